@@ -147,5 +147,12 @@ def parse_args():
         action='store_true',
         help='If set, would fuse multiple broadcast operators into one fused_broadcast operator.'
     )
+    parser.add_argument(
+        '--executor_type',
+        type=str,
+        choices=['default', 'experimental', 'work_stealing'],
+        default='default',
+        help='Specify the SSA graph executor of ParallelExecutor, can be '
+        'default, experimental, work_stealing')
     args = parser.parse_args()
     return args
@@ -170,6 +170,10 @@ def train_parallel(train_args, test_args, args, train_prog, test_prog,
     strategy = fluid.ExecutionStrategy()
     strategy.num_threads = args.cpus
     strategy.allow_op_delay = False
+    if args.executor_type == "experimental":
+        strategy.use_experimental_executor = True
+    elif args.executor_type == "work_stealing":
+        strategy.use_work_stealing_executor = True
     build_strategy = fluid.BuildStrategy()
     if args.reduce_strategy == "reduce":
         build_strategy.reduce_strategy = fluid.BuildStrategy(
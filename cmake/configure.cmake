@@ -49,6 +49,10 @@ if(NOT WITH_PROFILER)
     add_definitions(-DPADDLE_DISABLE_PROFILER)
 endif(NOT WITH_PROFILER)
 
+if(WITH_TRUSTED_KERNELS)
+    add_definitions(-DPADDLE_TRUSTED_KERNELS)
+endif(WITH_TRUSTED_KERNELS)
+
 if(NOT CMAKE_CROSSCOMPILING)
     if(WITH_AVX AND AVX_FOUND)
         set(SIMD_FLAG ${AVX_FLAG})
@@ -218,3 +222,7 @@ endif(WITH_GRPC)
 if(WITH_BRPC_RDMA)
     add_definitions(-DPADDLE_WITH_BRPC_RDMA)
 endif(WITH_BRPC_RDMA)
+
+if(WITH_VERBS)
+    add_definitions(-DPADDLE_WITH_VERBS)
+endif(WITH_VERBS)
@@ -63,6 +63,7 @@ ExternalProject_Add(
 )
 
 message(STATUS "Anakin for inference is enabled")
+add_definitions(-DPADDLE_WITH_ANAKIN)
 message(STATUS "Anakin is set INCLUDE:${ANAKIN_INCLUDE} LIBRARY:${ANAKIN_LIBRARY}")
 
 add_library(anakin_shared SHARED IMPORTED GLOBAL)
@@ -0,0 +1,48 @@
+# Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+IF(MOBILE_INFERENCE OR RPI)
+    return()
+ENDIF()
+
+include (ExternalProject)
+
+# NOTE: lz4 is needed when linking with recordio
+
+set(LZ4_SOURCES_DIR ${THIRD_PARTY_PATH}/lz4)
+set(LZ4_INSTALL_DIR ${THIRD_PARTY_PATH}/install/lz4)
+set(LZ4_INCLUDE_DIR "${LZ4_INSTALL_DIR}/include" CACHE PATH "lz4 include directory." FORCE)
+
+set(LZ4_LIBRARIES "${LZ4_INSTALL_DIR}/lib/liblz4.a")
+
+ExternalProject_Add(
+    extern_lz4
+    ${EXTERNAL_PROJECT_LOG_ARGS}
+    GIT_REPOSITORY    "https://github.com/lz4/lz4"
+    GIT_TAG           "v1.8.3"
+    PREFIX            ${LZ4_SOURCES_DIR}
+    UPDATE_COMMAND    ""
+    CONFIGURE_COMMAND ""
+    BUILD_IN_SOURCE   1
+    BUILD_COMMAND     make -C lib liblz4.a CC=${CMAKE_C_COMPILER} "CFLAGS=${CMAKE_C_FLAGS} -O3 -fPIC"
+    INSTALL_COMMAND   make -C lib install-static install-includes PREFIX=${LZ4_INSTALL_DIR} LIBDIR=${LZ4_INSTALL_DIR}/lib
+    TEST_COMMAND      ""
+)
+
+add_library(lz4 STATIC IMPORTED GLOBAL)
+set_property(TARGET lz4 PROPERTY IMPORTED_LOCATION ${LZ4_LIBRARIES})
+
+include_directories(${LZ4_INCLUDE_DIR})
+add_dependencies(lz4 extern_lz4)
@@ -0,0 +1,48 @@
+# Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+IF(MOBILE_INFERENCE OR RPI)
+    return()
+ENDIF()
+
+include (ExternalProject)
+
+# NOTE: zstd is needed when linking with recordio
+
+set(ZSTD_SOURCES_DIR ${THIRD_PARTY_PATH}/zstd)
+set(ZSTD_INSTALL_DIR ${THIRD_PARTY_PATH}/install/zstd)
+set(ZSTD_INCLUDE_DIR "${ZSTD_INSTALL_DIR}/include" CACHE PATH "zstd include directory." FORCE)
+
+set(ZSTD_LIBRARIES "${ZSTD_INSTALL_DIR}/lib/libzstd.a")
+
+ExternalProject_Add(
+    extern_zstd
+    ${EXTERNAL_PROJECT_LOG_ARGS}
+    GIT_REPOSITORY    "https://github.com/facebook/zstd"
+    GIT_TAG           "v1.3.7"
+    PREFIX            ${ZSTD_SOURCES_DIR}
+    UPDATE_COMMAND    ""
+    CONFIGURE_COMMAND ""
+    BUILD_IN_SOURCE   1
+    BUILD_COMMAND     make -C lib libzstd.a CC=${CMAKE_C_COMPILER} "CFLAGS=${CMAKE_C_FLAGS} -O3 -fPIC"
+    INSTALL_COMMAND   make -C lib install-static install-includes PREFIX=${ZSTD_INSTALL_DIR} LIBDIR=${ZSTD_INSTALL_DIR}/lib
+    TEST_COMMAND      ""
+)
+
+add_library(zstd STATIC IMPORTED GLOBAL)
+set_property(TARGET zstd PROPERTY IMPORTED_LOCATION ${ZSTD_LIBRARIES})
+
+include_directories(${ZSTD_INCLUDE_DIR})
+add_dependencies(zstd extern_zstd)
@@ -122,6 +122,18 @@ if(NOT MOBILE_INFERENCE AND NOT RPI)
     DSTS ${dst_dir} ${dst_dir}/lib
     DEPS snappystream)
 
+  set(dst_dir "${FLUID_INSTALL_DIR}/third_party/install/lz4")
+  copy(lz4_lib
+    SRCS ${LZ4_INCLUDE_DIR} ${LZ4_LIBRARIES}
+    DSTS ${dst_dir} ${dst_dir}/lib
+    DEPS lz4)
+
+  set(dst_dir "${FLUID_INSTALL_DIR}/third_party/install/zstd")
+  copy(zstd_lib
+    SRCS ${ZSTD_INCLUDE_DIR} ${ZSTD_LIBRARIES}
+    DSTS ${dst_dir} ${dst_dir}/lib
+    DEPS zstd)
+
   set(dst_dir "${FLUID_INSTALL_DIR}/third_party/install/zlib")
   copy(zlib_lib
     SRCS ${ZLIB_INCLUDE_DIR} ${ZLIB_LIBRARIES}
@@ -165,8 +177,10 @@ set(module "inference")
 copy(inference_lib DEPS ${inference_deps}
   SRCS ${src_dir}/${module}/*.h ${PADDLE_BINARY_DIR}/paddle/fluid/inference/libpaddle_fluid.*
        ${src_dir}/${module}/api/paddle_inference_api.h
+       ${src_dir}/${module}/api/paddle_c_api.h
        ${PADDLE_BINARY_DIR}/paddle/fluid/inference/api/paddle_inference_pass.h
   DSTS ${dst_dir}/${module} ${dst_dir}/${module} ${dst_dir}/${module} ${dst_dir}/${module}
+       ${dst_dir}/${module}
 )
 
 set(module "platform")
@@ -206,7 +220,9 @@ copy(third_party DEPS fluid_lib_dist
 copy(inference_api_lib DEPS fluid_lib_dist
   SRCS ${FLUID_INSTALL_DIR}/paddle/fluid/inference/libpaddle_fluid.*
        ${FLUID_INSTALL_DIR}/paddle/fluid/inference/paddle_inference_api.h
+       ${FLUID_INSTALL_DIR}/paddle/fluid/inference/paddle_c_api.h
   DSTS ${FLUID_INFERENCE_INSTALL_DIR}/paddle/lib ${FLUID_INFERENCE_INSTALL_DIR}/paddle/include
+       ${FLUID_INFERENCE_INSTALL_DIR}/paddle/include
 )
 
 add_custom_target(inference_lib_dist DEPENDS third_party inference_api_lib)
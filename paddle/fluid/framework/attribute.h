@@ -269,18 +269,18 @@ class TypedAttrChecker {
   }
 
   void operator()(AttributeMap& attr_map) const {  // NOLINT
-    if (!attr_map.count(attr_name_)) {
+    auto it = attr_map.find(attr_name_);
+    if (it == attr_map.end()) {
       // user do not set this attr
       PADDLE_ENFORCE(!default_value_setter_.empty(),
                      "Attribute '%s' is required!", attr_name_);
       // default_value_setter_ has no more than one element
       T val;
       (default_value_setter_[0])(val);
-      attr_map[attr_name_] = val;
+      it = attr_map.emplace(attr_name_, std::move(val)).first;
     }
-    Attribute& attr = attr_map.at(attr_name_);
     ExtractAttribute<T> extract_attr(attr_name_);
-    T* attr_value = extract_attr(attr);
+    T* attr_value = extract_attr(it->second);
     for (const auto& checker : value_checkers_) {
       checker(*attr_value);
     }
@@ -25,20 +25,10 @@ void TransDataDevice(const Tensor &in, const platform::Place &dst_place,
       in.place().which(), dst_place.which(),
       "Currently, model parallelism is only supported between CPU and CUDA");
 
-  // NOTE(yy): TransDataDevice should wait for computation of input.
-  platform::DeviceContextPool::Instance().Get(in.place())->Wait();
-  platform::DeviceContextPool::Instance().Get(dst_place)->Wait();
-
-  // FIXME(zcd): TransDataDevice is used to transform data from GPU to CPU and
-  // the enforced checkings have been done in GetDeviceContext, so the
-  // `dev_ctx->Wait()` is necessary. But `dev_ctx->Wait()` will make the program
-  // slow, especially when the number of elements is little, for example,
-  // the elements of learning rate are one and it's CPU side.
-  // One solution is to use a CUDA kernel to complete the copy operation when
-  // the transforming is from CPU to GPU and the number of elements is little.
-  // But the embarrassment is that this solution this solution makes training
-  // slower.
-  TensorCopySync(in, dst_place, out);
+  // NOTE: the copy is done on the copy stream of the GPU, which waits for
+  // the computation of the input but does not block the kernels issued
+  // later, and TransDataDevice returns after the copy finishes.
+  TensorCopyOnCopyStream(in, dst_place, out);
 }
 
 }  // namespace framework
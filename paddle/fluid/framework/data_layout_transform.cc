@@ -15,6 +15,7 @@
 #include "paddle/fluid/framework/data_layout_transform.h"
 #include <vector>
 
+#include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/operators/math/math_function.h"
 #ifdef PADDLE_WITH_MKLDNN
 #include "paddle/fluid/platform/mkldnn_helper.h"
@@ -91,6 +92,88 @@ void TransDataLayout(const OpKernelType& kernel_type_for_var,
   out->set_layout(expected_kernel_type.data_layout_);
 }
 
+template <typename InType>
+struct CastDataLayoutAndType {
+  CastDataLayoutAndType(const std::vector<int>& axis,
+                        const framework::Tensor& in, framework::Tensor* out)
+      : in_(in), out_(out), axis_(axis) {}
+  const framework::Tensor in_;
+  framework::Tensor* out_;
+  const std::vector<int> axis_;
+
+  template <typename OutType>
+  void apply() {
+    auto src_dims = in_.dims();
+    int64_t src_stride[4];
+    src_stride[3] = 1;
+    for (int i = 2; i >= 0; --i) {
+      src_stride[i] = src_stride[i + 1] * src_dims[i + 1];
+    }
+    int64_t dst_dims[4];
+    int64_t stride[4];
+    for (int i = 0; i < 4; ++i) {
+      dst_dims[i] = src_dims[axis_[i]];
+      stride[i] = src_stride[axis_[i]];
+    }
+
+    const InType* src = in_.data<InType>();
+    OutType* dst = out_->mutable_data<OutType>(in_.place());
+    for (int64_t i0 = 0; i0 < dst_dims[0]; ++i0) {
+      for (int64_t i1 = 0; i1 < dst_dims[1]; ++i1) {
+        for (int64_t i2 = 0; i2 < dst_dims[2]; ++i2) {
+          const InType* s = src + i0 * stride[0] + i1 * stride[1] +
+                            i2 * stride[2];
+          for (int64_t i3 = 0; i3 < dst_dims[3]; ++i3) {
+            *dst++ = static_cast<OutType>(s[i3 * stride[3]]);
+          }
+        }
+      }
+    }
+  }
+};
+
+struct CastDataLayoutAndTypeFrom {
+  CastDataLayoutAndTypeFrom(proto::VarType::Type dst_type,
+                            const std::vector<int>& axis,
+                            const framework::Tensor& in,
+                            framework::Tensor* out)
+      : dst_type_(dst_type), axis_(axis), in_(in), out_(out) {}
+  proto::VarType::Type dst_type_;
+  const std::vector<int>& axis_;
+  const framework::Tensor& in_;
+  framework::Tensor* out_;
+
+  template <typename InType>
+  void apply() {
+    framework::VisitDataType(dst_type_,
+                             CastDataLayoutAndType<InType>(axis_, in_, out_));
+  }
+};
+
+void TransDataLayoutAndType(const OpKernelType& kernel_type_for_var,
+                            const OpKernelType& expected_kernel_type,
+                            const Tensor& in, Tensor* out) {
+  PADDLE_ENFORCE(platform::is_cpu_place(in.place()),
+                 "TransDataLayoutAndType only supports CPU.");
+  PADDLE_ENFORCE(arity(in.dims()) == 4, "Input Arity only support 4!");
+
+  auto src_dim = in.dims();
+  auto axis = GetAxis(kernel_type_for_var.data_layout_,
+                      expected_kernel_type.data_layout_);
+  std::vector<int64_t> dst_dim(axis.size());
+  for (size_t i = 0; i < axis.size(); i++) {
+    dst_dim[i] = src_dim[axis[i]];
+  }
+  out->Resize(make_ddim(dst_dim));
+
+  framework::VisitDataType(
+      framework::ToDataType(in.type()),
+      CastDataLayoutAndTypeFrom(expected_kernel_type.data_type_, axis, in,
+                                out));
+
+  out->set_layout(expected_kernel_type.data_layout_);
+}
+
 #ifdef PADDLE_WITH_MKLDNN
 using mkldnn::memory;
 using mkldnn::primitive;
@@ -101,9 +184,9 @@ void* GetDataFromTensor(const Tensor& tensor, mkldnn::memory::data_type type) {
     case mkldnn::memory::data_type::f32:
       return platform::to_void_cast(tensor.data<float>());
     case mkldnn::memory::data_type::s8:
-      return platform::to_void_cast(tensor.data<char>());
+      return platform::to_void_cast(tensor.data<int8_t>());
     case mkldnn::memory::data_type::u8:
-      return platform::to_void_cast(tensor.data<unsigned char>());
+      return platform::to_void_cast(tensor.data<uint8_t>());
     case mkldnn::memory::data_type::s16:
       return platform::to_void_cast(tensor.data<int16_t>());
     case mkldnn::memory::data_type::s32:
@@ -145,7 +228,14 @@ void TransDataLayoutFromMKLDNN(const OpKernelType& kernel_type_for_var,
   memory::data_type in_type = ToMKLDNNDataType(in.type());
   PADDLE_ENFORCE(in_type != memory::data_type::data_undef,
                  "Input tensor type is not supported: ", in.type().name());
-  memory::data_type out_type = in_type;
+  // The reorder converts the data type as well when MKLDNN supports the one
+  // the kernel expects, so TransformData skips the data type transform.
+  auto out_type_index = ToTypeIndex(expected_kernel_type.data_type_);
+  memory::data_type out_type = ToMKLDNNDataType(out_type_index);
+  if (out_type == memory::data_type::data_undef) {
+    out_type = in_type;
+    out_type_index = in.type();
+  }
 
   auto in_format = platform::MKLDNNFormatForSize(in_tz.size(), in.format());
   auto out_format =
@@ -156,7 +246,8 @@ void TransDataLayoutFromMKLDNN(const OpKernelType& kernel_type_for_var,
   // output tensor has the same dims as input. Reorder don't change dims
   out->Resize(in.dims());
 
-  auto out_data = out->mutable_data(expected_kernel_type.place_, in.type());
+  auto out_data =
+      out->mutable_data(expected_kernel_type.place_, out_type_index);
 
   auto in_memory = memory({{{in_tz}, in_type, in_format}, cpu_engine}, in_data);
   auto out_memory =
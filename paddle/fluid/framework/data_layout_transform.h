@@ -53,8 +53,8 @@ inline DataLayout ToPaddleLayout(const MKLDNNFormat& format) {
 inline MKLDNNDataType ToMKLDNNDataType(const std::type_index type) {
   static const std::map<std::type_index, MKLDNNDataType> dict{
       {std::type_index(typeid(float)), MKLDNNDataType::f32},  // NOLINT
-      {std::type_index(typeid(char)), MKLDNNDataType::s8},    // NOLINT
-      {std::type_index(typeid(unsigned char)), MKLDNNDataType::u8},
+      {std::type_index(typeid(int8_t)), MKLDNNDataType::s8},  // NOLINT
+      {std::type_index(typeid(uint8_t)), MKLDNNDataType::u8},
       {std::type_index(typeid(int16_t)), MKLDNNDataType::s16},
       {std::type_index(typeid(int32_t)), MKLDNNDataType::s32}};
   auto iter = dict.find(type);
@@ -74,5 +74,12 @@ void TransDataLayout(const OpKernelType& kernel_type_for_var,
                      const OpKernelType& expected_kernel_type, const Tensor& in,
                      Tensor* out);
 
+// The same as TransDataLayout and then TransDataType, but the data is cast
+// while it is transposed, so no intermediate tensor is written. Only CPU is
+// supported.
+void TransDataLayoutAndType(const OpKernelType& kernel_type_for_var,
+                            const OpKernelType& expected_kernel_type,
+                            const Tensor& in, Tensor* out);
+
 }  // namespace framework
 }  // namespace paddle
@@ -43,3 +43,42 @@ TEST(DataTransform, DataLayoutFunction) {
   EXPECT_TRUE(in.layout() == paddle::framework::DataLayout::kNHWC);
   EXPECT_TRUE(in.dims() == paddle::framework::make_ddim({2, 3, 1, 2}));
 }
+
+TEST(DataTransform, DataLayoutAndTypeFunction) {
+  auto place = paddle::platform::CPUPlace();
+  paddle::framework::Tensor in;
+  paddle::framework::Tensor out;
+  double* in_data = in.mutable_data<double>(
+      paddle::framework::make_ddim({2, 3, 1, 2}), place);
+  for (int i = 0; i < in.numel(); ++i) {
+    in_data[i] = i;
+  }
+  in.set_layout(paddle::framework::DataLayout::kNHWC);
+
+  auto kernel_nhwc = paddle::framework::OpKernelType(
+      paddle::framework::proto::VarType::FP64, place,
+      paddle::framework::DataLayout::kNHWC,
+      paddle::framework::LibraryType::kPlain);
+  auto kernel_nchw = paddle::framework::OpKernelType(
+      paddle::framework::proto::VarType::FP32, place,
+      paddle::framework::DataLayout::kNCHW,
+      paddle::framework::LibraryType::kPlain);
+
+  paddle::framework::TransDataLayoutAndType(kernel_nhwc, kernel_nchw, in,
+                                            &out);
+
+  EXPECT_TRUE(out.layout() == paddle::framework::DataLayout::kNCHW);
+  EXPECT_TRUE(out.dims() == paddle::framework::make_ddim({2, 2, 3, 1}));
+  EXPECT_TRUE(out.type() == typeid(float));
+
+  // out[n][c][h][w] = in[n][h][w][c]
+  const float* out_data = out.data<float>();
+  for (int n = 0; n < 2; ++n) {
+    for (int c = 0; c < 2; ++c) {
+      for (int h = 0; h < 3; ++h) {
+        EXPECT_EQ(out_data[(n * 2 + c) * 3 + h],
+                  static_cast<float>((n * 3 + h) * 2 + c));
+      }
+    }
+  }
+}
@@ -17,6 +17,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/data_device_transform.h"
 #include "paddle/fluid/framework/data_layout_transform.h"
 #include "paddle/fluid/framework/data_type_transform.h"
+#include "paddle/fluid/framework/op_phase_profiler.h"
 
 #ifdef PADDLE_WITH_MKLDNN
 #include "paddle/fluid/platform/mkldnn_helper.h"
@@ -34,6 +35,10 @@ void TransformData(const OpKernelType &expected_kernel_type,
                    const OpKernelType &kernel_type_for_var,
                    const Tensor &input_tensor, Tensor *output_tensor) {
   bool transformed = false;
+  // Whether the layout transform has converted the data type as well.
+  bool type_transformed = false;
+  bool need_transform_type =
+      expected_kernel_type.data_type_ != kernel_type_for_var.data_type_;
   Tensor in;
   in.ShareDataWith(input_tensor);
   Tensor out;
@@ -42,6 +47,7 @@ void TransformData(const OpKernelType &expected_kernel_type,
 
   // do layout transform
   if (NeedTransformLayout(lout, lin)) {
+    size_t bytes = in.memory_size();
     if (lin == DataLayout::kMKLDNN || lout == DataLayout::kMKLDNN) {
       PADDLE_ENFORCE(
           !(lin == DataLayout::kMKLDNN && lout == DataLayout::kMKLDNN),
@@ -59,22 +65,34 @@ void TransformData(const OpKernelType &expected_kernel_type,
         out.set_layout(DataLayout::kMKLDNN);
         out.set_format(out_format);
 #endif
+        bytes = 0;
       } else {
         // Case2 - transfrom from MKLDNN OPKernel to Non-MKLDNN OPKernel
         // Do transform via MKLDNN lib
         TransDataLayoutFromMKLDNN(kernel_type_for_var, expected_kernel_type, in,
                                   &out);
+        type_transformed = need_transform_type &&
+                           ToDataType(out.type()) ==
+                               expected_kernel_type.data_type_;
       }
+    } else if (need_transform_type && platform::is_cpu_place(in.place())) {
+      // Case3 with a data type transform - cast the data while transposing
+      // it, without the intermediate tensor
+      TransDataLayoutAndType(kernel_type_for_var, expected_kernel_type, in,
+                             &out);
+      type_transformed = true;
     } else {
       // Case3 - transfrom between Non-MKLDNN OPKernels
       TransDataLayout(kernel_type_for_var, expected_kernel_type, in, &out);
     }
+    RecordDataTransform(kLayoutTransform, bytes);
     transformed = true;
     PassTensorData(&out, &in);
   }
 
   // do data type transform
-  if (expected_kernel_type.data_type_ != kernel_type_for_var.data_type_) {
+  if (need_transform_type && !type_transformed) {
+    RecordDataTransform(kDataTypeTransform, in.memory_size());
     TransDataType(kernel_type_for_var, expected_kernel_type, in, &out);
     transformed = true;
     PassTensorData(&out, &in);
@@ -83,6 +101,7 @@ void TransformData(const OpKernelType &expected_kernel_type,
   // do device transform
   if (!platform::is_same_place(kernel_type_for_var.place_,
                                expected_kernel_type.place_)) {
+    RecordDataTransform(kDeviceTransform, in.memory_size());
     TransDataDevice(in, expected_kernel_type.place_, &out);
     transformed = true;
     PassTensorData(&out, &in);
@@ -18,6 +18,7 @@
 #include <unordered_map>
 
 using float16 = paddle::platform::float16;
+using bfloat16 = paddle::platform::bfloat16;
 
 namespace paddle {
 namespace framework {
@@ -65,6 +66,7 @@ static DataTypeMap* InitDataTypeMap() {
   RegType(int16_t, proto::VarType::INT16);
   RegType(uint8_t, proto::VarType::UINT8);
   RegType(int8_t, proto::VarType::INT8);
+  RegType(bfloat16, proto::VarType::BF16);
 
 #undef RegType
   return retv;
@@ -16,6 +16,7 @@ limitations under the License. */
 #include <string>
 #include <typeindex>
 #include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/platform/bfloat16.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/float16.h"
 
@@ -55,6 +56,9 @@ inline void VisitDataType(proto::VarType::Type type, Visitor visitor) {
     case proto::VarType::INT8:
       visitor.template apply<int8_t>();
       break;
+    case proto::VarType::BF16:
+      visitor.template apply<platform::bfloat16>();
+      break;
     default:
       PADDLE_THROW("Not supported %d", type);
   }
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <cstring>
 #include <initializer_list>
 #include <stdexcept>
 #include <vector>
@@ -27,51 +28,107 @@ namespace framework {
 /**
  * \brief A dynamically sized dimension.
  *
- * The number of dimensions must be between [1, 9].
+ * The number of dimensions must be between [1, 9]. The dimensions are stored
+ * in a fixed-size array with the rank, so that indexing, product and slicing
+ * do not dispatch on the rank. The statically sized Dim<D> is only made at
+ * the boundary, e.g. by apply_visitor or boost::get.
  */
-struct DDim {
-  typedef boost::variant<Dim<0>, Dim<1>, Dim<2>, Dim<3>, Dim<4>, Dim<5>, Dim<6>,
-                         Dim<7>, Dim<8>, Dim<9>>
-      DDimVar;
-  DDimVar var;
+class DDim {
+ public:
+  static constexpr int kMaxRank = 9;
 
-  DDim() : var(Dim<1>()) {}
+  DDim() : rank_(1) { dim_[0] = 0; }
 
   template <int D>
-  explicit DDim(const Dim<D>& in) : var(in) {}
+  explicit DDim(const Dim<D>& in) {
+    *this = in;
+  }
+
+  DDim(const int64_t* dims, int rank) { Reset(dims, rank); }
 
-  /*implicit*/ DDim(std::initializer_list<int64_t> init_list);
+  /*implicit*/ DDim(std::initializer_list<int64_t> init_list)
+      : DDim(init_list.begin(), static_cast<int>(init_list.size())) {}
 
   template <int D>
   DDim& operator=(const Dim<D>& in) {
-    var = in;
+    static_assert(D <= kMaxRank, "The rank of Dim is greater than kMaxRank.");
+    rank_ = D;
+    for (int i = 0; i < D; ++i) {
+      dim_[i] = in[i];
+    }
     return *this;
   }
 
-  int64_t& operator[](int idx);
-  int64_t operator[](int idx) const;
+  int64_t& operator[](int idx) { return dim_[idx]; }
+  int64_t operator[](int idx) const { return dim_[idx]; }
 
+  // Call visitor with the Dim<D> of the same rank, which is a copy of this.
   template <typename Visitor>
-  typename Visitor::result_type apply_visitor(Visitor& visitor) {
-    return var.apply_visitor(visitor);
+  typename Visitor::result_type apply_visitor(Visitor& visitor) const {
+    switch (rank_) {
+      case 0:
+        return VisitDim<0>(visitor);
+      case 1:
+        return VisitDim<1>(visitor);
+      case 2:
+        return VisitDim<2>(visitor);
+      case 3:
+        return VisitDim<3>(visitor);
+      case 4:
+        return VisitDim<4>(visitor);
+      case 5:
+        return VisitDim<5>(visitor);
+      case 6:
+        return VisitDim<6>(visitor);
+      case 7:
+        return VisitDim<7>(visitor);
+      case 8:
+        return VisitDim<8>(visitor);
+      default:
+        return VisitDim<9>(visitor);
+    }
   }
 
-  template <typename Visitor>
-  typename Visitor::result_type apply_visitor(Visitor& visitor) const {
-    return var.apply_visitor(visitor);
+  template <int D>
+  Dim<D> ToDim() const {
+    PADDLE_ENFORCE_EQ(rank_, D, "The rank of DDim does not match Dim.");
+    Dim<D> dim;
+    for (int i = 0; i < D; ++i) {
+      dim[i] = dim_[i];
+    }
+    return dim;
   }
 
-  DDimVar getVar() { return var; }
+  bool operator==(const DDim& d) const;
 
-  bool operator==(DDim d) const;
+  bool operator!=(const DDim& d) const;
 
-  bool operator!=(DDim d) const;
+  DDim operator+(const DDim& d) const;
 
-  DDim operator+(DDim d) const;
+  DDim operator*(const DDim& d) const;
 
-  DDim operator*(DDim d) const;
+  int size() const { return rank_; }
+
+  const int64_t* Get() const { return dim_; }
+
+  int64_t* GetMutable() { return dim_; }
+
+ private:
+  void Reset(const int64_t* dims, int rank) {
+    PADDLE_ENFORCE(rank >= 0 && rank <= kMaxRank,
+                   "Dynamic dimensions must have between [1, 9] dimensions.");
+    rank_ = rank;
+    std::memcpy(dim_, dims, rank * sizeof(int64_t));
+  }
+
+  template <int D, typename Visitor>
+  typename Visitor::result_type VisitDim(Visitor& visitor) const {
+    Dim<D> dim = ToDim<D>();
+    return visitor(dim);
+  }
 
-  int size() const;
+  int64_t dim_[kMaxRank];
+  int rank_;
 };
 
 /**
@@ -134,7 +191,7 @@ namespace boost {
 
 template <typename T>
 T get(const paddle::framework::DDim& in) {
-  return boost::get<T>(in.var);
+  return in.ToDim<T::dimensions>();
 }
 
 }  // namespace boost
@@ -0,0 +1,188 @@
+/* Copyright (c) 2016 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+/*
+ * ddim_benchmark times the DDim operations of InferShape and Resize, on the
+ * flat DDim and on the boost::variant of Dim<0>..Dim<9> it replaced, which
+ * is kept here as the baseline.
+ *
+ *   ddim_benchmark --iterations=10000000
+ */
+#include <gflags/gflags.h>
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <vector>
+
+#include "paddle/fluid/framework/ddim.h"
+
+DEFINE_int32(iterations, 10000000, "The times to run each operation.");
+
+namespace paddle {
+namespace framework {
+namespace {
+
+// The operations of the baseline were not inlined in the callers, as they
+// were defined in ddim.cc.
+#define BASELINE_NOINLINE __attribute__((noinline))
+
+typedef boost::variant<Dim<0>, Dim<1>, Dim<2>, Dim<3>, Dim<4>, Dim<5>, Dim<6>,
+                       Dim<7>, Dim<8>, Dim<9>>
+    VariantDDim;
+
+template <int i>
+Dim<i> MakeDim(const int64_t* d) {
+  return Dim<i>(*d, MakeDim<i - 1>(d + 1));
+}
+
+template <>
+Dim<0> MakeDim<0>(const int64_t* d) {
+  return Dim<0>(*d);
+}
+
+BASELINE_NOINLINE VariantDDim
+MakeVariantDDim(const std::vector<int64_t>& dims) {
+  switch (dims.size()) {
+    case 1:
+      return MakeDim<1>(dims.data());
+    case 2:
+      return MakeDim<2>(dims.data());
+    case 3:
+      return MakeDim<3>(dims.data());
+    case 4:
+      return MakeDim<4>(dims.data());
+    default:
+      return MakeDim<5>(dims.data());
+  }
+}
+
+struct IndexVisitor : public boost::static_visitor<int64_t> {
+  explicit IndexVisitor(int idx) : idx_(idx) {}
+  template <int D>
+  int64_t operator()(const Dim<D>& dim) const {
+    return dim[idx_];
+  }
+  int idx_;
+};
+
+BASELINE_NOINLINE int64_t Get(const VariantDDim& ddim, int idx) {
+  return boost::apply_visitor(IndexVisitor(idx), ddim);
+}
+
+struct ProductVisitor : public boost::static_visitor<int64_t> {
+  template <int D>
+  int64_t operator()(const Dim<D>& dim) const {
+    return product(dim);
+  }
+};
+
+BASELINE_NOINLINE int64_t Product(const VariantDDim& ddim) {
+  ProductVisitor visitor;
+  return boost::apply_visitor(visitor, ddim);
+}
+
+struct VectorizeVisitor : public boost::static_visitor<> {
+  explicit VectorizeVisitor(std::vector<int64_t>* v) : v_(v) {}
+  template <typename T>
+  void operator()(const T& t) {
+    v_->push_back(t.head);
+    this->operator()(t.tail);
+  }
+  void operator()(const Dim<0>& t) {}
+  std::vector<int64_t>* v_;
+};
+
+BASELINE_NOINLINE std::vector<int64_t> Vectorize(const VariantDDim& ddim) {
+  std::vector<int64_t> result;
+  VectorizeVisitor visitor(&result);
+  boost::apply_visitor(visitor, ddim);
+  return result;
+}
+
+BASELINE_NOINLINE VariantDDim Slice(const VariantDDim& ddim, int begin,
+                                    int end) {
+  auto vec = Vectorize(ddim);
+  return MakeVariantDDim(
+      std::vector<int64_t>(vec.begin() + begin, vec.begin() + end));
+}
+
+template <typename Func>
+double NanosecondsPerIteration(Func func) {
+  int64_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < FLAGS_iterations; ++i) {
+    sink += func(i);
+  }
+  auto end = std::chrono::steady_clock::now();
+  // Keep the loop from being optimized out.
+  if (sink == 42) std::printf(" ");
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         FLAGS_iterations;
+}
+
+void Report(const char* name, double variant_ns, double flat_ns) {
+  std::printf("%-12s %12.2f %12.2f %10.2fx\n", name, variant_ns, flat_ns,
+              variant_ns / flat_ns);
+}
+
+}  // namespace
+
+void RunDDimBenchmark() {
+  // Pick one of the shapes by the iteration, so that the operations are not
+  // hoisted out of the loops.
+  const std::vector<std::vector<int64_t>> shapes = {
+      {32, 3, 224, 224}, {32, 64, 56, 56}, {32, 1000}, {128, 12, 64}};
+  std::vector<VariantDDim> variant_ddims;
+  std::vector<DDim> ddims;
+  for (auto& shape : shapes) {
+    variant_ddims.push_back(MakeVariantDDim(shape));
+    ddims.push_back(make_ddim(shape));
+  }
+
+  std::printf("%-12s %12s %12s %11s\n", "operation", "variant(ns)", "flat(ns)",
+              "speedup");
+  Report("index",
+         NanosecondsPerIteration([&](int i) {
+           return Get(variant_ddims[i & 3], 1);
+         }),
+         NanosecondsPerIteration([&](int i) { return ddims[i & 3][1]; }));
+  Report("product", NanosecondsPerIteration([&](int i) {
+           return Product(variant_ddims[i & 3]);
+         }),
+         NanosecondsPerIteration([&](int i) { return product(ddims[i & 3]); }));
+  Report("make_ddim", NanosecondsPerIteration([&](int i) {
+           return Get(MakeVariantDDim(shapes[i & 3]), 0);
+         }),
+         NanosecondsPerIteration(
+             [&](int i) { return make_ddim(shapes[i & 3])[0]; }));
+  Report("slice_ddim", NanosecondsPerIteration([&](int i) {
+           return Get(Slice(variant_ddims[i & 3], 1, 2), 0);
+         }),
+         NanosecondsPerIteration(
+             [&](int i) { return slice_ddim(ddims[i & 3], 1, 2)[0]; }));
+  Report("vectorize", NanosecondsPerIteration([&](int i) {
+           return Vectorize(variant_ddims[i & 3])[1];
+         }),
+         NanosecondsPerIteration(
+             [&](int i) { return vectorize(ddims[i & 3])[1]; }));
+}
+
+}  // namespace framework
+}  // namespace paddle
+
+int main(int argc, char** argv) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  paddle::framework::RunDDimBenchmark();
+  return 0;
+}
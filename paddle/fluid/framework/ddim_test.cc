@@ -95,3 +95,29 @@ TEST(DDim, Print) {
   ss << ddim;
   EXPECT_EQ("2, 3, 4", ss.str());
 }
+
+struct DimRankVisitor : public boost::static_visitor<int> {
+  template <int D>
+  int operator()(const paddle::framework::Dim<D>& dim) const {
+    return D;
+  }
+};
+
+TEST(DDim, Dim) {
+  paddle::framework::DDim ddim = paddle::framework::make_ddim({2, 3, 4});
+  DimRankVisitor visitor;
+  EXPECT_EQ(boost::apply_visitor(visitor, ddim), 3);
+
+  auto dim = boost::get<paddle::framework::Dim<3>>(ddim);
+  EXPECT_EQ(dim[0], 2);
+  EXPECT_EQ(dim[1], 3);
+  EXPECT_EQ(dim[2], 4);
+  EXPECT_EQ(paddle::framework::DDim(dim), ddim);
+  EXPECT_NE(paddle::framework::make_ddim({2, 3}), ddim);
+
+  paddle::framework::DDim empty = paddle::framework::make_ddim({});
+  EXPECT_EQ(empty.size(), 0);
+  EXPECT_EQ(paddle::framework::product(empty), 1);
+  EXPECT_THROW(paddle::framework::slice_ddim(ddim, 1, 4),
+               paddle::platform::EnforceNotMet);
+}
@@ -12,26 +12,181 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include <algorithm>
+#include <memory>
 
+#include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/details/all_reduce_op_handle.h"
 #include "paddle/fluid/framework/details/container_cast.h"
 #include "paddle/fluid/framework/details/reduce_and_gather.h"
 #include "paddle/fluid/framework/details/variable_visitor.h"
+#include "paddle/fluid/platform/intra_op_thread_pool.h"
 #include "paddle/fluid/platform/profiler.h"
 
+DEFINE_int32(cpu_all_reduce_num_threads, 0,
+             "The threads summing the segments of the CPU gradients of all "
+             "the places in parallel, 0 for the number of the places of the "
+             "first all reduce.");
+
 namespace paddle {
 namespace framework {
 namespace details {
 
+// The elements reduced at a time, summed across the buffers in the order of
+// TreeSum and then written back to all of them before they leave the cache.
+static constexpr int64_t kCPUAllReduceBlock = 4096;
+
+static platform::IntraOpThreadPool *CPUAllReducePool(int num_places) {
+  static platform::IntraOpThreadPool *pool = new platform::IntraOpThreadPool(
+      FLAGS_cpu_all_reduce_num_threads > 0 ? FLAGS_cpu_all_reduce_num_threads
+                                           : num_places);
+  return pool;
+}
+
+struct CPUAllReduceFunctor {
+  const std::vector<void *> &buffers_;
+  int64_t numel_;
+
+  template <typename T>
+  void apply() const {
+    std::vector<T *> bufs;
+    for (auto *b : buffers_) {
+      bufs.push_back(reinterpret_cast<T *>(b));
+    }
+    // The same order as the deterministic reduce, so that kAllReduce and
+    // kReduce train alike with FLAGS_cpu_deterministic.
+    auto reduce = [&bufs](int64_t begin, int64_t end) {
+      const size_t n = bufs.size();
+      // Not std::vector, whose bool is not an array.
+      std::unique_ptr<T[]> sum(new T[kCPUAllReduceBlock]);
+      std::unique_ptr<T[]> scratch(
+          new T[kCPUAllReduceBlock * TreeSumScratchSize(n)]);
+      std::vector<const T *> block_bufs(n);
+      for (int64_t b = begin; b < end; b += kCPUAllReduceBlock) {
+        int64_t len = std::min(kCPUAllReduceBlock, end - b);
+        for (size_t i = 0; i < n; ++i) {
+          block_bufs[i] = bufs[i] + b;
+        }
+        TreeSum(block_bufs.data(), n, len, sum.get(), scratch.get());
+        for (size_t i = 0; i < n; ++i) {
+          std::copy(sum.get(), sum.get() + len, bufs[i] + b);
+        }
+      }
+    };
+    CPUAllReducePool(static_cast<int>(bufs.size()))
+        ->ParallelFor(numel_, kCPUAllReduceBlock, reduce);
+  }
+};
+
+void CPUAllReduceInPlace(const std::vector<LoDTensor *> &tensors) {
+  PADDLE_ENFORCE(!tensors.empty());
+  auto &t0 = *tensors[0];
+  std::vector<void *> buffers;
+  for (auto *t : tensors) {
+    PADDLE_ENFORCE(platform::is_cpu_place(t->place()),
+                   "The tensors should be on CPU.");
+    PADDLE_ENFORCE_EQ(t->dims(), t0.dims());
+    PADDLE_ENFORCE(t->type() == t0.type());
+    void *data = t->data<void>();
+    // The places sharing a buffer add it once.
+    if (std::find(buffers.begin(), buffers.end(), data) == buffers.end()) {
+      buffers.push_back(data);
+    }
+  }
+  if (buffers.size() == 1) return;
+  CPUAllReduceFunctor func{buffers, t0.numel()};
+  VisitDataType(ToDataType(t0.type()), func);
+}
+
 #ifdef PADDLE_WITH_CUDA
+void NCCLAllReduceBuffers(const platform::NCCLContextMap &ctxs,
+                          const std::vector<platform::Place> &places,
+                          const std::vector<void *> &buffers, size_t numel,
+                          std::type_index type, bool use_hierarchical) {
+  auto dtype = platform::ToNCCLDataType(type);
+  if (!use_hierarchical || !ctxs.HasHierarchicalComms()) {
+    platform::NCCLGroupGuard guard;
+    for (size_t i = 0; i < places.size(); ++i) {
+      auto &nccl_ctx = ctxs.at(places[i]);
+      PADDLE_ENFORCE(platform::dynload::ncclAllReduce(
+          buffers[i], buffers[i], numel, dtype, ncclSum, nccl_ctx.comm_,
+          nccl_ctx.stream()));
+    }
+    return;
+  }
+
+  // Each NCCL call is issued on the stream of its device, so the three
+  // steps are ordered on every device without extra synchronization.
+  size_t nranks = places.size();
+  if (numel % nranks != 0) {
+    auto &root_ctx = ctxs.at(places[0]);
+    {
+      platform::NCCLGroupGuard guard;
+      for (size_t i = 0; i < nranks; ++i) {
+        auto &nccl_ctx = ctxs.at(places[i]);
+        PADDLE_ENFORCE(platform::dynload::ncclReduce(
+            buffers[i], buffers[i], numel, dtype, ncclSum, 0,
+            nccl_ctx.local_comm_, nccl_ctx.stream()));
+      }
+    }
+    PADDLE_ENFORCE(platform::dynload::ncclAllReduce(
+        buffers[0], buffers[0], numel, dtype, ncclSum, root_ctx.inter_comm_,
+        root_ctx.stream()));
+    {
+      platform::NCCLGroupGuard guard;
+      for (size_t i = 0; i < nranks; ++i) {
+        auto &nccl_ctx = ctxs.at(places[i]);
+        PADDLE_ENFORCE(platform::dynload::ncclBcast(
+            buffers[i], numel, dtype, 0, nccl_ctx.local_comm_,
+            nccl_ctx.stream()));
+      }
+    }
+    return;
+  }
+
+  size_t shard_numel = numel / nranks;
+  size_t shard_bytes = shard_numel * SizeOfType(type);
+  auto shard = [&](size_t i) {
+    return reinterpret_cast<uint8_t *>(buffers[i]) + i * shard_bytes;
+  };
+  {
+    platform::NCCLGroupGuard guard;
+    for (size_t i = 0; i < nranks; ++i) {
+      auto &nccl_ctx = ctxs.at(places[i]);
+      PADDLE_ENFORCE(platform::dynload::ncclReduceScatter(
+          buffers[i], shard(i), shard_numel, dtype, ncclSum,
+          nccl_ctx.local_comm_, nccl_ctx.stream()));
+    }
+  }
+  {
+    platform::NCCLGroupGuard guard;
+    for (size_t i = 0; i < nranks; ++i) {
+      auto &nccl_ctx = ctxs.at(places[i]);
+      PADDLE_ENFORCE(platform::dynload::ncclAllReduce(
+          shard(i), shard(i), shard_numel, dtype, ncclSum,
+          nccl_ctx.inter_comm_, nccl_ctx.stream()));
+    }
+  }
+  {
+    platform::NCCLGroupGuard guard;
+    for (size_t i = 0; i < nranks; ++i) {
+      auto &nccl_ctx = ctxs.at(places[i]);
+      PADDLE_ENFORCE(platform::dynload::ncclAllGather(
+          shard(i), buffers[i], shard_numel, dtype, nccl_ctx.local_comm_,
+          nccl_ctx.stream()));
+    }
+  }
+}
+
 AllReduceOpHandle::AllReduceOpHandle(ir::Node *node,
                                      const std::vector<Scope *> &local_scopes,
                                      const std::vector<platform::Place> &places,
-                                     const platform::NCCLContextMap *ctxs)
+                                     const platform::NCCLContextMap *ctxs,
+                                     bool use_hierarchical)
     : OpHandleBase(node),
       local_scopes_(local_scopes),
       places_(places),
-      nccl_ctxs_(ctxs) {
+      nccl_ctxs_(ctxs),
+      use_hierarchical_(use_hierarchical) {
   if (nccl_ctxs_) {
     for (auto &p : places_) {
       this->SetDeviceContext(p, nccl_ctxs_->DevCtx(p));
@@ -76,65 +231,27 @@ void AllReduceOpHandle::RunImpl() {
     if (platform::is_gpu_place(lod_tensors[0]->place())) {
 #ifdef PADDLE_WITH_CUDA
       PADDLE_ENFORCE(nccl_ctxs_, "nccl_ctxs should not be nullptr.");
-      int dtype = -1;
-      size_t numel = 0;
-      std::vector<std::function<void()>> all_reduce_calls;
-      for (size_t i = 0; i < local_scopes_.size(); ++i) {
-        auto &p = places_[i];
-        auto &lod_tensor = *lod_tensors[i];
-        void *buffer = const_cast<void *>(lod_tensor.data<void>());
-
-        if (dtype == -1) {
-          dtype = platform::ToNCCLDataType(lod_tensor.type());
-        }
-
-        if (numel == 0) {
-          numel = static_cast<size_t>(lod_tensor.numel());
-        }
-
-        int dev_id = boost::get<platform::CUDAPlace>(p).device;
-        auto &nccl_ctx = nccl_ctxs_->at(dev_id);
-        auto stream = nccl_ctx.stream();
-        auto comm = nccl_ctx.comm_;
-        all_reduce_calls.emplace_back([=] {
-          PADDLE_ENFORCE(platform::dynload::ncclAllReduce(
-              buffer, buffer, numel, static_cast<ncclDataType_t>(dtype),
-              ncclSum, comm, stream));
-        });
+      size_t numel = static_cast<size_t>(lod_tensors[0]->numel());
+      std::vector<void *> buffers;
+      for (auto *lod_tensor : lod_tensors) {
+        buffers.emplace_back(const_cast<void *>(lod_tensor->data<void>()));
       }
       this->RunAndRecordEvent([&] {
-        platform::NCCLGroupGuard guard;
-        for (auto &call : all_reduce_calls) {
-          call();
-        }
+        NCCLAllReduceBuffers(*nccl_ctxs_, places_, buffers, numel,
+                             lod_tensors[0]->type(), use_hierarchical_);
       });
 #else
       PADDLE_THROW("Not compiled with CUDA");
 #endif
     } else {  // Special handle CPU only Operator's gradient. Like CRF
-      auto &trg = *this->local_scopes_[0]
-                       ->FindVar(kLocalExecScopeName)
-                       ->Get<Scope *>()
-                       ->FindVar(out_var_handles[0]->name_)
-                       ->GetMutable<framework::LoDTensor>();
-
-      // Reduce All Tensor to trg in CPU
-      ReduceLoDTensor func(lod_tensors, &trg);
-      VisitDataType(ToDataType(lod_tensors[0]->type()), func);
-
-      for (size_t i = 1; i < local_scopes_.size(); ++i) {
+      std::vector<LoDTensor *> tensors;
+      for (size_t i = 0; i < local_scopes_.size(); ++i) {
         auto &scope =
             *local_scopes_[i]->FindVar(kLocalExecScopeName)->Get<Scope *>();
-        auto &p = places_[i];
-        auto *var = scope.FindVar(out_var_handles[i]->name_);
-        auto *dev_ctx = dev_ctxes_.at(p);
-
-        RunAndRecordEvent(p, [&trg, var, dev_ctx, p] {
-          auto &tensor_gpu = *var->GetMutable<framework::LoDTensor>();
-          auto &tensor_cpu = trg;
-          TensorCopy(tensor_cpu, p, *dev_ctx, &tensor_gpu);
-        });
+        tensors.emplace_back(
+            scope.FindVar(out_var_handles[i]->name_)->GetMutable<LoDTensor>());
       }
+      this->RunAndRecordEvent([&] { CPUAllReduceInPlace(tensors); });
     }
   }
 }
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <string>
+#include <typeindex>
 #include <vector>
 
 #include "paddle/fluid/framework/details/op_handle_base.h"
@@ -28,11 +29,32 @@ namespace paddle {
 namespace framework {
 namespace details {
 
+#ifdef PADDLE_WITH_CUDA
+// Sum the buffers of all the places in place, buffers[i] is on places[i].
+// The flat all reduce runs one ncclAllReduce over the global communicators.
+// The hierarchical one reduce-scatters the buffers inside the trainer, all
+// reduces each shard across the trainers over the inter communicator of its
+// local rank, then all-gathers the shards inside the trainer again. It falls
+// back to reduce, all reduce and broadcast through the first device if the
+// buffers can not be split evenly.
+void NCCLAllReduceBuffers(const platform::NCCLContextMap &ctxs,
+                          const std::vector<platform::Place> &places,
+                          const std::vector<void *> &buffers, size_t numel,
+                          std::type_index type, bool use_hierarchical);
+#endif
+
+// Sum the CPU tensors of all the places in place. The elements are split
+// into segments reduced by the threads of a pool at the same time, each
+// segment is summed into the first tensor and written back to the others
+// while it is still in cache, so no tensor is copied as a whole.
+void CPUAllReduceInPlace(const std::vector<LoDTensor *> &tensors);
+
 struct AllReduceOpHandle : public OpHandleBase {
 #ifdef PADDLE_WITH_CUDA
   AllReduceOpHandle(ir::Node *node, const std::vector<Scope *> &local_scopes,
                     const std::vector<platform::Place> &places,
-                    const platform::NCCLContextMap *ctxs);
+                    const platform::NCCLContextMap *ctxs,
+                    bool use_hierarchical = false);
 #else
   AllReduceOpHandle(ir::Node *node, const std::vector<Scope *> &local_scopes,
                     const std::vector<platform::Place> &places);
@@ -51,6 +73,7 @@ struct AllReduceOpHandle : public OpHandleBase {
   std::vector<platform::Place> places_;
 #ifdef PADDLE_WITH_CUDA
   const platform::NCCLContextMap *nccl_ctxs_;
+  bool use_hierarchical_;
 #endif
 };
 
@@ -0,0 +1,67 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/all_reduce_op_handle.h"
+
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+TEST(CPUAllReduceInPlace, SumAllPlaces) {
+  const int kPlaces = 4;
+  // Spans several blocks and a partial one.
+  const int64_t kNumel = 3 * 4096 + 17;
+  std::vector<LoDTensor> grads(kPlaces);
+  std::vector<LoDTensor *> ptrs;
+  for (int i = 0; i < kPlaces; ++i) {
+    grads[i].Resize({kNumel});
+    float *data = grads[i].mutable_data<float>(platform::CPUPlace());
+    for (int64_t j = 0; j < kNumel; ++j) {
+      data[j] = static_cast<float>(i + 1) * (j % 7);
+    }
+    ptrs.push_back(&grads[i]);
+  }
+
+  CPUAllReduceInPlace(ptrs);
+
+  for (int i = 0; i < kPlaces; ++i) {
+    const float *data = grads[i].data<float>();
+    for (int64_t j = 0; j < kNumel; ++j) {
+      ASSERT_FLOAT_EQ(data[j], 10.f * (j % 7));
+    }
+  }
+}
+
+TEST(CPUAllReduceInPlace, SharedBuffer) {
+  LoDTensor grad;
+  grad.Resize({8});
+  float *data = grad.mutable_data<float>(platform::CPUPlace());
+  for (int j = 0; j < 8; ++j) {
+    data[j] = j;
+  }
+  // The places sharing the buffer do not add it twice.
+  LoDTensor shared;
+  shared.ShareDataWith(grad);
+  CPUAllReduceInPlace({&grad, &shared});
+  for (int j = 0; j < 8; ++j) {
+    EXPECT_EQ(data[j], j);
+  }
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
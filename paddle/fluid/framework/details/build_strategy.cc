@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/details/build_strategy.h"
 
+#include "paddle/fluid/framework/details/collective_tuner.h"
 #include "paddle/fluid/framework/details/multi_devices_graph_check_pass.h"
 #include "paddle/fluid/framework/details/multi_devices_graph_print_pass.h"
 #include "paddle/fluid/framework/details/sequential_execution_pass.h"
@@ -40,6 +41,12 @@ class ParallelExecutorPassBuilder : public ir::PassBuilder {
       viz_pass->Set<std::string>("graph_viz_path", new std::string(graph_path));
     }
 
+    // Fuse the dropout with the residual add, before the add is fused with
+    // an activation.
+    if (strategy.fuse_dropout_add_ops_) {
+      AppendPass("fuse_dropout_add_pass");
+    }
+
     // Add op fusion.
     if (strategy.fuse_elewise_add_act_ops_) {
       auto fuse_elewise_add_act_pass = AppendPass("fuse_elewise_add_act_pass");
@@ -53,6 +60,21 @@ class ParallelExecutorPassBuilder : public ir::PassBuilder {
       }
     }
 
+    // Accumulate the gradients over the micro-batches.
+    if (strategy.num_accumulation_steps_ > 1) {
+      auto gradient_accumulation_pass =
+          AppendPass("gradient_accumulation_pass");
+      gradient_accumulation_pass->Set<const int>(
+          "num_accumulation_steps",
+          new int(static_cast<int>(strategy.num_accumulation_steps_)));
+    }
+
+    // Fuse the optimizer ops.
+    if (strategy.fuse_optimizer_ops_ &&
+        strategy.reduce_ != BuildStrategy::ReduceStrategy::kReduce) {
+      AppendPass("fuse_optimizer_ops_pass");
+    }
+
     // Convert graph to run on multi-devices.
     auto multi_devices_pass = AppendPass("multi_devices_pass");
     multi_devices_pass->SetNotOwned<const BuildStrategy>("strategy",
@@ -70,6 +92,15 @@ class ParallelExecutorPassBuilder : public ir::PassBuilder {
     // Verify that the graph is correct for multi-device executor.
     AppendPass("multi_devices_check_pass");
 
+    // Put the independent ops on multiple streams, before the locks and
+    // events are removed according to the streams.
+    if (strategy_.num_compute_streams_ > 1) {
+      auto stream_assignment_pass = AppendPass("stream_assignment_pass");
+      stream_assignment_pass->Set<const int>(
+          "num_streams",
+          new int(static_cast<int>(strategy_.num_compute_streams_)));
+    }
+
     if (strategy_.remove_unnecessary_lock_) {
       AppendPass("modify_op_lock_and_record_event_pass");
     }
@@ -79,6 +110,14 @@ class ParallelExecutorPassBuilder : public ir::PassBuilder {
   BuildStrategy strategy_;
 };
 
+void BuildStrategy::LoadCollectiveConfig(const std::string &path) {
+  auto config = ReadCollectiveConfig(path);
+  reduce_ = config.use_reduce_strategy ? ReduceStrategy::kReduce
+                                       : ReduceStrategy::kAllReduce;
+  fuse_all_reduce_ops_ = config.fuse_all_reduce_ops;
+  fuse_all_reduce_bucket_size_ = config.fuse_all_reduce_bucket_size;
+}
+
 std::shared_ptr<ir::PassBuilder> BuildStrategy::CreatePassesFromStrategy()
     const {
   pass_builder_.reset(new ParallelExecutorPassBuilder(*this));
@@ -133,7 +172,10 @@ std::unique_ptr<ir::Graph> BuildStrategy::Apply(
 }  // namespace framework
 }  // namespace paddle
 
+USE_PASS(fuse_dropout_add_pass);
 USE_PASS(fuse_elewise_add_act_pass);
+USE_PASS(fuse_optimizer_ops_pass);
+USE_PASS(gradient_accumulation_pass);
 USE_PASS(graph_viz_pass);
 USE_PASS(multi_batch_merge_pass);
 USE_PASS(multi_devices_pass);
@@ -141,3 +183,4 @@ USE_PASS(multi_devices_check_pass);
 USE_PASS(multi_devices_print_pass);
 USE_PASS(sequential_execution_pass);
 USE_PASS(modify_op_lock_and_record_event_pass);
+USE_PASS(stream_assignment_pass);
@@ -67,14 +67,66 @@ struct BuildStrategy {
 
   bool fuse_elewise_add_act_ops_{false};
 
+  // Fuse the dropout whose output is only added to another tensor of the
+  // same shape, and its grad, into the fused_dropout_add ops, which do not
+  // keep the dropout output, see fuse_dropout_add_pass.
+  bool fuse_dropout_add_ops_{false};
+
   bool enable_data_balance_{false};
 
+  // Balance the tokens of the sequences read on the devices instead of the
+  // number of the sequences, so that the devices compute about the same.
+  // It only works with enable_data_balance_.
+  bool data_balance_by_tokens_{false};
+
   bool enable_sequential_execution_{false};
 
   bool fuse_broadcast_op_{false};
 
+  // In kReduce mode on GPUs, broadcast the parameters optimized on a device
+  // at the beginning of the next iteration instead of the end of this one,
+  // in the order the forward ops read them. Each op only waits for the
+  // broadcast of the parameters it reads, so the broadcasts overlap the
+  // forward computation. The parameters on the other devices are one
+  // iteration behind until ParallelExecutor::SyncDeferredBroadcasts.
+  bool overlap_broadcast_{false};
+
+  // In kAllReduce mode, all reduce the dense gradients of the same data type
+  // together in buckets of about fuse_all_reduce_bucket_size_ bytes, instead
+  // of launching one all reduce per gradient.
+  bool fuse_all_reduce_ops_{false};
+
+  size_t fuse_all_reduce_bucket_size_{32 << 20};
+
+  // Fuse the dense sgd, momentum, lars_momentum and adam ops into the
+  // multi-tensor optimizer ops, see fuse_optimizer_ops_pass. It does not work
+  // in kReduce mode, where each parameter is updated on its own device.
+  bool fuse_optimizer_ops_{false};
+
+  // In multi-trainer NCCL mode, all reduce the gradients hierarchically:
+  // inside each trainer first, then across the trainers over one
+  // communicator per local device. The inter-trainer NCCL ids should be
+  // generated by gen_nccl_id.
+  bool use_hierarchical_allreduce_{false};
+
+  // Run the forward and backward ops num_accumulation_steps_ times, one
+  // micro-batch each time, accumulating the dense gradients in place, and run
+  // the all reduce and the optimize ops only in the last time, see
+  // gradient_accumulation_pass.
+  size_t num_accumulation_steps_{1};
+
   bool remove_unnecessary_lock_{false};
 
+  // Run the independent chains of the computation ops of each GPU on up to
+  // num_compute_streams_ CUDA streams, see stream_assignment_pass. It needs
+  // FLAGS_use_stream_ordered_allocator and does not work with the eager
+  // deletion.
+  size_t num_compute_streams_{1};
+
+  // Set the reduce strategy and the all reduce fusion from the config
+  // tuned by the collective_benchmark tool, see collective_tuner.h.
+  void LoadCollectiveConfig(const std::string &path);
+
   // User normally doesn't need to call this API.
   // The PassBuilder allows for more customized insert, remove of passes
   // from python side.
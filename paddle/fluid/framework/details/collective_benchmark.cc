@@ -0,0 +1,155 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+ * collective_benchmark measures the all reduce, reduce and broadcast of the
+ * NCCL communicators of NCCLContextMap, the same calls as AllReduceOpHandle,
+ * ReduceOpHandle and BroadcastOpHandle, over the message sizes and the
+ * device counts. It reports the bus bandwidth, and with --output_config it
+ * writes the reduce strategy and the all reduce bucket size tuned for all
+ * the devices, to be loaded by BuildStrategy.load_collective_config.
+ *
+ *   collective_benchmark --max_bytes=268435456 --output_config=nccl.conf
+ */
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <vector>
+
+#include "paddle/fluid/framework/details/all_reduce_op_handle.h"
+#include "paddle/fluid/framework/details/collective_tuner.h"
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/gpu_info.h"
+#include "paddle/fluid/platform/init.h"
+#include "paddle/fluid/platform/nccl_helper.h"
+
+DEFINE_int32(num_devices, 0, "The most devices to use, 0 for all of them.");
+DEFINE_uint64(min_bytes, 4 << 10, "The smallest message in bytes.");
+DEFINE_uint64(max_bytes, 256 << 20, "The largest message in bytes.");
+DEFINE_int32(warmup, 5, "The runs before timing each message.");
+DEFINE_int32(repeat, 20, "The timed runs of each message.");
+DEFINE_string(output_config, "",
+              "The file to write the collective config tuned for all the "
+              "devices to.");
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+static void RunCollective(const std::string &op,
+                          const platform::NCCLContextMap &ctxs,
+                          const std::vector<platform::Place> &places,
+                          const std::vector<void *> &buffers, size_t numel) {
+  if (op == "all_reduce") {
+    NCCLAllReduceBuffers(ctxs, places, buffers, numel, typeid(float), false);
+    return;
+  }
+  platform::NCCLGroupGuard guard;
+  for (size_t i = 0; i < places.size(); ++i) {
+    auto &nccl_ctx = ctxs.at(places[i]);
+    if (op == "reduce") {
+      PADDLE_ENFORCE(platform::dynload::ncclReduce(
+          buffers[i], buffers[i], numel, ncclFloat, ncclSum, 0, nccl_ctx.comm_,
+          nccl_ctx.stream()));
+    } else {
+      PADDLE_ENFORCE(platform::dynload::ncclBcast(
+          buffers[i], numel, ncclFloat, 0, nccl_ctx.comm_, nccl_ctx.stream()));
+    }
+  }
+}
+
+static std::vector<CollectiveBenchmarkResult> BenchmarkDevices(
+    int num_devices) {
+  std::vector<platform::Place> places;
+  for (int i = 0; i < num_devices; ++i) {
+    places.emplace_back(platform::CUDAPlace(i));
+  }
+  platform::NCCLContextMap ctxs(places);
+  std::vector<Tensor> tensors(num_devices);
+  std::vector<void *> buffers;
+  auto max_numel = static_cast<int64_t>(FLAGS_max_bytes / sizeof(float));
+  for (int i = 0; i < num_devices; ++i) {
+    buffers.push_back(
+        tensors[i].mutable_data<float>(make_ddim({max_numel}), places[i]));
+  }
+
+  std::vector<CollectiveBenchmarkResult> results;
+  for (const std::string op : {"all_reduce", "reduce", "broadcast"}) {
+    for (size_t bytes = FLAGS_min_bytes; bytes <= FLAGS_max_bytes;
+         bytes *= 2) {
+      size_t numel = bytes / sizeof(float);
+      for (int i = 0; i < FLAGS_warmup; ++i) {
+        RunCollective(op, ctxs, places, buffers, numel);
+      }
+      ctxs.WaitAll();
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < FLAGS_repeat; ++i) {
+        RunCollective(op, ctxs, places, buffers, numel);
+      }
+      ctxs.WaitAll();
+      double us = std::chrono::duration<double, std::micro>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+      results.push_back({op, num_devices, bytes, us / FLAGS_repeat});
+    }
+  }
+  return results;
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
+
+int main(int argc, char **argv) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  paddle::framework::InitDevices(false);
+  namespace details = paddle::framework::details;
+
+  int max_devices = paddle::platform::GetCUDADeviceCount();
+  if (FLAGS_num_devices > 0) {
+    max_devices = std::min(max_devices, FLAGS_num_devices);
+  }
+  if (max_devices < 2 || FLAGS_min_bytes < sizeof(float) ||
+      FLAGS_min_bytes > FLAGS_max_bytes) {
+    LOG(ERROR) << "collective_benchmark needs at least 2 devices and "
+               << "sizeof(float) <= min_bytes <= max_bytes.";
+    return 1;
+  }
+
+  // 2, 4, 8, ... devices and all of them
+  std::vector<details::CollectiveBenchmarkResult> results;
+  std::vector<int> device_counts;
+  for (int n = 2; n < max_devices; n *= 2) {
+    device_counts.push_back(n);
+  }
+  device_counts.push_back(max_devices);
+  for (int n : device_counts) {
+    auto device_results = details::BenchmarkDevices(n);
+    results.insert(results.end(), device_results.begin(),
+                   device_results.end());
+  }
+  std::cout << details::FormatCollectiveResults(results);
+
+  if (!FLAGS_output_config.empty()) {
+    auto config = details::TuneCollectiveConfig(results, max_devices);
+    details::WriteCollectiveConfig(config, FLAGS_output_config);
+    std::cout << "Write the collective config of " << max_devices
+              << " devices to " << FLAGS_output_config << std::endl;
+  }
+  return 0;
+}
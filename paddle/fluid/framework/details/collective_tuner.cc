@@ -0,0 +1,169 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/collective_tuner.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+double AlgorithmBandwidth(const CollectiveBenchmarkResult &result) {
+  if (result.time_us <= 0) return 0;
+  return result.bytes / result.time_us / 1e3;
+}
+
+double BusBandwidth(const CollectiveBenchmarkResult &result) {
+  double factor = 1;
+  if (result.op == "all_reduce") {
+    factor = 2.0 * (result.num_devices - 1) / result.num_devices;
+  }
+  return AlgorithmBandwidth(result) * factor;
+}
+
+static const CollectiveBenchmarkResult *FindResult(
+    const std::vector<CollectiveBenchmarkResult> &results,
+    const std::string &op, int num_devices, size_t bytes) {
+  for (auto &result : results) {
+    if (result.op == op && result.num_devices == num_devices &&
+        result.bytes == bytes) {
+      return &result;
+    }
+  }
+  return nullptr;
+}
+
+CollectiveConfig TuneCollectiveConfig(
+    const std::vector<CollectiveBenchmarkResult> &results, int num_devices,
+    double bandwidth_ratio) {
+  std::vector<const CollectiveBenchmarkResult *> all_reduces;
+  for (auto &result : results) {
+    if (result.op == "all_reduce" && result.num_devices == num_devices) {
+      all_reduces.push_back(&result);
+    }
+  }
+  PADDLE_ENFORCE(!all_reduces.empty(),
+                 "there is no all_reduce result of %d devices", num_devices);
+  std::sort(all_reduces.begin(), all_reduces.end(),
+            [](const CollectiveBenchmarkResult *a,
+               const CollectiveBenchmarkResult *b) {
+              return a->bytes < b->bytes;
+            });
+  double peak = 0;
+  for (auto *result : all_reduces) {
+    peak = std::max(peak, BusBandwidth(*result));
+  }
+
+  CollectiveConfig config;
+  config.fuse_all_reduce_ops = true;
+  for (auto *result : all_reduces) {
+    if (BusBandwidth(*result) >= peak * bandwidth_ratio) {
+      config.fuse_all_reduce_bucket_size = result->bytes;
+      break;
+    }
+  }
+
+  size_t bytes = config.fuse_all_reduce_bucket_size;
+  auto *all_reduce = FindResult(results, "all_reduce", num_devices, bytes);
+  auto *reduce = FindResult(results, "reduce", num_devices, bytes);
+  auto *broadcast = FindResult(results, "broadcast", num_devices, bytes);
+  if (reduce != nullptr && broadcast != nullptr &&
+      reduce->time_us + broadcast->time_us < all_reduce->time_us) {
+    config.use_reduce_strategy = true;
+    // the gradients are not fused in kReduce
+    config.fuse_all_reduce_ops = false;
+  }
+  return config;
+}
+
+void WriteCollectiveConfig(const CollectiveConfig &config,
+                           const std::string &path) {
+  std::ofstream out(path);
+  PADDLE_ENFORCE(out.is_open(), "can not open %s to write", path);
+  out << "# written by collective_benchmark\n";
+  out << "reduce_strategy "
+      << (config.use_reduce_strategy ? "Reduce" : "AllReduce") << "\n";
+  out << "fuse_all_reduce_ops "
+      << (config.fuse_all_reduce_ops ? "true" : "false") << "\n";
+  out << "fuse_all_reduce_bucket_size " << config.fuse_all_reduce_bucket_size
+      << "\n";
+}
+
+static bool ParseBool(const std::string &key, const std::string &value) {
+  PADDLE_ENFORCE(value == "true" || value == "false",
+                 "%s should be true or false, but it is %s", key, value);
+  return value == "true";
+}
+
+CollectiveConfig ReadCollectiveConfig(const std::string &path) {
+  std::ifstream in(path);
+  PADDLE_ENFORCE(in.is_open(), "can not open the collective config %s", path);
+  CollectiveConfig config;
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream is(line);
+    std::string key, value;
+    if (!(is >> key) || key[0] == '#') continue;
+    PADDLE_ENFORCE(static_cast<bool>(is >> value), "%s has no value in %s",
+                   key, path);
+    if (key == "reduce_strategy") {
+      PADDLE_ENFORCE(value == "AllReduce" || value == "Reduce",
+                     "reduce_strategy should be AllReduce or Reduce, but it "
+                     "is %s",
+                     value);
+      config.use_reduce_strategy = value == "Reduce";
+    } else if (key == "fuse_all_reduce_ops") {
+      config.fuse_all_reduce_ops = ParseBool(key, value);
+    } else if (key == "fuse_all_reduce_bucket_size") {
+      std::istringstream size(value);
+      PADDLE_ENFORCE(
+          static_cast<bool>(size >> config.fuse_all_reduce_bucket_size) &&
+              config.fuse_all_reduce_bucket_size > 0,
+          "fuse_all_reduce_bucket_size should be a positive integer, but it "
+          "is %s",
+          value);
+    } else {
+      PADDLE_THROW("unknown key %s in the collective config %s", key, path);
+    }
+  }
+  return config;
+}
+
+std::string FormatCollectiveResults(
+    const std::vector<CollectiveBenchmarkResult> &results) {
+  std::ostringstream os;
+  os << std::left << std::setw(12) << "op" << std::right << std::setw(8)
+     << "devices" << std::setw(14) << "bytes" << std::setw(14) << "time(us)"
+     << std::setw(14) << "algbw(GB/s)" << std::setw(14) << "busbw(GB/s)"
+     << "\n";
+  os << std::fixed << std::setprecision(2);
+  for (auto &result : results) {
+    os << std::left << std::setw(12) << result.op << std::right
+       << std::setw(8) << result.num_devices << std::setw(14) << result.bytes
+       << std::setw(14) << result.time_us << std::setw(14)
+       << AlgorithmBandwidth(result) << std::setw(14) << BusBandwidth(result)
+       << "\n";
+  }
+  return os.str();
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
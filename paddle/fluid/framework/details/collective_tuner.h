@@ -0,0 +1,75 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+// The time of a collective op over a message of bytes on num_devices
+// devices, measured by the collective_benchmark tool. The op is one of
+// "all_reduce", "reduce" and "broadcast".
+struct CollectiveBenchmarkResult {
+  std::string op;
+  int num_devices;
+  size_t bytes;
+  double time_us;
+};
+
+// The bytes of the message moved per second, in GB/s.
+double AlgorithmBandwidth(const CollectiveBenchmarkResult &result);
+
+// The bandwidth used on the busiest link, in GB/s, which does not depend on
+// the number of devices and compares with the hardware peak bandwidth. An
+// all reduce moves 2 * (n - 1) / n of the message over each link, a reduce
+// or a broadcast moves the message once, see also nccl-tests.
+double BusBandwidth(const CollectiveBenchmarkResult &result);
+
+// The subset of BuildStrategy decided by the collectives, which is written
+// by collective_benchmark and loaded by BuildStrategy::LoadCollectiveConfig.
+struct CollectiveConfig {
+  bool use_reduce_strategy{false};
+  bool fuse_all_reduce_ops{false};
+  size_t fuse_all_reduce_bucket_size{32 << 20};
+};
+
+// Pick the config for num_devices devices from the results.
+//
+// The bucket size is the smallest message whose all reduce reaches
+// bandwidth_ratio of the peak bus bandwidth, the smaller the buckets the
+// earlier they overlap the backward. kReduce is used if reducing and then
+// broadcasting a bucket is faster than all reducing it, since it also
+// splits the optimization over the devices.
+CollectiveConfig TuneCollectiveConfig(
+    const std::vector<CollectiveBenchmarkResult> &results, int num_devices,
+    double bandwidth_ratio = 0.9);
+
+// The config is in lines of "key value", where the keys are
+// reduce_strategy (AllReduce or Reduce), fuse_all_reduce_ops (true or
+// false) and fuse_all_reduce_bucket_size (bytes). Lines starting with #
+// are comments.
+void WriteCollectiveConfig(const CollectiveConfig &config,
+                           const std::string &path);
+CollectiveConfig ReadCollectiveConfig(const std::string &path);
+
+std::string FormatCollectiveResults(
+    const std::vector<CollectiveBenchmarkResult> &results);
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,81 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/collective_tuner.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+TEST(CollectiveTuner, Bandwidth) {
+  CollectiveBenchmarkResult all_reduce{"all_reduce", 4, 1 << 20, 100};
+  EXPECT_NEAR(AlgorithmBandwidth(all_reduce), 10.48576, 1e-6);
+  EXPECT_NEAR(BusBandwidth(all_reduce), 10.48576 * 1.5, 1e-6);
+  CollectiveBenchmarkResult broadcast{"broadcast", 4, 1 << 20, 100};
+  EXPECT_NEAR(BusBandwidth(broadcast), 10.48576, 1e-6);
+}
+
+TEST(CollectiveTuner, Tune) {
+  // the bus bandwidth saturates from 4MB
+  std::vector<CollectiveBenchmarkResult> results = {
+      {"all_reduce", 2, 1 << 20, 200},  {"all_reduce", 2, 4 << 20, 420},
+      {"all_reduce", 2, 16 << 20, 1600}, {"all_reduce", 4, 1 << 20, 100},
+      {"reduce", 2, 4 << 20, 300},       {"broadcast", 2, 4 << 20, 300},
+  };
+  auto config = TuneCollectiveConfig(results, 2);
+  EXPECT_FALSE(config.use_reduce_strategy);
+  EXPECT_TRUE(config.fuse_all_reduce_ops);
+  EXPECT_EQ(config.fuse_all_reduce_bucket_size, 4UL << 20);
+
+  results[4].time_us = 150;
+  results[5].time_us = 150;
+  config = TuneCollectiveConfig(results, 2);
+  EXPECT_TRUE(config.use_reduce_strategy);
+  EXPECT_FALSE(config.fuse_all_reduce_ops);
+
+  EXPECT_ANY_THROW(TuneCollectiveConfig(results, 8));
+}
+
+TEST(CollectiveTuner, ReadWrite) {
+  std::string path = "collective_tuner_test.conf";
+  CollectiveConfig config;
+  config.use_reduce_strategy = true;
+  config.fuse_all_reduce_bucket_size = 8 << 20;
+  WriteCollectiveConfig(config, path);
+  auto read = ReadCollectiveConfig(path);
+  EXPECT_TRUE(read.use_reduce_strategy);
+  EXPECT_FALSE(read.fuse_all_reduce_ops);
+  EXPECT_EQ(read.fuse_all_reduce_bucket_size, 8UL << 20);
+
+  {
+    std::ofstream out(path);
+    out << "reduce_strategy Broadcast\n";
+  }
+  EXPECT_ANY_THROW(ReadCollectiveConfig(path));
+  {
+    std::ofstream out(path);
+    out << "unknown_key 1\n";
+  }
+  EXPECT_ANY_THROW(ReadCollectiveConfig(path));
+  std::remove(path.c_str());
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
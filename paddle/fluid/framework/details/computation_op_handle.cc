@@ -14,6 +14,7 @@
 
 #include "paddle/fluid/framework/details/computation_op_handle.h"
 
+#include <memory>
 #include <string>
 
 namespace paddle {
@@ -30,6 +31,11 @@ void ComputationOpHandle::RunImpl() {
   WaitInputVarGenerated(place_);
 
   auto run_func = [this]() {
+    std::unique_ptr<platform::ScopedDeviceContextOverride> stream_guard;
+    if (stream_ctx_ != nullptr) {
+      stream_guard.reset(
+          new platform::ScopedDeviceContextOverride(stream_ctx_));
+    }
     op_->Run(*scope_->FindVar(kLocalExecScopeName)->Get<Scope *>(), place_);
   };
 
@@ -38,6 +38,13 @@ struct ComputationOpHandle : public OpHandleBase {
 
   void SetLockAndRecordEventFree(bool b) { is_lock_and_record_event_free_ = b; }
 
+  // Run the kernels on the stream of ctx from the stream pool of the place,
+  // instead of the stream of the default device context.
+  void SetStreamContext(platform::DeviceContext *ctx) {
+    dev_ctxes_[place_] = ctx;
+    stream_ctx_ = ctx;
+  }
+
  protected:
   void RunImpl() override;
 
@@ -48,6 +55,7 @@ struct ComputationOpHandle : public OpHandleBase {
   Scope *scope_;
   platform::Place place_;
   bool is_lock_and_record_event_free_{false};
+  platform::DeviceContext *stream_ctx_{nullptr};
 };
 }  // namespace details
 }  // namespace framework
@@ -0,0 +1,86 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/copy_op_handle.h"
+#include "paddle/fluid/framework/details/container_cast.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/platform/profiler.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+CopyOpHandle::CopyOpHandle(ir::Node *node,
+                           const std::vector<Scope *> &local_scopes,
+                           const platform::Place &dst_place)
+    : OpHandleBase(node), local_scopes_(local_scopes), dst_place_(dst_place) {
+  SetDeviceContext(dst_place_,
+                   platform::DeviceContextPool::Instance().Get(dst_place_));
+}
+
+void CopyOpHandle::RunImpl() {
+  platform::RecordEvent record_event(Name(), dev_ctxes_.at(dst_place_));
+
+  // The input and output may have dummy vars.
+  auto in_var_handles = DynamicCast<VarHandle>(inputs_);
+  auto out_var_handles = DynamicCast<VarHandle>(outputs_);
+  PADDLE_ENFORCE_EQ(in_var_handles.size(), 1UL,
+                    "The number of input should be one.");
+  PADDLE_ENFORCE_EQ(out_var_handles.size(), 1UL,
+                    "The number of output should be one.");
+  auto *in_handle = in_var_handles[0];
+  auto *out_handle = out_var_handles[0];
+
+  auto find_var = [this](const VarHandle *handle) {
+    auto *scope = local_scopes_.at(handle->scope_idx_)
+                      ->FindVar(kLocalExecScopeName)
+                      ->Get<Scope *>();
+    auto *var = scope->FindVar(handle->name_);
+    PADDLE_ENFORCE_NOT_NULL(var, "Cannot find variable %s to copy.",
+                            handle->name_);
+    return var;
+  };
+  auto *in_var = find_var(in_handle);
+  auto *out_var = find_var(out_handle);
+  // The scopes of the two places may share a persistable variable.
+  if (in_var == out_var) return;
+
+  WaitInputVarGenerated(dst_place_);
+  auto &dev_ctx = *dev_ctxes_.at(dst_place_);
+  RunAndRecordEvent(dst_place_, [&] {
+    if (in_var->IsType<LoDTensor>()) {
+      auto &src = in_var->Get<LoDTensor>();
+      auto *dst = out_var->GetMutable<LoDTensor>();
+      TensorCopy(src, dst_place_, dev_ctx, dst);
+      dst->set_lod(src.lod());
+    } else if (in_var->IsType<SelectedRows>()) {
+      auto &src = in_var->Get<SelectedRows>();
+      auto *dst = out_var->GetMutable<SelectedRows>();
+      dst->set_height(src.height());
+      dst->set_rows(src.rows());
+      TensorCopy(src.value(), dst_place_, dev_ctx, dst->mutable_value());
+    } else {
+      PADDLE_THROW("Variable %s should be LoDTensor or SelectedRows.",
+                   in_handle->name_);
+    }
+  });
+}
+
+std::string CopyOpHandle::Name() const { return "copy"; }
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
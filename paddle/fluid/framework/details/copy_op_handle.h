@@ -0,0 +1,47 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/details/op_handle_base.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+// Copy the LoDTensor or SelectedRows of the input VarHandle to the output
+// VarHandle, which may be in another scope on another place, e.g. to send an
+// activation or its gradient from one pipeline stage to the next one.
+struct CopyOpHandle : public OpHandleBase {
+ public:
+  CopyOpHandle(ir::Node *node, const std::vector<Scope *> &local_scopes,
+               const platform::Place &dst_place);
+
+  std::string Name() const override;
+
+ protected:
+  void RunImpl() override;
+
+ private:
+  const std::vector<Scope *> local_scopes_;
+  platform::Place dst_place_;
+};
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
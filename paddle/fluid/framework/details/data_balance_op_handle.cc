@@ -24,8 +24,11 @@ namespace details {
 DataBalanceOpHandle::DataBalanceOpHandle(
     ir::Node *node, const std::vector<Scope *> &local_scopes,
     const std::vector<platform::Place> &places,
-    const platform::NCCLContextMap *ctxs)
-    : OpHandleBase(node), local_scopes_(local_scopes), places_(places) {
+    const platform::NCCLContextMap *ctxs, bool balance_by_tokens)
+    : OpHandleBase(node),
+      local_scopes_(local_scopes),
+      places_(places),
+      balance_by_tokens_(balance_by_tokens) {
   if (ctxs) {
     for (auto &p : places_) {
       this->SetDeviceContext(p, ctxs->DevCtx(p));
@@ -35,10 +38,76 @@ DataBalanceOpHandle::DataBalanceOpHandle(
 #else
 DataBalanceOpHandle::DataBalanceOpHandle(
     ir::Node *node, const std::vector<Scope *> &local_scopes,
-    const std::vector<platform::Place> &places)
-    : OpHandleBase(node), local_scopes_(local_scopes), places_(places) {}
+    const std::vector<platform::Place> &places, bool balance_by_tokens)
+    : OpHandleBase(node),
+      local_scopes_(local_scopes),
+      places_(places),
+      balance_by_tokens_(balance_by_tokens) {}
 #endif
 
+namespace {
+
+// A device keeps its instances while their cost is within this ratio of the
+// average, so that the devices nearly balanced copy nothing.
+constexpr double kTokenBalanceSlack = 1.05;
+
+int InstanceNum(const LoDTensor &tensor) {
+  return tensor.lod().empty() ? tensor.dims()[0] : tensor.NumElements();
+}
+
+// The rows of the instances [begin, end) of the tensor.
+std::array<size_t, 2> InstanceRows(const LoDTensor &tensor, size_t begin,
+                                   size_t end) {
+  for (auto &level : tensor.lod()) {
+    begin = level[begin];
+    end = level[end];
+  }
+  return {{begin, end}};
+}
+
+// Concatenate the instances [begin, end) of the pieces into dst on place.
+void MergeInstances(const std::vector<const LoDTensor *> &srcs,
+                    const std::vector<std::array<int, 3>> &pieces,
+                    const platform::Place &place, LoDTensor *dst) {
+  const LoDTensor &first = *srcs[pieces[0][0]];
+  LoD lod(first.lod().size(), Vector<size_t>(1, 0));
+  int64_t rows = 0;
+  for (auto &piece : pieces) {
+    const LoDTensor &src = *srcs[piece[0]];
+    PADDLE_ENFORCE_EQ(src.lod().size(), lod.size(),
+                      "All the data shall have the same LoD levels.");
+    auto sliced = SliceInLevel(src.lod(), 0, piece[1], piece[2]);
+    for (size_t j = 0; j < lod.size(); ++j) {
+      size_t offset = lod[j].back();
+      for (size_t k = 1; k < sliced[j].size(); ++k) {
+        lod[j].push_back(sliced[j][k] + offset);
+      }
+    }
+    auto range = InstanceRows(src, piece[1], piece[2]);
+    rows += range[1] - range[0];
+  }
+  auto dims = first.dims();
+  dims[0] = rows;
+  dst->Resize(dims);
+  dst->set_layout(first.layout());
+  dst->set_lod(lod);
+  dst->mutable_data(place, first.type());
+
+  int64_t begin = 0;
+  for (auto &piece : pieces) {
+    const LoDTensor &src = *srcs[piece[0]];
+    auto range = InstanceRows(src, piece[1], piece[2]);
+    int64_t end = begin + range[1] - range[0];
+    if (end > begin) {
+      Tensor dst_rows = dst->Slice(begin, end);
+      TensorCopySync(src.Slice(range[0], range[1]), place, &dst_rows);
+    }
+    begin = end;
+  }
+}
+
+}  // namespace
+
 std::string DataBalanceOpHandle::Name() const { return "data balance"; }
 
 std::vector<std::array<int, 3>> DataBalanceOpHandle::GetBalancePlan(
@@ -85,6 +154,130 @@ std::vector<std::array<int, 3>> DataBalanceOpHandle::GetBalancePlan(
   return res;
 }
 
+std::vector<std::vector<std::array<int, 3>>>
+DataBalanceOpHandle::GetTokenBalancePlan(
+    const std::vector<std::vector<int64_t>> &costs) {
+  int device_num = costs.size();
+  int total_size = 0;
+  int64_t total_cost = 0;
+  for (auto &device_costs : costs) {
+    total_size += device_costs.size();
+    for (auto cost : device_costs) total_cost += cost;
+  }
+  std::vector<std::vector<std::array<int, 3>>> res(device_num);
+  if (total_size < device_num) {
+    // No enough data.
+    PADDLE_THROW_EOF();
+  }
+  double limit = kTokenBalanceSlack * total_cost / device_num;
+  std::vector<int64_t> loads(device_num, 0);
+  std::vector<int> sizes(device_num, 0);
+  std::vector<int> kept_sizes(device_num, 0);
+  bool balanced = true;
+  for (int i = 0; i < device_num; ++i) {
+    int size = costs[i].size();
+    int kept = 0;
+    while (kept < size &&
+           (kept == 0 || loads[i] + costs[i][kept] <= limit)) {
+      loads[i] += costs[i][kept++];
+    }
+    if (kept > 0) res[i].push_back({{i, 0, kept}});
+    sizes[i] = kept;
+    kept_sizes[i] = kept;
+    balanced &= kept == size && kept > 0;
+  }
+  if (balanced) {
+    // No need to do data balance.
+    return {};
+  }
+
+  // Move the rest to the least loaded devices, the empty ones first.
+  for (int src = 0; src < device_num; ++src) {
+    for (int ins = kept_sizes[src]; ins < static_cast<int>(costs[src].size());
+         ++ins) {
+      int dst = 0;
+      for (int i = 1; i < device_num; ++i) {
+        if (std::make_pair(sizes[i] > 0, loads[i]) <
+            std::make_pair(sizes[dst] > 0, loads[dst])) {
+          dst = i;
+        }
+      }
+      loads[dst] += costs[src][ins];
+      ++sizes[dst];
+      auto &pieces = res[dst];
+      if (!pieces.empty() && pieces.back()[0] == src &&
+          pieces.back()[2] == ins) {
+        ++pieces.back()[2];
+      } else {
+        pieces.push_back({{src, ins, ins + 1}});
+      }
+    }
+  }
+
+  // The devices may still be empty if the rest are too few, take the last
+  // instance of the device having the most ones.
+  for (int dst = 0; dst < device_num; ++dst) {
+    if (sizes[dst] > 0) continue;
+    int src = std::max_element(sizes.begin(), sizes.end()) - sizes.begin();
+    auto &piece = res[src].back();
+    res[dst].push_back({{piece[0], piece[2] - 1, piece[2]}});
+    if (--piece[2] == piece[1]) res[src].pop_back();
+    --sizes[src];
+    ++sizes[dst];
+  }
+  return res;
+}
+
+void DataBalanceOpHandle::BalanceByTokens(
+    const std::vector<std::vector<LoDTensor *>> &tensors) {
+  int device_num = places_.size();
+  // The tokens are counted on the first data with the LoD, the data without
+  // the LoD are balanced by the number of the instances.
+  const std::vector<LoDTensor *> *sequences = nullptr;
+  for (auto &data : tensors) {
+    for (auto *tensor : data) {
+      if (!tensor->lod().empty()) sequences = &data;
+    }
+    if (sequences != nullptr) break;
+  }
+  std::vector<std::vector<int64_t>> costs(device_num);
+  for (int i = 0; i < device_num; ++i) {
+    const LoDTensor &tensor = *tensors[0][i];
+    costs[i].assign(InstanceNum(tensor), 1);
+    if (sequences == nullptr || (*sequences)[i]->lod().empty()) continue;
+    for (size_t j = 0; j < costs[i].size(); ++j) {
+      auto rows = InstanceRows(*(*sequences)[i], j, j + 1);
+      // the empty sequences still cost a step
+      costs[i][j] = std::max<int64_t>(rows[1] - rows[0], 1);
+    }
+  }
+  const auto &balance_plan = GetTokenBalancePlan(costs);
+  if (balance_plan.empty()) return;
+
+  for (auto &data : tensors) {
+    std::vector<const LoDTensor *> srcs(data.begin(), data.end());
+    std::vector<LoDTensor> balanced(device_num);
+    for (int i = 0; i < device_num; ++i) {
+      const auto &pieces = balance_plan[i];
+      if (pieces.size() == 1UL && pieces[0][0] == i) {
+        // Share the instances kept on the device.
+        auto rows = InstanceRows(*srcs[i], pieces[0][1], pieces[0][2]);
+        balanced[i].ShareDataWith(srcs[i]->Slice(rows[0], rows[1]));
+        if (!srcs[i]->lod().empty()) {
+          balanced[i].set_lod(
+              SliceInLevel(srcs[i]->lod(), 0, pieces[0][1], pieces[0][2]));
+        }
+      } else {
+        MergeInstances(srcs, pieces, places_[i], &balanced[i]);
+      }
+    }
+    for (int i = 0; i < device_num; ++i) {
+      data[i]->ShareDataWith(balanced[i]);
+      data[i]->set_lod(balanced[i].lod());
+    }
+  }
+}
+
 void DataBalanceOpHandle::RunImpl() {
   PADDLE_ENFORCE_GT(places_.size(), 1,
                     "Data balance can only be enabled when the number of "
@@ -120,6 +313,10 @@ void DataBalanceOpHandle::RunImpl() {
           "All data on the same device shall have the same batch size.");
     }
   }
+  if (balance_by_tokens_) {
+    BalanceByTokens(lod_tensors);
+    return;
+  }
   const auto &balance_plan = GetBalancePlan(device_sizes);
 
   for (const auto &trans : balance_plan) {
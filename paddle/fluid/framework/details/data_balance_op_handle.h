@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <array>
 #include <string>
 #include <vector>
 #include "paddle/fluid/framework/details/op_handle_base.h"
@@ -32,16 +33,26 @@ struct DataBalanceOpHandle : public OpHandleBase {
 #ifdef PADDLE_WITH_CUDA
   DataBalanceOpHandle(ir::Node *node, const std::vector<Scope *> &local_scopes,
                       const std::vector<platform::Place> &places,
-                      const platform::NCCLContextMap *ctxs);
+                      const platform::NCCLContextMap *ctxs,
+                      bool balance_by_tokens = false);
 #else
   DataBalanceOpHandle(ir::Node *node, const std::vector<Scope *> &local_scopes,
-                      const std::vector<platform::Place> &places);
+                      const std::vector<platform::Place> &places,
+                      bool balance_by_tokens = false);
 #endif
 
   std::string Name() const override;
 
   bool IsMultiDeviceTransfer() override { return false; };
 
+  // Balance the costs of the instances, costs[dev_id][ins_id], on the
+  // devices. Each device keeps its first instances within the average cost,
+  // the rest go to the least loaded devices. Return the instances of each
+  // device, std::vector<(src_dev_id, ins_begin, ins_end)> in order, or
+  // nothing if the devices are balanced.
+  static std::vector<std::vector<std::array<int, 3>>> GetTokenBalancePlan(
+      const std::vector<std::vector<int64_t>> &costs);
+
  protected:
   void RunImpl() override;
 
@@ -50,8 +61,13 @@ struct DataBalanceOpHandle : public OpHandleBase {
   std::vector<std::array<int, 3>> GetBalancePlan(
       const std::vector<int> &batch_size_per_device);
 
+  // Balance the tokens, the elements of the last LoD level, of the instances
+  // instead of the number of them, for the sequences of variable lengths.
+  void BalanceByTokens(const std::vector<std::vector<LoDTensor *>> &tensors);
+
   const std::vector<Scope *> local_scopes_;
   const std::vector<platform::Place> places_;
+  bool balance_by_tokens_;
 };
 
 }  // namespace details
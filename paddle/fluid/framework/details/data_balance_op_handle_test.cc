@@ -0,0 +1,59 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/data_balance_op_handle.h"
+
+#include <array>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+using Pieces = std::vector<std::array<int, 3>>;
+
+TEST(DataBalanceOpHandle, TokenBalancePlan) {
+  // the long sequences on the first device are moved to the others
+  auto plan = DataBalanceOpHandle::GetTokenBalancePlan(
+      {{10, 10, 10, 10}, {1, 1}, {1, 1}});
+  ASSERT_EQ(plan.size(), 3UL);
+  EXPECT_EQ(plan[0], Pieces({{{0, 0, 1}}, {{0, 3, 4}}}));
+  EXPECT_EQ(plan[1], Pieces({{{1, 0, 2}}, {{0, 1, 2}}}));
+  EXPECT_EQ(plan[2], Pieces({{{2, 0, 2}}, {{0, 2, 3}}}));
+
+  // the same tokens in different numbers of the sequences
+  EXPECT_TRUE(DataBalanceOpHandle::GetTokenBalancePlan({{3, 3}, {2, 4}})
+                  .empty());
+}
+
+TEST(DataBalanceOpHandle, TokenBalancePlanEmptyDevice) {
+  auto plan = DataBalanceOpHandle::GetTokenBalancePlan({{1, 1, 1, 1}, {}});
+  EXPECT_EQ(plan[0], Pieces({{{0, 0, 2}}}));
+  EXPECT_EQ(plan[1], Pieces({{{0, 2, 4}}}));
+
+  // nothing is left over for the empty device, which takes an instance of
+  // the device having the most ones
+  plan = DataBalanceOpHandle::GetTokenBalancePlan({{30}, {30}, {1, 1}, {}});
+  EXPECT_EQ(plan[2], Pieces({{{2, 0, 1}}}));
+  EXPECT_EQ(plan[3], Pieces({{{2, 1, 2}}}));
+
+  EXPECT_THROW(DataBalanceOpHandle::GetTokenBalancePlan({{1}, {}}),
+               platform::EOFException);
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -19,13 +19,25 @@ namespace framework {
 namespace details {
 
 struct ExecutionStrategy {
-  enum ExecutorType { kDefault = 0, kExperimental = 1 };
+  enum ExecutorType { kDefault = 0, kExperimental = 1, kWorkStealing = 2 };
 
   size_t num_threads_{0};
   bool use_cuda_{true};
   bool allow_op_delay_{false};
   size_t num_iteration_per_drop_scope_{100};
   ExecutorType type_{kDefault};
+  // Only for kExperimental, run the ready operators in the order of their
+  // longest paths to the end of the graph, see FastThreadedSSAGraphExecutor.
+  bool use_priority_scheduling_{false};
+  // Keep the local exec scopes every num_iteration_per_drop_scope_
+  // iterations, only resetting their variables in place, instead of dropping
+  // and creating them again, see ScopeBufferedSSAGraphExecutor.
+  bool recycle_local_scopes_{false};
+  // Copy the fetched tensors into the buffers of the executor without
+  // waiting for them, and return the ones of the last run instead, so the
+  // fetches do not block the run. The first run returns empty tensors, see
+  // DelayedFetchBuffers.
+  bool delay_fetch_{false};
 };
 
 }  //  namespace details
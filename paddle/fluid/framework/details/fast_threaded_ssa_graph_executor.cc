@@ -12,7 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include "paddle/fluid/framework/details/fast_threaded_ssa_graph_executor.h"
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <string>
+#include <unordered_set>
 #include <vector>
 #include "paddle/fluid/framework/details/fetch_op_handle.h"
 #include "paddle/fluid/framework/details/multi_devices_helper.h"
@@ -21,6 +24,16 @@ namespace paddle {
 namespace framework {
 namespace details {
 
+// The measured op costs are folded into the priorities every this many runs.
+static constexpr size_t kPriorityUpdatePeriod = 10;
+
+static bool IsCommunicationOp(const OpHandleBase *op) {
+  static const std::unordered_set<std::string> kCommOps = {
+      "all_reduce", "fused_all_reduce", "broadcast", "reduce",
+      "fused_broadcast"};
+  return kCommOps.count(op->Name()) != 0;
+}
+
 FastThreadedSSAGraphExecutor::FastThreadedSSAGraphExecutor(
     const ExecutionStrategy &strategy, const std::vector<Scope *> &local_scopes,
     const std::vector<platform::Place> &places,
@@ -31,7 +44,9 @@ FastThreadedSSAGraphExecutor::FastThreadedSSAGraphExecutor(
       graph_(std::move(graph)),
       pool_(strategy.num_threads_ +
             1),  // add one more thread for generate op_deps
-      fetch_ctxs_(places) {
+      fetch_ctxs_(places),
+      delayed_fetch_buffers_(strategy.delay_fetch_ ? new DelayedFetchBuffers
+                                                   : nullptr) {
   auto &ops = graph_->Get<details::GraphOps>("ops");
 
   for (auto &op : ops) {
@@ -42,6 +57,14 @@ FastThreadedSSAGraphExecutor::FastThreadedSSAGraphExecutor(
     }
   }
 
+  if (strategy_.use_priority_scheduling_) {
+    for (auto &op : ops) {
+      op_costs_[op.get()] = 1.0;
+      op_run_time_[op.get()] = 0.0;
+    }
+    UpdatePriorities();
+  }
+
   PrepareAtomicOpDeps();
 }
 
@@ -76,7 +99,8 @@ FeedFetchList FastThreadedSSAGraphExecutor::Run(
 
     ir::Node *fetch_node =
         graph_->CreateEmptyNode("fetch", ir::Node::Type::kOperation);
-    auto *op = new FetchOpHandle(fetch_node, &fetches, i, &local_scopes_);
+    auto *op = new FetchOpHandle(fetch_node, &fetches, i, &local_scopes_,
+                                 delayed_fetch_buffers_.get());
     fetch_ops.emplace_back(op);
 
     for (auto &p : places_) {
@@ -93,8 +117,13 @@ FeedFetchList FastThreadedSSAGraphExecutor::Run(
   size_t num_complete = 0;
   remaining_ = 0;
   auto complete_q = std::make_shared<BlockingQueue<size_t>>();
-  for (auto op : bootstrap_ops_) {
-    RunOpAsync(op_deps.get(), op, complete_q);
+  if (strategy_.use_priority_scheduling_) {
+    ready_ops_ = std::priority_queue<PrioritizedOp>();
+    RunReadyOpsAsync(op_deps.get(), bootstrap_ops_, complete_q);
+  } else {
+    for (auto op : bootstrap_ops_) {
+      RunOpAsync(op_deps.get(), op, complete_q);
+    }
   }
 
   while (num_complete != op_deps->size()) {
@@ -116,6 +145,12 @@ FeedFetchList FastThreadedSSAGraphExecutor::Run(
   }
   // Wait FetchOps.
   ClearFetchOp(graph_.get(), &fetch_ops);
+  if (strategy_.use_priority_scheduling_) {
+    ++num_runs_;
+    if (num_runs_ == 1 || num_runs_ % kPriorityUpdatePeriod == 0) {
+      UpdatePriorities();
+    }
+  }
   return fetches;
 }
 void FastThreadedSSAGraphExecutor::RunOpAsync(
@@ -155,6 +190,130 @@ void FastThreadedSSAGraphExecutor::RunOpAsync(
     complete_q->Push(complete);
   });
 }
+void FastThreadedSSAGraphExecutor::RunReadyOpsAsync(
+    std::unordered_map<OpHandleBase *, std::atomic<int>> *op_deps,
+    const std::vector<OpHandleBase *> &ops,
+    const std::shared_ptr<BlockingQueue<size_t>> &complete_q) {
+  {
+    std::lock_guard<std::mutex> lock(ready_ops_mutex_);
+    for (auto *op : ops) {
+      auto it = op_priorities_.find(op);
+      ready_ops_.emplace(it == op_priorities_.end() ? 0 : it->second, op);
+    }
+  }
+  // Every task runs the ready operator of the highest priority in turn,
+  // until there is no one left.
+  for (size_t i = 0; i < ops.size(); ++i) {
+    ++remaining_;
+    this->pool_.enqueue([=] { RunReadyOps(op_deps, complete_q); });
+  }
+}
+
+void FastThreadedSSAGraphExecutor::RunReadyOps(
+    std::unordered_map<OpHandleBase *, std::atomic<int>> *op_deps,
+    const std::shared_ptr<BlockingQueue<size_t>> &complete_q) {
+  size_t complete = 0;
+  std::vector<OpHandleBase *> ready;
+  while (true) {
+    OpHandleBase *op_to_run = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(ready_ops_mutex_);
+      if (ready_ops_.empty()) break;
+      op_to_run = ready_ops_.top().second;
+      ready_ops_.pop();
+    }
+    try {
+      auto start = std::chrono::steady_clock::now();
+      op_to_run->Run(strategy_.use_cuda_);
+      auto it = op_run_time_.find(op_to_run);
+      if (it != op_run_time_.end()) {
+        it->second = std::chrono::duration<double, std::micro>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+      }
+      ++complete;
+    } catch (...) {
+      exception_.Catch(std::current_exception());
+      --remaining_;
+      complete_q->Push(-1UL);
+      return;
+    }
+
+    ready.clear();
+    for (auto &output : op_to_run->Outputs()) {
+      for (auto &pending_op : output->PendingOps()) {
+        std::atomic<int> &deps = op_deps->at(pending_op);
+        if (deps.fetch_sub(1) == 1) {  // pending_op ready
+          ready.emplace_back(pending_op);
+        }
+      }
+    }
+    if (ready.empty()) continue;
+    // This task goes on with one of them.
+    {
+      std::lock_guard<std::mutex> lock(ready_ops_mutex_);
+      for (auto *op : ready) {
+        auto it = op_priorities_.find(op);
+        ready_ops_.emplace(it == op_priorities_.end() ? 0 : it->second, op);
+      }
+    }
+    for (size_t i = 1; i < ready.size(); ++i) {
+      ++remaining_;
+      this->pool_.enqueue([=] { RunReadyOps(op_deps, complete_q); });
+    }
+  }
+  --remaining_;
+  complete_q->Push(complete);
+}
+
+void FastThreadedSSAGraphExecutor::UpdatePriorities() {
+  if (num_runs_ > 0) {
+    for (auto &item : op_run_time_) {
+      double &cost = op_costs_[item.first];
+      cost = num_runs_ == 1 ? item.second : 0.9 * cost + 0.1 * item.second;
+    }
+  }
+
+  // Visit the operators in the reverse topological order.
+  std::unordered_map<OpHandleBase *, int> deps = op_deps_;
+  std::vector<OpHandleBase *> sorted_ops(bootstrap_ops_);
+  for (size_t i = 0; i < sorted_ops.size(); ++i) {
+    for (auto &output : sorted_ops[i]->Outputs()) {
+      for (auto &pending_op : output->PendingOps()) {
+        auto it = deps.find(pending_op);
+        if (it != deps.end() && --it->second == 0) {
+          sorted_ops.emplace_back(pending_op);
+        }
+      }
+    }
+  }
+
+  double total_cost = 0;
+  double critical_path_cost = 0;
+  std::unordered_map<OpHandleBase *, double> path_costs;
+  for (auto it = sorted_ops.rbegin(); it != sorted_ops.rend(); ++it) {
+    double longest = 0;
+    for (auto &output : (*it)->Outputs()) {
+      for (auto &pending_op : output->PendingOps()) {
+        auto path_it = path_costs.find(pending_op);
+        if (path_it != path_costs.end()) {
+          longest = std::max(longest, path_it->second);
+        }
+      }
+    }
+    double cost = op_costs_[*it];
+    path_costs[*it] = longest + cost;
+    total_cost += cost;
+    critical_path_cost = std::max(critical_path_cost, longest + cost);
+  }
+
+  for (auto &item : path_costs) {
+    op_priorities_[item.first] =
+        item.second + (IsCommunicationOp(item.first) ? total_cost : 0);
+  }
+  VLOG(3) << "The critical path of the graph costs " << critical_path_cost;
+}
+
 void FastThreadedSSAGraphExecutor::PrepareAtomicOpDeps() {
   atomic_op_deps_ = pool_.enqueue([&] {
     auto *op_deps = new std::unordered_map<OpHandleBase *, std::atomic<int>>;
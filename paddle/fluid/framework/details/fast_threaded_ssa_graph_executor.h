@@ -13,12 +13,17 @@
 // limitations under the License.
 
 #pragma once
+#include <memory>
+#include <mutex>  // NOLINT
+#include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 #include "ThreadPool.h"
 #include "paddle/fluid/framework/blocking_queue.h"
 #include "paddle/fluid/framework/details/exception_holder.h"
 #include "paddle/fluid/framework/details/execution_strategy.h"
+#include "paddle/fluid/framework/details/fetch_op_handle.h"
 #include "paddle/fluid/framework/details/ssa_graph_executor.h"
 
 namespace paddle {
@@ -47,6 +52,8 @@ class FastThreadedSSAGraphExecutor : public SSAGraphExecutor {
 
   ::ThreadPool pool_;
   platform::DeviceContextPool fetch_ctxs_;
+  // Only if strategy_.delay_fetch_.
+  std::unique_ptr<DelayedFetchBuffers> delayed_fetch_buffers_;
   std::atomic<int> remaining_;
 
   void RunOpAsync(std::unordered_map<OpHandleBase *, std::atomic<int>> *op_deps,
@@ -55,6 +62,28 @@ class FastThreadedSSAGraphExecutor : public SSAGraphExecutor {
 
   void PrepareAtomicOpDeps();
 
+  // Priority scheduling. The priority of an operator is the cost of the
+  // longest path from it to the end of the graph, where the cost of an
+  // operator is its measured run time, or 1 before it is measured. The
+  // communication operators are put before all the others, so that they
+  // overlap with the computation.
+  void RunReadyOpsAsync(
+      std::unordered_map<OpHandleBase *, std::atomic<int>> *op_deps,
+      const std::vector<OpHandleBase *> &ops,
+      const std::shared_ptr<BlockingQueue<size_t>> &complete_q);
+  void RunReadyOps(
+      std::unordered_map<OpHandleBase *, std::atomic<int>> *op_deps,
+      const std::shared_ptr<BlockingQueue<size_t>> &complete_q);
+  void UpdatePriorities();
+
+  using PrioritizedOp = std::pair<double, OpHandleBase *>;
+  std::priority_queue<PrioritizedOp> ready_ops_;
+  std::mutex ready_ops_mutex_;
+  std::unordered_map<OpHandleBase *, double> op_priorities_;
+  std::unordered_map<OpHandleBase *, double> op_costs_;     // in microseconds
+  std::unordered_map<OpHandleBase *, double> op_run_time_;  // of the last run
+  size_t num_runs_{0};
+
   std::future<
       std::unique_ptr<std::unordered_map<OpHandleBase *, std::atomic<int>>>>
       atomic_op_deps_;
@@ -17,16 +17,43 @@
 #include <string>
 #include <vector>
 
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/memory/memcpy.h"
+
 namespace paddle {
 namespace framework {
 namespace details {
 
+DelayedFetchBuffers::~DelayedFetchBuffers() {
+#ifdef PADDLE_WITH_CUDA
+  for (auto &item : buffers_) {
+    for (auto event : item.second->events) {
+      if (event == nullptr) continue;
+      // The copies of the last run may be in flight.
+      cudaEventSynchronize(event);
+      cudaEventDestroy(event);
+    }
+  }
+#endif
+}
+
+DelayedFetchBuffers::Buffer *DelayedFetchBuffers::Get(size_t offset,
+                                                      const std::string &name,
+                                                      size_t scope_idx) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto &buffer = buffers_[std::make_tuple(offset, name, scope_idx)];
+  if (buffer == nullptr) buffer.reset(new Buffer);
+  return buffer.get();
+}
+
 FetchOpHandle::FetchOpHandle(ir::Node *node, FeedFetchList *data, size_t offset,
-                             std::vector<Scope *> *local_scopes)
+                             std::vector<Scope *> *local_scopes,
+                             DelayedFetchBuffers *delayed_buffers)
     : OpHandleBase(node),
       data_(data),
       offset_(offset),
-      local_scopes_(local_scopes) {}
+      local_scopes_(local_scopes),
+      delayed_buffers_(delayed_buffers) {}
 
 FetchOpHandle::~FetchOpHandle() {
   for (auto *input_var : inputs_) {
@@ -47,26 +74,32 @@ void FetchOpHandle::WaitAndMergeCPUTensors() const {
   data_->at(offset_).MergeLoDTensor(tensors_ptr, platform::CPUPlace());
 }
 
+const LoDTensor &FetchOpHandle::FetchedTensor(size_t i) const {
+  auto *var_handle = static_cast<VarHandle *>(inputs_[i]);
+  auto &scope = local_scopes_->at(var_handle->scope_idx_);
+  auto *var = scope->FindVar(kLocalExecScopeName)
+                  ->Get<Scope *>()
+                  ->FindVar(var_handle->name_);
+  PADDLE_ENFORCE_NOT_NULL(var, "Cannot find variable %s in execution scope",
+                          var_handle->name_);
+  return var->Get<framework::LoDTensor>();
+}
+
 void FetchOpHandle::RunImpl() {
+  if (delayed_buffers_ != nullptr) {
+    RunDelayed();
+    return;
+  }
   WaitInputVarGenerated(platform::CPUPlace());
 
   tensors_.resize(inputs_.size());
   platform::CPUPlace cpu;
-  auto &scopes = *local_scopes_;
 
   for (size_t i = 0; i < inputs_.size(); ++i) {
-    auto *var_handle = static_cast<VarHandle *>(inputs_[i]);
-    auto &scope = scopes.at(var_handle->scope_idx_);
-    auto *var = scope->FindVar(kLocalExecScopeName)
-                    ->Get<Scope *>()
-                    ->FindVar(var_handle->name_);
-    PADDLE_ENFORCE_NOT_NULL(var, "Cannot find variable %s in execution scope",
-                            var_handle->name_);
-
-    auto &t = var->Get<framework::LoDTensor>();
+    auto &t = FetchedTensor(i);
     if (platform::is_gpu_place(t.place())) {
 #ifdef PADDLE_WITH_CUDA
-      TensorCopySync(t, cpu, &tensors_[i]);
+      TensorCopyOnCopyStream(t, cpu, &tensors_[i]);
 #endif
     } else {
       tensors_[i].ShareDataWith(t);
@@ -77,6 +110,62 @@ void FetchOpHandle::RunImpl() {
   this->WaitAndMergeCPUTensors();
 }
 
+void FetchOpHandle::RunDelayed() {
+  auto &pool = platform::DeviceContextPool::Instance();
+  std::vector<const LoDTensor *> last_tensors;
+  for (size_t i = 0; i < inputs_.size(); ++i) {
+    auto *var_handle = static_cast<VarHandle *>(inputs_[i]);
+    auto &t = FetchedTensor(i);
+    auto *buffer = delayed_buffers_->Get(offset_, var_handle->name_,
+                                         var_handle->scope_idx_);
+    buffer->current ^= 1;
+    auto &dst = buffer->tensors[buffer->current];
+    auto *ctx = pool.Get(t.place());
+    if (var_handle->GeneratedOp()) {
+      var_handle->GeneratedOp()->RecordWaitEventOnCtx(ctx);
+    }
+    if (platform::is_gpu_place(t.place())) {
+#ifdef PADDLE_WITH_CUDA
+      auto *gpu_ctx = static_cast<platform::CUDADeviceContext *>(ctx);
+      dst.Resize(t.dims());
+      dst.set_layout(t.layout());
+      auto *dst_ptr = dst.mutable_data(platform::CUDAPinnedPlace(), t.type());
+      gpu_ctx->CopyStreamWaitCompute();
+      memory::Copy(platform::CUDAPinnedPlace(), dst_ptr,
+                   boost::get<platform::CUDAPlace>(t.place()), t.data<void>(),
+                   t.numel() * SizeOfType(t.type()), gpu_ctx->copy_stream());
+      auto &event = buffer->events[buffer->current];
+      if (event == nullptr) {
+        PADDLE_ENFORCE(
+            cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+      }
+      PADDLE_ENFORCE(cudaEventRecord(event, gpu_ctx->copy_stream()));
+      // The kernels writing the tensor from now on wait for the copy.
+      gpu_ctx->ComputeWaitCopyStream();
+#endif
+    } else {
+      TensorCopySync(t, platform::CPUPlace(), &dst);
+    }
+    dst.set_lod(t.lod());
+
+    int last = buffer->current ^ 1;
+#ifdef PADDLE_WITH_CUDA
+    if (buffer->events[last] != nullptr) {
+      PADDLE_ENFORCE(cudaEventSynchronize(buffer->events[last]));
+    }
+#endif
+    if (buffer->tensors[last].IsInitialized()) {
+      last_tensors.emplace_back(&buffer->tensors[last]);
+    }
+  }
+  // Nothing is fetched by the last run, e.g. for the first run.
+  if (last_tensors.size() < inputs_.size()) {
+    data_->at(offset_) = LoDTensor();
+    return;
+  }
+  data_->at(offset_).MergeLoDTensor(last_tensors, platform::CPUPlace());
+}
+
 void FetchOpHandle::WaitInputVarGenerated(const platform::Place &place) {
   auto cpu_ctx = platform::DeviceContextPool::Instance().Get(place);
   for (auto *input : inputs_) {
@@ -14,7 +14,11 @@
 
 #pragma once
 
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "paddle/fluid/framework/details/op_handle_base.h"
@@ -26,10 +30,40 @@ namespace paddle {
 namespace framework {
 namespace details {
 
+/*
+ * The buffers that the delayed fetches copy the tensors into, kept by an
+ * executor across its runs. Each fetched tensor has two of them, the one
+ * copied by this run without waiting, in the pinned memory for the GPU
+ * tensors, and the one copied by the last run, which is returned.
+ */
+class DelayedFetchBuffers {
+ public:
+  struct Buffer {
+    LoDTensor tensors[2];
+    // The one copied by this run.
+    int current{0};
+#ifdef PADDLE_WITH_CUDA
+    cudaEvent_t events[2]{nullptr, nullptr};
+#endif
+  };
+
+  ~DelayedFetchBuffers();
+
+  // The buffer of the tensor of the scope scope_idx, fetched at offset.
+  Buffer *Get(size_t offset, const std::string &name, size_t scope_idx);
+
+ private:
+  std::mutex mutex_;
+  std::map<std::tuple<size_t, std::string, size_t>, std::unique_ptr<Buffer>>
+      buffers_;
+};
+
 struct FetchOpHandle : public OpHandleBase {
  public:
+  // The fetches are delayed by a run if delayed_buffers is not nullptr.
   FetchOpHandle(ir::Node *node, FeedFetchList *data, size_t offset,
-                std::vector<Scope *> *local_scopes);
+                std::vector<Scope *> *local_scopes,
+                DelayedFetchBuffers *delayed_buffers = nullptr);
 
   ~FetchOpHandle();
 
@@ -45,10 +79,16 @@ struct FetchOpHandle : public OpHandleBase {
   void WaitInputVarGenerated(const platform::Place &place) override;
 
  private:
+  const LoDTensor &FetchedTensor(size_t i) const;
+
+  // Copy the tensors into the buffers and merge the ones of the last run.
+  void RunDelayed();
+
   FeedFetchList *data_;
   size_t offset_;
   std::vector<Scope *> *local_scopes_;
   std::vector<LoDTensor> tensors_;
+  DelayedFetchBuffers *delayed_buffers_;
 };
 
 }  // namespace details
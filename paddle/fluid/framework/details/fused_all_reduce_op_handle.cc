@@ -0,0 +1,154 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <algorithm>
+
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/details/all_reduce_op_handle.h"
+#include "paddle/fluid/framework/details/container_cast.h"
+#include "paddle/fluid/framework/details/fused_all_reduce_op_handle.h"
+#include "paddle/fluid/framework/details/reduce_and_gather.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/platform/profiler.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+#ifdef PADDLE_WITH_CUDA
+FusedAllReduceOpHandle::FusedAllReduceOpHandle(
+    ir::Node *node, const std::vector<Scope *> &local_scopes,
+    const std::vector<platform::Place> &places, size_t num_of_all_reduce,
+    const platform::NCCLContextMap *ctxs, bool use_hierarchical)
+    : OpHandleBase(node),
+      local_scopes_(local_scopes),
+      places_(places),
+      num_of_all_reduce_(num_of_all_reduce),
+      nccl_ctxs_(ctxs),
+      use_hierarchical_(use_hierarchical),
+      fused_buffers_(places.size()) {
+  if (nccl_ctxs_) {
+    for (auto &p : places_) {
+      this->SetDeviceContext(p, nccl_ctxs_->DevCtx(p));
+    }
+  }
+}
+#else
+FusedAllReduceOpHandle::FusedAllReduceOpHandle(
+    ir::Node *node, const std::vector<Scope *> &local_scopes,
+    const std::vector<platform::Place> &places, size_t num_of_all_reduce)
+    : OpHandleBase(node),
+      local_scopes_(local_scopes),
+      places_(places),
+      num_of_all_reduce_(num_of_all_reduce) {}
+#endif
+
+void FusedAllReduceOpHandle::RunImpl() {
+  platform::RecordEvent record_event(Name(), dev_ctxes_.cbegin()->second);
+
+  if (places_.size() == 1) {
+    return;  // No need to all reduce when GPU count = 1;
+  }
+  // Wait input done
+  WaitInputVarGenerated();
+  auto in_var_handles = DynamicCast<VarHandle>(this->Inputs());
+  auto out_var_handles = DynamicCast<VarHandle>(this->Outputs());
+  size_t num_places = places_.size();
+  PADDLE_ENFORCE_EQ(in_var_handles.size(), num_of_all_reduce_ * num_places,
+                    "The NoDummyInputSize should be equal to the number of "
+                    "gradients times the number of places.");
+  PADDLE_ENFORCE_EQ(
+      in_var_handles.size(), out_var_handles.size(),
+      "The NoDummyInputSize and NoDummyOutputSize should be equal.");
+
+  // lod_tensors[i][j] is the gradient i of place j.
+  std::vector<std::vector<LoDTensor *>> lod_tensors(num_of_all_reduce_);
+  for (size_t i = 0; i < num_of_all_reduce_; ++i) {
+    for (size_t j = 0; j < num_places; ++j) {
+      auto *in = in_var_handles[i * num_places + j];
+      auto *out = out_var_handles[i * num_places + j];
+      PADDLE_ENFORCE_EQ(in->scope_idx_, j,
+                        "The inputs should be ordered by the places.");
+      PADDLE_ENFORCE_EQ(in->name_, out->name_,
+                        "The name of input and output should be equal.");
+      auto &local_scope =
+          *local_scopes_[j]->FindVar(kLocalExecScopeName)->Get<Scope *>();
+      lod_tensors[i].emplace_back(
+          local_scope.FindVar(in->name_)->GetMutable<LoDTensor>());
+    }
+    PADDLE_ENFORCE(lod_tensors[i][0]->type() == lod_tensors[0][0]->type(),
+                   "The gradients fused together should have the same type.");
+  }
+
+  if (platform::is_gpu_place(lod_tensors[0][0]->place())) {
+#ifdef PADDLE_WITH_CUDA
+    PADDLE_ENFORCE(nccl_ctxs_, "nccl_ctxs should not be nullptr.");
+    auto type = lod_tensors[0][0]->type();
+    size_t size_of_type = SizeOfType(type);
+    int64_t numel = 0;
+    for (size_t i = 0; i < num_of_all_reduce_; ++i) {
+      numel += lod_tensors[i][0]->numel();
+    }
+
+    // Gather the gradients into the buffer of each place, all reduce the
+    // buffers, then scatter them back. Everything is issued on the stream of
+    // the NCCL context, so no extra synchronization is needed.
+    this->RunAndRecordEvent([&] {
+      std::vector<void *> buffers(num_places);
+      for (size_t j = 0; j < num_places; ++j) {
+        auto p = boost::get<platform::CUDAPlace>(places_[j]);
+        auto stream = nccl_ctxs_->at(p.device).stream();
+        auto &fused = fused_buffers_[j];
+        fused.Resize({numel});
+        auto *dst = reinterpret_cast<uint8_t *>(
+            fused.mutable_data(places_[j], type));
+        for (size_t i = 0; i < num_of_all_reduce_; ++i) {
+          auto &grad = *lod_tensors[i][j];
+          size_t bytes = grad.numel() * size_of_type;
+          memory::Copy(p, dst, p, grad.data<void>(), bytes, stream);
+          dst += bytes;
+        }
+        buffers[j] = fused.data<void>();
+      }
+      NCCLAllReduceBuffers(*nccl_ctxs_, places_, buffers,
+                           static_cast<size_t>(numel), type,
+                           use_hierarchical_);
+      for (size_t j = 0; j < num_places; ++j) {
+        auto p = boost::get<platform::CUDAPlace>(places_[j]);
+        auto stream = nccl_ctxs_->at(p.device).stream();
+        auto *src = reinterpret_cast<const uint8_t *>(buffers[j]);
+        for (size_t i = 0; i < num_of_all_reduce_; ++i) {
+          auto &grad = *lod_tensors[i][j];
+          size_t bytes = grad.numel() * size_of_type;
+          memory::Copy(p, grad.mutable_data(places_[j], type), p, src, bytes,
+                       stream);
+          src += bytes;
+        }
+      }
+    });
+#else
+    PADDLE_THROW("Not compiled with CUDA");
+#endif
+  } else {  // Special handle CPU only Operator's gradient. Like CRF
+    this->RunAndRecordEvent([&] {
+      for (size_t i = 0; i < num_of_all_reduce_; ++i) {
+        CPUAllReduceInPlace(lod_tensors[i]);
+      }
+    });
+  }
+}
+
+std::string FusedAllReduceOpHandle::Name() const { return "fused_all_reduce"; }
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
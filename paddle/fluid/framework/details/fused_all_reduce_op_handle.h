@@ -0,0 +1,71 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/details/op_handle_base.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/scope.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/platform/nccl_helper.h"
+#endif
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+// All-reduce a bucket of dense gradients of the same data type together.
+// On GPU, the gradients of every device are copied into one contiguous
+// buffer, which is reduced by a single ncclAllReduce and then copied back
+// to the gradients. The inputs and outputs are the gradients of every
+// place, the gradient i of place j is at i * num_places + j.
+struct FusedAllReduceOpHandle : public OpHandleBase {
+#ifdef PADDLE_WITH_CUDA
+  FusedAllReduceOpHandle(ir::Node *node,
+                         const std::vector<Scope *> &local_scopes,
+                         const std::vector<platform::Place> &places,
+                         size_t num_of_all_reduce,
+                         const platform::NCCLContextMap *ctxs,
+                         bool use_hierarchical = false);
+#else
+  FusedAllReduceOpHandle(ir::Node *node,
+                         const std::vector<Scope *> &local_scopes,
+                         const std::vector<platform::Place> &places,
+                         size_t num_of_all_reduce);
+#endif
+  std::string Name() const override;
+
+  bool IsMultiDeviceTransfer() override { return true; };
+
+ protected:
+  void RunImpl() override;
+
+ private:
+  std::vector<Scope *> local_scopes_;
+  std::vector<platform::Place> places_;
+  size_t num_of_all_reduce_;
+#ifdef PADDLE_WITH_CUDA
+  const platform::NCCLContextMap *nccl_ctxs_;
+  bool use_hierarchical_;
+  // The contiguous buffer of each place, kept between the runs.
+  std::vector<Tensor> fused_buffers_;
+#endif
+};
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
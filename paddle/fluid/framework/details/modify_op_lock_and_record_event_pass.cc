@@ -26,7 +26,10 @@ static bool IsLockAndRecordEventFreeComputationOpHandle(
   if (!platform::is_gpu_place(op->GetPlace())) return false;
   for (auto &pending_op : graph_view.PendingOps(op)) {
     auto *tmp = dynamic_cast<ComputationOpHandle *>(pending_op);
-    if (tmp == nullptr || !(tmp->GetPlace() == op->GetPlace())) {
+    // The pending ops on other streams wait for the event of op.
+    if (tmp == nullptr || !(tmp->GetPlace() == op->GetPlace()) ||
+        tmp->DeviceContext(op->GetPlace()) !=
+            op->DeviceContext(op->GetPlace())) {
       return false;
     }
   }
@@ -13,14 +13,18 @@
 // limitations under the License.
 #include <algorithm>
 #include <fstream>
+#include <map>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/details/all_reduce_op_handle.h"
 #include "paddle/fluid/framework/details/broadcast_op_handle.h"
 #include "paddle/fluid/framework/details/computation_op_handle.h"
 #include "paddle/fluid/framework/details/data_balance_op_handle.h"
+#include "paddle/fluid/framework/details/fused_all_reduce_op_handle.h"
 #include "paddle/fluid/framework/details/fused_broadcast_op_handle.h"
 #include "paddle/fluid/framework/details/multi_devices_graph_pass.h"
 #include "paddle/fluid/framework/details/reduce_op_handle.h"
@@ -34,93 +38,6 @@
 namespace paddle {
 namespace framework {
 namespace details {
-namespace {
-void PolishGraphToSupportDataHazards(ir::Graph *graph) {
-  for (auto &var_map : graph->Get<GraphVars>(kGraphVars)) {
-    for (auto &name_pair : var_map) {
-      if (name_pair.second.size() <= 1) {
-        continue;
-      }
-      auto it_new = name_pair.second.rbegin();
-      auto it_old = name_pair.second.rbegin();
-      ++it_old;
-      for (; it_old != name_pair.second.rend(); it_new = it_old, ++it_old) {
-        OpHandleBase *write_op = (*it_new)->GeneratedOp();
-        const auto &read_ops = (*it_old)->PendingOps();
-
-        for (auto *read_op : read_ops) {
-          // Manually add a dependency var from read_op to write_op;
-          if (read_op == write_op) {
-            // Read Write is the same op.
-            continue;
-          }
-          bool has_dep = false;
-          for (auto *r_out : read_op->Outputs()) {
-            for (auto *w_in : write_op->Inputs()) {
-              if (r_out->Node() == w_in->Node()) {
-                has_dep = true;
-                break;
-              }
-            }
-          }
-          if (has_dep) continue;
-
-          auto *dep_var = new DummyVarHandle(graph->CreateControlDepVar());
-          read_op->AddOutput(dep_var);
-          write_op->AddInput(dep_var);
-          graph->Get<GraphDepVars>(kGraphDepVars).emplace(dep_var);
-        }
-      }
-    }
-  }
-}
-
-VarHandle *CreateOrGetLatestVarHandle(ir::Graph *graph, ir::Node *node,
-                                      const platform::Place &place,
-                                      size_t place_offset) {
-  auto &var_holders = graph->Get<GraphVars>(kGraphVars)[place_offset];
-  auto &var_holder = var_holders[node->Name()];
-  VarHandle *var = nullptr;
-  if (var_holder.empty()) {
-    if (node->Var()) {
-      var = new VarHandle(graph->CreateVarNode(node->Var()), 0, place_offset,
-                          node->Name(), place);
-    } else {
-      var = new VarHandle(
-          graph->CreateEmptyNode(node->Name(), ir::Node::Type::kVariable), 0,
-          place_offset, node->Name(), place);
-    }
-    var_holder.emplace_back(var);
-  } else {
-    var = var_holder.rbegin()->get();
-  }
-  return var;
-}
-
-void CreateOpOutput(ir::Graph *graph, OpHandleBase *op_handle,
-                    ir::Node *new_node, const platform::Place &place,
-                    size_t place_offset) {
-  auto &vars =
-      graph->Get<GraphVars>(kGraphVars)[place_offset][new_node->Name()];
-  size_t version = vars.size();
-  auto var =
-      new VarHandle(new_node, version, place_offset, new_node->Name(), place);
-  vars.emplace_back(var);
-  op_handle->AddOutput(var);
-}
-
-void AddOutputToLeafOps(ir::Graph *graph) {
-  for (auto &op : graph->Get<GraphOps>(kGraphOps)) {
-    if (!op->Outputs().empty()) {
-      continue;
-    }
-    auto *dummy_leaf = new DummyVarHandle(graph->CreateControlDepVar());
-    graph->Get<GraphDepVars>(kGraphDepVars).emplace(dummy_leaf);
-    op->AddOutput(dummy_leaf);
-  }
-}
-}  // namespace
-
 static const char kLossVarName[] = "loss_var_name";
 static const char kPlaces[] = "places";
 static const char kParams[] = "params";
@@ -304,6 +221,7 @@ std::unique_ptr<ir::Graph> MultiDevSSAGraphBuilder::ApplyImpl(
   result.Set(kGraphDepVars, new GraphDepVars);
   result.Set(kGraphOps, new GraphOps);
   result.Set(kShardedVarDevice, new ShardedVarDevice);
+  result.Set(kDeferredBroadcastVars, new ShardedVarDevice);
 
   // find send/recv vars so that we can place the distributed training
   // related op in the place 0
@@ -317,7 +235,47 @@ std::unique_ptr<ir::Graph> MultiDevSSAGraphBuilder::ApplyImpl(
   bool is_forwarding = true;
   bool is_dist_train = false;
 
+  // The dense gradients waiting to be all reduced together, grouped by the
+  // data type. A bucket is flushed when it is big enough, or before any
+  // operator touches one of the gradients in it.
+  std::map<proto::VarType::Type, std::pair<std::vector<std::string>, size_t>>
+      all_reduce_buckets;
+  std::unordered_set<std::string> grads_in_buckets;
+  auto flush_all_reduce_buckets = [&] {
+    for (auto &bucket : all_reduce_buckets) {
+      InsertFusedAllReduceOp(&result, bucket.second.first);
+    }
+    all_reduce_buckets.clear();
+    grads_in_buckets.clear();
+  };
+  auto add_to_all_reduce_bucket = [&](const std::string &og) {
+    auto *var_desc = all_vars_.at(og);
+    auto dtype = var_desc->GetDataType();
+    auto &bucket = all_reduce_buckets[dtype];
+    bucket.first.emplace_back(og);
+    bucket.second += GetGradientMemorySize(*var_desc);
+    grads_in_buckets.emplace(og);
+    if (bucket.second >= strategy_.fuse_all_reduce_bucket_size_) {
+      InsertFusedAllReduceOp(&result, bucket.first);
+      for (auto &name : bucket.first) {
+        grads_in_buckets.erase(name);
+      }
+      all_reduce_buckets.erase(dtype);
+    }
+  };
+  auto touch_bucketed_grads = [&](ir::Node *node) {
+    for (auto *vars : {&node->inputs, &node->outputs}) {
+      for (ir::Node *n : *vars) {
+        if (grads_in_buckets.count(n->Name())) return true;
+      }
+    }
+    return false;
+  };
+
   for (ir::Node *node : sorted_ops) {
+    if (!grads_in_buckets.empty() && touch_bucketed_grads(node)) {
+      flush_all_reduce_buckets();
+    }
     if (boost::get<int>(
             node->Op()->GetAttr(OpProtoAndCheckerMaker::OpRoleAttrName())) ==
         static_cast<int>(OpRole::kRPC)) {
@@ -330,7 +288,13 @@ std::unique_ptr<ir::Graph> MultiDevSSAGraphBuilder::ApplyImpl(
                 OpProtoAndCheckerMaker::OpRoleVarAttrName()));
         PADDLE_ENFORCE(recv_vars_attr.size() == 2UL);  // [parameter, gradient]
         if (recv_vars_attr[0].find(".block") == std::string::npos) {
-          bcast_var_name_set[op_dev_id].emplace(recv_vars_attr[0]);
+          // The parameters received before the forward ops are broadcast
+          // right away, so that each forward op only waits for its own.
+          if (is_forwarding) {
+            CreateBroadcastOp(&result, recv_vars_attr[0], op_dev_id);
+          } else {
+            bcast_var_name_set[op_dev_id].emplace(recv_vars_attr[0]);
+          }
         }
       }
       is_dist_train = true;
@@ -340,7 +304,11 @@ std::unique_ptr<ir::Graph> MultiDevSSAGraphBuilder::ApplyImpl(
       int op_dev_id = CreateDistTrainOp(&result, node);
       if (node->Op()->Type() == "concat") {
         auto origin_param_name = node->Op()->OutputArgumentNames()[0];
-        bcast_var_name_set[op_dev_id].emplace(origin_param_name);
+        if (is_forwarding) {
+          CreateBroadcastOp(&result, origin_param_name, op_dev_id);
+        } else {
+          bcast_var_name_set[op_dev_id].emplace(origin_param_name);
+        }
       }
     } else if (IsScaleLossOp(node)) {
       // user can customize loss@grad if not use_default_grad_scale_
@@ -376,6 +344,14 @@ std::unique_ptr<ir::Graph> MultiDevSSAGraphBuilder::ApplyImpl(
           CreateComputationalOps(&result, node, places_.size());
         }
 
+        // The batch statistics of AUC are summed over the devices, so the
+        // auc operators on every device update the same global statistics.
+        if (node->Op()->Type() == "auc_stat" && places_.size() > 1) {
+          for (auto &stat_name : node->Op()->OutputArgumentNames()) {
+            InsertAllReduceOp(&result, stat_name);
+          }
+        }
+
         if (!is_forwarding && places_.size() > 1) {
           // Currently, we assume that once gradient is generated, it can be
           // broadcast, and each gradient is only broadcast once.
@@ -408,6 +384,8 @@ std::unique_ptr<ir::Graph> MultiDevSSAGraphBuilder::ApplyImpl(
                     if (IsSparseGradient(g_name)) {
                       CreateReduceOp(&result, g_name, 0);
                       CreateBroadcastOp(&result, g_name, 0);
+                    } else if (strategy_.fuse_all_reduce_ops_) {
+                      add_to_all_reduce_bucket(g_name);
                     } else {
                       InsertAllReduceOp(&result, g_name);
                     }
@@ -424,6 +402,8 @@ std::unique_ptr<ir::Graph> MultiDevSSAGraphBuilder::ApplyImpl(
       }
     }
   }
+  flush_all_reduce_buckets();
+
   bool use_gpu = false;
 #ifdef PADDLE_WITH_CUDA
   use_gpu = nccl_ctxs_ != nullptr;
@@ -437,7 +417,9 @@ std::unique_ptr<ir::Graph> MultiDevSSAGraphBuilder::ApplyImpl(
   if ((use_gpu &&
        strategy_.reduce_ == BuildStrategy::ReduceStrategy::kReduce) ||
       is_dist_train) {
-    if (strategy_.fuse_broadcast_op_) {
+    if (strategy_.overlap_broadcast_ && !is_dist_train) {
+      CreateDeferredBroadcastOps(&result, sorted_ops, bcast_var_name_set);
+    } else if (strategy_.fuse_broadcast_op_) {
       CreateFusedBroadcastOp(&result, bcast_var_name_set);
     } else {
       for (size_t dev_id = 0; dev_id < bcast_var_name_set.size(); ++dev_id) {
@@ -513,6 +495,83 @@ void MultiDevSSAGraphBuilder::CreateBroadcastOp(ir::Graph *result,
   }
 }
 
+void MultiDevSSAGraphBuilder::CreateDeferredBroadcastOps(
+    ir::Graph *result, const std::vector<ir::Node *> &sorted_ops,
+    const std::vector<std::unordered_set<std::string>> &bcast_varnames) const {
+  // Broadcast the parameters in the order they are first read.
+  std::unordered_map<std::string, size_t> first_read;
+  for (ir::Node *node : sorted_ops) {
+    for (ir::Node *in : node->inputs) {
+      first_read.emplace(in->Name(), first_read.size());
+    }
+  }
+  std::vector<std::tuple<size_t, std::string, size_t>> params;
+  for (size_t dev_id = 0; dev_id < bcast_varnames.size(); ++dev_id) {
+    for (auto &p_name : bcast_varnames[dev_id]) {
+      auto it = first_read.find(p_name);
+      params.emplace_back(
+          it == first_read.end() ? first_read.size() : it->second, p_name,
+          dev_id);
+    }
+  }
+  std::sort(params.begin(), params.end());
+
+  auto &graph_vars = result->Get<GraphVars>(kGraphVars);
+  auto &deferred = result->Get<ShardedVarDevice>(kDeferredBroadcastVars);
+  for (auto &param : params) {
+    const std::string &p_name = std::get<1>(param);
+    size_t src_dev_id = std::get<2>(param);
+    // The parameter should be read on every device before it is written.
+    bool read_first = true;
+    for (auto &vars : graph_vars) {
+      auto it = vars.find(p_name);
+      read_first = read_first && it != vars.end() && !it->second.empty() &&
+                   it->second.front()->GeneratedOp() == nullptr;
+    }
+    if (!read_first) {
+      CreateBroadcastOp(result, p_name, src_dev_id);
+      continue;
+    }
+
+#ifdef PADDLE_WITH_CUDA
+    auto *op_handle = new BroadcastOpHandle(
+        result->CreateEmptyNode("broadcast", ir::Node::Type::kOperation),
+        local_scopes_, places_, nccl_ctxs_);
+#else
+    auto *op_handle = new BroadcastOpHandle(
+        result->CreateEmptyNode("broadcast", ir::Node::Type::kOperation),
+        local_scopes_, places_);
+#endif
+    result->Get<GraphOps>(kGraphOps).emplace_back(op_handle);
+    // The value optimized in the last iteration.
+    op_handle->AddInput(graph_vars[src_dev_id][p_name].front().get());
+
+    for (size_t i = 0; i < places_.size(); ++i) {
+      auto &p = places_[i];
+      SetCommunicationContext(op_handle, p);
+      auto &vars = graph_vars[i][p_name];
+      auto *origin_var = vars.front().get();
+      auto *out_var = new VarHandle(
+          result->CreateEmptyNode(p_name, ir::Node::Type::kVariable), 1, i,
+          p_name, p);
+      // The ops reading the parameter wait for the broadcast.
+      std::vector<OpHandleBase *> read_ops(origin_var->PendingOps().begin(),
+                                           origin_var->PendingOps().end());
+      for (auto *read_op : read_ops) {
+        if (read_op != op_handle) read_op->ReplaceInput(origin_var, out_var);
+      }
+      vars.emplace(vars.begin() + 1, out_var);
+      for (size_t version = 2; version < vars.size(); ++version) {
+        vars[version]->version_ = version;
+      }
+      op_handle->AddOutput(out_var);
+    }
+    deferred[p_name] = src_dev_id;
+  }
+  VLOG(3) << deferred.size() << " of " << params.size()
+          << " parameters are broadcast at the beginning of the iteration";
+}
+
 void MultiDevSSAGraphBuilder::CreateFusedBroadcastOp(
     ir::Graph *result,
     const std::vector<std::unordered_set<std::string>> &bcast_varnames) const {
@@ -565,7 +624,8 @@ void MultiDevSSAGraphBuilder::InsertAllReduceOp(ir::Graph *result,
 #ifdef PADDLE_WITH_CUDA
   result->Get<GraphOps>(kGraphOps).emplace_back(new AllReduceOpHandle(
       result->CreateEmptyNode("allreduce", ir::Node::Type::kOperation),
-      local_scopes_, places_, nccl_ctxs_));
+      local_scopes_, places_, nccl_ctxs_,
+      strategy_.use_hierarchical_allreduce_));
 #else
   result->Get<GraphOps>(kGraphOps).emplace_back(new AllReduceOpHandle(
       result->CreateEmptyNode("allreduce", ir::Node::Type::kOperation),
@@ -589,16 +649,65 @@ void MultiDevSSAGraphBuilder::InsertAllReduceOp(ir::Graph *result,
   }
 }
 
+size_t MultiDevSSAGraphBuilder::GetGradientMemorySize(
+    const VarDesc &var_desc) const {
+  int64_t numel = 1;
+  for (auto dim : var_desc.GetShape()) {
+    // The unknown dimensions, e.g. the batch size, are counted as 1.
+    numel *= std::max<int64_t>(dim, 1);
+  }
+  return numel * SizeOfType(ToTypeIndex(var_desc.GetDataType()));
+}
+
+void MultiDevSSAGraphBuilder::InsertFusedAllReduceOp(
+    ir::Graph *result, const std::vector<std::string> &ogs) const {
+  if (ogs.size() == 1) {
+    InsertAllReduceOp(result, ogs[0]);
+    return;
+  }
+#ifdef PADDLE_WITH_CUDA
+  result->Get<GraphOps>(kGraphOps).emplace_back(new FusedAllReduceOpHandle(
+      result->CreateEmptyNode("fused_allreduce", ir::Node::Type::kOperation),
+      local_scopes_, places_, ogs.size(), nccl_ctxs_,
+      strategy_.use_hierarchical_allreduce_));
+#else
+  result->Get<GraphOps>(kGraphOps).emplace_back(new FusedAllReduceOpHandle(
+      result->CreateEmptyNode("fused_allreduce", ir::Node::Type::kOperation),
+      local_scopes_, places_, ogs.size()));
+#endif
+  auto *op_handle = result->Get<GraphOps>(kGraphOps).back().get();
+
+  for (size_t i = 0; i < places_.size(); ++i) {
+    SetCommunicationContext(op_handle, places_[i]);
+  }
+  // The inputs and outputs are ordered by the gradients, then the places.
+  for (auto &og : ogs) {
+    for (size_t i = 0; i < places_.size(); ++i) {
+      auto &p = places_[i];
+      auto &vars = result->Get<GraphVars>(kGraphVars)[i][og];
+      PADDLE_ENFORCE(!vars.empty());
+      auto &prev_grad = vars.back();
+      op_handle->AddInput(prev_grad.get());
+
+      auto var =
+          new VarHandle(result->CreateEmptyNode(og, ir::Node::Type::kVariable),
+                        vars.size(), i, og, p);
+      vars.emplace_back(var);
+      op_handle->AddOutput(var);
+    }
+  }
+}
+
 void MultiDevSSAGraphBuilder::InsertDataBalanceOp(
     ir::Graph *result, const std::vector<std::string> &datas) const {
 #ifdef PADDLE_WITH_CUDA
   result->Get<GraphOps>(kGraphOps).emplace_back(new DataBalanceOpHandle(
       result->CreateEmptyNode("data_balance", ir::Node::Type::kOperation),
-      local_scopes_, places_, nccl_ctxs_));
+      local_scopes_, places_, nccl_ctxs_, strategy_.data_balance_by_tokens_));
 #else
   result->Get<GraphOps>(kGraphOps).emplace_back(new DataBalanceOpHandle(
       result->CreateEmptyNode("data_balance", ir::Node::Type::kOperation),
-      local_scopes_, places_));
+      local_scopes_, places_, strategy_.data_balance_by_tokens_));
 #endif
   auto *op_handle = result->Get<GraphOps>(kGraphOps).back().get();
   for (size_t i = 0; i < places_.size(); ++i) {
@@ -815,7 +924,9 @@ int MultiDevSSAGraphBuilder::CreateRPCOp(ir::Graph *result,
       VLOG(10) << "recv param " << recv_param_grad[0]
                << " get grad place: " << recv_param_grad[1]
                << " place: " << op_dev_id;
-    } else {
+    }
+    // the recvs before the forward ops are placed before the gradients
+    if (op_dev_id == -1) {
       op_dev_id = GetAppropriateDeviceID(output_var_names);
     }
     for (auto &varname : output_var_names) {
@@ -846,7 +957,9 @@ int MultiDevSSAGraphBuilder::CreateRPCOp(ir::Graph *result,
     SetOpInputsAllPlaces(result, node, places_.size());
     for (ir::Node *output : node->outputs) {
       int outvar_dev_id = op_dev_id;
-      if (node->Op()->Type() == "fetch_barrier") {
+      // The fetch_barrier after the recvs of the parameters only outputs a
+      // dependency var, instead of all the received parameters.
+      if (node->Op()->Type() == "fetch_barrier" && node->inputs.empty()) {
         outvar_dev_id = GetVarDeviceID(*result, output->Name());
         PADDLE_ENFORCE_NE(outvar_dev_id, -1);
       }
@@ -73,6 +73,11 @@ class MultiDevSSAGraphBuilder : public ir::Pass {
 
   void InsertAllReduceOp(ir::Graph *result, const std::string &og) const;
 
+  void InsertFusedAllReduceOp(ir::Graph *result,
+                              const std::vector<std::string> &ogs) const;
+
+  size_t GetGradientMemorySize(const VarDesc &var_desc) const;
+
   void InsertDataBalanceOp(ir::Graph *result,
                            const std::vector<std::string> &datas) const;
 
@@ -83,6 +88,12 @@ class MultiDevSSAGraphBuilder : public ir::Pass {
       ir::Graph *result,
       const std::vector<std::unordered_set<std::string>> &bcast_varnames) const;
 
+  // Broadcast the parameters before they are read, see
+  // BuildStrategy::overlap_broadcast_.
+  void CreateDeferredBroadcastOps(
+      ir::Graph *result, const std::vector<ir::Node *> &sorted_ops,
+      const std::vector<std::unordered_set<std::string>> &bcast_varnames) const;
+
   bool IsSparseGradient(const std::string &og) const;
 
   size_t GetAppropriateDeviceID(
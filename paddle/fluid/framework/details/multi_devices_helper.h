@@ -52,6 +52,30 @@ const char kGraphOps[] = "ops";
 
 typedef std::unordered_map<std::string, int> ShardedVarDevice;
 const char kShardedVarDevice[] = "sharded_var_device";
+
+// The parameters broadcast from their devices at the beginning of the next
+// iteration, see BuildStrategy::overlap_broadcast_, and their devices.
+const char kDeferredBroadcastVars[] = "deferred_broadcast_vars";
+
+// Add the dependencies from the ops reading a version of a variable to the op
+// writing its next version, so that a variable is not overwritten before it
+// is read.
+void PolishGraphToSupportDataHazards(ir::Graph *graph);
+
+// Return the latest version of the variable of node on the place_offset-th
+// place, which is created as version 0 if there is none.
+VarHandle *CreateOrGetLatestVarHandle(ir::Graph *graph, ir::Node *node,
+                                      const platform::Place &place,
+                                      size_t place_offset);
+
+// Add a new version of the variable of new_node as an output of op_handle.
+void CreateOpOutput(ir::Graph *graph, OpHandleBase *op_handle,
+                    ir::Node *new_node, const platform::Place &place,
+                    size_t place_offset);
+
+// Add a dummy output to the ops without any output, since only the variables
+// should be the leaves of the graph.
+void AddOutputToLeafOps(ir::Graph *graph);
 }  // namespace details
 }  // namespace framework
 }  // namespace paddle
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include "paddle/fluid/framework/details/op_handle_base.h"
+#include <algorithm>
 #include <map>
 
 namespace paddle {
@@ -53,6 +54,7 @@ void OpHandleBase::Run(bool use_cuda) {
   PADDLE_ENFORCE(!use_cuda);
 #endif
 
+  if (IsSkipped()) return;
   RunImpl();
 }
 
@@ -90,6 +92,14 @@ void OpHandleBase::AddOutput(VarHandleBase *out) {
   out->AddInput(this, this->Node());
 }
 
+void OpHandleBase::ReplaceInput(VarHandleBase *old_in, VarHandleBase *new_in) {
+  std::replace(inputs_.begin(), inputs_.end(), old_in, new_in);
+  std::replace(node_->inputs.begin(), node_->inputs.end(), old_in->Node(),
+               new_in->Node());
+  old_in->RemoveOutput(this, this->Node());
+  new_in->AddOutput(this, this->Node());
+}
+
 void OpHandleBase::WaitInputVarGenerated() {
   for (auto in_var : inputs_) {
     if (NeedWait(in_var)) {
@@ -47,6 +47,9 @@ class OpHandleBase {
 
   void AddOutput(VarHandleBase *out);
 
+  // Read new_in instead of old_in.
+  void ReplaceInput(VarHandleBase *old_in, VarHandleBase *new_in);
+
   // This method adds the wait events of all the input on all the device
   // context.
   // NODE: This Wait is asynchronous operation.
@@ -90,6 +93,12 @@ class OpHandleBase {
 
   ir::Node *Node() { return node_; }
 
+  // Skip the op, but still make its outputs ready, in the runs when *skip is
+  // true, e.g. the optimize ops in the gradient accumulation steps.
+  void SetSkipCondition(const bool *skip) { skip_ = skip; }
+
+  bool IsSkipped() const { return skip_ != nullptr && *skip_; }
+
  protected:
   void RunAndRecordEvent(const std::function<void()> &callback);
 
@@ -102,6 +111,7 @@ class OpHandleBase {
   std::vector<VarHandleBase *> inputs_;
   std::vector<VarHandleBase *> outputs_;
   std::map<platform::Place, platform::DeviceContext *> dev_ctxes_;
+  const bool *skip_{nullptr};
 
 #ifdef PADDLE_WITH_CUDA
   std::unordered_map<int, cudaEvent_t> events_;
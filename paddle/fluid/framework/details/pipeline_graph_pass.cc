@@ -0,0 +1,334 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "paddle/fluid/framework/details/pipeline_graph_pass.h"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "paddle/fluid/framework/details/computation_op_handle.h"
+#include "paddle/fluid/framework/details/copy_op_handle.h"
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/scope.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+static const char kPlaces[] = "places";
+static const char kLocalScopes[] = "local_scopes";
+static const char kNumMicroBatches[] = "num_micro_batches";
+
+static int GetOpRole(const OpDesc &op) {
+  return boost::get<int>(
+      op.GetAttr(OpProtoAndCheckerMaker::OpRoleAttrName()));
+}
+
+// The optimize and lr_sched ops run once in an iteration, after all the
+// micro-batches.
+static bool IsRunOnceOp(const OpDesc &op) {
+  return GetOpRole(op) & (static_cast<int>(OpRole::kOptimize) |
+                          static_cast<int>(OpRole::kLRSched));
+}
+
+static std::vector<std::string> ArgumentNames(
+    const std::vector<std::string> &names) {
+  std::set<std::string> no_dup;
+  for (auto &name : names) {
+    if (name != kEmptyVarName) no_dup.insert(name);
+  }
+  return std::vector<std::string>(no_dup.begin(), no_dup.end());
+}
+
+static std::unordered_map<ir::Node *, size_t> AssignStages(
+    const std::vector<ir::Node *> &sorted_ops, size_t num_stages) {
+  const std::string role_var_name = OpProtoAndCheckerMaker::OpRoleVarAttrName();
+  std::unordered_map<ir::Node *, int> stages;
+  std::unordered_map<std::string, int> writer_stages;
+  for (ir::Node *node : sorted_ops) {
+    auto *op = node->Op();
+    int stage = -1;
+    if (op->HasAttr(kPipelineStageAttrName)) {
+      stage = boost::get<int>(op->GetAttr(kPipelineStageAttrName));
+    } else if (IsRunOnceOp(*op) && op->HasAttr(role_var_name)) {
+      // The optimize op runs on the stage of its gradient.
+      auto role_vars =
+          boost::get<std::vector<std::string>>(op->GetAttr(role_var_name));
+      if (role_vars.size() == 2 && writer_stages.count(role_vars[1])) {
+        stage = writer_stages.at(role_vars[1]);
+      }
+    }
+    if (stage == -1) {
+      for (auto &name : op->InputArgumentNames()) {
+        auto it = writer_stages.find(name);
+        if (it != writer_stages.end()) stage = std::max(stage, it->second);
+      }
+    }
+    stages[node] = stage;
+    if (stage == -1) continue;
+    for (auto &name : op->OutputArgumentNames()) {
+      writer_stages[name] = stage;
+    }
+  }
+
+  // The ops reading nothing generated, e.g. fill_constant or the lr_sched
+  // ops, run on the earliest stage reading their outputs.
+  std::unordered_map<std::string, int> reader_stages;
+  std::unordered_map<ir::Node *, size_t> result;
+  for (auto it = sorted_ops.rbegin(); it != sorted_ops.rend(); ++it) {
+    auto *op = (*it)->Op();
+    int stage = stages.at(*it);
+    if (stage == -1) {
+      for (auto &name : op->OutputArgumentNames()) {
+        auto reader = reader_stages.find(name);
+        if (reader == reader_stages.end()) continue;
+        stage = stage == -1 ? reader->second : std::min(stage, reader->second);
+      }
+      stage = std::max(stage, 0);
+    }
+    PADDLE_ENFORCE(stage >= 0 && static_cast<size_t>(stage) < num_stages,
+                   "The pipeline stage %d of op %s is out of the %d places.",
+                   stage, op->Type(), num_stages);
+    for (auto &name : op->InputArgumentNames()) {
+      auto reader = reader_stages.find(name);
+      if (reader == reader_stages.end() || reader->second > stage) {
+        reader_stages[name] = stage;
+      }
+    }
+    result[*it] = static_cast<size_t>(stage);
+  }
+  return result;
+}
+
+std::unique_ptr<ir::Graph> PipelineGraphBuilder::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  auto &places = Get<const std::vector<platform::Place>>(kPlaces);
+  auto &local_scopes = Get<const std::vector<Scope *>>(kLocalScopes);
+  const size_t num_micro_batches = Get<const size_t>(kNumMicroBatches);
+  const size_t num_stages = places.size();
+  PADDLE_ENFORCE_GT(num_micro_batches, 0UL);
+  PADDLE_ENFORCE_EQ(local_scopes.size(), num_stages * num_micro_batches,
+                    "There should be a local scope for each micro-batch on "
+                    "each stage.");
+  for (auto &p : places) {
+    PADDLE_ENFORCE_EQ(platform::is_gpu_place(p),
+                      platform::is_gpu_place(places[0]),
+                      "The pipeline stages should be all on CPU or all on "
+                      "GPU.");
+  }
+
+  std::vector<ir::Node *> sorted_ops = ir::TopologySortOperations(*graph);
+  auto stages = AssignStages(sorted_ops, num_stages);
+  auto nodes = graph->ReleaseNodes();
+  ir::Graph &result = *graph;
+
+  std::unordered_map<std::string, VarDesc *> all_vars;
+  for (auto &node : nodes) {
+    if (node->IsVar() && node->Var()) {
+      all_vars.emplace(node->Name(), node->Var());
+    }
+  }
+  std::unordered_map<std::string, std::unique_ptr<VarDesc>> accumulator_descs;
+
+  result.Set(kGraphVars, new GraphVars(num_stages * num_micro_batches));
+  result.Set(kGraphDepVars, new GraphDepVars);
+  result.Set(kGraphOps, new GraphOps);
+  auto *stage_vars = new PipelineStageVars;
+  result.Set(kPipelineStageVars, stage_vars);
+  auto *accumulators = new PipelineAccumulators;
+  result.Set(kPipelineAccumulators, accumulators);
+  auto &all_ops = result.Get<GraphOps>(kGraphOps);
+
+  // The persistable variables are shared by the micro-batches of a stage, so
+  // they are versioned in the first local scope of the stage.
+  auto is_persistable = [&](const std::string &name) {
+    auto it = all_vars.find(name);
+    return it != all_vars.end() && it->second->Persistable();
+  };
+  auto scope_idx = [&](const std::string &name, size_t stage,
+                       size_t micro_batch) {
+    return stage * num_micro_batches +
+           (is_persistable(name) ? 0 : micro_batch);
+  };
+  auto create_var_node = [&](const std::string &name) {
+    auto it = all_vars.find(name);
+    return it != all_vars.end()
+               ? result.CreateVarNode(it->second)
+               : result.CreateEmptyNode(name, ir::Node::Type::kVariable);
+  };
+  auto get_latest_var = [&](const std::string &name, size_t idx) {
+    auto &versions = result.Get<GraphVars>(kGraphVars)[idx][name];
+    if (versions.empty()) {
+      versions.emplace_back(new VarHandle(create_var_node(name), 0, idx, name,
+                                          places[idx / num_micro_batches]));
+    }
+    return versions.back().get();
+  };
+
+  // The stage writing the latest version of each variable, keyed by the
+  // micro-batch, or -1 for the persistable variables.
+  std::map<std::pair<int, std::string>, size_t> writer_stages;
+  auto writer_key = [&](const std::string &name, size_t micro_batch) {
+    return std::make_pair(
+        is_persistable(name) ? -1 : static_cast<int>(micro_batch), name);
+  };
+  // The variables sent to the other stages, which are reused until the
+  // variables are written again.
+  std::map<std::pair<VarHandle *, size_t>, VarHandle *> sent_vars;
+
+  auto read_var = [&](const std::string &name, size_t stage,
+                      size_t micro_batch) {
+    if (is_persistable(name)) (*stage_vars)[name].insert(stage);
+    size_t idx = scope_idx(name, stage, micro_batch);
+    auto writer = writer_stages.find(writer_key(name, micro_batch));
+    if (writer == writer_stages.end() || writer->second == stage) {
+      return get_latest_var(name, idx);
+    }
+    auto *src = get_latest_var(
+        name, scope_idx(name, writer->second, micro_batch));
+    auto &dst = sent_vars[std::make_pair(src, stage)];
+    if (dst == nullptr) {
+      all_ops.emplace_back(new CopyOpHandle(
+          result.CreateEmptyNode("copy", ir::Node::Type::kOperation),
+          local_scopes, places[stage]));
+      auto *op_handle = all_ops.back().get();
+      op_handle->AddInput(src);
+      CreateOpOutput(&result, op_handle, create_var_node(name), places[stage],
+                     idx);
+      dst = result.Get<GraphVars>(kGraphVars)[idx][name].back().get();
+    }
+    return dst;
+  };
+
+  auto create_op = [&](OpDesc *op, size_t stage, size_t micro_batch) {
+    auto &p = places[stage];
+    all_ops.emplace_back(new ComputationOpHandle(
+        result.CreateOpNode(op),
+        local_scopes[stage * num_micro_batches + micro_batch], p));
+    auto *op_handle = all_ops.back().get();
+    op_handle->SetDeviceContext(p,
+                                platform::DeviceContextPool::Instance().Get(p));
+    for (auto &name : ArgumentNames(op->InputArgumentNames())) {
+      op_handle->AddInput(read_var(name, stage, micro_batch));
+    }
+    for (auto &name : ArgumentNames(op->OutputArgumentNames())) {
+      if (is_persistable(name)) (*stage_vars)[name].insert(stage);
+      CreateOpOutput(&result, op_handle, create_var_node(name), p,
+                     scope_idx(name, stage, micro_batch));
+      writer_stages[writer_key(name, micro_batch)] = stage;
+    }
+  };
+
+  auto create_scale_op = [&](BlockDesc *block, const std::string &x,
+                             const std::string &out, float scale,
+                             size_t stage) {
+    OpDesc op(block);
+    op.SetType("scale");
+    op.SetInput("X", {x});
+    op.SetOutput("Out", {out});
+    op.SetAttr("scale", scale);
+    op.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+               static_cast<int>(OpRole::kBackward) |
+                   static_cast<int>(OpRole::kOptimize));
+    create_op(&op, stage, num_micro_batches - 1);
+  };
+
+  const std::string role_var_name = OpProtoAndCheckerMaker::OpRoleVarAttrName();
+  std::vector<std::pair<std::string, BlockDesc *>> accumulator_blocks;
+  for (ir::Node *node : sorted_ops) {
+    auto *op = node->Op();
+    int op_role = GetOpRole(*op);
+    PADDLE_ENFORCE(!(op_role & (static_cast<int>(OpRole::kRPC) |
+                                static_cast<int>(OpRole::kDist))),
+                   "The pipeline does not support the distributed op %s.",
+                   op->Type());
+    size_t stage = stages.at(node);
+    if (IsRunOnceOp(*op)) {
+      create_op(op, stage, num_micro_batches - 1);
+      continue;
+    }
+    for (size_t i = 0; i < num_micro_batches; ++i) {
+      create_op(op, stage, i);
+    }
+    if (!(op_role & static_cast<int>(OpRole::kBackward)) ||
+        !op->HasAttr(role_var_name)) {
+      continue;
+    }
+
+    // Sum the gradients of the micro-batches into the buffers, and the
+    // optimize ops read the average of them in the last micro-batch.
+    auto role_vars =
+        boost::get<std::vector<std::string>>(op->GetAttr(role_var_name));
+    PADDLE_ENFORCE_EQ(role_vars.size() % 2, 0);
+    auto outputs = op->OutputArgumentNames();
+    for (size_t i = 1; i < role_vars.size(); i += 2) {
+      const std::string &g_name = role_vars[i];
+      if (std::find(outputs.begin(), outputs.end(), g_name) == outputs.end()) {
+        continue;
+      }
+      auto *grad_desc = all_vars.at(g_name);
+      PADDLE_ENFORCE(grad_desc->GetType() == proto::VarType::LOD_TENSOR,
+                     "The pipeline only supports the dense gradients, but "
+                     "%s is not.",
+                     g_name);
+      const std::string acc_name = g_name + kPipelineAccumulatorSuffix;
+      auto *acc_desc = new VarDesc(acc_name);
+      acc_desc->SetType(proto::VarType::LOD_TENSOR);
+      acc_desc->SetDataType(grad_desc->GetDataType());
+      acc_desc->SetShape(grad_desc->GetShape());
+      acc_desc->SetPersistable(true);
+      accumulator_descs[acc_name].reset(acc_desc);
+      all_vars[acc_name] = acc_desc;
+      (*accumulators)[acc_name] = static_cast<int>(stage);
+
+      for (size_t m = 0; m < num_micro_batches; ++m) {
+        OpDesc sum_op(op->Block());
+        sum_op.SetType("sum");
+        sum_op.SetInput("X", {acc_name, g_name});
+        sum_op.SetOutput("Out", {acc_name});
+        sum_op.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+                       static_cast<int>(OpRole::kBackward));
+        create_op(&sum_op, stage, m);
+      }
+      create_scale_op(op->Block(), acc_name, g_name,
+                      1.f / num_micro_batches, stage);
+      accumulator_blocks.emplace_back(acc_name, op->Block());
+    }
+  }
+
+  // The buffers are reset after the average ops read them.
+  for (auto &acc : accumulator_blocks) {
+    create_scale_op(acc.second, acc.first, acc.first, 0.f,
+                    static_cast<size_t>(accumulators->at(acc.first)));
+  }
+
+  PolishGraphToSupportDataHazards(&result);
+  AddOutputToLeafOps(&result);
+  PADDLE_ENFORCE(!ir::HasCircle(result));
+  return graph;
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(pipeline_pass, paddle::framework::details::PipelineGraphBuilder)
+    .RequirePassAttr(paddle::framework::details::kPlaces)
+    .RequirePassAttr(paddle::framework::details::kLocalScopes)
+    .RequirePassAttr(paddle::framework::details::kNumMicroBatches);
@@ -0,0 +1,71 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "paddle/fluid/framework/details/multi_devices_helper.h"
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+// The attribute set on the ops by fluid.pipeline_stage, which is the index
+// of the place running the op.
+constexpr char kPipelineStageAttrName[] = "pipeline_stage";
+
+// The stages reading or writing each persistable variable, which should be
+// created in the scopes of these stages, or copied there if it is on another
+// place.
+typedef std::unordered_map<std::string, std::unordered_set<size_t>>
+    PipelineStageVars;
+constexpr char kPipelineStageVars[] = "pipeline_stage_vars";
+
+// The stage of each gradient accumulation buffer, which should be zeroed
+// before running.
+typedef std::unordered_map<std::string, int> PipelineAccumulators;
+constexpr char kPipelineAccumulators[] = "pipeline_accumulators";
+constexpr char kPipelineAccumulatorSuffix[] = "@PIPELINE_ACCUMULATION";
+
+/*
+ * Build the SSA graph running the program as a pipeline of stages, one stage
+ * on each place, over num_micro_batches micro-batches, GPipe-style.
+ *
+ * The op with the pipeline_stage attribute runs on that stage, and the grad
+ * ops usually inherit it from the forward ops. The optimize op runs on the
+ * stage of its gradient, and other ops on the latest stage of their inputs,
+ * or the earliest stage of their outputs' readers.
+ *
+ * The forward and backward ops are created once for each micro-batch, in the
+ * local scope stage * num_micro_batches + micro_batch, where the
+ * non-persistable variables live, and a variable generated on another stage
+ * is sent by a CopyOpHandle. So a stage runs the forward ops of the next
+ * micro-batch, or the backward ops of a previous one, while the others are
+ * busy with the other micro-batches. The dense gradients of the parameters
+ * are summed into the persistable buffers on their stages, and the optimize
+ * and lr_sched ops run once in the last micro-batch scope of each stage, with
+ * the buffers averaged over the micro-batches instead of the gradients.
+ */
+class PipelineGraphBuilder : public ir::Pass {
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+};
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -15,10 +15,12 @@
 #pragma once
 #include <algorithm>
 #include <map>
+#include <memory>
 #include <vector>
 #include "paddle/fluid/framework/details/reduce_and_gather.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/platform/intra_op_thread_pool.h"
 namespace paddle {
 namespace framework {
 namespace details {
@@ -53,6 +55,88 @@ struct ReduceLoDTensor {
   }
 };
 
+// The elements of the tensors summed across the sources at a time by the
+// deterministic reduce, in the cache.
+constexpr int64_t kDeterministicReduceBlock = 4096;
+
+// The scratch elements of TreeSum per element of len.
+inline size_t TreeSumScratchSize(size_t n) {
+  size_t levels = 1;
+  for (size_t m = 2; m < n; m *= 2) ++levels;
+  return levels;
+}
+
+// Sum the len elements of the n sources into out in the fixed pairwise order
+// of the sources, e.g. ((s0 + s1) + s2) + (s3 + s4), so that every element is
+// summed alike however the elements are split. scratch has
+// len * TreeSumScratchSize(n) elements, and out should not be a source.
+template <typename T>
+void TreeSum(const T *const *srcs, size_t n, int64_t len, T *out, T *scratch) {
+  if (n == 1) {
+    std::copy(srcs[0], srcs[0] + len, out);
+  } else if (n == 2) {
+    const T *a = srcs[0];
+    const T *b = srcs[1];
+    for (int64_t j = 0; j < len; ++j) {
+      out[j] = a[j] + b[j];
+    }
+  } else {
+    size_t half = (n + 1) / 2;
+    TreeSum(srcs, half, len, out, scratch + len);
+    TreeSum(srcs + half, n - half, len, scratch, scratch + len);
+    for (int64_t j = 0; j < len; ++j) {
+      out[j] += scratch[j];
+    }
+  }
+}
+
+// Reduce the CPU tensors by TreeSum in the order of src_tensors_, which is
+// bitwise reproducible. The blocks of the tensors run in parallel on the
+// intra-op threads, each summed across the sources into a buffer in the cache
+// before it is written to dst_tensor_, which may be one of the sources.
+struct DeterministicReduceLoDTensor {
+  const std::vector<const LoDTensor *> &src_tensors_;
+  LoDTensor &dst_tensor_;
+
+  DeterministicReduceLoDTensor(const std::vector<const LoDTensor *> &src,
+                               LoDTensor *dst)
+      : src_tensors_(src), dst_tensor_(*dst) {}
+
+  template <typename T>
+  void apply() const {
+    PADDLE_ENFORCE(!src_tensors_.empty());
+    auto &t0 = *src_tensors_[0];
+    PADDLE_ENFORCE_NE(t0.numel(), 0);
+    std::vector<const T *> srcs;
+    for (auto *t : src_tensors_) {
+      PADDLE_ENFORCE_EQ(t->dims(), t0.dims());
+      PADDLE_ENFORCE_EQ(t->type(), t0.type());
+      srcs.push_back(t->data<T>());
+    }
+
+    dst_tensor_.Resize(t0.dims());
+    T *dst = dst_tensor_.mutable_data<T>(platform::CPUPlace());
+    const size_t n = srcs.size();
+    auto reduce = [&](int64_t begin, int64_t end) {
+      const int64_t block = kDeterministicReduceBlock;
+      // Not std::vector, whose bool is not an array.
+      std::unique_ptr<T[]> sum(new T[block]);
+      std::unique_ptr<T[]> scratch(new T[block * TreeSumScratchSize(n)]);
+      std::vector<const T *> block_srcs(n);
+      for (int64_t b = begin; b < end; b += block) {
+        int64_t len = std::min(block, end - b);
+        for (size_t i = 0; i < n; ++i) {
+          block_srcs[i] = srcs[i] + b;
+        }
+        TreeSum(block_srcs.data(), n, len, sum.get(), scratch.get());
+        std::copy(sum.get(), sum.get() + len, dst + b);
+      }
+    };
+    platform::IntraOpThreadPool::GetInstance()->ParallelFor(
+        t0.numel(), kDeterministicReduceBlock, reduce);
+  }
+};
+
 inline void GatherSelectedRows(
     const std::vector<const SelectedRows *> &src_selecte_rows_,
     const std::vector<platform::Place> &in_places,
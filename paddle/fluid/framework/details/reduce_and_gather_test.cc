@@ -0,0 +1,67 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/reduce_and_gather.h"
+
+#include <random>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+TEST(DeterministicReduceLoDTensor, TreeOrder) {
+  const int kPlaces = 5;
+  // Spans several blocks and a partial one.
+  const int64_t kNumel = 5 * kDeterministicReduceBlock + 33;
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<LoDTensor> grads(kPlaces);
+  std::vector<const LoDTensor *> ptrs;
+  for (auto &grad : grads) {
+    grad.Resize({kNumel});
+    float *data = grad.mutable_data<float>(platform::CPUPlace());
+    for (int64_t j = 0; j < kNumel; ++j) {
+      data[j] = dist(rng);
+    }
+    ptrs.push_back(&grad);
+  }
+
+  LoDTensor out;
+  DeterministicReduceLoDTensor func(ptrs, &out);
+  func.apply<float>();
+
+  const float *s[kPlaces];
+  for (int i = 0; i < kPlaces; ++i) {
+    s[i] = grads[i].data<float>();
+  }
+  const float *data = out.data<float>();
+  for (int64_t j = 0; j < kNumel; ++j) {
+    float expected = ((s[0][j] + s[1][j]) + s[2][j]) + (s[3][j] + s[4][j]);
+    ASSERT_EQ(data[j], expected);
+  }
+
+  // Reduced into the first place, the same bits.
+  std::vector<float> copy(data, data + kNumel);
+  DeterministicReduceLoDTensor in_place(ptrs, &grads[0]);
+  in_place.apply<float>();
+  for (int64_t j = 0; j < kNumel; ++j) {
+    ASSERT_EQ(grads[0].data<float>()[j], copy[j]);
+  }
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
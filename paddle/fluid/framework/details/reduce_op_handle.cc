@@ -108,20 +108,11 @@ void ReduceOpHandle::RunImpl() {
                                out_var->GetMutable<framework::LoDTensor>());
           VisitDataType(ToDataType(lod_tensors[0]->type()), func);
         } else {
-          // We sum lod_tensors to reduce_sum_trg which is in local_scopes_0
-          // here, but it doesn't mean reduce_sum_trg must be in local_scopes_0.
-          auto &reduce_sum_trg = *this->local_scopes_[0]
-                                      ->FindVar(kLocalExecScopeName)
-                                      ->Get<Scope *>()
-                                      ->FindVar(out_var_handle->name_)
-                                      ->GetMutable<framework::LoDTensor>();
-          ReduceLoDTensor func(lod_tensors, &reduce_sum_trg);
+          // The tensors are summed in the order of the places whichever
+          // place holds the output, as the CPU all reduce does.
+          DeterministicReduceLoDTensor func(
+              lod_tensors, out_var->GetMutable<framework::LoDTensor>());
           VisitDataType(ToDataType(lod_tensors[0]->type()), func);
-
-          auto trg = out_var->GetMutable<framework::LoDTensor>();
-          if (reduce_sum_trg.data<void>() != trg->data<void>()) {
-            TensorCopy(reduce_sum_trg, platform::CPUPlace(), trg);
-          }
         }
       });
     } else if (paddle::platform::is_gpu_place(lod_tensors[0]->place())) {
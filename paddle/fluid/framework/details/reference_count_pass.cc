@@ -14,11 +14,13 @@
 
 #include <queue>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "paddle/fluid/framework/details/computation_op_handle.h"
 #include "paddle/fluid/framework/details/multi_devices_helper.h"
 #include "paddle/fluid/framework/details/reference_count_pass.h"
+#include "paddle/fluid/framework/executor.h"
 
 namespace paddle {
 namespace framework {
@@ -60,6 +62,37 @@ static void AddDependencyBetween(OpHandleBase *in, OpHandleBase *out,
   }
 }
 
+static bool IsRecomputeOp(ComputationOpHandle *op) {
+  for (auto &name : op->Node()->Op()->OutputArgumentNames()) {
+    if (name.find(kRecomputeVarSuffix) != std::string::npos) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// The recomputed ops only depend on the checkpoints, so they could run right
+// after the forward, and the activations they write would be alive together
+// with the forward ones. Make each of them wait for the last computation op
+// before it in the program on the same device instead.
+static void AddRecomputeDependencies(const GraphOps &all_ops,
+                                     ir::Graph *graph) {
+  std::unordered_map<int, ComputationOpHandle *> last_ops;
+  for (auto &op : all_ops) {
+    auto *compute_op = dynamic_cast<ComputationOpHandle *>(op.get());
+    if (compute_op == nullptr ||
+        !platform::is_gpu_place(compute_op->GetPlace())) {
+      continue;
+    }
+    int device = boost::get<platform::CUDAPlace>(compute_op->GetPlace()).device;
+    if (!IsRecomputeOp(compute_op)) {
+      last_ops[device] = compute_op;
+    } else if (last_ops.count(device)) {
+      AddDependencyBetween(last_ops[device], compute_op, graph);
+    }
+  }
+}
+
 std::unique_ptr<ir::Graph> ReferenceCountPass::ApplyImpl(
     std::unique_ptr<ir::Graph> graph) const {
   auto &ref_cnts = Get<DeviceReferenceCountMap>(kGlobalReferenceCount);
@@ -74,6 +107,17 @@ std::unique_ptr<ir::Graph> ReferenceCountPass::ApplyImpl(
   std::unordered_map<OpHandleBase *, std::unique_ptr<ReferenceCountOpHandle>>
       compute_ref_cnt_map;
 
+  // The variables read inside the sub-blocks of the control flow ops without
+  // being their inputs are not counted, as their last uses are unknown.
+  auto &all_ops = graph->Get<GraphOps>(kGraphOps);
+  std::unordered_set<std::string> skip_vars;
+  for (auto &op : all_ops) {
+    auto *compute_op = dynamic_cast<ComputationOpHandle *>(op.get());
+    if (compute_op == nullptr || compute_op->Node()->Op() == nullptr) continue;
+    auto vars = GetUnlistedSubBlockVars(*compute_op->Node()->Op());
+    skip_vars.insert(vars.begin(), vars.end());
+  }
+
   auto get_ref_cnts_from_compute_op = [&](
       const std::unique_ptr<OpHandleBase> &op,
       const std::vector<VarHandleBase *> &vars) {
@@ -101,7 +145,7 @@ std::unique_ptr<ir::Graph> ReferenceCountPass::ApplyImpl(
         if (var_desc == nullptr) continue;
       }
 
-      if (var_desc->Persistable()) continue;
+      if (var_desc->Persistable() || skip_vars.count(var_name)) continue;
       auto var_type = var_desc->Proto()->type().type();
       if (var_type != proto::VarType::LOD_TENSOR &&
           var_type != proto::VarType::SELECTED_ROWS) {
@@ -158,7 +202,7 @@ std::unique_ptr<ir::Graph> ReferenceCountPass::ApplyImpl(
     }
   };
 
-  auto &all_ops = graph->Get<GraphOps>(kGraphOps);
+  AddRecomputeDependencies(all_ops, graph.get());
   for (auto &op : all_ops) {
     auto in_var_names = get_ref_cnts_from_compute_op(op, op->Inputs());
     auto out_var_names = get_ref_cnts_from_compute_op(op, op->Outputs());
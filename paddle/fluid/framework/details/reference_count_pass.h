@@ -26,6 +26,10 @@ constexpr char kGlobalReferenceCount[] = "reference_count";
 constexpr char kCurReferenceCount[] = "current_reference_count";
 constexpr char kGarbageCollector[] = "garbage_collector";
 
+// The suffix of the variables written by the forward ops recomputed in the
+// backward, see append_backward with checkpoints.
+constexpr char kRecomputeVarSuffix[] = "@RECOMPUTE";
+
 class ReferenceCountPass : public ir::Pass {
  protected:
   std::unique_ptr<ir::Graph> ApplyImpl(
@@ -15,6 +15,7 @@
 #include "paddle/fluid/framework/details/scope_buffered_ssa_graph_executor.h"
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "paddle/fluid/framework/executor.h"
 #include "paddle/fluid/platform/profiler.h"
@@ -35,29 +36,89 @@ ScopeBufferedSSAGraphExecutor::ScopeBufferedSSAGraphExecutor(
       var_infos_(std::move(var_infos)),
       places_(std::move(places)) {}
 
-FeedFetchList ScopeBufferedSSAGraphExecutor::Run(
-    const std::vector<std::string> &fetch_tensors) {
-  if (drop_scope_counter_ == 0) {
-    // Create local scopes.
-    for (auto it = local_scopes_.rbegin(); it != local_scopes_.rend(); ++it) {
-      auto &scope = *it;
-      Scope &local_scope = scope->NewScope();
-      *scope->Var(details::kLocalExecScopeName)->GetMutable<Scope *>() =
-          &local_scope;
+void ScopeBufferedSSAGraphExecutor::CreateLocalExecScopes() {
+  for (auto it = local_scopes_.rbegin(); it != local_scopes_.rend(); ++it) {
+    auto &scope = *it;
+    Scope &local_scope = scope->NewScope();
+    *scope->Var(details::kLocalExecScopeName)->GetMutable<Scope *>() =
+        &local_scope;
 
-      for (auto &info : var_infos_) {
-        if (scope->FindVar(info.name_) != nullptr) {
-          continue;
-        }
+    for (auto &info : var_infos_) {
+      if (scope->FindVar(info.name_) != nullptr) {
+        continue;
+      }
 
-        if (info.persistable_) {  // Persistable
-          InitializeVariable(scope->Var(info.name_), info.type_);
-        } else {
-          InitializeVariable(local_scope.Var(info.name_), info.type_);
-        }
+      if (info.persistable_) {  // Persistable
+        InitializeVariable(scope->Var(info.name_), info.type_);
+      } else {
+        InitializeVariable(local_scope.Var(info.name_), info.type_);
       }
     }
   }
+  local_exec_scopes_created_ = true;
+}
+
+void ScopeBufferedSSAGraphExecutor::ResetLocalExecScope(
+    Scope *local_scope) const {
+  local_scope->DropKids();
+  std::unordered_map<std::string, proto::VarType::Type> types;
+  for (auto &info : var_infos_) {
+    if (!info.persistable_) {
+      types.emplace(info.name_, info.type_);
+    }
+  }
+  std::vector<std::string> created_vars;
+  for (auto &name : local_scope->LocalVarNames()) {
+    auto it = types.find(name);
+    if (it == types.end()) {
+      created_vars.push_back(name);
+      continue;
+    }
+    // The variable is kept, so its content is released here at once if the
+    // eager deletion has not released it in the iteration.
+    auto *var = local_scope->FindVar(name);
+    var->Clear();
+    InitializeVariable(var, it->second);
+  }
+  local_scope->EraseVars(created_vars);
+}
+
+void ScopeBufferedSSAGraphExecutor::ReleaseLocalExecScopes() {
+#ifdef PADDLE_WITH_CUDA
+  const std::string gc_name = "garbage_collector";
+  DeviceGarbageCollectorMap *gc =
+      Graph().Has(gc_name) ? &(Graph().Get<DeviceGarbageCollectorMap>(gc_name))
+                           : nullptr;
+#endif
+  // Wait All computational streams
+  for (auto p : places_) {
+    platform::DeviceContextPool::Instance().Get(p)->Wait();
+#ifdef PADDLE_WITH_CUDA
+    if (gc != nullptr && platform::is_gpu_place(p)) {
+      auto gpu_place = boost::get<platform::CUDAPlace>(p);
+      auto &gc_at_place = gc->at(gpu_place.device);
+      gc_at_place->Wait();
+      gc_at_place->Reset();
+    }
+#endif
+  }
+  for (auto &scope : local_scopes_) {
+    auto &local_scope =
+        *scope->Var(details::kLocalExecScopeName)->GetMutable<Scope *>();
+    if (strategy_.recycle_local_scopes_) {
+      ResetLocalExecScope(local_scope);
+    } else {
+      scope->DeleteScope(local_scope);
+    }
+  }
+  local_exec_scopes_created_ = strategy_.recycle_local_scopes_;
+}
+
+FeedFetchList ScopeBufferedSSAGraphExecutor::Run(
+    const std::vector<std::string> &fetch_tensors) {
+  if (!local_exec_scopes_created_) {
+    CreateLocalExecScopes();
+  }
   std::vector<framework::LoDTensor> fetch_data;
   std::exception_ptr eptr;
   try {
@@ -67,35 +128,17 @@ FeedFetchList ScopeBufferedSSAGraphExecutor::Run(
   }
 
   platform::RecordEvent e("ScopeBufferedSSAGraphExecutorAfterRun", nullptr);
+  // The next run on any stream of a place waits for this run on all its
+  // streams, e.g. the parameters updated on the stream pool.
+  for (auto &p : places_) {
+    platform::DeviceContextPool::Instance().JoinStreamContexts(p);
+  }
   drop_scope_counter_ += 1;
 
-#ifdef PADDLE_WITH_CUDA
-  const std::string gc_name = "garbage_collector";
-  DeviceGarbageCollectorMap *gc =
-      Graph().Has(gc_name) ? &(Graph().Get<DeviceGarbageCollectorMap>(gc_name))
-                           : nullptr;
-#endif
-
   if (!fetch_tensors.empty() ||
       drop_scope_counter_ == strategy_.num_iteration_per_drop_scope_) {
     drop_scope_counter_ = 0;
-    // Wait All computational streams
-    for (auto p : places_) {
-      platform::DeviceContextPool::Instance().Get(p)->Wait();
-#ifdef PADDLE_WITH_CUDA
-      if (gc != nullptr && platform::is_gpu_place(p)) {
-        auto gpu_place = boost::get<platform::CUDAPlace>(p);
-        auto &gc_at_place = gc->at(gpu_place.device);
-        gc_at_place->Wait();
-        gc_at_place->Reset();
-      }
-#endif
-    }
-    for (auto &scope : local_scopes_) {
-      auto &local_scope =
-          *scope->Var(details::kLocalExecScopeName)->GetMutable<Scope *>();
-      scope->DeleteScope(local_scope);
-    }
+    ReleaseLocalExecScopes();
   }
   if (eptr) {
     std::rethrow_exception(eptr);
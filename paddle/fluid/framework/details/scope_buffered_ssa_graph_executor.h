@@ -48,7 +48,18 @@ class ScopeBufferedSSAGraphExecutor : public SSAGraphExecutor {
   FeedFetchList Run(const std::vector<std::string>& fetch_tensors) override;
 
  private:
+  void CreateLocalExecScopes();
+
+  // Wait for all the places, then drop the local exec scopes or reset them
+  // if strategy_.recycle_local_scopes_.
+  void ReleaseLocalExecScopes();
+
+  // Drop the kid scopes and the variables created by the operators, and make
+  // the other variables uninitialized again, as if in a new local scope.
+  void ResetLocalExecScope(Scope* local_scope) const;
+
   size_t drop_scope_counter_{0};
+  bool local_exec_scopes_created_{false};
 
   ExecutionStrategy strategy_;
   std::unique_ptr<SSAGraphExecutor> underlying_executor_;
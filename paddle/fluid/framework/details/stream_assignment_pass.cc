@@ -0,0 +1,126 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/stream_assignment_pass.h"
+
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/framework/details/computation_op_handle.h"
+#include "paddle/fluid/framework/details/multi_devices_helper.h"
+#include "paddle/fluid/framework/details/op_graph_view.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/platform/device_context.h"
+
+DECLARE_bool(use_stream_ordered_allocator);
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+static ComputationOpHandle *GPUComputationOp(OpHandleBase *op) {
+  auto *compute_op = dynamic_cast<ComputationOpHandle *>(op);
+  if (compute_op != nullptr && platform::is_gpu_place(compute_op->GetPlace())) {
+    return compute_op;
+  }
+  return nullptr;
+}
+
+std::unique_ptr<ir::Graph> StreamAssignmentPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> ir_graph) const {
+  int num_streams = Get<const int>("num_streams");
+  if (num_streams <= 1) return ir_graph;
+  // The temporary memory freed on a stream could be reused by another one
+  // at once without the stream-ordered allocator, and the eager deletion
+  // frees the variables after the default stream only.
+  if (!FLAGS_use_stream_ordered_allocator) {
+    LOG(WARNING) << "The computation ops run on one stream, since multiple "
+                    "streams need FLAGS_use_stream_ordered_allocator.";
+    return ir_graph;
+  }
+  if (GetEagerDeletionThreshold() >= 0) {
+    LOG(WARNING) << "The computation ops run on one stream, since multiple "
+                    "streams do not work with the eager deletion.";
+    return ir_graph;
+  }
+
+  auto &all_ops = ir_graph->Get<GraphOps>(kGraphOps);
+  OpGraphView graph_view(all_ops);
+  std::unordered_map<OpHandleBase *, size_t> op_index;
+  std::unordered_map<OpHandleBase *, size_t> num_preceding;
+  std::deque<OpHandleBase *> ready_ops;
+  for (size_t i = 0; i < all_ops.size(); ++i) {
+    auto &op = all_ops[i];
+    op_index[op.get()] = i;
+    num_preceding[op.get()] = graph_view.PrecedingOps(op.get()).size();
+    if (num_preceding[op.get()] == 0) ready_ops.push_back(op.get());
+  }
+
+  std::unordered_map<OpHandleBase *, int> stream_of;
+  // The ops whose streams are continued by one of their pending ops.
+  std::unordered_set<OpHandleBase *> continued;
+  std::map<platform::Place, int> next_stream;
+  auto &pool = platform::DeviceContextPool::Instance();
+  // Visit the ops in a topological order, so that the preceding ops have
+  // their streams.
+  while (!ready_ops.empty()) {
+    auto *op = ready_ops.front();
+    ready_ops.pop_front();
+    for (auto *pending_op : graph_view.PendingOps(op)) {
+      if (--num_preceding[pending_op] == 0) ready_ops.push_back(pending_op);
+    }
+
+    auto *compute_op = GPUComputationOp(op);
+    if (compute_op == nullptr) continue;
+    auto &place = compute_op->GetPlace();
+    OpHandleBase *chain = nullptr;
+    for (auto *preceding_op : graph_view.PrecedingOps(op)) {
+      if (stream_of.count(preceding_op) == 0 ||
+          continued.count(preceding_op) != 0 ||
+          !(GPUComputationOp(preceding_op)->GetPlace() == place)) {
+        continue;
+      }
+      if (chain == nullptr || op_index[preceding_op] < op_index[chain]) {
+        chain = preceding_op;
+      }
+    }
+
+    int stream_id;
+    if (chain != nullptr) {
+      stream_id = stream_of[chain];
+      continued.insert(chain);
+    } else {
+      stream_id = next_stream[place];
+      next_stream[place] = (stream_id + 1) % num_streams;
+    }
+    stream_of[op] = stream_id;
+    if (stream_id != 0) {
+      compute_op->SetStreamContext(pool.GetStreamContext(place, stream_id));
+      VLOG(10) << "Run " << compute_op->DebugString() << " on the stream "
+               << stream_id;
+    }
+  }
+  return ir_graph;
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(stream_assignment_pass,
+              paddle::framework::details::StreamAssignmentPass)
+    .RequirePassAttr("num_streams");
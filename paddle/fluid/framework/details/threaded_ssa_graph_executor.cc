@@ -14,9 +14,13 @@
 
 #include "paddle/fluid/framework/details/threaded_ssa_graph_executor.h"
 
+#include "gflags/gflags.h"
 #include "paddle/fluid/framework/details/multi_devices_helper.h"
+#include "paddle/fluid/framework/threadpool.h"
 #include "paddle/fluid/platform/profiler.h"
 
+DECLARE_bool(cpu_unified_runtime);
+
 namespace paddle {
 namespace framework {
 namespace details {
@@ -25,11 +29,14 @@ ThreadedSSAGraphExecutor::ThreadedSSAGraphExecutor(
     const std::vector<platform::Place> &places,
     std::unique_ptr<ir::Graph> &&graph)
     : graph_(std::move(graph)),
-      pool_(strategy.num_threads_ >= 2 ? new ::ThreadPool(strategy.num_threads_)
-                                       : nullptr),
+      pool_(strategy.num_threads_ >= 2 && !FLAGS_cpu_unified_runtime
+                ? new ::ThreadPool(strategy.num_threads_)
+                : nullptr),
       local_scopes_(local_scopes),
       places_(places),
       fetch_ctxs_(places),
+      delayed_fetch_buffers_(strategy.delay_fetch_ ? new DelayedFetchBuffers
+                                                   : nullptr),
       running_ops_(0),
       strategy_(strategy) {}
 
@@ -167,7 +174,8 @@ void ThreadedSSAGraphExecutor::InsertFetchOps(
 
     ir::Node *fetch_node =
         graph_->CreateEmptyNode("fetch", ir::Node::Type::kOperation);
-    auto *op = new FetchOpHandle(fetch_node, fetch_data, i, &local_scopes_);
+    auto *op = new FetchOpHandle(fetch_node, fetch_data, i, &local_scopes_,
+                                 delayed_fetch_buffers_.get());
     fetch_ops->emplace_back(op);
 
     for (auto &p : places_) {
@@ -222,6 +230,9 @@ void ThreadedSSAGraphExecutor::RunOp(
   };
   if (pool_) {
     run_op_futures_.emplace_back(pool_->enqueue(op_run));
+  } else if (strategy_.num_threads_ >= 2 && FLAGS_cpu_unified_runtime) {
+    // The ops share the workers of the CPU runtime with their kernels' loops.
+    run_op_futures_.emplace_back(framework::Async(op_run));
   } else {
     op_run();
   }
@@ -16,6 +16,7 @@
 
 #include <deque>
 #include <list>
+#include <memory>
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -60,6 +61,8 @@ class ThreadedSSAGraphExecutor : public SSAGraphExecutor {
   std::vector<Scope *> local_scopes_;
   std::vector<platform::Place> places_;
   platform::DeviceContextPool fetch_ctxs_;
+  // Only if strategy_.delay_fetch_.
+  std::unique_ptr<DelayedFetchBuffers> delayed_fetch_buffers_;
   ExceptionHolder exception_holder_;
   std::atomic<int> running_ops_;
 
@@ -0,0 +1,141 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+/*
+ * A lock-free work-stealing deque of pointers (Chase and Lev, "Dynamic
+ * Circular Work-Stealing Deque", with the memory orders of Le et al.,
+ * "Correct and Efficient Work-Stealing for Weak Memory Models").
+ *
+ * Only the owner thread may Push and Pop, at the bottom, the other threads
+ * Steal from the top. The buffer grows when it is full, the old buffers are
+ * kept until the deque is destroyed because stealers may still read them.
+ */
+template <typename T>
+class WorkStealingDeque {
+ public:
+  explicit WorkStealingDeque(size_t capacity = 64) {
+    size_t cap = 1;
+    while (cap < capacity) cap <<= 1;
+    buffers_.emplace_back(new Buffer(cap));
+    buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+  }
+
+  void Push(T* item) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+    if (b - t > static_cast<int64_t>(buffer->mask)) {
+      buffer = Grow(buffer, t, b);
+    }
+    buffer->Put(b, item);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+
+  // Return nullptr if the deque is empty.
+  T* Pop() {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    T* item = buffer->Get(b);
+    if (t == b) {
+      // The last item, race with the stealers.
+      if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  // Return nullptr if the deque is empty or another thread wins the race.
+  T* Steal() {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) return nullptr;
+    Buffer* buffer = buffer_.load(std::memory_order_acquire);
+    T* item = buffer->Get(t);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  bool Empty() const {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    return b <= t;
+  }
+
+  // Disable copy and assignment
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+ private:
+  struct Buffer {
+    explicit Buffer(size_t capacity)
+        : mask(capacity - 1), items(new std::atomic<T*>[capacity]) {}
+
+    T* Get(int64_t i) const {
+      return items[i & mask].load(std::memory_order_relaxed);
+    }
+    void Put(int64_t i, T* item) {
+      items[i & mask].store(item, std::memory_order_relaxed);
+    }
+
+    size_t mask;
+    std::unique_ptr<std::atomic<T*>[]> items;
+  };
+
+  Buffer* Grow(Buffer* buffer, int64_t t, int64_t b) {
+    buffers_.emplace_back(new Buffer((buffer->mask + 1) << 1));
+    Buffer* bigger = buffers_.back().get();
+    for (int64_t i = t; i < b; ++i) {
+      bigger->Put(i, buffer->Get(i));
+    }
+    buffer_.store(bigger, std::memory_order_release);
+    return bigger;
+  }
+
+  // top_ is written by the stealers and bottom_ by the owner, keep them in
+  // different cache lines.
+  alignas(64) std::atomic<int64_t> top_{0};
+  alignas(64) std::atomic<int64_t> bottom_{0};
+  std::atomic<Buffer*> buffer_;
+  std::vector<std::unique_ptr<Buffer>> buffers_;  // accessed by the owner
+};
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,85 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/work_stealing_deque.h"
+#include <gtest/gtest.h>
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+TEST(WorkStealingDeque, PopAndSteal) {
+  WorkStealingDeque<int> deque(2);
+  std::vector<int> items(10);
+  for (auto& item : items) {
+    deque.Push(&item);
+  }
+  // The owner pops the newest item, the stealers take the oldest ones.
+  EXPECT_EQ(deque.Pop(), &items[9]);
+  EXPECT_EQ(deque.Steal(), &items[0]);
+  EXPECT_EQ(deque.Steal(), &items[1]);
+  for (int i = 8; i >= 2; --i) {
+    EXPECT_EQ(deque.Pop(), &items[i]);
+  }
+  EXPECT_TRUE(deque.Empty());
+  EXPECT_EQ(deque.Pop(), nullptr);
+  EXPECT_EQ(deque.Steal(), nullptr);
+}
+
+TEST(WorkStealingDeque, Concurrent) {
+  const int kItems = 100000;
+  const int kStealers = 4;
+  std::vector<int> items(kItems, 0);
+  std::vector<std::atomic<int>> taken(kItems);
+  for (auto& count : taken) count = 0;
+
+  WorkStealingDeque<int> deque(4);
+  std::atomic<bool> done{false};
+  std::atomic<int> num_taken{0};
+  auto take = [&](int* item) {
+    ++taken[item - items.data()];
+    ++num_taken;
+  };
+
+  std::vector<std::thread> stealers;
+  for (int i = 0; i < kStealers; ++i) {
+    stealers.emplace_back([&] {
+      while (!done) {
+        if (auto* item = deque.Steal()) take(item);
+      }
+    });
+  }
+  for (int i = 0; i < kItems; ++i) {
+    deque.Push(&items[i]);
+    if (i % 3 == 0) {
+      if (auto* item = deque.Pop()) take(item);
+    }
+  }
+  while (auto* item = deque.Pop()) take(item);
+  while (num_taken != kItems) {
+    std::this_thread::yield();
+  }
+  done = true;
+  for (auto& t : stealers) t.join();
+
+  for (auto& count : taken) {
+    EXPECT_EQ(count, 1);
+  }
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
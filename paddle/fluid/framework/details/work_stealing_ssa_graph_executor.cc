@@ -0,0 +1,257 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/work_stealing_ssa_graph_executor.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/details/fetch_op_handle.h"
+#include "paddle/fluid/framework/details/multi_devices_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+// The rounds an idle worker tries to steal before it sleeps.
+static constexpr int kStealRounds = 64;
+
+WorkStealingSSAGraphExecutor::WorkStealingSSAGraphExecutor(
+    const ExecutionStrategy &strategy, const std::vector<Scope *> &local_scopes,
+    const std::vector<platform::Place> &places,
+    std::unique_ptr<ir::Graph> &&graph)
+    : strategy_(strategy),
+      local_scopes_(local_scopes),
+      places_(places),
+      graph_(std::move(graph)),
+      fetch_ctxs_(places),
+      delayed_fetch_buffers_(strategy.delay_fetch_ ? new DelayedFetchBuffers
+                                                   : nullptr) {
+  auto &ops = graph_->Get<details::GraphOps>("ops");
+  for (auto &op : ops) {
+    int dep = static_cast<int>(op->NotReadyInputSize());
+    op_deps_.emplace(op.get(), dep);
+    atomic_op_deps_[op.get()] = dep;
+    if (dep == 0) {
+      bootstrap_ops_.emplace_back(op.get());
+    }
+  }
+
+  size_t num_workers = std::max<size_t>(strategy_.num_threads_, 1);
+  for (size_t i = 0; i < num_workers; ++i) {
+    deques_.emplace_back(new WorkStealingDeque<OpHandleBase>(ops.size()));
+  }
+  for (size_t i = 0; i < num_workers; ++i) {
+    workers_.emplace_back([this, i] { WorkerLoop(i); });
+  }
+}
+
+WorkStealingSSAGraphExecutor::~WorkStealingSSAGraphExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stop_ = true;
+  }
+  sleep_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+FeedFetchList WorkStealingSSAGraphExecutor::Run(
+    const std::vector<std::string> &fetch_tensors) {
+  for (auto &pair : op_deps_) {
+    atomic_op_deps_.at(pair.first) = pair.second;
+  }
+
+  FeedFetchList fetches;
+  fetches.resize(fetch_tensors.size());
+  std::unordered_map<std::string, std::vector<VarHandleBase *>> fetched_vars;
+  std::vector<std::unique_ptr<FetchOpHandle>> fetch_ops;
+
+  for (auto &fetch_var_name : fetch_tensors) {
+    for (auto &var_map : graph_->Get<details::GraphVars>("vars")) {
+      auto it = var_map.find(fetch_var_name);
+      if (it != var_map.end()) {
+        fetched_vars[fetch_var_name].push_back(it->second.rbegin()->get());
+      }
+    }
+  }
+
+  std::vector<OpHandleBase *> ready_ops(bootstrap_ops_);
+  for (size_t i = 0; i < fetch_tensors.size(); ++i) {
+    auto &var_name = fetch_tensors[i];
+    auto fetched_var_it = fetched_vars.find(var_name);
+    PADDLE_ENFORCE(fetched_var_it != fetched_vars.end(),
+                   "Cannot find fetched variable.(Perhaps the main_program "
+                   "is not set to ParallelExecutor)");
+
+    auto &vars = fetched_var_it->second;
+
+    ir::Node *fetch_node =
+        graph_->CreateEmptyNode("fetch", ir::Node::Type::kOperation);
+    auto *op = new FetchOpHandle(fetch_node, &fetches, i, &local_scopes_,
+                                 delayed_fetch_buffers_.get());
+    fetch_ops.emplace_back(op);
+
+    for (auto &p : places_) {
+      op->SetDeviceContext(p, fetch_ctxs_.Get(p));
+    }
+
+    for (auto *var : vars) {
+      op->AddInput(var);
+    }
+
+    int dep = static_cast<int>(op->NotReadyInputSize());
+    atomic_op_deps_[op] = dep;
+    if (dep == 0) {
+      ready_ops.emplace_back(op);
+    }
+  }
+
+  num_complete_ = 0;
+  if (!ready_ops.empty()) {
+    Submit(ready_ops);
+    std::unique_lock<std::mutex> lock(done_mutex_);
+    done_cv_.wait(lock, [this] { return num_pending_ == 0; });
+  }
+
+  size_t num_ops = atomic_op_deps_.size();
+  for (auto &op : fetch_ops) {
+    atomic_op_deps_.erase(op.get());
+  }
+  // Wait FetchOps.
+  ClearFetchOp(graph_.get(), &fetch_ops);
+
+  if (failed_) {
+    failed_ = false;
+    exception_.ReThrow();
+  }
+  PADDLE_ENFORCE_EQ(num_complete_.load(), num_ops,
+                    "Some operators of the graph are not run.");
+  return fetches;
+}
+
+void WorkStealingSSAGraphExecutor::Submit(
+    const std::vector<OpHandleBase *> &ops) {
+  num_pending_ += ops.size();
+  {
+    std::lock_guard<std::mutex> lock(injected_mutex_);
+    injected_ops_.insert(injected_ops_.end(), ops.begin(), ops.end());
+  }
+  num_injected_ += ops.size();
+  NotifyReady(ops.size());
+}
+
+void WorkStealingSSAGraphExecutor::Schedule(size_t id, OpHandleBase *op) {
+  ++num_pending_;
+  deques_[id]->Push(op);
+  NotifyReady(1);
+}
+
+void WorkStealingSSAGraphExecutor::NotifyReady(int64_t num_ready) {
+  num_ready_ += num_ready;
+  if (num_sleeping_ > 0) {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    if (num_ready > 1) {
+      sleep_cv_.notify_all();
+    } else {
+      sleep_cv_.notify_one();
+    }
+  }
+}
+
+void WorkStealingSSAGraphExecutor::FinishOne() {
+  if (num_pending_.fetch_sub(1) == 1) {
+    std::lock_guard<std::mutex> lock(done_mutex_);
+    done_cv_.notify_all();
+  }
+}
+
+OpHandleBase *WorkStealingSSAGraphExecutor::GetOp(size_t id) {
+  OpHandleBase *op = deques_[id]->Pop();
+  if (op == nullptr && num_injected_ > 0) {
+    std::lock_guard<std::mutex> lock(injected_mutex_);
+    if (!injected_ops_.empty()) {
+      op = injected_ops_.front();
+      injected_ops_.pop_front();
+      --num_injected_;
+    }
+  }
+  for (size_t i = 1; op == nullptr && i < deques_.size(); ++i) {
+    op = deques_[(id + i) % deques_.size()]->Steal();
+  }
+  if (op != nullptr) {
+    --num_ready_;
+  }
+  return op;
+}
+
+void WorkStealingSSAGraphExecutor::WorkerLoop(size_t id) {
+  while (true) {
+    OpHandleBase *op = nullptr;
+    for (int i = 0; i < kStealRounds && op == nullptr; ++i) {
+      op = GetOp(id);
+      if (op == nullptr) std::this_thread::yield();
+    }
+    if (op != nullptr) {
+      RunOps(id, op);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    ++num_sleeping_;
+    sleep_cv_.wait(lock, [this] { return stop_ || num_ready_ > 0; });
+    --num_sleeping_;
+    if (stop_) return;
+  }
+}
+
+void WorkStealingSSAGraphExecutor::RunOps(size_t id, OpHandleBase *op) {
+  OpHandleBase *op_to_run = op;
+  while (op_to_run != nullptr) {
+    if (!failed_) {
+      try {
+        op_to_run->Run(strategy_.use_cuda_);
+        ++num_complete_;
+      } catch (...) {
+        exception_.Catch(std::current_exception());
+        failed_ = true;
+      }
+    }
+
+    // The first ready successor inherits the pending count of op_to_run.
+    OpHandleBase *next = nullptr;
+    if (!failed_) {
+      for (auto &output : op_to_run->Outputs()) {
+        for (auto &pending_op : output->PendingOps()) {
+          std::atomic<int> &deps = atomic_op_deps_.at(pending_op);
+          if (deps.fetch_sub(1) == 1) {  // pending_op ready
+            if (next == nullptr) {
+              next = pending_op;
+            } else {
+              Schedule(id, pending_op);
+            }
+          }
+        }
+      }
+    }
+    if (next == nullptr) {
+      FinishOne();
+    }
+    op_to_run = next;
+  }
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,104 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/details/exception_holder.h"
+#include "paddle/fluid/framework/details/execution_strategy.h"
+#include "paddle/fluid/framework/details/fetch_op_handle.h"
+#include "paddle/fluid/framework/details/ssa_graph_executor.h"
+#include "paddle/fluid/framework/details/work_stealing_deque.h"
+
+namespace paddle {
+namespace framework {
+class Scope;
+namespace details {
+
+class OpHandleBase;
+
+// Runs the ready operators on a fixed set of workers, each of them owns a
+// lock-free deque. A worker runs the first ready successor of an operator
+// itself and pushes the others to its own deque, an idle worker steals the
+// oldest operators from the others. So the successors are run on the
+// thread which produced their inputs while it is busy enough, and no lock
+// is taken to dispatch an operator.
+class WorkStealingSSAGraphExecutor : public SSAGraphExecutor {
+ public:
+  WorkStealingSSAGraphExecutor(const ExecutionStrategy &strategy,
+                               const std::vector<Scope *> &local_scopes,
+                               const std::vector<platform::Place> &places,
+                               std::unique_ptr<ir::Graph> &&graph);
+  ~WorkStealingSSAGraphExecutor();
+
+  FeedFetchList Run(const std::vector<std::string> &fetch_tensors) override;
+  const ir::Graph &Graph() const override { return *graph_; }
+
+ private:
+  void WorkerLoop(size_t id);
+  OpHandleBase *GetOp(size_t id);
+  // Run op and the chain of successors that become ready on this worker.
+  void RunOps(size_t id, OpHandleBase *op);
+  void Schedule(size_t id, OpHandleBase *op);
+  void Submit(const std::vector<OpHandleBase *> &ops);
+  void NotifyReady(int64_t num_ready);
+  void FinishOne();
+
+  ExecutionStrategy strategy_;
+  std::vector<Scope *> local_scopes_;
+  std::vector<platform::Place> places_;
+  std::unique_ptr<ir::Graph> graph_;
+  platform::DeviceContextPool fetch_ctxs_;
+  // Only if strategy_.delay_fetch_.
+  std::unique_ptr<DelayedFetchBuffers> delayed_fetch_buffers_;
+
+  std::unordered_map<OpHandleBase *, int> op_deps_;
+  std::unordered_map<OpHandleBase *, std::atomic<int>> atomic_op_deps_;
+  std::vector<OpHandleBase *> bootstrap_ops_;
+
+  std::vector<std::unique_ptr<WorkStealingDeque<OpHandleBase>>> deques_;
+  std::vector<std::thread> workers_;
+
+  // The operators submitted by the thread calling Run.
+  std::mutex injected_mutex_;
+  std::deque<OpHandleBase *> injected_ops_;
+  std::atomic<int64_t> num_injected_{0};
+
+  // The operators in the deques that are not taken yet.
+  std::atomic<int64_t> num_ready_{0};
+  std::atomic<int> num_sleeping_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+  bool stop_{false};
+
+  // The operators that are scheduled but not finished.
+  std::atomic<int64_t> num_pending_{0};
+  std::mutex done_mutex_;
+  std::condition_variable done_cv_;
+
+  std::atomic<size_t> num_complete_{0};
+  std::atomic<bool> failed_{false};
+  ExceptionHolder exception_;
+};
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
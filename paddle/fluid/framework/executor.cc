@@ -17,13 +17,18 @@ limitations under the License. */
 #include "paddle/fluid/framework/feed_fetch_method.h"
 #include "paddle/fluid/framework/lod_rank_table.h"
 #include "paddle/fluid/framework/lod_tensor_array.h"
+#include "paddle/fluid/framework/op_phase_profiler.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/reader.h"
 #include "paddle/fluid/operators/detail/macros.h"
 #include "paddle/fluid/platform/place.h"
 #include "paddle/fluid/platform/profiler.h"
+#include "paddle/fluid/platform/sampling_profiler.h"
 
 DECLARE_bool(benchmark);
+#ifdef PADDLE_WITH_CUDA
+DECLARE_bool(use_stream_ordered_allocator);
+#endif
 DEFINE_bool(use_mkldnn, false, "Use MKLDNN to run");
 
 namespace paddle {
@@ -46,6 +51,30 @@ ExecutorPrepareContext::~ExecutorPrepareContext() {
   VLOG(5) << "destroy ExecutorPrepareContext";
 }
 
+void ExecutorPrepareContext::EnableInferShapeCache() {
+  infer_shape_cache_.reset(new InferShapeCache(
+      InferShapeCache::CollectFeedVars(prog_.Block(block_id_), ops_), ops_));
+}
+
+const RuntimeContext* ExecutorPrepareContext::ResolveRuntimeContext(
+    size_t i, const Scope& scope) {
+  if (runtime_ctxs_.size() != ops_.size()) {
+    runtime_ctxs_.clear();
+    runtime_ctxs_.resize(ops_.size());
+  }
+  auto* op = ops_[i].get();
+  if (dynamic_cast<OperatorWithKernel*>(op) == nullptr) {
+    return nullptr;
+  }
+  auto& runtime_ctx = runtime_ctxs_[i];
+  if (runtime_ctx == nullptr) {
+    runtime_ctx.reset(new RuntimeContext(op->Inputs(), op->Outputs(), scope));
+  } else {
+    runtime_ctx->Resolve(op->Inputs(), op->Outputs(), scope);
+  }
+  return runtime_ctx.get();
+}
+
 template <typename RefCntMap>
 static void DeleteUnusedTensors(const Scope& scope, const OperatorBase* op,
                                 GarbageCollector<Tensor>* gc,
@@ -84,11 +113,11 @@ static void DeleteUnusedTensors(const Scope& scope, const OperatorBase* op,
 Executor::Executor(const platform::Place& place) : place_(place) {}
 
 void Executor::Close() {
+  ClearPreparedContexts();
 #ifdef PADDLE_WITH_DISTRIBUTE
   // TODO(typhoonzero): complete message will need to use real trainer_id,
   // except 0.
-  ::paddle::operators::distributed::RPCClient::GetInstance<
-      ::paddle::operators::distributed::GRPCClient>(0)
+  ::paddle::operators::distributed::RPCClient::GetInstance<RPCCLIENT_T>(0)
       ->SendComplete();
 #endif
 }
@@ -161,9 +190,19 @@ void Executor::CreateVariables(const ProgramDesc& pdesc, Scope* scope,
 }
 
 void Executor::Run(const ProgramDesc& pdesc, Scope* scope, int block_id,
-                   bool create_local_scope, bool create_vars) {
+                   bool create_local_scope, bool create_vars,
+                   bool use_prepared_cache) {
   platform::RecordBlock b(block_id);
   if (FLAGS_use_mkldnn) EnableMKLDNN(pdesc);
+  if (use_prepared_cache) {
+    auto& cached = prepared_cache_[&pdesc][std::to_string(block_id)];
+    if (cached.ctx == nullptr) {
+      cached.ctx = Prepare(pdesc, block_id);
+    }
+    RunPreparedContext(cached.ctx.get(), scope, create_local_scope,
+                       create_vars);
+    return;
+  }
   auto ctx = Prepare(pdesc, block_id);
   RunPreparedContext(ctx.get(), scope, create_local_scope, create_vars);
 }
@@ -256,25 +295,21 @@ static bool has_fetch_operators(
   return fetch_count > 0;
 }
 
-void Executor::Run(const ProgramDesc& program, Scope* scope,
-                   std::map<std::string, const LoDTensor*>* feed_targets,
-                   std::map<std::string, LoDTensor*>* fetch_targets,
-                   bool create_local_scope, bool create_vars,
-                   const std::string& feed_holder_name,
-                   const std::string& fetch_holder_name) {
-  platform::RecordBlock b(kProgramId);
-  if (FLAGS_use_mkldnn) EnableMKLDNN(program);
+// Returns a copy of program with the feed and fetch operators of the targets,
+// or nullptr if program has them already.
+static std::unique_ptr<ProgramDesc> AddFeedFetchOps(
+    const ProgramDesc& program,
+    const std::map<std::string, const LoDTensor*>* feed_targets,
+    const std::map<std::string, LoDTensor*>* fetch_targets,
+    const std::string& feed_holder_name,
+    const std::string& fetch_holder_name) {
   bool has_feed_ops =
       has_feed_operators(program.Block(0), *feed_targets, feed_holder_name);
   bool has_fetch_ops =
       has_fetch_operators(program.Block(0), *fetch_targets, fetch_holder_name);
 
-  ProgramDesc* copy_program = const_cast<ProgramDesc*>(&program);
-  std::unique_ptr<ProgramDesc> unique_ptr_of_copy_program;
-  if (!has_feed_ops || !has_fetch_ops) {
-    unique_ptr_of_copy_program.reset(new ProgramDesc(program));
-    copy_program = unique_ptr_of_copy_program.get();
-  }
+  if (has_feed_ops && has_fetch_ops) return nullptr;
+  std::unique_ptr<ProgramDesc> copy_program(new ProgramDesc(program));
   auto* global_block = copy_program->MutableBlock(0);
 
   if (!has_feed_ops) {
@@ -323,12 +358,51 @@ void Executor::Run(const ProgramDesc& program, Scope* scope,
     }
   }
 
-  auto ctx = Prepare(*copy_program, 0);
+  return copy_program;
+}
+
+void Executor::Run(const ProgramDesc& program, Scope* scope,
+                   std::map<std::string, const LoDTensor*>* feed_targets,
+                   std::map<std::string, LoDTensor*>* fetch_targets,
+                   bool create_local_scope, bool create_vars,
+                   const std::string& feed_holder_name,
+                   const std::string& fetch_holder_name,
+                   bool use_prepared_cache) {
+  platform::RecordBlock b(kProgramId);
+  if (FLAGS_use_mkldnn) EnableMKLDNN(program);
+  if (use_prepared_cache) {
+    std::string key = feed_holder_name + ":" + fetch_holder_name;
+    for (auto& feed_target : *feed_targets) {
+      key += ";" + feed_target.first;
+    }
+    key += ":";
+    for (auto& fetch_target : *fetch_targets) {
+      key += ";" + fetch_target.first;
+    }
+    auto& cached = prepared_cache_[&program][key];
+    if (cached.ctx == nullptr) {
+      cached.program = AddFeedFetchOps(program, feed_targets, fetch_targets,
+                                       feed_holder_name, fetch_holder_name);
+      cached.ctx = Prepare(cached.program ? *cached.program : program, 0);
+    }
+    RunPreparedContext(cached.ctx.get(), scope, feed_targets, fetch_targets,
+                       create_local_scope, create_vars, feed_holder_name,
+                       fetch_holder_name);
+    return;
+  }
+
+  auto copy_program = AddFeedFetchOps(program, feed_targets, fetch_targets,
+                                      feed_holder_name, fetch_holder_name);
+  auto ctx = Prepare(copy_program ? *copy_program : program, 0);
   RunPreparedContext(ctx.get(), scope, feed_targets, fetch_targets,
                      create_local_scope, create_vars, feed_holder_name,
                      fetch_holder_name);
 }
 
+void Executor::DropPreparedContexts(const ProgramDesc& program) {
+  prepared_cache_.erase(&program);
+}
+
 std::unique_ptr<ExecutorPrepareContext> Executor::Prepare(
     const ProgramDesc& program, int block_id) {
   std::unique_ptr<ExecutorPrepareContext> ctx(
@@ -358,7 +432,8 @@ std::vector<std::shared_ptr<ExecutorPrepareContext>> Executor::Prepare(
 
 void Executor::RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
                                   bool create_local_scope, bool create_vars,
-                                  bool keep_kids) {
+                                  bool keep_kids, bool force_eager_deletion) {
+  platform::SampledIteration sampled_iteration;
   Scope* local_scope = scope;
   if (create_vars) {
     if (create_local_scope) {
@@ -369,15 +444,18 @@ void Executor::RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
 
   int64_t max_memory_size = GetEagerDeletionThreshold();
   std::unique_ptr<GarbageCollector<Tensor>> gc;
-  // WhileOp would set keep_kids to false
-  // WhileGradOp would need the scopes created in WhileOp
-  // Perhaps, we should not perform eager deletion in WhileOp
-  // The scopes and variables created by WhileOp would be deleted
-  // in WhileGradOp.
-  if (max_memory_size >= 0 && !keep_kids) {
+  // WhileOp sets keep_kids since WhileGradOp needs the variables of the step
+  // scopes, they are only deleted eagerly at inference, where WhileOp sets
+  // force_eager_deletion.
+  if (max_memory_size >= 0 && (!keep_kids || force_eager_deletion) &&
+      !ctx->ref_cnts_.empty()) {
     ctx->ResetReferenceCount();
 #ifdef PADDLE_WITH_CUDA
-    if (platform::is_gpu_place(place_)) {
+    if (platform::is_gpu_place(place_) &&
+        FLAGS_use_stream_ordered_allocator) {
+      gc.reset(new StreamOrderedGarbageCollector<Tensor>(
+          boost::get<platform::CUDAPlace>(place_), max_memory_size));
+    } else if (platform::is_gpu_place(place_)) {
       gc.reset(new DefaultStreamGarbageCollector<Tensor>(
           boost::get<platform::CUDAPlace>(place_), max_memory_size));
     } else {
@@ -389,10 +467,21 @@ void Executor::RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
 #endif
   }
 
-  for (auto& op : ctx->ops_) {
-    op->Run(*local_scope, place_);
+  auto* infer_shape_cache = ctx->infer_shape_cache_.get();
+  if (infer_shape_cache != nullptr) {
+    infer_shape_cache->BeginRun(*local_scope);
+  }
+
+  for (size_t i = 0; i < ctx->ops_.size(); ++i) {
+    auto& op = ctx->ops_[i];
+    {
+      InferShapeCache::OpGuard guard(infer_shape_cache, i);
+      op->Run(*local_scope, place_,
+              ctx->ResolveRuntimeContext(i, *local_scope));
+    }
 
     if (gc != nullptr) {
+      OpPhaseTimer timer(op->Type(), kGCPhase);
       DeleteUnusedTensors(*local_scope, op.get(), gc.get(),
                           &(ctx->cur_ref_cnts_));
     }
@@ -403,6 +492,10 @@ void Executor::RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
     }
   }
 
+  if (infer_shape_cache != nullptr) {
+    infer_shape_cache->EndRun();
+  }
+
   if (gc != nullptr) {
     gc->Wait();
   } else {
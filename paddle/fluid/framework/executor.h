@@ -15,9 +15,13 @@ limitations under the License. */
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include "paddle/fluid/framework/garbage_collector.h"
+#include "paddle/fluid/framework/infer_shape_cache.h"
 #include "paddle/fluid/framework/op_info.h"
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/framework/scope.h"
@@ -28,17 +32,69 @@ namespace paddle {
 namespace framework {
 extern void InitializeVariable(Variable* var, proto::VarType::Type var_type);
 
+// The blocks run by a control flow op, such as the step block of while.
+inline std::vector<BlockDesc*> GetSubBlocks(const OpDesc& op) {
+  std::vector<BlockDesc*> blocks;
+  for (auto& attr : op.GetAttrMap()) {
+    if (attr.second.type() == typeid(BlockDesc*)) {
+      blocks.push_back(boost::get<BlockDesc*>(attr.second));
+    } else if (attr.second.type() == typeid(std::vector<BlockDesc*>)) {
+      auto& sub_blocks = boost::get<std::vector<BlockDesc*>>(attr.second);
+      blocks.insert(blocks.end(), sub_blocks.begin(), sub_blocks.end());
+    }
+  }
+  return blocks;
+}
+
+// The variables referenced by the ops of the block and its nested blocks.
+inline void CollectReferencedVars(const BlockDesc& block,
+                                  std::unordered_set<std::string>* vars) {
+  for (auto* op : block.AllOps()) {
+    for (auto& name : op->InputArgumentNames()) vars->insert(name);
+    for (auto& name : op->OutputArgumentNames()) vars->insert(name);
+    for (auto* sub_block : GetSubBlocks(*op)) {
+      CollectReferencedVars(*sub_block, vars);
+    }
+  }
+}
+
+// The variables the sub-blocks of op reference but op does not list in its
+// inputs or outputs. Their last uses are unknown to the block of op, so they
+// should never be deleted eagerly in it.
+inline std::unordered_set<std::string> GetUnlistedSubBlockVars(
+    const OpDesc& op) {
+  std::unordered_set<std::string> vars;
+  for (auto* sub_block : GetSubBlocks(op)) {
+    CollectReferencedVars(*sub_block, &vars);
+  }
+  if (vars.empty()) return vars;
+  for (auto& name : op.InputArgumentNames()) vars.erase(name);
+  for (auto& name : op.OutputArgumentNames()) vars.erase(name);
+  return vars;
+}
+
+// The number of the references to each variable of the block. A variable
+// read by a sub-block is counted by the control flow op running the block,
+// so the variables of a step are released after the last one.
 template <typename T>
 std::unordered_map<std::string, T> GetNonPersistableReferenceCount(
     const ProgramDesc& prog, size_t block_id) {
   auto& block = prog.Block(block_id);
   std::unordered_map<std::string, T> ref_cnts;
+  std::unordered_set<std::string> skip_vars;
+  for (auto op_desc : block.AllOps()) {
+    auto vars = GetUnlistedSubBlockVars(*op_desc);
+    skip_vars.insert(vars.begin(), vars.end());
+  }
 
   auto update_ref_cnts = [&](OpDesc* op_desc, const VariableNameMap& name_map) {
     for (auto& name_pair : name_map) {
       for (auto& name : name_pair.second) {
         auto* var_desc = block.FindVar(name);
-        if (var_desc == nullptr || var_desc->Persistable()) continue;
+        if (var_desc == nullptr || var_desc->Persistable() ||
+            skip_vars.count(name)) {
+          continue;
+        }
         auto type = var_desc->Proto()->type().type();
         if (type != proto::VarType::LOD_TENSOR &&
             type != proto::VarType::SELECTED_ROWS) {
@@ -68,12 +124,35 @@ struct ExecutorPrepareContext {
 
   void ResetReferenceCount() { cur_ref_cnts_ = ref_cnts_; }
 
+  // Keep the variables alive until the scope is deleted, e.g. the states and
+  // outputs of a step which are read by the control flow op after the run.
+  void SkipEagerDeletionVars(const std::vector<std::string>& names) {
+    for (auto& name : names) ref_cnts_.erase(name);
+  }
+
+  void DisableEagerDeletion() { ref_cnts_.clear(); }
+
+  // Record the inferred output shapes of every op, and replay them instead
+  // of running InferShape while the feed shapes stay the same. Only the feed
+  // shapes are checked, it should not be enabled for the blocks with output
+  // shapes depending on the data values. It should be called after the ops
+  // are created.
+  void EnableInferShapeCache();
+
+  // Resolve the variables of the i-th op in scope right before it runs,
+  // reusing the slots of the last run. It returns nullptr for the operators
+  // without kernels, which do not use the runtime context.
+  const RuntimeContext* ResolveRuntimeContext(size_t i, const Scope& scope);
+
   const framework::ProgramDesc& prog_;
   size_t block_id_;
   std::vector<std::unique_ptr<OperatorBase>> ops_;
+  std::vector<std::unique_ptr<RuntimeContext>> runtime_ctxs_;
 
   std::unordered_map<std::string, int> ref_cnts_;
   std::unordered_map<std::string, int> cur_ref_cnts_;
+
+  std::unique_ptr<InferShapeCache> infer_shape_cache_;
 };
 
 class Executor {
@@ -96,17 +175,30 @@ class Executor {
    * @param
    *  ProgramDesc
    *  Scope
+   *
+   * @note With use_prepared_cache, the operators are created once for the
+   *  program and the block, and reused by the following runs. The cached
+   *  context refers to prog, which must not be changed or destroyed until
+   *  DropPreparedContexts(prog) is called.
    */
   void Run(const ProgramDesc& prog, Scope* scope, int block_id,
-           bool create_local_scope = true, bool create_vars = true);
+           bool create_local_scope = true, bool create_vars = true,
+           bool use_prepared_cache = false);
 
-  // This API is very slow.
+  // This API is very slow, unless use_prepared_cache is set, see above. The
+  // cache is also keyed by the names of the feed and fetch targets.
   void Run(const ProgramDesc& program, Scope* scope,
            std::map<std::string, const LoDTensor*>* feed_targets,
            std::map<std::string, LoDTensor*>* fetch_targets,
            bool create_local_scope = true, bool create_vars = true,
            const std::string& feed_holder_name = "feed",
-           const std::string& fetch_holder_name = "fetch");
+           const std::string& fetch_holder_name = "fetch",
+           bool use_prepared_cache = false);
+
+  // Drop the cached contexts of the program, after it is changed.
+  void DropPreparedContexts(const ProgramDesc& program);
+
+  void ClearPreparedContexts() { prepared_cache_.clear(); }
 
   static std::unique_ptr<ExecutorPrepareContext> Prepare(
       const ProgramDesc& program, int block_id);
@@ -116,9 +208,13 @@ class Executor {
 
   void CreateVariables(const ProgramDesc& pdesc, Scope* scope, int block_id);
 
+  // The variables are deleted eagerly if the eager deletion is enabled and
+  // keep_kids is not set, or force_eager_deletion is set. The control flow
+  // ops keeping the step scopes set it when no gradient reads the scopes.
   void RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
                           bool create_local_scope = true,
-                          bool create_vars = true, bool keep_kids = false);
+                          bool create_vars = true, bool keep_kids = false,
+                          bool force_eager_deletion = false);
 
   // This API is very slow.
   void RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
@@ -132,7 +228,17 @@ class Executor {
   void EnableMKLDNN(const ProgramDesc& program);
 
  private:
+  struct CachedContext {
+    // The copy of the program with the feed and fetch operators, if they
+    // were added to it.
+    std::unique_ptr<ProgramDesc> program;
+    std::unique_ptr<ExecutorPrepareContext> ctx;
+  };
+
   const platform::Place place_;
+  std::unordered_map<const ProgramDesc*,
+                     std::unordered_map<std::string, CachedContext>>
+      prepared_cache_;
 };
 
 }  // namespace framework
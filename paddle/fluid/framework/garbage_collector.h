@@ -19,12 +19,16 @@
 #include <functional>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <unordered_map>
 #include "paddle/fluid/platform/device_context.h"
 
 namespace paddle {
 namespace framework {
 
-// T should have memory_size() and clear() method
+// T should have memory_size(), holder_id(), holder_use_count() and clear()
+// methods. The memory shared by the garbages and the tensors still used, e.g.
+// a view by ShareDataWith, is not freed by clearing, it is only counted when
+// all the tensors using it are garbages.
 template <typename T>
 class GarbageCollector {
  public:
@@ -39,6 +43,7 @@ class GarbageCollector {
   void Reset() {
     std::lock_guard<std::mutex> guard(mutex_);
     garbages_.reset(new std::deque<T *>());
+    holder_counts_.clear();
     cur_memory_size_ = 0;
   }
 
@@ -54,12 +59,17 @@ class GarbageCollector {
       std::lock_guard<std::mutex> guard(mutex_);
       for (auto *obj : objs) {
         garbages_->push_back(obj);
-        cur_memory_size_ += obj->memory_size();
+        if (obj->holder_id() == nullptr) continue;
+        size_t count = ++holder_counts_[obj->holder_id()];
+        if (count == obj->holder_use_count()) {
+          cur_memory_size_ += obj->memory_size();
+        }
       }
       if (cur_memory_size_ >= max_memory_size_) {
         cur_memory_size_ = 0;
         clear_deque = garbages_;
         garbages_.reset(new std::deque<T *>());
+        holder_counts_.clear();
       }
     }
 
@@ -78,6 +88,8 @@ class GarbageCollector {
 
   platform::DeviceContext *dev_ctx_;
   std::shared_ptr<std::deque<T *>> garbages_;
+  // The number of the garbages using each memory block.
+  std::unordered_map<const void *, size_t> holder_counts_;
   mutable std::mutex mutex_;
   const size_t max_memory_size_;
   size_t cur_memory_size_ = 0;
@@ -121,6 +133,23 @@ class DefaultStreamGarbageCollector : public GarbageCollector<T> {
   }
 };
 
+// Used with FLAGS_use_stream_ordered_allocator. The memory of the garbages
+// is freed on the stream of the device context, where every kernel using it
+// has already been enqueued, so the garbages are cleared at once instead of
+// in a stream callback.
+template <typename T>
+class StreamOrderedGarbageCollector : public DefaultStreamGarbageCollector<T> {
+ public:
+  StreamOrderedGarbageCollector(const platform::CUDAPlace &place,
+                                size_t max_memory_size)
+      : DefaultStreamGarbageCollector<T>(place, max_memory_size) {}
+
+ protected:
+  void ClearCallback(const std::function<void()> &callback) override {
+    callback();
+  }
+};
+
 template <typename T>
 class StreamGarbageCollector : public GarbageCollector<T> {
  public:
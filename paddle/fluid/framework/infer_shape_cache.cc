@@ -0,0 +1,123 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/infer_shape_cache.h"
+#include "paddle/fluid/framework/feed_fetch_type.h"
+#include "paddle/fluid/framework/selected_rows.h"
+
+namespace paddle {
+namespace framework {
+
+static thread_local InferShapeRecord* g_infer_shape_record = nullptr;
+
+InferShapeRecord* InferShapeRecord::Take() {
+  auto* record = g_infer_shape_record;
+  g_infer_shape_record = nullptr;
+  return record;
+}
+
+void InferShapeRecord::Record(const std::vector<std::string>& output_names,
+                              const Scope& scope) {
+  outputs_.clear();
+  for (auto& name : output_names) {
+    auto* var = scope.FindVar(name);
+    if (var == nullptr) continue;
+    if (var->IsType<LoDTensor>()) {
+      auto& tensor = var->Get<LoDTensor>();
+      outputs_.push_back({name, false, tensor.dims(), tensor.lod()});
+    } else if (var->IsType<SelectedRows>()) {
+      auto& value = var->Get<SelectedRows>().value();
+      outputs_.push_back({name, true, value.dims(), LoD()});
+    } else {
+      // The InferShape of the other variable types can not be replayed.
+      outputs_.clear();
+      recorded_ = false;
+      return;
+    }
+  }
+  recorded_ = true;
+}
+
+void InferShapeRecord::Replay(const Scope& scope) const {
+  for (auto& output : outputs_) {
+    auto* var = scope.FindVar(output.name);
+    PADDLE_ENFORCE_NOT_NULL(var, "Variable %s is not found when replaying %s",
+                            output.name, "the recorded shapes.");
+    if (output.is_selected_rows) {
+      var->GetMutable<SelectedRows>()->mutable_value()->Resize(output.dims);
+    } else {
+      auto* tensor = var->GetMutable<LoDTensor>();
+      tensor->Resize(output.dims);
+      tensor->set_lod(output.lod);
+    }
+  }
+}
+
+InferShapeCache::InferShapeCache(
+    const std::vector<std::string>& feed_vars,
+    const std::vector<std::unique_ptr<OperatorBase>>& ops)
+    : feed_vars_(feed_vars), records_(ops.size()) {
+  auto& all_op_kernels = OperatorWithKernel::AllOpKernels();
+  for (auto& op : ops) {
+    // Only the operators with kernels run InferShape at runtime.
+    has_kernel_.push_back(all_op_kernels.count(op->Type()) != 0);
+  }
+}
+
+InferShapeCache::Signature InferShapeCache::GetSignature(
+    const Scope& scope) const {
+  Signature signature;
+  for (auto& name : feed_vars_) {
+    auto* var = scope.FindVar(name);
+    if (var == nullptr) {
+      signature.emplace_back(make_ddim({-1}), LoD());
+    } else if (var->IsType<LoDTensor>()) {
+      auto& tensor = var->Get<LoDTensor>();
+      signature.emplace_back(tensor.dims(), tensor.lod());
+    } else if (var->IsType<FeedFetchList>()) {
+      for (auto& tensor : var->Get<FeedFetchList>()) {
+        signature.emplace_back(tensor.dims(), tensor.lod());
+      }
+    }
+  }
+  return signature;
+}
+
+void InferShapeCache::BeginRun(const Scope& scope) {
+  auto signature = GetSignature(scope);
+  if (complete_ && signature == signature_) {
+    ++hit_count_;
+    return;
+  }
+  ++miss_count_;
+  VLOG(3) << "feed shapes changed, run full shape inference";
+  for (auto& record : records_) {
+    record.Clear();
+  }
+  complete_ = false;
+  signature_ = std::move(signature);
+}
+
+void InferShapeCache::EndRun() { complete_ = true; }
+
+InferShapeCache::OpGuard::OpGuard(InferShapeCache* cache, size_t idx) {
+  if (cache != nullptr && cache->has_kernel_[idx]) {
+    g_infer_shape_record = &cache->records_[idx];
+  }
+}
+
+InferShapeCache::OpGuard::~OpGuard() { g_infer_shape_record = nullptr; }
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,154 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/framework/ddim.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/scope.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * The dims and LoD of an operator's outputs right after its runtime
+ * InferShape. Replaying the record puts the outputs in the same state
+ * without running InferShape again.
+ */
+class InferShapeRecord {
+ public:
+  bool recorded() const { return recorded_; }
+
+  void Record(const std::vector<std::string>& output_names,
+              const Scope& scope);
+
+  void Replay(const Scope& scope) const;
+
+  void Clear() {
+    recorded_ = false;
+    outputs_.clear();
+  }
+
+  // Return the record of the operator that is being run on this thread, or
+  // nullptr. The record is released by the first call, so that the nested
+  // operators run by it do not see the record.
+  static InferShapeRecord* Take();
+
+ private:
+  friend class InferShapeCache;
+
+  struct Output {
+    std::string name;
+    bool is_selected_rows;
+    DDim dims;
+    LoD lod;
+  };
+
+  bool recorded_{false};
+  std::vector<Output> outputs_;
+};
+
+/*
+ * Memoizes the runtime InferShape results of a prepared block. The cache is
+ * keyed by the dims and LoD of the variables the block reads from outside,
+ * e.g. the feed targets. While they stay the same, the recorded output
+ * shapes of every operator are replayed and InferShape is skipped. Any
+ * change of the feed shapes falls back to a full shape inference.
+ *
+ * Only the feed shapes are checked, so the block should not have operators
+ * whose output shapes depend on the values of the data, e.g. the kernels
+ * resizing their outputs by the data like unique or multiclass_nms, and the
+ * operators reading the shapes of such outputs. Their recorded shapes would
+ * be replayed although the data changed.
+ *
+ * The cache is not thread-safe, one cache should be used by one executor.
+ */
+class InferShapeCache {
+ public:
+  InferShapeCache(const std::vector<std::string>& feed_vars,
+                  const std::vector<std::unique_ptr<OperatorBase>>& ops);
+
+  // Compare the feed shapes in the scope with the ones of the last run, and
+  // drop all the records when they are different.
+  void BeginRun(const Scope& scope);
+
+  // Mark the records complete, they will be replayed by the following runs.
+  void EndRun();
+
+  int64_t hit_count() const { return hit_count_; }
+  int64_t miss_count() const { return miss_count_; }
+
+  // Make the record of the idx-th operator visible to it while it runs.
+  class OpGuard {
+   public:
+    OpGuard(InferShapeCache* cache, size_t idx);
+    ~OpGuard();
+  };
+
+  // The non-persistable tensors that the ops read before they are written
+  // in the block, and the feed holders.
+  static std::vector<std::string> CollectFeedVars(
+      const BlockDesc& block,
+      const std::vector<std::unique_ptr<OperatorBase>>& ops);
+
+ private:
+  using Signature = std::vector<std::pair<DDim, LoD>>;
+  Signature GetSignature(const Scope& scope) const;
+
+  std::vector<std::string> feed_vars_;
+  std::vector<bool> has_kernel_;
+  std::vector<InferShapeRecord> records_;
+  Signature signature_;
+  bool complete_{false};
+  int64_t hit_count_{0};
+  int64_t miss_count_{0};
+};
+
+inline std::vector<std::string> InferShapeCache::CollectFeedVars(
+    const BlockDesc& block,
+    const std::vector<std::unique_ptr<OperatorBase>>& ops) {
+  std::vector<std::string> feed_vars;
+  std::unordered_set<std::string> visited;
+  for (auto& op : ops) {
+    for (auto& name_pair : op->Inputs()) {
+      for (auto& name : name_pair.second) {
+        if (!visited.insert(name).second) continue;
+        auto* var_desc = block.FindVarRecursive(name);
+        if (var_desc == nullptr) continue;
+        auto type = var_desc->GetType();
+        if (type == proto::VarType::FEED_MINIBATCH ||
+            (type == proto::VarType::LOD_TENSOR && !var_desc->Persistable())) {
+          feed_vars.push_back(name);
+        }
+      }
+    }
+    for (auto& name_pair : op->Outputs()) {
+      for (auto& name : name_pair.second) {
+        visited.insert(name);
+      }
+    }
+  }
+  return feed_vars;
+}
+
+}  // namespace framework
+}  // namespace paddle
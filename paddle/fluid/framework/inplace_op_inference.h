@@ -0,0 +1,66 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/type_defs.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * Declare the (input, output) arguments an operator may compute in place,
+ * i.e. the output may share the memory of the input, for every element of
+ * the output only depends on the same element of the input. The kernels of
+ * the operator should work when the two are the same variable.
+ */
+class InplaceOpInference {
+ public:
+  virtual ~InplaceOpInference() {}
+  virtual InplacePairs operator()() const = 0;
+};
+
+// X may be computed in place to Out.
+class SingleOpInplaceInToOut : public InplaceOpInference {
+ public:
+  InplacePairs operator()() const override { return {{"X", "Out"}}; }
+};
+
+/*
+ * The operators whose outputs are views of their inputs, i.e. always share
+ * the memory with new dims, e.g. reshape. The memory of such a pair lives
+ * until both die, and neither of them can be written in place while the
+ * other is used.
+ */
+class ShareDataOpInference : public InplaceOpInference {};
+
+// Out is a view of X.
+class SingleOpShareDataInToOut : public ShareDataOpInference {
+ public:
+  InplacePairs operator()() const override { return {{"X", "Out"}}; }
+};
+
+// X@GRAD is a view of Out@GRAD.
+class SingleGradOpShareDataInToOut : public ShareDataOpInference {
+ public:
+  InplacePairs operator()() const override {
+    return {{GradVarName("Out"), GradVarName("X")}};
+  }
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,43 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/bf16_convert_pass.h"
+#include <unordered_set>
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// The operators having bfloat16 CPU kernels.
+const std::unordered_set<std::string> kBF16Ops = {
+    "mul",     "fc",   "conv2d",     "elementwise_add", "elementwise_mul",
+    "relu",    "tanh", "leaky_relu", "relu6",           "brelu",
+    "sigmoid", "elu",  "swish"};
+
+}  // namespace
+
+bool BF16ConvertPass::CanConvert(Node* n) const {
+  auto* op = n->Op();
+  if (!kBF16Ops.count(op->Type())) return false;
+  return !op->HasAttr("use_mkldnn") ||
+         !boost::get<bool>(op->GetAttr("use_mkldnn"));
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(bf16_convert_pass, paddle::framework::ir::BF16ConvertPass);
@@ -0,0 +1,46 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include "paddle/fluid/framework/ir/fp16_convert_pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Run the operators having bfloat16 CPU kernels in bfloat16, for the
+ * inference on CPU, in the same way as FP16ConvertPass. The GEMMs of mul, fc
+ * and conv2d accumulate in FP32, only their outputs are rounded to BF16.
+ *
+ * The operators run by MKLDNN keep FP32, since MKLDNN has no bfloat16
+ * kernels of them.
+ */
+class BF16ConvertPass : public FP16ConvertPass {
+ public:
+  virtual ~BF16ConvertPass() {}
+
+ protected:
+  bool CanConvert(Node* n) const override;
+  proto::VarType::Type LowPrecisionType() const override {
+    return proto::VarType::BF16;
+  }
+  std::string LowPrecisionName() const override { return "bf16"; }
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
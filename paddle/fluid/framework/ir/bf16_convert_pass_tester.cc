@@ -0,0 +1,126 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/bf16_convert_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/platform/bfloat16.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::map<std::string, std::string>& inputs,
+           const std::map<std::string, std::string>& outputs,
+           bool use_mkldnn = false) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  op->SetAttr("use_mkldnn", use_mkldnn);
+  for (auto& input : inputs) {
+    op->SetInput(input.first, {input.second});
+  }
+  for (auto& output : outputs) {
+    op->SetOutput(output.first, {output.second});
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kForward));
+}
+
+// (a, w1)->conv2d(mkldnn)->b->relu->c
+// (c, w2)->mul->d->softmax->e
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v :
+       std::vector<std::string>({"a", "b", "c", "d", "e", "w1", "w2"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    if (v.size() > 1) {
+      var->SetPersistable(true);
+    }
+  }
+
+  SetOp(&prog, "conv2d", {{"Input", "a"}, {"Filter", "w1"}}, {{"Output", "b"}},
+        true);
+  SetOp(&prog, "relu", {{"X", "b"}}, {{"Out", "c"}});
+  SetOp(&prog, "mul", {{"X", "c"}, {"Y", "w2"}}, {{"Out", "d"}});
+  SetOp(&prog, "softmax", {{"X", "d"}}, {{"Out", "e"}});
+  return prog;
+}
+
+void InitParam(Scope* scope, const std::string& name) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  auto* data = tensor->mutable_data<float>(make_ddim({2, 2}),
+                                           platform::CPUPlace());
+  for (int i = 0; i < 4; ++i) {
+    data[i] = 0.5f * i;
+  }
+}
+
+TEST(BF16ConvertPass, basic) {
+  platform::DeviceContextPool::Init({platform::CPUPlace()});
+  Scope scope;
+  InitParam(&scope, "w1");
+  InitParam(&scope, "w2");
+
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  graph->Set(kParamScopeAttr, new Scope*(&scope));
+  auto pass = PassRegistry::Instance().Get("bf16_convert_pass");
+  graph = pass->Apply(std::move(graph));
+
+  std::map<std::string, proto::VarType::Type> dtypes;
+  int cast_count = 0;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && node->Var()) {
+      dtypes[node->Name()] = node->Var()->GetDataType();
+    }
+    if (!node->IsOp()) continue;
+    auto* op = node->Op();
+    if (op->Type() == "cast") {
+      ++cast_count;
+    } else if (op->Type() == "conv2d") {
+      // The MKLDNN conv2d is kept in FP32.
+      EXPECT_EQ(op->Input("Input")[0], "a");
+    } else if (op->Type() == "relu") {
+      EXPECT_EQ(op->Input("X")[0], "b@bf16");
+    } else if (op->Type() == "mul") {
+      EXPECT_EQ(op->Input("X")[0], "c");
+      EXPECT_EQ(op->Output("Out")[0], "d@bf16");
+    }
+  }
+  // b to BF16, d back to FP32.
+  EXPECT_EQ(cast_count, 2);
+  EXPECT_EQ(dtypes["b"], proto::VarType::FP32);
+  EXPECT_EQ(dtypes["c"], proto::VarType::BF16);
+  EXPECT_EQ(dtypes["d"], proto::VarType::FP32);
+  EXPECT_EQ(dtypes["w1"], proto::VarType::FP32);
+  EXPECT_EQ(dtypes["w2"], proto::VarType::BF16);
+
+  auto& w2 = scope.FindVar("w2")->Get<LoDTensor>();
+  ASSERT_TRUE(w2.type() == typeid(platform::bfloat16));
+  EXPECT_EQ(w2.dims(), make_ddim({2, 2}));
+  EXPECT_FLOAT_EQ(static_cast<float>(w2.data<platform::bfloat16>()[3]), 1.5f);
+  EXPECT_TRUE(scope.FindVar("w1")->Get<LoDTensor>().type() == typeid(float));
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(bf16_convert_pass);
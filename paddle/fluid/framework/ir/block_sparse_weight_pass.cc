@@ -0,0 +1,190 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/block_sparse_weight_pass.h"
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/block_sparse_gemm.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+namespace math = operators::math;
+
+// The operators supporting the block-sparse weight, and the inputs of their
+// weights.
+const std::unordered_map<std::string, std::string> kWeightInputs{
+    {"mul", "Y"}, {"fc", "W"}};
+
+// The block sizes tried, the largest first.
+const int kBlockSizes[] = {16, 4};
+
+// Whether the op reads var as its weight by the plain CPU kernel.
+bool ReadsWeight(Node* op, Node* var) {
+  if (!op->IsOp() || !op->Op()) return false;
+  auto it = kWeightInputs.find(op->Op()->Type());
+  if (it == kWeightInputs.end() ||
+      op->Op()->Input(it->second) != std::vector<std::string>({var->Name()})) {
+    return false;
+  }
+  if (op->Op()->Type() == "mul") {
+    return boost::get<int>(op->Op()->GetAttr("y_num_col_dims")) == 1;
+  }
+  return !op->Op()->HasAttr("use_mkldnn") ||
+         !boost::get<bool>(op->Op()->GetAttr("use_mkldnn"));
+}
+
+// Whether var is an FP32 persistable never written by the graph.
+bool IsConstantWeight(Node* var) {
+  return var->IsVar() && var->Var() && var->Var()->Persistable() &&
+         var->Var()->GetType() == proto::VarType::LOD_TENSOR &&
+         var->Var()->GetDataType() == proto::VarType::FP32 &&
+         var->inputs.empty();
+}
+
+// The best time in microseconds of a few calls of fn after a warm-up call.
+template <typename Fn>
+double TimeUs(Fn fn) {
+  const int kRepeats = 5;
+  fn();
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < kRepeats; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> BlockSparseWeightPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+  FusePassBase::Init("block_sparse_weight", graph.get());
+  auto* scope = param_scope();
+  float min_sparsity = Has("min_sparsity") ? Get<float>("min_sparsity") : 0.7f;
+  float min_speedup = Has("min_speedup") ? Get<float>("min_speedup") : 1.f;
+  int batch_size = Has("batch_size") ? Get<int>("batch_size") : 1;
+  PADDLE_ENFORCE_GT(batch_size, 0);
+
+  // The ops reading each weight, sorted by the names for the order of the
+  // logs.
+  std::map<std::string, std::vector<Node*>> readers;
+  for (auto* node : graph->Nodes()) {
+    if (!IsConstantWeight(node)) continue;
+    for (auto* op : node->outputs) {
+      if (ReadsWeight(op, node)) readers[node->Name()].push_back(op);
+    }
+  }
+
+  auto& dev_ctx = *static_cast<platform::CPUDeviceContext*>(
+      platform::DeviceContextPool::Instance().Get(platform::CPUPlace()));
+  auto blas = math::GetBlas<platform::CPUDeviceContext, float>(dev_ctx);
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+  int num_sparse = 0;
+  int num_weights = 0;
+  double dense_total_us = 0;
+  double total_us = 0;
+  for (auto& it : readers) {
+    const std::string& name = it.first;
+    auto* var = scope->FindVar(name);
+    PADDLE_ENFORCE_NOT_NULL(var, "The weight %s is not in the scope", name);
+    auto& weight = var->Get<LoDTensor>();
+    if (!weight.IsInitialized() || !platform::is_cpu_place(weight.place()) ||
+        weight.dims().size() != 2) {
+      continue;
+    }
+    const int k = weight.dims()[0];
+    const int n = weight.dims()[1];
+    const float* w = weight.data<float>();
+    int block_size = 0;
+    double sparsity = 0;
+    for (int size : kBlockSizes) {
+      sparsity = math::BlockSparsity(w, k, n, size);
+      if (sparsity >= min_sparsity) {
+        block_size = size;
+        break;
+      }
+    }
+    if (block_size == 0) continue;
+    ++num_sparse;
+
+    const std::string sparse_name = name + math::kBlockSparseSuffix;
+    auto* sparse = scope->Var(sparse_name)
+                       ->GetMutable<math::BlockSparseMatrix<float>>();
+    sparse->FromDense(w, k, n, block_size);
+
+    std::vector<float> x(static_cast<size_t>(batch_size) * k);
+    for (auto& v : x) v = dist(rng);
+    std::vector<float> out(static_cast<size_t>(batch_size) * n);
+    double dense_us = TimeUs([&] {
+      blas.GEMM(CblasNoTrans, CblasNoTrans, batch_size, n, k, 1.f, x.data(),
+                w, 0.f, out.data());
+    });
+    double sparse_us = TimeUs([&] {
+      math::BlockSparseMatMul(dev_ctx, *sparse, batch_size, x.data(),
+                              out.data());
+    });
+    double speedup = dense_us / std::max(sparse_us, 1e-3);
+    VLOG(3) << "The weight " << name << " of " << k << " x " << n << " has "
+            << sparsity * 100 << "% zero blocks of " << block_size
+            << ", the block-sparse GEMM is " << speedup
+            << "x the speed of the dense one";
+    dense_total_us += dense_us;
+    if (speedup < min_speedup) {
+      scope->EraseVars({sparse_name});
+      total_us += dense_us;
+      continue;
+    }
+    total_us += sparse_us;
+    for (auto* op : it.second) {
+      op->Op()->SetAttr(math::kWeightBlockSize, block_size);
+    }
+    ++num_weights;
+  }
+  if (num_sparse > 0) {
+    LOG(INFO) << "Converted " << num_weights << " of " << num_sparse
+              << " sparse weights to block-sparse, the GEMMs of a batch of "
+              << batch_size << " take " << total_us << "us instead of "
+              << dense_total_us << "us, "
+              << dense_total_us / std::max(total_us, 1e-3) << "x the speed";
+  }
+  AddStatis(num_weights);
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(block_sparse_weight_pass,
+              paddle::framework::ir::BlockSparseWeightPass);
@@ -0,0 +1,48 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Run the mul and fc operators of the pruned weights on the block-sparse
+ * weights for the inference on CPU, skipping the zero blocks.
+ *
+ * A constant FP32 weight in the parameter scope is converted once to blocks
+ * of 16, or else 4, consecutive outputs of an input if at least the
+ * "min_sparsity" attribute of the pass, 0.7 by default, of its blocks are
+ * zeros. The GEMM of the block-sparse weight is timed against the dense GEMM
+ * on "batch_size" rows, 1 by default, and the weight is kept dense unless it
+ * is at least "min_speedup" times faster, 1 by default. The speedups of the
+ * weights and of all the GEMMs are logged.
+ */
+class BlockSparseWeightPass : public FusePassBase {
+ public:
+  virtual ~BlockSparseWeightPass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,153 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/block_sparse_weight_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/operators/math/block_sparse_gemm.h"
+
+USE_OP(mul);
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+const int64_t kBatch = 3;
+const int64_t kInputs = 32;
+const int64_t kOutputs = 64;
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::map<std::string, std::string>& inputs,
+           const std::map<std::string, std::string>& outputs) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  for (auto& input : inputs) {
+    op->SetInput(input.first, {input.second});
+  }
+  for (auto& output : outputs) {
+    op->SetOutput(output.first, {output.second});
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kForward));
+  op->CheckAttrs();
+}
+
+// (x, w)->mul->a
+// (x, u)->mul->b
+// (x, v)->mul->c
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v :
+       std::vector<std::string>({"x", "w", "u", "v", "a", "b", "c"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    if (v == "w" || v == "u" || v == "v") {
+      var->SetPersistable(true);
+      var->SetShape({kInputs, kOutputs});
+    }
+  }
+  SetOp(&prog, "mul", {{"X", "x"}, {"Y", "w"}}, {{"Out", "a"}});
+  SetOp(&prog, "mul", {{"X", "x"}, {"Y", "u"}}, {{"Out", "b"}});
+  SetOp(&prog, "mul", {{"X", "x"}, {"Y", "v"}}, {{"Out", "c"}});
+  return prog;
+}
+
+// The weight w has a block of 16 nonzeros in one of 8 blocks, u has a block
+// of 4 nonzeros in every 16 elements, v is dense.
+void InitWeight(Scope* scope, const std::string& name) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  auto* data = tensor->mutable_data<float>(make_ddim({kInputs, kOutputs}),
+                                           platform::CPUPlace());
+  for (int64_t i = 0; i < kInputs * kOutputs; ++i) {
+    float value = 0.01f * (i % 37) - 0.2f;
+    if (name == "w") {
+      data[i] = (i / 16) % 8 == 3 ? value : 0.f;
+    } else if (name == "u") {
+      data[i] = (i / 4) % 4 == (i / 16) % 4 ? value : 0.f;
+    } else {
+      data[i] = value + 1.f;
+    }
+  }
+}
+
+TEST(BlockSparseWeightPass, mul) {
+  platform::CPUPlace place;
+  platform::DeviceContextPool::Init({place});
+  Scope scope;
+  for (auto& name : {"w", "u", "v"}) {
+    InitWeight(&scope, name);
+  }
+  auto* x = scope.Var("x")->GetMutable<LoDTensor>();
+  auto* x_data = x->mutable_data<float>(make_ddim({kBatch, kInputs}), place);
+  for (int64_t i = 0; i < kBatch * kInputs; ++i) {
+    x_data[i] = i % 5 == 0 ? 0.f : 0.1f * (i % 11) - 0.5f;
+  }
+  for (auto& name : {"a", "b", "c"}) {
+    scope.Var(name);
+  }
+
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  graph->Set(kParamScopeAttr, new Scope*(&scope));
+  auto pass = PassRegistry::Instance().Get("block_sparse_weight_pass");
+  // Convert the sparse weights even if the GEMM is not faster.
+  pass->Set("min_speedup", new float(0.f));
+  pass->Set("batch_size", new int(kBatch));
+  graph = pass->Apply(std::move(graph));
+
+  std::map<std::string, int> block_sizes;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    block_sizes[node->Op()->Input("Y")[0]] =
+        boost::get<int>(node->Op()->GetAttr(operators::math::kWeightBlockSize));
+    auto op = OpRegistry::CreateOp(*node->Op());
+    op->Run(scope, place);
+  }
+  EXPECT_EQ(block_sizes["w"], 16);
+  EXPECT_EQ(block_sizes["u"], 4);
+  EXPECT_EQ(block_sizes["v"], 0);
+  EXPECT_NE(scope.FindVar("w@BLOCK_SPARSE"), nullptr);
+  EXPECT_EQ(scope.FindVar("v@BLOCK_SPARSE"), nullptr);
+  auto& sparse = scope.FindVar("w@BLOCK_SPARSE")
+                     ->Get<operators::math::BlockSparseMatrix<float>>();
+  EXPECT_EQ(sparse.num_blocks(), kInputs * kOutputs / 16 / 8);
+
+  for (auto& it : std::map<std::string, std::string>(
+           {{"w", "a"}, {"u", "b"}, {"v", "c"}})) {
+    auto& w = scope.FindVar(it.first)->Get<LoDTensor>();
+    auto& out = scope.FindVar(it.second)->Get<LoDTensor>();
+    ASSERT_EQ(out.dims(), make_ddim({kBatch, kOutputs}));
+    for (int64_t i = 0; i < kBatch; ++i) {
+      for (int64_t j = 0; j < kOutputs; ++j) {
+        float expected = 0;
+        for (int64_t l = 0; l < kInputs; ++l) {
+          expected += x_data[i * kInputs + l] *
+                      w.data<float>()[l * kOutputs + j];
+        }
+        EXPECT_NEAR(out.data<float>()[i * kOutputs + j], expected, 1e-4);
+      }
+    }
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(block_sparse_weight_pass);
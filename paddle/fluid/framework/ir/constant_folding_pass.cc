@@ -0,0 +1,159 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/constant_folding_pass.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/scope.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// The operators whose outputs are not decided by their inputs, or that have
+// side effects.
+const std::unordered_set<std::string> kUnfoldableOps = {
+    "feed",
+    "fetch",
+    "read",
+    "create_py_reader",
+    "uniform_random",
+    "gaussian_random",
+    "truncated_gaussian_random",
+    "sampling_id",
+    "random_crop",
+    "dropout",
+    "print",
+    "save",
+    "save_combine",
+    "load",
+    "load_combine",
+    "while",
+    "conditional_block",
+    "recurrent"};
+
+bool IsLoDTensor(Node* var) {
+  return var->IsVar() && var->Var() &&
+         var->Var()->GetType() == proto::VarType::LOD_TENSOR;
+}
+
+bool HasBlockAttr(OpDesc* op) {
+  for (auto& name : op->AttrNames()) {
+    auto type = op->GetAttrType(name);
+    if (type == proto::AttrType::BLOCK || type == proto::AttrType::BLOCKS) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> ConstantFoldingPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+  FusePassBase::Init("constant_folding", graph.get());
+  auto* scope = param_scope();
+  platform::CPUPlace place;
+
+  // The parameters never written and the outputs of the folded operators.
+  std::unordered_set<Node*> constants;
+  std::unordered_map<std::string, int> name_count;
+  std::unordered_set<Node*> folded;
+  // Whether n can be evaluated from the constants only.
+  auto foldable = [&](Node* n) {
+    auto* op = n->Op();
+    if (kUnfoldableOps.count(op->Type()) || HasBlockAttr(op) ||
+        n->outputs.empty()) {
+      return false;
+    }
+    for (auto* in : n->inputs) {
+      if (!constants.count(in)) return false;
+    }
+    for (auto* out : n->outputs) {
+      // A persistable output is updated in place, such as the moving mean.
+      if (!IsLoDTensor(out) || out->Var()->Persistable()) return false;
+      // The variable is written again elsewhere.
+      if (name_count[out->Name()] > 1) return false;
+    }
+    return true;
+  };
+
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsVar()) continue;
+    ++name_count[node->Name()];
+    if (IsLoDTensor(node) && node->Var()->Persistable() &&
+        node->inputs.empty()) {
+      constants.insert(node);
+    }
+  }
+  for (auto* n : TopologySortOperations(*graph)) {
+    if (!foldable(n)) continue;
+    try {
+      for (auto* out : n->outputs) {
+        scope->Var(out->Name());
+      }
+      OpRegistry::CreateOp(*n->Op())->Run(*scope, place);
+    } catch (const std::exception& e) {
+      // No CPU kernel for example, then it is kept in the graph.
+      VLOG(3) << "Can not fold " << n->Op()->Type() << ": " << e.what();
+      continue;
+    }
+    folded.insert(n);
+    for (auto* out : n->outputs) {
+      constants.insert(out);
+    }
+  }
+
+  // Keep the constants read by the rest of the graph.
+  std::unordered_set<const Node*> nodes2rm(folded.begin(), folded.end());
+  for (auto* var : constants) {
+    bool used = false;
+    for (auto* reader : var->outputs) {
+      if (!folded.count(reader)) used = true;
+    }
+    if (used) {
+      var->Var()->SetPersistable(true);
+    } else if (!var->outputs.empty() || !var->inputs.empty()) {
+      // Only read by the folded operators, or written by them and unused.
+      bool by_folded = true;
+      for (auto* writer : var->inputs) {
+        if (!folded.count(writer)) by_folded = false;
+      }
+      if (by_folded) {
+        nodes2rm.insert(var);
+        if (name_count[var->Name()] == 1) scope->EraseVars({var->Name()});
+      }
+    }
+  }
+  GraphSafeRemoveNodes(graph.get(), nodes2rm);
+  AddStatis(folded.size());
+  VLOG(3) << "Folded " << folded.size() << " operators";
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(constant_folding_pass,
+              paddle::framework::ir::ConstantFoldingPass);
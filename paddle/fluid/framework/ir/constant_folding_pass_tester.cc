@@ -0,0 +1,126 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/constant_folding_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/scope.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+OpDesc* SetOp(ProgramDesc* prog, const std::string& type,
+              const std::map<std::string, std::string>& inputs,
+              const std::map<std::string, std::string>& outputs) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  for (auto& input : inputs) {
+    op->SetInput(input.first, {input.second});
+  }
+  for (auto& output : outputs) {
+    op->SetOutput(output.first, {output.second});
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kForward));
+  return op;
+}
+
+// w->scale->sw
+// fill_constant->c
+// (a, sw)->elementwise_mul->b
+// (b, c)->elementwise_add->d
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v :
+       std::vector<std::string>({"a", "b", "c", "d", "w", "sw"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    if (v == "w") {
+      var->SetPersistable(true);
+    }
+  }
+
+  auto* scale = SetOp(&prog, "scale", {{"X", "w"}}, {{"Out", "sw"}});
+  scale->SetAttr("scale", 2.f);
+  scale->SetAttr("bias", 0.f);
+  auto* fill = SetOp(&prog, "fill_constant", {}, {{"Out", "c"}});
+  fill->SetAttr("shape", std::vector<int64_t>({4}));
+  fill->SetAttr("value", 3.f);
+  fill->SetAttr("dtype", static_cast<int>(proto::VarType::FP32));
+  SetOp(&prog, "elementwise_mul", {{"X", "a"}, {"Y", "sw"}}, {{"Out", "b"}});
+  SetOp(&prog, "elementwise_add", {{"X", "b"}, {"Y", "c"}}, {{"Out", "d"}});
+  for (auto* op : prog.Block(0).AllOps()) {
+    op->CheckAttrs();
+  }
+  return prog;
+}
+
+TEST(ConstantFoldingPass, basic) {
+  platform::DeviceContextPool::Init({platform::CPUPlace()});
+  Scope scope;
+  auto* w = scope.Var("w")->GetMutable<LoDTensor>();
+  auto* w_data = w->mutable_data<float>(make_ddim({4}), platform::CPUPlace());
+  for (int i = 0; i < 4; ++i) {
+    w_data[i] = i;
+  }
+
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  graph->Set(kParamScopeAttr, new Scope*(&scope));
+  auto pass = PassRegistry::Instance().Get("constant_folding_pass");
+  graph = pass->Apply(std::move(graph));
+
+  std::map<std::string, Node*> vars;
+  int num_ops = 0;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp()) {
+      ++num_ops;
+      EXPECT_TRUE(node->Op()->Type() == "elementwise_mul" ||
+                  node->Op()->Type() == "elementwise_add");
+    } else if (node->Var()) {
+      vars[node->Name()] = node;
+    }
+  }
+  EXPECT_EQ(num_ops, 2);
+  // w is only read by the folded scale.
+  EXPECT_EQ(vars.count("w"), 0UL);
+  EXPECT_EQ(scope.FindVar("w"), nullptr);
+  ASSERT_EQ(vars.count("sw"), 1UL);
+  ASSERT_EQ(vars.count("c"), 1UL);
+  EXPECT_TRUE(vars["sw"]->Var()->Persistable());
+  EXPECT_TRUE(vars["c"]->Var()->Persistable());
+  EXPECT_FALSE(vars["b"]->Var()->Persistable());
+
+  auto& sw = scope.FindVar("sw")->Get<LoDTensor>();
+  auto& c = scope.FindVar("c")->Get<LoDTensor>();
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_FLOAT_EQ(sw.data<float>()[i], 2.f * i);
+    EXPECT_FLOAT_EQ(c.data<float>()[i], 3.f);
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(constant_folding_pass);
+USE_OP(scale);
+USE_NO_KERNEL_OP(fill_constant);
+USE_OP(elementwise_mul);
+USE_OP(elementwise_add);
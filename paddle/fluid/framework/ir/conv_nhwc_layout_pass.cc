@@ -0,0 +1,326 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/conv_nhwc_layout_pass.h"
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/tensor_util.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// The operators computing each element of the output from the element at the
+// same position of the input, which run in any layout.
+const std::unordered_set<std::string> kElementwiseUnaryOps = {
+    "relu", "sigmoid", "tanh", "leaky_relu", "relu6",
+    "brelu", "elu", "swish", "scale"};
+
+const std::unordered_set<std::string> kElementwiseBinaryOps = {
+    "elementwise_add", "elementwise_mul"};
+
+// A chain with fewer convolutions than this is kept NCHW.
+constexpr int kMinConvsPerChain = 2;
+
+const std::vector<int> kNCHWToNHWC = {0, 2, 3, 1};
+const std::vector<int> kNHWCToNCHW = {0, 3, 1, 2};
+
+bool Is4DTensor(Node* var) {
+  return var != nullptr && var->IsVar() && var->Var() &&
+         var->Var()->GetType() == proto::VarType::LOD_TENSOR &&
+         var->Var()->GetShape().size() == 4U;
+}
+
+bool HasArg(OpDesc* op, const std::string& slot) {
+  auto& inputs = op->Inputs();
+  auto it = inputs.find(slot);
+  return it != inputs.end() && !it->second.empty();
+}
+
+bool AttrIs(OpDesc* op, const std::string& name, bool value) {
+  return op->HasAttr(name) && boost::get<bool>(op->GetAttr(name)) == value;
+}
+
+Node* FindVar(const std::vector<Node*>& vars, const std::string& name) {
+  for (auto* var : vars) {
+    if (var->IsVar() && var->Name() == name) return var;
+  }
+  return nullptr;
+}
+
+Node* InputVar(Node* n, const std::string& slot) {
+  if (!HasArg(n->Op(), slot)) return nullptr;
+  return FindVar(n->inputs, n->Op()->Input(slot)[0]);
+}
+
+const char* LayoutOutputSlot(const std::string& type) {
+  if (type == "conv2d") return "Output";
+  if (type == "batch_norm") return "Y";
+  return "Out";
+}
+
+Node* LayoutOutputVar(Node* n) {
+  auto& outputs = n->Op()->Outputs();
+  auto it = outputs.find(LayoutOutputSlot(n->Op()->Type()));
+  if (it == outputs.end() || it->second.size() != 1U) return nullptr;
+  return FindVar(n->outputs, it->second[0]);
+}
+
+// The cudnn conv2d whose filter is an FP32 parameter read by it only, so that
+// the filter could be transposed in the parameter scope.
+bool IsNCHWCudnnConv(Node* n) {
+  auto* op = n->Op();
+  if (op->Type() != "conv2d" || !AttrIs(op, "use_cudnn", true) ||
+      !op->HasAttr("data_format") ||
+      boost::get<std::string>(op->GetAttr("data_format")) == "NHWC" ||
+      HasArg(op, "Bias") || HasArg(op, "ResidualData")) {
+    return false;
+  }
+  auto* filter = InputVar(n, "Filter");
+  return Is4DTensor(InputVar(n, "Input")) && Is4DTensor(filter) &&
+         filter->Var()->Persistable() &&
+         filter->Var()->GetDataType() == proto::VarType::FP32 &&
+         filter->outputs.size() == 1U;
+}
+
+void PermuteShape(VarDesc* var, const std::vector<int>& axis) {
+  auto shape = var->GetShape();
+  std::vector<int64_t> permuted(shape.size());
+  for (size_t i = 0; i < axis.size(); ++i) {
+    permuted[i] = shape[axis[i]];
+  }
+  var->SetShape(permuted);
+}
+
+// Let reader read to instead of from.
+void Redirect(Node* reader, Node* from, Node* to) {
+  reader->Op()->RenameInput(from->Name(), to->Name());
+  Unlink(from, reader);
+  IR_NODE_LINK_TO(to, reader);
+}
+
+Node* CreateTransposeOp(Graph* graph, Node* in, Node* out,
+                        const std::vector<int>& axis) {
+  OpDesc desc;
+  desc.SetType("transpose");
+  desc.SetInput("X", {in->Name()});
+  desc.SetOutput("Out", {out->Name()});
+  desc.SetAttr("axis", axis);
+  auto* transpose = graph->CreateOpNode(&desc);
+  IR_NODE_LINK_TO(in, transpose);
+  IR_NODE_LINK_TO(transpose, out);
+  return transpose;
+}
+
+Node* CreateNHWCVar(Graph* graph, Node* var) {
+  VarDesc desc(var->Name() + "@nhwc");
+  desc.SetDataType(var->Var()->GetDataType());
+  desc.SetShape(var->Var()->GetShape());
+  PermuteShape(&desc, kNCHWToNHWC);
+  return graph->CreateVarNode(&desc);
+}
+
+// Transpose the MCHW filter to MHWC in place.
+void TransposeFilterToMHWC(Scope* scope, const std::string& name) {
+  auto* var = scope->FindVar(name);
+  PADDLE_ENFORCE_NOT_NULL(var, "The parameter %s is not in the scope", name);
+  auto* tensor = var->GetMutable<LoDTensor>();
+  PADDLE_ENFORCE(tensor->IsInitialized(), "The parameter %s is not loaded",
+                 name);
+  PADDLE_ENFORCE_EQ(tensor->dims().size(), 4);
+  Tensor mchw;
+  TensorCopySync(*tensor, platform::CPUPlace(), &mchw);
+  const int m = mchw.dims()[0], c = mchw.dims()[1];
+  const int hw = mchw.dims()[2] * mchw.dims()[3];
+  Tensor mhwc;
+  const float* src = mchw.data<float>();
+  float* dst = mhwc.mutable_data<float>(
+      make_ddim({m, mchw.dims()[2], mchw.dims()[3], c}), platform::CPUPlace());
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < c; ++j) {
+      for (int k = 0; k < hw; ++k) {
+        dst[(i * hw + k) * c + j] = src[(i * c + j) * hw + k];
+      }
+    }
+  }
+  TensorCopySync(mhwc, tensor->place(), tensor);
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> ConvNHWCLayoutPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+  FusePassBase::Init("conv_nhwc_layout", graph.get());
+  auto* scope = param_scope();
+
+  std::vector<Node*> ops = TopologySortOperations(*graph);
+  // The operators to run in NHWC, and the variables they read in the layout.
+  std::unordered_map<Node*, std::vector<Node*>> converted;
+  // The variables written in NHWC by the converted operators.
+  std::unordered_map<Node*, Node*> nhwc_writers;
+  // The chains are the connected components of the converted operators.
+  std::unordered_map<Node*, Node*> chain_of;
+  std::function<Node*(Node*)> find_chain = [&](Node* n) {
+    auto& parent = chain_of[n];
+    if (parent == nullptr || parent == n) return parent = n;
+    return parent = find_chain(parent);
+  };
+
+  for (auto* n : ops) {
+    auto* op = n->Op();
+    const auto& type = op->Type();
+    std::vector<Node*> layout_inputs;
+    if (IsNCHWCudnnConv(n)) {
+      layout_inputs.push_back(InputVar(n, "Input"));
+    } else if ((type == "pool2d" && AttrIs(op, "use_cudnn", true) &&
+                op->HasAttr("data_format")) ||
+               type == "batch_norm" || kElementwiseUnaryOps.count(type)) {
+      auto* x = InputVar(n, "X");
+      if (!nhwc_writers.count(x)) continue;
+      layout_inputs.push_back(x);
+    } else if (kElementwiseBinaryOps.count(type)) {
+      auto* x = InputVar(n, "X");
+      auto* y = InputVar(n, "Y");
+      if (!nhwc_writers.count(x) || y == nullptr) continue;
+      layout_inputs.push_back(x);
+      if (nhwc_writers.count(y)) {
+        layout_inputs.push_back(y);
+      } else {
+        // Only the bias of the channels is moved to the last axis.
+        auto y_shape = y->Var()->GetShape();
+        if (y_shape.size() != 1U || !op->HasAttr("axis") ||
+            boost::get<int>(op->GetAttr("axis")) != 1) {
+          continue;
+        }
+      }
+    } else {
+      continue;
+    }
+    auto* out = LayoutOutputVar(n);
+    // The inplace operators could not write a new variable.
+    if (!Is4DTensor(out) || FindVar(n->inputs, out->Name())) continue;
+
+    converted[n] = layout_inputs;
+    nhwc_writers[out] = n;
+    chain_of[n] = n;
+    for (auto* var : layout_inputs) {
+      auto it = nhwc_writers.find(var);
+      if (it != nhwc_writers.end()) {
+        chain_of[find_chain(it->second)] = find_chain(n);
+      }
+    }
+  }
+
+  std::unordered_map<Node*, int> num_convs;
+  for (auto& item : converted) {
+    if (item.first->Op()->Type() == "conv2d") {
+      ++num_convs[find_chain(item.first)];
+    }
+  }
+  for (auto* n : ops) {
+    if (converted.count(n) && num_convs[find_chain(n)] < kMinConvsPerChain) {
+      nhwc_writers.erase(LayoutOutputVar(n));
+      converted.erase(n);
+    }
+  }
+
+  // Whether reader reads var in NHWC.
+  auto reads_nhwc = [&](Node* reader, Node* var) {
+    auto it = converted.find(reader);
+    return it != converted.end() &&
+           std::find(it->second.begin(), it->second.end(), var) !=
+               it->second.end();
+  };
+  // The NHWC copies of the NCHW variables, shared by the converted readers.
+  std::unordered_map<Node*, Node*> nhwc_copies;
+  int num_transposes = 0;
+  // The writers are rewritten before the readers in the topological order.
+  for (auto* n : ops) {
+    if (!converted.count(n)) continue;
+    auto* op = n->Op();
+    const auto& type = op->Type();
+    if (type == "conv2d") {
+      auto* filter = InputVar(n, "Filter");
+      TransposeFilterToMHWC(scope, filter->Name());
+      PermuteShape(filter->Var(), kNCHWToNHWC);
+      op->SetAttr("data_format", std::string("NHWC"));
+    } else if (type == "pool2d") {
+      op->SetAttr("data_format", std::string("NHWC"));
+    } else if (type == "batch_norm") {
+      op->SetAttr("data_layout", std::string("NHWC"));
+    } else if (kElementwiseBinaryOps.count(type) &&
+               converted[n].size() == 1U) {
+      op->SetAttr("axis", 3);
+    }
+
+    // Only the inputs of the convolutions could be NCHW.
+    for (auto* var : converted[n]) {
+      if (nhwc_writers.count(var)) continue;
+      auto& nhwc = nhwc_copies[var];
+      if (nhwc == nullptr) {
+        nhwc = CreateNHWCVar(graph.get(), var);
+        CreateTransposeOp(graph.get(), var, nhwc, kNCHWToNHWC);
+        ++num_transposes;
+      }
+      Redirect(n, var, nhwc);
+    }
+
+    auto* out = LayoutOutputVar(n);
+    bool read_by_nhwc_only = !out->outputs.empty();
+    for (auto* reader : out->outputs) {
+      read_by_nhwc_only &= reads_nhwc(reader, out);
+    }
+    if (read_by_nhwc_only) {
+      PermuteShape(out->Var(), kNCHWToNHWC);
+      continue;
+    }
+    // Write an NHWC copy and transpose it back to out for the NCHW readers
+    // and the fetches.
+    auto* nhwc = CreateNHWCVar(graph.get(), out);
+    op->RenameOutput(out->Name(), nhwc->Name());
+    Unlink(n, out);
+    IR_NODE_LINK_TO(n, nhwc);
+    std::vector<Node*> readers = out->outputs;
+    for (auto* reader : readers) {
+      if (reads_nhwc(reader, out)) {
+        Redirect(reader, out, nhwc);
+        std::replace(converted[reader].begin(), converted[reader].end(), out,
+                     nhwc);
+      }
+    }
+    nhwc_writers[nhwc] = n;
+    CreateTransposeOp(graph.get(), nhwc, out, kNHWCToNCHW);
+    ++num_transposes;
+  }
+  VLOG(3) << "Converted " << converted.size() << " operators to NHWC with "
+          << num_transposes << " transposes";
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(conv_nhwc_layout_pass, paddle::framework::ir::ConvNHWCLayoutPass);
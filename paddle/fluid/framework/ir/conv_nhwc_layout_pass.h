@@ -0,0 +1,52 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Run the chains of the cudnn conv2d in the NHWC layout, for the inference on
+ * GPU, where the cudnn convolutions run on the tensor cores without
+ * transposing the data internally.
+ *
+ * A chain starts from a cudnn conv2d, and grows through the cudnn pool2d,
+ * batch_norm, activations and elementwise ops reading its NHWC outputs. The
+ * channel-wise bias of the elementwise ops moves to the last axis. The chains
+ * with fewer than two convolutions are kept NCHW, since they can not pay for
+ * the transposes.
+ *
+ * A transpose op is inserted where an NCHW variable enters a chain, and where
+ * an NHWC variable is read out of the chain. The variables read by no
+ * operator keep NCHW so the fetched outputs do not change. The filters are
+ * transposed to MHWC in the parameter scope once.
+ */
+class ConvNHWCLayoutPass : public FusePassBase {
+ public:
+  virtual ~ConvNHWCLayoutPass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
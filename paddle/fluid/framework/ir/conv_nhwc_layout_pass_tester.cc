@@ -0,0 +1,171 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/conv_nhwc_layout_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/scope.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::map<std::string, std::string>& inputs,
+           const std::map<std::string, std::string>& outputs) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  if (type == "conv2d" || type == "pool2d") {
+    op->SetAttr("use_cudnn", true);
+    op->SetAttr("data_format", std::string("AnyLayout"));
+  } else if (type == "elementwise_add") {
+    op->SetAttr("axis", 1);
+  }
+  for (auto& input : inputs) {
+    op->SetInput(input.first, {input.second});
+  }
+  for (auto& output : outputs) {
+    op->SetOutput(output.first, {output.second});
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kForward));
+}
+
+// (a, w1)->conv2d->b->batch_norm(scale, bias, mean, var)->c->relu->d
+// (d, w2)->conv2d->e->elementwise_add(bias2)->f->relu->g->softmax->h
+// (g, w3)->conv2d->i
+// (x, w4)->conv2d->y->pool2d->z
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>(
+           {"a", "b", "c", "d", "e", "f", "g", "h", "i", "x", "y", "z"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    var->SetShape({1, 4, 8, 6});
+  }
+  for (auto& v : std::vector<std::string>(
+           {"w1", "w2", "w3", "w4", "scale", "bias", "mean", "var", "bias2"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    var->SetPersistable(true);
+    if (v[0] == 'w') {
+      var->SetShape({4, 4, 2, 3});
+    } else {
+      var->SetShape({4});
+    }
+  }
+
+  SetOp(&prog, "conv2d", {{"Input", "a"}, {"Filter", "w1"}}, {{"Output", "b"}});
+  SetOp(&prog, "batch_norm", {{"X", "b"},
+                              {"Scale", "scale"},
+                              {"Bias", "bias"},
+                              {"Mean", "mean"},
+                              {"Variance", "var"}},
+        {{"Y", "c"}, {"MeanOut", "mean"}, {"VarianceOut", "var"}});
+  SetOp(&prog, "relu", {{"X", "c"}}, {{"Out", "d"}});
+  SetOp(&prog, "conv2d", {{"Input", "d"}, {"Filter", "w2"}}, {{"Output", "e"}});
+  SetOp(&prog, "elementwise_add", {{"X", "e"}, {"Y", "bias2"}},
+        {{"Out", "f"}});
+  SetOp(&prog, "relu", {{"X", "f"}}, {{"Out", "g"}});
+  SetOp(&prog, "softmax", {{"X", "g"}}, {{"Out", "h"}});
+  SetOp(&prog, "conv2d", {{"Input", "g"}, {"Filter", "w3"}}, {{"Output", "i"}});
+  SetOp(&prog, "conv2d", {{"Input", "x"}, {"Filter", "w4"}}, {{"Output", "y"}});
+  SetOp(&prog, "pool2d", {{"X", "y"}}, {{"Out", "z"}});
+  return prog;
+}
+
+void InitFilter(Scope* scope, const std::string& name) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  auto* data = tensor->mutable_data<float>(make_ddim({4, 4, 2, 3}),
+                                           platform::CPUPlace());
+  for (int i = 0; i < tensor->numel(); ++i) {
+    data[i] = static_cast<float>(i);
+  }
+}
+
+TEST(ConvNHWCLayoutPass, basic) {
+  platform::DeviceContextPool::Init({platform::CPUPlace()});
+  Scope scope;
+  for (auto& name : std::vector<std::string>({"w1", "w2", "w3", "w4"})) {
+    InitFilter(&scope, name);
+  }
+
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  graph->Set(kParamScopeAttr, new Scope*(&scope));
+  auto pass = PassRegistry::Instance().Get("conv_nhwc_layout_pass");
+  graph = pass->Apply(std::move(graph));
+
+  std::map<std::string, std::vector<int64_t>> shapes;
+  int transpose_count = 0;
+  int nhwc_conv_count = 0;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && node->Var()) {
+      shapes[node->Name()] = node->Var()->GetShape();
+    }
+    if (!node->IsOp()) continue;
+    auto* op = node->Op();
+    if (op->Type() == "transpose") {
+      ++transpose_count;
+    } else if (op->Type() == "conv2d") {
+      auto format = boost::get<std::string>(op->GetAttr("data_format"));
+      if (format == "NHWC") ++nhwc_conv_count;
+      if (op->Output("Output")[0] == "b") {
+        EXPECT_EQ(op->Input("Input")[0], "a@nhwc");
+      } else if (op->Output("Output")[0] == "i@nhwc") {
+        EXPECT_EQ(op->Input("Input")[0], "g@nhwc");
+      } else {
+        // The chain of x has only one convolution.
+        EXPECT_EQ(op->Input("Input")[0], "x");
+        EXPECT_EQ(format, "AnyLayout");
+      }
+    } else if (op->Type() == "batch_norm") {
+      EXPECT_EQ(boost::get<std::string>(op->GetAttr("data_layout")), "NHWC");
+    } else if (op->Type() == "elementwise_add") {
+      EXPECT_EQ(boost::get<int>(op->GetAttr("axis")), 3);
+    } else if (op->Type() == "softmax") {
+      // softmax reads the NCHW g transposed back.
+      EXPECT_EQ(op->Input("X")[0], "g");
+    } else if (op->Type() == "pool2d") {
+      EXPECT_EQ(boost::get<std::string>(op->GetAttr("data_format")),
+                "AnyLayout");
+    }
+  }
+  // a to NHWC, g and i back to NCHW.
+  EXPECT_EQ(transpose_count, 3);
+  EXPECT_EQ(nhwc_conv_count, 3);
+  EXPECT_EQ(shapes["b"], std::vector<int64_t>({1, 8, 6, 4}));
+  EXPECT_EQ(shapes["g"], std::vector<int64_t>({1, 4, 8, 6}));
+  EXPECT_EQ(shapes["g@nhwc"], std::vector<int64_t>({1, 8, 6, 4}));
+  EXPECT_EQ(shapes["w1"], std::vector<int64_t>({4, 2, 3, 4}));
+  EXPECT_EQ(shapes["w4"], std::vector<int64_t>({4, 4, 2, 3}));
+
+  auto& w1 = scope.FindVar("w1")->Get<LoDTensor>();
+  EXPECT_EQ(w1.dims(), make_ddim({4, 2, 3, 4}));
+  // w1[1][c=2][h=1][w=0] of MCHW.
+  EXPECT_FLOAT_EQ(w1.data<float>()[((1 * 2 + 1) * 3 + 0) * 4 + 2],
+                  static_cast<float>(((1 * 4 + 2) * 2 + 1) * 3 + 0));
+  EXPECT_EQ(scope.FindVar("w4")->Get<LoDTensor>().dims(),
+            make_ddim({4, 4, 2, 3}));
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(conv_nhwc_layout_pass);
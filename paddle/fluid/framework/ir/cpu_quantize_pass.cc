@@ -0,0 +1,225 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/cpu_quantize_pass.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// How an INT8 variable is quantized.
+struct QuantVar {
+  float scale;
+  bool is_unsigned;
+};
+
+bool IsMKLDNNOp(Node* n, const std::string& type) {
+  if (!n->IsOp() || n->Op()->Type() != type) return false;
+  auto* op = n->Op();
+  return op->HasAttr("use_mkldnn") &&
+         boost::get<bool>(op->GetAttr("use_mkldnn"));
+}
+
+bool GetBoolAttr(OpDesc* op, const std::string& name) {
+  return op->HasAttr(name) && boost::get<bool>(op->GetAttr(name));
+}
+
+Node* FindVar(const std::vector<Node*>& vars, const std::string& name) {
+  for (auto* var : vars) {
+    if (var->IsVar() && var->Name() == name) return var;
+  }
+  return nullptr;
+}
+
+// The scale quantizing the values in [-threshold, threshold] to INT8, or the
+// values in [0, threshold] to UINT8.
+float Scale(float threshold, bool is_unsigned) {
+  if (threshold <= 0.0f) return 1.0f;
+  return (is_unsigned ? 255.0f : 127.0f) / threshold;
+}
+
+Node* CreateInt8Var(Graph* graph, Node* var, const QuantVar& quant) {
+  VarDesc desc(var->Name() + "@int8");
+  desc.SetDataType(quant.is_unsigned ? proto::VarType::UINT8
+                                     : proto::VarType::INT8);
+  if (var->Var()) {
+    desc.SetShape(var->Var()->GetShape());
+  }
+  return graph->CreateVarNode(&desc);
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> CPUQuantizePass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+  const auto& ranges = Get<VarQuantRange>(kQuantRangesAttr);
+  auto has_range = [&](const std::string& name) {
+    auto it = ranges.find(name);
+    return it != ranges.end() && !it->second.thresholds.empty();
+  };
+
+  std::vector<Node*> ops = TopologySortOperations(*graph);
+  std::unordered_set<Node*> quantized;
+  for (auto* n : ops) {
+    auto* op = n->Op();
+    if (IsMKLDNNOp(n, "conv2d")) {
+      if (!GetBoolAttr(op, "fuse_residual_connection") &&
+          op->Input("Input").size() == 1 && op->Output("Output").size() == 1 &&
+          has_range(op->Input("Input")[0]) &&
+          has_range(op->Input("Filter")[0]) &&
+          has_range(op->Output("Output")[0])) {
+        quantized.insert(n);
+      }
+    } else if (IsMKLDNNOp(n, "pool2d")) {
+      auto* x = FindVar(n->inputs, op->Input("X")[0]);
+      if (x && x->inputs.size() == 1 && quantized.count(x->inputs[0])) {
+        quantized.insert(n);
+      }
+    }
+  }
+
+  // A variable is INT8 if it is written by a quantized operator and only
+  // read by the quantized operators.
+  auto is_int8 = [&](Node* var) {
+    if (var->inputs.size() != 1 || !quantized.count(var->inputs[0]) ||
+        var->outputs.empty()) {
+      return false;
+    }
+    for (auto* reader : var->outputs) {
+      if (!quantized.count(reader)) return false;
+    }
+    return true;
+  };
+  // A pool2d is only worth quantizing if it reads INT8, drop the others
+  // until no more pool2d is dropped.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto it = quantized.begin(); it != quantized.end();) {
+      auto* n = *it;
+      if (n->Op()->Type() == "pool2d" &&
+          !is_int8(FindVar(n->inputs, n->Op()->Input("X")[0]))) {
+        it = quantized.erase(it);
+        changed = true;
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  std::unordered_map<std::string, QuantVar> int8_vars;
+  // The INT8 copies of the FP32 inputs, shared by the readers.
+  std::unordered_map<Node*, Node*> quantized_inputs;
+  auto quantize_input = [&](Node* n, Node* input, const std::string& slot) {
+    auto it = int8_vars.find(input->Name());
+    if (it != int8_vars.end()) return it->second;
+    auto& range = ranges.at(input->Name());
+    QuantVar quant{Scale(range.thresholds[0], range.is_unsigned),
+                   range.is_unsigned};
+    auto& int8_input = quantized_inputs[input];
+    if (int8_input == nullptr) {
+      int8_input = CreateInt8Var(graph.get(), input, quant);
+      OpDesc desc;
+      desc.SetType("quantize");
+      desc.SetInput("Input", {input->Name()});
+      desc.SetOutput("Output", {int8_input->Name()});
+      desc.SetAttr("Scale", quant.scale);
+      desc.SetAttr("is_negative_input", !quant.is_unsigned);
+      auto* quantize = graph->CreateOpNode(&desc);
+      IR_NODE_LINK_TO(input, quantize);
+      IR_NODE_LINK_TO(quantize, int8_input);
+    }
+    n->Op()->SetInput(slot, {int8_input->Name()});
+    Unlink(input, n);
+    IR_NODE_LINK_TO(int8_input, n);
+    return quant;
+  };
+  auto dequantize_output = [&](Node* n, Node* output, const std::string& slot,
+                               const QuantVar& quant) {
+    auto* int8_output = CreateInt8Var(graph.get(), output, quant);
+    OpDesc desc;
+    desc.SetType("dequantize");
+    desc.SetInput("Input", {int8_output->Name()});
+    desc.SetOutput("Output", {output->Name()});
+    desc.SetAttr("Scale", quant.scale);
+    auto* dequantize = graph->CreateOpNode(&desc);
+    n->Op()->SetOutput(slot, {int8_output->Name()});
+    Unlink(n, output);
+    IR_NODE_LINK_TO(n, int8_output);
+    IR_NODE_LINK_TO(int8_output, dequantize);
+    IR_NODE_LINK_TO(dequantize, output);
+  };
+  auto set_int8 = [&](Node* var, const QuantVar& quant) {
+    var->Var()->SetDataType(quant.is_unsigned ? proto::VarType::UINT8
+                                              : proto::VarType::INT8);
+    int8_vars[var->Name()] = quant;
+  };
+
+  // The writers are rewritten before the readers in the topological order.
+  for (auto* n : ops) {
+    if (!quantized.count(n)) continue;
+    auto* op = n->Op();
+    if (op->Type() == "conv2d") {
+      auto* input = FindVar(n->inputs, op->Input("Input")[0]);
+      auto* output = FindVar(n->outputs, op->Output("Output")[0]);
+      PADDLE_ENFORCE(input && output, "Fail to find the variables of conv2d");
+      QuantVar in = quantize_input(n, input, "Input");
+      std::vector<float> scale_weights;
+      for (float threshold : ranges.at(op->Input("Filter")[0]).thresholds) {
+        scale_weights.push_back(Scale(threshold, false));
+      }
+      op->SetAttr("is_test", true);
+      op->SetAttr("Scale_in", in.scale);
+      op->SetAttr("Scale_weights", scale_weights);
+      if (is_int8(output)) {
+        // The output of the fused relu is never negative.
+        bool fuse_relu = GetBoolAttr(op, "fuse_relu");
+        float threshold = ranges.at(output->Name()).thresholds[0];
+        QuantVar out{Scale(threshold, fuse_relu), fuse_relu};
+        op->SetAttr("Scale_out", out.scale);
+        set_int8(output, out);
+      } else {
+        op->SetAttr("force_fp32_output", true);
+      }
+    } else {
+      // The pooling keeps the scale of X.
+      auto* x = FindVar(n->inputs, op->Input("X")[0]);
+      auto* out = FindVar(n->outputs, op->Output("Out")[0]);
+      PADDLE_ENFORCE(x && out, "Fail to find the variables of pool2d");
+      QuantVar quant = int8_vars.at(x->Name());
+      if (is_int8(out)) {
+        set_int8(out, quant);
+      } else {
+        dequantize_output(n, out, "Out", quant);
+      }
+    }
+  }
+  VLOG(3) << "Quantized " << quantized.size() << " operators to INT8";
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(cpu_quantize_pass, paddle::framework::ir::CPUQuantizePass);
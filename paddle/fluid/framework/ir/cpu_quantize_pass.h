@@ -0,0 +1,64 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+// The range of a variable calibrated on the FP32 model.
+struct QuantRange {
+  // Whether the variable is never negative, so it can be quantized to UINT8.
+  bool is_unsigned{false};
+  // The values are clipped to [-threshold, threshold]. The weights have one
+  // threshold for each output channel, the activations have one.
+  std::vector<float> thresholds;
+};
+
+using VarQuantRange = std::unordered_map<std::string, QuantRange>;
+
+// The name of the VarQuantRange attribute of CPUQuantizePass.
+constexpr char kQuantRangesAttr[] = "quant_var_ranges";
+
+/*
+ * Quantize the conv2d and pool2d run by MKL-DNN to INT8 by the calibrated
+ * ranges of their variables.
+ *
+ * A conv2d is quantized if the ranges of its Input, Filter and Output are all
+ * known, and it does not fuse the residual connection. A pool2d is quantized
+ * if its X is the INT8 output of a quantized operator. A quantize op is
+ * inserted before the quantized operators reading FP32 inputs. The quantized
+ * operators write INT8 outputs if all the readers are quantized, otherwise
+ * conv2d writes FP32 by force_fp32_output and pool2d is followed by a
+ * dequantize op.
+ */
+class CPUQuantizePass : public Pass {
+ public:
+  virtual ~CPUQuantizePass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,189 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/cpu_quantize_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type, const std::string& name,
+           const std::vector<std::string>& inputs,
+           const std::vector<std::string>& outputs, bool fuse_relu = false) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  op->SetAttr("name", name);
+  if (type == "conv2d") {
+    op->SetAttr("use_mkldnn", true);
+    op->SetAttr("fuse_relu", fuse_relu);
+    op->SetInput("Input", {inputs[0]});
+    op->SetInput("Filter", {inputs[1]});
+    op->SetOutput("Output", outputs);
+  } else if (type == "pool2d") {
+    op->SetAttr("use_mkldnn", true);
+    op->SetInput("X", inputs);
+    op->SetOutput("Out", outputs);
+  } else {
+    op->SetInput("X", inputs);
+    op->SetOutput("Out", outputs);
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kForward));
+}
+
+// a->OP0->b
+// (b, w1)->conv1(relu)->c->pool1->d
+// (d, w2)->conv2->e->OP1->f
+// (f, w3)->conv3(relu)->g->pool2->h->OP2->i
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>(
+           {"a", "b", "c", "d", "e", "f", "g", "h", "i", "w1", "w2", "w3"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    if (v[0] == 'w') {
+      var->SetPersistable(true);
+    }
+  }
+
+  SetOp(&prog, "OP0", "op0", {"a"}, {"b"});
+  SetOp(&prog, "conv2d", "conv1", {"b", "w1"}, {"c"}, true);
+  SetOp(&prog, "pool2d", "pool1", {"c"}, {"d"});
+  SetOp(&prog, "conv2d", "conv2", {"d", "w2"}, {"e"});
+  SetOp(&prog, "OP1", "op1", {"e"}, {"f"});
+  SetOp(&prog, "conv2d", "conv3", {"f", "w3"}, {"g"}, true);
+  SetOp(&prog, "pool2d", "pool2", {"g"}, {"h"});
+  SetOp(&prog, "OP2", "op2", {"h"}, {"i"});
+  return prog;
+}
+
+QuantRange MakeRange(bool is_unsigned, const std::vector<float>& thresholds) {
+  QuantRange range;
+  range.is_unsigned = is_unsigned;
+  range.thresholds = thresholds;
+  return range;
+}
+
+VarQuantRange* BuildRanges() {
+  auto* ranges = new VarQuantRange;
+  (*ranges)["b"] = MakeRange(false, {2.0f});
+  (*ranges)["c"] = MakeRange(true, {4.0f});
+  (*ranges)["d"] = MakeRange(true, {4.0f});
+  (*ranges)["e"] = MakeRange(false, {8.0f});
+  (*ranges)["f"] = MakeRange(false, {1.0f});
+  (*ranges)["g"] = MakeRange(true, {0.5f});
+  (*ranges)["w1"] = MakeRange(false, {1.0f, 0.5f});
+  (*ranges)["w2"] = MakeRange(false, {0.25f});
+  // w3 has no range, so conv3 and pool2 are not quantized.
+  return ranges;
+}
+
+TEST(CPUQuantizePass, basic) {
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+
+  auto pass = PassRegistry::Instance().Get("cpu_quantize_pass");
+  pass->Set(kQuantRangesAttr, BuildRanges());
+  graph = pass->Apply(std::move(graph));
+
+  int quantize_count = 0;
+  int dequantize_count = 0;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && node->Name() == "c") {
+      EXPECT_EQ(node->Var()->GetDataType(), proto::VarType::UINT8);
+    }
+    if (!node->IsOp()) continue;
+    auto* op = node->Op();
+    if (op->Type() == "quantize") {
+      ++quantize_count;
+      EXPECT_EQ(op->Input("Input")[0], "b");
+      EXPECT_FLOAT_EQ(boost::get<float>(op->GetAttr("Scale")), 127.0f / 2.0f);
+      EXPECT_TRUE(boost::get<bool>(op->GetAttr("is_negative_input")));
+    } else if (op->Type() == "dequantize") {
+      ++dequantize_count;
+    } else if (op->Type() == "conv2d") {
+      auto name = boost::get<std::string>(op->GetAttr("name"));
+      if (name == "conv1") {
+        EXPECT_EQ(op->Input("Input")[0], "b@int8");
+        EXPECT_FLOAT_EQ(boost::get<float>(op->GetAttr("Scale_in")),
+                        127.0f / 2.0f);
+        EXPECT_FLOAT_EQ(boost::get<float>(op->GetAttr("Scale_out")),
+                        255.0f / 4.0f);
+        auto scale_weights =
+            boost::get<std::vector<float>>(op->GetAttr("Scale_weights"));
+        ASSERT_EQ(scale_weights.size(), 2UL);
+        EXPECT_FLOAT_EQ(scale_weights[1], 127.0f / 0.5f);
+      } else if (name == "conv2") {
+        // pool1 keeps the scale of conv1, and OP1 reads FP32.
+        EXPECT_EQ(op->Input("Input")[0], "d");
+        EXPECT_FLOAT_EQ(boost::get<float>(op->GetAttr("Scale_in")),
+                        255.0f / 4.0f);
+        EXPECT_TRUE(boost::get<bool>(op->GetAttr("force_fp32_output")));
+      } else if (name == "conv3") {
+        EXPECT_FALSE(op->HasAttr("Scale_in"));
+      }
+    } else if (op->Type() == "pool2d") {
+      auto name = boost::get<std::string>(op->GetAttr("name"));
+      EXPECT_EQ(op->Output("Out")[0], name == "pool1" ? "d" : "h");
+    }
+  }
+  EXPECT_EQ(quantize_count, 1);
+  EXPECT_EQ(dequantize_count, 0);
+}
+
+TEST(CPUQuantizePass, dequantize) {
+  // conv3 and pool2 are quantized with the range of w3, and OP2 reads the
+  // output of pool2 dequantized.
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+
+  auto* ranges = BuildRanges();
+  (*ranges)["w3"] = MakeRange(false, {1.0f});
+  auto pass = PassRegistry::Instance().Get("cpu_quantize_pass");
+  pass->Set(kQuantRangesAttr, ranges);
+  graph = pass->Apply(std::move(graph));
+
+  int quantize_count = 0;
+  int dequantize_count = 0;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    auto* op = node->Op();
+    if (op->Type() == "quantize") {
+      ++quantize_count;
+    } else if (op->Type() == "dequantize") {
+      ++dequantize_count;
+      EXPECT_EQ(op->Input("Input")[0], "h@int8");
+      EXPECT_EQ(op->Output("Output")[0], "h");
+      EXPECT_FLOAT_EQ(boost::get<float>(op->GetAttr("Scale")), 255.0f / 0.5f);
+      ASSERT_EQ(node->outputs.size(), 1UL);
+      ASSERT_EQ(node->outputs[0]->outputs.size(), 1UL);
+      EXPECT_EQ(node->outputs[0]->outputs[0]->Op()->Type(), "OP2");
+    } else if (op->Type() == "pool2d" &&
+               boost::get<std::string>(op->GetAttr("name")) == "pool2") {
+      EXPECT_EQ(op->Output("Out")[0], "h@int8");
+    }
+  }
+  EXPECT_EQ(quantize_count, 2);
+  EXPECT_EQ(dequantize_count, 1);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(cpu_quantize_pass);
@@ -41,7 +41,7 @@ std::unique_ptr<ir::Graph> DepthwiseConvMKLDNNPass::ApplyImpl(
                      Graph* g) {
     VLOG(3) << "handle DepthwiseConvMKLDNN fuse";
     GET_NODE(depthwise_conv, (*pattern));
-    depthwise_conv->Op()->SetType("conv2d");
+    g->SetOpType(depthwise_conv, "conv2d");
     found_depthwise_conv_mkldnn_count++;
   };
 
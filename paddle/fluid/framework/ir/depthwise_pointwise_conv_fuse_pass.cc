@@ -0,0 +1,190 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/depthwise_pointwise_conv_fuse_pass.h"
+#include <cmath>
+#include <string>
+#include <typeinfo>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static bool HasInput(const Node* op, const std::string& argument) {
+  auto& inputs = op->Op()->Inputs();
+  auto it = inputs.find(argument);
+  return it != inputs.end() && !it->second.empty();
+}
+
+// The fused op computes the NCHW 2-D convolutions without bias.
+static bool IsPlainConv(const Node* conv) {
+  auto* op = conv->Op();
+  if (HasInput(conv, "Bias") || HasInput(conv, "ResidualData")) return false;
+  if (op->HasAttr("data_format") &&
+      boost::get<std::string>(op->GetAttr("data_format")) == "NHWC") {
+    return false;
+  }
+  return true;
+}
+
+// The parameters are folded in FP32.
+static LoDTensor* GetFloatTensor(const Scope* scope, const Node* var) {
+  auto* scope_var = scope->FindVar(var->Name());
+  if (!scope_var || !scope_var->IsType<LoDTensor>()) return nullptr;
+  auto* tensor = scope_var->GetMutable<LoDTensor>();
+  if (!tensor->IsInitialized() || tensor->type() != typeid(float)) {
+    return nullptr;
+  }
+  return tensor;
+}
+
+std::unique_ptr<ir::Graph> DepthwisePointwiseConvFusePass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  FusePassBase::Init(name_scope_, graph.get());
+  auto* scope = param_scope();
+  PADDLE_ENFORCE(scope);
+
+  GraphPatternDetector gpd;
+  patterns::DepthwisePointwiseConv pattern(gpd.mutable_pattern(), name_scope_);
+  pattern();
+
+  int fusion_count{0};
+  auto handler = [&](const GraphPatternDetector::subgraph_t& subgraph,
+                     Graph* g) {
+    VLOG(4) << "handle depthwise pointwise conv fuse";
+    GET_IR_NODE_FROM_SUBGRAPH(dw_conv, dw_conv, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(batch_norm, batch_norm, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(relu, relu, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(pw_conv, pw_conv, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(dw_input, dw_input, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(dw_filter, dw_filter, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(dw_out, dw_out, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_scale, bn_scale, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_bias, bn_bias, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_mean, bn_mean, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_variance, bn_variance, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_out, bn_out, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_mean_out, bn_mean_out, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_variance_out, bn_variance_out, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_saved_mean, bn_saved_mean, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bn_saved_variance, bn_saved_variance, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(relu_out, relu_out, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(pw_filter, pw_filter, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(pw_out, pw_out, pattern);
+
+    // The fused op has no MKLDNN kernel.
+    if (FindFuseOption(*dw_conv, *pw_conv) != FUSE_NATIVE) return;
+    if (!IsPlainConv(dw_conv) || !IsPlainConv(pw_conv)) return;
+
+    auto* dw_tensor = GetFloatTensor(scope, dw_filter);
+    auto* pw_tensor = GetFloatTensor(scope, pw_filter);
+    if (!dw_tensor || !pw_tensor) return;
+    auto dw_dims = dw_tensor->dims();
+    auto pw_dims = pw_tensor->dims();
+    // the depthwise filter [C * M, 1, K_h, K_w] of C groups
+    int groups = boost::get<int>(dw_conv->Op()->GetAttr("groups"));
+    if (dw_dims.size() != 4 || dw_dims[1] != 1 || groups <= 1 ||
+        dw_dims[0] % groups != 0) {
+      return;
+    }
+    // the 1x1 filter [K, C * M, 1, 1] of stride 1 and no padding
+    auto pw_strides =
+        boost::get<std::vector<int>>(pw_conv->Op()->GetAttr("strides"));
+    auto pw_paddings =
+        boost::get<std::vector<int>>(pw_conv->Op()->GetAttr("paddings"));
+    if (pw_dims.size() != 4 || pw_dims[1] != dw_dims[0] || pw_dims[2] != 1 ||
+        pw_dims[3] != 1 || pw_strides != std::vector<int>({1, 1}) ||
+        pw_paddings != std::vector<int>({0, 0})) {
+      return;
+    }
+
+    // Fold the batch_norm into the depthwise filter, which is only read by
+    // the depthwise conv, and a new bias.
+    auto* scale_tensor = GetFloatTensor(scope, bn_scale);
+    auto* bn_bias_tensor = GetFloatTensor(scope, bn_bias);
+    auto* mean_tensor = GetFloatTensor(scope, bn_mean);
+    auto* variance_tensor = GetFloatTensor(scope, bn_variance);
+    if (!scale_tensor || !bn_bias_tensor || !mean_tensor || !variance_tensor) {
+      return;
+    }
+    const int64_t channels = dw_dims[0];
+    PADDLE_ENFORCE_EQ(scale_tensor->numel(), channels);
+    const float epsilon =
+        boost::get<float>(batch_norm->Op()->GetAttr("epsilon"));
+
+    VarDesc dw_bias_desc(patterns::PDNodeName(name_scope_, "dw_bias"));
+    dw_bias_desc.SetPersistable(true);
+    dw_bias_desc.SetShape({channels});
+    dw_bias_desc.SetDataType(proto::VarType::FP32);
+    auto* dw_bias = g->CreateVarNode(&dw_bias_desc);
+    auto* dw_bias_tensor =
+        scope->Var(dw_bias->Name())->GetMutable<LoDTensor>();
+    dw_bias_tensor->Resize({channels});
+    float* dw_bias_data =
+        dw_bias_tensor->mutable_data<float>(platform::CPUPlace());
+    float* dw_data = dw_tensor->mutable_data<float>(platform::CPUPlace());
+    const float* scale_data = scale_tensor->data<float>();
+    const float* bn_bias_data = bn_bias_tensor->data<float>();
+    const float* mean_data = mean_tensor->data<float>();
+    const float* variance_data = variance_tensor->data<float>();
+    const int64_t filter_size = dw_dims[2] * dw_dims[3];
+    for (int64_t c = 0; c < channels; ++c) {
+      const float alpha = scale_data[c] / std::sqrt(variance_data[c] + epsilon);
+      for (int64_t j = 0; j < filter_size; ++j) {
+        dw_data[c * filter_size + j] *= alpha;
+      }
+      dw_bias_data[c] = bn_bias_data[c] - alpha * mean_data[c];
+    }
+
+    OpDesc desc;
+    desc.SetType("fusion_depthwise_pointwise_conv");
+    desc.SetInput("Input", {dw_input->Name()});
+    desc.SetInput("DepthwiseFilter", {dw_filter->Name()});
+    desc.SetInput("DepthwiseBias", {dw_bias->Name()});
+    desc.SetInput("PointwiseFilter", {pw_filter->Name()});
+    desc.SetOutput("Output", {pw_out->Name()});
+    desc.SetAttr("strides", dw_conv->Op()->GetAttr("strides"));
+    desc.SetAttr("paddings", dw_conv->Op()->GetAttr("paddings"));
+    desc.SetAttr("dilations", dw_conv->Op()->GetAttr("dilations"));
+    desc.SetAttr("fuse_relu", true);
+
+    auto* op = g->CreateOpNode(&desc);
+    IR_NODE_LINK_TO(dw_input, op);
+    IR_NODE_LINK_TO(dw_filter, op);
+    IR_NODE_LINK_TO(dw_bias, op);
+    IR_NODE_LINK_TO(pw_filter, op);
+    IR_NODE_LINK_TO(op, pw_out);
+    GraphSafeRemoveNodes(
+        g, {dw_conv, dw_out, batch_norm, bn_scale, bn_bias, bn_mean,
+            bn_variance, bn_out, bn_mean_out, bn_variance_out, bn_saved_mean,
+            bn_saved_variance, relu, relu_out, pw_conv});
+    ++fusion_count;
+  };
+
+  gpd(graph.get(), handler);
+  AddStatis(fusion_count);
+
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(depthwise_pointwise_conv_fuse_pass,
+              paddle::framework::ir::DepthwisePointwiseConvFusePass);
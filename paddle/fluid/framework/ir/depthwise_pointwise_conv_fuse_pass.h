@@ -0,0 +1,44 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Fuse the depthwise separable convolution blocks of MobileNet at inference,
+ * depthwise conv + batch_norm + relu + 1x1 conv, into a
+ * fusion_depthwise_pointwise_conv op. The batch_norm is folded into the
+ * depthwise filter and a new bias.
+ */
+class DepthwisePointwiseConvFusePass : public FusePassBase {
+ public:
+  virtual ~DepthwisePointwiseConvFusePass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(std::unique_ptr<ir::Graph> graph) const;
+
+  const std::string name_scope_{"depthwise_pointwise_conv_fuse"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
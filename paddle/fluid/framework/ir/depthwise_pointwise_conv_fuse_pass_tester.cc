@@ -0,0 +1,173 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/depthwise_pointwise_conv_fuse_pass.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/scope.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::map<std::string, std::string>& inputs,
+           const std::map<std::string, std::string>& outputs,
+           int groups = 1) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  if (type == "conv2d" || type == "depthwise_conv2d") {
+    op->SetAttr("groups", groups);
+    op->SetAttr("strides", std::vector<int>({1, 1}));
+    op->SetAttr("paddings", std::vector<int>({groups > 1 ? 1 : 0, 0}));
+    op->SetAttr("dilations", std::vector<int>({1, 1}));
+  } else if (type == "batch_norm") {
+    op->SetAttr("is_test", true);
+    op->SetAttr("epsilon", 1e-5f);
+  }
+  for (auto& input : inputs) {
+    op->SetInput(input.first, {input.second});
+  }
+  for (auto& output : outputs) {
+    op->SetOutput(output.first, {output.second});
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kForward));
+}
+
+void AddBatchNorm(ProgramDesc* prog, const std::string& x,
+                  const std::string& y, const std::string& prefix) {
+  SetOp(prog, "batch_norm", {{"X", x},
+                             {"Scale", prefix + "scale"},
+                             {"Bias", prefix + "bias"},
+                             {"Mean", prefix + "mean"},
+                             {"Variance", prefix + "var"}},
+        {{"Y", y},
+         {"MeanOut", prefix + "mean"},
+         {"VarianceOut", prefix + "var"},
+         {"SavedMean", prefix + "saved_mean"},
+         {"SavedVariance", prefix + "saved_var"}});
+}
+
+// (a, w1)->depthwise_conv2d->b->batch_norm->c->relu->d
+// (d, w2)->conv2d->e
+// (e, w3)->conv2d(groups=4)->f->batch_norm->g->sigmoid->h
+// (h, w4)->conv2d->i
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>(
+           {"a", "b", "c", "d", "e", "f", "g", "h", "i", "1saved_mean",
+            "1saved_var", "2saved_mean", "2saved_var"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    var->SetShape({1, 4, 8, 6});
+  }
+  for (auto& v : std::vector<std::string>(
+           {"w1", "w2", "w3", "w4", "1scale", "1bias", "1mean", "1var",
+            "2scale", "2bias", "2mean", "2var"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    var->SetPersistable(true);
+  }
+
+  SetOp(&prog, "depthwise_conv2d", {{"Input", "a"}, {"Filter", "w1"}},
+        {{"Output", "b"}}, 4);
+  AddBatchNorm(&prog, "b", "c", "1");
+  SetOp(&prog, "relu", {{"X", "c"}}, {{"Out", "d"}});
+  SetOp(&prog, "conv2d", {{"Input", "d"}, {"Filter", "w2"}}, {{"Output", "e"}});
+  SetOp(&prog, "conv2d", {{"Input", "e"}, {"Filter", "w3"}}, {{"Output", "f"}},
+        4);
+  AddBatchNorm(&prog, "f", "g", "2");
+  SetOp(&prog, "sigmoid", {{"X", "g"}}, {{"Out", "h"}});
+  SetOp(&prog, "conv2d", {{"Input", "h"}, {"Filter", "w4"}}, {{"Output", "i"}});
+  return prog;
+}
+
+void InitTensor(Scope* scope, const std::string& name,
+                const std::vector<int64_t>& dims, float value) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  auto* data =
+      tensor->mutable_data<float>(make_ddim(dims), platform::CPUPlace());
+  for (int i = 0; i < tensor->numel(); ++i) {
+    data[i] = value;
+  }
+}
+
+TEST(DepthwisePointwiseConvFusePass, basic) {
+  Scope scope;
+  for (auto& name : std::vector<std::string>({"w1", "w3"})) {
+    InitTensor(&scope, name, {4, 1, 3, 3}, 1.f);
+  }
+  for (auto& name : std::vector<std::string>({"w2", "w4"})) {
+    InitTensor(&scope, name, {8, 4, 1, 1}, 1.f);
+  }
+  for (auto& prefix : std::vector<std::string>({"1", "2"})) {
+    InitTensor(&scope, prefix + "scale", {4}, 2.f);
+    InitTensor(&scope, prefix + "bias", {4}, 1.f);
+    InitTensor(&scope, prefix + "mean", {4}, 0.5f);
+    InitTensor(&scope, prefix + "var", {4}, 4.f);
+  }
+
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  graph->Set(kParamScopeAttr, new Scope*(&scope));
+  auto pass =
+      PassRegistry::Instance().Get("depthwise_pointwise_conv_fuse_pass");
+  graph = pass->Apply(std::move(graph));
+
+  int fused_count = 0;
+  int batch_norm_count = 0;
+  std::string bias_name;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    auto* op = node->Op();
+    if (op->Type() == "fusion_depthwise_pointwise_conv") {
+      ++fused_count;
+      EXPECT_EQ(op->Input("Input")[0], "a");
+      EXPECT_EQ(op->Input("DepthwiseFilter")[0], "w1");
+      EXPECT_EQ(op->Input("PointwiseFilter")[0], "w2");
+      EXPECT_EQ(op->Output("Output")[0], "e");
+      EXPECT_EQ(boost::get<std::vector<int>>(op->GetAttr("paddings")),
+                std::vector<int>({1, 0}));
+      bias_name = op->Input("DepthwiseBias")[0];
+    } else if (op->Type() == "batch_norm") {
+      ++batch_norm_count;
+    } else if (op->Type() == "relu") {
+      ADD_FAILURE() << "relu should be fused";
+    }
+  }
+  // The second block has no relu.
+  EXPECT_EQ(fused_count, 1);
+  EXPECT_EQ(batch_norm_count, 1);
+
+  // alpha = scale / sqrt(var + eps), bias = bn_bias - alpha * mean
+  const float alpha = 2.f / std::sqrt(4.f + 1e-5f);
+  auto& w1 = scope.FindVar("w1")->Get<LoDTensor>();
+  EXPECT_FLOAT_EQ(w1.data<float>()[5], alpha);
+  auto& bias = scope.FindVar(bias_name)->Get<LoDTensor>();
+  EXPECT_EQ(bias.numel(), 4);
+  EXPECT_FLOAT_EQ(bias.data<float>()[3], 1.f - alpha * 0.5f);
+  EXPECT_FLOAT_EQ(scope.FindVar("w3")->Get<LoDTensor>().data<float>()[5], 1.f);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(depthwise_pointwise_conv_fuse_pass);
@@ -0,0 +1,187 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/elementwise_chain_fuse_pass.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+// It should be the same as kMaxElementwiseChainSteps of
+// fusion_elementwise_chain_op.
+static constexpr size_t kMaxChainLength = 16;
+
+static bool IsBinaryOp(const std::string& type) {
+  static const std::unordered_set<std::string> ops = {
+      "elementwise_add", "elementwise_sub", "elementwise_mul",
+      "elementwise_div", "elementwise_max", "elementwise_min"};
+  return ops.count(type);
+}
+
+static bool IsChainOp(Node* node) {
+  static const std::unordered_set<std::string> unary_ops = {
+      "relu", "sigmoid", "tanh", "exp", "abs", "square", "sqrt", "scale"};
+  if (!node->IsOp() || !node->Op()) return false;
+  auto* op = node->Op();
+  if (op->HasAttr("use_mkldnn") && boost::get<bool>(op->GetAttr("use_mkldnn")))
+    return false;
+  return IsBinaryOp(op->Type()) || unary_ops.count(op->Type());
+}
+
+// Return the var node of the only argument of the op, or nullptr.
+static Node* GetVar(Node* op, const std::vector<Node*>& vars,
+                    const std::vector<std::string>& names) {
+  if (names.size() != 1) return nullptr;
+  for (auto* var : vars) {
+    if (var->IsVar() && var->Name() == names[0]) return var;
+  }
+  return nullptr;
+}
+
+static Node* InputVar(Node* op, const std::string& arg) {
+  return GetVar(op, op->inputs, op->Op()->Input(arg));
+}
+
+static Node* OutputVar(Node* op, const std::string& arg) {
+  return GetVar(op, op->outputs, op->Op()->Output(arg));
+}
+
+static OpDesc BuildChainOpDesc(const std::vector<Node*>& chain) {
+  std::vector<std::string> functors;
+  std::vector<std::string> ys;
+  std::vector<int> axis;
+  std::vector<float> scale;
+  std::vector<float> bias;
+  for (auto* node : chain) {
+    auto* op = node->Op();
+    functors.push_back(op->Type());
+    if (IsBinaryOp(op->Type())) {
+      ys.push_back(op->Input("Y")[0]);
+      axis.push_back(op->HasAttr("axis") ? boost::get<int>(op->GetAttr("axis"))
+                                         : -1);
+    } else if (op->Type() == "scale") {
+      float s = boost::get<float>(op->GetAttr("scale"));
+      float b =
+          op->HasAttr("bias") ? boost::get<float>(op->GetAttr("bias")) : 0.f;
+      if (op->HasAttr("bias_after_scale") &&
+          !boost::get<bool>(op->GetAttr("bias_after_scale"))) {
+        b *= s;
+      }
+      scale.push_back(s);
+      bias.push_back(b);
+    }
+  }
+
+  OpDesc desc;
+  desc.SetType("fusion_elementwise_chain");
+  desc.SetInput("X", chain.front()->Op()->Input("X"));
+  desc.SetInput("Y", ys);
+  desc.SetOutput("Out", chain.back()->Op()->Output("Out"));
+  desc.SetAttr("functor_list", functors);
+  desc.SetAttr("axis", axis);
+  desc.SetAttr("scale", scale);
+  desc.SetAttr("bias", bias);
+  return desc;
+}
+
+std::unique_ptr<ir::Graph> ElementwiseChainFusePass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  FusePassBase::Init(name_scope_, graph.get());
+
+  auto ops = TopologySortOperations(*graph);
+  std::unordered_map<Node*, size_t> order;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    order[ops[i]] = i;
+  }
+
+  // Find all the chains before changing the graph.
+  std::unordered_set<Node*> in_chain;
+  std::vector<std::vector<Node*>> chains;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    Node* head = ops[i];
+    if (in_chain.count(head) || !IsChainOp(head) || !InputVar(head, "X") ||
+        !OutputVar(head, "Out")) {
+      continue;
+    }
+    if (IsBinaryOp(head->Op()->Type()) && !InputVar(head, "Y")) continue;
+
+    std::vector<Node*> chain({head});
+    while (chain.size() < kMaxChainLength) {
+      Node* out = OutputVar(chain.back(), "Out");
+      if (!out->Var() || out->Var()->Persistable() ||
+          out->outputs.size() != 1) {
+        break;
+      }
+      Node* next = out->outputs[0];
+      if (!IsChainOp(next) || InputVar(next, "X") != out ||
+          !OutputVar(next, "Out")) {
+        break;
+      }
+      if (IsBinaryOp(next->Op()->Type())) {
+        Node* y = InputVar(next, "Y");
+        if (!y || y == out) break;
+        // The Y computed after the head might depend on the chain, then the
+        // fused op would make a circle.
+        if (!y->inputs.empty()) {
+          auto it = order.find(y->inputs[0]);
+          if (it == order.end() || it->second >= i) break;
+        }
+      }
+      chain.push_back(next);
+    }
+    if (chain.size() < 2) continue;
+    in_chain.insert(chain.begin(), chain.end());
+    chains.push_back(chain);
+  }
+
+  std::unordered_set<const Node*> marked_nodes;
+  for (auto& chain : chains) {
+    VLOG(4) << "fuse an elementwise chain of " << chain.size() << " ops";
+    OpDesc desc = BuildChainOpDesc(chain);
+    auto* fused = graph->CreateOpNode(&desc);
+
+    std::unordered_set<Node*> inputs({InputVar(chain.front(), "X")});
+    for (size_t k = 0; k < chain.size(); ++k) {
+      marked_nodes.insert(chain[k]);
+      if (k + 1 < chain.size()) {
+        marked_nodes.insert(OutputVar(chain[k], "Out"));
+      }
+      if (IsBinaryOp(chain[k]->Op()->Type())) {
+        inputs.insert(InputVar(chain[k], "Y"));
+      }
+    }
+    for (auto* input : inputs) {
+      IR_NODE_LINK_TO(input, fused);
+    }
+    IR_NODE_LINK_TO(fused, OutputVar(chain.back(), "Out"));
+  }
+  GraphSafeRemoveNodes(graph.get(), marked_nodes);
+  AddStatis(chains.size());
+
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(elementwise_chain_fuse_pass,
+              paddle::framework::ir::ElementwiseChainFusePass);
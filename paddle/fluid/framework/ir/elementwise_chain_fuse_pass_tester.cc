@@ -0,0 +1,99 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/elementwise_chain_fuse_pass.h"
+
+#include <gtest/gtest.h>
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+OpDesc* SetOp(ProgramDesc* prog, const std::string& type,
+              const std::map<std::string, std::string>& inputs,
+              const std::string& output) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  for (auto& input : inputs) {
+    op->SetInput(input.first, {input.second});
+  }
+  op->SetOutput("Out", {output});
+  return op;
+}
+
+// x->scale->a, (a, b)->elementwise_add->c, c->relu->d->sigmoid->e->fetch
+// x->tanh->f, (f, f)->elementwise_mul->g
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>(
+           {"x", "a", "b", "c", "d", "e", "f", "g", "fetched"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    if (v == "b") {
+      var->SetPersistable(true);
+    }
+  }
+  auto* scale = SetOp(&prog, "scale", {{"X", "x"}}, "a");
+  scale->SetAttr("scale", 2.f);
+  scale->SetAttr("bias", 1.f);
+  scale->SetAttr("bias_after_scale", false);
+  auto* add = SetOp(&prog, "elementwise_add", {{"X", "a"}, {"Y", "b"}}, "c");
+  add->SetAttr("axis", 1);
+  SetOp(&prog, "relu", {{"X", "c"}}, "d");
+  SetOp(&prog, "sigmoid", {{"X", "d"}}, "e");
+  SetOp(&prog, "fetch", {{"X", "e"}}, "fetched");
+
+  SetOp(&prog, "tanh", {{"X", "x"}}, "f");
+  SetOp(&prog, "elementwise_mul", {{"X", "f"}, {"Y", "f"}}, "g");
+  return prog;
+}
+
+TEST(ElementwiseChainFusePass, basic) {
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("elementwise_chain_fuse_pass");
+  graph = pass->Apply(std::move(graph));
+
+  int num_fused = 0;
+  std::vector<std::string> op_types;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    auto* op = node->Op();
+    op_types.push_back(op->Type());
+    if (op->Type() != "fusion_elementwise_chain") continue;
+    ++num_fused;
+    EXPECT_EQ(op->Input("X"), std::vector<std::string>({"x"}));
+    EXPECT_EQ(op->Input("Y"), std::vector<std::string>({"b"}));
+    EXPECT_EQ(op->Output("Out"), std::vector<std::string>({"e"}));
+    EXPECT_EQ(boost::get<std::vector<std::string>>(op->GetAttr("functor_list")),
+              std::vector<std::string>(
+                  {"scale", "elementwise_add", "relu", "sigmoid"}));
+    EXPECT_EQ(boost::get<std::vector<int>>(op->GetAttr("axis")),
+              std::vector<int>({1}));
+    EXPECT_EQ(boost::get<std::vector<float>>(op->GetAttr("scale")),
+              std::vector<float>({2.f}));
+    // the bias is applied before the scale
+    EXPECT_EQ(boost::get<std::vector<float>>(op->GetAttr("bias")),
+              std::vector<float>({2.f}));
+  }
+  EXPECT_EQ(num_fused, 1);
+  // fetch, tanh and elementwise_mul are kept
+  EXPECT_EQ(op_types.size(), 4UL);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(elementwise_chain_fuse_pass);
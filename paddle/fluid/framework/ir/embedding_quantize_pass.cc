@@ -0,0 +1,143 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/embedding_quantize_pass.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/operators/lookup_table_op.h"
+#include "paddle/fluid/platform/float16.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// Whether var is an FP32 table only read by the lookup_table ops of dense
+// tables in the graph.
+bool IsQuantizableTable(Node* var) {
+  if (!var->IsVar() || !var->Var() || !var->Var()->Persistable() ||
+      var->Var()->GetType() != proto::VarType::LOD_TENSOR ||
+      var->Var()->GetDataType() != proto::VarType::FP32 ||
+      !var->inputs.empty() || var->outputs.empty()) {
+    return false;
+  }
+  for (auto* reader : var->outputs) {
+    auto* op = reader->Op();
+    if (op == nullptr || op->Type() != "lookup_table" ||
+        op->Input("W") != std::vector<std::string>({var->Name()}) ||
+        boost::get<bool>(op->GetAttr("is_distributed")) ||
+        (op->HasAttr("table_format") &&
+         !boost::get<std::string>(op->GetAttr("table_format")).empty())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void QuantizeFloat16(const LoDTensor& table, LoDTensor* out) {
+  const float* src = table.data<float>();
+  auto* dst = out->mutable_data<platform::float16>(table.dims(),
+                                                   platform::CPUPlace());
+  for (int64_t i = 0; i < table.numel(); ++i) {
+    dst[i] = static_cast<platform::float16>(src[i]);
+  }
+}
+
+void QuantizeInt8Rowwise(const LoDTensor& table, LoDTensor* out) {
+  const int64_t rows = table.dims()[0];
+  const int64_t width = table.dims()[1];
+  const int64_t row_bytes = width + operators::kInt8RowwiseExtraBytes;
+  const float* src = table.data<float>();
+  auto* dst =
+      out->mutable_data<uint8_t>(make_ddim({rows, row_bytes}),
+                                 platform::CPUPlace());
+  for (int64_t r = 0; r < rows; ++r) {
+    const float* row = src + r * width;
+    uint8_t* codes = dst + r * row_bytes;
+    auto range = std::minmax_element(row, row + width);
+    float bias = width > 0 ? *range.first : 0.f;
+    float scale = width > 0 ? (*range.second - bias) / 255.f : 0.f;
+    if (scale == 0.f) scale = 1.f;
+    for (int64_t j = 0; j < width; ++j) {
+      float code = std::round((row[j] - bias) / scale);
+      codes[j] = static_cast<uint8_t>(std::min(std::max(code, 0.f), 255.f));
+    }
+    float scale_bias[2] = {scale, bias};
+    std::memcpy(codes + width, scale_bias, sizeof(scale_bias));
+  }
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> EmbeddingQuantizePass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+  FusePassBase::Init("embedding_quantize", graph.get());
+  auto* scope = param_scope();
+  std::string format = Has("table_format") ? Get<std::string>("table_format")
+                                           : operators::kTableInt8Rowwise;
+  PADDLE_ENFORCE(format == operators::kTableInt8Rowwise ||
+                     format == operators::kTableFloat16,
+                 "Unknown table_format %s", format);
+
+  int num_tables = 0;
+  int64_t fp32_bytes = 0;
+  int64_t quantized_bytes = 0;
+  for (auto* node : graph->Nodes()) {
+    if (!IsQuantizableTable(node)) continue;
+    auto* var = scope->FindVar(node->Name());
+    PADDLE_ENFORCE_NOT_NULL(var, "The table %s is not in the scope",
+                            node->Name());
+    auto* table = var->GetMutable<LoDTensor>();
+    PADDLE_ENFORCE(table->IsInitialized(), "The table %s is not loaded",
+                   node->Name());
+    if (!platform::is_cpu_place(table->place()) || table->dims().size() != 2) {
+      VLOG(3) << "Keep the table " << node->Name() << " in FP32";
+      continue;
+    }
+
+    LoDTensor quantized;
+    if (format == operators::kTableFloat16) {
+      QuantizeFloat16(*table, &quantized);
+      node->Var()->SetDataType(proto::VarType::FP16);
+    } else {
+      QuantizeInt8Rowwise(*table, &quantized);
+      node->Var()->SetDataType(proto::VarType::UINT8);
+    }
+    node->Var()->SetShape(vectorize(quantized.dims()));
+    fp32_bytes += table->memory_size();
+    quantized_bytes += quantized.memory_size();
+    table->ShareDataWith(quantized);
+    for (auto* reader : node->outputs) {
+      reader->Op()->SetAttr("table_format", format);
+    }
+    ++num_tables;
+  }
+  VLOG(3) << "Quantized " << num_tables << " tables to " << format << ", "
+          << fp32_bytes << " bytes to " << quantized_bytes << " bytes";
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(embedding_quantize_pass,
+              paddle::framework::ir::EmbeddingQuantizePass);
@@ -0,0 +1,47 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Quantize the embedding tables read by lookup_table for the inference on
+ * CPU, to cut the memory of the models dominated by large tables.
+ *
+ * The FP32 tables in the parameter scope only read by lookup_table are
+ * converted once to the "table_format" attribute of the pass, "int8_rowwise"
+ * by default or "float16", and the lookup_table ops dequantize the rows they
+ * gather. An int8_rowwise row keeps the uint8 codes of the elements followed
+ * by the float scale and bias of the row, which is about a quarter of the
+ * FP32 row.
+ */
+class EmbeddingQuantizePass : public FusePassBase {
+ public:
+  virtual ~EmbeddingQuantizePass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,151 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/embedding_quantize_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/scope.h"
+
+USE_OP(lookup_table);
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+const int64_t kRows = 8;
+const int64_t kWidth = 5;
+
+OpDesc* SetOp(ProgramDesc* prog, const std::string& type,
+              const std::map<std::string, std::string>& inputs,
+              const std::map<std::string, std::string>& outputs) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  for (auto& input : inputs) {
+    op->SetInput(input.first, {input.second});
+  }
+  for (auto& output : outputs) {
+    op->SetOutput(output.first, {output.second});
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kForward));
+  return op;
+}
+
+// (w, ids)->lookup_table->a
+// (v, ids)->lookup_table->b
+// (b, v)->mul->c
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>({"w", "v", "ids", "a", "b", "c"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(v == "ids" ? proto::VarType::INT64
+                                : proto::VarType::FP32);
+    if (v == "w" || v == "v") {
+      var->SetPersistable(true);
+      var->SetShape({kRows, kWidth});
+    }
+  }
+  SetOp(&prog, "lookup_table", {{"W", "w"}, {"Ids", "ids"}}, {{"Out", "a"}});
+  SetOp(&prog, "lookup_table", {{"W", "v"}, {"Ids", "ids"}}, {{"Out", "b"}});
+  SetOp(&prog, "mul", {{"X", "b"}, {"Y", "v"}}, {{"Out", "c"}});
+  for (auto* op : prog.Block(0).AllOps()) {
+    if (op->Type() == "lookup_table") op->CheckAttrs();
+  }
+  return prog;
+}
+
+void InitTable(Scope* scope, const std::string& name) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  auto* data = tensor->mutable_data<float>(make_ddim({kRows, kWidth}),
+                                           platform::CPUPlace());
+  for (int64_t i = 0; i < kRows * kWidth; ++i) {
+    data[i] = 0.37f * (i % 7) - 1.f + 0.1f * (i / kWidth);
+  }
+}
+
+void TestQuantize(const std::string& format, proto::VarType::Type dtype,
+                  int64_t row_bytes, float error) {
+  platform::CPUPlace place;
+  platform::DeviceContextPool::Init({place});
+  Scope scope;
+  InitTable(&scope, "w");
+  InitTable(&scope, "v");
+  LoDTensor expected;
+  TensorCopySync(scope.FindVar("w")->Get<LoDTensor>(), place, &expected);
+  auto* ids = scope.Var("ids")->GetMutable<LoDTensor>();
+  auto* ids_data = ids->mutable_data<int64_t>(make_ddim({4, 1}), place);
+  for (int64_t i = 0; i < 4; ++i) {
+    ids_data[i] = (i * 3) % kRows;
+  }
+  scope.Var("a");
+
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  graph->Set(kParamScopeAttr, new Scope*(&scope));
+  auto pass = PassRegistry::Instance().Get("embedding_quantize_pass");
+  pass->Set("table_format", new std::string(format));
+  graph = pass->Apply(std::move(graph));
+
+  OpDesc* lookup = nullptr;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && node->Name() == "w") {
+      EXPECT_EQ(node->Var()->GetDataType(), dtype);
+      EXPECT_EQ(node->Var()->GetShape(),
+                std::vector<int64_t>({kRows, row_bytes}));
+    } else if (node->IsVar() && node->Name() == "v") {
+      // v is also read by mul.
+      EXPECT_EQ(node->Var()->GetDataType(), proto::VarType::FP32);
+    } else if (node->IsOp() && node->Op()->Input("W") ==
+                                   std::vector<std::string>({"w"})) {
+      EXPECT_EQ(boost::get<std::string>(node->Op()->GetAttr("table_format")),
+                format);
+      lookup = node->Op();
+    }
+  }
+  EXPECT_EQ(scope.FindVar("w")->Get<LoDTensor>().dims(),
+            make_ddim({kRows, row_bytes}));
+  EXPECT_TRUE(scope.FindVar("v")->Get<LoDTensor>().type() == typeid(float));
+
+  ASSERT_NE(lookup, nullptr);
+  auto op = OpRegistry::CreateOp(*lookup);
+  op->Run(scope, place);
+  auto& a = scope.FindVar("a")->Get<LoDTensor>();
+  ASSERT_EQ(a.dims(), make_ddim({4, kWidth}));
+  for (int64_t i = 0; i < 4; ++i) {
+    for (int64_t j = 0; j < kWidth; ++j) {
+      EXPECT_NEAR(a.data<float>()[i * kWidth + j],
+                  expected.data<float>()[ids_data[i] * kWidth + j], error);
+    }
+  }
+}
+
+TEST(EmbeddingQuantizePass, int8_rowwise) {
+  // The rows range in less than 2.5, the error is at most half a step.
+  TestQuantize("int8_rowwise", proto::VarType::UINT8,
+               kWidth + 2 * sizeof(float), 2.5f / 255 / 2 + 1e-5);
+}
+
+TEST(EmbeddingQuantizePass, float16) {
+  TestQuantize("float16", proto::VarType::FP16, kWidth, 1e-3);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(embedding_quantize_pass);
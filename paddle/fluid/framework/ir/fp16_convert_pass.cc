@@ -0,0 +1,226 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fp16_convert_pass.h"
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/data_type_transform.h"
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/scope.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// The operators having float16 CUDA kernels.
+const std::unordered_set<std::string> kFP16Ops = {
+    "mul",     "elementwise_add", "batch_norm", "dropout",
+    "relu",    "sigmoid",         "tanh",       "leaky_relu",
+    "relu6",   "brelu",           "elu",        "swish"};
+
+// The operators only having float16 kernels with cuDNN.
+const std::unordered_set<std::string> kCUDNNFP16Ops = {"conv2d", "pool2d"};
+
+// The arguments keeping FP32 in the converted operators.
+const std::unordered_map<std::string, std::unordered_set<std::string>>
+    kFP32Slots = {{"batch_norm",
+                   {"Scale", "Bias", "Mean", "Variance", "MeanOut",
+                    "VarianceOut", "SavedMean", "SavedVariance"}}};
+
+bool IsFP32Slot(OpDesc* op, const std::string& slot) {
+  auto it = kFP32Slots.find(op->Type());
+  return it != kFP32Slots.end() && it->second.count(slot);
+}
+
+bool IsFP32Tensor(Node* var) {
+  return var->IsVar() && var->Var() &&
+         var->Var()->GetType() == proto::VarType::LOD_TENSOR &&
+         var->Var()->GetDataType() == proto::VarType::FP32;
+}
+
+bool HasName(const VariableNameMap& args, const std::string& name,
+             OpDesc* op, bool in_fp32_slots) {
+  for (auto& arg : args) {
+    if (IsFP32Slot(op, arg.first) != in_fp32_slots) continue;
+    if (std::find(arg.second.begin(), arg.second.end(), name) !=
+        arg.second.end()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Rename the arguments of the FP16 slots of op from `from` to `to`.
+void RenameFP16Slots(OpDesc* op, const std::string& from,
+                     const std::string& to, bool is_input) {
+  auto args = is_input ? op->Inputs() : op->Outputs();
+  for (auto& arg : args) {
+    if (IsFP32Slot(op, arg.first)) continue;
+    auto names = arg.second;
+    std::replace(names.begin(), names.end(), from, to);
+    if (is_input) {
+      op->SetInput(arg.first, names);
+    } else {
+      op->SetOutput(arg.first, names);
+    }
+  }
+}
+
+Node* CreateCastOp(Graph* graph, Node* in, Node* out, proto::VarType::Type from,
+                   proto::VarType::Type to) {
+  OpDesc desc;
+  desc.SetType("cast");
+  desc.SetInput("X", {in->Name()});
+  desc.SetOutput("Out", {out->Name()});
+  desc.SetAttr("in_dtype", static_cast<int>(from));
+  desc.SetAttr("out_dtype", static_cast<int>(to));
+  auto* cast = graph->CreateOpNode(&desc);
+  IR_NODE_LINK_TO(in, cast);
+  IR_NODE_LINK_TO(cast, out);
+  return cast;
+}
+
+void CastParam(Scope* scope, const std::string& name,
+               proto::VarType::Type dtype) {
+  auto* var = scope->FindVar(name);
+  PADDLE_ENFORCE_NOT_NULL(var, "The parameter %s is not in the scope", name);
+  auto* tensor = var->GetMutable<LoDTensor>();
+  PADDLE_ENFORCE(tensor->IsInitialized(), "The parameter %s is not loaded",
+                 name);
+  Tensor low;
+  auto place = tensor->place();
+  TransDataType(OpKernelType(proto::VarType::FP32, place),
+                OpKernelType(dtype, place), *tensor, &low);
+  tensor->ShareDataWith(low);
+}
+
+}  // namespace
+
+bool FP16ConvertPass::CanConvert(Node* n) const {
+  auto* op = n->Op();
+  if (kFP16Ops.count(op->Type())) return true;
+  return kCUDNNFP16Ops.count(op->Type()) && op->HasAttr("use_cudnn") &&
+         boost::get<bool>(op->GetAttr("use_cudnn"));
+}
+
+// The FP16 below stands for the low precision type of the pass.
+
+std::unique_ptr<ir::Graph> FP16ConvertPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+  FusePassBase::Init(LowPrecisionName() + "_convert", graph.get());
+  auto* scope = param_scope();
+  const auto low_type = LowPrecisionType();
+
+  std::vector<Node*> ops = TopologySortOperations(*graph);
+  std::unordered_set<Node*> converted;
+  for (auto* n : ops) {
+    if (CanConvert(n)) converted.insert(n);
+  }
+  // Whether the converted operator n reads var in an FP16 slot.
+  auto reads_fp16 = [&](Node* n, Node* var) {
+    return converted.count(n) &&
+           HasName(n->Op()->Inputs(), var->Name(), n->Op(), false);
+  };
+  auto read_by_fp16_only = [&](Node* var) {
+    if (var->outputs.empty()) return false;
+    for (auto* reader : var->outputs) {
+      if (!reads_fp16(reader, var) ||
+          HasName(reader->Op()->Inputs(), var->Name(), reader->Op(), true)) {
+        return false;
+      }
+    }
+    return true;
+  };
+  auto create_fp16_var = [&](Node* var) {
+    VarDesc desc(var->Name() + "@" + LowPrecisionName());
+    desc.SetDataType(low_type);
+    desc.SetShape(var->Var()->GetShape());
+    return graph->CreateVarNode(&desc);
+  };
+  // Let the FP16 slots of reader read fp16 instead of var.
+  auto redirect = [&](Node* reader, Node* var, Node* fp16) {
+    auto* op = reader->Op();
+    RenameFP16Slots(op, var->Name(), fp16->Name(), true);
+    if (!HasName(op->Inputs(), var->Name(), op, true)) {
+      Unlink(var, reader);
+    }
+    IR_NODE_LINK_TO(fp16, reader);
+  };
+
+  // The FP16 copies of the FP32 variables, shared by the readers.
+  std::unordered_map<Node*, Node*> fp16_copies;
+  int num_casts = 0;
+  // The writers are rewritten before the readers in the topological order.
+  for (auto* n : ops) {
+    if (!converted.count(n)) continue;
+    auto* op = n->Op();
+    std::vector<Node*> inputs = n->inputs;
+    for (auto* var : inputs) {
+      if (!IsFP32Tensor(var) || !reads_fp16(n, var)) continue;
+      if (var->Var()->Persistable() && read_by_fp16_only(var)) {
+        CastParam(scope, var->Name(), low_type);
+        var->Var()->SetDataType(low_type);
+        continue;
+      }
+      auto& fp16 = fp16_copies[var];
+      if (fp16 == nullptr) {
+        fp16 = create_fp16_var(var);
+        CreateCastOp(graph.get(), var, fp16, proto::VarType::FP32, low_type);
+        ++num_casts;
+      }
+      redirect(n, var, fp16);
+    }
+
+    std::vector<Node*> outputs = n->outputs;
+    for (auto* var : outputs) {
+      if (!IsFP32Tensor(var) ||
+          !HasName(op->Outputs(), var->Name(), op, false)) {
+        continue;
+      }
+      if (read_by_fp16_only(var)) {
+        var->Var()->SetDataType(low_type);
+        continue;
+      }
+      // Write an FP16 copy and cast it back to var for the FP32 readers and
+      // the fetches.
+      auto* fp16 = create_fp16_var(var);
+      RenameFP16Slots(op, var->Name(), fp16->Name(), false);
+      Unlink(n, var);
+      IR_NODE_LINK_TO(n, fp16);
+      std::vector<Node*> readers = var->outputs;
+      for (auto* reader : readers) {
+        if (reads_fp16(reader, var)) redirect(reader, var, fp16);
+      }
+      CreateCastOp(graph.get(), fp16, var, low_type, proto::VarType::FP32);
+      ++num_casts;
+    }
+  }
+  VLOG(3) << "Converted " << converted.size() << " operators to "
+          << LowPrecisionName() << " with " << num_casts << " casts";
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fp16_convert_pass, paddle::framework::ir::FP16ConvertPass);
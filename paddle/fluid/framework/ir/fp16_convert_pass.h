@@ -0,0 +1,62 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Run the operators having float16 CUDA kernels in half precision, for the
+ * inference on GPU.
+ *
+ * The FP32 variables of the converted operators become FP16, a cast op is
+ * inserted where an FP16 variable is read by an FP32 operator or the other
+ * way around, and is shared by all the readers. The variables read by no
+ * operator keep FP32 so the fetched outputs do not change their type. The
+ * weights only read by the converted operators are cast to FP16 in the
+ * parameter scope once.
+ *
+ * The numerically sensitive operators, such as softmax, layer_norm and the
+ * reductions, are kept in FP32, so are the parameters of batch_norm.
+ *
+ * The subclasses convert to another low precision type by overriding the
+ * type and the operators to convert.
+ */
+class FP16ConvertPass : public FusePassBase {
+ public:
+  virtual ~FP16ConvertPass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+
+  // Whether the operator n has the kernels of the low precision type.
+  virtual bool CanConvert(Node* n) const;
+  virtual proto::VarType::Type LowPrecisionType() const {
+    return proto::VarType::FP16;
+  }
+  // The suffix of the low precision copies of the variables.
+  virtual std::string LowPrecisionName() const { return "fp16"; }
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
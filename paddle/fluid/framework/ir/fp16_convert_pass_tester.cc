@@ -0,0 +1,140 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fp16_convert_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/platform/float16.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::map<std::string, std::string>& inputs,
+           const std::map<std::string, std::string>& outputs) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  if (type == "conv2d") {
+    op->SetAttr("use_cudnn", true);
+  }
+  for (auto& input : inputs) {
+    op->SetInput(input.first, {input.second});
+  }
+  for (auto& output : outputs) {
+    op->SetOutput(output.first, {output.second});
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kForward));
+}
+
+// (a, w1)->conv2d->b->batch_norm(scale, bias, mean, var)->c->relu->d
+// d->softmax->e
+// (d, w2)->mul->f
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>({"a", "b", "c", "d", "e", "f", "w1",
+                                           "w2", "scale", "bias", "mean",
+                                           "var"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    if (v.size() > 1) {
+      var->SetPersistable(true);
+    }
+  }
+
+  SetOp(&prog, "conv2d", {{"Input", "a"}, {"Filter", "w1"}}, {{"Output", "b"}});
+  SetOp(&prog, "batch_norm", {{"X", "b"},
+                              {"Scale", "scale"},
+                              {"Bias", "bias"},
+                              {"Mean", "mean"},
+                              {"Variance", "var"}},
+        {{"Y", "c"}, {"MeanOut", "mean"}, {"VarianceOut", "var"}});
+  SetOp(&prog, "relu", {{"X", "c"}}, {{"Out", "d"}});
+  SetOp(&prog, "softmax", {{"X", "d"}}, {{"Out", "e"}});
+  SetOp(&prog, "mul", {{"X", "d"}, {"Y", "w2"}}, {{"Out", "f"}});
+  return prog;
+}
+
+void InitParam(Scope* scope, const std::string& name) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  auto* data = tensor->mutable_data<float>(make_ddim({2, 2}),
+                                           platform::CPUPlace());
+  for (int i = 0; i < 4; ++i) {
+    data[i] = 0.5f * i;
+  }
+}
+
+TEST(FP16ConvertPass, basic) {
+  platform::DeviceContextPool::Init({platform::CPUPlace()});
+  Scope scope;
+  for (auto& name : std::vector<std::string>(
+           {"w1", "w2", "scale", "bias", "mean", "var"})) {
+    InitParam(&scope, name);
+  }
+
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  graph->Set(kParamScopeAttr, new Scope*(&scope));
+  auto pass = PassRegistry::Instance().Get("fp16_convert_pass");
+  graph = pass->Apply(std::move(graph));
+
+  std::map<std::string, proto::VarType::Type> dtypes;
+  int cast_count = 0;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && node->Var()) {
+      dtypes[node->Name()] = node->Var()->GetDataType();
+    }
+    if (!node->IsOp()) continue;
+    auto* op = node->Op();
+    if (op->Type() == "cast") {
+      ++cast_count;
+    } else if (op->Type() == "conv2d") {
+      EXPECT_EQ(op->Input("Input")[0], "a@fp16");
+    } else if (op->Type() == "relu") {
+      EXPECT_EQ(op->Output("Out")[0], "d@fp16");
+    } else if (op->Type() == "softmax") {
+      // softmax is kept in FP32.
+      EXPECT_EQ(op->Input("X")[0], "d");
+    } else if (op->Type() == "mul") {
+      EXPECT_EQ(op->Input("X")[0], "d@fp16");
+      EXPECT_EQ(op->Output("Out")[0], "f@fp16");
+    }
+  }
+  // a to FP16, d and f back to FP32.
+  EXPECT_EQ(cast_count, 3);
+  EXPECT_EQ(dtypes["b"], proto::VarType::FP16);
+  EXPECT_EQ(dtypes["c"], proto::VarType::FP16);
+  EXPECT_EQ(dtypes["d"], proto::VarType::FP32);
+  EXPECT_EQ(dtypes["f"], proto::VarType::FP32);
+  EXPECT_EQ(dtypes["w1"], proto::VarType::FP16);
+  EXPECT_EQ(dtypes["scale"], proto::VarType::FP32);
+
+  auto& w2 = scope.FindVar("w2")->Get<LoDTensor>();
+  ASSERT_TRUE(w2.type() == typeid(platform::float16));
+  EXPECT_EQ(w2.dims(), make_ddim({2, 2}));
+  EXPECT_FLOAT_EQ(static_cast<float>(w2.data<platform::float16>()[3]), 1.5f);
+  EXPECT_TRUE(scope.FindVar("scale")->Get<LoDTensor>().type() ==
+              typeid(float));
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(fp16_convert_pass);
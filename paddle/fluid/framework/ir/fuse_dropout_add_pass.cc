@@ -0,0 +1,185 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fuse_dropout_add_pass.h"
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/operator.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static Node* GetVar(const std::vector<Node*>& vars, const std::string& name) {
+  for (auto* var : vars) {
+    if (var->IsVar() && var->Name() == name) return var;
+  }
+  return nullptr;
+}
+
+static Node* GetInputVar(Node* op, const std::string& arg) {
+  auto& names = op->Op()->Input(arg);
+  return names.size() == 1 ? GetVar(op->inputs, names[0]) : nullptr;
+}
+
+static Node* GetOutputVar(Node* op, const std::string& arg) {
+  auto& names = op->Op()->Output(arg);
+  return names.size() == 1 ? GetVar(op->outputs, names[0]) : nullptr;
+}
+
+// The only op reading the var, or nullptr.
+static Node* OnlyConsumer(Node* var, const std::string& type) {
+  if (var == nullptr || var->outputs.size() != 1UL) return nullptr;
+  auto* op = var->outputs[0];
+  return op->IsOp() && op->Op() && op->Op()->Type() == type ? op : nullptr;
+}
+
+static bool IsSameShape(Node* x, Node* y) {
+  return x->Var() && y->Var() && x->Var()->GetShape() == y->Var()->GetShape();
+}
+
+// Replace the ops with a fused op of the desc, which reads and writes the
+// vars in its arguments, the other vars are the intermediate ones to remove.
+static void ReplaceWithFusedOp(Graph* graph, const std::vector<Node*>& ops,
+                               OpDesc* desc) {
+  auto* fused = graph->CreateOpNode(desc);
+  auto input_names = desc->InputArgumentNames();
+  auto output_names = desc->OutputArgumentNames();
+  auto has_name = [](const std::vector<std::string>& names, Node* var) {
+    return std::find(names.begin(), names.end(), var->Name()) != names.end();
+  };
+
+  std::unordered_set<const Node*> removed(ops.begin(), ops.end());
+  for (auto* op : ops) {
+    for (auto* in : op->inputs) {
+      if (in->IsCtrlVar() || has_name(input_names, in)) {
+        if (std::find(fused->inputs.begin(), fused->inputs.end(), in) ==
+            fused->inputs.end()) {
+          IR_NODE_LINK_TO(in, fused);
+        }
+      } else if (in->inputs.size() == 1UL && removed.count(in->inputs[0])) {
+        removed.insert(in);
+      }
+    }
+    for (auto* out : op->outputs) {
+      if (out->IsCtrlVar() || has_name(output_names, out)) {
+        IR_NODE_LINK_TO(fused, out);
+      }
+    }
+  }
+  GraphSafeRemoveNodes(graph, removed);
+}
+
+// elementwise_add_grad(Out@GRAD) -> dropout_out@GRAD -> dropout_grad
+static bool FuseBackward(Graph* graph, Node* add_grad) {
+  auto* d_out = GetInputVar(add_grad, GradVarName("Out"));
+  auto* y = GetInputVar(add_grad, "Y");
+  auto* d_dropout_out = GetOutputVar(add_grad, GradVarName("X"));
+  auto* dropout_grad = OnlyConsumer(d_dropout_out, "dropout_grad");
+  if (!d_out || !y || !dropout_grad || !IsSameShape(d_out, y) ||
+      dropout_grad->Op()->Input(GradVarName("Out")) !=
+          std::vector<std::string>({d_dropout_out->Name()}) ||
+      !GetInputVar(dropout_grad, "Mask")) {
+    return false;
+  }
+
+  OpDesc desc;
+  desc.SetType("fused_dropout_add_grad");
+  desc.SetInput("Mask", dropout_grad->Op()->Input("Mask"));
+  desc.SetInput(GradVarName("Out"), {d_out->Name()});
+  desc.SetOutput(GradVarName("X"),
+                 dropout_grad->Op()->Output(GradVarName("X")));
+  desc.SetOutput(GradVarName("Y"), add_grad->Op()->Output(GradVarName("Y")));
+  for (auto& attr : dropout_grad->Op()->GetAttrMap()) {
+    desc.SetAttr(attr.first, attr.second);
+  }
+  // Keep the parameters and the gradients of both ops to all reduce.
+  std::vector<std::string> op_role_var;
+  for (auto* op : std::vector<OpDesc*>({add_grad->Op(), dropout_grad->Op()})) {
+    if (!op->HasAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName())) continue;
+    auto vars = boost::get<std::vector<std::string>>(
+        op->GetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName()));
+    op_role_var.insert(op_role_var.end(), vars.begin(), vars.end());
+  }
+  desc.SetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName(), op_role_var);
+  VLOG(4) << "fuse " << add_grad->Name() << " and " << dropout_grad->Name()
+          << " of " << d_dropout_out->Name();
+  ReplaceWithFusedOp(graph, std::vector<Node*>({add_grad, dropout_grad}),
+                     &desc);
+  return true;
+}
+
+// dropout -> dropout_out -> elementwise_add(X=dropout_out, Y)
+static bool FuseForward(Graph* graph, Node* dropout) {
+  auto* x = GetInputVar(dropout, "X");
+  auto* dropout_out = GetOutputVar(dropout, "Out");
+  auto* add = OnlyConsumer(dropout_out, "elementwise_add");
+  if (!x || !add || (dropout_out->Var() && dropout_out->Var()->Persistable()) ||
+      add->Op()->Input("X") !=
+          std::vector<std::string>({dropout_out->Name()})) {
+    return false;
+  }
+  auto* y = GetInputVar(add, "Y");
+  auto* out = GetOutputVar(add, "Out");
+  if (!y || !out || y == dropout_out || !IsSameShape(dropout_out, y)) {
+    return false;
+  }
+
+  OpDesc desc;
+  desc.SetType("fused_dropout_add");
+  desc.SetInput("X", {x->Name()});
+  desc.SetInput("Y", {y->Name()});
+  desc.SetOutput("Out", {out->Name()});
+  desc.SetOutput("Mask", dropout->Op()->Output("Mask"));
+  for (auto& attr : dropout->Op()->GetAttrMap()) {
+    desc.SetAttr(attr.first, attr.second);
+  }
+  VLOG(4) << "fuse " << dropout->Name() << " and " << add->Name() << " of "
+          << dropout_out->Name();
+  ReplaceWithFusedOp(graph, std::vector<Node*>({dropout, add}), &desc);
+  return true;
+}
+
+std::unique_ptr<ir::Graph> FuseDropoutAddPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  // The backward is fused first, the dropout_grad reads the Out of the
+  // dropout, which should be read only by the elementwise_add to fuse.
+  int num_fused_grad = 0;
+  for (auto* node : TopologySortOperations(*graph)) {
+    if (node->Op()->Type() == "elementwise_add_grad" &&
+        FuseBackward(graph.get(), node)) {
+      ++num_fused_grad;
+    }
+  }
+  int num_fused = 0;
+  for (auto* node : TopologySortOperations(*graph)) {
+    if (node->Op()->Type() == "dropout" && FuseForward(graph.get(), node)) {
+      ++num_fused;
+    }
+  }
+  VLOG(3) << "fuse " << num_fused << " dropout + elementwise_add and "
+          << num_fused_grad << " of their grads";
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fuse_dropout_add_pass, paddle::framework::ir::FuseDropoutAddPass);
@@ -0,0 +1,123 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fuse_dropout_add_pass.h"
+
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::vector<std::pair<std::string, std::string>>& inputs,
+           const std::vector<std::pair<std::string, std::string>>& outputs,
+           OpRole role) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  for (auto& in : inputs) op->SetInput(in.first, {in.second});
+  for (auto& out : outputs) op->SetOutput(out.first, {out.second});
+  if (type == "dropout" || type == "dropout_grad") {
+    op->SetAttr("dropout_prob", 0.1f);
+    op->SetAttr("is_test", false);
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(role));
+}
+
+// a = dropout(x), b = a + y, c = dropout(b), d = c + c and their grads,
+// only the first dropout and add are fused
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>(
+           {"x", "y", "a", "a_mask", "b", "c", "c_mask", "d", "d@GRAD",
+            "c@GRAD", "b@GRAD", "a@GRAD", "y@GRAD", "x@GRAD"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    var->SetShape({-1, 32});
+  }
+  SetOp(&prog, "dropout", {{"X", "x"}}, {{"Out", "a"}, {"Mask", "a_mask"}},
+        OpRole::kForward);
+  SetOp(&prog, "elementwise_add", {{"X", "a"}, {"Y", "y"}}, {{"Out", "b"}},
+        OpRole::kForward);
+  SetOp(&prog, "dropout", {{"X", "b"}}, {{"Out", "c"}, {"Mask", "c_mask"}},
+        OpRole::kForward);
+  SetOp(&prog, "elementwise_add", {{"X", "c"}, {"Y", "c"}}, {{"Out", "d"}},
+        OpRole::kForward);
+  SetOp(&prog, "dropout_grad",
+        {{"Mask", "c_mask"}, {"Out", "c"}, {"Out@GRAD", "c@GRAD"}},
+        {{"X@GRAD", "b@GRAD"}}, OpRole::kBackward);
+  SetOp(&prog, "elementwise_add_grad",
+        {{"Y", "y"}, {"Out@GRAD", "b@GRAD"}},
+        {{"X@GRAD", "a@GRAD"}, {"Y@GRAD", "y@GRAD"}}, OpRole::kBackward);
+  SetOp(&prog, "dropout_grad",
+        {{"Mask", "a_mask"}, {"Out", "a"}, {"Out@GRAD", "a@GRAD"}},
+        {{"X@GRAD", "x@GRAD"}}, OpRole::kBackward);
+  return prog;
+}
+
+TEST(FuseDropoutAddPass, basic) {
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("fuse_dropout_add_pass");
+  graph = pass->Apply(std::move(graph));
+
+  std::map<std::string, int> num_ops;
+  std::unordered_set<std::string> var_names;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar()) {
+      var_names.insert(node->Name());
+      continue;
+    }
+    auto* op = node->Op();
+    ++num_ops[op->Type()];
+    if (op->Type() == "fused_dropout_add") {
+      EXPECT_EQ(op->Input("X"), std::vector<std::string>({"x"}));
+      EXPECT_EQ(op->Input("Y"), std::vector<std::string>({"y"}));
+      EXPECT_EQ(op->Output("Out"), std::vector<std::string>({"b"}));
+      EXPECT_EQ(op->Output("Mask"), std::vector<std::string>({"a_mask"}));
+      EXPECT_EQ(boost::get<float>(op->GetAttr("dropout_prob")), 0.1f);
+      EXPECT_EQ(node->inputs.size(), 2UL);
+      EXPECT_EQ(node->outputs.size(), 2UL);
+    } else if (op->Type() == "fused_dropout_add_grad") {
+      EXPECT_EQ(op->Input("Mask"), std::vector<std::string>({"a_mask"}));
+      EXPECT_EQ(op->Input("Out@GRAD"), std::vector<std::string>({"b@GRAD"}));
+      EXPECT_EQ(op->Output("X@GRAD"), std::vector<std::string>({"x@GRAD"}));
+      EXPECT_EQ(op->Output("Y@GRAD"), std::vector<std::string>({"y@GRAD"}));
+    }
+  }
+  EXPECT_EQ(num_ops["fused_dropout_add"], 1);
+  EXPECT_EQ(num_ops["fused_dropout_add_grad"], 1);
+  EXPECT_EQ(num_ops["dropout"], 1);
+  EXPECT_EQ(num_ops["elementwise_add"], 1);
+  EXPECT_EQ(num_ops["dropout_grad"], 1);
+  EXPECT_EQ(num_ops["elementwise_add_grad"], 0);
+  // the output of the dropout and its grad are not kept
+  EXPECT_EQ(var_names.count("a"), 0UL);
+  EXPECT_EQ(var_names.count("a@GRAD"), 0UL);
+  EXPECT_EQ(var_names.count("c"), 1UL);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(fuse_dropout_add_pass);
@@ -0,0 +1,233 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fuse_optimizer_ops_pass.h"
+#include <algorithm>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+struct FusedOptimizerInfo {
+  std::string fused_type;
+  // The inputs of the same shapes as Param, whose outputs are X + "Out".
+  std::vector<std::string> states;
+  // The scalar inputs of each parameter.
+  std::vector<std::string> scalars;
+  // The attributes which should be the same in a fused op.
+  std::vector<std::string> attrs;
+};
+
+static const FusedOptimizerInfo* GetFusedOptimizerInfo(
+    const std::string& type) {
+  static const std::unordered_map<std::string, FusedOptimizerInfo> infos = {
+      {"sgd", {"fused_sgd", {}, {}, {}}},
+      {"momentum",
+       {"fused_momentum", {"Velocity"}, {}, {"mu", "use_nesterov"}}},
+      {"lars_momentum",
+       {"fused_momentum",
+        {"Velocity"},
+        {},
+        {"mu", "lars_coeff", "lars_weight_decay"}}},
+      {"adam",
+       {"fused_adam",
+        {"Moment1", "Moment2"},
+        {"Beta1Pow", "Beta2Pow"},
+        {"beta1", "beta2", "epsilon"}}},
+  };
+  auto it = infos.find(type);
+  return it == infos.end() ? nullptr : &it->second;
+}
+
+static Node* GetInputVar(Node* op, const std::string& arg) {
+  auto& names = op->Op()->Input(arg);
+  if (names.size() != 1) return nullptr;
+  for (auto* var : op->inputs) {
+    if (var->IsVar() && var->Var() && var->Name() == names[0]) return var;
+  }
+  return nullptr;
+}
+
+// Whether the op could be fused, that is an optimize op with single dense
+// arguments.
+static bool IsFusibleOptimizer(Node* node) {
+  if (!node->IsOp() || !node->Op()) return false;
+  auto* info = GetFusedOptimizerInfo(node->Op()->Type());
+  if (info == nullptr) return false;
+  auto* op = node->Op();
+  if (!op->HasAttr(OpProtoAndCheckerMaker::OpRoleAttrName()) ||
+      boost::get<int>(op->GetAttr(OpProtoAndCheckerMaker::OpRoleAttrName())) !=
+          static_cast<int>(OpRole::kOptimize)) {
+    return false;
+  }
+  auto* param = GetInputVar(node, "Param");
+  auto* grad = GetInputVar(node, "Grad");
+  if (!param || !grad || !GetInputVar(node, "LearningRate") ||
+      grad->Var()->GetType() != proto::VarType::LOD_TENSOR) {
+    return false;
+  }
+  std::vector<std::string> args(info->states);
+  args.insert(args.end(), info->scalars.begin(), info->scalars.end());
+  for (auto& arg : args) {
+    if (!GetInputVar(node, arg)) return false;
+  }
+  return true;
+}
+
+static bool CanFuseWith(Node* op, Node* other) {
+  if (op->Op()->Type() != other->Op()->Type() ||
+      GetInputVar(op, "Param")->Var()->GetDataType() !=
+          GetInputVar(other, "Param")->Var()->GetDataType()) {
+    return false;
+  }
+  for (auto& attr : GetFusedOptimizerInfo(op->Op()->Type())->attrs) {
+    if (op->Op()->GetAttr(attr) != other->Op()->GetAttr(attr)) return false;
+  }
+  return true;
+}
+
+// Leave out the ops running after the others of the group, so the rest do not
+// depend on each other.
+static std::vector<Node*> IndependentOps(const std::vector<Node*>& group) {
+  std::unordered_set<Node*> visited;
+  std::queue<Node*> queue;
+  for (auto* op : group) {
+    for (auto* out : op->outputs) {
+      if (visited.insert(out).second) queue.push(out);
+    }
+  }
+  while (!queue.empty()) {
+    Node* node = queue.front();
+    queue.pop();
+    for (auto* out : node->outputs) {
+      if (visited.insert(out).second) queue.push(out);
+    }
+  }
+  std::vector<Node*> ops;
+  for (auto* op : group) {
+    if (!visited.count(op)) ops.push_back(op);
+  }
+  return ops;
+}
+
+static OpDesc BuildFusedOpDesc(const std::vector<Node*>& ops) {
+  auto* first = ops.front()->Op();
+  auto* info = GetFusedOptimizerInfo(first->Type());
+  std::vector<std::string> inputs({"Param", "Grad", "LearningRate"});
+  inputs.insert(inputs.end(), info->states.begin(), info->states.end());
+  inputs.insert(inputs.end(), info->scalars.begin(), info->scalars.end());
+  std::vector<std::string> outputs({"ParamOut"});
+  for (auto& state : info->states) {
+    outputs.push_back(state + "Out");
+  }
+
+  OpDesc desc;
+  desc.SetType(info->fused_type);
+  std::vector<std::string> op_role_var;
+  for (auto& arg : inputs) {
+    std::vector<std::string> names;
+    for (auto* op : ops) {
+      names.push_back(op->Op()->Input(arg)[0]);
+    }
+    desc.SetInput(arg, names);
+  }
+  for (auto& arg : outputs) {
+    std::vector<std::string> names;
+    for (auto* op : ops) {
+      names.push_back(op->Op()->Output(arg)[0]);
+    }
+    desc.SetOutput(arg, names);
+  }
+  // A learning rate shared by all the parameters is read once.
+  auto& lrs = desc.Input("LearningRate");
+  if (std::all_of(lrs.begin(), lrs.end(),
+                  [&](const std::string& lr) { return lr == lrs[0]; })) {
+    desc.SetInput("LearningRate", {lrs[0]});
+  }
+  for (auto* op : ops) {
+    op_role_var.push_back(op->Op()->Input("Param")[0]);
+    op_role_var.push_back(op->Op()->Input("Grad")[0]);
+  }
+  for (auto& attr : info->attrs) {
+    desc.SetAttr(attr, first->GetAttr(attr));
+  }
+  if (first->Type() == "lars_momentum") {
+    desc.SetAttr("use_lars", true);
+    desc.SetAttr("use_nesterov", false);
+  }
+  desc.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+               first->GetAttr(OpProtoAndCheckerMaker::OpRoleAttrName()));
+  desc.SetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName(), op_role_var);
+  return desc;
+}
+
+std::unique_ptr<ir::Graph> FuseOptimizerOpsPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  std::vector<std::vector<Node*>> groups;
+  for (auto* node : TopologySortOperations(*graph)) {
+    if (!IsFusibleOptimizer(node)) continue;
+    auto it = std::find_if(groups.begin(), groups.end(),
+                           [&](const std::vector<Node*>& group) {
+                             return CanFuseWith(group.front(), node);
+                           });
+    if (it == groups.end()) {
+      groups.emplace_back(std::vector<Node*>({node}));
+    } else {
+      it->push_back(node);
+    }
+  }
+
+  std::unordered_set<const Node*> marked_nodes;
+  for (auto& group : groups) {
+    auto ops = IndependentOps(group);
+    if (ops.size() < 2) continue;
+    VLOG(3) << "fuse " << ops.size() << " " << ops.front()->Op()->Type()
+            << " ops";
+    OpDesc desc = BuildFusedOpDesc(ops);
+    auto* fused = graph->CreateOpNode(&desc);
+    std::unordered_set<Node*> inputs;
+    std::unordered_set<Node*> outputs;
+    for (auto* op : ops) {
+      inputs.insert(op->inputs.begin(), op->inputs.end());
+      outputs.insert(op->outputs.begin(), op->outputs.end());
+      marked_nodes.insert(op);
+    }
+    for (auto* input : inputs) {
+      input->outputs.push_back(fused);
+      fused->inputs.push_back(input);
+    }
+    for (auto* output : outputs) {
+      output->inputs.push_back(fused);
+      fused->outputs.push_back(output);
+    }
+  }
+  GraphSafeRemoveNodes(graph.get(), marked_nodes);
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fuse_optimizer_ops_pass,
+              paddle::framework::ir::FuseOptimizerOpsPass);
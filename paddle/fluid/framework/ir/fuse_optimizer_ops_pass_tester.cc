@@ -0,0 +1,110 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fuse_optimizer_ops_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOptimizeOp(ProgramDesc* prog, const std::string& type,
+                   const std::string& param, const std::string& grad) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  op->SetInput("Param", {param});
+  op->SetInput("Grad", {grad});
+  op->SetInput("LearningRate", {"lr"});
+  op->SetOutput("ParamOut", {param});
+  if (type == "momentum") {
+    op->SetInput("Velocity", {param + "_velocity"});
+    op->SetOutput("VelocityOut", {param + "_velocity"});
+    op->SetAttr("mu", 0.9f);
+    op->SetAttr("use_nesterov", false);
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kOptimize));
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName(),
+              std::vector<std::string>({param, grad}));
+}
+
+// sgd(p1, g1), sgd(p2, g2), sgd(p3, g3) of a sparse g3,
+// p1->scale->g4, sgd(p4, g4) and momentum(p5, g5)
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>({"lr", "p1", "g1", "p2", "g2", "p3",
+                                           "g3", "p4", "g4", "p5", "g5",
+                                           "p5_velocity"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(v == "g3" ? proto::VarType::SELECTED_ROWS
+                           : proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+  }
+  SetOptimizeOp(&prog, "sgd", "p1", "g1");
+  SetOptimizeOp(&prog, "sgd", "p2", "g2");
+  SetOptimizeOp(&prog, "sgd", "p3", "g3");
+  auto* scale = prog.MutableBlock(0)->AppendOp();
+  scale->SetType("scale");
+  scale->SetInput("X", {"p1"});
+  scale->SetOutput("Out", {"g4"});
+  scale->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+                 static_cast<int>(OpRole::kOptimize));
+  SetOptimizeOp(&prog, "sgd", "p4", "g4");
+  SetOptimizeOp(&prog, "momentum", "p5", "g5");
+  return prog;
+}
+
+TEST(FuseOptimizerOpsPass, basic) {
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("fuse_optimizer_ops_pass");
+  graph = pass->Apply(std::move(graph));
+
+  int num_fused = 0;
+  std::vector<std::string> op_types;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    auto* op = node->Op();
+    op_types.push_back(op->Type());
+    if (op->Type() != "fused_sgd") continue;
+    ++num_fused;
+    EXPECT_EQ(op->Input("Param"), std::vector<std::string>({"p1", "p2"}));
+    EXPECT_EQ(op->Input("Grad"), std::vector<std::string>({"g1", "g2"}));
+    EXPECT_EQ(op->Input("LearningRate"), std::vector<std::string>({"lr"}));
+    EXPECT_EQ(op->Output("ParamOut"), std::vector<std::string>({"p1", "p2"}));
+    EXPECT_EQ(boost::get<std::vector<std::string>>(
+                  op->GetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName())),
+              std::vector<std::string>({"p1", "g1", "p2", "g2"}));
+    // the scale reads the p1 updated by the fused op
+    bool updates_p1 = false;
+    for (auto* out : node->outputs) {
+      for (auto* next : out->outputs) {
+        if (next->IsOp() && next->Op()->Type() == "scale") updates_p1 = true;
+      }
+    }
+    EXPECT_TRUE(updates_p1);
+  }
+  EXPECT_EQ(num_fused, 1);
+  // the sgd of the sparse g3, the scale, the sgd depending on p1 and the only
+  // momentum are kept
+  EXPECT_EQ(op_types.size(), 5UL);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(fuse_optimizer_ops_pass);
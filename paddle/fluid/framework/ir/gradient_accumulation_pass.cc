@@ -0,0 +1,150 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/gradient_accumulation_pass.h"
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static const char kNumAccumulationSteps[] = "num_accumulation_steps";
+
+static void LinkNodes(Node* in, Node* op, Node* out) {
+  op->inputs.push_back(in);
+  in->outputs.push_back(op);
+  op->outputs.push_back(out);
+  out->inputs.push_back(op);
+}
+
+static Node* CreateScaleOp(Graph* graph, BlockDesc* block,
+                           const std::string& x, const std::string& out,
+                           float scale) {
+  OpDesc op(block);
+  op.SetType("scale");
+  op.SetInput("X", {x});
+  op.SetOutput("Out", {out});
+  op.SetAttr("scale", scale);
+  // Run on all the devices like the backward ops, but only in the steps
+  // running the optimize ops.
+  op.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+             static_cast<int>(OpRole::kBackward) |
+                 static_cast<int>(OpRole::kOptimize));
+  return graph->CreateOpNode(&op);
+}
+
+std::unique_ptr<ir::Graph> GradientAccumulationPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  const int num_steps = Get<const int>(kNumAccumulationSteps);
+  PADDLE_ENFORCE_GT(num_steps, 1,
+                    "The gradients should be accumulated over more than one "
+                    "step.");
+  auto* buffers = new std::unordered_set<std::string>;
+  graph->Set(kGradientAccumulationBuffers, buffers);
+  const std::string role_var_name = OpProtoAndCheckerMaker::OpRoleVarAttrName();
+
+  for (Node* node : TopologySortOperations(*graph)) {
+    auto* op = node->Op();
+    int op_role = boost::get<int>(
+        op->GetAttr(OpProtoAndCheckerMaker::OpRoleAttrName()));
+    if (!(op_role & static_cast<int>(OpRole::kBackward)) ||
+        !op->HasAttr(role_var_name)) {
+      continue;
+    }
+    auto role_vars =
+        boost::get<std::vector<std::string>>(op->GetAttr(role_var_name));
+    PADDLE_ENFORCE_EQ(role_vars.size() % 2, 0);
+    std::vector<std::string> kept_role_vars;
+    for (size_t i = 0; i < role_vars.size(); i += 2) {
+      const std::string& p_name = role_vars[i];
+      const std::string& g_name = role_vars[i + 1];
+      Node* grad = nullptr;
+      for (Node* out : node->outputs) {
+        if (out->IsVar() && out->Var() && out->Name() == g_name) grad = out;
+      }
+      if (grad == nullptr) {
+        kept_role_vars.push_back(p_name);
+        kept_role_vars.push_back(g_name);
+        continue;
+      }
+      PADDLE_ENFORCE(grad->Var()->GetType() == proto::VarType::LOD_TENSOR,
+                     "The gradient accumulation only supports the dense "
+                     "gradients, but %s is not.",
+                     g_name);
+      VLOG(10) << "Accumulate " << g_name << " for parameter " << p_name;
+
+      const std::string acc_name = g_name + kGradientAccumulationSuffix;
+      VarDesc acc_desc(acc_name);
+      acc_desc.SetType(proto::VarType::LOD_TENSOR);
+      acc_desc.SetDataType(grad->Var()->GetDataType());
+      acc_desc.SetShape(grad->Var()->GetShape());
+      acc_desc.SetPersistable(true);
+      buffers->insert(acc_name);
+
+      // The consumers of g, i.e. the optimize ops, read the averaged one.
+      std::vector<Node*> consumers = grad->outputs;
+      grad->outputs.clear();
+
+      OpDesc sum_op(op->Block());
+      sum_op.SetType("sum");
+      sum_op.SetInput("X", {acc_name, g_name});
+      sum_op.SetOutput("Out", {acc_name});
+      sum_op.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+                     static_cast<int>(OpRole::kBackward));
+      Node* sum_node = graph->CreateOpNode(&sum_op);
+      Node* acc = graph->CreateVarNode(&acc_desc);
+      LinkNodes(graph->CreateVarNode(&acc_desc), sum_node, acc);
+      sum_node->inputs.push_back(grad);
+      grad->outputs.push_back(sum_node);
+
+      Node* average_node = CreateScaleOp(graph.get(), op->Block(), acc_name,
+                                         g_name, 1.f / num_steps);
+      average_node->Op()->SetAttr(role_var_name,
+                                  std::vector<std::string>({p_name, g_name}));
+      Node* average = graph->CreateVarNode(grad->Var());
+      LinkNodes(acc, average_node, average);
+      for (Node* consumer : consumers) {
+        for (auto& in : consumer->inputs) {
+          if (in == grad) in = average;
+        }
+        average->outputs.push_back(consumer);
+      }
+
+      // The buffer is reset after it is read by the average op.
+      Node* reset_node =
+          CreateScaleOp(graph.get(), op->Block(), acc_name, acc_name, 0.f);
+      LinkNodes(acc, reset_node, graph->CreateVarNode(&acc_desc));
+      Node* dep = graph->CreateControlDepVar();
+      average_node->outputs.push_back(dep);
+      dep->inputs.push_back(average_node);
+      reset_node->inputs.push_back(dep);
+      dep->outputs.push_back(reset_node);
+    }
+    op->SetAttr(role_var_name, kept_role_vars);
+  }
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(gradient_accumulation_pass,
+              paddle::framework::ir::GradientAccumulationPass)
+    .RequirePassAttr(paddle::framework::ir::kNumAccumulationSteps);
@@ -0,0 +1,56 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+// The graph attr holding the names of the accumulation buffers, which are
+// created and zeroed in each local scope by the ParallelExecutor.
+constexpr char kGradientAccumulationBuffers[] = "gradient_accumulation_buffers";
+constexpr char kGradientAccumulationSuffix[] = "@ACCUMULATION";
+
+/*
+ * Accumulate the dense gradients over num_accumulation_steps micro-batches,
+ * without copying the forward and backward ops as BatchMergePass does.
+ *
+ * For each gradient g of the parameter p, the pass adds
+ *   sum(g@ACCUMULATION, g) -> g@ACCUMULATION     in every step,
+ *   scale(g@ACCUMULATION, 1 / n) -> g            for the optimizer, and
+ *   scale(g@ACCUMULATION, 0) -> g@ACCUMULATION   to restart the accumulation,
+ * where g@ACCUMULATION is a persistable buffer. The [p, g] of OpRoleVar is
+ * moved to the second op, so the gradient is all reduced once after the
+ * accumulation. The last two ops have both the kBackward and the kOptimize
+ * roles, so that they run on all the devices, and the ParallelExecutor runs
+ * them, as well as the optimize, lr_sched, RPC and all reduce ops after them,
+ * only in every n-th step.
+ */
+class GradientAccumulationPass : public Pass {
+ public:
+  virtual ~GradientAccumulationPass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,128 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/gradient_accumulation_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+// mul_grad(x, w, out@GRAD) -> w@GRAD, sgd(w, w@GRAD, lr) -> w
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  auto* block = prog.MutableBlock(0);
+  for (auto& v : std::vector<std::string>(
+           {"x", "w", "out@GRAD", "w@GRAD", "x@GRAD", "lr"})) {
+    auto* var = block->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    var->SetShape({4, 8});
+  }
+  block->Var("w")->SetPersistable(true);
+
+  auto* mul_grad = block->AppendOp();
+  mul_grad->SetType("mul_grad");
+  mul_grad->SetInput("X", {"x"});
+  mul_grad->SetInput("Y", {"w"});
+  mul_grad->SetInput("Out@GRAD", {"out@GRAD"});
+  mul_grad->SetOutput("X@GRAD", {"x@GRAD"});
+  mul_grad->SetOutput("Y@GRAD", {"w@GRAD"});
+  mul_grad->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+                    static_cast<int>(OpRole::kBackward));
+  mul_grad->SetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName(),
+                    std::vector<std::string>({"w", "w@GRAD"}));
+
+  auto* sgd = block->AppendOp();
+  sgd->SetType("sgd");
+  sgd->SetInput("Param", {"w"});
+  sgd->SetInput("Grad", {"w@GRAD"});
+  sgd->SetInput("LearningRate", {"lr"});
+  sgd->SetOutput("ParamOut", {"w"});
+  sgd->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+               static_cast<int>(OpRole::kOptimize));
+  sgd->SetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName(),
+               std::vector<std::string>({"w", "w@GRAD"}));
+  return prog;
+}
+
+TEST(GradientAccumulationPass, basic) {
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("gradient_accumulation_pass");
+  pass->Set<const int>("num_accumulation_steps", new int(4));
+  graph = pass->Apply(std::move(graph));
+
+  const std::string acc_name =
+      std::string("w@GRAD") + kGradientAccumulationSuffix;
+  auto& buffers = graph->Get<std::unordered_set<std::string>>(
+      kGradientAccumulationBuffers);
+  EXPECT_EQ(buffers, std::unordered_set<std::string>({acc_name}));
+
+  const int update_role = static_cast<int>(OpRole::kBackward) |
+                          static_cast<int>(OpRole::kOptimize);
+  int num_sum = 0;
+  int num_scale = 0;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    auto* op = node->Op();
+    int op_role =
+        boost::get<int>(op->GetAttr(OpProtoAndCheckerMaker::OpRoleAttrName()));
+    std::vector<std::string> role_vars;
+    if (op->HasAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName())) {
+      role_vars = boost::get<std::vector<std::string>>(
+          op->GetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName()));
+    }
+    if (op->Type() == "mul_grad") {
+      // the gradient is all reduced after the accumulation
+      EXPECT_TRUE(role_vars.empty());
+    } else if (op->Type() == "sum") {
+      ++num_sum;
+      EXPECT_EQ(op->Input("X"), std::vector<std::string>({acc_name, "w@GRAD"}));
+      EXPECT_EQ(op->Output("Out"), std::vector<std::string>({acc_name}));
+      EXPECT_EQ(op_role, static_cast<int>(OpRole::kBackward));
+    } else if (op->Type() == "scale") {
+      ++num_scale;
+      EXPECT_EQ(op_role, update_role);
+      EXPECT_EQ(op->Input("X"), std::vector<std::string>({acc_name}));
+      float scale = boost::get<float>(op->GetAttr("scale"));
+      if (op->Output("Out")[0] == "w@GRAD") {
+        EXPECT_FLOAT_EQ(scale, 0.25f);
+        EXPECT_EQ(role_vars, std::vector<std::string>({"w", "w@GRAD"}));
+        // the sgd reads the averaged gradient
+        ASSERT_EQ(node->outputs.size(), 2UL);
+        bool feeds_sgd = false;
+        for (auto* out : node->outputs) {
+          for (auto* next : out->outputs) {
+            if (next->IsOp() && next->Op()->Type() == "sgd") feeds_sgd = true;
+          }
+        }
+        EXPECT_TRUE(feeds_sgd);
+      } else {
+        EXPECT_EQ(op->Output("Out"), std::vector<std::string>({acc_name}));
+        EXPECT_FLOAT_EQ(scale, 0.f);
+      }
+    }
+  }
+  EXPECT_EQ(num_sum, 1);
+  EXPECT_EQ(num_scale, 2);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(gradient_accumulation_pass);
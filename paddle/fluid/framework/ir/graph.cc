@@ -106,8 +106,9 @@ std::map<std::string, std::vector<ir::Node *>> Graph::InitFromProgram(
     // Otherwise, create a new one.
     for (auto &each_var_name : op->InputArgumentNames()) {
       ir::Node *var = nullptr;
-      if (var_nodes.find(each_var_name) != var_nodes.end()) {
-        var = var_nodes.at(each_var_name).back();
+      auto it = var_nodes.find(each_var_name);
+      if (it != var_nodes.end()) {
+        var = it->second.back();
       } else if (all_vars.count(each_var_name) != 0) {
         var = CreateVarNode(all_vars.at(each_var_name));
         var_nodes[each_var_name].push_back(var);
@@ -166,6 +167,8 @@ void Graph::ResolveHazard(
       const auto &read_ops = (*it_old)->outputs;
 
       PADDLE_ENFORCE(write_op, "The write_op should not be empty.");
+      std::unordered_set<ir::Node *> write_op_inputs(write_op->inputs.begin(),
+                                                     write_op->inputs.end());
 
       // Add write after write dependence
       ir::Node *upstream_op =
@@ -174,6 +177,7 @@ void Graph::ResolveHazard(
       if (upstream_op && upstream_op != write_op) {
         ir::Node *dep_var = CreateControlDepVar();
         write_op->inputs.push_back(dep_var);
+        write_op_inputs.insert(dep_var);
         upstream_op->outputs.push_back(dep_var);
         dep_var->outputs.push_back(write_op);
         dep_var->inputs.push_back(upstream_op);
@@ -188,11 +192,9 @@ void Graph::ResolveHazard(
         // 2 ops might have been connected via other vars.
         bool has_dep = false;
         for (ir::Node *r_out : read_op->outputs) {
-          for (ir::Node *w_in : write_op->inputs) {
-            if (r_out == w_in) {
-              has_dep = true;
-              break;
-            }
+          if (write_op_inputs.count(r_out)) {
+            has_dep = true;
+            break;
           }
         }
         if (has_dep) continue;
@@ -201,6 +203,7 @@ void Graph::ResolveHazard(
         read_op->outputs.push_back(dep_var);
         dep_var->inputs.push_back(read_op);
         write_op->inputs.push_back(dep_var);
+        write_op_inputs.insert(dep_var);
         dep_var->outputs.push_back(write_op);
       }
     }
@@ -17,6 +17,8 @@ limitations under the License. */
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "paddle/fluid/framework/ir/node.h"
@@ -104,6 +106,23 @@ class Graph {
 
   const std::unordered_set<ir::Node *> &Nodes() const { return node_set_; }
 
+  // The operator nodes of an op type, the index is kept as the nodes are
+  // added and removed so that the passes needn't scan the whole graph.
+  const std::unordered_set<ir::Node *> &OpNodes(
+      const std::string &op_type) const {
+    static const std::unordered_set<ir::Node *> kEmpty;
+    auto it = op_nodes_.find(op_type);
+    return it == op_nodes_.end() ? kEmpty : it->second;
+  }
+
+  // Change the type of an operator node and re-index it.
+  void SetOpType(ir::Node *node, const std::string &op_type) {
+    PADDLE_ENFORCE(node->IsOp() && node->Op());
+    UnindexOpNode(node);
+    node->Op()->SetType(op_type);
+    op_nodes_[op_type].insert(node);
+  }
+
   // Create a normal variable with non-null VarDesc.
   ir::Node *CreateVarNode(VarDesc *var_desc) {
     PADDLE_ENFORCE(var_desc);
@@ -141,23 +160,25 @@ class Graph {
     }
     nodes_.clear();
     node_set_.clear();
+    op_nodes_.clear();
+    id_nodes_.clear();
     return ret;
   }
 
   void RemoveNode(ir::Node *node) {
     PADDLE_ENFORCE(node_set_.find(node) != node_set_.end());
+    if (node->IsOp()) UnindexOpNode(node);
+    auto id_it = id_nodes_.find(node->id());
+    if (id_it != id_nodes_.end() && id_it->second == node) {
+      id_nodes_.erase(id_it);
+    }
     node_set_.erase(node);
     nodes_.erase(node);
   }
 
-  // NOTE low performance, but simple and secure.
   Node *RetriveNode(int id) {
-    for (auto &node : nodes_) {
-      if (node.second->id() == id) {
-        return node.second.get();
-      }
-    }
-    return nullptr;
+    auto it = id_nodes_.find(id);
+    return it == id_nodes_.end() ? nullptr : it->second;
   }
 
   std::map<std::string, std::vector<ir::Node *>> InitFromProgram(
@@ -172,15 +193,31 @@ class Graph {
     PADDLE_ENFORCE(node_set_.find(node) == node_set_.end());
     nodes_[node].reset(node);
     node_set_.insert(node);
+    if (node->IsOp()) op_nodes_[OpType(node)].insert(node);
+    id_nodes_[node->id()] = node;
     return node;
   }
 
+  // The op type a node is indexed by.
+  static std::string OpType(ir::Node *node) {
+    return node->Op() ? node->Op()->Type() : node->Name();
+  }
+
+  void UnindexOpNode(ir::Node *node) {
+    auto it = op_nodes_.find(OpType(node));
+    if (it == op_nodes_.end()) return;
+    it->second.erase(node);
+    if (it->second.empty()) op_nodes_.erase(it);
+  }
+
   // NOTE: program_ shouldn't be exposed to user.
   const ProgramDesc program_;
   std::map<std::string, boost::any> attrs_;
   std::map<std::string, std::function<void(void)>> attr_dels_;
   std::map<ir::Node *, std::unique_ptr<ir::Node>> nodes_;
   std::unordered_set<ir::Node *> node_set_;
+  std::unordered_map<std::string, std::unordered_set<ir::Node *>> op_nodes_;
+  std::unordered_map<int, ir::Node *> id_nodes_;
 };
 
 bool IsControlDepVar(const ir::Node &var);
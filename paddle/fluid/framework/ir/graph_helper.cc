@@ -188,6 +188,14 @@ size_t GraphNum(const Graph &graph) {
   return graph_count;
 }
 
+void Unlink(ir::Node *from, ir::Node *to) {
+  from->outputs.erase(
+      std::remove(from->outputs.begin(), from->outputs.end(), to),
+      from->outputs.end());
+  to->inputs.erase(std::remove(to->inputs.begin(), to->inputs.end(), from),
+                   to->inputs.end());
+}
+
 }  // namespace ir
 }  // namespace framework
 }  // namespace paddle
@@ -37,6 +37,9 @@ std::vector<ir::Node *> TopologySortOperations(const Graph &graph);
 std::map<ir::Node *, std::unordered_set<ir::Node *>> BuildOperationAdjList(
     const Graph &graph);
 
+// Remove the link from `from` to `to`, the reverse of IR_NODE_LINK_TO.
+void Unlink(ir::Node *from, ir::Node *to);
+
 }  // namespace ir
 }  // namespace framework
 }  // namespace paddle
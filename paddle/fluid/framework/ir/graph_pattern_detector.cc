@@ -100,11 +100,28 @@ bool GraphPatternDetector::MarkPDNodesInGraph(const ir::Graph &graph) {
   VLOG(3) << "mark pdnodes in graph";
   if (graph.Nodes().empty()) return false;
 
-  for (auto &node : GraphTraits::DFS(graph)) {
-    for (const auto &pdnode : pattern_.nodes()) {
-      if (pdnode->Tell(&node)) {
+  // The PDNodes of an op type are only checked against the indexed operators
+  // of the type, and the others against all the nodes.
+  std::vector<PDNode *> untyped_pdnodes;
+  for (const auto &pdnode : pattern_.nodes()) {
+    if (pdnode->op_type().empty()) {
+      untyped_pdnodes.push_back(pdnode.get());
+      continue;
+    }
+    for (auto *node : graph.OpNodes(pdnode->op_type())) {
+      if (pdnode->Tell(node)) {
         VLOG(4) << "pdnode " << pdnode->name() << " marked";
-        pdnodes2nodes_[pdnode.get()].insert(&node);
+        pdnodes2nodes_[pdnode.get()].insert(node);
+      }
+    }
+  }
+  if (!untyped_pdnodes.empty()) {
+    for (auto &node : GraphTraits::DFS(graph)) {
+      for (auto *pdnode : untyped_pdnodes) {
+        if (pdnode->Tell(&node)) {
+          VLOG(4) << "pdnode " << pdnode->name() << " marked";
+          pdnodes2nodes_[pdnode].insert(&node);
+        }
       }
     }
   }
@@ -181,16 +198,6 @@ struct HitGroup {
   std::unordered_set<Node *> nodes_;
 };
 
-// Tell whether Node a links to b.
-bool IsNodesLink(Node *a, Node *b) {
-  for (auto *node : a->outputs) {
-    if (b == node) {
-      return true;
-    }
-  }
-  return false;
-}
-
 std::vector<GraphPatternDetector::subgraph_t>
 GraphPatternDetector::DetectPatterns() {
   // Init empty subgraphs.
@@ -222,19 +229,48 @@ GraphPatternDetector::DetectPatterns() {
     cur_groups.clear();
     if (pre_groups.empty()) break;
     // source -> target
-    for (Node *source : pdnodes2nodes_[edge.first]) {
-      for (Node *target : pdnodes2nodes_[edge.second]) {
+    const auto &sources = pdnodes2nodes_[edge.first];
+    const auto &targets = pdnodes2nodes_[edge.second];
+    for (const auto &group : pre_groups) {
+      auto extend = [&](Node *source, Node *target) {
         VLOG(8) << "check " << source->id() << " -- " << target->id();
-        // TODO(Superjomn) add some prune strategies.
-        for (const auto &group : pre_groups) {
-          HitGroup new_group = group;
-          if (IsNodesLink(source, target) &&
-              new_group.Match(source, edge.first)) {
-            new_group.Register(source, edge.first);
-            if (new_group.Match(target, edge.second)) {
-              new_group.Register(target, edge.second);
-              cur_groups.push_back(new_group);
-              // TODO(Superjomn) need to unique
+        HitGroup new_group = group;
+        if (new_group.Match(source, edge.first)) {
+          new_group.Register(source, edge.first);
+          if (new_group.Match(target, edge.second)) {
+            new_group.Register(target, edge.second);
+            cur_groups.push_back(new_group);
+            // TODO(Superjomn) need to unique
+          }
+        }
+      };
+      // A node linked to the group is looked up from the neighbours of the
+      // node already in it, instead of from all the marked nodes.
+      auto source_it = group.roles.find(edge.first);
+      auto target_it = group.roles.find(edge.second);
+      std::unordered_set<Node *> visited;
+      if (source_it != group.roles.end()) {
+        Node *source = source_it->second;
+        if (!sources.count(source)) continue;
+        for (auto *target : source->outputs) {
+          if (targets.count(target) && visited.insert(target).second) {
+            extend(source, target);
+          }
+        }
+      } else if (target_it != group.roles.end()) {
+        Node *target = target_it->second;
+        if (!targets.count(target)) continue;
+        for (auto *source : target->inputs) {
+          if (sources.count(source) && visited.insert(source).second) {
+            extend(source, target);
+          }
+        }
+      } else {
+        for (auto *source : sources) {
+          visited.clear();
+          for (auto *target : source->outputs) {
+            if (targets.count(target) && visited.insert(target).second) {
+              extend(source, target);
             }
           }
         }
@@ -363,6 +399,7 @@ PDNode *PDNode::assert_is_op() {
 }
 
 PDNode *PDNode::assert_is_op(const std::string &op_type) {
+  if (!teller_ && op_type_.empty()) op_type_ = op_type;
   asserts_.emplace_back([op_type](Node *x) {
     return x && x->IsOp() && x->Op()->Type() == op_type;
   });
@@ -1097,6 +1134,187 @@ PDNode *patterns::ElementwiseAdd::operator()(PDNode *x_var) {
 
   return out_var;
 }
+
+PDNode *patterns::MultiHeadAttention::operator()(bool with_scale,
+                                                 bool with_bias,
+                                                 bool with_dropout) {
+  // The intermediate variables should not be used by the other ops.
+  auto only_one_output = [](Node *x) { return x->outputs.size() == 1UL; };
+
+  auto *q = pattern->NewNode(q_repr())
+                ->AsInput()
+                ->assert_is_op_input("matmul", "X");
+  auto *k = pattern->NewNode(k_repr())
+                ->AsInput()
+                ->assert_is_op_input("matmul", "Y");
+  auto *matmul_qk = pattern->NewNode(matmul_qk_repr())
+                        ->assert_is_op("matmul")
+                        ->assert_op_attr<bool>("transpose_X", false)
+                        ->assert_op_attr<bool>("transpose_Y", true);
+  auto *qk_out = pattern->NewNode(qk_out_repr())
+                     ->AsIntermediate()
+                     ->assert_is_only_output_of_op("matmul")
+                     ->assert_more(only_one_output);
+  matmul_qk->LinksFrom({q, k}).LinksTo({qk_out});
+  PDNode *x = qk_out;
+
+  if (with_scale) {
+    x->assert_is_op_input("scale", "X");
+    auto *scale = pattern->NewNode(scale_repr())
+                      ->assert_is_op("scale")
+                      ->assert_op_attr<float>("bias", 0.f);
+    auto *scale_out = pattern->NewNode(scale_out_repr())
+                          ->AsIntermediate()
+                          ->assert_is_only_output_of_op("scale")
+                          ->assert_more(only_one_output);
+    scale->LinksFrom({x}).LinksTo({scale_out});
+    x = scale_out;
+  }
+
+  if (with_bias) {
+    x->assert_is_op_input("elementwise_add", "X");
+    auto *eltadd = pattern->NewNode(eltadd_repr())
+                       ->assert_is_op("elementwise_add")
+                       ->assert_op_attr<int>("axis", -1);
+    auto *eltadd_bias = pattern->NewNode(eltadd_bias_repr())
+                            ->AsInput()
+                            ->assert_is_op_input("elementwise_add", "Y");
+    auto *eltadd_out = pattern->NewNode(eltadd_out_repr())
+                           ->AsIntermediate()
+                           ->assert_is_only_output_of_op("elementwise_add")
+                           ->assert_more(only_one_output);
+    eltadd->LinksFrom({x, eltadd_bias}).LinksTo({eltadd_out});
+    x = eltadd_out;
+  }
+
+  x->assert_is_op_input("softmax", "X");
+  auto *softmax = pattern->NewNode(softmax_repr())->assert_is_op("softmax");
+  auto *softmax_out = pattern->NewNode(softmax_out_repr())
+                          ->AsIntermediate()
+                          ->assert_is_only_output_of_op("softmax")
+                          ->assert_more(only_one_output);
+  softmax->LinksFrom({x}).LinksTo({softmax_out});
+  x = softmax_out;
+
+  if (with_dropout) {
+    x->assert_is_op_input("dropout", "X");
+    auto *dropout = pattern->NewNode(dropout_repr())
+                        ->assert_is_op("dropout")
+                        ->assert_op_attr<bool>("is_test", true);
+    auto *dropout_out = pattern->NewNode(dropout_out_repr())
+                            ->AsIntermediate()
+                            ->assert_is_op_output("dropout", "Out")
+                            ->assert_more(only_one_output);
+    auto *dropout_mask = pattern->NewNode(dropout_mask_repr())
+                             ->AsIntermediate()
+                             ->assert_is_op_output("dropout", "Mask")
+                             ->assert_more([](Node *x) {
+                               return x->outputs.empty();
+                             });
+    dropout->LinksFrom({x}).LinksTo({dropout_out, dropout_mask});
+    x = dropout_out;
+  }
+
+  x->assert_is_op_input("matmul", "X");
+  auto *v = pattern->NewNode(v_repr())
+                ->AsInput()
+                ->assert_is_op_input("matmul", "Y");
+  auto *matmul_qkv = pattern->NewNode(matmul_qkv_repr())
+                         ->assert_is_op("matmul")
+                         ->assert_op_attr<bool>("transpose_X", false)
+                         ->assert_op_attr<bool>("transpose_Y", false);
+  auto *out = pattern->NewNode(out_repr())
+                  ->AsOutput()
+                  ->assert_is_op_output("matmul", "Out");
+  matmul_qkv->LinksFrom({x, v}).LinksTo({out});
+  return out;
+}
+
+PDNode *patterns::DepthwisePointwiseConv::operator()() {
+  // The intermediate variables should not be used by the other ops.
+  auto only_one_output = [](Node *x) { return x->outputs.size() == 1UL; };
+  // The depthwise convolution can be a grouped conv2d.
+  std::unordered_set<std::string> dw_types({"conv2d", "depthwise_conv2d"});
+
+  auto *dw_input = pattern->NewNode(dw_input_repr())
+                       ->AsInput()
+                       ->assert_is_ops_input(dw_types, "Input");
+  auto *dw_filter = pattern->NewNode(dw_filter_repr())
+                        ->AsInput()
+                        ->assert_is_persistable_var()
+                        ->assert_is_ops_input(dw_types, "Filter")
+                        ->assert_more(only_one_output);
+  auto *dw_conv = pattern->NewNode(dw_conv_repr())->assert_is_ops(dw_types);
+  auto *dw_out = pattern->NewNode(dw_out_repr())
+                     ->AsIntermediate()
+                     ->assert_is_ops_output(dw_types, "Output")
+                     ->assert_is_op_input("batch_norm", "X")
+                     ->assert_more(only_one_output);
+  dw_conv->LinksFrom({dw_input, dw_filter}).LinksTo({dw_out});
+
+  auto *batch_norm = pattern->NewNode(batch_norm_repr())
+                         ->assert_is_op("batch_norm")
+                         ->assert_op_attr<bool>("is_test", true);
+  auto *bn_scale = pattern->NewNode(bn_scale_repr())
+                       ->AsInput()
+                       ->assert_is_persistable_var()
+                       ->assert_is_op_input("batch_norm", "Scale");
+  auto *bn_bias = pattern->NewNode(bn_bias_repr())
+                      ->AsInput()
+                      ->assert_is_persistable_var()
+                      ->assert_is_op_input("batch_norm", "Bias");
+  auto *bn_mean = pattern->NewNode(bn_mean_repr())
+                      ->AsInput()
+                      ->assert_is_persistable_var()
+                      ->assert_is_op_input("batch_norm", "Mean");
+  auto *bn_variance = pattern->NewNode(bn_variance_repr())
+                          ->AsInput()
+                          ->assert_is_persistable_var()
+                          ->assert_is_op_input("batch_norm", "Variance");
+  auto *bn_out = pattern->NewNode(bn_out_repr())
+                     ->AsIntermediate()
+                     ->assert_is_op_output("batch_norm", "Y")
+                     ->assert_is_op_input("relu", "X")
+                     ->assert_more(only_one_output);
+  auto *bn_mean_out = pattern->NewNode(bn_mean_out_repr())
+                          ->AsIntermediate()
+                          ->assert_is_op_output("batch_norm", "MeanOut");
+  auto *bn_variance_out =
+      pattern->NewNode(bn_variance_out_repr())
+          ->AsIntermediate()
+          ->assert_is_op_output("batch_norm", "VarianceOut");
+  auto *bn_saved_mean = pattern->NewNode(bn_saved_mean_repr())
+                            ->AsIntermediate()
+                            ->assert_is_op_output("batch_norm", "SavedMean");
+  auto *bn_saved_variance =
+      pattern->NewNode(bn_saved_variance_repr())
+          ->AsIntermediate()
+          ->assert_is_op_output("batch_norm", "SavedVariance");
+  batch_norm->LinksFrom({dw_out, bn_scale, bn_bias, bn_mean, bn_variance})
+      .LinksTo({bn_out, bn_mean_out, bn_variance_out, bn_saved_mean,
+                bn_saved_variance});
+
+  auto *relu = pattern->NewNode(relu_repr())->assert_is_op("relu");
+  auto *relu_out = pattern->NewNode(relu_out_repr())
+                       ->AsIntermediate()
+                       ->assert_is_op_output("relu", "Out")
+                       ->assert_is_op_input("conv2d", "Input")
+                       ->assert_more(only_one_output);
+  relu->LinksFrom({bn_out}).LinksTo({relu_out});
+
+  auto *pw_filter = pattern->NewNode(pw_filter_repr())
+                        ->AsInput()
+                        ->assert_is_persistable_var()
+                        ->assert_is_op_input("conv2d", "Filter");
+  auto *pw_conv = pattern->NewNode(pw_conv_repr())
+                      ->assert_is_op("conv2d")
+                      ->assert_op_attr<int>("groups", 1);
+  auto *pw_out = pattern->NewNode(pw_out_repr())
+                     ->AsOutput()
+                     ->assert_is_op_output("conv2d", "Output");
+  pw_conv->LinksFrom({relu_out, pw_filter}).LinksTo({pw_out});
+  return pw_out;
+}
 }  // namespace ir
 }  // namespace framework
 }  // namespace paddle
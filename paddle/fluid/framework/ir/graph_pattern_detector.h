@@ -66,6 +66,8 @@ struct PDNode {
   bool IsVar() const { return type_ == Type::kVar; }
 
   const std::string& name() const { return name_; }
+  // The op type set by assert_is_op, empty if the node matches other nodes.
+  const std::string& op_type() const { return op_type_; }
 
   PDNode& operator=(const PDNode&) = delete;
   PDNode(const PDNode&) = delete;
@@ -159,6 +161,7 @@ struct PDNode {
   std::vector<teller_t> asserts_;
   PDPattern* pattern_;
   std::string name_;
+  std::string op_type_;
   Type type_;
   Role role_{Role::kUnknown};
 };
@@ -228,9 +231,11 @@ class PDPattern {
  * This helper can be used to support fuse(conv+batchnorm => batchnorm e.g.).
  *
  * The algorithm has three phases:
- *   1. Mark the nodes that match the defined PDNodes in a PDPattern,
+ *   1. Mark the nodes that match the defined PDNodes in a PDPattern, a PDNode
+ *      of an op type is only checked against the operators of the type,
  *   2. Extend a PDNode to subgraphs by deducing the connection relation defined
- *      in PAPattern(the edges),
+ *      in PAPattern(the edges), starting from the matches of the first PDNode
+ *      and only looking at the neighbours of the nodes matched so far,
  *   3. Get the filtered subgraphs and treat them with a pre-defined handler.
  *
  * Usage:
@@ -671,6 +676,76 @@ struct ElementwiseAdd : public PatternBase {
   PATTERN_DECL_NODE(elementwise_add_y);
   PATTERN_DECL_NODE(elementwise_add_out);
 };
+
+// The scaled dot-product attention
+// op: matmul(transpose_Y) + (scale +) (elementwise_add +) softmax
+//     (+ dropout) + matmul
+// named nodes:
+// q, k, v, matmul_qk, qk_out, scale, scale_out, eltadd, eltadd_bias,
+// eltadd_out, softmax, softmax_out, dropout, dropout_out, dropout_mask,
+// matmul_qkv, out
+struct MultiHeadAttention : public PatternBase {
+  MultiHeadAttention(PDPattern* pattern, const std::string& name_scope)
+      : PatternBase(pattern, name_scope, "multihead_attention") {}
+
+  PDNode* operator()(bool with_scale, bool with_bias, bool with_dropout);
+
+  // declare operator node's name
+  PATTERN_DECL_NODE(matmul_qk);
+  PATTERN_DECL_NODE(scale);
+  PATTERN_DECL_NODE(eltadd);
+  PATTERN_DECL_NODE(softmax);
+  PATTERN_DECL_NODE(dropout);
+  PATTERN_DECL_NODE(matmul_qkv);
+  // declare variable node's name
+  PATTERN_DECL_NODE(q);
+  PATTERN_DECL_NODE(k);
+  PATTERN_DECL_NODE(v);
+  PATTERN_DECL_NODE(qk_out);
+  PATTERN_DECL_NODE(scale_out);
+  PATTERN_DECL_NODE(eltadd_bias);
+  PATTERN_DECL_NODE(eltadd_out);
+  PATTERN_DECL_NODE(softmax_out);
+  PATTERN_DECL_NODE(dropout_out);
+  PATTERN_DECL_NODE(dropout_mask);
+  PATTERN_DECL_NODE(out);
+};
+
+// The depthwise separable convolution block of MobileNet
+// op: depthwise conv + batch_norm + relu + conv
+// named nodes:
+// dw_input, dw_conv, dw_filter, dw_out,
+// batch_norm, bn_scale, bn_bias, bn_mean, bn_variance, bn_out,
+// bn_mean_out, bn_variance_out, bn_saved_mean, bn_saved_variance,
+// relu, relu_out, pw_conv, pw_filter, pw_out
+struct DepthwisePointwiseConv : public PatternBase {
+  DepthwisePointwiseConv(PDPattern* pattern, const std::string& name_scope)
+      : PatternBase(pattern, name_scope, "depthwise_pointwise_conv") {}
+
+  PDNode* operator()();
+
+  // declare operator node's name
+  PATTERN_DECL_NODE(dw_conv);
+  PATTERN_DECL_NODE(batch_norm);
+  PATTERN_DECL_NODE(relu);
+  PATTERN_DECL_NODE(pw_conv);
+  // declare variable node's name
+  PATTERN_DECL_NODE(dw_input);
+  PATTERN_DECL_NODE(dw_filter);
+  PATTERN_DECL_NODE(dw_out);
+  PATTERN_DECL_NODE(bn_scale);
+  PATTERN_DECL_NODE(bn_bias);
+  PATTERN_DECL_NODE(bn_mean);
+  PATTERN_DECL_NODE(bn_variance);
+  PATTERN_DECL_NODE(bn_out);
+  PATTERN_DECL_NODE(bn_mean_out);
+  PATTERN_DECL_NODE(bn_variance_out);
+  PATTERN_DECL_NODE(bn_saved_mean);
+  PATTERN_DECL_NODE(bn_saved_variance);
+  PATTERN_DECL_NODE(relu_out);
+  PATTERN_DECL_NODE(pw_filter);
+  PATTERN_DECL_NODE(pw_out);
+};
 }  // namespace patterns
 
 // Link two ir::Nodes from each other.
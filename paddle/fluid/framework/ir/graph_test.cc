@@ -206,5 +206,37 @@ TEST(GraphTest, WriteAfterWrite) {
   ASSERT_NE(control_dep2, nullptr);
   ASSERT_EQ(control_dep1, control_dep2);
 }
+
+TEST(GraphTest, OpNodes) {
+  ProgramDesc prog;
+  std::vector<std::string> types = {"sum", "dummy", "sum"};
+  for (size_t i = 0; i < types.size(); ++i) {
+    auto *op = prog.MutableBlock(0)->AppendOp();
+    op->SetType(types[i]);
+    op->SetInput("X", {"a"});
+    op->SetOutput("Out", {"out" + std::to_string(i)});
+    op->SetAttr("op_role", 1);
+  }
+  prog.MutableBlock(0)->Var("a")->SetType(proto::VarType::LOD_TENSOR);
+
+  std::unique_ptr<ir::Graph> g(new ir::Graph(prog));
+  ASSERT_EQ(g->OpNodes("sum").size(), 2UL);
+  ASSERT_EQ(g->OpNodes("dummy").size(), 1UL);
+  ASSERT_TRUE(g->OpNodes("mul").empty());
+  for (ir::Node *n : g->Nodes()) {
+    ASSERT_EQ(g->RetriveNode(n->id()), n);
+  }
+
+  ir::Node *dummy = *g->OpNodes("dummy").begin();
+  g->SetOpType(dummy, "sum");
+  ASSERT_EQ(dummy->Op()->Type(), "sum");
+  ASSERT_EQ(g->OpNodes("sum").size(), 3UL);
+  ASSERT_TRUE(g->OpNodes("dummy").empty());
+
+  int id = dummy->id();
+  g->RemoveNode(dummy);
+  ASSERT_EQ(g->OpNodes("sum").size(), 2UL);
+  ASSERT_EQ(g->RetriveNode(id), nullptr);
+}
 }  // namespace framework
 }  // namespace paddle
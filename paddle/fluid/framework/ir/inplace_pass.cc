@@ -0,0 +1,182 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/inplace_pass.h"
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/op_info.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+bool IsLoDTensor(Node* var) {
+  return var->IsVar() && var->Var() &&
+         var->Var()->GetType() == proto::VarType::LOD_TENSOR;
+}
+
+// Whether two shapes have the same number of elements, the -1 dims are
+// taken as the same unknown size.
+bool SameNumel(const std::vector<int64_t>& a, const std::vector<int64_t>& b) {
+  auto numel = [](const std::vector<int64_t>& shape) {
+    int64_t known = 1;
+    int unknown = 0;
+    for (auto dim : shape) {
+      if (dim < 0) {
+        ++unknown;
+      } else {
+        known *= dim;
+      }
+    }
+    return std::make_pair(known, unknown);
+  };
+  return numel(a) == numel(b);
+}
+
+bool HasOp(const std::vector<Node*>& ops, const std::string& type) {
+  return std::any_of(ops.begin(), ops.end(), [&](Node* n) {
+    return n->IsOp() && n->Op() && n->Op()->Type() == type;
+  });
+}
+
+Node* FindVar(const std::vector<Node*>& vars, const std::string& name) {
+  for (auto* var : vars) {
+    if (var->IsVar() && var->Name() == name) return var;
+  }
+  return nullptr;
+}
+
+int CountName(const VariableNameMap& args, const std::string& name) {
+  int count = 0;
+  for (auto& arg : args) {
+    count += std::count(arg.second.begin(), arg.second.end(), name);
+  }
+  return count;
+}
+
+// Whether var is a view, transitively, of a variable that is persistable, fed
+// or read by other operators, whose memory would be written by computing in
+// place to var.
+bool IsViewOfLiveVar(Node* var) {
+  for (auto* producer : var->inputs) {
+    if (!producer->IsOp() || producer->Op() == nullptr) continue;
+    auto* op = producer->Op();
+    auto* info = OpInfoMap::Instance().GetNullable(op->Type());
+    if (info == nullptr || !info->share_data_) continue;
+    for (auto& pair : info->infer_inplace_()) {
+      if (!op->Inputs().count(pair.first) ||
+          !op->Outputs().count(pair.second) ||
+          std::count(op->Output(pair.second).begin(),
+                     op->Output(pair.second).end(), var->Name()) == 0) {
+        continue;
+      }
+      for (auto& name : op->Input(pair.first)) {
+        auto* src = FindVar(producer->inputs, name);
+        if (src == nullptr || src->outputs.size() != 1 ||
+            src->inputs.empty() || HasOp(src->inputs, "feed") ||
+            (src->Var() && src->Var()->Persistable()) ||
+            IsViewOfLiveVar(src)) {
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> InplacePass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+  // The variables named the same are written more than once, the original
+  // name of every variable is kept to find them.
+  std::unordered_map<std::string, int> name_count;
+  std::unordered_map<Node*, std::string> origin_name;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsVar()) continue;
+    ++name_count[node->Name()];
+    origin_name[node] = node->Name();
+  }
+
+  int num_inplace = 0;
+  for (auto* n : TopologySortOperations(*graph)) {
+    auto* op = n->Op();
+    auto* info = OpInfoMap::Instance().GetNullable(op->Type());
+    if (info == nullptr || !info->infer_inplace_) continue;
+    for (auto& pair : info->infer_inplace_()) {
+      if (!op->Inputs().count(pair.first) ||
+          !op->Outputs().count(pair.second) ||
+          op->Input(pair.first).size() != 1 ||
+          op->Output(pair.second).size() != 1) {
+        continue;
+      }
+      auto* in = FindVar(n->inputs, op->Input(pair.first)[0]);
+      auto* out = FindVar(n->outputs, op->Output(pair.second)[0]);
+      if (in == nullptr || out == nullptr || !IsLoDTensor(in) ||
+          !IsLoDTensor(out) || in->Name() == out->Name()) {
+        continue;
+      }
+      auto* in_var = in->Var();
+      auto* out_var = out->Var();
+      if (in_var->Persistable() || out_var->Persistable() ||
+          in_var->GetDataType() != out_var->GetDataType() ||
+          !SameNumel(in_var->GetShape(), out_var->GetShape())) {
+        continue;
+      }
+      // in dies at n, and is not a feed target. The chained in place
+      // variables all have a unique original name.
+      if (in->outputs.size() != 1 || in->inputs.empty() ||
+          HasOp(in->inputs, "feed") || name_count[origin_name[in]] != 1 ||
+          CountName(op->Inputs(), in->Name()) != 1 || IsViewOfLiveVar(in)) {
+        continue;
+      }
+      // out is read, not fetched, and only written by n.
+      if (out->outputs.empty() || HasOp(out->outputs, "fetch") ||
+          name_count[origin_name[out]] != 1 ||
+          CountName(op->Outputs(), out->Name()) != 1) {
+        continue;
+      }
+
+      // Replace out by a variable of the same name as in.
+      VarDesc desc(*out_var->Proto());
+      desc.SetName(in->Name());
+      auto* inplace_out = graph->CreateVarNode(&desc);
+      origin_name[inplace_out] = origin_name[out];
+      op->RenameOutput(out->Name(), in->Name());
+      IR_NODE_LINK_TO(n, inplace_out);
+      for (auto* reader : out->outputs) {
+        reader->Op()->RenameInput(out->Name(), in->Name());
+        IR_NODE_LINK_TO(inplace_out, reader);
+      }
+      GraphSafeRemoveNodes(graph.get(), {out});
+      ++num_inplace;
+    }
+  }
+  VLOG(3) << "Compute " << num_inplace << " operators in place";
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(inplace_pass, paddle::framework::ir::InplacePass);
@@ -0,0 +1,50 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Compute the operators declaring an InplaceOpInference in place, by renaming
+ * their outputs to their inputs, when the input is only read by the operator
+ * and has the same number of elements and data type as the output.
+ *
+ * The inputs are never the parameters or the feed targets, and the outputs
+ * are never the fetch targets, so the visible variables keep their values.
+ * In a training graph the inputs needed by the backward are read by the
+ * gradient operators too, so they are kept.
+ *
+ * The output of an operator declaring a ShareDataOpInference, e.g. reshape,
+ * is a view of its input, which is not written in place unless the input
+ * dies at that operator as well.
+ */
+class InplacePass : public Pass {
+ public:
+  virtual ~InplacePass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,156 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/inplace_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::map<std::string, std::string>& inputs,
+           const std::map<std::string, std::string>& outputs) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  for (auto& input : inputs) {
+    op->SetInput(input.first, {input.second});
+  }
+  for (auto& output : outputs) {
+    op->SetOutput(output.first, {output.second});
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kForward));
+}
+
+// (x, w)->mul->a->relu->b->scale->c
+// (c, y)->elementwise_add->e->fetch
+// c->tanh->t->fetch
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>(
+           {"x", "w", "a", "b", "c", "y", "e", "t", "fetch"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(v == "fetch" ? proto::VarType::FETCH_LIST
+                              : proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    var->SetShape({-1, 4});
+    if (v == "w") {
+      var->SetPersistable(true);
+    }
+  }
+
+  SetOp(&prog, "mul", {{"X", "x"}, {"Y", "w"}}, {{"Out", "a"}});
+  SetOp(&prog, "relu", {{"X", "a"}}, {{"Out", "b"}});
+  SetOp(&prog, "scale", {{"X", "b"}}, {{"Out", "c"}});
+  SetOp(&prog, "elementwise_add", {{"X", "c"}, {"Y", "y"}}, {{"Out", "e"}});
+  SetOp(&prog, "tanh", {{"X", "c"}}, {{"Out", "t"}});
+  SetOp(&prog, "fetch", {{"X", "e"}}, {{"Out", "fetch"}});
+  SetOp(&prog, "fetch", {{"X", "t"}}, {{"Out", "fetch"}});
+  return prog;
+}
+
+TEST(InplacePass, basic) {
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("inplace_pass");
+  graph = pass->Apply(std::move(graph));
+
+  int num_vars_a = 0;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar()) {
+      EXPECT_NE(node->Name(), "b");
+      EXPECT_NE(node->Name(), "c");
+      if (node->Name() == "a") ++num_vars_a;
+      continue;
+    }
+    auto* op = node->Op();
+    if (op->Type() == "relu") {
+      EXPECT_EQ(op->Output("Out")[0], "a");
+    } else if (op->Type() == "scale") {
+      EXPECT_EQ(op->Input("X")[0], "a");
+      EXPECT_EQ(op->Output("Out")[0], "a");
+    } else if (op->Type() == "elementwise_add") {
+      // c is read by tanh too, and e is fetched.
+      EXPECT_EQ(op->Input("X")[0], "a");
+      EXPECT_EQ(op->Output("Out")[0], "e");
+    } else if (op->Type() == "tanh") {
+      EXPECT_EQ(op->Output("Out")[0], "t");
+    }
+  }
+  // The outputs of mul, relu and scale.
+  EXPECT_EQ(num_vars_a, 3);
+}
+
+// x->reshape2->a->relu->b->fetch
+// (x, w)->mul->m->reshape2->r->relu->s->fetch
+// m->tanh->t->fetch
+TEST(InplacePass, view) {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>(
+           {"x", "w", "a", "b", "m", "r", "s", "t", "fetch"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(v == "fetch" ? proto::VarType::FETCH_LIST
+                              : proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    var->SetShape({-1, 4});
+    if (v == "w") {
+      var->SetPersistable(true);
+    }
+  }
+  SetOp(&prog, "feed", {}, {{"Out", "x"}});
+  SetOp(&prog, "reshape2", {{"X", "x"}}, {{"Out", "a"}});
+  SetOp(&prog, "relu", {{"X", "a"}}, {{"Out", "b"}});
+  SetOp(&prog, "mul", {{"X", "x"}, {"Y", "w"}}, {{"Out", "m"}});
+  SetOp(&prog, "reshape2", {{"X", "m"}}, {{"Out", "r"}});
+  SetOp(&prog, "relu", {{"X", "r"}}, {{"Out", "s"}});
+  SetOp(&prog, "tanh", {{"X", "m"}}, {{"Out", "t"}});
+  SetOp(&prog, "fetch", {{"X", "b"}}, {{"Out", "fetch"}});
+  SetOp(&prog, "fetch", {{"X", "s"}}, {{"Out", "fetch"}});
+  SetOp(&prog, "fetch", {{"X", "t"}}, {{"Out", "fetch"}});
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("inplace_pass");
+  graph = pass->Apply(std::move(graph));
+
+  int num_relu = 0;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp() || node->Op()->Type() != "relu") continue;
+    ++num_relu;
+    // a is a view of the feed target x, and r is a view of m, which is read
+    // by tanh, neither of them is written in place.
+    auto* op = node->Op();
+    if (op->Input("X")[0] == "a") {
+      EXPECT_EQ(op->Output("Out")[0], "b");
+    } else {
+      EXPECT_EQ(op->Input("X")[0], "r");
+      EXPECT_EQ(op->Output("Out")[0], "s");
+    }
+  }
+  EXPECT_EQ(num_relu, 2);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(inplace_pass);
+USE_OP(relu);
+USE_OP(tanh);
+USE_OP(scale);
+USE_OP(elementwise_add);
+USE_OP(reshape2);
@@ -0,0 +1,132 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/memory_planning_pass.h"
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/ir/graph_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static bool IsPlannable(Node* var) {
+  if (!var->IsVar() || var->Var() == nullptr) return false;
+  auto* desc = var->Var();
+  if (desc->Persistable() || desc->GetType() != proto::VarType::LOD_TENSOR) {
+    return false;
+  }
+  // Only the tensors written and read by the graph itself, the feed and
+  // fetch targets are owned by the predictor.
+  if (var->inputs.empty() || var->outputs.empty()) return false;
+  for (auto* op : var->inputs) {
+    if (op->Name() == "feed") return false;
+  }
+  for (auto* op : var->outputs) {
+    if (op->Name() == "fetch") return false;
+  }
+  return true;
+}
+
+static size_t TensorSize(const VarDesc& desc, int64_t batch_size) {
+  int64_t numel = 1;
+  for (auto dim : desc.GetShape()) {
+    numel *= dim < 0 ? batch_size : dim;
+  }
+  return static_cast<size_t>(numel) *
+         SizeOfType(ToTypeIndex(desc.GetDataType()));
+}
+
+std::unique_ptr<Graph> MemoryPlanningPass::ApplyImpl(
+    std::unique_ptr<Graph> graph) const {
+  int64_t batch_size = 1;
+  if (Has(kMemoryPlanningBatchSize)) {
+    batch_size = Get<int>(kMemoryPlanningBatchSize);
+  }
+
+  std::unordered_map<std::string, size_t> sizes;
+  std::unordered_set<std::string> skipped;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsVar() || node->Var() == nullptr) continue;
+    // A variable may have several nodes, it is planned only if all of them
+    // are plannable.
+    if (!IsPlannable(node)) {
+      skipped.insert(node->Name());
+    } else {
+      sizes[node->Name()] = TensorSize(*node->Var(), batch_size);
+    }
+  }
+
+  std::vector<MemoryPlanOp> ops;
+  std::vector<std::pair<std::string, std::string>> views;
+  for (auto* node : TopologySortOperations(*graph)) {
+    auto* op_desc = node->Op();
+    MemoryPlanOp op;
+    op.inputs = op_desc->InputArgumentNames();
+    op.outputs = op_desc->OutputArgumentNames();
+    op.share_data = MemoryPlan::SharesData(op_desc->Type());
+    for (auto& slots : MemoryPlan::InplaceSlots(op_desc->Type())) {
+      if (!op_desc->Inputs().count(slots.first) ||
+          !op_desc->Outputs().count(slots.second)) {
+        continue;
+      }
+      auto& ins = op_desc->Input(slots.first);
+      auto& outs = op_desc->Output(slots.second);
+      if (ins.size() == 1 && outs.size() == 1) {
+        op.inplace.emplace_back(ins[0], outs[0]);
+        if (op.share_data) views.emplace_back(ins[0], outs[0]);
+      }
+    }
+    ops.push_back(std::move(op));
+  }
+
+  // A view and its input are planned together or not at all.
+  auto planned = [&](const std::string& name) {
+    return sizes.count(name) && !skipped.count(name);
+  };
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (auto& view : views) {
+      if (planned(view.first) != planned(view.second)) {
+        skipped.insert(view.first);
+        skipped.insert(view.second);
+        changed = true;
+      }
+    }
+  }
+  for (auto& name : skipped) {
+    sizes.erase(name);
+  }
+
+  auto* plan = new MemoryPlan;
+  plan->Build(ops, sizes);
+  VLOG(3) << "plan " << plan->blocks().size() << " tensors of "
+          << plan->total_size() << " bytes in an arena of "
+          << plan->arena_size() << " bytes";
+  graph->Set(kMemoryPlanAttr, plan);
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(memory_planning_pass,
+              paddle::framework::ir::MemoryPlanningPass);
@@ -0,0 +1,52 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+#include "paddle/fluid/framework/memory_plan.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+// The MemoryPlan of the graph, set by MemoryPlanningPass.
+constexpr char kMemoryPlanAttr[] = "memory_plan";
+// The optional batch size used for the -1 dims, 1 by default.
+constexpr char kMemoryPlanningBatchSize[] = "memory_planning_batch_size";
+
+/*
+ * Compute the lifetimes of the intermediate tensors of an inference graph in
+ * the topological order of its operators, and plan them in one arena with
+ * MemoryPlan. The tensor sizes come from the shapes of the VarDescs.
+ *
+ * The graph is not changed, the plan is set as its kMemoryPlanAttr, which
+ * tells the peak memory of the intermediate tensors ahead of time. The
+ * NaiveExecutor plans with the runtime shapes, see
+ * NaiveExecutor::EnableMemoryPlan.
+ */
+class MemoryPlanningPass : public Pass {
+ public:
+  virtual ~MemoryPlanningPass() {}
+
+ protected:
+  std::unique_ptr<Graph> ApplyImpl(std::unique_ptr<Graph> graph) const override;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,141 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/mkldnn_layout_propagation_pass.h"
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/operator.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+bool HasMKLDNNKernel(const std::string& type) {
+  auto& all_kernels = OperatorWithKernel::AllOpKernels();
+  auto it = all_kernels.find(type);
+  if (it == all_kernels.end()) return false;
+  for (auto& kernel : it->second) {
+    if (kernel.first.library_type_ == LibraryType::kMKLDNN) return true;
+  }
+  return false;
+}
+
+bool UseMKLDNN(OpDesc* op) {
+  return op->HasAttr("use_mkldnn") &&
+         boost::get<bool>(op->GetAttr("use_mkldnn"));
+}
+
+bool IsLoDTensor(Node* var) {
+  return var->IsVar() && var->Var() &&
+         var->Var()->GetType() == proto::VarType::LOD_TENSOR;
+}
+
+bool HasName(const VariableNameMap& args, const std::string& name) {
+  for (auto& arg : args) {
+    if (std::find(arg.second.begin(), arg.second.end(), name) !=
+        arg.second.end()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Whether the input var of the reader could be renamed. The inplace readers
+// write var back, and the readers with sub-blocks pass var to them by name.
+bool CanRedirect(Node* reader, Node* var) {
+  auto* op = reader->Op();
+  return !HasName(op->Outputs(), var->Name()) && !op->HasAttr("sub_block");
+}
+
+Node* CreateTransferLayoutOp(Graph* graph, Node* in, Node* out) {
+  OpDesc desc;
+  desc.SetType("transfer_layout");
+  desc.SetInput("X", {in->Name()});
+  desc.SetOutput("Out", {out->Name()});
+  desc.SetAttr("dst_layout", static_cast<int>(DataLayout::kNCHW));
+  auto* transfer = graph->CreateOpNode(&desc);
+  IR_NODE_LINK_TO(in, transfer);
+  IR_NODE_LINK_TO(transfer, out);
+  return transfer;
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> MKLDNNLayoutPropagationPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+  std::vector<Node*> ops = TopologySortOperations(*graph);
+
+  // The operators running the MKLDNN kernels, whose outputs are in the MKLDNN
+  // layout.
+  std::unordered_set<Node*> mkldnn_ops;
+  int num_cleared = 0;
+  for (auto* n : ops) {
+    if (!UseMKLDNN(n->Op())) continue;
+    if (HasMKLDNNKernel(n->Op()->Type())) {
+      mkldnn_ops.insert(n);
+    } else {
+      n->Op()->SetAttr("use_mkldnn", false);
+      ++num_cleared;
+    }
+  }
+
+  int num_transfers = 0;
+  for (auto* n : ops) {
+    if (!mkldnn_ops.count(n)) continue;
+    std::vector<Node*> outputs = n->outputs;
+    for (auto* var : outputs) {
+      if (!IsLoDTensor(var)) continue;
+      // The MKLDNN readers read var directly, the other readers share one
+      // NCHW copy of it.
+      std::vector<Node*> plain_readers;
+      for (auto* reader : var->outputs) {
+        if (reader->IsOp() && reader->Op() && !mkldnn_ops.count(reader) &&
+            CanRedirect(reader, var)) {
+          plain_readers.push_back(reader);
+        }
+      }
+      if (plain_readers.empty()) continue;
+
+      VarDesc desc(var->Name() + "@nchw");
+      desc.SetDataType(var->Var()->GetDataType());
+      desc.SetShape(var->Var()->GetShape());
+      auto* nchw = graph->CreateVarNode(&desc);
+      CreateTransferLayoutOp(graph.get(), var, nchw);
+      for (auto* reader : plain_readers) {
+        reader->Op()->RenameInput(var->Name(), nchw->Name());
+        Unlink(var, reader);
+        IR_NODE_LINK_TO(nchw, reader);
+      }
+      ++num_transfers;
+    }
+  }
+  VLOG(3) << "Insert " << num_transfers << " transfer_layout operators for "
+          << mkldnn_ops.size() << " MKLDNN operators, clear use_mkldnn of "
+          << num_cleared << " operators without MKLDNN kernels";
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(mkldnn_layout_propagation_pass,
+              paddle::framework::ir::MKLDNNLayoutPropagationPass);
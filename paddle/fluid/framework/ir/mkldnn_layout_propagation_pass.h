@@ -0,0 +1,45 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Propagate the MKLDNN layout of the outputs of the MKLDNN operators to their
+ * readers, and reorder every output read by non-MKLDNN operators back to NCHW
+ * once by an explicit transfer_layout operator shared by all these readers,
+ * instead of a reorder in the data transform of each of them.
+ *
+ * The use_mkldnn of the operators without MKLDNN kernels is cleared, since
+ * they run the plain kernels anyway. It should run after the MKLDNN fuses.
+ */
+class MKLDNNLayoutPropagationPass : public Pass {
+ public:
+  virtual ~MKLDNNLayoutPropagationPass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
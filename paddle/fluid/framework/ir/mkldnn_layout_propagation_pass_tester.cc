@@ -0,0 +1,90 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/mkldnn_layout_propagation_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/operator.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::vector<std::string>& inputs,
+           const std::vector<std::string>& outputs, bool use_mkldnn) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  op->SetAttr("use_mkldnn", use_mkldnn);
+  op->SetInput("X", inputs);
+  op->SetOutput("Out", outputs);
+}
+
+// a->mkldnn_op->b
+// b->plain_op->c
+// b->plain_op->d
+// b->mkldnn_op->e
+// e->mkldnn_op->f
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>({"a", "b", "c", "d", "e", "f"})) {
+    prog.MutableBlock(0)->Var(v)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  SetOp(&prog, "mkldnn_op", {"a"}, {"b"}, true);
+  SetOp(&prog, "plain_op", {"b"}, {"c"}, true);
+  SetOp(&prog, "plain_op", {"b"}, {"d"}, false);
+  SetOp(&prog, "mkldnn_op", {"b"}, {"e"}, true);
+  SetOp(&prog, "mkldnn_op", {"e"}, {"f"}, true);
+  return prog;
+}
+
+TEST(MKLDNNLayoutPropagationPass, basic) {
+  // Only mkldnn_op has an MKLDNN kernel.
+  OperatorWithKernel::AllOpKernels()["mkldnn_op"][OpKernelType(
+      proto::VarType::FP32, platform::CPUPlace(), DataLayout::kMKLDNN,
+      LibraryType::kMKLDNN)] = [](const ExecutionContext&) {};
+
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("mkldnn_layout_propagation_pass");
+  graph = pass->Apply(std::move(graph));
+
+  int num_transfers = 0;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    auto* op = node->Op();
+    if (op->Type() == "transfer_layout") {
+      ++num_transfers;
+      EXPECT_EQ(op->Input("X")[0], "b");
+      EXPECT_EQ(op->Output("Out")[0], "b@nchw");
+      ASSERT_EQ(node->outputs.size(), 1UL);
+      EXPECT_EQ(node->outputs[0]->outputs.size(), 2UL);
+    } else if (op->Type() == "plain_op") {
+      // Both plain_ops read the NCHW copy.
+      EXPECT_FALSE(boost::get<bool>(op->GetAttr("use_mkldnn")));
+      EXPECT_EQ(op->Input("X")[0], "b@nchw");
+    } else if (op->Type() == "mkldnn_op") {
+      EXPECT_TRUE(boost::get<bool>(op->GetAttr("use_mkldnn")));
+      EXPECT_NE(op->Input("X")[0], "b@nchw");
+    }
+  }
+  // e is only read by the MKLDNN operators.
+  EXPECT_EQ(num_transfers, 1);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(mkldnn_layout_propagation_pass);
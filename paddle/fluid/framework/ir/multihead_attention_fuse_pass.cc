@@ -0,0 +1,142 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/multihead_attention_fuse_pass.h"
+#include <string>
+#include <unordered_set>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+// The fused op only supports Q, K and V with the same batch dims.
+static bool IsSameRank(std::initializer_list<Node*> vars) {
+  size_t rank = 0;
+  for (auto* var : vars) {
+    if (!var->Var()) return false;
+    size_t var_rank = var->Var()->GetShape().size();
+    if (var_rank < 2 || (rank != 0 && var_rank != rank)) return false;
+    rank = var_rank;
+  }
+  return true;
+}
+
+static int BuildFusion(Graph* graph, const std::string& name_scope,
+                       bool with_scale, bool with_bias, bool with_dropout) {
+  GraphPatternDetector gpd;
+  patterns::MultiHeadAttention pattern(gpd.mutable_pattern(), name_scope);
+  pattern(with_scale, with_bias, with_dropout);
+
+  int fusion_count{0};
+  auto handler = [&](const GraphPatternDetector::subgraph_t& subgraph,
+                     Graph* g) {
+    VLOG(4) << "handle multihead attention fuse";
+    GET_IR_NODE_FROM_SUBGRAPH(q, q, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(k, k, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(v, v, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(matmul_qk, matmul_qk, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(qk_out, qk_out, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(softmax, softmax, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(softmax_out, softmax_out, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(matmul_qkv, matmul_qkv, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(out, out, pattern);
+    if (!IsSameRank({q, k, v, qk_out})) return;
+
+    std::unordered_set<const Node*> marked_nodes(
+        {matmul_qk, qk_out, softmax, softmax_out, matmul_qkv});
+    float alpha = boost::get<float>(matmul_qk->Op()->GetAttr("alpha"));
+    float out_scale = boost::get<float>(matmul_qkv->Op()->GetAttr("alpha"));
+
+    OpDesc desc;
+    desc.SetType("fused_multihead_attention");
+    desc.SetInput("Q", {q->Name()});
+    desc.SetInput("K", {k->Name()});
+    desc.SetInput("V", {v->Name()});
+    Node* bias = nullptr;
+    if (with_scale) {
+      GET_IR_NODE_FROM_SUBGRAPH(scale, scale, pattern);
+      GET_IR_NODE_FROM_SUBGRAPH(scale_out, scale_out, pattern);
+      alpha *= boost::get<float>(scale->Op()->GetAttr("scale"));
+      marked_nodes.insert({scale, scale_out});
+    }
+    if (with_bias) {
+      GET_IR_NODE_FROM_SUBGRAPH(eltadd, eltadd, pattern);
+      GET_IR_NODE_FROM_SUBGRAPH(eltadd_bias, eltadd_bias, pattern);
+      GET_IR_NODE_FROM_SUBGRAPH(eltadd_out, eltadd_out, pattern);
+      // the bias should not be broadcasted
+      if (!IsSameRank({qk_out, eltadd_bias})) return;
+      desc.SetInput("BiasQK", {eltadd_bias->Name()});
+      bias = eltadd_bias;
+      marked_nodes.insert({eltadd, eltadd_out});
+    }
+    if (with_dropout) {
+      GET_IR_NODE_FROM_SUBGRAPH(dropout, dropout, pattern);
+      GET_IR_NODE_FROM_SUBGRAPH(dropout_out, dropout_out, pattern);
+      GET_IR_NODE_FROM_SUBGRAPH(dropout_mask, dropout_mask, pattern);
+      auto* dropout_op = dropout->Op();
+      bool upscale_in_train =
+          dropout_op->HasAttr("dropout_implementation") &&
+          boost::get<std::string>(dropout_op->GetAttr(
+              "dropout_implementation")) == "upscale_in_train";
+      if (!upscale_in_train) {
+        out_scale *=
+            1.0f - boost::get<float>(dropout_op->GetAttr("dropout_prob"));
+      }
+      marked_nodes.insert({dropout, dropout_out, dropout_mask});
+    }
+    desc.SetOutput("Out", {out->Name()});
+    desc.SetAttr("alpha", alpha);
+    desc.SetAttr("out_scale", out_scale);
+
+    auto* op = g->CreateOpNode(&desc);
+    IR_NODE_LINK_TO(q, op);
+    IR_NODE_LINK_TO(k, op);
+    IR_NODE_LINK_TO(v, op);
+    if (bias) {
+      IR_NODE_LINK_TO(bias, op);
+    }
+    IR_NODE_LINK_TO(op, out);
+    GraphSafeRemoveNodes(g, marked_nodes);
+    ++fusion_count;
+  };
+
+  gpd(graph, handler);
+  return fusion_count;
+}
+
+std::unique_ptr<ir::Graph> MultiHeadAttentionFusePass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  FusePassBase::Init(name_scope_, graph.get());
+
+  int fusion_count = 0;
+  for (bool with_scale : {true, false}) {
+    for (bool with_bias : {true, false}) {
+      for (bool with_dropout : {true, false}) {
+        fusion_count += BuildFusion(graph.get(), name_scope_, with_scale,
+                                    with_bias, with_dropout);
+      }
+    }
+  }
+  AddStatis(fusion_count);
+
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(multihead_attention_fuse_pass,
+              paddle::framework::ir::MultiHeadAttentionFusePass);
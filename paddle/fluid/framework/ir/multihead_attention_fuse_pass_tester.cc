@@ -0,0 +1,129 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/multihead_attention_fuse_pass.h"
+
+#include <gtest/gtest.h>
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+OpDesc* SetOp(ProgramDesc* prog, const std::string& type,
+              const std::map<std::string, std::string>& inputs,
+              const std::map<std::string, std::string>& outputs) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  for (auto& input : inputs) {
+    op->SetInput(input.first, {input.second});
+  }
+  for (auto& output : outputs) {
+    op->SetOutput(output.first, {output.second});
+  }
+  return op;
+}
+
+OpDesc* SetMatMul(ProgramDesc* prog, const std::string& x,
+                  const std::string& y, const std::string& out,
+                  bool transpose_y, float alpha) {
+  auto* op = SetOp(prog, "matmul", {{"X", x}, {"Y", y}}, {{"Out", out}});
+  op->SetAttr("transpose_X", false);
+  op->SetAttr("transpose_Y", transpose_y);
+  op->SetAttr("alpha", alpha);
+  return op;
+}
+
+// The attention with all the optional ops:
+// (q, k)->matmul->qk->scale->s->(s, bias)->elementwise_add->a->softmax->p
+// p->dropout->(d, mask), (d, v)->matmul->out
+// The attention without them:
+// (q, k)->matmul->qk1->softmax->p1, (p1, v)->matmul->out1
+// The attention whose attention weights are also fetched:
+// (q, k)->matmul->qk2->softmax->p2, (p2, v)->matmul->out2, p2->fetch
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>(
+           {"q", "k", "v", "bias", "qk", "s", "a", "p", "d", "mask", "out",
+            "qk1", "p1", "out1", "qk2", "p2", "out2", "fetched"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetShape({-1, 8, -1, 64});
+  }
+
+  SetMatMul(&prog, "q", "k", "qk", true, 0.5f);
+  auto* scale = SetOp(&prog, "scale", {{"X", "qk"}}, {{"Out", "s"}});
+  scale->SetAttr("scale", 0.25f);
+  scale->SetAttr("bias", 0.f);
+  auto* eltadd = SetOp(&prog, "elementwise_add", {{"X", "s"}, {"Y", "bias"}},
+                       {{"Out", "a"}});
+  eltadd->SetAttr("axis", -1);
+  SetOp(&prog, "softmax", {{"X", "a"}}, {{"Out", "p"}});
+  auto* dropout =
+      SetOp(&prog, "dropout", {{"X", "p"}}, {{"Out", "d"}, {"Mask", "mask"}});
+  dropout->SetAttr("is_test", true);
+  dropout->SetAttr("dropout_prob", 0.25f);
+  SetMatMul(&prog, "d", "v", "out", false, 1.f);
+
+  SetMatMul(&prog, "q", "k", "qk1", true, 0.125f);
+  SetOp(&prog, "softmax", {{"X", "qk1"}}, {{"Out", "p1"}});
+  SetMatMul(&prog, "p1", "v", "out1", false, 1.f);
+
+  SetMatMul(&prog, "q", "k", "qk2", true, 0.125f);
+  SetOp(&prog, "softmax", {{"X", "qk2"}}, {{"Out", "p2"}});
+  SetMatMul(&prog, "p2", "v", "out2", false, 1.f);
+  SetOp(&prog, "fetch", {{"X", "p2"}}, {{"Out", "fetched"}});
+  return prog;
+}
+
+TEST(MultiHeadAttentionFusePass, basic) {
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("multihead_attention_fuse_pass");
+  graph = pass->Apply(std::move(graph));
+
+  int num_fused = 0;
+  int num_matmul = 0;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    auto* op = node->Op();
+    if (op->Type() == "matmul") {
+      ++num_matmul;
+    }
+    if (op->Type() != "fused_multihead_attention") continue;
+    ++num_fused;
+    ASSERT_EQ(node->outputs.size(), 1UL);
+    auto out = node->outputs[0]->Name();
+    float alpha = boost::get<float>(op->GetAttr("alpha"));
+    float out_scale = boost::get<float>(op->GetAttr("out_scale"));
+    if (out == "out") {
+      EXPECT_EQ(op->Input("BiasQK"), std::vector<std::string>({"bias"}));
+      EXPECT_FLOAT_EQ(alpha, 0.125f);
+      EXPECT_FLOAT_EQ(out_scale, 0.75f);
+    } else {
+      EXPECT_EQ(out, "out1");
+      EXPECT_TRUE(op->Input("BiasQK").empty());
+      EXPECT_FLOAT_EQ(alpha, 0.125f);
+      EXPECT_FLOAT_EQ(out_scale, 1.f);
+    }
+  }
+  EXPECT_EQ(num_fused, 2);
+  // the last attention is kept
+  EXPECT_EQ(num_matmul, 2);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(multihead_attention_fuse_pass);
@@ -0,0 +1,60 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/packed_weight_pass.h"
+#include <string>
+#include <unordered_map>
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// The operators supporting the packed weight, and the inputs of their weights.
+const std::unordered_map<std::string, std::string> kWeightInputs{
+    {"mul", "Y"}, {"fc", "W"}, {"matmul", "Y"}};
+
+// The same as math::kUsePackedWeight.
+constexpr char kUsePackedWeight[] = "use_packed_weight";
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> PackedWeightPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  int num_packed = 0;
+  for (auto* n : graph->Nodes()) {
+    if (!n->IsOp() || !n->Op()) continue;
+    auto it = kWeightInputs.find(n->Op()->Type());
+    if (it == kWeightInputs.end()) continue;
+    auto& names = n->Op()->Input(it->second);
+    if (names.size() != 1UL) continue;
+    for (auto* in : n->inputs) {
+      if (in->Name() != names[0] || !in->Var()) continue;
+      if (in->Var()->Persistable() && in->inputs.empty()) {
+        n->Op()->SetAttr(kUsePackedWeight, true);
+        ++num_packed;
+      }
+      break;
+    }
+  }
+  VLOG(3) << "Use the packed weights in " << num_packed << " operators";
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(packed_weight_pass, paddle::framework::ir::PackedWeightPass);
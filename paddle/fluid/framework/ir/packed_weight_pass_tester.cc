@@ -0,0 +1,75 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/packed_weight_pass.h"
+
+#include <gtest/gtest.h>
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::map<std::string, std::string>& inputs,
+           const std::string& output) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  for (auto& input : inputs) {
+    op->SetInput(input.first, {input.second});
+  }
+  op->SetOutput("Out", {output});
+}
+
+// (x, w)->mul->a, (a, v)->fc->b, (b, b)->matmul->c, (c, u)->matmul->d
+// where w and v are the weights, u is a persistable written by assign.
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>(
+           {"x", "w", "a", "v", "b", "c", "u", "d", "y"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    if (v == "w" || v == "v" || v == "u") {
+      var->SetPersistable(true);
+    }
+  }
+  SetOp(&prog, "mul", {{"X", "x"}, {"Y", "w"}}, "a");
+  SetOp(&prog, "fc", {{"Input", "a"}, {"W", "v"}}, "b");
+  SetOp(&prog, "matmul", {{"X", "b"}, {"Y", "b"}}, "c");
+  SetOp(&prog, "assign", {{"X", "y"}}, "u");
+  SetOp(&prog, "matmul", {{"X", "c"}, {"Y", "u"}}, "d");
+  return prog;
+}
+
+TEST(PackedWeightPass, basic) {
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("packed_weight_pass");
+  graph = pass->Apply(std::move(graph));
+
+  int num_packed = 0;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp() || !node->Op()->HasAttr("use_packed_weight")) continue;
+    EXPECT_TRUE(boost::get<bool>(node->Op()->GetAttr("use_packed_weight")));
+    auto type = node->Op()->Type();
+    EXPECT_TRUE(type == "mul" || type == "fc");
+    ++num_packed;
+  }
+  EXPECT_EQ(num_packed, 2);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(packed_weight_pass);
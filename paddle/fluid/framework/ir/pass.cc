@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/ir/pass.h"
+#include <chrono>  // NOLINT
+#include <unordered_map>
 #include "paddle/fluid/framework/ir/graph_helper.h"
 
 namespace paddle {
@@ -28,7 +30,18 @@ std::unique_ptr<Graph> Pass::Apply(std::unique_ptr<Graph> graph) const {
     PADDLE_ENFORCE(graph->Has(attr), "Required graph atrribute %s not set.",
                    attr);
   }
+  auto start = std::chrono::steady_clock::now();
   auto applied_graph = ApplyImpl(std::move(graph));
+  double elapsed_ms = std::chrono::duration<double, std::milli>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+  VLOG(3) << "pass " << Type() << " took " << elapsed_ms << "ms";
+  if (!applied_graph->Has(kPassTimingAttr)) {
+    applied_graph->Set(kPassTimingAttr,
+                       new std::unordered_map<std::string, double>);
+  }
+  applied_graph->Get<std::unordered_map<std::string, double>>(
+      kPassTimingAttr)[Type()] += elapsed_ms;
   // TODO(panyx0718): Add more verifications.
   PADDLE_ENFORCE(!HasCircle(*applied_graph),
                  "Illegal Pass. Generated graph shouldn't has cycle.");
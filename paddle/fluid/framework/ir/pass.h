@@ -26,6 +26,10 @@ limitations under the License. */
 namespace paddle {
 namespace framework {
 namespace ir {
+// The milliseconds spent in each type of pass applied to the graph, an
+// std::unordered_map<std::string, double>.
+static const char kPassTimingAttr[] = "__pass_timing__";
+
 template <typename PassType>
 struct PassRegistrar;
 
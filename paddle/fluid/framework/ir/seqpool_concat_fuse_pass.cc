@@ -0,0 +1,138 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/seqpool_concat_fuse_pass.h"
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+Node* FindVar(const std::vector<Node*>& vars, const std::string& name) {
+  for (auto* var : vars) {
+    if (var->IsVar() && var->Name() == name) return var;
+  }
+  return nullptr;
+}
+
+// The sequence_pool op writing the input of the concat, which is used only by
+// the concat, the unused MaxIndex is appended to removed.
+Node* GetSeqPool(Node* in, Node* concat, std::unordered_set<Node*>* removed) {
+  if (!in || !in->Var() || in->Var()->Persistable() ||
+      in->inputs.size() != 1UL || in->outputs.size() != 1UL ||
+      in->outputs[0] != concat) {
+    return nullptr;
+  }
+  Node* seqpool = in->inputs[0];
+  if (!seqpool->IsOp() || !seqpool->Op() ||
+      seqpool->Op()->Type() != "sequence_pool" ||
+      seqpool->Op()->Output("Out") != std::vector<std::string>({in->Name()}) ||
+      seqpool->Op()->Input("X").size() != 1UL) {
+    return nullptr;
+  }
+  auto pooltype = boost::get<std::string>(seqpool->Op()->GetAttr("pooltype"));
+  if (pooltype != "SUM" && pooltype != "AVERAGE" && pooltype != "SQRT") {
+    return nullptr;
+  }
+  for (auto* out : seqpool->outputs) {
+    if (out == in) continue;
+    if (!out->outputs.empty()) return nullptr;
+    removed->insert(out);
+  }
+  removed->insert(seqpool);
+  removed->insert(in);
+  return seqpool;
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> SeqPoolConcatFusePass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+  FusePassBase::Init(name_scope_, graph.get());
+
+  std::vector<Node*> concats;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op() && node->Op()->Type() == "concat") {
+      concats.push_back(node);
+    }
+  }
+
+  int fusion_count = 0;
+  for (auto* concat : concats) {
+    auto* op = concat->Op();
+    auto input_names = op->Input("X");
+    if (input_names.size() < 2UL || op->Output("Out").size() != 1UL ||
+        boost::get<int>(op->GetAttr("axis")) != 1) {
+      continue;
+    }
+    Node* out = FindVar(concat->outputs, op->Output("Out")[0]);
+    if (!out) continue;
+
+    std::unordered_set<Node*> removed;
+    std::vector<Node*> xs;
+    std::string pooltype;
+    bool ok = std::unordered_set<std::string>(input_names.begin(),
+                                              input_names.end())
+                  .size() == input_names.size();
+    for (size_t i = 0; ok && i < input_names.size(); ++i) {
+      Node* seqpool =
+          GetSeqPool(FindVar(concat->inputs, input_names[i]), concat, &removed);
+      Node* x = seqpool ? FindVar(seqpool->inputs, seqpool->Op()->Input("X")[0])
+                        : nullptr;
+      if (!x) {
+        ok = false;
+        break;
+      }
+      auto type = boost::get<std::string>(seqpool->Op()->GetAttr("pooltype"));
+      ok = i == 0 || type == pooltype;
+      pooltype = type;
+      xs.push_back(x);
+    }
+    if (!ok) continue;
+
+    std::vector<std::string> x_names;
+    for (auto* x : xs) x_names.push_back(x->Name());
+    OpDesc desc;
+    desc.SetType("fusion_seqpool_concat");
+    desc.SetInput("X", x_names);
+    desc.SetOutput("Out", {out->Name()});
+    desc.SetAttr("pooltype", pooltype);
+    desc.SetAttr("axis", 1);
+    auto* fused = graph->CreateOpNode(&desc);
+    for (auto* x : std::unordered_set<Node*>(xs.begin(), xs.end())) {
+      IR_NODE_LINK_TO(x, fused);
+    }
+    IR_NODE_LINK_TO(fused, out);
+
+    removed.insert(concat);
+    std::unordered_set<const Node*> marked(removed.begin(), removed.end());
+    GraphSafeRemoveNodes(graph.get(), marked);
+    ++fusion_count;
+  }
+  AddStatis(fusion_count);
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(seqpool_concat_fuse_pass,
+              paddle::framework::ir::SeqPoolConcatFusePass);
@@ -0,0 +1,93 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/seqpool_concat_fuse_pass.h"
+
+#include <gtest/gtest.h>
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::vector<std::string>& inputs, const std::string& output,
+           const std::string& pooltype = "SUM") {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  op->SetInput("X", inputs);
+  op->SetOutput("Out", {output});
+  if (type == "sequence_pool") {
+    op->SetAttr("pooltype", pooltype);
+    op->SetOutput("MaxIndex", {output + "_index"});
+  } else if (type == "concat") {
+    op->SetAttr("axis", 1);
+  }
+}
+
+// a->sequence_pool->a1, b->sequence_pool->b1, c->sequence_pool->c1,
+// (a1, b1, c1)->concat->d->fc
+// e->sequence_pool(MAX)->e1, (a1, e1)->concat->f
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>({"a", "b", "c", "a1", "b1", "c1",
+                                           "a1_index", "b1_index", "c1_index",
+                                           "d", "e", "e1", "e1_index", "f",
+                                           "g"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+  }
+  SetOp(&prog, "sequence_pool", {"a"}, "a1");
+  SetOp(&prog, "sequence_pool", {"b"}, "b1");
+  SetOp(&prog, "sequence_pool", {"c"}, "c1");
+  SetOp(&prog, "concat", {"a1", "b1", "c1"}, "d");
+  SetOp(&prog, "relu", {"d"}, "g");
+  SetOp(&prog, "sequence_pool", {"e"}, "e1", "MAX");
+  SetOp(&prog, "concat", {"e1", "e"}, "f");
+  return prog;
+}
+
+TEST(SeqPoolConcatFusePass, basic) {
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("seqpool_concat_fuse_pass");
+  graph = pass->Apply(std::move(graph));
+
+  int num_fused = 0;
+  int num_seqpools = 0;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    auto* op = node->Op();
+    if (op->Type() == "sequence_pool") ++num_seqpools;
+    if (op->Type() != "fusion_seqpool_concat") continue;
+    ++num_fused;
+    EXPECT_EQ(op->Input("X"), std::vector<std::string>({"a", "b", "c"}));
+    EXPECT_EQ(op->Output("Out"), std::vector<std::string>({"d"}));
+    EXPECT_EQ(boost::get<std::string>(op->GetAttr("pooltype")), "SUM");
+    EXPECT_EQ(node->inputs.size(), 3UL);
+    ASSERT_EQ(node->outputs.size(), 1UL);
+    EXPECT_EQ(node->outputs[0]->outputs[0]->Op()->Type(), "relu");
+  }
+  // The max pooling and the concat of a sequence are not fused.
+  EXPECT_EQ(num_fused, 1);
+  EXPECT_EQ(num_seqpools, 1);
+  auto& statis =
+      graph->Get<std::unordered_map<std::string, int>>(kFuseStatisAttr);
+  EXPECT_EQ(statis.at("seqpool_concat_fuse"), 1);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(seqpool_concat_fuse_pass);
@@ -0,0 +1,105 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/virtual_concat_pass.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+Node* FindVar(const std::vector<Node*>& vars, const std::string& name) {
+  for (auto* var : vars) {
+    if (var->IsVar() && var->Name() == name) return var;
+  }
+  return nullptr;
+}
+
+// A temporary LoDTensor of one variable node, which has a single writer.
+bool IsSingleTensor(Node* var,
+                    const std::unordered_map<std::string, int>& name_count) {
+  return var != nullptr && var->Var() &&
+         var->Var()->GetType() == proto::VarType::LOD_TENSOR &&
+         !var->Var()->Persistable() && name_count.at(var->Name()) == 1;
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> VirtualConcatPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+  std::unordered_map<std::string, int> name_count;
+  std::vector<Node*> concats;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar()) {
+      ++name_count[node->Name()];
+    } else if (node->IsOp() && node->Op() && node->Op()->Type() == "concat") {
+      concats.push_back(node);
+    }
+  }
+
+  // Every variable is bound to the slice of one concat.
+  std::unordered_set<std::string> bound;
+  int num_virtual = 0;
+  for (auto* n : concats) {
+    auto* op = n->Op();
+    auto input_names = op->Input("X");
+    if (input_names.size() < 2 || op->Output("Out").size() != 1) continue;
+    auto* out = FindVar(n->outputs, op->Output("Out")[0]);
+    if (!IsSingleTensor(out, name_count)) continue;
+
+    std::unordered_set<std::string> names(input_names.begin(),
+                                          input_names.end());
+    std::unordered_set<Node*> producers;
+    bool ok = names.size() == input_names.size();
+    for (auto& name : input_names) {
+      if (!ok) break;
+      auto* in = FindVar(n->inputs, name);
+      ok = IsSingleTensor(in, name_count) && !bound.count(name) &&
+           in->inputs.size() == 1 && in->inputs[0]->IsOp() &&
+           in->inputs[0]->Op() && in->inputs[0]->Op()->Type() != "feed";
+      if (ok) producers.insert(in->inputs[0]);
+    }
+    if (!ok) continue;
+    bound.insert(input_names.begin(), input_names.end());
+
+    OpDesc desc;
+    desc.SetType("bind_concat_slices");
+    desc.SetAttr("input_names", input_names);
+    desc.SetAttr("output_name", out->Name());
+    desc.SetAttr("axis", op->GetAttr("axis"));
+    auto* bind = graph->CreateOpNode(&desc);
+    // The inputs are bound before they are written.
+    auto* ctrl = graph->CreateControlDepVar();
+    IR_NODE_LINK_TO(bind, ctrl);
+    for (auto* producer : producers) {
+      IR_NODE_LINK_TO(ctrl, producer);
+    }
+    ++num_virtual;
+  }
+  VLOG(3) << "Write the outputs of " << num_virtual << " concats in place";
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(virtual_concat_pass, paddle::framework::ir::VirtualConcatPass);
@@ -0,0 +1,47 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Make the producers of the inputs of a concat write its output in place, by
+ * a bind_concat_slices operator before the producers, which binds the inputs
+ * to the slices of the output of the last run. The concat then copies
+ * nothing, unless the shapes change or the slices on the axis are not
+ * consecutive.
+ *
+ * The inputs and the output are written only once and are never the
+ * parameters or the feed targets, so no other operator writes the memory of
+ * the output. It runs after the inplace_pass, which renames the variables.
+ */
+class VirtualConcatPass : public Pass {
+ public:
+  virtual ~VirtualConcatPass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
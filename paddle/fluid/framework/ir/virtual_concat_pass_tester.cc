@@ -0,0 +1,100 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/virtual_concat_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::map<std::string, std::vector<std::string>>& inputs,
+           const std::map<std::string, std::string>& outputs) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  if (type == "concat") {
+    op->SetAttr("axis", 1);
+  }
+  for (auto& input : inputs) {
+    op->SetInput(input.first, input.second);
+  }
+  for (auto& output : outputs) {
+    op->SetOutput(output.first, {output.second});
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kForward));
+}
+
+// x->feed, (x, w)->mul->a, x->relu->b, x->tanh->c
+// (a, b)->concat->d, (c, x)->concat->e, (d, w)->concat->f
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>(
+           {"feed", "x", "w", "a", "b", "c", "d", "e", "f"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(v == "feed" ? proto::VarType::FEED_MINIBATCH
+                             : proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    if (v == "w") {
+      var->SetPersistable(true);
+    }
+  }
+
+  SetOp(&prog, "feed", {{"X", {"feed"}}}, {{"Out", "x"}});
+  SetOp(&prog, "mul", {{"X", {"x"}}, {"Y", {"w"}}}, {{"Out", "a"}});
+  SetOp(&prog, "relu", {{"X", {"x"}}}, {{"Out", "b"}});
+  SetOp(&prog, "tanh", {{"X", {"x"}}}, {{"Out", "c"}});
+  SetOp(&prog, "concat", {{"X", {"a", "b"}}}, {{"Out", "d"}});
+  SetOp(&prog, "concat", {{"X", {"c", "x"}}}, {{"Out", "e"}});
+  SetOp(&prog, "concat", {{"X", {"d", "w"}}}, {{"Out", "f"}});
+  return prog;
+}
+
+TEST(VirtualConcatPass, basic) {
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("virtual_concat_pass");
+  graph = pass->Apply(std::move(graph));
+
+  int num_binds = 0;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp() || node->Op()->Type() != "bind_concat_slices") continue;
+    ++num_binds;
+    auto* op = node->Op();
+    EXPECT_EQ(boost::get<std::vector<std::string>>(op->GetAttr("input_names")),
+              std::vector<std::string>({"a", "b"}));
+    EXPECT_EQ(boost::get<std::string>(op->GetAttr("output_name")), "d");
+    EXPECT_EQ(boost::get<int>(op->GetAttr("axis")), 1);
+    // mul and relu run after it.
+    ASSERT_EQ(node->outputs.size(), 1UL);
+    auto* ctrl = node->outputs[0];
+    EXPECT_TRUE(ctrl->IsCtrlVar());
+    ASSERT_EQ(ctrl->outputs.size(), 2UL);
+    for (auto* producer : ctrl->outputs) {
+      EXPECT_TRUE(producer->Op()->Type() == "mul" ||
+                  producer->Op()->Type() == "relu");
+    }
+  }
+  // x is a feed target and w is a parameter.
+  EXPECT_EQ(num_binds, 1);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(virtual_concat_pass);
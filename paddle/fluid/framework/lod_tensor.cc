@@ -305,6 +305,39 @@ void DeserializeFromStream(std::istream &is, LoDTensor *tensor,
   TensorFromStream(is, static_cast<Tensor *>(tensor), dev_ctx);
 }
 
+void DeserializeFromPiece(string::Piece *data, LoDTensor *tensor,
+                          const platform::DeviceContext &dev_ctx) {
+  auto read = [data](void *dst, size_t size) {
+    PADDLE_ENFORCE_LE(size, data->len(), "The data is truncated.");
+    memcpy(dst, data->data(), size);
+    *data = string::SkipPrefix(*data, size);
+  };
+  {
+    // the 1st field, unit32_t version for LoDTensor
+    uint32_t version;
+    read(&version, sizeof(version));
+    PADDLE_ENFORCE(framework::IsTensorVersionSupported(version),
+                   "tensor version %u is not supported.", version);
+    PADDLE_ENFORCE_EQ(version, 0U, "Only version 0 is supported");
+  }
+  {
+    // the 2st field, LoD information
+    uint64_t lod_level;
+    read(&lod_level, sizeof(lod_level));
+    auto &lod = *tensor->mutable_lod();
+    lod.resize(lod_level);
+    for (uint64_t i = 0; i < lod_level; ++i) {
+      uint64_t size;
+      read(&size, sizeof(size));
+      std::vector<size_t> tmp(size / sizeof(size_t));
+      read(tmp.data(), size);
+      lod[i] = tmp;
+    }
+  }
+  // the 3st filed, Tensor
+  TensorFromPiece(data, static_cast<Tensor *>(tensor), dev_ctx);
+}
+
 #if !defined(_WIN32)
 void WriteToRecordIO(recordio::Writer *writer,
                      const std::vector<LoDTensor> &tensor,
@@ -324,13 +357,17 @@ bool ReadFromRecordIO(recordio::Scanner *scanner,
   if (!scanner->HasNext()) {
     return false;
   }
-  std::istringstream sin(scanner->Next());
+  // The record is a view into the chunk of the scanner, so the tensors are
+  // read from it directly.
+  string::Piece record = scanner->Next();
   uint32_t sz;
-  sin.read(reinterpret_cast<char *>(&sz), sizeof(uint32_t));
+  PADDLE_ENFORCE_GE(record.len(), sizeof(uint32_t), "The record is truncated.");
+  memcpy(&sz, record.data(), sizeof(uint32_t));
+  record = string::SkipPrefix(record, sizeof(uint32_t));
   auto &result = *result_ptr;
   result.resize(sz);
   for (uint32_t i = 0; i < sz; ++i) {
-    DeserializeFromStream(sin, &result[i], dev_ctx);
+    DeserializeFromPiece(&record, &result[i], dev_ctx);
   }
 
   return true;
@@ -218,6 +218,9 @@ void SerializeToStream(std::ostream& os, const LoDTensor& tensor,
                        const platform::DeviceContext& dev_ctx);
 void DeserializeFromStream(std::istream& is, LoDTensor* tensor,
                            const platform::DeviceContext& dev_ctx);
+// Deserialize the tensor from the front of the data, and move data past it.
+void DeserializeFromPiece(string::Piece* data, LoDTensor* tensor,
+                          const platform::DeviceContext& dev_ctx);
 
 extern void WriteToRecordIO(recordio::Writer* writer,
                             const std::vector<LoDTensor>& tensor,
@@ -16,6 +16,7 @@
 #include <gtest/gtest.h>
 #include <algorithm>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "paddle/fluid/framework/lod_tensor.h"
@@ -274,6 +275,34 @@ TEST(LoD, ConvertToOffsetBasedLoD) {
   EXPECT_EQ(offset_lod, expected);
 }
 
+TEST(LoDTensor, DeserializeFromPiece) {
+  LoDTensor tensor;
+  tensor.set_lod({{0, 2, 5}});
+  float* tmp = tensor.mutable_data<float>(make_ddim({5, 2}),
+                                          platform::CPUPlace());
+  for (int i = 0; i < 10; ++i) {
+    tmp[i] = static_cast<float>(i);
+  }
+  auto& ctx =
+      *platform::DeviceContextPool::Instance().Get(platform::CPUPlace());
+  std::stringstream stream;
+  SerializeToStream(stream, tensor, ctx);
+  SerializeToStream(stream, tensor, ctx);
+  std::string buffer = stream.str();
+
+  string::Piece data(buffer);
+  for (int n = 0; n < 2; ++n) {
+    LoDTensor result;
+    DeserializeFromPiece(&data, &result, ctx);
+    ASSERT_EQ(result.lod(), tensor.lod());
+    ASSERT_EQ(result.dims(), tensor.dims());
+    for (int i = 0; i < 10; ++i) {
+      ASSERT_EQ(result.data<float>()[i], static_cast<float>(i));
+    }
+  }
+  ASSERT_EQ(data.len(), 0UL);
+}
+
 #if !defined(_WIN32)
 template <typename T>
 static void TestRecordIO() {
@@ -0,0 +1,206 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/mapped_file.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // !_WIN32
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/framework/version.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+// "PDMM" in the little endian order.
+constexpr uint32_t kMappableParamsMagic = 0x4D4D4450;
+constexpr uint32_t kMappableParamsVersion = 0;
+
+MappedFile::MappedFile(const std::string& path) : data_(nullptr), size_(0) {
+#if !defined(_WIN32)
+  int fd = open(path.c_str(), O_RDONLY);
+  PADDLE_ENFORCE(fd >= 0, "Cannot open file %s", path);
+  struct stat st;
+  PADDLE_ENFORCE_EQ(fstat(fd, &st), 0, "Cannot stat file %s", path);
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_ > 0) {
+    // The writes, e.g. the parameters fused by the IR passes, go to private
+    // copies of the pages and never reach the file.
+    void* data =
+        mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    PADDLE_ENFORCE(data != MAP_FAILED, "Cannot map file %s", path);
+    data_ = static_cast<char*>(data);
+  }
+  // The mapping stays valid after the file is closed.
+  close(fd);
+#else
+  PADDLE_THROW("MappedFile is not supported on Windows");
+#endif  // !_WIN32
+}
+
+MappedFile::~MappedFile() {
+#if !defined(_WIN32)
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+#endif  // !_WIN32
+}
+
+bool IsMappableParamsFile(const std::string& path) {
+  std::ifstream fin(path, std::ios::in | std::ios::binary);
+  uint32_t magic = 0;
+  fin.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+  return static_cast<bool>(fin) && magic == kMappableParamsMagic;
+}
+
+void WriteMappableParamsHeader(std::ostream& os) {
+  os.write(reinterpret_cast<const char*>(&kMappableParamsMagic),
+           sizeof(kMappableParamsMagic));
+  os.write(reinterpret_cast<const char*>(&kMappableParamsVersion),
+           sizeof(kMappableParamsVersion));
+}
+
+size_t MappableParamsBegin(const MappedFile& file) {
+  PADDLE_ENFORCE_GE(file.size(), 2 * sizeof(uint32_t),
+                    "The mappable parameters file is truncated");
+  uint32_t magic, version;
+  std::memcpy(&magic, file.data(), sizeof(magic));
+  std::memcpy(&version, file.data() + sizeof(magic), sizeof(version));
+  PADDLE_ENFORCE_EQ(magic, kMappableParamsMagic,
+                    "The file is not a mappable parameters file");
+  PADDLE_ENFORCE_EQ(version, kMappableParamsVersion,
+                    "Only version 0 is supported");
+  return 2 * sizeof(uint32_t);
+}
+
+void SerializeToMappableStream(std::ostream& os, const LoDTensor& tensor,
+                               const platform::DeviceContext& dev_ctx) {
+  {  // the 1st field, uint32_t version for LoDTensor
+    os.write(reinterpret_cast<const char*>(&kCurTensorVersion),
+             sizeof(kCurTensorVersion));
+  }
+  {  // the 2nd field, LoD information, the same as SerializeToStream
+    auto lod = tensor.lod();
+    uint64_t size = lod.size();
+    os.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    for (auto& each : lod) {
+      size = each.size() * sizeof(framework::LoD::value_type::value_type);
+      os.write(reinterpret_cast<const char*>(&size), sizeof(size));
+      os.write(reinterpret_cast<const char*>(each.data()),
+               static_cast<std::streamsize>(size));
+    }
+  }
+  {  // the 3rd field, uint32_t version for Tensor
+    constexpr uint32_t version = 0;
+    os.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  }
+  {  // the 4th field, tensor description
+    proto::VarType::TensorDesc desc;
+    desc.set_data_type(framework::ToDataType(tensor.type()));
+    auto dims = framework::vectorize(tensor.dims());
+    auto* pb_dims = desc.mutable_dims();
+    pb_dims->Resize(static_cast<int>(dims.size()), 0);
+    std::copy(dims.begin(), dims.end(), pb_dims->begin());
+    int32_t size = desc.ByteSize();
+    os.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    auto out = desc.SerializeAsString();
+    os.write(out.data(), size);
+  }
+  {  // the 5th field, the padding and the aligned tensor data
+    size_t pos = static_cast<size_t>(os.tellp());
+    size_t padding = (kMappedTensorAlignment - pos % kMappedTensorAlignment) %
+                     kMappedTensorAlignment;
+    std::vector<char> zeros(padding, 0);
+    os.write(zeros.data(), padding);
+
+    Tensor cpu_tensor;
+    const Tensor* src = &tensor;
+    if (!platform::is_cpu_place(tensor.place())) {
+      TensorCopySync(tensor, platform::CPUPlace(), &cpu_tensor);
+      src = &cpu_tensor;
+    }
+    uint64_t size = src->numel() * framework::SizeOfType(src->type());
+    os.write(static_cast<const char*>(src->data<void>()),
+             static_cast<std::streamsize>(size));
+  }
+}
+
+size_t DeserializeFromMappedFile(const std::shared_ptr<MappedFile>& file,
+                                 size_t offset, LoDTensor* tensor) {
+  auto read = [&](void* dst, size_t size) {
+    PADDLE_ENFORCE_LE(offset + size, file->size(),
+                      "The mappable parameters file is truncated");
+    std::memcpy(dst, file->data() + offset, size);
+    offset += size;
+  };
+  {  // the 1st field, uint32_t version for LoDTensor
+    uint32_t version;
+    read(&version, sizeof(version));
+    PADDLE_ENFORCE(framework::IsTensorVersionSupported(version),
+                   "tensor version %u is not supported.", version);
+  }
+  {  // the 2nd field, LoD information
+    uint64_t lod_level;
+    read(&lod_level, sizeof(lod_level));
+    auto& lod = *tensor->mutable_lod();
+    lod.resize(lod_level);
+    for (uint64_t i = 0; i < lod_level; ++i) {
+      uint64_t size;
+      read(&size, sizeof(size));
+      std::vector<size_t> tmp(size / sizeof(size_t));
+      read(tmp.data(), size);
+      lod[i] = tmp;
+    }
+  }
+  {  // the 3rd field, uint32_t version for Tensor
+    uint32_t version;
+    read(&version, sizeof(version));
+    PADDLE_ENFORCE_EQ(version, 0U, "Only version 0 is supported");
+  }
+  proto::VarType::TensorDesc desc;
+  {  // the 4th field, tensor description
+    int32_t size;
+    read(&size, sizeof(size));
+    std::vector<char> buf(size);
+    read(buf.data(), size);
+    PADDLE_ENFORCE(desc.ParseFromArray(buf.data(), size),
+                   "Cannot parse tensor desc");
+  }
+  {  // the 5th field, the padding and the aligned tensor data
+    offset += (kMappedTensorAlignment - offset % kMappedTensorAlignment) %
+              kMappedTensorAlignment;
+    std::vector<int64_t> dims(desc.dims().begin(), desc.dims().end());
+    tensor->Resize(framework::make_ddim(dims));
+    auto type = framework::ToTypeIndex(desc.data_type());
+    size_t size = tensor->numel() * framework::SizeOfType(type);
+    PADDLE_ENFORCE_LE(offset + size, file->size(),
+                      "The mappable parameters file is truncated");
+    tensor->ShareExternalData(file->data() + offset, size, type, file);
+    offset += size;
+  }
+  return offset;
+}
+
+}  // namespace framework
+}  // namespace paddle
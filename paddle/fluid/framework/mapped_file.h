@@ -0,0 +1,78 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * @brief A file mapped into memory. The mapping is private, the pages are
+ * shared with the page cache, and by all the processes mapping the same
+ * file, until they are written.
+ */
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+
+  char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  char* data_;
+  size_t size_;
+
+  DISABLE_COPY_AND_ASSIGN(MappedFile);
+};
+
+/*
+ * The combined parameters file whose tensor data can be mapped.
+ *
+ * The file starts with a magic number and a version, followed by the
+ * LoDTensors in the format of SerializeToStream, except that zeros are
+ * padded before the data of every tensor to align it to
+ * kMappedTensorAlignment bytes from the beginning of the file.
+ */
+constexpr size_t kMappedTensorAlignment = 4096;
+
+// Whether the file at path is a mappable parameters file.
+bool IsMappableParamsFile(const std::string& path);
+
+void WriteMappableParamsHeader(std::ostream& os);
+
+void SerializeToMappableStream(std::ostream& os, const LoDTensor& tensor,
+                               const platform::DeviceContext& dev_ctx);
+
+/*
+ * @brief Deserialize the tensor at offset of the mappable parameters file,
+ * the data of the tensor references the mapped memory directly.
+ *
+ * @return the offset of the next tensor.
+ */
+size_t DeserializeFromMappedFile(const std::shared_ptr<MappedFile>& file,
+                                 size_t offset, LoDTensor* tensor);
+
+// The offset of the first tensor in the mappable parameters file.
+size_t MappableParamsBegin(const MappedFile& file);
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,163 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/memory_plan.h"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_set>
+#include "paddle/fluid/framework/op_info.h"
+
+namespace paddle {
+namespace framework {
+
+constexpr size_t MemoryPlan::kAlignment;
+
+namespace {
+
+// The tensors that share one block of the arena.
+struct Interval {
+  int begin;
+  int end;
+  size_t size;
+  size_t offset;
+  std::vector<std::string> names;
+};
+
+size_t AlignedSize(size_t size) {
+  return (size + MemoryPlan::kAlignment - 1) / MemoryPlan::kAlignment *
+         MemoryPlan::kAlignment;
+}
+
+bool Overlap(const Interval& a, const Interval& b) {
+  return a.begin <= b.end && b.begin <= a.end;
+}
+
+}  // namespace
+
+void MemoryPlan::Build(const std::vector<MemoryPlanOp>& ops,
+                       const std::unordered_map<std::string, size_t>& sizes) {
+  blocks_.clear();
+  arena_size_ = 0;
+  total_size_ = 0;
+
+  std::unordered_map<std::string, int> last_use;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    for (auto* names : {&ops[i].inputs, &ops[i].outputs}) {
+      for (auto& name : *names) {
+        if (sizes.count(name)) last_use[name] = static_cast<int>(i);
+      }
+    }
+  }
+
+  std::vector<Interval> intervals;
+  std::unordered_map<std::string, size_t> interval_of;
+  auto add_interval = [&](const std::string& name, int begin) {
+    interval_of[name] = intervals.size();
+    intervals.push_back(
+        {begin, last_use[name], AlignedSize(sizes.at(name)), 0, {name}});
+  };
+
+  for (size_t i = 0; i < ops.size(); ++i) {
+    auto& op = ops[i];
+    int idx = static_cast<int>(i);
+    for (auto& name : op.inputs) {
+      // A tensor read before it is written is alive from the beginning.
+      if (sizes.count(name) && !interval_of.count(name)) {
+        add_interval(name, 0);
+      }
+    }
+
+    std::unordered_set<std::string> reused;
+    for (auto& pair : op.inplace) {
+      auto& in = pair.first;
+      auto& out = pair.second;
+      if (!sizes.count(in) || !sizes.count(out) || interval_of.count(out) ||
+          reused.count(in) ||
+          std::find(op.inputs.begin(), op.inputs.end(), out) !=
+              op.inputs.end()) {
+        continue;
+      }
+      auto& interval = intervals[interval_of.at(in)];
+      if (op.share_data) {
+        interval.end = std::max(interval.end, last_use[out]);
+        interval.size = std::max(interval.size, AlignedSize(sizes.at(out)));
+        interval.names.push_back(out);
+        interval_of[out] = interval_of.at(in);
+        continue;
+      }
+      if (interval.end != idx || AlignedSize(sizes.at(out)) > interval.size) {
+        continue;
+      }
+      interval.end = last_use[out];
+      interval.names.push_back(out);
+      interval_of[out] = interval_of.at(in);
+      reused.insert(in);
+    }
+
+    for (auto& name : op.outputs) {
+      if (sizes.count(name) && !interval_of.count(name)) {
+        add_interval(name, idx);
+      }
+    }
+  }
+
+  std::vector<size_t> order(intervals.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return intervals[a].size > intervals[b].size;
+  });
+
+  std::vector<size_t> placed;
+  for (auto i : order) {
+    auto& interval = intervals[i];
+    std::vector<std::pair<size_t, size_t>> used;
+    for (auto j : placed) {
+      if (Overlap(interval, intervals[j])) {
+        used.emplace_back(intervals[j].offset,
+                          intervals[j].offset + intervals[j].size);
+      }
+    }
+    std::sort(used.begin(), used.end());
+    size_t offset = 0;
+    for (auto& range : used) {
+      if (range.first >= offset + interval.size) break;
+      offset = std::max(offset, range.second);
+    }
+    interval.offset = offset;
+    arena_size_ = std::max(arena_size_, offset + interval.size);
+    placed.push_back(i);
+  }
+
+  for (auto& interval : intervals) {
+    for (auto& name : interval.names) {
+      blocks_[name] = Block{interval.offset, interval.size};
+      total_size_ += AlignedSize(sizes.at(name));
+    }
+  }
+}
+
+InplacePairs MemoryPlan::InplaceSlots(const std::string& op_type) {
+  auto* info = OpInfoMap::Instance().GetNullable(op_type);
+  if (info == nullptr || !info->infer_inplace_) return {};
+  return info->infer_inplace_();
+}
+
+bool MemoryPlan::SharesData(const std::string& op_type) {
+  auto* info = OpInfoMap::Instance().GetNullable(op_type);
+  return info != nullptr && info->share_data_;
+}
+
+}  // namespace framework
+}  // namespace paddle
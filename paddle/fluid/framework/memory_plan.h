@@ -0,0 +1,93 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/type_defs.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * The variables an operator reads and writes, in the order of execution.
+ * The inplace pairs are (input, output) that the operator may compute in
+ * the same memory, see MemoryPlan::InplaceSlots. With share_data, the
+ * outputs of the pairs are views of the inputs, which always share the
+ * memory, share_data is false when it is omitted in the braces.
+ */
+struct MemoryPlanOp {
+  std::vector<std::string> inputs;
+  std::vector<std::string> outputs;
+  std::vector<std::pair<std::string, std::string>> inplace;
+  bool share_data;
+};
+
+/*
+ * A static memory plan of the intermediate tensors of a sequence of
+ * operators. The lifetime of a tensor is the range between the first
+ * operator that writes it and the last operator that uses it. Every tensor
+ * is given an offset in one arena, so that the tensors whose lifetimes
+ * overlap do not overlap in the arena. The offsets are assigned greedily
+ * from the biggest tensor, each at the lowest gap that fits between the
+ * tensors already placed and alive at the same time.
+ *
+ * The output of an in-place capable operator reuses the block of an input
+ * which dies at the operator. A view shares the block of its input, which
+ * lives until both of them die.
+ */
+class MemoryPlan {
+ public:
+  static constexpr size_t kAlignment = 64;
+
+  struct Block {
+    size_t offset;
+    size_t size;
+  };
+
+  // Plan the tensors in sizes, which maps a variable to its bytes. The
+  // variables that are not in sizes are not planned.
+  void Build(const std::vector<MemoryPlanOp>& ops,
+             const std::unordered_map<std::string, size_t>& sizes);
+
+  bool Has(const std::string& name) const { return blocks_.count(name) != 0; }
+  const Block& Get(const std::string& name) const { return blocks_.at(name); }
+  const std::unordered_map<std::string, Block>& blocks() const {
+    return blocks_;
+  }
+
+  // The bytes of the arena.
+  size_t arena_size() const { return arena_size_; }
+  // The bytes of all the planned tensors, without any sharing.
+  size_t total_size() const { return total_size_; }
+
+  // The (input slot, output slot) pairs of an operator type that could be
+  // computed in place, declared by its InplaceOpInference.
+  static InplacePairs InplaceSlots(const std::string& op_type);
+
+  // Whether the outputs of the inplace pairs of an operator type are views
+  // of the inputs, declared by a ShareDataOpInference.
+  static bool SharesData(const std::string& op_type);
+
+ private:
+  std::unordered_map<std::string, Block> blocks_;
+  size_t arena_size_{0};
+  size_t total_size_{0};
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,110 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/memory_plan.h"
+#include <gtest/gtest.h>
+
+namespace paddle {
+namespace framework {
+
+static constexpr size_t kAlign = MemoryPlan::kAlignment;
+
+static bool Disjoint(const MemoryPlan::Block& a, const MemoryPlan::Block& b) {
+  return a.offset + a.size <= b.offset || b.offset + b.size <= a.offset;
+}
+
+TEST(MemoryPlan, Chain) {
+  // x -> a -> b -> c -> y, every tensor only lives across two ops.
+  std::vector<MemoryPlanOp> ops = {
+      {{"x"}, {"a"}, {}},
+      {{"a"}, {"b"}, {}},
+      {{"b"}, {"c"}, {}},
+      {{"c"}, {"y"}, {}},
+  };
+  MemoryPlan plan;
+  plan.Build(ops, {{"a", kAlign}, {"b", kAlign}, {"c", kAlign}});
+  EXPECT_EQ(plan.total_size(), 3 * kAlign);
+  // a and c do not live at the same time.
+  EXPECT_EQ(plan.arena_size(), 2 * kAlign);
+  EXPECT_TRUE(Disjoint(plan.Get("a"), plan.Get("b")));
+  EXPECT_TRUE(Disjoint(plan.Get("b"), plan.Get("c")));
+  EXPECT_EQ(plan.Get("a").offset, plan.Get("c").offset);
+  EXPECT_FALSE(plan.Has("x"));
+}
+
+TEST(MemoryPlan, Inplace) {
+  std::vector<MemoryPlanOp> ops = {
+      {{"x"}, {"a"}, {}},
+      {{"a"}, {"b"}, {{"a", "b"}}},
+      {{"b"}, {"c"}, {{"b", "c"}}},
+      {{"c"}, {"y"}, {}},
+  };
+  MemoryPlan plan;
+  plan.Build(ops, {{"a", 100}, {"b", 100}, {"c", 10}});
+  EXPECT_EQ(plan.arena_size(), 2 * kAlign);
+  EXPECT_EQ(plan.Get("a").offset, plan.Get("b").offset);
+  EXPECT_EQ(plan.Get("b").offset, plan.Get("c").offset);
+}
+
+TEST(MemoryPlan, InplaceNeedsDeadInput) {
+  // a is still read after b is computed, it can not be overwritten.
+  std::vector<MemoryPlanOp> ops = {
+      {{"x"}, {"a"}, {}},
+      {{"a"}, {"b"}, {{"a", "b"}}},
+      {{"a", "b"}, {"y"}, {}},
+  };
+  MemoryPlan plan;
+  plan.Build(ops, {{"a", kAlign}, {"b", kAlign}});
+  EXPECT_EQ(plan.arena_size(), 2 * kAlign);
+  EXPECT_TRUE(Disjoint(plan.Get("a"), plan.Get("b")));
+}
+
+TEST(MemoryPlan, ShareData) {
+  // v is a view of a, which is read after v is made, and c is computed after
+  // a dies, while v is still alive.
+  std::vector<MemoryPlanOp> ops = {
+      {{"x"}, {"a"}, {}},
+      {{"a"}, {"v"}, {{"a", "v"}}, true},
+      {{"a"}, {"b"}, {}},
+      {{"b"}, {"c"}, {}},
+      {{"c", "v"}, {"y"}, {}},
+  };
+  MemoryPlan plan;
+  plan.Build(ops, {{"a", kAlign}, {"v", kAlign}, {"b", kAlign}, {"c", kAlign}});
+  EXPECT_EQ(plan.Get("a").offset, plan.Get("v").offset);
+  EXPECT_TRUE(Disjoint(plan.Get("v"), plan.Get("c")));
+  EXPECT_TRUE(Disjoint(plan.Get("a"), plan.Get("b")));
+  EXPECT_EQ(plan.arena_size(), 3 * kAlign);
+}
+
+TEST(MemoryPlan, FirstFit) {
+  // big lives in [0, 1], small in [1, 2] and mid in [2, 3]; mid reuses the
+  // block of big, which is dead at op 2.
+  std::vector<MemoryPlanOp> ops = {
+      {{"x"}, {"big"}, {}},
+      {{"big"}, {"small"}, {}},
+      {{"small"}, {"mid"}, {}},
+      {{"mid"}, {"y"}, {}},
+  };
+  MemoryPlan plan;
+  plan.Build(ops,
+             {{"big", 4 * kAlign}, {"small", kAlign}, {"mid", 2 * kAlign}});
+  EXPECT_EQ(plan.arena_size(), 5 * kAlign);
+  EXPECT_EQ(plan.Get("big").offset, 0UL);
+  EXPECT_EQ(plan.Get("small").offset, 4 * kAlign);
+  EXPECT_EQ(plan.Get("mid").offset, 0UL);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cstring>
 #include <initializer_list>
 #include <memory>
 #include <mutex>  // NOLINT
@@ -24,6 +25,7 @@
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/platform/gpu_info.h"
 
 #include "glog/logging.h"
 
@@ -69,6 +71,127 @@ struct CUDABuffer {
     }
   }
 };
+
+// The stream of the device context of place, which is the stream of the op
+// when it runs under a ScopedDeviceContextOverride.
+inline cudaStream_t CurrentStream(const platform::CUDAPlace &place) {
+  return static_cast<platform::CUDADeviceContext *>(
+             platform::DeviceContextPool::Instance().Get(place))
+      ->stream();
+}
+
+// The copy of the data of a Vector on a device. The data is uploaded from a
+// pinned staging buffer, so that the copy is asynchronous on the stream of
+// the device. version_ is the version of the data it holds.
+//
+// With several compute streams, stream_ is the stream the copy was last
+// uploaded or written on. The readers on the other streams wait for it in
+// Acquire, and an upload or a write waits for the readers in Release, so
+// that buffer_ is not overwritten while it is read.
+struct CUDACopy {
+  CUDABuffer buffer_;
+  void *staging_{nullptr};
+  size_t staging_size_{0};
+  cudaEvent_t uploaded_{nullptr};
+  size_t version_{0};
+  cudaStream_t stream_{nullptr};
+
+  CUDACopy() {}
+  ~CUDACopy() {
+    WaitUploaded();
+    for (auto reader : readers_) {
+      PADDLE_ENFORCE(cudaEventRecord(sync_, reader));
+      PADDLE_ENFORCE(cudaEventSynchronize(sync_));
+    }
+    if (staging_ != nullptr) {
+      memory::Free(platform::CUDAPinnedPlace(), staging_);
+    }
+    if (uploaded_ != nullptr) {
+      cudaEventDestroy(uploaded_);
+    }
+    if (sync_ != nullptr) {
+      cudaEventDestroy(sync_);
+    }
+  }
+
+  CUDACopy(const CUDACopy &o) = delete;
+  CUDACopy &operator=(const CUDACopy &o) = delete;
+
+  // Upload size bytes of src to the buffer, which grows if it is too small.
+  void Upload(const platform::CUDAPlace &place, const void *src, size_t size) {
+    int prev_id = platform::GetCurrentDeviceId();
+    platform::SetDeviceId(place.device);
+    if (sync_ == nullptr) {
+      PADDLE_ENFORCE(cudaEventCreateWithFlags(&sync_, cudaEventDisableTiming));
+    }
+    auto stream = CurrentStream(place);
+    Release(stream);
+    if (buffer_.data_ == nullptr || buffer_.size_ < size) {
+      buffer_.Resize(place, size);
+    }
+    if (size > 0) {
+      // The staging buffer is reused after the last upload from it is done.
+      WaitUploaded();
+      if (staging_size_ < size) {
+        if (staging_ != nullptr) {
+          memory::Free(platform::CUDAPinnedPlace(), staging_);
+        }
+        staging_ = memory::Alloc(platform::CUDAPinnedPlace(), size);
+        PADDLE_ENFORCE_NOT_NULL(staging_);
+        staging_size_ = size;
+      }
+      if (uploaded_ == nullptr) {
+        PADDLE_ENFORCE(
+            cudaEventCreateWithFlags(&uploaded_, cudaEventDisableTiming));
+      }
+      std::memcpy(staging_, src, size);
+      memory::Copy(place, buffer_.data_, platform::CUDAPinnedPlace(),
+                   staging_, size, stream);
+      PADDLE_ENFORCE(cudaEventRecord(uploaded_, stream));
+    }
+    platform::SetDeviceId(prev_id);
+  }
+
+  // Make the work issued to stream from now on see the data of the copy.
+  void Acquire(cudaStream_t stream) {
+    if (stream == stream_) return;
+    Order(stream_, stream);
+    if (std::find(readers_.begin(), readers_.end(), stream) ==
+        readers_.end()) {
+      readers_.push_back(stream);
+    }
+  }
+
+  // Make the work issued to stream from now on wait for the readers and the
+  // last writer of the copy, before stream overwrites it.
+  void Release(cudaStream_t stream) {
+    for (auto reader : readers_) {
+      if (reader != stream) Order(reader, stream);
+    }
+    readers_.clear();
+    if (stream_ != nullptr && stream_ != stream) Order(stream_, stream);
+    stream_ = stream;
+  }
+
+ private:
+  void WaitUploaded() const {
+    if (uploaded_ != nullptr) {
+      PADDLE_ENFORCE(cudaEventSynchronize(uploaded_));
+    }
+  }
+
+  // Make the work issued to to from now on wait for the work issued to from
+  // so far.
+  void Order(cudaStream_t from, cudaStream_t to) {
+    PADDLE_ENFORCE(cudaEventRecord(sync_, from));
+    PADDLE_ENFORCE(cudaStreamWaitEvent(to, sync_, 0));
+  }
+
+  // The streams other than stream_ which have read the copy since it was
+  // last uploaded or written.
+  std::vector<cudaStream_t> readers_;
+  cudaEvent_t sync_{nullptr};
+};
 }  // namespace details
 
 // Vector<T> implements the std::vector interface, and can get Data or
@@ -84,27 +207,24 @@ class Vector {
   // The actual class to implement vector logic
   class VectorData {
    public:
-    VectorData() : flag_(kDataInCPU) {}
-    VectorData(size_t count, const T &value)
-        : cpu_(count, value), flag_(kDataInCPU) {}
-    VectorData(std::initializer_list<T> init) : cpu_(init), flag_(kDataInCPU) {}
+    VectorData() {}
+    VectorData(size_t count, const T &value) : cpu_(count, value) {}
+    VectorData(std::initializer_list<T> init) : cpu_(init) {}
     template <typename U>
-    explicit VectorData(const std::vector<U> &dat)
-        : cpu_(dat), flag_(kDataInCPU) {}
+    explicit VectorData(const std::vector<U> &dat) : cpu_(dat) {}
     ~VectorData() {}
 
     VectorData(const VectorData &o) {
       o.ImmutableCPU();
       cpu_ = o.cpu_;
-      flag_ = kDataInCPU;
     }
 
     VectorData &operator=(const VectorData &o) {
       o.ImmutableCPU();
       cpu_ = o.cpu_;
-      flag_ = kDataInCPU;
-      details::CUDABuffer null;
-      gpu_.Swap(null);
+      ++version_;
+      cuda_dirty_device_ = -1;
+      gpu_.clear();
       return *this;
     }
 
@@ -198,21 +318,27 @@ class Vector {
     const T *CUDAData(platform::Place place) const {
       PADDLE_ENFORCE(platform::is_gpu_place(place),
                      "CUDA Data must on CUDA place");
-      ImmutableCUDA(place);
-      return reinterpret_cast<T *>(gpu_.data_);
+      return reinterpret_cast<T *>(ImmutableCUDA(place)->buffer_.data_);
     }
 
     // get cuda ptr. mutable
     T *CUDAMutableData(platform::Place place) {
       const T *ptr = CUDAData(place);
-      flag_ = kDirty | kDataInCUDA;
+      // The copy on the device becomes the only latest one.
+      ++version_;
+      auto &cuda_place = boost::get<platform::CUDAPlace>(place);
+      cuda_dirty_device_ = cuda_place.device;
+      auto &copy = gpu_[cuda_dirty_device_];
+      copy->version_ = version_;
+      copy->Release(details::CurrentStream(cuda_place));
       return const_cast<T *>(ptr);
     }
 
     // clear
     void clear() {
       cpu_.clear();
-      flag_ = kDirty | kDataInCPU;
+      ++version_;
+      cuda_dirty_device_ = -1;
     }
 
     size_t capacity() const { return cpu_.capacity(); }
@@ -234,103 +360,64 @@ class Vector {
 
     std::mutex &Mutex() const { return mtx_; }
 
-    std::unique_ptr<platform::CUDAPlace> CUDAPlace() const {
-      if (gpu_.data_ == nullptr) {
-        return nullptr;
-      } else {
-        return std::unique_ptr<platform::CUDAPlace>(
-            new platform::CUDAPlace(gpu_.place_));
-      }
-    }
-
    private:
-    enum DataFlag {
-      kDataInCPU = 0x01,
-      kDataInCUDA = 0x02,
-      // kDirty means the data has been changed in one device.
-      kDirty = 0x10
-    };
-
     void CopyToCPU() const {
-      // COPY GPU Data To CPU
-      auto *dev_ctx = static_cast<platform::CUDADeviceContext *>(
-          platform::DeviceContextPool::Instance().Get(
-              platform::Place(gpu_.place_)));
-      auto stream = dev_ctx->stream();
-      void *src = gpu_.data_;
+      // COPY GPU Data To CPU, on the stream it was written on
+      auto &copy = gpu_[cuda_dirty_device_];
+      auto &gpu = copy->buffer_;
+      void *src = gpu.data_;
       void *dst = cpu_.data();
-      memory::Copy(platform::CPUPlace(), dst, gpu_.place_, src, gpu_.size_,
-                   stream);
-      dev_ctx->Wait();
+      memory::Copy(platform::CPUPlace(), dst, gpu.place_, src,
+                   cpu_.size() * sizeof(T), copy->stream_);
+      PADDLE_ENFORCE(cudaStreamSynchronize(copy->stream_));
     }
 
     void MutableCPU() {
-      if (IsInCUDA() && IsDirty()) {
-        CopyToCPU();
+      ImmutableCPU();
+      // The copies on the devices are out of date.
+      ++version_;
+    }
+
+    // Return the copy of the latest data on the device of place. It is only
+    // uploaded if the data has changed since the copy was uploaded, and the
+    // copies on the other devices are kept, so the same data used on several
+    // devices is not uploaded again.
+    details::CUDACopy *ImmutableCUDA(platform::Place place) const {
+      auto &cuda_place = boost::get<platform::CUDAPlace>(place);
+      int dev_id = cuda_place.device;
+      if (gpu_.size() <= static_cast<size_t>(dev_id)) {
+        gpu_.resize(dev_id + 1);
       }
-      flag_ = kDirty | kDataInCPU;
-    }
-
-    void ImmutableCUDA(platform::Place place) const {
-      if (IsDirty()) {
-        if (IsInCPU()) {
-          CopyCPUDataToCUDA(place);
-          UnsetFlag(kDirty);
-          SetFlag(kDataInCUDA);
-        } else if (IsInCUDA() &&
-                   !(boost::get<platform::CUDAPlace>(place) == gpu_.place_)) {
-          PADDLE_THROW("This situation should not happen");
-          // Still dirty
-        } else {
-          // Dirty && DataInCUDA && Device is same
-          // Do nothing
-        }
-      } else {
-        if (!IsInCUDA()) {
-          // Even data is not dirty. However, data is not in CUDA. Copy data.
-          CopyCPUDataToCUDA(place);
-          SetFlag(kDataInCUDA);
-        } else if (!(boost::get<platform::CUDAPlace>(place) == gpu_.place_)) {
-          PADDLE_THROW("This situation should not happen.");
-        } else {
-          // Not Dirty && DataInCUDA && Device is same
-          // Do nothing.
-        }
+      auto &copy = gpu_[dev_id];
+      if (copy != nullptr && copy->version_ == version_) {
+        copy->Acquire(details::CurrentStream(cuda_place));
+        return copy.get();
       }
-    }
-
-    void CopyCPUDataToCUDA(const platform::Place &place) const {
-      void *src = cpu_.data();
-      gpu_.Resize(place, cpu_.size() * sizeof(T));
-      void *dst = gpu_.data_;
-      auto *dev_ctx = static_cast<platform::CUDADeviceContext *>(
-          platform::DeviceContextPool::Instance().Get(place));
-      auto stream = dev_ctx->stream();
-      memory::Copy(gpu_.place_, dst, platform::CPUPlace(), src, gpu_.size_,
-                   stream);
+      // The latest data is on another device, sync it by the CPU.
+      ImmutableCPU();
+      if (copy == nullptr) {
+        copy.reset(new details::CUDACopy);
+      }
+      copy->Upload(cuda_place, cpu_.data(), cpu_.size() * sizeof(T));
+      copy->version_ = version_;
+      return copy.get();
     }
 
     void ImmutableCPU() const {
-      if (IsDirty() && !IsInCPU()) {  // If data has been changed in CUDA, or
-                                      // CPU has no data.
+      // If data has been changed in CUDA.
+      if (cuda_dirty_device_ >= 0) {
         CopyToCPU();
-        UnsetFlag(kDirty);
+        cuda_dirty_device_ = -1;
       }
-      SetFlag(kDataInCPU);
     }
 
-    void UnsetFlag(int flag) const { flag_ &= ~flag; }
-    void SetFlag(int flag) const { flag_ |= flag; }
-
-    bool IsDirty() const { return flag_ & kDirty; }
-
-    bool IsInCUDA() const { return flag_ & kDataInCUDA; }
-
-    bool IsInCPU() const { return flag_ & kDataInCPU; }
-
     mutable std::vector<T> cpu_;
-    mutable details::CUDABuffer gpu_;
-    mutable int flag_;
+    // The copies on the devices, indexed by the device id.
+    mutable std::vector<std::unique_ptr<details::CUDACopy>> gpu_;
+    // The version of the latest data, which is increased by every change.
+    mutable size_t version_{1};
+    // The device whose copy is newer than cpu_ if it is not -1.
+    mutable int cuda_dirty_device_{-1};
 
     mutable std::mutex mtx_;
   };
@@ -423,35 +510,19 @@ class Vector {
   }
 
   // get cuda ptr. immutable
+  // The data is shared by the copies of the Vector, e.g. the LoD shared by
+  // the sequence ops, and so are the copies of it on the devices.
   const T *CUDAData(platform::Place place) const {
-    {
-      auto &mtx = m_.Data().Mutex();
-      std::lock_guard<std::mutex> guard(mtx);
-      auto cuda_place = m_.Data().CUDAPlace();
-      if (cuda_place == nullptr ||
-          *cuda_place == boost::get<platform::CUDAPlace>(place)) {
-        return m_.Data().CUDAData(place);
-      }
-    }
-    // If m_ contains CUDAData in a different place. Detach manually.
-    m_.Detach();
-    return CUDAData(place);
+    auto &mtx = m_.Data().Mutex();
+    std::lock_guard<std::mutex> guard(mtx);
+    return m_.Data().CUDAData(place);
   }
 
   // get cuda ptr. mutable
   T *CUDAMutableData(platform::Place place) {
-    {
-      auto &mtx = m_.Data().Mutex();
-      std::lock_guard<std::mutex> guard(mtx);
-      auto cuda_place = m_.Data().CUDAPlace();
-      if (cuda_place == nullptr ||
-          *cuda_place == boost::get<platform::CUDAPlace>(place)) {
-        return m_.MutableData()->CUDAMutableData(place);
-      }
-    }
-    // If m_ contains CUDAData in a different place. Detach manually.
-    m_.Detach();
-    return CUDAMutableData(place);
+    auto *data = m_.MutableData();
+    std::lock_guard<std::mutex> guard(data->Mutex());
+    return data->CUDAMutableData(place);
   }
 
   // clear
@@ -73,3 +73,26 @@ TEST(mixed_vector, MultiGPU) {
     ASSERT_EQ(tmp[i], i * 100);
   }
 }
+
+TEST(mixed_vector, CUDACache) {
+  vec<int> tmp;
+  for (int i = 0; i < 10; ++i) {
+    tmp.push_back(i);
+  }
+  paddle::platform::CUDAPlace gpu(0);
+
+  // The copies of a Vector share the data on the device.
+  const vec<int>& const_tmp = tmp;
+  const int* gpu_ptr = const_tmp.CUDAData(gpu);
+  vec<int> shared = tmp;
+  const vec<int>& const_shared = shared;
+  ASSERT_EQ(const_shared.CUDAData(gpu), gpu_ptr);
+
+  // Changing the data on the CPU uploads it again.
+  multiply_10<<<1, 1, 0, GetCUDAStream(gpu)>>>(tmp.MutableData(gpu));
+  ASSERT_EQ(tmp[1], 10);
+  tmp[1] = -1;
+  multiply_10<<<1, 1, 0, GetCUDAStream(gpu)>>>(tmp.MutableData(gpu));
+  ASSERT_EQ(tmp[1], -10);
+  ASSERT_EQ(tmp[2], 200);
+}
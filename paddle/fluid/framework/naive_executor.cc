@@ -12,15 +12,25 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/feed_fetch_method.h"
 #include "paddle/fluid/framework/lod_rank_table.h"
 #include "paddle/fluid/framework/lod_tensor_array.h"
 #include "paddle/fluid/framework/naive_executor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/reader.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/fluid/platform/cuda_graph.h"
+#include "paddle/fluid/platform/sampling_profiler.h"
 #include "paddle/fluid/string/pretty_log.h"
 
 namespace paddle {
@@ -57,6 +67,79 @@ static void InitializeVariable(Variable *var, proto::VarType::Type var_type) {
   }
 }
 
+// The shape and the memory of a tensor that the kernels captured in a CUDA
+// graph are launched with.
+struct CUDAGraphTensor {
+  DDim dims;
+  LoD lod;
+  const void *data{nullptr};
+
+  bool operator==(const CUDAGraphTensor &o) const {
+    return data == o.data && dims == o.dims && lod == o.lod;
+  }
+};
+
+struct NaiveExecutor::CUDAGraphState {
+  int warmup_runs{0};
+  // The runs in a row with the same tensors.
+  int steady_runs{0};
+  // The capture failed, e.g. an operator synchronizes the stream.
+  bool disabled{false};
+  // The variables of the operators, and their tensors at the last run.
+  std::vector<Variable *> vars;
+  std::vector<CUDAGraphTensor> tensors;
+#ifdef PADDLE_WITH_CUDA
+  std::unique_ptr<platform::CUDAGraph> graph;
+  // The memory freed during the capture, which the graph replays on.
+  std::vector<std::pair<platform::CUDAPlace, void *>> memory;
+#endif
+
+  void CollectVars(const std::vector<std::unique_ptr<RuntimeContext>> &ctxs) {
+    std::unordered_set<Variable *> seen;
+    vars.clear();
+    for (auto &ctx : ctxs) {
+      if (ctx == nullptr) continue;
+      for (auto *slots : {&ctx->inputs, &ctx->outputs}) {
+        for (auto &slot : *slots) {
+          for (auto *var : slot.second) {
+            if (var != nullptr && seen.insert(var).second) vars.push_back(var);
+          }
+        }
+      }
+    }
+    tensors.clear();
+    steady_runs = 0;
+  }
+
+  // The tensors of vars, false if some of them can not be captured.
+  bool Collect(const platform::Place &place,
+               std::vector<CUDAGraphTensor> *result) const {
+    bool capturable = true;
+    result->resize(vars.size());
+    for (size_t i = 0; i < vars.size(); ++i) {
+      auto &item = (*result)[i];
+      if (!vars[i]->IsType<LoDTensor>()) {
+        capturable = false;
+        continue;
+      }
+      auto &tensor = vars[i]->Get<LoDTensor>();
+      item.dims = tensor.dims();
+      item.lod = tensor.lod();
+      if (tensor.IsInitialized()) {
+        item.data = tensor.data<void>();
+        if (!(tensor.place() == place)) capturable = false;
+      }
+    }
+    return capturable;
+  }
+};
+
+NaiveExecutor::NaiveExecutor(const platform::Place &place) : place_(place) {}
+
+NaiveExecutor::~NaiveExecutor() {
+  if (cuda_graph_) DiscardCUDAGraph();
+}
+
 void NaiveExecutor::Prepare(Scope *parent_scope,
                             const ProgramDesc &program_desc, int block_id,
                             bool with_feed_fetch_ops) {
@@ -67,13 +150,440 @@ void NaiveExecutor::Prepare(Scope *parent_scope,
   }
   CreateVariables(program_desc, scope_, block_id);
   CreateOps(program_desc, block_id, with_feed_fetch_ops);
+  CreateRuntimeContexts();
+}
+
+void NaiveExecutor::PrepareShared(Scope *parent_scope,
+                                  const ProgramDesc &program_desc,
+                                  int block_id, const NaiveExecutor &other) {
+  PADDLE_ENFORCE_NOT_NULL(parent_scope,
+                          "The shared executor needs the persistable "
+                          "variables in the parent scope");
+  scope_ = &parent_scope->NewScope();
+  CreateLocalVariables(program_desc, scope_, block_id);
+  ops_ = other.ops_;
+  CreateRuntimeContexts();
 }
 
 void NaiveExecutor::Run() {
-  for (auto &op : ops_) {
-    VLOG(4) << "run " << op->Type();
-    op->Run(*scope_, place_);
+  platform::SampledIteration sampled_iteration;
+  if (cuda_graph_ && RunCUDAGraph()) return;
+  RunOps();
+  if (memory_plan_pending_) {
+    BuildMemoryPlan();
+  }
+}
+
+void NaiveExecutor::RunOps() {
+  auto *infer_shape_cache = infer_shape_cache_.get();
+  if (infer_shape_cache) {
+    infer_shape_cache->BeginRun(*scope_);
+  }
+  auto &ops = *ops_;
+  if (parallel_runner_) {
+    parallel_runner_->Run([&](size_t i) {
+      VLOG(4) << "run " << ops[i]->Type();
+      InferShapeCache::OpGuard guard(infer_shape_cache, i);
+      ops[i]->Run(*scope_, place_, runtime_ctxs_[i].get());
+    });
+  } else {
+    for (size_t i = 0; i < ops.size(); ++i) {
+      VLOG(4) << "run " << ops[i]->Type();
+      InferShapeCache::OpGuard guard(infer_shape_cache, i);
+      ops[i]->Run(*scope_, place_, runtime_ctxs_[i].get());
+    }
+  }
+  if (infer_shape_cache) {
+    infer_shape_cache->EndRun();
+  }
+}
+
+void NaiveExecutor::EnableCUDAGraph(int warmup_runs) {
+  PADDLE_ENFORCE(platform::is_gpu_place(place_),
+                 "The CUDA graph only supports CUDAPlace.");
+  if (cuda_graph_) DiscardCUDAGraph();
+  cuda_graph_.reset();
+#ifdef PADDLE_WITH_CUDA
+  if (!platform::CUDAGraph::IsSupported()) {
+    LOG(WARNING) << "The CUDA graph needs CUDA 10.1 or later.";
+    return;
+  }
+  for (auto &op : *ops_) {
+    if (dynamic_cast<OperatorWithKernel *>(op.get()) == nullptr) {
+      LOG(WARNING) << "The operator " << op->Type()
+                   << " has no kernel, the CUDA graph is disabled.";
+      return;
+    }
+  }
+  cuda_graph_.reset(new CUDAGraphState);
+  cuda_graph_->warmup_runs = std::max(warmup_runs, 0);
+  cuda_graph_->CollectVars(runtime_ctxs_);
+#endif
+}
+
+bool NaiveExecutor::cuda_graph_captured() const {
+#ifdef PADDLE_WITH_CUDA
+  return cuda_graph_ && cuda_graph_->graph != nullptr;
+#else
+  return false;
+#endif
+}
+
+bool NaiveExecutor::RunCUDAGraph() {
+#ifdef PADDLE_WITH_CUDA
+  auto &state = *cuda_graph_;
+  if (state.disabled) return false;
+  std::vector<CUDAGraphTensor> tensors;
+  bool capturable = state.Collect(place_, &tensors);
+  auto *ctx = static_cast<platform::CUDADeviceContext *>(
+      platform::DeviceContextPool::Instance().Get(place_));
+  if (state.graph) {
+    if (tensors == state.tensors) {
+      state.graph->Replay(ctx->stream());
+      return true;
+    }
+    VLOG(3) << "The tensors are changed, discard the CUDA graph";
+    DiscardCUDAGraph();
+  }
+  state.steady_runs = tensors == state.tensors ? state.steady_runs + 1 : 0;
+  state.tensors.swap(tensors);
+  // The tensors are moved into the arena at the end of the run.
+  if (!capturable || memory_plan_pending_ ||
+      state.steady_runs < state.warmup_runs) {
+    return false;
+  }
+  if (!CaptureCUDAGraph()) return false;
+  // The tensors allocated by the capture.
+  state.Collect(place_, &state.tensors);
+  // The captured kernels are not run yet.
+  state.graph->Replay(ctx->stream());
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool NaiveExecutor::CaptureCUDAGraph() {
+#ifdef PADDLE_WITH_CUDA
+  auto &state = *cuda_graph_;
+  auto stream = static_cast<platform::CUDADeviceContext *>(
+                    platform::DeviceContextPool::Instance().Get(place_))
+                    ->stream();
+  memory::DeferThreadGPUFrees(&state.memory);
+  std::string error;
+  try {
+    platform::CUDAGraph::BeginCapture(stream);
+    RunOps();
+  } catch (std::exception &e) {
+    error = e.what();
+  }
+  state.graph = platform::CUDAGraph::EndCapture(stream);
+  memory::DeferThreadGPUFrees(nullptr);
+  if (state.graph != nullptr && error.empty()) {
+    VLOG(3) << "Capture " << ops_->size() << " operators in a CUDA graph";
+    return true;
+  }
+  // The operators of the failed capture are run again by the caller.
+  LOG(WARNING) << "Cannot capture the operators in a CUDA graph, they are "
+                  "run one by one from now on. "
+               << error;
+  DiscardCUDAGraph();
+  state.disabled = true;
+  return false;
+#else
+  return false;
+#endif
+}
+
+void NaiveExecutor::DiscardCUDAGraph() {
+#ifdef PADDLE_WITH_CUDA
+  auto &state = *cuda_graph_;
+  if (state.graph != nullptr) {
+    // The replays in flight use the memory.
+    platform::DeviceContextPool::Instance().Get(place_)->Wait();
+    state.graph.reset();
+  }
+  for (auto &item : state.memory) {
+    memory::Free(item.first, item.second);
+  }
+  state.memory.clear();
+  state.steady_runs = 0;
+#endif
+}
+
+void NaiveExecutor::EnableMemoryPlan(
+    const std::vector<std::string> &skip_vars) {
+  memory_plan_skip_vars_.clear();
+  memory_plan_skip_vars_.insert(skip_vars.begin(), skip_vars.end());
+  memory_plan_pending_ = true;
+}
+
+void NaiveExecutor::BuildMemoryPlan() {
+  memory_plan_pending_ = false;
+
+  std::vector<MemoryPlanOp> ops;
+  std::unordered_set<std::string> written, read, excluded;
+  // The input of each view.
+  std::unordered_map<std::string, std::string> view_of;
+  for (auto &op : *ops_) {
+    MemoryPlanOp plan_op;
+    plan_op.inputs = op->InputVars();
+    plan_op.outputs = op->OutputVars(true);
+    plan_op.share_data = MemoryPlan::SharesData(op->Type());
+    for (auto &slots : MemoryPlan::InplaceSlots(op->Type())) {
+      if (!op->Inputs().count(slots.first) ||
+          !op->Outputs().count(slots.second)) {
+        continue;
+      }
+      auto &ins = op->Inputs(slots.first);
+      auto &outs = op->Outputs(slots.second);
+      if (ins.size() == 1 && outs.size() == 1) {
+        plan_op.inplace.emplace_back(ins[0], outs[0]);
+        if (plan_op.share_data && ins[0] != outs[0]) {
+          view_of[outs[0]] = ins[0];
+        }
+      }
+    }
+    for (auto &name : plan_op.inputs) {
+      // Read before written, e.g. the parameters and the feed targets.
+      if (!written.count(name)) excluded.insert(name);
+      read.insert(name);
+    }
+    written.insert(plan_op.outputs.begin(), plan_op.outputs.end());
+    if (op->Type() == "feed") {
+      excluded.insert(plan_op.outputs.begin(), plan_op.outputs.end());
+    } else if (op->Type() == "fetch") {
+      excluded.insert(plan_op.inputs.begin(), plan_op.inputs.end());
+    }
+    ops.push_back(std::move(plan_op));
+  }
+
+  // The variable a view shares the memory of, following the views of views.
+  auto root_of = [&](std::string name) {
+    for (size_t i = 0; i < view_of.size() && view_of.count(name); ++i) {
+      name = view_of.at(name);
+    }
+    return name;
+  };
+  std::unordered_map<std::string, size_t> sizes;
+  std::unordered_map<const void *, std::string> owners;
+  for (auto &name : written) {
+    // The tensors never read by the operators are the outputs.
+    if (!read.count(name) || excluded.count(name) ||
+        memory_plan_skip_vars_.count(name)) {
+      continue;
+    }
+    auto *var = scope_->FindLocalVar(name);
+    if (var == nullptr || !var->IsType<LoDTensor>()) continue;
+    auto &tensor = var->Get<LoDTensor>();
+    if (!tensor.IsInitialized() || !(tensor.place() == place_)) continue;
+    // The tensors sharing the memory with others, e.g. by ShareDataWith,
+    // can not be planned separately, except the views of the same tensor,
+    // which are planned in its block.
+    const void *data = tensor.data<void>();
+    auto it = owners.find(data);
+    if (it != owners.end() && root_of(it->second) != root_of(name)) {
+      excluded.insert(name);
+      excluded.insert(it->second);
+      continue;
+    }
+    owners.emplace(data, name);
+    sizes[name] = tensor.numel() * SizeOfType(tensor.type());
+  }
+  // A view and its input are planned together or not at all, the memory of
+  // an unplanned view is still the block of its input.
+  auto planned = [&](const std::string &name) {
+    return sizes.count(name) && !excluded.count(name);
+  };
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (auto &item : view_of) {
+      if (planned(item.first) != planned(item.second)) {
+        excluded.insert(item.first);
+        excluded.insert(item.second);
+        changed = true;
+      }
+    }
+  }
+  for (auto &name : excluded) {
+    sizes.erase(name);
+  }
+
+  memory_plan_.reset(new MemoryPlan);
+  memory_plan_->Build(ops, sizes);
+  if (parallel_runner_) AddMemoryPlanDependencies();
+  VLOG(3) << "plan " << memory_plan_->blocks().size() << " tensors of "
+          << memory_plan_->total_size() << " bytes in an arena of "
+          << memory_plan_->arena_size() << " bytes";
+  if (memory_plan_->arena_size() == 0) return;
+
+  memory_arena_.Resize({static_cast<int64_t>(memory_plan_->arena_size())});
+  memory_arena_.mutable_data<uint8_t>(place_);
+  for (auto &item : memory_plan_->blocks()) {
+    auto *tensor = scope_->FindLocalVar(item.first)->GetMutable<LoDTensor>();
+    tensor->ShareBufferWith(memory_arena_, item.second.offset,
+                            item.second.size);
+  }
+}
+
+void NaiveExecutor::AddMemoryPlanDependencies() {
+  // The first writer and the users of the planned tensors.
+  std::unordered_map<std::string, std::vector<size_t>> users;
+  auto &ops = *ops_;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    auto names = ops[i]->InputVars();
+    auto outputs = ops[i]->OutputVars(true);
+    names.insert(names.end(), outputs.begin(), outputs.end());
+    for (auto &name : names) {
+      if (!memory_plan_->Has(name)) continue;
+      auto &op_ids = users[name];
+      if (op_ids.empty() || op_ids.back() != i) op_ids.push_back(i);
+    }
+  }
+  for (auto &a : users) {
+    auto &a_block = memory_plan_->Get(a.first);
+    for (auto &b : users) {
+      auto &b_block = memory_plan_->Get(b.first);
+      if (a_block.offset >= b_block.offset + b_block.size ||
+          b_block.offset >= a_block.offset + a_block.size) {
+        continue;
+      }
+      // b is written after a dies, in the memory of a.
+      size_t b_first = b.second.front();
+      if (a.second.back() > b_first) continue;
+      for (auto op_id : a.second) {
+        if (op_id < b_first) parallel_runner_->AddDependency(op_id, b_first);
+      }
+    }
+  }
+}
+
+void NaiveExecutor::EnableParallelRun(int num_threads) {
+  PADDLE_ENFORCE(platform::is_cpu_place(place_),
+                 "The parallel run only supports CPU.");
+  parallel_runner_.reset();
+  for (auto &op : *ops_) {
+    if (op->Attrs().count("use_mkldnn") && op->Attr<bool>("use_mkldnn")) {
+      LOG(WARNING) << "The operators run by MKLDNN are run one by one.";
+      return;
+    }
+  }
+  if (num_threads <= 1) return;
+
+  auto &ops = *ops_;
+  parallel_runner_.reset(new ParallelOpRunner(ops.size(), num_threads));
+  std::unordered_map<std::string, size_t> last_writer;
+  std::unordered_map<std::string, std::vector<size_t>> readers;
+  // The operators after the last barrier, each of them depends on it.
+  std::vector<size_t> since_barrier;
+  int64_t barrier = -1;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    bool is_barrier = false;
+    for (auto &attr : ops[i]->Attrs()) {
+      if (attr.second.type() == typeid(BlockDesc *) ||
+          attr.second.type() == typeid(std::vector<BlockDesc *>)) {
+        is_barrier = true;
+      }
+    }
+    if (is_barrier) {
+      for (auto op_id : since_barrier) {
+        parallel_runner_->AddDependency(op_id, i);
+      }
+      since_barrier.clear();
+    } else if (barrier >= 0) {
+      parallel_runner_->AddDependency(barrier, i);
+    }
+
+    auto inputs = ops[i]->InputVars();
+    auto outputs = ops[i]->OutputVars(true);
+    // Read after write.
+    for (auto &name : inputs) {
+      auto it = last_writer.find(name);
+      if (it != last_writer.end()) {
+        parallel_runner_->AddDependency(it->second, i);
+      }
+    }
+    // Write after write and write after read.
+    for (auto &name : outputs) {
+      if (name == kEmptyVarName) continue;
+      auto it = last_writer.find(name);
+      if (it != last_writer.end() && it->second != i) {
+        parallel_runner_->AddDependency(it->second, i);
+      }
+      for (auto op_id : readers[name]) {
+        if (op_id != i) parallel_runner_->AddDependency(op_id, i);
+      }
+    }
+    for (auto &name : inputs) {
+      readers[name].push_back(i);
+    }
+    for (auto &name : outputs) {
+      if (name == kEmptyVarName) continue;
+      readers[name].clear();
+      last_writer[name] = i;
+    }
+
+    if (is_barrier) {
+      barrier = static_cast<int64_t>(i);
+    } else {
+      since_barrier.push_back(i);
+    }
+  }
+  if (memory_plan_) AddMemoryPlanDependencies();
+  VLOG(3) << "run " << ops.size() << " operators on " << num_threads
+          << " threads, sequential: " << parallel_runner_->sequential();
+}
+
+void NaiveExecutor::EnableInferShapeCache(const ProgramDesc &program_desc,
+                                          int block_id) {
+  infer_shape_cache_.reset(new InferShapeCache(
+      InferShapeCache::CollectFeedVars(program_desc.Block(block_id), *ops_),
+      *ops_));
+}
+
+void NaiveExecutor::EnableTransferCache(const ProgramDesc &program_desc,
+                                        int block_id) {
+  auto &block = program_desc.Block(block_id);
+  for (auto &op : *ops_) {
+    auto *op_with_kernel = dynamic_cast<OperatorWithKernel *>(op.get());
+    if (op_with_kernel == nullptr) continue;
+    std::unordered_set<std::string> persistable_vars;
+    for (auto &name : op->InputVars()) {
+      auto *var = block.FindVarRecursive(name);
+      if (var != nullptr && var->Persistable()) {
+        persistable_vars.insert(name);
+      }
+    }
+    op_with_kernel->SetTransferCacheVars(persistable_vars);
+  }
+}
+
+void NaiveExecutor::ClearTransferCache() {
+  for (auto &op : *ops_) {
+    auto *op_with_kernel = dynamic_cast<OperatorWithKernel *>(op.get());
+    if (op_with_kernel != nullptr) op_with_kernel->ClearTransferCache();
+  }
+}
+
+void NaiveExecutor::ReplicatePersistables(const ProgramDesc &program_desc,
+                                          int block_id) {
+  PADDLE_ENFORCE(scope_ && scope_->parent(),
+                 "The persistable variables are replicated from the parent "
+                 "scope, call PrepareShared first");
+  for (auto &var : program_desc.Block(block_id).AllVars()) {
+    if (!var->Persistable() || var->GetType() != proto::VarType::LOD_TENSOR) {
+      continue;
+    }
+    auto *src = scope_->parent()->FindVar(var->Name());
+    if (src == nullptr || !src->IsType<LoDTensor>()) continue;
+    auto &src_tensor = src->Get<LoDTensor>();
+    if (!src_tensor.IsInitialized()) continue;
+    auto *dst_tensor = scope_->Var(var->Name())->GetMutable<LoDTensor>();
+    TensorCopySync(src_tensor, src_tensor.place(), dst_tensor);
+    dst_tensor->set_lod(src_tensor.lod());
+    VLOG(3) << "Replicate " << var->Name() << " in the local scope";
   }
+  CreateRuntimeContexts();
 }
 
 void NaiveExecutor::CreateVariables(const ProgramDesc &desc, Scope *scope,
@@ -114,6 +624,26 @@ void NaiveExecutor::CreateVariables(const ProgramDesc &desc, Scope *scope,
   }
 }
 
+void NaiveExecutor::CreateLocalVariables(const ProgramDesc &desc,
+                                         Scope *scope, int block_id) {
+  for (auto &var : desc.Block(block_id).AllVars()) {
+    if (var->Name() == framework::kEmptyVarName) {
+      continue;
+    }
+    // The feed and fetch holders are created locally too, so that every
+    // executor has its own ones.
+    auto type = var->GetType();
+    if (var->Persistable() && type != proto::VarType::FEED_MINIBATCH &&
+        type != proto::VarType::FETCH_LIST) {
+      PADDLE_ENFORCE_NOT_NULL(scope->FindVar(var->Name()),
+                              "The persistable variable %s is not created",
+                              var->Name());
+      continue;
+    }
+    InitializeVariable(scope->Var(var->Name()), type);
+  }
+}
+
 void NaiveExecutor::CreateOps(const ProgramDesc &desc, int block_id,
                               bool with_feed_fetch_ops) {
   for (const auto &op_desc : desc.Block(block_id).AllOps()) {
@@ -124,7 +654,26 @@ void NaiveExecutor::CreateOps(const ProgramDesc &desc, int block_id,
                             op_desc->Output("Out")[0]);
       continue;
     }
-    ops_.emplace_back(OpRegistry::CreateOp(*op_desc));
+    ops_->emplace_back(OpRegistry::CreateOp(*op_desc));
+  }
+}
+
+void NaiveExecutor::CreateRuntimeContexts() {
+  runtime_ctxs_.clear();
+  runtime_ctxs_.reserve(ops_->size());
+  for (auto &op : *ops_) {
+    // The operators without kernels do not use the runtime context.
+    if (dynamic_cast<OperatorWithKernel *>(op.get()) == nullptr) {
+      runtime_ctxs_.emplace_back(nullptr);
+    } else {
+      runtime_ctxs_.emplace_back(
+          new RuntimeContext(op->Inputs(), op->Outputs(), *scope_));
+    }
+  }
+  // The graph is launched with the tensors of the replaced variables.
+  if (cuda_graph_) {
+    DiscardCUDAGraph();
+    cuda_graph_->CollectVars(runtime_ctxs_);
   }
 }
 
@@ -137,13 +686,24 @@ LoDTensor *NaiveExecutor::FindTensor(const std::string &name) {
 }
 
 void NaiveExecutor::CleanFeedFetchOps() {
+  PADDLE_ENFORCE(infer_shape_cache_ == nullptr,
+                 "CleanFeedFetchOps should be called before "
+                 "EnableInferShapeCache.");
+  PADDLE_ENFORCE_EQ(ops_.use_count(), 1,
+                    "The operators shared with other executors can not be "
+                    "changed.");
   std::vector<std::unique_ptr<OperatorBase>> ops;
-  for (auto &op : ops_) {
+  for (auto &op : *ops_) {
     if (op->Type() != "feed" && op->Type() != "fetch") {
       ops.emplace_back(std::move(op));
     }
   }
-  ops_.swap(ops);
+  ops_->swap(ops);
+  // The indices of the operators are changed.
+  parallel_runner_.reset();
+  if (cuda_graph_) DiscardCUDAGraph();
+  cuda_graph_.reset();
+  CreateRuntimeContexts();
 }
 
 }  // namespace framework
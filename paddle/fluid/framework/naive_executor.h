@@ -14,9 +14,14 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
+#include "paddle/fluid/framework/infer_shape_cache.h"
+#include "paddle/fluid/framework/memory_plan.h"
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/parallel_op_runner.h"
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/platform/device_context.h"
@@ -30,7 +35,8 @@ namespace framework {
  */
 class NaiveExecutor {
  public:
-  explicit NaiveExecutor(const platform::Place& place) : place_(place) {}
+  explicit NaiveExecutor(const platform::Place& place);
+  ~NaiveExecutor();
 
   // Create child scope.
   // Create variables.
@@ -38,9 +44,78 @@ class NaiveExecutor {
   void Prepare(Scope* parent_scope, const ProgramDesc& program_desc,
                int block_id, bool with_feed_fetch_ops);
 
+  // Prepare an executor sharing the operators of the prepared executor
+  // other, which are stateless and can be run on several scopes at the same
+  // time. Only the temporary variables are created, in a new child scope of
+  // parent_scope, the persistable ones should exist in parent_scope already.
+  void PrepareShared(Scope* parent_scope, const ProgramDesc& program_desc,
+                     int block_id, const NaiveExecutor& other);
+
   // Run all the operators.
   void Run();
 
+  // Replay the recorded output shapes of the operators instead of running
+  // InferShape while the feed shapes stay the same. Only the feed shapes are
+  // checked, it should not be enabled for the programs with output shapes
+  // depending on the data values. It should be called after Prepare with the
+  // same program and block.
+  void EnableInferShapeCache(const ProgramDesc& program_desc, int block_id);
+
+  const InferShapeCache* infer_shape_cache() const {
+    return infer_shape_cache_.get();
+  }
+
+  // Plan the intermediate tensors in one arena at the end of the next run,
+  // which measures their sizes. The following runs reuse the arena and do
+  // not allocate the tensors while their shapes stay the same. The
+  // skip_vars, e.g. the outputs read after Run, are not planned.
+  void EnableMemoryPlan(const std::vector<std::string>& skip_vars = {});
+
+  const MemoryPlan* memory_plan() const { return memory_plan_.get(); }
+
+  // Cache the copies of the persistable inputs transformed to the kernels of
+  // the operators, e.g. the weights of another layout or data type, and reuse
+  // them in the following runs. The persistable variables should not be
+  // changed in place after. It should be called after Prepare with the same
+  // program and block.
+  void EnableTransferCache(const ProgramDesc& program_desc, int block_id);
+
+  // Drop the copies cached by EnableTransferCache. It should be called after
+  // the persistable variables are replaced.
+  void ClearTransferCache();
+
+  // Copy the persistable tensors of the parent scope into the scope of the
+  // executor, which shadow the shared ones, e.g. to keep a replica of the
+  // weights in the memory of the NUMA node that the executor runs on. The
+  // copies are allocated by the calling thread. It should be called after
+  // PrepareShared with the same program and block.
+  void ReplicatePersistables(const ProgramDesc& program_desc, int block_id);
+
+  // Run the independent operators at the same time on num_threads threads,
+  // including the one calling Run, by the dependencies of their variables.
+  // The operators with sub-blocks are barriers. It keeps running one by one
+  // for the graphs without independent operators, and for the operators run
+  // by MKLDNN. Only CPU is supported. It should be called after Prepare, and
+  // again after CleanFeedFetchOps.
+  void EnableParallelRun(int num_threads);
+
+  const ParallelOpRunner* parallel_runner() const {
+    return parallel_runner_.get();
+  }
+
+  // Capture the kernels of a run in a CUDA graph once the tensors keep the
+  // same shapes and memory for warmup_runs runs, and replay the graph instead
+  // of running the operators while they stay the same. It runs the operators
+  // when they change, and captures again after the warm-up. The programs
+  // with operators without kernels, e.g. the control flow and the feed and
+  // fetch ones, or with tensors out of the GPU, are not captured. Only
+  // CUDAPlace is supported. It should be called after Prepare, and again
+  // after CleanFeedFetchOps.
+  void EnableCUDAGraph(int warmup_runs = 2);
+
+  // Whether the next run with the same tensors replays a CUDA graph.
+  bool cuda_graph_captured() const;
+
   // Get an tensor to operating directly, without the need for feed_ops.
   LoDTensor* FindTensor(const std::string& name);
 
@@ -51,14 +126,49 @@ class NaiveExecutor {
  protected:
   void CreateVariables(const ProgramDesc& desc, Scope* scope, int block_id);
 
+  void CreateLocalVariables(const ProgramDesc& desc, Scope* scope,
+                            int block_id);
+
   void CreateOps(const ProgramDesc& desc, int block_id,
                  bool with_feed_fetch_ops);
 
+  // Resolve the variables of the operators in the scope once, the variables
+  // of the scope should not be erased after.
+  void CreateRuntimeContexts();
+
+  void BuildMemoryPlan();
+
+  // The operators that reuse the arena blocks of the dead tensors have to
+  // run after their users.
+  void AddMemoryPlanDependencies();
+
+  void RunOps();
+
+  // Replay or capture the run, false if the operators should be run instead.
+  bool RunCUDAGraph();
+
+  bool CaptureCUDAGraph();
+
+  // Free the memory kept for the replays of the discarded graph.
+  void DiscardCUDAGraph();
+
  private:
   const platform::Place place_;
-  // Catch the required resource to avoid recreate.
-  std::vector<std::unique_ptr<OperatorBase>> ops_;
+  // Catch the required resource to avoid recreate. The operators are shared
+  // by the executors prepared by PrepareShared.
+  std::shared_ptr<std::vector<std::unique_ptr<OperatorBase>>> ops_{
+      new std::vector<std::unique_ptr<OperatorBase>>};
   Scope* scope_;
+  // The variables of ops_ resolved in scope_, one for each operator.
+  std::vector<std::unique_ptr<RuntimeContext>> runtime_ctxs_;
+  std::unique_ptr<InferShapeCache> infer_shape_cache_;
+  bool memory_plan_pending_{false};
+  std::unordered_set<std::string> memory_plan_skip_vars_;
+  std::unique_ptr<MemoryPlan> memory_plan_;
+  Tensor memory_arena_;
+  std::unique_ptr<ParallelOpRunner> parallel_runner_;
+  struct CUDAGraphState;
+  std::unique_ptr<CUDAGraphState> cuda_graph_;
 };
 
 }  // namespace framework
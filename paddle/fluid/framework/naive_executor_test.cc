@@ -17,6 +17,8 @@
 #include <algorithm>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/platform/cuda_graph.h"
 
 namespace paddle {
 namespace framework {
@@ -64,6 +66,316 @@ TEST(NaiveExecutor, Basic) {
   }
 }
 
+TEST(NaiveExecutor, PrepareShared) {
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto& name : {"a", "b", "c"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  main_block->Var("b")->SetPersistable(true);
+
+  auto* add = main_block->AppendOp();
+  add->SetType("elementwise_add");
+  add->SetInput("X", {"a"});
+  add->SetInput("Y", {"b"});
+  add->SetOutput("Out", {"c"});
+
+  auto place = platform::CPUPlace();
+  Scope scope;
+  NaiveExecutor exe(place);
+  exe.Prepare(&scope, program, 0, false /*with feed fetch ops*/);
+  NaiveExecutor shared_exe(place);
+  shared_exe.PrepareShared(&scope, program, 0, exe);
+
+  // b is shared, a and c are local to every executor.
+  EXPECT_EQ(exe.FindTensor("b"), shared_exe.FindTensor("b"));
+  EXPECT_NE(exe.FindTensor("a"), shared_exe.FindTensor("a"));
+  EXPECT_NE(exe.FindTensor("c"), shared_exe.FindTensor("c"));
+
+  auto* b_tensor = exe.FindTensor("b");
+  b_tensor->Resize({1, 4});
+  std::fill_n(b_tensor->mutable_data<float>(place), 4, 1.f);
+  float value = 1.f;
+  for (auto* e : {&exe, &shared_exe}) {
+    auto* a_tensor = e->FindTensor("a");
+    a_tensor->Resize({1, 4});
+    std::fill_n(a_tensor->mutable_data<float>(place), 4, value);
+    value += 1.f;
+  }
+  exe.Run();
+  shared_exe.Run();
+
+  auto* c_data = exe.FindTensor("c")->data<float>();
+  auto* shared_c_data = shared_exe.FindTensor("c")->data<float>();
+  for (int i = 0; i < 4; i++) {
+    EXPECT_NEAR(c_data[i], 2., 1e-5);
+    EXPECT_NEAR(shared_c_data[i], 3., 1e-5);
+  }
+}
+
+TEST(NaiveExecutor, ReplicatePersistables) {
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto& name : {"a", "b", "c"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  main_block->Var("b")->SetPersistable(true);
+
+  auto* add = main_block->AppendOp();
+  add->SetType("elementwise_add");
+  add->SetInput("X", {"a"});
+  add->SetInput("Y", {"b"});
+  add->SetOutput("Out", {"c"});
+
+  auto place = platform::CPUPlace();
+  Scope scope;
+  NaiveExecutor exe(place);
+  exe.Prepare(&scope, program, 0, false /*with feed fetch ops*/);
+  auto* b_tensor = exe.FindTensor("b");
+  b_tensor->Resize({1, 4});
+  std::fill_n(b_tensor->mutable_data<float>(place), 4, 1.f);
+
+  NaiveExecutor replica(place);
+  replica.PrepareShared(&scope, program, 0, exe);
+  replica.ReplicatePersistables(program, 0);
+
+  // The replica runs on its own copy of b.
+  auto* replica_b_tensor = replica.FindTensor("b");
+  EXPECT_NE(b_tensor, replica_b_tensor);
+  EXPECT_NE(b_tensor->data<float>(), replica_b_tensor->data<float>());
+  std::fill_n(b_tensor->mutable_data<float>(place), 4, 2.f);
+
+  auto* a_tensor = replica.FindTensor("a");
+  a_tensor->Resize({1, 4});
+  std::fill_n(a_tensor->mutable_data<float>(place), 4, 1.f);
+  replica.Run();
+
+  auto* c_data = replica.FindTensor("c")->data<float>();
+  for (int i = 0; i < 4; i++) {
+    EXPECT_NEAR(c_data[i], 2., 1e-5);
+  }
+}
+
+TEST(NaiveExecutor, InferShapeCache) {
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto& name : {"a", "b", "c"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+
+  auto* add = main_block->AppendOp();
+  add->SetType("elementwise_add");
+  add->SetInput("X", {"a"});
+  add->SetInput("Y", {"b"});
+  add->SetOutput("Out", {"c"});
+
+  auto place = platform::CPUPlace();
+  NaiveExecutor exe(place);
+  exe.Prepare(nullptr, program, 0, false /*with feed fetch ops*/);
+  exe.EnableInferShapeCache(program, 0);
+  auto* a_tensor = exe.FindTensor("a");
+  auto* b_tensor = exe.FindTensor("b");
+  auto* c_tensor = exe.FindTensor("c");
+
+  auto feed = [&](int64_t width) {
+    a_tensor->Resize({1, width});
+    b_tensor->Resize({1, width});
+    std::fill_n(a_tensor->mutable_data<float>(place), width, 1.f);
+    std::fill_n(b_tensor->mutable_data<float>(place), width, 2.f);
+  };
+
+  feed(4);
+  exe.Run();
+  exe.Run();
+  EXPECT_EQ(exe.infer_shape_cache()->miss_count(), 1);
+  EXPECT_EQ(exe.infer_shape_cache()->hit_count(), 1);
+  EXPECT_EQ(c_tensor->dims(), make_ddim({1, 4}));
+
+  feed(8);
+  exe.Run();
+  EXPECT_EQ(exe.infer_shape_cache()->miss_count(), 2);
+  EXPECT_EQ(c_tensor->dims(), make_ddim({1, 8}));
+  auto* c_data = c_tensor->data<float>();
+  for (int i = 0; i < 8; i++) {
+    EXPECT_NEAR(c_data[i], 3., 1e-5);
+  }
+}
+
+TEST(NaiveExecutor, MemoryPlan) {
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto& name : {"a", "b", "c", "d", "e"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  // c = a + b, d = c + b, e = d + b
+  for (auto& io : std::vector<std::pair<std::string, std::string>>{
+           {"a", "c"}, {"c", "d"}, {"d", "e"}}) {
+    auto* add = main_block->AppendOp();
+    add->SetType("elementwise_add");
+    add->SetInput("X", {io.first});
+    add->SetInput("Y", {"b"});
+    add->SetOutput("Out", {io.second});
+  }
+
+  auto place = platform::CPUPlace();
+  NaiveExecutor exe(place);
+  exe.Prepare(nullptr, program, 0, false /*with feed fetch ops*/);
+  exe.EnableMemoryPlan();
+  auto* a_tensor = exe.FindTensor("a");
+  auto* b_tensor = exe.FindTensor("b");
+  a_tensor->Resize({1, 4});
+  b_tensor->Resize({1, 4});
+  std::fill_n(a_tensor->mutable_data<float>(place), 4, 1.f);
+  std::fill_n(b_tensor->mutable_data<float>(place), 4, 2.f);
+
+  exe.Run();
+  ASSERT_NE(exe.memory_plan(), nullptr);
+  // c and d are planned, d is computed in place of c. The feeds and the
+  // output e are not planned.
+  EXPECT_EQ(exe.memory_plan()->blocks().size(), 2UL);
+  EXPECT_TRUE(exe.memory_plan()->Has("c"));
+  EXPECT_TRUE(exe.memory_plan()->Has("d"));
+  EXPECT_EQ(exe.memory_plan()->arena_size(), MemoryPlan::kAlignment);
+
+  exe.Run();
+  auto* c_tensor = exe.FindTensor("c");
+  auto* d_tensor = exe.FindTensor("d");
+  EXPECT_EQ(c_tensor->data<float>(), d_tensor->data<float>());
+  auto* e_data = exe.FindTensor("e")->data<float>();
+  for (int i = 0; i < 4; i++) {
+    EXPECT_NEAR(e_data[i], 7., 1e-5);
+  }
+}
+
+TEST(NaiveExecutor, ParallelRun) {
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto& name : {"a", "b", "c", "d", "e", "f"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  // The branches c = a + b and d = b + b are independent, e = c + d, then
+  // the chain f = e + e.
+  std::vector<std::vector<std::string>> adds{
+      {"a", "b", "c"}, {"b", "b", "d"}, {"c", "d", "e"}, {"e", "e", "f"}};
+  for (auto& io : adds) {
+    auto* add = main_block->AppendOp();
+    add->SetType("elementwise_add");
+    add->SetInput("X", {io[0]});
+    add->SetInput("Y", {io[1]});
+    add->SetOutput("Out", {io[2]});
+  }
+
+  auto place = platform::CPUPlace();
+  NaiveExecutor exe(place);
+  exe.Prepare(nullptr, program, 0, false /*with feed fetch ops*/);
+  exe.EnableParallelRun(2);
+  ASSERT_NE(exe.parallel_runner(), nullptr);
+  EXPECT_FALSE(exe.parallel_runner()->sequential());
+  auto* a_tensor = exe.FindTensor("a");
+  auto* b_tensor = exe.FindTensor("b");
+  a_tensor->Resize({1, 4});
+  b_tensor->Resize({1, 4});
+  std::fill_n(a_tensor->mutable_data<float>(place), 4, 1.f);
+  std::fill_n(b_tensor->mutable_data<float>(place), 4, 2.f);
+
+  for (int run = 0; run < 3; ++run) {
+    exe.Run();
+    auto* f_data = exe.FindTensor("f")->data<float>();
+    for (int i = 0; i < 4; i++) {
+      EXPECT_NEAR(f_data[i], 14., 1e-5);
+    }
+  }
+}
+
+TEST(NaiveExecutor, ParallelRunSequential) {
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto& name : {"a", "b", "c", "d"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  // c = a + b, d = c + b
+  for (auto& io : std::vector<std::pair<std::string, std::string>>{
+           {"a", "c"}, {"c", "d"}}) {
+    auto* add = main_block->AppendOp();
+    add->SetType("elementwise_add");
+    add->SetInput("X", {io.first});
+    add->SetInput("Y", {"b"});
+    add->SetOutput("Out", {io.second});
+  }
+
+  auto place = platform::CPUPlace();
+  NaiveExecutor exe(place);
+  exe.Prepare(nullptr, program, 0, false /*with feed fetch ops*/);
+  exe.EnableParallelRun(4);
+  ASSERT_NE(exe.parallel_runner(), nullptr);
+  EXPECT_TRUE(exe.parallel_runner()->sequential());
+}
+
+#ifdef PADDLE_WITH_CUDA
+TEST(NaiveExecutor, CUDAGraph) {
+  if (!platform::CUDAGraph::IsSupported()) return;
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto& name : {"a", "b", "c", "d"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  // c = a + b, d = c + b
+  for (auto& io : std::vector<std::pair<std::string, std::string>>{
+           {"a", "c"}, {"c", "d"}}) {
+    auto* add = main_block->AppendOp();
+    add->SetType("elementwise_add");
+    add->SetInput("X", {io.first});
+    add->SetInput("Y", {"b"});
+    add->SetOutput("Out", {io.second});
+  }
+
+  auto place = platform::CUDAPlace(0);
+  NaiveExecutor exe(place);
+  exe.Prepare(nullptr, program, 0, false /*with feed fetch ops*/);
+  exe.EnableCUDAGraph(1);
+  auto feed = [&](const std::string& name, int64_t n, float value) {
+    LoDTensor cpu_tensor;
+    cpu_tensor.Resize({1, n});
+    std::fill_n(cpu_tensor.mutable_data<float>(platform::CPUPlace()), n,
+                value);
+    // Copied in place while the shape stays the same.
+    TensorCopySync(cpu_tensor, place, exe.FindTensor(name));
+  };
+  auto expect_d = [&](int64_t n, float value) {
+    LoDTensor cpu_tensor;
+    TensorCopySync(*exe.FindTensor("d"), platform::CPUPlace(), &cpu_tensor);
+    ASSERT_EQ(cpu_tensor.numel(), n);
+    for (int64_t i = 0; i < n; i++) {
+      EXPECT_NEAR(cpu_tensor.data<float>()[i], value, 1e-5);
+    }
+  };
+
+  feed("a", 4, 1.f);
+  feed("b", 4, 2.f);
+  exe.Run();
+  EXPECT_FALSE(exe.cuda_graph_captured());
+  expect_d(4, 5.f);
+  // The outputs are allocated by the first run, the third one is captured
+  // after a run with the same tensors.
+  exe.Run();
+  EXPECT_FALSE(exe.cuda_graph_captured());
+  exe.Run();
+  EXPECT_TRUE(exe.cuda_graph_captured());
+  expect_d(4, 5.f);
+  feed("a", 4, 3.f);
+  exe.Run();
+  EXPECT_TRUE(exe.cuda_graph_captured());
+  expect_d(4, 7.f);
+
+  // Another shape runs the operators.
+  feed("a", 8, 1.f);
+  feed("b", 8, 1.f);
+  exe.Run();
+  EXPECT_FALSE(exe.cuda_graph_captured());
+  expect_d(8, 3.f);
+}
+#endif
+
 }  // namespace framework
 }  // namespace paddle
 
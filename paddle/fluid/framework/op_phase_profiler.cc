@@ -0,0 +1,183 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/op_phase_profiler.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iomanip>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+DEFINE_bool(profile_op_phases, false,
+            "Accumulate the time of the InferShape, the kernel selection, "
+            "the data transforms, the kernel and the eager deletion of the "
+            "ops by the op type, see framework/op_phase_profiler.h.");
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+struct OpPhaseStats {
+  uint64_t calls = 0;
+  uint64_t phase_ns[kNumOpPhases] = {0};
+  uint64_t transforms[kNumDataTransformKinds] = {0};
+  uint64_t transform_bytes[kNumDataTransformKinds] = {0};
+};
+
+// The stats of a thread. The lock is only contended by the report.
+struct ThreadOpPhaseStats {
+  std::mutex mu;
+  std::unordered_map<std::string, OpPhaseStats> ops;
+};
+
+std::mutex g_all_stats_mu;
+std::list<std::shared_ptr<ThreadOpPhaseStats>> g_all_stats;
+
+ThreadOpPhaseStats& GetThreadStats() {
+  static thread_local std::shared_ptr<ThreadOpPhaseStats> stats;
+  if (!stats) {
+    stats = std::make_shared<ThreadOpPhaseStats>();
+    std::lock_guard<std::mutex> guard(g_all_stats_mu);
+    g_all_stats.push_back(stats);
+  }
+  return *stats;
+}
+
+// The op being timed by the thread, which the data transforms count to.
+thread_local const std::string* g_cur_op_type = nullptr;
+
+uint64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+OpPhaseTimer::OpPhaseTimer(const std::string& op_type, OpPhase phase)
+    : is_enabled_(IsOpPhaseProfilerEnabled()) {
+  if (!is_enabled_) return;
+  op_type_ = &op_type;
+  phase_ = phase;
+  parent_op_type_ = g_cur_op_type;
+  g_cur_op_type = op_type_;
+  start_ns_ = NowNs();
+}
+
+OpPhaseTimer::~OpPhaseTimer() {
+  if (!is_enabled_) return;
+  uint64_t elapsed = NowNs() - start_ns_;
+  g_cur_op_type = parent_op_type_;
+  auto& stats = GetThreadStats();
+  std::lock_guard<std::mutex> guard(stats.mu);
+  auto& op = stats.ops[*op_type_];
+  op.phase_ns[phase_] += elapsed;
+  // Every run of the op has a kernel.
+  if (phase_ == kComputePhase) ++op.calls;
+}
+
+void RecordDataTransform(DataTransformKind kind, size_t bytes) {
+  if (!IsOpPhaseProfilerEnabled() || g_cur_op_type == nullptr) return;
+  auto& stats = GetThreadStats();
+  std::lock_guard<std::mutex> guard(stats.mu);
+  auto& op = stats.ops[*g_cur_op_type];
+  ++op.transforms[kind];
+  op.transform_bytes[kind] += bytes;
+}
+
+std::string OpPhaseProfilerReport() {
+  std::unordered_map<std::string, OpPhaseStats> merged;
+  {
+    std::lock_guard<std::mutex> guard(g_all_stats_mu);
+    for (auto& thread_stats : g_all_stats) {
+      std::lock_guard<std::mutex> thread_guard(thread_stats->mu);
+      for (auto& name_op : thread_stats->ops) {
+        auto& op = merged[name_op.first];
+        op.calls += name_op.second.calls;
+        for (int i = 0; i < kNumOpPhases; ++i) {
+          op.phase_ns[i] += name_op.second.phase_ns[i];
+        }
+        for (int i = 0; i < kNumDataTransformKinds; ++i) {
+          op.transforms[i] += name_op.second.transforms[i];
+          op.transform_bytes[i] += name_op.second.transform_bytes[i];
+        }
+      }
+    }
+  }
+
+  std::vector<std::pair<std::string, OpPhaseStats>> ops(merged.begin(),
+                                                        merged.end());
+  auto total_ns = [](const OpPhaseStats& op) {
+    uint64_t total = 0;
+    for (int i = 0; i < kNumOpPhases; ++i) total += op.phase_ns[i];
+    return total;
+  };
+  std::sort(ops.begin(), ops.end(),
+            [&total_ns](const std::pair<std::string, OpPhaseStats>& a,
+                        const std::pair<std::string, OpPhaseStats>& b) {
+              return total_ns(a.second) > total_ns(b.second);
+            });
+
+  std::ostringstream os;
+  os << "------------------------->     Op Phase Report     "
+        "<-------------------------\n";
+  os << "Time unit: ms, transforms: count/MB of layout, data type and "
+        "place\n";
+  const int kNameWidth = 32;
+  const int kWidth = 12;
+  os << std::left << std::setw(kNameWidth) << "Op" << std::right
+     << std::setw(kWidth) << "Calls" << std::setw(kWidth) << "Total"
+     << std::setw(kWidth) << "InferShape" << std::setw(kWidth) << "Select"
+     << std::setw(kWidth) << "Prepare" << std::setw(kWidth) << "Kernel"
+     << std::setw(kWidth) << "GC" << std::setw(kWidth + 4) << "Layout"
+     << std::setw(kWidth + 4) << "DataType" << std::setw(kWidth + 4)
+     << "Place"
+     << "\n";
+  os << std::fixed << std::setprecision(3);
+  for (auto& name_op : ops) {
+    auto& op = name_op.second;
+    os << std::left << std::setw(kNameWidth) << name_op.first << std::right
+       << std::setw(kWidth) << op.calls << std::setw(kWidth)
+       << total_ns(op) / 1e6;
+    for (int i = 0; i < kNumOpPhases; ++i) {
+      os << std::setw(kWidth) << op.phase_ns[i] / 1e6;
+    }
+    for (int i = 0; i < kNumDataTransformKinds; ++i) {
+      std::ostringstream transform;
+      transform << std::fixed << std::setprecision(2) << op.transforms[i]
+                << "/" << op.transform_bytes[i] / 1048576.;
+      os << std::setw(kWidth + 4) << transform.str();
+    }
+    os << "\n";
+  }
+  return os.str();
+}
+
+void ResetOpPhaseProfiler() {
+  std::lock_guard<std::mutex> guard(g_all_stats_mu);
+  for (auto& thread_stats : g_all_stats) {
+    std::lock_guard<std::mutex> thread_guard(thread_stats->mu);
+    thread_stats->ops.clear();
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,80 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <gflags/gflags.h>
+#include <stdint.h>
+#include <string>
+
+DECLARE_bool(profile_op_phases);
+
+namespace paddle {
+namespace framework {
+
+/*
+ * The op phase profiler accumulates the time of each phase of running the
+ * ops by the op type, i.e. the InferShape, the kernel selection, the data
+ * transforms of PrepareData, the kernel and the eager deletion of the
+ * executor. It also counts the tensors transformed by TransformData and
+ * their bytes by the kind of the transform, to find the hidden layout, data
+ * type or place conversions.
+ *
+ * It is enabled by FLAGS_profile_op_phases. The CUDA kernels are timed by
+ * their launches unless FLAGS_benchmark is also set to wait for them.
+ */
+enum OpPhase {
+  kInferShapePhase,
+  kKernelSelectPhase,
+  kPrepareDataPhase,
+  kComputePhase,
+  kGCPhase,
+  kNumOpPhases,
+};
+
+enum DataTransformKind {
+  kLayoutTransform,
+  kDataTypeTransform,
+  kDeviceTransform,
+  kNumDataTransformKinds,
+};
+
+inline bool IsOpPhaseProfilerEnabled() { return FLAGS_profile_op_phases; }
+
+// Time a phase of the op, the data transforms in the scope are counted to
+// the op.
+class OpPhaseTimer {
+ public:
+  OpPhaseTimer(const std::string& op_type, OpPhase phase);
+  ~OpPhaseTimer();
+
+ private:
+  bool is_enabled_;
+  const std::string* op_type_;
+  OpPhase phase_;
+  const std::string* parent_op_type_;
+  uint64_t start_ns_;
+};
+
+// Count a tensor of bytes transformed for the op being timed by the thread.
+void RecordDataTransform(DataTransformKind kind, size_t bytes);
+
+// The report of the ops sorted by the total time, with the time of each
+// phase and the transforms.
+std::string OpPhaseProfilerReport();
+
+void ResetOpPhaseProfiler();
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,70 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/op_phase_profiler.h"
+#include <string>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(OpPhaseProfiler, disabled) {
+  FLAGS_profile_op_phases = false;
+  ResetOpPhaseProfiler();
+  std::string op_type = "disabled_op";
+  {
+    OpPhaseTimer timer(op_type, kComputePhase);
+    RecordDataTransform(kLayoutTransform, 1024);
+  }
+  EXPECT_EQ(OpPhaseProfilerReport().find(op_type), std::string::npos);
+}
+
+TEST(OpPhaseProfiler, phases_and_transforms) {
+  FLAGS_profile_op_phases = true;
+  ResetOpPhaseProfiler();
+  std::string mul = "mul";
+  std::string relu = "relu";
+  for (int i = 0; i < 3; ++i) {
+    { OpPhaseTimer timer(mul, kInferShapePhase); }
+    {
+      OpPhaseTimer timer(mul, kPrepareDataPhase);
+      RecordDataTransform(kDataTypeTransform, 1048576);
+    }
+    { OpPhaseTimer timer(mul, kComputePhase); }
+  }
+  { OpPhaseTimer timer(relu, kComputePhase); }
+  // The transforms out of the timers are not counted to any op.
+  RecordDataTransform(kDeviceTransform, 1048576);
+
+  std::string report = OpPhaseProfilerReport();
+  auto mul_pos = report.find("\nmul ");
+  auto relu_pos = report.find("\nrelu ");
+  ASSERT_NE(mul_pos, std::string::npos);
+  ASSERT_NE(relu_pos, std::string::npos);
+  std::string mul_line =
+      report.substr(mul_pos + 1, report.find('\n', mul_pos + 1) - mul_pos);
+  std::string relu_line =
+      report.substr(relu_pos + 1, report.find('\n', relu_pos + 1) - relu_pos);
+  EXPECT_NE(mul_line.find(" 3 "), std::string::npos);
+  EXPECT_NE(mul_line.find(" 3/3.00"), std::string::npos);
+  EXPECT_NE(relu_line.find(" 1 "), std::string::npos);
+  EXPECT_EQ(relu_line.find(" 1/"), std::string::npos);
+
+  ResetOpPhaseProfiler();
+  EXPECT_EQ(OpPhaseProfilerReport().find("\nmul "), std::string::npos);
+  FLAGS_profile_op_phases = false;
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -18,19 +18,33 @@ limitations under the License. */
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <mutex>  // NOLINT
 
 #include "paddle/fluid/framework/data_transform.h"
 #include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/infer_shape_cache.h"
 #include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_phase_profiler.h"
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/framework/shape_inference.h"
 #include "paddle/fluid/framework/var_type.h"
+#include "paddle/fluid/memory/memory_profiler.h"
 #include "paddle/fluid/platform/profiler.h"
+#include "paddle/fluid/platform/sampling_profiler.h"
 
 DECLARE_bool(benchmark);
 DEFINE_bool(check_nan_inf, false,
             "Checking whether operator produce NAN/INF or not. It will be "
             "extremely slow so please use this flag wisely.");
+DEFINE_bool(enable_kernel_cache, false,
+            "Cache the kernel chosen by each operator and reuse it as long as "
+            "the data type, layout and place of its inputs do not change. "
+            "The kernel map lookup and the data transform scan are skipped "
+            "on a cache hit.");
+DEFINE_bool(cache_shape_deterministic_outputs, true,
+            "Keep the outputs of the operators whose outputs only depend on "
+            "the shapes of their inputs, like prior_box, and copy them "
+            "instead of running the kernel again for the same input shapes.");
 
 namespace paddle {
 namespace framework {
@@ -139,7 +153,52 @@ static LoD GetLoD(const Scope& scope, const std::string& name) {
   }
 }
 
+RuntimeContext::RuntimeContext(const VariableNameMap& innames,
+                               const VariableNameMap& outnames,
+                               const Scope& scope) {
+  Resolve(innames, outnames, scope);
+}
+
+static void ResolveVars(const VariableNameMap& names, const Scope& scope,
+                        VariableValueMap* vars) {
+  for (auto& var_name_item : names) {
+    auto& var_list = (*vars)[var_name_item.first];
+    var_list.resize(var_name_item.second.size());
+    for (size_t i = 0; i < var_name_item.second.size(); ++i) {
+      auto& var_name = var_name_item.second[i];
+      var_list[i] =
+          var_name == kEmptyVarName ? nullptr : scope.FindVar(var_name);
+    }
+  }
+}
+
+void RuntimeContext::Resolve(const VariableNameMap& innames,
+                             const VariableNameMap& outnames,
+                             const Scope& scope) {
+  ResolveVars(innames, scope, &inputs);
+  ResolveVars(outnames, scope, &outputs);
+}
+
+const std::vector<Variable*>& RuntimeContext::InputVars(
+    const std::string& name) const {
+  auto it = inputs.find(name);
+  PADDLE_ENFORCE(it != inputs.end(), "The input %s is not resolved.", name);
+  return it->second;
+}
+
+const std::vector<Variable*>& RuntimeContext::OutputVars(
+    const std::string& name) const {
+  auto it = outputs.find(name);
+  PADDLE_ENFORCE(it != outputs.end(), "The output %s is not resolved.", name);
+  return it->second;
+}
+
 void OperatorBase::Run(const Scope& scope, const platform::Place& place) {
+  Run(scope, place, nullptr);
+}
+
+void OperatorBase::Run(const Scope& scope, const platform::Place& place,
+                       const RuntimeContext* runtime_ctx) {
   VLOG(4) << place << " " << DebugStringEx(&scope);
   if (platform::is_gpu_place(place)) {
 #ifndef PADDLE_WITH_CUDA
@@ -153,16 +212,52 @@ void OperatorBase::Run(const Scope& scope, const platform::Place& place) {
   // The profile has a process-wide mutex, results in serious performance issue
   // in concurrency scenerio. Here use an `if` to fix this issue.
   // Please not remove the `if`, ask @Superjomn if there are any concern.
-  if (platform::IsProfileEnabled()) {
+  if (memory::IsMemoryProfilerEnabled()) {
+    RunWithMemoryProfiler(scope, place, runtime_ctx);
+  } else if (platform::IsProfileEnabled() || platform::IsSampling()) {
     platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
     platform::RecordEvent record_event(Type(), pool.Get(place));
-    RunImpl(scope, place);
+    RunImplWithContext(scope, place, runtime_ctx);
   } else {
-    RunImpl(scope, place);
+    RunImplWithContext(scope, place, runtime_ctx);
   }
   VLOG(3) << place << " " << DebugStringEx(&scope);
 }
 
+static const Tensor* GetOutputTensor(const Variable& var) {
+  if (var.IsType<LoDTensor>()) {
+    return &var.Get<LoDTensor>();
+  } else if (var.IsType<SelectedRows>()) {
+    return &var.Get<SelectedRows>().value();
+  }
+  return nullptr;
+}
+
+void OperatorBase::RunWithMemoryProfiler(
+    const Scope& scope, const platform::Place& place,
+    const RuntimeContext* runtime_ctx) const {
+  memory::MemoryProfilerOpGuard guard(Type());
+  if (platform::IsProfileEnabled() || platform::IsSampling()) {
+    platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
+    platform::RecordEvent record_event(Type(), pool.Get(place));
+    RunImplWithContext(scope, place, runtime_ctx);
+  } else {
+    RunImplWithContext(scope, place, runtime_ctx);
+  }
+  // Tag the allocations with the outputs holding them, the allocations of
+  // the temporaries keep the op only.
+  for (auto& name_vars : outputs_) {
+    for (auto& var_name : name_vars.second) {
+      auto* var = scope.FindVar(var_name);
+      auto* tensor = var == nullptr ? nullptr : GetOutputTensor(*var);
+      if (tensor != nullptr && tensor->IsInitialized() &&
+          tensor->numel() > 0) {
+        memory::NameAllocation(tensor->data<void>(), var_name);
+      }
+    }
+  }
+}
+
 bool OperatorBase::HasInputs(const std::string& name) const {
   if (inputs_.find(name) != inputs_.end()) {
     return true;
@@ -384,6 +479,12 @@ bool ExecutionContext::HasInput(const std::string& name) const {
   if (!op_.HasInputs(name)) {
     return false;
   }
+  if (runtime_ctx_ != nullptr) {
+    auto& vars = runtime_ctx_->InputVars(name);
+    PADDLE_ENFORCE_LE(vars.size(), 1UL,
+                      "Input %s should not have more than one inputs", name);
+    return !vars.empty() && vars[0] != nullptr;
+  }
   auto& ins = Inputs(name);
   size_t length = ins.size();
   if (length == 0) {
@@ -400,6 +501,12 @@ bool ExecutionContext::HasOutput(const std::string& name) const {
   if (!op_.HasOutputs(name)) {
     return false;
   }
+  if (runtime_ctx_ != nullptr) {
+    auto& vars = runtime_ctx_->OutputVars(name);
+    PADDLE_ENFORCE_LE(vars.size(), 1UL,
+                      "Output %s should not have more than one inputs", name);
+    return !vars.empty() && vars[0] != nullptr;
+  }
   auto& outs = Outputs(name);
   size_t length = outs.size();
   if (length == 0) {
@@ -421,6 +528,16 @@ const Tensor* ExecutionContext::Input<Tensor>(const std::string& name) const {
 template <>
 const std::vector<const Tensor*> ExecutionContext::MultiInput<Tensor>(
     const std::string& name) const {
+  if (runtime_ctx_ != nullptr) {
+    auto& vars = runtime_ctx_->InputVars(name);
+    std::vector<const Tensor*> res;
+    res.reserve(vars.size());
+    std::transform(vars.begin(), vars.end(), std::back_inserter(res),
+                   [](const Variable* var) {
+                     return var == nullptr ? nullptr : GetTensorFromVar(*var);
+                   });
+    return res;
+  }
   auto names = op().Inputs(name);
   std::vector<const Tensor*> res;
   res.reserve(names.size());
@@ -441,6 +558,17 @@ Tensor* ExecutionContext::Output<Tensor>(const std::string& name) const {
 template <>
 std::vector<Tensor*> ExecutionContext::MultiOutput<Tensor>(
     const std::string& name) const {
+  if (runtime_ctx_ != nullptr) {
+    auto& vars = runtime_ctx_->OutputVars(name);
+    std::vector<Tensor*> res;
+    res.reserve(vars.size());
+    std::transform(vars.begin(), vars.end(), std::back_inserter(res),
+                   [](Variable* var) {
+                     return var == nullptr ? nullptr
+                                           : GetMutableTensorFromVar(var);
+                   });
+    return res;
+  }
   auto names = op().Outputs(name);
   std::vector<Tensor*> res;
   res.reserve(names.size());
@@ -470,10 +598,14 @@ bool OpSupportGPU(const std::string& op_type) {
 
 class RuntimeInferShapeContext : public InferShapeContext {
  public:
-  RuntimeInferShapeContext(const OperatorBase& op, const Scope& scope)
-      : op_(op), scope_(scope) {}
+  RuntimeInferShapeContext(const OperatorBase& op, const Scope& scope,
+                           const RuntimeContext* runtime_ctx = nullptr)
+      : op_(op), scope_(scope), runtime_ctx_(runtime_ctx) {}
 
   bool HasInput(const std::string& name) const override {
+    if (runtime_ctx_ != nullptr) {
+      return HasSingleVar(runtime_ctx_->inputs, name, "Input");
+    }
     // has only one input
     const auto& ins = op_.Inputs();
     auto it = ins.find(name);
@@ -490,6 +622,9 @@ class RuntimeInferShapeContext : public InferShapeContext {
   }
 
   bool HasOutput(const std::string& name) const override {
+    if (runtime_ctx_ != nullptr) {
+      return HasSingleVar(runtime_ctx_->outputs, name, "Output");
+    }
     // has only one output
     const auto& outs = op_.Outputs();
     auto it = outs.find(name);
@@ -509,6 +644,9 @@ class RuntimeInferShapeContext : public InferShapeContext {
     if (!op_.HasInputs(name)) {
       return false;
     }
+    if (runtime_ctx_ != nullptr) {
+      return HasAllVars(runtime_ctx_->InputVars(name));
+    }
     auto inputs = op_.Inputs(name);
     if (inputs.empty()) {
       return false;
@@ -525,6 +663,9 @@ class RuntimeInferShapeContext : public InferShapeContext {
     if (!op_.HasOutputs(name)) {
       return false;
     }
+    if (runtime_ctx_ != nullptr) {
+      return HasAllVars(runtime_ctx_->OutputVars(name));
+    }
     auto outputs = op_.Outputs(name);
     if (outputs.empty()) {
       return false;
@@ -556,8 +697,8 @@ class RuntimeInferShapeContext : public InferShapeContext {
     const std::string& input_n = Inputs(in)[i];
     const std::string& output_n = Outputs(out)[j];
 
-    Variable* in_var = scope_.FindVar(input_n);
-    Variable* out_var = scope_.FindVar(output_n);
+    Variable* in_var = InputVar(in, i);
+    Variable* out_var = OutputVar(out, j);
     PADDLE_ENFORCE(in_var->Type() == out_var->Type(),
                    "The type of %s and %s is not the same.", output_n,
                    GetDim(input_n));
@@ -585,9 +726,9 @@ class RuntimeInferShapeContext : public InferShapeContext {
     const std::vector<std::string>& outputs = Outputs(out);
     PADDLE_ENFORCE_LT(i, inputs.size());
     PADDLE_ENFORCE_LT(j, outputs.size());
-    Variable* in_var = scope_.FindVar(inputs.at(i));
+    Variable* in_var = InputVar(in, i);
     if (!in_var->IsType<LoDTensor>()) return;
-    Variable* out_var = scope_.FindVar(outputs.at(j));
+    Variable* out_var = OutputVar(out, j);
     PADDLE_ENFORCE(out_var->IsType<LoDTensor>(),
                    "The %d-th output of Output(%s) must be LoDTensor.", j, out);
     auto in_tensor = in_var->Get<LoDTensor>();
@@ -617,9 +758,84 @@ class RuntimeInferShapeContext : public InferShapeContext {
 
   bool IsRuntime() const override { return true; }
 
+  DDim GetInputDim(const std::string& name) const override {
+    if (runtime_ctx_ == nullptr) {
+      return InferShapeContext::GetInputDim(name);
+    }
+    auto& vars = runtime_ctx_->InputVars(name);
+    PADDLE_ENFORCE_EQ(vars.size(), 1UL,
+                      "Input(%s) should hold one element, but now it holds %d",
+                      name, vars.size());
+    return GetVarDim(vars[0], Inputs(name)[0]);
+  }
+
+  std::vector<DDim> GetInputsDim(const std::string& name) const override {
+    if (runtime_ctx_ == nullptr) {
+      return InferShapeContext::GetInputsDim(name);
+    }
+    auto& vars = runtime_ctx_->InputVars(name);
+    auto& names = Inputs(name);
+    std::vector<DDim> ret;
+    ret.reserve(vars.size());
+    for (size_t i = 0; i < vars.size(); ++i) {
+      ret.push_back(GetVarDim(vars[i], names[i]));
+    }
+    return ret;
+  }
+
+  void SetOutputDim(const std::string& name, const DDim& dim) override {
+    if (runtime_ctx_ == nullptr) {
+      InferShapeContext::SetOutputDim(name, dim);
+      return;
+    }
+    auto& vars = runtime_ctx_->OutputVars(name);
+    PADDLE_ENFORCE_EQ(vars.size(), 1UL,
+                      "Output(%s) should hold one element, but now it holds %d",
+                      name, vars.size());
+    SetVarDim(vars[0], Outputs(name)[0], dim);
+  }
+
+  void SetOutputsDim(const std::string& name,
+                     const std::vector<DDim>& dims) override {
+    if (runtime_ctx_ == nullptr) {
+      InferShapeContext::SetOutputsDim(name, dims);
+      return;
+    }
+    auto& vars = runtime_ctx_->OutputVars(name);
+    auto& names = Outputs(name);
+    PADDLE_ENFORCE_EQ(vars.size(), dims.size());
+    for (size_t i = 0; i < vars.size(); ++i) {
+      if (names[i] == kEmptyVarName) {
+        continue;
+      }
+      SetVarDim(vars[i], names[i], dims[i]);
+    }
+  }
+
+  std::vector<InferShapeVarPtr> GetInputVarPtrs(
+      const std::string& name) override {
+    if (runtime_ctx_ == nullptr) {
+      return InferShapeContext::GetInputVarPtrs(name);
+    }
+    auto& vars = runtime_ctx_->InputVars(name);
+    return std::vector<InferShapeVarPtr>(vars.begin(), vars.end());
+  }
+
+  std::vector<InferShapeVarPtr> GetOutputVarPtrs(
+      const std::string& name) override {
+    if (runtime_ctx_ == nullptr) {
+      return InferShapeContext::GetOutputVarPtrs(name);
+    }
+    auto& vars = runtime_ctx_->OutputVars(name);
+    return std::vector<InferShapeVarPtr>(vars.begin(), vars.end());
+  }
+
  protected:
   DDim GetDim(const std::string& name) const override {
-    Variable* var = scope_.FindVar(name);
+    return GetVarDim(scope_.FindVar(name), name);
+  }
+
+  DDim GetVarDim(const Variable* var, const std::string& name) const {
     PADDLE_ENFORCE_NOT_NULL(var);
     if (var->IsType<LoDTensor>()) {
       return var->Get<LoDTensor>().dims();
@@ -638,7 +854,10 @@ class RuntimeInferShapeContext : public InferShapeContext {
   }
 
   void SetDim(const std::string& name, const DDim& dim) override {
-    Variable* var = scope_.FindVar(name);
+    SetVarDim(scope_.FindVar(name), name, dim);
+  }
+
+  void SetVarDim(Variable* var, const std::string& name, const DDim& dim) {
     if (var->IsType<LoDTensor>()) {
       var->GetMutable<LoDTensor>()->Resize(dim);
     } else if (var->IsType<SelectedRows>()) {
@@ -664,8 +883,41 @@ class RuntimeInferShapeContext : public InferShapeContext {
   }
 
  private:
+  bool HasSingleVar(const VariableValueMap& vars, const std::string& name,
+                    const char* kind) const {
+    auto it = vars.find(name);
+    if (it == vars.end() || it->second.empty()) {
+      return false;
+    }
+    PADDLE_ENFORCE_EQ(it->second.size(), 1UL,
+                      "%s %s should not have more than one variable", kind,
+                      name);
+    return it->second[0] != nullptr;
+  }
+
+  bool HasAllVars(const std::vector<Variable*>& vars) const {
+    return !vars.empty() &&
+           std::all_of(vars.begin(), vars.end(),
+                       [](const Variable* var) { return var != nullptr; });
+  }
+
+  Variable* InputVar(const std::string& name, size_t i) const {
+    if (runtime_ctx_ != nullptr) {
+      return runtime_ctx_->InputVars(name).at(i);
+    }
+    return scope_.FindVar(Inputs(name).at(i));
+  }
+
+  Variable* OutputVar(const std::string& name, size_t i) const {
+    if (runtime_ctx_ != nullptr) {
+      return runtime_ctx_->OutputVars(name).at(i);
+    }
+    return scope_.FindVar(Outputs(name).at(i));
+  }
+
   const OperatorBase& op_;
   const Scope& scope_;
+  const RuntimeContext* runtime_ctx_;
 };
 
 static void CheckTensorNANOrInf(const std::string& name,
@@ -682,67 +934,315 @@ static void CheckTensorNANOrInf(const std::string& name,
                  "Tensor %s contains NAN", name);
 }
 
+// The fields of the inputs that the caches of an op compare with the last
+// run.
+enum InputKeyField {
+  kInputKeyDataType = 1,
+  kInputKeyLayout = 1 << 1,
+  kInputKeyPlace = 1 << 2,
+  kInputKeyDims = 1 << 3,
+  kInputKeyLoD = 1 << 4,
+};
+
+// The key of an input of an op, only the fields collected are set.
+struct OpInputKey {
+  bool initialized{false};
+  proto::VarType::Type data_type{proto::VarType::RAW};
+  DataLayout data_layout{DataLayout::kAnyLayout};
+  platform::Place place{platform::CPUPlace()};
+  DDim dims;
+  LoD lod;
+};
+
+static std::vector<OpInputKey> CollectInputKeys(
+    const VariableNameMap& inputs, const Scope& scope,
+    const RuntimeContext* runtime_ctx, int fields) {
+  std::vector<OpInputKey> keys;
+  for (auto& var_name_item : inputs) {
+    for (size_t i = 0; i < var_name_item.second.size(); ++i) {
+      auto* var = runtime_ctx != nullptr
+                      ? runtime_ctx->InputVars(var_name_item.first)[i]
+                      : scope.FindVar(var_name_item.second[i]);
+      const Tensor* tensor = nullptr;
+      if (var != nullptr && VarIsTensor(*var)) {
+        tensor = GetTensorFromVar(*var);
+      }
+      keys.emplace_back();
+      if (tensor == nullptr || !tensor->IsInitialized()) continue;
+      auto& key = keys.back();
+      key.initialized = true;
+      if (fields & kInputKeyDataType) {
+        key.data_type = ToDataType(tensor->type());
+      }
+      if (fields & kInputKeyLayout) key.data_layout = tensor->layout();
+      if (fields & kInputKeyPlace) key.place = tensor->place();
+      if (fields & kInputKeyDims) key.dims = tensor->dims();
+      if ((fields & kInputKeyLoD) && var->IsType<LoDTensor>()) {
+        key.lod = var->Get<LoDTensor>().lod();
+      }
+    }
+  }
+  return keys;
+}
+
+static bool MatchInputKeys(const std::vector<OpInputKey>& l,
+                           const std::vector<OpInputKey>& r, int fields) {
+  if (l.size() != r.size()) return false;
+  for (size_t i = 0; i < l.size(); ++i) {
+    if (l[i].initialized != r[i].initialized) return false;
+    if (!l[i].initialized) continue;
+    if (((fields & kInputKeyDataType) && l[i].data_type != r[i].data_type) ||
+        ((fields & kInputKeyLayout) && l[i].data_layout != r[i].data_layout) ||
+        ((fields & kInputKeyPlace) &&
+         !platform::is_same_place(l[i].place, r[i].place)) ||
+        ((fields & kInputKeyDims) && l[i].dims != r[i].dims) ||
+        ((fields & kInputKeyLoD) && l[i].lod != r[i].lod)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+struct OperatorWithKernel::KernelCache {
+  static constexpr int kInputKeyFields =
+      kInputKeyDataType | kInputKeyLayout | kInputKeyPlace;
+
+  bool Match(const std::vector<OpInputKey>& keys,
+             const platform::Place& run_place) const {
+    return platform::is_same_place(place, run_place) &&
+           MatchInputKeys(keys, input_keys, kInputKeyFields);
+  }
+
+  platform::Place place;
+  std::vector<OpInputKey> input_keys;
+  OpKernelType kernel_type;
+  const OpKernelFunc* kernel_func;
+  // Whether TryTransferData produced a transfer scope for these inputs.
+  bool need_transfer;
+};
+
+struct OperatorWithKernel::OutputCache {
+  static constexpr int kInputKeyFields =
+      kInputKeyDataType | kInputKeyDims | kInputKeyLoD;
+
+  bool Match(const std::vector<OpInputKey>& keys,
+             const platform::Place& run_place) const {
+    return platform::is_same_place(place, run_place) &&
+           MatchInputKeys(keys, input_keys, kInputKeyFields);
+  }
+
+  platform::Place place;
+  std::vector<OpInputKey> input_keys;
+  // The outputs, by the names of the output variables. The output
+  // variables share them read-only.
+  std::vector<std::pair<std::string, LoDTensor>> outputs;
+};
+
+struct OperatorWithKernel::TransferCache {
+  struct Entry {
+    // The input the copy was transformed from.
+    const void* src_data;
+    DDim src_dims;
+    OpKernelType kernel_type_for_var;
+    OpKernelType expected_kernel_type;
+    Tensor out;
+  };
+
+  bool Find(const std::string& var_name, const Tensor& in,
+            const OpKernelType& kernel_type_for_var,
+            const OpKernelType& expected_kernel_type, Tensor* out) {
+    std::lock_guard<std::mutex> guard(mu);
+    auto it = entries.find(var_name);
+    if (it == entries.end()) return false;
+    auto& entry = it->second;
+    if (entry.src_data != in.data<void>() || entry.src_dims != in.dims() ||
+        entry.kernel_type_for_var != kernel_type_for_var ||
+        entry.expected_kernel_type != expected_kernel_type) {
+      return false;
+    }
+    out->ShareDataWith(entry.out);
+    return true;
+  }
+
+  void Store(const std::string& var_name, const Tensor& in,
+             const OpKernelType& kernel_type_for_var,
+             const OpKernelType& expected_kernel_type, const Tensor& out) {
+    std::lock_guard<std::mutex> guard(mu);
+    Entry entry{in.data<void>(), in.dims(), kernel_type_for_var,
+                expected_kernel_type, Tensor()};
+    entry.out.ShareDataWith(out);
+    entries.erase(var_name);
+    entries.emplace(var_name, std::move(entry));
+  }
+
+  std::unordered_set<std::string> var_names;
+  std::mutex mu;
+  std::unordered_map<std::string, Entry> entries;
+};
+
+void OperatorWithKernel::SetTransferCacheVars(
+    const std::unordered_set<std::string>& var_names) {
+  if (var_names.empty()) {
+    transfer_cache_ = nullptr;
+    return;
+  }
+  transfer_cache_.reset(new TransferCache);
+  transfer_cache_->var_names = var_names;
+}
+
+void OperatorWithKernel::ClearTransferCache() {
+  if (transfer_cache_ == nullptr) return;
+  std::lock_guard<std::mutex> guard(transfer_cache_->mu);
+  transfer_cache_->entries.clear();
+}
+
 void OperatorWithKernel::RunImpl(const Scope& scope,
                                  const platform::Place& place) const {
-  RuntimeInferShapeContext infer_shape_ctx(*this, scope);
-  this->InferShape(&infer_shape_ctx);
+  RunImplWithContext(scope, place, nullptr);
+}
+
+void OperatorWithKernel::RunImplWithContext(
+    const Scope& scope, const platform::Place& place,
+    const RuntimeContext* runtime_ctx) const {
+  bool cache_outputs =
+      FLAGS_cache_shape_deterministic_outputs && IsShapeDeterministic();
+  std::vector<OpInputKey> output_cache_keys;
+  if (cache_outputs) {
+    output_cache_keys = CollectInputKeys(Inputs(), scope, runtime_ctx,
+                                         OutputCache::kInputKeyFields);
+    auto output_cache = std::atomic_load(&output_cache_);
+    if (output_cache != nullptr &&
+        output_cache->Match(output_cache_keys, place)) {
+      VLOG(3) << "reuse the cached outputs of op " << type_;
+      for (auto& output : output_cache->outputs) {
+        auto* var = scope.FindVar(output.first);
+        PADDLE_ENFORCE_NOT_NULL(var, "Output %s of %s should be created",
+                                output.first, type_);
+        auto* tensor = var->GetMutable<LoDTensor>();
+        tensor->ShareDataReadOnlyWith(output.second);
+        tensor->set_lod(output.second.lod());
+      }
+      return;
+    }
+  }
+
+  {
+    OpPhaseTimer timer(type_, kInferShapePhase);
+    auto* infer_shape_record = InferShapeRecord::Take();
+    if (infer_shape_record != nullptr && infer_shape_record->recorded()) {
+      infer_shape_record->Replay(scope);
+    } else {
+      RuntimeInferShapeContext infer_shape_ctx(*this, scope, runtime_ctx);
+      this->InferShape(&infer_shape_ctx);
+      if (infer_shape_record != nullptr) {
+        infer_shape_record->Record(OutputVars(true), scope);
+      }
+    }
+  }
   platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
   auto* dev_ctx = pool.Get(place);
 
-  // check if op[type] has kernel registered.
-  auto& all_op_kernels = AllOpKernels();
-  auto kernels_iter = all_op_kernels.find(type_);
-  if (kernels_iter == all_op_kernels.end()) {
-    PADDLE_THROW(
-        "There are no kernels which are registered in the %s operator.", type_);
-  }
+  std::vector<OpInputKey> input_keys;
+  std::shared_ptr<KernelCache> cache;
+  std::unique_ptr<OpKernelType> expected_kernel_key;
+  const OpKernelFunc* kernel_func = nullptr;
+  {
+    OpPhaseTimer timer(type_, kKernelSelectPhase);
+    if (FLAGS_enable_kernel_cache) {
+      input_keys = CollectInputKeys(Inputs(), scope, runtime_ctx,
+                                    KernelCache::kInputKeyFields);
+      cache = std::atomic_load(&kernel_cache_);
+      if (cache != nullptr && !cache->Match(input_keys, place)) {
+        cache = nullptr;
+      }
+    }
+
+    if (cache != nullptr) {
+      VLOG(3) << "kernel cache hit for op " << type_;
+      expected_kernel_key.reset(new OpKernelType(cache->kernel_type));
+      kernel_func = cache->kernel_func;
+    } else {
+      // check if op[type] has kernel registered.
+      auto& all_op_kernels = AllOpKernels();
+      auto kernels_iter = all_op_kernels.find(type_);
+      if (kernels_iter == all_op_kernels.end()) {
+        PADDLE_THROW(
+            "There are no kernels which are registered in the %s operator.",
+            type_);
+      }
 
-  OpKernelMap& kernels = kernels_iter->second;
+      OpKernelMap& kernels = kernels_iter->second;
 
-  // TODO(dzhwinter) : kernel fallback mechanism will be added when all the
-  // transform functions are ready.
+      // TODO(dzhwinter) : kernel fallback mechanism will be added when all
+      // the transform functions are ready.
 
-  // for (auto& candidate : kKernelPriority) {
-  //   Do selection
-  // }
+      // for (auto& candidate : kKernelPriority) {
+      //   Do selection
+      // }
 
-  auto expected_kernel_key =
-      this->GetExpectedKernelType(ExecutionContext(*this, scope, *dev_ctx));
-  VLOG(3) << "expected_kernel_key:" << expected_kernel_key;
+      expected_kernel_key.reset(new OpKernelType(this->GetExpectedKernelType(
+          ExecutionContext(*this, scope, *dev_ctx, runtime_ctx))));
+      VLOG(3) << "expected_kernel_key:" << *expected_kernel_key;
 
-  auto kernel_iter = kernels.find(expected_kernel_key);
+      auto kernel_iter = kernels.find(*expected_kernel_key);
 #ifdef PADDLE_WITH_MKLDNN
-  // workaround for missing MKLDNN kernel when FLAGS_use_mkldnn env var is set
-  if (kernel_iter == kernels.end() &&
-      expected_kernel_key.library_type_ == LibraryType::kMKLDNN) {
-    VLOG(3) << "missing MKLDNN kernel: fallbacking to PLAIN one";
-    expected_kernel_key.library_type_ = LibraryType::kPlain;
-    expected_kernel_key.data_layout_ = DataLayout::kAnyLayout;
-    kernel_iter = kernels.find(expected_kernel_key);
-  }
+      // workaround for missing MKLDNN kernel when FLAGS_use_mkldnn is set
+      if (kernel_iter == kernels.end() &&
+          expected_kernel_key->library_type_ == LibraryType::kMKLDNN) {
+        VLOG(3) << "missing MKLDNN kernel: fallbacking to PLAIN one";
+        expected_kernel_key->library_type_ = LibraryType::kPlain;
+        expected_kernel_key->data_layout_ = DataLayout::kAnyLayout;
+        kernel_iter = kernels.find(*expected_kernel_key);
+      }
 #endif
-  if (kernel_iter == kernels.end()) {
-    PADDLE_THROW("op %s does not have kernel for %s", type_,
-                 KernelTypeToString(expected_kernel_key));
+      if (kernel_iter == kernels.end()) {
+        PADDLE_THROW("op %s does not have kernel for %s", type_,
+                     KernelTypeToString(*expected_kernel_key));
+      }
+      kernel_func = &kernel_iter->second;
+    }
   }
 
   // do data transformScope &transfer_scope;
   std::vector<std::string> transfered_inplace_vars;
-  auto* transfer_scope =
-      TryTransferData(scope, expected_kernel_key, &transfered_inplace_vars);
+  Scope* transfer_scope = nullptr;
+  if (cache == nullptr || cache->need_transfer) {
+    OpPhaseTimer timer(type_, kPrepareDataPhase);
+    transfer_scope = TryTransferData(scope, *expected_kernel_key, runtime_ctx,
+                                     &transfered_inplace_vars);
+  }
 
-  // exec scope is the scope that kernel actually executed on.
+  if (FLAGS_enable_kernel_cache && cache == nullptr) {
+    std::shared_ptr<KernelCache> new_cache(new KernelCache{
+        place, std::move(input_keys), *expected_kernel_key, kernel_func,
+        transfer_scope != nullptr});
+    std::atomic_store(&kernel_cache_, new_cache);
+  }
+
+  // exec scope is the scope that kernel actually executed on. The runtime
+  // context does not hold the transferred variables, the kernel looks them
+  // up in the transfer scope.
   const Scope& exec_scope =
       (transfer_scope == nullptr ? scope : *transfer_scope);
+  const RuntimeContext* exec_ctx =
+      transfer_scope == nullptr ? runtime_ctx : nullptr;
 
-  if (!(expected_kernel_key.place_ == dev_ctx->GetPlace())) {
-    dev_ctx = pool.Get(expected_kernel_key.place_);
+  if (!(expected_kernel_key->place_ == dev_ctx->GetPlace())) {
+    dev_ctx = pool.Get(expected_kernel_key->place_);
   }
 
-  kernel_iter->second(ExecutionContext(*this, exec_scope, *dev_ctx));
+  {
+    OpPhaseTimer timer(type_, kComputePhase);
+    (*kernel_func)(ExecutionContext(*this, exec_scope, *dev_ctx, exec_ctx));
+    // Time the CUDA kernels rather than their launches.
+    if (FLAGS_benchmark && IsOpPhaseProfilerEnabled()) {
+      dev_ctx->Wait();
+    }
+  }
 
   if (!transfered_inplace_vars.empty()) {
     // there is inplace variable has been transfered.
+    OpPhaseTimer timer(type_, kPrepareDataPhase);
     TransferInplaceVarsBack(scope, transfered_inplace_vars, *transfer_scope);
   }
 
@@ -751,6 +1251,30 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
     dev_ctx->Wait();
   }
 
+  if (cache_outputs) {
+    std::shared_ptr<OutputCache> output_cache(
+        new OutputCache{place, std::move(output_cache_keys), {}});
+    for (auto& vname : OutputVars(true)) {
+      auto* var = scope.FindVar(vname);
+      if (var == nullptr) continue;
+      // Only the LoDTensor outputs can be kept.
+      if (!var->IsType<LoDTensor>() ||
+          !var->Get<LoDTensor>().IsInitialized()) {
+        output_cache = nullptr;
+        break;
+      }
+      // The cache takes the memory of the output, and a later write to
+      // the output copies it.
+      auto* tensor = var->GetMutable<LoDTensor>();
+      output_cache->outputs.emplace_back(vname, LoDTensor());
+      auto& cached = output_cache->outputs.back().second;
+      cached.ShareDataWith(*tensor);
+      cached.set_lod(tensor->lod());
+      tensor->ShareDataReadOnlyWith(cached);
+    }
+    std::atomic_store(&output_cache_, output_cache);
+  }
+
   if (FLAGS_check_nan_inf) {
     for (auto& vname : OutputVars(true)) {
       auto* var = exec_scope.FindVar(vname);
@@ -779,11 +1303,15 @@ void OperatorWithKernel::TransferInplaceVarsBack(
 
 Scope* OperatorWithKernel::TryTransferData(
     const Scope& scope, const OpKernelType& expected_kernel_key,
+    const RuntimeContext* runtime_ctx,
     std::vector<std::string>* transfered_inplace_vars) const {
   Scope* new_scope = nullptr;
   for (auto& var_name_item : Inputs()) {
-    for (auto& var_name : var_name_item.second) {
-      auto* var = scope.FindVar(var_name);
+    for (size_t i = 0; i < var_name_item.second.size(); ++i) {
+      auto& var_name = var_name_item.second[i];
+      auto* var = runtime_ctx != nullptr
+                      ? runtime_ctx->InputVars(var_name_item.first)[i]
+                      : scope.FindVar(var_name);
       // Only tensor can be tranfer to another device.
       if (var == nullptr || !VarIsTensor(*var)) {
         continue;
@@ -802,8 +1330,9 @@ Scope* OperatorWithKernel::TryTransferData(
       }
 
       auto out_var_names = OutputVars(true);
-      if (std::find(out_var_names.begin(), out_var_names.end(), var_name) !=
-          out_var_names.end()) {
+      bool inplace = std::find(out_var_names.begin(), out_var_names.end(),
+                               var_name) != out_var_names.end();
+      if (inplace) {
         transfered_inplace_vars->emplace_back(var_name);
       }
 
@@ -816,7 +1345,22 @@ Scope* OperatorWithKernel::TryTransferData(
 
       auto* trans_var = new_scope->Var(var_name);
       Tensor out;
-      TransformData(expected_kernel_key, kernel_type_for_var, *tensor_in, &out);
+      // The copy of an inplace variable is written by the kernel, so it is
+      // never cached.
+      bool cached = !inplace && transfer_cache_ != nullptr &&
+                    transfer_cache_->var_names.count(var_name) != 0;
+      if (!cached ||
+          !transfer_cache_->Find(var_name, *tensor_in, kernel_type_for_var,
+                                 expected_kernel_key, &out)) {
+        TransformData(expected_kernel_key, kernel_type_for_var, *tensor_in,
+                      &out);
+        if (cached) {
+          transfer_cache_->Store(var_name, *tensor_in, kernel_type_for_var,
+                                 expected_kernel_key, out);
+        }
+      } else {
+        VLOG(3) << "Reuse the transformed " << var_name;
+      }
       SetTensorToVariable(*var, out, trans_var);
     }
   }
@@ -827,11 +1371,15 @@ Scope* OperatorWithKernel::TryTransferData(
 proto::VarType::Type OperatorWithKernel::IndicateDataType(
     const ExecutionContext& ctx) const {
   auto& scope = ctx.scope();
+  auto* runtime_ctx = ctx.runtime_ctx();
   int data_type = -1;
   std::string last_input_name;
   for (auto& input : this->inputs_) {
-    for (auto& ipt_name : input.second) {
-      auto* var = scope.FindVar(ipt_name);
+    for (size_t i = 0; i < input.second.size(); ++i) {
+      auto& ipt_name = input.second[i];
+      auto* var = runtime_ctx != nullptr
+                      ? runtime_ctx->InputVars(input.first)[i]
+                      : scope.FindVar(ipt_name);
       if (var != nullptr) {
         const Tensor* t = nullptr;
         if (var->IsType<Tensor>()) {
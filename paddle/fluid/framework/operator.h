@@ -16,9 +16,12 @@ limitations under the License. */
 
 #include <algorithm>
 #include <atomic>
+#include <map>
+#include <memory>
 #include <string>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #define GLOG_NO_ABBREVIATED_SEVERITIES
 #define GOOGLE_GLOG_DLL_DECL
@@ -68,6 +71,32 @@ const Tensor* GetTensorFromVar(const Variable& var);
 class OperatorBase;
 class ExecutionContext;
 
+using VariableValueMap = std::map<std::string, std::vector<Variable*>>;
+
+/**
+ * RuntimeContext holds the variables of the inputs and outputs of an op,
+ * resolved in a scope once, in the same slots as the VariableNameMap of the
+ * op. The contexts of an op run with one holds them instead of looking them
+ * up in the scope, which takes the lock of the scope, by name again and again.
+ * The variables should not be erased from the scope while it is used.
+ */
+class RuntimeContext {
+ public:
+  RuntimeContext(const VariableNameMap& innames,
+                 const VariableNameMap& outnames, const Scope& scope);
+
+  // Resolve the variables in scope again, e.g. in the local scope of another
+  // run, reusing the slots.
+  void Resolve(const VariableNameMap& innames, const VariableNameMap& outnames,
+               const Scope& scope);
+
+  const std::vector<Variable*>& InputVars(const std::string& name) const;
+  const std::vector<Variable*>& OutputVars(const std::string& name) const;
+
+  VariableValueMap inputs;
+  VariableValueMap outputs;
+};
+
 /**
  * OperatorBase has the basic element that Net will call to do computation.
  * Only CreateOperator from OpRegistry will new Operator directly. User
@@ -85,6 +114,11 @@ class OperatorBase {
   //  The implementation should be written at RunImpl
   void Run(const Scope& scope, const platform::Place& place);
 
+  /// Run with the variables of the op resolved in scope by runtime_ctx,
+  /// which is the same as Run if runtime_ctx is nullptr.
+  void Run(const Scope& scope, const platform::Place& place,
+           const RuntimeContext* runtime_ctx);
+
   // FIXME(typhoonzero): this is only used for recv_op to stop event_loop.
   virtual void Stop() {}
 
@@ -98,9 +132,9 @@ class OperatorBase {
 
   template <typename T>
   inline const T& Attr(const std::string& name) const {
-    PADDLE_ENFORCE(attrs_.count(name) != 0, "%s should be in AttributeMap",
-                   name);
-    return boost::get<T>(attrs_.at(name));
+    auto it = attrs_.find(name);
+    PADDLE_ENFORCE(it != attrs_.end(), "%s should be in AttributeMap", name);
+    return boost::get<T>(it->second);
   }
   const AttributeMap& Attrs() const { return attrs_; }
 
@@ -140,15 +174,28 @@ class OperatorBase {
  private:
   void GenerateTemporaryNames();
   void CheckAllInputOutputSet() const;
+  // Run with the allocations tagged by the op and its outputs.
+  void RunWithMemoryProfiler(const Scope& scope, const platform::Place& place,
+                             const RuntimeContext* runtime_ctx) const;
   virtual void RunImpl(const Scope& scope,
                        const platform::Place& place) const = 0;
+  // Only the operators with kernels use the runtime context.
+  virtual void RunImplWithContext(const Scope& scope,
+                                  const platform::Place& place,
+                                  const RuntimeContext* runtime_ctx) const {
+    RunImpl(scope, place);
+  }
 };
 
 class ExecutionContext {
  public:
   ExecutionContext(const OperatorBase& op, const Scope& scope,
-                   const platform::DeviceContext& device_context)
-      : op_(op), scope_(scope), device_context_(device_context) {}
+                   const platform::DeviceContext& device_context,
+                   const RuntimeContext* runtime_ctx = nullptr)
+      : op_(op),
+        scope_(scope),
+        device_context_(device_context),
+        runtime_ctx_(runtime_ctx) {}
 
   const OperatorBase& op() const { return op_; }
 
@@ -172,17 +219,27 @@ class ExecutionContext {
   }
 
   const Variable* InputVar(const std::string& name) const {
+    if (runtime_ctx_ != nullptr) {
+      return SingleVar(runtime_ctx_->InputVars(name), name);
+    }
     auto ipt = op_.Input(name);
     return ipt == kEmptyVarName ? nullptr : scope_.FindVar(ipt);
   }
 
   Variable* OutputVar(const std::string& name) const {
+    if (runtime_ctx_ != nullptr) {
+      return SingleVar(runtime_ctx_->OutputVars(name), name);
+    }
     auto opt = op_.Output(name);
     return opt == kEmptyVarName ? nullptr : scope_.FindVar(opt);
   }
 
   const std::vector<const Variable*> MultiInputVar(
       const std::string& name) const {
+    if (runtime_ctx_ != nullptr) {
+      auto& vars = runtime_ctx_->InputVars(name);
+      return std::vector<const Variable*>(vars.begin(), vars.end());
+    }
     auto names = op_.Inputs(name);
     std::vector<const Variable*> res;
     res.reserve(names.size());
@@ -195,6 +252,9 @@ class ExecutionContext {
   }
 
   std::vector<Variable*> MultiOutputVar(const std::string& name) const {
+    if (runtime_ctx_ != nullptr) {
+      return runtime_ctx_->OutputVars(name);
+    }
     auto names = op_.Outputs(name);
     std::vector<Variable*> res;
     res.reserve(names.size());
@@ -220,6 +280,16 @@ class ExecutionContext {
 
   template <typename T>
   const std::vector<const T*> MultiInput(const std::string& name) const {
+    if (runtime_ctx_ != nullptr) {
+      auto& vars = runtime_ctx_->InputVars(name);
+      std::vector<const T*> res;
+      res.reserve(vars.size());
+      std::transform(vars.begin(), vars.end(), std::back_inserter(res),
+                     [](const Variable* var) {
+                       return var == nullptr ? nullptr : &var->Get<T>();
+                     });
+      return res;
+    }
     auto names = op_.Inputs(name);
     std::vector<const T*> res;
     res.reserve(names.size());
@@ -233,6 +303,16 @@ class ExecutionContext {
 
   template <typename T>
   std::vector<T*> MultiOutput(const std::string& name) const {
+    if (runtime_ctx_ != nullptr) {
+      auto& vars = runtime_ctx_->OutputVars(name);
+      std::vector<T*> res;
+      res.reserve(vars.size());
+      std::transform(vars.begin(), vars.end(), std::back_inserter(res),
+                     [](Variable* var) {
+                       return var == nullptr ? nullptr : var->GetMutable<T>();
+                     });
+      return res;
+    }
     auto names = op_.Outputs(name);
     std::vector<T*> res;
     res.reserve(names.size());
@@ -273,10 +353,22 @@ class ExecutionContext {
     return op_.Outputs(name);
   }
 
+  const RuntimeContext* runtime_ctx() const { return runtime_ctx_; }
+
  private:
+  Variable* SingleVar(const std::vector<Variable*>& vars,
+                      const std::string& name) const {
+    PADDLE_ENFORCE_LE(vars.size(), 1UL,
+                      "Operator %s's argument %s should contain only one "
+                      "variable.",
+                      op_.Type(), name);
+    return vars.empty() ? nullptr : vars[0];
+  }
+
   const OperatorBase& op_;
   const Scope& scope_;
   const platform::DeviceContext& device_context_;
+  const RuntimeContext* runtime_ctx_;
 };
 
 template <>
@@ -341,6 +433,25 @@ class OperatorWithKernel : public OperatorBase {
     OpInfoMap::Instance().Get(Type()).infer_shape_(ctx);
   }
 
+  // Cache the transformed copies of the inputs var_names and reuse them in
+  // the following runs instead of transforming them again. The inputs should
+  // not be changed in place between the runs, e.g. the parameters of an
+  // inference program. A copy is transformed again when its input is
+  // reallocated or resized.
+  void SetTransferCacheVars(const std::unordered_set<std::string>& var_names);
+
+  // Drop the cached copies, e.g. after the inputs are replaced. The copies
+  // are matched by the address of the input, which the allocator may reuse
+  // once the old input is freed.
+  void ClearTransferCache();
+
+  // Whether the outputs only depend on the shapes and the data types of the
+  // inputs and on the attributes, like the boxes of prior_box. The outputs of
+  // such an op are kept when FLAGS_cache_shape_deterministic_outputs is set,
+  // and copied to the outputs of the following runs with the same input
+  // shapes instead of running the kernel.
+  virtual bool IsShapeDeterministic() const { return false; }
+
  protected:
   virtual OpKernelType GetExpectedKernelType(const ExecutionContext& ctx) const;
   virtual OpKernelType GetKernelTypeForVar(
@@ -352,6 +463,8 @@ class OperatorWithKernel : public OperatorBase {
   // same.
   proto::VarType::Type IndicateDataType(const ExecutionContext& ctx) const;
   void RunImpl(const Scope& scope, const platform::Place& place) const final;
+  void RunImplWithContext(const Scope& scope, const platform::Place& place,
+                          const RuntimeContext* runtime_ctx) const final;
 
   /**
    * Transfer data from scope to a transfered scope. If there is no data need to
@@ -361,11 +474,31 @@ class OperatorWithKernel : public OperatorBase {
    */
   Scope* TryTransferData(
       const Scope& scope, const OpKernelType& expected_kernel_key,
+      const RuntimeContext* runtime_ctx,
       std::vector<std::string>* transfered_inplace_vars) const;
 
   void TransferInplaceVarsBack(const Scope& scope,
                                const std::vector<std::string>& inplace_vars,
                                const Scope& exec_scope) const;
+
+  /**
+   * The kernel chosen by the last run, together with the data type, layout
+   * and place of every input it was chosen for. It is only used when
+   * FLAGS_enable_kernel_cache is set, and is swapped atomically so that the
+   * same op can be run from several threads.
+   */
+  struct KernelCache;
+  mutable std::shared_ptr<KernelCache> kernel_cache_;
+
+  // The transformed copies of the inputs set by SetTransferCacheVars.
+  struct TransferCache;
+  std::shared_ptr<TransferCache> transfer_cache_;
+
+  // The outputs of a shape deterministic op for the input shapes of the last
+  // run, swapped atomically like the kernel cache. The output variables share
+  // them read-only, a write to an output copies it first.
+  struct OutputCache;
+  mutable std::shared_ptr<OutputCache> output_cache_;
 };
 
 extern bool OpSupportGPU(const std::string& op_type);
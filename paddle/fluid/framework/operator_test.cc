@@ -108,6 +108,7 @@ class OpKernelTestProtoAndCheckerMaker : public OpProtoAndCheckerMaker {
 };
 
 static int cpu_kernel_run_num = 0;
+static int expected_kernel_type_num = 0;
 
 class OpWithKernelTest : public OperatorWithKernel {
  public:
@@ -117,6 +118,7 @@ class OpWithKernelTest : public OperatorWithKernel {
   void InferShape(framework::InferShapeContext* ctx) const override {}
   OpKernelType GetExpectedKernelType(
       const ExecutionContext& ctx) const override {
+    expected_kernel_type_num++;
     return OpKernelType(proto::VarType::FP32, ctx.GetPlace());
   }
 };
@@ -220,6 +222,120 @@ REGISTER_OP_WITHOUT_GRADIENT(
 REGISTER_OP_CPU_KERNEL(op_multi_inputs_with_kernel,
                        paddle::framework::CPUKernalMultiInputsTest);
 
+DECLARE_bool(enable_kernel_cache);
+
+// test the cached kernel is reused while the inputs do not change
+TEST(OpKernel, kernel_cache) {
+  paddle::framework::InitDevices(true);
+  paddle::framework::proto::OpDesc op_desc;
+  op_desc.set_type("op_with_kernel");
+  BuildVar("x", {"IN1"}, op_desc.add_inputs());
+  BuildVar("y", {"OUT1"}, op_desc.add_outputs());
+
+  // the flag is restored when the test returns or fails
+  google::FlagSaver flag_saver;
+  FLAGS_enable_kernel_cache = true;
+  paddle::platform::CPUPlace cpu_place;
+  paddle::framework::Scope scope;
+  auto* x = scope.Var("IN1")->GetMutable<paddle::framework::LoDTensor>();
+  x->Resize({2, 3});
+  x->mutable_data<float>(cpu_place);
+
+  auto op = paddle::framework::OpRegistry::CreateOp(op_desc);
+  int run_num = paddle::framework::cpu_kernel_run_num;
+  int lookup_num = paddle::framework::expected_kernel_type_num;
+  op->Run(scope, cpu_place);
+  ASSERT_EQ(paddle::framework::expected_kernel_type_num, lookup_num + 1);
+  // the second run takes the kernel from the cache without looking it up
+  op->Run(scope, cpu_place);
+  ASSERT_EQ(paddle::framework::cpu_kernel_run_num, run_num + 2);
+  ASSERT_EQ(paddle::framework::expected_kernel_type_num, lookup_num + 1);
+
+  // changing the input data type invalidates the cache
+  x->mutable_data<double>(cpu_place);
+  op->Run(scope, cpu_place);
+  ASSERT_EQ(paddle::framework::cpu_kernel_run_num, run_num + 3);
+  ASSERT_EQ(paddle::framework::expected_kernel_type_num, lookup_num + 2);
+}
+
+namespace paddle {
+namespace framework {
+
+class ShapeDeterministicOpTest : public OpWithKernelTest {
+ public:
+  using OpWithKernelTest::OpWithKernelTest;
+
+  bool IsShapeDeterministic() const override { return true; }
+};
+
+static int shape_deterministic_kernel_run_num = 0;
+
+class CPUKernelShapeDeterministicTest : public OpKernel<float> {
+ public:
+  void Compute(const ExecutionContext& ctx) const {
+    shape_deterministic_kernel_run_num++;
+    auto* x = ctx.Input<Tensor>("x");
+    auto* y = ctx.Output<Tensor>("y");
+    float* y_data = y->mutable_data<float>(x->dims(), ctx.GetPlace());
+    for (int64_t i = 0; i < x->numel(); ++i) {
+      y_data[i] = static_cast<float>(x->dims()[0]);
+    }
+  }
+};
+
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_OP_WITHOUT_GRADIENT(
+    op_shape_deterministic, paddle::framework::ShapeDeterministicOpTest,
+    paddle::framework::OpKernelTestProtoAndCheckerMaker);
+REGISTER_OP_CPU_KERNEL(op_shape_deterministic,
+                       paddle::framework::CPUKernelShapeDeterministicTest);
+
+// test the outputs are reused while the input shapes do not change
+TEST(OpKernel, shape_deterministic) {
+  paddle::framework::InitDevices(true);
+  paddle::framework::proto::OpDesc op_desc;
+  op_desc.set_type("op_shape_deterministic");
+  BuildVar("x", {"IN1"}, op_desc.add_inputs());
+  BuildVar("y", {"OUT1"}, op_desc.add_outputs());
+
+  paddle::platform::CPUPlace cpu_place;
+  paddle::framework::Scope scope;
+  auto* x = scope.Var("IN1")->GetMutable<paddle::framework::LoDTensor>();
+  x->Resize({2, 3});
+  x->mutable_data<float>(cpu_place);
+  auto* y = scope.Var("OUT1")->GetMutable<paddle::framework::LoDTensor>();
+
+  auto op = paddle::framework::OpRegistry::CreateOp(op_desc);
+  op->Run(scope, cpu_place);
+  ASSERT_EQ(paddle::framework::shape_deterministic_kernel_run_num, 1);
+
+  // the cached output is shared even if the output is cleared
+  y->clear();
+  op->Run(scope, cpu_place);
+  ASSERT_EQ(paddle::framework::shape_deterministic_kernel_run_num, 1);
+  ASSERT_EQ(y->dims(), paddle::framework::make_ddim({2, 3}));
+  EXPECT_EQ(y->data<float>()[5], 2.f);
+
+  // writing the output does not change the cached one
+  const float* cached = y->data<float>();
+  float* y_data = y->mutable_data<float>(cpu_place);
+  EXPECT_NE(y_data, cached);
+  y_data[5] = -1.f;
+  op->Run(scope, cpu_place);
+  ASSERT_EQ(paddle::framework::shape_deterministic_kernel_run_num, 1);
+  EXPECT_EQ(y->data<float>(), cached);
+  EXPECT_EQ(y->data<float>()[5], 2.f);
+
+  // changing the input shape runs the kernel again
+  x->Resize({4, 3});
+  x->mutable_data<float>(cpu_place);
+  op->Run(scope, cpu_place);
+  ASSERT_EQ(paddle::framework::shape_deterministic_kernel_run_num, 2);
+  EXPECT_EQ(y->data<float>()[11], 4.f);
+}
+
 // test with multi inputs
 TEST(OpKernel, multi_inputs) {
   paddle::framework::InitDevices(true);
@@ -247,3 +363,143 @@ TEST(OpKernel, multi_inputs) {
   auto op = paddle::framework::OpRegistry::CreateOp(op_desc);
   op->Run(scope, cpu_place);
 }
+
+// test the variables resolved by the runtime context are used instead of the
+// ones in the scope
+TEST(OpKernel, runtime_context) {
+  paddle::framework::InitDevices(true);
+  paddle::framework::proto::OpDesc op_desc;
+
+  op_desc.set_type("op_multi_inputs_with_kernel");
+  BuildVar("xs", {"x0", "x1", "x2"}, op_desc.add_inputs());
+  BuildVar("k", {"k0"}, op_desc.add_inputs());
+  BuildVar("ys", {"y0", "y1"}, op_desc.add_outputs());
+
+  paddle::platform::CPUPlace cpu_place;
+  paddle::framework::Scope scope;
+  for (auto& name : {"x0", "x1", "x2", "k0", "y0", "y1"}) {
+    scope.Var(name)->GetMutable<paddle::framework::LoDTensor>();
+  }
+
+  auto op = paddle::framework::OpRegistry::CreateOp(op_desc);
+  paddle::framework::RuntimeContext runtime_ctx(op->Inputs(), op->Outputs(),
+                                                scope);
+  ASSERT_EQ(runtime_ctx.InputVars("xs").size(), 3UL);
+  ASSERT_EQ(runtime_ctx.InputVars("k")[0], scope.FindVar("k0"));
+  ASSERT_EQ(runtime_ctx.OutputVars("ys")[1], scope.FindVar("y1"));
+
+  // The kernel finds its variables although the scope is empty.
+  paddle::framework::Scope empty_scope;
+  op->Run(empty_scope, cpu_place, &runtime_ctx);
+
+  paddle::framework::Scope other_scope;
+  auto* k0 = other_scope.Var("k0");
+  runtime_ctx.Resolve(op->Inputs(), op->Outputs(), other_scope);
+  ASSERT_EQ(runtime_ctx.InputVars("k")[0], k0);
+  ASSERT_EQ(runtime_ctx.InputVars("xs")[0], nullptr);
+}
+
+namespace paddle {
+namespace framework {
+
+class OpWithTransferTest : public OperatorWithKernel {
+ public:
+  using OperatorWithKernel::OperatorWithKernel;
+
+ protected:
+  void InferShape(framework::InferShapeContext* ctx) const override {}
+  OpKernelType GetExpectedKernelType(
+      const ExecutionContext& ctx) const override {
+    return OpKernelType(proto::VarType::FP32, ctx.GetPlace());
+  }
+  // The input is transformed to the data type of the kernel.
+  OpKernelType GetKernelTypeForVar(
+      const std::string& var_name, const Tensor& tensor,
+      const OpKernelType& expected_kernel_type) const override {
+    return OpKernelType(ToDataType(tensor.type()), tensor.place(),
+                        tensor.layout());
+  }
+};
+
+class OpWithTransferTestProtoAndCheckerMaker : public OpProtoAndCheckerMaker {
+ public:
+  void Make() {
+    AddInput("x", "input of test op");
+    AddOutput("y", "output of test op");
+    AddComment("This is test op");
+  }
+};
+
+class CPUKernelTransferTest : public OpKernel<float> {
+ public:
+  void Compute(const ExecutionContext& ctx) const {
+    auto* x = ctx.Input<Tensor>("x");
+    auto* y = ctx.Output<Tensor>("y");
+    y->Resize(x->dims());
+    std::copy(x->data<float>(), x->data<float>() + x->numel(),
+              y->mutable_data<float>(ctx.GetPlace()));
+  }
+};
+
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_OP_WITHOUT_GRADIENT(
+    op_with_transfer, paddle::framework::OpWithTransferTest,
+    paddle::framework::OpWithTransferTestProtoAndCheckerMaker);
+REGISTER_OP_CPU_KERNEL(op_with_transfer,
+                       paddle::framework::CPUKernelTransferTest);
+
+// test the transformed copy of an input is reused until it is reallocated
+TEST(OpKernel, transfer_cache) {
+  paddle::framework::InitDevices(true);
+  paddle::framework::proto::OpDesc op_desc;
+  op_desc.set_type("op_with_transfer");
+  BuildVar("x", {"IN1"}, op_desc.add_inputs());
+  BuildVar("y", {"OUT1"}, op_desc.add_outputs());
+
+  paddle::platform::CPUPlace cpu_place;
+  paddle::framework::Scope scope;
+  auto* x = scope.Var("IN1")->GetMutable<paddle::framework::LoDTensor>();
+  auto* y = scope.Var("OUT1")->GetMutable<paddle::framework::LoDTensor>();
+  double* x_data = x->mutable_data<double>({2}, cpu_place);
+  x_data[0] = 1;
+  x_data[1] = 2;
+
+  auto op = paddle::framework::OpRegistry::CreateOp(op_desc);
+  auto* op_with_kernel =
+      dynamic_cast<paddle::framework::OperatorWithKernel*>(op.get());
+  ASSERT_NE(op_with_kernel, nullptr);
+  op_with_kernel->SetTransferCacheVars({"IN1"});
+  op->Run(scope, cpu_place);
+  ASSERT_EQ(y->data<float>()[1], 2.f);
+
+  // the input changed in place is not transformed again
+  x_data[1] = 3;
+  op->Run(scope, cpu_place);
+  ASSERT_EQ(y->data<float>()[1], 2.f);
+
+  // the reallocated input is transformed again
+  x->Resize({3});
+  x_data = x->mutable_data<double>(cpu_place);
+  x_data[0] = 4;
+  x_data[1] = 5;
+  x_data[2] = 6;
+  op->Run(scope, cpu_place);
+  ASSERT_EQ(y->numel(), 3);
+  ASSERT_EQ(y->data<float>()[2], 6.f);
+
+  // the input is transformed again after the cache is cleared
+  x_data[2] = 8;
+  op->Run(scope, cpu_place);
+  ASSERT_EQ(y->data<float>()[2], 6.f);
+  op_with_kernel->ClearTransferCache();
+  op->Run(scope, cpu_place);
+  ASSERT_EQ(y->data<float>()[2], 8.f);
+
+  // the other inputs are transformed in every run
+  op_with_kernel->SetTransferCacheVars({});
+  x_data[2] = 7;
+  op->Run(scope, cpu_place);
+  ASSERT_EQ(y->data<float>()[2], 7.f);
+}
@@ -15,8 +15,13 @@ limitations under the License. */
 #include "paddle/fluid/framework/parallel_executor.h"
 #include <string>
 #include <tuple>
+#include <unordered_set>
 #include <vector>
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/ir/gradient_accumulation_pass.h"
 #include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/operators/math/math_function.h"
 
 #include "paddle/fluid/framework/ir/graph.h"
 
@@ -28,7 +33,9 @@ limitations under the License. */
 #include "paddle/fluid/framework/details/multi_devices_helper.h"
 #include "paddle/fluid/framework/details/scope_buffered_ssa_graph_executor.h"
 #include "paddle/fluid/framework/details/threaded_ssa_graph_executor.h"
+#include "paddle/fluid/framework/details/work_stealing_ssa_graph_executor.h"
 #include "paddle/fluid/platform/profiler.h"
+#include "paddle/fluid/platform/sampling_profiler.h"
 
 namespace paddle {
 namespace framework {
@@ -49,6 +56,16 @@ class ParallelExecutorPrivate {
   bool own_local_scope_;
   bool use_cuda_;
   bool use_all_reduce_;
+
+  size_t num_accumulation_steps_{1};
+  size_t accumulation_step_{0};
+  // True in the gradient accumulation steps but the last one, where the
+  // optimize ops are skipped.
+  bool skip_optimize_ops_{false};
+
+  // The parameters broadcast at the beginning of the iteration, and the
+  // devices optimizing them.
+  std::unordered_map<std::string, int> deferred_bcast_vars_;
 };
 
 std::vector<Scope *> &ParallelExecutor::GetLocalScopes() {
@@ -101,6 +118,20 @@ ParallelExecutor::ParallelExecutor(
     }
     member_->nccl_ctxs_.reset(new platform::NCCLContextMap(
         member_->places_, nccl_id, num_trainers, trainer_id));
+    if (build_strategy.use_hierarchical_allreduce_ && num_trainers > 1 &&
+        member_->places_.size() > 1) {
+      std::vector<ncclUniqueId *> inter_ids;
+      for (size_t i = 0; i < member_->places_.size(); ++i) {
+        auto *var = scope->FindVar(platform::InterNCCLIdVarName(i));
+        PADDLE_ENFORCE_NOT_NULL(
+            var, "Variable %s is not found, the hierarchical allreduce needs "
+                 "the inter-trainer NCCL ids generated by gen_nccl_id.",
+            platform::InterNCCLIdVarName(i));
+        inter_ids.emplace_back(var->GetMutable<ncclUniqueId>());
+      }
+      member_->nccl_ctxs_->InitHierarchicalComms(inter_ids, num_trainers,
+                                                 trainer_id);
+    }
 #else
     PADDLE_THROW("Not compiled with CUDA");
 #endif
@@ -147,6 +178,16 @@ ParallelExecutor::ParallelExecutor(
                            params, member_->local_scopes_, member_->use_cuda_);
 #endif
 
+  if (graph->Has(details::kDeferredBroadcastVars)) {
+    member_->deferred_bcast_vars_ = graph->Get<details::ShardedVarDevice>(
+        details::kDeferredBroadcastVars);
+  }
+
+  member_->num_accumulation_steps_ = build_strategy.num_accumulation_steps_;
+  if (member_->num_accumulation_steps_ > 1) {
+    InitGradientAccumulation(graph.get());
+  }
+
   // Step 3. Create vars in each scope. Passes may also create new vars.
   //         skip control vars and empty vars
   std::vector<details::VariableInfo> var_infos;
@@ -167,6 +208,9 @@ ParallelExecutor::ParallelExecutor(
   if (exec_strategy.type_ == ExecutionStrategy::kDefault) {
     member_->executor_.reset(new details::ThreadedSSAGraphExecutor(
         exec_strategy, member_->local_scopes_, places, std::move(graph)));
+  } else if (exec_strategy.type_ == ExecutionStrategy::kWorkStealing) {
+    member_->executor_.reset(new details::WorkStealingSSAGraphExecutor(
+        exec_strategy, member_->local_scopes_, places, std::move(graph)));
   } else {
     member_->executor_.reset(new details::FastThreadedSSAGraphExecutor(
         exec_strategy, member_->local_scopes_, places, std::move(graph)));
@@ -177,11 +221,82 @@ ParallelExecutor::ParallelExecutor(
       member_->places_, std::move(member_->executor_)));
 }
 
+void ParallelExecutor::InitGradientAccumulation(ir::Graph *graph) const {
+  // Zero the accumulation buffers of each device.
+  auto &buffers = graph->Get<std::unordered_set<std::string>>(
+      ir::kGradientAccumulationBuffers);
+  std::unordered_set<std::string> initialized;
+  for (ir::Node *node : graph->Nodes()) {
+    if (!node->IsVar() || node->Var() == nullptr ||
+        buffers.count(node->Name()) == 0 ||
+        !initialized.insert(node->Name()).second) {
+      continue;
+    }
+    for (size_t i = 0; i < member_->places_.size(); ++i) {
+      auto &place = member_->places_[i];
+      auto *buffer =
+          member_->local_scopes_[i]->Var(node->Name())->GetMutable<LoDTensor>();
+      buffer->Resize(make_ddim(node->Var()->GetShape()));
+      buffer->mutable_data(place, ToTypeIndex(node->Var()->GetDataType()));
+      operators::math::set_constant(
+          *platform::DeviceContextPool::Instance().Get(place), buffer, 0.f);
+    }
+  }
+  for (auto &place : member_->places_) {
+    platform::DeviceContextPool::Instance().Get(place)->Wait();
+  }
+
+  // Skip the optimize ops, and the ops without an OpDesc depending on them,
+  // e.g. the all reduce and broadcast ops, but in the last accumulation step.
+  const int update_roles = static_cast<int>(OpRole::kOptimize) |
+                           static_cast<int>(OpRole::kLRSched) |
+                           static_cast<int>(OpRole::kRPC) |
+                           static_cast<int>(OpRole::kDist);
+  const std::string role_name = OpProtoAndCheckerMaker::OpRoleAttrName();
+  std::unordered_set<details::OpHandleBase *> skipped;
+  auto &ops = graph->Get<details::GraphOps>(details::kGraphOps);
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (auto &op : ops) {
+      if (skipped.count(op.get())) continue;
+      bool skip = false;
+      auto *op_desc = op->Node()->Op();
+      if (op_desc != nullptr) {
+        skip = op_desc->HasAttr(role_name) &&
+               (boost::get<int>(op_desc->GetAttr(role_name)) & update_roles);
+      } else {
+        for (auto *in : op->Inputs()) {
+          skip = skip || (in->GeneratedOp() != nullptr &&
+                          skipped.count(in->GeneratedOp()) != 0);
+        }
+      }
+      if (skip) {
+        op->SetSkipCondition(&member_->skip_optimize_ops_);
+        skipped.insert(op.get());
+        changed = true;
+      }
+    }
+  }
+  VLOG(3) << skipped.size() << " of " << ops.size()
+          << " ops run only in the last gradient accumulation step";
+}
+
+void ParallelExecutor::SyncDeferredBroadcasts() {
+  std::vector<std::unordered_set<std::string>> vars(member_->places_.size());
+  for (auto &var : member_->deferred_bcast_vars_) {
+    vars[var.second].insert(var.first);
+  }
+  for (size_t i = 0; i < vars.size(); ++i) {
+    if (!vars[i].empty()) BCastParamsToDevices(vars[i], i);
+  }
+}
+
 void ParallelExecutor::BCastParamsToDevices(
-    const std::unordered_set<std::string> &vars) const {
-  // the initializing bcast, all vars would be bcast from device(0).
+    const std::unordered_set<std::string> &vars, size_t src_dev_id) const {
+  // bcast from device(src_dev_id), which is device(0) at initialization.
   for (auto &var : vars) {
-    framework::Variable *main_var = member_->local_scopes_[0]->FindVar(var);
+    framework::Variable *main_var =
+        member_->local_scopes_[src_dev_id]->FindVar(var);
     if (main_var == nullptr || !main_var->IsType<LoDTensor>()) {
       continue;
     }
@@ -201,7 +316,7 @@ void ParallelExecutor::BCastParamsToDevices(
         auto place = member_->places_[i];
         void *buffer;
 
-        if (i == 0) {
+        if (i == src_dev_id) {
           buffer = const_cast<void *>(main_tensor.data<void>());
         } else {
           auto local_scope = member_->local_scopes_[i];
@@ -218,8 +333,9 @@ void ParallelExecutor::BCastParamsToDevices(
         platform::NCCLGroupGuard guard;
         for (size_t i = 0; i < member_->places_.size(); ++i) {
           auto &nccl_ctx = member_->nccl_ctxs_->at(member_->places_[i]);
-          platform::dynload::ncclBcast(buffers[i], numel, data_type, 0,
-                                       nccl_ctx.comm_, nccl_ctx.stream());
+          platform::dynload::ncclBcast(buffers[i], numel, data_type,
+                                       src_dev_id, nccl_ctx.comm_,
+                                       nccl_ctx.stream());
         }
         member_->nccl_ctxs_->WaitAll();
       }
@@ -229,7 +345,7 @@ void ParallelExecutor::BCastParamsToDevices(
     } else {
       platform::CPUPlace cpu;
       for (size_t i = 0; i < member_->places_.size(); ++i) {
-        if (i == 0) continue;
+        if (i == src_dev_id) continue;
 
         auto local_scope = member_->local_scopes_[i];
         auto *t = local_scope->Var(var)->GetMutable<LoDTensor>();
@@ -251,6 +367,7 @@ void ParallelExecutor::BCastParamsToDevices(
 void ParallelExecutor::Run(const std::vector<std::string> &fetch_tensors,
                            const std::string &fetched_var_name) {
   platform::RecordBlock b(0);
+  platform::SampledIteration sampled_iteration;
 #ifdef PADDLE_WITH_CUDA
   if (!gcs_.empty()) {
     ResetReferenceCount();
@@ -263,6 +380,10 @@ void ParallelExecutor::Run(const std::vector<std::string> &fetch_tensors,
     }
   }
 #endif
+  if (member_->num_accumulation_steps_ > 1) {
+    size_t step = ++member_->accumulation_step_;
+    member_->skip_optimize_ops_ = step % member_->num_accumulation_steps_ != 0;
+  }
   auto fetch_data = member_->executor_->Run(fetch_tensors);
   *member_->global_scope_->Var(fetched_var_name)->GetMutable<FeedFetchList>() =
       fetch_data;
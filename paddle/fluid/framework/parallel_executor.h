@@ -72,8 +72,16 @@ class ParallelExecutor {
   void Run(const std::vector<std::string> &fetch_tensors,
            const std::string &fetched_var_name);
 
+  // Broadcast the parameters optimized in the last iteration, which are
+  // deferred to the next one with BuildStrategy::overlap_broadcast_, e.g.
+  // before saving them.
+  void SyncDeferredBroadcasts();
+
  private:
-  void BCastParamsToDevices(const std::unordered_set<std::string> &vars) const;
+  void BCastParamsToDevices(const std::unordered_set<std::string> &vars,
+                            size_t src_dev_id = 0) const;
+
+  void InitGradientAccumulation(ir::Graph *graph) const;
 
   std::unique_ptr<ParallelExecutorPrivate> member_;
 
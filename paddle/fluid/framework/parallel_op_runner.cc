@@ -0,0 +1,171 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/parallel_op_runner.h"
+#include <algorithm>
+#include "paddle/fluid/platform/cpu_info.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+ParallelOpRunner::ParallelOpRunner(size_t num_ops, int num_threads)
+    : num_threads_(std::max(num_threads, 1)),
+      downstream_(num_ops),
+      num_deps_(num_ops, 0) {}
+
+ParallelOpRunner::~ParallelOpRunner() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ParallelOpRunner::AddDependency(size_t from, size_t to) {
+  PADDLE_ENFORCE_LT(from, to, "An operator can only depend on the former.");
+  PADDLE_ENFORCE_LT(to, downstream_.size());
+  auto &downstream = downstream_[from];
+  if (std::find(downstream.begin(), downstream.end(), to) !=
+      downstream.end()) {
+    return;
+  }
+  downstream.push_back(to);
+  ++num_deps_[to];
+}
+
+bool ParallelOpRunner::sequential() const {
+  // The graph is a chain iff every operator depends on the one right before
+  // it, then the longest path has all the operators.
+  for (size_t i = 1; i < downstream_.size(); ++i) {
+    auto &downstream = downstream_[i - 1];
+    if (std::find(downstream.begin(), downstream.end(), i) ==
+        downstream.end()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ParallelOpRunner::Run(const std::function<void(size_t)> &run_op) {
+  if (num_threads_ == 1 || sequential()) {
+    for (size_t i = 0; i < downstream_.size(); ++i) {
+      run_op(i);
+    }
+    return;
+  }
+  if (workers_.empty()) StartWorkers();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  run_op_ = &run_op;
+  pending_ = num_deps_;
+  remaining_ = downstream_.size();
+  in_flight_ = 0;
+  error_ = nullptr;
+  for (size_t i = 0; i < pending_.size(); ++i) {
+    if (pending_[i] == 0) ready_.push_back(i);
+  }
+  work_cv_.notify_all();
+
+  while (!Finished()) {
+    if (!ready_.empty() && error_ == nullptr) {
+      size_t idx = ready_.front();
+      ready_.pop_front();
+      Execute(&lock, idx);
+    } else {
+      done_cv_.wait(lock, [this] {
+        return Finished() || (!ready_.empty() && error_ == nullptr);
+      });
+    }
+  }
+  run_op_ = nullptr;
+  ready_.clear();
+  auto error = error_;
+  error_ = nullptr;
+  lock.unlock();
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+}
+
+void ParallelOpRunner::StartWorkers() {
+  int numa_node = platform::CurrentNumaNode();
+  for (size_t i = 1; i < num_threads_; ++i) {
+    workers_.emplace_back([this, numa_node] { WorkerLoop(numa_node); });
+  }
+}
+
+void ParallelOpRunner::WorkerLoop(int numa_node) {
+  if (numa_node >= 0) {
+    platform::BindCurrentThreadToNumaNode(numa_node);
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    work_cv_.wait(lock, [this] {
+      return stop_ || (!ready_.empty() && error_ == nullptr);
+    });
+    if (stop_) return;
+    size_t idx = ready_.front();
+    ready_.pop_front();
+    Execute(&lock, idx);
+  }
+}
+
+void ParallelOpRunner::Execute(std::unique_lock<std::mutex> *lock,
+                               size_t idx) {
+  while (true) {
+    ++in_flight_;
+    lock->unlock();
+    std::exception_ptr error;
+    try {
+      (*run_op_)(idx);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    lock->lock();
+    --in_flight_;
+    --remaining_;
+    if (error != nullptr && error_ == nullptr) {
+      error_ = error;
+    }
+
+    // Keep the first ready successor on this thread, it likely reads the
+    // output in the cache.
+    bool has_next = false;
+    size_t next = 0;
+    if (error_ == nullptr) {
+      for (auto to : downstream_[idx]) {
+        if (--pending_[to] != 0) continue;
+        if (!has_next) {
+          has_next = true;
+          next = to;
+        } else {
+          ready_.push_back(to);
+          work_cv_.notify_one();
+        }
+      }
+    }
+    if (Finished() || !ready_.empty()) {
+      done_cv_.notify_one();
+    }
+    if (!has_next) return;
+    idx = next;
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,89 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+/*
+ * Run the operators of a block by their dependencies, so that the
+ * independent branches, e.g. the towers of a multi-tower model, run at the
+ * same time. The operator i is run after all the operators it depends on,
+ * each of which should be before i in the block. The calling thread and
+ * num_threads - 1 workers run the operators, the workers are created by the
+ * first parallel Run and bound to the NUMA node of its thread.
+ *
+ * If no two operators are independent, Run runs them one by one on the
+ * calling thread without touching the workers.
+ *
+ * Run should not be called at the same time on several threads.
+ */
+class ParallelOpRunner {
+ public:
+  ParallelOpRunner(size_t num_ops, int num_threads);
+  ~ParallelOpRunner();
+
+  // Run the operator to after the operator from, with from < to.
+  void AddDependency(size_t from, size_t to);
+
+  // Call run_op with the index of every operator. The first exception thrown
+  // by run_op stops scheduling the operators and is rethrown after the ones
+  // running finish.
+  void Run(const std::function<void(size_t)>& run_op);
+
+  // Whether the operators are in one chain.
+  bool sequential() const;
+
+  size_t num_threads() const { return num_threads_; }
+
+ private:
+  void StartWorkers();
+  void WorkerLoop(int numa_node);
+  // Run the operator idx and then the successors made ready by it, one of
+  // them on this thread and the others by the workers. It is called and
+  // returns with the lock held.
+  void Execute(std::unique_lock<std::mutex>* lock, size_t idx);
+  bool Finished() const {
+    return remaining_ == 0 || (error_ != nullptr && in_flight_ == 0);
+  }
+
+  size_t num_threads_;
+  std::vector<std::vector<size_t>> downstream_;
+  std::vector<int> num_deps_;
+
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  std::vector<std::thread> workers_;
+  bool stop_{false};
+  // The states of the current Run, guarded by mutex_.
+  const std::function<void(size_t)>* run_op_{nullptr};
+  std::vector<int> pending_;
+  std::deque<size_t> ready_;
+  size_t remaining_{0};
+  size_t in_flight_{0};
+  std::exception_ptr error_;
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,103 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/parallel_op_runner.h"
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <mutex>   // NOLINT
+#include <stdexcept>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(ParallelOpRunner, Sequential) {
+  ParallelOpRunner runner(4, 4);
+  for (size_t i = 1; i < 4; ++i) {
+    runner.AddDependency(i - 1, i);
+  }
+  runner.AddDependency(0, 2);
+  EXPECT_TRUE(runner.sequential());
+
+  std::vector<size_t> order;
+  auto tid = std::this_thread::get_id();
+  runner.Run([&](size_t i) {
+    EXPECT_EQ(std::this_thread::get_id(), tid);
+    order.push_back(i);
+  });
+  EXPECT_EQ(order, std::vector<size_t>({0, 1, 2, 3}));
+}
+
+TEST(ParallelOpRunner, Branches) {
+  // 0 -> {1, 2} -> 3, the branches 1 and 2 wait for each other, so they
+  // have to run at the same time.
+  ParallelOpRunner runner(4, 2);
+  runner.AddDependency(0, 1);
+  runner.AddDependency(0, 2);
+  runner.AddDependency(1, 3);
+  runner.AddDependency(2, 3);
+  EXPECT_FALSE(runner.sequential());
+
+  for (int run = 0; run < 10; ++run) {
+    std::atomic<int> started{0};
+    std::atomic<bool> overlapped{true};
+    std::mutex mutex;
+    std::vector<size_t> order;
+    runner.Run([&](size_t i) {
+      if (i == 1 || i == 2) {
+        ++started;
+        auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (started < 2) {
+          if (std::chrono::steady_clock::now() > deadline) {
+            overlapped = false;
+            break;
+          }
+          std::this_thread::yield();
+        }
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      order.push_back(i);
+    });
+    EXPECT_TRUE(overlapped);
+    ASSERT_EQ(order.size(), 4UL);
+    EXPECT_EQ(order.front(), 0UL);
+    EXPECT_EQ(order.back(), 3UL);
+  }
+}
+
+TEST(ParallelOpRunner, Exception) {
+  ParallelOpRunner runner(4, 3);
+  runner.AddDependency(0, 3);
+  runner.AddDependency(1, 3);
+  runner.AddDependency(2, 3);
+
+  std::atomic<bool> last_run{false};
+  auto run_op = [&](size_t i) {
+    if (i == 1) throw std::runtime_error("op 1 fails");
+    if (i == 3) last_run = true;
+  };
+  EXPECT_THROW(runner.Run(run_op), std::runtime_error);
+  EXPECT_FALSE(last_run);
+
+  // The runner is usable after the failure.
+  std::atomic<int> num_run{0};
+  runner.Run([&](size_t) { ++num_run; });
+  EXPECT_EQ(num_run, 4);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,179 @@
+/* Copyright (c) 2016 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/pipeline_executor.h"
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/details/pipeline_graph_pass.h"
+#include "paddle/fluid/framework/details/scope_buffered_ssa_graph_executor.h"
+#include "paddle/fluid/framework/details/threaded_ssa_graph_executor.h"
+#include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/ir/pass.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/platform/profiler.h"
+
+namespace paddle {
+namespace framework {
+
+PipelineExecutor::PipelineExecutor(const std::vector<platform::Place> &places,
+                                   size_t num_micro_batches,
+                                   const ProgramDesc &main_program,
+                                   Scope *scope,
+                                   const ExecutionStrategy &exec_strategy)
+    : places_(places),
+      num_micro_batches_(num_micro_batches),
+      global_scope_(scope) {
+  PADDLE_ENFORCE(!places_.empty(), "There should be at least one stage.");
+  PADDLE_ENFORCE_GT(num_micro_batches_, 0UL);
+  std::vector<platform::Place> local_places;
+  for (auto &place : places_) {
+    stage_scopes_.push_back(&global_scope_->NewScope());
+    for (size_t i = 0; i < num_micro_batches_; ++i) {
+      local_scopes_.push_back(&stage_scopes_.back()->NewScope());
+      local_places.push_back(place);
+    }
+  }
+
+  auto pass = ir::PassRegistry::Instance().Get("pipeline_pass");
+  pass->SetNotOwned<const std::vector<platform::Place>>("places", &places_);
+  pass->SetNotOwned<const std::vector<Scope *>>("local_scopes",
+                                                &local_scopes_);
+  pass->Set<const size_t>("num_micro_batches",
+                          new size_t(num_micro_batches_));
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(main_program));
+  graph = pass->Apply(std::move(graph));
+  InitStageScopes(*graph);
+
+  std::vector<details::VariableInfo> var_infos;
+  for (auto &node : graph->Nodes()) {
+    if (node->IsVar() && !node->IsCtrlVar() && node->Var()) {
+      var_infos.emplace_back();
+      var_infos.back().name_ = node->Var()->Name();
+      var_infos.back().type_ = node->Var()->GetType();
+      var_infos.back().persistable_ = node->Var()->Persistable();
+    }
+  }
+
+  executor_.reset(new details::ThreadedSSAGraphExecutor(
+      exec_strategy, local_scopes_, local_places, std::move(graph)));
+  executor_.reset(new details::ScopeBufferedSSAGraphExecutor(
+      exec_strategy, local_scopes_, std::move(var_infos), local_places,
+      std::move(executor_)));
+}
+
+void PipelineExecutor::InitStageScopes(const ir::Graph &graph) const {
+  std::unordered_map<std::string, VarDesc *> var_descs;
+  for (ir::Node *node : graph.Nodes()) {
+    if (node->IsVar() && node->Var()) {
+      var_descs.emplace(node->Name(), node->Var());
+    }
+  }
+  auto &pool = platform::DeviceContextPool::Instance();
+
+  // The persistable variables are created in the stage scopes if they are
+  // not in the global scope, or copied there if they are on another place.
+  for (auto &pair : graph.Get<details::PipelineStageVars>(
+           details::kPipelineStageVars)) {
+    auto *global_var = global_scope_->FindVar(pair.first);
+    for (size_t stage : pair.second) {
+      auto &place = places_[stage];
+      if (global_var == nullptr) {
+        InitializeVariable(stage_scopes_[stage]->Var(pair.first),
+                           var_descs.at(pair.first)->GetType());
+        continue;
+      }
+      if (!global_var->IsType<LoDTensor>()) continue;
+      auto &src = global_var->Get<LoDTensor>();
+      if (!src.IsInitialized() || src.place() == place) continue;
+      auto *dst =
+          stage_scopes_[stage]->Var(pair.first)->GetMutable<LoDTensor>();
+      TensorCopy(src, place, *pool.Get(place), dst);
+      dst->set_lod(src.lod());
+    }
+  }
+
+  for (auto &pair : graph.Get<details::PipelineAccumulators>(
+           details::kPipelineAccumulators)) {
+    auto *desc = var_descs.at(pair.first);
+    auto &place = places_[pair.second];
+    auto *buffer =
+        stage_scopes_[pair.second]->Var(pair.first)->GetMutable<LoDTensor>();
+    buffer->Resize(make_ddim(desc->GetShape()));
+    buffer->mutable_data(place, ToTypeIndex(desc->GetDataType()));
+    operators::math::set_constant(*pool.Get(place), buffer, 0.f);
+  }
+  for (auto &place : places_) {
+    pool.Get(place)->Wait();
+  }
+}
+
+void PipelineExecutor::FeedAndSplitTensorIntoMicroBatches(
+    const std::unordered_map<std::string, LoDTensor> &tensors) {
+  for (auto &pair : tensors) {
+    // The micro-batches are copied to each place once.
+    std::map<platform::Place, std::vector<LoDTensor>> micro_batches;
+    for (size_t i = 0; i < places_.size(); ++i) {
+      auto &place = places_[i];
+      auto it = micro_batches.find(place);
+      if (it == micro_batches.end()) {
+        it = micro_batches
+                 .emplace(place, pair.second.SplitLoDTensor(
+                                     std::vector<platform::Place>(
+                                         num_micro_batches_, place)))
+                 .first;
+        PADDLE_ENFORCE_EQ(
+            it->second.size(), num_micro_batches_,
+            "The number of samples of current batch is less than the count "
+            "of micro-batches, currently, it is not allowed. (%d vs %d)",
+            it->second.size(), num_micro_batches_);
+      }
+      for (size_t j = 0; j < num_micro_batches_; ++j) {
+        auto *t = local_scopes_[i * num_micro_batches_ + j]
+                      ->Var(pair.first)
+                      ->GetMutable<LoDTensor>();
+        t->ShareDataWith(it->second[j]);
+        t->set_lod(it->second[j].lod());
+      }
+    }
+  }
+}
+
+void PipelineExecutor::Run(const std::vector<std::string> &fetch_tensors,
+                           const std::string &fetched_var_name) {
+  platform::RecordBlock b(0);
+  auto fetch_data = executor_->Run(fetch_tensors);
+  *global_scope_->Var(fetched_var_name)->GetMutable<FeedFetchList>() =
+      fetch_data;
+}
+
+PipelineExecutor::~PipelineExecutor() {
+  for (auto &p : places_) {
+    platform::DeviceContextPool::Instance().Get(p)->Wait();
+  }
+  // The executor is released before the scopes it runs in.
+  executor_.reset();
+  for (auto *scope : stage_scopes_) {
+    global_scope_->DeleteScope(scope);
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(pipeline_pass);
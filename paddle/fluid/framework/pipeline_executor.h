@@ -0,0 +1,76 @@
+/* Copyright (c) 2016 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/details/execution_strategy.h"
+#include "paddle/fluid/framework/details/ssa_graph_executor.h"
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/platform/macros.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace framework {
+
+using details::ExecutionStrategy;
+
+/*
+ * Run the main program as a pipeline of stages, one stage on each place,
+ * where a batch is split into num_micro_batches micro-batches streaming
+ * through the stages. See details::PipelineGraphBuilder for the partition of
+ * the program.
+ *
+ * Each stage has a child scope of the given scope, where the persistable
+ * variables on another place are copied to, and the micro-batches of the
+ * stage run in the child scopes of it.
+ */
+class PipelineExecutor {
+  DISABLE_COPY_AND_ASSIGN(PipelineExecutor);
+
+ public:
+  PipelineExecutor(const std::vector<platform::Place> &places,
+                   size_t num_micro_batches, const ProgramDesc &main_program,
+                   Scope *scope, const ExecutionStrategy &exec_strategy);
+
+  ~PipelineExecutor();
+
+  // Split each tensor into the micro-batches, which are fed to all the stages.
+  void FeedAndSplitTensorIntoMicroBatches(
+      const std::unordered_map<std::string, LoDTensor> &tensors);
+
+  void Run(const std::vector<std::string> &fetch_tensors,
+           const std::string &fetched_var_name);
+
+ private:
+  void InitStageScopes(const ir::Graph &graph) const;
+
+  std::vector<platform::Place> places_;
+  size_t num_micro_batches_;
+  Scope *global_scope_;
+  std::vector<Scope *> stage_scopes_;
+  // The scope of the micro-batch m on the stage s is local_scopes_[s * M + m].
+  std::vector<Scope *> local_scopes_;
+  std::unique_ptr<details::SSAGraphExecutor> executor_;
+};
+
+}  // namespace framework
+}  // namespace paddle
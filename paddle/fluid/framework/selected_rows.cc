@@ -14,6 +14,14 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/selected_rows.h"
 
+#include <gflags/gflags.h>
+#include <chrono>  // NOLINT
+#include <cstring>
+
+DEFINE_string(sparse_table_spill_dir, "",
+              "The directory of the files holding the rows evicted from the "
+              "sparse tables, they are dropped if it is empty.");
+
 namespace paddle {
 namespace framework {
 
@@ -85,6 +93,11 @@ void SerializeToStream(std::ostream& os, const SelectedRows& selected_rows,
   }
   // the 4st field, Tensor data
   TensorToStream(os, selected_rows.value(), dev_ctx);
+  // the 5st field, optional, the spilled rows of a sparse table
+  auto* spilled_rows = selected_rows.spilled_rows();
+  if (spilled_rows != nullptr && spilled_rows->size() > 0) {
+    spilled_rows->SerializeToStream(os);
+  }
 }
 
 void DeserializeFromStream(std::istream& is, SelectedRows* selected_rows,
@@ -113,62 +126,349 @@ void DeserializeFromStream(std::istream& is, SelectedRows* selected_rows,
   }
   // the 4st field, tensor which contains the data
   TensorFromStream(is, selected_rows->mutable_value(), dev_ctx);
+  // the 5st field, optional, the spilled rows of a sparse table
+  if (is.peek() != std::istream::traits_type::eof()) {
+    PADDLE_ENFORCE(!FLAGS_sparse_table_spill_dir.empty(),
+                   "The sparse table has spilled rows, please set "
+                   "FLAGS_sparse_table_spill_dir to load them");
+    selected_rows->InitSpilledRows(FLAGS_sparse_table_spill_dir);
+    selected_rows->spilled_rows()->DeserializeFromStream(is);
+  }
+}
+
+static int64_t NowSeconds() {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
 }
 
 bool SelectedRows::HasKey(int64_t key) const {
+  auto* shard = GetShard(key);
+  {
+    RWLockGuard guard(&shard->lock, RWLockGuard::Status::kRDLock);
+    if (shard->id_to_index.count(key) != 0) {
+      return true;
+    }
+  }
+  if (spilled_rows_ && spilled_rows_->Has(key)) {
+    return true;
+  }
+  // The rows may be set without building the index.
   return std::find(rows_.begin(), rows_.end(), key) == rows_.end() ? false
                                                                    : true;
 }
 
+int64_t SelectedRows::Index(int64_t key) const {
+  auto* shard = GetShard(key);
+  {
+    RWLockGuard guard(&shard->lock, RWLockGuard::Status::kRDLock);
+    auto iter = shard->id_to_index.find(key);
+    if (iter != shard->id_to_index.end()) {
+      return iter->second;
+    }
+  }
+  auto it = std::find(rows_.begin(), rows_.end(), key);
+  if (it == rows_.end()) {
+    PADDLE_THROW("id %s not in table", key);
+  }
+  return static_cast<int64_t>(std::distance(rows_.begin(), it));
+}
+
+size_t SelectedRows::RowBytes() const {
+  return value_->numel() / value_->dims()[0] * SizeOfType(value_->type());
+}
+
+char* SelectedRows::RowData(int64_t index) const {
+  return static_cast<char*>(value_->mutable_data(value_->place())) +
+         index * RowBytes();
+}
+
+int64_t SelectedRows::AppendKey(int64_t key, bool* reused) {
+  std::lock_guard<std::mutex> lock(*rows_mutex_);
+  auto vector_size = rows_.size();
+  PADDLE_ENFORCE_EQ(
+      indexed_rows_, static_cast<int64_t>(vector_size),
+      "id_to_index_ size %d should have the same size with rows_ %d",
+      indexed_rows_, vector_size);
+  int64_t row_num = static_cast<int64_t>(vector_size);
+  if (row_num == value_->dims()[0]) {
+    if (free_slots_.empty()) {
+      PADDLE_THROW("selected rows is full, then length exceed %d", row_num);
+    }
+    auto slot = free_slots_.back();
+    free_slots_.pop_back();
+    rows_[slot] = key;
+    *reused = true;
+    return slot;
+  }
+  // key logic to put a key into id_to_index_
+  rows_.push_back(key);
+  ++indexed_rows_;
+  *reused = false;
+  return row_num;
+}
+
+int64_t SelectedRows::InsertKey(IndexShard* shard, int64_t key) {
+  bool reused = false;
+  auto index = AppendKey(key, &reused);
+  // restore the spilled row of the key, an evicted slot without it starts
+  // from zero
+  bool restored =
+      spilled_rows_ != nullptr && spilled_rows_->Take(key, RowData(index));
+  if (reused && !restored) {
+    std::memset(RowData(index), 0, RowBytes());
+  }
+  if (reused && evict_enabled_) {
+    row_freq_[index].store(0, std::memory_order_relaxed);
+    row_epoch_[index].store(evict_epoch_, std::memory_order_relaxed);
+  }
+  shard->id_to_index[key] = index;
+  return index;
+}
+
 int64_t SelectedRows::AutoGrownIndex(int64_t key, bool auto_grown) {
-  rwlock_->RDLock();
-  auto iter = id_to_index_.find(key);
-  if (iter == id_to_index_.end()) {
-    rwlock_->UNLock();
-    if (!auto_grown) {
-      PADDLE_THROW("key %d not found", key);
+  auto* shard = GetShard(key);
+  RWLockGuard guard(&shard->lock, RWLockGuard::Status::kRDLock);
+  auto iter = shard->id_to_index.find(key);
+  if (iter != shard->id_to_index.end()) {
+    if (evict_enabled_) RecordAccess(iter->second, NowSeconds());
+    return iter->second;
+  }
+  guard.UnLock();
+  if (!auto_grown && !(spilled_rows_ && spilled_rows_->Has(key))) {
+    PADDLE_THROW("key %d not found", key);
+  }
+  guard.WRLock();
+  auto write_iter = shard->id_to_index.find(key);
+  int64_t index = write_iter != shard->id_to_index.end()
+                      ? write_iter->second
+                      : InsertKey(shard, key);
+  if (evict_enabled_) RecordAccess(index, NowSeconds());
+  return index;
+}
+
+int64_t SelectedRows::ExistingIndex(int64_t key) {
+  auto* shard = GetShard(key);
+  RWLockGuard guard(&shard->lock, RWLockGuard::Status::kRDLock);
+  auto iter = shard->id_to_index.find(key);
+  int64_t index = iter != shard->id_to_index.end() ? iter->second : -1;
+  if (index < 0 && spilled_rows_ != nullptr) {
+    guard.UnLock();
+    guard.WRLock();
+    auto write_iter = shard->id_to_index.find(key);
+    if (write_iter != shard->id_to_index.end()) {
+      index = write_iter->second;
+    } else if (spilled_rows_->Has(key)) {
+      index = InsertKey(shard, key);
     }
-    rwlock_->WRLock();
-    auto map_size = id_to_index_.size();
-    auto vector_size = rows_.size();
-    if (map_size != vector_size) {
-      rwlock_->UNLock();
-      PADDLE_THROW(
-          "id_to_index_ size %d should have the same size with rows_ %d",
-          map_size, vector_size);
+  }
+  if (index >= 0 && evict_enabled_) RecordAccess(index, NowSeconds());
+  return index;
+}
+
+void SelectedRows::GetIndexsByIds(const int64_t* ids, int64_t num,
+                                  std::vector<int64_t>* indexs,
+                                  bool auto_grown) {
+  indexs->resize(num);
+  // the positions of the ids in each shard
+  std::vector<std::vector<int64_t>> shard_ids(kIndexShardNum);
+  for (int64_t i = 0; i < num; ++i) {
+    shard_ids[GetShard(ids[i]) - index_shards_.get()].push_back(i);
+  }
+
+  bool record = evict_enabled_;
+  int64_t now = record ? NowSeconds() : 0;
+  std::vector<int64_t> missed;
+  for (int s = 0; s < kIndexShardNum; ++s) {
+    if (shard_ids[s].empty()) continue;
+    auto* shard = &index_shards_[s];
+    auto& id_to_index = shard->id_to_index;
+    missed.clear();
+    RWLockGuard guard(&shard->lock, RWLockGuard::Status::kRDLock);
+    for (auto i : shard_ids[s]) {
+      auto iter = id_to_index.find(ids[i]);
+      if (iter == id_to_index.end()) {
+        missed.push_back(i);
+      } else {
+        (*indexs)[i] = iter->second;
+        if (record) RecordAccess(iter->second, now);
+      }
     }
-    auto write_iter = id_to_index_.find(key);
-    if (write_iter == id_to_index_.end()) {
-      int row_num = rows_.size();
-      if (row_num == value_->dims()[0]) {
-        rwlock_->UNLock();
-        PADDLE_THROW("selected rows is full, then length exceed %d", row_num);
+    guard.UnLock();
+    if (missed.empty()) continue;
+    if (!auto_grown) {
+      for (auto i : missed) {
+        if (!(spilled_rows_ && spilled_rows_->Has(ids[i]))) {
+          PADDLE_THROW("key %d not found", ids[i]);
+        }
       }
-      // key logic to put a key into id_to_index_
-      rows_.push_back(key);
-      auto index = static_cast<int64_t>(rows_.size() - 1);
-      id_to_index_[key] = index;
-      rwlock_->UNLock();
-      return index;
-    } else {
-      auto index = write_iter->second;
-      rwlock_->UNLock();
-      return index;
     }
-  } else {
-    auto index = iter->second;
-    rwlock_->UNLock();
-    return index;
+
+    guard.WRLock();
+    for (auto i : missed) {
+      auto iter = id_to_index.find(ids[i]);
+      (*indexs)[i] =
+          iter == id_to_index.end() ? InsertKey(shard, ids[i]) : iter->second;
+      if (record) RecordAccess((*indexs)[i], now);
+    }
   }
 }
 
 void SelectedRows::SyncIndex() {
-  rwlock_->WRLock();
-  id_to_index_.clear();
-  for (size_t i = 0; i < rows_.size(); ++i) {
-    id_to_index_[rows_[i]] = i;
+  for (int s = 0; s < kIndexShardNum; ++s) {
+    index_shards_[s].lock.WRLock();
+  }
+  {
+    std::lock_guard<std::mutex> lock(*rows_mutex_);
+    for (int s = 0; s < kIndexShardNum; ++s) {
+      index_shards_[s].id_to_index.clear();
+    }
+    free_slots_.clear();
+    for (size_t i = 0; i < rows_.size(); ++i) {
+      if (rows_[i] == kEvictedRow) {
+        free_slots_.push_back(i);
+        continue;
+      }
+      GetShard(rows_[i])->id_to_index[rows_[i]] = i;
+    }
+    indexed_rows_ = static_cast<int64_t>(rows_.size());
+  }
+  for (int s = 0; s < kIndexShardNum; ++s) {
+    index_shards_[s].lock.UNLock();
+  }
+}
+
+void SelectedRows::Snapshot(SelectedRows* snapshot) const {
+  PADDLE_ENFORCE(platform::is_cpu_place(place()),
+                 "Only the sparse table on CPU could be snapshotted");
+  RWLockGuard guard(evict_lock_.get(), RWLockGuard::Status::kRDLock);
+  {
+    std::lock_guard<std::mutex> lock(*rows_mutex_);
+    snapshot->set_rows(rows_);
+  }
+  snapshot->set_height(height_);
+  TensorCopySync(*value_, platform::CPUPlace(), snapshot->mutable_value());
+}
+
+void SelectedRows::MarkUpdated(const int64_t* keys, int64_t num) {
+  if (!track_updated_) return;
+  std::lock_guard<std::mutex> lock(*updated_mutex_);
+  updated_keys_.insert(keys, keys + num);
+}
+
+void SelectedRows::TakeUpdatedRows(SelectedRows* updated) {
+  PADDLE_ENFORCE(platform::is_cpu_place(place()),
+                 "Only the sparse table on CPU could be snapshotted");
+  std::unordered_set<int64_t> keys;
+  {
+    std::lock_guard<std::mutex> lock(*updated_mutex_);
+    keys.swap(updated_keys_);
+  }
+  RWLockGuard guard(evict_lock_.get(), RWLockGuard::Status::kRDLock);
+  std::vector<int64_t> rows;
+  std::vector<int64_t> indexs;
+  rows.reserve(keys.size());
+  indexs.reserve(keys.size());
+  for (int64_t key : keys) {
+    auto* shard = GetShard(key);
+    RWLockGuard shard_guard(&shard->lock, RWLockGuard::Status::kRDLock);
+    auto iter = shard->id_to_index.find(key);
+    if (iter != shard->id_to_index.end()) {
+      rows.push_back(key);
+      indexs.push_back(iter->second);
+    }
+  }
+
+  auto dims = value_->dims();
+  dims[0] = static_cast<int64_t>(rows.size());
+  auto* value = updated->mutable_value();
+  value->Resize(dims);
+  char* dst = static_cast<char*>(
+      value->mutable_data(platform::CPUPlace(), value_->type()));
+  size_t row_bytes = RowBytes();
+  for (size_t i = 0; i < indexs.size(); ++i) {
+    std::memcpy(dst + i * row_bytes, RowData(indexs[i]), row_bytes);
+  }
+  updated->set_rows(rows);
+  updated->set_height(height_);
+}
+
+void SelectedRows::InitSpilledRows(const std::string& spill_dir) {
+  if (spilled_rows_ != nullptr) return;
+  PADDLE_ENFORCE(value_->IsInitialized() && value_->dims()[0] > 0,
+                 "The sparse table should be initialized before spilling");
+  spilled_rows_.reset(new SpilledRows(spill_dir, RowBytes()));
+}
+
+void SelectedRows::EnableEviction(int64_t min_freq, int64_t ttl,
+                                  const std::string& spill_dir) {
+  RWLockGuard guard(evict_lock_.get(), RWLockGuard::Status::kWRLock);
+  if (evict_enabled_) return;
+  PADDLE_ENFORCE(value_->IsInitialized(),
+                 "The sparse table should be initialized before eviction");
+  if (!spill_dir.empty()) {
+    InitSpilledRows(spill_dir);
+  }
+  int64_t capacity = value_->dims()[0];
+  int64_t now = NowSeconds();
+  row_freq_.reset(new std::atomic<int64_t>[capacity]);
+  row_access_.reset(new std::atomic<int64_t>[capacity]);
+  row_epoch_.reset(new std::atomic<int64_t>[capacity]);
+  for (int64_t i = 0; i < capacity; ++i) {
+    row_freq_[i].store(0, std::memory_order_relaxed);
+    row_access_[i].store(now, std::memory_order_relaxed);
+    row_epoch_[i].store(0, std::memory_order_relaxed);
+  }
+  evict_min_freq_ = min_freq;
+  evict_ttl_ = ttl;
+  evict_enabled_ = true;
+}
+
+bool SelectedRows::NeedEvict(int64_t num) const {
+  if (!evict_enabled_) return false;
+  std::lock_guard<std::mutex> lock(*rows_mutex_);
+  int64_t room = value_->dims()[0] - static_cast<int64_t>(rows_.size()) +
+                 static_cast<int64_t>(free_slots_.size());
+  return room < num;
+}
+
+int64_t SelectedRows::EvictRows() {
+  RWLockGuard guard(evict_lock_.get(), RWLockGuard::Status::kWRLock);
+  if (!evict_enabled_) return 0;
+  for (int s = 0; s < kIndexShardNum; ++s) {
+    index_shards_[s].lock.WRLock();
+  }
+  int64_t evicted = 0;
+  {
+    std::lock_guard<std::mutex> lock(*rows_mutex_);
+    int64_t now = NowSeconds();
+    for (size_t i = 0; i < rows_.size(); ++i) {
+      int64_t key = rows_[i];
+      if (key == kEvictedRow) continue;
+      int64_t freq = row_freq_[i].load(std::memory_order_relaxed);
+      int64_t access = row_access_[i].load(std::memory_order_relaxed);
+      int64_t epoch = row_epoch_[i].load(std::memory_order_relaxed);
+      bool expired = evict_ttl_ > 0 && now - access > evict_ttl_;
+      bool cold = freq < evict_min_freq_ && epoch < evict_epoch_;
+      if (!expired && !cold) {
+        row_freq_[i].store(freq / 2, std::memory_order_relaxed);
+        continue;
+      }
+      if (spilled_rows_ != nullptr) {
+        spilled_rows_->Put(key, RowData(i));
+      }
+      GetShard(key)->id_to_index.erase(key);
+      rows_[i] = kEvictedRow;
+      free_slots_.push_back(i);
+      ++evicted;
+    }
+    ++evict_epoch_;
+  }
+  for (int s = 0; s < kIndexShardNum; ++s) {
+    index_shards_[s].lock.UNLock();
   }
-  rwlock_->UNLock();
+  VLOG(3) << "evict " << evicted << " rows from the sparse table";
+  return evicted;
 }
 
 void SelectedRows::Get(const framework::Tensor& ids, framework::Tensor* value,
@@ -182,12 +482,14 @@ void SelectedRows::Get(const framework::Tensor& ids, framework::Tensor* value,
     PADDLE_ENFORCE_EQ(value_width, value->numel() / value->dims()[0],
                       "output tensor should have the same shape with table "
                       "except the dims[0].");
-    for (int i = 0; i < ids.numel(); ++i) {
-      int64_t index = AutoGrownIndex(ids.data<int64_t>()[i], auto_grown);
+    RWLockGuard guard(evict_lock_.get(), RWLockGuard::Status::kRDLock);
+    std::vector<int64_t> indexs;
+    GetIndexsByIds(ids.data<int64_t>(), ids.numel(), &indexs, auto_grown);
+    for (int64_t i = 0; i < ids.numel(); ++i) {
       framework::VisitDataType(
           framework::ToDataType(value_->type()),
           TensorCopyVisitor(value, i * value_width, *value_.get(),
-                            index * value_width, value_width));
+                            indexs[i] * value_width, value_width));
     }
   }
 }
@@ -15,14 +15,18 @@ limitations under the License. */
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/rw_lock.h"
+#include "paddle/fluid/framework/spilled_rows.h"
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/memory/memcpy.h"
 
@@ -50,13 +54,19 @@ class SelectedRows {
   SelectedRows(const std::vector<int64_t>& rows, const int64_t& height)
       : rows_(rows), height_(height) {
     value_.reset(new Tensor());
-    rwlock_.reset(new RWLock);
+    index_shards_.reset(new IndexShard[kIndexShardNum]);
+    rows_mutex_.reset(new std::mutex);
+    evict_lock_.reset(new RWLock);
+    updated_mutex_.reset(new std::mutex);
   }
 
   SelectedRows() {
     height_ = 0;
     value_.reset(new Tensor());
-    rwlock_.reset(new RWLock);
+    index_shards_.reset(new IndexShard[kIndexShardNum]);
+    rows_mutex_.reset(new std::mutex);
+    evict_lock_.reset(new RWLock);
+    updated_mutex_.reset(new std::mutex);
   }
 
   platform::Place place() const { return value_->place(); }
@@ -80,13 +90,7 @@ class SelectedRows {
    *
    * @return -1 if the key does not exists.
    */
-  int64_t Index(int64_t key) const {
-    auto it = std::find(rows_.begin(), rows_.end(), key);
-    if (it == rows_.end()) {
-      PADDLE_THROW("id %s not in table", key);
-    }
-    return static_cast<int64_t>(std::distance(rows_.begin(), it));
-  }
+  int64_t Index(int64_t key) const;
 
   /*
    * @brief whether has the specified key in the table.
@@ -107,6 +111,17 @@ class SelectedRows {
   void Get(const framework::Tensor& ids, framework::Tensor* value,
            bool auto_grown = false);
 
+  /*
+   * @brief Get the indexes of a batch of keys, see AutoGrownIndex. Each
+   * index shard is locked once for all the keys falling into it.
+   *
+   * Note!!! this interface is only used when selected_rows is used as
+   * parameters
+   * for distribute lookup table.
+   */
+  void GetIndexsByIds(const int64_t* ids, int64_t num,
+                      std::vector<int64_t>* indexs, bool auto_grown);
+
   /*
    * @brief Get the index of the key from id_to_index_ map. If the key not
    * exist,
@@ -120,8 +135,101 @@ class SelectedRows {
    */
   int64_t AutoGrownIndex(int64_t key, bool auto_grown);
 
+  /*
+   * @brief Get the index of the key like AutoGrownIndex without growing, a
+   * spilled key is loaded back.
+   *
+   * Note!!! this interface is only used when selected_rows is used as
+   * parameters
+   * for distribute lookup table.
+   *
+   * @return -1 if the key is not in the table, e.g. it was evicted without
+   * a spill tier.
+   */
+  int64_t ExistingIndex(int64_t key);
+
   void SyncIndex();
 
+  /*
+   * @brief Enable the entry lifecycle of the sparse table. The access
+   * frequency and time of every row are recorded, and EvictRows() evicts
+   * the rows not accessed for ttl seconds, or accessed less than min_freq
+   * times and not since the last eviction. The frequency is halved on each
+   * eviction so that it follows the recent accesses. A value of 0 disables
+   * the corresponding rule.
+   *
+   * The evicted rows are spilled to a file in spill_dir, and loaded back
+   * on a miss. Without spill_dir, they are dropped and their slots are
+   * reused with zero value.
+   *
+   * Note!!! this interface is only used when selected_rows is used as
+   * parameters
+   * for distribute lookup table.
+   */
+  void EnableEviction(int64_t min_freq, int64_t ttl,
+                      const std::string& spill_dir);
+
+  bool EvictionEnabled() const { return evict_enabled_; }
+
+  /*
+   * @brief whether the table has no room for num new keys.
+   */
+  bool NeedEvict(int64_t num) const;
+
+  /*
+   * @brief Evict the rows by the rules given to EnableEviction.
+   *
+   * NOTE: the indexes returned by AutoGrownIndex may be reused once the
+   * rows are evicted, only Get() and the updates holding evict_lock() are
+   * safe to run concurrently.
+   *
+   * @return the number of evicted rows.
+   */
+  int64_t EvictRows();
+
+  // Hold it for reading while the rows of the indexes got from the table
+  // are written, so that EvictRows() does not free and reuse their slots.
+  RWLock* evict_lock() const { return evict_lock_.get(); }
+
+  /*
+   * @brief Create the spill tier in spill_dir if it does not exist.
+   */
+  void InitSpilledRows(const std::string& spill_dir);
+
+  // The spill tier, nullptr if the table does not spill.
+  SpilledRows* spilled_rows() const { return spilled_rows_.get(); }
+
+  /*
+   * @brief Copy the rows and the value of the table to snapshot on CPU,
+   * which could be serialized while the table is being updated. The
+   * spilled rows are not copied.
+   *
+   * Note!!! this interface is only used when selected_rows is used as
+   * parameters
+   * for distribute lookup table.
+   */
+  void Snapshot(SelectedRows* snapshot) const;
+
+  /*
+   * @brief Start recording the keys of the rows passed to MarkUpdated, for
+   * the incremental checkpoints.
+   */
+  void TrackUpdatedRows() { track_updated_ = true; }
+
+  bool UpdatedRowsTracked() const { return track_updated_; }
+
+  /*
+   * @brief Record the keys of the updated rows, a no-op unless
+   * TrackUpdatedRows was called.
+   */
+  void MarkUpdated(const int64_t* keys, int64_t num);
+
+  /*
+   * @brief Copy the rows updated since the last call to updated on CPU,
+   * and clear the record. The updated rows evicted since are skipped.
+   */
+  void TakeUpdatedRows(SelectedRows* updated);
+
   DDim GetCompleteDims() const {
     std::vector<int64_t> dims = vectorize(value_->dims());
     dims[0] = height_;
@@ -129,20 +237,78 @@ class SelectedRows {
   }
 
  private:
+  // The index of the keys is split into shards, each guarded by its own
+  // lock, so that the lookups of the prefetch threads do not contend.
+  struct IndexShard {
+    RWLock lock;
+    std::unordered_map<int64_t, int64_t> id_to_index;
+  };
+  static constexpr int kIndexShardBits = 6;
+  static constexpr int kIndexShardNum = 1 << kIndexShardBits;
+
+  IndexShard* GetShard(int64_t key) const {
+    // Mix the key before picking the shard: the ids on one pserver often
+    // share the same residue modulo the number of pservers.
+    uint64_t hash = static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ULL;
+    return &index_shards_[hash >> (64 - kIndexShardBits)];
+  }
+  // Append key to rows_ or reuse an evicted slot for it, the caller holds
+  // the write lock of its shard.
+  int64_t AppendKey(int64_t key, bool* reused);
+  // Add key to the shard, the caller holds the write lock of the shard.
+  int64_t InsertKey(IndexShard* shard, int64_t key);
+  // Record the access of the row at index.
+  void RecordAccess(int64_t index, int64_t now) {
+    row_freq_[index].fetch_add(1, std::memory_order_relaxed);
+    row_access_[index].store(now, std::memory_order_relaxed);
+    row_epoch_[index].store(evict_epoch_.load(std::memory_order_relaxed),
+                            std::memory_order_relaxed);
+  }
+  size_t RowBytes() const;
+  char* RowData(int64_t index) const;
+
   // Notice: rows can be duplicate. We can have {0, 4, 7, 0, 5, 7, 9} here.
   // SelectedRows are simply concated when adding together. Until a
   // SelectedRows add a Tensor, will the duplicate rows be handled.
   Vector<int64_t> rows_;
-  std::unordered_map<int64_t, int64_t> id_to_index_;
+  std::unique_ptr<IndexShard[]> index_shards_{nullptr};
+  // Guard the appends to rows_ and indexed_rows_.
+  std::unique_ptr<std::mutex> rows_mutex_{nullptr};
+  // The number of the rows in index_shards_.
+  int64_t indexed_rows_{0};
+  // The evicted slots of rows_, guarded by rows_mutex_.
+  std::vector<int64_t> free_slots_;
+
+  // Held by Get() for reading and by EvictRows() for writing, so that the
+  // slots are not reused while their values are copied.
+  std::unique_ptr<RWLock> evict_lock_{nullptr};
+  std::atomic<bool> evict_enabled_{false};
+  int64_t evict_min_freq_{0};
+  int64_t evict_ttl_{0};
+  // The number of the evictions done.
+  std::atomic<int64_t> evict_epoch_{0};
+  // The access frequency, the last access time and the evict_epoch_ of the
+  // last access of each row.
+  std::unique_ptr<std::atomic<int64_t>[]> row_freq_{nullptr};
+  std::unique_ptr<std::atomic<int64_t>[]> row_access_{nullptr};
+  std::unique_ptr<std::atomic<int64_t>[]> row_epoch_{nullptr};
+  std::unique_ptr<SpilledRows> spilled_rows_{nullptr};
+  // The keys recorded by MarkUpdated, guarded by updated_mutex_.
+  std::atomic<bool> track_updated_{false};
+  std::unique_ptr<std::mutex> updated_mutex_{nullptr};
+  std::unordered_set<int64_t> updated_keys_;
   std::unique_ptr<Tensor> value_{nullptr};
   int64_t height_;
-  std::unique_ptr<RWLock> rwlock_{nullptr};
 };
 
+// The key of the evicted slots in the rows of a sparse table.
+constexpr int64_t kEvictedRow = -1;
+
 /*
  * Serialize/Desiralize SelectedRows to std::ostream
  * You can pass ofstream or ostringstream to serilize to file
  * or to a in memory string. GPU tensor will be copied to CPU.
+ * The spilled rows of a sparse table are appended after the tensor.
  */
 void SerializeToStream(std::ostream& os, const SelectedRows& selected_rows,
                        const platform::DeviceContext& dev_ctx);
@@ -194,5 +194,154 @@ TEST(SelectedRows, MultiThreadAutoIndex) {
   t4.join();
 }
 
+void f5(SelectedRows* table, int table_size, int batch_size, int seed) {
+  std::vector<int64_t> ids(batch_size);
+  std::vector<int64_t> indexs;
+  for (int i = 0; i < 1000; ++i) {
+    for (int j = 0; j < batch_size; ++j) {
+      ids[j] = (seed + i * batch_size + j * 7) % table_size;
+    }
+    table->GetIndexsByIds(ids.data(), batch_size, &indexs, true);
+    for (int j = 0; j < batch_size; ++j) {
+      ASSERT_EQ(indexs[j], table->AutoGrownIndex(ids[j], false));
+    }
+  }
+}
+
+TEST(SelectedRows, MultiThreadGetIndexs) {
+  platform::CPUPlace cpu;
+  SelectedRows table;
+
+  int64_t table_size = 10000;
+  int64_t embedding_width = 8;
+  table.mutable_value()->Resize(
+      framework::make_ddim({table_size, embedding_width}));
+  table.mutable_value()->mutable_data<float>(cpu);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back(f5, &table, table_size, 64, i * 13);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  // every key is indexed once and points back to its row
+  auto& rows = table.rows();
+  ASSERT_EQ(rows.size(), static_cast<size_t>(table_size));
+  for (size_t i = 0; i < rows.size(); ++i) {
+    ASSERT_EQ(table.Index(rows[i]), static_cast<int64_t>(i));
+  }
+
+  // the index is rebuilt from the rows
+  table.SyncIndex();
+  for (size_t i = 0; i < rows.size(); ++i) {
+    ASSERT_EQ(table.AutoGrownIndex(rows[i], false), static_cast<int64_t>(i));
+  }
+}
+
+TEST(SelectedRows, EvictAndSpill) {
+  platform::CPUPlace cpu;
+  SelectedRows table;
+
+  int64_t table_size = 4;
+  int64_t embedding_width = 2;
+  table.mutable_value()->Resize(
+      framework::make_ddim({table_size, embedding_width}));
+  auto* data = table.mutable_value()->mutable_data<float>(cpu);
+  table.EnableEviction(2, 0, "/tmp");
+
+  framework::Tensor ids;
+  auto* ids_data = ids.mutable_data<int64_t>(framework::make_ddim({4}), cpu);
+  framework::Tensor get_value;
+  auto* value_data = get_value.mutable_data<float>(
+      framework::make_ddim({4, embedding_width}), cpu);
+  for (int64_t i = 0; i < 4; ++i) {
+    ids_data[i] = i;
+  }
+  table.Get(ids, &get_value, true);
+  for (int64_t i = 0; i < 4; ++i) {
+    int64_t index = table.Index(i);
+    for (int64_t j = 0; j < embedding_width; ++j) {
+      data[index * embedding_width + j] = static_cast<float>(i * 10);
+    }
+  }
+  // the rows accessed since the last eviction are kept
+  ASSERT_EQ(table.EvictRows(), 0);
+
+  ids_data[0] = ids_data[1] = 0;
+  ids_data[2] = ids_data[3] = 1;
+  table.Get(ids, &get_value, true);
+  ASSERT_TRUE(table.NeedEvict(1));
+  ASSERT_EQ(table.EvictRows(), 2);
+  ASSERT_EQ(table.spilled_rows()->size(), 2UL);
+  ASSERT_TRUE(table.HasKey(2));
+  ASSERT_FALSE(table.NeedEvict(2));
+
+  // a new key starts from zero and a spilled key is loaded back
+  framework::Tensor new_ids;
+  auto* new_ids_data =
+      new_ids.mutable_data<int64_t>(framework::make_ddim({2}), cpu);
+  new_ids_data[0] = 4;
+  new_ids_data[1] = 2;
+  framework::Tensor new_value;
+  auto* new_value_data = new_value.mutable_data<float>(
+      framework::make_ddim({2, embedding_width}), cpu);
+  table.Get(new_ids, &new_value, true);
+  for (int64_t j = 0; j < embedding_width; ++j) {
+    ASSERT_EQ(new_value_data[j], 0);
+    ASSERT_EQ(new_value_data[embedding_width + j], 20);
+  }
+  ASSERT_EQ(table.spilled_rows()->size(), 1UL);
+  ASSERT_TRUE(table.spilled_rows()->Has(3));
+  ASSERT_EQ(table.rows().size(), static_cast<size_t>(table_size));
+}
+
+TEST(SelectedRows, TakeUpdatedRows) {
+  platform::CPUPlace cpu;
+  SelectedRows table;
+
+  int64_t table_size = 10;
+  int64_t embedding_width = 2;
+  table.mutable_value()->Resize(
+      framework::make_ddim({table_size, embedding_width}));
+  auto* data = table.mutable_value()->mutable_data<float>(cpu);
+  for (int64_t key = 0; key < 5; ++key) {
+    int64_t index = table.AutoGrownIndex(key, true);
+    data[index * embedding_width] = static_cast<float>(key);
+    data[index * embedding_width + 1] = static_cast<float>(key * 10);
+  }
+
+  // Nothing is recorded before the tracking.
+  std::vector<int64_t> keys{1, 2};
+  table.MarkUpdated(keys.data(), 2);
+  ASSERT_FALSE(table.UpdatedRowsTracked());
+
+  table.TrackUpdatedRows();
+  SelectedRows snapshot;
+  table.Snapshot(&snapshot);
+  ASSERT_EQ(snapshot.rows().size(), 5UL);
+  ASSERT_EQ(snapshot.value().dims(), table.value().dims());
+
+  keys = {3, 1, 3};
+  table.MarkUpdated(keys.data(), 3);
+  SelectedRows updated;
+  table.TakeUpdatedRows(&updated);
+  ASSERT_EQ(updated.rows().size(), 2UL);
+  ASSERT_EQ(updated.value().dims(), framework::make_ddim({2, 2}));
+  const float* updated_data = updated.value().data<float>();
+  for (size_t i = 0; i < updated.rows().size(); ++i) {
+    int64_t key = updated.rows()[i];
+    ASSERT_TRUE(key == 1 || key == 3);
+    ASSERT_EQ(updated_data[i * 2], static_cast<float>(key));
+    ASSERT_EQ(updated_data[i * 2 + 1], static_cast<float>(key * 10));
+  }
+
+  // The record is cleared after taken.
+  SelectedRows empty;
+  table.TakeUpdatedRows(&empty);
+  ASSERT_EQ(empty.rows().size(), 0UL);
+}
+
 }  // namespace framework
 }  // namespace paddle
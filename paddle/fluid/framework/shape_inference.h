@@ -41,13 +41,14 @@ class InferShapeContext {
   virtual bool HasInputs(const std::string &name) const = 0;
   virtual bool HasOutputs(const std::string &name) const = 0;
 
-  DDim GetInputDim(const std::string &name) const;
-  std::vector<DDim> GetInputsDim(const std::string &name) const;
+  virtual DDim GetInputDim(const std::string &name) const;
+  virtual std::vector<DDim> GetInputsDim(const std::string &name) const;
   std::vector<DDim> GetReaderDims(const std::string &name) const;
   DDim GetInputsElementDim(const std::string &name, int idx) const;
 
-  void SetOutputDim(const std::string &name, const DDim &dim);
-  void SetOutputsDim(const std::string &name, const std::vector<DDim> &dims);
+  virtual void SetOutputDim(const std::string &name, const DDim &dim);
+  virtual void SetOutputsDim(const std::string &name,
+                             const std::vector<DDim> &dims);
   void SetReaderDims(const std::string &name, const std::vector<DDim> &dims);
 
   virtual AttrReader Attrs() const = 0;
@@ -64,8 +65,10 @@ class InferShapeContext {
 
   virtual bool IsRuntime() const = 0;
 
-  std::vector<InferShapeVarPtr> GetInputVarPtrs(const std::string &name);
-  std::vector<InferShapeVarPtr> GetOutputVarPtrs(const std::string &name);
+  virtual std::vector<InferShapeVarPtr> GetInputVarPtrs(
+      const std::string &name);
+  virtual std::vector<InferShapeVarPtr> GetOutputVarPtrs(
+      const std::string &name);
   virtual InferShapeVarPtr GetVarPtr(const std::string &name) = 0;
 
   // Note: In while op, we need this to be public
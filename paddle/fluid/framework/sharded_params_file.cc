@@ -0,0 +1,123 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/sharded_params_file.h"
+
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+// "PDSH" in the little endian order.
+constexpr uint32_t kShardedParamsMagic = 0x48534450;
+constexpr uint32_t kShardedParamsVersion = 0;
+
+std::string ShardedParamsShardPath(const std::string& path, uint32_t shard) {
+  return path + ".shard-" + std::to_string(shard);
+}
+
+bool IsShardedParamsFile(const std::string& path) {
+  std::ifstream fin(path, std::ios::in | std::ios::binary);
+  uint32_t magic = 0;
+  fin.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+  return static_cast<bool>(fin) && magic == kShardedParamsMagic;
+}
+
+void WriteShardedParamsIndex(const std::string& path, uint32_t num_shards,
+                             const std::vector<ShardedParamsEntry>& entries) {
+  std::ofstream fout(path, std::ios::out | std::ios::binary);
+  PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open %s to write", path);
+  auto write = [&fout](const void* data, size_t size) {
+    fout.write(static_cast<const char*>(data),
+               static_cast<std::streamsize>(size));
+  };
+  write(&kShardedParamsMagic, sizeof(kShardedParamsMagic));
+  write(&kShardedParamsVersion, sizeof(kShardedParamsVersion));
+  write(&num_shards, sizeof(num_shards));
+  uint64_t num_entries = entries.size();
+  write(&num_entries, sizeof(num_entries));
+  for (auto& entry : entries) {
+    PADDLE_ENFORCE_LT(entry.shard, num_shards, "The shard of %s is invalid",
+                      entry.name);
+    uint32_t name_size = static_cast<uint32_t>(entry.name.size());
+    write(&name_size, sizeof(name_size));
+    write(entry.name.data(), name_size);
+    write(&entry.shard, sizeof(entry.shard));
+    write(&entry.offset, sizeof(entry.offset));
+  }
+  fout.close();
+  PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot write %s", path);
+}
+
+uint32_t ReadShardedParamsIndex(const std::string& path,
+                                std::vector<ShardedParamsEntry>* entries) {
+  std::ifstream fin(path, std::ios::in | std::ios::binary);
+  PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open file %s", path);
+  auto read = [&fin, &path](void* data, size_t size) {
+    fin.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+    PADDLE_ENFORCE(static_cast<bool>(fin),
+                   "The sharded parameters index %s is truncated", path);
+  };
+  uint32_t magic, version, num_shards;
+  read(&magic, sizeof(magic));
+  PADDLE_ENFORCE_EQ(magic, kShardedParamsMagic,
+                    "%s is not a sharded parameters index", path);
+  read(&version, sizeof(version));
+  PADDLE_ENFORCE_EQ(version, kShardedParamsVersion,
+                    "Only version 0 is supported");
+  read(&num_shards, sizeof(num_shards));
+  uint64_t num_entries;
+  read(&num_entries, sizeof(num_entries));
+  entries->clear();
+  entries->reserve(num_entries);
+  for (uint64_t i = 0; i < num_entries; ++i) {
+    ShardedParamsEntry entry;
+    uint32_t name_size;
+    read(&name_size, sizeof(name_size));
+    entry.name.resize(name_size);
+    read(&entry.name[0], name_size);
+    read(&entry.shard, sizeof(entry.shard));
+    read(&entry.offset, sizeof(entry.offset));
+    PADDLE_ENFORCE_LT(entry.shard, num_shards, "The shard of %s is invalid",
+                      entry.name);
+    entries->push_back(std::move(entry));
+  }
+  return num_shards;
+}
+
+std::vector<uint32_t> AssignParamsToShards(const std::vector<size_t>& sizes,
+                                           uint32_t num_shards) {
+  PADDLE_ENFORCE_GT(num_shards, 0U, "The number of shards should be > 0");
+  std::vector<size_t> order(sizes.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&sizes](size_t a, size_t b) {
+    return sizes[a] > sizes[b];
+  });
+  std::vector<size_t> loads(num_shards, 0);
+  std::vector<uint32_t> shards(sizes.size());
+  for (size_t i : order) {
+    auto shard = static_cast<uint32_t>(
+        std::min_element(loads.begin(), loads.end()) - loads.begin());
+    shards[i] = shard;
+    loads[shard] += sizes[i];
+  }
+  return shards;
+}
+
+}  // namespace framework
+}  // namespace paddle
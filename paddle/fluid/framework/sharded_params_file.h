@@ -0,0 +1,59 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+/*
+ * The sharded combined parameters file.
+ *
+ * The file at the path is an index, which starts with a magic number, a
+ * version and the number of the shards, followed by the name, the shard and
+ * the offset of every tensor. The tensors are in the shard files, see
+ * ShardedParamsShardPath, in the format of SerializeToStream. So the shards
+ * are written and read in parallel, and any of the tensors is read without
+ * reading the others.
+ */
+struct ShardedParamsEntry {
+  std::string name;
+  uint32_t shard;
+  uint64_t offset;
+};
+
+// The path of the shard-th shard of the sharded parameters file at path.
+std::string ShardedParamsShardPath(const std::string& path, uint32_t shard);
+
+// Whether the file at path is the index of a sharded parameters file.
+bool IsShardedParamsFile(const std::string& path);
+
+void WriteShardedParamsIndex(const std::string& path, uint32_t num_shards,
+                             const std::vector<ShardedParamsEntry>& entries);
+
+// Read the entries of the index at path, and return the number of the shards.
+uint32_t ReadShardedParamsIndex(const std::string& path,
+                                std::vector<ShardedParamsEntry>* entries);
+
+// Assign the tensors of the sizes to the shards, the largest first to the
+// least loaded shard, so the shards have about the same bytes.
+std::vector<uint32_t> AssignParamsToShards(const std::vector<size_t>& sizes,
+                                           uint32_t num_shards);
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,61 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/sharded_params_file.h"
+
+#include <cstdio>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(ShardedParamsFile, Index) {
+  std::string path = "/tmp/sharded_params_file_test_index";
+  std::vector<ShardedParamsEntry> entries = {
+      {"fc_0.w_0", 0, 0}, {"fc_0.b_0", 1, 0}, {"fc_1.w_0", 1, 4096}};
+  WriteShardedParamsIndex(path, 2, entries);
+  EXPECT_TRUE(IsShardedParamsFile(path));
+  EXPECT_FALSE(IsShardedParamsFile(ShardedParamsShardPath(path, 0)));
+
+  std::vector<ShardedParamsEntry> read;
+  EXPECT_EQ(ReadShardedParamsIndex(path, &read), 2U);
+  ASSERT_EQ(read.size(), entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    EXPECT_EQ(read[i].name, entries[i].name);
+    EXPECT_EQ(read[i].shard, entries[i].shard);
+    EXPECT_EQ(read[i].offset, entries[i].offset);
+  }
+  std::remove(path.c_str());
+}
+
+TEST(ShardedParamsFile, AssignParamsToShards) {
+  std::vector<size_t> sizes = {100, 10, 60, 40, 20, 30};
+  auto shards = AssignParamsToShards(sizes, 2);
+  ASSERT_EQ(shards.size(), sizes.size());
+  size_t loads[2] = {0, 0};
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    ASSERT_LT(shards[i], 2U);
+    loads[shards[i]] += sizes[i];
+  }
+  EXPECT_EQ(loads[0], 130U);
+  EXPECT_EQ(loads[1], 130U);
+
+  shards = AssignParamsToShards(sizes, 8);
+  for (auto shard : shards) {
+    EXPECT_LT(shard, 8U);
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
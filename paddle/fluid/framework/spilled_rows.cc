@@ -0,0 +1,167 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/spilled_rows.h"
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // !_WIN32
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+// The file grows by doubling, starting from this number of rows.
+constexpr size_t kMinSpilledCapacity = 1024;
+
+SpilledRows::SpilledRows(const std::string& dir, size_t row_bytes)
+    : row_bytes_(row_bytes),
+      fd_(-1),
+      data_(nullptr),
+      capacity_(0),
+      used_slots_(0) {
+  PADDLE_ENFORCE_GT(row_bytes, 0UL, "The row of SpilledRows is empty");
+#if !defined(_WIN32)
+  std::string path = dir + "/spilled_rows.XXXXXX";
+  std::vector<char> buf(path.begin(), path.end());
+  buf.push_back('\0');
+  fd_ = mkstemp(buf.data());
+  PADDLE_ENFORCE(fd_ >= 0, "Failed to create the spill file in %s", dir);
+  // The file is removed once it is closed.
+  unlink(buf.data());
+  Reserve(kMinSpilledCapacity);
+#else
+  PADDLE_THROW("SpilledRows is not supported on Windows");
+#endif  // !_WIN32
+}
+
+SpilledRows::~SpilledRows() {
+#if !defined(_WIN32)
+  if (data_ != nullptr) {
+    munmap(data_, capacity_ * row_bytes_);
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+#endif  // !_WIN32
+}
+
+void SpilledRows::Reserve(size_t capacity) {
+  if (capacity <= capacity_) return;
+#if !defined(_WIN32)
+  size_t new_capacity = std::max(capacity_ * 2, capacity);
+  PADDLE_ENFORCE_EQ(ftruncate(fd_, new_capacity * row_bytes_), 0,
+                    "Failed to grow the spill file to %d rows", new_capacity);
+  if (data_ != nullptr) {
+    munmap(data_, capacity_ * row_bytes_);
+  }
+  void* data = mmap(nullptr, new_capacity * row_bytes_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED, fd_, 0);
+  PADDLE_ENFORCE(data != MAP_FAILED, "Failed to map the spill file");
+  data_ = static_cast<char*>(data);
+  capacity_ = new_capacity;
+#endif  // !_WIN32
+}
+
+size_t SpilledRows::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return key_to_slot_.size();
+}
+
+bool SpilledRows::Has(int64_t key) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return key_to_slot_.count(key) != 0;
+}
+
+void SpilledRows::Put(int64_t key, const void* row) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int64_t slot;
+  auto iter = key_to_slot_.find(key);
+  if (iter != key_to_slot_.end()) {
+    slot = iter->second;
+  } else if (!free_slots_.empty()) {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+  } else {
+    Reserve(used_slots_ + 1);
+    slot = used_slots_++;
+  }
+  std::memcpy(RowAt(slot), row, row_bytes_);
+  key_to_slot_[key] = slot;
+}
+
+bool SpilledRows::Take(int64_t key, void* row) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = key_to_slot_.find(key);
+  if (iter == key_to_slot_.end()) {
+    return false;
+  }
+  std::memcpy(row, RowAt(iter->second), row_bytes_);
+  free_slots_.push_back(iter->second);
+  key_to_slot_.erase(iter);
+  return true;
+}
+
+void SpilledRows::SerializeToStream(std::ostream& os) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  {  // the 1st field, uint32_t version
+    constexpr uint32_t version = 0;
+    os.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  }
+  {  // the 2nd field, the bytes of a row
+    uint64_t row_bytes = row_bytes_;
+    os.write(reinterpret_cast<const char*>(&row_bytes), sizeof(row_bytes));
+  }
+  {  // the 3rd field, the number of rows followed by the keys and rows
+    uint64_t size = key_to_slot_.size();
+    os.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    for (auto& item : key_to_slot_) {
+      os.write(reinterpret_cast<const char*>(&item.first),
+               sizeof(item.first));
+      os.write(RowAt(item.second), row_bytes_);
+    }
+  }
+}
+
+void SpilledRows::DeserializeFromStream(std::istream& is) {
+  {
+    uint32_t version;
+    is.read(reinterpret_cast<char*>(&version), sizeof(version));
+    PADDLE_ENFORCE_EQ(version, 0U, "Only version 0 is supported");
+  }
+  {
+    uint64_t row_bytes;
+    is.read(reinterpret_cast<char*>(&row_bytes), sizeof(row_bytes));
+    PADDLE_ENFORCE_EQ(row_bytes, static_cast<uint64_t>(row_bytes_),
+                      "The spilled rows have a different width");
+  }
+  uint64_t size;
+  is.read(reinterpret_cast<char*>(&size), sizeof(size));
+  std::vector<char> row(row_bytes_);
+  for (uint64_t i = 0; i < size; ++i) {
+    int64_t key;
+    is.read(reinterpret_cast<char*>(&key), sizeof(key));
+    is.read(row.data(), row_bytes_);
+    PADDLE_ENFORCE(is.good(), "The spilled rows are truncated");
+    Put(key, row.data());
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
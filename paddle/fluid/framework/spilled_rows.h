@@ -0,0 +1,88 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * @brief The cold tier of a sparse table. The rows evicted from the
+ * SelectedRows are kept in a file mapped into memory, so they live on the
+ * disk instead of the RAM, and are loaded back into the table on a miss.
+ *
+ * The file is created in the given directory and removed right away, it
+ * only lives as long as the SpilledRows. All the interfaces are thread
+ * safe.
+ */
+class SpilledRows {
+ public:
+  SpilledRows(const std::string& dir, size_t row_bytes);
+  ~SpilledRows();
+
+  size_t row_bytes() const { return row_bytes_; }
+
+  size_t size() const;
+
+  bool Has(int64_t key) const;
+
+  /*
+   * @brief Store the row of key, overwrite it if the key exists.
+   */
+  void Put(int64_t key, const void* row);
+
+  /*
+   * @brief Copy the row of key into row and remove it from the tier.
+   *
+   * @return false if the key does not exist.
+   */
+  bool Take(int64_t key, void* row);
+
+  /*
+   * Serialize/Deserialize all the rows to/from the stream, the
+   * deserialized rows are added to the existing ones.
+   */
+  void SerializeToStream(std::ostream& os) const;
+  void DeserializeFromStream(std::istream& is);
+
+ private:
+  // Make room for at least capacity rows in the file.
+  void Reserve(size_t capacity);
+
+  char* RowAt(int64_t slot) const { return data_ + slot * row_bytes_; }
+
+  size_t row_bytes_;
+  int fd_;
+  char* data_;
+  size_t capacity_;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<int64_t, int64_t> key_to_slot_;
+  std::vector<int64_t> free_slots_;
+  int64_t used_slots_;
+
+  DISABLE_COPY_AND_ASSIGN(SpilledRows);
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,66 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/spilled_rows.h"
+#include <sstream>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(SpilledRows, PutTake) {
+  int width = 4;
+  SpilledRows spilled("/tmp", width * sizeof(float));
+  // put more rows than the initial capacity to grow the file
+  for (int64_t key = 0; key < 5000; ++key) {
+    std::vector<float> row(width, static_cast<float>(key));
+    spilled.Put(key, row.data());
+  }
+  ASSERT_EQ(spilled.size(), 5000UL);
+  ASSERT_TRUE(spilled.Has(4999));
+
+  std::vector<float> row(width);
+  ASSERT_TRUE(spilled.Take(42, row.data()));
+  for (int i = 0; i < width; ++i) {
+    ASSERT_EQ(row[i], 42.0f);
+  }
+  ASSERT_FALSE(spilled.Has(42));
+  ASSERT_FALSE(spilled.Take(42, row.data()));
+  ASSERT_EQ(spilled.size(), 4999UL);
+}
+
+TEST(SpilledRows, Serialize) {
+  int width = 3;
+  SpilledRows src("/tmp", width * sizeof(float));
+  for (int64_t key = 10; key < 20; ++key) {
+    std::vector<float> row(width, static_cast<float>(key) * 0.5f);
+    src.Put(key, row.data());
+  }
+  std::ostringstream oss;
+  src.SerializeToStream(oss);
+
+  SpilledRows dst("/tmp", width * sizeof(float));
+  std::istringstream iss(oss.str());
+  dst.DeserializeFromStream(iss);
+  ASSERT_EQ(dst.size(), 10UL);
+  std::vector<float> row(width);
+  for (int64_t key = 10; key < 20; ++key) {
+    ASSERT_TRUE(dst.Take(key, row.data()));
+    ASSERT_EQ(row[width - 1], static_cast<float>(key) * 0.5f);
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
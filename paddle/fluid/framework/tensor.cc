@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/tensor.h"
+#include <algorithm>
+#include <cstring>
 
 namespace paddle {
 namespace framework {
@@ -45,6 +47,14 @@ void* Tensor::mutable_data(platform::Place place, std::type_index type,
     PADDLE_ENFORCE_GE(requested_size, size);
     size = requested_size;
   }
+  // The read-only memory is copied to the tensor's own block on the first
+  // write.
+  std::shared_ptr<Placeholder> read_only_holder;
+  size_t read_only_offset = offset_;
+  if (holder_ != nullptr && holder_->read_only() &&
+      holder_->place() == place) {
+    read_only_holder = std::move(holder_);
+  }
   /* some versions of boost::variant don't have operator!= */
   if (holder_ == nullptr || !(holder_->place() == place) ||
       holder_->size() < size + offset_) {
@@ -69,6 +79,23 @@ void* Tensor::mutable_data(platform::Place place, std::type_index type,
 #endif
     offset_ = 0;
   }
+  if (read_only_holder != nullptr) {
+    size_t copy_size =
+        std::min(size, read_only_holder->size() - read_only_offset);
+    auto* src =
+        static_cast<uint8_t*>(read_only_holder->ptr()) + read_only_offset;
+#ifdef PADDLE_WITH_CUDA
+    if (platform::is_gpu_place(place)) {
+      auto gpu_place = boost::get<platform::CUDAPlace>(place);
+      memory::Copy(gpu_place, holder_->ptr(), gpu_place, src, copy_size,
+                   nullptr);
+    } else {
+      std::memcpy(holder_->ptr(), src, copy_size);
+    }
+#else
+    std::memcpy(holder_->ptr(), src, copy_size);
+#endif
+  }
   return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(holder_->ptr()) +
                                  offset_);
 }
@@ -85,6 +112,36 @@ Tensor& Tensor::ShareDataWith(const Tensor& src) {
   return *this;
 }
 
+Tensor& Tensor::ShareDataReadOnlyWith(const Tensor& src) {
+  src.check_memory_size();
+  *this = src;
+  holder_ = std::make_shared<BufferViewPlaceholder>(
+      src.holder_, src.offset_, src.memory_size(), true);
+  offset_ = 0;
+  return *this;
+}
+
+Tensor& Tensor::ShareBufferWith(const Tensor& buffer, size_t offset,
+                                size_t size) {
+  PADDLE_ENFORCE_NOT_NULL(buffer.holder_, "The buffer holds no memory.");
+  PADDLE_ENFORCE_LE(offset + size, buffer.memory_size(),
+                    "The view is out of the range of the buffer.");
+  holder_ = std::make_shared<BufferViewPlaceholder>(
+      buffer.holder_, buffer.offset_ + offset, size);
+  offset_ = 0;
+  return *this;
+}
+
+Tensor& Tensor::ShareExternalData(void* ptr, size_t size, std::type_index type,
+                                  std::shared_ptr<void> owner,
+                                  bool read_only) {
+  PADDLE_ENFORCE_NOT_NULL(ptr, "The external memory is null.");
+  holder_ = std::make_shared<ExternalPlaceholder>(ptr, size, type,
+                                                  std::move(owner), read_only);
+  offset_ = 0;
+  return *this;
+}
+
 Tensor Tensor::Slice(int begin_idx, int end_idx) const {
   check_memory_size();
   PADDLE_ENFORCE_GE(begin_idx, 0,
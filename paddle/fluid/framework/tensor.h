@@ -18,6 +18,7 @@ limitations under the License. */
 #include <cstring>
 #include <memory>
 #include <typeindex>
+#include <utility>
 #include <vector>
 
 #include "paddle/fluid/framework/data_layout.h"
@@ -120,6 +121,35 @@ class Tensor {
   /*! The internal of two tensors share the same memory block. */
   Tensor& ShareDataWith(const Tensor& src);
 
+  /**
+   * @brief  Share the memory block of src like ShareDataWith, but read-only:
+   *         the first mutable_data copies it to the tensor's own block, so
+   *         writing the tensor never changes src.
+   */
+  Tensor& ShareDataReadOnlyWith(const Tensor& src);
+
+  /**
+   * @brief  Use the bytes [offset, offset + size) of the memory of buffer.
+   *
+   * @note   The tensor keeps using the bytes until it needs more than size
+   *         bytes, then mutable_data allocates its own memory block.
+   */
+  Tensor& ShareBufferWith(const Tensor& buffer, size_t offset, size_t size);
+
+  /**
+   * @brief  Use the external CPU memory [ptr, ptr + size) holding the data
+   *         of type, e.g. a mapped file. The memory is not owned by the
+   *         tensor, owner is kept alive as long as the tensor uses it.
+   *
+   * @note   Like ShareBufferWith, mutable_data allocates the tensor's own
+   *         memory block when it needs more than size bytes. If read_only,
+   *         mutable_data copies the memory to the tensor's own block, so
+   *         only data() reads the external memory.
+   */
+  Tensor& ShareExternalData(void* ptr, size_t size, std::type_index type,
+                            std::shared_ptr<void> owner,
+                            bool read_only = false);
+
   /**
    * @brief  Return a sub-tensor of the given tensor.
    *
@@ -153,6 +183,13 @@ class Tensor {
 
   void clear() { holder_ = nullptr; }
 
+  /*! Identify the memory block, the tensors sharing it return the same. */
+  const void* holder_id() const { return holder_.get(); }
+
+  /*! The number of the tensors using the memory block, e.g. the views made
+   *  by ShareDataWith and the slices. */
+  size_t holder_use_count() const { return holder_.use_count(); }
+
  private:
   /**
    * @note    Placeholder hides type T, so it doesn't appear as a template
@@ -166,6 +203,7 @@ class Tensor {
     virtual platform::Place place() const = 0;
     virtual void set_type(std::type_index type) = 0;
     virtual void set_place(platform::Place place) = 0;
+    virtual bool read_only() const { return false; }
   };
 
   template <typename Place>
@@ -200,6 +238,62 @@ class Tensor {
     std::type_index type_;
   };
 
+  /*! A part of the memory block of another placeholder. */
+  struct BufferViewPlaceholder : public Placeholder {
+    BufferViewPlaceholder(std::shared_ptr<Placeholder> buffer, size_t offset,
+                          size_t size, bool read_only = false)
+        : buffer_(std::move(buffer)),
+          offset_(offset),
+          size_(size),
+          type_(buffer_->type()),
+          read_only_(read_only) {}
+
+    virtual size_t size() const { return size_; }
+    virtual platform::Place place() const { return buffer_->place(); }
+    virtual void* ptr() const {
+      return static_cast<uint8_t*>(buffer_->ptr()) + offset_;
+    }
+    virtual std::type_index type() const { return type_; }
+    virtual void set_type(std::type_index type) { type_ = type; }
+    virtual void set_place(platform::Place place) {
+      PADDLE_THROW("Can not change the place of a buffer view.");
+    }
+    virtual bool read_only() const { return read_only_; }
+
+    std::shared_ptr<Placeholder> buffer_;
+    size_t offset_;
+    size_t size_;
+    std::type_index type_;
+    bool read_only_;
+  };
+
+  /*! The external CPU memory kept alive by an owner. */
+  struct ExternalPlaceholder : public Placeholder {
+    ExternalPlaceholder(void* ptr, size_t size, std::type_index type,
+                        std::shared_ptr<void> owner, bool read_only)
+        : ptr_(ptr),
+          size_(size),
+          type_(type),
+          owner_(std::move(owner)),
+          read_only_(read_only) {}
+
+    virtual size_t size() const { return size_; }
+    virtual platform::Place place() const { return platform::CPUPlace(); }
+    virtual void* ptr() const { return ptr_; }
+    virtual std::type_index type() const { return type_; }
+    virtual void set_type(std::type_index type) { type_ = type; }
+    virtual void set_place(platform::Place place) {
+      PADDLE_THROW("Can not change the place of external memory.");
+    }
+    virtual bool read_only() const { return read_only_; }
+
+    void* ptr_;
+    size_t size_;
+    std::type_index type_;
+    std::shared_ptr<void> owner_;
+    bool read_only_;
+  };
+
   /*! holds the memory block if allocated. */
   std::shared_ptr<Placeholder> holder_;
 
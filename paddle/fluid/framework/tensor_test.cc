@@ -156,6 +156,87 @@ TEST(Tensor, ShareDataWith) {
 #endif
 }
 
+TEST(Tensor, ShareBufferWith) {
+  paddle::framework::Tensor buffer;
+  auto* base = buffer.mutable_data<uint8_t>(framework::make_ddim({256}),
+                                            platform::CPUPlace());
+  paddle::framework::Tensor view;
+  view.ShareBufferWith(buffer, 64, 128);
+  EXPECT_EQ(view.memory_size(), 128UL);
+
+  // The view is used while it is big enough.
+  auto* data = view.mutable_data<float>(framework::make_ddim({4, 8}),
+                                        platform::CPUPlace());
+  EXPECT_EQ(reinterpret_cast<uint8_t*>(data), base + 64);
+
+  // A bigger tensor allocates its own memory.
+  data = view.mutable_data<float>(framework::make_ddim({4, 16}),
+                                  platform::CPUPlace());
+  EXPECT_NE(reinterpret_cast<uint8_t*>(data), base + 64);
+  EXPECT_EQ(buffer.data<uint8_t>(), base);
+}
+
+TEST(Tensor, ShareExternalData) {
+  std::shared_ptr<std::vector<float>> external(new std::vector<float>(16, 1.f));
+  paddle::framework::Tensor tensor;
+  tensor.Resize(framework::make_ddim({4, 4}));
+  tensor.ShareExternalData(external->data(), 16 * sizeof(float),
+                           typeid(float), external);
+  EXPECT_TRUE(platform::is_cpu_place(tensor.place()));
+  EXPECT_EQ(tensor.data<float>(), external->data());
+
+  // The tensor keeps the external memory alive.
+  float* data = external->data();
+  external.reset();
+  EXPECT_EQ(tensor.data<float>(), data);
+  EXPECT_EQ(tensor.data<float>()[15], 1.f);
+
+  // A bigger tensor allocates its own memory.
+  EXPECT_NE(tensor.mutable_data<float>(framework::make_ddim({4, 8}),
+                                       platform::CPUPlace()),
+            data);
+}
+
+TEST(Tensor, ShareReadOnlyExternalData) {
+  std::vector<float> external(16, 1.f);
+  paddle::framework::Tensor tensor;
+  tensor.Resize(framework::make_ddim({4, 4}));
+  tensor.ShareExternalData(external.data(), 16 * sizeof(float), typeid(float),
+                           nullptr, true);
+  const auto& const_tensor = tensor;
+  EXPECT_EQ(const_tensor.data<float>(), external.data());
+
+  // The first write copies the external memory.
+  float* data = tensor.mutable_data<float>(platform::CPUPlace());
+  EXPECT_NE(data, external.data());
+  EXPECT_EQ(data[15], 1.f);
+  data[0] = 2.f;
+  EXPECT_EQ(external[0], 1.f);
+  EXPECT_EQ(tensor.mutable_data<float>(platform::CPUPlace()), data);
+}
+
+TEST(Tensor, ShareDataReadOnlyWith) {
+  paddle::framework::Tensor src;
+  float* src_data = src.mutable_data<float>(framework::make_ddim({2, 3}),
+                                            platform::CPUPlace());
+  for (int i = 0; i < 6; ++i) {
+    src_data[i] = static_cast<float>(i);
+  }
+  paddle::framework::Tensor tensor;
+  tensor.ShareDataReadOnlyWith(src);
+  const auto& const_tensor = tensor;
+  EXPECT_EQ(const_tensor.data<float>(), src_data);
+  EXPECT_EQ(tensor.dims(), src.dims());
+
+  // The first write copies the shared memory.
+  float* data = tensor.mutable_data<float>(platform::CPUPlace());
+  EXPECT_NE(data, src_data);
+  EXPECT_EQ(data[5], 5.f);
+  data[0] = -1.f;
+  EXPECT_EQ(src_data[0], 0.f);
+  EXPECT_EQ(tensor.mutable_data<float>(platform::CPUPlace()), data);
+}
+
 TEST(Tensor, Slice) {
   {
     framework::Tensor src_tensor;
@@ -13,6 +13,7 @@
    limitations under the License. */
 #include "paddle/fluid/framework/tensor_util.h"
 #include <algorithm>
+#include <cstring>
 #include <limits>
 #include <vector>
 #include "paddle/fluid/framework/data_type.h"
@@ -67,6 +68,11 @@ void TensorCopy(const Tensor& src, const platform::Place& dst_place,
     auto stream =
         reinterpret_cast<const platform::CUDADeviceContext&>(ctx).stream();
     memory::Copy(dst_gpu_place, dst_ptr, src_cpu_place, src_ptr, size, stream);
+  } else if (platform::is_cuda_pinned_place(src_place) &&
+             platform::is_cpu_place(dst_place)) {
+    memory::Copy(boost::get<platform::CPUPlace>(dst_place), dst_ptr,
+                 boost::get<platform::CUDAPinnedPlace>(src_place), src_ptr,
+                 size);
   } else if (platform::is_gpu_place(src_place) &&
              platform::is_gpu_place(dst_place)) {
     auto src_gpu_place = boost::get<platform::CUDAPlace>(src_place);
@@ -163,6 +169,50 @@ void TensorCopySync(const Tensor& src, const platform::Place& dst_place,
 #endif
 }
 
+void TensorCopyOnCopyStream(const Tensor& src, const platform::Place& dst_place,
+                            Tensor* dst) {
+#ifdef PADDLE_WITH_CUDA
+  auto src_place = src.place();
+  bool upload = platform::is_gpu_place(dst_place) &&
+                (platform::is_cpu_place(src_place) ||
+                 platform::is_cuda_pinned_place(src_place));
+  bool download =
+      platform::is_gpu_place(src_place) && platform::is_cpu_place(dst_place);
+  if (upload || download) {
+    VLOG(3) << "TensorCopyOnCopyStream " << src.dims() << " from "
+            << src_place << " to " << dst_place;
+    src.check_memory_size();
+    dst->Resize(src.dims());
+    dst->set_layout(src.layout());
+    auto src_ptr = src.data<void>();
+    auto dst_ptr = dst->mutable_data(dst_place, src.type());
+    auto size = src.numel() * SizeOfType(src.type());
+    auto* ctx = static_cast<platform::CUDADeviceContext*>(
+        platform::DeviceContextPool::Instance().Get(upload ? dst_place
+                                                           : src_place));
+    // the kernels writing src or using the memory of dst are done first
+    ctx->CopyStreamWaitCompute();
+    auto stream = ctx->copy_stream();
+    if (download) {
+      memory::Copy(boost::get<platform::CPUPlace>(dst_place), dst_ptr,
+                   boost::get<platform::CUDAPlace>(src_place), src_ptr, size,
+                   stream);
+    } else if (platform::is_cpu_place(src_place)) {
+      memory::Copy(boost::get<platform::CUDAPlace>(dst_place), dst_ptr,
+                   boost::get<platform::CPUPlace>(src_place), src_ptr, size,
+                   stream);
+    } else {
+      memory::Copy(boost::get<platform::CUDAPlace>(dst_place), dst_ptr,
+                   boost::get<platform::CUDAPinnedPlace>(src_place), src_ptr,
+                   size, stream);
+    }
+    PADDLE_ENFORCE(cudaStreamSynchronize(stream));
+    return;
+  }
+#endif
+  TensorCopySync(src, dst_place, dst);
+}
+
 template <typename Predicate, typename DevCtx>
 struct AnyDTypeVisitor {
   Predicate predicate_;
@@ -486,5 +536,58 @@ void TensorFromStream(std::istream& is, Tensor* tensor,
   }
 }
 
+template <typename T>
+static T ReadFromPiece(string::Piece* data) {
+  T value;
+  PADDLE_ENFORCE_GE(data->len(), sizeof(T), "The data is truncated.");
+  std::memcpy(&value, data->data(), sizeof(T));
+  *data = string::SkipPrefix(*data, sizeof(T));
+  return value;
+}
+
+void TensorFromPiece(string::Piece* data, Tensor* tensor,
+                     const platform::DeviceContext& dev_ctx) {
+  uint32_t version = ReadFromPiece<uint32_t>(data);
+  PADDLE_ENFORCE_EQ(version, 0U, "Only version 0 is supported");
+  proto::VarType::TensorDesc desc;
+  {  // int32_t size
+     // proto buffer
+    int32_t size = ReadFromPiece<int32_t>(data);
+    PADDLE_ENFORCE_LE(static_cast<size_t>(size), data->len(),
+                      "The data is truncated.");
+    PADDLE_ENFORCE(desc.ParseFromArray(data->data(), size),
+                   "Cannot parse tensor desc");
+    *data = string::SkipPrefix(*data, size);
+  }
+  {  // read tensor
+    std::vector<int64_t> dims;
+    dims.reserve(static_cast<size_t>(desc.dims().size()));
+    std::copy(desc.dims().begin(), desc.dims().end(), std::back_inserter(dims));
+    tensor->Resize(framework::make_ddim(dims));
+    void* buf;
+    size_t size =
+        tensor->numel() *
+        framework::SizeOfType(framework::ToTypeIndex(desc.data_type()));
+    PADDLE_ENFORCE_LE(size, data->len(), "The data is truncated.");
+    framework::VisitDataType(
+        desc.data_type(),
+        DeserializedDataFunctor(&buf, tensor, dev_ctx.GetPlace()));
+    if (platform::is_gpu_place(dev_ctx.GetPlace())) {
+#ifdef PADDLE_WITH_CUDA
+      auto stream =
+          reinterpret_cast<const platform::CUDADeviceContext&>(dev_ctx)
+              .stream();
+      memory::Copy(boost::get<platform::CUDAPlace>(dev_ctx.GetPlace()), buf,
+                   platform::CPUPlace(), data->data(), size, stream);
+#else
+      PADDLE_THROW("Unexpected branch");
+#endif
+    } else {
+      std::memcpy(buf, data->data(), size);
+    }
+    *data = string::SkipPrefix(*data, size);
+  }
+}
+
 }  // namespace framework
 }  // namespace paddle
@@ -19,6 +19,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/framework.pb.h"
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/string/piece.h"
 
 namespace paddle {
 namespace framework {
@@ -45,6 +46,14 @@ void TensorCopy(const Tensor& src, const platform::Place& dst_place,
 void TensorCopySync(const Tensor& src, const platform::Place& dst_place,
                     Tensor* dst);
 
+// Copy between the host and a GPU on the copy stream of the GPU's
+// CUDADeviceContext, and wait for the copy to finish. The copy waits for
+// the kernels issued to the GPU so far, but unlike TensorCopySync it does
+// not hold back the kernels issued later. The other copies fall back to
+// TensorCopySync.
+void TensorCopyOnCopyStream(const Tensor& src, const platform::Place& dst_place,
+                            Tensor* dst);
+
 template <typename T>
 void TensorFromVector(const std::vector<T>& src,
                       const platform::DeviceContext& ctx, Tensor* dst);
@@ -71,6 +80,10 @@ void TensorToStream(std::ostream& os, const Tensor& tensor,
                     const platform::DeviceContext& dev_ctx);
 void TensorFromStream(std::istream& is, Tensor* tensor,
                       const platform::DeviceContext& dev_ctx);
+// The same as TensorFromStream, but reads the tensor from the front of the
+// data and moves data past it, without copying it to a stream.
+void TensorFromPiece(string::Piece* data, Tensor* tensor,
+                     const platform::DeviceContext& dev_ctx);
 
 //
 // The implementation of template functions.
@@ -118,6 +118,38 @@ TEST(TensorCopy, Tensor) {
 #endif
 }
 
+TEST(TensorCopyOnCopyStream, Tensor) {
+  paddle::platform::CPUPlace cpu_place;
+  paddle::framework::Tensor src_tensor;
+  int* src_ptr = src_tensor.mutable_data<int>(make_ddim({3, 3}), cpu_place);
+  for (int i = 0; i < 9; ++i) {
+    src_ptr[i] = i;
+  }
+
+  // copies not involving a GPU fall back to TensorCopySync
+  paddle::framework::Tensor cpu_tensor;
+  TensorCopyOnCopyStream(src_tensor, cpu_place, &cpu_tensor);
+  EXPECT_NE(src_ptr, cpu_tensor.data<int>());
+  for (int i = 0; i < 9; ++i) {
+    EXPECT_EQ(cpu_tensor.data<int>()[i], i);
+  }
+
+#ifdef PADDLE_WITH_CUDA
+  {
+    paddle::platform::CUDAPlace gpu_place(0);
+    paddle::framework::Tensor gpu_tensor;
+    paddle::framework::Tensor dst_tensor;
+    // upload and download on the copy stream
+    TensorCopyOnCopyStream(src_tensor, gpu_place, &gpu_tensor);
+    TensorCopyOnCopyStream(gpu_tensor, cpu_place, &dst_tensor);
+    EXPECT_EQ(dst_tensor.dims(), src_tensor.dims());
+    for (int i = 0; i < 9; ++i) {
+      EXPECT_EQ(dst_tensor.data<int>()[i], i);
+    }
+  }
+#endif
+}
+
 TEST(TensorFromVector, Tensor) {
   {
     std::vector<int> src_vec = {1, 2, 3, 4, 5, 6, 7, 8, 9};
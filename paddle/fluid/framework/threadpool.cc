@@ -23,6 +23,8 @@ DEFINE_int32(io_threadpool_size, 100,
 DEFINE_int32(dist_threadpool_size, 0,
              "number of threads used for distributed executed.");
 
+DECLARE_bool(cpu_unified_runtime);
+
 namespace paddle {
 namespace framework {
 std::unique_ptr<ThreadPool> ThreadPool::threadpool_(nullptr);
@@ -34,7 +36,9 @@ ThreadPool* ThreadPool::GetInstance() {
 }
 
 void ThreadPool::Init() {
-  if (threadpool_.get() == nullptr) {
+  if (threadpool_.get() == nullptr && FLAGS_cpu_unified_runtime) {
+    threadpool_.reset(new ThreadPool(platform::TaskPriority::kCompute));
+  } else if (threadpool_.get() == nullptr) {
     // TODO(Yancey1989): specify the max threads number
     int num_threads = std::thread::hardware_concurrency();
     if (FLAGS_dist_threadpool_size > 0) {
@@ -54,6 +58,9 @@ ThreadPool::ThreadPool(int num_threads) : running_(true) {
   }
 }
 
+ThreadPool::ThreadPool(platform::TaskPriority priority)
+    : running_(true), forward_(true), priority_(priority) {}
+
 ThreadPool::~ThreadPool() {
   {
     // notify all threads to stop running
@@ -98,11 +105,28 @@ ThreadPool* ThreadPoolIO::GetInstanceIO() {
 }
 
 void ThreadPoolIO::InitIO() {
-  if (io_threadpool_.get() == nullptr) {
+  if (io_threadpool_.get() == nullptr && FLAGS_cpu_unified_runtime) {
+    io_threadpool_.reset(new ThreadPool(platform::TaskPriority::kIO));
+  } else if (io_threadpool_.get() == nullptr) {
     // TODO(typhoonzero1986): make this configurable
     io_threadpool_.reset(new ThreadPool(FLAGS_io_threadpool_size));
   }
 }
 
+std::unique_ptr<ThreadPool> ThreadPoolIO::rpc_threadpool_(nullptr);
+std::once_flag ThreadPoolIO::rpc_init_flag_;
+
+ThreadPool* ThreadPoolIO::GetInstanceRPC() {
+  if (!FLAGS_cpu_unified_runtime) return GetInstanceIO();
+  std::call_once(rpc_init_flag_, &ThreadPoolIO::InitRPC);
+  return rpc_threadpool_.get();
+}
+
+void ThreadPoolIO::InitRPC() {
+  if (rpc_threadpool_.get() == nullptr) {
+    rpc_threadpool_.reset(new ThreadPool(platform::TaskPriority::kRPC));
+  }
+}
+
 }  // namespace framework
 }  // namespace paddle
@@ -17,12 +17,14 @@ limitations under the License. */
 #include <condition_variable>  // NOLINT
 #include <functional>
 #include <future>  // NOLINT
+#include <memory>
 #include <mutex>   // NOLINT
 #include <queue>
 #include <thread>  // NOLINT
 #include <vector>
 #include "glog/logging.h"
 #include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/intra_op_thread_pool.h"
 #include "paddle/fluid/platform/macros.h"  // for DISABLE_COPY_AND_ASSIGN
 
 namespace paddle {
@@ -45,11 +47,16 @@ struct ExceptionHandler {
 };
 
 // ThreadPool maintains a queue of tasks, and runs them using a fixed
-// number of threads.
+// number of threads. With FLAGS_cpu_unified_runtime the singletons have no
+// threads, they schedule their tasks on the unified CPU runtime with their
+// priority instead.
 class ThreadPool {
  public:
   explicit ThreadPool(int num_threads);
 
+  // The pool running its tasks on platform::IntraOpThreadPool::GetInstance().
+  explicit ThreadPool(platform::TaskPriority priority);
+
   using Task = std::packaged_task<std::unique_ptr<platform::EnforceNotMet>()>;
 
   // Returns the singleton of ThreadPool.
@@ -84,6 +91,13 @@ class ThreadPool {
       return nullptr;
     });
     std::future<std::unique_ptr<platform::EnforceNotMet>> f = task.get_future();
+    if (forward_) {
+      lock.unlock();
+      auto shared_task = std::make_shared<Task>(std::move(task));
+      platform::IntraOpThreadPool::GetInstance()->Schedule(
+          [shared_task] { (*shared_task)(); }, priority_);
+      return f;
+    }
     tasks_.push(std::move(task));
     scheduled_.notify_one();
     return f;
@@ -109,6 +123,9 @@ class ThreadPool {
   std::mutex mutex_;
   bool running_;
   std::condition_variable scheduled_;
+
+  bool forward_{false};
+  platform::TaskPriority priority_{platform::TaskPriority::kCompute};
 };
 
 class ThreadPoolIO : ThreadPool {
@@ -116,10 +133,17 @@ class ThreadPoolIO : ThreadPool {
   static ThreadPool* GetInstanceIO();
   static void InitIO();
 
+  // The pool of the RPC tasks, the same as the IO pool unless
+  // FLAGS_cpu_unified_runtime is set.
+  static ThreadPool* GetInstanceRPC();
+  static void InitRPC();
+
  private:
   // NOTE: threadpool in base will be inhereted here.
   static std::unique_ptr<ThreadPool> io_threadpool_;
   static std::once_flag io_init_flag_;
+  static std::unique_ptr<ThreadPool> rpc_threadpool_;
+  static std::once_flag rpc_init_flag_;
 };
 
 // Run a function asynchronously.
@@ -135,5 +159,10 @@ std::future<void> AsyncIO(Callback callback) {
   return ThreadPoolIO::GetInstanceIO()->Run(callback);
 }
 
+template <typename Callback>
+std::future<void> AsyncRPC(Callback callback) {
+  return ThreadPoolIO::GetInstanceRPC()->Run(callback);
+}
+
 }  // namespace framework
 }  // namespace paddle
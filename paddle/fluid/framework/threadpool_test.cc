@@ -59,3 +59,19 @@ TEST(ThreadPool, ConcurrentRun) {
   }
   EXPECT_EQ(sum, ((n + 1) * n) / 2);
 }
+
+TEST(ThreadPool, RunOnIntraOpThreadPool) {
+  framework::ThreadPool pool(paddle::platform::TaskPriority::kIO);
+  std::atomic<int> sum(0);
+  std::vector<std::future<void>> fs;
+  for (int i = 0; i < 10; ++i) {
+    fs.push_back(pool.Run([&sum]() { sum.fetch_add(1); }));
+  }
+  for (auto& f : fs) {
+    f.wait();
+  }
+  EXPECT_EQ(sum, 10);
+  auto f = pool.RunAndGetException(
+      []() { PADDLE_THROW("the task fails in the runtime"); });
+  EXPECT_NE(f.get(), nullptr);
+}
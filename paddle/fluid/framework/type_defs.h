@@ -19,6 +19,7 @@ limitations under the License. */
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 #include "paddle/fluid/platform/variant.h"
 
@@ -54,5 +55,9 @@ using InferVarTypeFN =
 
 using InferShapeFN = std::function<void(InferShapeContext*)>;
 
+// The (input, output) argument pairs that can be computed in place.
+using InplacePairs = std::vector<std::pair<std::string, std::string>>;
+using InferInplaceOpFN = std::function<InplacePairs()>;
+
 }  // namespace framework
 }  // namespace paddle
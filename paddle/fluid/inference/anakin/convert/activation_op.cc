@@ -0,0 +1,52 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <string>
+#include <unordered_map>
+#include "paddle/fluid/inference/anakin/convert/op_converter.h"
+
+namespace paddle {
+namespace inference {
+namespace anakin {
+
+/*
+ * The activations, Activation in Anakin.
+ */
+template <typename Target>
+class ActivationOpConverter : public AnakinOpConverter<Target> {
+ public:
+  void operator()(const framework::proto::OpDesc& op,
+                  const framework::Scope& scope) override {
+    static const std::unordered_map<std::string, std::string> kTypes = {
+        {"relu", "Relu"}, {"sigmoid", "Sigmoid"}, {"tanh", "TanH"}};
+    framework::OpDesc op_desc(op, nullptr);
+    PADDLE_ENFORCE_EQ(op_desc.Input("X").size(), 1UL);
+    PADDLE_ENFORCE_EQ(op_desc.Output("Out").size(), 1UL);
+    auto it = kTypes.find(op_desc.Type());
+    PADDLE_ENFORCE(it != kTypes.end(), "Anakin unsupported activation %s",
+                   op_desc.Type());
+    auto op_name = this->OpName(op_desc);
+    this->engine_->AddOp(op_name, "Activation", op_desc.Input("X"),
+                         op_desc.Output("Out"));
+    this->engine_->AddOpAttr(op_name, "type", it->second);
+  }
+};
+
+}  // namespace anakin
+}  // namespace inference
+}  // namespace paddle
+
+REGISTER_ANAKIN_OP_CONVERTER(relu, ActivationOpConverter);
+REGISTER_ANAKIN_OP_CONVERTER(sigmoid, ActivationOpConverter);
+REGISTER_ANAKIN_OP_CONVERTER(tanh, ActivationOpConverter);
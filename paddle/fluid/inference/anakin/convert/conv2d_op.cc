@@ -0,0 +1,67 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "framework/core/parameter.h"
+#include "paddle/fluid/inference/anakin/convert/op_converter.h"
+
+namespace paddle {
+namespace inference {
+namespace anakin {
+
+/*
+ * Conv2dOp, Convolution in Anakin, the filter is a parameter in OIHW.
+ */
+template <typename Target>
+class Conv2dOpConverter : public AnakinOpConverter<Target> {
+ public:
+  void operator()(const framework::proto::OpDesc& op,
+                  const framework::Scope& scope) override {
+    framework::OpDesc op_desc(op, nullptr);
+    PADDLE_ENFORCE_EQ(op_desc.Input("Input").size(), 1UL);
+    PADDLE_ENFORCE_EQ(op_desc.Input("Filter").size(), 1UL);
+    PADDLE_ENFORCE_EQ(op_desc.Output("Output").size(), 1UL);
+    auto op_name = this->OpName(op_desc);
+    this->engine_->AddOp(op_name, "Convolution", op_desc.Input("Input"),
+                         op_desc.Output("Output"));
+
+    auto& filter = this->GetParameter(scope, op_desc.Input("Filter")[0]);
+    auto filter_shape = framework::vectorize2int(filter.dims());
+    PADDLE_ENFORCE_EQ(filter_shape.size(), 4UL);
+    auto* weight = this->engine_->AddWeight(filter, filter_shape);
+    this->engine_->AddOpAttr(op_name, "weight_1", *weight);
+
+    auto strides = boost::get<std::vector<int>>(op_desc.GetAttr("strides"));
+    auto paddings = boost::get<std::vector<int>>(op_desc.GetAttr("paddings"));
+    auto dilations = boost::get<std::vector<int>>(op_desc.GetAttr("dilations"));
+    int groups = boost::get<int>(op_desc.GetAttr("groups"));
+    ::anakin::PTuple<int> kernel_size({filter_shape[2], filter_shape[3]});
+    this->engine_->AddOpAttr(op_name, "filter_num", filter_shape[0]);
+    this->engine_->AddOpAttr(op_name, "kernel_size", kernel_size);
+    this->engine_->AddOpAttr(op_name, "strides",
+                             ::anakin::PTuple<int>(strides));
+    this->engine_->AddOpAttr(op_name, "padding",
+                             ::anakin::PTuple<int>(paddings));
+    this->engine_->AddOpAttr(op_name, "dilation_rate",
+                             ::anakin::PTuple<int>(dilations));
+    this->engine_->AddOpAttr(op_name, "group", groups);
+    this->engine_->AddOpAttr(op_name, "axis", 1);
+    this->engine_->AddOpAttr(op_name, "bias_term", false);
+  }
+};
+
+}  // namespace anakin
+}  // namespace inference
+}  // namespace paddle
+
+REGISTER_ANAKIN_OP_CONVERTER(conv2d, Conv2dOpConverter);
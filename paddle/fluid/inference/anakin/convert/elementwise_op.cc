@@ -0,0 +1,49 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <vector>
+#include "framework/core/parameter.h"
+#include "paddle/fluid/inference/anakin/convert/op_converter.h"
+
+namespace paddle {
+namespace inference {
+namespace anakin {
+
+/*
+ * ElementwiseAddOp of two tensors of the same shape, Eltwise in Anakin.
+ */
+template <typename Target>
+class ElementwiseAddOpConverter : public AnakinOpConverter<Target> {
+ public:
+  void operator()(const framework::proto::OpDesc& op,
+                  const framework::Scope& scope) override {
+    framework::OpDesc op_desc(op, nullptr);
+    PADDLE_ENFORCE_EQ(op_desc.Input("X").size(), 1UL);
+    PADDLE_ENFORCE_EQ(op_desc.Input("Y").size(), 1UL);
+    PADDLE_ENFORCE_EQ(op_desc.Output("Out").size(), 1UL);
+    auto op_name = this->OpName(op_desc);
+    this->engine_->AddOp(op_name, "Eltwise",
+                         {op_desc.Input("X")[0], op_desc.Input("Y")[0]},
+                         op_desc.Output("Out"));
+    this->engine_->AddOpAttr(op_name, "type", std::string("Add"));
+    this->engine_->AddOpAttr(op_name, "coeff",
+                             ::anakin::PTuple<float>({1.f, 1.f}));
+  }
+};
+
+}  // namespace anakin
+}  // namespace inference
+}  // namespace paddle
+
+REGISTER_ANAKIN_OP_CONVERTER(elementwise_add, ElementwiseAddOpConverter);
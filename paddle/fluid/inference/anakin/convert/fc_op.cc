@@ -0,0 +1,70 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <vector>
+#include "framework/core/parameter.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/inference/anakin/convert/op_converter.h"
+
+namespace paddle {
+namespace inference {
+namespace anakin {
+
+/*
+ * MulOp by a parameter, Dense in Anakin. Anakin takes the weight of
+ * [out_dim, in_dim], while fluid stores it in [in_dim, out_dim], so it is
+ * transposed once when converting.
+ */
+template <typename Target>
+class FcOpConverter : public AnakinOpConverter<Target> {
+ public:
+  void operator()(const framework::proto::OpDesc& op,
+                  const framework::Scope& scope) override {
+    framework::OpDesc op_desc(op, nullptr);
+    PADDLE_ENFORCE_EQ(op_desc.Input("X").size(), 1UL);
+    PADDLE_ENFORCE_EQ(op_desc.Input("Y").size(), 1UL);
+    PADDLE_ENFORCE_EQ(op_desc.Output("Out").size(), 1UL);
+    auto op_name = this->OpName(op_desc);
+    this->engine_->AddOp(op_name, "Dense", op_desc.Input("X"),
+                         op_desc.Output("Out"));
+
+    auto& y = this->GetParameter(scope, op_desc.Input("Y")[0]);
+    PADDLE_ENFORCE_EQ(y.dims().size(), 2UL);
+    int in_dim = static_cast<int>(y.dims()[0]);
+    int out_dim = static_cast<int>(y.dims()[1]);
+    framework::Tensor cpu_y;
+    framework::TensorCopySync(y, platform::CPUPlace(), &cpu_y);
+    framework::Tensor trans_y;
+    float* trans_data =
+        trans_y.mutable_data<float>({out_dim, in_dim}, platform::CPUPlace());
+    const float* y_data = cpu_y.data<float>();
+    for (int i = 0; i < in_dim; ++i) {
+      for (int j = 0; j < out_dim; ++j) {
+        trans_data[j * in_dim + i] = y_data[i * out_dim + j];
+      }
+    }
+    auto* weight = this->engine_->AddWeight(trans_y, {1, 1, out_dim, in_dim});
+    this->engine_->AddOpAttr(op_name, "weight_1", *weight);
+    this->engine_->AddOpAttr(op_name, "out_dim", out_dim);
+    this->engine_->AddOpAttr(
+        op_name, "axis", boost::get<int>(op_desc.GetAttr("x_num_col_dims")));
+    this->engine_->AddOpAttr(op_name, "bias_term", false);
+  }
+};
+
+}  // namespace anakin
+}  // namespace inference
+}  // namespace paddle
+
+REGISTER_ANAKIN_OP_CONVERTER(fc, FcOpConverter);
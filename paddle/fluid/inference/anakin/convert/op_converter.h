@@ -0,0 +1,135 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/inference/anakin/engine.h"
+#include "paddle/fluid/inference/utils/singleton.h"
+
+namespace paddle {
+namespace inference {
+namespace anakin {
+
+/*
+ * Convert Op from Fluid to Anakin Engine.
+ */
+template <typename Target>
+class AnakinOpConverter {
+ public:
+  AnakinOpConverter() {}
+
+  // Converter logic for an op.
+  virtual void operator()(const framework::proto::OpDesc& op,
+                          const framework::Scope& scope) {}
+
+  // Convert a single fluid operator and add the corresponding operator to
+  // the Anakin graph.
+  void ConvertOp(const framework::proto::OpDesc& op,
+                 const std::unordered_set<std::string>& parameters,
+                 const framework::Scope& scope, AnakinEngine<Target>* engine) {
+    framework::OpDesc op_desc(op, nullptr);
+    std::string type = op_desc.Type();
+    if (type == "mul") {
+      PADDLE_ENFORCE_EQ(op_desc.Input("Y").size(), 1UL);
+      PADDLE_ENFORCE(parameters.count(op_desc.Input("Y")[0]),
+                     "Anakin engine only converts the mul by a parameter");
+      type = "fc";
+    }
+    if (type == "depthwise_conv2d") {
+      type = "conv2d";
+    }
+    auto* it = Registry<AnakinOpConverter<Target>>::Lookup(type);
+    PADDLE_ENFORCE_NOT_NULL(it, "no OpConverter for optype [%s]",
+                            op_desc.Type());
+    it->SetEngine(engine);
+    (*it)(op, scope);
+  }
+
+  // Convert a fluid block to the Anakin graph, NOTE it just converts the
+  // operators, the inputs and outputs of the graph are declared by the
+  // anakin_engine op.
+  void ConvertBlock(const framework::proto::BlockDesc& block,
+                    const std::unordered_set<std::string>& parameters,
+                    const framework::Scope& scope,
+                    AnakinEngine<Target>* engine) {
+    for (int i = 0; i < block.ops_size(); i++) {
+      ConvertOp(block.ops(i), parameters, scope, engine);
+    }
+  }
+
+  void SetEngine(AnakinEngine<Target>* engine) { engine_ = engine; }
+
+  virtual ~AnakinOpConverter() {}
+
+ protected:
+  // The unique name of the Anakin operator of a fluid operator, which is the
+  // name of its first output.
+  static std::string OpName(const framework::OpDesc& op) {
+    auto outputs = op.OutputArgumentNames();
+    PADDLE_ENFORCE(!outputs.empty(), "the op %s has no output", op.Type());
+    return op.Type() + ":" + outputs.front();
+  }
+
+  // The parameter called name, in CPU memory.
+  static const framework::LoDTensor& GetParameter(
+      const framework::Scope& scope, const std::string& name) {
+    auto* var = scope.FindVar(name);
+    PADDLE_ENFORCE_NOT_NULL(var, "no parameter called %s", name);
+    return var->Get<framework::LoDTensor>();
+  }
+
+  AnakinEngine<Target>* engine_{nullptr};
+};
+
+}  // namespace anakin
+}  // namespace inference
+}  // namespace paddle
+
+#ifdef PADDLE_WITH_CUDA
+#define REGISTER_ANAKIN_NV_CONVERTER(op_type__, Converter__)            \
+  ::paddle::inference::Registry<                                        \
+      ::paddle::inference::anakin::AnakinOpConverter<::anakin::NV>>::   \
+      Register<::paddle::inference::anakin::Converter__<::anakin::NV>>( \
+          #op_type__);
+#else
+#define REGISTER_ANAKIN_NV_CONVERTER(op_type__, Converter__)
+#endif
+
+#define REGISTER_ANAKIN_OP_CONVERTER(op_type__, Converter__)                   \
+  struct anakin_##op_type__##_converter                                        \
+      : public ::paddle::framework::Registrar {                                \
+    anakin_##op_type__##_converter() {                                         \
+      ::paddle::inference::Registry<                                           \
+          ::paddle::inference::anakin::AnakinOpConverter<::anakin::X86>>::     \
+          Register<::paddle::inference::anakin::Converter__<::anakin::X86>>(   \
+              #op_type__);                                                     \
+      REGISTER_ANAKIN_NV_CONVERTER(op_type__, Converter__)                     \
+    }                                                                          \
+  };                                                                           \
+  anakin_##op_type__##_converter anakin_##op_type__##_converter__;             \
+  int TouchAnakinConverterRegister_##op_type__() {                             \
+    anakin_##op_type__##_converter__.Touch();                                  \
+    return 0;                                                                  \
+  }
+
+#define USE_ANAKIN_CONVERTER(op_type__)                                    \
+  extern int TouchAnakinConverterRegister_##op_type__();                   \
+  static int use_op_converter_anakin_##op_type__ __attribute__((unused)) = \
+      TouchAnakinConverterRegister_##op_type__();
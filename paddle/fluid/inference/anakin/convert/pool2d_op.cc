@@ -0,0 +1,72 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <string>
+#include <vector>
+#include "framework/core/parameter.h"
+#include "paddle/fluid/inference/anakin/convert/op_converter.h"
+
+namespace paddle {
+namespace inference {
+namespace anakin {
+
+/*
+ * Pool2dOp, Pooling in Anakin.
+ */
+template <typename Target>
+class Pool2dOpConverter : public AnakinOpConverter<Target> {
+ public:
+  void operator()(const framework::proto::OpDesc& op,
+                  const framework::Scope& scope) override {
+    framework::OpDesc op_desc(op, nullptr);
+    PADDLE_ENFORCE_EQ(op_desc.Input("X").size(), 1UL);
+    PADDLE_ENFORCE_EQ(op_desc.Output("Out").size(), 1UL);
+    auto op_name = this->OpName(op_desc);
+    this->engine_->AddOp(op_name, "Pooling", op_desc.Input("X"),
+                         op_desc.Output("Out"));
+
+    auto pool_type =
+        boost::get<std::string>(op_desc.GetAttr("pooling_type"));
+    auto ksize = boost::get<std::vector<int>>(op_desc.GetAttr("ksize"));
+    auto strides = boost::get<std::vector<int>>(op_desc.GetAttr("strides"));
+    auto paddings = boost::get<std::vector<int>>(op_desc.GetAttr("paddings"));
+    bool global_pooling = boost::get<bool>(op_desc.GetAttr("global_pooling"));
+    bool ceil_mode = boost::get<bool>(op_desc.GetAttr("ceil_mode"));
+    std::string method;
+    if (pool_type == "max") {
+      method = "MAX";
+    } else if (pool_type == "avg") {
+      // fluid excludes the padding from the average by default.
+      method = "AVGEXC";
+    } else {
+      PADDLE_THROW("Anakin unsupported pooling type %s", pool_type);
+    }
+    this->engine_->AddOpAttr(op_name, "method", method);
+    this->engine_->AddOpAttr(op_name, "pool_size",
+                             ::anakin::PTuple<int>(ksize));
+    this->engine_->AddOpAttr(op_name, "strides",
+                             ::anakin::PTuple<int>(strides));
+    this->engine_->AddOpAttr(op_name, "padding",
+                             ::anakin::PTuple<int>(paddings));
+    this->engine_->AddOpAttr(op_name, "global_pooling", global_pooling);
+    this->engine_->AddOpAttr(op_name, "cmp_out_shape_floor_as_conv",
+                             !ceil_mode);
+  }
+};
+
+}  // namespace anakin
+}  // namespace inference
+}  // namespace paddle
+
+REGISTER_ANAKIN_OP_CONVERTER(pool2d, Pool2dOpConverter);
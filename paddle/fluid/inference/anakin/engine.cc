@@ -0,0 +1,193 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/anakin/engine.h"
+
+#ifdef PADDLE_WITH_CUDA
+#include <cuda_runtime.h>
+#endif
+#include <glog/logging.h>
+#include <cstring>
+#include <type_traits>
+
+#include "framework/graph/graph_global_mem.h"
+#include "paddle/fluid/framework/tensor_util.h"
+
+namespace paddle {
+namespace inference {
+namespace anakin {
+
+namespace {
+
+// Copy between the memory of Anakin and the fluid tensors, which are in the
+// place of the kernel, i.e. the CPU for X86 and the GPU for NV.
+template <typename Target>
+void CopyData(void *dst, const void *src, size_t size) {
+#ifdef PADDLE_WITH_CUDA
+  if (std::is_same<::anakin::NV, Target>::value) {
+    PADDLE_ENFORCE_EQ(cudaMemcpy(dst, src, size, cudaMemcpyDefault), 0,
+                      "copy data of the Anakin engine failed");
+    return;
+  }
+#endif
+  std::memcpy(dst, src, size);
+}
+
+::anakin::saber::Shape ToAnakinShape(const std::vector<int> &shape) {
+  // Anakin takes the tensors in NCHW.
+  PADDLE_ENFORCE_LE(shape.size(), 4UL,
+                    "Anakin engine takes tensors of at most 4 dimensions");
+  ::anakin::saber::Shape res;
+  for (auto s : shape) {
+    res.push_back(s);
+  }
+  while (res.size() < 4UL) {
+    res.push_back(1);
+  }
+  return res;
+}
+
+int64_t ShapeCount(const std::vector<int> &shape) {
+  int64_t count = 1;
+  for (auto s : shape) {
+    count *= s;
+  }
+  return count;
+}
+
+}  // namespace
+
+template <typename Target>
+AnakinEngine<Target>::AnakinEngine(int max_batch_size, int device)
+    : max_batch_size_(max_batch_size), device_(device), graph_(new GraphT) {
+  PADDLE_ENFORCE_GT(max_batch_size_, 0,
+                    "Anakin engine needs the max_batch_size set");
+}
+
+template <typename Target>
+AnakinEngine<Target>::~AnakinEngine() {}
+
+template <typename Target>
+void AnakinEngine<Target>::AddOp(const std::string &name,
+                                 const std::string &type,
+                                 const std::vector<std::string> &inputs,
+                                 const std::vector<std::string> &outputs) {
+  PADDLE_ENFORCE(graph_->AddOp(name, type, inputs, outputs),
+                 "Add operation %s of type %s failed", name, type);
+}
+
+template <typename Target>
+typename AnakinEngine<Target>::BlockT *AnakinEngine<Target>::AddWeight(
+    const framework::Tensor &tensor, const std::vector<int> &shape) {
+  PADDLE_ENFORCE_EQ(ShapeCount(shape), tensor.numel(),
+                    "the shape of the weight does not match the tensor");
+  auto anakin_shape = ToAnakinShape(shape);
+  auto *block = ::anakin::graph::GraphGlobalMem<Target>::Global()
+                    .template new_block<::anakin::saber::AK_FLOAT>(
+                        anakin_shape);
+  // The host tensor is filled first, the device tensor copies from it.
+  framework::Tensor cpu_tensor;
+  const framework::Tensor *src = &tensor;
+  if (!platform::is_cpu_place(tensor.place())) {
+    framework::TensorCopySync(tensor, platform::CPUPlace(), &cpu_tensor);
+    src = &cpu_tensor;
+  }
+  float *data = block->h_tensor().mutable_data();
+  std::memcpy(data, src->data<float>(), tensor.numel() * sizeof(float));
+  block->d_tensor().set_shape(anakin_shape);
+  block->d_tensor().copy_from(block->h_tensor());
+  return block;
+}
+
+template <typename Target>
+void AnakinEngine<Target>::DeclareInput(const std::string &name,
+                                        const std::vector<int> &shape) {
+  PADDLE_ENFORCE(!shape.empty());
+  std::vector<int> max_shape(shape);
+  max_shape[0] = max_batch_size_;
+  PADDLE_ENFORCE(graph_->AddOp(name, "Input", {}, {name}),
+                 "Add input %s failed", name);
+  AddOpAttr(name, "input_shape", ToAnakinShape(max_shape));
+  graph_->RegistVar(name);
+  inputs_.push_back(name);
+  input_shapes_[name] = max_shape;
+}
+
+template <typename Target>
+void AnakinEngine<Target>::DeclareOutput(const std::string &name) {
+  PADDLE_ENFORCE(graph_->AddOp(name + "_out", "Output", {name}, {}),
+                 "Add output %s failed", name);
+  graph_->RegistVar(name);
+  outputs_.push_back(name);
+}
+
+template <typename Target>
+void AnakinEngine<Target>::Freeze() {
+  PADDLE_ENFORCE(graph_->Freeze(), "Freeze the Anakin graph failed");
+  PADDLE_ENFORCE(graph_->Optimize(), "Optimize the Anakin graph failed");
+  net_.reset(new NetT(*graph_, true));
+}
+
+template <typename Target>
+void AnakinEngine<Target>::Execute(
+    const std::map<std::string, framework::LoDTensor *> &inputs,
+    const std::map<std::string, framework::LoDTensor *> &outputs,
+    const platform::Place &place) {
+  PADDLE_ENFORCE(net_ != nullptr, "Call Freeze before executing the engine");
+  // Recreate the Net if an input is larger than the one it is created for.
+  bool reshaped = false;
+  for (const auto &input : inputs) {
+    auto shape = framework::vectorize2int(input.second->dims());
+    auto &net_shape = input_shapes_[input.first];
+    if (ShapeCount(shape) > ShapeCount(net_shape)) {
+      VLOG(3) << "reshape the input " << input.first << " of Anakin engine";
+      graph_->Reshape(input.first, ToAnakinShape(shape));
+      net_shape = shape;
+      reshaped = true;
+    }
+  }
+  if (reshaped) {
+    net_.reset(new NetT(*graph_, true));
+  }
+
+  for (const auto &input : inputs) {
+    auto *tensor = input.second;
+    auto *anakin_input = net_->get_in(input.first);
+    anakin_input->reshape(
+        ToAnakinShape(framework::vectorize2int(tensor->dims())));
+    CopyData<Target>(anakin_input->mutable_data(), tensor->data<float>(),
+                     tensor->numel() * sizeof(float));
+  }
+
+  net_->prediction();
+
+  for (const auto &output : outputs) {
+    auto *tensor = output.second;
+    auto *anakin_output = net_->get_out(output.first);
+    std::vector<int> shape = anakin_output->valid_shape();
+    tensor->Resize(framework::make_ddim(shape));
+    CopyData<Target>(tensor->mutable_data<float>(place),
+                     anakin_output->mutable_data(),
+                     tensor->numel() * sizeof(float));
+  }
+}
+
+template class AnakinEngine<::anakin::X86>;
+#ifdef PADDLE_WITH_CUDA
+template class AnakinEngine<::anakin::NV>;
+#endif
+
+}  // namespace anakin
+}  // namespace inference
+}  // namespace paddle
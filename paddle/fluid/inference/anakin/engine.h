@@ -0,0 +1,137 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "framework/core/net/net.h"
+#include "framework/graph/graph.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "saber/core/shape.h"
+#include "saber/saber_types.h"
+
+namespace paddle {
+namespace inference {
+namespace anakin {
+
+/*
+ * Anakin Engine, runs a subgraph of a fluid program on the Anakin kernels.
+ *
+ * The op converters add the operators and their weights to the graph, then
+ * Freeze optimizes the graph and creates the Net executing it. Target is
+ * anakin::X86 or anakin::NV.
+ */
+template <typename Target>
+class AnakinEngine {
+ public:
+  using GraphT = ::anakin::graph::Graph<Target, ::anakin::saber::AK_FLOAT,
+                                        ::anakin::Precision::FP32>;
+  using NetT = ::anakin::Net<Target, ::anakin::saber::AK_FLOAT,
+                             ::anakin::Precision::FP32>;
+  using BlockT = ::anakin::PBlock<float, Target>;
+
+  explicit AnakinEngine(int max_batch_size, int device = 0);
+  ~AnakinEngine();
+
+  // Add an operator called name to the graph, its inputs and outputs are the
+  // names of the variables of the fluid subgraph.
+  void AddOp(const std::string& name, const std::string& type,
+             const std::vector<std::string>& inputs,
+             const std::vector<std::string>& outputs);
+
+  template <typename T>
+  void AddOpAttr(const std::string& op_name, const std::string& attr_name,
+                 const T& attr_value) {
+    PADDLE_ENFORCE(graph_->AddOpAttr(op_name, attr_name, attr_value),
+                   "Add operation's attribution %s of %s failed", attr_name,
+                   op_name);
+  }
+
+  // Create a weight block of the shape in NCHW, owned by the graph, and fill
+  // it with the data of the fluid tensor, which is in any place.
+  BlockT* AddWeight(const framework::Tensor& tensor,
+                    const std::vector<int>& shape);
+
+  // Declare the input of the graph with its shape, the first dim is the batch
+  // size, which is bounded by max_batch_size.
+  void DeclareInput(const std::string& name, const std::vector<int>& shape);
+  void DeclareOutput(const std::string& name);
+
+  // Optimize the graph and create the Net after adding all the operators.
+  void Freeze();
+
+  // Run the Net on the inputs, and write its outputs to the fluid tensors in
+  // place. The inputs and outputs are keyed by the names declared.
+  void Execute(const std::map<std::string, framework::LoDTensor*>& inputs,
+               const std::map<std::string, framework::LoDTensor*>& outputs,
+               const platform::Place& place);
+
+  int max_batch_size() const { return max_batch_size_; }
+  std::vector<std::string> inputs() const { return inputs_; }
+  std::vector<std::string> outputs() const { return outputs_; }
+
+ private:
+  int max_batch_size_;
+  int device_;
+  std::unique_ptr<GraphT> graph_;
+  std::unique_ptr<NetT> net_;
+  std::vector<std::string> inputs_;
+  std::vector<std::string> outputs_;
+  // The shapes of the inputs the Net is created for, the Net is recreated if
+  // an input becomes larger.
+  std::unordered_map<std::string, std::vector<int>> input_shapes_;
+};
+
+/*
+ * Helper to control the Anakin engines' creation and deletion, the engines
+ * are shared by the anakin_engine ops of the same key.
+ */
+template <typename Target>
+class AnakinEngineManager {
+ public:
+  bool HasEngine(const std::string& name) const {
+    return engines_.count(name) != 0;
+  }
+
+  AnakinEngine<Target>* Get(const std::string& name) const {
+    return engines_.at(name).get();
+  }
+
+  AnakinEngine<Target>* Create(int max_batch_size, const std::string& name,
+                               int device = 0) {
+    auto* p = new AnakinEngine<Target>(max_batch_size, device);
+    engines_[name].reset(p);
+    return p;
+  }
+
+  void DeleteAll() {
+    for (auto& item : engines_) {
+      item.second.reset(nullptr);
+    }
+  }
+
+ private:
+  std::unordered_map<std::string, std::unique_ptr<AnakinEngine<Target>>>
+      engines_;
+};
+
+}  // namespace anakin
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,97 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/analysis/anakin_op_teller.h"
+#include <unordered_set>
+#include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/op_desc.h"
+
+namespace paddle {
+namespace inference {
+namespace analysis {
+
+namespace {
+
+// The operators converted without conditions.
+const std::unordered_set<std::string> kSupportedOps = {
+    "relu", "sigmoid", "tanh", "softmax", "concat"};
+
+bool SetReason(std::string *reason, const std::string &msg) {
+  if (reason) *reason = msg;
+  return false;
+}
+
+bool IsParameter(const Node *node, const std::string &name) {
+  for (auto *in : node->inlinks) {
+    if (in->name() == name && !in->pb_msg().empty()) {
+      framework::proto::VarDesc var;
+      return var.ParseFromString(in->pb_msg()) && var.persistable();
+    }
+  }
+  return false;
+}
+
+bool TellOp(const Node *node, const framework::OpDesc &op,
+            std::string *reason) {
+  const auto &type = op.Type();
+  if (type == "conv2d" || type == "depthwise_conv2d") {
+    if (!IsParameter(node, op.Input("Filter")[0])) {
+      return SetReason(reason, "Filter is not a parameter");
+    }
+    return true;
+  }
+  if (type == "mul") {
+    if (!IsParameter(node, op.Input("Y")[0])) {
+      return SetReason(reason, "Y is not a parameter");
+    }
+    return true;
+  }
+  if (type == "pool2d") {
+    auto pool_type = boost::get<std::string>(op.GetAttr("pooling_type"));
+    if (pool_type != "max" && pool_type != "avg") {
+      return SetReason(reason, "the pooling type " + pool_type +
+                                   " is not supported");
+    }
+    return true;
+  }
+  if (type == "elementwise_add") {
+    // Only the sum of two tensors of the same shape is converted.
+    if (IsParameter(node, op.Input("Y")[0])) {
+      return SetReason(reason, "Y is a parameter");
+    }
+    if (boost::get<int>(op.GetAttr("axis")) != -1) {
+      return SetReason(reason, "Y is broadcasted");
+    }
+    return true;
+  }
+  return SetReason(reason, "no converter");
+}
+
+}  // namespace
+
+bool AnakinCanConvert(const Node *node, std::string *reason) {
+  if (!node->IsFunction()) return SetReason(reason, "not an operator");
+  auto *func = static_cast<const Function *>(node);
+  if (kSupportedOps.count(func->func_type())) return true;
+  framework::proto::OpDesc proto;
+  if (node->pb_msg().empty() || !proto.ParseFromString(node->pb_msg())) {
+    return SetReason(reason, "the desc of the operator is unknown");
+  }
+  framework::OpDesc op(proto, nullptr);
+  return TellOp(node, op, reason);
+}
+
+}  // namespace analysis
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,60 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/analysis/anakin_subgraph_pass.h"
+#include <map>
+#include <utility>
+#include "paddle/fluid/inference/analysis/anakin_op_teller.h"
+
+namespace paddle {
+namespace inference {
+namespace analysis {
+
+void AnakinSubGraphPass::Run(DataFlowGraph *graph) {
+  SubGraphFuse(graph, node_inside_subgraph_teller_, argument_, "anakin")();
+
+  // Log the operators left to fluid, with the reasons they are not converted.
+  std::map<std::string, std::pair<int, std::string>> blockers;
+  int num_engines = 0;
+  int num_converted = 0;
+  for (auto &node : graph->nodes.nodes()) {
+    if (node->deleted()) continue;
+    if (node->IsFunctionBlock()) {
+      auto *block = static_cast<FunctionBlock *>(node.get());
+      if (block->engine_type != "anakin") continue;
+      ++num_engines;
+      num_converted += block->subgraph.size();
+      continue;
+    }
+    if (!node->IsFunction() || node_inside_subgraph_teller_(node.get())) {
+      continue;
+    }
+    auto &type = static_cast<Function *>(node.get())->func_type();
+    auto &blocker = blockers[type];
+    ++blocker.first;
+    if (blocker.second.empty()) {
+      AnakinCanConvert(node.get(), &blocker.second);
+    }
+  }
+  LOG(INFO) << "Anakin subgraph: " << num_engines << " engines of "
+            << num_converted << " operators";
+  for (auto &blocker : blockers) {
+    LOG(INFO) << "Anakin fallback to fluid: " << blocker.first << " x "
+              << blocker.second.first << ", " << blocker.second.second;
+  }
+}
+
+}  // namespace analysis
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,57 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include "paddle/fluid/inference/analysis/analysis_pass.h"
+#include "paddle/fluid/inference/analysis/node.h"
+#include "paddle/fluid/inference/analysis/subgraph_splitter.h"
+
+namespace paddle {
+namespace inference {
+namespace analysis {
+
+/*
+ * Parse the graph and replace the sub-graphs of the Anakin supported nodes
+ * with the blocks run by the anakin_engine op, the other nodes are left to
+ * fluid.
+ */
+class AnakinSubGraphPass : public DataFlowGraphPass {
+ public:
+  using NodeInsideSubgraphTeller = SubGraphFuse::NodeInsideSubgraphTeller;
+
+  explicit AnakinSubGraphPass(const NodeInsideSubgraphTeller& teller)
+      : node_inside_subgraph_teller_(teller) {}
+
+  bool Initialize(Argument* argument) override {
+    argument_ = argument;
+    return true;
+  }
+
+  void Run(DataFlowGraph* graph) override;
+
+  bool Finalize() override { return true; }
+
+  std::string repr() const override { return "anakin-sub-graph"; }
+  std::string description() const override { return "anakin sub graph pass"; }
+
+ private:
+  NodeInsideSubgraphTeller node_inside_subgraph_teller_;
+  Argument* argument_;
+};
+
+}  // namespace analysis
+}  // namespace inference
+}  // namespace paddle
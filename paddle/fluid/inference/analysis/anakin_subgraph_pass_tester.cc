@@ -0,0 +1,69 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/analysis/anakin_subgraph_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/inference/analysis/anakin_op_teller.h"
+#include "paddle/fluid/inference/analysis/data_flow_graph_to_fluid_pass.h"
+#include "paddle/fluid/inference/analysis/ut_helper.h"
+
+namespace paddle {
+namespace inference {
+namespace analysis {
+
+TEST(AnakinSubGraphPass, main) {
+  auto teller = [](const Node* node) { return AnakinCanConvert(node); };
+
+  Argument argument(FLAGS_inference_model_dir);
+  argument.Set<int>("minimum_subgraph_size", new int(0));
+  argument.Set<int>("max_batch_size", new int(3));
+
+  FluidToDataFlowGraphPass pass0;
+  AnakinSubGraphPass anakin_pass(teller);
+  DataFlowGraphToFluidPass pass1;
+  ASSERT_TRUE(pass0.Initialize(&argument));
+  ASSERT_TRUE(anakin_pass.Initialize(&argument));
+  ASSERT_TRUE(pass1.Initialize(&argument));
+
+  argument.main_dfg.reset(new DataFlowGraph);
+  pass0.Run(argument.main_dfg.get());
+  anakin_pass.Run(argument.main_dfg.get());
+
+  // The lookup_table ops of word2vec are left to fluid, the rest are fused.
+  int num_blocks = 0;
+  for (auto& node : argument.main_dfg->nodes.nodes()) {
+    if (node->deleted()) continue;
+    if (node->IsFunctionBlock()) {
+      ++num_blocks;
+      EXPECT_EQ(static_cast<FunctionBlock*>(node.get())->engine_type,
+                "anakin");
+    } else if (node->IsFunction()) {
+      EXPECT_FALSE(AnakinCanConvert(node.get()));
+    }
+  }
+  EXPECT_GT(num_blocks, 0);
+
+  pass1.Run(argument.main_dfg.get());
+  int num_engine_ops = 0;
+  for (auto& op : argument.transformed_program_desc->blocks(0).ops()) {
+    EXPECT_NE(op.type(), "tensorrt_engine");
+    if (op.type() == "anakin_engine") ++num_engine_ops;
+  }
+  EXPECT_EQ(num_engine_ops, num_blocks);
+}
+
+}  // namespace analysis
+}  // namespace inference
+}  // namespace paddle
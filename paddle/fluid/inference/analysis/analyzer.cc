@@ -16,18 +16,28 @@
 #include <string>
 #include <vector>
 
+#include "paddle/fluid/inference/analysis/anakin_op_teller.h"
+#include "paddle/fluid/inference/analysis/anakin_subgraph_pass.h"
 #include "paddle/fluid/inference/analysis/data_flow_graph_to_fluid_pass.h"
 #include "paddle/fluid/inference/analysis/dfg_graphviz_draw_pass.h"
 #include "paddle/fluid/inference/analysis/fluid_to_data_flow_graph_pass.h"
 #include "paddle/fluid/inference/analysis/fluid_to_ir_pass.h"
 #include "paddle/fluid/inference/analysis/model_store_pass.h"
 #include "paddle/fluid/inference/analysis/pass_manager.h"
+#include "paddle/fluid/inference/analysis/tensorrt_op_teller.h"
 #include "paddle/fluid/inference/analysis/tensorrt_subgraph_node_mark_pass.h"
 #include "paddle/fluid/inference/analysis/tensorrt_subgraph_pass.h"
 
 DEFINE_bool(IA_enable_tensorrt_subgraph_engine, false,
             "Enable subgraph to TensorRT engine for acceleration");
 
+DEFINE_bool(IA_enable_anakin_subgraph_engine, false,
+            "Offload the subgraphs supported by Anakin to Anakin engine");
+
+DEFINE_bool(IA_enable_subgraph_cost_model, false,
+            "Fuse only the subgraphs the cost model estimates to be faster in "
+            "the engine than in fluid");
+
 DEFINE_bool(IA_enable_ir, false, "Turn on IR support");
 
 DEFINE_string(IA_graphviz_log_root, "./",
@@ -49,6 +59,7 @@ class DfgPassManagerImpl final : public DfgPassManager {
       AddPass("fluid-to-ir-pass", new FluidToIrPass);
     }
     TryAddTensorRtPass();
+    TryAddAnakinPass();
     AddPass("data-flow-graph-to-fluid", new DataFlowGraphToFluidPass);
     if (!FLAGS_IA_output_storage_path.empty()) {
       AddPass("model-store-pass", new ModelStorePass);
@@ -68,18 +79,7 @@ class DfgPassManagerImpl final : public DfgPassManager {
   void TryAddTensorRtPass() {
     if (FLAGS_IA_enable_tensorrt_subgraph_engine) {
       auto trt_teller = [&](const Node* node) {
-        std::unordered_set<std::string> teller_set(
-            {"mul", "conv2d", "pool2d", "relu", "softmax", "sigmoid",
-             "depthwise_conv2d", "batch_norm", "concat", "tanh", "pad",
-             "elementwise_add", "dropout"});
-        if (!node->IsFunction()) return false;
-
-        const auto* func = static_cast<const Function*>(node);
-        if (teller_set.count(func->func_type())) {
-          return true;
-        } else {
-          return false;
-        }
+        return TensorRTCanConvert(node);
       };
 
       AddPass("tensorrt-subgraph-marker",
@@ -88,6 +88,16 @@ class DfgPassManagerImpl final : public DfgPassManager {
     }
   }
 
+  void TryAddAnakinPass() {
+    if (FLAGS_IA_enable_anakin_subgraph_engine) {
+      // The operators not fused by TensorRT are left to Anakin.
+      auto anakin_teller = [&](const Node* node) {
+        return AnakinCanConvert(node);
+      };
+      AddPass("anakin-subgraph", new AnakinSubGraphPass(anakin_teller));
+    }
+  }
+
   // Add the graphviz debuger pass if the parent pass has one.
   void AddGraphvizDebugerPass(AnalysisPass* pass) {
     auto* debuger_pass = pass->CreateGraphvizDebugerPass();
@@ -67,8 +67,11 @@ class Analyzer : public OrderedRegistry<PassManager> {
   // larger fusion.
   const std::vector<std::string> all_ir_passes_{{
       // Manual update the passes here.
+      "constant_folding_pass",          //
       "attention_lstm_fuse_pass",       //
       "seqconv_eltadd_relu_fuse_pass",  //
+      "seqpool_concat_fuse_pass",       //
+      "multihead_attention_fuse_pass",  //
       "embedding_fc_lstm_fuse_pass",    //
       "fc_lstm_fuse_pass",              //
       "mul_lstm_fuse_pass",             //
@@ -76,14 +79,28 @@ class Analyzer : public OrderedRegistry<PassManager> {
       "mul_gru_fuse_pass",              //
       "seq_concat_fc_fuse_pass",        //
       "fc_fuse_pass",                   //
-      "conv_bn_fuse_pass",              //
-      "conv_eltwiseadd_bn_fuse_pass",   //
+      // Before conv_bn_fuse_pass, which folds the batch_norm of the block.
+      "depthwise_pointwise_conv_fuse_pass",  //
+      "conv_bn_fuse_pass",                   //
+      "conv_eltwiseadd_bn_fuse_pass",        //
 #ifdef PADDLE_WITH_MKLDNN
       "depthwise_conv_mkldnn_pass",             //
       "conv_bias_mkldnn_fuse_pass",             //
       "conv_relu_mkldnn_fuse_pass",             //
       "conv_elementwise_add_mkldnn_fuse_pass",  //
 #endif
+      // The smallest fuse, after all the fuses of elementwise and activations.
+      "elementwise_chain_fuse_pass",  //
+      // After the fuses, which create the fc operators.
+      "packed_weight_pass",  //
+#ifdef PADDLE_WITH_MKLDNN
+      // After the fuses, which decide the MKLDNN operators.
+      "mkldnn_layout_propagation_pass",  //
+#endif
+      // After the fuses, which match the original variables.
+      "inplace_pass",  //
+      // After the inplace_pass, which writes the variables more than once.
+      "virtual_concat_pass",  //
   }};
 
   std::unordered_set<std::string> disabled_ir_passes_;
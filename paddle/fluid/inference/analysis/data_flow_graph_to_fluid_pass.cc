@@ -97,14 +97,19 @@ void DataFlowGraphToFluidPass::AddFluidOp(Node *node) {
   }
 }
 
-void CreateTrtEngineOp(Node *node, Argument *argument,
-                       framework::proto::BlockDesc *block) {
+// Create the engine op running the sub-graph of the block node, the
+// tensorrt_engine or the anakin_engine by the engine type of the block.
+void CreateEngineOp(Node *node, Argument *argument,
+                    framework::proto::BlockDesc *block) {
   PADDLE_ENFORCE(argument->main_dfg.get());
   const DataFlowGraph &graph = *(argument->main_dfg);
   static int counter{0};
   PADDLE_ENFORCE(node->IsFunctionBlock());
   framework::OpDesc desc;
   auto *func = static_cast<FunctionBlock *>(node);
+  const std::string &engine_type = func->engine_type;
+  PADDLE_ENFORCE(engine_type == "tensorrt" || engine_type == "anakin",
+                 "unknown engine type %s", engine_type);
 
   // collect inputs
   std::unordered_set<std::string> input_names;
@@ -125,16 +130,16 @@ void CreateTrtEngineOp(Node *node, Argument *argument,
 
   desc.SetOutput(
       "Ys", std::vector<std::string>(output_names.begin(), output_names.end()));
-  desc.SetType("tensorrt_engine");
+  desc.SetType(engine_type + "_engine");
 
   std::unordered_map<std::string, std::string> output_name_map;
 
   // The following procedure is used to rename all the intermediate
   // variables and the output variables of the subgraph.
   // Why we do this?
-  // During the transition from fluid OP to tensorrt OP, we map
+  // During the transition from fluid OP to engine OP, we map
   // the input and output Tensor(fluid data structure) of fluid OP
-  // to the correspondin ITensor (trt data structure) through the
+  // to the correspondin tensor of the engine through the
   // Tensor name. When we set up ITensor for an variable, we must
   // ensure that it has not been set before.
   // If there is variable in the fluid graph, which is not only the
@@ -195,7 +200,7 @@ void CreateTrtEngineOp(Node *node, Argument *argument,
       }
     }
   }
-  // When tensorrt engine runs at the end of the operation,
+  // When the engine runs at the end of the operation,
   // output_mapping help us copy the data from the renamed ITensor
   // to Tensor.
   std::vector<std::string> output_mapping;
@@ -209,8 +214,19 @@ void CreateTrtEngineOp(Node *node, Argument *argument,
 
   SetAttr(desc.Proto(), "subgraph", block->SerializeAsString());
   SetAttr(desc.Proto(), "max_batch_size", argument->Get<int>("max_batch_size"));
-  SetAttr(desc.Proto(), "workspace_size", argument->Get<int>("workspace_size"));
-  SetAttr(desc.Proto(), "engine_uniq_key", "trt-" + std::to_string(counter++));
+  if (engine_type == "tensorrt") {
+    SetAttr(desc.Proto(), "workspace_size",
+            argument->Get<int>("workspace_size"));
+    SetAttr(desc.Proto(), "engine_uniq_key",
+            "trt-" + std::to_string(counter++));
+    if (argument->Has("precision_mode")) {
+      SetAttr(desc.Proto(), "precision_mode",
+              argument->Get<std::string>("precision_mode"));
+    }
+  } else {
+    SetAttr(desc.Proto(), "engine_uniq_key",
+            "anakin-" + std::to_string(counter++));
+  }
   SetAttr(desc.Proto(), "parameters", ExtractParameters(graph.nodes.nodes()));
   SetAttr(desc.Proto(), "output_name_mapping", output_mapping);
   node->SetPbMsg(desc.Proto()->SerializeAsString());
@@ -253,7 +269,7 @@ void DataFlowGraphToFluidPass::AddEngineOp(Node *node) {
   *block_desc.Proto()->mutable_vars() =
       argument_->origin_program_desc->blocks(0).vars();
   PADDLE_ENFORCE(!block_desc.Proto()->vars().empty());
-  CreateTrtEngineOp(node, argument_, block_desc.Proto());
+  CreateEngineOp(node, argument_, block_desc.Proto());
   auto *main_block = desc_->mutable_blocks(framework::kRootBlockIndex);
   auto *op = main_block->add_ops();
   PADDLE_ENFORCE(!node->pb_msg().empty(), "failed to set desc for block");
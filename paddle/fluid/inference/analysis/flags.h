@@ -17,6 +17,8 @@
 // TODO(Superjomn) add a definition flag like PADDLE_WITH_TENSORRT and hide this
 // flag if not available.
 DECLARE_bool(IA_enable_tensorrt_subgraph_engine);
+DECLARE_bool(IA_enable_anakin_subgraph_engine);
+DECLARE_bool(IA_enable_subgraph_cost_model);
 DECLARE_string(IA_graphviz_log_root);
 DECLARE_string(IA_output_storage_path);
 DECLARE_bool(IA_enable_ir);
@@ -106,6 +106,13 @@ class FluidToIrPass final : public DataFlowGraphPass {
               ir_passes.graph().Get<std::unordered_map<std::string, int>>(
                   framework::ir::kFuseStatisAttr)));
     }
+    if (ir_passes.graph().Has(framework::ir::kPassTimingAttr)) {
+      argument_->Set(
+          framework::ir::kPassTimingAttr,
+          new std::unordered_map<std::string, double>(
+              ir_passes.graph().Get<std::unordered_map<std::string, double>>(
+                  framework::ir::kPassTimingAttr)));
+    }
   }
 
   void EnableParamModify(const std::string &model_dir,
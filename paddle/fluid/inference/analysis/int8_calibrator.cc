@@ -0,0 +1,174 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/analysis/int8_calibrator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace inference {
+namespace analysis {
+
+Int8Calibrator::Algorithm Int8Calibrator::ParseAlgorithm(
+    const std::string& name) {
+  if (name == "max") return Algorithm::kMax;
+  if (name == "KL") return Algorithm::kKL;
+  PADDLE_THROW("Unknown INT8 calibration algorithm %s, only max and KL are "
+               "supported",
+               name);
+  return Algorithm::kMax;
+}
+
+Int8Calibrator::Int8Calibrator(Algorithm algorithm, int num_bins)
+    : algorithm_(algorithm), num_bins_(num_bins) {
+  PADDLE_ENFORCE_GT(num_bins, 0);
+}
+
+void Int8Calibrator::NextPass() {
+  ++pass_;
+  PADDLE_ENFORCE_LT(pass_, num_passes(), "All the passes are finished");
+  for (auto& item : stats_) {
+    item.second.histogram.assign(num_bins_, 0);
+  }
+}
+
+void Int8Calibrator::Observe(const std::string& name, const float* data,
+                             size_t size) {
+  if (pass_ == 0) {
+    auto it = stats_.find(name);
+    if (it == stats_.end()) {
+      it = stats_
+               .emplace(name, Stat{std::numeric_limits<float>::max(), 0.0f,
+                                   std::vector<int64_t>()})
+               .first;
+    }
+    auto& stat = it->second;
+    for (size_t i = 0; i < size; ++i) {
+      stat.min = std::min(stat.min, data[i]);
+      stat.max_abs = std::max(stat.max_abs, std::abs(data[i]));
+    }
+    return;
+  }
+  auto it = stats_.find(name);
+  PADDLE_ENFORCE(it != stats_.end(), "%s is not observed in the first pass",
+                 name);
+  auto& stat = it->second;
+  if (stat.max_abs <= 0.0f) return;
+  float bin_width = stat.max_abs / num_bins_;
+  for (size_t i = 0; i < size; ++i) {
+    int bin = static_cast<int>(std::abs(data[i]) / bin_width);
+    stat.histogram[std::min(bin, num_bins_ - 1)] += 1;
+  }
+}
+
+const Int8Calibrator::Stat& Int8Calibrator::GetStat(
+    const std::string& name) const {
+  auto it = stats_.find(name);
+  PADDLE_ENFORCE(it != stats_.end(), "%s is not observed", name);
+  return it->second;
+}
+
+bool Int8Calibrator::IsUnsigned(const std::string& name) const {
+  return GetStat(name).min >= 0.0f;
+}
+
+float Int8Calibrator::Threshold(const std::string& name) const {
+  auto& stat = GetStat(name);
+  if (algorithm_ == Algorithm::kMax || stat.histogram.empty() ||
+      stat.max_abs <= 0.0f) {
+    return stat.max_abs;
+  }
+  return KLThreshold(stat.histogram, stat.max_abs / num_bins_,
+                     IsUnsigned(name) ? 256 : 128);
+}
+
+float Int8Calibrator::KLThreshold(const std::vector<int64_t>& histogram,
+                                  float bin_width, int num_quantized_bins) {
+  int num_bins = static_cast<int>(histogram.size());
+  if (num_bins <= num_quantized_bins) return num_bins * bin_width;
+
+  // outliers[i] is the number of the values in the bins >= i.
+  std::vector<double> outliers(num_bins + 1, 0);
+  for (int i = num_bins - 1; i >= 0; --i) {
+    outliers[i] = outliers[i + 1] + histogram[i];
+  }
+
+  int best = num_bins;
+  double min_divergence = std::numeric_limits<double>::max();
+  std::vector<double> p;
+  std::vector<double> q;
+  for (int i = num_quantized_bins; i <= num_bins; ++i) {
+    // The reference distribution clips the values >= i to the last bin.
+    p.assign(histogram.begin(), histogram.begin() + i);
+    p[i - 1] += outliers[i];
+
+    // Merge the i bins into num_quantized_bins, and expand each merged bin
+    // back evenly over its non empty bins.
+    q.assign(i, 0);
+    double merge = static_cast<double>(i) / num_quantized_bins;
+    for (int k = 0; k < num_quantized_bins; ++k) {
+      int begin = static_cast<int>(k * merge);
+      int end = k == num_quantized_bins - 1 ? i
+                                            : static_cast<int>((k + 1) * merge);
+      double sum = 0;
+      int non_empty = 0;
+      for (int j = begin; j < end; ++j) {
+        sum += histogram[j];
+        non_empty += histogram[j] > 0;
+      }
+      if (non_empty == 0) continue;
+      for (int j = begin; j < end; ++j) {
+        if (histogram[j] > 0) q[j] = sum / non_empty;
+      }
+    }
+
+    double p_sum = 0;
+    double q_sum = 0;
+    for (int j = 0; j < i; ++j) {
+      p_sum += p[j];
+      q_sum += q[j];
+    }
+    if (p_sum <= 0 || q_sum <= 0) continue;
+    double divergence = 0;
+    for (int j = 0; j < i; ++j) {
+      if (p[j] <= 0) continue;
+      double pj = p[j] / p_sum;
+      double qj = std::max(q[j] / q_sum, 1e-10);
+      divergence += pj * std::log(pj / qj);
+    }
+    if (divergence < min_divergence) {
+      min_divergence = divergence;
+      best = i;
+    }
+  }
+  return std::min(best + 0.5f, static_cast<float>(num_bins)) * bin_width;
+}
+
+std::vector<float> ChannelMaxAbs(const float* data, int64_t channels,
+                                 int64_t channel_size) {
+  std::vector<float> max_abs(channels, 0.0f);
+  for (int64_t c = 0; c < channels; ++c) {
+    const float* channel = data + c * channel_size;
+    for (int64_t i = 0; i < channel_size; ++i) {
+      max_abs[c] = std::max(max_abs[c], std::abs(channel[i]));
+    }
+  }
+  return max_abs;
+}
+
+}  // namespace analysis
+}  // namespace inference
+}  // namespace paddle
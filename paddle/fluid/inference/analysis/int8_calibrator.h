@@ -0,0 +1,90 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace paddle {
+namespace inference {
+namespace analysis {
+
+/*
+ * Collect the ranges of the FP32 variables on the calibration data for the
+ * INT8 quantization after training.
+ *
+ * The max algorithm takes the max absolute value of a variable as the
+ * threshold of its range. The KL algorithm clips the outliers by the
+ * threshold minimizing the KL divergence between the distribution of the
+ * values and that of the quantized values, it needs a second pass over the
+ * calibration data to build the histograms once the max absolute values are
+ * known.
+ */
+class Int8Calibrator {
+ public:
+  enum class Algorithm { kMax, kKL };
+
+  // "max" or "KL".
+  static Algorithm ParseAlgorithm(const std::string& name);
+
+  explicit Int8Calibrator(Algorithm algorithm, int num_bins = 2048);
+
+  // The number of passes over the calibration data.
+  int num_passes() const { return algorithm_ == Algorithm::kKL ? 2 : 1; }
+
+  // Start the next pass over the calibration data.
+  void NextPass();
+
+  // Observe the values of the variable name in the current pass.
+  void Observe(const std::string& name, const float* data, size_t size);
+
+  bool Has(const std::string& name) const { return stats_.count(name) > 0; }
+
+  // Whether the observed values of the variable are never negative.
+  bool IsUnsigned(const std::string& name) const;
+
+  float Threshold(const std::string& name) const;
+
+  // The threshold of the histogram of the absolute values, whose bins are of
+  // bin_width, minimizing the KL divergence when the values are quantized to
+  // num_quantized_bins levels.
+  static float KLThreshold(const std::vector<int64_t>& histogram,
+                           float bin_width, int num_quantized_bins);
+
+ private:
+  struct Stat {
+    float min;
+    float max_abs;
+    std::vector<int64_t> histogram;
+  };
+
+  const Stat& GetStat(const std::string& name) const;
+
+  Algorithm algorithm_;
+  int num_bins_;
+  int pass_{0};
+  std::unordered_map<std::string, Stat> stats_;
+};
+
+// The max absolute values of the channels of the weights, data has channels
+// of channel_size values.
+std::vector<float> ChannelMaxAbs(const float* data, int64_t channels,
+                                 int64_t channel_size);
+
+}  // namespace analysis
+}  // namespace inference
+}  // namespace paddle
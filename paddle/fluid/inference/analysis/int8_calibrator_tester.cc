@@ -0,0 +1,85 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/analysis/int8_calibrator.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+namespace paddle {
+namespace inference {
+namespace analysis {
+
+TEST(Int8Calibrator, max) {
+  Int8Calibrator calibrator(Int8Calibrator::ParseAlgorithm("max"));
+  ASSERT_EQ(calibrator.num_passes(), 1);
+  std::vector<float> a{0.5f, -3.0f, 2.0f};
+  std::vector<float> b{1.0f, 4.0f};
+  calibrator.Observe("a", a.data(), a.size());
+  calibrator.Observe("b", b.data(), b.size());
+  calibrator.Observe("b", a.data(), 1);
+
+  ASSERT_TRUE(calibrator.Has("a"));
+  ASSERT_FALSE(calibrator.Has("c"));
+  EXPECT_FLOAT_EQ(calibrator.Threshold("a"), 3.0f);
+  EXPECT_FALSE(calibrator.IsUnsigned("a"));
+  EXPECT_FLOAT_EQ(calibrator.Threshold("b"), 4.0f);
+  EXPECT_TRUE(calibrator.IsUnsigned("b"));
+}
+
+TEST(Int8Calibrator, KL) {
+  Int8Calibrator calibrator(Int8Calibrator::ParseAlgorithm("KL"));
+  ASSERT_EQ(calibrator.num_passes(), 2);
+  std::mt19937 rng(0);
+  std::normal_distribution<float> normal(0.0f, 1.0f);
+  std::vector<float> data(100000);
+  for (auto& value : data) {
+    value = normal(rng);
+  }
+  // The outliers should be clipped.
+  data[0] = 100.0f;
+  data[1] = -80.0f;
+
+  for (int pass = 0; pass < calibrator.num_passes(); ++pass) {
+    if (pass > 0) calibrator.NextPass();
+    calibrator.Observe("x", data.data(), data.size());
+  }
+  float threshold = calibrator.Threshold("x");
+  EXPECT_GT(threshold, 2.0f);
+  EXPECT_LT(threshold, 10.0f);
+}
+
+TEST(Int8Calibrator, KLThreshold) {
+  // Nothing to clip for the evenly distributed values.
+  std::vector<int64_t> histogram(2048, 10);
+  float threshold = Int8Calibrator::KLThreshold(histogram, 0.01f, 128);
+  EXPECT_GT(threshold, 0.9f * 2048 * 0.01f);
+  EXPECT_LE(threshold, 2048 * 0.01f);
+
+  // The bins are too few to be merged.
+  std::vector<int64_t> small(64, 1);
+  EXPECT_FLOAT_EQ(Int8Calibrator::KLThreshold(small, 0.5f, 128), 32.0f);
+}
+
+TEST(Int8Calibrator, ChannelMaxAbs) {
+  std::vector<float> weights{1.0f, -2.0f, 0.5f, 0.25f, -0.75f, 0.0f};
+  auto max_abs = ChannelMaxAbs(weights.data(), 2, 3);
+  ASSERT_EQ(max_abs.size(), 2UL);
+  EXPECT_FLOAT_EQ(max_abs[0], 2.0f);
+  EXPECT_FLOAT_EQ(max_abs[1], 0.75f);
+}
+
+}  // namespace analysis
+}  // namespace inference
+}  // namespace paddle
@@ -212,6 +212,9 @@ class Function : public Node {
 struct FunctionBlock : public Node {
   std::string repr() const override { return "block-" + std::to_string(id()); }
   std::vector<Node *> subgraph;
+  // The engine running the sub-graph, the type of the engine op is
+  // engine_type + "_engine".
+  std::string engine_type{"tensorrt"};
 
  protected:
   FunctionBlock() { SetType(Node::Type::kFunctionBlock); }
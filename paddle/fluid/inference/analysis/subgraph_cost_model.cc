@@ -0,0 +1,337 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/analysis/subgraph_cost_model.h"
+#include <algorithm>
+#include <map>
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/op_desc.h"
+
+namespace paddle {
+namespace inference {
+namespace analysis {
+
+namespace {
+
+// The default profiles, the numbers of the engines are relative to fluid on
+// the same device, only their ratios matter to the partition.
+std::map<std::string, EngineProfile> &Profiles() {
+  static std::map<std::string, EngineProfile> profiles = {
+      {"fluid", {20000., 10000., 10., 0., 0., false}},
+      {"mkldnn", {80000., 10000., 10., 0., 0., false}},
+      {"tensorrt", {80000., 20000., 2., 30., 5000., true}},
+      {"anakin", {60000., 15000., 2., 20., 5000., true}},
+  };
+  return profiles;
+}
+
+// The operators an engine fuses into the operator producing their input.
+bool IsElementwise(const std::string &type) {
+  static const std::unordered_set<std::string> ops = {
+      "relu",          "sigmoid",         "tanh",  "leaky_relu",
+      "relu6",         "elementwise_add", "scale", "elementwise_mul",
+      "batch_norm",    "dropout",
+  };
+  return ops.count(type) != 0;
+}
+
+double OpCost(const EngineProfile &profile, double flops, double bytes) {
+  return std::max(flops / profile.flops_per_us,
+                  bytes / profile.bytes_per_us) +
+         profile.op_overhead_us;
+}
+
+int64_t Numel(const std::vector<int64_t> &dims) {
+  if (dims.empty()) return 0;
+  int64_t numel = 1;
+  for (auto d : dims) numel *= d;
+  return numel;
+}
+
+bool ParseVar(const Node *value, framework::proto::VarDesc *var) {
+  return !value->pb_msg().empty() && var->ParseFromString(value->pb_msg()) &&
+         var->type().type() == framework::proto::VarType::LOD_TENSOR;
+}
+
+bool IsPersistable(const Node *value) {
+  framework::proto::VarDesc var;
+  return ParseVar(value, &var) && var.persistable();
+}
+
+}  // namespace
+
+SubGraphCostModel::SubGraphCostModel(const std::string &engine_type,
+                                     Argument *argument)
+    : engine_type_(engine_type) {
+  if (argument->Has("max_batch_size")) {
+    batch_size_ = std::max(argument->Get<int>("max_batch_size"), 1);
+  }
+}
+
+void SubGraphCostModel::SetProfile(const std::string &backend,
+                                   const EngineProfile &profile) {
+  Profiles()[backend] = profile;
+}
+
+const EngineProfile &SubGraphCostModel::GetProfile(
+    const std::string &backend) {
+  auto it = Profiles().find(backend);
+  PADDLE_ENFORCE(it != Profiles().end(), "no profile of the backend %s",
+                 backend);
+  return it->second;
+}
+
+std::vector<int64_t> SubGraphCostModel::Dims(const Node *value) const {
+  framework::proto::VarDesc var;
+  std::vector<int64_t> dims;
+  if (!ParseVar(value, &var)) return dims;
+  for (auto d : var.type().lod_tensor().tensor().dims()) {
+    dims.push_back(d < 0 ? batch_size_ : d);
+  }
+  return dims;
+}
+
+int64_t SubGraphCostModel::Bytes(const Node *value) const {
+  framework::proto::VarDesc var;
+  if (!ParseVar(value, &var)) return 0;
+  auto type = var.type().lod_tensor().tensor().data_type();
+  return Numel(Dims(value)) *
+         framework::SizeOfType(framework::ToTypeIndex(type));
+}
+
+void SubGraphCostModel::Estimate(const Node *func, double *flops,
+                                 double *bytes) const {
+  *flops = 0;
+  *bytes = 0;
+  std::unordered_map<std::string, const Node *> values;
+  for (auto *in : func->inlinks) {
+    values[in->name()] = in;
+    *bytes += Bytes(in);
+  }
+  int64_t out_numel = 0;
+  for (auto *out : func->outlinks) {
+    values[out->name()] = out;
+    *bytes += Bytes(out);
+    out_numel += Numel(Dims(out));
+  }
+  // Count an operation per output element if the op is unknown.
+  *flops = out_numel;
+
+  framework::proto::OpDesc proto;
+  if (func->pb_msg().empty() || !proto.ParseFromString(func->pb_msg())) return;
+  framework::OpDesc op(proto, nullptr);
+  auto dims_of = [&](const std::string &slot) {
+    auto names = op.Input(slot);
+    if (names.empty() || !values.count(names[0])) {
+      return std::vector<int64_t>();
+    }
+    return Dims(values[names[0]]);
+  };
+
+  const auto &type = op.Type();
+  if (type == "conv2d" || type == "depthwise_conv2d" ||
+      type == "conv2d_transpose") {
+    auto filter = dims_of("Filter");
+    if (filter.size() != 4UL) return;
+    // The transposed conv multiplies each input element by the filter.
+    int64_t numel =
+        type == "conv2d_transpose" ? Numel(dims_of("Input")) : out_numel;
+    *flops = 2. * numel * filter[1] * filter[2] * filter[3];
+  } else if (type == "mul" || type == "fc") {
+    auto w = dims_of(type == "mul" ? "Y" : "W");
+    if (w.empty() || w.back() == 0) return;
+    *flops = 2. * out_numel * (Numel(w) / w.back());
+  } else if (type == "matmul") {
+    auto x = dims_of("X");
+    if (x.size() < 2UL) return;
+    bool trans_x = boost::get<bool>(op.GetAttr("transpose_X"));
+    *flops = 2. * out_numel * x[x.size() - (trans_x ? 2 : 1)];
+  } else if (type == "pool2d") {
+    auto x = dims_of("X");
+    auto ksize = boost::get<std::vector<int>>(op.GetAttr("ksize"));
+    if (op.HasAttr("global_pooling") &&
+        boost::get<bool>(op.GetAttr("global_pooling")) && x.size() == 4UL) {
+      ksize = {static_cast<int>(x[2]), static_cast<int>(x[3])};
+    }
+    double window = 1;
+    for (auto k : ksize) window *= k;
+    *flops = out_numel * window;
+  }
+}
+
+double SubGraphCostModel::FluidCost(const Node *func) const {
+  double flops, bytes;
+  Estimate(func, &flops, &bytes);
+  std::string backend = "fluid";
+  framework::proto::OpDesc proto;
+  if (!func->pb_msg().empty() && proto.ParseFromString(func->pb_msg())) {
+    framework::OpDesc op(proto, nullptr);
+    if (op.HasAttr("use_mkldnn") &&
+        boost::get<bool>(op.GetAttr("use_mkldnn"))) {
+      backend = "mkldnn";
+    }
+  }
+  return OpCost(GetProfile(backend), flops, bytes);
+}
+
+double SubGraphCostModel::BoundaryBytes(
+    const std::vector<Node *> &subgraph) const {
+  std::unordered_set<const Node *> inside(subgraph.begin(), subgraph.end());
+  std::unordered_set<const Node *> boundary;
+  for (auto *func : subgraph) {
+    for (auto *in : func->inlinks) {
+      bool produced_inside = false;
+      for (auto *producer : in->inlinks) {
+        produced_inside |= inside.count(producer) != 0;
+      }
+      // The parameters are loaded by the engine once.
+      if (!produced_inside && !IsPersistable(in)) boundary.insert(in);
+    }
+    for (auto *out : func->outlinks) {
+      bool used_outside = out->outlinks.empty();
+      for (auto *consumer : out->outlinks) {
+        used_outside |= inside.count(consumer) == 0;
+      }
+      if (used_outside) boundary.insert(out);
+    }
+  }
+  double bytes = 0;
+  for (auto *value : boundary) {
+    bytes += Bytes(value);
+  }
+  return bytes;
+}
+
+double SubGraphCostModel::EngineCost(
+    const std::vector<Node *> &subgraph) const {
+  const auto &profile = GetProfile(engine_type_);
+  std::unordered_set<const Node *> inside(subgraph.begin(), subgraph.end());
+  double cost = profile.launch_us;
+  for (auto *func : subgraph) {
+    const auto &type = static_cast<const Function *>(func)->func_type();
+    if (profile.fuse_elementwise && IsElementwise(type) &&
+        !func->inlinks.empty()) {
+      bool fused = false;
+      for (auto *producer : func->inlinks.front()->inlinks) {
+        fused |= inside.count(producer) != 0;
+      }
+      if (fused) continue;
+    }
+    double flops, bytes;
+    Estimate(func, &flops, &bytes);
+    cost += OpCost(profile, flops, bytes);
+  }
+  if (profile.copy_bytes_per_us > 0) {
+    cost += BoundaryBytes(subgraph) / profile.copy_bytes_per_us;
+  }
+  return cost;
+}
+
+double SubGraphCostModel::Gain(const std::vector<Node *> &subgraph) const {
+  double fluid_cost = 0;
+  for (auto *func : subgraph) {
+    fluid_cost += FluidCost(func);
+  }
+  return fluid_cost - EngineCost(subgraph);
+}
+
+namespace {
+
+// Whether all the inputs or all the outputs of a function are outside the
+// sub-graph, leaving such a function keeps the rest connected.
+bool OnBoundary(const Node *func,
+                const std::unordered_set<const Node *> &inside) {
+  bool source = true;
+  for (auto *in : func->inlinks) {
+    for (auto *producer : in->inlinks) {
+      source &= inside.count(producer) == 0;
+    }
+  }
+  bool sink = true;
+  for (auto *out : func->outlinks) {
+    for (auto *consumer : out->outlinks) {
+      sink &= inside.count(consumer) == 0;
+    }
+  }
+  return source || sink;
+}
+
+}  // namespace
+
+bool SubGraphPartitioner::TrimBoundary(std::vector<Node *> *subgraph) {
+  bool trimmed = false;
+  double gain = cost_model_.Gain(*subgraph);
+  while (subgraph->size() > 1UL) {
+    std::unordered_set<const Node *> inside(subgraph->begin(),
+                                            subgraph->end());
+    int best = -1;
+    double best_gain = gain;
+    for (size_t i = 0; i < subgraph->size(); ++i) {
+      if (!OnBoundary((*subgraph)[i], inside)) continue;
+      std::vector<Node *> rest(*subgraph);
+      rest.erase(rest.begin() + i);
+      double rest_gain = cost_model_.Gain(rest);
+      if (rest_gain > best_gain + 1e-6) {
+        best = i;
+        best_gain = rest_gain;
+      }
+    }
+    if (best < 0) break;
+    VLOG(4) << "leave " << (*subgraph)[best]->repr() << " to fluid, gain "
+            << gain << " -> " << best_gain << "us";
+    excluded_.insert((*subgraph)[best]);
+    subgraph->erase(subgraph->begin() + best);
+    gain = best_gain;
+    trimmed = true;
+  }
+  return trimmed;
+}
+
+SubGraphPartitioner::NodeInsideSubgraphTeller SubGraphPartitioner::
+operator()() {
+  auto teller = [this](const Node *node) {
+    return !excluded_.count(node) && node_inside_subgraph_teller_(node);
+  };
+  // Leaving the nodes to fluid splits the sub-graphs, which are estimated
+  // again until no node is left.
+  const int kMaxIterations = 16;
+  for (int i = 0; i < kMaxIterations; ++i) {
+    bool changed = false;
+    for (auto &subgraph : SubGraphSplitter(graph_, teller)()) {
+      if (subgraph.size() <=
+          static_cast<size_t>(argument_->Get<int>("minimum_subgraph_size"))) {
+        continue;
+      }
+      changed |= TrimBoundary(&subgraph);
+      double gain = cost_model_.Gain(subgraph);
+      if (gain <= 0) {
+        VLOG(3) << "leave a sub-graph of " << subgraph.size()
+                << " operators to fluid, gain " << gain << "us";
+        excluded_.insert(subgraph.begin(), subgraph.end());
+        changed = true;
+      }
+    }
+    if (!changed) break;
+  }
+  auto excluded = excluded_;
+  auto node_inside_subgraph_teller = node_inside_subgraph_teller_;
+  return [excluded, node_inside_subgraph_teller](const Node *node) {
+    return !excluded.count(node) && node_inside_subgraph_teller(node);
+  };
+}
+
+}  // namespace analysis
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,132 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+ * This file defines a cost model to decide which sub-graphs are worth running
+ * in an engine.
+ */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/fluid/inference/analysis/argument.h"
+#include "paddle/fluid/inference/analysis/data_flow_graph.h"
+#include "paddle/fluid/inference/analysis/node.h"
+#include "paddle/fluid/inference/analysis/subgraph_splitter.h"
+
+namespace paddle {
+namespace inference {
+namespace analysis {
+
+/*
+ * The performance of a backend running the operators, "fluid", "mkldnn" (the
+ * fluid operators with use_mkldnn), "tensorrt" or "anakin". The latency of an
+ * operator is max(flops / compute, bytes / bandwidth) + op_overhead_us.
+ */
+struct EngineProfile {
+  // The FLOPs reached by the kernels per microsecond.
+  double flops_per_us;
+  // The bytes read and written by the kernels per microsecond.
+  double bytes_per_us;
+  // The cost to dispatch an operator.
+  double op_overhead_us;
+  // The fixed cost to run an engine op, zero for fluid.
+  double launch_us;
+  // The bytes per microsecond copied to and from the engine's buffers.
+  double copy_bytes_per_us;
+  // Whether the elementwise operators following another operator inside the
+  // engine are fused into it.
+  bool fuse_elementwise;
+};
+
+/*
+ * SubGraphCostModel - Estimate the latency of the operators in fluid and in an
+ * engine from the shapes of their variables, which have the batch size of
+ * "max_batch_size" in the argument.
+ */
+class SubGraphCostModel {
+ public:
+  SubGraphCostModel(const std::string &engine_type, Argument *argument);
+
+  // The estimated latency in microseconds of a function in its fluid kernel.
+  double FluidCost(const Node *func) const;
+
+  // The estimated latency of the functions of a sub-graph in the engine,
+  // including the engine launch and the copies of its inputs and outputs.
+  double EngineCost(const std::vector<Node *> &subgraph) const;
+
+  // The latency saved by running the sub-graph in the engine, negative if the
+  // engine is slower.
+  double Gain(const std::vector<Node *> &subgraph) const;
+
+  // Overwrite the profile of a backend, to tune the model for a device.
+  static void SetProfile(const std::string &backend,
+                         const EngineProfile &profile);
+  static const EngineProfile &GetProfile(const std::string &backend);
+
+ protected:
+  // FLOPs and bytes accessed by a function.
+  void Estimate(const Node *func, double *flops, double *bytes) const;
+  // The bytes of the variables copied in and out of the sub-graph.
+  double BoundaryBytes(const std::vector<Node *> &subgraph) const;
+  // The dims of a value, the unknown dims are replaced with the batch size.
+  std::vector<int64_t> Dims(const Node *value) const;
+  int64_t Bytes(const Node *value) const;
+
+ private:
+  std::string engine_type_;
+  int batch_size_{1};
+};
+
+/*
+ * SubGraphPartitioner - Refine the sub-graphs of the nodes an engine supports
+ * with the cost model. The supported nodes whose sub-graph does not pay off
+ * are left to fluid, and so are the nodes on the boundary of a sub-graph if
+ * leaving them out saves more latency, e.g. a cheap operator with a large
+ * input copied in. It returns the teller of the nodes to put in the engine.
+ */
+class SubGraphPartitioner {
+ public:
+  using NodeInsideSubgraphTeller = SubGraphSplitter::NodeInsideSubgraphTeller;
+
+  SubGraphPartitioner(DataFlowGraph *graph,
+                      const NodeInsideSubgraphTeller &teller,
+                      Argument *argument, const std::string &engine_type)
+      : graph_(graph),
+        node_inside_subgraph_teller_(teller),
+        argument_(argument),
+        cost_model_(engine_type, argument) {}
+
+  NodeInsideSubgraphTeller operator()();
+
+ protected:
+  // Leave the boundary functions of a sub-graph to fluid while it lowers the
+  // latency, returns whether any function is left.
+  bool TrimBoundary(std::vector<Node *> *subgraph);
+
+ private:
+  DataFlowGraph *graph_;
+  NodeInsideSubgraphTeller node_inside_subgraph_teller_;
+  Argument *argument_;
+  SubGraphCostModel cost_model_;
+  std::unordered_set<const Node *> excluded_;
+};
+
+}  // namespace analysis
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,111 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/analysis/subgraph_cost_model.h"
+#include "paddle/fluid/inference/analysis/flags.h"
+#include "paddle/fluid/inference/analysis/ut_helper.h"
+
+namespace paddle {
+namespace inference {
+namespace analysis {
+
+SubGraphSplitter::NodeInsideSubgraphTeller teller = [](const Node* node) {
+  if (node->type() != Node::Type::kFunction) return false;
+  const auto* func = static_cast<const Function*>(node);
+  return func->func_type() == "elementwise_add" ||
+         func->func_type() == "relu" || func->func_type() == "mul" ||
+         func->func_type() == "sigmoid" || func->func_type() == "softmax";
+};
+
+int CountBlocks(const DataFlowGraph& dfg) {
+  int num_blocks = 0;
+  for (auto& node : dfg.nodes.nodes()) {
+    if (!node->deleted() && node->IsFunctionBlock()) ++num_blocks;
+  }
+  return num_blocks;
+}
+
+TEST(SubGraphCostModel, Cost) {
+  auto desc = LoadProgramDesc(FLAGS_inference_model_dir + "/__model__");
+  auto dfg = ProgramDescToDFG(desc);
+  Argument argument;
+  argument.Set<int>("max_batch_size", new int(8));
+  SubGraphCostModel cost_model("tensorrt", &argument);
+
+  std::vector<Node*> subgraph;
+  double fluid_cost = 0;
+  double mul_cost = 0;
+  for (auto& node : dfg.nodes.nodes()) {
+    if (!node->IsFunction()) continue;
+    EXPECT_GT(cost_model.FluidCost(node.get()), 0.);
+    if (teller(node.get())) {
+      subgraph.push_back(node.get());
+      fluid_cost += cost_model.FluidCost(node.get());
+    }
+    if (static_cast<Function*>(node.get())->func_type() == "mul") {
+      mul_cost = std::max(mul_cost, cost_model.FluidCost(node.get()));
+    }
+  }
+  ASSERT_FALSE(subgraph.empty());
+  // The matrix multiplications cost more than the dispatch.
+  EXPECT_GT(mul_cost, SubGraphCostModel::GetProfile("fluid").op_overhead_us);
+  EXPECT_GT(cost_model.EngineCost(subgraph),
+            SubGraphCostModel::GetProfile("tensorrt").launch_us);
+  EXPECT_NEAR(cost_model.Gain(subgraph),
+              fluid_cost - cost_model.EngineCost(subgraph), 1e-6);
+}
+
+TEST(SubGraphPartitioner, Fuse) {
+  FLAGS_IA_enable_subgraph_cost_model = true;
+  auto profile = SubGraphCostModel::GetProfile("tensorrt");
+  Argument argument;
+  argument.Set<int>("minimum_subgraph_size", new int(0));
+  argument.Set<int>("max_batch_size", new int(1));
+
+  // The engine is too slow to launch for any sub-graph.
+  {
+    auto slow = profile;
+    slow.launch_us = 1e9;
+    SubGraphCostModel::SetProfile("tensorrt", slow);
+    auto desc = LoadProgramDesc(FLAGS_inference_model_dir + "/__model__");
+    auto dfg = ProgramDescToDFG(desc);
+    SubGraphFuse(&dfg, teller, &argument)();
+    EXPECT_EQ(CountBlocks(dfg), 0);
+  }
+
+  // A free engine fuses the same sub-graphs as the greedy split.
+  {
+    auto fast = profile;
+    fast.launch_us = 0;
+    fast.copy_bytes_per_us = 1e30;
+    fast.op_overhead_us = 0;
+    SubGraphCostModel::SetProfile("tensorrt", fast);
+    auto desc = LoadProgramDesc(FLAGS_inference_model_dir + "/__model__");
+    auto dfg = ProgramDescToDFG(desc);
+    SubGraphFuse(&dfg, teller, &argument)();
+
+    FLAGS_IA_enable_subgraph_cost_model = false;
+    auto greedy_dfg = ProgramDescToDFG(desc);
+    SubGraphFuse(&greedy_dfg, teller, &argument)();
+    EXPECT_GT(CountBlocks(greedy_dfg), 0);
+    EXPECT_EQ(CountBlocks(dfg), CountBlocks(greedy_dfg));
+  }
+
+  SubGraphCostModel::SetProfile("tensorrt", profile);
+  FLAGS_IA_enable_subgraph_cost_model = false;
+}
+
+}  // namespace analysis
+}  // namespace inference
+}  // namespace paddle
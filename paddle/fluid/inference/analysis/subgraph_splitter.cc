@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/inference/analysis/subgraph_splitter.h"
+#include "paddle/fluid/inference/analysis/flags.h"
+#include "paddle/fluid/inference/analysis/subgraph_cost_model.h"
 
 namespace paddle {
 namespace inference {
@@ -34,6 +36,10 @@ inline void MarkOutLinksInSubGraph(const Function *func) {
 }
 
 void SubGraphSplitter::MarkNodesInsideSubGraph() {
+  // Clear the marks of the former splits, which may use other tellers.
+  for (auto &node : GraphTraits<DataFlowGraph>(*graph_).nodes()) {
+    node.attr(kMarkerAttrName).Bool() = false;
+  }
   for (auto &node : GraphTraits<DataFlowGraph>(*graph_).nodes()) {
     if (node_inside_subgraph_teller_(&node)) {
       node.attr(kMarkerAttrName).Bool() = true;
@@ -307,7 +313,11 @@ std::vector<std::vector<Node *>> SubGraphSplitter::ExtractSubGraphs() {
 void SubGraphFuse::operator()() { ReplaceNodesWithSubGraphs(); }
 
 void SubGraphFuse::ReplaceNodesWithSubGraphs() {
-  auto subgraphs = SubGraphSplitter(graph_, node_inside_subgraph_teller_)();
+  auto teller = node_inside_subgraph_teller_;
+  if (FLAGS_IA_enable_subgraph_cost_model) {
+    teller = SubGraphPartitioner(graph_, teller, argument_, engine_type_)();
+  }
+  auto subgraphs = SubGraphSplitter(graph_, teller)();
   for (auto &subgraph : subgraphs) {
     if (subgraph.size() <= argument_->Get<int>("minimum_subgraph_size"))
       continue;
@@ -317,6 +327,7 @@ void SubGraphFuse::ReplaceNodesWithSubGraphs() {
     // as deleted. 3. Replace the deleted node with the new Block Node.
     auto *block_node = static_cast<FunctionBlock *>(
         graph_->nodes.Create(Node::Type::kFunctionBlock));
+    block_node->engine_type = engine_type_;
     auto io = ExtractInputAndOutputOfSubGraph(subgraph);
     block_node->inlinks = std::move(io.first);
     block_node->outlinks = std::move(io.second);
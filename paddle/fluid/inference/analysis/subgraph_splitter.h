@@ -18,6 +18,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include "paddle/fluid/inference/analysis/argument.h"
@@ -65,10 +66,12 @@ class SubGraphFuse {
   using NodeInsideSubgraphTeller = SubGraphSplitter::NodeInsideSubgraphTeller;
 
   SubGraphFuse(DataFlowGraph *graph, const NodeInsideSubgraphTeller &teller,
-               Argument *argument)
+               Argument *argument,
+               const std::string &engine_type = "tensorrt")
       : graph_(graph),
         node_inside_subgraph_teller_(teller),
-        argument_(argument) {}
+        argument_(argument),
+        engine_type_(engine_type) {}
 
   // The main method which run all the logic.
   void operator()();
@@ -81,6 +84,7 @@ class SubGraphFuse {
   DataFlowGraph *graph_;
   NodeInsideSubgraphTeller node_inside_subgraph_teller_;
   Argument *argument_;
+  std::string engine_type_;
 };
 
 }  // namespace analysis
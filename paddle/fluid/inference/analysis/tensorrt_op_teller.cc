@@ -0,0 +1,136 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/analysis/tensorrt_op_teller.h"
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/op_desc.h"
+
+namespace paddle {
+namespace inference {
+namespace analysis {
+
+namespace {
+
+// The operators converted without conditions.
+const std::unordered_set<std::string> kSupportedOps = {
+    "mul",     "conv2d",     "pool2d",          "relu",   "softmax",
+    "sigmoid", "tanh",       "depthwise_conv2d", "concat", "batch_norm",
+    "pad",     "dropout",    "elementwise_add"};
+
+bool SetReason(std::string *reason, const std::string &msg) {
+  if (reason) *reason = msg;
+  return false;
+}
+
+// The VarDesc of the input called name, false if it is unknown.
+bool GetInputVar(const Node *node, const std::string &name,
+                 framework::proto::VarDesc *var) {
+  for (auto *in : node->inlinks) {
+    if (in->name() == name && !in->pb_msg().empty()) {
+      return var->ParseFromString(in->pb_msg());
+    }
+  }
+  return false;
+}
+
+int InputRank(const Node *node, const std::string &name) {
+  framework::proto::VarDesc var;
+  if (!GetInputVar(node, name, &var) ||
+      var.type().type() != framework::proto::VarType::LOD_TENSOR) {
+    return -1;
+  }
+  return var.type().lod_tensor().tensor().dims_size();
+}
+
+bool IsParameter(const Node *node, const std::string &name) {
+  framework::proto::VarDesc var;
+  return GetInputVar(node, name, &var) && var.persistable();
+}
+
+bool TellOp(const Node *node, const framework::OpDesc &op,
+            std::string *reason) {
+  const auto &type = op.Type();
+  if (type == "transpose" || type == "transpose2") {
+    auto axis = boost::get<std::vector<int>>(op.GetAttr("axis"));
+    if (axis.empty() || axis[0] != 0) {
+      return SetReason(reason, "the batch dim is transposed");
+    }
+    return true;
+  }
+  if (type == "reshape" || type == "reshape2") {
+    if (op.Inputs().count("Shape") && !op.Input("Shape").empty()) {
+      return SetReason(reason, "the shape is set by the Shape input");
+    }
+    auto shape = boost::get<std::vector<int>>(op.GetAttr("shape"));
+    if (shape.empty() || (shape[0] != 0 && shape[0] != -1)) {
+      return SetReason(reason, "the batch dim is reshaped");
+    }
+    return true;
+  }
+  if (type == "leaky_relu") {
+    float alpha = boost::get<float>(op.GetAttr("alpha"));
+    if (alpha < 0.f || alpha > 1.f) {
+      return SetReason(reason, "alpha is out of [0, 1]");
+    }
+    return true;
+  }
+  if (type == "prelu") {
+    auto mode = boost::get<std::string>(op.GetAttr("mode"));
+    if (mode != "all" && mode != "channel") {
+      return SetReason(reason, "the mode " + mode + " is not supported");
+    }
+    if (!IsParameter(node, op.Input("Alpha")[0])) {
+      return SetReason(reason, "Alpha is not a parameter");
+    }
+    return true;
+  }
+  if (type == "matmul") {
+    // The matrices are the last two dims, the batch dim is implicit.
+    for (auto &slot : {"X", "Y"}) {
+      auto &name = op.Input(slot)[0];
+      if (IsParameter(node, name)) {
+        return SetReason(reason, std::string(slot) + " is a parameter");
+      }
+      int rank = InputRank(node, name);
+      if (rank < 0) {
+        return SetReason(reason, std::string(slot) + " has unknown shape");
+      }
+      if (rank < 3) {
+        return SetReason(reason, std::string(slot) + " has less than 3 dims");
+      }
+    }
+    return true;
+  }
+  return SetReason(reason, "no converter");
+}
+
+}  // namespace
+
+bool TensorRTCanConvert(const Node *node, std::string *reason) {
+  if (!node->IsFunction()) return SetReason(reason, "not an operator");
+  auto *func = static_cast<const Function *>(node);
+  if (kSupportedOps.count(func->func_type())) return true;
+  framework::proto::OpDesc proto;
+  if (node->pb_msg().empty() || !proto.ParseFromString(node->pb_msg())) {
+    return SetReason(reason, "the desc of the operator is unknown");
+  }
+  framework::OpDesc op(proto, nullptr);
+  return TellOp(node, op, reason);
+}
+
+}  // namespace analysis
+}  // namespace inference
+}  // namespace paddle
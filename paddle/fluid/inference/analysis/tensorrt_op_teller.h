@@ -0,0 +1,37 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include "paddle/fluid/inference/analysis/node.h"
+
+namespace paddle {
+namespace inference {
+namespace analysis {
+
+/*
+ * Tell whether a Function node can be converted to a TensorRT layer by the
+ * converters in inference/tensorrt/convert.
+ *
+ * Some operators are only supported with some attributes, for example the
+ * reshape keeping the batch dim, so the attributes and the shapes of the
+ * inputs are checked too. If the node can not be converted, the reason is
+ * set to reason if it is not null.
+ */
+bool TensorRTCanConvert(const Node *node, std::string *reason = nullptr);
+
+}  // namespace analysis
+}  // namespace inference
+}  // namespace paddle
@@ -13,7 +13,10 @@
 // limitations under the License.
 
 #include "paddle/fluid/inference/analysis/tensorrt_subgraph_pass.h"
+#include <map>
+#include <utility>
 #include "paddle/fluid/inference/analysis/subgraph_splitter.h"
+#include "paddle/fluid/inference/analysis/tensorrt_op_teller.h"
 
 namespace paddle {
 namespace inference {
@@ -25,11 +28,50 @@ TensorRTSubGraphPass::TensorRTSubGraphPass(
 
 void TensorRTSubGraphPass::Run(DataFlowGraph *graph) {
   SubGraphFuse(graph, node_inside_subgraph_teller_, argument_)();
+  ReportFallback(graph);
   VLOG(4) << "debug info "
           << graph->HumanReadableInfo(false /*show_values*/,
                                       true /*show_functions*/);
 }
 
+void TensorRTSubGraphPass::ReportFallback(DataFlowGraph *graph) {
+  // type -> (count, reason) of the operators blocking the subgraphs.
+  std::map<std::string, std::pair<int, std::string>> blockers;
+  int num_engines = 0;
+  int num_converted = 0;
+  int num_left = 0;
+  for (auto &node : graph->nodes.nodes()) {
+    if (node->deleted()) continue;
+    if (node->IsFunctionBlock()) {
+      ++num_engines;
+      auto *block = static_cast<FunctionBlock *>(node.get());
+      num_converted += block->subgraph.size();
+      continue;
+    }
+    if (!node->IsFunction()) continue;
+    if (node_inside_subgraph_teller_(node.get())) {
+      // supported, but in a subgraph less than minimum_subgraph_size
+      ++num_left;
+      continue;
+    }
+    auto &type = static_cast<Function *>(node.get())->func_type();
+    auto &blocker = blockers[type];
+    ++blocker.first;
+    if (blocker.second.empty()) {
+      TensorRTCanConvert(node.get(), &blocker.second);
+    }
+  }
+
+  LOG(INFO) << "TensorRT subgraph: " << num_engines << " engines of "
+            << num_converted << " operators, " << num_left
+            << " supported operators left in the subgraphs less than "
+            << argument_->Get<int>("minimum_subgraph_size") << " operators";
+  for (auto &blocker : blockers) {
+    LOG(INFO) << "TensorRT fallback to fluid: " << blocker.first << " x "
+              << blocker.second.first << ", " << blocker.second.second;
+  }
+}
+
 }  // namespace analysis
 }  // namespace inference
 
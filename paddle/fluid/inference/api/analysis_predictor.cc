@@ -13,19 +13,31 @@
 // limitations under the License.
 
 #include "paddle/fluid/inference/api/analysis_predictor.h"
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <future>  // NOLINT
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT
+#include <unordered_set>
 #include <vector>
 #include "paddle/fluid/framework/feed_fetch_method.h"
+#include "paddle/fluid/framework/ir/cpu_quantize_pass.h"
 #include "paddle/fluid/framework/ir/fuse_pass_base.h"
 #include "paddle/fluid/framework/ir/pass.h"
 #include "paddle/fluid/framework/naive_executor.h"
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/inference/analysis/int8_calibrator.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/api/paddle_inference_pass.h"
+#include "paddle/fluid/inference/io.h"
 #include "paddle/fluid/inference/utils/singleton.h"
 #include "paddle/fluid/platform/cpu_helper.h"
+#include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/platform/profiler.h"
 
 DECLARE_bool(profile);
@@ -51,6 +63,9 @@ bool AnalysisPredictor::Init(
 
   // no matter with or without MKLDNN
   paddle::platform::SetNumThreads(FLAGS_paddle_num_threads);
+  // Load the parameters into the memory of the node.
+  numa_node_ = config_.numa_node;
+  BindNumaNode();
 
   if (config_.use_gpu) {
     place_ = paddle::platform::CUDAPlace(config_.device);
@@ -71,8 +86,12 @@ bool AnalysisPredictor::Init(
   executor_.reset(new paddle::framework::NaiveExecutor(place_));
 
   if (!program) {
-    if (!LoadProgramDesc()) return false;
-    OptimizeInferenceProgram();
+    std::string cache_dir = OptimCacheDir();
+    if (cache_dir.empty() || !LoadOptimCache(cache_dir)) {
+      if (!LoadProgramDesc()) return false;
+      OptimizeInferenceProgram();
+      if (!cache_dir.empty()) SaveOptimCache(cache_dir);
+    }
   } else {
     inference_program_ = program;
   }
@@ -83,13 +102,174 @@ bool AnalysisPredictor::Init(
   // Get the feed_target_names and fetch_target_names
   PrepareFeedFetch();
 
+  if (config_.enable_int8) {
+#ifdef PADDLE_WITH_MKLDNN
+    if (config_.use_gpu || !config_._use_mkldnn) {
+      LOG(ERROR) << "INT8 quantization only supports CPU with MKLDNN";
+      return false;
+    }
+    if (!QuantizeINT8()) return false;
+#else
+    LOG(ERROR) << "INT8 quantization requires Paddle built with MKLDNN";
+    return false;
+#endif
+  }
+  // The layout is converted first, so the FP16 pass sees the transposes.
+  if (config_.enable_nhwc) {
+    if (!config_.use_gpu) {
+      LOG(ERROR) << "NHWC inference only supports GPU";
+      return false;
+    }
+    if (!ConvertProgram("conv_nhwc_layout_pass")) return false;
+  }
+  if (config_.enable_fp16) {
+    if (!config_.use_gpu) {
+      LOG(ERROR) << "FP16 inference only supports GPU";
+      return false;
+    }
+    if (!ConvertProgram("fp16_convert_pass")) return false;
+  }
+  if (config_.enable_bf16) {
+    if (config_.use_gpu) {
+      LOG(ERROR) << "BF16 inference only supports CPU";
+      return false;
+    }
+    if (!ConvertProgram("bf16_convert_pass")) return false;
+  }
+  if (!config_.embedding_table_format.empty()) {
+    if (config_.use_gpu) {
+      LOG(ERROR) << "The quantized embedding tables only support CPU";
+      return false;
+    }
+    if (!ConvertProgram("embedding_quantize_pass",
+                        [&](framework::ir::Pass *pass) {
+                          pass->Set("table_format",
+                                    new std::string(
+                                        config_.embedding_table_format));
+                        })) {
+      return false;
+    }
+  }
+  if (config_.enable_block_sparse_weights) {
+    if (config_.use_gpu) {
+      LOG(ERROR) << "The block-sparse weights only support CPU";
+      return false;
+    }
+    if (!ConvertProgram("block_sparse_weight_pass")) return false;
+  }
+
+  return StartWarmup();
+}
+
+bool AnalysisPredictor::InitShared(const AnalysisPredictor &other) {
+  VLOG(3) << "Predictor::init_shared()";
+  place_ = other.place_;
+  scope_ = other.scope_;
+  inference_program_ = other.inference_program_;
+  executor_.reset(new paddle::framework::NaiveExecutor(place_));
+  executor_->PrepareShared(scope_.get(), *inference_program_, 0,
+                           *other.executor_);
+  // The feed and fetch holders live in the scope of the executor, which is
+  // deleted with the predictor.
+  sub_scope_ = executor_->scope();
+  shared_params_ = other.shared_params_;
+
+  numa_node_ = config_.numa_node;
+  if (numa_node_ >= 0 && numa_node_ != other.numa_node_ &&
+      config_.replicate_params_per_numa_node) {
+    framework::RWLockGuard guard(&shared_params_->lock,
+                                 framework::RWLockGuard::Status::kRDLock);
+    ReplicateParams();
+  }
+
+  PrepareFeedFetch();
+  return StartWarmup();
+}
+
+void AnalysisPredictor::ReplicateParams() {
+  replicas_version_ = shared_params_->version;
+  // Allocate the replicas from the node in a thread bound to it, the calling
+  // thread stays where it is.
+  std::thread replicate([this] {
+    platform::BindCurrentThreadToNumaNode(numa_node_);
+    executor_->ReplicatePersistables(*inference_program_, 0);
+  });
+  replicate.join();
+}
+
+void AnalysisPredictor::UpdateReplicas() {
+  if (replicas_version_ >= 0 && replicas_version_ != shared_params_->version) {
+    ReplicateParams();
+  }
+}
+
+void AnalysisPredictor::BindNumaNode() {
+  if (numa_node_ >= 0 && platform::CurrentNumaNode() != numa_node_) {
+    if (!platform::BindCurrentThreadToNumaNode(numa_node_)) {
+      LOG(WARNING) << "Fail to bind the predictor to the NUMA node "
+                   << numa_node_;
+    }
+  }
+}
+
+bool AnalysisPredictor::StartWarmup() {
+  if (config_.warmup_data.empty()) return true;
+  if (!config_.warmup_in_background) {
+    return RunWarmup(config_.warmup_data);
+  }
+  ready_ = false;
+  warmup_ = std::async(std::launch::async, [this] {
+    bool succeeded = RunWarmup(config_.warmup_data);
+    ready_ = true;
+    return succeeded;
+  });
+  return true;
+}
+
+bool AnalysisPredictor::RunWarmup(
+    const std::vector<std::vector<PaddleTensor>> &inputs) {
+  inference::Timer timer;
+  timer.tic();
+  for (auto &batch : inputs) {
+    framework::RWLockGuard guard(&shared_params_->lock,
+                                 framework::RWLockGuard::Status::kRDLock);
+    if (!RunBatch(batch)) {
+      LOG(ERROR) << "fail to warm up the predictor";
+      return false;
+    }
+  }
+  VLOG(3) << "warm up " << inputs.size() << " batches in " << timer.toc()
+          << "ms";
   return true;
 }
 
+void AnalysisPredictor::WaitForWarmup() {
+  if (warmup_.valid() && !warmup_.get()) {
+    LOG(WARNING) << "the warm-up in the background failed, the first runs "
+                    "may be slow";
+  }
+}
+
+bool AnalysisPredictor::Warmup(
+    const std::vector<std::vector<PaddleTensor>> &inputs) {
+  WaitForWarmup();
+  return RunWarmup(inputs);
+}
+
 bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
                             std::vector<PaddleTensor> *output_data,
                             int batch_size) {
+  WaitForWarmup();
+  framework::RWLockGuard guard(&shared_params_->lock,
+                               framework::RWLockGuard::Status::kRDLock);
+  UpdateReplicas();
+  return RunFeedFetch(inputs, output_data);
+}
+
+bool AnalysisPredictor::RunFeedFetch(const std::vector<PaddleTensor> &inputs,
+                                     std::vector<PaddleTensor> *output_data) {
   VLOG(3) << "Predictor::predict";
+  BindNumaNode();
   inference::Timer timer;
   timer.tic();
   // set feed variable
@@ -210,6 +390,7 @@ void AnalysisPredictor::OptimizeInferenceProgram() {
   LOG(INFO) << "optimize begin";
   FLAGS_IA_enable_ir = config_.enable_ir_optim;
   FLAGS_IA_enable_tensorrt_subgraph_engine = false;
+  FLAGS_IA_enable_anakin_subgraph_engine = false;
   FLAGS_IA_output_storage_path = "";  // Don't output the model.
   // Analyze inference_program
   if (!config_.model_dir.empty()) {
@@ -305,8 +486,25 @@ void AnalysisPredictor::PrepareFeedFetch() {
   }
 }
 
+std::vector<std::string> AnalysisPredictor::GetInputNames() const {
+  std::vector<std::string> names;
+  for (auto *op : feeds_) {
+    names.push_back(op->Output("Out")[0]);
+  }
+  return names;
+}
+
+std::vector<std::string> AnalysisPredictor::GetOutputNames() const {
+  std::vector<std::string> names;
+  for (auto *op : fetchs_) {
+    names.push_back(op->Input("X")[0]);
+  }
+  return names;
+}
+
 std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetInputTensor(
     const std::string &name) {
+  WaitForWarmup();
   PADDLE_ENFORCE(executor_->scope()->FindVar(name), "no name called %s", name);
   std::unique_ptr<ZeroCopyTensor> res(
       new ZeroCopyTensor(static_cast<void *>(executor_->scope())));
@@ -317,6 +515,7 @@ std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetInputTensor(
 
 std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetOutputTensor(
     const std::string &name) {
+  WaitForWarmup();
   PADDLE_ENFORCE(executor_->scope()->FindVar(name), "no name called %s", name);
   std::unique_ptr<ZeroCopyTensor> res(
       new ZeroCopyTensor(static_cast<void *>(executor_->scope())));
@@ -326,6 +525,15 @@ std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetOutputTensor(
 }
 
 bool AnalysisPredictor::ZeroCopyRun() {
+  WaitForWarmup();
+  framework::RWLockGuard guard(&shared_params_->lock,
+                               framework::RWLockGuard::Status::kRDLock);
+  UpdateReplicas();
+  return RunZeroCopy();
+}
+
+bool AnalysisPredictor::RunZeroCopy() {
+  BindNumaNode();
   executor_->Run();
   // Fix TensorArray reuse not cleaned bug.
   tensor_array_batch_cleaner_.CollectTensorArrays(scope_.get());
@@ -333,6 +541,159 @@ bool AnalysisPredictor::ZeroCopyRun() {
   return true;
 }
 
+bool AnalysisPredictor::RunBatch(const std::vector<PaddleTensor> &inputs) {
+  if (config_.use_feed_fetch_ops) {
+    std::vector<PaddleTensor> outputs;
+    return RunFeedFetch(inputs, &outputs);
+  }
+  for (auto &input : inputs) {
+    auto *var = executor_->scope()->FindVar(input.name);
+    if (var == nullptr) {
+      LOG(ERROR) << "no input called " << input.name;
+      return false;
+    }
+    auto *tensor = var->GetMutable<framework::LoDTensor>();
+    framework::DDim ddim = framework::make_ddim(input.shape);
+    void *input_ptr;
+    if (input.dtype == PaddleDType::INT64) {
+      input_ptr = tensor->mutable_data<int64_t>(ddim, platform::CPUPlace());
+    } else if (input.dtype == PaddleDType::FLOAT32) {
+      input_ptr = tensor->mutable_data<float>(ddim, platform::CPUPlace());
+    } else {
+      LOG(ERROR) << "unsupported feed type " << input.dtype;
+      return false;
+    }
+    std::memcpy(input_ptr, input.data.data(), input.data.length());
+    framework::LoD lod;
+    for (auto &level : input.lod) {
+      lod.emplace_back(level);
+    }
+    tensor->set_lod(lod);
+  }
+  return RunZeroCopy();
+}
+
+bool AnalysisPredictor::QuantizeINT8() {
+  using inference::analysis::Int8Calibrator;
+  LOG(INFO) << "INT8 calibration begin";
+  if (config_.int8_calibration_data.empty()) {
+    LOG(ERROR) << "no calibration data for INT8 quantization";
+    return false;
+  }
+  if (config_.int8_scale_algo != "max" && config_.int8_scale_algo != "KL") {
+    LOG(ERROR) << "unknown INT8 scale algorithm " << config_.int8_scale_algo;
+    return false;
+  }
+
+  // The variables of the operators cpu_quantize_pass may quantize.
+  std::unordered_set<std::string> activations;
+  std::unordered_set<std::string> weights;
+  for (auto *op : inference_program_->Block(0).AllOps()) {
+    if (op->Type() == "conv2d") {
+      for (auto &name : op->Input("Input")) activations.insert(name);
+      for (auto &name : op->Output("Output")) activations.insert(name);
+      for (auto &name : op->Input("Filter")) weights.insert(name);
+    } else if (op->Type() == "pool2d") {
+      for (auto &name : op->Input("X")) activations.insert(name);
+      for (auto &name : op->Output("Out")) activations.insert(name);
+    }
+  }
+
+  Int8Calibrator calibrator(
+      Int8Calibrator::ParseAlgorithm(config_.int8_scale_algo));
+  auto *scope = executor_->scope();
+  for (int pass = 0; pass < calibrator.num_passes(); ++pass) {
+    if (pass > 0) calibrator.NextPass();
+    for (auto &batch : config_.int8_calibration_data) {
+      if (!RunBatch(batch)) {
+        LOG(ERROR) << "fail to run the calibration data";
+        return false;
+      }
+      for (auto &name : activations) {
+        auto *var = scope->FindVar(name);
+        if (var == nullptr || !var->IsType<framework::LoDTensor>()) continue;
+        auto &tensor = var->Get<framework::LoDTensor>();
+        if (!tensor.IsInitialized() || tensor.type() != typeid(float)) {
+          continue;
+        }
+        // The blocked MKLDNN formats pad the channels with zeros, observe
+        // the whole buffer not to miss the values behind the padding.
+        size_t size = tensor.layout() == framework::DataLayout::kMKLDNN
+                          ? tensor.memory_size() / sizeof(float)
+                          : static_cast<size_t>(tensor.numel());
+        calibrator.Observe(name, tensor.data<float>(), size);
+      }
+    }
+  }
+
+  framework::ir::VarQuantRange ranges;
+  for (auto &name : activations) {
+    if (!calibrator.Has(name)) continue;
+    auto &range = ranges[name];
+    range.is_unsigned = calibrator.IsUnsigned(name);
+    range.thresholds = {calibrator.Threshold(name)};
+  }
+  for (auto &name : weights) {
+    auto *var = scope->FindVar(name);
+    if (var == nullptr || !var->IsType<framework::LoDTensor>()) continue;
+    auto &tensor = var->Get<framework::LoDTensor>();
+    if (tensor.type() != typeid(float) || tensor.dims().size() != 4) continue;
+    int64_t channels = tensor.dims()[0];
+    ranges[name].thresholds = inference::analysis::ChannelMaxAbs(
+        tensor.data<float>(), channels, tensor.numel() / channels);
+  }
+
+  std::unique_ptr<framework::ir::Graph> graph(
+      new framework::ir::Graph(*inference_program_));
+  auto quantize_pass =
+      framework::ir::PassRegistry::Instance().Get("cpu_quantize_pass");
+  quantize_pass->Set(framework::ir::kQuantRangesAttr,
+                     new framework::ir::VarQuantRange(std::move(ranges)));
+  graph = quantize_pass->Apply(std::move(graph));
+  auto program = std::make_shared<framework::ProgramDesc>(*inference_program_);
+  auto to_program_pass =
+      framework::ir::PassRegistry::Instance().Get("graph_to_program_pass");
+  to_program_pass->SetNotOwned("program", program.get());
+  graph = to_program_pass->Apply(std::move(graph));
+  inference_program_ = program;
+  PrepareExecutor();
+  LOG(INFO) << "== INT8 quantization end ==";
+  return true;
+}
+
+bool AnalysisPredictor::ConvertProgram(
+    const std::string &pass_name,
+    const std::function<void(framework::ir::Pass *)> &set_attrs) {
+  std::unique_ptr<framework::ir::Graph> graph(
+      new framework::ir::Graph(*inference_program_));
+  graph->Set(framework::ir::kParamScopeAttr,
+             new framework::Scope *(scope_.get()));
+  auto convert_pass = framework::ir::PassRegistry::Instance().Get(pass_name);
+  if (set_attrs) set_attrs(convert_pass.get());
+  graph = convert_pass->Apply(std::move(graph));
+  auto program = std::make_shared<framework::ProgramDesc>(*inference_program_);
+  auto to_program_pass =
+      framework::ir::PassRegistry::Instance().Get("graph_to_program_pass");
+  to_program_pass->SetNotOwned("program", program.get());
+  graph = to_program_pass->Apply(std::move(graph));
+  inference_program_ = program;
+  PrepareExecutor();
+  return true;
+}
+
+void AnalysisPredictor::PrepareExecutor() {
+  // The temporary variables of the old program are dropped with the scope of
+  // the executor.
+  scope_->DeleteScope(executor_->scope());
+  executor_.reset(new paddle::framework::NaiveExecutor(place_));
+  executor_->Prepare(scope_.get(), *inference_program_, 0,
+                     config_.use_feed_fetch_ops);
+  feeds_.clear();
+  feed_names_.clear();
+  fetchs_.clear();
+  PrepareFeedFetch();
+}
+
 bool AnalysisPredictor::LoadProgramDesc() {
   // Initialize the inference program
   std::unique_ptr<framework::Executor> tmp_exe(
@@ -359,7 +720,220 @@ bool AnalysisPredictor::LoadProgramDesc() {
   return true;
 }
 
+namespace {
+
+bool ReadFile(const std::string &path, std::string *data) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return false;
+  data->assign(std::istreambuf_iterator<char>(file),
+               std::istreambuf_iterator<char>());
+  return !file.bad();
+}
+
+// The size and the modification time of a file, to tell whether it changed
+// without reading it.
+std::string FileStamp(const std::string &path) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) return "none";
+  return std::to_string(st.st_size) + "_" + std::to_string(st.st_mtime);
+}
+
+bool IsPersistable(const framework::VarDesc &var) {
+  return var.Persistable() &&
+         var.GetType() != framework::proto::VarType::FEED_MINIBATCH &&
+         var.GetType() != framework::proto::VarType::FETCH_LIST;
+}
+
+}  // namespace
+
+std::string AnalysisPredictor::OptimCacheDir() {
+  if (config_.opt_cache_dir.empty() || !config_.enable_ir_optim) return "";
+  std::string prog_file = config_.model_dir.empty()
+                              ? config_.prog_file
+                              : config_.model_dir + "/__model__";
+  std::string key;
+  if (!ReadFile(prog_file, &key)) return "";
+  if (config_.model_dir.empty()) {
+    key += FileStamp(config_.param_file);
+  } else {
+    // The parameters are saved in separate files named by the variables.
+    framework::ProgramDesc origin(key);
+    for (auto *var : origin.Block(0).AllVars()) {
+      if (IsPersistable(*var)) {
+        key += var->Name() + FileStamp(config_.model_dir + "/" + var->Name());
+      }
+    }
+  }
+  key += "_ir_mode" + std::to_string(static_cast<int>(config_.ir_mode));
+  for (auto &pass : config_.ir_passes) {
+    key += "_" + pass;
+  }
+  key += config_._use_mkldnn ? "_mkldnn" : "";
+  return config_.opt_cache_dir + "/optim_" +
+         std::to_string(std::hash<std::string>()(key));
+}
+
+bool AnalysisPredictor::LoadOptimCache(const std::string &dir) {
+  std::string model_file = dir + "/__model__";
+  if (access(model_file.c_str(), R_OK) != 0) return false;
+  try {
+    platform::CPUPlace place;
+    framework::Executor exe(place);
+    inference_program_ =
+        inference::Load(&exe, scope_.get(), model_file, dir + "/param");
+  } catch (const std::exception &e) {
+    // A broken cache is rebuilt.
+    LOG(WARNING) << "fail to load the optimized program from " << dir << ": "
+                 << e.what();
+    return false;
+  }
+  LOG(INFO) << "load the optimized program from " << dir;
+  return true;
+}
+
+void AnalysisPredictor::SaveOptimCache(const std::string &dir) {
+  // The cached program only keeps the persistables having parameters, the
+  // others are removed by the fuse passes.
+  framework::ProgramDesc program(*inference_program_);
+  std::vector<std::string> params;
+  for (auto *var : program.Block(0).AllVars()) {
+    if (!IsPersistable(*var)) continue;
+    auto *param = scope_->FindVar(var->Name());
+    if (param && param->IsType<framework::LoDTensor>() &&
+        param->Get<framework::LoDTensor>().IsInitialized()) {
+      params.push_back(var->Name());
+    } else {
+      var->SetPersistable(false);
+    }
+  }
+  // The same order as load_combine in inference::Load.
+  std::sort(params.begin(), params.end());
+
+  // Write to a temporary directory first, so that the processes sharing the
+  // cache never read a partial one.
+  mkdir(config_.opt_cache_dir.c_str(), 0755);
+  std::string tmp_dir = dir + ".tmp" + std::to_string(getpid());
+  if (mkdir(tmp_dir.c_str(), 0755) != 0) {
+    LOG(WARNING) << "fail to create the optimized program cache " << tmp_dir;
+    return;
+  }
+  auto remove_tmp = [&] {
+    remove((tmp_dir + "/param").c_str());
+    remove((tmp_dir + "/__model__").c_str());
+    rmdir(tmp_dir.c_str());
+  };
+  try {
+    // The parameters are mapped by the later loads, which share their pages
+    // across the processes.
+    inference::SaveVars(*scope_, params, tmp_dir, true, true);
+    std::string serialized = program.Proto()->SerializeAsString();
+    std::ofstream file(tmp_dir + "/__model__", std::ios::binary);
+    file.write(serialized.data(), serialized.size());
+    PADDLE_ENFORCE(static_cast<bool>(file), "fail to write the program");
+  } catch (const std::exception &e) {
+    LOG(WARNING) << "fail to write the optimized program cache " << tmp_dir
+                 << ": " << e.what();
+    remove_tmp();
+    return;
+  }
+  if (rename(tmp_dir.c_str(), dir.c_str()) != 0) {
+    // Another process may have written the same cache.
+    LOG(WARNING) << "fail to write the optimized program cache " << dir;
+    remove_tmp();
+  }
+}
+
+bool AnalysisPredictor::ReloadParams(const std::string &model_dir,
+                                     const std::string &param_file) {
+  WaitForWarmup();
+  std::lock_guard<std::mutex> reload_lock(shared_params_->reload_mutex);
+  // The parameters are saved by the persistables of the original program.
+  std::string prog_file = config_.model_dir.empty()
+                              ? config_.prog_file
+                              : config_.model_dir + "/__model__";
+  std::string serialized;
+  if (!ReadFile(prog_file, &serialized)) {
+    LOG(ERROR) << "fail to read the program " << prog_file;
+    return false;
+  }
+  framework::ProgramDesc origin(serialized);
+  std::unordered_set<std::string> names;
+  for (auto *var : origin.Block(0).AllVars()) {
+    if (IsPersistable(*var)) names.insert(var->Name());
+  }
+  for (auto *var : inference_program_->Block(0).AllVars()) {
+    if (IsPersistable(*var) && !names.count(var->Name())) {
+      LOG(ERROR) << "the parameter " << var->Name()
+                 << " is created by the IR passes, it cannot be reloaded";
+      return false;
+    }
+  }
+  for (auto &name : names) {
+    auto *var = scope_->FindLocalVar(name);
+    if (var == nullptr || !var->IsType<framework::LoDTensor>()) {
+      LOG(ERROR) << "the parameter " << name
+                 << " is removed by the IR passes, it cannot be reloaded";
+      return false;
+    }
+  }
+
+  // Load the new values aside while the predictors run on the old ones.
+  framework::Scope staging;
+  try {
+    framework::Executor exe(place_);
+    inference::LoadPersistables(&exe, &staging, origin, model_dir,
+                                param_file);
+  } catch (const std::exception &e) {
+    LOG(ERROR) << "fail to load the parameters: " << e.what();
+    return false;
+  }
+  for (auto &name : names) {
+    auto &value = staging.FindVar(name)->Get<framework::LoDTensor>();
+    auto &param = scope_->FindLocalVar(name)->Get<framework::LoDTensor>();
+    if (value.dims() != param.dims() || value.type() != param.type()) {
+      LOG(ERROR) << "the new value of the parameter " << name
+                 << " does not match the old one";
+      return false;
+    }
+  }
+
+  framework::RWLockGuard guard(&shared_params_->lock,
+                               framework::RWLockGuard::Status::kWRLock);
+  // The variables and their tensors, which the operators have resolved, stay
+  // the same and share the new memory. The transformed copies of the inputs
+  // cached by the operators, which are shared by the clones, are dropped as
+  // the allocator may reuse the freed memory of the old values for other
+  // tensors. The caches kept in the scope by the kernels, e.g. w@PACKED, are
+  // erased and built again.
+  std::unordered_set<std::string> program_vars;
+  for (auto *var : inference_program_->Block(0).AllVars()) {
+    program_vars.insert(var->Name());
+  }
+  std::vector<std::string> derived;
+  for (auto &name : scope_->LocalVarNames()) {
+    auto pos = name.find('@');
+    if (pos != std::string::npos && names.count(name.substr(0, pos)) &&
+        !program_vars.count(name)) {
+      derived.push_back(name);
+    }
+  }
+  for (auto &name : names) {
+    auto *param =
+        scope_->FindLocalVar(name)->GetMutable<framework::LoDTensor>();
+    auto *value = staging.FindVar(name)->GetMutable<framework::LoDTensor>();
+    param->ShareDataWith(*value);
+    param->set_lod(value->lod());
+  }
+  scope_->EraseVars(derived);
+  executor_->ClearTransferCache();
+  ++shared_params_->version;
+  LOG(INFO) << "reload " << names.size() << " parameters to the version "
+            << shared_params_->version;
+  return true;
+}
+
 AnalysisPredictor::~AnalysisPredictor() {
+  WaitForWarmup();
 #if !defined(_WIN32)
   if (FLAGS_profile) {
     platform::DisableProfiler(platform::EventSortingKey::kTotal,
@@ -372,8 +946,13 @@ AnalysisPredictor::~AnalysisPredictor() {
 }
 
 std::unique_ptr<PaddlePredictor> AnalysisPredictor::Clone() {
+  WaitForWarmup();
   auto *x = new AnalysisPredictor(config_);
-  x->Init(scope_, inference_program_);
+  if (numa_node_ >= 0) {
+    x->config_.numa_node =
+        (numa_node_ + ++num_clones_) % platform::NumaNodeCount();
+  }
+  x->InitShared(*this);
   return std::unique_ptr<PaddlePredictor>(x);
 }
 
@@ -13,9 +13,15 @@
 // limitations under the License.
 
 #pragma once
+#include <atomic>
+#include <functional>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
 #include <string>
 #include <vector>
+#include "paddle/fluid/framework/ir/pass.h"
 #include "paddle/fluid/framework/naive_executor.h"
+#include "paddle/fluid/framework/rw_lock.h"
 #include "paddle/fluid/inference/analysis/analyzer.h"
 #include "paddle/fluid/inference/api/api_impl.h"
 #include "paddle/fluid/inference/api/details/reset_tensor_array.h"
@@ -52,6 +58,14 @@ class AnalysisPredictor : public PaddlePredictor {
 
   bool ZeroCopyRun() override;
 
+  bool Warmup(const std::vector<std::vector<PaddleTensor>> &inputs) override;
+  bool IsReady() const override { return ready_; }
+
+  // The parameters of the IR optimized program should be the ones of the
+  // model, it fails if the passes fuse or convert them.
+  bool ReloadParams(const std::string &model_dir,
+                    const std::string &param_file = "") override;
+
   void PrepareFeedFetch();
 
   void OptimizeInferenceProgram();
@@ -63,9 +77,54 @@ class AnalysisPredictor : public PaddlePredictor {
   framework::Scope *scope() { return executor_->scope(); }
   framework::ProgramDesc &program() { return *inference_program_; }
 
+  // The names of the feed and fetch variables, in the order of their "col".
+  std::vector<std::string> GetInputNames() const;
+  std::vector<std::string> GetOutputNames() const;
+
  protected:
+  // Share the program, the parameters and the operators of other, only
+  // create the temporary variables in a new scope.
+  bool InitShared(const AnalysisPredictor &other);
+
   bool LoadProgramDesc();
 
+  // The directory caching the optimized program of the model and config_,
+  // empty if the cache is disabled.
+  std::string OptimCacheDir();
+  bool LoadOptimCache(const std::string &dir);
+  void SaveOptimCache(const std::string &dir);
+
+  // Calibrate the ranges of the variables on config_.int8_calibration_data,
+  // then quantize the program to INT8 and prepare it again.
+  bool QuantizeINT8();
+  // Run the inputs through the feed and fetch ops, or the zero copy tensors
+  // without them, and discard the outputs.
+  bool RunBatch(const std::vector<PaddleTensor> &inputs);
+  bool RunFeedFetch(const std::vector<PaddleTensor> &inputs,
+                    std::vector<PaddleTensor> *output_data);
+  bool RunZeroCopy();
+  // Warm up on config_.warmup_data, in the background if
+  // config_.warmup_in_background.
+  bool StartWarmup();
+  bool RunWarmup(const std::vector<std::vector<PaddleTensor>> &inputs);
+  // Wait for the warm-up in the background if any.
+  void WaitForWarmup();
+  // Convert the program by the pass, such as running in half precision or in
+  // the NHWC layout on GPU, and prepare it again. set_attrs sets the
+  // attributes of the pass if any.
+  bool ConvertProgram(
+      const std::string &pass_name,
+      const std::function<void(framework::ir::Pass *)> &set_attrs = nullptr);
+  // Prepare the executor and the feeds and fetches for the new program.
+  void PrepareExecutor();
+  // Bind the calling thread to numa_node_ if it is not yet.
+  void BindNumaNode();
+  // Copy the parameters into the scope of the clone on another NUMA node.
+  void ReplicateParams();
+  // Replicate the parameters again if they are reloaded. Requires the read
+  // lock of shared_params_.
+  void UpdateReplicas();
+
   bool SetFeed(const std::vector<PaddleTensor> &input_datas,
                framework::Scope *scope);
   bool GetFetch(std::vector<PaddleTensor> *output_data,
@@ -90,6 +149,23 @@ class AnalysisPredictor : public PaddlePredictor {
   // concurrency problems, so cache them.
   std::vector<framework::LoDTensor> feed_tensors_;
   details::TensorArrayBatchCleaner tensor_array_batch_cleaner_;
+  // The NUMA node the predictor runs on, -1 if not bound.
+  int numa_node_{-1};
+  std::atomic<int> num_clones_{0};
+  std::future<bool> warmup_;
+  std::atomic<bool> ready_{true};
+
+  // The runs of the predictor and its clones hold the read lock, the reload
+  // of the parameters holds the write lock to switch to the new values.
+  struct SharedParams {
+    framework::RWLock lock;
+    std::mutex reload_mutex;
+    std::atomic<int64_t> version{0};
+  };
+  std::shared_ptr<SharedParams> shared_params_{new SharedParams};
+  // The version of the parameters replicated by the clone, -1 if it has no
+  // replicas.
+  int64_t replicas_version_{-1};
 };
 
 }  // namespace paddle
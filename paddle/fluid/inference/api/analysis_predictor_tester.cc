@@ -14,7 +14,15 @@
 
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <cmath>
+#include <thread>  // NOLINT
+#include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/inference/api/model_manager.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/inference/api/predictor_pool.h"
+#include "paddle/fluid/inference/io.h"
 
 DEFINE_string(dirname, "", "dirname to tests.");
 
@@ -61,5 +69,275 @@ TEST(AnalysisPredictor, ZeroCopy) {
   LOG(INFO) << "output_data: " << out_data;
 }
 
+TEST(AnalysisPredictor, PredictorPool) {
+  AnalysisConfig config;
+  config.model_dir = FLAGS_dirname + "/word2vec.inference.model";
+  config.use_feed_fetch_ops = false;
+
+  const int kNumThreads = 4;
+  contrib::PredictorPool pool(CreatePaddlePredictor<AnalysisConfig>(config),
+                              kNumThreads);
+  ASSERT_EQ(pool.size(), static_cast<size_t>(kNumThreads));
+
+  // Every predictor runs the same words on its own thread.
+  std::vector<std::vector<float>> outputs(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < kNumThreads; ++tid) {
+    threads.emplace_back([&, tid] {
+      auto* predictor = pool.Retrieve(tid);
+      for (auto& name : {"firstw", "secondw", "thirdw", "forthw"}) {
+        auto input = predictor->GetInputTensor(name);
+        input->Reshape({4, 1});
+        auto* data = input->mutable_data<int64_t>(PaddlePlace::kCPU);
+        for (int i = 0; i < 4; i++) {
+          data[i] = i;
+        }
+      }
+      for (int i = 0; i < 10; i++) {
+        ASSERT_TRUE(predictor->ZeroCopyRun());
+      }
+      auto out = predictor->GetOutputTensor("fc_1.tmp_2");
+      PaddlePlace place;
+      int size = 0;
+      auto* out_data = out->data<float>(&place, &size);
+      outputs[tid].assign(out_data, out_data + size);
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  ASSERT_FALSE(outputs[0].empty());
+  for (int tid = 1; tid < kNumThreads; ++tid) {
+    ASSERT_EQ(outputs[tid].size(), outputs[0].size());
+    for (size_t i = 0; i < outputs[0].size(); i++) {
+      EXPECT_NEAR(outputs[tid][i], outputs[0][i], 1e-5);
+    }
+  }
+}
+
+std::vector<float> RunWords(PaddlePredictor* predictor) {
+  for (auto& name : {"firstw", "secondw", "thirdw", "forthw"}) {
+    auto input = predictor->GetInputTensor(name);
+    input->Reshape({4, 1});
+    auto* data = input->mutable_data<int64_t>(PaddlePlace::kCPU);
+    for (int i = 0; i < 4; i++) {
+      data[i] = i;
+    }
+  }
+  EXPECT_TRUE(predictor->ZeroCopyRun());
+  auto out = predictor->GetOutputTensor("fc_1.tmp_2");
+  PaddlePlace place;
+  int size = 0;
+  auto* out_data = out->data<float>(&place, &size);
+  return std::vector<float>(out_data, out_data + size);
+}
+
+TEST(AnalysisPredictor, OptimCache) {
+  AnalysisConfig config;
+  config.model_dir = FLAGS_dirname + "/word2vec.inference.model";
+  config.use_feed_fetch_ops = false;
+  auto expected = RunWords(CreatePaddlePredictor<AnalysisConfig>(config).get());
+
+  char cache_dir[] = "/tmp/analysis_predictor_cacheXXXXXX";
+  ASSERT_NE(mkdtemp(cache_dir), nullptr);
+  config.opt_cache_dir = cache_dir;
+  // The first predictor writes the cache, the second one loads it.
+  for (int i = 0; i < 2; i++) {
+    auto output = RunWords(CreatePaddlePredictor<AnalysisConfig>(config).get());
+    ASSERT_EQ(output.size(), expected.size());
+    for (size_t j = 0; j < expected.size(); j++) {
+      EXPECT_NEAR(output[j], expected[j], 1e-5);
+    }
+  }
+}
+
+TEST(AnalysisPredictor, NumaNode) {
+  AnalysisConfig config;
+  config.model_dir = FLAGS_dirname + "/word2vec.inference.model";
+  config.use_feed_fetch_ops = false;
+  auto expected = RunWords(CreatePaddlePredictor<AnalysisConfig>(config).get());
+
+  config.numa_node = 0;
+  config.replicate_params_per_numa_node = true;
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  // The clones run on the other nodes with their own parameters, if any.
+  std::vector<std::unique_ptr<PaddlePredictor>> clones;
+  for (int i = 0; i < 2; i++) {
+    clones.emplace_back(predictor->Clone());
+  }
+  for (auto& clone : clones) {
+    std::vector<float> output;
+    std::thread t([&] { output = RunWords(clone.get()); });
+    t.join();
+    ASSERT_EQ(output.size(), expected.size());
+    for (size_t j = 0; j < expected.size(); j++) {
+      EXPECT_NEAR(output[j], expected[j], 1e-5);
+    }
+  }
+}
+
+TEST(AnalysisPredictor, Warmup) {
+  AnalysisConfig config;
+  config.model_dir = FLAGS_dirname + "/word2vec.inference.model";
+  config.use_feed_fetch_ops = false;
+  auto expected = RunWords(CreatePaddlePredictor<AnalysisConfig>(config).get());
+
+  // Warm up on the batch sizes to serve.
+  for (int batch_size : {1, 8}) {
+    std::vector<PaddleTensor> inputs;
+    for (auto& name : {"firstw", "secondw", "thirdw", "forthw"}) {
+      PaddleTensor input;
+      input.name = name;
+      input.shape = {batch_size, 1};
+      input.dtype = PaddleDType::INT64;
+      input.data.Resize(batch_size * sizeof(int64_t));
+      auto* data = static_cast<int64_t*>(input.data.data());
+      for (int i = 0; i < batch_size; i++) {
+        data[i] = i;
+      }
+      inputs.push_back(input);
+    }
+    config.warmup_data.push_back(inputs);
+  }
+
+  for (bool background : {false, true}) {
+    config.warmup_in_background = background;
+    auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+    if (!background) {
+      EXPECT_TRUE(predictor->IsReady());
+    }
+    // The run waits for the warm-up in the background.
+    auto output = RunWords(predictor.get());
+    EXPECT_TRUE(predictor->IsReady());
+    ASSERT_EQ(output.size(), expected.size());
+    for (size_t j = 0; j < expected.size(); j++) {
+      EXPECT_NEAR(output[j], expected[j], 1e-5);
+    }
+    EXPECT_TRUE(predictor->Warmup(config.warmup_data));
+  }
+}
+
+TEST(AnalysisPredictor, BF16) {
+  AnalysisConfig config;
+  config.model_dir = FLAGS_dirname + "/word2vec.inference.model";
+  config.use_feed_fetch_ops = false;
+  auto expected = RunWords(CreatePaddlePredictor<AnalysisConfig>(config).get());
+
+  config.enable_bf16 = true;
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  ASSERT_TRUE(predictor != nullptr);
+  auto output = RunWords(predictor.get());
+  ASSERT_EQ(output.size(), expected.size());
+  // bfloat16 keeps 8 bits of precision, the GEMMs accumulate in float.
+  for (size_t j = 0; j < expected.size(); j++) {
+    EXPECT_NEAR(output[j], expected[j], 1e-2);
+  }
+}
+
+TEST(AnalysisPredictor, ReloadParams) {
+  AnalysisConfig config;
+  config.model_dir = FLAGS_dirname + "/word2vec.inference.model";
+  config.use_feed_fetch_ops = false;
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  auto clone = predictor->Clone();
+  auto expected = RunWords(predictor.get());
+
+  // Save the parameters of the model halved.
+  char param_dir[] = "/tmp/analysis_predictor_reloadXXXXXX";
+  ASSERT_NE(mkdtemp(param_dir), nullptr);
+  {
+    framework::Scope scope;
+    framework::Executor exe(platform::CPUPlace{});
+    auto program = Load(&exe, &scope, config.model_dir);
+    std::vector<std::string> params;
+    for (auto* var : program->Block(0).AllVars()) {
+      if (!var->Persistable() ||
+          var->GetType() != framework::proto::VarType::LOD_TENSOR) {
+        continue;
+      }
+      auto* tensor =
+          scope.FindVar(var->Name())->GetMutable<framework::LoDTensor>();
+      auto* data = tensor->data<float>();
+      for (int64_t i = 0; i < tensor->numel(); i++) {
+        data[i] *= 0.5;
+      }
+      params.push_back(var->Name());
+    }
+    std::sort(params.begin(), params.end());
+    SaveVars(scope, params, param_dir);
+  }
+
+  // The clone shares the reloaded parameters.
+  ASSERT_TRUE(predictor->ReloadParams("", std::string(param_dir) + "/param"));
+  auto output = RunWords(predictor.get());
+  ASSERT_EQ(output.size(), expected.size());
+  bool changed = false;
+  for (size_t j = 0; j < expected.size(); j++) {
+    changed |= std::abs(output[j] - expected[j]) > 1e-5;
+  }
+  EXPECT_TRUE(changed);
+  auto clone_output = RunWords(clone.get());
+  ASSERT_EQ(clone_output.size(), output.size());
+  for (size_t j = 0; j < output.size(); j++) {
+    EXPECT_NEAR(clone_output[j], output[j], 1e-5);
+  }
+
+  ASSERT_TRUE(clone->ReloadParams(config.model_dir));
+  output = RunWords(predictor.get());
+  for (size_t j = 0; j < expected.size(); j++) {
+    EXPECT_NEAR(output[j], expected[j], 1e-5);
+  }
+  EXPECT_FALSE(predictor->ReloadParams("/tmp/no_such_model_dir"));
+}
+
+TEST(AnalysisPredictor, ModelManager) {
+  AnalysisConfig config;
+  config.model_dir = FLAGS_dirname + "/word2vec.inference.model";
+  config.use_feed_fetch_ops = false;
+  auto expected = RunWords(CreatePaddlePredictor<AnalysisConfig>(config).get());
+
+  char cache_dir[] = "/tmp/model_manager_cacheXXXXXX";
+  ASSERT_NE(mkdtemp(cache_dir), nullptr);
+  // The first registration writes the cache, the second one loads it.
+  size_t model_bytes = 0;
+  {
+    contrib::ModelManager manager(0, cache_dir);
+    ASSERT_TRUE(manager.Register("a", config));
+    size_t optimized_bytes = manager.resident_bytes();
+    ASSERT_TRUE(manager.Register("b", config));
+    model_bytes = manager.resident_bytes() - optimized_bytes;
+  }
+  ASSERT_GT(model_bytes, 0UL);
+
+  // The budget only holds one of the models.
+  contrib::ModelManager manager(model_bytes * 3 / 2, cache_dir);
+  ASSERT_TRUE(manager.Register("a", config));
+  ASSERT_TRUE(manager.Register("b", config));
+  EXPECT_FALSE(manager.IsResident("a"));
+  EXPECT_TRUE(manager.IsResident("b"));
+  EXPECT_EQ(manager.resident_bytes(), model_bytes);
+  EXPECT_EQ(manager.num_loads(), 2UL);
+  EXPECT_EQ(manager.Acquire("c"), nullptr);
+
+  for (auto* name : {"a", "a", "b"}) {
+    auto predictor = manager.Acquire(name);
+    ASSERT_NE(predictor, nullptr);
+    EXPECT_TRUE(manager.IsResident(name));
+    auto output = RunWords(predictor.get());
+    ASSERT_EQ(output.size(), expected.size());
+    for (size_t j = 0; j < expected.size(); j++) {
+      EXPECT_NEAR(output[j], expected[j], 1e-5);
+    }
+  }
+  // a is loaded again, then b.
+  EXPECT_EQ(manager.num_loads(), 4UL);
+  EXPECT_FALSE(manager.IsResident("a"));
+
+  manager.Unregister("b");
+  EXPECT_EQ(manager.resident_bytes(), 0UL);
+  EXPECT_EQ(manager.Acquire("b"), nullptr);
+}
+
 }  // namespace inference
 }  // namespace paddle
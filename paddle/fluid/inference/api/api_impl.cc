@@ -21,6 +21,7 @@ limitations under the License. */
 #include <vector>
 
 #include "paddle/fluid/framework/feed_fetch_method.h"
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/inference/api/api_impl.h"
 #include "paddle/fluid/inference/api/details/reset_tensor_array.h"
 #include "paddle/fluid/inference/api/helper.h"
@@ -40,6 +41,32 @@ std::string num2str(T a) {
   istr << a;
   return istr.str();
 }
+
+// Copy a tensor of the inputs to a LoDTensor on the CPU.
+bool PaddleTensorToLoDTensor(const PaddleTensor &tensor,
+                             framework::LoDTensor *input) {
+  framework::DDim ddim = framework::make_ddim(tensor.shape);
+  void *input_ptr;
+  if (tensor.dtype == PaddleDType::INT64) {
+    input_ptr = input->mutable_data<int64_t>(ddim, platform::CPUPlace());
+  } else if (tensor.dtype == PaddleDType::FLOAT32) {
+    input_ptr = input->mutable_data<float>(ddim, platform::CPUPlace());
+  } else {
+    LOG(ERROR) << "unsupported feed type " << tensor.dtype;
+    return false;
+  }
+
+  // TODO(panyx0718): Init LoDTensor from existing memcpy to save a copy.
+  std::memcpy(static_cast<void *>(input_ptr), tensor.data.data(),
+              tensor.data.length());
+  // TODO(Superjomn) Low performance, need optimization for heavy LoD copy.
+  framework::LoD lod;
+  for (auto &level : tensor.lod) {
+    lod.emplace_back(level);
+  }
+  input->set_lod(lod);
+  return true;
+}
 }  // namespace
 
 void NativePaddlePredictor::PrepareFeedFetch() {
@@ -120,6 +147,105 @@ bool NativePaddlePredictor::Init(
   return true;
 }
 
+bool NativePaddlePredictor::InitShared(const NativePaddlePredictor &other) {
+  VLOG(3) << "Predictor::init_shared()";
+  place_ = other.place_;
+  scope_ = other.scope_;
+  sub_scope_ = &(scope_->NewScope());
+  PADDLE_ENFORCE_NOT_NULL(sub_scope_, "create sub scope fail");
+  executor_.reset(new paddle::framework::Executor(place_));
+  // The parameters are loaded by other already, and the prepared operators
+  // are stateless, so they are shared instead of created again.
+  inference_program_ = other.inference_program_;
+  ctx_ = other.ctx_;
+  executor_->CreateVariables(*inference_program_, sub_scope_, 0);
+
+  PrepareFeedFetch();
+  return true;
+}
+
+bool NativePaddlePredictor::InitSession(
+    const NativePaddlePredictor &other,
+    const std::map<std::string, std::string> &states,
+    const std::vector<PaddleTensor> &initial_states) {
+  VLOG(3) << "Predictor::init_session()";
+  place_ = other.place_;
+  scope_ = other.scope_;
+  sub_scope_ = &(scope_->NewScope());
+  PADDLE_ENFORCE_NOT_NULL(sub_scope_, "create sub scope fail");
+  executor_.reset(new paddle::framework::Executor(place_));
+  states_ = states;
+
+  // Drop the feeds and the fetches of the states, and number the others
+  // again in their order.
+  std::set<std::string> state_feeds, state_fetches;
+  for (auto &state : states) {
+    state_feeds.insert(state.first);
+    state_fetches.insert(state.second);
+  }
+  inference_program_.reset(
+      new framework::ProgramDesc(*other.inference_program_));
+  auto *block = inference_program_->MutableBlock(0);
+  int feed_col = 0;
+  int fetch_col = 0;
+  for (size_t i = 0; i < block->OpSize();) {
+    auto *op = block->Op(i);
+    if (op->Type() == "feed") {
+      if (state_feeds.erase(op->Output("Out")[0])) {
+        block->RemoveOp(i, i + 1);
+        continue;
+      }
+      op->SetAttr("col", feed_col++);
+    } else if (op->Type() == "fetch") {
+      if (state_fetches.erase(op->Input("X")[0])) {
+        block->RemoveOp(i, i + 1);
+        continue;
+      }
+      op->SetAttr("col", fetch_col++);
+    }
+    ++i;
+  }
+  if (!state_feeds.empty() || !state_fetches.empty()) {
+    LOG(ERROR) << "the states are not the feed and fetch targets of the model";
+    return false;
+  }
+  ctx_ = executor_->Prepare(*inference_program_, 0);
+  executor_->CreateVariables(*inference_program_, sub_scope_, 0);
+  PrepareFeedFetch();
+
+  if (initial_states.size() != states.size()) {
+    LOG(ERROR) << "wrong initial state size, need " << states.size()
+               << " but get " << initial_states.size();
+    return false;
+  }
+  for (auto &state : initial_states) {
+    framework::LoDTensor value;
+    if (!states.count(state.name) || !PaddleTensorToLoDTensor(state, &value)) {
+      LOG(ERROR) << "fail to set the initial state " << state.name;
+      return false;
+    }
+    auto *tensor =
+        sub_scope_->Var(state.name)->GetMutable<framework::LoDTensor>();
+    framework::TensorCopySync(value, place_, tensor);
+    tensor->set_lod(value.lod());
+  }
+  return true;
+}
+
+void NativePaddlePredictor::UpdateStates(framework::Scope *scope) {
+  for (auto &state : states_) {
+    auto *fetch = scope->FindVar(state.second);
+    PADDLE_ENFORCE_NOT_NULL(fetch, "no state variable called %s",
+                            state.second);
+    auto &value = fetch->Get<framework::LoDTensor>();
+    auto *tensor = scope->Var(state.first)->GetMutable<framework::LoDTensor>();
+    // Copy instead of sharing the memory, since the operators may write the
+    // fetch target while reading the feed target.
+    framework::TensorCopy(value, place_, tensor);
+    tensor->set_lod(value.lod());
+  }
+}
+
 NativePaddlePredictor::~NativePaddlePredictor() {
 #if !defined(_WIN32)
   if (FLAGS_profile) {
@@ -152,6 +278,9 @@ bool NativePaddlePredictor::Run(const std::vector<PaddleTensor> &inputs,
                                 false, /* don't create local scope each time*/
                                 false /* don't create variable each time */);
   VLOG(4) << "Finish prepared context";
+  if (!states_.empty()) {
+    UpdateStates(scope);
+  }
   // get fetch variable
   if (!GetFetch(output_data, scope)) {
     LOG(ERROR) << "fail to get fetches";
@@ -169,8 +298,8 @@ std::unique_ptr<PaddlePredictor> NativePaddlePredictor::Clone() {
   VLOG(3) << "Predictor::clone";
   std::unique_ptr<PaddlePredictor> cls(new NativePaddlePredictor(config_));
 
-  if (!dynamic_cast<NativePaddlePredictor *>(cls.get())->Init(scope_)) {
-    LOG(ERROR) << "fail to call Init";
+  if (!dynamic_cast<NativePaddlePredictor *>(cls.get())->InitShared(*this)) {
+    LOG(ERROR) << "fail to call InitShared";
     return nullptr;
   }
 #ifdef __clang__
@@ -182,6 +311,25 @@ std::unique_ptr<PaddlePredictor> NativePaddlePredictor::Clone() {
 #endif
 }
 
+std::unique_ptr<PaddlePredictor> NativePaddlePredictor::CreateSession(
+    const std::map<std::string, std::string> &states,
+    const std::vector<PaddleTensor> &initial_states) {
+  VLOG(3) << "Predictor::create_session";
+  std::unique_ptr<PaddlePredictor> session(new NativePaddlePredictor(config_));
+  if (!dynamic_cast<NativePaddlePredictor *>(session.get())
+           ->InitSession(*this, states, initial_states)) {
+    LOG(ERROR) << "fail to call InitSession";
+    return nullptr;
+  }
+#ifdef __clang__
+  // fix clang compile error
+  return session;
+#else
+  // fix manylinux compile error.
+  return std::move(session);
+#endif
+}
+
 bool NativePaddlePredictor::SetFeed(const std::vector<PaddleTensor> &inputs,
                                     framework::Scope *scope) {
   VLOG(3) << "Predictor::set_feed";
@@ -192,26 +340,7 @@ bool NativePaddlePredictor::SetFeed(const std::vector<PaddleTensor> &inputs,
   }
   for (size_t i = 0; i < inputs.size(); ++i) {
     framework::LoDTensor input;
-    framework::DDim ddim = framework::make_ddim(inputs[i].shape);
-    void *input_ptr;
-    if (inputs[i].dtype == PaddleDType::INT64) {
-      input_ptr = input.mutable_data<int64_t>(ddim, platform::CPUPlace());
-    } else if (inputs[i].dtype == PaddleDType::FLOAT32) {
-      input_ptr = input.mutable_data<float>(ddim, platform::CPUPlace());
-    } else {
-      LOG(ERROR) << "unsupported feed type " << inputs[i].dtype;
-      return false;
-    }
-
-    // TODO(panyx0718): Init LoDTensor from existing memcpy to save a copy.
-    std::memcpy(static_cast<void *>(input_ptr), inputs[i].data.data(),
-                inputs[i].data.length());
-    // TODO(Superjomn) Low performance, need optimization for heavy LoD copy.
-    framework::LoD lod;
-    for (auto &level : inputs[i].lod) {
-      lod.emplace_back(level);
-    }
-    input.set_lod(lod);
+    if (!PaddleTensorToLoDTensor(inputs[i], &input)) return false;
     int idx = -1;
     if (config_.specify_input_name) {
       idx = feed_names_[inputs[i].name];
@@ -52,6 +52,10 @@ class NativePaddlePredictor : public PaddlePredictor {
 
   std::unique_ptr<PaddlePredictor> Clone() override;
 
+  std::unique_ptr<PaddlePredictor> CreateSession(
+      const std::map<std::string, std::string> &states,
+      const std::vector<PaddleTensor> &initial_states) override;
+
   ~NativePaddlePredictor() override;
 
   framework::Scope *scope() { return sub_scope_ ? sub_scope_ : scope_.get(); }
@@ -66,17 +70,31 @@ class NativePaddlePredictor : public PaddlePredictor {
                    PaddleTensor *output_data);
   void PrepareFeedFetch();
 
+  // Share the program, the parameters and the prepared operators of other,
+  // only create the temporary variables in a new sub scope.
+  bool InitShared(const NativePaddlePredictor &other);
+  // Share the parameters of other, and prepare a copy of the program without
+  // the feeds and fetches of the states.
+  bool InitSession(const NativePaddlePredictor &other,
+                   const std::map<std::string, std::string> &states,
+                   const std::vector<PaddleTensor> &initial_states);
+  // Copy the fetch targets of the states to their feed targets for the next
+  // run of a session, on the device.
+  void UpdateStates(framework::Scope *scope);
+
   NativeConfig config_;
   platform::Place place_;
   std::unique_ptr<framework::Executor> executor_;
   std::shared_ptr<framework::Scope> scope_;
-  std::unique_ptr<framework::ExecutorPrepareContext> ctx_;
-  std::unique_ptr<framework::ProgramDesc> inference_program_;
+  std::shared_ptr<framework::ExecutorPrepareContext> ctx_;
+  std::shared_ptr<framework::ProgramDesc> inference_program_;
   std::vector<framework::OpDesc *> feeds_;
   std::map<std::string, size_t> feed_names_;
   std::vector<framework::OpDesc *> fetchs_;
   // Do not use unique_ptr, use parent scope to delete
   framework::Scope *sub_scope_{nullptr};
+  // The feed targets of the states of a session to their fetch targets.
+  std::map<std::string, std::string> states_;
   details::TensorArrayBatchCleaner tensor_array_batch_cleaner_;
 };
 
@@ -14,7 +14,9 @@ limitations under the License. */
 
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#include <sys/stat.h>
 
+#include <fstream>
 #include <thread>  // NOLINT
 
 #include "gflags/gflags.h"
@@ -268,6 +270,85 @@ void MainThreadsImageClassification(bool use_gpu) {
   }
 }
 
+// Save a model summing up its input x in the state h, y = 2 * (x + h).
+std::string SaveAccumulateModel() {
+  std::string dirname = "./accumulate.inference.model";
+  mkdir(dirname.c_str(), 0755);
+  framework::ProgramDesc program;
+  auto* block = program.MutableBlock(0);
+  block->Var("feed")->SetType(framework::proto::VarType::FEED_MINIBATCH);
+  block->Var("feed")->SetPersistable(true);
+  block->Var("fetch")->SetType(framework::proto::VarType::FETCH_LIST);
+  block->Var("fetch")->SetPersistable(true);
+  for (auto* name : {"x", "h", "h_out", "y"}) {
+    auto* var = block->Var(name);
+    var->SetType(framework::proto::VarType::LOD_TENSOR);
+    var->SetDataType(framework::proto::VarType::FP32);
+    var->SetShape({-1, 2});
+  }
+  auto add_op = [&](const std::string& type, const std::string& x,
+                    const std::string& out) {
+    auto* op = block->AppendOp();
+    op->SetType(type);
+    op->SetInput("X", {x});
+    op->SetOutput("Out", {out});
+    return op;
+  };
+  add_op("feed", "feed", "x")->SetAttr("col", 0);
+  add_op("feed", "feed", "h")->SetAttr("col", 1);
+  add_op("elementwise_add", "x", "h_out")->SetInput("Y", {"h"});
+  add_op("scale", "h_out", "y")->SetAttr("scale", 2.f);
+  add_op("fetch", "h_out", "fetch")->SetAttr("col", 0);
+  add_op("fetch", "y", "fetch")->SetAttr("col", 1);
+  std::ofstream file(dirname + "/__model__", std::ios::binary);
+  file << program.Proto()->SerializeAsString();
+  return dirname;
+}
+
+void MainStreamingSession(bool use_gpu) {
+  NativeConfig config = GetConfig();
+  config.model_dir = SaveAccumulateModel();
+  config.use_gpu = use_gpu;
+  auto predictor = CreatePaddlePredictor(config);
+
+  std::vector<float> zeros(2, 0.f);
+  PaddleTensor h;
+  h.name = "h";
+  h.shape = {1, 2};
+  h.dtype = PaddleDType::FLOAT32;
+  h.data.Reset(zeros.data(), zeros.size() * sizeof(float));
+  auto session0 = predictor->CreateSession({{"h", "h_out"}}, {h});
+  auto session1 = predictor->CreateSession({{"h", "h_out"}}, {h});
+  ASSERT_TRUE(session0 != nullptr);
+  ASSERT_TRUE(session1 != nullptr);
+
+  std::vector<float> chunk = {1.f, 2.f};
+  PaddleTensor x;
+  x.shape = {1, 2};
+  x.dtype = PaddleDType::FLOAT32;
+  x.data.Reset(chunk.data(), chunk.size() * sizeof(float));
+  std::vector<PaddleTensor> outputs;
+  for (int step = 1; step <= 3; ++step) {
+    ASSERT_TRUE(session0->Run({x}, &outputs));
+    // Only y is fetched, the state stays in the session.
+    ASSERT_EQ(outputs.size(), 1UL);
+    ASSERT_EQ(outputs[0].data.length(), 2 * sizeof(float));
+    auto* y = static_cast<float*>(outputs[0].data.data());
+    EXPECT_NEAR(y[0], 2.f * step, ACC_DIFF);
+    EXPECT_NEAR(y[1], 4.f * step, ACC_DIFF);
+  }
+  // The sessions do not share the states.
+  ASSERT_TRUE(session1->Run({x}, &outputs));
+  EXPECT_NEAR(static_cast<float*>(outputs[0].data.data())[0], 2.f, ACC_DIFF);
+
+  // The predictor still takes the states as the feeds.
+  ASSERT_TRUE(predictor->Run({x, h}, &outputs));
+  ASSERT_EQ(outputs.size(), 2UL);
+
+  // The states should be the feed and fetch targets.
+  EXPECT_TRUE(predictor->CreateSession({{"h", "y1"}}, {h}) == nullptr);
+}
+
 TEST(inference_api_native, word2vec_cpu) { MainWord2Vec(false /*use_gpu*/); }
 TEST(inference_api_native, word2vec_cpu_threads) {
   MainThreadsWord2Vec(false /*use_gpu*/);
@@ -278,6 +359,9 @@ TEST(inference_api_native, image_classification_cpu) {
 TEST(inference_api_native, image_classification_cpu_threads) {
   MainThreadsImageClassification(false /*use_gpu*/);
 }
+TEST(inference_api_native, streaming_session_cpu) {
+  MainStreamingSession(false /*use_gpu*/);
+}
 
 #ifdef PADDLE_WITH_CUDA
 TEST(inference_api_native, word2vec_gpu) { MainWord2Vec(true /*use_gpu*/); }
@@ -288,6 +372,9 @@ TEST(inference_api_native, word2vec_gpu) { MainWord2Vec(true /*use_gpu*/); }
 TEST(inference_api_native, image_classification_gpu) {
   MainImageClassification(true /*use_gpu*/);
 }
+TEST(inference_api_native, streaming_session_gpu) {
+  MainStreamingSession(true /*use_gpu*/);
+}
 // Turn off temporarily for the unstable result.
 // TEST(inference_api_native, image_classification_gpu_threads) {
 //   MainThreadsImageClassification(true /*use_gpu*/);
@@ -75,9 +75,41 @@ class TensorRTSubgraphPredictor : public NativePaddlePredictor {
                                sub_scope_ ? sub_scope_ : scope_.get(), 0);
     // Get the feed_target_names and fetch_target_names
     PrepareFeedFetch();
+    if (config_.precision_mode == "INT8") {
+      return Calibrate();
+    }
     return true;
   }
 
+  // Run the calibration batches with the INT8 engine ops recording their
+  // inputs, then run the first batch again to build the engines calibrated
+  // with them. Without the batches, the engines are built with the tables
+  // cached in FLAGS_tensorrt_engine_cache_dir.
+  bool Calibrate() {
+    if (config_.int8_calibration_data.empty()) return true;
+    auto& calib_store =
+        Singleton<inference::tensorrt::TRTCalibrationStore>::Global();
+    auto batch_size = [](const std::vector<PaddleTensor>& batch) {
+      PADDLE_ENFORCE(!batch.empty() && !batch.front().shape.empty(),
+                     "the calibration batch is empty");
+      return batch.front().shape.front();
+    };
+    std::vector<PaddleTensor> outputs;
+    bool success = true;
+    calib_store.SetCalibrating(true);
+    for (auto& batch : config_.int8_calibration_data) {
+      success = Run(batch, &outputs, batch_size(batch));
+      if (!success) break;
+    }
+    calib_store.SetCalibrating(false);
+    if (success) {
+      auto& batch = config_.int8_calibration_data.front();
+      success = Run(batch, &outputs, batch_size(batch));
+    }
+    calib_store.ClearBatches();
+    return success;
+  }
+
   bool Run(const std::vector<PaddleTensor>& inputs,
            std::vector<PaddleTensor>* output_data,
            int batch_size = -1) override {
@@ -186,3 +218,10 @@ USE_TRT_CONVERTER(batch_norm);
 USE_TRT_CONVERTER(concat);
 USE_TRT_CONVERTER(dropout);
 USE_TRT_CONVERTER(pad);
+USE_TRT_CONVERTER(transpose);
+USE_TRT_CONVERTER(transpose2);
+USE_TRT_CONVERTER(reshape);
+USE_TRT_CONVERTER(reshape2);
+USE_TRT_CONVERTER(leaky_relu);
+USE_TRT_CONVERTER(prelu);
+USE_TRT_CONVERTER(matmul);
@@ -15,6 +15,7 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#include <string>
 #include "paddle/fluid/inference/analysis/analyzer.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 
@@ -24,7 +25,9 @@ using contrib::MixedRTConfig;
 
 DEFINE_string(dirname, "", "Directory of the inference model.");
 
-void CompareTensorRTWithFluid(bool enable_tensorrt) {
+void CompareTensorRTWithFluid(bool enable_tensorrt,
+                              const std::string &precision_mode = "FP32",
+                              float abs_error = 1e-3) {
   FLAGS_IA_enable_tensorrt_subgraph_engine = enable_tensorrt;
 
   //# 1. Create PaddlePredictor with a config.
@@ -40,23 +43,27 @@ void CompareTensorRTWithFluid(bool enable_tensorrt) {
   config1.fraction_of_gpu_memory = 0.3;
   config1.device = 0;
   config1.max_batch_size = 10;
+  config1.precision_mode = precision_mode;
 
-  auto predictor0 = CreatePaddlePredictor<NativeConfig>(config0);
-  auto predictor1 = CreatePaddlePredictor<MixedRTConfig>(config1);
+  //# 2. Prepare input.
+  std::vector<int64_t> data(20);
+  for (int i = 0; i < 20; i++) data[i] = i;
 
-  for (int batch_id = 0; batch_id < 1; batch_id++) {
-    //# 2. Prepare input.
-    std::vector<int64_t> data(20);
-    for (int i = 0; i < 20; i++) data[i] = i;
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({10, 1});
+  tensor.data = PaddleBuf(data.data(), data.size() * sizeof(int64_t));
+  tensor.dtype = PaddleDType::INT64;
 
-    PaddleTensor tensor;
-    tensor.shape = std::vector<int>({10, 1});
-    tensor.data = PaddleBuf(data.data(), data.size() * sizeof(int64_t));
-    tensor.dtype = PaddleDType::INT64;
+  // For simplicity, we set all the slots with the same data.
+  std::vector<PaddleTensor> slots(4, tensor);
+  if (precision_mode == "INT8") {
+    config1.int8_calibration_data.assign(2, slots);
+  }
 
-    // For simplicity, we set all the slots with the same data.
-    std::vector<PaddleTensor> slots(4, tensor);
+  auto predictor0 = CreatePaddlePredictor<NativeConfig>(config0);
+  auto predictor1 = CreatePaddlePredictor<MixedRTConfig>(config1);
 
+  for (int batch_id = 0; batch_id < 1; batch_id++) {
     //# 3. Run
     std::vector<PaddleTensor> outputs0;
     std::vector<PaddleTensor> outputs1;
@@ -76,7 +83,7 @@ void CompareTensorRTWithFluid(bool enable_tensorrt) {
 
     ASSERT_GT(num_elements, 0UL);
     for (size_t i = 0; i < std::min(num_elements, num_elements1); i++) {
-      EXPECT_NEAR(data0[i], data1[i], 1e-3);
+      EXPECT_NEAR(data0[i], data1[i], abs_error);
     }
   }
 }
@@ -89,4 +96,8 @@ TEST(paddle_inference_api_tensorrt_subgraph_engine, with_tensorrt) {
   CompareTensorRTWithFluid(true);
 }
 
+TEST(paddle_inference_api_tensorrt_subgraph_engine, with_tensorrt_int8) {
+  CompareTensorRTWithFluid(true, "INT8", 1e-1);
+}
+
 }  // namespace paddle
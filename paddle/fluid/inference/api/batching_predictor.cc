@@ -0,0 +1,336 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/batching_predictor.h"
+
+#include <glog/logging.h>
+#include <algorithm>
+#include <cstring>
+#include <future>  // NOLINT
+#include <utility>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace contrib {
+
+using Clock = std::chrono::steady_clock;
+using LoD = std::vector<std::vector<size_t>>;
+
+struct BatchingPredictor::Request {
+  const std::vector<PaddleTensor>* inputs;
+  std::vector<PaddleTensor>* outputs;
+  int num_samples;
+  Clock::time_point enqueue_time;
+  std::promise<bool> done;
+};
+
+namespace {
+
+int NumSamples(const PaddleTensor& tensor) {
+  if (!tensor.lod.empty()) {
+    return static_cast<int>(tensor.lod[0].size()) - 1;
+  }
+  return tensor.shape.empty() ? 0 : tensor.shape[0];
+}
+
+int64_t NumElements(const std::vector<int64_t>& shape) {
+  int64_t numel = 1;
+  for (auto dim : shape) numel *= dim;
+  return numel;
+}
+
+// Whether the inputs of two requests can be merged into one batch.
+bool Compatible(const std::vector<PaddleTensor>& a,
+                const std::vector<PaddleTensor>& b) {
+  if (a.size() != b.size()) return false;
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i].name != b[i].name || a[i].dtype != b[i].dtype ||
+        a[i].shape.size() != b[i].shape.size() ||
+        a[i].lod.size() != b[i].lod.size()) {
+      return false;
+    }
+    if (!std::equal(a[i].shape.begin() + 1, a[i].shape.end(),
+                    b[i].shape.begin() + 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Append the offsets of lod to merged, shifted behind the existing ones.
+void AppendLoD(const LoD& lod, LoD* merged) {
+  merged->resize(lod.size());
+  for (size_t level = 0; level < lod.size(); ++level) {
+    auto& dst = (*merged)[level];
+    if (dst.empty()) dst.push_back(0);
+    size_t base = dst.back() - lod[level].front();
+    for (size_t i = 1; i < lod[level].size(); ++i) {
+      dst.push_back(base + lod[level][i]);
+    }
+  }
+}
+
+// Slice the top level sequences [begin, end) of lod, the offsets of the slice
+// start from 0, and the rows of the slice are returned.
+LoD SliceLoD(const LoD& lod, size_t begin, size_t end, size_t* row_begin,
+             size_t* row_end) {
+  LoD slice;
+  for (auto& level : lod) {
+    PADDLE_ENFORCE_LE(end + 1, level.size(), "The LoD of output is too short");
+    std::vector<size_t> offsets;
+    for (size_t i = begin; i <= end; ++i) {
+      offsets.push_back(level[i] - level[begin]);
+    }
+    slice.emplace_back(std::move(offsets));
+    size_t next_begin = level[begin];
+    end = level[end];
+    begin = next_begin;
+  }
+  *row_begin = begin;
+  *row_end = end;
+  return slice;
+}
+
+void* MutableData(ZeroCopyTensor* tensor, PaddleDType dtype) {
+  switch (dtype) {
+    case PaddleDType::FLOAT32:
+      return tensor->mutable_data<float>(PaddlePlace::kCPU);
+    case PaddleDType::INT64:
+      return tensor->mutable_data<int64_t>(PaddlePlace::kCPU);
+    default:
+      PADDLE_THROW("Unsupported data type %d", static_cast<int>(dtype));
+  }
+  return nullptr;
+}
+
+void CopyToCPU(ZeroCopyTensor* tensor, PaddleDType dtype, void* data) {
+  switch (dtype) {
+    case PaddleDType::FLOAT32:
+      tensor->copy_to_cpu(static_cast<float*>(data));
+      break;
+    case PaddleDType::INT64:
+      tensor->copy_to_cpu(static_cast<int64_t*>(data));
+      break;
+    default:
+      PADDLE_THROW("Unsupported data type %d", static_cast<int>(dtype));
+  }
+}
+
+}  // namespace
+
+BatchingPredictor::BatchingPredictor(
+    std::unique_ptr<PaddlePredictor> predictor, const BatchingConfig& config)
+    : predictor_(std::move(predictor)), config_(config) {
+  PADDLE_ENFORCE_NOT_NULL(predictor_);
+  PADDLE_ENFORCE_GT(config_.max_batch_size, 0);
+  PADDLE_ENFORCE(!config_.output_names.empty(),
+                 "The outputs of BatchingPredictor are not set");
+  stats_.batch_size_histogram.resize(config_.max_batch_size + 1, 0);
+  start_time_ = Clock::now();
+  batch_thread_ = std::thread([this] { BatchLoop(); });
+}
+
+BatchingPredictor::~BatchingPredictor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    exit_ = true;
+  }
+  cond_.notify_all();
+  batch_thread_.join();
+}
+
+bool BatchingPredictor::Run(const std::vector<PaddleTensor>& inputs,
+                            std::vector<PaddleTensor>* outputs) {
+  if (inputs.empty() || NumSamples(inputs[0]) <= 0) {
+    LOG(ERROR) << "The request of BatchingPredictor has no sample";
+    return false;
+  }
+  for (auto& input : inputs) {
+    if (input.shape.empty()) {
+      LOG(ERROR) << "The input " << input.name << " is a scalar";
+      return false;
+    }
+  }
+  Request request;
+  request.inputs = &inputs;
+  request.outputs = outputs;
+  request.num_samples = NumSamples(inputs[0]);
+  request.enqueue_time = Clock::now();
+  auto done = request.done.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(&request);
+    queued_samples_ += request.num_samples;
+  }
+  cond_.notify_all();
+  return done.get();
+}
+
+void BatchingPredictor::BatchLoop() {
+  while (true) {
+    std::vector<Request*> batch;
+    int batch_size = 0;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [this] { return exit_ || !queue_.empty(); });
+      if (queue_.empty()) return;
+      auto deadline = queue_.front()->enqueue_time +
+                      std::chrono::microseconds(config_.max_delay_us);
+      cond_.wait_until(lock, deadline, [this] {
+        return exit_ || queued_samples_ >= config_.max_batch_size;
+      });
+      // The first request always runs, even if it is larger than a batch,
+      // the others join it while they fit and are compatible.
+      while (!queue_.empty()) {
+        auto* request = queue_.front();
+        if (!batch.empty() &&
+            (batch_size + request->num_samples > config_.max_batch_size ||
+             !Compatible(*batch.front()->inputs, *request->inputs))) {
+          break;
+        }
+        batch.push_back(request);
+        batch_size += request->num_samples;
+        queued_samples_ -= request->num_samples;
+        queue_.pop_front();
+      }
+    }
+    UpdateStats(batch, batch_size);
+    RunBatch(batch, batch_size);
+  }
+}
+
+void BatchingPredictor::RunBatch(const std::vector<Request*>& batch,
+                                 int batch_size) {
+  bool success = true;
+  try {
+    auto& first = *batch.front()->inputs;
+    for (size_t i = 0; i < first.size(); ++i) {
+      std::vector<int> shape = first[i].shape;
+      shape[0] = 0;
+      LoD lod;
+      for (auto* request : batch) {
+        auto& input = (*request->inputs)[i];
+        shape[0] += input.shape[0];
+        AppendLoD(input.lod, &lod);
+      }
+      auto tensor = predictor_->GetInputTensor(first[i].name);
+      PADDLE_ENFORCE_NOT_NULL(tensor, "The predictor does not support "
+                                      "ZeroCopyTensor");
+      tensor->Reshape(shape);
+      auto* dst = static_cast<char*>(MutableData(tensor.get(), first[i].dtype));
+      for (auto* request : batch) {
+        auto& input = (*request->inputs)[i];
+        std::vector<int64_t> dims(input.shape.begin(), input.shape.end());
+        size_t size = NumElements(dims) * PaddleDtypeSize(input.dtype);
+        PADDLE_ENFORCE_GE(input.data.length(), size,
+                          "The data of input %s is too short", input.name);
+        std::memcpy(dst, input.data.data(), size);
+        dst += size;
+      }
+      if (!lod.empty()) {
+        tensor->SetLoD(lod);
+      }
+    }
+
+    PADDLE_ENFORCE(predictor_->ZeroCopyRun(), "Failed to run the batch");
+
+    for (auto* request : batch) {
+      request->outputs->clear();
+      request->outputs->resize(config_.output_names.size());
+    }
+    std::vector<char> buffer;
+    for (size_t i = 0; i < config_.output_names.size(); ++i) {
+      auto& name = config_.output_names[i];
+      auto tensor = predictor_->GetOutputTensor(name);
+      PADDLE_ENFORCE_NOT_NULL(tensor, "The predictor does not support "
+                                      "ZeroCopyTensor");
+      auto shape = tensor->shape();
+      auto lod = tensor->lod();
+      auto dtype = tensor->type();
+      PADDLE_ENFORCE(!shape.empty(), "The output %s is a scalar", name);
+      int64_t numel = NumElements(shape);
+      size_t row_size = (shape[0] == 0 ? 0 : numel / shape[0]) *
+                        PaddleDtypeSize(dtype);
+      buffer.resize(numel * PaddleDtypeSize(dtype));
+      CopyToCPU(tensor.get(), dtype, buffer.data());
+
+      size_t num_samples = lod.empty() ? shape[0] : lod[0].size() - 1;
+      PADDLE_ENFORCE_EQ(num_samples, static_cast<size_t>(batch_size),
+                        "The output %s does not match the samples of batch",
+                        name);
+      size_t sample = 0;
+      for (auto* request : batch) {
+        size_t row_begin = sample;
+        size_t row_end = sample + request->num_samples;
+        auto& output = (*request->outputs)[i];
+        if (!lod.empty()) {
+          output.lod = SliceLoD(lod, sample, row_end, &row_begin, &row_end);
+        }
+        PADDLE_ENFORCE_LE(row_end, static_cast<size_t>(shape[0]),
+                          "The LoD of output %s exceeds its rows", name);
+        output.name = name;
+        output.dtype = dtype;
+        output.shape.assign(shape.begin(), shape.end());
+        output.shape[0] = static_cast<int>(row_end - row_begin);
+        output.data.Resize((row_end - row_begin) * row_size);
+        std::memcpy(output.data.data(), buffer.data() + row_begin * row_size,
+                    (row_end - row_begin) * row_size);
+        sample += request->num_samples;
+      }
+    }
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Failed to run a batch of " << batch.size()
+               << " requests: " << e.what();
+    success = false;
+  }
+  for (auto* request : batch) {
+    request->done.set_value(success);
+  }
+}
+
+void BatchingPredictor::UpdateStats(const std::vector<Request*>& batch,
+                                    int batch_size) {
+  auto now = Clock::now();
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  for (auto* request : batch) {
+    int64_t delay = std::chrono::duration_cast<std::chrono::microseconds>(
+                        now - request->enqueue_time)
+                        .count();
+    total_queue_delay_us_ += delay;
+    stats_.max_queue_delay_us = std::max(stats_.max_queue_delay_us, delay);
+  }
+  stats_.num_requests += batch.size();
+  stats_.num_samples += batch_size;
+  stats_.num_batches += 1;
+  stats_.batch_size_histogram[std::min(batch_size, config_.max_batch_size)] +=
+      1;
+}
+
+BatchingStats BatchingPredictor::GetStats() const {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  BatchingStats stats = stats_;
+  if (stats.num_requests > 0) {
+    stats.avg_queue_delay_us = total_queue_delay_us_ / stats.num_requests;
+  }
+  double seconds =
+      std::chrono::duration<double>(Clock::now() - start_time_).count();
+  if (seconds > 0) {
+    stats.throughput = stats.num_samples / seconds;
+  }
+  return stats;
+}
+
+}  // namespace contrib
+}  // namespace paddle
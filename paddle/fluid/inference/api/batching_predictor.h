@@ -0,0 +1,108 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+
+namespace paddle {
+namespace contrib {
+
+struct BatchingConfig {
+  // The max number of samples merged into one batch.
+  int max_batch_size{32};
+  // The max microseconds the first request of a batch waits for the others.
+  int max_delay_us{1000};
+  // The names of the output tensors returned to the callers.
+  std::vector<std::string> output_names;
+};
+
+struct BatchingStats {
+  int64_t num_requests{0};
+  int64_t num_samples{0};
+  int64_t num_batches{0};
+  // The microseconds the requests wait in the queue before their batches run.
+  double avg_queue_delay_us{0};
+  int64_t max_queue_delay_us{0};
+  // batch_size_histogram[i] is the number of batches of i samples, the
+  // batches larger than max_batch_size are counted in the last bucket.
+  std::vector<int64_t> batch_size_histogram;
+  // The samples processed per second since the predictor was created.
+  double throughput{0};
+};
+
+/*
+ * A front end merging the single requests from many threads into batches.
+ *
+ * The requests are concatenated along dim 0, the LoD of the sequence inputs
+ * is concatenated too, until max_batch_size samples are queued or the first
+ * request waited max_delay_us. The batch is run by one ZeroCopyRun of the
+ * predictor, which should be created with use_feed_fetch_ops off, and the
+ * outputs are split back to the callers.
+ *
+ * The number of samples of a request is the number of its top level
+ * sequences if the first input has LoD, dim 0 of it otherwise. Every output
+ * should have one sample, or one top level sequence, per input sample.
+ */
+class BatchingPredictor {
+ public:
+  BatchingPredictor(std::unique_ptr<PaddlePredictor> predictor,
+                    const BatchingConfig& config);
+  BatchingPredictor(const BatchingPredictor&) = delete;
+  BatchingPredictor& operator=(const BatchingPredictor&) = delete;
+  ~BatchingPredictor();
+
+  // Run one request, thread safe. The inputs should be named, and are only
+  // used until Run returns.
+  bool Run(const std::vector<PaddleTensor>& inputs,
+           std::vector<PaddleTensor>* outputs);
+
+  BatchingStats GetStats() const;
+
+ private:
+  struct Request;
+
+  void BatchLoop();
+
+  void RunBatch(const std::vector<Request*>& batch, int batch_size);
+
+  void UpdateStats(const std::vector<Request*>& batch, int batch_size);
+
+  std::unique_ptr<PaddlePredictor> predictor_;
+  BatchingConfig config_;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<Request*> queue_;
+  // the number of samples in queue_
+  int queued_samples_{0};
+  bool exit_{false};
+  std::thread batch_thread_;
+
+  mutable std::mutex stats_mutex_;
+  BatchingStats stats_;
+  double total_queue_delay_us_{0};
+  std::chrono::steady_clock::time_point start_time_;
+};
+
+}  // namespace contrib
+}  // namespace paddle
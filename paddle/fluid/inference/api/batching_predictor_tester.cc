@@ -0,0 +1,124 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <thread>  // NOLINT
+#include "paddle/fluid/inference/api/batching_predictor.h"
+
+DEFINE_string(dirname, "", "dirname to tests.");
+
+namespace paddle {
+namespace inference {
+using contrib::AnalysisConfig;
+using contrib::BatchingConfig;
+using contrib::BatchingPredictor;
+
+const char* kInputNames[] = {"firstw", "secondw", "thirdw", "forthw"};
+const char* kOutputName = "fc_1.tmp_2";
+
+AnalysisConfig GetConfig() {
+  AnalysisConfig config;
+  config.model_dir = FLAGS_dirname + "/word2vec.inference.model";
+  config.use_feed_fetch_ops = false;
+  return config;
+}
+
+// The request of one sample, which is the word id of every input.
+std::vector<PaddleTensor> MakeRequest(int64_t* words) {
+  std::vector<PaddleTensor> inputs(4);
+  for (int i = 0; i < 4; ++i) {
+    inputs[i].name = kInputNames[i];
+    inputs[i].shape = {1, 1};
+    inputs[i].dtype = PaddleDType::INT64;
+    inputs[i].data.Reset(words + i, sizeof(int64_t));
+  }
+  return inputs;
+}
+
+std::vector<float> RunSingle(PaddlePredictor* predictor, int64_t* words) {
+  for (int i = 0; i < 4; ++i) {
+    auto input = predictor->GetInputTensor(kInputNames[i]);
+    input->Reshape({1, 1});
+    *input->mutable_data<int64_t>(PaddlePlace::kCPU) = words[i];
+  }
+  EXPECT_TRUE(predictor->ZeroCopyRun());
+  auto output = predictor->GetOutputTensor(kOutputName);
+  PaddlePlace place;
+  int size = 0;
+  auto* data = output->data<float>(&place, &size);
+  return std::vector<float>(data, data + size);
+}
+
+TEST(BatchingPredictor, MergeAndSplit) {
+  const int kNumThreads = 8;
+  const int kNumRequests = 16;
+
+  BatchingConfig batching;
+  batching.max_batch_size = 8;
+  batching.max_delay_us = 10000;
+  batching.output_names = {kOutputName};
+  BatchingPredictor batching_predictor(
+      CreatePaddlePredictor<AnalysisConfig>(GetConfig()), batching);
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(GetConfig());
+
+  std::vector<std::vector<int64_t>> words(kNumThreads * kNumRequests);
+  for (size_t i = 0; i < words.size(); ++i) {
+    for (int j = 0; j < 4; ++j) {
+      words[i].push_back((i + j) % 1000);
+    }
+  }
+  std::vector<std::vector<PaddleTensor>> outputs(words.size());
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < kNumThreads; ++tid) {
+    threads.emplace_back([&, tid] {
+      for (int i = 0; i < kNumRequests; ++i) {
+        size_t id = tid * kNumRequests + i;
+        auto inputs = MakeRequest(words[id].data());
+        ASSERT_TRUE(batching_predictor.Run(inputs, &outputs[id]));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  for (size_t i = 0; i < words.size(); ++i) {
+    auto expected = RunSingle(predictor.get(), words[i].data());
+    ASSERT_EQ(outputs[i].size(), 1UL);
+    auto& output = outputs[i][0];
+    ASSERT_EQ(output.shape[0], 1);
+    ASSERT_EQ(output.data.length(), expected.size() * sizeof(float));
+    auto* data = static_cast<float*>(output.data.data());
+    for (size_t j = 0; j < expected.size(); ++j) {
+      EXPECT_NEAR(data[j], expected[j], 1e-5);
+    }
+  }
+
+  auto stats = batching_predictor.GetStats();
+  ASSERT_EQ(stats.num_requests, kNumThreads * kNumRequests);
+  ASSERT_EQ(stats.num_samples, kNumThreads * kNumRequests);
+  ASSERT_LE(stats.num_batches, stats.num_requests);
+  int64_t num_batches = 0;
+  for (size_t i = 0; i < stats.batch_size_histogram.size(); ++i) {
+    num_batches += stats.batch_size_histogram[i];
+  }
+  ASSERT_EQ(num_batches, stats.num_batches);
+  LOG(INFO) << "batches: " << stats.num_batches
+            << ", avg queue delay(us): " << stats.avg_queue_delay_us
+            << ", throughput: " << stats.throughput;
+}
+
+}  // namespace inference
+}  // namespace paddle
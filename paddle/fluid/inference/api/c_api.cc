@@ -0,0 +1,324 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/paddle_c_api.h"
+
+#include <glog/logging.h>
+#include <exception>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/inference/api/analysis_predictor.h"
+
+namespace {
+
+using paddle::framework::LoDTensor;
+
+struct Binding {
+  LoDTensor* tensor{nullptr};
+  void* data{nullptr};
+  size_t capacity{0};
+  std::type_index type{typeid(float)};
+};
+
+std::type_index ToTypeIndex(paddle_infer_dtype dtype) {
+  switch (dtype) {
+    case kPD_INFER_FLOAT32:
+      return typeid(float);
+    case kPD_INFER_INT64:
+      return typeid(int64_t);
+  }
+  PADDLE_THROW("Unsupported data type %d", static_cast<int>(dtype));
+}
+
+}  // namespace
+
+struct paddle_infer_predictor {
+  std::unique_ptr<paddle::PaddlePredictor> holder;
+  paddle::AnalysisPredictor* predictor{nullptr};
+  std::vector<std::string> input_names;
+  std::vector<std::string> output_names;
+  std::vector<Binding> inputs;
+  std::vector<Binding> outputs;
+  std::string last_error;
+
+  void Reset(std::unique_ptr<paddle::PaddlePredictor> p) {
+    holder = std::move(p);
+    predictor = static_cast<paddle::AnalysisPredictor*>(holder.get());
+    input_names = predictor->GetInputNames();
+    output_names = predictor->GetOutputNames();
+    inputs.resize(input_names.size());
+    outputs.resize(output_names.size());
+  }
+
+  LoDTensor* FindTensor(const std::string& name) {
+    auto* var = predictor->scope()->FindVar(name);
+    PADDLE_ENFORCE_NOT_NULL(var, "No variable called %s", name);
+    return var->GetMutable<LoDTensor>();
+  }
+};
+
+namespace {
+
+// Run the function, and turn the exceptions into the status of the call.
+template <typename Func>
+paddle_infer_status Guard(paddle_infer_predictor* predictor, Func&& func) {
+  if (predictor == nullptr) return kPD_INFER_NULLPTR;
+  try {
+    return func();
+  } catch (const std::exception& e) {
+    predictor->last_error = e.what();
+    LOG(ERROR) << predictor->last_error;
+    return kPD_INFER_RUNTIME_ERROR;
+  }
+}
+
+paddle_infer_status Fail(paddle_infer_predictor* predictor,
+                         paddle_infer_status status, const std::string& msg) {
+  predictor->last_error = msg;
+  return status;
+}
+
+}  // namespace
+
+extern "C" {
+
+void paddle_infer_config_init(paddle_infer_config* config) {
+  if (config == nullptr) return;
+  config->model_dir = nullptr;
+  config->prog_file = nullptr;
+  config->param_file = nullptr;
+  config->use_gpu = 0;
+  config->device = 0;
+  config->fraction_of_gpu_memory = 0.5f;
+  config->enable_ir_optim = 1;
+}
+
+paddle_infer_status paddle_infer_predictor_create(
+    const paddle_infer_config* config, paddle_infer_predictor** predictor) {
+  if (config == nullptr || predictor == nullptr) return kPD_INFER_NULLPTR;
+  *predictor = nullptr;
+  paddle::contrib::AnalysisConfig analysis_config;
+  if (config->model_dir != nullptr) {
+    analysis_config.model_dir = config->model_dir;
+  } else if (config->prog_file != nullptr && config->param_file != nullptr) {
+    analysis_config.prog_file = config->prog_file;
+    analysis_config.param_file = config->param_file;
+  } else {
+    return kPD_INFER_NULLPTR;
+  }
+  analysis_config.use_gpu = config->use_gpu != 0;
+  analysis_config.device = config->device;
+  analysis_config.fraction_of_gpu_memory = config->fraction_of_gpu_memory;
+  analysis_config.enable_ir_optim = config->enable_ir_optim != 0;
+  // The inputs and outputs are bound to the variables in the scope directly.
+  analysis_config.use_feed_fetch_ops = false;
+
+  std::unique_ptr<paddle_infer_predictor> res(new paddle_infer_predictor);
+  auto status = Guard(res.get(), [&] {
+    auto p = paddle::CreatePaddlePredictor<paddle::contrib::AnalysisConfig>(
+        analysis_config);
+    if (p == nullptr) return kPD_INFER_RUNTIME_ERROR;
+    res->Reset(std::move(p));
+    return kPD_INFER_OK;
+  });
+  if (status == kPD_INFER_OK) *predictor = res.release();
+  return status;
+}
+
+paddle_infer_status paddle_infer_predictor_clone(
+    paddle_infer_predictor* predictor, paddle_infer_predictor** cloned) {
+  if (cloned == nullptr) return kPD_INFER_NULLPTR;
+  *cloned = nullptr;
+  return Guard(predictor, [&] {
+    std::unique_ptr<paddle_infer_predictor> res(new paddle_infer_predictor);
+    res->Reset(predictor->predictor->Clone());
+    *cloned = res.release();
+    return kPD_INFER_OK;
+  });
+}
+
+void paddle_infer_predictor_destroy(paddle_infer_predictor* predictor) {
+  delete predictor;
+}
+
+const char* paddle_infer_predictor_last_error(
+    const paddle_infer_predictor* predictor) {
+  return predictor == nullptr ? "" : predictor->last_error.c_str();
+}
+
+int paddle_infer_predictor_num_inputs(const paddle_infer_predictor* predictor) {
+  return predictor == nullptr ? 0
+                              : static_cast<int>(predictor->inputs.size());
+}
+
+int paddle_infer_predictor_num_outputs(
+    const paddle_infer_predictor* predictor) {
+  return predictor == nullptr ? 0
+                              : static_cast<int>(predictor->outputs.size());
+}
+
+const char* paddle_infer_predictor_input_name(
+    const paddle_infer_predictor* predictor, int index) {
+  if (predictor == nullptr || index < 0 ||
+      index >= static_cast<int>(predictor->input_names.size())) {
+    return nullptr;
+  }
+  return predictor->input_names[index].c_str();
+}
+
+const char* paddle_infer_predictor_output_name(
+    const paddle_infer_predictor* predictor, int index) {
+  if (predictor == nullptr || index < 0 ||
+      index >= static_cast<int>(predictor->output_names.size())) {
+    return nullptr;
+  }
+  return predictor->output_names[index].c_str();
+}
+
+paddle_infer_status paddle_infer_predictor_bind_input(
+    paddle_infer_predictor* predictor, int index, paddle_infer_dtype dtype,
+    void* data, size_t capacity) {
+  return Guard(predictor, [&] {
+    if (data == nullptr) return kPD_INFER_NULLPTR;
+    if (index < 0 || index >= static_cast<int>(predictor->inputs.size())) {
+      return Fail(predictor, kPD_INFER_OUT_OF_RANGE, "Invalid input index");
+    }
+    auto& binding = predictor->inputs[index];
+    binding.tensor = predictor->FindTensor(predictor->input_names[index]);
+    binding.data = data;
+    binding.capacity = capacity;
+    binding.type = ToTypeIndex(dtype);
+    // The operators only read the inputs, a writer would copy the buffer
+    // instead of changing the data of the caller.
+    binding.tensor->ShareExternalData(data, capacity, binding.type, nullptr,
+                                      true);
+    binding.tensor->set_lod({});
+    return kPD_INFER_OK;
+  });
+}
+
+paddle_infer_status paddle_infer_predictor_bind_output(
+    paddle_infer_predictor* predictor, int index, paddle_infer_dtype dtype,
+    void* data, size_t capacity) {
+  return Guard(predictor, [&] {
+    if (data == nullptr) return kPD_INFER_NULLPTR;
+    if (index < 0 || index >= static_cast<int>(predictor->outputs.size())) {
+      return Fail(predictor, kPD_INFER_OUT_OF_RANGE, "Invalid output index");
+    }
+    auto& binding = predictor->outputs[index];
+    binding.tensor = predictor->FindTensor(predictor->output_names[index]);
+    binding.data = data;
+    binding.capacity = capacity;
+    binding.type = ToTypeIndex(dtype);
+    binding.tensor->ShareExternalData(data, capacity, binding.type, nullptr,
+                                      false);
+    return kPD_INFER_OK;
+  });
+}
+
+paddle_infer_status paddle_infer_predictor_set_input_shape(
+    paddle_infer_predictor* predictor, int index, const int64_t* shape,
+    int rank) {
+  return Guard(predictor, [&] {
+    if (shape == nullptr) return kPD_INFER_NULLPTR;
+    if (index < 0 || index >= static_cast<int>(predictor->inputs.size())) {
+      return Fail(predictor, kPD_INFER_OUT_OF_RANGE, "Invalid input index");
+    }
+    auto& binding = predictor->inputs[index];
+    if (binding.tensor == nullptr) {
+      return Fail(predictor, kPD_INFER_NOT_FOUND, "The input is not bound");
+    }
+    paddle::framework::DDim dims(shape, rank);
+    size_t bytes = paddle::framework::product(dims) *
+                   paddle::framework::SizeOfType(binding.type);
+    if (bytes > binding.capacity) {
+      return Fail(predictor, kPD_INFER_OUT_OF_RANGE,
+                  "The input shape exceeds the bound buffer");
+    }
+    binding.tensor->Resize(dims);
+    return kPD_INFER_OK;
+  });
+}
+
+paddle_infer_status paddle_infer_predictor_output_shape(
+    const paddle_infer_predictor* predictor, int index, int64_t* shape,
+    int* rank) {
+  auto* p = const_cast<paddle_infer_predictor*>(predictor);
+  return Guard(p, [&] {
+    if (shape == nullptr || rank == nullptr) return kPD_INFER_NULLPTR;
+    if (index < 0 || index >= static_cast<int>(p->outputs.size())) {
+      return Fail(p, kPD_INFER_OUT_OF_RANGE, "Invalid output index");
+    }
+    auto* tensor = p->outputs[index].tensor;
+    if (tensor == nullptr) tensor = p->FindTensor(p->output_names[index]);
+    auto dims = tensor->dims();
+    if (dims.size() > *rank) {
+      return Fail(p, kPD_INFER_OUT_OF_RANGE, "The shape buffer is too small");
+    }
+    for (int i = 0; i < dims.size(); ++i) {
+      shape[i] = dims[i];
+    }
+    *rank = dims.size();
+    return kPD_INFER_OK;
+  });
+}
+
+paddle_infer_status paddle_infer_predictor_run(
+    paddle_infer_predictor* predictor) {
+  return Guard(predictor, [&] {
+    for (auto& binding : predictor->inputs) {
+      if (binding.tensor == nullptr) {
+        return Fail(predictor, kPD_INFER_NOT_FOUND, "An input is not bound");
+      }
+    }
+    predictor->predictor->ZeroCopyRun();
+
+    for (auto& binding : predictor->outputs) {
+      if (binding.tensor == nullptr) continue;
+      auto& tensor = *binding.tensor;
+      // Written in place by the operator.
+      if (paddle::platform::is_cpu_place(tensor.place()) &&
+          tensor.data<void>() == binding.data) {
+        continue;
+      }
+      if (tensor.type() != binding.type) {
+        return Fail(predictor, kPD_INFER_RUNTIME_ERROR,
+                    "The output type does not match the bound buffer");
+      }
+      size_t bytes = tensor.numel() * paddle::framework::SizeOfType(
+                                          binding.type);
+      if (bytes > binding.capacity) {
+        return Fail(predictor, kPD_INFER_OUT_OF_RANGE,
+                    "The output exceeds the bound buffer");
+      }
+      // Copy into a view of the buffer, which is large enough to not be
+      // reallocated.
+      paddle::framework::Tensor dst;
+      dst.ShareExternalData(binding.data, binding.capacity, binding.type,
+                            nullptr, false);
+      dst.Resize(tensor.dims());
+      paddle::framework::TensorCopySync(tensor, paddle::platform::CPUPlace(),
+                                        &dst);
+    }
+    return kPD_INFER_OK;
+  });
+}
+
+}  // extern "C"
@@ -0,0 +1,111 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "paddle/fluid/inference/api/paddle_c_api.h"
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+
+DEFINE_string(dirname, "", "dirname to tests.");
+
+namespace paddle {
+namespace inference {
+
+TEST(CApi, BoundBuffers) {
+  std::string model_dir = FLAGS_dirname + "/word2vec.inference.model";
+
+  // The reference output of the C++ zero copy API.
+  contrib::AnalysisConfig config;
+  config.model_dir = model_dir;
+  config.use_feed_fetch_ops = false;
+  auto ref = CreatePaddlePredictor<contrib::AnalysisConfig>(config);
+  for (auto& name : {"firstw", "secondw", "thirdw", "forthw"}) {
+    auto input = ref->GetInputTensor(name);
+    input->Reshape({4, 1});
+    auto* data = input->mutable_data<int64_t>(PaddlePlace::kCPU);
+    for (int i = 0; i < 4; i++) {
+      data[i] = i;
+    }
+  }
+  ASSERT_TRUE(ref->ZeroCopyRun());
+  auto ref_out = ref->GetOutputTensor("fc_1.tmp_2");
+  PaddlePlace place;
+  int ref_size = 0;
+  auto* ref_data = ref_out->data<float>(&place, &ref_size);
+
+  paddle_infer_config c_config;
+  paddle_infer_config_init(&c_config);
+  c_config.model_dir = model_dir.c_str();
+  paddle_infer_predictor* predictor = nullptr;
+  ASSERT_EQ(paddle_infer_predictor_create(&c_config, &predictor),
+            kPD_INFER_OK);
+  ASSERT_EQ(paddle_infer_predictor_num_inputs(predictor), 4);
+  ASSERT_EQ(paddle_infer_predictor_num_outputs(predictor), 1);
+  EXPECT_EQ(std::string(paddle_infer_predictor_output_name(predictor, 0)),
+            "fc_1.tmp_2");
+
+  std::vector<std::vector<int64_t>> inputs(4, std::vector<int64_t>(8));
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(paddle_infer_predictor_bind_input(
+                  predictor, i, kPD_INFER_INT64, inputs[i].data(),
+                  inputs[i].size() * sizeof(int64_t)),
+              kPD_INFER_OK);
+  }
+  std::vector<float> output(ref_size / sizeof(float));
+  ASSERT_EQ(paddle_infer_predictor_bind_output(predictor, 0, kPD_INFER_FLOAT32,
+                                               output.data(), ref_size),
+            kPD_INFER_OK);
+
+  // The buffers are bound once and reused by the runs.
+  const int64_t shape[] = {4, 1};
+  for (int run = 0; run < 3; ++run) {
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 0; j < 4; ++j) {
+        inputs[i][j] = j;
+      }
+      ASSERT_EQ(paddle_infer_predictor_set_input_shape(predictor, i, shape, 2),
+                kPD_INFER_OK);
+    }
+    ASSERT_EQ(paddle_infer_predictor_run(predictor), kPD_INFER_OK);
+    for (size_t i = 0; i < output.size(); ++i) {
+      EXPECT_NEAR(output[i], ref_data[i], 1e-5);
+    }
+  }
+
+  int64_t out_shape[4];
+  int rank = 4;
+  ASSERT_EQ(
+      paddle_infer_predictor_output_shape(predictor, 0, out_shape, &rank),
+      kPD_INFER_OK);
+  EXPECT_EQ(rank, 2);
+  EXPECT_EQ(out_shape[0], 4);
+
+  // The shapes beyond the bound buffers are rejected.
+  const int64_t large_shape[] = {16, 1};
+  EXPECT_EQ(
+      paddle_infer_predictor_set_input_shape(predictor, 0, large_shape, 2),
+      kPD_INFER_OUT_OF_RANGE);
+
+  paddle_infer_predictor* cloned = nullptr;
+  ASSERT_EQ(paddle_infer_predictor_clone(predictor, &cloned), kPD_INFER_OK);
+  EXPECT_EQ(paddle_infer_predictor_run(cloned), kPD_INFER_NOT_FOUND);
+  paddle_infer_predictor_destroy(cloned);
+  paddle_infer_predictor_destroy(predictor);
+}
+
+}  // namespace inference
+}  // namespace paddle
@@ -12,9 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstring>
+#include <typeindex>
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
@@ -67,10 +71,48 @@ T *ZeroCopyTensor::data(PaddlePlace *place, int *size) {
   return res;
 }
 
+template <typename T>
+void ZeroCopyTensor::copy_to_cpu(T *data) {
+  auto *tensor = static_cast<framework::LoDTensor *>(FindTensor());
+  auto *src = tensor->data<T>();
+  size_t size = tensor->numel() * sizeof(T);
+
+  if (platform::is_cpu_place(tensor->place())) {
+    std::memcpy(static_cast<void *>(data), src, size);
+  } else if (platform::is_gpu_place(tensor->place())) {
+#ifdef PADDLE_WITH_CUDA
+    auto gpu_place = boost::get<platform::CUDAPlace>(tensor->place());
+    auto *dev_ctx = static_cast<const platform::CUDADeviceContext *>(
+        platform::DeviceContextPool::Instance().Get(gpu_place));
+    memory::Copy(platform::CPUPlace(), static_cast<void *>(data), gpu_place,
+                 src, size, dev_ctx->stream());
+    dev_ctx->Wait();
+#else
+    PADDLE_THROW("Not compiled with CUDA, should not reach here.");
+#endif
+  } else {
+    PADDLE_THROW("Unsupported place: %s", tensor->place());
+  }
+}
+
+PaddleDType ZeroCopyTensor::type() const {
+  auto *tensor = static_cast<framework::LoDTensor *>(FindTensor());
+  auto type = tensor->type();
+  if (type == typeid(float)) {
+    return PaddleDType::FLOAT32;
+  } else if (type == typeid(int64_t)) {
+    return PaddleDType::INT64;
+  }
+  PADDLE_THROW("Unsupported data type of tensor [%s]", name_);
+  return PaddleDType::FLOAT32;
+}
+
 template float *ZeroCopyTensor::data<float>(PaddlePlace *place, int *size);
 template int64_t *ZeroCopyTensor::data<int64_t>(PaddlePlace *place, int *size);
 template float *ZeroCopyTensor::mutable_data<float>(PaddlePlace place);
 template int64_t *ZeroCopyTensor::mutable_data<int64_t>(PaddlePlace place);
+template void ZeroCopyTensor::copy_to_cpu<float>(float *data);
+template void ZeroCopyTensor::copy_to_cpu<int64_t>(int64_t *data);
 
 void *ZeroCopyTensor::FindTensor() const {
   PADDLE_ENFORCE(!name_.empty(),
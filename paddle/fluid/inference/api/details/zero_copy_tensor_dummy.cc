@@ -28,10 +28,17 @@ T *ZeroCopyTensor::data(PaddlePlace *place, int *size) {
   return nullptr;
 }
 
+template <typename T>
+void ZeroCopyTensor::copy_to_cpu(T *data) {}
+
+PaddleDType ZeroCopyTensor::type() const { return PaddleDType::FLOAT32; }
+
 template float *ZeroCopyTensor::data<float>(PaddlePlace *place, int *size);
 template int64_t *ZeroCopyTensor::data<int64_t>(PaddlePlace *place, int *size);
 template float *ZeroCopyTensor::mutable_data(PaddlePlace place);
 template int64_t *ZeroCopyTensor::mutable_data(PaddlePlace place);
+template void ZeroCopyTensor::copy_to_cpu<float>(float *data);
+template void ZeroCopyTensor::copy_to_cpu<int64_t>(int64_t *data);
 
 void *ZeroCopyTensor::FindTensor() const { return nullptr; }
 
@@ -0,0 +1,187 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/model_manager.h"
+
+#include <glog/logging.h>
+#include <sys/stat.h>
+#include <utility>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/inference/api/analysis_predictor.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace contrib {
+
+namespace {
+
+// The bytes of the tensors in the scopes of the predictor, which are the
+// parameters right after it is created.
+size_t PredictorBytes(PaddlePredictor* predictor) {
+  size_t bytes = 0;
+  const framework::Scope* scope =
+      static_cast<AnalysisPredictor*>(predictor)->scope();
+  for (; scope != nullptr; scope = scope->parent()) {
+    for (auto& name : scope->LocalVarNames()) {
+      auto* var = scope->FindLocalVar(name);
+      if (var && var->IsType<framework::LoDTensor>()) {
+        bytes += var->Get<framework::LoDTensor>().memory_size();
+      }
+    }
+  }
+  return bytes;
+}
+
+}  // namespace
+
+ModelManager::ModelManager(size_t memory_budget, const std::string& cache_dir)
+    : memory_budget_(memory_budget), cache_dir_(cache_dir) {
+  PADDLE_ENFORCE(!cache_dir_.empty(),
+                 "The model manager needs a directory to cache the models");
+  mkdir(cache_dir_.c_str(), 0755);
+}
+
+bool ModelManager::Register(const std::string& name,
+                            const AnalysisConfig& config) {
+  auto model = std::make_shared<Model>();
+  model->config = config;
+  if (model->config.opt_cache_dir.empty()) {
+    model->config.opt_cache_dir = cache_dir_;
+  }
+  if (!model->config.enable_ir_optim) {
+    LOG(WARNING) << "the model " << name
+                 << " is not optimized, loading it reads the original model";
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PADDLE_ENFORCE(models_.count(name) == 0, "The model %s is registered",
+                   name);
+    models_[name] = model;
+  }
+  // The first load optimizes the model and writes the cache.
+  std::lock_guard<std::mutex> load_lock(model->load_mutex);
+  if (Load(name, model.get()) == nullptr) {
+    Unregister(name);
+    return false;
+  }
+  return true;
+}
+
+void ModelManager::Unregister(const std::string& name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = models_.find(name);
+  if (it == models_.end()) return;
+  auto& model = *it->second;
+  if (model.predictor) {
+    lru_.erase(model.lru);
+    resident_bytes_ -= model.bytes;
+  }
+  models_.erase(it);
+}
+
+std::unique_ptr<PaddlePredictor> ModelManager::Acquire(
+    const std::string& name) {
+  std::shared_ptr<Model> model;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = models_.find(name);
+    if (it == models_.end()) {
+      LOG(ERROR) << "the model " << name << " is not registered";
+      return nullptr;
+    }
+    model = it->second;
+  }
+
+  std::shared_ptr<PaddlePredictor> predictor;
+  {
+    std::lock_guard<std::mutex> load_lock(model->load_mutex);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      predictor = model->predictor;
+      if (predictor) {
+        lru_.splice(lru_.begin(), lru_, model->lru);
+      }
+    }
+    if (!predictor) {
+      predictor = Load(name, model.get());
+      if (!predictor) return nullptr;
+    }
+  }
+  // The clone keeps the scope and the operators of the model alive.
+  return predictor->Clone();
+}
+
+std::shared_ptr<PaddlePredictor> ModelManager::Load(const std::string& name,
+                                                    Model* model) {
+  std::shared_ptr<PaddlePredictor> predictor(
+      CreatePaddlePredictor<AnalysisConfig>(model->config));
+  if (!predictor) {
+    LOG(ERROR) << "fail to load the model " << name;
+    return nullptr;
+  }
+  size_t bytes = PredictorBytes(predictor.get());
+  VLOG(3) << "load the model " << name << " of " << bytes << " bytes";
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++num_loads_;
+  // The model may have been unregistered while loading.
+  auto it = models_.find(name);
+  if (it == models_.end() || it->second.get() != model) return predictor;
+  model->predictor = predictor;
+  model->bytes = bytes;
+  lru_.push_front(name);
+  model->lru = lru_.begin();
+  resident_bytes_ += bytes;
+  EvictLocked();
+  return predictor;
+}
+
+void ModelManager::EvictLocked() {
+  if (memory_budget_ == 0) return;
+  while (resident_bytes_ > memory_budget_ && lru_.size() > 1UL) {
+    auto name = lru_.back();
+    auto& model = *models_.at(name);
+    VLOG(3) << "evict the model " << name << " of " << model.bytes
+            << " bytes";
+    lru_.pop_back();
+    resident_bytes_ -= model.bytes;
+    model.predictor.reset();
+    model.bytes = 0;
+  }
+  if (resident_bytes_ > memory_budget_) {
+    LOG(WARNING) << "the resident models take " << resident_bytes_
+                 << " bytes, more than the budget of " << memory_budget_;
+  }
+}
+
+bool ModelManager::IsResident(const std::string& name) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = models_.find(name);
+  return it != models_.end() && it->second->predictor != nullptr;
+}
+
+size_t ModelManager::resident_bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return resident_bytes_;
+}
+
+size_t ModelManager::num_loads() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_loads_;
+}
+
+}  // namespace contrib
+}  // namespace paddle
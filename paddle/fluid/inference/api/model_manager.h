@@ -0,0 +1,94 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+
+namespace paddle {
+namespace contrib {
+
+/*
+ * A host of more models than the memory holds as predictors at once.
+ *
+ * A registered model is optimized once into the optimized program cache of
+ * the manager, so that loading it again only reads the optimized program and
+ * maps its parameters, without running the IR passes or copying the weights.
+ * The predictors are created when their model is acquired, and the least
+ * recently used ones are released once the memory of the resident models
+ * exceeds the budget. The predictors all share the device contexts and the
+ * allocators of the process.
+ *
+ * It is thread safe.
+ */
+class ModelManager {
+ public:
+  // memory_budget is the bytes of the parameters of the resident models, 0
+  // for no limit. The optimized programs are cached in cache_dir, unless the
+  // config of a model has its own opt_cache_dir.
+  ModelManager(size_t memory_budget, const std::string& cache_dir);
+  ModelManager(const ModelManager&) = delete;
+  ModelManager& operator=(const ModelManager&) = delete;
+
+  // Register the model of config as name, and optimize it. The model stays
+  // resident until it is evicted.
+  bool Register(const std::string& name, const AnalysisConfig& config);
+  void Unregister(const std::string& name);
+
+  // A predictor of the model for the calling thread, which shares the
+  // parameters of the resident model, loading the model if it is not
+  // resident. The evicted model is freed once its predictors are deleted.
+  // nullptr if the model is not registered or fails to load.
+  std::unique_ptr<PaddlePredictor> Acquire(const std::string& name);
+
+  bool IsResident(const std::string& name) const;
+  size_t resident_bytes() const;
+  // The loads of the models not resident, including the registrations.
+  size_t num_loads() const;
+
+ private:
+  struct Model {
+    AnalysisConfig config;
+    // Serialize the loads of the model.
+    std::mutex load_mutex;
+    // Guarded by mutex_.
+    std::shared_ptr<PaddlePredictor> predictor;
+    size_t bytes{0};
+    std::list<std::string>::iterator lru;
+  };
+
+  // Load the model without the lock, and make it the most recently used.
+  std::shared_ptr<PaddlePredictor> Load(const std::string& name,
+                                        Model* model);
+  // Release the least recently used models but the most recent one until
+  // the resident ones fit in the budget. Requires mutex_.
+  void EvictLocked();
+
+  size_t memory_budget_;
+  std::string cache_dir_;
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, std::shared_ptr<Model>> models_;
+  // The names of the resident models, the most recently used first.
+  std::list<std::string> lru_;
+  size_t resident_bytes_{0};
+  size_t num_loads_{0};
+};
+
+}  // namespace contrib
+}  // namespace paddle
@@ -0,0 +1,151 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+/*
+ * This file contains a lightweight C inference API for the embedded
+ * deployments. A predictor is an opaque handle, the caller binds its own
+ * buffers to the inputs and outputs once, then each run only sets the input
+ * shapes and executes the program, without allocating the I/O tensors.
+ *
+ * A typical usage:
+ *
+ *   paddle_infer_config config;
+ *   paddle_infer_config_init(&config);
+ *   config.model_dir = "./model";
+ *   paddle_infer_predictor* predictor = NULL;
+ *   paddle_infer_predictor_create(&config, &predictor);
+ *   paddle_infer_predictor_bind_input(predictor, 0, kPD_INFER_FLOAT32,
+ *                                     input, sizeof(input));
+ *   paddle_infer_predictor_bind_output(predictor, 0, kPD_INFER_FLOAT32,
+ *                                      output, sizeof(output));
+ *   for (each request) {
+ *     paddle_infer_predictor_set_input_shape(predictor, 0, shape, 2);
+ *     paddle_infer_predictor_run(predictor);
+ *   }
+ *   paddle_infer_predictor_destroy(predictor);
+ */
+
+#ifndef PADDLE_FLUID_INFERENCE_API_PADDLE_C_API_H_
+#define PADDLE_FLUID_INFERENCE_API_PADDLE_C_API_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define PD_INFER_API __declspec(dllexport)
+#else
+#define PD_INFER_API __attribute__((visibility("default")))
+#endif
+
+typedef enum {
+  kPD_INFER_OK = 0,
+  kPD_INFER_NULLPTR = 1,
+  kPD_INFER_OUT_OF_RANGE = 2,
+  kPD_INFER_NOT_FOUND = 3,
+  kPD_INFER_RUNTIME_ERROR = 4,
+} paddle_infer_status;
+
+typedef enum {
+  kPD_INFER_FLOAT32 = 0,
+  kPD_INFER_INT64 = 1,
+} paddle_infer_dtype;
+
+typedef struct {
+  /* The directory of the model, or NULL to load prog_file and param_file. */
+  const char* model_dir;
+  const char* prog_file;
+  const char* param_file;
+  int use_gpu;
+  int device;
+  float fraction_of_gpu_memory;
+  int enable_ir_optim;
+} paddle_infer_config;
+
+typedef struct paddle_infer_predictor paddle_infer_predictor;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Fill the config with the defaults: CPU, with the IR optimization. */
+PD_INFER_API void paddle_infer_config_init(paddle_infer_config* config);
+
+PD_INFER_API paddle_infer_status paddle_infer_predictor_create(
+    const paddle_infer_config* config, paddle_infer_predictor** predictor);
+
+/*
+ * Create a predictor sharing the parameters with the given one, to run on
+ * another thread. The bindings are not cloned.
+ */
+PD_INFER_API paddle_infer_status paddle_infer_predictor_clone(
+    paddle_infer_predictor* predictor, paddle_infer_predictor** cloned);
+
+PD_INFER_API void paddle_infer_predictor_destroy(
+    paddle_infer_predictor* predictor);
+
+/* The error message of the last failed call on the predictor. */
+PD_INFER_API const char* paddle_infer_predictor_last_error(
+    const paddle_infer_predictor* predictor);
+
+/* The inputs and outputs are indexed in the order of the feeds and fetches
+ * of the program. */
+PD_INFER_API int paddle_infer_predictor_num_inputs(
+    const paddle_infer_predictor* predictor);
+PD_INFER_API int paddle_infer_predictor_num_outputs(
+    const paddle_infer_predictor* predictor);
+PD_INFER_API const char* paddle_infer_predictor_input_name(
+    const paddle_infer_predictor* predictor, int index);
+PD_INFER_API const char* paddle_infer_predictor_output_name(
+    const paddle_infer_predictor* predictor, int index);
+
+/*
+ * Bind a buffer of `capacity` bytes owned by the caller to an input. The
+ * buffer must outlive the predictor or the next binding of the input, and is
+ * read in place by the following runs.
+ */
+PD_INFER_API paddle_infer_status paddle_infer_predictor_bind_input(
+    paddle_infer_predictor* predictor, int index, paddle_infer_dtype dtype,
+    void* data, size_t capacity);
+
+/*
+ * Bind a buffer of `capacity` bytes owned by the caller to an output. The
+ * operator producing the output writes it in place when it runs on CPU,
+ * otherwise the output is copied into the buffer after each run.
+ */
+PD_INFER_API paddle_infer_status paddle_infer_predictor_bind_output(
+    paddle_infer_predictor* predictor, int index, paddle_infer_dtype dtype,
+    void* data, size_t capacity);
+
+/* Set the shape of the data in the bound buffer of an input. */
+PD_INFER_API paddle_infer_status paddle_infer_predictor_set_input_shape(
+    paddle_infer_predictor* predictor, int index, const int64_t* shape,
+    int rank);
+
+/*
+ * Get the shape of an output of the last run. `rank` is the capacity of
+ * `shape` when called, and is set to the rank of the output.
+ */
+PD_INFER_API paddle_infer_status paddle_infer_predictor_output_shape(
+    const paddle_infer_predictor* predictor, int index, int64_t* shape,
+    int* rank);
+
+/* Run the program on the bound inputs, and fill the bound outputs. */
+PD_INFER_API paddle_infer_status
+paddle_infer_predictor_run(paddle_infer_predictor* predictor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PADDLE_FLUID_INFERENCE_API_PADDLE_C_API_H_
@@ -22,6 +22,7 @@ limitations under the License. */
 #pragma once
 
 #include <cassert>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -120,6 +121,15 @@ class ZeroCopyTensor {
 
   std::vector<int64_t> shape();
 
+  // The data type of the tensor, only FLOAT32 and INT64 are supported.
+  PaddleDType type() const;
+
+  // Copy the data of the tensor to the CPU memory, which should hold
+  // numel elements.
+  // This is for reading the output tensor which might live in GPU.
+  template <typename T>
+  void copy_to_cpu(T* data);
+
   void SetLoD(const std::vector<std::vector<size_t>>& x);
   std::vector<std::vector<size_t>> lod() const;
 
@@ -167,10 +177,49 @@ class PaddlePredictor {
   }
   virtual bool ZeroCopyRun() { return false; }
 
+  // Run the batches of inputs, each one is the inputs of a Run with the
+  // shapes of the requests to serve, and discard the outputs. The memory,
+  // the kernels and the caches they need are ready for the next runs.
+  virtual bool Warmup(const std::vector<std::vector<PaddleTensor>>& inputs) {
+    std::vector<PaddleTensor> outputs;
+    for (auto& batch : inputs) {
+      if (!Run(batch, &outputs)) return false;
+    }
+    return true;
+  }
+  // Whether the predictor has finished its warm-up and serves at the steady
+  // speed.
+  virtual bool IsReady() const { return true; }
+
+  // Replace the values of the parameters with the ones saved for the same
+  // program, in param_file if it is not empty, or else in the separate files
+  // of model_dir, keeping the optimized program, the prepared operators and
+  // their caches. The new values are loaded aside, then switched to between
+  // the runs of the predictor and its clones, which see either all the old
+  // values or all the new ones.
+  virtual bool ReloadParams(const std::string& model_dir,
+                            const std::string& param_file = "") {
+    return false;
+  }
+
   // Clone a predictor that share the model weights, the Cloned predictor should
   // be thread-safe.
   virtual std::unique_ptr<PaddlePredictor> Clone() = 0;
 
+  // Create a session of streaming inference, e.g. on the chunks of an audio.
+  // Like a clone, it shares the model weights and runs in its own scope.
+  // `states` maps the feed target of each state, e.g. the initial hidden
+  // state of an RNN, to the fetch target whose value it takes in the next
+  // run. These feeds and fetches are dropped from the runs of the session, so
+  // the states stay in its scope on the device, and only the other feeds,
+  // in their order, are passed to Run. `initial_states` are the values of
+  // the states in the first run, by their names.
+  virtual std::unique_ptr<PaddlePredictor> CreateSession(
+      const std::map<std::string, std::string>& states,
+      const std::vector<PaddleTensor>& initial_states) {
+    return nullptr;
+  }
+
   // Destroy the Predictor.
   virtual ~PaddlePredictor() = default;
 
@@ -216,7 +265,8 @@ enum class PaddleEngineKind {
   kNative = 0,         // Use the native Fluid facility.
   kAutoMixedTensorRT,  // Automatically mix Fluid with TensorRT.
   kAnalysis,           // More optimization.
-  kAnakin              // Use Anakin for inference, not mature yet.
+  kAnakin,             // Use Anakin for inference, not mature yet.
+  kAutoMixedAnakin     // Automatically mix Fluid with Anakin.
 };
 
 template <typename ConfigT, PaddleEngineKind engine>
@@ -246,9 +296,25 @@ struct MixedRTConfig : public NativeConfig {
   //  We set this variable to control the minimum number of nodes in the
   //  subgraph, 3 as default value.
   int minimum_subgraph_size = 3;
-  // Reserved configuration
-  // We just support "FP32" now, "FP16" and "INT8" will be supported.
+  // "FP32" or "INT8", "FP16" will be supported. The INT8 engines are
+  // calibrated with int8_calibration_data when the predictor is created, and
+  // the calibration tables are cached with the engines if
+  // FLAGS_tensorrt_engine_cache_dir is set, so that the later processes need
+  // no calibration data. NOT stable yet.
   std::string precision_mode = "FP32";
+  // The feeds of the calibration runs, each is the inputs of a Run.
+  std::vector<std::vector<PaddleTensor>> int8_calibration_data;
+};
+
+// Offload the subgraphs supported by Anakin to the Anakin engines, the other
+// operators run in fluid. The engines run on the GPU if use_gpu, otherwise on
+// the X86 CPU.
+struct MixedAnakinConfig : public NativeConfig {
+  // The maximum batch size of the inputs, the engines reserve the memory for
+  // it when building.
+  int max_batch_size{1};
+  // The minimum number of the operators in a subgraph run by Anakin.
+  int minimum_subgraph_size = 3;
 };
 
 // NOTE WIP, not stable yet.
@@ -272,6 +338,78 @@ struct AnalysisConfig : public NativeConfig {
   // NOTE this is just for internal development, please not use it.
   // NOT stable yet.
   bool _use_mkldnn{false};
+
+  // Quantize the conv2d and pool2d run by MKLDNN to INT8 after the IR
+  // optimization, by the ranges of the variables calibrated on
+  // int8_calibration_data. It requires _use_mkldnn on CPU.
+  // NOT stable yet.
+  bool enable_int8{false};
+  // The batches of inputs to calibrate, each one is the inputs of a Run.
+  std::vector<std::vector<PaddleTensor>> int8_calibration_data;
+  // "KL" clips the outliers of the activations, "max" keeps the whole range.
+  std::string int8_scale_algo{"KL"};
+
+  // Run the operators having float16 CUDA kernels in half precision, the
+  // weights are cast to float16 once after loading. It requires use_gpu.
+  // NOT stable yet.
+  bool enable_fp16{false};
+
+  // Run the operators having bfloat16 CPU kernels, mul, fc, conv2d and the
+  // elementwise and activation ops, in bfloat16 with the GEMMs accumulating
+  // in float, the weights are cast to bfloat16 once after loading. It
+  // requires CPU, the operators run by MKLDNN keep float.
+  // NOT stable yet.
+  bool enable_bf16{false};
+
+  // Run the chains of the cudnn conv2d in the NHWC layout, the filters are
+  // transposed once after loading. It requires use_gpu, and the cudnn conv2d
+  // runs on the tensor cores with enable_fp16.
+  // NOT stable yet.
+  bool enable_nhwc{false};
+
+  // Quantize the embedding tables only read by lookup_table to
+  // "int8_rowwise", the uint8 codes with a float scale and bias per row, or
+  // to "float16" once after loading, and dequantize the rows looked up. It
+  // requires CPU. Empty to keep the tables in float.
+  // NOT stable yet.
+  std::string embedding_table_format;
+
+  // Run the mul and fc of the pruned weights, which have at least 70% zero
+  // blocks of 16 or 4 outputs, on the block-sparse weights, skipping the zero
+  // blocks, if it is faster than the dense GEMM. The weights are converted
+  // once after loading, and the speedups are logged. It requires CPU.
+  // NOT stable yet.
+  bool enable_block_sparse_weights{false};
+
+  // The directory caching the optimized programs and their parameters. The
+  // IR optimization is skipped if the same model was optimized with the same
+  // passes before. The cache is keyed by the program, the timestamps of the
+  // parameter files and the options of the optimization. The cached
+  // parameters are mapped into memory on CPU rather than read.
+  // NOT stable yet.
+  std::string opt_cache_dir;
+
+  // Run the predictor on the CPUs of the NUMA node, and allocate its CPU
+  // memory from the node. The threads calling Run and ZeroCopyRun are bound
+  // to the node. The clones are spread over the nodes round-robin starting
+  // from it. -1 to not bind.
+  // NOT stable yet.
+  int numa_node{-1};
+  // Copy the parameters into the memory of the node of each clone bound to
+  // another node, rather than sharing the ones of the main predictor.
+  // NOT stable yet.
+  bool replicate_params_per_numa_node{false};
+
+  // The batches of inputs to warm up the predictor and its clones with once
+  // they are created, each one is the inputs of a Run with the shapes of the
+  // requests to serve. The runs grow the memory pools, search the cuDNN
+  // algorithms, create the MKLDNN primitives and generate the JIT kernels of
+  // the shapes, so that the first requests run at the steady speed.
+  std::vector<std::vector<PaddleTensor>> warmup_data;
+  // Warm up on a background thread, so that the creation returns at once.
+  // IsReady tells whether the warm-up has finished, the calls to Run,
+  // ZeroCopyRun and the zero copy tensors wait for it.
+  bool warmup_in_background{false};
 };
 
 // Configurations for Anakin engine.
@@ -0,0 +1,45 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/predictor_pool.h"
+
+#include <utility>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace contrib {
+
+PredictorPool::PredictorPool(std::unique_ptr<PaddlePredictor> main,
+                             size_t size) {
+  PADDLE_ENFORCE_NOT_NULL(main, "The main predictor of the pool is null");
+  PADDLE_ENFORCE_GT(size, 0UL, "The pool should hold one predictor at least");
+  predictors_.reserve(size);
+  predictors_.emplace_back(std::move(main));
+  for (size_t i = 1; i < size; ++i) {
+    auto predictor = predictors_.front()->Clone();
+    PADDLE_ENFORCE_NOT_NULL(predictor, "Failed to clone the %d-th predictor",
+                            i);
+    predictors_.emplace_back(std::move(predictor));
+  }
+}
+
+PaddlePredictor* PredictorPool::Retrieve(size_t idx) {
+  PADDLE_ENFORCE_LT(idx, predictors_.size(),
+                    "The pool only has %d predictors", predictors_.size());
+  return predictors_[idx].get();
+}
+
+}  // namespace contrib
+}  // namespace paddle
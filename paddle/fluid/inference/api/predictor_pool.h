@@ -0,0 +1,51 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+
+namespace paddle {
+namespace contrib {
+
+/*
+ * A pool of predictors for the serving threads.
+ *
+ * The parameters are loaded once by the main predictor into its scope, which
+ * is only read by the others. The other predictors are created by Clone(),
+ * they share the program and the operators of the main one and only hold the
+ * temporary variables of a run, so creating them does not load or prepare
+ * anything again.
+ *
+ * Each predictor should be used by one thread at a time.
+ */
+class PredictorPool {
+ public:
+  PredictorPool(std::unique_ptr<PaddlePredictor> main, size_t size);
+  PredictorPool(const PredictorPool&) = delete;
+  PredictorPool& operator=(const PredictorPool&) = delete;
+
+  // The predictor of the idx-th thread, the 0-th one is the main predictor.
+  PaddlePredictor* Retrieve(size_t idx);
+
+  size_t size() const { return predictors_.size(); }
+
+ private:
+  std::vector<std::unique_ptr<PaddlePredictor>> predictors_;
+};
+
+}  // namespace contrib
+}  // namespace paddle
@@ -152,13 +152,14 @@ std::unique_ptr<framework::ProgramDesc> Load(
 
 void SaveVars(const framework::Scope& scope,
               const std::vector<std::string>& vars, const std::string& dirname,
-              bool predicate) {
+              bool predicate, bool page_aligned) {
   framework::ProgramDesc prog;
   auto* block = prog.MutableBlock(0);
   auto* op = block->AppendOp();
   op->SetType("save_combine");
   op->SetInput("X", vars);
   op->SetAttr("file_path", dirname + "/param");
+  op->SetAttr("page_aligned", page_aligned);
   op->CheckAttrs();
 
   platform::CPUPlace place;
@@ -41,10 +41,11 @@ std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
                                              const std::string& prog_filename,
                                              const std::string& param_filename);
 
-// Save the variables from a scope to disk.
+// Save the variables from a scope to disk. With page_aligned, the file is
+// mapped into memory by the load instead of being read.
 void SaveVars(const framework::Scope& scope,
               const std::vector<std::string>& vars, const std::string& dirname,
-              bool predicate = true);
+              bool predicate = true, bool page_aligned = false);
 
 }  // namespace inference
 }  // namespace paddle
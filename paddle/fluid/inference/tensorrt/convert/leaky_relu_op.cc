@@ -0,0 +1,71 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+/*
+ * LeakyReluOp, max(x, alpha * x) for alpha in [0, 1], for TensorRT has no
+ * leaky relu activation.
+ */
+class LeakyReluOpConverter : public OpConverter {
+ public:
+  void operator()(const framework::proto::OpDesc& op,
+                  const framework::Scope& scope, bool test_mode) override {
+    VLOG(4) << "convert a fluid leaky_relu op to tensorrt layers";
+
+    framework::OpDesc op_desc(op, nullptr);
+    auto* input = engine_->GetITensor(op_desc.Input("X")[0]);
+    const float alpha = boost::get<float>(op_desc.GetAttr("alpha"));
+    PADDLE_ENFORCE(alpha >= 0.f && alpha <= 1.f,
+                   "The alpha of leaky_relu should be in [0, 1].");
+    auto output_name = op_desc.Output("Out")[0];
+
+    // The weights should live until the engine is built.
+    std::unique_ptr<framework::Tensor> alpha_tensor(new framework::Tensor());
+    alpha_tensor->Resize({1});
+    float* alpha_data = alpha_tensor->mutable_data<float>(platform::CPUPlace());
+    alpha_data[0] = alpha;
+    TensorRTEngine::Weight scale{nvinfer1::DataType::kFLOAT,
+                                 static_cast<void*>(alpha_data), 1};
+    TensorRTEngine::Weight empty{nvinfer1::DataType::kFLOAT, nullptr, 0};
+    engine_->weight_map[output_name + "_alpha"] = std::move(alpha_tensor);
+
+    auto* scale_layer = TRT_ENGINE_ADD_LAYER(
+        engine_, Scale, *const_cast<nvinfer1::ITensor*>(input),
+        nvinfer1::ScaleMode::kUNIFORM, empty.get(), scale.get(), empty.get());
+    PADDLE_ENFORCE(scale_layer != nullptr);
+    auto* layer = TRT_ENGINE_ADD_LAYER(
+        engine_, ElementWise, *const_cast<nvinfer1::ITensor*>(input),
+        *scale_layer->getOutput(0), nvinfer1::ElementWiseOperation::kMAX);
+    PADDLE_ENFORCE(layer != nullptr);
+
+    engine_->SetITensor(output_name, layer->getOutput(0));
+    layer->setName(("leaky_relu (Output: " + output_name + ")").c_str());
+    layer->getOutput(0)->setName(output_name.c_str());
+    if (test_mode) {  // the test framework can not determine which is the
+                      // output, so place the declaration inside.
+      engine_->DeclareOutput(output_name);
+    }
+  }
+};
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+REGISTER_TRT_OP_CONVERTER(leaky_relu, LeakyReluOpConverter);
@@ -0,0 +1,75 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+/*
+ * MatMulOp of two activations, the last two dims are the matrices and the
+ * others, the batch dim included, are the batches.
+ */
+class MatMulOpConverter : public OpConverter {
+ public:
+  void operator()(const framework::proto::OpDesc& op,
+                  const framework::Scope& scope, bool test_mode) override {
+    VLOG(4) << "convert a fluid matmul op to tensorrt matrix multiply layer";
+
+    framework::OpDesc op_desc(op, nullptr);
+    auto* x = engine_->GetITensor(op_desc.Input("X")[0]);
+    auto* y = engine_->GetITensor(op_desc.Input("Y")[0]);
+    const bool transpose_x = boost::get<bool>(op_desc.GetAttr("transpose_X"));
+    const bool transpose_y = boost::get<bool>(op_desc.GetAttr("transpose_Y"));
+    const float alpha = boost::get<float>(op_desc.GetAttr("alpha"));
+    PADDLE_ENFORCE_GE(x->getDimensions().nbDims, 2);
+    PADDLE_ENFORCE_GE(y->getDimensions().nbDims, 2);
+    auto output_name = op_desc.Output("Out")[0];
+
+    nvinfer1::ILayer* layer = TRT_ENGINE_ADD_LAYER(
+        engine_, MatrixMultiply, *const_cast<nvinfer1::ITensor*>(x),
+        transpose_x, *const_cast<nvinfer1::ITensor*>(y), transpose_y);
+    PADDLE_ENFORCE(layer != nullptr);
+    if (alpha != 1.f) {
+      // The weights should live until the engine is built.
+      std::unique_ptr<framework::Tensor> alpha_tensor(new framework::Tensor());
+      alpha_tensor->Resize({1});
+      float* alpha_data =
+          alpha_tensor->mutable_data<float>(platform::CPUPlace());
+      alpha_data[0] = alpha;
+      TensorRTEngine::Weight scale{nvinfer1::DataType::kFLOAT,
+                                   static_cast<void*>(alpha_data), 1};
+      TensorRTEngine::Weight empty{nvinfer1::DataType::kFLOAT, nullptr, 0};
+      engine_->weight_map[output_name + "_alpha"] = std::move(alpha_tensor);
+      layer = TRT_ENGINE_ADD_LAYER(engine_, Scale, *layer->getOutput(0),
+                                   nvinfer1::ScaleMode::kUNIFORM, empty.get(),
+                                   scale.get(), empty.get());
+    }
+
+    engine_->SetITensor(output_name, layer->getOutput(0));
+    layer->setName(("matmul (Output: " + output_name + ")").c_str());
+    layer->getOutput(0)->setName(output_name.c_str());
+    if (test_mode) {  // the test framework can not determine which is the
+                      // output, so place the declaration inside.
+      engine_->DeclareOutput(output_name);
+    }
+  }
+};
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+REGISTER_TRT_OP_CONVERTER(matmul, MatMulOpConverter);
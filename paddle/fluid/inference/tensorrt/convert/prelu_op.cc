@@ -0,0 +1,100 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+/*
+ * PReluOp in the all or channel mode, relu(x) - alpha * relu(-x), for
+ * TensorRT has no prelu activation.
+ */
+class PReluOpConverter : public OpConverter {
+ public:
+  void operator()(const framework::proto::OpDesc& op,
+                  const framework::Scope& scope, bool test_mode) override {
+    VLOG(4) << "convert a fluid prelu op to tensorrt layers";
+
+    framework::OpDesc op_desc(op, nullptr);
+    auto* input = engine_->GetITensor(op_desc.Input("X")[0]);
+    const std::string mode = boost::get<std::string>(op_desc.GetAttr("mode"));
+    PADDLE_ENFORCE(mode == "all" || mode == "channel",
+                   "The prelu of mode %s is not supported in TensorRT.", mode);
+    auto output_name = op_desc.Output("Out")[0];
+
+    auto* alpha_v = scope.FindVar(op_desc.Input("Alpha")[0]);
+    PADDLE_ENFORCE_NOT_NULL(alpha_v);
+    auto* alpha_t = alpha_v->GetMutable<framework::LoDTensor>();
+    framework::LoDTensor alpha_cpu;
+    alpha_cpu.Resize(alpha_t->dims());
+    TensorCopySync(*alpha_t, platform::CPUPlace(), &alpha_cpu);
+    const float* alpha_data = alpha_cpu.data<float>();
+
+    // The weights should live until the engine is built.
+    std::unique_ptr<framework::Tensor> neg_alpha(new framework::Tensor());
+    neg_alpha->Resize({alpha_cpu.numel()});
+    float* neg_alpha_data =
+        neg_alpha->mutable_data<float>(platform::CPUPlace());
+    for (int64_t i = 0; i < alpha_cpu.numel(); i++) {
+      neg_alpha_data[i] = -alpha_data[i];
+    }
+    std::unique_ptr<framework::Tensor> neg_one(new framework::Tensor());
+    neg_one->Resize({1});
+    float* neg_one_data = neg_one->mutable_data<float>(platform::CPUPlace());
+    neg_one_data[0] = -1.f;
+
+    TensorRTEngine::Weight neg_alpha_weights{
+        nvinfer1::DataType::kFLOAT, static_cast<void*>(neg_alpha_data),
+        static_cast<size_t>(alpha_cpu.numel())};
+    TensorRTEngine::Weight neg_one_weights{
+        nvinfer1::DataType::kFLOAT, static_cast<void*>(neg_one_data), 1};
+    TensorRTEngine::Weight empty{nvinfer1::DataType::kFLOAT, nullptr, 0};
+    engine_->weight_map[output_name + "_neg_alpha"] = std::move(neg_alpha);
+    engine_->weight_map[output_name + "_neg_one"] = std::move(neg_one);
+
+    auto* x = const_cast<nvinfer1::ITensor*>(input);
+    auto* pos = TRT_ENGINE_ADD_LAYER(engine_, Activation, *x,
+                                     nvinfer1::ActivationType::kRELU);
+    auto* neg_x = TRT_ENGINE_ADD_LAYER(
+        engine_, Scale, *x, nvinfer1::ScaleMode::kUNIFORM, empty.get(),
+        neg_one_weights.get(), empty.get());
+    auto* neg = TRT_ENGINE_ADD_LAYER(engine_, Activation, *neg_x->getOutput(0),
+                                     nvinfer1::ActivationType::kRELU);
+    auto scale_mode = mode == "all" ? nvinfer1::ScaleMode::kUNIFORM
+                                    : nvinfer1::ScaleMode::kCHANNEL;
+    auto* scaled_neg = TRT_ENGINE_ADD_LAYER(
+        engine_, Scale, *neg->getOutput(0), scale_mode, empty.get(),
+        neg_alpha_weights.get(), empty.get());
+    auto* layer = TRT_ENGINE_ADD_LAYER(
+        engine_, ElementWise, *pos->getOutput(0), *scaled_neg->getOutput(0),
+        nvinfer1::ElementWiseOperation::kSUM);
+    PADDLE_ENFORCE(layer != nullptr);
+
+    engine_->SetITensor(output_name, layer->getOutput(0));
+    layer->setName(("prelu (Output: " + output_name + ")").c_str());
+    layer->getOutput(0)->setName(output_name.c_str());
+    if (test_mode) {  // the test framework can not determine which is the
+                      // output, so place the declaration inside.
+      engine_->DeclareOutput(output_name);
+    }
+  }
+};
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+REGISTER_TRT_OP_CONVERTER(prelu, PReluOpConverter);
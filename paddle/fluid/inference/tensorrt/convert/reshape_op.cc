@@ -0,0 +1,89 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+/*
+ * ReshapeOp, the batch dim should be kept and the shape should be set by the
+ * attribute.
+ */
+class ReshapeOpConverter : public OpConverter {
+ public:
+  void operator()(const framework::proto::OpDesc& op,
+                  const framework::Scope& scope, bool test_mode) override {
+    VLOG(4) << "convert a fluid reshape op to tensorrt shuffle layer";
+
+    framework::OpDesc op_desc(op, nullptr);
+    auto* input = engine_->GetITensor(op_desc.Input("X")[0]);
+    auto shape = boost::get<std::vector<int>>(op_desc.GetAttr("shape"));
+    PADDLE_ENFORCE(!shape.empty() && (shape[0] == 0 || shape[0] == -1),
+                   "The batch dim can not be reshaped in TensorRT.");
+
+    nvinfer1::Dims input_shape = input->getDimensions();
+    int64_t volume = 1;
+    for (int i = 0; i < input_shape.nbDims; i++) {
+      volume *= input_shape.d[i];
+    }
+    // Resolve the 0 and -1 of the shape without the batch dim, the dims
+    // copied from the input are the same in fluid and TensorRT.
+    nvinfer1::Dims dims;
+    dims.nbDims = static_cast<int>(shape.size()) - 1;
+    int unknown = -1;
+    int64_t known = 1;
+    for (int i = 0; i < dims.nbDims; i++) {
+      int dim = shape[i + 1];
+      if (dim == 0) {
+        PADDLE_ENFORCE_LT(i, input_shape.nbDims);
+        dim = input_shape.d[i];
+      }
+      if (dim == -1) {
+        PADDLE_ENFORCE_EQ(unknown, -1, "Only one dim can be -1.");
+        unknown = i;
+      } else {
+        known *= dim;
+      }
+      dims.d[i] = dim;
+      dims.type[i] = nvinfer1::DimensionType::kSPATIAL;
+    }
+    if (unknown >= 0) {
+      PADDLE_ENFORCE_EQ(volume % known, 0);
+      dims.d[unknown] = static_cast<int>(volume / known);
+    }
+
+    auto* layer = TRT_ENGINE_ADD_LAYER(engine_, Shuffle,
+                                       *const_cast<nvinfer1::ITensor*>(input));
+    PADDLE_ENFORCE(layer != nullptr);
+    layer->setReshapeDimensions(dims);
+
+    auto output_name = op_desc.Output("Out")[0];
+    engine_->SetITensor(output_name, layer->getOutput(0));
+    layer->setName(("reshape (Output: " + output_name + ")").c_str());
+    layer->getOutput(0)->setName(output_name.c_str());
+    if (test_mode) {  // the test framework can not determine which is the
+                      // output, so place the declaration inside.
+      engine_->DeclareOutput(output_name);
+    }
+  }
+};
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+REGISTER_TRT_OP_CONVERTER(reshape, ReshapeOpConverter);
+REGISTER_TRT_OP_CONVERTER(reshape2, ReshapeOpConverter);
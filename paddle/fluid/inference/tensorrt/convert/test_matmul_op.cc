@@ -0,0 +1,50 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/inference/tensorrt/convert/ut_helper.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+TEST(MatMulOpConverter, main) {
+  framework::Scope scope;
+  std::unordered_set<std::string> parameters;
+  TRTConvertValidation validator(10, parameters, scope, 1000);
+  validator.DeclInputVar("matmul-X", nvinfer1::Dims3(2, 3, 4));
+  validator.DeclInputVar("matmul-Y", nvinfer1::Dims3(2, 5, 4));
+  validator.DeclOutputVar("matmul-Out", nvinfer1::Dims3(2, 3, 5));
+
+  // Prepare Op description
+  framework::OpDesc desc;
+  desc.SetType("matmul");
+  desc.SetInput("X", {"matmul-X"});
+  desc.SetInput("Y", {"matmul-Y"});
+  desc.SetOutput("Out", {"matmul-Out"});
+  desc.SetAttr("transpose_X", false);
+  desc.SetAttr("transpose_Y", true);
+  desc.SetAttr("alpha", 0.5f);
+
+  validator.SetOp(*desc.Proto());
+
+  validator.Execute(5);
+}
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+USE_OP(matmul);
@@ -0,0 +1,69 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+/*
+ * TransposeOp, the batch dim should not be moved.
+ */
+class TransposeOpConverter : public OpConverter {
+ public:
+  void operator()(const framework::proto::OpDesc& op,
+                  const framework::Scope& scope, bool test_mode) override {
+    VLOG(4) << "convert a fluid transpose op to tensorrt shuffle layer";
+
+    framework::OpDesc op_desc(op, nullptr);
+    auto* input = engine_->GetITensor(op_desc.Input("X")[0]);
+    auto axis = boost::get<std::vector<int>>(op_desc.GetAttr("axis"));
+    PADDLE_ENFORCE(!axis.empty() && axis[0] == 0,
+                   "The batch dim can not be transposed in TensorRT.");
+
+    nvinfer1::Dims input_shape = input->getDimensions();
+    int nbDims = input_shape.nbDims;
+    PADDLE_ENFORCE_GE(nbDims, static_cast<int>(axis.size()) - 1);
+    // The axis of fluid count the batch dim, the dims of TensorRT do not.
+    nvinfer1::Permutation perm;
+    for (int i = 0; i < nbDims; i++) {
+      perm.order[i] = i;
+    }
+    for (size_t i = 1; i < axis.size(); i++) {
+      perm.order[i - 1] = axis[i] - 1;
+    }
+
+    auto* layer = TRT_ENGINE_ADD_LAYER(engine_, Shuffle,
+                                       *const_cast<nvinfer1::ITensor*>(input));
+    PADDLE_ENFORCE(layer != nullptr);
+    layer->setFirstTranspose(perm);
+
+    auto output_name = op_desc.Output("Out")[0];
+    engine_->SetITensor(output_name, layer->getOutput(0));
+    layer->setName(("transpose (Output: " + output_name + ")").c_str());
+    layer->getOutput(0)->setName(output_name.c_str());
+    if (test_mode) {  // the test framework can not determine which is the
+                      // output, so place the declaration inside.
+      engine_->DeclareOutput(output_name);
+    }
+  }
+};
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+REGISTER_TRT_OP_CONVERTER(transpose, TransposeOpConverter);
+REGISTER_TRT_OP_CONVERTER(transpose2, TransposeOpConverter);
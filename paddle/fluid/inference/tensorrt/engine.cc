@@ -69,13 +69,55 @@ void TensorRTEngine::FreezeNetwork() {
   // build engine.
   infer_builder_->setMaxBatchSize(max_batch_);
   infer_builder_->setMaxWorkspaceSize(max_workspace_);
+  if (int8_calibrator_) {
+    if (infer_builder_->platformHasFastInt8()) {
+      infer_builder_->setInt8Mode(true);
+      infer_builder_->setInt8Calibrator(int8_calibrator_);
+    } else {
+      LOG(WARNING) << "the GPU has no fast INT8, build the engine in FP32";
+    }
+  }
 
   infer_engine_.reset(infer_builder_->buildCudaEngine(*infer_network_));
   PADDLE_ENFORCE(infer_engine_ != nullptr, "build cuda engine failed!");
 
   infer_context_.reset(infer_engine_->createExecutionContext());
+  AllocateBuffers();
+}
+
+void TensorRTEngine::Serialize(std::string *data) {
+  PADDLE_ENFORCE(infer_engine_ != nullptr, "call FreezeNetwork first.");
+  auto *memory = infer_engine_->serialize();
+  PADDLE_ENFORCE_NOT_NULL(memory, "serialize cuda engine failed!");
+  data->assign(static_cast<const char *>(memory->data()), memory->size());
+  memory->destroy();
+}
+
+bool TensorRTEngine::Deserialize(const std::string &data) {
+  freshDeviceId();
+  PADDLE_ENFORCE(infer_engine_ == nullptr, "the engine is already created.");
+  auto *runtime = createInferRuntime(&logger_);
+  PADDLE_ENFORCE_NOT_NULL(runtime, "create infer runtime failed!");
+  infer_engine_.reset(
+      runtime->deserializeCudaEngine(data.data(), data.size(), nullptr));
+  runtime->destroy();
+  if (infer_engine_ == nullptr) return false;
+  if (infer_engine_->getMaxBatchSize() < max_batch_) {
+    LOG(WARNING) << "the serialized engine supports the batch size up to "
+                 << infer_engine_->getMaxBatchSize() << ", less than "
+                 << max_batch_;
+    infer_engine_.reset(nullptr);
+    return false;
+  }
+  infer_context_.reset(infer_engine_->createExecutionContext());
+  for (int i = 0; i < infer_engine_->getNbBindings(); ++i) {
+    buffer_sizes_[infer_engine_->getBindingName(i)] = 0;
+  }
+  AllocateBuffers();
+  return true;
+}
 
-  // allocate GPU buffers.
+void TensorRTEngine::AllocateBuffers() {
   buffers_.resize(buffer_sizes_.size());
   for (auto &item : buffer_sizes_) {
     // The output buffers are not set in the network building phrase, need to
@@ -90,10 +132,11 @@ void TensorRTEngine::FreezeNetwork() {
     }
 
     auto &buf = buffer(item.first);
-    buf.max_size = item.second * max_batch_;
+    // item.second is already the size of max_batch_.
+    buf.max_size = item.second;
     CHECK(buf.buffer == nullptr);  // buffer should be allocated only once.
 
-    PADDLE_ENFORCE_EQ(0, cudaMalloc(&buf.buffer, item.second * max_batch_));
+    PADDLE_ENFORCE_EQ(0, cudaMalloc(&buf.buffer, item.second));
     buf.size = 0;
     PADDLE_ENFORCE_LE(buf.max_size, 1 << 30);  // 10G
     buf.device = DeviceType::GPU;
@@ -153,17 +196,7 @@ void *TensorRTEngine::GetOutputInGPU(const std::string &name) {
 
 void TensorRTEngine::GetOutputInGPU(const std::string &name, void *dst,
                                     size_t max_size) {
-  // determine data size
-  auto *output = TensorRTEngine::GetITensor(name);
-  nvinfer1::Dims dims = output->getDimensions();
-  auto dim_size = analysis::AccuDims(dims.d, dims.nbDims);
-  size_t dst_size = dim_size * runtime_batch_ *
-                    kDataTypeSize[static_cast<int>(output->getType())];
-
-  auto it = buffer_sizes_.find(name);
-  PADDLE_ENFORCE(it != buffer_sizes_.end());
-  PADDLE_ENFORCE_GT(it->second, 0);
-  PADDLE_ENFORCE_LE(dst_size, it->second);
+  size_t dst_size = OutputSize(name);
   PADDLE_ENFORCE_GE(max_size, dst_size);
   auto &buf = buffer(name);
   PADDLE_ENFORCE_NOT_NULL(buf.buffer, "buffer should be allocated before");
@@ -174,17 +207,7 @@ void TensorRTEngine::GetOutputInGPU(const std::string &name, void *dst,
 
 void TensorRTEngine::GetOutputInCPU(const std::string &name, void *dst,
                                     size_t max_size) {
-  // determine data size
-
-  auto *output = TensorRTEngine::GetITensor(name);
-  nvinfer1::Dims dims = output->getDimensions();
-  auto dim_size = analysis::AccuDims(dims.d, dims.nbDims);
-  size_t dst_size = dim_size * runtime_batch_ *
-                    kDataTypeSize[static_cast<int>(output->getType())];
-  auto it = buffer_sizes_.find(name);
-  PADDLE_ENFORCE(it != buffer_sizes_.end());
-  PADDLE_ENFORCE_GT(it->second, 0);
-  PADDLE_ENFORCE_LE(dst_size, it->second);
+  size_t dst_size = OutputSize(name);
   PADDLE_ENFORCE_GE(max_size, dst_size);
   auto &buf = buffer(name);
   PADDLE_ENFORCE_NOT_NULL(buf.buffer, "buffer should be allocated before");
@@ -192,6 +215,26 @@ void TensorRTEngine::GetOutputInCPU(const std::string &name, void *dst,
                                        cudaMemcpyDeviceToHost, *stream_));
 }
 
+size_t TensorRTEngine::OutputSize(const std::string &name) {
+  auto it = buffer_sizes_.find(name);
+  PADDLE_ENFORCE(it != buffer_sizes_.end(), "no output %s", name);
+  PADDLE_ENFORCE_GT(it->second, 0);
+  auto slot_offset = infer_engine_->getBindingIndex(name.c_str());
+  auto dims = infer_engine_->getBindingDimensions(slot_offset);
+  size_t size = analysis::AccuDims(dims.d, dims.nbDims) * runtime_batch_ *
+                kDataTypeSize[static_cast<int>(
+                    infer_engine_->getBindingDataType(slot_offset))];
+  PADDLE_ENFORCE_LE(size, it->second);
+  return size;
+}
+
+nvinfer1::Dims TensorRTEngine::GetBindingDims(const std::string &name) {
+  PADDLE_ENFORCE(infer_engine_ != nullptr, "call FreezeNetwork first.");
+  auto slot_offset = infer_engine_->getBindingIndex(name.c_str());
+  PADDLE_ENFORCE_GE(slot_offset, 0, "no binding called %s", name);
+  return infer_engine_->getBindingDimensions(slot_offset);
+}
+
 Buffer &TensorRTEngine::buffer(const std::string &name) {
   PADDLE_ENFORCE(infer_engine_ != nullptr, "call FreezeNetwork first.");
   auto it = buffer_sizes_.find(name);
@@ -80,6 +80,20 @@ class TensorRTEngine : public EngineBase {
   // After finishing adding ops, freeze this network and creates the executation
   // environment.
   void FreezeNetwork();
+  // Build the engine in INT8 with the ranges calibrated by calibrator, which
+  // should be alive until FreezeNetwork returns. The engine stays in FP32 if
+  // the GPU has no fast INT8.
+  void EnableInt8(nvinfer1::IInt8Calibrator* calibrator) {
+    int8_calibrator_ = calibrator;
+  }
+
+  // Serialize the frozen engine, so that it can be loaded by Deserialize
+  // without building the network again.
+  void Serialize(std::string* data);
+  // Create the executation environment from a serialized engine instead of
+  // building the network. Return false if data is not an engine of this
+  // version of TensorRT. The engine is bound to the GPU model serializing it.
+  bool Deserialize(const std::string& data);
 
   // Add an input and set its name, data type and dimention.
   nvinfer1::ITensor* DeclareInput(const std::string& name,
@@ -117,6 +131,9 @@ class TensorRTEngine : public EngineBase {
   void SetITensor(const std::string& name, nvinfer1::ITensor* tensor);
   // Get an ITensor called name.
   nvinfer1::ITensor* GetITensor(const std::string& name);
+  // Get the dims of the input or output called name, without the batch dim.
+  // It also works for the deserialized engines, which have no ITensor.
+  nvinfer1::Dims GetBindingDims(const std::string& name);
 
   nvinfer1::ICudaEngine* engine() { return infer_engine_.get(); }
   nvinfer1::INetworkDefinition* network() { return infer_network_.get(); }
@@ -154,6 +171,7 @@ class TensorRTEngine : public EngineBase {
       itensor_map_;
   // The specific GPU id that the TensorRTEngine bounded to.
   int device_;
+  nvinfer1::IInt8Calibrator* int8_calibrator_{nullptr};
 
   // TensorRT related internal members
   template <typename T>
@@ -174,6 +192,10 @@ class TensorRTEngine : public EngineBase {
   // ensure that the thread is associated with the correct device by calling
   // freshDeviceId().
   void freshDeviceId();
+  // Allocate the GPU buffers of the bindings of infer_engine_.
+  void AllocateBuffers();
+  // The bytes of the output called name for the runtime batch.
+  size_t OutputSize(const std::string& name);
 };  // class TensorRTEngine
 
 // Add an layer__ into engine__ with args ARGS.
@@ -16,6 +16,7 @@ limitations under the License. */
 #include <cuda_runtime_api.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#include <string>
 
 #include "paddle/fluid/inference/tensorrt/engine.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -77,6 +78,46 @@ TEST_F(TensorRTEngineTest, add_layer) {
   ASSERT_EQ(y_cpu, x_v * 2 + 3);
 }
 
+TEST_F(TensorRTEngineTest, serialize) {
+  float raw_weight[1] = {2.};
+  float raw_bias[1] = {3.};
+  TensorRTEngine::Weight weight(nvinfer1::DataType::kFLOAT, raw_weight, 1);
+  TensorRTEngine::Weight bias(nvinfer1::DataType::kFLOAT, raw_bias, 1);
+  auto* x = engine_->DeclareInput("x", nvinfer1::DataType::kFLOAT,
+                                  nvinfer1::DimsCHW{1, 1, 1});
+  auto* fc_layer = TRT_ENGINE_ADD_LAYER(engine_, FullyConnected, *x, 1,
+                                        weight.get(), bias.get());
+  PADDLE_ENFORCE(fc_layer != nullptr);
+  engine_->DeclareOutput(fc_layer, 0, "y");
+  engine_->FreezeNetwork();
+
+  std::string serialized;
+  engine_->Serialize(&serialized);
+  ASSERT_FALSE(serialized.empty());
+
+  // The loaded engine runs without the network.
+  cudaStream_t stream;
+  TensorRTEngine engine(10, 1 << 10, &stream);
+  ASSERT_TRUE(engine.Deserialize(serialized));
+  ASSERT_EQ(engine.engine()->getNbBindings(), 2);
+  auto dims = engine.GetBindingDims("y");
+  ASSERT_EQ(dims.nbDims, 3);
+  ASSERT_EQ(dims.d[0], 1);
+
+  float x_v[2] = {1234, 4321};
+  engine.SetInputFromCPU("x", reinterpret_cast<void*>(x_v), sizeof(x_v));
+  engine.Execute(2);
+  float y_cpu[2];
+  engine.GetOutputInCPU("y", y_cpu, sizeof(y_cpu));
+  cudaStreamSynchronize(stream);
+  ASSERT_EQ(y_cpu[0], x_v[0] * 2 + 3);
+  ASSERT_EQ(y_cpu[1], x_v[1] * 2 + 3);
+
+  cudaStream_t invalid_stream;
+  TensorRTEngine invalid(10, 1 << 10, &invalid_stream);
+  ASSERT_FALSE(invalid.Deserialize("not an engine"));
+}
+
 TEST_F(TensorRTEngineTest, add_layer_multi_dim) {
   // Weight in CPU memory.
   // It seems tensorrt FC use col-major: [[1.0, 3.3], [1.1, 4.4]]
@@ -0,0 +1,111 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/tensorrt/trt_int8_calibrator.h"
+#include <cuda_runtime_api.h>
+#include <glog/logging.h>
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+void TRTCalibrationStore::Record(
+    const std::string& key,
+    const std::map<std::string, const framework::Tensor*>& inputs) {
+  CalibrationBatch batch;
+  for (auto& input : inputs) {
+    framework::TensorCopySync(*input.second, platform::CPUPlace(),
+                              &batch[input.first]);
+  }
+  batches_[key].push_back(std::move(batch));
+}
+
+const std::vector<CalibrationBatch>& TRTCalibrationStore::Batches(
+    const std::string& key) const {
+  static const std::vector<CalibrationBatch> empty;
+  auto it = batches_.find(key);
+  return it == batches_.end() ? empty : it->second;
+}
+
+TRTInt8Calibrator::TRTInt8Calibrator(
+    const std::vector<CalibrationBatch>& batches, const std::string& table,
+    int device)
+    : table_(table) {
+  if (!table_.empty() || batches.empty()) return;
+  auto same_shapes = [&](const CalibrationBatch& batch) {
+    if (batch.size() != batches[0].size()) return false;
+    for (auto& input : batch) {
+      auto it = batches[0].find(input.first);
+      if (it == batches[0].end() || it->second.dims() != input.second.dims()) {
+        return false;
+      }
+    }
+    return true;
+  };
+  for (auto& batch : batches) {
+    if (same_shapes(batch)) {
+      batches_.push_back(&batch);
+    } else {
+      LOG(WARNING) << "skip a calibration batch of the different shapes";
+    }
+  }
+  batch_size_ = static_cast<int>(batches[0].begin()->second.dims()[0]);
+
+  PADDLE_ENFORCE_EQ(0, cudaSetDevice(device));
+  for (auto& input : batches[0]) {
+    size_t size = input.second.memory_size();
+    void* buffer = nullptr;
+    PADDLE_ENFORCE_EQ(0, cudaMalloc(&buffer, size));
+    buffers_[input.first] = std::make_pair(buffer, size);
+  }
+}
+
+TRTInt8Calibrator::~TRTInt8Calibrator() {
+  for (auto& buffer : buffers_) {
+    cudaFree(buffer.second.first);
+  }
+}
+
+bool TRTInt8Calibrator::getBatch(void* bindings[], const char* names[],
+                                 int nb_bindings) {
+  if (next_batch_ >= batches_.size()) return false;
+  auto& batch = *batches_[next_batch_++];
+  for (int i = 0; i < nb_bindings; ++i) {
+    auto input = batch.find(names[i]);
+    auto buffer = buffers_.find(names[i]);
+    PADDLE_ENFORCE(input != batch.end() && buffer != buffers_.end(),
+                   "no calibration data of the input %s", names[i]);
+    PADDLE_ENFORCE_EQ(
+        0, cudaMemcpy(buffer->second.first, input->second.data<void>(),
+                      buffer->second.second, cudaMemcpyHostToDevice));
+    bindings[i] = buffer->second.first;
+  }
+  return true;
+}
+
+const void* TRTInt8Calibrator::readCalibrationCache(std::size_t& length) {
+  length = table_.size();
+  return table_.empty() ? nullptr : table_.data();
+}
+
+void TRTInt8Calibrator::writeCalibrationCache(const void* ptr,
+                                              std::size_t length) {
+  table_.assign(static_cast<const char*>(ptr), length);
+}
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
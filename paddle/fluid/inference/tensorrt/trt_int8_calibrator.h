@@ -0,0 +1,100 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <NvInfer.h>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/tensor.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+// The inputs of an engine in a calibration run, by the input names.
+using CalibrationBatch = std::map<std::string, framework::Tensor>;
+
+/*
+ * TRTCalibrationStore - Hold the inputs of the INT8 engines recorded in the
+ * calibration runs of a predictor, and the calibration tables of the engines
+ * built with them, so that the engines for the other input shapes are built
+ * without calibrating again.
+ */
+class TRTCalibrationStore {
+ public:
+  // While calibrating, the INT8 engine ops run their sub-graphs in fluid and
+  // record the inputs instead of building the engines.
+  void SetCalibrating(bool calibrating) { calibrating_ = calibrating; }
+  bool calibrating() const { return calibrating_; }
+
+  // Copy the inputs of the engine called key to the CPU.
+  void Record(const std::string& key,
+              const std::map<std::string, const framework::Tensor*>& inputs);
+  // The batches recorded of the engine called key, empty if none.
+  const std::vector<CalibrationBatch>& Batches(const std::string& key) const;
+  // Release the batches after the engines are built.
+  void ClearBatches() { batches_.clear(); }
+
+  void SetTable(const std::string& key, const std::string& table) {
+    tables_[key] = table;
+  }
+  // The calibration table of the engine called key, empty if none.
+  std::string Table(const std::string& key) const {
+    auto it = tables_.find(key);
+    return it == tables_.end() ? "" : it->second;
+  }
+
+ private:
+  bool calibrating_{false};
+  std::unordered_map<std::string, std::vector<CalibrationBatch>> batches_;
+  std::unordered_map<std::string, std::string> tables_;
+};
+
+/*
+ * TRTInt8Calibrator - Feed the recorded batches to TensorRT, which calibrates
+ * the INT8 ranges of the tensors by the entropy of their distributions. The
+ * batches are skipped if a calibration table is given, otherwise the table
+ * written by TensorRT is kept to be cached.
+ */
+class TRTInt8Calibrator : public nvinfer1::IInt8EntropyCalibrator {
+ public:
+  // Only the batches of the same shapes as the first one are fed.
+  TRTInt8Calibrator(const std::vector<CalibrationBatch>& batches,
+                    const std::string& table, int device);
+  ~TRTInt8Calibrator();
+
+  int getBatchSize() const override { return batch_size_; }
+  bool getBatch(void* bindings[], const char* names[],
+                int nb_bindings) override;
+  const void* readCalibrationCache(std::size_t& length) override;
+  void writeCalibrationCache(const void* ptr, std::size_t length) override;
+
+  const std::string& table() const { return table_; }
+
+ private:
+  std::vector<const CalibrationBatch*> batches_;
+  size_t next_batch_{0};
+  int batch_size_{1};
+  std::string table_;
+  // The GPU buffers of the inputs and their sizes.
+  std::unordered_map<std::string, std::pair<void*, size_t>> buffers_;
+};
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
@@ -15,7 +15,15 @@
 #pragma once
 
 #include <gtest/gtest.h>
+#include <unistd.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <cmath>
+#include <condition_variable>  // NOLINT
+#include <fstream>
+#include <mutex>  // NOLINT
+#include <numeric>
 #include <string>
 #include <thread>  // NOLINT
 #include <vector>
@@ -35,6 +43,18 @@ DEFINE_bool(test_all_data, false, "Test the all dataset in data file.");
 DEFINE_int32(num_threads, 1, "Running the inference program in multi-threads.");
 DEFINE_bool(use_analysis, true,
             "Running the inference program in analysis mode.");
+DEFINE_bool(benchmark, false,
+            "Run the benchmark suite of the predictors before the test.");
+DEFINE_string(benchmark_predictors, "native,analysis",
+              "The predictors to benchmark side by side, any of native, "
+              "analysis and tensorrt.");
+DEFINE_double(benchmark_qps, 0,
+              "The fixed QPS of the requests of all the threads, 0 to send "
+              "the requests back to back.");
+DEFINE_int32(benchmark_warmup, 2,
+             "The warm-up runs of each thread before the benchmark.");
+DEFINE_string(benchmark_report, "",
+              "The file to append the results to, one JSON per line.");
 
 namespace paddle {
 namespace inference {
@@ -162,12 +182,205 @@ void TestMultiThreadPrediction(
   }
 }
 
+struct BenchmarkResult {
+  std::string predictor;
+  int num_threads;
+  // The fixed QPS of the load, 0 for the requests back to back.
+  double qps;
+  size_t num_requests;
+  // The latencies in ms, from the time each request is scheduled, so the
+  // queueing behind the slow requests is counted under a fixed QPS.
+  double mean;
+  double p50;
+  double p90;
+  double p99;
+  double p999;
+  // Samples per second.
+  double throughput;
+  // The resident memory of the process after the run.
+  double rss_mb;
+};
+
+static double ResidentMemoryMB() {
+  std::ifstream statm("/proc/self/statm");
+  size_t size = 0, resident = 0;
+  if (!(statm >> size >> resident)) return 0.;
+  return static_cast<double>(resident) * sysconf(_SC_PAGESIZE) / (1 << 20);
+}
+
+std::unique_ptr<PaddlePredictor> CreateBenchmarkPredictor(
+    const AnalysisConfig &config, const std::string &predictor) {
+  if (predictor == "native") {
+    return CreateTestPredictor(config, false);
+  } else if (predictor == "analysis") {
+    return CreateTestPredictor(config, true);
+  } else if (predictor == "tensorrt") {
+#ifdef PADDLE_WITH_TENSORRT
+    contrib::MixedRTConfig trt_config;
+    static_cast<NativeConfig &>(trt_config) = config;
+    trt_config.use_gpu = true;
+    trt_config.max_batch_size = FLAGS_batch_size;
+    return CreatePaddlePredictor<contrib::MixedRTConfig>(trt_config);
+#else
+    LOG(WARNING) << "Skip the tensorrt predictor, which is not compiled.";
+    return nullptr;
+#endif
+  }
+  LOG(FATAL) << "Unknown predictor " << predictor;
+  return nullptr;
+}
+
+// Run the requests of the inputs, FLAGS_repeat times per thread, from
+// num_threads threads each with its own predictor.
+bool BenchmarkPredictor(const AnalysisConfig &config,
+                        const std::vector<std::vector<PaddleTensor>> &inputs,
+                        const std::string &predictor, int num_threads,
+                        BenchmarkResult *result) {
+  CHECK(!inputs.empty()) << "No inputs to benchmark.";
+  std::vector<std::unique_ptr<PaddlePredictor>> predictors;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    predictors.emplace_back(CreateBenchmarkPredictor(config, predictor));
+    if (!predictors.back()) return false;
+  }
+  const size_t num_requests =
+      static_cast<size_t>(FLAGS_repeat) * inputs.size() * num_threads;
+  const double qps = FLAGS_benchmark_qps;
+  using Clock = std::chrono::steady_clock;
+  std::atomic<size_t> next_request{0};
+  std::vector<std::vector<double>> latencies(num_threads);
+
+  // The threads wait for the others to warm up before the start.
+  std::mutex mu;
+  std::condition_variable cv;
+  int num_ready = 0;
+  bool started = false;
+  Clock::time_point start;
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid]() {
+#ifdef PADDLE_WITH_MKLDNN
+      platform::set_cur_thread_id(static_cast<int>(tid) + 1);
+#endif
+      std::vector<std::vector<PaddleTensor>> inputs_tid = inputs;
+      std::vector<PaddleTensor> outputs_tid;
+      for (int i = 0; i < FLAGS_benchmark_warmup; ++i) {
+        predictors[tid]->Run(inputs_tid[i % inputs_tid.size()], &outputs_tid,
+                             FLAGS_batch_size);
+      }
+      {
+        std::unique_lock<std::mutex> lock(mu);
+        if (++num_ready == num_threads) {
+          start = Clock::now();
+          started = true;
+          cv.notify_all();
+        }
+        cv.wait(lock, [&] { return started; });
+      }
+      for (size_t i = next_request++; i < num_requests; i = next_request++) {
+        Clock::time_point scheduled = Clock::now();
+        if (qps > 0) {
+          scheduled = start + std::chrono::duration_cast<Clock::duration>(
+                                  std::chrono::duration<double>(i / qps));
+          std::this_thread::sleep_until(scheduled);
+        }
+        predictors[tid]->Run(inputs_tid[i % inputs_tid.size()], &outputs_tid,
+                             FLAGS_batch_size);
+        latencies[tid].push_back(
+            std::chrono::duration<double, std::milli>(Clock::now() - scheduled)
+                .count());
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  double elapsed =
+      std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::vector<double> all;
+  for (auto &thread_latencies : latencies) {
+    all.insert(all.end(), thread_latencies.begin(), thread_latencies.end());
+  }
+  std::sort(all.begin(), all.end());
+  auto percentile = [&all](double q) {
+    size_t rank = static_cast<size_t>(std::ceil(q * all.size()));
+    return all[std::min(std::max<size_t>(rank, 1), all.size()) - 1];
+  };
+  result->predictor = predictor;
+  result->num_threads = num_threads;
+  result->qps = qps;
+  result->num_requests = all.size();
+  result->mean = std::accumulate(all.begin(), all.end(), 0.) / all.size();
+  result->p50 = percentile(0.5);
+  result->p90 = percentile(0.9);
+  result->p99 = percentile(0.99);
+  result->p999 = percentile(0.999);
+  result->throughput = all.size() * FLAGS_batch_size / elapsed;
+  result->rss_mb = ResidentMemoryMB();
+  return true;
+}
+
+std::string BenchmarkResultToJson(const BenchmarkResult &result) {
+  std::ostringstream os;
+  os << "{\"predictor\": \"" << result.predictor
+     << "\", \"batch_size\": " << FLAGS_batch_size
+     << ", \"num_threads\": " << result.num_threads
+     << ", \"qps\": " << result.qps
+     << ", \"num_requests\": " << result.num_requests
+     << ", \"mean_ms\": " << result.mean << ", \"p50_ms\": " << result.p50
+     << ", \"p90_ms\": " << result.p90 << ", \"p99_ms\": " << result.p99
+     << ", \"p999_ms\": " << result.p999
+     << ", \"throughput\": " << result.throughput
+     << ", \"rss_mb\": " << result.rss_mb << "}";
+  return os.str();
+}
+
+// Benchmark the predictors of FLAGS_benchmark_predictors one by one under
+// the same load, and report them side by side.
+void BenchmarkPrediction(const AnalysisConfig &config,
+                         const std::vector<std::vector<PaddleTensor>> &inputs,
+                         int num_threads) {
+  std::vector<std::string> predictors;
+  split(FLAGS_benchmark_predictors, ',', &predictors);
+  std::vector<BenchmarkResult> results;
+  for (auto &predictor : predictors) {
+    BenchmarkResult result;
+    if (BenchmarkPredictor(config, inputs, predictor, num_threads, &result)) {
+      results.push_back(result);
+    }
+  }
+
+  std::ofstream report;
+  if (!FLAGS_benchmark_report.empty()) {
+    report.open(FLAGS_benchmark_report, std::ios::app);
+    CHECK(report.is_open()) << "Cannot open " << FLAGS_benchmark_report;
+  }
+  LOG(INFO) << "====== benchmark batch_size: " << FLAGS_batch_size
+            << ", threads: " << num_threads
+            << ", qps: " << FLAGS_benchmark_qps << " ======";
+  for (auto &result : results) {
+    LOG(INFO) << result.predictor << ": requests " << result.num_requests
+              << ", mean " << result.mean << "ms, p50 " << result.p50
+              << "ms, p90 " << result.p90 << "ms, p99 " << result.p99
+              << "ms, p999 " << result.p999 << "ms, throughput "
+              << result.throughput << " samples/s, rss " << result.rss_mb
+              << "MB";
+    if (report.is_open()) {
+      report << BenchmarkResultToJson(result) << "\n";
+    }
+  }
+}
+
 void TestPrediction(const AnalysisConfig &config,
                     const std::vector<std::vector<PaddleTensor>> &inputs,
                     std::vector<PaddleTensor> *outputs, int num_threads,
                     bool use_analysis = FLAGS_use_analysis) {
   LOG(INFO) << "use_analysis: " << use_analysis
             << ", use_mkldnn: " << config._use_mkldnn;
+  if (FLAGS_benchmark) {
+    BenchmarkPrediction(config, inputs, num_threads);
+  }
   if (num_threads == 1) {
     TestOneThreadPrediction(config, inputs, outputs, use_analysis);
   } else {
@@ -13,6 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/memory/detail/buddy_allocator.h"
+
+#include <algorithm>
+
 #include "glog/logging.h"
 
 DEFINE_bool(free_idle_memory, false,
@@ -49,17 +52,44 @@ inline size_t align(size_t size, size_t alignment) {
   return remaining == 0 ? size : size + (alignment - remaining);
 }
 
+size_t BuddyAllocator::ChunkSize(size_t unaligned_size) const {
+  return align(unaligned_size + sizeof(MemoryBlock::Desc), min_chunk_size_);
+}
+
+size_t BuddyAllocator::ChunkSize(void* p) {
+  auto block = static_cast<MemoryBlock*>(p)->metadata();
+  if (system_allocator_->UseGpu()) {
+    // The metadata of GPU chunks is kept in the locked cache_.
+    std::lock_guard<std::mutex> lock(mutex_);
+    return block->total_size(cache_);
+  }
+  return block->total_size(cache_);
+}
+
 void* BuddyAllocator::Alloc(size_t unaligned_size) {
   // adjust allocation alignment
-  size_t size =
-      align(unaligned_size + sizeof(MemoryBlock::Desc), min_chunk_size_);
+  size_t size = ChunkSize(unaligned_size);
 
   // acquire the allocator lock
   std::lock_guard<std::mutex> lock(mutex_);
 
   VLOG(10) << "Allocate " << unaligned_size << " bytes from chunk size "
            << size;
+  return AllocImpl(size);
+}
 
+size_t BuddyAllocator::AllocBatch(size_t chunk_size, size_t n, void** ptrs) {
+  PADDLE_ASSERT(chunk_size % min_chunk_size_ == 0);
+  std::lock_guard<std::mutex> lock(mutex_);
+  VLOG(10) << "Allocate " << n << " chunks of size " << chunk_size;
+  for (size_t i = 0; i < n; ++i) {
+    ptrs[i] = AllocImpl(chunk_size);
+    if (ptrs[i] == nullptr) return i;
+  }
+  return n;
+}
+
+void* BuddyAllocator::AllocImpl(size_t size) {
   // if the allocation is huge, send directly to the system allocator
   if (size > max_chunk_size_) {
     VLOG(10) << "Allocate from system allocator.";
@@ -90,11 +120,21 @@ void* BuddyAllocator::Alloc(size_t unaligned_size) {
 }
 
 void BuddyAllocator::Free(void* p) {
-  // Point back to metadata
-  auto block = static_cast<MemoryBlock*>(p)->metadata();
-
   // Acquire the allocator lock
   std::lock_guard<std::mutex> lock(mutex_);
+  FreeImpl(p);
+}
+
+void BuddyAllocator::FreeBatch(void* const* ptrs, size_t n) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = 0; i < n; ++i) {
+    FreeImpl(ptrs[i]);
+  }
+}
+
+void BuddyAllocator::FreeImpl(void* p) {
+  // Point back to metadata
+  auto block = static_cast<MemoryBlock*>(p)->metadata();
 
   VLOG(10) << "Free from address " << block;
 
@@ -155,6 +195,9 @@ void BuddyAllocator::Free(void* p) {
            << block->total_size(cache_) << ")";
   pool_.insert(
       IndexSizeAddress(block->index(cache_), block->total_size(cache_), block));
+  if (block->total_size(cache_) == max_chunk_size_) {
+    idle_since_[block] = std::chrono::steady_clock::now();
+  }
 
   if (FLAGS_free_idle_memory) {
     // Clean up if existing too much free memory
@@ -167,6 +210,16 @@ void BuddyAllocator::Free(void* p) {
 }
 
 size_t BuddyAllocator::Used() { return total_used_; }
+
+BuddyAllocator::Stats BuddyAllocator::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats{total_used_, total_free_, pool_.size(), 0};
+  for (auto& chunk : pool_) {
+    stats.largest_free_chunk =
+        std::max(stats.largest_free_chunk, std::get<1>(chunk));
+  }
+  return stats;
+}
 size_t BuddyAllocator::GetMinChunkSize() { return min_chunk_size_; }
 size_t BuddyAllocator::GetMaxChunkSize() { return max_chunk_size_; }
 
@@ -213,6 +266,7 @@ BuddyAllocator::PoolSet::iterator BuddyAllocator::RefillPool() {
   }
 
   total_free_ += max_chunk_size_;
+  idle_since_[p] = std::chrono::steady_clock::now();
 
   // dump the block into pool
   return pool_.insert(IndexSizeAddress(index, max_chunk_size_, p)).first;
@@ -244,6 +298,7 @@ void* BuddyAllocator::SplitToAlloc(BuddyAllocator::PoolSet::iterator it,
                                    size_t size) {
   auto block = static_cast<MemoryBlock*>(std::get<2>(*it));
   pool_.erase(it);
+  idle_since_.erase(block);
 
   VLOG(10) << "Split block (" << block << ", " << block->total_size(cache_)
            << ") into";
@@ -269,6 +324,33 @@ void* BuddyAllocator::SplitToAlloc(BuddyAllocator::PoolSet::iterator it,
   return block;
 }
 
+size_t BuddyAllocator::ReleaseIdle(
+    size_t reserve, std::chrono::steady_clock::duration idle_time) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto now = std::chrono::steady_clock::now();
+  size_t released = 0;
+  for (auto it = idle_since_.begin(); it != idle_since_.end();) {
+    if (total_free_ < reserve + max_chunk_size_) break;
+    if (now - it->second < idle_time) {
+      ++it;
+      continue;
+    }
+    auto block = static_cast<MemoryBlock*>(it->first);
+    size_t index = block->index(cache_);
+    VLOG(10) << "Release idle block " << block << " to system allocator.";
+    pool_.erase(IndexSizeAddress(index, max_chunk_size_, block));
+    system_allocator_->Free(block, max_chunk_size_, index);
+    cache_.invalidate(block);
+    if (system_allocator_->UseGpu() && index == 1) {
+      fallback_alloc_count_--;
+    }
+    total_free_ -= max_chunk_size_;
+    released += max_chunk_size_;
+    it = idle_since_.erase(it);
+  }
+  return released;
+}
+
 void BuddyAllocator::CleanIdleFallBackAlloc() {
   // If fallback allocation does not exist, return directly
   if (!fallback_alloc_count_) return;
@@ -288,6 +370,7 @@ void BuddyAllocator::CleanIdleFallBackAlloc() {
 
     system_allocator_->Free(block, max_chunk_size_, block->index(cache_));
     cache_.invalidate(block);
+    idle_since_.erase(block);
 
     pool = PoolSet::reverse_iterator(pool_.erase(std::next(pool).base()));
 
@@ -324,6 +407,7 @@ void BuddyAllocator::CleanIdleNormalAlloc() {
 
     system_allocator_->Free(block, max_chunk_size_, block->index(cache_));
     cache_.invalidate(block);
+    idle_since_.erase(block);
 
     pool = PoolSet::reverse_iterator(pool_.erase(std::next(pool).base()));
 
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <chrono>  // NOLINT
 #include <memory>
 #include <mutex>  // NOLINT
 #include <set>
@@ -45,12 +46,59 @@ class BuddyAllocator {
   size_t GetMinChunkSize();
   size_t GetMaxChunkSize();
 
+  /*! \brief The size of the chunk that serves an allocation */
+  size_t ChunkSize(size_t unaligned_size) const;
+
+  /*! \brief The size of the chunk that an allocated pointer belongs to */
+  size_t ChunkSize(void* ptr);
+
+  /**
+   *  \brief   Allocate several chunks of the same size with one lock.
+   *
+   *  \param   chunk_size  the chunk size returned by ChunkSize.
+   *
+   *  \return  the number of chunks allocated, which may be less than n when
+   *           the memory is exhausted.
+   */
+  size_t AllocBatch(size_t chunk_size, size_t n, void** ptrs);
+
+  /*! \brief Free several chunks with one lock */
+  void FreeBatch(void* const* ptrs, size_t n);
+
+  struct Stats {
+    size_t used;
+    size_t free;
+    size_t num_free_chunks;
+    size_t largest_free_chunk;
+  };
+
+  /*! \brief The used and free memory, and the fragmentation of the pool */
+  Stats GetStats();
+
+  /**
+   *  \brief   Return the wholly free system chunks to the system allocator.
+   *
+   *  \param   reserve    the free bytes that are kept in the pool.
+   *  \param   idle_time  how long a system chunk should have been wholly
+   *                      free before it is released.
+   *
+   *  \return  the bytes released.
+   */
+  size_t ReleaseIdle(size_t reserve,
+                     std::chrono::steady_clock::duration idle_time);
+
  public:
   // Disable copy and assignment
   BuddyAllocator(const BuddyAllocator&) = delete;
   BuddyAllocator& operator=(const BuddyAllocator&) = delete;
 
  private:
+  /*! \brief Allocate a chunk of the aligned size, the lock should be held */
+  void* AllocImpl(size_t size);
+
+  /*! \brief Free a chunk, the lock should be held */
+  void FreeImpl(void* ptr);
+
   // Tuple (allocator index, memory size, memory address)
   using IndexSizeAddress = std::tuple<size_t, size_t, void*>;
   // Each element in PoolSet is a free allocation
@@ -100,6 +148,10 @@ class BuddyAllocator {
   /*! Record fallback allocation count for auto-scaling */
   size_t fallback_alloc_count_ = 0;
 
+  /*! The time since when each wholly free system chunk has been free */
+  std::unordered_map<void*, std::chrono::steady_clock::time_point>
+      idle_since_;
+
  private:
   /*! Unify the metadata format between GPU and CPU allocations */
   MetadataCache cache_;
@@ -0,0 +1,69 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/memory/detail/buddy_allocator.h"
+
+#include <chrono>  // NOLINT
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace memory {
+namespace detail {
+
+static constexpr size_t kMinChunk = 1 << 12;
+static constexpr size_t kMaxChunk = 1 << 20;
+
+TEST(BuddyAllocator, ReleaseIdle) {
+  BuddyAllocator buddy(std::unique_ptr<SystemAllocator>(new CPUAllocator),
+                       kMinChunk, kMaxChunk);
+  // Every allocation takes a system chunk of its own.
+  std::vector<void*> ps;
+  for (int i = 0; i < 4; ++i) {
+    ps.push_back(buddy.Alloc(kMaxChunk / 2 + 1));
+    ASSERT_NE(ps.back(), nullptr);
+  }
+  for (auto* p : ps) buddy.Free(p);
+  EXPECT_EQ(buddy.GetStats().free, 4 * kMaxChunk);
+
+  // The chunks are not idle long enough.
+  EXPECT_EQ(buddy.ReleaseIdle(0, std::chrono::hours(1)), 0UL);
+
+  // The reserve is kept in the pool.
+  EXPECT_EQ(buddy.ReleaseIdle(kMaxChunk, std::chrono::milliseconds(0)),
+            3 * kMaxChunk);
+  EXPECT_EQ(buddy.GetStats().free, kMaxChunk);
+
+  // The pool refills after the release.
+  void* p = buddy.Alloc(kMaxChunk / 2 + 1);
+  void* q = buddy.Alloc(kMaxChunk / 2 + 1);
+  EXPECT_NE(p, nullptr);
+  EXPECT_NE(q, nullptr);
+  // The chunks in use are never released.
+  EXPECT_EQ(buddy.ReleaseIdle(0, std::chrono::milliseconds(0)), 0UL);
+  buddy.Free(p);
+  buddy.Free(q);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(buddy.ReleaseIdle(0, std::chrono::milliseconds(5)),
+            2 * kMaxChunk);
+  EXPECT_EQ(buddy.GetStats().free, 0UL);
+}
+
+}  // namespace detail
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,144 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/memory/detail/size_class_allocator.h"
+
+#include "glog/logging.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace memory {
+namespace detail {
+
+// The requests up to 2^kMinClassShift bytes share the smallest class.
+static constexpr size_t kMinClassShift = 8;
+// The number of classes in (2^p, 2^(p+1)].
+static constexpr size_t kClassesPerPower = 4;
+static constexpr size_t kNumClasses =
+    (64 - kMinClassShift) * kClassesPerPower + 1;
+
+static size_t FloorLog2(size_t x) {
+  size_t p = 0;
+  while (x >>= 1) ++p;
+  return p;
+}
+
+size_t SizeClassAllocator::ClassId(size_t size) {
+  if (size <= (1UL << kMinClassShift)) return 0;
+  // 2^p < size <= 2^(p+1), split into classes of step 2^p / 4.
+  size_t p = FloorLog2(size - 1);
+  size_t step = (1UL << p) / kClassesPerPower;
+  size_t k = (size - (1UL << p) + step - 1) / step;
+  return (p - kMinClassShift) * kClassesPerPower + k;
+}
+
+size_t SizeClassAllocator::SizeOfClass(size_t class_id) {
+  if (class_id == 0) return 1UL << kMinClassShift;
+  size_t p = kMinClassShift + (class_id - 1) / kClassesPerPower;
+  size_t k = (class_id - 1) % kClassesPerPower + 1;
+  return (1UL << p) + k * ((1UL << p) / kClassesPerPower);
+}
+
+size_t SizeClassAllocator::ClassSize(size_t size) {
+  return SizeOfClass(ClassId(size));
+}
+
+SizeClassAllocator::SizeClassAllocator(
+    std::unique_ptr<SystemAllocator> system_allocator, size_t max_cache_size)
+    : system_allocator_(std::move(system_allocator)),
+      max_cache_size_(max_cache_size),
+      free_lists_(kNumClasses) {}
+
+SizeClassAllocator::~SizeClassAllocator() {
+  Release();
+  if (!blocks_.empty()) {
+    VLOG(3) << blocks_.size() << " blocks are not freed before destroying "
+            << "the SizeClassAllocator";
+  }
+}
+
+void* SizeClassAllocator::Alloc(size_t unaligned_size) {
+  size_t class_id = ClassId(unaligned_size);
+  size_t size = SizeOfClass(class_id);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& list = free_lists_[class_id];
+  void* p = nullptr;
+  size_t index = 0;
+  if (!list.empty()) {
+    p = list.back().first;
+    index = list.back().second;
+    list.pop_back();
+    stats_.cached -= size;
+    ++stats_.hit_count;
+  } else {
+    p = system_allocator_->Alloc(&index, size);
+    if (p == nullptr && stats_.cached > 0) {
+      // The cached blocks of the other classes may make room for it.
+      ShrinkCache(0);
+      p = system_allocator_->Alloc(&index, size);
+    }
+    if (p == nullptr) return nullptr;
+    ++stats_.system_alloc_count;
+  }
+  blocks_[p] = Block{class_id, index};
+  stats_.used += size;
+  return p;
+}
+
+void SizeClassAllocator::Free(void* p) {
+  if (p == nullptr) return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = blocks_.find(p);
+  PADDLE_ENFORCE(it != blocks_.end(),
+                 "The memory is not allocated by the SizeClassAllocator");
+  size_t class_id = it->second.class_id;
+  size_t size = SizeOfClass(class_id);
+  free_lists_[class_id].emplace_back(p, it->second.index);
+  blocks_.erase(it);
+  stats_.used -= size;
+  stats_.cached += size;
+  if (stats_.cached > max_cache_size_) {
+    ShrinkCache(max_cache_size_);
+  }
+}
+
+void SizeClassAllocator::ShrinkCache(size_t limit) {
+  for (size_t i = kNumClasses; i > 0 && stats_.cached > limit; --i) {
+    auto& list = free_lists_[i - 1];
+    size_t size = SizeOfClass(i - 1);
+    while (!list.empty() && stats_.cached > limit) {
+      system_allocator_->Free(list.back().first, size, list.back().second);
+      list.pop_back();
+      stats_.cached -= size;
+      ++stats_.system_free_count;
+    }
+  }
+}
+
+size_t SizeClassAllocator::Release() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t cached = stats_.cached;
+  ShrinkCache(0);
+  return cached;
+}
+
+SizeClassAllocator::Stats SizeClassAllocator::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+}  // namespace detail
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,99 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "paddle/fluid/memory/detail/system_allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace detail {
+
+/**
+ * \brief A pool caching the freed blocks of a SystemAllocator by size class,
+ *        the fluid counterpart of the legacy PoolAllocator.
+ *
+ * Every request is rounded up to a size class, there are four classes
+ * between two powers of two, so a block wastes at most a quarter of its
+ * size. A freed block is kept in the free list of its class and served to
+ * the next request of the class, thus a training step that repeats the
+ * same allocations settles into zero system allocations after the first
+ * one. When the cached bytes exceed the limit, the largest cached blocks
+ * are returned to the system allocator.
+ */
+class SizeClassAllocator {
+ public:
+  struct Stats {
+    size_t used = 0;                // bytes of the blocks in use
+    size_t cached = 0;              // bytes in the free lists
+    size_t hit_count = 0;           // allocations served by the free lists
+    size_t system_alloc_count = 0;  // blocks allocated by the system
+    size_t system_free_count = 0;   // blocks returned to the system
+  };
+
+  /**
+   * \param system_allocator the allocator of the blocks.
+   * \param max_cache_size   the bytes that the free lists may hold.
+   */
+  SizeClassAllocator(std::unique_ptr<SystemAllocator> system_allocator,
+                     size_t max_cache_size);
+
+  ~SizeClassAllocator();
+
+  void* Alloc(size_t unaligned_size);
+  void Free(void* ptr);
+
+  /*! \brief Return all the cached blocks to the system, and their bytes */
+  size_t Release();
+
+  Stats GetStats();
+
+  /*! \brief The size of the class serving a request of size bytes */
+  static size_t ClassSize(size_t size);
+
+  // Disable copy and assignment
+  SizeClassAllocator(const SizeClassAllocator&) = delete;
+  SizeClassAllocator& operator=(const SizeClassAllocator&) = delete;
+
+ private:
+  // The block cached in a free list, with the index of the system allocator.
+  using CachedBlock = std::pair<void*, size_t>;
+  struct Block {
+    size_t class_id;
+    size_t index;
+  };
+
+  static size_t ClassId(size_t size);
+  static size_t SizeOfClass(size_t class_id);
+
+  /*! \brief Return the largest cached blocks until the cache fits in limit */
+  void ShrinkCache(size_t limit);
+
+  std::mutex mutex_;
+  std::unique_ptr<SystemAllocator> system_allocator_;
+  size_t max_cache_size_;
+  std::vector<std::vector<CachedBlock>> free_lists_;
+  std::unordered_map<void*, Block> blocks_;  // the blocks in use
+  Stats stats_;
+};
+
+}  // namespace detail
+}  // namespace memory
+}  // namespace paddle
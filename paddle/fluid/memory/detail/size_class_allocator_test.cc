@@ -0,0 +1,110 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/memory/detail/size_class_allocator.h"
+
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace memory {
+namespace detail {
+
+TEST(SizeClassAllocator, ClassSize) {
+  EXPECT_EQ(SizeClassAllocator::ClassSize(1), 256UL);
+  EXPECT_EQ(SizeClassAllocator::ClassSize(256), 256UL);
+  EXPECT_EQ(SizeClassAllocator::ClassSize(257), 320UL);
+  EXPECT_EQ(SizeClassAllocator::ClassSize(512), 512UL);
+  EXPECT_EQ(SizeClassAllocator::ClassSize(513), 640UL);
+  EXPECT_EQ(SizeClassAllocator::ClassSize(3 << 20), 3UL << 20);
+  for (size_t size = 1; size < (1 << 20); size = size * 3 / 2 + 1) {
+    size_t class_size = SizeClassAllocator::ClassSize(size);
+    EXPECT_GE(class_size, size);
+    // At most a quarter is wasted above the smallest class.
+    if (size > 256) EXPECT_LE(class_size, size + size / 4 + 1);
+  }
+}
+
+TEST(SizeClassAllocator, SteadyState) {
+  SizeClassAllocator allocator(
+      std::unique_ptr<SystemAllocator>(new CPUAllocator), 64 << 20);
+
+  // The first step allocates from the system, the next ones only reuse.
+  const std::vector<size_t> sizes = {100, 4096, 5000, 1 << 20, 3 << 20};
+  for (int step = 0; step < 3; ++step) {
+    std::vector<void*> ptrs;
+    for (size_t size : sizes) {
+      ptrs.push_back(allocator.Alloc(size));
+      ASSERT_NE(ptrs.back(), nullptr);
+    }
+    for (auto* p : ptrs) {
+      allocator.Free(p);
+    }
+    EXPECT_EQ(allocator.GetStats().system_alloc_count, sizes.size());
+  }
+  auto stats = allocator.GetStats();
+  EXPECT_EQ(stats.used, 0UL);
+  EXPECT_EQ(stats.hit_count, 2 * sizes.size());
+  EXPECT_EQ(stats.system_free_count, 0UL);
+
+  EXPECT_EQ(allocator.Release(), stats.cached);
+  EXPECT_EQ(allocator.GetStats().cached, 0UL);
+  EXPECT_EQ(allocator.GetStats().system_free_count, sizes.size());
+}
+
+TEST(SizeClassAllocator, BoundedCache) {
+  SizeClassAllocator allocator(
+      std::unique_ptr<SystemAllocator>(new CPUAllocator), 16 << 10);
+
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; ++i) {
+    ptrs.push_back(allocator.Alloc(1 << 10));
+  }
+  for (auto* p : ptrs) {
+    allocator.Free(p);
+  }
+  auto stats = allocator.GetStats();
+  EXPECT_LE(stats.cached, 16UL << 10);
+  EXPECT_EQ(stats.system_free_count, 48UL);
+  EXPECT_EQ(stats.used, 0UL);
+}
+
+TEST(SizeClassAllocator, MultiThreads) {
+  SizeClassAllocator allocator(
+      std::unique_ptr<SystemAllocator>(new CPUAllocator), 64 << 20);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&allocator, t] {
+      for (int i = 0; i < 1000; ++i) {
+        size_t size = ((i + t) % 16 + 1) * 1000;
+        void* p = allocator.Alloc(size);
+        ASSERT_NE(p, nullptr);
+        static_cast<char*>(p)[size - 1] = 1;
+        allocator.Free(p);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(allocator.GetStats().used, 0UL);
+}
+
+}  // namespace detail
+}  // namespace memory
+}  // namespace paddle
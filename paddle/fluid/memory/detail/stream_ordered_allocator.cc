@@ -0,0 +1,179 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/memory/detail/stream_ordered_allocator.h"
+
+#include "glog/logging.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/gpu_info.h"
+
+namespace paddle {
+namespace memory {
+namespace detail {
+
+// A cached chunk is reused only when it is at most this times bigger than
+// the requested chunk, so that small requests do not hold big chunks.
+static constexpr size_t kMaxChunkWasteRatio = 2;
+
+StreamOrderedAllocator::StreamOrderedAllocator(BuddyAllocator* buddy,
+                                               int device_id,
+                                               size_t max_cached_size)
+    : buddy_(buddy), device_id_(device_id), max_cached_size_(max_cached_size) {}
+
+StreamOrderedAllocator::~StreamOrderedAllocator() {
+  ReleaseAll();
+  std::lock_guard<std::mutex> lock(mutex_);
+  platform::SetDeviceId(device_id_);
+  for (auto event : idle_events_) {
+    PADDLE_ENFORCE(cudaEventDestroy(event));
+  }
+}
+
+cudaEvent_t StreamOrderedAllocator::NewEvent() {
+  if (!idle_events_.empty()) {
+    auto event = idle_events_.back();
+    idle_events_.pop_back();
+    return event;
+  }
+  cudaEvent_t event;
+  platform::SetDeviceId(device_id_);
+  PADDLE_ENFORCE(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+  return event;
+}
+
+void StreamOrderedAllocator::RecycleEvent(cudaEvent_t event) {
+  idle_events_.push_back(event);
+}
+
+void* StreamOrderedAllocator::TakeChunk(FreeList* list, size_t size,
+                                        cudaStream_t stream,
+                                        bool same_stream) {
+  auto it = list->lower_bound(size);
+  if (it == list->end() || it->first > size * kMaxChunkWasteRatio) {
+    return nullptr;
+  }
+  auto chunk = it->second;
+  if (!same_stream && cudaEventQuery(chunk.event) != cudaSuccess) {
+    // The chunk may still be used by the kernels of the other stream.
+    PADDLE_ENFORCE(cudaStreamWaitEvent(stream, chunk.event, 0));
+  }
+  cached_size_ -= it->first;
+  list->erase(it);
+  RecycleEvent(chunk.event);
+  return chunk.ptr;
+}
+
+void* StreamOrderedAllocator::Alloc(size_t unaligned_size,
+                                    cudaStream_t stream) {
+  size_t size = buddy_->ChunkSize(unaligned_size);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& list = free_lists_[stream];
+    void* p = TakeChunk(&list, size, stream, true);
+    if (p != nullptr) {
+      VLOG(10) << "Reuse chunk " << p << " on the same stream " << stream;
+      return p;
+    }
+    for (auto& item : free_lists_) {
+      if (item.first == stream) continue;
+      p = TakeChunk(&item.second, size, stream, false);
+      if (p != nullptr) {
+        VLOG(10) << "Reuse chunk " << p << " of stream " << item.first
+                 << " on stream " << stream;
+        return p;
+      }
+    }
+  }
+
+  void* p = buddy_->Alloc(unaligned_size);
+  if (p == nullptr && ReleaseAll() > 0) {
+    // Retry after all the cached chunks are returned to the buddy allocator.
+    p = buddy_->Alloc(unaligned_size);
+  }
+  return p;
+}
+
+void StreamOrderedAllocator::Free(void* p, cudaStream_t stream) {
+  size_t size = buddy_->ChunkSize(p);
+  if (size > buddy_->GetMaxChunkSize()) {
+    // Huge chunks are returned to cudaFree, which synchronizes the device.
+    buddy_->Free(p);
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto event = NewEvent();
+  PADDLE_ENFORCE(cudaEventRecord(event, stream));
+  free_lists_[stream].emplace(size, Chunk{p, event});
+  cached_size_ += size;
+
+  if (cached_size_ > max_cached_size_) {
+    Release([](const Chunk& chunk) {
+      return cudaEventQuery(chunk.event) == cudaSuccess;
+    });
+  }
+}
+
+template <typename Predicate>
+size_t StreamOrderedAllocator::Release(Predicate&& pred) {
+  std::vector<void*> chunks;
+  for (auto& item : free_lists_) {
+    auto& list = item.second;
+    for (auto it = list.begin(); it != list.end();) {
+      if (pred(it->second)) {
+        chunks.push_back(it->second.ptr);
+        cached_size_ -= it->first;
+        RecycleEvent(it->second.event);
+        it = list.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  if (!chunks.empty()) {
+    VLOG(10) << "Release " << chunks.size() << " chunks to BuddyAllocator";
+    buddy_->FreeBatch(chunks.data(), chunks.size());
+  }
+  return chunks.size();
+}
+
+size_t StreamOrderedAllocator::ReleaseIdle() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return Release([](const Chunk& chunk) {
+    return cudaEventQuery(chunk.event) == cudaSuccess;
+  });
+}
+
+size_t StreamOrderedAllocator::ReleaseAll() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return Release([](const Chunk& chunk) {
+    PADDLE_ENFORCE(cudaEventSynchronize(chunk.event));
+    return true;
+  });
+}
+
+size_t StreamOrderedAllocator::Used() {
+  size_t used = buddy_->Used();
+  size_t cached = CachedSize();
+  return used > cached ? used - cached : 0;
+}
+
+size_t StreamOrderedAllocator::CachedSize() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cached_size_;
+}
+
+}  // namespace detail
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,108 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#ifdef PADDLE_WITH_CUDA
+#include <cuda_runtime.h>
+
+#include <map>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/memory/detail/buddy_allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace detail {
+
+/**
+ * \brief A stream-ordered front end of the GPU BuddyAllocator.
+ *
+ * A chunk freed on a CUDA stream is kept in the free list of that stream,
+ * together with an event recorded on the stream at the time of Free. An
+ * allocation on the same stream reuses the chunk at once: the kernels that
+ * used the chunk are ordered before the new user by the stream itself. An
+ * allocation on another stream reuses it only after making the stream wait
+ * for the event, which is device-side and never blocks the host. Chunks go
+ * back to the buddy allocator only after their events have completed.
+ *
+ * With this allocator the memory of a deleted tensor can be released as
+ * soon as the last kernel using it has been enqueued, without waiting for
+ * the stream.
+ */
+class StreamOrderedAllocator {
+ public:
+  /**
+   * \param buddy            the GPU allocator that owns the chunks.
+   * \param device_id        the GPU of the buddy allocator.
+   * \param max_cached_size  the bytes that may be kept in the free lists.
+   */
+  StreamOrderedAllocator(BuddyAllocator* buddy, int device_id,
+                         size_t max_cached_size);
+
+  ~StreamOrderedAllocator();
+
+  void* Alloc(size_t unaligned_size, cudaStream_t stream);
+  void Free(void* ptr, cudaStream_t stream);
+
+  /*! \brief Return the cached chunks whose last use has completed */
+  size_t ReleaseIdle();
+
+  /*! \brief Wait for all the cached chunks and return them all */
+  size_t ReleaseAll();
+
+  /*! \brief The used memory, excluding the cached chunks */
+  size_t Used();
+
+  size_t CachedSize();
+
+  // Disable copy and assignment
+  StreamOrderedAllocator(const StreamOrderedAllocator&) = delete;
+  StreamOrderedAllocator& operator=(const StreamOrderedAllocator&) = delete;
+
+ private:
+  struct Chunk {
+    void* ptr;
+    cudaEvent_t event;  // recorded on the freeing stream
+  };
+  // Free chunks of one stream, ordered by chunk size.
+  using FreeList = std::multimap<size_t, Chunk>;
+
+  /*! \brief Take a chunk of at least size bytes from a free list */
+  void* TakeChunk(FreeList* list, size_t size, cudaStream_t stream,
+                  bool same_stream);
+
+  /*! \brief Release the chunks that satisfy the predicate to buddy */
+  template <typename Predicate>
+  size_t Release(Predicate&& pred);
+
+  cudaEvent_t NewEvent();
+  void RecycleEvent(cudaEvent_t event);
+
+  BuddyAllocator* buddy_;
+  int device_id_;
+  size_t max_cached_size_;
+  size_t cached_size_ = 0;
+
+  std::unordered_map<cudaStream_t, FreeList> free_lists_;
+  std::vector<cudaEvent_t> idle_events_;
+  std::mutex mutex_;
+};
+
+}  // namespace detail
+}  // namespace memory
+}  // namespace paddle
+#endif
@@ -20,9 +20,14 @@ limitations under the License. */
 #include <windows.h>  // VirtualLock/VirtualUnlock
 #else
 #include <sys/mman.h>  // for mlock and munlock
+#include <unistd.h>    // for sysconf
 #endif
 #include <stdlib.h>   // for malloc and free
 #include <algorithm>  // for std::max
+#include <atomic>
+#include <map>
+#include <mutex>  // NOLINT
+#include <utility>
 
 #include "gflags/gflags.h"
 #include "paddle/fluid/platform/assert.h"
@@ -36,6 +41,12 @@ limitations under the License. */
 // of memory available to the system for paging.  So, by default, we
 // should set false to use_pinned_memory.
 DEFINE_bool(use_pinned_memory, true, "If set, allocate cpu pinned memory.");
+DEFINE_string(cpu_huge_pages, "",
+              "How the big CPU chunks are backed by huge pages. It is empty "
+              "to use the normal pages, 'madvise' to map the chunks advised "
+              "to use the transparent huge pages, or 'hugetlb' to map them "
+              "from the reserved 2MB or 1GB huge pages, falling back to "
+              "'madvise' when no huge pages are reserved.");
 DECLARE_double(fraction_of_gpu_memory_to_use);
 namespace paddle {
 namespace memory {
@@ -59,19 +70,116 @@ void* AlignedMalloc(size_t size) {
   return p;
 }
 
+namespace {
+
+constexpr size_t kHugePageSize = 2ul << 20;
+constexpr size_t kGiantPageSize = 1ul << 30;
+
+// How a host region is mapped, which is kept in the index of its chunk.
+enum HostRegionKind : size_t {
+  kMallocRegion = 0,     // the heap of malloc, or cudaMallocHost
+  kPageRegion = 1,       // mmap of the normal pages advised MADV_HUGEPAGE
+  kHugePageRegion = 2,   // mmap of the 2MB pages of MAP_HUGETLB
+  kGiantPageRegion = 3,  // mmap of the 1GB pages of MAP_HUGETLB
+};
+
+size_t HostRegionSize(size_t size, HostRegionKind kind) {
+  size_t page = kind == kGiantPageRegion ? kGiantPageSize : kHugePageSize;
+  return (size + page - 1) / page * page;
+}
+
+#ifndef _WIN32
+void* MapHostRegion(size_t size, HostRegionKind kind) {
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  if (kind == kHugePageRegion || kind == kGiantPageRegion) {
+#ifdef MAP_HUGETLB
+    flags |= MAP_HUGETLB;
+#if defined(MAP_HUGE_SHIFT)
+    flags |= (kind == kGiantPageRegion ? 30 : 21) << MAP_HUGE_SHIFT;
+#else
+    if (kind == kGiantPageRegion) return nullptr;
+#endif
+#else
+    return nullptr;
+#endif
+  }
+  size_t region_size = HostRegionSize(size, kind);
+  void* p =
+      mmap(nullptr, region_size, PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (p == MAP_FAILED) return nullptr;
+#ifdef MADV_HUGEPAGE
+  if (kind == kPageRegion) madvise(p, region_size, MADV_HUGEPAGE);
+#endif
+  return p;
+}
+#endif
+
+// Map a region of size bytes aligned to the huge pages, from the reserved
+// huge pages if hugetlb is true and there are some, otherwise from the
+// transparent ones. The 1GB pages are only used when they waste less than
+// 1/8 of the region.
+void* MapHugePageRegion(size_t size, bool hugetlb, HostRegionKind* kind) {
+#ifdef _WIN32
+  return nullptr;
+#else
+  void* p = nullptr;
+  if (hugetlb) {
+    if (size >= kGiantPageSize &&
+        HostRegionSize(size, kGiantPageRegion) - size < size / 8) {
+      *kind = kGiantPageRegion;
+      p = MapHostRegion(size, *kind);
+    }
+    if (p == nullptr) {
+      *kind = kHugePageRegion;
+      p = MapHostRegion(size, *kind);
+    }
+  }
+  if (p == nullptr) {
+    *kind = kPageRegion;
+    p = MapHostRegion(size, *kind);
+  }
+  return p;
+#endif
+}
+
+void UnmapHugePageRegion(void* p, size_t size, HostRegionKind kind) {
+#ifndef _WIN32
+  munmap(p, HostRegionSize(size, kind));
+#endif
+}
+
+}  // namespace
+
 void* CPUAllocator::Alloc(size_t* index, size_t size) {
   // According to http://www.cplusplus.com/reference/cstdlib/malloc/,
   // malloc might not return nullptr if size is zero, but the returned
   // pointer shall not be dereferenced -- so we make it nullptr.
   if (size <= 0) return nullptr;
 
+  // The lowest bit of the index tells whether the chunk is locked, and the
+  // others the kind of its region.
   *index = 0;  // unlock memory
 
-  void* p = AlignedMalloc(size);
+  void* p = nullptr;
+  HostRegionKind kind = kMallocRegion;
+  if (!FLAGS_cpu_huge_pages.empty() && size >= kHugePageSize) {
+    PADDLE_ENFORCE(FLAGS_cpu_huge_pages == "madvise" ||
+                       FLAGS_cpu_huge_pages == "hugetlb",
+                   "Unknown cpu_huge_pages %s", FLAGS_cpu_huge_pages);
+    p = MapHugePageRegion(size, FLAGS_cpu_huge_pages == "hugetlb", &kind);
+    if (p == nullptr) {
+      kind = kMallocRegion;
+      VLOG(3) << "Fail to map " << size << " bytes of huge pages";
+    }
+  }
+  if (p == nullptr) {
+    p = AlignedMalloc(size);
+  }
+  *index = kind << 1;
 
   if (p != nullptr) {
     if (FLAGS_use_pinned_memory) {
-      *index = 1;
+      *index |= 1;
 #ifdef _WIN32
       VirtualLock(p, size);
 #else
@@ -84,18 +192,103 @@ void* CPUAllocator::Alloc(size_t* index, size_t size) {
 }
 
 void CPUAllocator::Free(void* p, size_t size, size_t index) {
-  if (p != nullptr && index == 1) {
+  if (p != nullptr && (index & 1)) {
 #ifdef _WIN32
     VirtualUnlock(p, size);
 #else
     munlock(p, size);
 #endif
   }
-  free(p);
+  auto kind = static_cast<HostRegionKind>(index >> 1);
+  if (kind == kMallocRegion) {
+    free(p);
+  } else {
+    UnmapHugePageRegion(p, size, kind);
+  }
 }
 
 bool CPUAllocator::UseGpu() const { return false; }
 
+namespace {
+
+// The memory allocated by the NumaCPUAllocators, begin -> (end, node).
+struct NumaRegions {
+  std::mutex mutex;
+  std::map<uintptr_t, std::pair<uintptr_t, int>> regions;
+  std::atomic<bool> used{false};
+
+  static NumaRegions& Instance() {
+    static NumaRegions* instance = new NumaRegions;
+    return *instance;
+  }
+};
+
+}  // namespace
+
+void* NumaCPUAllocator::Alloc(size_t* index, size_t size) {
+  if (size <= 0) return nullptr;
+  *index = 0;
+#ifdef _WIN32
+  void* p = AlignedMalloc(size);
+  if (FLAGS_use_pinned_memory) {
+    *index = 1;
+    VirtualLock(p, size);
+  }
+#else
+  // mbind requires the page aligned memory.
+  size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_t aligned_size = (size + page_size - 1) / page_size * page_size;
+  void* p = nullptr;
+  PADDLE_ENFORCE_EQ(posix_memalign(&p, page_size, aligned_size), 0,
+                    "Alloc %ld error!", size);
+  PADDLE_ENFORCE(p, "Fail to allocate CPU memory: size = %d .", size);
+  if (!platform::BindMemoryToNumaNode(p, aligned_size, node_)) {
+    VLOG(3) << "Fail to bind " << size << " bytes to the NUMA node " << node_;
+  }
+  if (FLAGS_use_pinned_memory) {
+    *index = 1;
+    mlock(p, size);
+  }
+#endif
+
+  auto& numa = NumaRegions::Instance();
+  std::lock_guard<std::mutex> lock(numa.mutex);
+  auto begin = reinterpret_cast<uintptr_t>(p);
+  numa.regions[begin] = std::make_pair(begin + size, node_);
+  numa.used = true;
+  return p;
+}
+
+void NumaCPUAllocator::Free(void* p, size_t size, size_t index) {
+  if (p == nullptr) return;
+  {
+    auto& numa = NumaRegions::Instance();
+    std::lock_guard<std::mutex> lock(numa.mutex);
+    numa.regions.erase(reinterpret_cast<uintptr_t>(p));
+  }
+  if (index == 1) {
+#ifdef _WIN32
+    VirtualUnlock(p, size);
+#else
+    munlock(p, size);
+#endif
+  }
+  free(p);
+}
+
+bool NumaCPUAllocator::UseGpu() const { return false; }
+
+int NumaCPUAllocator::NodeOf(const void* p) {
+  auto& numa = NumaRegions::Instance();
+  if (!numa.used) return -1;
+  auto addr = reinterpret_cast<uintptr_t>(p);
+  std::lock_guard<std::mutex> lock(numa.mutex);
+  auto it = numa.regions.upper_bound(addr);
+  if (it == numa.regions.begin()) return -1;
+  --it;
+  return addr < it->second.first ? it->second.second : -1;
+}
+
 #ifdef PADDLE_WITH_CUDA
 
 void* GPUAllocator::Alloc(size_t* index, size_t size) {
@@ -208,6 +401,70 @@ void CUDAPinnedAllocator::Free(void* p, size_t size, size_t index) {
 
 bool CUDAPinnedAllocator::UseGpu() const { return false; }
 
+void* CUDAHostRegisterAllocator::Alloc(size_t* index, size_t size) {
+  if (size <= 0) return nullptr;
+
+  size_t usable =
+      paddle::platform::CUDAPinnedMaxAllocSize() - registered_size_;
+  if (size > usable) {
+    LOG(WARNING) << "Cannot register " << size / 1024.0 / 1024.0
+                 << " MB pinned memory."
+                 << ", available " << usable / 1024.0 / 1024.0 << " MB";
+    return nullptr;
+  }
+
+  void* p = nullptr;
+  HostRegionKind kind = kMallocRegion;
+#ifdef _WIN32
+  if (cudaMallocHost(&p, size) != cudaSuccess) {
+    LOG(WARNING) << "cudaMallocHost failed.";
+    return nullptr;
+  }
+#else
+  p = MapHugePageRegion(size, true, &kind);
+  if (p == nullptr) {
+    LOG(WARNING) << "Cannot map " << size << " bytes host memory.";
+    return nullptr;
+  }
+
+  // The registered memory is visible to all CUDA contexts.
+  cudaError_t result = cudaHostRegister(p, size, cudaHostRegisterPortable);
+  if (result != cudaSuccess) {
+    LOG(WARNING) << "cudaHostRegister failed: "
+                 << cudaGetErrorString(result);
+    UnmapHugePageRegion(p, size, kind);
+    return nullptr;
+  }
+#endif
+  *index = kind;
+
+  VLOG(10) << "Register " << size << " bytes host memory of kind " << *index;
+  registered_size_ += size;
+  return p;
+}
+
+void CUDAHostRegisterAllocator::Free(void* p, size_t size, size_t index) {
+  PADDLE_ASSERT(registered_size_ >= size);
+  registered_size_ -= size;
+
+  auto kind = static_cast<HostRegionKind>(index);
+  cudaError_t err;
+  if (kind == kMallocRegion) {
+    err = cudaFreeHost(p);
+  } else {
+    err = cudaHostUnregister(p);
+  }
+  // Allow cudaErrorCudartUnloading as CUDAPinnedAllocator::Free does.
+  if (err != cudaErrorCudartUnloading) {
+    PADDLE_ENFORCE(err, "Fail to release the pinned memory.");
+  }
+  if (kind != kMallocRegion) {
+    UnmapHugePageRegion(p, size, kind);
+  }
+}
+
+bool CUDAHostRegisterAllocator::UseGpu() const { return false; }
+
 #endif
 
 }  // namespace detail
@@ -41,6 +41,24 @@ class CPUAllocator : public SystemAllocator {
   virtual bool UseGpu() const;
 };
 
+// Allocate the CPU memory bound to a NUMA node, the arena of the threads
+// bound to the node by platform::BindCurrentThreadToNumaNode.
+class NumaCPUAllocator : public SystemAllocator {
+ public:
+  explicit NumaCPUAllocator(int node) : node_(node) {}
+
+  virtual void* Alloc(size_t* index, size_t size);
+  virtual void Free(void* p, size_t size, size_t index);
+  virtual bool UseGpu() const;
+
+  // The node of the memory allocated by a NumaCPUAllocator that p points
+  // into, -1 if p is not allocated by any of them.
+  static int NodeOf(const void* p);
+
+ private:
+  int node_;
+};
+
 #ifdef PADDLE_WITH_CUDA
 class GPUAllocator : public SystemAllocator {
  public:
@@ -65,6 +83,20 @@ class CUDAPinnedAllocator : public SystemAllocator {
  private:
   size_t cuda_pinnd_alloc_size_ = 0;
 };
+
+// Map the host regions backed by huge pages when the system has them, and
+// page-lock them by cudaHostRegister. The regions are meant to be big, so
+// the cost of registering is paid once for many chunks, and the transfers
+// touch fewer TLB entries than the ones from cudaMallocHost.
+class CUDAHostRegisterAllocator : public SystemAllocator {
+ public:
+  virtual void* Alloc(size_t* index, size_t size);
+  virtual void Free(void* p, size_t size, size_t index);
+  virtual bool UseGpu() const;
+
+ private:
+  size_t registered_size_ = 0;
+};
 #endif
 
 }  // namespace detail
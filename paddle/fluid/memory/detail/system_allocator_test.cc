@@ -21,6 +21,7 @@ limitations under the License. */
 #include "gtest/gtest.h"
 
 DECLARE_bool(use_pinned_memory);
+DECLARE_string(cpu_huge_pages);
 
 void TestAllocator(paddle::memory::detail::SystemAllocator* a, size_t size) {
   bool freed = false;
@@ -56,10 +57,55 @@ TEST(CPUAllocator, LockMem) {
   TestAllocator(&a, 0);
 }
 
+TEST(CPUAllocator, HugePages) {
+  FLAGS_use_pinned_memory = false;
+  paddle::memory::detail::CPUAllocator a;
+  // Without reserved huge pages hugetlb falls back to madvise.
+  for (auto mode : {"madvise", "hugetlb"}) {
+    FLAGS_cpu_huge_pages = mode;
+    TestAllocator(&a, 2048);
+    TestAllocator(&a, 4 << 20);
+    TestAllocator(&a, (4 << 20) + 1);
+  }
+  FLAGS_use_pinned_memory = true;
+  TestAllocator(&a, 4 << 20);
+  FLAGS_cpu_huge_pages = "";
+}
+
+TEST(NumaCPUAllocator, Alloc) {
+  FLAGS_use_pinned_memory = false;
+  paddle::memory::detail::NumaCPUAllocator a(0);
+  TestAllocator(&a, 2048);
+  TestAllocator(&a, 0);
+}
+
+TEST(NumaCPUAllocator, NodeOf) {
+  FLAGS_use_pinned_memory = false;
+  using paddle::memory::detail::NumaCPUAllocator;
+  NumaCPUAllocator a(0);
+  size_t index;
+  char* p = static_cast<char*>(a.Alloc(&index, 2048));
+  EXPECT_EQ(NumaCPUAllocator::NodeOf(p), 0);
+  EXPECT_EQ(NumaCPUAllocator::NodeOf(p + 2047), 0);
+  EXPECT_EQ(NumaCPUAllocator::NodeOf(p + 2048), -1);
+  a.Free(p, 2048, index);
+  EXPECT_EQ(NumaCPUAllocator::NodeOf(p), -1);
+
+  int x;
+  EXPECT_EQ(NumaCPUAllocator::NodeOf(&x), -1);
+}
+
 #ifdef PADDLE_WITH_CUDA
 TEST(GPUAllocator, Alloc) {
   paddle::memory::detail::GPUAllocator a(0);
   TestAllocator(&a, 2048);
   TestAllocator(&a, 0);
 }
+
+TEST(CUDAHostRegisterAllocator, Alloc) {
+  paddle::memory::detail::CUDAHostRegisterAllocator a;
+  TestAllocator(&a, 2048);
+  TestAllocator(&a, 4 << 20);
+  TestAllocator(&a, 0);
+}
 #endif
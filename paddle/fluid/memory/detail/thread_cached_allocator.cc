@@ -0,0 +1,188 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/memory/detail/thread_cached_allocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+#include "glog/logging.h"
+
+namespace paddle {
+namespace memory {
+namespace detail {
+
+// The maximum number of chunks fetched from the buddy allocator to refill an
+// empty free list.
+static constexpr size_t kMaxRefillBatch = 8;
+
+struct ThreadCachedAllocator::Shared {
+  explicit Shared(BuddyAllocator* b) : buddy(b) {}
+
+  BuddyAllocator* buddy;
+  std::atomic<size_t> total_cached_size{0};
+  // Guards alive against the releases done when the cache threads exit.
+  std::mutex mutex;
+  bool alive{true};
+};
+
+struct ThreadCachedAllocator::ThreadCache {
+  ThreadCache(std::shared_ptr<Shared> s, size_t num_classes)
+      : shared(std::move(s)), free_lists(num_classes) {}
+
+  ~ThreadCache() {
+    std::lock_guard<std::mutex> lock(shared->mutex);
+    if (!shared->alive) return;
+    for (auto& list : free_lists) {
+      if (!list.empty()) {
+        shared->buddy->FreeBatch(list.data(), list.size());
+      }
+    }
+    shared->total_cached_size -= stats.cached_size;
+  }
+
+  std::shared_ptr<Shared> shared;
+  std::vector<std::vector<void*>> free_lists;
+  ThreadCacheStats stats;
+};
+
+ThreadCachedAllocator::ThreadCachedAllocator(BuddyAllocator* buddy,
+                                             size_t max_class_size,
+                                             size_t max_thread_cache_size)
+    : buddy_(buddy),
+      class_size_(buddy->GetMinChunkSize()),
+      num_classes_(max_class_size / buddy->GetMinChunkSize()),
+      max_thread_cache_size_(max_thread_cache_size),
+      shared_(new Shared(buddy)) {
+  VLOG(10) << "ThreadCachedAllocator with " << num_classes_
+           << " size classes of step " << class_size_;
+}
+
+ThreadCachedAllocator::~ThreadCachedAllocator() {
+  // Return the chunks cached by this thread, the chunks cached by other
+  // threads are dropped together with the buddy allocator.
+  auto* cache = GetThreadCache();
+  for (size_t i = 0; i < num_classes_; ++i) {
+    auto& list = cache->free_lists[i];
+    if (!list.empty()) {
+      buddy_->FreeBatch(list.data(), list.size());
+      shared_->total_cached_size -= list.size() * (i + 1) * class_size_;
+      list.clear();
+    }
+  }
+  cache->stats.cached_size = 0;
+
+  std::lock_guard<std::mutex> lock(shared_->mutex);
+  shared_->alive = false;
+}
+
+ThreadCachedAllocator::ThreadCache* ThreadCachedAllocator::GetThreadCache() {
+  static thread_local std::unordered_map<const Shared*,
+                                         std::unique_ptr<ThreadCache>>
+      caches;
+  auto& cache = caches[shared_.get()];
+  if (cache == nullptr) {
+    cache.reset(new ThreadCache(shared_, num_classes_));
+  }
+  return cache.get();
+}
+
+void* ThreadCachedAllocator::Alloc(size_t unaligned_size) {
+  size_t class_id = buddy_->ChunkSize(unaligned_size) / class_size_ - 1;
+  if (class_id >= num_classes_) {
+    return buddy_->Alloc(unaligned_size);
+  }
+
+  size_t size = (class_id + 1) * class_size_;
+  auto* cache = GetThreadCache();
+  auto& list = cache->free_lists[class_id];
+  if (!list.empty()) {
+    void* p = list.back();
+    list.pop_back();
+    cache->stats.cached_size -= size;
+    shared_->total_cached_size -= size;
+    ++cache->stats.hit_count;
+    return p;
+  }
+
+  ++cache->stats.miss_count;
+  size_t budget = max_thread_cache_size_ > cache->stats.cached_size
+                      ? max_thread_cache_size_ - cache->stats.cached_size
+                      : 0;
+  size_t batch = std::min(kMaxRefillBatch, budget / size + 1);
+  void* chunks[kMaxRefillBatch];
+  size_t num = buddy_->AllocBatch(size, batch, chunks);
+  if (num == 0) return nullptr;
+  list.insert(list.end(), chunks + 1, chunks + num);
+  cache->stats.cached_size += (num - 1) * size;
+  shared_->total_cached_size += (num - 1) * size;
+  return chunks[0];
+}
+
+void ThreadCachedAllocator::Free(void* p) {
+  size_t class_id = buddy_->ChunkSize(p) / class_size_ - 1;
+  if (class_id >= num_classes_) {
+    buddy_->Free(p);
+    return;
+  }
+
+  size_t size = (class_id + 1) * class_size_;
+  auto* cache = GetThreadCache();
+  cache->free_lists[class_id].push_back(p);
+  cache->stats.cached_size += size;
+  shared_->total_cached_size += size;
+
+  if (cache->stats.cached_size > max_thread_cache_size_) {
+    Release(cache, class_id);
+    // Release the other classes too if the current one is not enough.
+    for (size_t i = 0; i < num_classes_ &&
+                       cache->stats.cached_size > max_thread_cache_size_;
+         ++i) {
+      Release(cache, i);
+    }
+  }
+}
+
+void ThreadCachedAllocator::Release(ThreadCache* cache, size_t class_id) {
+  auto& list = cache->free_lists[class_id];
+  size_t num = (list.size() + 1) / 2;
+  if (num == 0) return;
+  buddy_->FreeBatch(list.data() + list.size() - num, num);
+  list.resize(list.size() - num);
+
+  size_t size = num * (class_id + 1) * class_size_;
+  cache->stats.cached_size -= size;
+  shared_->total_cached_size -= size;
+  ++cache->stats.release_count;
+}
+
+size_t ThreadCachedAllocator::Used() {
+  size_t used = buddy_->Used();
+  size_t cached = CachedSize();
+  return used > cached ? used - cached : 0;
+}
+
+size_t ThreadCachedAllocator::CachedSize() const {
+  return shared_->total_cached_size;
+}
+
+ThreadCacheStats ThreadCachedAllocator::ThreadStats() {
+  return GetThreadCache()->stats;
+}
+
+}  // namespace detail
+}  // namespace memory
+}  // namespace paddle
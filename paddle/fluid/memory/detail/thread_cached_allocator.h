@@ -0,0 +1,97 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "paddle/fluid/memory/detail/buddy_allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace detail {
+
+/**
+ * \brief Per-thread statistics of a ThreadCachedAllocator.
+ */
+struct ThreadCacheStats {
+  size_t cached_size = 0;    // bytes held in the thread's free lists
+  size_t hit_count = 0;      // allocations served by the free lists
+  size_t miss_count = 0;     // allocations that went to the buddy allocator
+  size_t release_count = 0;  // batches released back to the buddy allocator
+};
+
+/**
+ * \brief A thread-caching front end of BuddyAllocator, similar to tcmalloc.
+ *
+ * Small chunks are kept in per-thread free lists indexed by size class,
+ * where a size class is a multiple of the minimum chunk size of the buddy
+ * allocator. Allocations and frees of small chunks do not take the lock of
+ * the buddy allocator, which is only visited to refill or release a free
+ * list in batches. Chunks larger than the biggest size class go to the
+ * buddy allocator directly.
+ *
+ * \note  A chunk may be freed by another thread than the one allocated it,
+ *        then it is cached by the freeing thread.
+ */
+class ThreadCachedAllocator {
+ public:
+  /**
+   * \param buddy                 the allocator that owns the chunks.
+   * \param max_class_size        the biggest chunk size which is cached.
+   * \param max_thread_cache_size the bytes that one thread may cache.
+   */
+  ThreadCachedAllocator(BuddyAllocator* buddy, size_t max_class_size,
+                        size_t max_thread_cache_size);
+
+  ~ThreadCachedAllocator();
+
+  void* Alloc(size_t unaligned_size);
+  void Free(void* ptr);
+
+  /*! \brief The used memory, excluding the chunks cached by threads */
+  size_t Used();
+
+  /*! \brief The bytes cached by all the threads */
+  size_t CachedSize() const;
+
+  /*! \brief The statistics of the calling thread */
+  ThreadCacheStats ThreadStats();
+
+  // Disable copy and assignment
+  ThreadCachedAllocator(const ThreadCachedAllocator&) = delete;
+  ThreadCachedAllocator& operator=(const ThreadCachedAllocator&) = delete;
+
+ private:
+  // The state shared with the thread caches, which may outlive the
+  // allocator until their threads exit.
+  struct Shared;
+  struct ThreadCache;
+
+  ThreadCache* GetThreadCache();
+
+  /*! \brief Return half of the chunks in a free list to the buddy allocator */
+  void Release(ThreadCache* cache, size_t class_id);
+
+  BuddyAllocator* buddy_;
+  size_t class_size_;  // the size step between two size classes
+  size_t num_classes_;
+  size_t max_thread_cache_size_;
+  std::shared_ptr<Shared> shared_;
+};
+
+}  // namespace detail
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,108 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/memory/detail/thread_cached_allocator.h"
+
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace memory {
+namespace detail {
+
+static constexpr size_t kMinChunk = 1 << 12;
+static constexpr size_t kMaxChunk = 1 << 24;
+
+TEST(ThreadCachedAllocator, ReuseInThread) {
+  BuddyAllocator buddy(std::unique_ptr<SystemAllocator>(new CPUAllocator),
+                       kMinChunk, kMaxChunk);
+  ThreadCachedAllocator allocator(&buddy, 16 * kMinChunk, 64 * kMinChunk);
+
+  void* p = allocator.Alloc(100);
+  ASSERT_NE(p, nullptr);
+  allocator.Free(p);
+  EXPECT_EQ(allocator.Used(), 0UL);
+  EXPECT_GT(allocator.ThreadStats().cached_size, 0UL);
+
+  // The freed chunk is served again without visiting the buddy allocator.
+  size_t misses = allocator.ThreadStats().miss_count;
+  void* q = allocator.Alloc(100);
+  EXPECT_EQ(p, q);
+  EXPECT_EQ(allocator.ThreadStats().miss_count, misses);
+  EXPECT_GT(allocator.ThreadStats().hit_count, 0UL);
+  allocator.Free(q);
+
+  // Big chunks bypass the thread cache.
+  void* big = allocator.Alloc(32 * kMinChunk);
+  EXPECT_GE(allocator.Used(), 32 * kMinChunk);
+  allocator.Free(big);
+  EXPECT_EQ(allocator.Used(), 0UL);
+}
+
+TEST(ThreadCachedAllocator, BoundedCache) {
+  BuddyAllocator buddy(std::unique_ptr<SystemAllocator>(new CPUAllocator),
+                       kMinChunk, kMaxChunk);
+  ThreadCachedAllocator allocator(&buddy, 16 * kMinChunk, 8 * kMinChunk);
+
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; ++i) {
+    ptrs.push_back(allocator.Alloc(kMinChunk));
+  }
+  for (auto* p : ptrs) {
+    allocator.Free(p);
+  }
+  EXPECT_LE(allocator.ThreadStats().cached_size, 8 * kMinChunk);
+  EXPECT_GT(allocator.ThreadStats().release_count, 0UL);
+  EXPECT_EQ(allocator.Used(), 0UL);
+}
+
+TEST(ThreadCachedAllocator, MultiThreads) {
+  BuddyAllocator buddy(std::unique_ptr<SystemAllocator>(new CPUAllocator),
+                       kMinChunk, kMaxChunk);
+  ThreadCachedAllocator allocator(&buddy, 16 * kMinChunk, 64 * kMinChunk);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&allocator, t] {
+      std::vector<void*> ptrs;
+      for (int i = 0; i < 1000; ++i) {
+        size_t size = ((i + t) % 16 + 1) * 1000;
+        void* p = allocator.Alloc(size);
+        ASSERT_NE(p, nullptr);
+        memset(p, 0, size);
+        ptrs.push_back(p);
+        if (ptrs.size() > 16) {
+          allocator.Free(ptrs.front());
+          ptrs.erase(ptrs.begin());
+        }
+      }
+      for (auto* p : ptrs) {
+        allocator.Free(p);
+      }
+    });
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+  // The caches of the exited threads are returned to the buddy allocator.
+  EXPECT_EQ(allocator.CachedSize(), 0UL);
+  EXPECT_EQ(buddy.Used(), 0UL);
+}
+
+}  // namespace detail
+}  // namespace memory
+}  // namespace paddle
@@ -12,6 +12,14 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <mutex>   // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "paddle/fluid/memory/malloc.h"
@@ -19,7 +27,12 @@ limitations under the License. */
 #include "glog/logging.h"
 
 #include "paddle/fluid/memory/detail/buddy_allocator.h"
+#include "paddle/fluid/memory/detail/size_class_allocator.h"
+#include "paddle/fluid/memory/detail/stream_ordered_allocator.h"
 #include "paddle/fluid/memory/detail/system_allocator.h"
+#include "paddle/fluid/memory/detail/thread_cached_allocator.h"
+#include "paddle/fluid/memory/memory_profiler.h"
+#include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/platform/gpu_info.h"
 
 DEFINE_bool(init_allocated_mem, false,
@@ -28,13 +41,130 @@ DEFINE_bool(init_allocated_mem, false,
             "To find this error in time, we use init_allocated_mem to indicate "
             "that initializing the allocated memory with a small value "
             "during unit testing.");
+DEFINE_bool(use_thread_cached_allocator, false,
+            "If it is true, small CPU allocations are served from per-thread "
+            "free lists in front of the BuddyAllocator, which avoids taking "
+            "the lock of the BuddyAllocator for every Alloc and Free.");
+DEFINE_uint64(thread_cache_max_chunk_size_in_kb, 64,
+              "The biggest CPU chunk that is kept in the thread caches.");
+DEFINE_uint64(thread_cache_size_in_kb, 4096,
+              "The CPU memory that one thread may cache before returning "
+              "chunks to the BuddyAllocator.");
+DEFINE_bool(use_stream_ordered_allocator, false,
+            "If it is true, GPU chunks freed on a CUDA stream are cached in "
+            "the free list of the stream and reused by it without waiting, "
+            "the reuse by other streams is guarded by CUDA events.");
+DEFINE_uint64(stream_ordered_cache_size_in_mb, 1024,
+              "The GPU memory that the stream-ordered allocator may cache on "
+              "each device before returning idle chunks to the "
+              "BuddyAllocator.");
+DEFINE_bool(use_cuda_pinned_pool, false,
+            "If it is true, the CUDAPinnedPlace memory is carved from big "
+            "host regions page-locked by cudaHostRegister, which are backed "
+            "by huge pages when available, and the small chunks are served "
+            "from size-class free lists in front of the BuddyAllocator.");
+DEFINE_uint64(cuda_pinned_region_size_in_mb, 256,
+              "The size of the host regions registered by the pinned pool.");
+DEFINE_uint64(cuda_pinned_pool_max_chunk_size_in_kb, 4096,
+              "The biggest pinned chunk that is kept in the free lists of "
+              "the pinned pool.");
+DEFINE_uint64(cuda_pinned_pool_cache_size_in_mb, 64,
+              "The pinned memory that one thread may cache before returning "
+              "chunks to the BuddyAllocator.");
+DEFINE_string(size_class_pool_places, "",
+              "The places allocating from a pool that caches the freed blocks "
+              "by size class, instead of the BuddyAllocator, comma separated "
+              "from cpu, gpu and cuda_pinned, e.g. \"cpu,gpu\". A training "
+              "step repeating its allocations reaches zero system "
+              "allocations once the pool is warm.");
+DEFINE_uint64(size_class_pool_cache_size_in_mb, 1024,
+              "The bytes that a size-class pool caches before returning the "
+              "largest freed blocks to the system.");
+DEFINE_uint64(idle_memory_release_ms, 0,
+              "If it is positive, a background thread returns the system "
+              "chunks that have been wholly free for this many milliseconds "
+              "to the system, so that other processes sharing the device "
+              "can use them.");
+DEFINE_uint64(idle_memory_reserve_in_mb, 0,
+              "The free memory that each allocator keeps when its idle "
+              "chunks are released.");
 DECLARE_double(fraction_of_gpu_memory_to_use);
+DECLARE_string(cpu_huge_pages);
 
 namespace paddle {
 namespace memory {
 
 using BuddyAllocator = detail::BuddyAllocator;
 
+// The system chunks of the CPU buddy allocators, which are rounded to the
+// 2MB huge pages when the chunks are backed by them.
+static size_t CpuSystemChunkSize() {
+  size_t size = platform::CpuMaxChunkSize();
+  if (!FLAGS_cpu_huge_pages.empty()) {
+    constexpr size_t kHugePageSize = 2ul << 20;
+    size = (size + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+  }
+  return size;
+}
+
+// The buddy allocators visited by ReleaseIdleMemory.
+struct BuddyAllocatorRegistry {
+  std::mutex mutex;
+  // (allocator, place)
+  std::vector<std::pair<BuddyAllocator*, platform::Place>> allocators;
+
+  static BuddyAllocatorRegistry& Instance() {
+    static BuddyAllocatorRegistry* instance = new BuddyAllocatorRegistry;
+    return *instance;
+  }
+};
+
+static size_t ReleaseIdleMemory(const platform::Place& place, size_t reserve,
+                                std::chrono::steady_clock::duration idle_time);
+
+static void IdleMemoryReleaseLoop() {
+  auto idle_time = std::chrono::milliseconds(FLAGS_idle_memory_release_ms);
+  auto interval = std::max(idle_time / 2, std::chrono::milliseconds(1));
+  size_t reserve = FLAGS_idle_memory_reserve_in_mb << 20;
+  while (true) {
+    std::this_thread::sleep_for(interval);
+    std::vector<platform::Place> places;
+    {
+      auto& registry = BuddyAllocatorRegistry::Instance();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      for (auto& item : registry.allocators) {
+        if (std::find(places.begin(), places.end(), item.second) ==
+            places.end()) {
+          places.push_back(item.second);
+        }
+      }
+    }
+    for (auto& place : places) {
+      size_t released = ReleaseIdleMemory(place, reserve, idle_time);
+      if (released > 0) {
+        VLOG(3) << "Release " << released << " idle bytes of " << place;
+      }
+    }
+  }
+}
+
+static void RegisterBuddyAllocator(BuddyAllocator* a,
+                                   const platform::Place& place) {
+  auto& registry = BuddyAllocatorRegistry::Instance();
+  {
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.allocators.emplace_back(a, place);
+  }
+  static std::once_flag init_flag;
+  std::call_once(init_flag, []() {
+    if (FLAGS_idle_memory_release_ms > 0) {
+      // The allocators are never destroyed, so the thread may run until
+      // the process exits.
+      std::thread(IdleMemoryReleaseLoop).detach();
+    }
+  });
+}
+
 BuddyAllocator* GetCPUBuddyAllocator() {
   // We tried thread_local for inference::RNN1 model, but that not works much
   // for multi-thread test.
@@ -44,7 +174,70 @@ BuddyAllocator* GetCPUBuddyAllocator() {
   std::call_once(init_flag, []() {
     a = new detail::BuddyAllocator(
         std::unique_ptr<detail::SystemAllocator>(new detail::CPUAllocator),
-        platform::CpuMinChunkSize(), platform::CpuMaxChunkSize());
+        platform::CpuMinChunkSize(), CpuSystemChunkSize());
+    RegisterBuddyAllocator(a, platform::CPUPlace());
+  });
+
+  return a;
+}
+
+// The arena of the threads bound to a NUMA node, whose system chunks are
+// bound to the node.
+BuddyAllocator* GetCPUBuddyAllocator(int node) {
+  static std::mutex mutex;
+  static std::vector<BuddyAllocator*> as;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (as.empty()) {
+    as.resize(platform::NumaNodeCount(), nullptr);
+  }
+  PADDLE_ENFORCE(node >= 0 && node < static_cast<int>(as.size()),
+                 "The NUMA node %d is out of range.", node);
+  if (as[node] == nullptr) {
+    as[node] = new detail::BuddyAllocator(
+        std::unique_ptr<detail::SystemAllocator>(
+            new detail::NumaCPUAllocator(node)),
+        platform::CpuMinChunkSize(), CpuSystemChunkSize());
+    RegisterBuddyAllocator(as[node], platform::CPUPlace());
+  }
+  return as[node];
+}
+
+detail::ThreadCachedAllocator* GetCPUThreadCachedAllocator() {
+  static std::once_flag init_flag;
+  static detail::ThreadCachedAllocator* a = nullptr;
+
+  std::call_once(init_flag, []() {
+    a = new detail::ThreadCachedAllocator(
+        GetCPUBuddyAllocator(), FLAGS_thread_cache_max_chunk_size_in_kb << 10,
+        FLAGS_thread_cache_size_in_kb << 10);
+  });
+
+  return a;
+}
+
+// Whether FLAGS_size_class_pool_places contains the kind of places.
+static bool UseSizeClassPool(const char* kind) {
+  const std::string& places = FLAGS_size_class_pool_places;
+  if (places.empty()) return false;
+  size_t len = strlen(kind);
+  for (size_t pos = 0; pos <= places.size();) {
+    size_t end = places.find(',', pos);
+    if (end == std::string::npos) end = places.size();
+    if (end - pos == len && places.compare(pos, len, kind) == 0) return true;
+    pos = end + 1;
+  }
+  return false;
+}
+
+detail::SizeClassAllocator* GetCPUSizeClassPool() {
+  static std::once_flag init_flag;
+  static detail::SizeClassAllocator* a = nullptr;
+
+  std::call_once(init_flag, []() {
+    a = new detail::SizeClassAllocator(
+        std::unique_ptr<detail::SystemAllocator>(new detail::CPUAllocator),
+        FLAGS_size_class_pool_cache_size_in_mb << 20);
   });
 
   return a;
@@ -72,10 +265,23 @@ struct NaiveAllocator {
 template <>
 void* Alloc<platform::CPUPlace>(platform::CPUPlace place, size_t size) {
   VLOG(10) << "Allocate " << size << " bytes on " << platform::Place(place);
-  void* p = GetCPUBuddyAllocator()->Alloc(size);
+  int node = platform::CurrentNumaNode();
+  void* p = nullptr;
+  if (node >= 0) {
+    p = GetCPUBuddyAllocator(node)->Alloc(size);
+  } else if (UseSizeClassPool("cpu")) {
+    p = GetCPUSizeClassPool()->Alloc(size);
+  } else if (FLAGS_use_thread_cached_allocator) {
+    p = GetCPUThreadCachedAllocator()->Alloc(size);
+  } else {
+    p = GetCPUBuddyAllocator()->Alloc(size);
+  }
   if (FLAGS_init_allocated_mem) {
     memset(p, 0xEF, size);
   }
+  if (IsMemoryProfilerEnabled() && p != nullptr) {
+    RecordAlloc(place, p, size);
+  }
   VLOG(10) << "  pointer=" << p;
   return p;
 }
@@ -83,14 +289,39 @@ void* Alloc<platform::CPUPlace>(platform::CPUPlace place, size_t size) {
 template <>
 void Free<platform::CPUPlace>(platform::CPUPlace place, void* p) {
   VLOG(10) << "Free pointer=" << p << " on " << platform::Place(place);
-  GetCPUBuddyAllocator()->Free(p);
+  if (IsMemoryProfilerEnabled()) {
+    RecordFree(p);
+  }
+  // The memory may be freed by a thread bound to another node, or by no node.
+  int node = detail::NumaCPUAllocator::NodeOf(p);
+  if (node >= 0) {
+    GetCPUBuddyAllocator(node)->Free(p);
+  } else if (UseSizeClassPool("cpu")) {
+    GetCPUSizeClassPool()->Free(p);
+  } else if (FLAGS_use_thread_cached_allocator) {
+    GetCPUThreadCachedAllocator()->Free(p);
+  } else {
+    GetCPUBuddyAllocator()->Free(p);
+  }
 }
 
 template <>
 size_t Used<platform::CPUPlace>(platform::CPUPlace place) {
+  if (UseSizeClassPool("cpu")) {
+    return GetCPUSizeClassPool()->GetStats().used;
+  }
+  if (FLAGS_use_thread_cached_allocator) {
+    return GetCPUThreadCachedAllocator()->Used();
+  }
   return GetCPUBuddyAllocator()->Used();
 }
 
+template <>
+size_t ThreadCached<platform::CPUPlace>(platform::CPUPlace place) {
+  if (!FLAGS_use_thread_cached_allocator) return 0;
+  return GetCPUThreadCachedAllocator()->ThreadStats().cached_size;
+}
+
 #ifdef PADDLE_WITH_CUDA
 
 BuddyAllocator* GetGPUBuddyAllocator(int gpu_id) {
@@ -109,6 +340,7 @@ BuddyAllocator* GetGPUBuddyAllocator(int gpu_id) {
       a_arr[i] = new BuddyAllocator(
           std::unique_ptr<detail::SystemAllocator>(new detail::GPUAllocator(i)),
           platform::GpuMinChunkSize(), platform::GpuMaxChunkSize());
+      RegisterBuddyAllocator(a_arr[i], platform::CUDAPlace(i));
 
       VLOG(10) << "\n\nNOTE: each GPU device use "
                << FLAGS_fraction_of_gpu_memory_to_use * 100
@@ -123,15 +355,127 @@ BuddyAllocator* GetGPUBuddyAllocator(int gpu_id) {
   return a_arr[gpu_id];
 }
 
+detail::StreamOrderedAllocator* GetGPUStreamOrderedAllocator(int gpu_id) {
+  static std::once_flag init_flag;
+  static detail::StreamOrderedAllocator** a_arr = nullptr;
+
+  std::call_once(init_flag, [gpu_id]() {
+    int gpu_num = platform::GetCUDADeviceCount();
+    a_arr = new detail::StreamOrderedAllocator*[gpu_num];
+    for (int i = 0; i < gpu_num; i++) {
+      a_arr[i] = new detail::StreamOrderedAllocator(
+          GetGPUBuddyAllocator(i), i,
+          FLAGS_stream_ordered_cache_size_in_mb << 20);
+    }
+  });
+
+  platform::SetDeviceId(gpu_id);
+  return a_arr[gpu_id];
+}
+
+detail::SizeClassAllocator* GetGPUSizeClassPool(int gpu_id) {
+  static std::once_flag init_flag;
+  static detail::SizeClassAllocator** a_arr = nullptr;
+
+  std::call_once(init_flag, [gpu_id]() {
+    int gpu_num = platform::GetCUDADeviceCount();
+    PADDLE_ENFORCE(gpu_id < gpu_num, "gpu_id:%d should < gpu_num:%d", gpu_id,
+                   gpu_num);
+    a_arr = new detail::SizeClassAllocator*[gpu_num];
+    for (int i = 0; i < gpu_num; i++) {
+      a_arr[i] = new detail::SizeClassAllocator(
+          std::unique_ptr<detail::SystemAllocator>(new detail::GPUAllocator(i)),
+          FLAGS_size_class_pool_cache_size_in_mb << 20);
+    }
+  });
+
+  return a_arr[gpu_id];
+}
+
+// The stream on which the plain Alloc and Free of a device are ordered, it
+// is the stream of the first CUDADeviceContext created on the device.
+static std::atomic<cudaStream_t>* DefaultStreams(int gpu_id) {
+  static std::once_flag init_flag;
+  static std::atomic<cudaStream_t>* streams = nullptr;
+  static int gpu_num = 0;
+
+  std::call_once(init_flag, []() {
+    gpu_num = platform::GetCUDADeviceCount();
+    streams = new std::atomic<cudaStream_t>[gpu_num];
+    for (int i = 0; i < gpu_num; i++) {
+      streams[i] = nullptr;
+    }
+  });
+
+  PADDLE_ENFORCE(gpu_id < gpu_num, "gpu_id:%d should < gpu_num:%d", gpu_id,
+                 gpu_num);
+  return &streams[gpu_id];
+}
+
+// The stream set by SetThreadStream on the thread, of thread_stream_device.
+static thread_local int thread_stream_device = -1;
+static thread_local cudaStream_t thread_stream = nullptr;
+
+static cudaStream_t GetDefaultStream(int gpu_id) {
+  if (thread_stream_device == gpu_id) return thread_stream;
+  return DefaultStreams(gpu_id)->load();
+}
+
+void SetThreadStream(int device, cudaStream_t stream) {
+  thread_stream_device = device;
+  thread_stream = stream;
+}
+
+static thread_local std::vector<std::pair<platform::CUDAPlace, void*>>*
+    thread_deferred_frees = nullptr;
+
+void DeferThreadGPUFrees(
+    std::vector<std::pair<platform::CUDAPlace, void*>>* frees) {
+  thread_deferred_frees = frees;
+}
+
+void SetDefaultStream(platform::CUDAPlace place, cudaStream_t stream) {
+  cudaStream_t expected = nullptr;
+  DefaultStreams(place.device)->compare_exchange_strong(expected, stream);
+}
+
+void ResetDefaultStream(platform::CUDAPlace place, cudaStream_t stream) {
+  if (DefaultStreams(place.device)->compare_exchange_strong(stream, nullptr) &&
+      FLAGS_use_stream_ordered_allocator) {
+    // The free list of the stream must not outlive it.
+    GetGPUStreamOrderedAllocator(place.device)->ReleaseAll();
+  }
+}
+
 template <>
 size_t Used<platform::CUDAPlace>(platform::CUDAPlace place) {
+  if (UseSizeClassPool("gpu")) {
+    return GetGPUSizeClassPool(place.device)->GetStats().used;
+  }
+  if (FLAGS_use_stream_ordered_allocator) {
+    return GetGPUStreamOrderedAllocator(place.device)->Used();
+  }
   return GetGPUBuddyAllocator(place.device)->Used();
 }
 
-template <>
-void* Alloc<platform::CUDAPlace>(platform::CUDAPlace place, size_t size) {
+void* Alloc(platform::CUDAPlace place, size_t size, cudaStream_t stream) {
   auto* buddy_allocator = GetGPUBuddyAllocator(place.device);
-  auto* ptr = buddy_allocator->Alloc(size);
+  auto alloc = [&]() {
+    if (UseSizeClassPool("gpu")) {
+      // Like the BuddyAllocator, the blocks are reused regardless of the
+      // stream, cudaFree synchronizes the device before returning them.
+      return GetGPUSizeClassPool(place.device)->Alloc(size);
+    }
+    return FLAGS_use_stream_ordered_allocator
+               ? GetGPUStreamOrderedAllocator(place.device)->Alloc(size, stream)
+               : buddy_allocator->Alloc(size);
+  };
+  auto* ptr = alloc();
+  if (ptr == nullptr && ReleaseIdleMemory(place) > 0) {
+    VLOG(3) << "Retry to allocate " << size << " bytes in GPU "
+            << place.device << " after releasing the idle memory";
+    ptr = alloc();
+  }
   if (ptr == nullptr) {
     int cur_dev = platform::GetCurrentDeviceId();
     platform::SetDeviceId(place.device);
@@ -148,12 +492,37 @@ void* Alloc<platform::CUDAPlace>(platform::CUDAPlace place, size_t size) {
   if (FLAGS_init_allocated_mem) {
     cudaMemset(ptr, 0xEF, size);
   }
+  if (IsMemoryProfilerEnabled() && ptr != nullptr) {
+    RecordAlloc(place, ptr, size);
+  }
   return ptr;
 }
 
+void Free(platform::CUDAPlace place, void* p, cudaStream_t stream) {
+  if (thread_deferred_frees != nullptr) {
+    thread_deferred_frees->emplace_back(place, p);
+    return;
+  }
+  if (IsMemoryProfilerEnabled()) {
+    RecordFree(p);
+  }
+  if (UseSizeClassPool("gpu")) {
+    GetGPUSizeClassPool(place.device)->Free(p);
+  } else if (FLAGS_use_stream_ordered_allocator) {
+    GetGPUStreamOrderedAllocator(place.device)->Free(p, stream);
+  } else {
+    GetGPUBuddyAllocator(place.device)->Free(p);
+  }
+}
+
+template <>
+void* Alloc<platform::CUDAPlace>(platform::CUDAPlace place, size_t size) {
+  return Alloc(place, size, GetDefaultStream(place.device));
+}
+
 template <>
 void Free<platform::CUDAPlace>(platform::CUDAPlace place, void* p) {
-  GetGPUBuddyAllocator(place.device)->Free(p);
+  Free(place, p, GetDefaultStream(place.device));
 }
 
 BuddyAllocator* GetCUDAPinnedBuddyAllocator() {
@@ -161,25 +530,90 @@ BuddyAllocator* GetCUDAPinnedBuddyAllocator() {
   static BuddyAllocator* ba = nullptr;
 
   std::call_once(init_flag, []() {
-    ba = new BuddyAllocator(std::unique_ptr<detail::SystemAllocator>(
-                                new detail::CUDAPinnedAllocator),
-                            platform::CUDAPinnedMinChunkSize(),
-                            platform::CUDAPinnedMaxChunkSize());
+    if (FLAGS_use_cuda_pinned_pool) {
+      // Every system chunk of the buddy allocator is a registered region.
+      size_t region_size =
+          std::min<size_t>(FLAGS_cuda_pinned_region_size_in_mb << 20,
+                           platform::CUDAPinnedMaxAllocSize());
+      region_size = std::max(region_size, platform::CUDAPinnedMinChunkSize());
+      ba = new BuddyAllocator(std::unique_ptr<detail::SystemAllocator>(
+                                  new detail::CUDAHostRegisterAllocator),
+                              platform::CUDAPinnedMinChunkSize(), region_size);
+    } else {
+      ba = new BuddyAllocator(std::unique_ptr<detail::SystemAllocator>(
+                                  new detail::CUDAPinnedAllocator),
+                              platform::CUDAPinnedMinChunkSize(),
+                              platform::CUDAPinnedMaxChunkSize());
+    }
+    RegisterBuddyAllocator(ba, platform::CUDAPinnedPlace());
   });
 
   return ba;
 }
 
+detail::SizeClassAllocator* GetCUDAPinnedSizeClassPool() {
+  static std::once_flag init_flag;
+  static detail::SizeClassAllocator* a = nullptr;
+
+  std::call_once(init_flag, []() {
+    a = new detail::SizeClassAllocator(
+        std::unique_ptr<detail::SystemAllocator>(
+            new detail::CUDAPinnedAllocator),
+        FLAGS_size_class_pool_cache_size_in_mb << 20);
+  });
+
+  return a;
+}
+
+// The pinned pool shared by the readers, the fetches and the RPC payloads,
+// whose chunks are allocated and freed by different threads at high rates.
+detail::ThreadCachedAllocator* GetCUDAPinnedPool() {
+  static std::once_flag init_flag;
+  static detail::ThreadCachedAllocator* a = nullptr;
+
+  std::call_once(init_flag, []() {
+    a = new detail::ThreadCachedAllocator(
+        GetCUDAPinnedBuddyAllocator(),
+        FLAGS_cuda_pinned_pool_max_chunk_size_in_kb << 10,
+        FLAGS_cuda_pinned_pool_cache_size_in_mb << 20);
+  });
+
+  return a;
+}
+
 template <>
 size_t Used<platform::CUDAPinnedPlace>(platform::CUDAPinnedPlace place) {
+  if (UseSizeClassPool("cuda_pinned")) {
+    return GetCUDAPinnedSizeClassPool()->GetStats().used;
+  }
+  if (FLAGS_use_cuda_pinned_pool) {
+    return GetCUDAPinnedPool()->Used();
+  }
   return GetCUDAPinnedBuddyAllocator()->Used();
 }
 
+template <>
+size_t ThreadCached<platform::CUDAPinnedPlace>(
+    platform::CUDAPinnedPlace place) {
+  if (!FLAGS_use_cuda_pinned_pool) return 0;
+  return GetCUDAPinnedPool()->ThreadStats().cached_size;
+}
+
 template <>
 void* Alloc<platform::CUDAPinnedPlace>(platform::CUDAPinnedPlace place,
                                        size_t size) {
-  auto* buddy_allocator = GetCUDAPinnedBuddyAllocator();
-  void* ptr = buddy_allocator->Alloc(size);
+  auto alloc = [size]() {
+    if (UseSizeClassPool("cuda_pinned")) {
+      return GetCUDAPinnedSizeClassPool()->Alloc(size);
+    }
+    return FLAGS_use_cuda_pinned_pool
+               ? GetCUDAPinnedPool()->Alloc(size)
+               : GetCUDAPinnedBuddyAllocator()->Alloc(size);
+  };
+  void* ptr = alloc();
+  if (ptr == nullptr && ReleaseIdleMemory(place) > 0) {
+    ptr = alloc();
+  }
 
   if (ptr == nullptr) {
     LOG(WARNING) << "cudaMallocHost Cannot allocate " << size
@@ -188,15 +622,129 @@ void* Alloc<platform::CUDAPinnedPlace>(platform::CUDAPinnedPlace place,
   if (FLAGS_init_allocated_mem) {
     memset(ptr, 0xEF, size);
   }
+  if (IsMemoryProfilerEnabled() && ptr != nullptr) {
+    RecordAlloc(place, ptr, size);
+  }
   return ptr;
 }
 
 template <>
 void Free<platform::CUDAPinnedPlace>(platform::CUDAPinnedPlace place, void* p) {
-  GetCUDAPinnedBuddyAllocator()->Free(p);
+  if (IsMemoryProfilerEnabled()) {
+    RecordFree(p);
+  }
+  if (UseSizeClassPool("cuda_pinned")) {
+    GetCUDAPinnedSizeClassPool()->Free(p);
+  } else if (FLAGS_use_cuda_pinned_pool) {
+    GetCUDAPinnedPool()->Free(p);
+  } else {
+    GetCUDAPinnedBuddyAllocator()->Free(p);
+  }
 }
 #endif
 
+static size_t ReleaseIdleMemory(
+    const platform::Place& place, size_t reserve,
+    std::chrono::steady_clock::duration idle_time) {
+  size_t released = 0;
+#ifdef PADDLE_WITH_CUDA
+  if (platform::is_gpu_place(place) && FLAGS_use_stream_ordered_allocator) {
+    // Return the chunks cached by the streams first, so that they may merge
+    // into wholly free system chunks.
+    int cur_dev = platform::GetCurrentDeviceId();
+    GetGPUStreamOrderedAllocator(boost::get<platform::CUDAPlace>(place).device)
+        ->ReleaseIdle();
+    platform::SetDeviceId(cur_dev);
+  }
+#endif
+  std::vector<BuddyAllocator*> allocators;
+  {
+    auto& registry = BuddyAllocatorRegistry::Instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto& item : registry.allocators) {
+      if (item.second == place) allocators.push_back(item.first);
+    }
+  }
+  for (auto* a : allocators) {
+#ifdef PADDLE_WITH_CUDA
+    if (platform::is_gpu_place(place)) {
+      // The GPU chunks are freed on their device.
+      int cur_dev = platform::GetCurrentDeviceId();
+      platform::SetDeviceId(boost::get<platform::CUDAPlace>(place).device);
+      released += a->ReleaseIdle(reserve, idle_time);
+      platform::SetDeviceId(cur_dev);
+      continue;
+    }
+#endif
+    released += a->ReleaseIdle(reserve, idle_time);
+  }
+  return released;
+}
+
+size_t ReleaseIdleMemory(const platform::Place& place) {
+  size_t released = 0;
+  // The cached blocks of the size-class pools are idle by definition, but
+  // they are only released on demand, they are what keeps the steps free of
+  // system allocations.
+  if (platform::is_cpu_place(place) && UseSizeClassPool("cpu")) {
+    released += GetCPUSizeClassPool()->Release();
+  }
+#ifdef PADDLE_WITH_CUDA
+  if (platform::is_gpu_place(place) && UseSizeClassPool("gpu")) {
+    released +=
+        GetGPUSizeClassPool(boost::get<platform::CUDAPlace>(place).device)
+            ->Release();
+  }
+  if (platform::is_cuda_pinned_place(place) &&
+      UseSizeClassPool("cuda_pinned")) {
+    released += GetCUDAPinnedSizeClassPool()->Release();
+  }
+#endif
+  return released +
+         ReleaseIdleMemory(place, 0, std::chrono::steady_clock::duration(0));
+}
+
+SizeClassPoolStats GetSizeClassPoolStats(const platform::Place& place) {
+  if (platform::is_cpu_place(place)) {
+    return GetCPUSizeClassPool()->GetStats();
+  }
+#ifdef PADDLE_WITH_CUDA
+  if (platform::is_gpu_place(place)) {
+    return GetGPUSizeClassPool(boost::get<platform::CUDAPlace>(place).device)
+        ->GetStats();
+  }
+  if (platform::is_cuda_pinned_place(place)) {
+    return GetCUDAPinnedSizeClassPool()->GetStats();
+  }
+#endif
+  PADDLE_THROW("The allocator of %s is not supported", place);
+}
+
+static AllocatorStats ToAllocatorStats(const BuddyAllocator::Stats& stats) {
+  return AllocatorStats{stats.used, stats.free, stats.num_free_chunks,
+                        stats.largest_free_chunk};
+}
+
+AllocatorStats GetAllocatorStats(const platform::Place& place) {
+  if (platform::is_cpu_place(place)) {
+    return ToAllocatorStats(GetCPUBuddyAllocator()->GetStats());
+  }
+#ifdef PADDLE_WITH_CUDA
+  if (platform::is_gpu_place(place)) {
+    int cur_dev = platform::GetCurrentDeviceId();
+    auto stats =
+        GetGPUBuddyAllocator(boost::get<platform::CUDAPlace>(place).device)
+            ->GetStats();
+    platform::SetDeviceId(cur_dev);
+    return ToAllocatorStats(stats);
+  }
+  if (platform::is_cuda_pinned_place(place)) {
+    return ToAllocatorStats(GetCUDAPinnedBuddyAllocator()->GetStats());
+  }
+#endif
+  PADDLE_THROW("The allocator of %s is not supported", place);
+}
+
 size_t Usage::operator()(const platform::CPUPlace& cpu) const {
   return Used(cpu);
 }
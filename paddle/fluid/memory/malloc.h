@@ -14,6 +14,13 @@ limitations under the License. */
 
 #pragma once
 
+#ifdef PADDLE_WITH_CUDA
+#include <cuda_runtime.h>
+#endif
+
+#include <utility>
+#include <vector>
+#include "paddle/fluid/memory/detail/size_class_allocator.h"
 #include "paddle/fluid/platform/place.h"
 
 namespace paddle {
@@ -54,6 +61,99 @@ void Free(Place place, void* ptr);
 template <typename Place>
 size_t Used(Place place);
 
+/**
+ * \brief   Size of the memory cached by the calling thread in one place.
+ *
+ * \param[in]  place  Allocation place, CPUPlace and CUDAPinnedPlace with
+ *                    FLAGS_use_cuda_pinned_pool keep thread caches.
+ *
+ * \note    The cached memory is counted as free by Used.
+ */
+template <typename Place>
+size_t ThreadCached(Place place);
+
+#ifdef PADDLE_WITH_CUDA
+/**
+ * \brief   Allocate GPU memory that is used in the order of a CUDA stream.
+ *
+ * \note    With FLAGS_use_stream_ordered_allocator, a chunk freed on the
+ *          same stream is reused without synchronization. Otherwise it is
+ *          the same as Alloc<CUDAPlace>.
+ */
+void* Alloc(platform::CUDAPlace place, size_t size, cudaStream_t stream);
+
+/**
+ * \brief   Free GPU memory after the work enqueued on a CUDA stream.
+ *
+ * \note    The memory must not be used by the other streams, unless they
+ *          wait for the stream before the memory is freed.
+ */
+void Free(platform::CUDAPlace place, void* ptr, cudaStream_t stream);
+
+/**
+ * \brief   Set the stream of Alloc<CUDAPlace> and Free<CUDAPlace>.
+ *
+ * \note    Only the first stream set on a device takes effect until it is
+ *          reset, CUDADeviceContext sets its stream when it is created.
+ */
+void SetDefaultStream(platform::CUDAPlace place, cudaStream_t stream);
+void ResetDefaultStream(platform::CUDAPlace place, cudaStream_t stream);
+
+/**
+ * \brief   Order Alloc<CUDAPlace> and Free<CUDAPlace> of the device on the
+ *          stream instead of the default one, on the calling thread only.
+ *
+ * \note    device -1 resets it to the default stream.
+ */
+void SetThreadStream(int device, cudaStream_t stream);
+
+/**
+ * \brief   Keep the GPU memory freed by the calling thread in frees instead
+ *          of freeing it, until it is set to nullptr.
+ *
+ * \note    The kernels captured in a CUDA graph replay on the memory of the
+ *          capture, so their temporaries are kept until the graph is
+ *          destroyed. The caller frees them by Free<CUDAPlace>.
+ */
+void DeferThreadGPUFrees(
+    std::vector<std::pair<platform::CUDAPlace, void*>>* frees);
+#endif
+
+/**
+ * \brief   The statistics of the BuddyAllocator of a place.
+ *
+ * \note    free is the memory allocated from the system but not used, in
+ *          num_free_chunks chunks. The allocations larger than
+ *          largest_free_chunk have to allocate from the system.
+ */
+struct AllocatorStats {
+  size_t used;
+  size_t free;
+  size_t num_free_chunks;
+  size_t largest_free_chunk;
+};
+
+AllocatorStats GetAllocatorStats(const platform::Place& place);
+
+/**
+ * \brief   Return the wholly free system chunks of the allocators of a place
+ *          to the system.
+ *
+ * \return  The bytes released.
+ *
+ * \note    It is done on allocation failures before retrying, and in the
+ *          background when FLAGS_idle_memory_release_ms is positive.
+ */
+size_t ReleaseIdleMemory(const platform::Place& place);
+
+using SizeClassPoolStats = detail::SizeClassAllocator::Stats;
+
+/**
+ * \brief   The statistics of the size-class pool of a place, which serves the
+ *          place when FLAGS_size_class_pool_places contains it.
+ */
+SizeClassPoolStats GetSizeClassPoolStats(const platform::Place& place);
+
 struct Usage : public boost::static_visitor<size_t> {
   size_t operator()(const platform::CPUPlace& cpu) const;
   size_t operator()(const platform::CUDAPlace& gpu) const;
@@ -14,14 +14,21 @@ limitations under the License. */
 
 #include "paddle/fluid/memory/malloc.h"
 
+#include <cstring>
 #include <unordered_map>
+#include <vector>
 
+#include "gflags/gflags.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/memory/detail/memory_block.h"
 #include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/platform/gpu_info.h"
 #include "paddle/fluid/platform/place.h"
 
+#ifdef PADDLE_WITH_CUDA
+DECLARE_bool(use_cuda_pinned_pool);
+#endif
+
 inline bool is_aligned(void const *p) {
   return 0 == (reinterpret_cast<uintptr_t>(p) & 0x3);
 }
@@ -195,4 +202,27 @@ TEST(BuddyAllocator, CUDAPinnedMultAllocator) {
     EXPECT_EQ(total_size, paddle::memory::Used(cpu));
   }
 }
+
+TEST(BuddyAllocator, CUDAPinnedPool) {
+  FLAGS_use_cuda_pinned_pool = true;
+  paddle::platform::CUDAPinnedPlace cpu;
+
+  std::vector<void *> ps;
+  for (auto size : {128, 65536, 1048576, 16777216}) {
+    void *p = paddle::memory::Alloc(cpu, size);
+    EXPECT_NE(p, nullptr);
+    memset(p, 0, size);
+    ps.push_back(p);
+  }
+  for (auto p : ps) {
+    paddle::memory::Free(cpu, p);
+  }
+  EXPECT_GT(paddle::memory::ThreadCached(cpu), 0UL);
+
+  // A freed chunk of the same size class is reused.
+  void *p = paddle::memory::Alloc(cpu, 1048576);
+  EXPECT_EQ(p, ps[2]);
+  paddle::memory::Free(cpu, p);
+  FLAGS_use_cuda_pinned_pool = false;
+}
 #endif
@@ -0,0 +1,251 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/memory/memory_profiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <mutex>  // NOLINT
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/memory/malloc.h"
+
+namespace paddle {
+namespace memory {
+
+namespace detail {
+std::atomic<bool> g_memory_profiler_enabled{false};
+}  // namespace detail
+
+namespace {
+
+// The number of the largest allocations live at the peak in the report.
+constexpr size_t kNumTopAllocations = 20;
+
+struct AllocationRecord {
+  platform::Place place;
+  size_t size;
+  std::string op;
+  std::string var;
+  // The order of the allocation, to tell whether it is live at the peak.
+  uint64_t seq;
+};
+
+struct PlaceState {
+  platform::Place place;
+  size_t live = 0;
+  size_t peak = 0;
+  uint64_t peak_seq = 0;
+  size_t num_allocs = 0;
+  size_t num_frees = 0;
+  // The allocations live at the peak but freed since then.
+  std::vector<AllocationRecord> freed_since_peak;
+};
+
+struct MemoryProfiler {
+  std::mutex mu;
+  uint64_t next_seq = 0;
+  std::unordered_map<const void*, AllocationRecord> live;
+  std::map<std::string, PlaceState> places;
+};
+
+MemoryProfiler& GetMemoryProfiler() {
+  static MemoryProfiler* profiler = new MemoryProfiler;
+  return *profiler;
+}
+
+std::string PlaceName(const platform::Place& place) {
+  std::ostringstream os;
+  os << place;
+  return os.str();
+}
+
+// The ops being run by the thread, the innermost one tags the allocations.
+std::vector<const std::string*>& ThreadOpStack() {
+  static thread_local std::vector<const std::string*> stack;
+  return stack;
+}
+
+std::string ReadableBytes(size_t bytes) {
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(2);
+  if (bytes >= (1UL << 30)) {
+    os << static_cast<double>(bytes) / (1UL << 30) << " GB";
+  } else if (bytes >= (1UL << 20)) {
+    os << static_cast<double>(bytes) / (1UL << 20) << " MB";
+  } else if (bytes >= (1UL << 10)) {
+    os << static_cast<double>(bytes) / (1UL << 10) << " KB";
+  } else {
+    os << bytes << " B";
+  }
+  return os.str();
+}
+
+}  // namespace
+
+void EnableMemoryProfiler() {
+  auto& profiler = GetMemoryProfiler();
+  {
+    std::lock_guard<std::mutex> lock(profiler.mu);
+    profiler.next_seq = 0;
+    profiler.live.clear();
+    profiler.places.clear();
+  }
+  detail::g_memory_profiler_enabled.store(true);
+}
+
+void DisableMemoryProfiler() { detail::g_memory_profiler_enabled.store(false); }
+
+void RecordAlloc(const platform::Place& place, const void* ptr, size_t size) {
+  auto& stack = ThreadOpStack();
+  auto& profiler = GetMemoryProfiler();
+  std::lock_guard<std::mutex> lock(profiler.mu);
+  uint64_t seq = ++profiler.next_seq;
+  AllocationRecord record{place, size,
+                          stack.empty() ? std::string() : *stack.back(),
+                          std::string(), seq};
+  profiler.live[ptr] = std::move(record);
+
+  auto& state = profiler.places[PlaceName(place)];
+  state.place = place;
+  state.live += size;
+  ++state.num_allocs;
+  if (state.live > state.peak) {
+    state.peak = state.live;
+    state.peak_seq = seq;
+    state.freed_since_peak.clear();
+  }
+}
+
+void RecordFree(const void* ptr) {
+  auto& profiler = GetMemoryProfiler();
+  std::lock_guard<std::mutex> lock(profiler.mu);
+  auto it = profiler.live.find(ptr);
+  // The allocations before enabling the profiler are not tracked.
+  if (it == profiler.live.end()) return;
+  auto& state = profiler.places[PlaceName(it->second.place)];
+  state.live -= it->second.size;
+  ++state.num_frees;
+  if (it->second.seq <= state.peak_seq) {
+    state.freed_since_peak.push_back(std::move(it->second));
+  }
+  profiler.live.erase(it);
+}
+
+void NameAllocation(const void* ptr, const std::string& var_name) {
+  auto& profiler = GetMemoryProfiler();
+  std::lock_guard<std::mutex> lock(profiler.mu);
+  auto it = profiler.live.find(ptr);
+  if (it != profiler.live.end() && it->second.var.empty()) {
+    it->second.var = var_name;
+  }
+}
+
+MemoryProfilerOpGuard::MemoryProfilerOpGuard(const std::string& op_type)
+    : is_enabled_(IsMemoryProfilerEnabled()) {
+  if (is_enabled_) {
+    ThreadOpStack().push_back(&op_type);
+  }
+}
+
+MemoryProfilerOpGuard::~MemoryProfilerOpGuard() {
+  if (is_enabled_) {
+    ThreadOpStack().pop_back();
+  }
+}
+
+std::string MemoryProfilerReport() {
+  auto& profiler = GetMemoryProfiler();
+  std::lock_guard<std::mutex> lock(profiler.mu);
+  std::ostringstream os;
+  os << "------------------------->     Memory Profiling Report     "
+        "<-------------------------\n";
+  for (auto& name_state : profiler.places) {
+    auto& state = name_state.second;
+    os << "\nPlace: " << name_state.first << "\n";
+    os << "  Current: " << ReadableBytes(state.live)
+       << "  Peak: " << ReadableBytes(state.peak)
+       << "  Allocs: " << state.num_allocs << "  Frees: " << state.num_frees
+       << "\n";
+    try {
+      auto stats = GetAllocatorStats(state.place);
+      double fragmentation =
+          stats.free == 0
+              ? 0.
+              : 1. - static_cast<double>(stats.largest_free_chunk) / stats.free;
+      os << "  Allocator used: " << ReadableBytes(stats.used)
+         << "  free: " << ReadableBytes(stats.free) << " in "
+         << stats.num_free_chunks << " chunks, the largest "
+         << ReadableBytes(stats.largest_free_chunk)
+         << "  fragmentation: " << std::setprecision(3) << fragmentation
+         << "\n";
+    } catch (platform::EnforceNotMet&) {
+    }
+
+    // The allocations live at the peak.
+    std::vector<const AllocationRecord*> at_peak;
+    for (auto& record : state.freed_since_peak) {
+      at_peak.push_back(&record);
+    }
+    for (auto& ptr_record : profiler.live) {
+      auto& record = ptr_record.second;
+      if (record.seq <= state.peak_seq &&
+          PlaceName(record.place) == name_state.first) {
+        at_peak.push_back(&record);
+      }
+    }
+
+    std::map<std::string, size_t> op_bytes;
+    for (auto* record : at_peak) {
+      op_bytes[record->op.empty() ? "(no op)" : record->op] += record->size;
+    }
+    std::vector<std::pair<std::string, size_t>> ops(op_bytes.begin(),
+                                                    op_bytes.end());
+    std::sort(ops.begin(), ops.end(),
+              [](const std::pair<std::string, size_t>& a,
+                 const std::pair<std::string, size_t>& b) {
+                return a.second > b.second;
+              });
+    os << "  Live at the peak by op:\n";
+    for (auto& op : ops) {
+      os << "    " << std::left << std::setw(40) << op.first << std::right
+         << std::setw(12) << ReadableBytes(op.second) << std::setw(8)
+         << std::fixed << std::setprecision(1)
+         << 100. * op.second / std::max<size_t>(state.peak, 1) << "%\n";
+      os.unsetf(std::ios_base::floatfield);
+    }
+
+    std::sort(at_peak.begin(), at_peak.end(),
+              [](const AllocationRecord* a, const AllocationRecord* b) {
+                return a->size > b->size;
+              });
+    if (at_peak.size() > kNumTopAllocations) {
+      at_peak.resize(kNumTopAllocations);
+    }
+    os << "  The largest allocations live at the peak:\n";
+    for (auto* record : at_peak) {
+      os << "    " << std::left << std::setw(40)
+         << (record->var.empty() ? "(unnamed)" : record->var) << std::setw(24)
+         << (record->op.empty() ? "(no op)" : record->op) << std::right
+         << std::setw(12) << ReadableBytes(record->size) << "\n";
+    }
+  }
+  return os.str();
+}
+
+}  // namespace memory
+}  // namespace paddle
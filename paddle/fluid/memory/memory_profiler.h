@@ -0,0 +1,72 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace memory {
+
+/*
+ * The memory profiler records the allocations and the frees of memory::Alloc
+ * and memory::Free, tagged with the op being run by the thread, and the
+ * variables of the op outputs. For every place it keeps the high-water mark
+ * and the allocations that were live at it, so that the report tells which
+ * variables and ops account for the peak memory.
+ *
+ * Only the allocations since the profiler is enabled are tracked.
+ */
+
+namespace detail {
+extern std::atomic<bool> g_memory_profiler_enabled;
+}  // namespace detail
+
+inline bool IsMemoryProfilerEnabled() {
+  return detail::g_memory_profiler_enabled.load(std::memory_order_relaxed);
+}
+
+// Enable the memory profiler, the records of the previous profiling are
+// cleared.
+void EnableMemoryProfiler();
+
+void DisableMemoryProfiler();
+
+void RecordAlloc(const platform::Place& place, const void* ptr, size_t size);
+
+void RecordFree(const void* ptr);
+
+// Tag the allocation starting at ptr with the variable which holds it.
+void NameAllocation(const void* ptr, const std::string& var_name);
+
+// The allocations of the thread are tagged with the op in the scope.
+class MemoryProfilerOpGuard {
+ public:
+  explicit MemoryProfilerOpGuard(const std::string& op_type);
+  ~MemoryProfilerOpGuard();
+
+ private:
+  bool is_enabled_;
+};
+
+// The report of the places, with the current and the peak memory, the
+// fragmentation of the allocator, and the allocations live at the peak by
+// op and by variable.
+std::string MemoryProfilerReport();
+
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,79 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/memory/memory_profiler.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/memory/malloc.h"
+
+namespace paddle {
+namespace memory {
+
+TEST(MemoryProfiler, PeakAttribution) {
+  platform::CPUPlace cpu;
+  char buf[4];
+  EnableMemoryProfiler();
+  {
+    std::string op = "conv2d";
+    MemoryProfilerOpGuard guard(op);
+    RecordAlloc(cpu, buf, 1000);
+    NameAllocation(buf, "conv_out");
+    RecordAlloc(cpu, buf + 1, 3000);
+  }
+  {
+    std::string op = "relu";
+    MemoryProfilerOpGuard guard(op);
+    RecordAlloc(cpu, buf + 2, 500);
+    NameAllocation(buf + 2, "relu_out");
+  }
+  // The peak is 4500 bytes, the frees after it do not change the
+  // allocations live at the peak.
+  RecordFree(buf + 1);
+  RecordAlloc(cpu, buf + 3, 200);
+  RecordFree(buf + 3);
+  DisableMemoryProfiler();
+
+  std::string report = MemoryProfilerReport();
+  EXPECT_NE(report.find("Current: 1.46 KB"), std::string::npos) << report;
+  EXPECT_NE(report.find("Peak: 4.39 KB"), std::string::npos) << report;
+  EXPECT_NE(report.find("conv_out"), std::string::npos);
+  EXPECT_NE(report.find("relu_out"), std::string::npos);
+  EXPECT_NE(report.find("(unnamed)"), std::string::npos);
+  // conv2d is the first in the ops live at the peak.
+  EXPECT_LT(report.find("conv2d"), report.find("relu"));
+  EXPECT_NE(report.find("88.9%"), std::string::npos) << report;
+  // The allocation after the peak is not reported.
+  EXPECT_EQ(report.find("(no op)"), std::string::npos) << report;
+}
+
+TEST(MemoryProfiler, Malloc) {
+  platform::CPUPlace cpu;
+  EnableMemoryProfiler();
+  void* p = Alloc(cpu, 4096);
+  NameAllocation(p, "x");
+  std::string report = MemoryProfilerReport();
+  EXPECT_NE(report.find("Current: 4.00 KB"), std::string::npos) << report;
+  EXPECT_NE(report.find("fragmentation"), std::string::npos) << report;
+  Free(cpu, p);
+  DisableMemoryProfiler();
+  EXPECT_NE(MemoryProfilerReport().find("Current: 0 B"), std::string::npos);
+
+  auto stats = GetAllocatorStats(cpu);
+  EXPECT_GE(stats.free, stats.largest_free_chunk);
+}
+
+}  // namespace memory
+}  // namespace paddle
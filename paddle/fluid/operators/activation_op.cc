@@ -540,14 +540,16 @@ namespace ops = paddle::operators;
   REGISTER_OPERATOR(KERNEL_TYPE, ::paddle::operators::ActivationOp, \
                     ::paddle::operators::OP_NAME##OpMaker,          \
                     ::paddle::operators::ActivationOpInferVarType,  \
-                    ::paddle::operators::OP_NAME##GradMaker);       \
+                    ::paddle::operators::OP_NAME##GradMaker,        \
+                    ::paddle::framework::SingleOpInplaceInToOut);   \
   REGISTER_OPERATOR(KERNEL_TYPE##_grad, ::paddle::operators::ActivationOpGrad)
 
 #define REGISTER_ACTIVATION_OP(OP_NAME, KERNEL_TYPE)                    \
   REGISTER_OPERATOR(KERNEL_TYPE, ::paddle::operators::ActivationOp,     \
                     ::paddle::operators::OP_NAME##OpMaker,              \
                     ::paddle::operators::ActivationOpInferVarType,      \
-                    ::paddle::framework::DefaultGradOpDescMaker<true>); \
+                    ::paddle::framework::DefaultGradOpDescMaker<true>,  \
+                    ::paddle::framework::SingleOpInplaceInToOut);       \
   REGISTER_OPERATOR(KERNEL_TYPE##_grad, ::paddle::operators::ActivationOpGrad)
 
 #define REGISTER_ACTIVATION_CPU_KERNEL(act_type, functor, grad_functor)   \
@@ -555,13 +557,17 @@ namespace ops = paddle::operators;
       act_type, ops::ActivationKernel<paddle::platform::CPUDeviceContext, \
                                       ops::functor<float>>,               \
       ops::ActivationKernel<paddle::platform::CPUDeviceContext,           \
-                            ops::functor<double>>);                       \
+                            ops::functor<double>>,                        \
+      ops::ActivationKernel<paddle::platform::CPUDeviceContext,           \
+                            ops::functor<paddle::platform::bfloat16>>);   \
   REGISTER_OP_CPU_KERNEL(                                                 \
       act_type##_grad,                                                    \
       ops::ActivationGradKernel<paddle::platform::CPUDeviceContext,       \
                                 ops::grad_functor<float>>,                \
       ops::ActivationGradKernel<paddle::platform::CPUDeviceContext,       \
-                                ops::grad_functor<double>>);
+                                ops::grad_functor<double>>,               \
+      ops::ActivationGradKernel<paddle::platform::CPUDeviceContext,       \
+                                ops::grad_functor<paddle::platform::bfloat16>>);
 
 FOR_EACH_OP_FUNCTOR(REGISTER_ACTIVATION_OP);
 FOR_EACH_INPLACE_OP_FUNCTOR(REGISTER_INPLACE_ACTIVATION_OP);
@@ -19,7 +19,9 @@ limitations under the License. */
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/detail/safe_ref.h"
+#include "paddle/fluid/platform/bfloat16.h"
 #include "paddle/fluid/platform/float16.h"
+#include "paddle/fluid/platform/for_range.h"
 
 #ifdef PADDLE_WITH_MKLDNN
 #include "paddle/fluid/platform/mkldnn_helper.h"
@@ -53,17 +55,25 @@ class ActivationKernel
                             "Cannot get output tensor Out, variable name = %s",
                             context.op().Output("Out"));
     Out.mutable_data<T>(context.GetPlace());
-    auto x = framework::EigenVector<T>::Flatten(X);
-    auto out = framework::EigenVector<T>::Flatten(Out);
-    auto* place =
-        context.template device_context<DeviceContext>().eigen_device();
+    auto& dev_ctx = context.template device_context<DeviceContext>();
+    auto* place = dev_ctx.eigen_device();
     Functor functor;
 
     auto attrs = functor.GetAttrs();
     for (auto& attr : attrs) {
       *attr.second = context.Attr<float>(attr.first);
     }
-    functor(*place, x, out);
+    // The functors are elementwise, so the big tensors are split into the
+    // chunks on CPU.
+    const T* x_data = X.data<T>();
+    T* out_data = Out.data<T>();
+    platform::ParallelFor(dev_ctx, X.numel(), [&](int64_t begin, int64_t end) {
+      typename framework::EigenVector<T>::ConstType x(x_data + begin,
+                                                      end - begin);
+      typename framework::EigenVector<T>::Type out(out_data + begin,
+                                                   end - begin);
+      functor(*place, x, out);
+    });
   }
 };
 
@@ -79,26 +89,34 @@ class ActivationGradKernel
     auto* dX = context.Output<framework::Tensor>(framework::GradVarName("X"));
     dX->mutable_data<T>(context.GetPlace());
 
-    auto dout = framework::EigenVector<T>::Flatten(*dOut);
-    auto out = framework::EigenVector<T>::Flatten(*Out);
-    auto dx = framework::EigenVector<T>::Flatten(*dX);
-    auto* place =
-        context.template device_context<DeviceContext>().eigen_device();
+    auto& dev_ctx = context.template device_context<DeviceContext>();
+    auto* place = dev_ctx.eigen_device();
     Functor functor;
     auto attrs = functor.GetAttrs();
     for (auto& attr : attrs) {
       *attr.second = context.Attr<float>(attr.first);
     }
     bool inplace = functor.Inplace();
+    const T* x_data = nullptr;
     if (!inplace) {
-      auto* X = context.Input<framework::Tensor>("X");
-      auto x = framework::EigenVector<T>::Flatten(*X);
-      functor(*place, x, out, dout, dx);
+      x_data = context.Input<framework::Tensor>("X")->data<T>();
     } else {
       VLOG(10) << " Inplace activation ";
-      auto x = framework::EigenVector<T>::Flatten(*dX);
-      functor(*place, x, out, dout, dx);
+      x_data = dX->data<T>();
     }
+    const T* out_data = Out->data<T>();
+    const T* dout_data = dOut->data<T>();
+    T* dx_data = dX->data<T>();
+    using ConstVector = typename framework::EigenVector<T>::ConstType;
+    platform::ParallelFor(
+        dev_ctx, dX->numel(), [&](int64_t begin, int64_t end) {
+          ConstVector x(x_data + begin, end - begin);
+          ConstVector out(out_data + begin, end - begin);
+          ConstVector dout(dout_data + begin, end - begin);
+          typename framework::EigenVector<T>::Type dx(dx_data + begin,
+                                                      end - begin);
+          functor(*place, x, out, dout, dx);
+        });
   }
 };
 
@@ -378,6 +396,14 @@ struct Sine<platform::float16> {
   }
 };
 
+template <>
+struct Sine<platform::bfloat16> {
+  HOSTDEVICE platform::bfloat16 operator()(
+      const platform::bfloat16& val) const {
+    return platform::bfloat16(sin(static_cast<float>(val)));
+  }
+};
+
 template <typename T>
 struct Cosine {
   HOSTDEVICE T operator()(const T& val) const { return cos(val); }
@@ -390,6 +416,14 @@ struct Cosine<platform::float16> {
   }
 };
 
+template <>
+struct Cosine<platform::bfloat16> {
+  HOSTDEVICE platform::bfloat16 operator()(
+      const platform::bfloat16& val) const {
+    return platform::bfloat16(cos(static_cast<float>(val)));
+  }
+};
+
 // cosine'(x) = -sin(x)
 template <typename T>
 struct CosGradFunctor : public BaseActivationFunctor<T> {
@@ -740,7 +774,7 @@ struct PowGradFunctor : public BaseActivationFunctor<T> {
             typename dX>
   void operator()(Device d, X x, Out out, dOut dout, dX dx) const {
     dx.device(d) = dout * static_cast<T>(factor) *
-                   x.pow(static_cast<T>(factor - static_cast<T>(1)));
+                   x.pow(static_cast<T>(factor - 1));
   }
 };
 
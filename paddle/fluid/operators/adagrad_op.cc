@@ -19,6 +19,7 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
+#include "paddle/fluid/platform/for_range.h"
 
 namespace paddle {
 namespace operators {
@@ -99,12 +100,6 @@ for numerical stability to avoid the division by zero error.
   }
 };
 
-namespace {
-size_t FindPos(const std::vector<int64_t>& rows, int64_t value) {
-  return std::find(rows.begin(), rows.end(), value) - rows.begin();
-}
-}  // namespace
-
 template <typename T>
 struct SparseAdagradFunctor<platform::CPUDeviceContext, T> {
   void operator()(const platform::CPUDeviceContext& context,
@@ -116,27 +111,28 @@ struct SparseAdagradFunctor<platform::CPUDeviceContext, T> {
     math::scatter::MergeAdd<platform::CPUDeviceContext, T> merge_func;
     auto grad_merge = merge_func(context, grad);
     auto& merge_rows = grad_merge.rows();
-    auto* grad_merge_data = grad_merge.mutable_value()->template data<T>();
-
-    // 2. m += g_m * g_m
-    math::scatter::Mul<platform::CPUDeviceContext, T> sqare_func;
-    auto grad_square = sqare_func(context, grad_merge, grad_merge);
+    const auto* grad_merge_data = grad_merge.value().template data<T>();
 
-    math::SelectedRowsAddToTensor<platform::CPUDeviceContext, T> functor;
-    functor(context, grad_square, moment);
-
-    // 3. update parameter
-    auto* lr = learning_rate.data<T>();
+    // 2. m += g_m * g_m and update the parameter, only for the merged rows,
+    // which are distinct so they are updated in parallel.
+    T lr = learning_rate.data<T>()[0];
     auto* param_data = param->data<T>();
     auto* moment_data = moment->data<T>();
-
-    for (size_t i = 0; i < merge_rows.size(); i++) {
-      for (int64_t j = 0; j < grad_width; j++) {
-        param_data[merge_rows[i] * grad_width + j] -=
-            lr[0] * grad_merge_data[i * grad_width + j] /
-            (std::sqrt(moment_data[merge_rows[i] * grad_width + j]) + epsilon);
-      }
-    }
+    const int64_t* rows = merge_rows.data();
+    platform::ParallelFor(
+        context, static_cast<int64_t>(merge_rows.size()),
+        [=](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            const T* g = grad_merge_data + i * grad_width;
+            T* m = moment_data + rows[i] * grad_width;
+            T* p = param_data + rows[i] * grad_width;
+            for (int64_t j = 0; j < grad_width; ++j) {
+              m[j] += g[j] * g[j];
+              p[j] -= lr * g[j] / (std::sqrt(m[j]) + epsilon);
+            }
+          }
+        },
+        grad_width);
   }
 };
 
@@ -72,6 +72,15 @@ class AdamOp : public framework::OperatorWithKernel {
     ctx->SetOutputDim("ParamOut", param_dims);
     ctx->SetOutputDim("Moment1Out", param_dims);
     ctx->SetOutputDim("Moment2Out", param_dims);
+
+    if (ctx->HasInput("RowStep")) {
+      PADDLE_ENFORCE(ctx->HasOutput("RowStepOut"),
+                     "Output(RowStepOut) of AdamOp should not be null.");
+      auto row_step_dims = ctx->GetInputDim("RowStep");
+      PADDLE_ENFORCE_EQ(framework::product(row_step_dims), param_dims[0],
+                        "RowStep should have a step of each row of Param.");
+      ctx->SetOutputDim("RowStepOut", row_step_dims);
+    }
   }
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext &ctx) const override {
@@ -91,10 +100,18 @@ class AdamOpMaker : public framework::OpProtoAndCheckerMaker {
     AddInput("Moment2", "(Tensor) Input second moment");
     AddInput("Beta1Pow", "(Tensor) Input beta1 power accumulator");
     AddInput("Beta2Pow", "(Tensor) Input beta2 power accumulator");
+    AddInput("RowStep",
+             "(Tensor<int64_t>) the update steps of each row of Param, "
+             "which correct the beta powers of each row in lazy_mode.")
+        .AsDispensable();
 
     AddOutput("ParamOut", "(Tensor) Output parameter");
     AddOutput("Moment1Out", "(Tensor) Output first moment");
     AddOutput("Moment2Out", "(Tensor) Output second moment");
+    AddOutput("RowStepOut",
+              "(Tensor<int64_t>) the updated steps, sharing the memory with "
+              "Input(RowStep).")
+        .AsDispensable();
 
     AddAttr<float>("beta1",
                    "(float, default 0.9) "
@@ -110,6 +127,11 @@ class AdamOpMaker : public framework::OpProtoAndCheckerMaker {
                    "(float, default 1.0e-8) "
                    "Constant for numerical stability")
         .SetDefault(1.0e-8f);
+    AddAttr<bool>("lazy_mode",
+                  "(bool, default false) "
+                  "Only update the rows in the SelectedRows gradient, "
+                  "in place of Param and the moments.")
+        .SetDefault(false);
 
     AddComment(R"DOC(
 Adam Optimizer.
@@ -129,6 +151,10 @@ learning\_rate = learning\_rate *
 param\_out = param - learning\_rate * \frac{moment\_1}{\sqrt{moment\_2} + \epsilon}
 $$
 
+In lazy_mode, a SelectedRows gradient only updates its rows, so the moments of
+the other rows are not decayed. If RowStep is given, the $\beta_{1\_pow}$ and
+$\beta_{2\_pow}$ of each row are the powers of its own update steps.
+
 )DOC");
   }
 };
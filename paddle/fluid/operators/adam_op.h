@@ -227,6 +227,89 @@ struct SparseAdamFunctor {
   }
 };
 
+// The lazy update of the rows in the merged sparse gradient only, where the
+// moments of the other rows are not decayed. If row_step is given, the bias
+// correction of each row uses the beta powers of its own step count.
+template <typename T>
+struct LazySparseAdamFunctor {
+  T beta1_;
+  T beta2_;
+  T epsilon_;
+
+  const T* beta1_pow_;
+  const T* beta2_pow_;
+  const T* moment1_;
+  T* moment1_out_;
+  const T* moment2_;
+  T* moment2_out_;
+  const T* lr_;
+  const T* grad_;
+  const T* param_;
+  T* param_out_;
+
+  const int64_t* rows_;
+  int64_t row_numel_;
+  const int64_t* row_step_;
+
+  LazySparseAdamFunctor(T beta1, T beta2, T epsilon, const T* beta1_pow,
+                        const T* beta2_pow, const T* mom1, T* mom1_out,
+                        const T* mom2, T* mom2_out, const T* lr,
+                        const T* grad, const T* param, T* param_out,
+                        const int64_t* rows, int64_t row_numel,
+                        const int64_t* row_step)
+      : beta1_(beta1),
+        beta2_(beta2),
+        epsilon_(epsilon),
+        beta1_pow_(beta1_pow),
+        beta2_pow_(beta2_pow),
+        moment1_(mom1),
+        moment1_out_(mom1_out),
+        moment2_(mom2),
+        moment2_out_(mom2_out),
+        lr_(lr),
+        grad_(grad),
+        param_(param),
+        param_out_(param_out),
+        rows_(rows),
+        row_numel_(row_numel),
+        row_step_(row_step) {}
+
+  // Update the j-th element of the r-th row of the gradient.
+  inline HOSTDEVICE void Update(int64_t r, int64_t j) const {
+    int64_t row = rows_[r];
+    int64_t i = row * row_numel_ + j;
+    T g = grad_[r * row_numel_ + j];
+    T mom1 = moment1_[i];
+    T mom2 = moment2_[i];
+    T beta1_pow = *beta1_pow_;
+    T beta2_pow = *beta2_pow_;
+    if (row_step_ != nullptr) {
+      T step = static_cast<T>(row_step_[row] + 1);
+      beta1_pow = pow(beta1_, step);
+      beta2_pow = pow(beta2_, step);
+    }
+    T lr = *lr_ * sqrt(1 - beta2_pow) / (1 - beta1_pow);
+
+    mom1 = beta1_ * mom1 + (1 - beta1_) * g;
+    mom2 = beta2_ * mom2 + (1 - beta2_) * g * g;
+    moment1_out_[i] = mom1;
+    moment2_out_[i] = mom2;
+    param_out_[i] = param_[i] - lr * (mom1 / (sqrt(mom2) + epsilon_));
+  }
+
+  inline HOSTDEVICE void operator()(size_t i) const {
+    Update(i / row_numel_, i % row_numel_);
+  }
+};
+
+// row_step[rows[r]] += 1, run after the update reading the old steps.
+struct RowStepIncFunctor {
+  const int64_t* rows_;
+  int64_t* row_step_;
+
+  inline HOSTDEVICE void operator()(size_t r) const { ++row_step_[rows_[r]]; }
+};
+
 template <typename DeviceContext, typename T>
 class AdamOpKernel : public framework::OpKernel<T> {
  public:
@@ -343,6 +426,11 @@ class AdamOpKernel : public framework::OpKernel<T> {
 #endif
       auto row_numel = grad_tensor.numel() / grad_merge.rows().size();
 
+      if (ctx.Attr<bool>("lazy_mode")) {
+        LazyUpdate(ctx, grad_merge, rows, row_numel);
+        return;
+      }
+
       SparseAdamFunctor<T> functor(
           beta1, beta2, epsilon, beta1_pow.template data<T>(),
           beta2_pow.template data<T>(), mom1.template data<T>(),
@@ -360,6 +448,68 @@ class AdamOpKernel : public framework::OpKernel<T> {
       PADDLE_THROW("Variable type not supported by adam_op");
     }
   }
+
+ private:
+  void LazyUpdate(const framework::ExecutionContext& ctx,
+                  const framework::SelectedRows& grad_merge,
+                  const int64_t* rows, int64_t row_numel) const {
+    using paddle::framework::LoDTensor;
+    // The rows not in the gradient are left as they are, so the outputs
+    // should share the memory with the inputs.
+    auto* param_out = ctx.Output<LoDTensor>("ParamOut");
+    auto* mom1_out = ctx.Output<LoDTensor>("Moment1Out");
+    auto* mom2_out = ctx.Output<LoDTensor>("Moment2Out");
+    PADDLE_ENFORCE_EQ(ctx.Input<LoDTensor>("Param"), param_out,
+                      "ParamOut should be Param in lazy_mode.");
+    PADDLE_ENFORCE_EQ(ctx.Input<LoDTensor>("Moment1"), mom1_out,
+                      "Moment1Out should be Moment1 in lazy_mode.");
+    PADDLE_ENFORCE_EQ(ctx.Input<LoDTensor>("Moment2"), mom2_out,
+                      "Moment2Out should be Moment2 in lazy_mode.");
+
+    int64_t* row_step = nullptr;
+    if (ctx.HasInput("RowStep")) {
+      auto* row_step_out = ctx.Output<LoDTensor>("RowStepOut");
+      PADDLE_ENFORCE_EQ(ctx.Input<LoDTensor>("RowStep"), row_step_out,
+                        "RowStepOut should be RowStep in lazy_mode.");
+      PADDLE_ENFORCE_EQ(row_step_out->numel(), param_out->dims()[0],
+                        "RowStep should have a step of each row of Param.");
+      row_step = row_step_out->mutable_data<int64_t>(ctx.GetPlace());
+    }
+
+    LazySparseAdamFunctor<T> functor(
+        static_cast<T>(ctx.Attr<float>("beta1")),
+        static_cast<T>(ctx.Attr<float>("beta2")),
+        static_cast<T>(ctx.Attr<float>("epsilon")),
+        ctx.Input<LoDTensor>("Beta1Pow")->template data<T>(),
+        ctx.Input<LoDTensor>("Beta2Pow")->template data<T>(),
+        mom1_out->template data<T>(), mom1_out->template data<T>(),
+        mom2_out->template data<T>(), mom2_out->template data<T>(),
+        ctx.Input<LoDTensor>("LearningRate")->template data<T>(),
+        grad_merge.value().template data<T>(), param_out->template data<T>(),
+        param_out->template data<T>(), rows, row_numel, row_step);
+    int64_t row_count = static_cast<int64_t>(grad_merge.rows().size());
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    if (platform::is_cpu_place(ctx.GetPlace())) {
+      // The rows are updated in parallel, each by a loop over its elements.
+      platform::ParallelFor(dev_ctx, row_count,
+                            [&functor, row_numel](int64_t begin, int64_t end) {
+                              for (int64_t r = begin; r < end; ++r) {
+                                for (int64_t j = 0; j < row_numel; ++j) {
+                                  functor.Update(r, j);
+                                }
+                              }
+                            },
+                            row_numel);
+    } else {
+      platform::ForRange<DeviceContext> for_range(dev_ctx,
+                                                  row_count * row_numel);
+      for_range(functor);
+    }
+    if (row_step != nullptr) {
+      platform::ForRange<DeviceContext> for_range(dev_ctx, row_count);
+      for_range(RowStepIncFunctor{rows, row_step});
+    }
+  }
 };
 
 }  // namespace operators
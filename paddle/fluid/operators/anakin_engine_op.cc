@@ -0,0 +1,53 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#ifdef PADDLE_WITH_ANAKIN
+
+#include "paddle/fluid/operators/anakin_engine_op.h"
+
+namespace paddle {
+namespace operators {
+
+class AnakinEngineOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Xs", "A list of inputs.").AsDuplicable();
+    AddOutput("Ys", "A list of outputs").AsDuplicable();
+    AddAttr<std::string>("subgraph", "the subgraph.");
+    AddAttr<std::string>("engine_uniq_key",
+                         "unique key for the Anakin engine.");
+    AddAttr<int>("max_batch_size", "the maximum batch size.");
+    AddAttr<std::vector<std::string>>("parameters",
+                                      "the parameters of the subgraph.");
+    AddAttr<std::vector<std::string>>(
+        "output_name_mapping",
+        "the names of the outputs inside the subgraph, in the order of Ys.");
+    AddComment("Anakin engine operator.");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+
+REGISTER_OPERATOR(anakin_engine, ops::AnakinEngineOp,
+                  ops::AnakinEngineOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+
+REGISTER_OP_CPU_KERNEL(
+    anakin_engine,
+    ops::AnakinEngineKernel<paddle::platform::CPUDeviceContext, float>);
+
+#endif  // PADDLE_WITH_ANAKIN
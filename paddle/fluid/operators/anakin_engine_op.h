@@ -0,0 +1,161 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#ifdef PADDLE_WITH_ANAKIN
+
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/inference/anakin/convert/op_converter.h"
+#include "paddle/fluid/inference/anakin/engine.h"
+#include "paddle/fluid/inference/analysis/helper.h"
+
+namespace paddle {
+namespace operators {
+
+using inference::Singleton;
+
+// The Anakin target running the kernels of the device context.
+template <typename DeviceContext>
+struct AnakinTarget;
+
+template <>
+struct AnakinTarget<platform::CPUDeviceContext> {
+  using type = ::anakin::X86;
+  static int Device(const platform::Place& place) { return 0; }
+};
+
+#ifdef PADDLE_WITH_CUDA
+template <>
+struct AnakinTarget<platform::CUDADeviceContext> {
+  using type = ::anakin::NV;
+  static int Device(const platform::Place& place) {
+    return boost::get<platform::CUDAPlace>(place).device;
+  }
+};
+#endif
+
+class AnakinEngineOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+ protected:
+  void InferShape(framework::InferShapeContext* ctx) const override {}
+
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    auto input0 = ctx.Inputs("Xs").front();
+    framework::OpKernelType kt = framework::OpKernelType(
+        framework::ToDataType(ctx.scope()
+                                  .FindVar(input0)
+                                  ->GetMutable<framework::LoDTensor>()
+                                  ->type()),
+        ctx.GetPlace());
+    return kt;
+  }
+};
+
+template <typename DeviceContext, typename T>
+class AnakinEngineKernel : public framework::OpKernel<T> {
+  using Target = typename AnakinTarget<DeviceContext>::type;
+  using EngineManager = inference::anakin::AnakinEngineManager<Target>;
+
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto input_names = context.op().Inputs("Xs");
+    PADDLE_ENFORCE(!input_names.empty(), "should pass more than one inputs");
+    auto output_names = context.op().Outputs("Ys");
+    std::vector<std::string> output_maps =
+        context.Attr<std::vector<std::string>>("output_name_mapping");
+    PADDLE_ENFORCE_EQ(output_names.size(), output_maps.size());
+
+    auto params = context.Attr<std::vector<std::string>>("parameters");
+    std::unordered_set<std::string> parameters(params.begin(), params.end());
+
+    std::map<std::string, framework::LoDTensor*> inputs;
+    for (const auto& x : input_names) {
+      if (parameters.count(x)) continue;
+      auto& t = inference::analysis::GetFromScope<framework::LoDTensor>(
+          context.scope(), x);
+      PADDLE_ENFORCE(!t.lod().size() || t.lod()[0].size() <= 2,
+                     "Anakin engine does not take the sequences");
+      inputs[x] = &t;
+    }
+    PADDLE_ENFORCE(!inputs.empty(), "the inputs of Anakin engine are not set");
+    for (auto& input : inputs) {
+      PADDLE_ENFORCE_LE(input.second->dims()[0],
+                        context.Attr<int>("max_batch_size"),
+                        "the batch size exceeds the max_batch_size");
+    }
+
+    auto engine_name = context.Attr<std::string>("engine_uniq_key");
+    auto& manager = Singleton<EngineManager>::Global();
+    if (!manager.HasEngine(engine_name)) {
+      Prepare(context, engine_name, inputs);
+    }
+    auto* engine = manager.Get(engine_name);
+
+    std::map<std::string, framework::LoDTensor*> outputs;
+    for (size_t i = 0; i < output_names.size(); ++i) {
+      auto* fluid_v = context.scope().FindVar(output_names[i]);
+      PADDLE_ENFORCE_NOT_NULL(fluid_v, "no output variable called %s",
+                              output_names[i]);
+      outputs[output_maps[i]] = fluid_v->GetMutable<framework::LoDTensor>();
+    }
+    engine->Execute(inputs, outputs, context.GetPlace());
+  }
+
+ protected:
+  void Prepare(
+      const framework::ExecutionContext& context,
+      const std::string& engine_name,
+      const std::map<std::string, framework::LoDTensor*>& inputs) const {
+    VLOG(4) << "Prepare Anakin engine " << engine_name;
+    framework::proto::BlockDesc block_desc;
+    block_desc.ParseFromString(context.Attr<std::string>("subgraph"));
+
+    auto params = context.Attr<std::vector<std::string>>("parameters");
+    std::unordered_set<std::string> parameters(params.begin(), params.end());
+
+    auto* engine = Singleton<EngineManager>::Global().Create(
+        context.Attr<int>("max_batch_size"), engine_name,
+        AnakinTarget<DeviceContext>::Device(context.GetPlace()));
+
+    // Use the real shapes of the data, the dims of the variables may be -1.
+    for (auto& input : inputs) {
+      engine->DeclareInput(input.first,
+                           framework::vectorize2int(input.second->dims()));
+    }
+
+    Singleton<inference::anakin::AnakinOpConverter<Target>>::Global()
+        .ConvertBlock(block_desc, parameters, context.scope(), engine);
+
+    for (auto& output :
+         context.Attr<std::vector<std::string>>("output_name_mapping")) {
+      engine->DeclareOutput(output);
+    }
+    engine->Freeze();
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+#endif  // PADDLE_WITH_ANAKIN
@@ -12,10 +12,10 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
-#include <thrust/execution_policy.h>
-#include <thrust/sort.h>
+#include <thrust/device_vector.h>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/argsort_op.h"
+#include "paddle/fluid/operators/cub_sort.h"
 #include "paddle/fluid/platform/assert.h"
 #include "paddle/fluid/platform/cuda_device_function.h"
 #include "paddle/fluid/platform/cuda_primitives.h"
@@ -71,17 +71,6 @@ __global__ void PermuteInData(const T* in, const int64_t* trg_idx, int64_t n,
   }
 }
 
-template <typename T>
-__global__ void Sort(int64_t axis_dim, int64_t groups, T* med_out,
-                     int64_t* med_ids) {
-  int index = threadIdx.x + blockDim.x * blockIdx.x;
-  if (index < groups) {
-    thrust::sort_by_key(thrust::device, med_out + index * axis_dim,
-                        med_out + axis_dim * (1 + index),
-                        med_ids + index * axis_dim);
-  }
-}
-
 template <typename T>
 __global__ void PermuteMediateData(const T* med_out, const int64_t* med_ids,
                                    const int64_t* trg_idx, int64_t n, T* out,
@@ -135,12 +124,20 @@ class ArgsortOpCUDAKernel : public framework::OpKernel<T> {
     PermuteInData<<<(numel - 1) / num_threads + 1, num_threads, 0, stream>>>(
         in_data, trg_idx, numel, med_out_data);
 
-    Sort<<<(groups - 1) / num_threads + 1, num_threads, 0, stream>>>(
-        in_dims[axis], groups, med_out_data, med_ids_data);
+    // Sort every group by the segmented radix sort
+    Tensor sorted_output, sorted_indices;
+    T* sorted_out_data =
+        sorted_output.mutable_data<T>(input->dims(), ctx.GetPlace());
+    int64_t* sorted_ids_data =
+        sorted_indices.mutable_data<int64_t>(in_dims, ctx.GetPlace());
+    SegmentedSortPairs<T, int64_t>(ctx.cuda_device_context(), med_out_data,
+                                   sorted_out_data, med_ids_data,
+                                   sorted_ids_data, groups, in_dims[axis],
+                                   /* descending= */ false);
 
     PermuteMediateData<<<(numel - 1) / num_threads + 1, num_threads, 0,
-                         stream>>>(med_out_data, med_ids_data, trg_idx, numel,
-                                   out_data, ids_data);
+                         stream>>>(sorted_out_data, sorted_ids_data, trg_idx,
+                                   numel, out_data, ids_data);
   }
 };
 
@@ -43,6 +43,9 @@ class ArgsortKernel : public framework::OpKernel<T> {
                          : framework::product(framework::slice_ddim(
                                in_dims, axis + 1, in_dims.size()));
 
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
     for (int64_t i = 0; i < groups; ++i) {
       int64_t idx = i;
       std::vector<int64_t> shape_vec(in_dims.size(), 0);
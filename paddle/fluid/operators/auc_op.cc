@@ -41,6 +41,11 @@ class AucOp : public framework::OperatorWithKernel {
     PADDLE_ENFORCE_GE(num_pred_buckets, 1, "num_thresholds must larger than 1");
     PADDLE_ENFORCE_GE(slide_steps, 0, "slide_steps must be natural number");
 
+    PADDLE_ENFORCE_EQ(ctx->HasInput("BatchStatPos"),
+                      ctx->HasInput("BatchStatNeg"),
+                      "Input(BatchStatPos) and Input(BatchStatNeg) should be "
+                      "given together.");
+
     ctx->SetOutputDim("AUC", {1});
 
     slide_steps = slide_steps == 0 ? 1 : slide_steps;
@@ -71,6 +76,15 @@ class AucOpMaker : public framework::OpProtoAndCheckerMaker {
     // TODO(typhoonzero): support weight input
     AddInput("StatPos", "Statistic value when label = 1");
     AddInput("StatNeg", "Statistic value when label = 0");
+    AddInput("BatchStatPos",
+             "(Tensor, optional) The statistic value of the batch when "
+             "label = 1, the output of auc_stat. If it is given, the batch "
+             "is not counted again from Predict and Label.")
+        .AsDispensable();
+    AddInput("BatchStatNeg",
+             "(Tensor, optional) The statistic value of the batch when "
+             "label = 0, the output of auc_stat.")
+        .AsDispensable();
 
     AddOutput("AUC",
               "A scalar representing the "
@@ -100,6 +114,13 @@ https://en.wikipedia.org/wiki/Receiver_operating_characteristic#Area_under_the_c
 There are two types of possible curves:
 1. ROC: Receiver operating characteristic
 2. PR: Precision Recall
+
+The statistics of the thresholds are kept in StatPosOut and StatNegOut,
+which should be persistable. With slide_steps > 0 they are the sliding
+window of the last slide_steps batches, otherwise they are accumulated
+over all the batches. When BatchStatPos and BatchStatNeg from auc_stat are
+given, the ParallelExecutor sums them over the devices before this
+operator runs, so that the AUC is a global one.
 )DOC");
   }
 };
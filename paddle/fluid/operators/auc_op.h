@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <cstring>
 #include <string>
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
@@ -23,6 +24,47 @@ namespace operators {
 
 using Tensor = framework::Tensor;
 
+// Counts the positive and the negative samples of the batch in the buckets
+// of their predicted probabilities.
+template <typename T>
+inline void StatBatch(const framework::Tensor *label,
+                      const framework::Tensor *predict,
+                      const int num_thresholds, int64_t *stat_pos,
+                      int64_t *stat_neg) {
+  size_t batch_size = predict->dims()[0];
+  size_t inference_width = predict->dims()[1];
+  const T *inference_data = predict->data<T>();
+  const auto *label_data = label->data<int64_t>();
+
+  for (size_t i = 0; i < batch_size; i++) {
+    uint32_t binIdx = static_cast<uint32_t>(
+        inference_data[i * inference_width + 1] * num_thresholds);
+    if (label_data[i]) {
+      stat_pos[binIdx] += 1;
+    } else {
+      stat_neg[binIdx] += 1;
+    }
+  }
+}
+
+template <typename DeviceContext, typename T>
+class AucStatKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &ctx) const override {
+    auto *predict = ctx.Input<Tensor>("Predict");
+    auto *label = ctx.Input<Tensor>("Label");
+    auto *stat_pos = ctx.Output<Tensor>("StatPos");
+    auto *stat_neg = ctx.Output<Tensor>("StatNeg");
+    int num_thresholds = ctx.Attr<int>("num_thresholds");
+
+    auto *stat_pos_data = stat_pos->mutable_data<int64_t>(ctx.GetPlace());
+    auto *stat_neg_data = stat_neg->mutable_data<int64_t>(ctx.GetPlace());
+    std::memset(stat_pos_data, 0, stat_pos->numel() * sizeof(int64_t));
+    std::memset(stat_neg_data, 0, stat_neg->numel() * sizeof(int64_t));
+    StatBatch<T>(label, predict, num_thresholds, stat_pos_data, stat_neg_data);
+  }
+};
+
 template <typename DeviceContext, typename T>
 class AucKernel : public framework::OpKernel<T> {
  public:
@@ -51,8 +93,24 @@ class AucKernel : public framework::OpKernel<T> {
     auto stat_pos_calc = stat_pos_data.data();
     auto stat_neg_calc = stat_neg_data.data();
 
-    statAuc(label, predict, num_pred_buckets, num_thresholds, slide_steps,
-            origin_stat_pos, origin_stat_neg, &stat_pos_calc, &stat_neg_calc);
+    // The statistics of the batch are given by auc_stat when they are summed
+    // over the devices, otherwise they are counted here.
+    auto *batch_stat_pos = ctx.Input<Tensor>("BatchStatPos");
+    auto *batch_stat_neg = ctx.Input<Tensor>("BatchStatNeg");
+    if (batch_stat_pos != nullptr && batch_stat_neg != nullptr) {
+      PADDLE_ENFORCE_EQ(batch_stat_pos->numel(), num_pred_buckets);
+      PADDLE_ENFORCE_EQ(batch_stat_neg->numel(), num_pred_buckets);
+      std::memcpy(stat_pos_calc, batch_stat_pos->data<int64_t>(),
+                  num_pred_buckets * sizeof(int64_t));
+      std::memcpy(stat_neg_calc, batch_stat_neg->data<int64_t>(),
+                  num_pred_buckets * sizeof(int64_t));
+    } else {
+      StatBatch<T>(label, predict, num_thresholds, stat_pos_calc,
+                   stat_neg_calc);
+    }
+
+    statAuc(num_pred_buckets, slide_steps, origin_stat_pos, origin_stat_neg,
+            &stat_pos_calc, &stat_neg_calc);
 
     calcAuc(ctx, stat_pos_calc, stat_neg_calc, num_thresholds, auc);
   }
@@ -63,27 +121,9 @@ class AucKernel : public framework::OpKernel<T> {
     return (X1 > X2 ? (X1 - X2) : (X2 - X1)) * (Y1 + Y2) / 2.0;
   }
 
-  inline static void statAuc(const framework::Tensor *label,
-                             const framework::Tensor *predict,
-                             const int num_pred_buckets,
-                             const int num_thresholds, const int slide_steps,
+  inline static void statAuc(const int num_pred_buckets, const int slide_steps,
                              int64_t *origin_stat_pos, int64_t *origin_stat_neg,
                              int64_t **stat_pos, int64_t **stat_neg) {
-    size_t batch_size = predict->dims()[0];
-    size_t inference_width = predict->dims()[1];
-    const T *inference_data = predict->data<T>();
-    const auto *label_data = label->data<int64_t>();
-
-    for (size_t i = 0; i < batch_size; i++) {
-      uint32_t binIdx = static_cast<uint32_t>(
-          inference_data[i * inference_width + 1] * num_thresholds);
-      if (label_data[i]) {
-        (*stat_pos)[binIdx] += 1.0;
-      } else {
-        (*stat_neg)[binIdx] += 1.0;
-      }
-    }
-
     int bucket_length = num_pred_buckets * sizeof(int64_t);
 
     // will stat auc unlimited.
@@ -115,8 +155,8 @@ class AucKernel : public framework::OpKernel<T> {
       std::memset(*stat_neg, 0, bucket_length);
 
       for (int slide = 0; slide < num_pred_buckets; ++slide) {
-        int stat_pos_steps = 0;
-        int stat_neg_steps = 0;
+        int64_t stat_pos_steps = 0;
+        int64_t stat_neg_steps = 0;
         for (int step = 0; step < slide_steps; ++step) {
           stat_pos_steps += origin_stat_pos[slide + step * num_pred_buckets];
           stat_neg_steps += origin_stat_neg[slide + step * num_pred_buckets];
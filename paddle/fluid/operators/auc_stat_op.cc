@@ -0,0 +1,89 @@
+/* Copyright (c) 2016 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/auc_op.h"
+
+namespace paddle {
+namespace operators {
+
+class AucStatOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+ protected:
+  void InferShape(framework::InferShapeContext *ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("Predict"),
+                   "Input(Predict) should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("Label"), "Input(Label) should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("StatPos"),
+                   "Output(StatPos) should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("StatNeg"),
+                   "Output(StatNeg) should not be null.");
+    auto predict_dims = ctx->GetInputDim("Predict");
+    PADDLE_ENFORCE_EQ(predict_dims[1], 2, "Only support binary classification");
+    PADDLE_ENFORCE_EQ(predict_dims[0], ctx->GetInputDim("Label")[0],
+                      "Predict and Label should have same height.");
+
+    int num_pred_buckets = ctx->Attrs().Get<int>("num_thresholds") + 1;
+    PADDLE_ENFORCE_GE(num_pred_buckets, 1, "num_thresholds must larger than 1");
+    ctx->SetOutputDim("StatPos", {1, num_pred_buckets});
+    ctx->SetOutputDim("StatNeg", {1, num_pred_buckets});
+  }
+
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext &ctx) const override {
+    return framework::OpKernelType(
+        framework::ToDataType(ctx.Input<Tensor>("Predict")->type()),
+        ctx.device_context());
+  }
+};
+
+class AucStatOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Predict",
+             "A floating point 2D tensor with shape [batch_size, 2], values "
+             "are in the range [0, 1].");
+    AddInput("Label",
+             "A 2D int tensor indicating the label of the training data. "
+             "shape: [batch_size, 1]");
+    AddOutput("StatPos",
+              "(Tensor) The number of the samples with label = 1 in each "
+              "bucket of the batch, shape: [1, num_thresholds + 1]");
+    AddOutput("StatNeg",
+              "(Tensor) The number of the samples with label = 0 in each "
+              "bucket of the batch, shape: [1, num_thresholds + 1]");
+    AddAttr<int>(
+        "num_thresholds",
+        "The number of thresholds to use when discretizing the roc curve.")
+        .SetDefault((2 << 12) - 1);
+    AddComment(R"DOC(
+AUC Statistic Operator.
+
+Counts the positive and the negative samples of a batch in the buckets of
+their predicted probabilities, which are the inputs BatchStatPos and
+BatchStatNeg of the auc operator. The ParallelExecutor all reduces the
+outputs of this operator over the devices, so the auc operators on all the
+devices update their statistics by the same global batch.
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(auc_stat, ops::AucStatOp, ops::AucStatOpMaker);
+REGISTER_OP_CPU_KERNEL(auc_stat,
+                       ops::AucStatKernel<paddle::platform::CPUPlace, float>);
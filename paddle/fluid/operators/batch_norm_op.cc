@@ -154,7 +154,7 @@ class BatchNormOpMaker : public framework::OpProtoAndCheckerMaker {
                   "(bool, default false) Only used in mkldnn kernel")
         .SetDefault(false);
     AddAttr<bool>("fuse_with_relu",
-                  "(bool, default false) Only used in mkldnn kernel")
+                  "(bool, default false) Only used in mkldnn and CUDA kernel")
         .SetDefault(false);
     AddComment(R"DOC(
 Batch Normalization.
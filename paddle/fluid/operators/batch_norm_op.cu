@@ -0,0 +1,239 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <cub/cub.cuh>
+#include "paddle/fluid/operators/batch_norm_op.h"
+#include "paddle/fluid/operators/welford.cu.h"
+#include "paddle/fluid/platform/float16.h"
+
+namespace paddle {
+namespace operators {
+
+// The index of the i-th of the N * sample_size elements of the channel c.
+template <DataLayout layout>
+__device__ __forceinline__ int ChannelElementIndex(int c, int i, int C,
+                                                   int sample_size) {
+  return layout == DataLayout::kNCHW
+             ? (i / sample_size * C + c) * sample_size + i % sample_size
+             : i * C + c;
+}
+
+// A block reduces the statistics of a channel and normalizes it.
+template <typename T, typename ParamT, DataLayout layout, int BlockDim>
+__global__ void BatchNormReluForwardTrainingKernel(
+    const T *x, const ParamT *scale, const ParamT *bias, int N, int C,
+    int sample_size, ParamT epsilon, ParamT factor, T *y, ParamT *mean_out,
+    ParamT *variance_out, ParamT *saved_mean, ParamT *saved_inv_std) {
+  using BlockReduce = cub::BlockReduce<WelfordData<ParamT>, BlockDim>;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  __shared__ ParamT new_scale_shared;
+  __shared__ ParamT new_bias_shared;
+
+  int c = blockIdx.x;
+  int inner_size = N * sample_size;
+  WelfordData<ParamT> data;
+  for (int i = threadIdx.x; i < inner_size; i += BlockDim) {
+    int idx = ChannelElementIndex<layout>(c, i, C, sample_size);
+    data.Update(static_cast<ParamT>(x[idx]));
+  }
+  data = BlockReduce(temp_storage).Reduce(data, WelfordMergeFunctor<ParamT>());
+
+  if (threadIdx.x == 0) {
+    ParamT inv_std = 1 / sqrt(data.m2 / inner_size + epsilon);
+    saved_mean[c] = data.mean;
+    saved_inv_std[c] = inv_std;
+    // The running variance is unbiased, as the one of cuDNN.
+    mean_out[c] = (1 - factor) * mean_out[c] + factor * data.mean;
+    variance_out[c] = (1 - factor) * variance_out[c] +
+                      factor * data.m2 / (inner_size - 1);
+    new_scale_shared = scale[c] * inv_std;
+    new_bias_shared = bias[c] - data.mean * scale[c] * inv_std;
+  }
+  __syncthreads();
+
+  ParamT new_scale = new_scale_shared;
+  ParamT new_bias = new_bias_shared;
+  for (int i = threadIdx.x; i < inner_size; i += BlockDim) {
+    int idx = ChannelElementIndex<layout>(c, i, C, sample_size);
+    ParamT out = static_cast<ParamT>(x[idx]) * new_scale + new_bias;
+    y[idx] = static_cast<T>(out > 0 ? out : 0);
+  }
+}
+
+template <typename T, typename ParamT, DataLayout layout>
+__global__ void BatchNormReluForwardInferenceKernel(
+    const T *x, const ParamT *scale, const ParamT *bias, const ParamT *mean,
+    const ParamT *variance, int num, int C, int sample_size, ParamT epsilon,
+    T *y) {
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < num;
+       i += blockDim.x * gridDim.x) {
+    int c = layout == DataLayout::kNCHW ? i / sample_size % C : i % C;
+    ParamT inv_std = 1 / sqrt(variance[c] + epsilon);
+    ParamT out =
+        (static_cast<ParamT>(x[i]) - mean[c]) * inv_std * scale[c] + bias[c];
+    y[i] = static_cast<T>(out > 0 ? out : 0);
+  }
+}
+
+// With g = d_y * (y > 0), d_bias = sum(g), d_scale = sum(g * x_hat) and
+// d_x = scale * inv_std * (g - mean(g) - x_hat * mean(g * x_hat)).
+template <typename T, typename ParamT, DataLayout layout, int BlockDim>
+__global__ void BatchNormReluBackwardKernel(
+    const T *x, const T *d_y, const ParamT *scale, const ParamT *bias,
+    const ParamT *saved_mean, const ParamT *saved_inv_std, int N, int C,
+    int sample_size, T *d_x, ParamT *d_scale, ParamT *d_bias) {
+  using BlockReduce = cub::BlockReduce<ParamT, BlockDim>;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  __shared__ ParamT d_scale_shared;
+  __shared__ ParamT d_bias_shared;
+
+  int c = blockIdx.x;
+  int inner_size = N * sample_size;
+  ParamT mean = saved_mean[c];
+  ParamT inv_std = saved_inv_std[c];
+  ParamT channel_scale = scale[c];
+  ParamT channel_bias = bias[c];
+
+  ParamT sum_g = 0, sum_g_x_hat = 0;
+  for (int i = threadIdx.x; i < inner_size; i += BlockDim) {
+    int idx = ChannelElementIndex<layout>(c, i, C, sample_size);
+    ParamT x_hat = (static_cast<ParamT>(x[idx]) - mean) * inv_std;
+    ParamT g = x_hat * channel_scale + channel_bias > 0
+                   ? static_cast<ParamT>(d_y[idx])
+                   : 0;
+    sum_g += g;
+    sum_g_x_hat += g * x_hat;
+  }
+  sum_g = BlockReduce(temp_storage).Reduce(sum_g, cub::Sum());
+  __syncthreads();
+  sum_g_x_hat = BlockReduce(temp_storage).Reduce(sum_g_x_hat, cub::Sum());
+  if (threadIdx.x == 0) {
+    d_bias[c] = d_bias_shared = sum_g;
+    d_scale[c] = d_scale_shared = sum_g_x_hat;
+  }
+  __syncthreads();
+
+  ParamT mean_g = d_bias_shared / inner_size;
+  ParamT mean_g_x_hat = d_scale_shared / inner_size;
+  for (int i = threadIdx.x; i < inner_size; i += BlockDim) {
+    int idx = ChannelElementIndex<layout>(c, i, C, sample_size);
+    ParamT x_hat = (static_cast<ParamT>(x[idx]) - mean) * inv_std;
+    ParamT g = x_hat * channel_scale + channel_bias > 0
+                   ? static_cast<ParamT>(d_y[idx])
+                   : 0;
+    d_x[idx] = static_cast<T>(channel_scale * inv_std *
+                              (g - mean_g - x_hat * mean_g_x_hat));
+  }
+}
+
+static constexpr int kBatchNormBlockDim = 512;
+
+template <typename T, typename ParamT>
+void BatchNormReluForwardTraining(const platform::CUDADeviceContext &ctx,
+                                  DataLayout layout, int N, int C,
+                                  int sample_size, const T *x,
+                                  const ParamT *scale, const ParamT *bias,
+                                  double epsilon, double momentum, T *y,
+                                  ParamT *mean_out, ParamT *variance_out,
+                                  ParamT *saved_mean, ParamT *saved_inv_std) {
+  auto eps = static_cast<ParamT>(epsilon);
+  auto factor = static_cast<ParamT>(1. - momentum);
+  if (layout == DataLayout::kNCHW) {
+    BatchNormReluForwardTrainingKernel<
+        T, ParamT, DataLayout::kNCHW,
+        kBatchNormBlockDim><<<C, kBatchNormBlockDim, 0, ctx.stream()>>>(
+        x, scale, bias, N, C, sample_size, eps, factor, y, mean_out,
+        variance_out, saved_mean, saved_inv_std);
+  } else {
+    BatchNormReluForwardTrainingKernel<
+        T, ParamT, DataLayout::kNHWC,
+        kBatchNormBlockDim><<<C, kBatchNormBlockDim, 0, ctx.stream()>>>(
+        x, scale, bias, N, C, sample_size, eps, factor, y, mean_out,
+        variance_out, saved_mean, saved_inv_std);
+  }
+}
+
+template <typename T, typename ParamT>
+void BatchNormReluForwardInference(const platform::CUDADeviceContext &ctx,
+                                   DataLayout layout, int N, int C,
+                                   int sample_size, const T *x,
+                                   const ParamT *scale, const ParamT *bias,
+                                   const ParamT *mean, const ParamT *variance,
+                                   double epsilon, T *y) {
+  const int kThreads = 512;
+  int num = N * C * sample_size;
+  int max_blocks = std::max(ctx.GetMaxPhysicalThreadCount() / kThreads, 1);
+  int blocks = std::min((num + kThreads - 1) / kThreads, max_blocks);
+  auto eps = static_cast<ParamT>(epsilon);
+  if (layout == DataLayout::kNCHW) {
+    BatchNormReluForwardInferenceKernel<
+        T, ParamT, DataLayout::kNCHW><<<blocks, kThreads, 0, ctx.stream()>>>(
+        x, scale, bias, mean, variance, num, C, sample_size, eps, y);
+  } else {
+    BatchNormReluForwardInferenceKernel<
+        T, ParamT, DataLayout::kNHWC><<<blocks, kThreads, 0, ctx.stream()>>>(
+        x, scale, bias, mean, variance, num, C, sample_size, eps, y);
+  }
+}
+
+template <typename T, typename ParamT>
+void BatchNormReluBackward(const platform::CUDADeviceContext &ctx,
+                           DataLayout layout, int N, int C, int sample_size,
+                           const T *x, const T *d_y, const ParamT *scale,
+                           const ParamT *bias, const ParamT *saved_mean,
+                           const ParamT *saved_inv_std, T *d_x,
+                           ParamT *d_scale, ParamT *d_bias) {
+  if (layout == DataLayout::kNCHW) {
+    BatchNormReluBackwardKernel<
+        T, ParamT, DataLayout::kNCHW,
+        kBatchNormBlockDim><<<C, kBatchNormBlockDim, 0, ctx.stream()>>>(
+        x, d_y, scale, bias, saved_mean, saved_inv_std, N, C, sample_size, d_x,
+        d_scale, d_bias);
+  } else {
+    BatchNormReluBackwardKernel<
+        T, ParamT, DataLayout::kNHWC,
+        kBatchNormBlockDim><<<C, kBatchNormBlockDim, 0, ctx.stream()>>>(
+        x, d_y, scale, bias, saved_mean, saved_inv_std, N, C, sample_size, d_x,
+        d_scale, d_bias);
+  }
+}
+
+#define INSTANTIATE_BATCH_NORM_RELU_FORWARD(T, ParamT)                       \
+  template void BatchNormReluForwardTraining<T, ParamT>(                     \
+      const platform::CUDADeviceContext &, DataLayout, int, int, int,        \
+      const T *, const ParamT *, const ParamT *, double, double, T *,        \
+      ParamT *, ParamT *, ParamT *, ParamT *);                               \
+  template void BatchNormReluForwardInference<T, ParamT>(                    \
+      const platform::CUDADeviceContext &, DataLayout, int, int, int,        \
+      const T *, const ParamT *, const ParamT *, const ParamT *,             \
+      const ParamT *, double, T *)
+
+#define INSTANTIATE_BATCH_NORM_RELU_BACKWARD(T, ParamT)                      \
+  template void BatchNormReluBackward<T, ParamT>(                            \
+      const platform::CUDADeviceContext &, DataLayout, int, int, int,        \
+      const T *, const T *, const ParamT *, const ParamT *, const ParamT *,  \
+      const ParamT *, T *, ParamT *, ParamT *)
+
+INSTANTIATE_BATCH_NORM_RELU_FORWARD(float, float);
+INSTANTIATE_BATCH_NORM_RELU_FORWARD(double, double);
+INSTANTIATE_BATCH_NORM_RELU_FORWARD(platform::float16, float);
+INSTANTIATE_BATCH_NORM_RELU_BACKWARD(float, float);
+INSTANTIATE_BATCH_NORM_RELU_BACKWARD(double, double);
+
+#undef INSTANTIATE_BATCH_NORM_RELU_FORWARD
+#undef INSTANTIATE_BATCH_NORM_RELU_BACKWARD
+
+}  // namespace operators
+}  // namespace paddle
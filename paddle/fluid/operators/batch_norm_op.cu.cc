@@ -59,6 +59,7 @@ class BatchNormKernel<platform::CUDADeviceContext, T>
     double epsilon = static_cast<double>(ctx.Attr<float>("epsilon"));
     const float momentum = ctx.Attr<float>("momentum");
     const bool is_test = ctx.Attr<bool>("is_test");
+    const bool fuse_with_relu = ctx.Attr<bool>("fuse_with_relu");
     const std::string data_layout_str = ctx.Attr<std::string>("data_layout");
     const DataLayout data_layout =
         framework::StringToDataLayout(data_layout_str);
@@ -131,16 +132,27 @@ class BatchNormKernel<platform::CUDADeviceContext, T>
       PADDLE_ENFORCE_EQ(est_mean->dims()[0], C);
       PADDLE_ENFORCE_EQ(est_var->dims()[0], C);
 
-      CUDNN_ENFORCE(platform::dynload::cudnnBatchNormalizationForwardInference(
-          handle,
-          // Note: PERSISTENT not implemented for inference
-          CUDNN_BATCHNORM_SPATIAL, CudnnDataType<T>::kOne(),
-          CudnnDataType<T>::kZero(), data_desc_, x->template data<T>(),
-          data_desc_, y->template mutable_data<T>(ctx.GetPlace()),
-          bn_param_desc_, scale->template data<BatchNormParamType<T>>(),
-          bias->template data<BatchNormParamType<T>>(),
-          est_mean->template data<BatchNormParamType<T>>(),
-          est_var->template data<BatchNormParamType<T>>(), epsilon));
+      if (fuse_with_relu) {
+        BatchNormReluForwardInference<T, BatchNormParamType<T>>(
+            dev_ctx, data_layout, N, C, H * W * D, x->template data<T>(),
+            scale->template data<BatchNormParamType<T>>(),
+            bias->template data<BatchNormParamType<T>>(),
+            est_mean->template data<BatchNormParamType<T>>(),
+            est_var->template data<BatchNormParamType<T>>(), epsilon,
+            y->template mutable_data<T>(ctx.GetPlace()));
+      } else {
+        CUDNN_ENFORCE(
+            platform::dynload::cudnnBatchNormalizationForwardInference(
+                handle,
+                // Note: PERSISTENT not implemented for inference
+                CUDNN_BATCHNORM_SPATIAL, CudnnDataType<T>::kOne(),
+                CudnnDataType<T>::kZero(), data_desc_, x->template data<T>(),
+                data_desc_, y->template mutable_data<T>(ctx.GetPlace()),
+                bn_param_desc_, scale->template data<BatchNormParamType<T>>(),
+                bias->template data<BatchNormParamType<T>>(),
+                est_mean->template data<BatchNormParamType<T>>(),
+                est_var->template data<BatchNormParamType<T>>(), epsilon));
+      }
     } else {
       // Run training mode.
       // obtain running mean and running inv var, and see if we need to
@@ -164,6 +176,20 @@ class BatchNormKernel<platform::CUDADeviceContext, T>
         LOG(WARNING) << "Only 1 element in normalization dimension, "
                      << "we skip the batch norm calculation, let y = x.";
         framework::TensorCopySync(*x, ctx.GetPlace(), y);
+      } else if (fuse_with_relu) {
+        BatchNormReluForwardTraining<T, BatchNormParamType<T>>(
+            dev_ctx, data_layout, N, C, H * W * D, x->template data<T>(),
+            scale->template data<BatchNormParamType<T>>(),
+            bias->template data<BatchNormParamType<T>>(), epsilon, momentum,
+            y->template mutable_data<T>(ctx.GetPlace()),
+            mean_out->template mutable_data<BatchNormParamType<T>>(
+                ctx.GetPlace()),
+            variance_out->template mutable_data<BatchNormParamType<T>>(
+                ctx.GetPlace()),
+            saved_mean->template mutable_data<BatchNormParamType<T>>(
+                ctx.GetPlace()),
+            saved_variance->template mutable_data<BatchNormParamType<T>>(
+                ctx.GetPlace()));
       } else {
         double this_factor = 1. - momentum;
 
@@ -199,6 +225,7 @@ class BatchNormGradKernel<platform::CUDADeviceContext, T>
     PADDLE_ENFORCE(platform::is_gpu_place(ctx.GetPlace()),
                    "It must use CUDAPlace.");
     double epsilon = static_cast<double>(ctx.Attr<float>("epsilon"));
+    const bool fuse_with_relu = ctx.Attr<bool>("fuse_with_relu");
     const std::string data_layout_str = ctx.Attr<std::string>("data_layout");
     const DataLayout data_layout =
         framework::StringToDataLayout(data_layout_str);
@@ -235,6 +262,24 @@ class BatchNormGradKernel<platform::CUDADeviceContext, T>
     PADDLE_ENFORCE_EQ(scale->dims().size(), 1UL);
     PADDLE_ENFORCE_EQ(scale->dims()[0], C);
 
+    if (fuse_with_relu) {
+      // The fused kernels save the inverse std as cuDNN does.
+      const auto *bias = ctx.Input<Tensor>("Bias");
+      const auto *saved_mean = ctx.Input<Tensor>("SavedMean");
+      const auto *saved_inv_std = ctx.Input<Tensor>("SavedVariance");
+      BatchNormReluBackward<T, BatchNormParamType<T>>(
+          dev_ctx, data_layout, N, C, H * W * D, x->template data<T>(),
+          d_y->template data<T>(),
+          scale->template data<BatchNormParamType<T>>(),
+          bias->template data<BatchNormParamType<T>>(),
+          saved_mean->template data<BatchNormParamType<T>>(),
+          saved_inv_std->template data<BatchNormParamType<T>>(),
+          d_x->template mutable_data<T>(ctx.GetPlace()),
+          d_scale->template mutable_data<BatchNormParamType<T>>(ctx.GetPlace()),
+          d_bias->template mutable_data<BatchNormParamType<T>>(ctx.GetPlace()));
+      return;
+    }
+
     // ------------------- cudnn descriptors ---------------------
     cudnnTensorDescriptor_t data_desc_;
     cudnnTensorDescriptor_t bn_param_desc_;
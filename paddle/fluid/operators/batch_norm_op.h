@@ -47,5 +47,38 @@ class BatchNormGradKernel : public framework::OpKernel<T> {
   void Compute(const framework::ExecutionContext& ctx) const override;
 };
 
+#ifdef PADDLE_WITH_CUDA
+// The batch norm fused with relu on CUDA, y = max(scale * x_hat + bias, 0).
+// The statistics of a channel are gathered in a single pass by Welford's
+// algorithm and x is normalized by the same kernel. The training saves only
+// the mean and the inverse std of the channels, the backward recomputes the
+// relu mask from x instead of reading y. ParamT is the type of the scale, the
+// bias and the statistics, the sample_size is H * W * D.
+template <typename T, typename ParamT>
+void BatchNormReluForwardTraining(const platform::CUDADeviceContext &ctx,
+                                  DataLayout layout, int N, int C,
+                                  int sample_size, const T *x,
+                                  const ParamT *scale, const ParamT *bias,
+                                  double epsilon, double momentum, T *y,
+                                  ParamT *mean_out, ParamT *variance_out,
+                                  ParamT *saved_mean, ParamT *saved_inv_std);
+
+template <typename T, typename ParamT>
+void BatchNormReluForwardInference(const platform::CUDADeviceContext &ctx,
+                                   DataLayout layout, int N, int C,
+                                   int sample_size, const T *x,
+                                   const ParamT *scale, const ParamT *bias,
+                                   const ParamT *mean, const ParamT *variance,
+                                   double epsilon, T *y);
+
+template <typename T, typename ParamT>
+void BatchNormReluBackward(const platform::CUDADeviceContext &ctx,
+                           DataLayout layout, int N, int C, int sample_size,
+                           const T *x, const T *d_y, const ParamT *scale,
+                           const ParamT *bias, const ParamT *saved_mean,
+                           const ParamT *saved_inv_std, T *d_x,
+                           ParamT *d_scale, ParamT *d_bias);
+#endif
+
 }  // namespace operators
 }  // namespace paddle
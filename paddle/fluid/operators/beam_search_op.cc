@@ -13,7 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <algorithm>
-#include <map>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -30,46 +30,52 @@ void BeamSearch::operator()(const framework::LoDTensor &pre_ids,
                             framework::LoDTensor *selected_scores) {
   auto abs_lod = framework::ToAbsOffset(ids_->lod());
   auto &high_level = abs_lod[lod_level_];
+  const int num_sources = static_cast<int>(high_level.size()) - 1;
+  auto *pre_ids_data = pre_ids.data<int64_t>();
+  auto *pre_scores_data = pre_scores.data<float>();
 
-  auto items = SelectTopBeamSizeItems(pre_ids, pre_scores);
-  auto selected_items = ToMap(items, high_level.back());
-  VLOG(3) << "selected_items:";
-  for (size_t i = 0; i < selected_items.size(); ++i) {
-    VLOG(3) << "offset:" << i;
-    for (auto &item : selected_items[i]) {
-      VLOG(3) << ItemToString(item);
+  // The selected items of the source i are in
+  // [i * beam_size_, i * beam_size_ + num_items[i]) of items.
+  std::vector<Item> items(num_sources * beam_size_);
+  std::vector<size_t> num_items(num_sources);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < num_sources; ++i) {
+    Item *top_items = items.data() + i * beam_size_;
+    num_items[i] =
+        SelectTopBeamSizeItems(pre_ids_data, pre_scores_data, high_level[i],
+                               high_level[i + 1], top_items);
+    if (IsBeamEnded(pre_ids_data, top_items, num_items[i])) {
+      num_items[i] = 0;
     }
   }
 
-  PruneEndBeams(pre_ids, &selected_items);
   // calculate the output tensor's height
-  size_t num_instances = std::accumulate(
-      std::begin(selected_items), std::end(selected_items), 0,
-      [](size_t a, std::vector<Item> &b) { return a + b.size(); });
+  size_t num_instances =
+      std::accumulate(num_items.begin(), num_items.end(), size_t(0));
   // the output tensor shape should be [num_instances, 1]
   auto dims = framework::make_ddim(
-      std::vector<int64_t>({static_cast<int>(num_instances), 1}));
+      std::vector<int64_t>({static_cast<int64_t>(num_instances), 1}));
   selected_ids->Resize(dims);
   selected_scores->Resize(dims);
-
-  std::map<size_t /*offset*/, std::vector<Item>> hash;
-  framework::LoD new_lod;
   auto *ids_data = selected_ids->mutable_data<int64_t>(platform::CPUPlace());
   auto *scores_data =
       selected_scores->mutable_data<float>(platform::CPUPlace());
 
-  // fill in data
-  std::vector<size_t> low_level;
+  // fill in data, the items are already sorted by the offsets of prefixes
+  std::vector<size_t> low_level(high_level.back() + 1, 0);
   size_t low_offset = 0;
-  for (auto &items : selected_items) {
-    low_level.push_back(low_offset);
-    for (auto &item : items) {
-      ids_data[low_offset] = item.id;
-      scores_data[low_offset] = item.score;
+  for (int i = 0; i < num_sources; ++i) {
+    const Item *top_items = items.data() + i * beam_size_;
+    for (size_t j = 0; j < num_items[i]; ++j) {
+      ids_data[low_offset] = top_items[j].id;
+      scores_data[low_offset] = top_items[j].score;
+      low_level[top_items[j].offset + 1]++;
       low_offset++;
     }
   }
-  low_level.push_back(low_offset);
+  std::partial_sum(low_level.begin(), low_level.end(), low_level.begin());
 
   // fill lod
   framework::LoD lod(2);
@@ -82,116 +88,68 @@ void BeamSearch::operator()(const framework::LoDTensor &pre_ids,
   selected_scores->set_lod(lod);
 }
 
-void BeamSearch::PruneEndBeams(const framework::LoDTensor &pre_ids,
-                               std::vector<std::vector<Item>> *items) {
-  auto *pre_ids_data = pre_ids.data<int64_t>();
-  auto abs_lod = framework::ToAbsOffset(ids_->lod());
-  auto &high_level = abs_lod[lod_level_];
-  for (size_t src_idx = 0; src_idx < high_level.size() - 1; ++src_idx) {
-    size_t src_prefix_start = high_level[src_idx];
-    size_t src_prefix_end = high_level[src_idx + 1];
-    bool finish_flag = true;
-    for (size_t offset = src_prefix_start; offset < src_prefix_end; offset++) {
-      for (auto &item : items->at(offset)) {
-        if (item.id != static_cast<size_t>(end_id_) ||
-            pre_ids_data[offset] != end_id_) {
-          finish_flag = false;
-          break;
-        }
-      }
-      if (!finish_flag) break;
-    }
-    if (finish_flag) {  // all branchs of the beam (source sentence) end and
-                        // prune this beam
-      for (size_t offset = src_prefix_start; offset < src_prefix_end; offset++)
-        items->at(offset).clear();
-    }
-  }
-}
-
-std::vector<std::vector<BeamSearch::Item>> BeamSearch::ToMap(
-    const std::vector<std::vector<Item>> &items, size_t element_num) {
-  std::vector<std::vector<Item>> result;
-  result.resize(element_num);
-  for (auto &entries : items) {
-    for (const auto &item : entries) {
-      result[item.offset].push_back(item);
-    }
+size_t BeamSearch::SelectTopBeamSizeItems(const int64_t *pre_ids,
+                                          const float *pre_scores,
+                                          size_t prefix_start,
+                                          size_t prefix_end,
+                                          Item *top_items) const {
+  auto *ids_data = ids_->data<int64_t>();
+  auto *scores_data = scores_->data<float>();
+  size_t instance_dim = 1;
+  for (int i = 1; i < ids_->dims().size(); i++) {
+    instance_dim *= ids_->dims()[i];
   }
-  return result;
-}
 
-std::vector<std::vector<BeamSearch::Item>> BeamSearch::SelectTopBeamSizeItems(
-    const framework::LoDTensor &pre_ids,
-    const framework::LoDTensor &pre_scores) {
-  std::vector<std::vector<Item>> result;
-  std::vector<Item> items;
-  // for each source sentence, select the top beam_size items across all
-  // candidate sets.
-  while (NextItemSet(pre_ids, pre_scores, &items)) {
-    std::nth_element(
-        std::begin(items), std::begin(items) + beam_size_, std::end(items),
-        [](const Item &a, const Item &b) { return a.score > b.score; });
-    // prune the top beam_size items.
-    if (items.size() > beam_size_) {
-      items.resize(beam_size_);
-    }
-    result.emplace_back(items);
-  }
-  VLOG(3) << "SelectTopBeamSizeItems result size " << result.size();
-  for (auto &items : result) {
-    VLOG(3) << "item set:";
-    for (auto &item : items) {
-      VLOG(3) << ItemToString(item);
+  // top_items[0] is the item with the lowest score while it is a heap.
+  auto greater = [](const Item &a, const Item &b) { return a.score > b.score; };
+  size_t num_items = 0;
+  auto push = [&](size_t offset, id_t id, score_t score) {
+    if (num_items < beam_size_) {
+      top_items[num_items++] = Item(offset, id, score);
+      std::push_heap(top_items, top_items + num_items, greater);
+    } else if (beam_size_ > 0 && score > top_items[0].score) {
+      std::pop_heap(top_items, top_items + num_items, greater);
+      top_items[num_items - 1] = Item(offset, id, score);
+      std::push_heap(top_items, top_items + num_items, greater);
     }
-  }
-
-  return result;
-}
-
-// the candidates of a source
-bool BeamSearch::NextItemSet(const framework::LoDTensor &pre_ids,
-                             const framework::LoDTensor &pre_scores,
-                             std::vector<BeamSearch::Item> *items) {
-  if (sent_offset_ >= ids_->NumElements(lod_level_)) {
-    return false;
-  }
-  // find the current candidates
-  auto ids = *ids_;
-  auto scores = *scores_;
+  };
 
-  auto abs_lod = framework::ToAbsOffset(ids.lod());
-
-  auto *ids_data = ids.data<int64_t>();
-  auto *scores_data = scores.data<float>();
-
-  size_t instance_dim = 1;
-  for (int i = 1; i < ids.dims().size(); i++) {
-    instance_dim *= ids.dims()[i];
-  }
-
-  auto *pre_ids_data = pre_ids.data<int64_t>();
-  auto *pre_scores_data = pre_scores.data<float>();
-  items->clear();
-  items->reserve(framework::product(ids.dims()));
-  for (size_t offset = abs_lod[lod_level_][sent_offset_];
-       offset < abs_lod[lod_level_][sent_offset_ + 1]; offset++) {
-    auto pre_id = pre_ids_data[offset];
-    auto pre_score = pre_scores_data[offset];
-    if (pre_id == end_id_) {
+  // select the top beam_size items across all candidate sets of the source
+  for (size_t offset = prefix_start; offset < prefix_end; offset++) {
+    if (pre_ids[offset] == end_id_) {
       // Allocate all probability mass to eos_id for finished branchs and the
       // other candidate ids can be ignored.
-      items->emplace_back(offset, end_id_, pre_score);
+      push(offset, end_id_, pre_scores[offset]);
     } else {
+      const int64_t *ids = ids_data + offset * instance_dim;
+      const float *scores = scores_data + offset * instance_dim;
       for (size_t d = 0; d < instance_dim; d++) {
-        const size_t dim_offset = offset * instance_dim + d;
-        items->emplace_back(offset, ids_data[dim_offset],
-                            scores_data[dim_offset]);
+        push(offset, ids[d], scores[d]);
       }
     }
   }
 
-  sent_offset_++;
+  std::sort(top_items, top_items + num_items,
+            [](const Item &a, const Item &b) {
+              return a.offset < b.offset ||
+                     (a.offset == b.offset && a.score > b.score);
+            });
+  VLOG(3) << "SelectTopBeamSizeItems of prefixes [" << prefix_start << ", "
+          << prefix_end << "):";
+  for (size_t i = 0; i < num_items; ++i) {
+    VLOG(3) << ItemToString(top_items[i]);
+  }
+  return num_items;
+}
+
+bool BeamSearch::IsBeamEnded(const int64_t *pre_ids, const Item *items,
+                             size_t num_items) const {
+  for (size_t i = 0; i < num_items; ++i) {
+    if (items[i].id != static_cast<id_t>(end_id_) ||
+        pre_ids[items[i].offset] != end_id_) {
+      return false;
+    }
+  }
   return true;
 }
 
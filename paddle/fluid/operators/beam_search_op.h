@@ -154,40 +154,29 @@ class BeamSearch {
 
  protected:
   /*
-   * Prune the source sentences all branchs finished, and it is optional.
-   * Pruning must one step later than finishing (thus pre_ids is needed here),
-   * since the end tokens must be writed out.
+   * Select the top beam_size items among the candidates of the prefixes
+   * [prefix_start, prefix_end) of a source sentence by a min-heap of
+   * beam_size items, which are stored in top_items, and sort them by the
+   * offsets of their prefixes, then by the scores. Return the number of the
+   * selected items.
    */
-  void PruneEndBeams(const framework::LoDTensor& pre_ids,
-                     std::vector<std::vector<Item>>* items);
+  size_t SelectTopBeamSizeItems(const int64_t* pre_ids,
+                                const float* pre_scores, size_t prefix_start,
+                                size_t prefix_end, Item* top_items) const;
 
   /*
-   * Transform the items into a map whose key is offset, value is the items.
-   * NOTE low performance.
+   * Whether all branchs of the source sentence finished, then it should be
+   * pruned, and it is optional. Pruning must one step later than finishing
+   * (thus pre_ids is needed here), since the end tokens must be writed out.
    */
-  std::vector<std::vector<Item>> ToMap(
-      const std::vector<std::vector<Item>>& inputs, size_t element_num);
-
-  /*
-   * For each source, select top beam_size records.
-   */
-  std::vector<std::vector<Item>> SelectTopBeamSizeItems(
-      const framework::LoDTensor& pre_ids,
-      const framework::LoDTensor& pre_scores);
-
-  /*
-   * Get the items of next source sequence, return false if no remaining items.
-   */
-  bool NextItemSet(const framework::LoDTensor& pre_ids,
-                   const framework::LoDTensor& pre_scores,
-                   std::vector<Item>* items);
+  bool IsBeamEnded(const int64_t* pre_ids, const Item* items,
+                   size_t num_items) const;
 
  private:
   size_t beam_size_;
   const framework::LoDTensor* ids_;
   const framework::LoDTensor* scores_;
   size_t lod_level_{0};
-  size_t sent_offset_{0};
   int end_id_{0};
 };
 
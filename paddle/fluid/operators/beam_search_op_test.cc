@@ -87,5 +87,39 @@ TEST(beam_search_op, run) {
   }
 }
 
+TEST(beam_search_op, end_beams) {
+  CPUPlace place;
+  LoDTensor ids, scores;
+  CreateInput(&ids, &scores);
+
+  // the prefixes of the first source all ended, and the second prefix of the
+  // second source ended
+  vector<int64_t> _pre_ids({0, 0, 1, 0});
+  LoDTensor pre_ids;
+  pre_ids.Resize(framework::make_ddim(vector<int64_t>(4, 1)));
+  LoDTensor pre_scores;
+  pre_scores.Resize(framework::make_ddim(vector<int64_t>(4, 1)));
+  for (int i = 0; i < 4; i++) {
+    pre_ids.mutable_data<int64_t>(place)[i] = _pre_ids[i];
+    pre_scores.mutable_data<float>(place)[i] = 0.2 * (i + 1);
+  }
+
+  BeamSearch beamsearch(ids, scores, (size_t)0, (size_t)2, 0);
+  LoDTensor sids, sscores;
+  beamsearch(pre_ids, pre_scores, &sids, &sscores);
+
+  // the first source is pruned, and the ended prefix of the second source
+  // only has the end id with its previous score
+  LoD tlod({{0, 2, 4}, {0, 0, 0, 1, 2}});
+  ASSERT_EQ(sids.lod(), tlod);
+  ASSERT_EQ(sscores.lod(), tlod);
+  vector<int64_t> tids({3, 0});
+  vector<float> tscores({0.9, 0.8});
+  for (int i = 0; i < 2; i++) {
+    ASSERT_EQ(tids[i], sids.data<int64_t>()[i]);
+    ASSERT_FLOAT_EQ(tscores[i], sscores.data<float>()[i]);
+  }
+}
+
 }  // namespace test
 }  // namespace paddle
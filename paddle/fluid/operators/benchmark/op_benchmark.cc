@@ -0,0 +1,72 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+/*
+ * op_benchmark runs the kernels of an op on the inputs of a config, see
+ * op_tester_config.h, and reports the latencies, GFLOPS and bandwidth of
+ * each kernel. With a baseline file, it fails if a kernel is slower than
+ * the baseline by more than the threshold.
+ *
+ *   op_benchmark --op_config_file=mul.config --baseline_file=mul.baseline
+ *
+ * The configs of the ops worth tracking are in configs.
+ */
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <fstream>
+#include <iostream>
+
+#include "paddle/fluid/operators/benchmark/op_tester.h"
+#include "paddle/fluid/platform/init.h"
+#include "paddle/fluid/pybind/pybind.h"
+
+DEFINE_string(op_config_file, "", "The config file of the op to benchmark.");
+DEFINE_string(baseline_file, "",
+              "The p50 latencies of the kernels to compare with. It is "
+              "written if it does not exist or --update_baseline is set.");
+DEFINE_bool(update_baseline, false, "Overwrite the baseline file.");
+DEFINE_double(regression_threshold, 0.1,
+              "The ratio slower than the baseline to fail on, 0.1 for 10%.");
+
+int main(int argc, char** argv) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  if (FLAGS_op_config_file.empty()) {
+    LOG(ERROR) << "--op_config_file should be given.";
+    return 1;
+  }
+  paddle::framework::InitDevices(false);
+
+  namespace benchmark = paddle::operators::benchmark;
+  benchmark::OpTesterConfig config(FLAGS_op_config_file);
+  benchmark::OpTester tester(config);
+  auto results = tester.Run();
+  std::cout << benchmark::FormatResults(config.op_type, results);
+
+  if (FLAGS_baseline_file.empty()) return 0;
+  bool has_baseline = static_cast<bool>(std::ifstream(FLAGS_baseline_file));
+  if (FLAGS_update_baseline || !has_baseline) {
+    benchmark::WriteBaseline(FLAGS_baseline_file, results);
+    std::cout << "Write the baseline " << FLAGS_baseline_file << std::endl;
+    return 0;
+  }
+  auto regressions = benchmark::CheckRegressions(
+      results, benchmark::ReadBaseline(FLAGS_baseline_file),
+      FLAGS_regression_threshold);
+  for (auto& regression : regressions) {
+    std::cout << "Regression " << regression << std::endl;
+  }
+  return regressions.empty() ? 0 : 1;
+}
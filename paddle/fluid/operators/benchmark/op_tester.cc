@@ -0,0 +1,447 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/benchmark/op_tester.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <set>
+#include <sstream>
+
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/op_info.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace benchmark {
+
+using framework::LibraryType;
+using framework::LoDTensor;
+using framework::OpKernelType;
+
+static framework::proto::VarType::Type ToDataType(const std::string& dtype) {
+  if (dtype == "float32") return framework::proto::VarType::FP32;
+  if (dtype == "float64") return framework::proto::VarType::FP64;
+  if (dtype == "int32") return framework::proto::VarType::INT32;
+  if (dtype == "int64") return framework::proto::VarType::INT64;
+  PADDLE_THROW("The dtype %s is not supported, only float32, float64, int32 "
+               "and int64.",
+               dtype);
+}
+
+template <typename T>
+static void FillRandom(const OpInputConfig& input, std::mt19937* engine,
+                       LoDTensor* tensor, std::true_type) {
+  T* data = tensor->mutable_data<T>(platform::CPUPlace());
+  std::uniform_real_distribution<T> dist(input.low, input.high);
+  for (int64_t i = 0; i < tensor->numel(); ++i) data[i] = dist(*engine);
+}
+
+// The integers are in [ceil(low), ceil(high)), e.g. the ids of a lookup.
+template <typename T>
+static void FillRandom(const OpInputConfig& input, std::mt19937* engine,
+                       LoDTensor* tensor, std::false_type) {
+  T* data = tensor->mutable_data<T>(platform::CPUPlace());
+  T low = static_cast<T>(std::ceil(input.low));
+  T high = std::max(low, static_cast<T>(std::ceil(input.high) - 1));
+  std::uniform_int_distribution<T> dist(low, high);
+  for (int64_t i = 0; i < tensor->numel(); ++i) data[i] = dist(*engine);
+}
+
+static void FillRandom(const OpInputConfig& input, std::mt19937* engine,
+                       LoDTensor* tensor) {
+  switch (ToDataType(input.dtype)) {
+    case framework::proto::VarType::FP32:
+      return FillRandom<float>(input, engine, tensor, std::true_type());
+    case framework::proto::VarType::FP64:
+      return FillRandom<double>(input, engine, tensor, std::true_type());
+    case framework::proto::VarType::INT32:
+      return FillRandom<int>(input, engine, tensor, std::false_type());
+    default:
+      return FillRandom<int64_t>(input, engine, tensor, std::false_type());
+  }
+}
+
+static framework::Attribute ToAttribute(framework::proto::AttrType type,
+                                        const std::string& value) {
+  auto items = SplitString(value, ',');
+  auto to_bool = [](const std::string& str) {
+    return str == "true" || str == "True" || str == "1";
+  };
+  switch (type) {
+    case framework::proto::AttrType::INT:
+      return std::stoi(value);
+    case framework::proto::AttrType::FLOAT:
+      return std::stof(value);
+    case framework::proto::AttrType::STRING:
+      return value;
+    case framework::proto::AttrType::BOOLEAN:
+      return to_bool(value);
+    case framework::proto::AttrType::LONG:
+      return static_cast<int64_t>(std::stoll(value));
+    case framework::proto::AttrType::INTS: {
+      std::vector<int> ints;
+      for (auto& item : items) ints.push_back(std::stoi(item));
+      return ints;
+    }
+    case framework::proto::AttrType::FLOATS: {
+      std::vector<float> floats;
+      for (auto& item : items) floats.push_back(std::stof(item));
+      return floats;
+    }
+    case framework::proto::AttrType::STRINGS:
+      return items;
+    case framework::proto::AttrType::BOOLEANS: {
+      std::vector<bool> bools;
+      for (auto& item : items) bools.push_back(to_bool(item));
+      return bools;
+    }
+    case framework::proto::AttrType::LONGS: {
+      std::vector<int64_t> longs;
+      for (auto& item : items) longs.push_back(std::stoll(item));
+      return longs;
+    }
+    default:
+      PADDLE_THROW("The attr type %d is not supported.", type);
+  }
+}
+
+static std::string KernelName(const OpKernelType& kernel_type) {
+  std::ostringstream os;
+  os << kernel_type.place_ << "/"
+     << framework::LibraryTypeToString(kernel_type.library_type_);
+  return os.str();
+}
+
+static bool HasAttr(const framework::proto::OpProto& proto,
+                    const std::string& name) {
+  for (auto& attr : proto.attrs()) {
+    if (attr.name() == name) return true;
+  }
+  return false;
+}
+
+OpTester::OpTester(const OpTesterConfig& config) : config_(config) {
+  auto& info = framework::OpInfoMap::Instance();
+  PADDLE_ENFORCE(info.Has(config_.op_type), "The op %s is not registered.",
+                 config_.op_type);
+  PADDLE_ENFORCE(!config_.inputs.empty(), "The op %s should have inputs.",
+                 config_.op_type);
+  data_type_ = ToDataType(config_.inputs[0].dtype);
+
+  // The duplicable inputs are named by the indices.
+  std::map<std::string, int> num_inputs;
+  for (auto& input : config_.inputs) ++num_inputs[input.name];
+  std::map<std::string, int> indices;
+  std::mt19937 engine(0);
+  for (auto& input : config_.inputs) {
+    std::string var_name = input.name;
+    if (num_inputs[input.name] > 1) {
+      var_name += "_" + std::to_string(indices[input.name]++);
+    }
+    inputs_[input.name].push_back(var_name);
+
+    LoDTensor& tensor = input_tensors_[var_name];
+    tensor.Resize(framework::make_ddim(input.dims));
+    if (!input.lod.empty()) {
+      tensor.set_lod({input.lod});
+    }
+    FillRandom(input, &engine, &tensor);
+    input_bytes_ += tensor.memory_size();
+  }
+
+  for (auto& output : info.Get(config_.op_type).Proto().outputs()) {
+    std::string var_name = output.name();
+    if (input_tensors_.count(var_name)) var_name += "@OUT";
+    outputs_[output.name()].push_back(var_name);
+  }
+}
+
+std::vector<OpKernelType> OpTester::GetKernelTypes() const {
+  std::vector<OpKernelType> kernel_types;
+  auto& all_kernels = framework::OperatorWithKernel::AllOpKernels();
+  auto it = all_kernels.find(config_.op_type);
+  if (it == all_kernels.end()) return kernel_types;
+
+  auto& proto = framework::OpInfoMap::Instance().Get(config_.op_type).Proto();
+  std::set<std::string> names;
+  for (auto& kernel : it->second) {
+    auto& kernel_type = kernel.first;
+    if (kernel_type.data_type_ != data_type_) continue;
+    bool is_gpu = platform::is_gpu_place(kernel_type.place_);
+    if (!platform::is_cpu_place(kernel_type.place_) && !is_gpu) continue;
+    if ((is_gpu && config_.device == "cpu") ||
+        (!is_gpu && config_.device == "gpu")) {
+      continue;
+    }
+#ifndef PADDLE_WITH_CUDA
+    if (is_gpu) continue;
+#endif
+    // The kernel is chosen by the attributes.
+    if (kernel_type.library_type_ == LibraryType::kMKLDNN &&
+        !HasAttr(proto, "use_mkldnn")) {
+      continue;
+    }
+    if (kernel_type.library_type_ == LibraryType::kCUDNN &&
+        !HasAttr(proto, "use_cudnn")) {
+      continue;
+    }
+    if (names.insert(KernelName(kernel_type)).second) {
+      kernel_types.push_back(kernel_type);
+    }
+  }
+  // The plain CPU kernel first, which is the reference of the others.
+  std::sort(kernel_types.begin(), kernel_types.end(),
+            [](const OpKernelType& a, const OpKernelType& b) {
+              bool a_gpu = platform::is_gpu_place(a.place_);
+              bool b_gpu = platform::is_gpu_place(b.place_);
+              if (a_gpu != b_gpu) return b_gpu;
+              return a.library_type_ < b.library_type_;
+            });
+  return kernel_types;
+}
+
+void OpTester::CreateVariables(const platform::Place& place,
+                               framework::Scope* scope) {
+  for (auto& name_tensor : input_tensors_) {
+    auto* tensor = scope->Var(name_tensor.first)->GetMutable<LoDTensor>();
+    framework::TensorCopySync(name_tensor.second, place, tensor);
+    tensor->set_lod(name_tensor.second.lod());
+  }
+  for (auto& name_vars : outputs_) {
+    for (auto& var_name : name_vars.second) {
+      scope->Var(var_name)->GetMutable<LoDTensor>();
+    }
+  }
+}
+
+template <typename T>
+static double MaxDiff(const LoDTensor& a, const LoDTensor& b) {
+  const T* x = a.data<T>();
+  const T* y = b.data<T>();
+  double max_diff = 0.;
+  for (int64_t i = 0; i < a.numel(); ++i) {
+    double diff = static_cast<double>(x[i]) - static_cast<double>(y[i]);
+    max_diff = std::max(max_diff, std::fabs(diff));
+  }
+  return max_diff;
+}
+
+OpKernelResult OpTester::RunKernel(const OpKernelType& kernel_type) {
+  auto& proto = framework::OpInfoMap::Instance().Get(config_.op_type).Proto();
+  framework::AttributeMap attrs;
+  for (auto& attr_proto : proto.attrs()) {
+    for (auto& attr : config_.attrs) {
+      if (attr.first == attr_proto.name()) {
+        attrs[attr.first] = ToAttribute(attr_proto.type(), attr.second);
+      }
+    }
+  }
+  if (HasAttr(proto, "use_mkldnn")) {
+    attrs["use_mkldnn"] = kernel_type.library_type_ == LibraryType::kMKLDNN;
+  }
+  if (HasAttr(proto, "use_cudnn")) {
+    attrs["use_cudnn"] = kernel_type.library_type_ == LibraryType::kCUDNN;
+  }
+  for (auto& attr : config_.attrs) {
+    PADDLE_ENFORCE(HasAttr(proto, attr.first), "The op %s has no attr %s.",
+                   config_.op_type, attr.first);
+  }
+
+  platform::Place place = kernel_type.place_;
+  framework::Scope scope;
+  CreateVariables(place, &scope);
+  auto op = framework::OpRegistry::CreateOp(config_.op_type, inputs_,
+                                            outputs_, attrs);
+  auto* dev_ctx = platform::DeviceContextPool::Instance().Get(place);
+
+  for (int i = 0; i < config_.warmup; ++i) {
+    op->Run(scope, place);
+  }
+  dev_ctx->Wait();
+  std::vector<double> latencies;
+  for (int i = 0; i < config_.repeat; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    op->Run(scope, place);
+    dev_ctx->Wait();
+    auto end = std::chrono::steady_clock::now();
+    latencies.push_back(
+        std::chrono::duration<double, std::micro>(end - start).count());
+  }
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&latencies](double q) {
+    size_t i = static_cast<size_t>(q * latencies.size());
+    return latencies[std::min(i, latencies.size() - 1)];
+  };
+
+  OpKernelResult result;
+  result.kernel = KernelName(kernel_type);
+  double total = 0.;
+  for (double latency : latencies) total += latency;
+  result.mean_us = total / latencies.size();
+  result.min_us = latencies.front();
+  result.p50_us = percentile(0.5);
+  result.p90_us = percentile(0.9);
+  result.p99_us = percentile(0.99);
+
+  // Compare the outputs with the ones of the first kernel.
+  size_t output_bytes = 0;
+  bool is_reference = reference_outputs_.empty();
+  result.max_diff = is_reference ? 0. : -1.;
+  for (auto& name_vars : outputs_) {
+    for (auto& var_name : name_vars.second) {
+      auto& tensor = scope.FindVar(var_name)->Get<LoDTensor>();
+      if (!tensor.IsInitialized()) continue;
+      output_bytes += tensor.memory_size();
+      LoDTensor cpu_tensor;
+      framework::TensorCopySync(tensor, platform::CPUPlace(), &cpu_tensor);
+      if (is_reference) {
+        reference_outputs_[var_name] = cpu_tensor;
+        continue;
+      }
+      auto it = reference_outputs_.find(var_name);
+      if (it == reference_outputs_.end() ||
+          it->second.numel() != cpu_tensor.numel() ||
+          it->second.type() != cpu_tensor.type()) {
+        continue;
+      }
+      double diff = -1.;
+      if (cpu_tensor.type() == typeid(float)) {
+        diff = MaxDiff<float>(it->second, cpu_tensor);
+      } else if (cpu_tensor.type() == typeid(double)) {
+        diff = MaxDiff<double>(it->second, cpu_tensor);
+      }
+      result.max_diff = std::max(result.max_diff, diff);
+    }
+  }
+
+  double flops = EstimateFlops(*op, scope);
+  result.gflops = flops / (result.p50_us * 1e3);
+  result.gbps = (input_bytes_ + output_bytes) / (result.p50_us * 1e3);
+  return result;
+}
+
+double OpTester::EstimateFlops(const framework::OperatorBase& op,
+                               const framework::Scope& scope) const {
+  if (config_.flops > 0.) return config_.flops;
+  auto dims_of = [&scope](const std::string& var_name) {
+    return scope.FindVar(var_name)->Get<LoDTensor>().dims();
+  };
+  if (config_.op_type == "mul") {
+    auto x_dims = framework::flatten_to_2d(dims_of(op.Input("X")),
+                                           op.Attr<int>("x_num_col_dims"));
+    auto y_dims = framework::flatten_to_2d(dims_of(op.Input("Y")),
+                                           op.Attr<int>("y_num_col_dims"));
+    return 2. * x_dims[0] * x_dims[1] * y_dims[1];
+  }
+  if (config_.op_type == "conv2d" || config_.op_type == "depthwise_conv2d") {
+    // Each output is a dot of C / groups * KH * KW.
+    auto filter_dims = dims_of(op.Input("Filter"));
+    double numel = framework::product(dims_of(op.Output("Output")));
+    return 2. * numel * filter_dims[1] * filter_dims[2] * filter_dims[3];
+  }
+  return 0.;
+}
+
+std::vector<OpKernelResult> OpTester::Run() {
+  auto kernel_types = GetKernelTypes();
+  PADDLE_ENFORCE(!kernel_types.empty(),
+                 "The op %s has no kernel of %s on the device %s.",
+                 config_.op_type, framework::DataTypeToString(data_type_),
+                 config_.device);
+  std::vector<OpKernelResult> results;
+  for (auto& kernel_type : kernel_types) {
+    VLOG(3) << "Benchmark " << config_.op_type << " " << kernel_type;
+    results.push_back(RunKernel(kernel_type));
+  }
+  return results;
+}
+
+std::string FormatResults(const std::string& op_type,
+                          const std::vector<OpKernelResult>& results) {
+  std::ostringstream os;
+  os << "Op: " << op_type << "\n";
+  os << std::left << std::setw(24) << "Kernel" << std::right << std::setw(12)
+     << "Mean(us)" << std::setw(12) << "Min(us)" << std::setw(12)
+     << "P50(us)" << std::setw(12) << "P90(us)" << std::setw(12) << "P99(us)"
+     << std::setw(10) << "GFLOPS" << std::setw(10) << "GB/s" << std::setw(12)
+     << "MaxDiff" << "\n";
+  os << std::fixed << std::setprecision(3);
+  for (auto& result : results) {
+    os << std::left << std::setw(24) << result.kernel << std::right
+       << std::setw(12) << result.mean_us << std::setw(12) << result.min_us
+       << std::setw(12) << result.p50_us << std::setw(12) << result.p90_us
+       << std::setw(12) << result.p99_us << std::setw(10) << result.gflops
+       << std::setw(10) << result.gbps << std::setw(12);
+    if (result.max_diff < 0.) {
+      os << "-";
+    } else {
+      os << std::scientific << std::setprecision(2) << result.max_diff
+         << std::fixed << std::setprecision(3);
+    }
+    os << "\n";
+  }
+  return os.str();
+}
+
+void WriteBaseline(const std::string& path,
+                   const std::vector<OpKernelResult>& results) {
+  std::ofstream fout(path);
+  PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open the baseline file %s.",
+                 path);
+  for (auto& result : results) {
+    fout << result.kernel << " " << result.p50_us << "\n";
+  }
+}
+
+std::map<std::string, double> ReadBaseline(const std::string& path) {
+  std::ifstream fin(path);
+  PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open the baseline file %s.",
+                 path);
+  std::map<std::string, double> baseline;
+  std::string kernel;
+  double p50_us;
+  while (fin >> kernel >> p50_us) {
+    baseline[kernel] = p50_us;
+  }
+  return baseline;
+}
+
+std::vector<std::string> CheckRegressions(
+    const std::vector<OpKernelResult>& results,
+    const std::map<std::string, double>& baseline, double threshold) {
+  std::vector<std::string> regressions;
+  for (auto& result : results) {
+    auto it = baseline.find(result.kernel);
+    if (it == baseline.end()) continue;
+    if (result.p50_us > it->second * (1. + threshold)) {
+      std::ostringstream os;
+      os << result.kernel << ": p50 " << result.p50_us << " us, the baseline "
+         << it->second << " us";
+      regressions.push_back(os.str());
+    }
+  }
+  return regressions;
+}
+
+}  // namespace benchmark
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,101 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_kernel_type.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/operators/benchmark/op_tester_config.h"
+
+namespace paddle {
+namespace operators {
+namespace benchmark {
+
+struct OpKernelResult {
+  // The place and the library of the kernel, like CPUPlace/MKLDNN.
+  std::string kernel;
+  double mean_us;
+  double min_us;
+  double p50_us;
+  double p90_us;
+  double p99_us;
+  // 0 if the flops of the op are unknown.
+  double gflops;
+  // The bandwidth of reading the inputs and writing the outputs once.
+  double gbps;
+  // The max absolute difference of the outputs from the first kernel, or -1
+  // if they are not compared.
+  double max_diff;
+};
+
+/*
+ * OpTester builds the op of the config by OpRegistry::CreateOp, and runs it
+ * with each of the registered kernels of the data type of the inputs, i.e.
+ * the plain, MKLDNN, CUDA and cuDNN ones, on the same random inputs.
+ */
+class OpTester {
+ public:
+  explicit OpTester(const OpTesterConfig& config);
+
+  std::vector<OpKernelResult> Run();
+
+ private:
+  // The kernels to benchmark, one per place and library.
+  std::vector<framework::OpKernelType> GetKernelTypes() const;
+
+  OpKernelResult RunKernel(const framework::OpKernelType& kernel_type);
+
+  // Create the input and the output variables on the place.
+  void CreateVariables(const platform::Place& place, framework::Scope* scope);
+
+  double EstimateFlops(const framework::OperatorBase& op,
+                       const framework::Scope& scope) const;
+
+  OpTesterConfig config_;
+  framework::proto::VarType::Type data_type_;
+  framework::VariableNameMap inputs_;
+  framework::VariableNameMap outputs_;
+  // The inputs on CPU, which are copied to the place of each kernel.
+  std::map<std::string, framework::LoDTensor> input_tensors_;
+  size_t input_bytes_ = 0;
+  // The outputs of the first kernel, on CPU.
+  std::map<std::string, framework::LoDTensor> reference_outputs_;
+};
+
+// The report of the results, one line per kernel.
+std::string FormatResults(const std::string& op_type,
+                          const std::vector<OpKernelResult>& results);
+
+// The baseline file has a line of the kernel and its p50 latency in
+// microseconds for each kernel.
+void WriteBaseline(const std::string& path,
+                   const std::vector<OpKernelResult>& results);
+
+std::map<std::string, double> ReadBaseline(const std::string& path);
+
+// The messages of the kernels whose p50 latencies are slower than the
+// baseline by more than the threshold, e.g. 0.1 for 10%.
+std::vector<std::string> CheckRegressions(
+    const std::vector<OpKernelResult>& results,
+    const std::map<std::string, double>& baseline, double threshold);
+
+}  // namespace benchmark
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,161 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/benchmark/op_tester_config.h"
+
+#include <fstream>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace benchmark {
+
+static std::string Trim(const std::string& str) {
+  const char* kSpaces = " \t\r\n";
+  size_t begin = str.find_first_not_of(kSpaces);
+  if (begin == std::string::npos) return "";
+  size_t end = str.find_last_not_of(kSpaces);
+  return str.substr(begin, end - begin + 1);
+}
+
+std::vector<std::string> SplitString(const std::string& str, char delim) {
+  std::vector<std::string> items;
+  size_t begin = 0;
+  while (begin <= str.size()) {
+    size_t end = str.find(delim, begin);
+    if (end == std::string::npos) end = str.size();
+    std::string item = Trim(str.substr(begin, end - begin));
+    if (!item.empty()) items.push_back(item);
+    begin = end + 1;
+  }
+  return items;
+}
+
+std::vector<int64_t> ParseDims(const std::string& str) {
+  std::vector<int64_t> dims;
+  for (auto& item : SplitString(str, 'x')) {
+    dims.push_back(std::stoll(item));
+  }
+  PADDLE_ENFORCE(!dims.empty(), "The dims %s are invalid.", str);
+  return dims;
+}
+
+OpTesterConfig::OpTesterConfig(const std::string& path) {
+  std::ifstream fin(path);
+  PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open the config file %s.",
+                 path);
+  Init(fin);
+}
+
+void OpTesterConfig::Init(std::istream& is) {
+  // The block being parsed, input, attr or empty for the top level.
+  std::string block;
+  std::pair<std::string, std::string> attr;
+  std::string line;
+  int line_no = 0;
+  while (std::getline(is, line)) {
+    ++line_no;
+    line = Trim(line.substr(0, line.find('#')));
+    if (line.empty()) continue;
+
+    if (line.back() == '{') {
+      PADDLE_ENFORCE(block.empty(), "Line %d: the blocks cannot be nested.",
+                     line_no);
+      block = Trim(line.substr(0, line.size() - 1));
+      if (block == "input") {
+        inputs.emplace_back();
+      } else if (block == "attr") {
+        attr = std::make_pair(std::string(), std::string());
+      } else {
+        PADDLE_THROW("Line %d: unknown block %s.", line_no, block);
+      }
+      continue;
+    }
+    if (line == "}") {
+      PADDLE_ENFORCE(!block.empty(), "Line %d: unexpected }.", line_no);
+      if (block == "input") {
+        PADDLE_ENFORCE(!inputs.back().name.empty() &&
+                           !inputs.back().dims.empty(),
+                       "Line %d: the input should have the name and dims.",
+                       line_no);
+      } else {
+        PADDLE_ENFORCE(!attr.first.empty(),
+                       "Line %d: the attr should have the name.", line_no);
+        attrs.push_back(attr);
+      }
+      block.clear();
+      continue;
+    }
+
+    size_t colon = line.find(':');
+    PADDLE_ENFORCE(colon != std::string::npos,
+                   "Line %d: expect key: value, but got %s.", line_no, line);
+    std::string key = Trim(line.substr(0, colon));
+    std::string value = Trim(line.substr(colon + 1));
+    if (block == "input") {
+      auto& input = inputs.back();
+      if (key == "name") {
+        input.name = value;
+      } else if (key == "dims") {
+        input.dims = ParseDims(value);
+      } else if (key == "dtype") {
+        input.dtype = value;
+      } else if (key == "lod") {
+        for (auto& item : SplitString(value, ',')) {
+          input.lod.push_back(std::stoul(item));
+        }
+      } else if (key == "range") {
+        auto range = SplitString(value, ',');
+        PADDLE_ENFORCE_EQ(range.size(), 2UL,
+                          "Line %d: the range should be low, high.", line_no);
+        input.low = std::stod(range[0]);
+        input.high = std::stod(range[1]);
+      } else {
+        PADDLE_THROW("Line %d: unknown key %s of the input.", line_no, key);
+      }
+    } else if (block == "attr") {
+      if (key == "name") {
+        attr.first = value;
+      } else if (key == "value") {
+        attr.second = value;
+      } else {
+        PADDLE_THROW("Line %d: unknown key %s of the attr.", line_no, key);
+      }
+    } else if (key == "op_type") {
+      op_type = value;
+    } else if (key == "device") {
+      PADDLE_ENFORCE(value == "cpu" || value == "gpu" || value == "all",
+                     "Line %d: the device should be cpu, gpu or all.",
+                     line_no);
+      device = value;
+    } else if (key == "warmup") {
+      warmup = std::stoi(value);
+    } else if (key == "repeat") {
+      repeat = std::stoi(value);
+    } else if (key == "flops") {
+      flops = std::stod(value);
+    } else {
+      PADDLE_THROW("Line %d: unknown key %s.", line_no, key);
+    }
+  }
+  PADDLE_ENFORCE(block.empty(), "The block %s is not closed.", block);
+  PADDLE_ENFORCE(!op_type.empty(), "The op_type should be given.");
+  PADDLE_ENFORCE_GT(repeat, 0, "The repeat should be > 0.");
+  PADDLE_ENFORCE_GE(warmup, 0, "The warmup should be >= 0.");
+}
+
+}  // namespace benchmark
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,89 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace paddle {
+namespace operators {
+namespace benchmark {
+
+/*
+ * The config of an op benchmark, in a text format like:
+ *
+ *   # a comment
+ *   op_type: mul
+ *   device: cpu
+ *   repeat: 100
+ *   input {
+ *     name: X
+ *     dims: 32x784
+ *     dtype: float32
+ *   }
+ *   input {
+ *     name: Y
+ *     dims: 784x64
+ *   }
+ *   attr {
+ *     name: x_num_col_dims
+ *     value: 1
+ *   }
+ *
+ * The inputs are filled with the uniform random values in [low, high) of
+ * the range field. A duplicable input is given by the input blocks of the
+ * same name.
+ */
+struct OpInputConfig {
+  std::string name;
+  std::vector<int64_t> dims;
+  std::string dtype = "float32";
+  // The offsets of the 1-level LoD, empty for a tensor without LoD.
+  std::vector<size_t> lod;
+  double low = -1.;
+  double high = 1.;
+};
+
+struct OpTesterConfig {
+  OpTesterConfig() = default;
+  explicit OpTesterConfig(const std::string& path);
+
+  // Parse the config, the fields not given keep the defaults.
+  void Init(std::istream& is);
+
+  std::string op_type;
+  // cpu, gpu or all, the kernels of the devices to benchmark.
+  std::string device = "all";
+  int warmup = 10;
+  int repeat = 100;
+  // The floating point operations of a run, see also EstimateFlops.
+  double flops = 0.;
+  std::vector<OpInputConfig> inputs;
+  // The attributes as the strings, which are converted by the types of
+  // the attributes in the OpProto.
+  std::vector<std::pair<std::string, std::string>> attrs;
+};
+
+// Parse the dims like 32x784.
+std::vector<int64_t> ParseDims(const std::string& str);
+
+// Split the str by the delim, the empty items are dropped.
+std::vector<std::string> SplitString(const std::string& str, char delim);
+
+}  // namespace benchmark
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,122 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/benchmark/op_tester.h"
+
+#include <sstream>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+USE_OP(mul);
+USE_OP(scale);
+
+namespace paddle {
+namespace operators {
+namespace benchmark {
+
+TEST(OpTesterConfig, Init) {
+  std::istringstream is(R"CONFIG(
+# the fc of mnist
+op_type: mul
+device: cpu
+repeat: 5
+input {
+  name: X
+  dims: 32x784
+  lod: 0,10,32
+}
+input {
+  name: Y
+  dims: 784x64
+  range: 0, 2
+}
+attr {
+  name: x_num_col_dims
+  value: 1
+}
+)CONFIG");
+  OpTesterConfig config;
+  config.Init(is);
+  EXPECT_EQ(config.op_type, "mul");
+  EXPECT_EQ(config.device, "cpu");
+  EXPECT_EQ(config.warmup, 10);
+  EXPECT_EQ(config.repeat, 5);
+  ASSERT_EQ(config.inputs.size(), 2UL);
+  EXPECT_EQ(config.inputs[0].dims, std::vector<int64_t>({32, 784}));
+  EXPECT_EQ(config.inputs[0].lod, std::vector<size_t>({0, 10, 32}));
+  EXPECT_EQ(config.inputs[1].dtype, "float32");
+  EXPECT_EQ(config.inputs[1].low, 0.);
+  EXPECT_EQ(config.inputs[1].high, 2.);
+  ASSERT_EQ(config.attrs.size(), 1UL);
+  EXPECT_EQ(config.attrs[0].first, "x_num_col_dims");
+  EXPECT_EQ(config.attrs[0].second, "1");
+
+  std::istringstream unclosed("op_type: mul\ninput {\n  name: X\n");
+  EXPECT_THROW(OpTesterConfig().Init(unclosed), platform::EnforceNotMet);
+  std::istringstream unknown("op_type: mul\nbatch: 1\n");
+  EXPECT_THROW(OpTesterConfig().Init(unknown), platform::EnforceNotMet);
+}
+
+TEST(OpTester, Mul) {
+  OpTesterConfig config;
+  config.op_type = "mul";
+  config.device = "cpu";
+  config.warmup = 1;
+  config.repeat = 3;
+  config.inputs.resize(2);
+  config.inputs[0].name = "X";
+  config.inputs[0].dims = {16, 32};
+  config.inputs[1].name = "Y";
+  config.inputs[1].dims = {32, 8};
+
+  OpTester tester(config);
+  auto results = tester.Run();
+  ASSERT_GE(results.size(), 1UL);
+  EXPECT_EQ(results[0].kernel, "CPUPlace/PLAIN");
+  EXPECT_EQ(results[0].max_diff, 0.);
+  EXPECT_LE(results[0].min_us, results[0].p50_us);
+  EXPECT_LE(results[0].p50_us, results[0].p99_us);
+  EXPECT_GT(results[0].gflops, 0.);
+  EXPECT_GT(results[0].gbps, 0.);
+}
+
+TEST(OpTester, Baseline) {
+  OpTesterConfig config;
+  config.op_type = "scale";
+  config.device = "cpu";
+  config.repeat = 3;
+  config.inputs.resize(1);
+  config.inputs[0].name = "X";
+  config.inputs[0].dims = {64, 64};
+  config.attrs.emplace_back("scale", "2.0");
+
+  auto results = OpTester(config).Run();
+  ASSERT_GE(results.size(), 1UL);
+  EXPECT_EQ(results[0].gflops, 0.);
+
+  WriteBaseline("op_tester_test.baseline", results);
+  auto baseline = ReadBaseline("op_tester_test.baseline");
+  ASSERT_EQ(baseline.count(results[0].kernel), 1UL);
+  EXPECT_TRUE(CheckRegressions(results, baseline, 0.1).empty());
+
+  baseline[results[0].kernel] = results[0].p50_us / 2;
+  auto regressions = CheckRegressions(results, baseline, 0.1);
+  ASSERT_EQ(regressions.size(), 1UL);
+  EXPECT_NE(regressions[0].find(results[0].kernel), std::string::npos);
+}
+
+}  // namespace benchmark
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,113 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/operator.h"
+
+namespace paddle {
+namespace operators {
+
+static framework::LoDTensor* FindInitializedTensor(
+    const framework::Scope& scope, const std::string& name) {
+  auto* var = scope.FindVar(name);
+  if (var == nullptr || !var->IsType<framework::LoDTensor>()) return nullptr;
+  auto* tensor = var->GetMutable<framework::LoDTensor>();
+  return tensor->IsInitialized() ? tensor : nullptr;
+}
+
+class BindConcatSlicesOp : public framework::OperatorBase {
+ public:
+  BindConcatSlicesOp(const std::string& type,
+                     const framework::VariableNameMap& inputs,
+                     const framework::VariableNameMap& outputs,
+                     const framework::AttributeMap& attrs)
+      : OperatorBase(type, inputs, outputs, attrs) {}
+
+  void RunImpl(const framework::Scope& scope,
+               const platform::Place& place) const override {
+    auto& input_names = Attr<std::vector<std::string>>("input_names");
+    int axis = Attr<int>("axis");
+    auto* out = FindInitializedTensor(scope, Attr<std::string>("output_name"));
+    // Nothing to bind before the first run.
+    if (out == nullptr) return;
+    auto out_dims = out->dims();
+    // The slices on the axis are consecutive when the dims before it are 1.
+    for (int i = 0; i < axis; ++i) {
+      if (out_dims[i] != 1) return;
+    }
+
+    std::vector<framework::LoDTensor*> ins;
+    int64_t numel = 0;
+    for (auto& name : input_names) {
+      auto* in = FindInitializedTensor(scope, name);
+      if (in == nullptr || in->type() != out->type() ||
+          !(in->place() == out->place())) {
+        return;
+      }
+      ins.push_back(in);
+      numel += in->numel();
+    }
+    // The shapes of the last run do not match.
+    if (numel != out->numel()) return;
+
+    framework::Tensor flat;
+    flat.ShareDataWith(*out);
+    flat.Resize({out->numel()});
+    int64_t offset = 0;
+    for (auto* in : ins) {
+      if (in->numel() == 0) continue;
+      auto dims = in->dims();
+      in->ShareDataWith(flat.Slice(offset, offset + in->numel()));
+      in->Resize(dims);
+      offset += in->numel();
+    }
+  }
+};
+
+class BindConcatSlicesOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddAttr<std::vector<std::string>>("input_names",
+                                      "The inputs of the concat.");
+    AddAttr<std::string>("output_name", "The output of the concat.");
+    AddAttr<int>("axis", "The axis of the concat.").SetDefault(0);
+    AddComment(R"DOC(
+BindConcatSlices Operator.
+
+Binds the inputs of a concat to the consecutive slices of its output of the
+last run, so that the producers of the inputs write the output in place and
+the concat copies nothing. It does nothing when the shapes of the last run do
+not match or the slices are not consecutive, then the concat copies the inputs.
+
+It is inserted by the virtual_concat_pass, and should not be configured by
+users directly.
+)DOC");
+  }
+};
+
+class BindConcatSlicesOpShapeInference : public framework::InferShapeBase {
+ public:
+  void operator()(framework::InferShapeContext* ctx) const override {}
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+REGISTER_OPERATOR(bind_concat_slices, paddle::operators::BindConcatSlicesOp,
+                  paddle::framework::EmptyGradOpMaker,
+                  paddle::operators::BindConcatSlicesOpMaker,
+                  paddle::operators::BindConcatSlicesOpShapeInference);
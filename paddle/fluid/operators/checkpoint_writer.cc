@@ -0,0 +1,109 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/checkpoint_writer.h"
+#include <stdio.h>
+#include <fstream>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+
+AsyncCheckpointWriter& AsyncCheckpointWriter::Instance() {
+  static AsyncCheckpointWriter writer;
+  return writer;
+}
+
+AsyncCheckpointWriter::~AsyncCheckpointWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  if (!error_.empty()) {
+    LOG(ERROR) << "Failed to write the checkpoint: " << error_;
+  }
+}
+
+void AsyncCheckpointWriter::Submit(const std::string& filename, WriteFn fn) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.emplace_back(filename, std::move(fn));
+    if (!thread_.joinable()) {
+      thread_ = std::thread([this] { Loop(); });
+    }
+  }
+  cv_.notify_all();
+}
+
+void AsyncCheckpointWriter::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this] { return tasks_.empty() && !running_; });
+  if (!error_.empty()) {
+    std::string error;
+    error.swap(error_);
+    PADDLE_THROW("Failed to write the checkpoint: %s", error);
+  }
+}
+
+void AsyncCheckpointWriter::Loop() {
+  while (true) {
+    std::pair<std::string, WriteFn> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return !tasks_.empty() || stop_; });
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+      running_ = true;
+    }
+
+    std::string error;
+    try {
+      const std::string& filename = task.first;
+      std::string tmp_filename = filename + ".tmp";
+      {
+        std::ofstream fout(tmp_filename, std::ios::binary);
+        PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open %s to write",
+                       tmp_filename);
+        task.second(&fout);
+        fout.close();
+        PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot write %s",
+                       tmp_filename);
+      }
+      PADDLE_ENFORCE_EQ(rename(tmp_filename.c_str(), filename.c_str()), 0,
+                        "Cannot rename %s to %s", tmp_filename, filename);
+      VLOG(4) << "Async checkpoint written to " << filename;
+    } catch (std::exception& e) {
+      error = e.what();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      running_ = false;
+      if (!error.empty() && error_.empty()) {
+        error_ = error;
+      }
+    }
+    done_cv_.notify_all();
+  }
+}
+
+}  // namespace operators
+}  // namespace paddle
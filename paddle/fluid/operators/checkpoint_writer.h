@@ -0,0 +1,69 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <ostream>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+
+namespace paddle {
+namespace operators {
+
+// AsyncCheckpointWriter writes the snapshots of the variables taken by the
+// save ops to the files on a background thread, in the order they are
+// submitted, so that the training goes on while the files are flushed. Each
+// file is written to a temporary file first and renamed when it is
+// complete, so an unfinished checkpoint never replaces a good file.
+class AsyncCheckpointWriter {
+ public:
+  using WriteFn = std::function<void(std::ostream* os)>;
+
+  static AsyncCheckpointWriter& Instance();
+
+  // Run the pending writes before exiting.
+  ~AsyncCheckpointWriter();
+
+  // Write the file by fn on the background thread. fn should only use the
+  // data it owns, e.g. a snapshot of the variable.
+  void Submit(const std::string& filename, WriteFn fn);
+
+  // Wait for all the submitted writes, and throw the error of the first
+  // failed one since the last Wait.
+  void Wait();
+
+ private:
+  AsyncCheckpointWriter() = default;
+
+  void Loop();
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable done_cv_;
+  std::deque<std::pair<std::string, WriteFn>> tasks_;
+  // Whether a task is being written.
+  bool running_{false};
+  bool stop_{false};
+  std::string error_;
+  std::thread thread_;
+};
+
+}  // namespace operators
+}  // namespace paddle
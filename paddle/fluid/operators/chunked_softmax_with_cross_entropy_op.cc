@@ -0,0 +1,195 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+
+#include "paddle/fluid/operators/chunked_softmax_with_cross_entropy_op.h"
+#include <memory>
+
+namespace paddle {
+namespace operators {
+
+class ChunkedSoftmaxWithCrossEntropyOpMaker
+    : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Logits",
+             "(Tensor, default: Tensor<float>), The unscaled log probabilities "
+             "which is a 2-D tensor with shape [N x K]. N is the batch_size, "
+             "and K is the class number.");
+    AddInput("Label",
+             "(Tensor) The ground truth which is a 2-D tensor. If soft_label "
+             "is set to false, Label is a Tensor<int64> with shape [N x 1] of "
+             "the class ids. If soft_label is set to true, Label is a "
+             "Tensor<float/double> with shape [N x K].");
+    AddOutput("Loss",
+              "(Tensor, default: Tensor<float>), A 2-D tensor. The cross "
+              "entropy loss with shape [N x 1].");
+    AddOutput("LogSumExp",
+              "(Tensor, default: Tensor<float>), A 2-D tensor with shape "
+              "[N x 1], the log of the sum of the exp of each row of the "
+              "logits, which is used to compute the softmax again in the "
+              "backward.")
+        .AsIntermediate();
+    AddAttr<bool>(
+        "soft_label",
+        "(bool, default: false), A flag to indicate whether to interpretate "
+        "the given labels as soft labels.")
+        .SetDefault(false);
+    AddAttr<int>(
+        "ignore_index",
+        "(int, default -100), Specifies a target value that is ignored and "
+        "does not contribute to the loss and the input gradient. Only valid "
+        "if soft_label is set to False")
+        .SetDefault(-100);
+    AddAttr<int>("chunk_size",
+                 "(int, default 4096), The number of classes reduced in a "
+                 "chunk. The CUDA kernel reduces the chunks of a row in "
+                 "parallel blocks, so the rows of a large class number are "
+                 "split over the device.")
+        .SetDefault(4096)
+        .GreaterThan(0);
+    AddComment(R"DOC(
+Chunked Softmax With Cross Entropy Operator.
+
+It computes the same loss as softmax_with_cross_entropy without the softmax
+output of shape [N x K], which is too large to keep for the class numbers
+of hundreds of thousands. The log-sum-exp of each row is computed online
+over the chunks of chunk_size classes:
+
+$$m = \max(m, \max_{i \in chunk}\text{Logit}_i), \quad
+s = s \cdot \exp(m_{old} - m) + \sum_{i \in chunk}\exp(\text{Logit}_i - m)$$
+
+and only $LogSumExp = m + \log(s)$ is kept for the backward, which computes
+the softmax again:
+
+$$\frac{\partial Loss}{\partial \text{Logit}_i} =
+\exp(\text{Logit}_i - LogSumExp) - \text{Label}_i$$
+
+The soft labels of a row should sum to one.
+
+)DOC");
+  }
+};
+
+class ChunkedSoftmaxWithCrossEntropyOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("Logits"),
+                   "Input(Logits) should be not null.");
+    PADDLE_ENFORCE(ctx->HasInput("Label"), "Input(Label) should be not null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Loss"), "Output(Loss) should be not null.");
+    PADDLE_ENFORCE(ctx->HasOutput("LogSumExp"),
+                   "Output(LogSumExp) should be not null.");
+
+    auto logits_dims = ctx->GetInputDim("Logits");
+    auto labels_dims = ctx->GetInputDim("Label");
+    PADDLE_ENFORCE_EQ(logits_dims.size(), 2UL,
+                      "The input of chunked_softmax_with_cross_entropy should "
+                      "be a 2-D tensor.");
+    PADDLE_ENFORCE_EQ(labels_dims.size(), 2UL,
+                      "The labels should be a 2-D tensor.");
+
+    if (ctx->Attrs().Get<bool>("soft_label")) {
+      PADDLE_ENFORCE_EQ(logits_dims[1], labels_dims[1],
+                        "If Attr(soft_label) == true, the 2nd dimension of "
+                        "Input(X) and Input(Label) should be equal.");
+    } else {
+      PADDLE_ENFORCE_EQ(labels_dims[1], 1UL,
+                        "If Attr(soft_label) == false, the 2nd dimension of "
+                        "Input(Label) should be 1.");
+    }
+
+    ctx->SetOutputDim("Loss", {logits_dims[0], 1});
+    ctx->SetOutputDim("LogSumExp", {logits_dims[0], 1});
+    ctx->ShareLoD("Logits", /*->*/ "Loss");
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        framework::ToDataType(ctx.Input<Tensor>("Logits")->type()),
+        ctx.device_context());
+  }
+};
+
+class ChunkedSoftmaxWithCrossEntropyOpGrad
+    : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput(framework::GradVarName("Loss")),
+                   "Input(Loss@Grad) should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("Logits"),
+                   "Input(Logits) should be not null.");
+    PADDLE_ENFORCE(ctx->HasInput("LogSumExp"),
+                   "Input(LogSumExp) should be not null.");
+    PADDLE_ENFORCE(ctx->HasInput("Label"), "Input(Label) should be not null.");
+    PADDLE_ENFORCE(ctx->HasOutput(framework::GradVarName("Logits")),
+                   "Output(Logits@Grad) should be not null.");
+
+    ctx->SetOutputDim(framework::GradVarName("Logits"),
+                      ctx->GetInputDim("Logits"));
+    ctx->ShareLoD("Logits", framework::GradVarName("Logits"));
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        framework::ToDataType(
+            ctx.Input<Tensor>(framework::GradVarName("Loss"))->type()),
+        ctx.device_context());
+  }
+};
+
+class ChunkedSoftmaxWithCrossEntropyGradMaker
+    : public framework::SingleGradOpDescMaker {
+ public:
+  using framework::SingleGradOpDescMaker::SingleGradOpDescMaker;
+
+ protected:
+  std::unique_ptr<framework::OpDesc> Apply() const override {
+    auto* grad_op = new framework::OpDesc();
+    grad_op->SetType("chunked_softmax_with_cross_entropy_grad");
+    grad_op->SetInput("Logits", Input("Logits"));
+    grad_op->SetInput("Label", Input("Label"));
+    grad_op->SetInput("LogSumExp", Output("LogSumExp"));
+    grad_op->SetInput(framework::GradVarName("Loss"), OutputGrad("Loss"));
+    grad_op->SetOutput(framework::GradVarName("Logits"), InputGrad("Logits"));
+    grad_op->SetAttrMap(Attrs());
+    return std::unique_ptr<framework::OpDesc>(grad_op);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+
+REGISTER_OPERATOR(chunked_softmax_with_cross_entropy,
+                  ops::ChunkedSoftmaxWithCrossEntropyOp,
+                  ops::ChunkedSoftmaxWithCrossEntropyOpMaker,
+                  ops::ChunkedSoftmaxWithCrossEntropyGradMaker);
+REGISTER_OPERATOR(chunked_softmax_with_cross_entropy_grad,
+                  ops::ChunkedSoftmaxWithCrossEntropyOpGrad);
+REGISTER_OP_CPU_KERNEL(chunked_softmax_with_cross_entropy,
+                       ops::ChunkedSoftmaxWithCrossEntropyKernel<float>,
+                       ops::ChunkedSoftmaxWithCrossEntropyKernel<double>);
+REGISTER_OP_CPU_KERNEL(chunked_softmax_with_cross_entropy_grad,
+                       ops::ChunkedSoftmaxWithCrossEntropyGradKernel<float>,
+                       ops::ChunkedSoftmaxWithCrossEntropyGradKernel<double>);
@@ -0,0 +1,217 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+
+#include <cub/cub.cuh>
+#include <limits>
+#include "paddle/fluid/operators/chunked_softmax_with_cross_entropy_op.h"
+
+namespace paddle {
+namespace operators {
+
+static __device__ __forceinline__ float real_exp(float x) { return expf(x); }
+static __device__ __forceinline__ double real_exp(double x) { return exp(x); }
+static __device__ __forceinline__ float real_log(float x) { return logf(x); }
+static __device__ __forceinline__ double real_log(double x) { return log(x); }
+
+// The reduction of a chunk of a row: the max of the logits, the sum of
+// their exp shifted by the max and, for the soft labels, the sums of
+// Label * Logits and of Label.
+template <typename T>
+struct LogSumExpPartial {
+  T max;
+  T sum;
+  T label_dot;
+  T label_sum;
+};
+
+template <typename T>
+struct MergeLogSumExp {
+  __device__ __forceinline__ LogSumExpPartial<T> operator()(
+      const LogSumExpPartial<T>& a, const LogSumExpPartial<T>& b) const {
+    LogSumExpPartial<T> out;
+    out.max = a.max > b.max ? a.max : b.max;
+    out.sum = a.sum * real_exp(a.max - out.max) +
+              b.sum * real_exp(b.max - out.max);
+    out.label_dot = a.label_dot + b.label_dot;
+    out.label_sum = a.label_sum + b.label_sum;
+    return out;
+  }
+};
+
+// A block reduces the chunk blockIdx.y of the row blockIdx.x, each thread
+// keeps the max and the sum of its elements online.
+template <typename T, int BlockDim>
+__global__ void ChunkLogSumExp(const T* logits, const T* soft_labels,
+                               int64_t class_num, int64_t chunk_size,
+                               LogSumExpPartial<T>* partials) {
+  typedef cub::BlockReduce<LogSumExpPartial<T>, BlockDim> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+
+  int64_t row = blockIdx.x;
+  int64_t begin = blockIdx.y * chunk_size;
+  int64_t end =
+      begin + chunk_size < class_num ? begin + chunk_size : class_num;
+  const T* x = logits + row * class_num;
+
+  LogSumExpPartial<T> partial = {std::numeric_limits<T>::lowest(), 0, 0, 0};
+  for (int64_t j = begin + threadIdx.x; j < end; j += BlockDim) {
+    T value = x[j];
+    if (value > partial.max) {
+      partial.sum *= real_exp(partial.max - value);
+      partial.max = value;
+    }
+    partial.sum += real_exp(value - partial.max);
+    if (soft_labels != nullptr) {
+      T y = soft_labels[row * class_num + j];
+      partial.label_dot += y * value;
+      partial.label_sum += y;
+    }
+  }
+  partial = BlockReduce(temp_storage).Reduce(partial, MergeLogSumExp<T>());
+  if (threadIdx.x == 0) partials[row * gridDim.y + blockIdx.y] = partial;
+}
+
+// A thread merges the chunks of a row into its LogSumExp and loss.
+template <typename T>
+__global__ void MergeChunkLogSumExp(const LogSumExpPartial<T>* partials,
+                                    const T* logits, const int64_t* labels,
+                                    int64_t batch_size, int64_t class_num,
+                                    int num_chunks, int ignore_index,
+                                    T* log_sum_exp, T* loss) {
+  MergeLogSumExp<T> merge;
+  for (int64_t row = blockIdx.x * blockDim.x + threadIdx.x; row < batch_size;
+       row += blockDim.x * gridDim.x) {
+    LogSumExpPartial<T> partial = partials[row * num_chunks];
+    for (int c = 1; c < num_chunks; ++c) {
+      partial = merge(partial, partials[row * num_chunks + c]);
+    }
+    T lse = partial.max + real_log(partial.sum);
+    log_sum_exp[row] = lse;
+    if (labels == nullptr) {
+      loss[row] = lse * partial.label_sum - partial.label_dot;
+    } else {
+      int64_t label = labels[row];
+      loss[row] = label == ignore_index
+                      ? static_cast<T>(0)
+                      : lse - logits[row * class_num + label];
+    }
+  }
+}
+
+template <typename T>
+__global__ void ChunkedSoftmaxWithCrossEntropyGrad(
+    const T* logits, const int64_t* labels, const T* soft_labels,
+    const T* log_sum_exp, const T* loss_grad, int64_t batch_size,
+    int64_t class_num, int ignore_index, T* logits_grad) {
+  int64_t num = batch_size * class_num;
+  for (int64_t idx = blockIdx.x * blockDim.x + threadIdx.x; idx < num;
+       idx += blockDim.x * gridDim.x) {
+    int64_t row = idx / class_num;
+    T softmax = real_exp(logits[idx] - log_sum_exp[row]);
+    if (soft_labels != nullptr) {
+      logits_grad[idx] = loss_grad[row] * (softmax - soft_labels[idx]);
+    } else if (labels[row] == ignore_index) {
+      logits_grad[idx] = 0;
+    } else {
+      T label = idx - row * class_num == labels[row] ? 1 : 0;
+      logits_grad[idx] = loss_grad[row] * (softmax - label);
+    }
+  }
+}
+
+template <typename T>
+class ChunkedSoftmaxWithCrossEntropyCUDAKernel
+    : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    PADDLE_ENFORCE(platform::is_gpu_place(context.GetPlace()),
+                   "This kernel only runs on GPU device.");
+    const Tensor* logits = context.Input<Tensor>("Logits");
+    const Tensor* labels = context.Input<Tensor>("Label");
+    Tensor* loss = context.Output<Tensor>("Loss");
+    Tensor* log_sum_exp = context.Output<Tensor>("LogSumExp");
+
+    const int64_t batch_size = logits->dims()[0];
+    const int64_t class_num = logits->dims()[1];
+    const int64_t chunk_size = context.Attr<int>("chunk_size");
+    const bool soft_label = context.Attr<bool>("soft_label");
+    const int num_chunks = (class_num + chunk_size - 1) / chunk_size;
+
+    auto* loss_data = loss->mutable_data<T>(context.GetPlace());
+    auto* lse_data = log_sum_exp->mutable_data<T>(context.GetPlace());
+    if (batch_size == 0) return;
+
+    // 4 values of T per chunk.
+    Tensor partials;
+    auto* partials_data =
+        reinterpret_cast<LogSumExpPartial<T>*>(partials.mutable_data<T>(
+            {batch_size * num_chunks * 4}, context.GetPlace()));
+
+    constexpr int kBlockDim = 256;
+    auto stream = context.cuda_device_context().stream();
+    ChunkLogSumExp<T, kBlockDim><<<dim3(batch_size, num_chunks), kBlockDim,
+                                   0, stream>>>(
+        logits->data<T>(), soft_label ? labels->data<T>() : nullptr,
+        class_num, chunk_size, partials_data);
+    int grid = (batch_size + kBlockDim - 1) / kBlockDim;
+    MergeChunkLogSumExp<T><<<grid, kBlockDim, 0, stream>>>(
+        partials_data, logits->data<T>(),
+        soft_label ? nullptr : labels->data<int64_t>(), batch_size, class_num,
+        num_chunks, context.Attr<int>("ignore_index"), lse_data, loss_data);
+  }
+};
+
+template <typename T>
+class ChunkedSoftmaxWithCrossEntropyGradCUDAKernel
+    : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    const Tensor* logits = context.Input<Tensor>("Logits");
+    const Tensor* labels = context.Input<Tensor>("Label");
+    const Tensor* log_sum_exp = context.Input<Tensor>("LogSumExp");
+    const Tensor* loss_grad =
+        context.Input<Tensor>(framework::GradVarName("Loss"));
+    Tensor* logits_grad =
+        context.Output<Tensor>(framework::GradVarName("Logits"));
+
+    const int64_t batch_size = logits->dims()[0];
+    const int64_t class_num = logits->dims()[1];
+    const bool soft_label = context.Attr<bool>("soft_label");
+    auto* grad_data = logits_grad->mutable_data<T>(context.GetPlace());
+    int64_t num = batch_size * class_num;
+    if (num == 0) return;
+
+    const int block = 512;
+    int grid = std::min<int64_t>((num + block - 1) / block, 65536);
+    ChunkedSoftmaxWithCrossEntropyGrad<
+        T><<<grid, block, 0, context.cuda_device_context().stream()>>>(
+        logits->data<T>(), soft_label ? nullptr : labels->data<int64_t>(),
+        soft_label ? labels->data<T>() : nullptr, log_sum_exp->data<T>(),
+        loss_grad->data<T>(), batch_size, class_num,
+        context.Attr<int>("ignore_index"), grad_data);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(chunked_softmax_with_cross_entropy,
+                        ops::ChunkedSoftmaxWithCrossEntropyCUDAKernel<float>,
+                        ops::ChunkedSoftmaxWithCrossEntropyCUDAKernel<double>);
+REGISTER_OP_CUDA_KERNEL(
+    chunked_softmax_with_cross_entropy_grad,
+    ops::ChunkedSoftmaxWithCrossEntropyGradCUDAKernel<float>,
+    ops::ChunkedSoftmaxWithCrossEntropyGradCUDAKernel<double>);
@@ -0,0 +1,169 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/platform/for_range.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+// Check the hard labels before the rows are computed in parallel.
+inline void CheckHardLabels(const Tensor& labels, int64_t class_num,
+                            int ignore_index) {
+  const int64_t* label_data = labels.data<int64_t>();
+  for (int64_t i = 0; i < labels.numel(); ++i) {
+    PADDLE_ENFORCE(label_data[i] == ignore_index ||
+                       (label_data[i] >= 0 && label_data[i] < class_num),
+                   "The label %d of the row %d is out of [0, %d).",
+                   label_data[i], i, class_num);
+  }
+}
+
+/*
+ * The log-sum-exp of a row computed online over chunks of chunk_size
+ * classes: the sum of the exp is rescaled to the max of a chunk when it is
+ * larger than the max so far, so the row is read once without storing
+ * the softmax.
+ */
+template <typename T>
+T RowLogSumExp(const T* x, int64_t class_num, int64_t chunk_size) {
+  T max = std::numeric_limits<T>::lowest();
+  T sum = 0;
+  for (int64_t begin = 0; begin < class_num; begin += chunk_size) {
+    int64_t end = std::min(begin + chunk_size, class_num);
+    T chunk_max = *std::max_element(x + begin, x + end);
+    if (chunk_max > max) {
+      sum *= std::exp(max - chunk_max);
+      max = chunk_max;
+    }
+    for (int64_t j = begin; j < end; ++j) {
+      sum += std::exp(x[j] - max);
+    }
+  }
+  return max + std::log(sum);
+}
+
+template <typename T>
+class ChunkedSoftmaxWithCrossEntropyKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    PADDLE_ENFORCE(platform::is_cpu_place(context.GetPlace()),
+                   "This kernel only runs on CPU.");
+    const Tensor* logits = context.Input<Tensor>("Logits");
+    const Tensor* labels = context.Input<Tensor>("Label");
+    Tensor* loss = context.Output<Tensor>("Loss");
+    Tensor* log_sum_exp = context.Output<Tensor>("LogSumExp");
+
+    const int64_t batch_size = logits->dims()[0];
+    const int64_t class_num = logits->dims()[1];
+    const int64_t chunk_size = context.Attr<int>("chunk_size");
+    const bool soft_label = context.Attr<bool>("soft_label");
+    const int ignore_index = context.Attr<int>("ignore_index");
+    if (!soft_label) CheckHardLabels(*labels, class_num, ignore_index);
+
+    const T* logits_data = logits->data<T>();
+    T* loss_data = loss->mutable_data<T>(context.GetPlace());
+    T* lse_data = log_sum_exp->mutable_data<T>(context.GetPlace());
+    auto& dev_ctx =
+        context.template device_context<platform::CPUDeviceContext>();
+    platform::ParallelFor(
+        dev_ctx, batch_size,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            const T* x = logits_data + i * class_num;
+            T lse = RowLogSumExp(x, class_num, chunk_size);
+            lse_data[i] = lse;
+            if (soft_label) {
+              const T* y = labels->data<T>() + i * class_num;
+              T row_loss = 0;
+              for (int64_t j = 0; j < class_num; ++j) {
+                row_loss += y[j] * (lse - x[j]);
+              }
+              loss_data[i] = row_loss;
+            } else {
+              int64_t label = labels->data<int64_t>()[i];
+              loss_data[i] = label == ignore_index ? 0 : lse - x[label];
+            }
+          }
+        },
+        class_num);
+  }
+};
+
+// Logits@GRAD = Loss@GRAD * (exp(Logits - LogSumExp) - Label), the softmax
+// is computed again from the LogSumExp of the forward. The rows of the
+// ignored labels get no gradient.
+template <typename T>
+class ChunkedSoftmaxWithCrossEntropyGradKernel
+    : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    const Tensor* logits = context.Input<Tensor>("Logits");
+    const Tensor* labels = context.Input<Tensor>("Label");
+    const Tensor* log_sum_exp = context.Input<Tensor>("LogSumExp");
+    const Tensor* loss_grad =
+        context.Input<Tensor>(framework::GradVarName("Loss"));
+    Tensor* logits_grad =
+        context.Output<Tensor>(framework::GradVarName("Logits"));
+
+    const int64_t batch_size = logits->dims()[0];
+    const int64_t class_num = logits->dims()[1];
+    const bool soft_label = context.Attr<bool>("soft_label");
+    const int ignore_index = context.Attr<int>("ignore_index");
+
+    const T* logits_data = logits->data<T>();
+    const T* lse_data = log_sum_exp->data<T>();
+    const T* loss_grad_data = loss_grad->data<T>();
+    T* grad_data = logits_grad->mutable_data<T>(context.GetPlace());
+    auto& dev_ctx =
+        context.template device_context<platform::CPUDeviceContext>();
+    platform::ParallelFor(
+        dev_ctx, batch_size,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            const T* x = logits_data + i * class_num;
+            T* dx = grad_data + i * class_num;
+            T lse = lse_data[i];
+            T dloss = loss_grad_data[i];
+            if (soft_label) {
+              const T* y = labels->data<T>() + i * class_num;
+              for (int64_t j = 0; j < class_num; ++j) {
+                dx[j] = dloss * (std::exp(x[j] - lse) - y[j]);
+              }
+              continue;
+            }
+            int64_t label = labels->data<int64_t>()[i];
+            if (label == ignore_index) {
+              std::fill(dx, dx + class_num, static_cast<T>(0));
+              continue;
+            }
+            for (int64_t j = 0; j < class_num; ++j) {
+              dx[j] = dloss * std::exp(x[j] - lse);
+            }
+            dx[label] -= dloss;
+          }
+        },
+        class_num);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
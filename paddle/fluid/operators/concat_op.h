@@ -23,6 +23,39 @@ limitations under the License. */
 namespace paddle {
 namespace operators {
 
+/*
+ * Whether the inputs are the consecutive slices of the output, bound by the
+ * bind_concat_slices op of the virtual_concat_pass, so that their producers
+ * have written the output in place. Otherwise the output is reallocated if
+ * some inputs are in its memory, so that the copies never overlap.
+ */
+template <typename T>
+bool IsConcatInPlace(const std::vector<const framework::Tensor*>& ins,
+                     int64_t axis, const platform::Place& place,
+                     framework::Tensor* out) {
+  const T* out_begin = out->data<T>();
+  const T* out_end = out_begin + out->numel();
+  bool in_place = true;
+  for (int64_t i = 0; i < axis; ++i) {
+    if (out->dims()[i] != 1) in_place = false;
+  }
+  bool overlap = false;
+  int64_t offset = 0;
+  for (auto* in : ins) {
+    const T* in_begin = in->data<T>();
+    const T* in_end = in_begin + in->numel();
+    if (in_begin != out_begin + offset) in_place = false;
+    if (in_begin < out_end && out_begin < in_end) overlap = true;
+    offset += in->numel();
+  }
+  if (in_place) return true;
+  if (overlap) {
+    out->clear();
+    out->mutable_data<T>(place);
+  }
+  return false;
+}
+
 template <typename DeviceContext, typename T>
 class ConcatKernel : public framework::OpKernel<T> {
  public:
@@ -32,9 +65,11 @@ class ConcatKernel : public framework::OpKernel<T> {
     int64_t axis = static_cast<int64_t>(ctx.Attr<int>("axis"));
     auto place = ctx.GetPlace();
     out->mutable_data<T>(place);
+    if (IsConcatInPlace<T>(ins, axis, place, out)) return;
 
     // Sometimes direct copies will be faster, this maybe need deeply analysis.
-    if (axis == 0 && ins.size() < 10) {
+    // On GPU the ConcatFunctor copies all the inputs in one launch.
+    if (axis == 0 && ins.size() < 10 && platform::is_cpu_place(place)) {
       size_t output_offset = 0;
       for (auto* in : ins) {
         auto in_stride = framework::stride_numel(in->dims());
@@ -92,7 +127,9 @@ class ConcatGradKernel : public framework::OpKernel<T> {
     auto& dev_ctx = ctx.template device_context<DeviceContext>();
 
     // Sometimes direct copies will be faster, this maybe need deeply analysis.
-    if (axis == 0 && outs.size() < 10) {
+    // On GPU the SplitFunctor copies all the outputs in one launch.
+    auto place = ctx.GetPlace();
+    if (axis == 0 && outs.size() < 10 && platform::is_cpu_place(place)) {
       std::vector<const framework::Tensor*> ref_shape;
       ref_shape.insert(ref_shape.begin(), ins.begin(), ins.end());
       StridedMemcpyWithAxis0<T>(dev_ctx, *out_grad, ref_shape, &outputs);
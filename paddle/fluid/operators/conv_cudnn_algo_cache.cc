@@ -0,0 +1,123 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/conv_cudnn_algo_cache.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <fstream>
+#include <sstream>
+
+#include "glog/logging.h"
+#include "paddle/fluid/platform/enforce.h"
+
+DEFINE_bool(cudnn_exhaustive_search, false,
+            "Whether to find the fastest algorithm of the cudnn convolutions "
+            "by running all of them once for each shape, rather than by the "
+            "heuristics. It is ignored if cudnn_deterministic is true.");
+DEFINE_string(cudnn_algo_cache_file, "",
+              "The file to keep the algorithms found by the exhaustive "
+              "search of the cudnn convolutions in across processes.");
+
+namespace paddle {
+namespace operators {
+
+static void AppendDims(const char* name, const std::vector<int>& dims,
+                       std::ostream* os) {
+  *os << "," << name << "=";
+  for (size_t i = 0; i < dims.size(); ++i) {
+    *os << (i == 0 ? "" : "x") << dims[i];
+  }
+}
+
+std::string ConvAlgoKey::ToString() const {
+  std::ostringstream os;
+  os << kind << ",device=" << device << ",cudnn=" << cudnn_version
+     << ",dtype=" << dtype << ",layout=" << layout;
+  AppendDims("input", input_dims, &os);
+  AppendDims("filter", filter_dims, &os);
+  AppendDims("output", output_dims, &os);
+  AppendDims("strides", strides, &os);
+  AppendDims("paddings", paddings, &os);
+  AppendDims("dilations", dilations, &os);
+  os << ",groups=" << groups;
+  std::string key = os.str();
+  for (auto& c : key) {
+    if (isspace(c)) c = '_';
+  }
+  return key;
+}
+
+ConvAlgoCache& ConvAlgoCache::Instance() {
+  static ConvAlgoCache cache(FLAGS_cudnn_algo_cache_file);
+  return cache;
+}
+
+ConvAlgoCache::ConvAlgoCache(const std::string& path) : path_(path) {
+  if (!path_.empty()) Load();
+}
+
+void ConvAlgoCache::Load() {
+  std::ifstream in(path_);
+  if (!in.is_open()) return;
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream is(line);
+    std::string key;
+    ConvAlgoCacheEntry entry;
+    // a line may be cut by a writer killed in the middle
+    if (is >> key >> entry.algo >> entry.workspace_bytes) {
+      entries_[key] = entry;
+    }
+  }
+  VLOG(3) << "load " << entries_.size() << " cudnn algorithms from " << path_;
+}
+
+bool ConvAlgoCache::Find(const std::string& key, size_t workspace_limit,
+                         ConvAlgoCacheEntry* entry) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end() || it->second.workspace_bytes > workspace_limit) {
+    return false;
+  }
+  *entry = it->second;
+  return true;
+}
+
+void ConvAlgoCache::Insert(const std::string& key,
+                           const ConvAlgoCacheEntry& entry) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_[key] = entry;
+  if (path_.empty()) return;
+  std::ostringstream line;
+  line << key << " " << entry.algo << " " << entry.workspace_bytes << "\n";
+  // One write of the whole line in the append mode, so the lines of the
+  // processes sharing the file are not interleaved.
+  FILE* file = fopen(path_.c_str(), "a");
+  if (file == nullptr) {
+    LOG(WARNING) << "can not append the cudnn algorithm to " << path_;
+    return;
+  }
+  std::string data = line.str();
+  fwrite(data.data(), 1, data.size(), file);
+  fclose(file);
+}
+
+size_t ConvAlgoCache::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+}  // namespace operators
+}  // namespace paddle
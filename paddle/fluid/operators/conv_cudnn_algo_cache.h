@@ -0,0 +1,101 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <gflags/gflags.h>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+DECLARE_bool(cudnn_exhaustive_search);
+DECLARE_string(cudnn_algo_cache_file);
+
+namespace paddle {
+namespace operators {
+
+// What the algorithm of a convolution depends on, the algorithms found on
+// another GPU model or cuDNN version are searched again.
+struct ConvAlgoKey {
+  // "fwd", "bwd_data" or "bwd_filter"
+  std::string kind;
+  // the GPU model, e.g. "Tesla V100-SXM2-16GB"
+  std::string device;
+  int cudnn_version;
+  std::string dtype;
+  std::string layout;
+  std::vector<int> input_dims;
+  std::vector<int> filter_dims;
+  std::vector<int> output_dims;
+  std::vector<int> strides;
+  std::vector<int> paddings;
+  std::vector<int> dilations;
+  int groups;
+
+  // A string without whitespaces, to be a word of the cache file.
+  std::string ToString() const;
+};
+
+struct ConvAlgoCacheEntry {
+  int algo;
+  size_t workspace_bytes;
+};
+
+// The cache of the convolution algorithms found by the exhaustive search of
+// cuDNN, which is slow and repeated for every new shape otherwise.
+//
+// With a path, the cache loads the file at first and appends every new
+// algorithm to it, so the processes sharing the file reuse the algorithms
+// of each other. Each line of the file is "key algo workspace_bytes", the
+// last line of a key wins.
+class ConvAlgoCache {
+ public:
+  // The cache of FLAGS_cudnn_algo_cache_file.
+  static ConvAlgoCache& Instance();
+
+  explicit ConvAlgoCache(const std::string& path = "");
+
+  // Only the algorithms fitting in the workspace limit are found, since the
+  // limit may be smaller than the one of the search.
+  bool Find(const std::string& key, size_t workspace_limit,
+            ConvAlgoCacheEntry* entry);
+
+  void Insert(const std::string& key, const ConvAlgoCacheEntry& entry);
+
+  // Return the cached algorithm of the key, or the one returned by search,
+  // which is cached then.
+  template <typename AlgoT, typename SearchFunc>
+  AlgoT GetOrSearch(const std::string& key, size_t workspace_limit,
+                    SearchFunc search) {
+    ConvAlgoCacheEntry entry;
+    if (!Find(key, workspace_limit, &entry)) {
+      entry = search();
+      Insert(key, entry);
+    }
+    return static_cast<AlgoT>(entry.algo);
+  }
+
+  size_t size();
+
+ private:
+  void Load();
+
+  std::mutex mutex_;
+  std::string path_;
+  std::unordered_map<std::string, ConvAlgoCacheEntry> entries_;
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,98 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/conv_cudnn_algo_cache.h"
+
+#include <stdio.h>
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+
+static ConvAlgoKey MakeKey() {
+  ConvAlgoKey key;
+  key.kind = "fwd";
+  key.device = "Tesla V100";
+  key.cudnn_version = 7102;
+  key.dtype = "float32";
+  key.layout = "NCHW";
+  key.input_dims = {8, 3, 224, 224};
+  key.filter_dims = {64, 3, 7, 7};
+  key.output_dims = {8, 64, 112, 112};
+  key.strides = {2, 2};
+  key.paddings = {3, 3};
+  key.dilations = {1, 1};
+  key.groups = 1;
+  return key;
+}
+
+TEST(ConvAlgoCache, Key) {
+  auto key = MakeKey();
+  EXPECT_EQ(key.ToString(),
+            "fwd,device=Tesla_V100,cudnn=7102,dtype=float32,layout=NCHW,"
+            "input=8x3x224x224,filter=64x3x7x7,output=8x64x112x112,"
+            "strides=2x2,paddings=3x3,dilations=1x1,groups=1");
+  auto other = MakeKey();
+  other.input_dims[0] = 16;
+  EXPECT_NE(key.ToString(), other.ToString());
+}
+
+TEST(ConvAlgoCache, WorkspaceLimit) {
+  ConvAlgoCache cache;
+  cache.Insert("k", {1, 1024});
+  ConvAlgoCacheEntry entry;
+  EXPECT_TRUE(cache.Find("k", 1024, &entry));
+  EXPECT_EQ(entry.algo, 1);
+  EXPECT_FALSE(cache.Find("k", 1023, &entry));
+  EXPECT_FALSE(cache.Find("other", 1024, &entry));
+
+  int searches = 0;
+  auto search = [&searches]() {
+    ++searches;
+    return ConvAlgoCacheEntry{2, 512};
+  };
+  // searched again under the smaller limit
+  EXPECT_EQ(cache.GetOrSearch<int>("k", 1000, search), 2);
+  EXPECT_EQ(cache.GetOrSearch<int>("k", 1000, search), 2);
+  EXPECT_EQ(searches, 1);
+}
+
+TEST(ConvAlgoCache, SharedFile) {
+  std::string path = "conv_cudnn_algo_cache_test.txt";
+  std::remove(path.c_str());
+  std::string key = MakeKey().ToString();
+  {
+    ConvAlgoCache writer(path);
+    writer.Insert(key, {3, 2048});
+    writer.Insert("other", {0, 0});
+  }
+  {
+    // a line cut by a killed writer is skipped
+    std::ofstream out(path, std::ios::app);
+    out << "cut 1";
+  }
+  ConvAlgoCache reader(path);
+  EXPECT_EQ(reader.size(), 2UL);
+  ConvAlgoCacheEntry entry;
+  ASSERT_TRUE(reader.Find(key, 4096, &entry));
+  EXPECT_EQ(entry.algo, 3);
+  EXPECT_EQ(entry.workspace_bytes, 2048UL);
+  std::remove(path.c_str());
+}
+
+}  // namespace operators
+}  // namespace paddle
@@ -12,9 +12,14 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/memory/memory.h"
+#include "paddle/fluid/operators/conv_cudnn_algo_cache.h"
 #include "paddle/fluid/operators/conv_op.h"
 #include "paddle/fluid/platform/assert.h"
 #include "paddle/fluid/platform/cudnn_helper.h"
@@ -38,6 +43,86 @@ using ScalingParamType = typename platform::CudnnDataType<T>::ScalingParamType;
 
 static constexpr size_t kCONV_CUDNN_WORKSPACE_LIMIT_BYTES =
     static_cast<size_t>(1024) * 1024 * 1024;
+// More than the algorithms of any kind of convolution.
+static constexpr int kMaxConvAlgos = 16;
+
+static bool UseExhaustiveSearch() {
+  return FLAGS_cudnn_exhaustive_search && !FLAGS_cudnn_deterministic;
+}
+
+static std::string GPUModel(int device) {
+  static std::mutex mutex;
+  static std::unordered_map<int, std::string> models;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = models.find(device);
+  if (it == models.end()) {
+    cudaDeviceProp prop;
+    PADDLE_ENFORCE(cudaGetDeviceProperties(&prop, device));
+    it = models.emplace(device, prop.name).first;
+  }
+  return it->second;
+}
+
+// The layout of the input and the output, NHWC if data_format is "NHWC",
+// otherwise NCHW or NCDHW by the rank of the input.
+static DataLayout ConvLayout(const framework::ExecutionContext& ctx,
+                             const Tensor& input) {
+  if (ctx.Attr<std::string>("data_format") == "NHWC") {
+    PADDLE_ENFORCE_EQ(input.dims().size(), 4,
+                      "The NHWC layout only supports conv2d.");
+    return DataLayout::kNHWC;
+  }
+  return input.dims().size() == 5 ? DataLayout::kNCDHW : DataLayout::kNCHW;
+}
+
+// The offset between the first elements of two neighbouring groups of a
+// sample, whose channels are interleaved in the NHWC layout.
+static int GroupOffset(const framework::DDim& dims, int groups,
+                       DataLayout layout) {
+  if (layout == DataLayout::kNHWC) {
+    return dims[dims.size() - 1] / groups;
+  }
+  return framework::product(dims) / dims[0] / groups;
+}
+
+template <typename T>
+static std::string ConvAlgoCacheKey(const std::string& kind,
+                                    const framework::ExecutionContext& ctx,
+                                    const Tensor& input, const Tensor& filter,
+                                    const Tensor& output, DataLayout layout) {
+  ConvAlgoKey key;
+  key.kind = kind;
+  key.device =
+      GPUModel(boost::get<platform::CUDAPlace>(ctx.GetPlace()).device);
+  key.cudnn_version = static_cast<int>(platform::dynload::cudnnGetVersion());
+  key.dtype = framework::DataTypeToString(framework::ToDataType(typeid(T)));
+  key.layout = layout == DataLayout::kNCDHW
+                   ? "NCDHW"
+                   : (layout == DataLayout::kNHWC ? "NHWC" : "NCHW");
+  key.input_dims = framework::vectorize2int(input.dims());
+  key.filter_dims = framework::vectorize2int(filter.dims());
+  key.output_dims = framework::vectorize2int(output.dims());
+  key.strides = ctx.Attr<std::vector<int>>("strides");
+  key.paddings = ctx.Attr<std::vector<int>>("paddings");
+  key.dilations = ctx.Attr<std::vector<int>>("dilations");
+  key.groups = ctx.Attr<int>("groups");
+  return key.ToString();
+}
+
+// The perfs returned by cudnnFindConvolution*AlgorithmEx are sorted by the
+// time, and the ones failed to run are at the end.
+template <typename PerfT>
+static ConvAlgoCacheEntry FastestConvAlgo(const PerfT* perfs, int num) {
+  for (int i = 0; i < num; ++i) {
+    if (perfs[i].status == CUDNN_STATUS_SUCCESS) {
+      VLOG(3) << "found the cudnn algorithm " << perfs[i].algo << " of "
+              << perfs[i].time << " ms and " << perfs[i].memory << " bytes";
+      return ConvAlgoCacheEntry{static_cast<int>(perfs[i].algo),
+                                perfs[i].memory};
+    }
+  }
+  PADDLE_THROW("no cudnn convolution algorithm runs in the workspace limit");
+}
 
 template <typename T>
 class CUDNNConvOpKernel : public framework::OpKernel<T> {
@@ -65,10 +150,7 @@ class CUDNNConvOpKernel : public framework::OpKernel<T> {
     ScopedTensorDescriptor output_desc;
     ScopedFilterDescriptor filter_desc;
     ScopedConvolutionDescriptor conv_desc;
-    DataLayout layout = DataLayout::kNCHW;
-    if (input->dims().size() == 5) {
-      layout = DataLayout::kNCDHW;
-    }
+    DataLayout layout = ConvLayout(ctx, *input);
 
     cudnnConvolutionDescriptor_t cudnn_conv_desc =
         conv_desc.descriptor<T>(paddings, strides, dilations);
@@ -89,33 +171,8 @@ class CUDNNConvOpKernel : public framework::OpKernel<T> {
     cudnnFilterDescriptor_t cudnn_filter_desc = filter_desc.descriptor<T>(
         layout, framework::vectorize2int(filter->dims()), groups);
 
-    int input_channels = input->dims()[1];
-    int input_height, input_width, input_depth;
-    if (input->dims().size() == 5) {
-      input_depth = input->dims()[2];
-      input_height = input->dims()[3];
-      input_width = input->dims()[4];
-    } else {  // dim size is enforced in InferShape
-      input_depth = 1;
-      input_height = input->dims()[2];
-      input_width = input->dims()[3];
-    }
-    int output_channels = filter->dims()[0];
-    int output_height, output_width, output_depth;
-    if (output->dims().size() == 5) {
-      output_depth = output->dims()[2];
-      output_height = output->dims()[3];
-      output_width = output->dims()[4];
-    } else {
-      output_depth = 1;
-      output_height = output->dims()[2];
-      output_width = output->dims()[3];
-    }
-
-    int group_offset_in =
-        input_channels / groups * input_height * input_width * input_depth;
-    int group_offset_out =
-        output_channels / groups * output_height * output_width * output_depth;
+    int group_offset_in = GroupOffset(input->dims(), groups, layout);
+    int group_offset_out = GroupOffset(output->dims(), groups, layout);
     int group_offset_filter = filter->numel() / groups;
     // ------------------- cudnn conv workspace ---------------------
     size_t workspace_size_in_bytes;  // final workspace to allocate.
@@ -127,12 +184,9 @@ class CUDNNConvOpKernel : public framework::OpKernel<T> {
     cudnnConvolutionFwdAlgo_t algo;
     auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
     auto handle = dev_ctx.cudnn_handle();
+    auto workspace_handle = dev_ctx.cudnn_workspace_handle();
 
-    CUDNN_ENFORCE(platform::dynload::cudnnGetConvolutionForwardAlgorithm(
-        handle, cudnn_input_desc, cudnn_filter_desc, cudnn_conv_desc,
-        cudnn_output_desc, CUDNN_CONVOLUTION_FWD_SPECIFY_WORKSPACE_LIMIT,
-        workspace_size_limit, &algo));
-
+    bool use_tensor_op_math = false;
 #if CUDA_VERSION >= 9000 && CUDNN_VERSION_MIN(7, 0, 1)
     // Tensor core is supported since the volta GPU and
     // is only enabled when input and filter data are float16
@@ -141,14 +195,42 @@ class CUDNNConvOpKernel : public framework::OpKernel<T> {
             std::type_index(typeid(platform::float16))) {
       CUDNN_ENFORCE(platform::dynload::cudnnSetConvolutionMathType(
           cudnn_conv_desc, CUDNN_TENSOR_OP_MATH));
-      // Currently tensor core is only enabled using this algo
-      algo = CUDNN_CONVOLUTION_FWD_ALGO_IMPLICIT_PRECOMP_GEMM;
+      use_tensor_op_math = true;
     } else {
       CUDNN_ENFORCE(platform::dynload::cudnnSetConvolutionMathType(
           cudnn_conv_desc, CUDNN_DEFAULT_MATH));
     }
 #endif
 
+    if (UseExhaustiveSearch()) {
+      auto search = [&]() {
+        cudnnConvolutionFwdAlgoPerf_t perfs[kMaxConvAlgos];
+        int num_perfs = 0;
+        auto cudnn_find_func = [&](void* cudnn_workspace) {
+          CUDNN_ENFORCE(
+              platform::dynload::cudnnFindConvolutionForwardAlgorithmEx(
+                  handle, cudnn_input_desc, input_data, cudnn_filter_desc,
+                  filter_data, cudnn_conv_desc, cudnn_output_desc,
+                  output_data, kMaxConvAlgos, &num_perfs, perfs,
+                  cudnn_workspace, workspace_size_limit));
+        };
+        workspace_handle.RunFunc(cudnn_find_func, workspace_size_limit);
+        return FastestConvAlgo(perfs, num_perfs);
+      };
+      algo = ConvAlgoCache::Instance().GetOrSearch<cudnnConvolutionFwdAlgo_t>(
+          ConvAlgoCacheKey<T>("fwd", ctx, *input, *filter, *output, layout),
+          workspace_size_limit, search);
+    } else {
+      CUDNN_ENFORCE(platform::dynload::cudnnGetConvolutionForwardAlgorithm(
+          handle, cudnn_input_desc, cudnn_filter_desc, cudnn_conv_desc,
+          cudnn_output_desc, CUDNN_CONVOLUTION_FWD_SPECIFY_WORKSPACE_LIMIT,
+          workspace_size_limit, &algo));
+      if (use_tensor_op_math) {
+        // Currently tensor core is only enabled using this algo
+        algo = CUDNN_CONVOLUTION_FWD_ALGO_IMPLICIT_PRECOMP_GEMM;
+      }
+    }
+
     // get workspace size able to allocate
     CUDNN_ENFORCE(platform::dynload::cudnnGetConvolutionForwardWorkspaceSize(
         handle, cudnn_input_desc, cudnn_filter_desc, cudnn_conv_desc,
@@ -160,7 +242,6 @@ class CUDNNConvOpKernel : public framework::OpKernel<T> {
 
     // ------------------- cudnn conv forward ---------------------
     ScalingParamType<T> alpha = 1.0f, beta = 0.0f;
-    auto workspace_handle = dev_ctx.cudnn_workspace_handle();
     for (int i = 0; i < groups; i++) {
       auto cudnn_func = [&](void* cudnn_workspace) {
         CUDNN_ENFORCE(platform::dynload::cudnnConvolutionForward(
@@ -204,10 +285,7 @@ class CUDNNConvGradOpKernel : public framework::OpKernel<T> {
     ScopedFilterDescriptor filter_desc;
     ScopedFilterDescriptor filter_grad_desc;
     ScopedConvolutionDescriptor conv_desc;
-    DataLayout layout = DataLayout::kNCHW;
-    if (input->dims().size() == 5) {
-      layout = DataLayout::kNCDHW;
-    }
+    DataLayout layout = ConvLayout(ctx, *input);
 
     cudnnConvolutionDescriptor_t cudnn_conv_desc =
         conv_desc.descriptor<T>(paddings, strides, dilations);
@@ -229,34 +307,8 @@ class CUDNNConvGradOpKernel : public framework::OpKernel<T> {
     cudnnFilterDescriptor_t cudnn_filter_desc = filter_desc.descriptor<T>(
         layout, framework::vectorize2int(filter->dims()), groups);
 
-    int input_channels = input->dims()[1];
-    int input_height, input_width, input_depth;
-    if (input->dims().size() == 5) {
-      input_depth = input->dims()[2];
-      input_height = input->dims()[3];
-      input_width = input->dims()[4];
-    } else {  // dim size is enforced in InferShape
-      input_depth = 1;
-      input_height = input->dims()[2];
-      input_width = input->dims()[3];
-    }
-
-    int output_grad_channels = filter->dims()[0];
-    int output_grad_height, output_grad_width, output_grad_depth;
-    if (input->dims().size() == 5) {
-      output_grad_depth = output_grad->dims()[2];
-      output_grad_height = output_grad->dims()[3];
-      output_grad_width = output_grad->dims()[4];
-    } else {
-      output_grad_depth = 1;
-      output_grad_height = output_grad->dims()[2];
-      output_grad_width = output_grad->dims()[3];
-    }
-
-    int group_offset_in =
-        input_channels / groups * input_height * input_width * input_depth;
-    int group_offset_out = output_grad_channels / groups * output_grad_height *
-                           output_grad_width * output_grad_depth;
+    int group_offset_in = GroupOffset(input->dims(), groups, layout);
+    int group_offset_out = GroupOffset(output_grad->dims(), groups, layout);
     int group_offset_filter = filter->numel() / groups;
     // ------------------- cudnn backward algorithm ---------------------
     cudnnConvolutionBwdDataAlgo_t data_algo;
@@ -269,8 +321,30 @@ class CUDNNConvGradOpKernel : public framework::OpKernel<T> {
 
     auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
     auto handle = dev_ctx.cudnn_handle();
+    auto workspace_handle = dev_ctx.cudnn_workspace_handle();
     if (input_grad) {
-      if (!FLAGS_cudnn_deterministic) {
+      if (UseExhaustiveSearch()) {
+        auto search = [&]() {
+          cudnnConvolutionBwdDataAlgoPerf_t perfs[kMaxConvAlgos];
+          int num_perfs = 0;
+          T* input_grad_data = input_grad->mutable_data<T>(ctx.GetPlace());
+          auto cudnn_find_func = [&](void* cudnn_workspace) {
+            CUDNN_ENFORCE(
+                platform::dynload::cudnnFindConvolutionBackwardDataAlgorithmEx(
+                    handle, cudnn_filter_desc, filter_data,
+                    cudnn_output_grad_desc, output_grad_data, cudnn_conv_desc,
+                    cudnn_input_desc, input_grad_data, kMaxConvAlgos,
+                    &num_perfs, perfs, cudnn_workspace, workspace_size_limit));
+          };
+          workspace_handle.RunFunc(cudnn_find_func, workspace_size_limit);
+          return FastestConvAlgo(perfs, num_perfs);
+        };
+        data_algo = ConvAlgoCache::Instance()
+                        .GetOrSearch<cudnnConvolutionBwdDataAlgo_t>(
+                            ConvAlgoCacheKey<T>("bwd_data", ctx, *input,
+                                                *filter, *output_grad, layout),
+                            workspace_size_limit, search);
+      } else if (!FLAGS_cudnn_deterministic) {
         CUDNN_ENFORCE(
             platform::dynload::cudnnGetConvolutionBackwardDataAlgorithm(
                 handle, cudnn_filter_desc,
@@ -295,7 +369,31 @@ class CUDNNConvGradOpKernel : public framework::OpKernel<T> {
     }
 
     if (filter_grad) {
-      if (!FLAGS_cudnn_deterministic) {
+      if (UseExhaustiveSearch()) {
+        auto search = [&]() {
+          cudnnConvolutionBwdFilterAlgoPerf_t perfs[kMaxConvAlgos];
+          int num_perfs = 0;
+          T* filter_grad_data = filter_grad->mutable_data<T>(ctx.GetPlace());
+          auto cudnn_find_func = [&](void* cudnn_workspace) {
+            CUDNN_ENFORCE(
+                platform::dynload::
+                    cudnnFindConvolutionBackwardFilterAlgorithmEx(
+                        handle, cudnn_input_desc, input_data,
+                        cudnn_output_grad_desc, output_grad_data,
+                        cudnn_conv_desc, cudnn_filter_desc, filter_grad_data,
+                        kMaxConvAlgos, &num_perfs, perfs, cudnn_workspace,
+                        workspace_size_limit));
+          };
+          workspace_handle.RunFunc(cudnn_find_func, workspace_size_limit);
+          return FastestConvAlgo(perfs, num_perfs);
+        };
+        filter_algo =
+            ConvAlgoCache::Instance()
+                .GetOrSearch<cudnnConvolutionBwdFilterAlgo_t>(
+                    ConvAlgoCacheKey<T>("bwd_filter", ctx, *input, *filter,
+                                        *output_grad, layout),
+                    workspace_size_limit, search);
+      } else if (!FLAGS_cudnn_deterministic) {
         CUDNN_ENFORCE(
             platform::dynload::cudnnGetConvolutionBackwardFilterAlgorithm(
                 handle, cudnn_input_desc, cudnn_output_grad_desc,
@@ -315,7 +413,6 @@ class CUDNNConvGradOpKernel : public framework::OpKernel<T> {
 
     // ------------------- cudnn conv backward data ---------------------
     ScalingParamType<T> alpha = 1.0f, beta = 0.0f;
-    auto workspace_handle = dev_ctx.cudnn_workspace_handle();
     if (input_grad) {
       T* input_grad_data = input_grad->mutable_data<T>(ctx.GetPlace());
       // Because beta is zero, it is unnecessary to reset input_grad.
@@ -361,7 +458,8 @@ REGISTER_OP_KERNEL(conv2d, CUDNN, plat::CUDAPlace,
                    paddle::operators::CUDNNConvOpKernel<plat::float16>);
 REGISTER_OP_KERNEL(conv2d_grad, CUDNN, plat::CUDAPlace,
                    paddle::operators::CUDNNConvGradOpKernel<float>,
-                   paddle::operators::CUDNNConvGradOpKernel<double>);
+                   paddle::operators::CUDNNConvGradOpKernel<double>,
+                   paddle::operators::CUDNNConvGradOpKernel<plat::float16>);
 
 REGISTER_OP_KERNEL(conv3d, CUDNN, plat::CUDAPlace,
                    paddle::operators::CUDNNConvOpKernel<float>,
@@ -369,4 +467,5 @@ REGISTER_OP_KERNEL(conv3d, CUDNN, plat::CUDAPlace,
                    paddle::operators::CUDNNConvOpKernel<plat::float16>);
 REGISTER_OP_KERNEL(conv3d_grad, CUDNN, plat::CUDAPlace,
                    paddle::operators::CUDNNConvGradOpKernel<float>,
-                   paddle::operators::CUDNNConvGradOpKernel<double>);
+                   paddle::operators::CUDNNConvGradOpKernel<double>,
+                   paddle::operators::CUDNNConvGradOpKernel<plat::float16>);
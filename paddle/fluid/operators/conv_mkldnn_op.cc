@@ -556,6 +556,280 @@ class ConvMKLDNNOpKernel : public paddle::framework::OpKernel<T> {
   }
 };
 
+// Quantize the FP32 src into dst by a reorder with output scales.
+static void QuantizeByReorder(const memory& src, const memory& dst, int mask,
+                              const std::vector<float>& scales) {
+  mkldnn::primitive_attr attr;
+  attr.set_output_scales(mask, scales);
+  attr.set_int_output_round_mode(mkldnn::round_mode::round_nearest);
+  auto reorder_pd = mkldnn::reorder::primitive_desc(
+      src.get_primitive_desc(), dst.get_primitive_desc(), attr);
+  std::vector<primitive> pipeline{mkldnn::reorder(reorder_pd, src, dst)};
+  stream(stream::kind::eager).submit(pipeline).wait();
+}
+
+/*
+ * The convolution of the models quantized after training. T is the type of
+ * the quantized Input, uint8_t or int8_t.
+ *
+ * The FP32 Filter and Bias are quantized by Scale_weights and
+ * Scale_in * Scale_weights when the primitive is created, so the kernel only
+ * supports inference. The INT32 results are requantized by Scale_out to the
+ * Output, which is UINT8 if fuse_relu and INT8 otherwise, or dequantized to
+ * FP32 if force_fp32_output.
+ */
+template <typename T>
+class ConvMKLDNNINT8OpKernel : public paddle::framework::OpKernel<T> {
+ public:
+  void Compute(const paddle::framework::ExecutionContext& ctx) const override {
+    PADDLE_ENFORCE(paddle::platform::is_cpu_place(ctx.GetPlace()),
+                   "It must use CPUPlace.");
+    PADDLE_ENFORCE(ctx.Attr<bool>("is_test"),
+                   "INT8 convolution only supports inference");
+
+    auto& dev_ctx =
+        ctx.template device_context<paddle::platform::MKLDNNDeviceContext>();
+    const auto& mkldnn_engine = dev_ctx.GetEngine();
+
+    auto* input = ctx.Input<Tensor>("Input");
+    auto* filter = ctx.Input<Tensor>("Filter");
+    auto* bias = ctx.HasInput("Bias") ? ctx.Input<Tensor>("Bias") : nullptr;
+    auto* output = ctx.Output<Tensor>("Output");
+
+    PADDLE_ENFORCE(input->layout() == DataLayout::kMKLDNN &&
+                       input->format() != memory::format::format_undef,
+                   "Wrong layout/format set for Input tensor");
+    PADDLE_ENFORCE(filter->layout() == DataLayout::kMKLDNN &&
+                       filter->format() != memory::format::format_undef,
+                   "Wrong layout/format set for Filter tensor");
+    PADDLE_ENFORCE(input->dims().size() == 4,
+                   "Input must be with 4 dimensions, i.e. NCHW");
+    PADDLE_ENFORCE(filter->dims().size() == 4,
+                   "Filter must be with 4 dimensions, i.e. OIHW");
+    PADDLE_ENFORCE(!ctx.Attr<bool>("fuse_residual_connection"),
+                   "INT8 convolution does not support residual connection");
+
+    std::vector<int> strides = ctx.Attr<std::vector<int>>("strides");
+    std::vector<int> paddings = ctx.Attr<std::vector<int>>("paddings");
+    std::vector<int> dilations = ctx.Attr<std::vector<int>>("dilations");
+    bool fuse_relu = ctx.Attr<bool>("fuse_relu");
+    bool force_fp32_output = ctx.Attr<bool>("force_fp32_output");
+    int groups = ctx.Attr<int>("groups");
+    float scale_in = ctx.Attr<float>("Scale_in");
+    float scale_out = ctx.Attr<float>("Scale_out");
+    std::vector<float> scale_weights =
+        ctx.Attr<std::vector<float>>("Scale_weights");
+
+    PADDLE_ENFORCE(
+        dilations.size() == 2 && dilations[0] == 1 && dilations[1] == 1,
+        "dilation in convolution is not implemented yet");
+    bool per_channel = scale_weights.size() > 1;
+    PADDLE_ENFORCE(!per_channel ||
+                       scale_weights.size() ==
+                           static_cast<size_t>(filter->dims()[0]),
+                   "Scale_weights should have one scale for each output "
+                   "channel, or one for the whole Filter");
+
+    std::vector<int> src_tz = paddle::framework::vectorize2int(input->dims());
+    std::vector<int> weights_tz =
+        paddle::framework::vectorize2int(filter->dims());
+    int g = std::max(groups, 1);
+    if (g > 1) {
+      int o = weights_tz[0];
+      int i = weights_tz[1];
+      int h = weights_tz[2];
+      int w = weights_tz[3];
+      weights_tz.resize(5);
+      weights_tz[0] = g;
+      weights_tz[1] = o / g;
+      weights_tz[2] = i;
+      weights_tz[3] = h;
+      weights_tz[4] = w;
+    }
+    std::vector<int> dst_tz = paddle::framework::vectorize2int(output->dims());
+
+    const std::string key =
+        ConvMKLDNNHandler::GetHash(src_tz, weights_tz, strides, paddings,
+                                   dilations, groups,
+                                   ctx.op().Output("Output")) +
+        "@int8";
+    const std::string key_conv_p = key + "@conv_p";
+    const std::string key_user_src_mem_p = key + "@user_src_mem_p";
+    const std::string key_src_mem_p = key + "@src_mem_p";
+    const std::string key_src_reorder_p = key + "@src_reorder_p";
+    const std::string key_weights_mem_p = key + "@weights_mem_p";
+    const std::string key_bias_mem_p = key + "@bias_mem_p";
+    const std::string key_dst_mem_p = key + "@dst_mem_p";
+
+    auto dst_type = force_fp32_output
+                        ? memory::data_type::f32
+                        : (fuse_relu ? memory::data_type::u8
+                                     : memory::data_type::s8);
+    const T* input_data = input->data<T>();
+
+    auto conv_p = std::static_pointer_cast<mkldnn::convolution_forward>(
+        dev_ctx.GetBlob(key_conv_p));
+    std::shared_ptr<memory> user_src_memory_p;
+    std::shared_ptr<memory> dst_memory_p;
+    if (conv_p == nullptr) {
+      std::string data_format = ctx.Attr<std::string>("data_format");
+      auto chosen_memory_format =
+          platform::data_format_to_memory_format(data_format);
+
+      auto src_md = platform::MKLDNNMemDesc(
+          src_tz, platform::MKLDNNGetDataType<T>(), chosen_memory_format);
+      auto weights_md = platform::MKLDNNMemDesc(
+          weights_tz, memory::data_type::s8,
+          (g == 1) ? chosen_memory_format : memory::format::goihw);
+      auto dst_md =
+          platform::MKLDNNMemDesc(dst_tz, dst_type, chosen_memory_format);
+
+      memory::dims stride_dims = {strides[0], strides[1]};
+      memory::dims padding_dims = {paddings[0], paddings[1]};
+      std::vector<int> bias_tz;
+      std::unique_ptr<mkldnn::convolution_forward::desc> conv_desc;
+      if (bias) {
+        bias_tz = paddle::framework::vectorize2int(bias->dims());
+        auto bias_md = platform::MKLDNNMemDesc(
+            bias_tz, memory::data_type::s32, memory::format::x);
+        conv_desc.reset(new mkldnn::convolution_forward::desc(
+            mkldnn::prop_kind::forward_scoring, mkldnn::convolution_direct,
+            src_md, weights_md, bias_md, dst_md, stride_dims, padding_dims,
+            padding_dims, mkldnn::padding_kind::zero));
+      } else {
+        conv_desc.reset(new mkldnn::convolution_forward::desc(
+            mkldnn::prop_kind::forward_scoring, mkldnn::convolution_direct,
+            src_md, weights_md, dst_md, stride_dims, padding_dims,
+            padding_dims, mkldnn::padding_kind::zero));
+      }
+
+      // The INT32 results are in the scale of Scale_in * Scale_weights.
+      std::vector<float> output_shift_scale(scale_weights.size());
+      for (size_t i = 0; i < scale_weights.size(); ++i) {
+        output_shift_scale[i] = (force_fp32_output ? 1.0f : scale_out) /
+                                (scale_in * scale_weights[i]);
+      }
+      mkldnn::primitive_attr conv_attr;
+      conv_attr.set_output_scales(per_channel ? 1 << 1 : 0,
+                                  output_shift_scale);
+      conv_attr.set_int_output_round_mode(mkldnn::round_mode::round_nearest);
+      if (fuse_relu) {
+        mkldnn::post_ops post_operations;
+        post_operations.append_eltwise(1.0f, mkldnn::algorithm::eltwise_relu,
+                                       0.0f, 0.0f);
+        conv_attr.set_post_ops(post_operations);
+      }
+      auto conv_pd =
+          std::make_shared<mkldnn::convolution_forward::primitive_desc>(
+              *conv_desc, conv_attr, mkldnn_engine);
+
+      auto user_src_md = platform::MKLDNNMemDesc(
+          src_tz, platform::MKLDNNGetDataType<T>(), input->format());
+      user_src_memory_p = std::make_shared<memory>(
+          memory::primitive_desc(user_src_md, mkldnn_engine),
+          to_void_cast<T>(input_data));
+      auto src_memory_p = user_src_memory_p;
+      auto src_pd = conv_pd->src_primitive_desc();
+      auto user_src_pd = user_src_memory_p->get_primitive_desc();
+      if (src_pd != user_src_pd) {
+        src_memory_p = std::make_shared<memory>(src_pd);
+        auto src_reorder_p =
+            std::make_shared<reorder>(*user_src_memory_p, *src_memory_p);
+        dev_ctx.SetBlob(key_src_reorder_p, src_reorder_p);
+      }
+
+      // The Filter is quantized along the output channels, which are the
+      // dims 0 and 1 of the grouped weights.
+      auto user_weights_md = platform::MKLDNNMemDesc(
+          weights_tz, memory::data_type::f32,
+          (g == 1) ? filter->format() : memory::format::goihw);
+      memory user_weights_memory(
+          memory::primitive_desc(user_weights_md, mkldnn_engine),
+          to_void_cast<float>(filter->data<float>()));
+      auto weights_memory_p =
+          std::make_shared<memory>(conv_pd->weights_primitive_desc());
+      int weights_mask = per_channel ? (g == 1 ? 1 << 0 : (1 << 0) + (1 << 1))
+                                     : 0;
+      QuantizeByReorder(user_weights_memory, *weights_memory_p, weights_mask,
+                        scale_weights);
+
+      auto* output_data =
+          MutableOutput(output, dst_type, ctx.GetPlace(),
+                        conv_pd->dst_primitive_desc().get_size());
+      dst_memory_p =
+          std::make_shared<memory>(conv_pd->dst_primitive_desc(), output_data);
+
+      if (bias) {
+        std::vector<float> scale_bias(scale_weights.size());
+        for (size_t i = 0; i < scale_weights.size(); ++i) {
+          scale_bias[i] = scale_in * scale_weights[i];
+        }
+        auto user_bias_md = platform::MKLDNNMemDesc(
+            bias_tz, memory::data_type::f32, memory::format::x);
+        memory user_bias_memory(
+            memory::primitive_desc(user_bias_md, mkldnn_engine),
+            to_void_cast<float>(bias->data<float>()));
+        auto bias_memory_p =
+            std::make_shared<memory>(conv_pd->bias_primitive_desc());
+        QuantizeByReorder(user_bias_memory, *bias_memory_p,
+                          per_channel ? 1 << 0 : 0, scale_bias);
+        dev_ctx.SetBlob(key_bias_mem_p, bias_memory_p);
+        conv_p = std::make_shared<mkldnn::convolution_forward>(
+            *conv_pd, *src_memory_p, *weights_memory_p, *bias_memory_p,
+            *dst_memory_p);
+      } else {
+        conv_p = std::make_shared<mkldnn::convolution_forward>(
+            *conv_pd, *src_memory_p, *weights_memory_p, *dst_memory_p);
+      }
+
+      dev_ctx.SetBlob(key_user_src_mem_p, user_src_memory_p);
+      dev_ctx.SetBlob(key_src_mem_p, src_memory_p);
+      dev_ctx.SetBlob(key_weights_mem_p, weights_memory_p);
+      dev_ctx.SetBlob(key_dst_mem_p, dst_memory_p);
+      dev_ctx.SetBlob(key_conv_p, conv_p);
+    } else {
+      // Primitives already exist, only the data of Input and Output change.
+      user_src_memory_p = std::static_pointer_cast<memory>(
+          dev_ctx.GetBlob(key_user_src_mem_p));
+      dst_memory_p =
+          std::static_pointer_cast<memory>(dev_ctx.GetBlob(key_dst_mem_p));
+      PADDLE_ENFORCE(user_src_memory_p != nullptr && dst_memory_p != nullptr,
+                     "Fail to find convolution memory in device context");
+      user_src_memory_p->set_data_handle(to_void_cast<T>(input_data));
+      dst_memory_p->set_data_handle(
+          MutableOutput(output, dst_type, ctx.GetPlace(),
+                        dst_memory_p->get_primitive_desc().get_size()));
+    }
+
+    std::vector<primitive> pipeline;
+    auto src_reorder_p =
+        std::static_pointer_cast<reorder>(dev_ctx.GetBlob(key_src_reorder_p));
+    if (src_reorder_p != nullptr) {
+      pipeline.push_back(*src_reorder_p);
+    }
+    pipeline.push_back(*conv_p);
+    stream(stream::kind::eager).submit(pipeline).wait();
+
+    output->set_layout(DataLayout::kMKLDNN);
+    output->set_format(GetMKLDNNFormat(*dst_memory_p));
+  }
+
+ private:
+  void* MutableOutput(Tensor* output, memory::data_type type,
+                      const platform::Place& place, size_t size) const {
+    switch (type) {
+      case memory::data_type::f32:
+        return output->mutable_data<float>(place, size);
+      case memory::data_type::u8:
+        return output->mutable_data<uint8_t>(place, size);
+      case memory::data_type::s8:
+        return output->mutable_data<int8_t>(place, size);
+      default:
+        PADDLE_THROW("Unsupported output type of INT8 convolution");
+    }
+  }
+};
+
 template <typename T>
 class ConvMKLDNNGradOpKernel : public paddle::framework::OpKernel<T> {
  public:
@@ -735,7 +1009,9 @@ class ConvMKLDNNGradOpKernel : public paddle::framework::OpKernel<T> {
 namespace ops = paddle::operators;
 
 REGISTER_OP_KERNEL(conv2d, MKLDNN, ::paddle::platform::CPUPlace,
-                   ops::ConvMKLDNNOpKernel<float>);
+                   ops::ConvMKLDNNOpKernel<float>,
+                   ops::ConvMKLDNNINT8OpKernel<uint8_t>,
+                   ops::ConvMKLDNNINT8OpKernel<int8_t>);
 
 REGISTER_OP_KERNEL(conv2d_grad, MKLDNN, ::paddle::platform::CPUPlace,
                    ops::ConvMKLDNNGradOpKernel<float>);
@@ -24,6 +24,11 @@ limitations under the License. */
 #include "paddle/fluid/platform/mkldnn_helper.h"
 #endif
 
+DEFINE_bool(conv_cpu_fast_algo, true,
+            "Whether to select the Winograd, the direct or the depthwise "
+            "convolution by the shapes for the 2-D convolutions on CPU, "
+            "instead of always using im2col + GEMM.");
+
 namespace paddle {
 namespace operators {
 
@@ -55,23 +60,44 @@ void ConvOp::InferShape(framework::InferShapeContext* ctx) const {
       paddings.size(), strides.size(),
       "Conv paddings dimension and Conv strides dimension should be the same.");
 
-  PADDLE_ENFORCE_EQ(in_dims[1], filter_dims[1] * groups,
+  // The channels are the last dim of the NHWC input, output and filter.
+  const bool channel_last =
+      ctx->Attrs().Get<std::string>("data_format") == "NHWC";
+  PADDLE_ENFORCE(!channel_last || in_dims.size() == 4,
+                 "The NHWC layout only supports conv2d.");
+  const int channel_dim = channel_last ? in_dims.size() - 1 : 1;
+  const int spatial_begin = channel_last ? 1 : 2;
+
+  PADDLE_ENFORCE_EQ(in_dims[channel_dim], filter_dims[channel_dim] * groups,
                     "The number of input channels should be equal to filter "
                     "channels * groups.");
   PADDLE_ENFORCE_EQ(
       filter_dims[0] % groups, 0,
       "The number of output channels should be divided by groups.");
 
-  std::vector<int64_t> output_shape({in_dims[0], filter_dims[0]});
+  std::vector<int64_t> output_shape({in_dims[0]});
+  if (!channel_last) output_shape.push_back(filter_dims[0]);
   for (size_t i = 0; i < strides.size(); ++i) {
-    output_shape.push_back(ConvOutputSize(in_dims[i + 2], filter_dims[i + 2],
-                                          dilations[i], paddings[i],
-                                          strides[i]));
+    output_shape.push_back(ConvOutputSize(
+        in_dims[i + spatial_begin], filter_dims[i + spatial_begin],
+        dilations[i], paddings[i], strides[i]));
   }
+  if (channel_last) output_shape.push_back(filter_dims[0]);
   ctx->SetOutputDim("Output", framework::make_ddim(output_shape));
   ctx->ShareLoD("Input", "Output");
 }
 
+// Only the plain kernels fake quantize the inputs, conv3d has no such
+// attributes.
+static bool IsFakeQuantized(const framework::ExecutionContext& ctx) {
+  auto& attrs = ctx.op().Attrs();
+  for (const char* attr : {math::kInputQuantBits, math::kFilterQuantBits}) {
+    auto it = attrs.find(attr);
+    if (it != attrs.end() && boost::get<int>(it->second) > 0) return true;
+  }
+  return false;
+}
+
 framework::OpKernelType ConvOp::GetExpectedKernelType(
     const framework::ExecutionContext& ctx) const {
   framework::LibraryType library{framework::LibraryType::kPlain};
@@ -80,13 +106,13 @@ framework::OpKernelType ConvOp::GetExpectedKernelType(
   framework::DataLayout layout = framework::StringToDataLayout(data_format);
 
 #ifdef PADDLE_WITH_CUDA
-  if (platform::CanCUDNNBeUsed(ctx)) {
+  if (platform::CanCUDNNBeUsed(ctx) && !IsFakeQuantized(ctx)) {
     library = framework::LibraryType::kCUDNN;
   }
 #endif
 #ifdef PADDLE_WITH_MKLDNN
   if (library == framework::LibraryType::kPlain &&
-      platform::CanMKLDNNBeUsed(ctx)) {
+      platform::CanMKLDNNBeUsed(ctx) && !IsFakeQuantized(ctx)) {
     library = framework::LibraryType::kMKLDNN;
     layout = framework::DataLayout::kMKLDNN;
   }
@@ -96,13 +122,29 @@ framework::OpKernelType ConvOp::GetExpectedKernelType(
       framework::ToDataType(ctx.Input<Tensor>("Input")->type());
   auto filter_data_type =
       framework::ToDataType(ctx.Input<Tensor>("Filter")->type());
-  PADDLE_ENFORCE_EQ(input_data_type, filter_data_type,
-                    "input and filter data type should be consistent");
+  if (input_data_type == framework::proto::VarType::INT8 ||
+      input_data_type == framework::proto::VarType::UINT8) {
+    // The FP32 filter is quantized by the INT8 kernel itself.
+    PADDLE_ENFORCE_EQ(library, framework::LibraryType::kMKLDNN,
+                      "int8 can only be used when MKLDNN is used");
+    PADDLE_ENFORCE_EQ(filter_data_type, framework::proto::VarType::FP32,
+                      "the filter of int8 convolution should be float");
+  } else {
+    PADDLE_ENFORCE_EQ(input_data_type, filter_data_type,
+                      "input and filter data type should be consistent");
+  }
 
   if (input_data_type == framework::proto::VarType::FP16) {
     PADDLE_ENFORCE_EQ(library, framework::LibraryType::kCUDNN,
                       "float16 can only be used when CUDNN is used");
   }
+  if (layout == framework::DataLayout::kNHWC) {
+    PADDLE_ENFORCE_EQ(library, framework::LibraryType::kCUDNN,
+                      "the NHWC layout can only be used when CUDNN is used");
+    // The cudnn kernel reads data_format itself, the input should not be
+    // transformed to the layout.
+    layout = framework::DataLayout::kAnyLayout;
+  }
 
   return framework::OpKernelType(input_data_type, ctx.GetPlace(), layout,
                                  library);
@@ -173,12 +215,42 @@ void Conv2DOpMaker::Make() {
                 "whenever convolution output is as an input to residual "
                 "connection.")
       .SetDefault(false);
+  AddAttr<float>("Scale_in",
+                 "(float, default 1.0) Only used in the INT8 mkldnn kernel. "
+                 "The scale the Input is quantized with.")
+      .SetDefault(1.0f);
+  AddAttr<std::vector<float>>(
+      "Scale_weights",
+      "(vector<float>, default {1.0}) Only used in the INT8 mkldnn kernel. "
+      "The scales the FP32 Filter is quantized with, one for each output "
+      "channel, or one for the whole Filter.")
+      .SetDefault({1.0f});
+  AddAttr<float>("Scale_out",
+                 "(float, default 1.0) Only used in the INT8 mkldnn kernel. "
+                 "The scale the Output is quantized with.")
+      .SetDefault(1.0f);
+  AddAttr<bool>("force_fp32_output",
+                "(bool, default false) Only used in the INT8 mkldnn kernel. "
+                "Dequantize the Output to FP32 instead of quantizing it by "
+                "Scale_out.")
+      .SetDefault(false);
+  AddAttr<int>(math::kInputQuantBits,
+               "(int, default 0) Only used in the quantization-aware training "
+               "on CPU, the bits the Input is fake quantized with by its abs "
+               "max before the convolution, 0 if it is not quantized.")
+      .SetDefault(0);
+  AddAttr<int>(math::kFilterQuantBits,
+               "(int, default 0) Only used in the quantization-aware training "
+               "on CPU, the bits the Filter is fake quantized with by its abs "
+               "max before the convolution, 0 if it is not quantized.")
+      .SetDefault(0);
   AddAttr<std::string>(
       "data_format",
-      "(string, default NCHW) Only used in "
-      "An optional string from: \"NHWC\", \"NCHW\". "
-      "Defaults to \"NHWC\". Specify the data format of the output data, "
-      "the input will be transformed automatically. ")
+      "(string, default AnyLayout) An optional string from: \"NHWC\", "
+      "\"NCHW\", \"AnyLayout\". \"NHWC\" is only supported by the cudnn "
+      "kernel, where the Input and the Output are NHWC and the Filter is "
+      "MHWC, so that the cudnn convolution runs on the tensor cores without "
+      "transposing the data. The others are NCHW.")
       .SetDefault("AnyLayout");
   // TODO(dzhwinter): need to registered layout transform function
   AddAttr<int>("workspace_size_MB",
@@ -334,17 +406,22 @@ framework::OpKernelType ConvOpGrad::GetExpectedKernelType(
   framework::DataLayout layout_ = framework::StringToDataLayout(data_format);
 
 #ifdef PADDLE_WITH_CUDA
-  if (platform::CanCUDNNBeUsed(ctx)) {
+  if (platform::CanCUDNNBeUsed(ctx) && !IsFakeQuantized(ctx)) {
     library_ = framework::LibraryType::kCUDNN;
   }
 #endif
 #ifdef PADDLE_WITH_MKLDNN
   if (library_ == framework::LibraryType::kPlain &&
-      platform::CanMKLDNNBeUsed(ctx)) {
+      platform::CanMKLDNNBeUsed(ctx) && !IsFakeQuantized(ctx)) {
     library_ = framework::LibraryType::kMKLDNN;
     layout_ = framework::DataLayout::kMKLDNN;
   }
 #endif
+  if (layout_ == framework::DataLayout::kNHWC) {
+    PADDLE_ENFORCE_EQ(library_, framework::LibraryType::kCUDNN,
+                      "the NHWC layout can only be used when CUDNN is used");
+    layout_ = framework::DataLayout::kAnyLayout;
+  }
 
   return framework::OpKernelType(
       framework::ToDataType(ctx.Input<Tensor>("Input")->type()), ctx.GetPlace(),
@@ -371,21 +448,25 @@ REGISTER_OPERATOR(conv3d_grad, ops::ConvOpGrad);
 // TODO(xingzhaolong): neon kernel for mobile
 REGISTER_OP_CPU_KERNEL(
     depthwise_conv2d,
-    ops::GemmConvKernel<paddle::platform::CPUDeviceContext, float>,
-    ops::GemmConvKernel<paddle::platform::CPUDeviceContext, double>);
+    ops::DepthwiseConvKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::DepthwiseConvKernel<paddle::platform::CPUDeviceContext, double>);
 
 REGISTER_OP_CPU_KERNEL(
     depthwise_conv2d_grad,
-    ops::GemmConvGradKernel<paddle::platform::CPUDeviceContext, float>,
-    ops::GemmConvGradKernel<paddle::platform::CPUDeviceContext, double>);
+    ops::DepthwiseConvGradKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::DepthwiseConvGradKernel<paddle::platform::CPUDeviceContext, double>);
 
 REGISTER_OP_CPU_KERNEL(
     conv2d, ops::GemmConvKernel<paddle::platform::CPUDeviceContext, float>,
-    ops::GemmConvKernel<paddle::platform::CPUDeviceContext, double>);
+    ops::GemmConvKernel<paddle::platform::CPUDeviceContext, double>,
+    ops::GemmConvKernel<paddle::platform::CPUDeviceContext,
+                        paddle::platform::bfloat16>);
 REGISTER_OP_CPU_KERNEL(
     conv2d_grad,
     ops::GemmConvGradKernel<paddle::platform::CPUDeviceContext, float>,
-    ops::GemmConvGradKernel<paddle::platform::CPUDeviceContext, double>);
+    ops::GemmConvGradKernel<paddle::platform::CPUDeviceContext, double>,
+    ops::GemmConvGradKernel<paddle::platform::CPUDeviceContext,
+                            paddle::platform::bfloat16>);
 
 REGISTER_OP_CPU_KERNEL(
     conv3d, ops::GemmConvKernel<paddle::platform::CPUDeviceContext, float>,
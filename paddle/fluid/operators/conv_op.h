@@ -15,12 +15,19 @@ limitations under the License. */
 #pragma once
 
 #include <vector>
+#include "gflags/gflags.h"
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/depthwise_conv.h"
+#include "paddle/fluid/operators/math/direct_conv.h"
+#include "paddle/fluid/operators/math/fake_quant.h"
 #include "paddle/fluid/operators/math/im2col.h"
+#include "paddle/fluid/operators/math/implicit_gemm_conv.h"
 #include "paddle/fluid/operators/math/vol2col.h"
+#include "paddle/fluid/operators/math/winograd_conv.h"
+
+DECLARE_bool(conv_cpu_fast_algo);
 
 namespace paddle {
 namespace operators {
@@ -88,15 +95,196 @@ class ConvOpGrad : public framework::OperatorWithKernel {
       const framework::ExecutionContext& ctx) const override;
 };
 
+enum class CPUConvAlgo { kIm2ColGemm, kWinograd, kDirect, kDepthwise };
+
+// Selects the 2-D convolution algorithm on CPU by the shapes. The depthwise
+// convolutions, whose groups have one input channel each, are computed
+// directly over the channel planes instead of a tiny GEMM per channel. The
+// Winograd
+// F(2x2, 3x3) convolution is used for the 3x3 filters with stride 1 and
+// dilation 1, and the direct convolution for the convolutions with so few
+// input channels that the im2col buffer costs more than the tiny GEMM.
+// filter_dim: {k_o, k_i, k_h, k_w}, where k_i is the channels of a group.
+inline CPUConvAlgo SelectCPUConvAlgo(const std::vector<int64_t>& filter_dim,
+                                     const std::vector<int>& strides,
+                                     const std::vector<int>& dilations,
+                                     int groups, int64_t output_size) {
+  if (!FLAGS_conv_cpu_fast_algo || filter_dim.size() != 4U) {
+    return CPUConvAlgo::kIm2ColGemm;
+  }
+  const int64_t output_channels = filter_dim[0] / groups;
+  const int64_t input_channels = filter_dim[1];
+  const int64_t filter_size = filter_dim[2] * filter_dim[3];
+  if (groups > 1 && input_channels == 1) {
+    return CPUConvAlgo::kDepthwise;
+  }
+  if (filter_dim[2] == 3 && filter_dim[3] == 3 && strides[0] == 1 &&
+      strides[1] == 1 && dilations[0] == 1 && dilations[1] == 1 &&
+      input_channels >= 4 && output_channels >= 4 && output_size >= 16) {
+    return CPUConvAlgo::kWinograd;
+  }
+  if (input_channels * filter_size <= 27) {
+    return CPUConvAlgo::kDirect;
+  }
+  return CPUConvAlgo::kIm2ColGemm;
+}
+
+// Runs the 2-D convolution by the Winograd, the direct or the implicit GEMM
+// algorithm, returns false if im2col + GEMM should be used. CPU has the
+// former two and GPU the implicit GEMM.
+template <typename DeviceContext, typename T>
+struct FastConv2DFunctor {
+  bool operator()(const DeviceContext& dev_ctx, const Tensor& input,
+                  const Tensor& filter, const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations, int groups,
+                  Tensor* output) const {
+    return false;
+  }
+};
+
+template <typename T>
+struct FastConv2DFunctor<platform::CPUDeviceContext, T> {
+  bool operator()(const platform::CPUDeviceContext& dev_ctx,
+                  const Tensor& input, const Tensor& filter,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations, int groups,
+                  Tensor* output) const {
+    std::vector<int64_t> filter_dim(framework::vectorize(filter.dims()));
+    if (filter_dim.size() != 4U) return false;
+    const int64_t output_size = output->dims()[2] * output->dims()[3];
+    CPUConvAlgo algo =
+        SelectCPUConvAlgo(filter_dim, strides, dilations, groups, output_size);
+    if (algo == CPUConvAlgo::kIm2ColGemm) return false;
+    if (algo == CPUConvAlgo::kDepthwise) {
+      math::DepthwiseConvFunctor<platform::CPUDeviceContext, T> depthwise;
+      depthwise(dev_ctx, input, filter, strides, paddings, dilations, output);
+      return true;
+    }
+
+    const int batch_size = static_cast<int>(input.dims()[0]);
+    const int64_t in_step = input.dims()[1] / groups;
+    const int64_t out_step = output->dims()[1] / groups;
+    framework::DDim in_slice_shape = {in_step, input.dims()[2],
+                                      input.dims()[3]};
+    framework::DDim out_slice_shape = {out_step, output->dims()[2],
+                                       output->dims()[3]};
+
+    // The filters are transformed once for all the images.
+    std::vector<Tensor> filter_slices(groups);
+    math::WinogradConv3x3Functor<platform::CPUDeviceContext, T> winograd;
+    for (int g = 0; g < groups; ++g) {
+      Tensor filter_slice = filter.Slice(g * out_step, (g + 1) * out_step);
+      if (algo == CPUConvAlgo::kWinograd) {
+        winograd.TransformFilter(dev_ctx, filter_slice, &filter_slices[g]);
+      } else {
+        filter_slices[g] = filter_slice;
+      }
+    }
+
+    math::DirectConvFunctor<platform::CPUDeviceContext, T> direct;
+    for (int i = 0; i < batch_size; ++i) {
+      Tensor in_batch = input.Slice(i, i + 1);
+      Tensor out_batch = output->Slice(i, i + 1);
+      in_batch.Resize(framework::slice_ddim(input.dims(), 1, 4));
+      out_batch.Resize(framework::slice_ddim(output->dims(), 1, 4));
+      for (int g = 0; g < groups; ++g) {
+        Tensor in_slice = in_batch.Slice(g * in_step, (g + 1) * in_step);
+        Tensor out_slice = out_batch.Slice(g * out_step, (g + 1) * out_step);
+        in_slice.Resize(in_slice_shape);
+        out_slice.Resize(out_slice_shape);
+        if (algo == CPUConvAlgo::kWinograd) {
+          winograd(dev_ctx, in_slice, filter_slices[g], paddings, &out_slice);
+        } else {
+          direct(dev_ctx, in_slice, filter_slices[g], strides, paddings,
+                 dilations, &out_slice);
+        }
+      }
+    }
+    return true;
+  }
+};
+
+#ifdef PADDLE_WITH_CUDA
+template <typename T>
+struct FastConv2DFunctor<platform::CUDADeviceContext, T> {
+  bool operator()(const platform::CUDADeviceContext& dev_ctx,
+                  const Tensor& input, const Tensor& filter,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations, int groups,
+                  Tensor* output) const {
+    if (filter.dims().size() != 4) return false;
+    auto shape = math::MakeImplicitGemmConvShape(
+        input, filter, strides, paddings, dilations, groups, *output);
+    if (!math::UseImplicitGemmConv(shape, false)) return false;
+    math::ImplicitGemmConvFunctor<platform::CUDADeviceContext, T>()(
+        dev_ctx, input, filter, strides, paddings, dilations, groups, output);
+    return true;
+  }
+};
+#endif
+
+// Runs the backward of the depthwise 2-D convolution, returns false if
+// col2im + GEMM should be used. Only CPU has this algorithm.
+template <typename DeviceContext, typename T>
+struct FastConv2DGradFunctor {
+  bool operator()(const DeviceContext& dev_ctx, const Tensor& input,
+                  const Tensor& filter, const Tensor& output_grad,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations, int groups,
+                  Tensor* input_grad, Tensor* filter_grad) const {
+    return false;
+  }
+};
+
+template <typename T>
+struct FastConv2DGradFunctor<platform::CPUDeviceContext, T> {
+  bool operator()(const platform::CPUDeviceContext& dev_ctx,
+                  const Tensor& input, const Tensor& filter,
+                  const Tensor& output_grad, const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations, int groups,
+                  Tensor* input_grad, Tensor* filter_grad) const {
+    std::vector<int64_t> filter_dim(framework::vectorize(filter.dims()));
+    if (filter_dim.size() != 4U) return false;
+    const int64_t output_size = output_grad.dims()[2] * output_grad.dims()[3];
+    if (SelectCPUConvAlgo(filter_dim, strides, dilations, groups,
+                          output_size) != CPUConvAlgo::kDepthwise) {
+      return false;
+    }
+    if (input_grad) {
+      math::DepthwiseConvInputGradFunctor<platform::CPUDeviceContext, T>
+          depthwise_input_grad;
+      depthwise_input_grad(dev_ctx, input, filter, output_grad, strides,
+                           paddings, dilations, input_grad);
+    }
+    if (filter_grad) {
+      math::DepthwiseConvFilterGradFunctor<platform::CPUDeviceContext, T>
+          depthwise_filter_grad;
+      depthwise_filter_grad(dev_ctx, input, output_grad, strides, paddings,
+                            dilations, filter_grad);
+    }
+    return true;
+  }
+};
+
 template <typename DeviceContext, typename T>
 class GemmConvKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext& context) const override {
-    const Tensor* input = context.Input<Tensor>("Input");
+    Tensor input_quant, filter_quant;
+    const Tensor* input = math::FakeQuantizedInput<DeviceContext, T>(
+        context, math::kInputQuantBits, context.Input<Tensor>("Input"),
+        &input_quant);
     // The filter will be reshaped in the calculations,
     // so here use an assignment operation,
     // that avoids modifying the variable in the Scope.
-    Tensor filter = *context.Input<Tensor>("Filter");
+    Tensor filter = *math::FakeQuantizedInput<DeviceContext, T>(
+        context, math::kFilterQuantBits, context.Input<Tensor>("Filter"),
+        &filter_quant);
     Tensor* output = context.Output<Tensor>("Output");
     output->mutable_data<T>(context.GetPlace());
 
@@ -105,6 +293,13 @@ class GemmConvKernel : public framework::OpKernel<T> {
     std::vector<int> paddings = context.Attr<std::vector<int>>("paddings");
     std::vector<int> dilations = context.Attr<std::vector<int>>("dilations");
 
+    auto& dev_ctx = context.template device_context<DeviceContext>();
+    if (FastConv2DFunctor<DeviceContext, T>()(dev_ctx, *input, filter, strides,
+                                              paddings, dilations, groups,
+                                              output)) {
+      return;
+    }
+
     const int batch_size = static_cast<int>(input->dims()[0]);
 
     // filter_shape_vec: {k_o, k_i, k_h, k_w} or {k_o, k_i, k_d, k_h, k_w}
@@ -160,7 +355,6 @@ class GemmConvKernel : public framework::OpKernel<T> {
     math::Vol2ColFunctor<DeviceContext, T> vol2col;
     math::Im2ColFunctor<math::ColFormat::kCFO, DeviceContext, T> im2col;
 
-    auto& dev_ctx = context.template device_context<DeviceContext>();
     auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
     for (int i = 0; i < batch_size; i++) {
       Tensor in_batch = input->Slice(i, i + 1).Resize(input_shape);
@@ -198,25 +392,39 @@ template <typename DeviceContext, typename T>
 class GemmConvGradKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext& context) const override {
-    const Tensor* input = context.Input<Tensor>("Input");
     const Tensor* output_grad =
         context.Input<Tensor>(framework::GradVarName("Output"));
     Tensor* input_grad =
         context.Output<Tensor>(framework::GradVarName("Input"));
     Tensor* filter_grad =
         context.Output<Tensor>(framework::GradVarName("Filter"));
+
+    if (!input_grad && !filter_grad) return;
+
+    // The gradients of the fake quantized inputs are passed straight through.
+    Tensor input_quant, filter_quant;
+    const Tensor* input = math::FakeQuantizedInput<DeviceContext, T>(
+        context, math::kInputQuantBits, context.Input<Tensor>("Input"),
+        &input_quant);
     // The filter and filter_grad will be reshaped in the calculations,
     // so here use an assignment operation,
     // that avoids modifying the variable in the Scope.
-    Tensor filter = *context.Input<Tensor>("Filter");
-
-    if (!input_grad && !filter_grad) return;
+    Tensor filter = *math::FakeQuantizedInput<DeviceContext, T>(
+        context, math::kFilterQuantBits, context.Input<Tensor>("Filter"),
+        &filter_quant);
 
     int groups = context.Attr<int>("groups");
     std::vector<int> strides = context.Attr<std::vector<int>>("strides");
     std::vector<int> paddings = context.Attr<std::vector<int>>("paddings");
     std::vector<int> dilations = context.Attr<std::vector<int>>("dilations");
 
+    auto& dev_ctx = context.template device_context<DeviceContext>();
+    if (FastConv2DGradFunctor<DeviceContext, T>()(
+            dev_ctx, *input, filter, *output_grad, strides, paddings,
+            dilations, groups, input_grad, filter_grad)) {
+      return;
+    }
+
     const int batch_size = static_cast<int>(input->dims()[0]);
 
     // filter_shape_vec: {k_o, k_i, k_h, k_w} or {k_o, k_i, k_d, k_h, k_w}
@@ -274,7 +482,6 @@ class GemmConvGradKernel : public framework::OpKernel<T> {
     }
 
     math::SetConstant<DeviceContext, T> set_zero;
-    auto& dev_ctx = context.template device_context<DeviceContext>();
     auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
 
     if (input_grad) {
@@ -365,8 +572,13 @@ template <typename DeviceContext, typename T>
 class DepthwiseConvKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext& context) const override {
-    const Tensor* input = context.Input<Tensor>("Input");
-    Tensor filter = *context.Input<Tensor>("Filter");
+    Tensor input_quant, filter_quant;
+    const Tensor* input = math::FakeQuantizedInput<DeviceContext, T>(
+        context, math::kInputQuantBits, context.Input<Tensor>("Input"),
+        &input_quant);
+    Tensor filter = *math::FakeQuantizedInput<DeviceContext, T>(
+        context, math::kFilterQuantBits, context.Input<Tensor>("Filter"),
+        &filter_quant);
     Tensor* output = context.Output<Tensor>("Output");
     output->mutable_data<T>(context.GetPlace());
 
@@ -389,17 +601,23 @@ template <typename DeviceContext, typename T>
 class DepthwiseConvGradKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext& context) const override {
-    const Tensor* input = context.Input<Tensor>("Input");
     const Tensor* output_grad =
         context.Input<Tensor>(framework::GradVarName("Output"));
     Tensor* input_grad =
         context.Output<Tensor>(framework::GradVarName("Input"));
     Tensor* filter_grad =
         context.Output<Tensor>(framework::GradVarName("Filter"));
-    Tensor filter = *context.Input<Tensor>("Filter");
 
     if (!input_grad && !filter_grad) return;
 
+    Tensor input_quant, filter_quant;
+    const Tensor* input = math::FakeQuantizedInput<DeviceContext, T>(
+        context, math::kInputQuantBits, context.Input<Tensor>("Input"),
+        &input_quant);
+    Tensor filter = *math::FakeQuantizedInput<DeviceContext, T>(
+        context, math::kFilterQuantBits, context.Input<Tensor>("Filter"),
+        &filter_quant);
+
     std::vector<int> strides = context.Attr<std::vector<int>>("strides");
     std::vector<int> paddings = context.Attr<std::vector<int>>("paddings");
     std::vector<int> dilations = context.Attr<std::vector<int>>("dilations");
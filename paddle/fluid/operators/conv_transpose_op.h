@@ -19,6 +19,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/depthwise_conv.h"
 #include "paddle/fluid/operators/math/im2col.h"
+#include "paddle/fluid/operators/math/implicit_gemm_conv.h"
 #include "paddle/fluid/operators/math/vol2col.h"
 
 namespace paddle {
@@ -59,6 +60,39 @@ class ConvTransposeOpGrad : public framework::OperatorWithKernel {
       const framework::ExecutionContext& ctx) const override;
 };
 
+// Runs the 2-D transposed convolution by the implicit GEMM, returns false if
+// GEMM + col2im should be used. Only GPU has this algorithm.
+template <typename DeviceContext, typename T>
+struct FastConv2DTransposeFunctor {
+  bool operator()(const DeviceContext& dev_ctx, const Tensor& input,
+                  const Tensor& filter, const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations, int groups,
+                  Tensor* output) const {
+    return false;
+  }
+};
+
+#ifdef PADDLE_WITH_CUDA
+template <typename T>
+struct FastConv2DTransposeFunctor<platform::CUDADeviceContext, T> {
+  bool operator()(const platform::CUDADeviceContext& dev_ctx,
+                  const Tensor& input, const Tensor& filter,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations, int groups,
+                  Tensor* output) const {
+    if (filter.dims().size() != 4) return false;
+    auto shape = math::MakeImplicitGemmConvShape(
+        input, filter, strides, paddings, dilations, groups, *output);
+    if (!math::UseImplicitGemmConv(shape, true)) return false;
+    math::ImplicitGemmConvTransposeFunctor<platform::CUDADeviceContext, T>()(
+        dev_ctx, input, filter, strides, paddings, dilations, groups, output);
+    return true;
+  }
+};
+#endif
+
 template <typename DeviceContext, typename T>
 class GemmConvTransposeKernel : public framework::OpKernel<T> {
  public:
@@ -73,6 +107,14 @@ class GemmConvTransposeKernel : public framework::OpKernel<T> {
     std::vector<int> dilations = context.Attr<std::vector<int>>("dilations");
     int groups = context.Attr<int>("groups");
 
+    auto& dev_ctx = context.template device_context<DeviceContext>();
+    output->mutable_data<T>(context.GetPlace());
+    if (FastConv2DTransposeFunctor<DeviceContext, T>()(
+            dev_ctx, *input, filter, strides, paddings, dilations, groups,
+            output)) {
+      return;
+    }
+
     const int batch_size = static_cast<int>(input->dims()[0]);
 
     // input_shape_vec: {n, c, h, w} or {n, c, d, h, w}
@@ -116,9 +158,7 @@ class GemmConvTransposeKernel : public framework::OpKernel<T> {
     DDim filter_matrix_shape = {input->dims()[1], col_matrix_shape[0]};
     filter.Resize(filter_matrix_shape);
 
-    output->mutable_data<T>(context.GetPlace());
     math::SetConstant<DeviceContext, T> set_zero;
-    auto& dev_ctx = context.template device_context<DeviceContext>();
     auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
     set_zero(dev_ctx, output, static_cast<T>(0));
 
@@ -120,7 +120,7 @@ class CRFDecodingOp : public framework::OperatorWithKernel {
       const framework::ExecutionContext& ctx) const override {
     return framework::OpKernelType(
         framework::ToDataType(ctx.Input<LoDTensor>("Emission")->type()),
-        platform::CPUPlace());
+        ctx.GetPlace());
   }
 };
 }  // namespace operators
@@ -0,0 +1,146 @@
+/* Copyright (c) 2016 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include "paddle/fluid/operators/crf_decoding_op.h"
+
+namespace paddle {
+namespace operators {
+
+namespace {
+
+int const kNumCUDAThreads = 512;
+
+// The power of two threads of a block to run the tags of a sequence.
+static inline int NumThreads(const int tag_num) {
+  int threads = 32;
+  while (threads < tag_num && threads < kNumCUDAThreads) threads <<= 1;
+  return threads;
+}
+
+// One block decodes one sequence, the threads of the block run the tags.
+// alpha(k, i) is the score of the best tags from position 0 to position k
+// with i being the end tag, and track(k, i) is the tag at position k - 1 of
+// it. The first max is taken for ties as the JIT CRFDecodeKernel does.
+template <typename T>
+__global__ void ViterbiKernel(const size_t* lod, const T* x, const T* w,
+                              const int64_t* label, const int tag_num,
+                              T* alpha, int* track, int64_t* path) {
+  const int start = static_cast<int>(lod[blockIdx.x]);
+  const int seq_len = static_cast<int>(lod[blockIdx.x + 1]) - start;
+  if (seq_len == 0) return;
+  x += start * tag_num;
+  alpha += start * tag_num;
+  track += start * tag_num;
+  path += start;
+  const int state_trans_base_idx = 2;
+
+  for (int i = threadIdx.x; i < tag_num; i += blockDim.x) {
+    alpha[i] = w[i] + x[i];
+  }
+  for (int k = 1; k < seq_len; ++k) {
+    __syncthreads();
+    for (int i = threadIdx.x; i < tag_num; i += blockDim.x) {
+      T max_score =
+          alpha[(k - 1) * tag_num] + w[state_trans_base_idx * tag_num + i];
+      int max_j = 0;
+      for (int j = 1; j < tag_num; ++j) {
+        T score = alpha[(k - 1) * tag_num + j] +
+                  w[(j + state_trans_base_idx) * tag_num + i];
+        if (score > max_score) {
+          max_score = score;
+          max_j = j;
+        }
+      }
+      alpha[k * tag_num + i] = max_score + x[k * tag_num + i];
+      track[k * tag_num + i] = max_j;
+    }
+  }
+  __syncthreads();
+
+  if (threadIdx.x == 0) {
+    const T* last_alpha = alpha + (seq_len - 1) * tag_num;
+    T max_score = last_alpha[0] + w[tag_num];
+    int max_i = 0;
+    for (int i = 1; i < tag_num; ++i) {
+      T score = last_alpha[i] + w[tag_num + i];
+      if (score > max_score) {
+        max_score = score;
+        max_i = i;
+      }
+    }
+    path[seq_len - 1] = max_i;
+    for (int k = seq_len - 1; k >= 1; --k) {
+      path[k - 1] = max_i = track[k * tag_num + max_i];
+    }
+  }
+
+  if (label) {
+    __syncthreads();
+    label += start;
+    for (int k = threadIdx.x; k < seq_len; k += blockDim.x) {
+      path[k] = label[k] == path[k] ? 1 : 0;
+    }
+  }
+}
+
+}  // namespace
+
+template <typename T>
+class CRFDecodingCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* emission_weights = ctx.Input<LoDTensor>("Emission");
+    auto* transition_weights = ctx.Input<Tensor>("Transition");
+    auto* label = ctx.Input<LoDTensor>("Label");
+    auto* decoded_path = ctx.Output<Tensor>("ViterbiPath");
+
+    PADDLE_ENFORCE_EQ(emission_weights->NumLevels(), 1UL,
+                      "The Input(Emission) should be a sequence.");
+    auto lod = emission_weights->lod();
+    PADDLE_ENFORCE(lod.size(), "Input(Emission) must be a sequence.");
+    if (label) {
+      PADDLE_ENFORCE_EQ(label->NumLevels(), 1UL,
+                        "The Input(Label) should be a sequence.");
+    }
+    const size_t level = 0;
+    const int seq_num = static_cast<int>(lod[level].size() - 1);
+    const int tag_num = static_cast<int>(emission_weights->dims()[1]);
+
+    auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
+    int64_t* path = decoded_path->mutable_data<int64_t>(ctx.GetPlace());
+    math::SetConstant<platform::CUDADeviceContext, int64_t>()(
+        dev_ctx, decoded_path, 0);
+    if (seq_num == 0) return;
+
+    Tensor alpha;
+    T* alpha_value =
+        alpha.mutable_data<T>(emission_weights->dims(), ctx.GetPlace());
+    Tensor track;
+    int* track_value =
+        track.mutable_data<int>(emission_weights->dims(), ctx.GetPlace());
+    ViterbiKernel<T><<<seq_num, NumThreads(tag_num), 0, dev_ctx.stream()>>>(
+        lod[level].CUDAData(ctx.GetPlace()), emission_weights->data<T>(),
+        transition_weights->data<T>(),
+        label ? label->data<int64_t>() : nullptr, tag_num, alpha_value,
+        track_value, path);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(crf_decoding, ops::CRFDecodingCUDAKernel<float>,
+                        ops::CRFDecodingCUDAKernel<double>);
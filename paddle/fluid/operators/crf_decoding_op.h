@@ -13,11 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <algorithm>
 #include <limits>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/jit_kernel.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/platform/for_range.h"
 
 namespace paddle {
 namespace operators {
@@ -45,13 +47,28 @@ class CRFDecodingOpKernel : public framework::OpKernel<T> {
     int64_t* path = decoded_path->mutable_data<int64_t>(platform::CPUPlace());
     math::SetConstant<DeviceContext, int64_t>()(
         ctx.template device_context<DeviceContext>(), decoded_path, 0);
-    for (size_t i = 0; i < seq_num; ++i) {
-      int start_pos = static_cast<int>(lod[level][i]);
-      int end_pos = static_cast<int>(lod[level][i + 1]);
-      Tensor decoded_path_one_seq = decoded_path->Slice(start_pos, end_pos);
-      Decode(emission_weights->Slice(start_pos, end_pos), *transition_weights,
-             &decoded_path_one_seq);
-    }
+    const size_t tag_num = emission_weights->dims()[1];
+    // The JIT kernel is fetched once, the kernel pool is not thread-safe.
+    const auto& ker = math::jitkernel::KernelPool::Instance()
+                          .template Get<math::jitkernel::CRFDecodeKernel<T>>(
+                              static_cast<int>(tag_num));
+    // The sequences are decoded independently by the intra-op thread pool.
+    platform::ParallelFor(
+        ctx.template device_context<DeviceContext>(),
+        static_cast<int64_t>(seq_num),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            int start_pos = static_cast<int>(lod[level][i]);
+            int end_pos = static_cast<int>(lod[level][i + 1]);
+            if (end_pos == start_pos) continue;
+            Tensor decoded_path_one_seq =
+                decoded_path->Slice(start_pos, end_pos);
+            Decode(emission_weights->Slice(start_pos, end_pos),
+                   *transition_weights, *ker, &decoded_path_one_seq);
+          }
+        },
+        emission_weights->numel() * static_cast<int64_t>(tag_num) /
+            static_cast<int64_t>(std::max<size_t>(seq_num, 1)));
 
     if (label) {
       PADDLE_ENFORCE_EQ(label->NumLevels(), 1UL,
@@ -66,6 +83,7 @@ class CRFDecodingOpKernel : public framework::OpKernel<T> {
 
  private:
   void Decode(const Tensor& emission_weights, const Tensor& transition_weights,
+              const math::jitkernel::CRFDecodeKernel<T>& ker,
               Tensor* decoded_path) const {
     auto emission_dims = emission_weights.dims();
     const size_t seq_len = emission_dims[0];
@@ -82,10 +100,7 @@ class CRFDecodingOpKernel : public framework::OpKernel<T> {
     Tensor track;
     int* track_value =
         track.mutable_data<int>(emission_dims, platform::CPUPlace());
-    const auto& ker = math::jitkernel::KernelPool::Instance()
-                          .template Get<math::jitkernel::CRFDecodeKernel<T>>(
-                              static_cast<int>(tag_num));
-    ker->Compute(static_cast<int>(seq_len), x, w, alpha_value, track_value);
+    ker.Compute(static_cast<int>(seq_len), x, w, alpha_value, track_value);
     T max_score = -std::numeric_limits<T>::max();
     int max_i = 0;
     for (size_t i = 0; i < tag_num; ++i) {
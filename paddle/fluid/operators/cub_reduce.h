@@ -18,6 +18,7 @@
 #include <cmath>
 #include <numeric>
 #include <set>
+#include <type_traits>
 #include <vector>
 
 #include <cub/cub.cuh>  // NOLINT
@@ -27,6 +28,43 @@
 namespace paddle {
 namespace operators {
 
+// The transforms applied to each element before it is reduced, fused into the
+// reduction so the transformed tensor is not materialized.
+template <typename T>
+struct IdentityFunctor {
+  HOSTDEVICE explicit inline IdentityFunctor() {}
+
+  HOSTDEVICE inline T operator()(const T& x) const { return x; }
+};
+
+template <typename T>
+struct DivideFunctor {
+  HOSTDEVICE explicit inline DivideFunctor(int n) : n_inv((T)(1.0 / n)) {}
+
+  HOSTDEVICE inline T operator()(const T& x) const { return x * n_inv; }
+
+ private:
+  T n_inv;
+};
+
+template <typename T>
+struct AbsFunctor {
+  HOSTDEVICE inline T operator()(const T& x) const { return x < 0 ? -x : x; }
+};
+
+template <typename T>
+struct SquareFunctor {
+  HOSTDEVICE inline T operator()(const T& x) const { return x * x; }
+};
+
+// cub has Sum, Max and Min, but no product.
+struct CustomMul {
+  template <typename T>
+  __device__ __forceinline__ T operator()(const T& a, const T& b) const {
+    return a * b;
+  }
+};
+
 namespace detail {
 template <typename T, size_t ElementCount>
 struct Array {
@@ -122,6 +160,16 @@ __global__ void ReduceKernel(const Tx* x, Ty* y, ReduceOp reducer,
   }
 }
 
+// y = transformer(x) if nothing is reduced.
+template <typename Tx, typename Ty, typename TransformOp>
+__global__ void TransformKernel(const Tx* x, Ty* y, TransformOp transformer,
+                                int n) {
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += blockDim.x * gridDim.x) {
+    y[i] = static_cast<Ty>(transformer(x[i]));
+  }
+}
+
 static inline std::vector<int> GetStrides(const std::vector<int>& dims) {
   int n = static_cast<int>(dims.size());
   if (n == 0) return std::vector<int>();
@@ -256,7 +304,7 @@ void TensorReduce(const framework::Tensor& x, framework::Tensor* y,
   int is_reduced = 0;
   for (auto e : origin_reduce_dims) {
     auto pos = e >= 0 ? e : e + x_dim.size();
-    is_reduced |= 1 << e;
+    is_reduced |= 1 << pos;
   }
   for (int i = 0; i < x_dim.size(); i++) {
     if ((i == 0) || (((is_reduced >> i) ^ (is_reduced >> (i - 1))) & 1)) {
@@ -295,9 +343,17 @@ void TensorReduce(const framework::Tensor& x, framework::Tensor* y,
   auto x_data = x.data<Tx>();
   auto y_data = y->mutable_data<Ty>(x.place());
   if (reduce_num == 1) {
-    auto out_dims = y->dims();
-    framework::TensorCopy(x, y->place(), y);
-    y->Resize(out_dims);
+    if (std::is_same<Tx, Ty>::value &&
+        std::is_same<TransformOp, IdentityFunctor<Tx>>::value) {
+      auto out_dims = y->dims();
+      framework::TensorCopy(x, y->place(), y);
+      y->Resize(out_dims);
+    } else {
+      const int block = 256;
+      int grid = std::min((left_num + block - 1) / block, 4096);
+      detail::TransformKernel<Tx, Ty, TransformOp><<<grid, block, 0, stream>>>(
+          x_data, y_data, transformer, left_num);
+    }
     return;
   }
 
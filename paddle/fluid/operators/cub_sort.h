@@ -0,0 +1,111 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <limits>
+#include <cub/cub.cuh>  // NOLINT
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+
+namespace detail {
+template <typename IndexT>
+__global__ void SegmentOffsetsKernel(IndexT* offsets, int n,
+                                     IndexT segment_size) {
+  int i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i < n) {
+    offsets[i] = i * segment_size;
+  }
+}
+
+// ids[i] = i % segment_size, the index of every element in its segment
+template <typename IndexT>
+__global__ void SegmentIndicesKernel(IndexT* ids, int n, int segment_size) {
+  int i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i < n) {
+    ids[i] = i % segment_size;
+  }
+}
+}  // namespace detail
+
+/*
+ * Sort num_segments contiguous segments of segment_size keys each by the
+ * radix sort of cub, ascending or descending, and permute the values with
+ * their keys. One segment is sorted by the device-wide sort, which is much
+ * faster for the long rows than sorting a segment by one block.
+ */
+template <typename KeyT, typename ValueT>
+void SegmentedSortPairs(const platform::CUDADeviceContext& ctx,
+                        const KeyT* keys_in, KeyT* keys_out,
+                        const ValueT* values_in, ValueT* values_out,
+                        int64_t num_segments, int64_t segment_size,
+                        bool descending) {
+  const int64_t num_items = num_segments * segment_size;
+  PADDLE_ENFORCE_LE(num_items, std::numeric_limits<int>::max(),
+                    "Too many items to sort by cub.");
+  if (num_items == 0) {
+    return;
+  }
+  auto stream = ctx.stream();
+  const int kThreads = 256;
+  framework::Tensor offsets_t;
+  int* offsets = nullptr;
+  if (num_segments > 1) {
+    offsets = offsets_t.mutable_data<int>(
+        framework::make_ddim({num_segments + 1}), ctx.GetPlace());
+    detail::SegmentOffsetsKernel<int><<<
+        (num_segments + kThreads) / kThreads, kThreads, 0, stream>>>(
+        offsets, static_cast<int>(num_segments + 1),
+        static_cast<int>(segment_size));
+  }
+
+  // the first call only gets the size of the temporary storage
+  auto sort = [&](void* temp_storage, size_t* temp_storage_bytes) {
+    const int n = static_cast<int>(num_items);
+    const int end_bit = sizeof(KeyT) * 8;
+    if (num_segments > 1 && descending) {
+      cub::DeviceSegmentedRadixSort::SortPairsDescending(
+          temp_storage, *temp_storage_bytes, keys_in, keys_out, values_in,
+          values_out, n, static_cast<int>(num_segments), offsets, offsets + 1,
+          0, end_bit, stream);
+    } else if (num_segments > 1) {
+      cub::DeviceSegmentedRadixSort::SortPairs(
+          temp_storage, *temp_storage_bytes, keys_in, keys_out, values_in,
+          values_out, n, static_cast<int>(num_segments), offsets, offsets + 1,
+          0, end_bit, stream);
+    } else if (descending) {
+      cub::DeviceRadixSort::SortPairsDescending(
+          temp_storage, *temp_storage_bytes, keys_in, keys_out, values_in,
+          values_out, n, 0, end_bit, stream);
+    } else {
+      cub::DeviceRadixSort::SortPairs(temp_storage, *temp_storage_bytes,
+                                      keys_in, keys_out, values_in, values_out,
+                                      n, 0, end_bit, stream);
+    }
+  };
+  size_t temp_storage_bytes = 0;
+  sort(nullptr, &temp_storage_bytes);
+  framework::Tensor tmp;
+  auto* temp_storage = tmp.mutable_data<uint8_t>(
+      framework::make_ddim({static_cast<int64_t>(temp_storage_bytes)}),
+      ctx.GetPlace());
+  sort(temp_storage, &temp_storage_bytes);
+}
+
+}  // namespace operators
+}  // namespace paddle
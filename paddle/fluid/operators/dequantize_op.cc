@@ -0,0 +1,90 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <string>
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace operators {
+
+using framework::Tensor;
+
+template <typename T>
+class DequantizeKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* input = ctx.Input<Tensor>("Input");
+    auto* output = ctx.Output<Tensor>("Output");
+    float scale = ctx.Attr<float>("Scale");
+    PADDLE_ENFORCE_GT(scale, 0.0f, "The scale of DequantizeOp should be > 0");
+    const T* input_data = input->data<T>();
+    float* output_data = output->mutable_data<float>(ctx.GetPlace());
+    float reciprocal = 1.0f / scale;
+    for (int64_t i = 0; i < input->numel(); ++i) {
+      output_data[i] = static_cast<float>(input_data[i]) * reciprocal;
+    }
+  }
+};
+
+class DequantizeOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("Input"),
+                   "Input(Input) of DequantizeOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Output"),
+                   "Output(Output) of DequantizeOp should not be null.");
+
+    ctx->ShareDim("Input", /*->*/ "Output");
+    ctx->ShareLoD("Input", /*->*/ "Output");
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        framework::ToDataType(ctx.Input<Tensor>("Input")->type()),
+        ctx.GetPlace());
+  }
+};
+
+class DequantizeOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Input", "(Tensor) The INT8 or UINT8 tensor to be dequantized.");
+    AddOutput("Output", "(Tensor) The dequantized FP32 tensor.");
+    AddAttr<float>("Scale", "(float) The scale the Input is quantized with.")
+        .SetDefault(1.0f);
+    AddComment(R"DOC(
+DequantizeOp operator.
+
+It dequantizes the INT8 or UINT8 outputs of the quantized operators back to
+FP32, the opposite of QuantizeOp:
+
+$$Output = \frac{Input}{Scale}$$
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+
+REGISTER_OPERATOR(dequantize, ops::DequantizeOp, ops::DequantizeOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OP_CPU_KERNEL(dequantize, ops::DequantizeKernel<uint8_t>,
+                       ops::DequantizeKernel<int8_t>);
@@ -16,7 +16,14 @@
 
 #ifdef PADDLE_WITH_DISTRIBUTE
 
-#ifdef PADDLE_WITH_GRPC
+#if defined(PADDLE_WITH_VERBS)
+
+#include "paddle/fluid/operators/distributed/verbs_client.h"
+#include "paddle/fluid/operators/distributed/verbs_server.h"
+#define RPCSERVER_T paddle::operators::distributed::AsyncVerbsServer
+#define RPCCLIENT_T paddle::operators::distributed::VerbsClient
+
+#elif defined(PADDLE_WITH_GRPC)
 
 #include "paddle/fluid/operators/distributed/grpc_client.h"
 #include "paddle/fluid/operators/distributed/grpc_server.h"
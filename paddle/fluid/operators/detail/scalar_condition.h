@@ -0,0 +1,73 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#ifdef PADDLE_WITH_CUDA
+#include <thread>  // NOLINT
+#endif
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/enforce.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/fluid/platform/gpu_info.h"
+#endif
+
+namespace paddle {
+namespace operators {
+namespace detail {
+
+/**
+ * Read the bool scalar condition of the control flow ops on the host.
+ *
+ * A condition on the GPU is copied to pinned memory asynchronously on the
+ * stream of its device context, and only the event recorded after the copy
+ * is polled. The stream is not synchronized, so the work issued to it by
+ * other threads, and the copies on the other streams keep going.
+ */
+inline bool ReadScalarCondition(const framework::LoDTensor& cond) {
+  PADDLE_ENFORCE(cond.IsInitialized(), "The condition is not initialized.");
+  PADDLE_ENFORCE_EQ(cond.numel(), 1, "The condition should be a scalar.");
+  if (!platform::is_gpu_place(cond.place())) {
+    return cond.data<bool>()[0];
+  }
+#ifdef PADDLE_WITH_CUDA
+  auto place = boost::get<platform::CUDAPlace>(cond.place());
+  auto* dev_ctx = static_cast<platform::CUDADeviceContext*>(
+      platform::DeviceContextPool::Instance().Get(place));
+  platform::CUDAPinnedPlace pinned_place;
+  auto* value = static_cast<bool*>(memory::Alloc(pinned_place, sizeof(bool)));
+  platform::SetDeviceId(place.device);
+  cudaEvent_t event;
+  PADDLE_ENFORCE(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+  platform::GpuMemcpyAsync(value, cond.data<bool>(), sizeof(bool),
+                           cudaMemcpyDeviceToHost, dev_ctx->stream());
+  PADDLE_ENFORCE(cudaEventRecord(event, dev_ctx->stream()));
+  cudaError_t status;
+  while ((status = cudaEventQuery(event)) == cudaErrorNotReady) {
+    std::this_thread::yield();
+  }
+  PADDLE_ENFORCE(status);
+  PADDLE_ENFORCE(cudaEventDestroy(event));
+  bool res = *value;
+  memory::Free(pinned_place, value);
+  return res;
+#else
+  PADDLE_THROW("The condition is on the GPU, which is not compiled.");
+#endif
+}
+
+}  // namespace detail
+}  // namespace operators
+}  // namespace paddle
@@ -49,6 +49,9 @@ class AnchorGeneratorOp : public framework::OperatorWithKernel {
     ctx->SetOutputDim("Variances", framework::make_ddim(dim_vec));
   }
 
+  // The anchors only depend on the shape of the feature map.
+  bool IsShapeDeterministic() const override { return true; }
+
  protected:
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext& ctx) const override {
@@ -47,7 +47,7 @@ class BipartiteMatchOp : public framework::OperatorWithKernel {
       const framework::ExecutionContext& ctx) const override {
     return framework::OpKernelType(
         framework::ToDataType(ctx.Input<LoDTensor>("DistMat")->type()),
-        platform::CPUPlace());
+        ctx.GetPlace());
   }
 };
 
@@ -0,0 +1,198 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/math_function.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+using LoDTensor = framework::LoDTensor;
+
+namespace {
+
+// Must be a power of 2 for the tree reduction in BipartiteMatchKernel.
+int const kNumCUDAThreads = 512;
+
+// Finds the unmatched row of the largest distance to the j-th column, the
+// smallest row wins a tie. best_row is -1 if all the distances are 0.
+template <typename T>
+static __device__ inline void ColumnBestRow(const T *dist, const int *matched,
+                                            const int row, const int col,
+                                            const int j, int *best_row,
+                                            T *best_dist) {
+  const T kEPS = static_cast<T>(1e-6);
+  int max_row_idx = -1;
+  T max_dist = -1;
+  for (int m = 0; m < row; ++m) {
+    if (matched[m]) continue;
+    const T d = dist[m * col + j];
+    if (d >= kEPS && d > max_dist) {
+      max_row_idx = m;
+      max_dist = d;
+    }
+  }
+  *best_row = max_row_idx;
+  *best_dist = max_dist;
+}
+
+// One block matches one instance. Every column keeps its best unmatched
+// row, so an iteration of the greedy matching is a block-wide argmax over
+// the columns, and only the columns whose best row was just taken are
+// searched again. The pair of the largest distance is matched first, the
+// ties go to the smallest column, as the CPU kernel does.
+template <typename T>
+static __global__ void BipartiteMatchKernel(
+    const T *dist_data, const size_t *lod, const int col,
+    const bool per_prediction, const T threshold, int *col_best_row,
+    T *col_best_dist, int *row_matched, int *match_indices, T *match_dist) {
+  __shared__ T s_dist[kNumCUDAThreads];
+  __shared__ int s_col[kNumCUDAThreads];
+
+  const int tid = threadIdx.x;
+  const int ins = blockIdx.x;
+  const int row_begin = static_cast<int>(lod[ins]);
+  const int row = static_cast<int>(lod[ins + 1]) - row_begin;
+  const T *dist = dist_data + row_begin * col;
+  int *matched = row_matched + row_begin;
+  int *best_row = col_best_row + ins * col;
+  T *best_dist = col_best_dist + ins * col;
+  int *indices = match_indices + ins * col;
+  T *out_dist = match_dist + ins * col;
+
+  for (int m = tid; m < row; m += blockDim.x) matched[m] = 0;
+  __syncthreads();
+  for (int j = tid; j < col; j += blockDim.x) {
+    ColumnBestRow(dist, matched, row, col, j, best_row + j, best_dist + j);
+  }
+  __syncthreads();
+
+  for (int k = 0; k < row; ++k) {
+    T max_dist = -1;
+    int max_col = -1;
+    for (int j = tid; j < col; j += blockDim.x) {
+      if (indices[j] == -1 && best_row[j] != -1 && best_dist[j] > max_dist) {
+        max_col = j;
+        max_dist = best_dist[j];
+      }
+    }
+    s_dist[tid] = max_dist;
+    s_col[tid] = max_col;
+    __syncthreads();
+    for (int s = blockDim.x / 2; s > 0; s >>= 1) {
+      if (tid < s) {
+        const int other = tid + s;
+        if (s_col[other] != -1 &&
+            (s_col[tid] == -1 || s_dist[other] > s_dist[tid] ||
+             (s_dist[other] == s_dist[tid] && s_col[other] < s_col[tid]))) {
+          s_dist[tid] = s_dist[other];
+          s_col[tid] = s_col[other];
+        }
+      }
+      __syncthreads();
+    }
+    const int max_idx = s_col[0];
+    // Cannot find good match.
+    if (max_idx == -1) break;
+    const int max_row_idx = best_row[max_idx];
+    __syncthreads();
+    if (tid == 0) {
+      indices[max_idx] = max_row_idx;
+      out_dist[max_idx] = best_dist[max_idx];
+      matched[max_row_idx] = 1;
+    }
+    __syncthreads();
+    for (int j = tid; j < col; j += blockDim.x) {
+      if (indices[j] == -1 && best_row[j] == max_row_idx) {
+        ColumnBestRow(dist, matched, row, col, j, best_row + j, best_dist + j);
+      }
+    }
+    __syncthreads();
+  }
+
+  if (!per_prediction) return;
+  const T kEPS = static_cast<T>(1e-6);
+  for (int j = tid; j < col; j += blockDim.x) {
+    if (indices[j] != -1) continue;
+    int max_row_idx = -1;
+    T max_dist = -1;
+    for (int m = 0; m < row; ++m) {
+      const T d = dist[m * col + j];
+      if (d >= kEPS && d >= threshold && d > max_dist) {
+        max_row_idx = m;
+        max_dist = d;
+      }
+    }
+    if (max_row_idx != -1) {
+      indices[j] = max_row_idx;
+      out_dist[j] = max_dist;
+    }
+  }
+}
+
+}  // namespace
+
+template <typename T>
+class BipartiteMatchCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *dist_mat = context.Input<LoDTensor>("DistMat");
+    auto *match_indices = context.Output<Tensor>("ColToRowMatchIndices");
+    auto *match_dist = context.Output<Tensor>("ColToRowMatchDist");
+
+    auto &dev_ctx =
+        context.template device_context<platform::CUDADeviceContext>();
+
+    auto row = dist_mat->dims()[0];
+    auto col = dist_mat->dims()[1];
+
+    framework::Vector<size_t> lod({0, static_cast<size_t>(row)});
+    if (dist_mat->lod().size()) {
+      PADDLE_ENFORCE_EQ(dist_mat->lod().size(), 1UL,
+                        "Only support 1 level of LoD.");
+      lod = dist_mat->lod().back();
+    }
+    int64_t n = static_cast<int64_t>(lod.size() - 1);
+    match_indices->mutable_data<int>({n, col}, context.GetPlace());
+    match_dist->mutable_data<T>({n, col}, context.GetPlace());
+
+    math::SetConstant<platform::CUDADeviceContext, int> iset;
+    iset(dev_ctx, match_indices, static_cast<int>(-1));
+    math::SetConstant<platform::CUDADeviceContext, T> tset;
+    tset(dev_ctx, match_dist, static_cast<T>(0));
+    if (n == 0 || row == 0 || col == 0) return;
+
+    Tensor col_best_row, col_best_dist, row_matched;
+    col_best_row.mutable_data<int>({n, col}, context.GetPlace());
+    col_best_dist.mutable_data<T>({n, col}, context.GetPlace());
+    row_matched.mutable_data<int>({row}, context.GetPlace());
+
+    auto type = context.Attr<std::string>("match_type");
+    auto threshold = context.Attr<float>("dist_threshold");
+    BipartiteMatchKernel<T><<<n, kNumCUDAThreads, 0, dev_ctx.stream()>>>(
+        dist_mat->data<T>(), lod.CUDAData(context.GetPlace()), col,
+        type == "per_prediction", static_cast<T>(threshold),
+        col_best_row.data<int>(), col_best_dist.data<T>(),
+        row_matched.data<int>(), match_indices->data<int>(),
+        match_dist->data<T>());
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(bipartite_match, ops::BipartiteMatchCUDAKernel<float>,
+                        ops::BipartiteMatchCUDAKernel<double>);
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/detection/poly_util.h"
+#include "paddle/fluid/platform/for_range.h"
 
 namespace paddle {
 namespace operators {
@@ -62,10 +63,17 @@ class MultiClassNMSOp : public framework::OperatorWithKernel {
  protected:
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext& ctx) const override {
+    // The CUDA kernel only supports the rectangle boxes and the NMS without
+    // the adaptive threshold, the others run on CPU.
+    auto place = ctx.GetPlace();
+    if (ctx.Input<framework::LoDTensor>("BBoxes")->dims()[2] != 4 ||
+        ctx.Attr<float>("nms_eta") < 1.f) {
+      place = platform::CPUPlace();
+    }
     return framework::OpKernelType(
         framework::ToDataType(
             ctx.Input<framework::LoDTensor>("Scores")->type()),
-        platform::CPUPlace());
+        place);
   }
 };
 
@@ -111,26 +119,6 @@ static inline T BBoxArea(const T* box, const bool normalized) {
   }
 }
 
-template <class T>
-static inline T JaccardOverlap(const T* box1, const T* box2,
-                               const bool normalized) {
-  if (box2[0] > box1[2] || box2[2] < box1[0] || box2[1] > box1[3] ||
-      box2[3] < box1[1]) {
-    return static_cast<T>(0.);
-  } else {
-    const T inter_xmin = std::max(box1[0], box2[0]);
-    const T inter_ymin = std::max(box1[1], box2[1]);
-    const T inter_xmax = std::min(box1[2], box2[2]);
-    const T inter_ymax = std::min(box1[3], box2[3]);
-    const T inter_w = inter_xmax - inter_xmin;
-    const T inter_h = inter_ymax - inter_ymin;
-    const T inter_area = inter_w * inter_h;
-    const T bbox1_area = BBoxArea<T>(box1, normalized);
-    const T bbox2_area = BBoxArea<T>(box2, normalized);
-    return inter_area / (bbox1_area + bbox2_area - inter_area);
-  }
-}
-
 template <class T>
 T PolyIoU(const T* box1, const T* box2, const size_t box_size,
           const bool normalized) {
@@ -168,25 +156,54 @@ class MultiClassNMSKernel : public framework::OpKernel<T> {
     T adaptive_threshold = nms_threshold;
     const T* bbox_data = bbox.data<T>();
 
-    while (sorted_indices.size() != 0) {
-      const int idx = sorted_indices.front().second;
+    if (box_size == 4) {
+      // Keep the coordinates and the areas of the selected boxes in separate
+      // arrays, so that the overlaps of a box with all of them are computed
+      // by a loop without branches, which can be vectorized.
+      std::vector<T> xmin, ymin, xmax, ymax, area;
+      for (auto& pair : sorted_indices) {
+        const int idx = pair.second;
+        const T* box = bbox_data + idx * box_size;
+        const T box_area = BBoxArea<T>(box, true);
+        const size_t num_selected = area.size();
+        int suppressed = 0;
+        for (size_t k = 0; k < num_selected; ++k) {
+          const bool disjoint = xmin[k] > box[2] || xmax[k] < box[0] ||
+                                ymin[k] > box[3] || ymax[k] < box[1];
+          const T inter_w =
+              std::min(box[2], xmax[k]) - std::max(box[0], xmin[k]);
+          const T inter_h =
+              std::min(box[3], ymax[k]) - std::max(box[1], ymin[k]);
+          const T inter_area = inter_w * inter_h;
+          const T overlap =
+              disjoint ? static_cast<T>(0.)
+                       : inter_area / (box_area + area[k] - inter_area);
+          suppressed |= !(overlap <= adaptive_threshold);
+        }
+        if (suppressed) continue;
+        selected_indices->push_back(idx);
+        xmin.push_back(box[0]);
+        ymin.push_back(box[1]);
+        xmax.push_back(box[2]);
+        ymax.push_back(box[3]);
+        area.push_back(box_area);
+        if (eta < 1 && adaptive_threshold > 0.5) {
+          adaptive_threshold *= eta;
+        }
+      }
+      return;
+    }
+
+    for (auto& pair : sorted_indices) {
+      const int idx = pair.second;
       bool keep = true;
       for (size_t k = 0; k < selected_indices->size(); ++k) {
         if (keep) {
           const int kept_idx = (*selected_indices)[k];
-          T overlap = T(0.);
-          // 4: [xmin ymin xmax ymax]
-          if (box_size == 4) {
-            overlap = JaccardOverlap<T>(bbox_data + idx * box_size,
-                                        bbox_data + kept_idx * box_size, true);
-          }
           // 8: [x1 y1 x2 y2 x3 y3 x4 y4] or 16, 24, 32
-          if (box_size == 8 || box_size == 16 || box_size == 24 ||
-              box_size == 32) {
-            overlap =
-                PolyIoU<T>(bbox_data + idx * box_size,
-                           bbox_data + kept_idx * box_size, box_size, true);
-          }
+          T overlap =
+              PolyIoU<T>(bbox_data + idx * box_size,
+                         bbox_data + kept_idx * box_size, box_size, true);
           keep = overlap <= adaptive_threshold;
         } else {
           break;
@@ -195,7 +212,6 @@ class MultiClassNMSKernel : public framework::OpKernel<T> {
       if (keep) {
         selected_indices->push_back(idx);
       }
-      sorted_indices.erase(sorted_indices.begin());
       if (keep && eta < 1 && adaptive_threshold > 0.5) {
         adaptive_threshold *= eta;
       }
@@ -215,13 +231,24 @@ class MultiClassNMSKernel : public framework::OpKernel<T> {
 
     int64_t class_num = scores.dims()[0];
     int64_t predict_dim = scores.dims()[1];
+    // The classes are independent, so they run in parallel.
+    std::vector<std::vector<int>> class_indices(class_num);
+    platform::ParallelFor(
+        ctx.template device_context<platform::CPUDeviceContext>(), class_num,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t c = begin; c < end; ++c) {
+            if (c == background_label) continue;
+            Tensor score = scores.Slice(c, c + 1);
+            NMSFast(bboxes, score, score_threshold, nms_threshold, nms_eta,
+                    nms_top_k, &class_indices[c]);
+          }
+        },
+        predict_dim);
     int num_det = 0;
     for (int64_t c = 0; c < class_num; ++c) {
       if (c == background_label) continue;
-      Tensor score = scores.Slice(c, c + 1);
-      NMSFast(bboxes, score, score_threshold, nms_threshold, nms_eta, nms_top_k,
-              &((*indices)[c]));
-      num_det += (*indices)[c].size();
+      num_det += class_indices[c].size();
+      (*indices)[c] = std::move(class_indices[c]);
     }
 
     *num_nmsed_out = num_det;
@@ -0,0 +1,455 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <vector>
+#include "cub/cub.cuh"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/operators/math/math_function.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+using LoDTensor = framework::LoDTensor;
+
+namespace {
+
+#define DIVUP(m, n) ((m) / (n) + ((m) % (n) > 0))
+#define CUDA_1D_KERNEL_LOOP(i, n)                              \
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < (n); \
+       i += blockDim.x * gridDim.x)
+
+int const kThreadsPerBlock = sizeof(uint64_t) * 8;
+int const kNumCUDAThreads = 512;
+int const kNumMaxinumBlocks = 4096;
+int const kMaxGridZ = 65535;
+
+static inline int NumBlocks(const int n) {
+  return std::min(DIVUP(n, kNumCUDAThreads), kNumMaxinumBlocks);
+}
+
+// The same overlap of the normalized boxes as the CPU kernel computes.
+template <typename T>
+static __device__ inline T BBoxArea(const T *box) {
+  if (box[2] < box[0] || box[3] < box[1]) return static_cast<T>(0.);
+  return (box[2] - box[0]) * (box[3] - box[1]);
+}
+
+template <typename T>
+static __device__ inline T JaccardOverlap(const T *box1, const T *box2) {
+  if (box2[0] > box1[2] || box2[2] < box1[0] || box2[1] > box1[3] ||
+      box2[3] < box1[1]) {
+    return static_cast<T>(0.);
+  }
+  const T inter_xmin = box1[0] < box2[0] ? box2[0] : box1[0];
+  const T inter_ymin = box1[1] < box2[1] ? box2[1] : box1[1];
+  const T inter_xmax = box2[2] < box1[2] ? box2[2] : box1[2];
+  const T inter_ymax = box2[3] < box1[3] ? box2[3] : box1[3];
+  const T inter_area = (inter_xmax - inter_xmin) * (inter_ymax - inter_ymin);
+  return inter_area / (BBoxArea(box1) + BBoxArea(box2) - inter_area);
+}
+
+// A segment is the scores of a class of an image, and the index of a score
+// is the box in the image.
+static __global__ void InitSegmentsKernel(const int num_scores,
+                                          const int num_segments,
+                                          const int segment_size, int *index,
+                                          int *offsets) {
+  CUDA_1D_KERNEL_LOOP(i, num_scores) { index[i] = i % segment_size; }
+  CUDA_1D_KERNEL_LOOP(i, num_segments + 1) { offsets[i] = i * segment_size; }
+}
+
+template <typename T>
+static void SortSegmentsDescending(const platform::CUDADeviceContext &ctx,
+                                   const T *keys_in, const int *values_in,
+                                   const int num_items, const int num_segments,
+                                   const int *offsets, T *keys_out,
+                                   int *values_out) {
+  size_t temp_storage_bytes = 0;
+  PADDLE_ENFORCE(cub::DeviceSegmentedRadixSort::SortPairsDescending<T, int>(
+      nullptr, temp_storage_bytes, keys_in, keys_out, values_in, values_out,
+      num_items, num_segments, offsets, offsets + 1, 0, sizeof(T) * 8,
+      ctx.stream()));
+  Tensor temp_storage;
+  void *d_temp_storage = temp_storage.mutable_data<uint8_t>(
+      {static_cast<int64_t>(std::max<size_t>(temp_storage_bytes, 1))},
+      ctx.GetPlace());
+  PADDLE_ENFORCE(cub::DeviceSegmentedRadixSort::SortPairsDescending<T, int>(
+      d_temp_storage, temp_storage_bytes, keys_in, keys_out, values_in,
+      values_out, num_items, num_segments, offsets, offsets + 1, 0,
+      sizeof(T) * 8, ctx.stream()));
+}
+
+// The candidates of a class are its boxes with the scores larger than the
+// threshold, at most top_k of them.
+template <typename T>
+static __global__ void CountCandidatesKernel(
+    const T *sorted_scores, const int num_segments, const int segment_size,
+    const T threshold, const int top_k, const int num_classes,
+    const int background_label, int *counts) {
+  CUDA_1D_KERNEL_LOOP(s, num_segments) {
+    const T *scores = sorted_scores + s * segment_size;
+    int lo = 0, hi = segment_size;
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      if (scores[mid] > threshold) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    if (top_k > -1 && lo > top_k) lo = top_k;
+    counts[s] = s % num_classes == background_label ? 0 : lo;
+  }
+}
+
+template <typename T>
+static __global__ void GatherCandidateBoxesKernel(
+    const T *boxes, const int *sorted_index, const int *counts,
+    const int num_segments, const int segment_size, const int num_classes,
+    const int max_count, T *candidate_boxes) {
+  CUDA_1D_KERNEL_LOOP(i, num_segments * max_count) {
+    const int s = i / max_count;
+    if (i % max_count >= counts[s]) continue;
+    const int n = s / num_classes;
+    const T *box = boxes + (n * segment_size +
+                            sorted_index[s * segment_size + i % max_count]) *
+                               4;
+    for (int j = 0; j < 4; ++j) {
+      candidate_boxes[i * 4 + j] = box[j];
+    }
+  }
+}
+
+// The bit j of the row i of the mask is set if the candidate j is suppressed
+// by the candidate i.
+template <typename T>
+static __global__ void NMSMaskKernel(const T *candidate_boxes,
+                                     const int *counts, const int num_segments,
+                                     const int max_count,
+                                     const T nms_threshold, uint64_t *mask) {
+  const int row_start = blockIdx.y;
+  const int col_start = blockIdx.x;
+  // Only the blocks on and above the diagonal are read by the reduction.
+  if (col_start < row_start) return;
+  const int col_blocks = DIVUP(max_count, kThreadsPerBlock);
+
+  __shared__ T block_boxes[kThreadsPerBlock * 4];
+  for (int s = blockIdx.z; s < num_segments; s += gridDim.z) {
+    const int count = counts[s];
+    const int row_size =
+        min(count - row_start * kThreadsPerBlock, kThreadsPerBlock);
+    const int col_size =
+        min(count - col_start * kThreadsPerBlock, kThreadsPerBlock);
+    if (row_size <= 0 || col_size <= 0) continue;
+    const T *segment_boxes = candidate_boxes + s * max_count * 4;
+
+    __syncthreads();
+    if (threadIdx.x < col_size) {
+      for (int j = 0; j < 4; ++j) {
+        block_boxes[threadIdx.x * 4 + j] =
+            segment_boxes[(kThreadsPerBlock * col_start + threadIdx.x) * 4 +
+                          j];
+      }
+    }
+    __syncthreads();
+
+    if (threadIdx.x < row_size) {
+      const int cur_box_idx = kThreadsPerBlock * row_start + threadIdx.x;
+      const T *cur_box = segment_boxes + cur_box_idx * 4;
+      uint64_t t = 0;
+      int start = row_start == col_start ? threadIdx.x + 1 : 0;
+      for (int i = start; i < col_size; i++) {
+        if (!(JaccardOverlap(block_boxes + i * 4, cur_box) <= nms_threshold)) {
+          t |= 1ULL << i;
+        }
+      }
+      mask[(s * max_count + cur_box_idx) * col_blocks + col_start] = t;
+    }
+  }
+}
+
+// Each block greedily selects the candidates of a segment in the order of
+// the scores, where the threads OR the mask rows of the selected candidates
+// in parallel.
+static __global__ void NMSReduceKernel(const uint64_t *mask, const int *counts,
+                                       const int max_count, uint64_t *removed,
+                                       int *kept, int *num_kept) {
+  const int s = blockIdx.x;
+  const int count = counts[s];
+  const int col_blocks = DIVUP(max_count, kThreadsPerBlock);
+  const int segment_col_blocks = DIVUP(count, kThreadsPerBlock);
+  uint64_t *remv = removed + s * col_blocks;
+  for (int j = threadIdx.x; j < segment_col_blocks; j += blockDim.x) {
+    remv[j] = 0;
+  }
+
+  int num = 0;
+  for (int i = 0; i < count; ++i) {
+    __syncthreads();
+    const int nblock = i / kThreadsPerBlock;
+    const int inblock = i % kThreadsPerBlock;
+    // The row i only sets the bits after i, so all the threads read the same
+    // bit even if the word is being updated.
+    if (remv[nblock] & (1ULL << inblock)) continue;
+    if (threadIdx.x == 0) kept[s * max_count + num] = i;
+    ++num;
+    const uint64_t *p = mask + (s * max_count + i) * col_blocks;
+    for (int j = nblock + threadIdx.x; j < segment_col_blocks;
+         j += blockDim.x) {
+      remv[j] |= p[j];
+    }
+  }
+  if (threadIdx.x == 0) num_kept[s] = num;
+}
+
+// Pack the kept candidates of all the segments, in the order of the
+// segments and then the scores.
+template <typename T>
+static __global__ void GatherKeptKernel(const T *sorted_scores,
+                                        const int *kept, const int *num_kept,
+                                        const int *kept_offsets,
+                                        const int num_segments,
+                                        const int segment_size,
+                                        const int max_count, T *kept_scores,
+                                        int *kept_index) {
+  CUDA_1D_KERNEL_LOOP(i, num_segments * max_count) {
+    const int s = i / max_count;
+    const int k = i % max_count;
+    if (k >= num_kept[s]) continue;
+    const int src = s * segment_size + kept[i];
+    kept_scores[kept_offsets[s] + k] = sorted_scores[src];
+    kept_index[kept_offsets[s] + k] = src;
+  }
+}
+
+static __global__ void IotaKernel(const int num, int *out) {
+  CUDA_1D_KERNEL_LOOP(i, num) { out[i] = i; }
+}
+
+// Each block marks the keep_top_k kept boxes with the largest scores of an
+// image.
+static __global__ void SelectTopKKernel(const int *sorted_pos,
+                                        const int *image_offsets,
+                                        const int keep_top_k, int *selected) {
+  const int begin = image_offsets[blockIdx.x];
+  const int end = image_offsets[blockIdx.x + 1];
+  for (int r = begin + threadIdx.x; r < end; r += blockDim.x) {
+    selected[sorted_pos[r]] = r - begin < keep_top_k;
+  }
+}
+
+template <typename T>
+static __global__ void WriteOutputKernel(
+    const T *boxes, const int *sorted_index, const T *kept_scores,
+    const int *kept_index, const int *selected, const int *out_pos,
+    const int num_kept, const int segment_size, const int num_classes,
+    T *out) {
+  CUDA_1D_KERNEL_LOOP(i, num_kept) {
+    if (!selected[i]) continue;
+    const int src = kept_index[i];
+    const int s = src / segment_size;
+    const int n = s / num_classes;
+    const T *box = boxes + (n * segment_size + sorted_index[src]) * 4;
+    T *row = out + out_pos[i] * 6;
+    row[0] = s % num_classes;  // label
+    row[1] = kept_scores[i];   // score
+    for (int j = 0; j < 4; ++j) {
+      row[2 + j] = box[j];
+    }
+  }
+}
+
+}  // namespace
+
+/*
+ * The NMS of all the classes of all the images runs at once. The scores of
+ * each class are sorted by a segmented radix sort, the IoU bitmask of its
+ * candidates is computed as generate_proposals does, and a block reduces the
+ * mask of each class on device. Only the numbers of the candidates and the
+ * kept boxes are copied to host, to size the buffers and the output.
+ */
+template <typename T>
+class MultiClassNMSCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &ctx) const override {
+    auto *boxes = ctx.Input<Tensor>("BBoxes");
+    auto *scores = ctx.Input<Tensor>("Scores");
+    auto *outs = ctx.Output<LoDTensor>("Out");
+    PADDLE_ENFORCE_EQ(boxes->dims()[2], 4,
+                      "The CUDA kernel only supports the rectangle boxes.");
+    PADDLE_ENFORCE_GE(ctx.Attr<float>("nms_eta"), 1.,
+                      "The CUDA kernel does not support the adaptive NMS.");
+    const int background_label = ctx.Attr<int>("background_label");
+    const int nms_top_k = ctx.Attr<int>("nms_top_k");
+    const int keep_top_k = ctx.Attr<int>("keep_top_k");
+    const T nms_threshold = static_cast<T>(ctx.Attr<float>("nms_threshold"));
+    const T score_threshold =
+        static_cast<T>(ctx.Attr<float>("score_threshold"));
+
+    auto &dev_ctx = ctx.cuda_device_context();
+    auto stream = dev_ctx.stream();
+    auto place = ctx.GetPlace();
+    const int batch_size = scores->dims()[0];
+    const int class_num = scores->dims()[1];
+    const int predict_dim = scores->dims()[2];
+    const int num_segments = batch_size * class_num;
+    const int num_scores = num_segments * predict_dim;
+
+    Tensor index_t, offsets_t, sorted_scores_t, sorted_index_t, counts_t;
+    int *index = index_t.mutable_data<int>({num_scores}, place);
+    int *offsets = offsets_t.mutable_data<int>({num_segments + 1}, place);
+    InitSegmentsKernel<<<NumBlocks(std::max(num_scores, num_segments + 1)),
+                         kNumCUDAThreads, 0, stream>>>(
+        num_scores, num_segments, predict_dim, index, offsets);
+    T *sorted_scores = sorted_scores_t.mutable_data<T>({num_scores}, place);
+    int *sorted_index = sorted_index_t.mutable_data<int>({num_scores}, place);
+    SortSegmentsDescending<T>(dev_ctx, scores->data<T>(), index, num_scores,
+                              num_segments, offsets, sorted_scores,
+                              sorted_index);
+
+    int *counts = counts_t.mutable_data<int>({num_segments}, place);
+    CountCandidatesKernel<T><<<NumBlocks(num_segments), kNumCUDAThreads, 0,
+                               stream>>>(sorted_scores, num_segments,
+                                         predict_dim, score_threshold,
+                                         nms_top_k, class_num,
+                                         background_label, counts);
+    std::vector<int> counts_vec;
+    framework::TensorToVector(counts_t, dev_ctx, &counts_vec);
+    dev_ctx.Wait();
+    const int max_count =
+        *std::max_element(counts_vec.begin(), counts_vec.end());
+
+    std::vector<size_t> batch_starts(batch_size + 1, 0);
+    if (max_count > 0) {
+      // The candidates of each segment take max_count slots.
+      const int col_blocks = DIVUP(max_count, kThreadsPerBlock);
+      Tensor candidate_boxes_t, mask_t, removed_t, kept_t, num_kept_t;
+      T *candidate_boxes = candidate_boxes_t.mutable_data<T>(
+          {num_segments * max_count, 4}, place);
+      GatherCandidateBoxesKernel<T><<<NumBlocks(num_segments * max_count),
+                                      kNumCUDAThreads, 0, stream>>>(
+          boxes->data<T>(), sorted_index, counts, num_segments, predict_dim,
+          class_num, max_count, candidate_boxes);
+
+      auto *mask = reinterpret_cast<uint64_t *>(mask_t.mutable_data<int64_t>(
+          {num_segments * max_count, col_blocks}, place));
+      dim3 blocks(col_blocks, col_blocks, std::min(num_segments, kMaxGridZ));
+      NMSMaskKernel<T><<<blocks, kThreadsPerBlock, 0, stream>>>(
+          candidate_boxes, counts, num_segments, max_count, nms_threshold,
+          mask);
+
+      auto *removed = reinterpret_cast<uint64_t *>(
+          removed_t.mutable_data<int64_t>({num_segments, col_blocks}, place));
+      int *kept = kept_t.mutable_data<int>({num_segments, max_count}, place);
+      int *num_kept = num_kept_t.mutable_data<int>({num_segments}, place);
+      NMSReduceKernel<<<num_segments, kThreadsPerBlock, 0, stream>>>(
+          mask, counts, max_count, removed, kept, num_kept);
+
+      std::vector<int> num_kept_vec;
+      framework::TensorToVector(num_kept_t, dev_ctx, &num_kept_vec);
+      dev_ctx.Wait();
+      std::vector<int> kept_offsets(num_segments + 1, 0);
+      for (int s = 0; s < num_segments; ++s) {
+        kept_offsets[s + 1] = kept_offsets[s] + num_kept_vec[s];
+      }
+      const int total_kept = kept_offsets.back();
+      std::vector<int> image_offsets(batch_size + 1);
+      bool truncated = false;
+      for (int n = 0; n <= batch_size; ++n) {
+        image_offsets[n] = kept_offsets[n * class_num];
+        if (n == 0) continue;
+        size_t num_det = image_offsets[n] - image_offsets[n - 1];
+        if (keep_top_k > -1 && num_det > static_cast<size_t>(keep_top_k)) {
+          num_det = keep_top_k;
+          truncated = true;
+        }
+        batch_starts[n] = batch_starts[n - 1] + num_det;
+      }
+
+      if (total_kept > 0) {
+        Tensor kept_offsets_t, kept_scores_t, kept_index_t, selected_t;
+        framework::TensorFromVector(kept_offsets, dev_ctx, &kept_offsets_t);
+        T *kept_scores = kept_scores_t.mutable_data<T>({total_kept}, place);
+        int *kept_index = kept_index_t.mutable_data<int>({total_kept}, place);
+        GatherKeptKernel<T><<<NumBlocks(num_segments * max_count),
+                              kNumCUDAThreads, 0, stream>>>(
+            sorted_scores, kept, num_kept, kept_offsets_t.data<int>(),
+            num_segments, predict_dim, max_count, kept_scores, kept_index);
+
+        // Keep the keep_top_k boxes of the largest scores in each image.
+        int *selected = selected_t.mutable_data<int>({total_kept}, place);
+        Tensor image_offsets_t, pos_t, sorted_kept_scores_t, sorted_pos_t;
+        if (truncated) {
+          framework::TensorFromVector(image_offsets, dev_ctx,
+                                      &image_offsets_t);
+          int *pos = pos_t.mutable_data<int>({total_kept}, place);
+          IotaKernel<<<NumBlocks(total_kept), kNumCUDAThreads, 0, stream>>>(
+              total_kept, pos);
+          T *sorted_kept_scores =
+              sorted_kept_scores_t.mutable_data<T>({total_kept}, place);
+          int *sorted_pos = sorted_pos_t.mutable_data<int>({total_kept}, place);
+          SortSegmentsDescending<T>(dev_ctx, kept_scores, pos, total_kept,
+                                    batch_size, image_offsets_t.data<int>(),
+                                    sorted_kept_scores, sorted_pos);
+          SelectTopKKernel<<<batch_size, kNumCUDAThreads, 0, stream>>>(
+              sorted_pos, image_offsets_t.data<int>(), keep_top_k, selected);
+        } else {
+          math::SetConstant<platform::CUDADeviceContext, int>()(
+              dev_ctx, &selected_t, 1);
+        }
+
+        Tensor out_pos_t;
+        int *out_pos = out_pos_t.mutable_data<int>({total_kept}, place);
+        size_t temp_storage_bytes = 0;
+        PADDLE_ENFORCE(cub::DeviceScan::ExclusiveSum(
+            nullptr, temp_storage_bytes, selected, out_pos, total_kept,
+            stream));
+        Tensor temp_storage;
+        void *d_temp_storage = temp_storage.mutable_data<uint8_t>(
+            {static_cast<int64_t>(std::max<size_t>(temp_storage_bytes, 1))},
+            place);
+        PADDLE_ENFORCE(cub::DeviceScan::ExclusiveSum(
+            d_temp_storage, temp_storage_bytes, selected, out_pos, total_kept,
+            stream));
+
+        T *out = outs->mutable_data<T>(
+            {static_cast<int64_t>(batch_starts.back()), 6}, place);
+        WriteOutputKernel<T><<<NumBlocks(total_kept), kNumCUDAThreads, 0,
+                               stream>>>(
+            boxes->data<T>(), sorted_index, kept_scores, kept_index, selected,
+            out_pos, total_kept, predict_dim, class_num, out);
+      }
+    }
+
+    if (batch_starts.back() == 0) {
+      outs->mutable_data<T>({1}, place);
+      math::SetConstant<platform::CUDADeviceContext, T>()(dev_ctx, outs,
+                                                          static_cast<T>(-1));
+    }
+
+    framework::LoD lod;
+    lod.emplace_back(batch_starts);
+    outs->set_lod(lod);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(multiclass_nms, ops::MultiClassNMSCUDAKernel<float>,
+                        ops::MultiClassNMSCUDAKernel<double>);
@@ -68,6 +68,9 @@ class PriorBoxOp : public framework::OperatorWithKernel {
     ctx->SetOutputDim("Variances", framework::make_ddim(dim_vec));
   }
 
+  // The boxes only depend on the shapes of the feature map and the image.
+  bool IsShapeDeterministic() const override { return true; }
+
  protected:
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext& ctx) const override {
@@ -50,7 +50,7 @@ bool BRPCClient::AsyncSendVar(const std::string& ep,
   const framework::Scope* p_scope = &scope;
   const auto ch_ptr = GetChannel(ep_val);
 
-  framework::AsyncIO(
+  framework::AsyncRPC(
       [var_name_val, p_ctx, ep_val, p_scope, time_out, ch_ptr, this] {
         auto ch_ctx = ch_ptr->Pop();
         brpc::Controller* cntl = new brpc::Controller();
@@ -95,7 +95,7 @@ bool BRPCClient::AsyncGetVar(const std::string& ep,
   const framework::Scope* p_scope = &scope;
   const auto ch = GetChannel(ep_val);
 
-  framework::AsyncIO(
+  framework::AsyncRPC(
       [var_name_val, ep_val, p_scope, p_ctx, time_out, ch, this] {});
 
   req_count_++;
@@ -116,8 +116,8 @@ bool BRPCClient::AsyncPrefetchVar(const std::string& ep,
   const framework::Scope* p_scope = &scope;
   const auto ch = GetChannel(ep_val);
 
-  framework::AsyncIO([in_var_name_val, out_var_name_val, ep_val, p_scope, p_ctx,
-                      time_out, ch, this] {});
+  framework::AsyncRPC([in_var_name_val, out_var_name_val, ep_val, p_scope,
+                       p_ctx, time_out, ch, this] {});
 
   req_count_++;
   return true;
@@ -0,0 +1,211 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/grad_compression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/platform/float16.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+GradientCompressor& GradientCompressor::Instance() {
+  static GradientCompressor compressor;
+  return compressor;
+}
+
+void GradientCompressor::SetCompressType(const std::string& varname,
+                                         CompressType type, float topk_ratio) {
+  if (type == CompressType::kTopK) {
+    PADDLE_ENFORCE(topk_ratio > 0.0f && topk_ratio <= 1.0f,
+                   "topk_ratio of %s should be in (0, 1], but got %f", varname,
+                   topk_ratio);
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto& setting = settings_[varname];
+  setting.type = type;
+  setting.topk_ratio = topk_ratio;
+}
+
+CompressType GradientCompressor::GetCompressType(
+    const std::string& varname) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = settings_.find(varname);
+  return it == settings_.end() ? CompressType::kNone : it->second.type;
+}
+
+void GradientCompressor::ClearResiduals() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (auto& pair : settings_) {
+    std::lock_guard<std::mutex> setting_guard(*pair.second.mutex);
+    pair.second.residual = framework::Tensor();
+  }
+}
+
+bool GradientCompressor::Compress(const std::string& varname,
+                                  const framework::Variable& var,
+                                  const platform::DeviceContext& ctx,
+                                  framework::Variable* out,
+                                  CompressType* type) {
+  Setting* setting = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = settings_.find(varname);
+    if (it == settings_.end() || it->second.type == CompressType::kNone) {
+      return false;
+    }
+    // The elements of an unordered_map are not moved by rehashing.
+    setting = &it->second;
+  }
+  if (!var.IsType<framework::LoDTensor>()) return false;
+  auto& tensor = var.Get<framework::LoDTensor>();
+  if (tensor.type() != typeid(float) || tensor.numel() == 0) return false;
+
+  framework::Tensor cpu_tensor;
+  const float* src = nullptr;
+  if (platform::is_cpu_place(tensor.place())) {
+    src = tensor.data<float>();
+  } else {
+    framework::TensorCopy(tensor, platform::CPUPlace(), ctx, &cpu_tensor);
+    ctx.Wait();
+    src = cpu_tensor.data<float>();
+  }
+  int64_t numel = tensor.numel();
+  platform::CPUPlace cpu;
+
+  if (setting->type == CompressType::kFP16) {
+    auto* out_tensor = out->GetMutable<framework::LoDTensor>();
+    out_tensor->Resize(tensor.dims());
+    out_tensor->set_lod(tensor.lod());
+    auto* dst = out_tensor->mutable_data<platform::float16>(cpu);
+    for (int64_t i = 0; i < numel; ++i) {
+      dst[i] = static_cast<platform::float16>(src[i]);
+    }
+    *type = CompressType::kFP16;
+    return true;
+  }
+
+  PADDLE_ENFORCE(setting->type == CompressType::kTopK);
+  std::lock_guard<std::mutex> guard(*setting->mutex);
+  auto& residual = setting->residual;
+  if (residual.numel() != numel) {
+    residual.Resize({numel});
+    std::memset(residual.mutable_data<float>(cpu), 0, numel * sizeof(float));
+  }
+  float* acc = residual.data<float>();
+  for (int64_t i = 0; i < numel; ++i) {
+    acc[i] += src[i];
+  }
+
+  int64_t k = static_cast<int64_t>(std::ceil(setting->topk_ratio * numel));
+  k = std::min(std::max<int64_t>(k, 1), numel);
+  std::vector<int64_t> indices(numel);
+  std::iota(indices.begin(), indices.end(), 0);
+  std::nth_element(indices.begin(), indices.begin() + k - 1, indices.end(),
+                   [acc](int64_t a, int64_t b) {
+                     return std::fabs(acc[a]) > std::fabs(acc[b]);
+                   });
+  indices.resize(k);
+  std::sort(indices.begin(), indices.end());
+
+  auto* slr = out->GetMutable<framework::SelectedRows>();
+  slr->set_height(numel);
+  auto* value = slr->mutable_value();
+  value->Resize({k, 1});
+  auto* value_data = value->mutable_data<float>(cpu);
+  for (int64_t i = 0; i < k; ++i) {
+    value_data[i] = acc[indices[i]];
+    // The sent elements leave the residual, the others are kept for the
+    // next step.
+    acc[indices[i]] = 0.0f;
+  }
+  slr->set_rows(framework::Vector<int64_t>(indices));
+  *type = CompressType::kTopK;
+  return true;
+}
+
+void DecompressVariable(CompressType type, const framework::Variable& var,
+                        const framework::DDim& dense_dims,
+                        const platform::DeviceContext& ctx,
+                        framework::Variable* out) {
+  platform::CPUPlace cpu;
+  auto* out_tensor = out->GetMutable<framework::LoDTensor>();
+  bool on_cpu = platform::is_cpu_place(ctx.GetPlace());
+  framework::LoDTensor cpu_out;
+  framework::LoDTensor* dst = on_cpu ? out_tensor : &cpu_out;
+  dst->Resize(dense_dims);
+  auto* dst_data = dst->mutable_data<float>(cpu);
+  int64_t numel = dst->numel();
+
+  switch (type) {
+    case CompressType::kFP16: {
+      auto& in = var.Get<framework::LoDTensor>();
+      PADDLE_ENFORCE_EQ(in.numel(), numel,
+                        "The received float16 tensor has wrong size.");
+      framework::Tensor cpu_in;
+      if (!platform::is_cpu_place(in.place())) {
+        framework::TensorCopySync(in, cpu, &cpu_in);
+      }
+      auto* src = platform::is_cpu_place(in.place())
+                      ? in.data<platform::float16>()
+                      : cpu_in.data<platform::float16>();
+      for (int64_t i = 0; i < numel; ++i) {
+        dst_data[i] = static_cast<float>(src[i]);
+      }
+      dst->set_lod(in.lod());
+      break;
+    }
+    case CompressType::kTopK: {
+      auto& slr = var.Get<framework::SelectedRows>();
+      PADDLE_ENFORCE_EQ(slr.height(), numel,
+                        "The height of the received top-k gradient should be "
+                        "the number of elements of the gradient.");
+      auto& value = slr.value();
+      framework::Tensor cpu_value;
+      if (!platform::is_cpu_place(value.place())) {
+        framework::TensorCopySync(value, cpu, &cpu_value);
+      }
+      auto* src = platform::is_cpu_place(value.place())
+                      ? value.data<float>()
+                      : cpu_value.data<float>();
+      auto& rows = slr.rows();
+      PADDLE_ENFORCE_EQ(static_cast<int64_t>(rows.size()), value.numel());
+      std::memset(dst_data, 0, numel * sizeof(float));
+      for (size_t i = 0; i < rows.size(); ++i) {
+        PADDLE_ENFORCE_LT(rows[i], numel);
+        dst_data[rows[i]] = src[i];
+      }
+      dst->set_lod(framework::LoD());
+      break;
+    }
+    default:
+      PADDLE_THROW("Unknown compress type %d", static_cast<int>(type));
+  }
+
+  if (!on_cpu) {
+    framework::TensorCopySync(cpu_out, ctx.GetPlace(), out_tensor);
+    out_tensor->set_lod(cpu_out.lod());
+  }
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,89 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
+#include "paddle/fluid/framework/ddim.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/variable.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// The values must be the same as sendrecv::CompressType.
+enum class CompressType {
+  kNone = 0,
+  // Send the gradient as float16.
+  kFP16 = 1,
+  // Send the k largest elements by magnitude as a SelectedRows, whose rows
+  // are the indices in the flattened gradient. The elements not sent are
+  // accumulated locally and added to the gradient of the next step.
+  kTopK = 2,
+};
+
+// The compression settings of the variables sent by this process. The
+// settings are keyed by the name of the sent variable and set by send_op.
+class GradientCompressor {
+ public:
+  static GradientCompressor& Instance();
+
+  void SetCompressType(const std::string& varname, CompressType type,
+                       float topk_ratio);
+
+  CompressType GetCompressType(const std::string& varname) const;
+
+  // Compress the dense float gradient var into out, which lives on CPU.
+  // Return false if var can not be compressed, e.g. it is not a float
+  // LoDTensor, then it should be sent as it is.
+  bool Compress(const std::string& varname, const framework::Variable& var,
+                const platform::DeviceContext& ctx, framework::Variable* out,
+                CompressType* type);
+
+  // Drop the accumulated residuals, only for testing.
+  void ClearResiduals();
+
+ private:
+  GradientCompressor() = default;
+
+  struct Setting {
+    CompressType type{CompressType::kNone};
+    float topk_ratio{0.0f};
+    // The residual of the top-k sparsification, guarded by mutex.
+    std::unique_ptr<std::mutex> mutex{new std::mutex};
+    framework::Tensor residual;
+  };
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Setting> settings_;
+};
+
+// Decompress the var received with the compression type into the dense
+// float LoDTensor out, on the place of ctx. dense_dims is the dims of the
+// original gradient.
+void DecompressVariable(CompressType type, const framework::Variable& var,
+                        const framework::DDim& dense_dims,
+                        const platform::DeviceContext& ctx,
+                        framework::Variable* out);
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,106 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/grad_compression.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+static void FillGradient(const std::vector<float>& values,
+                         framework::Variable* var) {
+  auto* tensor = var->GetMutable<framework::LoDTensor>();
+  tensor->Resize({static_cast<int64_t>(values.size())});
+  auto* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (size_t i = 0; i < values.size(); ++i) {
+    data[i] = values[i];
+  }
+}
+
+TEST(GradientCompressor, FP16) {
+  platform::CPUDeviceContext ctx;
+  auto& compressor = GradientCompressor::Instance();
+  compressor.SetCompressType("fp16_grad", CompressType::kFP16, 0.0f);
+
+  framework::Variable grad, compressed, decompressed;
+  FillGradient({0.5f, -1.25f, 3.0f, 0.0f}, &grad);
+  CompressType type;
+  ASSERT_TRUE(compressor.Compress("fp16_grad", grad, ctx, &compressed, &type));
+  EXPECT_EQ(type, CompressType::kFP16);
+  EXPECT_TRUE(compressed.Get<framework::LoDTensor>().type() ==
+              typeid(platform::float16));
+
+  DecompressVariable(type, compressed, framework::make_ddim({4}), ctx,
+                     &decompressed);
+  auto& out = decompressed.Get<framework::LoDTensor>();
+  auto& in = grad.Get<framework::LoDTensor>();
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(out.data<float>()[i], in.data<float>()[i]);
+  }
+}
+
+TEST(GradientCompressor, TopKWithResidual) {
+  platform::CPUDeviceContext ctx;
+  auto& compressor = GradientCompressor::Instance();
+  compressor.SetCompressType("topk_grad", CompressType::kTopK, 0.5f);
+
+  framework::Variable grad, compressed, decompressed;
+  FillGradient({0.1f, -4.0f, 0.2f, 3.0f}, &grad);
+  CompressType type;
+  ASSERT_TRUE(compressor.Compress("topk_grad", grad, ctx, &compressed, &type));
+  EXPECT_EQ(type, CompressType::kTopK);
+  auto& slr = compressed.Get<framework::SelectedRows>();
+  ASSERT_EQ(slr.rows().size(), 2UL);
+  EXPECT_EQ(slr.rows()[0], 1);
+  EXPECT_EQ(slr.rows()[1], 3);
+  EXPECT_EQ(slr.height(), 4);
+
+  DecompressVariable(type, compressed, framework::make_ddim({4}), ctx,
+                     &decompressed);
+  auto* out = decompressed.Get<framework::LoDTensor>().data<float>();
+  EXPECT_EQ(out[0], 0.0f);
+  EXPECT_EQ(out[1], -4.0f);
+  EXPECT_EQ(out[2], 0.0f);
+  EXPECT_EQ(out[3], 3.0f);
+
+  // The residuals of the elements not sent are added to the next gradient.
+  FillGradient({0.1f, 0.0f, 0.2f, 0.0f}, &grad);
+  framework::Variable compressed2;
+  ASSERT_TRUE(compressor.Compress("topk_grad", grad, ctx, &compressed2, &type));
+  auto& slr2 = compressed2.Get<framework::SelectedRows>();
+  ASSERT_EQ(slr2.rows().size(), 2UL);
+  EXPECT_EQ(slr2.rows()[0], 0);
+  EXPECT_EQ(slr2.rows()[1], 2);
+  EXPECT_FLOAT_EQ(slr2.value().data<float>()[0], 0.2f);
+  EXPECT_FLOAT_EQ(slr2.value().data<float>()[1], 0.4f);
+  compressor.ClearResiduals();
+}
+
+TEST(GradientCompressor, NotCompressed) {
+  platform::CPUDeviceContext ctx;
+  framework::Variable grad, compressed;
+  FillGradient({1.0f}, &grad);
+  CompressType type;
+  auto& compressor = GradientCompressor::Instance();
+  EXPECT_FALSE(
+      compressor.Compress("unknown_grad", grad, ctx, &compressed, &type));
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <sys/time.h>
+#include <algorithm>
 #include <limits>
 
 #include "glog/logging.h"  // For VLOG
@@ -22,6 +23,18 @@ limitations under the License. */
 #include "paddle/fluid/operators/distributed/request_handler.h"
 #include "paddle/fluid/platform/profiler.h"
 
+DEFINE_int64(rpc_send_batch_bytes, 0,
+             "the variables smaller than this bytes sent to the same "
+             "endpoint are coalesced into one request, 0 to disable it");
+DEFINE_int32(rpc_send_batch_delay_ms, 1,
+             "the longest milliseconds a coalesced variable waits to be sent");
+DEFINE_int32(rpc_client_cq_num, 1,
+             "the completion queues of the gRPC client, each is polled by a "
+             "thread");
+DEFINE_int32(rpc_client_channel_num, 1,
+             "the channels of the gRPC client to each endpoint, each has its "
+             "own TCP connection");
+
 namespace paddle {
 namespace operators {
 namespace distributed {
@@ -29,9 +42,17 @@ namespace distributed {
 void GRPCClient::InitImpl() { InitEventLoop(); }
 
 void GRPCClient::InitEventLoop() {
-  // start the client process thread
-  // TODO(wuyi): can make this in a threadpool
-  client_thread_.reset(new std::thread(std::bind(&GRPCClient::Proceed, this)));
+  // start the client process threads
+  PADDLE_ENFORCE_GT(FLAGS_rpc_client_cq_num, 0);
+  for (int i = 0; i < FLAGS_rpc_client_cq_num; ++i) {
+    cqs_.emplace_back(new grpc::CompletionQueue());
+    client_threads_.emplace_back(new std::thread(
+        std::bind(&GRPCClient::Proceed, this, cqs_.back().get())));
+  }
+  if (FLAGS_rpc_send_batch_bytes > 0) {
+    batch_thread_.reset(
+        new std::thread(std::bind(&GRPCClient::FlushBatchesLoop, this)));
+  }
 }
 
 void GRPCClient::SendComplete() {
@@ -49,7 +70,17 @@ void GRPCClient::SendComplete() {
 GRPCClient::~GRPCClient() {
   stopped_ = true;
   Wait();
-  cq_.Shutdown();
+  if (batch_thread_) {
+    {
+      std::lock_guard<std::mutex> lk(batch_mutex_);
+      batch_stopped_ = true;
+    }
+    batch_cond_.notify_all();
+    batch_thread_->join();
+  }
+  for (auto& cq : cqs_) {
+    cq->Shutdown();
+  }
   {
     std::lock_guard<std::mutex> guard(chan_mutex_);
     for (auto& it : channels_) {
@@ -57,7 +88,9 @@ GRPCClient::~GRPCClient() {
     }
     channels_.clear();
   }
-  client_thread_->join();
+  for (auto& thread : client_threads_) {
+    thread->join();
+  }
 }
 
 VarHandlePtr GRPCClient::AsyncSendVar(const std::string& ep,
@@ -69,27 +102,39 @@ VarHandlePtr GRPCClient::AsyncSendVar(const std::string& ep,
   const std::string ep_val = ep;
   const std::string var_name_val = var_name;
   const framework::Scope* p_scope = &scope;
-  const auto ch = GetChannel(ep_val);
-  SendProcessor* s = new SendProcessor(ch);
+  const auto ch = GetChannel(ep_val, var_name_val);
+  auto* cq = GetCompletionQueue(var_name_val);
   const std::string method = "SendRPC";
   VarHandlePtr h(new VarHandle(ep, method, var_name_val, p_ctx, p_scope));
-  s->Prepare(h, time_out);
 
-  framework::AsyncIO([var_name_val, p_scope, p_ctx, s, method, h, this] {
+  framework::AsyncRPC([ep_val, var_name_val, p_scope, p_ctx, ch, cq, method,
+                       h, time_out, this] {
     auto* var = p_scope->FindVar(var_name_val);
 
+    platform::RecordRPCEvent record_event(
+        method, p_ctx, ep_val,
+        platform::NextRPCFlowId(method, trainer_id_, var_name_val), true);
+
     ::grpc::ByteBuffer req;
     SerializeToByteBuffer(var_name_val, var, *p_ctx, &req, "", trainer_id_);
 
+    // the large variables are still sent alone, so they do not hold back
+    // the small ones
+    if (req.Length() < static_cast<size_t>(FLAGS_rpc_send_batch_bytes)) {
+      AppendToBatch(ep_val, h, &req, time_out);
+      return;
+    }
+
+    SendProcessor* s = new SendProcessor(ch);
+    s->Prepare(h, time_out);
+
     VLOG(3) << s->GetVarHandlePtr()->String() << " begin";
 
     // stub context
     s->response_call_back_ = nullptr;
 
-    platform::RecordRPCEvent record_event(method, p_ctx);
-
     auto call = s->stub_g_.PrepareUnaryCall(
-        s->context_.get(), "/sendrecv.SendRecvService/SendVariable", req, &cq_);
+        s->context_.get(), "/sendrecv.SendRecvService/SendVariable", req, cq);
     call->StartCall();
     call->Finish(&s->reply_, &s->status_, reinterpret_cast<void*>(s));
 
@@ -102,6 +147,72 @@ VarHandlePtr GRPCClient::AsyncSendVar(const std::string& ep,
   return h;
 }
 
+void GRPCClient::AppendToBatch(const std::string& ep, VarHandlePtr h,
+                               ::grpc::ByteBuffer* msg, int64_t time_out) {
+  std::lock_guard<std::mutex> lk(batch_mutex_);
+  auto& batch = batches_[ep];
+  if (batch.handles.empty()) {
+    batch.start = std::chrono::steady_clock::now();
+  }
+  batch.handles.push_back(h);
+  batch.bytes += msg->Length();
+  batch.msgs.emplace_back();
+  batch.msgs.back().Swap(msg);
+  batch.time_out = std::max(batch.time_out, time_out);
+  if (batch.bytes >= static_cast<size_t>(FLAGS_rpc_send_batch_bytes)) {
+    FlushBatch(ep, &batch);
+  }
+}
+
+void GRPCClient::FlushBatch(const std::string& ep, SendBatch* batch) {
+  if (batch->handles.empty()) return;
+  VLOG(3) << "send a batch of " << batch->handles.size() << " variables to "
+          << ep;
+
+  BatchSendProcessor* s = new BatchSendProcessor(GetChannel(ep));
+  s->Prepare(batch->handles, batch->time_out);
+
+  ::grpc::ByteBuffer req;
+  SerializeToBatchByteBuffer(batch->msgs, &req);
+
+  platform::RecordRPCEvent record_event("SendBatchRPC", nullptr);
+
+  {
+    // the variables of the batch are completed by one call
+    std::lock_guard<std::mutex> lk(sync_mutex_);
+    req_count_ -= static_cast<int64_t>(batch->handles.size()) - 1;
+  }
+
+  auto call = s->stub_g_.PrepareUnaryCall(
+      s->context_.get(), "/sendrecv.SendRecvService/SendVariables", req,
+      GetCompletionQueue(ep));
+  call->StartCall();
+  call->Finish(&s->reply_, &s->status_, reinterpret_cast<void*>(s));
+  *batch = SendBatch();
+}
+
+void GRPCClient::FlushBatches() {
+  std::lock_guard<std::mutex> lk(batch_mutex_);
+  for (auto& item : batches_) {
+    FlushBatch(item.first, &item.second);
+  }
+}
+
+void GRPCClient::FlushBatchesLoop() {
+  auto delay = std::chrono::milliseconds(FLAGS_rpc_send_batch_delay_ms);
+  std::unique_lock<std::mutex> lk(batch_mutex_);
+  while (!batch_stopped_) {
+    batch_cond_.wait_for(lk, delay);
+    auto now = std::chrono::steady_clock::now();
+    for (auto& item : batches_) {
+      auto& batch = item.second;
+      if (!batch.handles.empty() && now - batch.start >= delay) {
+        FlushBatch(item.first, &batch);
+      }
+    }
+  }
+}
+
 void ProcGetResponse(const VarHandle& var_h,
                      const ::grpc::ByteBuffer& ret_msg) {
   framework::Variable* outvar = nullptr;
@@ -128,13 +239,14 @@ VarHandlePtr GRPCClient::AsyncGetVar(const std::string& ep,
   const std::string ep_val = ep;
   const std::string var_name_val = var_name;
   const framework::Scope* p_scope = &scope;
-  const auto ch = GetChannel(ep_val);
+  const auto ch = GetChannel(ep_val, var_name_val);
+  auto* cq = GetCompletionQueue(var_name_val);
   GetProcessor* s = new GetProcessor(ch);
   const std::string method = "GetRPC";
   VarHandlePtr h(new VarHandle(ep, method, var_name_val, p_ctx, p_scope));
   s->Prepare(h, time_out);
 
-  framework::AsyncIO([var_name_val, s, method, p_ctx, h, this] {
+  framework::AsyncRPC([ep_val, var_name_val, s, cq, method, p_ctx, h, this] {
     // prepare input
     sendrecv::VariableMessage req;
     req.set_varname(var_name_val);
@@ -147,10 +259,12 @@ VarHandlePtr GRPCClient::AsyncGetVar(const std::string& ep,
     // stub context
     s->response_call_back_ = ProcGetResponse;
 
-    platform::RecordRPCEvent record_event(method, p_ctx);
+    platform::RecordRPCEvent record_event(
+        method, p_ctx, ep_val,
+        platform::NextRPCFlowId(method, trainer_id_, var_name_val), true);
 
     auto call = s->stub_g_.PrepareUnaryCall(
-        s->context_.get(), "/sendrecv.SendRecvService/GetVariable", buf, &cq_);
+        s->context_.get(), "/sendrecv.SendRecvService/GetVariable", buf, cq);
     call->StartCall();
     call->Finish(&s->reply_, &s->status_, reinterpret_cast<void*>(s));
 
@@ -175,7 +289,8 @@ VarHandlePtr GRPCClient::AsyncPrefetchVar(const std::string& ep,
   const std::string in_var_name_val = in_var_name;
   const std::string out_var_name_val = out_var_name;
   const framework::Scope* p_scope = &scope;
-  const auto ch = GetChannel(ep_val);
+  const auto ch = GetChannel(ep_val, in_var_name_val);
+  auto* cq = GetCompletionQueue(in_var_name_val);
   GetProcessor* s = new GetProcessor(ch);
 
   const std::string method = "PrefetchRPC";
@@ -183,8 +298,8 @@ VarHandlePtr GRPCClient::AsyncPrefetchVar(const std::string& ep,
   VarHandlePtr h(new VarHandle(ep, method, out_var_name_val, p_ctx, p_scope));
   s->Prepare(h, time_out);
 
-  framework::AsyncIO([in_var_name_val, out_var_name_val, ep_val, p_scope, p_ctx,
-                      s, method, h, this] {
+  framework::AsyncRPC([in_var_name_val, out_var_name_val, ep_val, p_scope,
+                       p_ctx, s, cq, method, h, this] {
     auto* var = p_scope->FindVar(in_var_name_val);
 
     ::grpc::ByteBuffer req;
@@ -199,7 +314,7 @@ VarHandlePtr GRPCClient::AsyncPrefetchVar(const std::string& ep,
 
     auto call = s->stub_g_.PrepareUnaryCall(
         s->context_.get(), "/sendrecv.SendRecvService/PrefetchVariable", req,
-        &cq_);
+        cq);
     call->StartCall();
     call->Finish(&s->reply_, &s->status_, static_cast<void*>(s));
 
@@ -224,10 +339,12 @@ VarHandlePtr GRPCClient::AsyncSendBatchBarrier(const std::string& ep,
 
   sendrecv::VariableMessage req;
   req.set_varname(BATCH_BARRIER_MESSAGE);
+  req.set_trainer_id(trainer_id_);
 
   platform::RecordRPCEvent record_event(method, nullptr);
 
-  auto rpc = s->stub_->AsyncSendVariable(s->context_.get(), req, &cq_);
+  auto rpc = s->stub_->AsyncSendVariable(s->context_.get(), req,
+                                         GetCompletionQueue(ep));
   rpc->Finish(&s->reply_, &s->status_, reinterpret_cast<void*>(s));
   req_count_++;
 
@@ -252,7 +369,8 @@ VarHandlePtr GRPCClient::AsyncSendFetchBarrier(const std::string& ep,
 
   platform::RecordRPCEvent record_event(method, nullptr);
 
-  auto rpc = s->stub_->AsyncGetVariable(s->context_.get(), req, &cq_);
+  auto rpc = s->stub_->AsyncGetVariable(s->context_.get(), req,
+                                        GetCompletionQueue(ep));
   rpc->Finish(&s->reply_, &s->status_, reinterpret_cast<void*>(s));
   req_count_++;
 
@@ -274,10 +392,12 @@ VarHandlePtr GRPCClient::AsyncSendComplete(const std::string& ep,
 
   sendrecv::VariableMessage req;
   req.set_varname(COMPLETE_MESSAGE);
+  req.set_trainer_id(trainer_id_);
 
   platform::RecordRPCEvent record_event(method, nullptr);
 
-  auto rpc = s->stub_->AsyncSendVariable(s->context_.get(), req, &cq_);
+  auto rpc = s->stub_->AsyncSendVariable(s->context_.get(), req,
+                                         GetCompletionQueue(ep));
   rpc->Finish(&s->reply_, &s->status_, reinterpret_cast<void*>(s));
   req_count_++;
 
@@ -307,7 +427,8 @@ VarHandlePtr GRPCClient::AsyncCheckpointNotify(const std::string& ep,
 
   platform::RecordRPCEvent record_event(method, nullptr);
 
-  auto rpc = s->stub_->AsyncCheckpointNotify(s->context_.get(), req, &cq_);
+  auto rpc = s->stub_->AsyncCheckpointNotify(s->context_.get(), req,
+                                             GetCompletionQueue(ep));
   rpc->Finish(&s->reply_, &s->status_, reinterpret_cast<void*>(s));
   req_count_++;
 
@@ -319,17 +440,18 @@ VarHandlePtr GRPCClient::AsyncCheckpointNotify(const std::string& ep,
 }
 
 bool GRPCClient::Wait() {
+  FlushBatches();
   std::unique_lock<std::mutex> lk(sync_mutex_);
   sync_cond_.wait(lk, [this] { return (req_count_ == 0 || ok_ == false); });
   return ok_;
 }
 
-void GRPCClient::Proceed() {
+void GRPCClient::Proceed(grpc::CompletionQueue* cq) {
   void* tag = nullptr;
   bool ok = false;
 
   VLOG(3) << "GRPCClient Proceed begin";
-  while (!stopped_ && cq_.Next(&tag, &ok)) {
+  while (!stopped_ && cq->Next(&tag, &ok)) {
     BaseProcessor* c = static_cast<BaseProcessor*>(tag);
     GPR_ASSERT(ok);
     PADDLE_ENFORCE(c);
@@ -373,24 +495,32 @@ void GRPCClient::Proceed() {
   VLOG(3) << "GRPCClient Proceed end";
 }
 
-std::shared_ptr<grpc::Channel> GRPCClient::GetChannel(const std::string& ep) {
+std::shared_ptr<grpc::Channel> GRPCClient::GetChannel(const std::string& ep,
+                                                      const std::string& key) {
   std::lock_guard<std::mutex> guard(chan_mutex_);
-  auto it = channels_.find(ep);
-  if (it != channels_.end()) {
-    return it->second;
+  auto& channels = channels_[ep];
+  if (channels.empty()) {
+    PADDLE_ENFORCE_GT(FLAGS_rpc_client_channel_num, 0);
+    for (int i = 0; i < FLAGS_rpc_client_channel_num; ++i) {
+      // Channel configurations:
+      grpc::ChannelArguments args;
+      args.SetInt(GRPC_ARG_MAX_RECONNECT_BACKOFF_MS, 2000);
+      args.SetCompressionAlgorithm(GRPC_COMPRESS_NONE);
+      args.SetMaxSendMessageSize(std::numeric_limits<int>::max());
+      args.SetMaxReceiveMessageSize(std::numeric_limits<int>::max());
+      // The channels of the different arguments do not share the TCP
+      // connection.
+      args.SetInt("paddle.channel_index", i);
+
+      channels.push_back(grpc::CreateCustomChannel(
+          ep, grpc::InsecureChannelCredentials(), args));
+    }
   }
+  return channels[std::hash<std::string>()(key) % channels.size()];
+}
 
-  // Channel configurations:
-  grpc::ChannelArguments args;
-  args.SetInt(GRPC_ARG_MAX_RECONNECT_BACKOFF_MS, 2000);
-  args.SetCompressionAlgorithm(GRPC_COMPRESS_NONE);
-  args.SetMaxSendMessageSize(std::numeric_limits<int>::max());
-  args.SetMaxReceiveMessageSize(std::numeric_limits<int>::max());
-
-  auto ch =
-      grpc::CreateCustomChannel(ep, grpc::InsecureChannelCredentials(), args);
-  channels_[ep] = ch;
-  return ch;
+grpc::CompletionQueue* GRPCClient::GetCompletionQueue(const std::string& key) {
+  return cqs_[std::hash<std::string>()(key) % cqs_.size()].get();
 }
 
 }  // namespace distributed
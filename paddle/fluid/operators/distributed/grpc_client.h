@@ -26,6 +26,7 @@ limitations under the License. */
 #include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
+#include <unordered_map>
 #include <vector>
 
 #include "grpc++/channel.h"
@@ -78,7 +79,7 @@ class BaseProcessor {
 
   VarHandlePtr GetVarHandlePtr() { return var_h_; }
   bool Wait() { return var_h_->Wait(); }
-  void Finish(bool ok) { return var_h_->Finish(ok); }
+  virtual void Finish(bool ok) { return var_h_->Finish(ok); }
   virtual void ProcessImpl() = 0;
 
   std::unique_ptr<grpc::ClientContext> context_;
@@ -109,6 +110,39 @@ class SendProcessor : public BaseProcessor {
   RequestSendCallBack response_call_back_ = nullptr;
 };
 
+// Sends the variables coalesced for an endpoint in one call, the first
+// handle is var_h_.
+class BatchSendProcessor : public BaseProcessor {
+ public:
+  explicit BatchSendProcessor(std::shared_ptr<grpc::Channel> ch)
+      : BaseProcessor(), stub_g_(ch) {}
+
+  virtual ~BatchSendProcessor() {}
+
+  void Prepare(const std::vector<VarHandlePtr>& handles, int64_t time_out) {
+    handles_ = handles;
+    BaseProcessor::Prepare(handles.front(), time_out);
+  }
+
+  void ProcessImpl() override {
+    for (size_t i = 1; i < handles_.size(); ++i) {
+      handles_[i]->Finish(true);
+    }
+  }
+
+  void Finish(bool ok) override {
+    for (auto& h : handles_) {
+      h->Finish(ok);
+    }
+  }
+
+  ::grpc::GenericStub stub_g_;
+  ::grpc::ByteBuffer reply_;
+
+ private:
+  std::vector<VarHandlePtr> handles_;
+};
+
 typedef std::function<void(const VarHandle&, const ::grpc::ByteBuffer&)>
     RequestGetCallBack;
 
@@ -174,7 +208,8 @@ class CheckpointNotifyProcessor : public BaseProcessor {
 
 class GRPCClient : public RPCClient {
  public:
-  GRPCClient() : ok_(true), completed_(false), stopped_(false) {}
+  GRPCClient()
+      : ok_(true), completed_(false), stopped_(false), batch_stopped_(false) {}
   virtual ~GRPCClient();
 
   VarHandlePtr AsyncSendVar(const std::string& ep,
@@ -220,14 +255,43 @@ class GRPCClient : public RPCClient {
   // InitEventLoop should only be called by Init()
   void InitEventLoop();
 
-  void Proceed();
+  void Proceed(grpc::CompletionQueue* cq);
 
-  std::shared_ptr<grpc::Channel> GetChannel(const std::string& ep);
+  // The channel to ep and the completion queue of the calls on the variable
+  // called key. The calls are routed by the hash of key, so the calls on a
+  // variable keep their order.
+  std::shared_ptr<grpc::Channel> GetChannel(const std::string& ep,
+                                            const std::string& key = "");
+  grpc::CompletionQueue* GetCompletionQueue(const std::string& key = "");
+
+  // The variables smaller than FLAGS_rpc_send_batch_bytes waiting to be
+  // sent to an endpoint in one call of SendVariables.
+  struct SendBatch {
+    std::vector<VarHandlePtr> handles;
+    std::vector<::grpc::ByteBuffer> msgs;
+    size_t bytes = 0;
+    int64_t time_out = 0;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  void AppendToBatch(const std::string& ep, VarHandlePtr h,
+                     ::grpc::ByteBuffer* msg, int64_t time_out);
+
+  // Send the batch of ep, batch_mutex_ should be held.
+  void FlushBatch(const std::string& ep, SendBatch* batch);
+
+  void FlushBatches();
+
+  // Flush the batches older than FLAGS_rpc_send_batch_delay_ms.
+  void FlushBatchesLoop();
 
  private:
-  grpc::CompletionQueue cq_;
-  std::unordered_map<std::string, std::shared_ptr<grpc::Channel>> channels_;
-  std::unique_ptr<std::thread> client_thread_;
+  // Each completion queue is polled by a thread.
+  std::vector<std::unique_ptr<grpc::CompletionQueue>> cqs_;
+  std::vector<std::unique_ptr<std::thread>> client_threads_;
+  // FLAGS_rpc_client_channel_num channels to each endpoint.
+  std::unordered_map<std::string, std::vector<std::shared_ptr<grpc::Channel>>>
+      channels_;
 
   // mutex for Wait client sync
   std::mutex sync_mutex_;
@@ -244,6 +308,12 @@ class GRPCClient : public RPCClient {
   bool completed_;
 
   volatile bool stopped_;
+
+  std::mutex batch_mutex_;
+  std::condition_variable batch_cond_;
+  std::unordered_map<std::string, SendBatch> batches_;
+  std::unique_ptr<std::thread> batch_thread_;
+  bool batch_stopped_;
 };
 
 }  // namespace distributed
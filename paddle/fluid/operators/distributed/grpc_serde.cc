@@ -16,11 +16,13 @@ limitations under the License. */
 #include <nccl.h>
 #endif
 #include <sys/time.h>
+#include <memory>
 #include <thread>  // NOLINT
 
 #include "google/protobuf/io/coded_stream.h"
 #include "google/protobuf/io/zero_copy_stream.h"
 #include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/operators/distributed/grad_compression.h"
 #include "paddle/fluid/operators/distributed/grpc_bytebuffer_stream.h"
 #include "paddle/fluid/operators/distributed/grpc_serde.h"
 #include "paddle/fluid/operators/distributed/grpc_variable_response.h"
@@ -32,6 +34,19 @@ namespace paddle {
 namespace operators {
 namespace distributed {
 
+// The CPU memory of the sent tensors is referenced by the slices without
+// copy. Each such slice owns a holder, which keeps the memory alive until
+// the slice is released by gRPC, even if the variable is changed or freed
+// after the call is issued.
+template <typename T>
+static void ReleaseHolder(void* holder) {
+  delete static_cast<T*>(holder);
+}
+
+// The compressed gradient is shared by the slices that reference it, and
+// released with the last one.
+using CompressedVarHolder = std::shared_ptr<framework::Variable>;
+
 void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
                            const platform::DeviceContext& ctx,
                            ::grpc::ByteBuffer* msg, const std::string& out_name,
@@ -60,12 +75,39 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
   if (!out_name.empty()) {
     request.set_out_varname(out_name);
   }
+
+  // Send the compressed gradient instead if it is configured by send_op.
+  // The compressed gradient is always on CPU.
+  CompressedVarHolder compressed;
+  const platform::DeviceContext* send_ctx = &ctx;
+  auto& compressor = GradientCompressor::Instance();
+  if (var->IsType<framework::LoDTensor>() &&
+      compressor.GetCompressType(name) != CompressType::kNone) {
+    compressed.reset(new framework::Variable);
+    CompressType compress_type;
+    if (compressor.Compress(name, *var, ctx, compressed.get(),
+                            &compress_type)) {
+      request.set_compress_type(
+          static_cast<::sendrecv::CompressType>(compress_type));
+      for (auto dim :
+           framework::vectorize(var->Get<framework::LoDTensor>().dims())) {
+        request.add_dense_dims(dim);
+      }
+      var = compressed.get();
+      send_ctx = platform::DeviceContextPool::Instance().Get(
+          platform::CPUPlace());
+    } else {
+      compressed.reset();
+    }
+  }
+
   if (var->IsType<framework::LoDTensor>()) {
     request.set_type(::sendrecv::LOD_TENSOR);
-    GetTensorPayload(var, ctx, &request, &payload, &payload_size);
+    GetTensorPayload(var, *send_ctx, &request, &payload, &payload_size);
   } else if (var->IsType<framework::SelectedRows>()) {
     request.set_type(::sendrecv::SELECTED_ROWS);
-    GetSelectedRowsPayload(var, ctx, &request, &payload, &payload_size);
+    GetSelectedRowsPayload(var, *send_ctx, &request, &payload,
+                           &payload_size);
 #ifdef PADDLE_WITH_CUDA
   } else if (var->IsType<ncclUniqueId>()) {
     request.set_type(::sendrecv::NCCL_ID);
@@ -75,7 +117,11 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
                  typeid(var->Type()).name());
   }
 
-  if (platform::is_gpu_place(ctx.GetPlace())) {
+  void* payload_user_data = payload;
+  if (compressed) {
+    payload_user_data = new CompressedVarHolder(compressed);
+    destroy_callback = ReleaseHolder<CompressedVarHolder>;
+  } else if (platform::is_gpu_place(ctx.GetPlace())) {
 #ifdef PADDLE_WITH_CUDA
     // GPU data is copied to CPU buffer when sending,
     // free the buffer when possible.
@@ -84,6 +130,15 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
       memory::Free(cuda_pinned, backing);
     };
 #endif
+  } else if (var->IsType<framework::LoDTensor>()) {
+    // The copy of the tensor shares the memory of the variable.
+    payload_user_data =
+        new framework::Tensor(var->Get<framework::LoDTensor>());
+    destroy_callback = ReleaseHolder<framework::Tensor>;
+  } else if (var->IsType<framework::SelectedRows>()) {
+    payload_user_data =
+        new framework::Tensor(var->Get<framework::SelectedRows>().value());
+    destroy_callback = ReleaseHolder<framework::Tensor>;
   }
 
   std::string header;
@@ -118,7 +173,7 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
   memcpy(const_cast<uint8_t*>(slices[0].begin()), e.data(), e.size());
   slices[1] = ::grpc::Slice(
       grpc_slice_new_with_user_data(payload, payload_size, destroy_callback,
-                                    static_cast<char*>(payload)),
+                                    payload_user_data),
       ::grpc::Slice::STEAL_REF);
 
   if (var->IsType<framework::SelectedRows>()) {
@@ -130,13 +185,24 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
     slices[2] = ::grpc::Slice(e2.size());
     memcpy(const_cast<uint8_t*>(slices[2].begin()), e2.data(), e2.size());
 
+    // The rows are copied on write, so the copy held by the slice keeps
+    // the sent rows unchanged.
+    using RowsHolder = framework::Vector<int64_t>;
+    const int64_t* rows_data = slr->rows().data();
+    DestroyCallback rows_destroy_callback = ReleaseHolder<CompressedVarHolder>;
+    void* rows_user_data = nullptr;
+    if (compressed) {
+      rows_user_data = new CompressedVarHolder(compressed);
+    } else {
+      auto* rows = new RowsHolder(slr->rows());
+      rows_data = static_cast<const RowsHolder*>(rows)->data();
+      rows_destroy_callback = ReleaseHolder<RowsHolder>;
+      rows_user_data = rows;
+    }
     slices[3] = ::grpc::Slice(
         grpc_slice_new_with_user_data(
-            const_cast<void*>(
-                reinterpret_cast<const void*>(slr->rows().data())),
-            rows_memory_size, [](void* backing) {},
-            const_cast<char*>(
-                reinterpret_cast<const char*>(slr->rows().data()))),
+            const_cast<void*>(reinterpret_cast<const void*>(rows_data)),
+            rows_memory_size, rows_destroy_callback, rows_user_data),
         ::grpc::Slice::STEAL_REF);
     num_slices = 4;
   }
@@ -156,6 +222,20 @@ void DeserializeFromByteBuffer(const ::grpc::ByteBuffer& msg,
   *trainer_id = resp.GetTrainerId();
 }
 
+void SerializeToBatchByteBuffer(const std::vector<::grpc::ByteBuffer>& msgs,
+                                ::grpc::ByteBuffer* batch) {
+  std::vector<::grpc::Slice> slices;
+  for (auto& msg : msgs) {
+    uint64_t length = msg.Length();
+    slices.emplace_back(&length, sizeof(length));
+    std::vector<::grpc::Slice> msg_slices;
+    PADDLE_ENFORCE(msg.Dump(&msg_slices).ok(), "dump bytebuffer error!");
+    slices.insert(slices.end(), msg_slices.begin(), msg_slices.end());
+  }
+  ::grpc::ByteBuffer tmp(slices.data(), slices.size());
+  batch->Swap(&tmp);
+}
+
 }  // namespace distributed
 }  // namespace operators
 }  // namespace paddle
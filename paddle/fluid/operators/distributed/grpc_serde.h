@@ -46,6 +46,12 @@ void DeserializeFromByteBuffer(const ::grpc::ByteBuffer& msg,
                                const framework::Scope* scope,
                                framework::Variable** var, int* trainer_id);
 
+// Concatenate the serialized variables into one request of SendVariables,
+// each of them is prefixed by its length in bytes. The slices of msgs are
+// shared by batch, nothing is copied.
+void SerializeToBatchByteBuffer(const std::vector<::grpc::ByteBuffer>& msgs,
+                                ::grpc::ByteBuffer* batch);
+
 }  // namespace distributed
 }  // namespace operators
 }  // namespace paddle
@@ -16,6 +16,7 @@ limitations under the License. */
 #include <string>
 #include <thread>  // NOLINT
 
+#include "gflags/gflags.h"
 #include "google/protobuf/text_format.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/lod_tensor.h"
@@ -35,6 +36,8 @@ namespace operators = paddle::operators;
 namespace math = paddle::operators::math;
 namespace memory = paddle::memory;
 
+DECLARE_int64(rpc_deserialize_section_bytes);
+
 void RunSerdeTestSelectedRows(platform::Place place) {
   platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
   auto& ctx = *pool.Get(place);
@@ -212,6 +215,37 @@ TEST(LodTensor, Run) {
 #endif
 }
 
+TEST(LodTensor, RunSections) {
+  platform::CPUPlace place;
+  platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
+  auto& ctx = *pool.Get(place);
+
+  framework::Variable var;
+  auto* tensor = var.GetMutable<framework::LoDTensor>();
+  tensor->Resize(framework::make_ddim({1000, 33}));
+  float* data = tensor->mutable_data<float>(place);
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = static_cast<float>(i);
+  }
+  ::grpc::ByteBuffer msg;
+  operators::distributed::SerializeToByteBuffer("myvar", &var, ctx, &msg);
+
+  // the payload is copied by the sections of 4K, the last one shorter
+  int64_t section_bytes = FLAGS_rpc_deserialize_section_bytes;
+  FLAGS_rpc_deserialize_section_bytes = 4096;
+  framework::Scope scope;
+  scope.Var("myvar");
+  operators::distributed::GRPCVariableResponse resp(&scope, &ctx);
+  EXPECT_EQ(resp.Parse(msg), 0);
+  FLAGS_rpc_deserialize_section_bytes = section_bytes;
+
+  auto& tensor2 = resp.GetVar()->Get<framework::LoDTensor>();
+  ASSERT_EQ(tensor2.numel(), tensor->numel());
+  for (int64_t i = 0; i < tensor2.numel(); ++i) {
+    EXPECT_FLOAT_EQ(tensor2.data<float>()[i], static_cast<float>(i));
+  }
+}
+
 TEST(SelectedRows, Run) {
   platform::CPUPlace place;
   RunSerdeTestSelectedRows(place);
@@ -221,3 +255,43 @@ TEST(SelectedRows, Run) {
   RunSerdeTestSelectedRows(gpu);
 #endif
 }
+
+TEST(Batch, Run) {
+  platform::CPUPlace place;
+  platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
+  auto& ctx = *pool.Get(place);
+
+  // serialize the variables and coalesce them into one batch
+  std::vector<::grpc::ByteBuffer> msgs(3);
+  for (size_t i = 0; i < msgs.size(); ++i) {
+    framework::Variable var;
+    auto* tensor = var.GetMutable<framework::LoDTensor>();
+    tensor->Resize(framework::make_ddim({16, static_cast<int64_t>(i + 1)}));
+    tensor->mutable_data<float>(place);
+    math::set_constant(ctx, tensor, static_cast<float>(i));
+    operators::distributed::SerializeToByteBuffer(
+        paddle::string::Sprintf("myvar%d", i), &var, ctx, &msgs[i]);
+  }
+  ::grpc::ByteBuffer batch;
+  operators::distributed::SerializeToBatchByteBuffer(msgs, &batch);
+
+  // parse the variables one by one
+  framework::Scope scope;
+  operators::distributed::GrpcByteBufferSource source;
+  EXPECT_TRUE(source.Init(batch));
+  for (size_t i = 0; i < msgs.size(); ++i) {
+    auto varname = paddle::string::Sprintf("myvar%d", i);
+    scope.Var(varname);
+    operators::distributed::GRPCVariableResponse resp(&scope, &ctx);
+    EXPECT_EQ(resp.ParseFrame(&source), 0);
+    EXPECT_EQ(resp.Varname(), varname);
+
+    auto& tensor = resp.GetVar()->Get<framework::LoDTensor>();
+    EXPECT_EQ(tensor.numel(), static_cast<int64_t>(16 * (i + 1)));
+    for (int64_t j = 0; j < tensor.numel(); ++j) {
+      EXPECT_FLOAT_EQ(tensor.data<float>()[j], static_cast<float>(i));
+    }
+  }
+  EXPECT_EQ(source.ByteCount(),
+            static_cast<::google::protobuf::int64>(batch.Length()));
+}
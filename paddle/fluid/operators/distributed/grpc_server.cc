@@ -14,9 +14,11 @@ limitations under the License. */
 
 #include <limits>
 #include <string>
+#include <vector>
 
 #include "paddle/fluid/operators/distributed/grpc_serde.h"
 #include "paddle/fluid/operators/distributed/grpc_server.h"
+#include "paddle/fluid/operators/distributed/rpc_metrics.h"
 
 using ::grpc::ServerAsyncResponseWriter;
 
@@ -105,6 +107,9 @@ class RequestSend final : public RequestBase {
     int trainer_id = request_->GetTrainerId();
     framework::Variable* outvar = nullptr;
 
+    platform::RecordRPCEvent record_event(
+        "RequestSend", nullptr, "trainer " + std::to_string(trainer_id),
+        platform::NextRPCFlowId("SendRPC", trainer_id, varname), false);
     request_handler_->Handle(varname, scope, invar, &outvar, trainer_id);
     Finish(reply_, &responder_);
   }
@@ -115,6 +120,57 @@ class RequestSend final : public RequestBase {
   ServerAsyncResponseWriter<sendrecv::VoidMessage> responder_;
 };
 
+class RequestSendBatch final : public RequestBase {
+ public:
+  explicit RequestSendBatch(GrpcService::AsyncService* service,
+                            ::grpc::ServerCompletionQueue* cq,
+                            RequestHandler* request_handler, int req_id)
+      : RequestBase(service, cq, request_handler, req_id), responder_(&ctx_) {
+    int method_id = static_cast<int>(distributed::GrpcMethod::kSendVariables);
+    service_->RequestAsyncUnary(
+        method_id, &ctx_, &request_, &responder_, cq_, cq_,
+        reinterpret_cast<void*>(static_cast<intptr_t>(req_id)));
+  }
+  virtual ~RequestSendBatch() {}
+  std::string GetReqName() override { return varnames_; }
+
+  void Process() override {
+    GrpcByteBufferSource source;
+    PADDLE_ENFORCE(source.Init(request_), "dump bytebuffer error!");
+    auto length = static_cast<::google::protobuf::int64>(request_.Length());
+    while (source.ByteCount() < length) {
+      std::shared_ptr<GRPCVariableResponse> var(new GRPCVariableResponse(
+          request_handler_->scope(), request_handler_->dev_ctx(),
+          !request_handler_->sync_mode()));
+      PADDLE_ENFORCE_EQ(var->ParseFrame(&source), 0,
+                        "parse the variable %d of the batch error!",
+                        vars_.size());
+      // the local scopes of the variables live as long as the request
+      vars_.push_back(var);
+
+      std::string varname = var->Varname();
+      VLOG(4) << "RequestSendBatch var_name:" << varname;
+      varnames_ += varnames_.empty() ? varname : "," + varname;
+
+      framework::Variable* outvar = nullptr;
+      int trainer_id = var->GetTrainerId();
+      platform::RecordRPCEvent record_event(
+          "RequestSend", nullptr, "trainer " + std::to_string(trainer_id),
+          platform::NextRPCFlowId("SendRPC", trainer_id, varname), false);
+      request_handler_->Handle(varname, var->GetMutableLocalScope(),
+                               var->GetVar(), &outvar, trainer_id);
+    }
+    Finish(reply_, &responder_);
+  }
+
+ protected:
+  sendrecv::VoidMessage reply_;
+  ::grpc::ByteBuffer request_;
+  std::vector<std::shared_ptr<GRPCVariableResponse>> vars_;
+  std::string varnames_;
+  ServerAsyncResponseWriter<sendrecv::VoidMessage> responder_;
+};
+
 class RequestGet final : public RequestBase {
  public:
   explicit RequestGet(GrpcService::AsyncService* service,
@@ -141,6 +197,9 @@ class RequestGet final : public RequestBase {
     auto invar = scope->FindVar(varname);
     framework::Variable* outvar = nullptr;
 
+    platform::RecordRPCEvent record_event(
+        "RequestGet", nullptr, "trainer " + std::to_string(trainer_id),
+        platform::NextRPCFlowId("GetRPC", trainer_id, varname), false);
     request_handler_->Handle(varname, scope, invar, &outvar, trainer_id);
 
     if (outvar) {
@@ -261,6 +320,13 @@ void AsyncGRPCServer::StartServer() {
   builder.SetMaxReceiveMessageSize(std::numeric_limits<int>::max());
   builder.RegisterService(&service_);
 
+  // The variables coalesced by GRPCClient are served by the send handler.
+  if (rpc_call_map_.count(kRequestSend) != 0 &&
+      rpc_call_map_.count(kRequestSendBatch) == 0) {
+    RegisterRPC(kRequestSendBatch, rpc_call_map_[kRequestSend],
+                rpc_thread_num_[kRequestSend]);
+  }
+
   for (auto t : rpc_call_map_) {
     rpc_cq_[t.first].reset(builder.AddCompletionQueue().release());
   }
@@ -345,6 +411,8 @@ void AsyncGRPCServer::TryToRegisterNewOne(const std::string& rpc_name,
   RequestBase* b = nullptr;
   if (rpc_name == kRequestSend) {
     b = new RequestSend(&service_, cq.get(), handler, req_id);
+  } else if (rpc_name == kRequestSendBatch) {
+    b = new RequestSendBatch(&service_, cq.get(), handler, req_id);
   } else if (rpc_name == kRequestGet) {
     b = new RequestGet(&service_, cq.get(), handler, req_id);
   } else if (rpc_name == kRequestPrefetch) {
@@ -366,6 +434,15 @@ void AsyncGRPCServer::HandleRequest(
   void* tag = NULL;
   bool ok = false;
 
+  auto& metrics = MetricsRegistry::Instance();
+  auto* in_flight = metrics.GetGauge(
+      "pserver_requests_in_flight",
+      "The requests being processed, including the ones at the barriers.",
+      MetricLabel("rpc", rpc_name));
+  auto* latency = metrics.GetHistogram(
+      "pserver_request_seconds", "The time processing the requests.",
+      MetricLabel("rpc", rpc_name));
+
   while (true) {
     VLOG(4) << "HandleRequest " << rpc_name << " wait next";
     if (!cq->Next(&tag, &ok)) {
@@ -402,7 +479,12 @@ void AsyncGRPCServer::HandleRequest(
 
     switch (base->Status()) {
       case PROCESS: {
-        base->Process();
+        in_flight->Add(1);
+        {
+          ScopedLatency record_latency(latency);
+          base->Process();
+        }
+        in_flight->Add(-1);
         break;
       }
       case FINISH: {
@@ -19,6 +19,7 @@
 #include <nccl.h>
 #endif
 
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
 #include "paddle/fluid/operators/distributed/grpc_variable_response.h"
 #include "paddle/fluid/platform/profiler.h"
 
@@ -56,6 +57,33 @@ int GRPCVariableResponse::Parse(const ::grpc::ByteBuffer& byte_buffer) {
   return Parse(&r);
 }
 
+// The Source of one variable in a request of SendVariables.
+class FrameSource : public Source {
+ public:
+  explicit FrameSource(::google::protobuf::io::ZeroCopyInputStream* stream)
+      : stream_(stream) {}
+  ::google::protobuf::io::ZeroCopyInputStream* contents() override {
+    return stream_;
+  }
+
+ private:
+  ::google::protobuf::io::ZeroCopyInputStream* stream_;
+};
+
+int GRPCVariableResponse::ParseFrame(GrpcByteBufferSource* source) {
+  uint64_t length = 0;
+  {
+    // the bytes read ahead are backed up to source when input is destroyed
+    ::google::protobuf::io::CodedInputStream input(source);
+    if (!input.ReadRaw(&length, sizeof(length))) {
+      return -1;
+    }
+  }
+  ::google::protobuf::io::LimitingInputStream frame(source, length);
+  FrameSource r(&frame);
+  return Parse(&r);
+}
+
 bool ParseLodData(::google::protobuf::io::CodedInputStream* input,
                   std::vector<int64_t>* lod) {
   while (true) {
@@ -104,6 +132,17 @@ bool ParseLodData(::google::protobuf::io::CodedInputStream* input,
 }
 
 int GRPCVariableResponse::Parse(Source* source) {
+  int ret = ParseFields(source);
+  // The sections being copied read the buffers of source, which may be
+  // released once Parse returns.
+  WaitSections();
+  if (ret != 0) {
+    return ret;
+  }
+  return Decompress() ? 0 : -1;
+}
+
+int GRPCVariableResponse::ParseFields(Source* source) {
   ::google::protobuf::io::ZeroCopyInputStream* input_stream =
       source->contents();
   ::google::protobuf::io::CodedInputStream input(input_stream);
@@ -114,10 +153,7 @@ int GRPCVariableResponse::Parse(Source* source) {
     int tag = GetTagFieldNumber(p.first);
     WireType wt = GetTagWireType(p.first);
     if (!p.second) {
-      if (tag != 0) {
-        return -1;
-      }
-      return 0;
+      return tag != 0 ? -1 : 0;
     }
 
     switch (tag) {
@@ -301,6 +337,43 @@ int GRPCVariableResponse::Parse(Source* source) {
         meta_.set_trainer_id(trainer_id);
         break;
       }
+      case sendrecv::VariableMessage::kCompressTypeFieldNumber: {
+        uint32_t v = 0;
+        if ((wt != WIRETYPE_VARINT) || !input.ReadVarint32(&v)) {
+          return tag;
+        }
+        meta_.set_compress_type(static_cast<::sendrecv::CompressType>(v));
+        break;
+      }
+      case sendrecv::VariableMessage::kDenseDimsFieldNumber: {
+        // not packed
+        if (wt == WIRETYPE_VARINT) {
+          uint64_t v;
+          if (!input.ReadVarint64(&v)) {
+            return tag;
+          }
+          meta_.add_dense_dims(v);
+          break;
+        }
+
+        // packed
+        if (wt == WIRETYPE_LENGTH_DELIMITED) {
+          int num_bytes = 0;
+          if (!input.ReadVarintSizeAsInt(&num_bytes)) {
+            return tag;
+          }
+          int start_pos = input.CurrentPosition();
+          while (input.CurrentPosition() - start_pos < num_bytes) {
+            uint64_t v;
+            if (!input.ReadVarint64(&v)) {
+              return tag;
+            }
+            meta_.add_dense_dims(v);
+          }
+          break;
+        }
+        return tag;
+      }
       default: {
         // Unknown tag, return unknown error.
         return -1;
@@ -51,6 +51,15 @@ class GRPCVariableResponse : public VariableResponse {
   // -1: unkown error.
   // other: number of error field.
   int Parse(const ::grpc::ByteBuffer& byte_buffer);
+
+  // Parse the next variable of a request of SendVariables, which is a
+  // sequence of the serialized variables prefixed by their lengths.
+  int ParseFrame(GrpcByteBufferSource* source);
+
+ private:
+  // Parse the fields of the message, the payloads may still be being copied
+  // when it returns.
+  int ParseFields(Source* source);
 };
 
 };  // namespace distributed
@@ -0,0 +1,88 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/hot_rows.h"
+
+#include <map>
+#include <memory>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+HotRowsTracker::HotRowsTracker(size_t capacity)
+    : capacity_(capacity), total_(0) {
+  PADDLE_ENFORCE_GT(capacity, 0UL, "The capacity of HotRowsTracker is 0");
+}
+
+HotRowsTracker* HotRowsTracker::Get(const std::string& table,
+                                    size_t capacity) {
+  static std::mutex mutex;
+  static std::map<std::string, std::unique_ptr<HotRowsTracker>> trackers;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& tracker = trackers[table];
+  if (tracker == nullptr) {
+    tracker.reset(new HotRowsTracker(capacity));
+  }
+  return tracker.get();
+}
+
+void HotRowsTracker::Record(const int64_t* ids, int64_t num) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  total_ += num;
+  for (int64_t i = 0; i < num; ++i) {
+    int64_t id = ids[i];
+    auto it = counts_.find(id);
+    int64_t count = 1;
+    if (it != counts_.end()) {
+      by_count_.erase(std::make_pair(it->second, id));
+      count = ++it->second;
+    } else {
+      if (counts_.size() >= capacity_) {
+        auto least = by_count_.begin();
+        count = least->first + 1;
+        counts_.erase(least->second);
+        by_count_.erase(least);
+      }
+      counts_.emplace(id, count);
+    }
+    by_count_.emplace(count, id);
+  }
+}
+
+std::vector<std::pair<int64_t, int64_t>> HotRowsTracker::Top(size_t k) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::pair<int64_t, int64_t>> top;
+  for (auto it = by_count_.rbegin(); it != by_count_.rend() && top.size() < k;
+       ++it) {
+    top.emplace_back(it->second, it->first);
+  }
+  return top;
+}
+
+int64_t HotRowsTracker::total() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return total_;
+}
+
+size_t HotRowsTracker::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return counts_.size();
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
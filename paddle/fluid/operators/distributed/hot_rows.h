@@ -0,0 +1,64 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// The rows most prefetched from a sparse table on the pserver, to find the
+// hot ids skewing the load of the pservers. The rows are counted by the
+// Space-Saving algorithm in a bounded memory: the capacity rows with the
+// largest counts are tracked, and a new row replaces the least counted one
+// and inherits its count, so a count is overestimated by at most the count
+// of the row it replaced.
+class HotRowsTracker {
+ public:
+  explicit HotRowsTracker(size_t capacity);
+
+  // Get the tracker of the table, create it with capacity if it does not
+  // exist.
+  static HotRowsTracker* Get(const std::string& table, size_t capacity);
+
+  void Record(const int64_t* ids, int64_t num);
+
+  // The k hottest rows with their counts, the most counted first.
+  std::vector<std::pair<int64_t, int64_t>> Top(size_t k) const;
+
+  // The number of the ids recorded.
+  int64_t total() const;
+
+  size_t size() const;
+
+ private:
+  size_t capacity_;
+  mutable std::mutex mutex_;
+  int64_t total_;
+  std::unordered_map<int64_t, int64_t> counts_;
+  // (count, id) of the tracked rows, the least counted first.
+  std::set<std::pair<int64_t, int64_t>> by_count_;
+};
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
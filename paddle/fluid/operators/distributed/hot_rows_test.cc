@@ -0,0 +1,71 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/hot_rows.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+TEST(HotRowsTracker, Top) {
+  HotRowsTracker tracker(3);
+  std::vector<int64_t> ids = {7, 1, 7, 2, 7, 1};
+  tracker.Record(ids.data(), ids.size());
+  EXPECT_EQ(tracker.total(), 6);
+  EXPECT_EQ(tracker.size(), 3UL);
+
+  auto top = tracker.Top(2);
+  ASSERT_EQ(top.size(), 2UL);
+  EXPECT_EQ(top[0], std::make_pair(7L, 3L));
+  EXPECT_EQ(top[1], std::make_pair(1L, 2L));
+  EXPECT_EQ(tracker.Top(10).size(), 3UL);
+}
+
+TEST(HotRowsTracker, Replace) {
+  HotRowsTracker tracker(2);
+  std::vector<int64_t> ids = {7, 7, 7, 1, 1, 2};
+  tracker.Record(ids.data(), ids.size());
+  // 2 replaces 1 and inherits its count
+  EXPECT_EQ(tracker.size(), 2UL);
+  auto top = tracker.Top(2);
+  EXPECT_EQ(top[0], std::make_pair(7L, 3L));
+  EXPECT_EQ(top[1], std::make_pair(2L, 3L));
+}
+
+TEST(HotRowsTracker, Skewed) {
+  // the hot row stays in the tracker among the cold ones
+  HotRowsTracker tracker(3);
+  std::vector<int64_t> ids = {7, 7, 7};
+  for (int64_t i = 100; i < 104; ++i) {
+    ids.push_back(i);
+    ids.push_back(7);
+  }
+  tracker.Record(ids.data(), ids.size());
+  EXPECT_EQ(tracker.Top(1)[0], std::make_pair(7L, 7L));
+  EXPECT_EQ(tracker.total(), 11);
+}
+
+TEST(HotRowsTracker, Get) {
+  auto* tracker = HotRowsTracker::Get("table", 4);
+  EXPECT_EQ(tracker, HotRowsTracker::Get("table", 8));
+  EXPECT_NE(tracker, HotRowsTracker::Get("other_table", 4));
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,132 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/prefetch_cache.h"
+
+#include <cstring>
+#include <map>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+PrefetchCache::PrefetchCache(int64_t capacity, int64_t staleness)
+    : capacity_(capacity), staleness_(staleness), step_(0), width_(0) {
+  PADDLE_ENFORCE_GT(capacity, 0, "The capacity of PrefetchCache is 0");
+}
+
+PrefetchCache* PrefetchCache::Get(const std::string& name, int64_t capacity,
+                                  int64_t staleness) {
+  static std::mutex mutex;
+  static std::map<std::string, std::unique_ptr<PrefetchCache>> caches;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& cache = caches[name];
+  if (cache == nullptr) {
+    cache.reset(new PrefetchCache(capacity, staleness));
+  }
+  return cache.get();
+}
+
+void PrefetchCache::NextStep() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++step_;
+}
+
+int64_t PrefetchCache::step() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return step_;
+}
+
+int64_t PrefetchCache::width() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return width_;
+}
+
+size_t PrefetchCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+void PrefetchCache::Lookup(const int64_t* ids, int64_t num, float* rows,
+                           std::vector<int64_t>* missed) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  missed->clear();
+  for (int64_t i = 0; i < num; ++i) {
+    auto iter = entries_.find(ids[i]);
+    if (iter == entries_.end() || step_ - iter->second.step > staleness_) {
+      missed->push_back(i);
+      continue;
+    }
+    auto& entry = iter->second;
+    std::memcpy(rows + i * width_, rows_.data() + entry.slot * width_,
+                width_ * sizeof(float));
+    lru_.splice(lru_.begin(), lru_, entry.lru);
+  }
+}
+
+void PrefetchCache::Update(const int64_t* ids, int64_t num, const float* rows,
+                           int64_t width, int64_t step) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (width_ == 0) {
+    width_ = width;
+    rows_.resize(capacity_ * width_);
+  }
+  PADDLE_ENFORCE_EQ(width, width_, "The rows of the cache have %d elements",
+                    width_);
+  for (int64_t i = 0; i < num; ++i) {
+    auto iter = entries_.find(ids[i]);
+    if (iter != entries_.end()) {
+      auto& entry = iter->second;
+      // do not overwrite a newer row with an older refresh
+      if (entry.step > step) continue;
+      entry.step = step;
+      lru_.splice(lru_.begin(), lru_, entry.lru);
+      std::memcpy(rows_.data() + entry.slot * width_, rows + i * width_,
+                  width_ * sizeof(float));
+      continue;
+    }
+    int64_t slot;
+    if (static_cast<int64_t>(entries_.size()) < capacity_) {
+      slot = static_cast<int64_t>(entries_.size());
+    } else {
+      // reuse the slot of the least recently used row
+      auto last = entries_.find(lru_.back());
+      slot = last->second.slot;
+      entries_.erase(last);
+      lru_.pop_back();
+    }
+    lru_.push_front(ids[i]);
+    entries_[ids[i]] = Entry{slot, step, lru_.begin()};
+    std::memcpy(rows_.data() + slot * width_, rows + i * width_,
+                width_ * sizeof(float));
+  }
+}
+
+void PrefetchCache::AddRefresh(const Refresh& refresh) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  refreshes_.push_back(refresh);
+}
+
+std::vector<PrefetchCache::Refresh> PrefetchCache::TakeRefreshes() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<Refresh> refreshes;
+  refreshes.swap(refreshes_);
+  return refreshes;
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
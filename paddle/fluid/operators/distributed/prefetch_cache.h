@@ -0,0 +1,108 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/operators/distributed/request_handler.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// The trainer side cache of the float rows prefetched from the sparse
+// tables on the pservers, used by prefetch_op. A row fetched at some step
+// is reused for the following staleness steps, and the least recently used
+// rows are dropped when the cache is full.
+//
+// In the pipeline mode, prefetch_op refreshes the cached rows it hits in
+// the background, the refresh overlaps the computation of the step and is
+// applied to the cache at the beginning of the next one.
+class PrefetchCache {
+ public:
+  // The rows of the ids in refresh_scope(), refreshed in the background.
+  struct Refresh {
+    // the index of the prefetched variables
+    size_t index;
+    // the step issuing the refresh
+    int64_t step;
+    VarHandlePtr handle;
+  };
+
+  PrefetchCache(int64_t capacity, int64_t staleness);
+
+  // Get the cache of name, create it with capacity and staleness if it
+  // does not exist.
+  static PrefetchCache* Get(const std::string& name, int64_t capacity,
+                            int64_t staleness);
+
+  // Start a new step, the rows fetched more than staleness steps ago are
+  // not reused any more.
+  void NextStep();
+
+  int64_t step() const;
+
+  // The number of the elements of a row, 0 if nothing is cached.
+  int64_t width() const;
+
+  size_t size() const;
+
+  // Copy the cached rows of ids into rows, which has num rows of width().
+  // The positions of the ids not cached are returned in missed.
+  void Lookup(const int64_t* ids, int64_t num, float* rows,
+              std::vector<int64_t>* missed);
+
+  // Cache the rows of ids fetched at step.
+  void Update(const int64_t* ids, int64_t num, const float* rows,
+              int64_t width, int64_t step);
+
+  framework::Scope* refresh_scope() { return &refresh_scope_; }
+
+  void AddRefresh(const Refresh& refresh);
+
+  std::vector<Refresh> TakeRefreshes();
+
+ private:
+  struct Entry {
+    int64_t slot;
+    // the step fetching the row
+    int64_t step;
+    std::list<int64_t>::iterator lru;
+  };
+
+  int64_t capacity_;
+  int64_t staleness_;
+
+  mutable std::mutex mutex_;
+  int64_t step_;
+  int64_t width_;
+  std::vector<float> rows_;
+  std::unordered_map<int64_t, Entry> entries_;
+  // the ids from the most to the least recently used
+  std::list<int64_t> lru_;
+
+  framework::Scope refresh_scope_;
+  std::vector<Refresh> refreshes_;
+};
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
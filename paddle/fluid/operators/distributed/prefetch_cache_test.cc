@@ -0,0 +1,69 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/prefetch_cache.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+TEST(PrefetchCache, LookupUpdate) {
+  PrefetchCache cache(2, 1);
+  std::vector<int64_t> ids = {3, 5};
+  std::vector<float> rows(4);
+  std::vector<int64_t> missed;
+
+  cache.NextStep();
+  cache.Lookup(ids.data(), 2, rows.data(), &missed);
+  EXPECT_EQ(missed, std::vector<int64_t>({0, 1}));
+  std::vector<float> fetched = {0.3f, 0.3f, 0.5f, 0.5f};
+  cache.Update(ids.data(), 2, fetched.data(), 2, cache.step());
+  EXPECT_EQ(cache.width(), 2);
+
+  // reused in the next step
+  cache.NextStep();
+  std::vector<int64_t> lookup = {5, 7};
+  cache.Lookup(lookup.data(), 2, rows.data(), &missed);
+  EXPECT_EQ(missed, std::vector<int64_t>({1}));
+  EXPECT_EQ(rows[0], 0.5f);
+  EXPECT_EQ(rows[1], 0.5f);
+
+  // 3 is the least recently used and dropped for 7
+  std::vector<float> fetched7 = {0.7f, 0.7f};
+  cache.Update(lookup.data() + 1, 1, fetched7.data(), 2, cache.step());
+  EXPECT_EQ(cache.size(), 2UL);
+  cache.Lookup(ids.data(), 2, rows.data(), &missed);
+  EXPECT_EQ(missed, std::vector<int64_t>({0}));
+
+  // 5 is fetched at step 1 and stale at step 3
+  cache.NextStep();
+  cache.Lookup(lookup.data(), 2, rows.data(), &missed);
+  EXPECT_EQ(missed, std::vector<int64_t>({0}));
+  EXPECT_EQ(rows[2], 0.7f);
+
+  // an older refresh does not overwrite a newer row
+  std::vector<float> old7 = {0.1f, 0.1f};
+  cache.Update(lookup.data() + 1, 1, old7.data(), 2, 1);
+  cache.Lookup(lookup.data() + 1, 1, rows.data(), &missed);
+  EXPECT_TRUE(missed.empty());
+  EXPECT_EQ(rows[0], 0.7f);
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -36,6 +36,7 @@ namespace operators {
 namespace distributed {
 
 constexpr char kRequestSend[] = "RequestSend";
+constexpr char kRequestSendBatch[] = "RequestSendBatch";
 constexpr char kRequestGet[] = "RequestGet";
 constexpr char kRequestPrefetch[] = "RequestPrefetch";
 constexpr char kRequestCheckpoint[] = "RequestCheckpoint";
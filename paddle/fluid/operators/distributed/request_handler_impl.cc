@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -20,10 +21,19 @@
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/operators/distributed/hot_rows.h"
 #include "paddle/fluid/operators/distributed/request_handler_impl.h"
+#include "paddle/fluid/operators/distributed/rpc_metrics.h"
 #include "paddle/fluid/operators/distributed/rpc_server.h"
 #include "paddle/fluid/string/printf.h"
 
+DEFINE_int32(rpc_hot_rows_capacity, 0,
+             "The number of the most prefetched rows of each sparse table "
+             "tracked by the pserver, 0 to disable the tracking.");
+DEFINE_int32(rpc_hot_rows_report_interval, 1000,
+             "Log the hottest rows of a table every this number of the "
+             "prefetch requests, if the rows are tracked.");
+
 namespace paddle {
 namespace operators {
 namespace distributed {
@@ -32,6 +42,45 @@ namespace distributed {
 // to directory specified.
 constexpr char LOOKUP_TABLE_PATH[] = "kLookupTablePath";
 
+static int64_t VariableBytes(const framework::Variable* var) {
+  if (var == nullptr) return 0;
+  if (var->IsType<framework::LoDTensor>()) {
+    return var->Get<framework::LoDTensor>().memory_size();
+  }
+  if (var->IsType<framework::SelectedRows>()) {
+    auto& slr = var->Get<framework::SelectedRows>();
+    return slr.value().memory_size() + slr.rows().size() * sizeof(int64_t);
+  }
+  return 0;
+}
+
+// The metrics are got once, updating them is lock-free.
+static MetricCounter* ReceivedBytes() {
+  static MetricCounter* counter = MetricsRegistry::Instance().GetCounter(
+      "pserver_received_bytes_total",
+      "The bytes of the variables sent by the trainers.");
+  return counter;
+}
+
+static MetricCounter* SentBytes() {
+  static MetricCounter* counter = MetricsRegistry::Instance().GetCounter(
+      "pserver_sent_bytes_total",
+      "The bytes of the variables got by the trainers.");
+  return counter;
+}
+
+static MetricHistogram* OptimizeSeconds(bool async) {
+  static MetricHistogram* async_histogram =
+      MetricsRegistry::Instance().GetHistogram(
+          "pserver_optimize_seconds", "The time running the optimize blocks.",
+          MetricLabel("mode", "async"));
+  static MetricHistogram* pipeline_histogram =
+      MetricsRegistry::Instance().GetHistogram(
+          "pserver_optimize_seconds", "The time running the optimize blocks.",
+          MetricLabel("mode", "pipeline"));
+  return async ? async_histogram : pipeline_histogram;
+}
+
 bool RequestSendHandler::Handle(const std::string& varname,
                                 framework::Scope* scope,
                                 framework::Variable* invar,
@@ -42,17 +91,25 @@ bool RequestSendHandler::Handle(const std::string& varname,
 
   // Sync
   if (varname == BATCH_BARRIER_MESSAGE) {
-    VLOG(3) << "sync: recv BATCH_BARRIER_MESSAGE";
-    rpc_server_->IncreaseBatchBarrier(kRequestSend);
+    if (sync_mode_) {
+      VLOG(3) << "sync: recv BATCH_BARRIER_MESSAGE";
+      rpc_server_->IncreaseBatchBarrier(kRequestSend);
+    } else if (rpc_server_->staleness() > 0) {
+      VLOG(3) << "async: recv BATCH_BARRIER_MESSAGE of trainer " << trainer_id;
+      rpc_server_->IncreaseTrainerClock(trainer_id);
+    }
   } else if (varname == COMPLETE_MESSAGE) {
     VLOG(3) << "sync: recv complete message";
+    rpc_server_->FinishTrainerClock(trainer_id);
     rpc_server_->Complete();
   } else {
+    ReceivedBytes()->Add(VariableBytes(invar));
     // Async
     if (!sync_mode_) {
       VLOG(3) << "async process var: " << varname;
       rpc_server_->Profiler().OneStep();
       try {
+        ScopedLatency latency(OptimizeSeconds(true));
         executor_->RunPreparedContext((*grad_to_prepared_ctx_)[varname].get(),
                                       scope);
       } catch (std::exception& e) {
@@ -68,11 +125,47 @@ bool RequestSendHandler::Handle(const std::string& varname,
         LOG(FATAL) << "sync: Can not find server side var: " << varname;
         return false;
       }
+      if (pipeline_optimize_) {
+        OptimizeIfReady(varname);
+      }
     }
   }
   return true;
 }
 
+void RequestSendHandler::OptimizeIfReady(const std::string& varname) {
+  // NOTE: the gradients sent by the trainers are renamed with a
+  // ".trainer_%d" suffix by distributed_transpiler.py
+  std::string grad_name = varname;
+  auto pos = grad_name.find(".trainer_");
+  if (pos != std::string::npos) {
+    auto end = grad_name.find('.', pos + 1);
+    grad_name.erase(pos, end == std::string::npos ? end : end - pos);
+  }
+  auto it = grad_to_prepared_ctx_->find(grad_name);
+  if (it == grad_to_prepared_ctx_->end()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (++grad_counts_[grad_name] < rpc_server_->GetClientNum() ||
+        !optimized_grads_.insert(grad_name).second) {
+      return;
+    }
+  }
+  VLOG(3) << "sync: optimize " << grad_name << " in pipeline";
+  ScopedLatency latency(OptimizeSeconds(false));
+  executor_->RunPreparedContext(it->second.get(), scope_);
+}
+
+std::unordered_set<std::string> RequestSendHandler::ResetOptimizedGrads() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::unordered_set<std::string> optimized;
+  optimized.swap(optimized_grads_);
+  grad_counts_.clear();
+  return optimized;
+}
+
 bool RequestGetHandler::Handle(const std::string& varname,
                                framework::Scope* scope,
                                framework::Variable* invar,
@@ -90,6 +183,9 @@ bool RequestGetHandler::Handle(const std::string& varname,
     }
   } else {
     if (varname != FETCH_BARRIER_MESSAGE && varname != COMPLETE_MESSAGE) {
+      if (rpc_server_->staleness() > 0) {
+        rpc_server_->WaitTrainerClock(trainer_id);
+      }
       if (enable_dc_asgd_) {
         // NOTE: the format is determined by distributed_transpiler.py
         std::string param_bak_name =
@@ -106,6 +202,9 @@ bool RequestGetHandler::Handle(const std::string& varname,
       *outvar = scope_->FindVar(varname);
     }
   }
+  if (outvar != nullptr) {
+    SentBytes()->Add(VariableBytes(*outvar));
+  }
   return true;
 }
 
@@ -116,6 +215,9 @@ bool RequestPrefetchHandler::Handle(const std::string& varname,
                                     const int trainer_id,
                                     const std::string& out_var_name) {
   VLOG(4) << "RequestPrefetchHandler " << varname;
+  if (invar != nullptr && invar->IsType<framework::LoDTensor>()) {
+    RecordPrefetch(varname, invar->Get<framework::LoDTensor>());
+  }
 
   auto var_desc = program_->Block(0).FindVar(out_var_name);
   InitializeVariable(*outvar, var_desc->GetType());
@@ -125,6 +227,43 @@ bool RequestPrefetchHandler::Handle(const std::string& varname,
   return true;
 }
 
+void RequestPrefetchHandler::RecordPrefetch(const std::string& varname,
+                                            const framework::LoDTensor& ids) {
+  TableStats* table;
+  int64_t requests;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    table = &tables_[varname];
+    if (table->rows == nullptr) {
+      table->rows = MetricsRegistry::Instance().GetCounter(
+          "pserver_prefetch_rows_total",
+          "The rows of the sparse tables prefetched by the trainers.",
+          MetricLabel("table", varname));
+      if (FLAGS_rpc_hot_rows_capacity > 0) {
+        table->hot_rows =
+            HotRowsTracker::Get(varname, FLAGS_rpc_hot_rows_capacity);
+      }
+    }
+    requests = ++table->requests;
+  }
+  table->rows->Add(ids.numel());
+  if (table->hot_rows == nullptr || ids.type() != typeid(int64_t)) return;
+
+  table->hot_rows->Record(ids.data<int64_t>(), ids.numel());
+  if (FLAGS_rpc_hot_rows_report_interval > 0 &&
+      requests % FLAGS_rpc_hot_rows_report_interval == 0) {
+    const size_t kReportRows = 10;
+    int64_t total = table->hot_rows->total();
+    std::ostringstream os;
+    for (auto& row : table->hot_rows->Top(kReportRows)) {
+      os << " " << row.first << ":"
+         << static_cast<double>(row.second) / total;
+    }
+    LOG(INFO) << "the hottest rows of " << varname << " and their shares of "
+              << total << " prefetched rows:" << os.str();
+  }
+}
+
 bool RequestCheckpointHandler::Handle(const std::string& varname,
                                       framework::Scope* scope,
                                       framework::Variable* invar,
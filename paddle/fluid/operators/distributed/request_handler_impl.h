@@ -17,7 +17,10 @@
 #include <time.h>
 
 #include <functional>
+#include <mutex>  // NOLINT
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -28,7 +31,9 @@
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/framework/var_type.h"
+#include "paddle/fluid/operators/distributed/hot_rows.h"
 #include "paddle/fluid/operators/distributed/request_handler.h"
+#include "paddle/fluid/operators/distributed/rpc_metrics.h"
 
 namespace paddle {
 namespace operators {
@@ -37,7 +42,7 @@ namespace distributed {
 class RequestSendHandler final : public RequestHandler {
  public:
   explicit RequestSendHandler(bool sync_mode, bool enable_dc_asgd = false)
-      : RequestHandler(sync_mode) {
+      : RequestHandler(sync_mode), pipeline_optimize_(false) {
     enable_dc_asgd_ = enable_dc_asgd;
   }
   virtual ~RequestSendHandler() {}
@@ -46,8 +51,27 @@ class RequestSendHandler final : public RequestHandler {
               const int trainer_id,
               const std::string& out_var_name = "") override;
 
+  // In sync mode, run the optimize block of a gradient in
+  // grad_to_prepared_ctx_ as soon as all the trainers have sent it, so the
+  // optimization overlaps the receiving of the other gradients.
+  void SetPipelineOptimize(bool pipeline_optimize) {
+    pipeline_optimize_ = pipeline_optimize;
+  }
+
+  // Return the gradients optimized in the current step, and start counting
+  // the gradients of the next step.
+  std::unordered_set<std::string> ResetOptimizedGrads();
+
  private:
+  void OptimizeIfReady(const std::string& varname);
+
   bool enable_dc_asgd_;
+  bool pipeline_optimize_;
+
+  std::mutex mutex_;
+  // the number of the trainers which have sent a gradient
+  std::unordered_map<std::string, int> grad_counts_;
+  std::unordered_set<std::string> optimized_grads_;
 };
 
 class RequestGetHandler final : public RequestHandler {
@@ -74,6 +98,22 @@ class RequestPrefetchHandler final : public RequestHandler {
               framework::Variable* var, framework::Variable** outvar,
               const int trainer_id,
               const std::string& out_var_name = "") override;
+
+ private:
+  // Count the rows prefetched from each table on this pserver, and track
+  // the hottest ones if FLAGS_rpc_hot_rows_capacity is set, to find the
+  // ids skewing the load of the pservers.
+  void RecordPrefetch(const std::string& varname,
+                      const framework::LoDTensor& ids);
+
+  struct TableStats {
+    MetricCounter* rows = nullptr;
+    HotRowsTracker* hot_rows = nullptr;
+    int64_t requests = 0;
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, TableStats> tables_;
 };
 
 class RequestCheckpointHandler final : public RequestHandler {
@@ -0,0 +1,255 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/rpc_metrics.h"
+
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <sstream>
+
+#include "glog/logging.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+static std::string SampleName(const std::string& name,
+                              const std::string& labels) {
+  return labels.empty() ? name : name + "{" + labels + "}";
+}
+
+void MetricCounter::Export(const std::string& name, const std::string& labels,
+                           std::ostream* os) const {
+  *os << SampleName(name, labels) << " " << value() << "\n";
+}
+
+void MetricGauge::Export(const std::string& name, const std::string& labels,
+                         std::ostream* os) const {
+  *os << SampleName(name, labels) << " " << value() << "\n";
+}
+
+MetricHistogram::MetricHistogram(const std::vector<double>& bounds)
+    : bounds_(bounds),
+      buckets_(new std::atomic<uint64_t>[bounds.size() + 1]),
+      count_(0),
+      sum_nanos_(0) {
+  PADDLE_ENFORCE(std::is_sorted(bounds_.begin(), bounds_.end()),
+                 "the bounds of the histogram should be sorted");
+  for (size_t i = 0; i <= bounds_.size(); ++i) {
+    buckets_[i].store(0);
+  }
+}
+
+void MetricHistogram::Observe(double value) {
+  size_t i = std::lower_bound(bounds_.begin(), bounds_.end(), value) -
+             bounds_.begin();
+  buckets_[i].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_nanos_.fetch_add(static_cast<int64_t>(value * 1e9),
+                       std::memory_order_relaxed);
+}
+
+double MetricHistogram::sum() const {
+  return sum_nanos_.load(std::memory_order_relaxed) / 1e9;
+}
+
+void MetricHistogram::Export(const std::string& name,
+                             const std::string& labels,
+                             std::ostream* os) const {
+  std::string prefix = labels.empty() ? "" : labels + ",";
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i <= bounds_.size(); ++i) {
+    cumulative += bucket_count(i);
+    std::ostringstream le;
+    if (i < bounds_.size()) {
+      le << bounds_[i];
+    } else {
+      le << "+Inf";
+    }
+    *os << name << "_bucket{" << prefix << "le=\"" << le.str() << "\"} "
+        << cumulative << "\n";
+  }
+  *os << SampleName(name + "_sum", labels) << " " << sum() << "\n";
+  *os << SampleName(name + "_count", labels) << " " << count() << "\n";
+}
+
+const std::vector<double>& MetricHistogram::LatencyBounds() {
+  static const std::vector<double> bounds = {
+      0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+      0.1,    0.25,    0.5,    1,     2.5,    5,     10,   25,    100};
+  return bounds;
+}
+
+MetricsRegistry& MetricsRegistry::Instance() {
+  static MetricsRegistry registry;
+  return registry;
+}
+
+MetricsRegistry::Family* MetricsRegistry::GetFamily(const std::string& name,
+                                                    const std::string& type,
+                                                    const std::string& help) {
+  auto& family = families_[name];
+  if (family.type.empty()) {
+    family.type = type;
+    family.help = help;
+  }
+  PADDLE_ENFORCE_EQ(family.type, type, "the metric %s is of type %s", name,
+                    family.type);
+  return &family;
+}
+
+MetricCounter* MetricsRegistry::GetCounter(const std::string& name,
+                                           const std::string& help,
+                                           const std::string& labels) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& metric = GetFamily(name, "counter", help)->metrics[labels];
+  if (!metric) metric.reset(new MetricCounter);
+  return static_cast<MetricCounter*>(metric.get());
+}
+
+MetricGauge* MetricsRegistry::GetGauge(const std::string& name,
+                                       const std::string& help,
+                                       const std::string& labels) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& metric = GetFamily(name, "gauge", help)->metrics[labels];
+  if (!metric) metric.reset(new MetricGauge);
+  return static_cast<MetricGauge*>(metric.get());
+}
+
+MetricHistogram* MetricsRegistry::GetHistogram(
+    const std::string& name, const std::string& help,
+    const std::string& labels, const std::vector<double>& bounds) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& metric = GetFamily(name, "histogram", help)->metrics[labels];
+  if (!metric) metric.reset(new MetricHistogram(bounds));
+  return static_cast<MetricHistogram*>(metric.get());
+}
+
+std::string MetricsRegistry::ExportText() const {
+  std::ostringstream os;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& name_family : families_) {
+    auto& family = name_family.second;
+    os << "# HELP " << name_family.first << " " << family.help << "\n";
+    os << "# TYPE " << name_family.first << " " << family.type << "\n";
+    for (auto& labels_metric : family.metrics) {
+      labels_metric.second->Export(name_family.first, labels_metric.first,
+                                   &os);
+    }
+  }
+  return os.str();
+}
+
+static int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+ScopedLatency::ScopedLatency(MetricHistogram* histogram)
+    : histogram_(histogram), start_ns_(NowNs()) {}
+
+ScopedLatency::~ScopedLatency() {
+  histogram_->Observe((NowNs() - start_ns_) / 1e9);
+}
+
+MetricsHttpServer::MetricsHttpServer(int port)
+    : fd_(-1), port_(-1), exit_(false) {
+  fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  PADDLE_ENFORCE(fd_ >= 0, "create the socket of the metrics server error");
+  int reuse = 1;
+  setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(static_cast<uint16_t>(port));
+  socklen_t len = sizeof(addr);
+  if (bind(fd_, reinterpret_cast<sockaddr*>(&addr), len) != 0 ||
+      listen(fd_, 16) != 0 ||
+      getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+    // The metrics are not worth failing the pserver.
+    LOG(WARNING) << "the metrics server can not listen on port " << port
+                 << ": " << strerror(errno);
+    close(fd_);
+    fd_ = -1;
+    return;
+  }
+  port_ = ntohs(addr.sin_port);
+  LOG(INFO) << "serving the metrics on port " << port_;
+  thread_.reset(new std::thread([this] { Serve(); }));
+}
+
+MetricsHttpServer::~MetricsHttpServer() {
+  exit_ = true;
+  if (thread_) thread_->join();
+  if (fd_ >= 0) close(fd_);
+}
+
+void MetricsHttpServer::Serve() {
+  while (!exit_.load()) {
+    pollfd pfd;
+    pfd.fd = fd_;
+    pfd.events = POLLIN;
+    // wake up now and then to check the exit flag
+    if (poll(&pfd, 1, 200) <= 0) continue;
+    int conn = accept(fd_, nullptr, nullptr);
+    if (conn < 0) continue;
+
+    // Only the request line is needed, e.g. "GET /metrics HTTP/1.1".
+    char buf[1024];
+    ssize_t n = recv(conn, buf, sizeof(buf) - 1, 0);
+    std::string request(buf, n > 0 ? n : 0);
+    std::string status = "200 OK";
+    std::string body;
+    if (request.compare(0, 13, "GET /metrics ") == 0 ||
+        request.compare(0, 6, "GET / ") == 0) {
+      body = MetricsRegistry::Instance().ExportText();
+    } else {
+      status = "404 Not Found";
+    }
+    std::ostringstream response;
+    response << "HTTP/1.0 " << status << "\r\n"
+             << "Content-Type: text/plain; version=0.0.4\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    std::string data = response.str();
+#ifdef MSG_NOSIGNAL
+    // the scraper may close the connection before the response is sent
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+    size_t sent = 0;
+    while (sent < data.size()) {
+      ssize_t m = send(conn, data.data() + sent, data.size() - sent, flags);
+      if (m <= 0) break;
+      sent += m;
+    }
+    close(conn);
+  }
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
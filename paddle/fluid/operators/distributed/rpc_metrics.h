@@ -0,0 +1,174 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <ostream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// The metrics of the pserver, exported in the Prometheus text format by
+// MetricsHttpServer. Updating a metric is lock-free, only getting it from
+// the registry takes a lock, so the metrics of the hot paths are got once
+// and kept by the callers.
+class Metric {
+ public:
+  virtual ~Metric() {}
+  // Write the samples of the metric, labels is like `rpc="SendVariable"`.
+  virtual void Export(const std::string& name, const std::string& labels,
+                      std::ostream* os) const = 0;
+};
+
+class MetricCounter : public Metric {
+ public:
+  MetricCounter() : value_(0) {}
+  void Add(int64_t value = 1) {
+    value_.fetch_add(value, std::memory_order_relaxed);
+  }
+  int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+  void Export(const std::string& name, const std::string& labels,
+              std::ostream* os) const override;
+
+ private:
+  std::atomic<int64_t> value_;
+};
+
+class MetricGauge : public Metric {
+ public:
+  MetricGauge() : value_(0) {}
+  void Set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+  void Add(int64_t value) {
+    value_.fetch_add(value, std::memory_order_relaxed);
+  }
+  int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+  void Export(const std::string& name, const std::string& labels,
+              std::ostream* os) const override;
+
+ private:
+  std::atomic<int64_t> value_;
+};
+
+// A histogram of the observed values over the fixed upper bounds, e.g. the
+// latencies in seconds.
+class MetricHistogram : public Metric {
+ public:
+  explicit MetricHistogram(const std::vector<double>& bounds);
+
+  void Observe(double value);
+
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  double sum() const;
+  // The count of the values in (bounds[i - 1], bounds[i]], the last bucket
+  // has the values larger than all the bounds.
+  uint64_t bucket_count(size_t i) const {
+    return buckets_[i].load(std::memory_order_relaxed);
+  }
+
+  void Export(const std::string& name, const std::string& labels,
+              std::ostream* os) const override;
+
+  // The bounds from 100us to 100s.
+  static const std::vector<double>& LatencyBounds();
+
+ private:
+  std::vector<double> bounds_;
+  std::unique_ptr<std::atomic<uint64_t>[]> buckets_;
+  std::atomic<uint64_t> count_;
+  // The sum in nanos of the unit, to be added atomically.
+  std::atomic<int64_t> sum_nanos_;
+};
+
+class MetricsRegistry {
+ public:
+  static MetricsRegistry& Instance();
+
+  // Get the metric of the name and the labels, the metrics of a name must
+  // be the same type. The returned metric lives as long as the process.
+  MetricCounter* GetCounter(const std::string& name, const std::string& help,
+                            const std::string& labels = "");
+  MetricGauge* GetGauge(const std::string& name, const std::string& help,
+                        const std::string& labels = "");
+  MetricHistogram* GetHistogram(
+      const std::string& name, const std::string& help,
+      const std::string& labels = "",
+      const std::vector<double>& bounds = MetricHistogram::LatencyBounds());
+
+  // All the metrics in the Prometheus text format.
+  std::string ExportText() const;
+
+ private:
+  struct Family {
+    std::string type;
+    std::string help;
+    std::map<std::string, std::unique_ptr<Metric>> metrics;
+  };
+
+  Family* GetFamily(const std::string& name, const std::string& type,
+                    const std::string& help);
+
+  mutable std::mutex mutex_;
+  std::map<std::string, Family> families_;
+};
+
+// The label of a metric, e.g. MetricLabel("rpc", "SendVariable").
+inline std::string MetricLabel(const std::string& key,
+                               const std::string& value) {
+  return key + "=\"" + value + "\"";
+}
+
+// Observe the seconds elapsed in the scope into the histogram.
+class ScopedLatency {
+ public:
+  explicit ScopedLatency(MetricHistogram* histogram);
+  ~ScopedLatency();
+
+ private:
+  MetricHistogram* histogram_;
+  int64_t start_ns_;
+};
+
+// A minimal HTTP server serving MetricsRegistry::ExportText on /metrics,
+// to be scraped by Prometheus.
+class MetricsHttpServer {
+ public:
+  explicit MetricsHttpServer(int port);
+  ~MetricsHttpServer();
+
+  // The port actually bound, which is chosen by the system for port 0, or
+  // -1 if the server failed to start.
+  int port() const { return port_; }
+
+ private:
+  void Serve();
+
+  int fd_;
+  int port_;
+  std::atomic<bool> exit_;
+  std::unique_ptr<std::thread> thread_;
+};
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,117 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/rpc_metrics.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+TEST(RPCMetrics, CounterGauge) {
+  auto& registry = MetricsRegistry::Instance();
+  auto* counter =
+      registry.GetCounter("test_requests_total", "requests", "rpc=\"Get\"");
+  EXPECT_EQ(counter, registry.GetCounter("test_requests_total", "requests",
+                                         "rpc=\"Get\""));
+  counter->Add();
+  counter->Add(2);
+  EXPECT_EQ(counter->value(), 3);
+
+  auto* gauge = registry.GetGauge("test_in_flight", "in flight");
+  gauge->Add(2);
+  gauge->Add(-1);
+  EXPECT_EQ(gauge->value(), 1);
+
+  std::string text = registry.ExportText();
+  EXPECT_NE(text.find("# TYPE test_requests_total counter\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("test_requests_total{rpc=\"Get\"} 3\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("test_in_flight 1\n"), std::string::npos);
+}
+
+TEST(RPCMetrics, Histogram) {
+  MetricHistogram histogram({0.1, 1});
+  histogram.Observe(0.05);
+  histogram.Observe(0.1);
+  histogram.Observe(0.5);
+  histogram.Observe(5);
+  EXPECT_EQ(histogram.count(), 4UL);
+  EXPECT_EQ(histogram.bucket_count(0), 2UL);
+  EXPECT_EQ(histogram.bucket_count(1), 1UL);
+  EXPECT_EQ(histogram.bucket_count(2), 1UL);
+  EXPECT_NEAR(histogram.sum(), 5.65, 1e-6);
+
+  auto* latency = MetricsRegistry::Instance().GetHistogram(
+      "test_latency_seconds", "latency", "rpc=\"Send\"", {0.1, 1});
+  latency->Observe(0.5);
+  std::string text = MetricsRegistry::Instance().ExportText();
+  EXPECT_NE(text.find("test_latency_seconds_bucket{rpc=\"Send\",le=\"0.1\"} "
+                      "0\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("test_latency_seconds_bucket{rpc=\"Send\",le=\"1\"} "
+                      "1\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("test_latency_seconds_bucket{rpc=\"Send\",le=\"+Inf\"} "
+                      "1\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("test_latency_seconds_count{rpc=\"Send\"} 1\n"),
+            std::string::npos);
+}
+
+static std::string HttpGet(int port, const std::string& path) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  EXPECT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+  std::string request = "GET " + path + " HTTP/1.1\r\n\r\n";
+  EXPECT_EQ(send(fd, request.data(), request.size(), 0),
+            static_cast<ssize_t>(request.size()));
+  std::string response;
+  char buf[1024];
+  ssize_t n;
+  while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) {
+    response.append(buf, n);
+  }
+  close(fd);
+  return response;
+}
+
+TEST(RPCMetrics, HttpServer) {
+  MetricsRegistry::Instance().GetCounter("test_http_total", "http")->Add();
+  MetricsHttpServer server(0);
+  ASSERT_GT(server.port(), 0);
+  std::string response = HttpGet(server.port(), "/metrics");
+  EXPECT_EQ(response.find("HTTP/1.0 200 OK\r\n"), 0UL);
+  EXPECT_NE(response.find("test_http_total 1\n"), std::string::npos);
+  response = HttpGet(server.port(), "/other");
+  EXPECT_EQ(response.find("HTTP/1.0 404"), 0UL);
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
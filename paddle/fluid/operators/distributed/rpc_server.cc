@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <limits>
@@ -24,6 +25,10 @@ DEFINE_int32(rpc_server_profile_period, 0,
              "the period of listen_and_serv to do profile");
 DEFINE_string(rpc_server_profile_path, "/dev/null",
               "the profile log file path");
+DEFINE_int32(rpc_server_metrics_port, -1,
+             "the port of listen_and_serv to serve the metrics on /metrics "
+             "in the Prometheus text format, 0 to choose a free port and "
+             "-1 to disable it");
 
 namespace paddle {
 namespace operators {
@@ -63,6 +68,7 @@ void RPCServer::ShutDown() {
   exit_flag_ = true;
   barrier_cond_.notify_all();
   rpc_cond_.notify_all();
+  metrics_server_.reset();
 }
 
 void RPCServer::SavePort() const {
@@ -75,6 +81,10 @@ void RPCServer::SavePort() const {
 }
 
 void RPCServer::WaitBarrier(const std::string& rpc_name) {
+  ScopedLatency latency(MetricsRegistry::Instance().GetHistogram(
+      "pserver_barrier_wait_seconds",
+      "The time waiting for all the trainers at the barrier.",
+      MetricLabel("rpc", rpc_name)));
   std::unique_lock<std::mutex> lock(this->mutex_);
   barrier_cond_.wait(lock, [this, &rpc_name] {
     return ((barrier_counter_[rpc_name] == client_num_ && client_num_ != 0) ||
@@ -121,6 +131,52 @@ int RPCServer::GetClientNum() {
   return client_num_;
 }
 
+void RPCServer::SetStaleness(int staleness) {
+  PADDLE_ENFORCE_GE(staleness, 0, "staleness should not be negative");
+  std::unique_lock<std::mutex> lock(mutex_);
+  staleness_ = staleness;
+  trainer_clocks_.assign(client_num_, 0);
+}
+
+void RPCServer::IncreaseTrainerClock(int trainer_id) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    PADDLE_ENFORCE(trainer_id >= 0 &&
+                       trainer_id < static_cast<int>(trainer_clocks_.size()),
+                   "invalid trainer_id %d", trainer_id);
+    ++trainer_clocks_[trainer_id];
+    VLOG(4) << "trainer " << trainer_id << " clock "
+            << trainer_clocks_[trainer_id];
+  }
+  barrier_cond_.notify_all();
+}
+
+void RPCServer::FinishTrainerClock(int trainer_id) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (trainer_id < 0 ||
+        trainer_id >= static_cast<int>(trainer_clocks_.size())) {
+      return;
+    }
+    trainer_clocks_[trainer_id] = std::numeric_limits<int64_t>::max();
+  }
+  barrier_cond_.notify_all();
+}
+
+void RPCServer::WaitTrainerClock(int trainer_id) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (trainer_id < 0 ||
+      trainer_id >= static_cast<int>(trainer_clocks_.size())) {
+    return;
+  }
+  barrier_cond_.wait(lock, [this, trainer_id] {
+    int64_t slowest = *std::min_element(trainer_clocks_.begin(),
+                                        trainer_clocks_.end());
+    return trainer_clocks_[trainer_id] - slowest <= staleness_ ||
+           exit_flag_.load();
+  });
+}
+
 void RPCServer::ResetBarrierCounter() {
   VLOG(3) << "RPCServer ResetBarrierCounter ";
   std::unique_lock<std::mutex> lock(mutex_);
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <atomic>
+#include <memory>
 #include <set>
 #include <string>
 #include <thread>  // NOLINT
@@ -22,9 +23,11 @@
 #include <vector>
 
 #include "paddle/fluid/operators/distributed/request_handler.h"
+#include "paddle/fluid/operators/distributed/rpc_metrics.h"
 
 DECLARE_int32(rpc_server_profile_period);
 DECLARE_string(rpc_server_profile_path);
+DECLARE_int32(rpc_server_metrics_port);
 
 namespace paddle {
 namespace operators {
@@ -51,7 +54,13 @@ class RPCServer {
         exit_flag_(false),
         selected_port_(0),
         client_num_(client_num),
-        need_reset_all_vars_(false) {}
+        need_reset_all_vars_(false),
+        staleness_(0) {
+    if (FLAGS_rpc_server_metrics_port >= 0) {
+      metrics_server_.reset(
+          new MetricsHttpServer(FLAGS_rpc_server_metrics_port));
+    }
+  }
 
   virtual ~RPCServer() {}
   virtual void StartServer() = 0;
@@ -90,6 +99,17 @@ class RPCServer {
 
   bool NeedResetAllVars();
 
+  // Bounded staleness for the async mode: every batch barrier of a trainer
+  // advances its clock, and a trainer getting the parameters waits until
+  // it is at most staleness steps ahead of the slowest trainer. 0 means
+  // the trainers are never blocked.
+  void SetStaleness(int staleness);
+  int staleness() const { return staleness_; }
+  void IncreaseTrainerClock(int trainer_id);
+  // The completed trainers do not hold back the others any more.
+  void FinishTrainerClock(int trainer_id);
+  void WaitTrainerClock(int trainer_id);
+
  protected:
   virtual void ShutDownImpl() = 0;
 
@@ -103,6 +123,11 @@ class RPCServer {
   std::condition_variable rpc_cond_;
   RPCServerProfiler profiler_;
 
+  int staleness_;
+  std::vector<int64_t> trainer_clocks_;
+
+  std::unique_ptr<MetricsHttpServer> metrics_server_;
+
  protected:
   std::string bind_address_;
   std::atomic<int> exit_flag_;
@@ -13,8 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <unistd.h>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/block_desc.h"
@@ -63,6 +66,9 @@ void CreateVarsOnScope(framework::Scope* scope, platform::CPUPlace* place) {
 
   auto ids_var = scope->Var("ids");
   ids_var->GetMutable<framework::LoDTensor>();
+
+  auto x_var = scope->Var("x");
+  x_var->GetMutable<framework::LoDTensor>();
 }
 
 void InitTensorsOnClient(framework::Scope* scope, platform::CPUPlace* place,
@@ -181,3 +187,144 @@ TEST(COMPLETE, CPU) {
   g_rpc_service.reset(nullptr);
   g_req_handler.reset(nullptr);
 }
+
+TEST(STALENESS, CPU) {
+  g_rpc_service.reset(new RPCSERVER_T("127.0.0.1:0", 2));
+  g_rpc_service->SetStaleness(1);
+
+  // trainer 0 is one step ahead of trainer 1, still in the bound
+  g_rpc_service->IncreaseTrainerClock(0);
+  g_rpc_service->WaitTrainerClock(0);
+
+  // trainer 0 is two steps ahead, it waits until trainer 1 catches up
+  g_rpc_service->IncreaseTrainerClock(0);
+  std::atomic<bool> released(false);
+  std::thread get_thread([&released] {
+    g_rpc_service->WaitTrainerClock(0);
+    released = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_FALSE(released.load());
+  g_rpc_service->IncreaseTrainerClock(1);
+  get_thread.join();
+  EXPECT_TRUE(released.load());
+
+  // a completed trainer does not hold back the others
+  g_rpc_service->IncreaseTrainerClock(0);
+  g_rpc_service->IncreaseTrainerClock(0);
+  g_rpc_service->FinishTrainerClock(1);
+  g_rpc_service->WaitTrainerClock(0);
+
+  g_rpc_service.reset(nullptr);
+}
+
+// A send benchmark of a large dense tensor, the throughput is logged.
+TEST(SENDRECV, LargeTensor) {
+  g_req_handler.reset(new distributed::RequestSendHandler(true));
+  g_rpc_service.reset(new RPCSERVER_T("127.0.0.1:0", 1));
+  distributed::RPCClient* client =
+      distributed::RPCClient::GetInstance<RPCCLIENT_T>(0);
+  PADDLE_ENFORCE(client != nullptr);
+  std::thread server_thread(StartServer, distributed::kRequestSend);
+  g_rpc_service->WaitServerReady();
+  g_rpc_service->SetCond(distributed::kRequestSend);
+  int port = g_rpc_service->GetSelectedPort();
+  std::string ep = paddle::string::Sprintf("127.0.0.1:%d", port);
+
+  framework::Scope scope;
+  platform::CPUPlace place;
+  platform::CPUDeviceContext ctx(place);
+  CreateVarsOnScope(&scope, &place);
+  const int64_t numel = 1 << 24;  // 64MB of float
+  auto* x = scope.Var("x")->GetMutable<framework::LoDTensor>();
+  auto* x_data = x->mutable_data<float>(framework::make_ddim({numel}), place);
+  for (int64_t i = 0; i < numel; ++i) {
+    x_data[i] = static_cast<float>(i % 1024);
+  }
+
+  const int repeat = 10;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeat; ++i) {
+    client->AsyncSendVar(ep, ctx, scope, "x");
+    client->Wait();
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  double mb = static_cast<double>(numel * sizeof(float) * repeat) / (1 << 20);
+  LOG(INFO) << "sent " << mb << "MB in " << elapsed.count() << "s, "
+            << mb / elapsed.count() << "MB/s";
+
+  auto* server_x =
+      g_req_handler->scope()->FindVar("x")->GetMutable<framework::LoDTensor>();
+  ASSERT_EQ(server_x->numel(), numel);
+  auto* server_data = server_x->data<float>();
+  for (int64_t i = 0; i < numel; i += 4099) {
+    EXPECT_EQ(server_data[i], static_cast<float>(i % 1024));
+  }
+
+  g_rpc_service->ShutDown();
+  server_thread.join();
+  g_rpc_service.reset(nullptr);
+  g_req_handler.reset(nullptr);
+}
+
+// A send benchmark of many small variables to one endpoint, which is bound
+// by the polling of the client; compare the logged throughput with the
+// different --rpc_client_cq_num and --rpc_client_channel_num.
+TEST(SENDRECV, ManySmallVars) {
+  g_req_handler.reset(new distributed::RequestSendHandler(true));
+  g_rpc_service.reset(new RPCSERVER_T("127.0.0.1:0", 1));
+  distributed::RPCClient* client =
+      distributed::RPCClient::GetInstance<RPCCLIENT_T>(0);
+  PADDLE_ENFORCE(client != nullptr);
+  std::thread server_thread(StartServer, distributed::kRequestSend);
+  g_rpc_service->WaitServerReady();
+  g_rpc_service->SetCond(distributed::kRequestSend);
+  int port = g_rpc_service->GetSelectedPort();
+  std::string ep = paddle::string::Sprintf("127.0.0.1:%d", port);
+
+  framework::Scope scope;
+  platform::CPUPlace place;
+  platform::CPUDeviceContext ctx(place);
+  const int num_vars = 256;
+  const int64_t numel = 1024;  // 4KB of float
+  std::vector<std::string> names;
+  for (int i = 0; i < num_vars; ++i) {
+    names.push_back("small_" + std::to_string(i));
+    auto* t = scope.Var(names.back())->GetMutable<framework::LoDTensor>();
+    auto* data = t->mutable_data<float>(framework::make_ddim({numel}), place);
+    for (int64_t j = 0; j < numel; ++j) {
+      data[j] = static_cast<float>(i);
+    }
+    g_req_handler->scope()->Var(names.back());
+  }
+
+  const int repeat = 20;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeat; ++i) {
+    for (auto& name : names) {
+      client->AsyncSendVar(ep, ctx, scope, name);
+    }
+    ASSERT_TRUE(client->Wait());
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  double sends = static_cast<double>(num_vars) * repeat;
+  LOG(INFO) << "sent " << sends << " variables in " << elapsed.count()
+            << "s, " << sends / elapsed.count() << " variables/s, "
+            << sends * numel * sizeof(float) / (1 << 20) / elapsed.count()
+            << "MB/s";
+
+  for (int i = 0; i < num_vars; i += 37) {
+    auto* server_t = g_req_handler->scope()
+                         ->FindVar(names[i])
+                         ->GetMutable<framework::LoDTensor>();
+    ASSERT_EQ(server_t->numel(), numel);
+    EXPECT_EQ(server_t->data<float>()[numel - 1], static_cast<float>(i));
+  }
+
+  g_rpc_service->ShutDown();
+  server_thread.join();
+  g_rpc_service.reset(nullptr);
+  g_req_handler.reset(nullptr);
+}
@@ -38,7 +38,7 @@ void* GetVarPayLoad(const std::string varname, int64_t size) {
 void GetTensorPayload(framework::Variable* var,
                       const platform::DeviceContext& ctx, VarMsg* request,
                       void** payload, size_t* payload_size) {
-  auto tensor = var->Get<framework::LoDTensor>();
+  auto& tensor = var->Get<framework::LoDTensor>();
   // FIXME(wuyi): data types in send_recv.proto is copied from
   // framework.proto
   request->set_data_type(
@@ -73,7 +73,7 @@ void GetTensorPayload(framework::Variable* var,
     ctx.Wait();
 #endif
   } else {
-    *payload = tensor.data<void>();
+    *payload = const_cast<void*>(tensor.data<void>());
   }
   *payload_size = tensor.numel() * framework::SizeOfType(tensor.type());
 }
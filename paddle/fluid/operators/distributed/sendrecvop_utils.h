@@ -24,6 +24,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/framework/var_type.h"
+#include "paddle/fluid/platform/float16.h"
 
 #include "paddle/fluid/operators/distributed/send_recv.pb.h"
 
@@ -43,6 +44,8 @@ void GetSelectedRowsPayload(framework::Variable* var,
 
 inline std::type_index ToTypeIndex(sendrecv::VariableMessage::Type type) {
   switch (type) {
+    case sendrecv::VariableMessage::FP16:
+      return typeid(platform::float16);  // NOLINT
     case sendrecv::VariableMessage::FP32:
       return typeid(float);  // NOLINT
     case sendrecv::VariableMessage::FP64:
@@ -13,13 +13,41 @@
 // limitations under the License.
 
 #include "paddle/fluid/operators/distributed/variable_response.h"
+#include <algorithm>
+#include <cstring>
 #include <vector>
+#include "gflags/gflags.h"
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/operators/distributed/grad_compression.h"
 #include "paddle/fluid/operators/distributed/sendrecvop_utils.h"
 
+DEFINE_int64(rpc_deserialize_section_bytes, 1 << 20,
+             "The bytes of a section of a received payload on CPU, the "
+             "payloads of two sections or more are copied into the variable "
+             "by the RPC threads in parallel. 0 to copy them on the polling "
+             "thread.");
+
 namespace paddle {
 namespace operators {
 namespace distributed {
 
+namespace {
+
+// A piece of a payload contiguous in a buffer of the message.
+struct CopyPiece {
+  char* dest;
+  const char* src;
+  int size;
+};
+
+void CopyPieces(const std::vector<CopyPiece>& pieces) {
+  for (auto& piece : pieces) {
+    std::memcpy(piece.dest, piece.src, piece.size);
+  }
+}
+
+}  // namespace
+
 bool VariableResponse::ReadRaw(::google::protobuf::io::CodedInputStream* input,
                                const platform::DeviceContext& dev_ctx,
                                platform::Place place, void* dest,
@@ -63,6 +91,13 @@ bool VariableResponse::ReadRaw(::google::protobuf::io::CodedInputStream* input,
     return true;
   }
 
+  // The pieces of a big payload are grouped into the sections, which are
+  // copied by the RPC threads, and the last one by this thread.
+  const int64_t section_bytes = FLAGS_rpc_deserialize_section_bytes;
+  const bool by_sections = section_bytes > 0 && length >= 2 * section_bytes;
+  std::vector<CopyPiece> section;
+  int64_t section_size = 0;
+
   char* p = reinterpret_cast<char*>(dest);
   while (total_written < length) {
     if (!input->GetDirectBufferPointer(&data, &size_to_write)) {
@@ -73,17 +108,35 @@ bool VariableResponse::ReadRaw(::google::protobuf::io::CodedInputStream* input,
     if (total_written + size_to_write > length) {
       size_to_write = length - total_written;
     }
-    // TODO(gongwb): can we avoid copy?
-    platform::CPUPlace cpu;
     // This log is useful to see how long a internal block size is of rpc.
     VLOG(7) << "copy " << size_to_write << " data to CPUPlace";
-    memory::Copy(cpu, reinterpret_cast<void*>(p), cpu, data, size_to_write);
+    if (by_sections) {
+      const char* src = reinterpret_cast<const char*>(data);
+      for (int offset = 0; offset < size_to_write;) {
+        int size = static_cast<int>(std::min<int64_t>(
+            size_to_write - offset, section_bytes - section_size));
+        section.push_back({p + offset, src + offset, size});
+        section_size += size;
+        offset += size;
+        if (section_size == section_bytes) {
+          sections_.push_back(
+              framework::AsyncRPC([section] { CopyPieces(section); }));
+          section.clear();
+          section_size = 0;
+        }
+      }
+    } else {
+      // TODO(gongwb): can we avoid copy?
+      platform::CPUPlace cpu;
+      memory::Copy(cpu, reinterpret_cast<void*>(p), cpu, data, size_to_write);
+    }
 
     p += size_to_write;
     total_written += size_to_write;
 
     input->Skip(size_to_write);
   }
+  CopyPieces(section);
 
   return true;
 }
@@ -92,13 +145,13 @@ bool VariableResponse::CopyLodTensorData(
     ::google::protobuf::io::CodedInputStream* input,
     const platform::DeviceContext& ctx, const framework::DDim& dims,
     int length) {
-  auto server_var = GetVar();
+  auto server_var = GetParseVar();
   if (!server_var) {
     LOG(ERROR) << "recved var should not on current server: "
                << meta_.varname();
     return false;
   }
-  auto* tensor = GetVar()->GetMutable<framework::LoDTensor>();
+  auto* tensor = server_var->GetMutable<framework::LoDTensor>();
   tensor->Resize(dims);
   framework::LoD lod;
   for (int i = 0; i < meta_.lod_level(); ++i) {
@@ -132,7 +185,7 @@ bool VariableResponse::CopySelectRowsTensorData(
     ::google::protobuf::io::CodedInputStream* input,
     const platform::DeviceContext& ctx, const framework::DDim& dims,
     int length) {
-  auto* slr = GetVar()->GetMutable<framework::SelectedRows>();
+  auto* slr = GetParseVar()->GetMutable<framework::SelectedRows>();
   slr->set_height(meta_.slr_height());
   auto* tensor = slr->mutable_value();
   tensor->Resize(dims);
@@ -154,7 +207,7 @@ bool VariableResponse::CopySelectRowsTensorData(
 bool VariableResponse::CopySelectRowsData(
     ::google::protobuf::io::CodedInputStream* input,
     const platform::DeviceContext& ctx, int length) {
-  auto* slr = GetVar()->GetMutable<framework::SelectedRows>();
+  auto* slr = GetParseVar()->GetMutable<framework::SelectedRows>();
   slr->mutable_rows()->clear();
   slr->mutable_rows()->resize(length /
                               framework::SizeOfType(typeid(int64_t)));  // int64
@@ -169,6 +222,27 @@ bool VariableResponse::CopySelectRowsData(
   return true;
 }
 
+void VariableResponse::WaitSections() {
+  for (auto& section : sections_) {
+    section.get();
+  }
+  sections_.clear();
+}
+
+bool VariableResponse::Decompress() {
+  if (!IsCompressed()) return true;
+  auto* var = GetVar();
+  if (var == nullptr) {
+    LOG(ERROR) << "recved var should not on current server: "
+               << meta_.varname();
+    return false;
+  }
+  DecompressVariable(static_cast<CompressType>(meta_.compress_type()),
+                     compressed_var_, GetDims(meta_.dense_dims()), *dev_ctx_,
+                     var);
+  return true;
+}
+
 bool VariableResponse::ProcSerializedField(
     int tag, ::google::protobuf::io::CodedInputStream* input,
     int64_t num_bytes) {
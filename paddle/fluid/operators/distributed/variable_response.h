@@ -14,7 +14,9 @@
 
 #pragma once
 
+#include <future>  // NOLINT
 #include <string>
+#include <vector>
 
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/lod_tensor.h"
@@ -94,7 +96,26 @@ class VariableResponse {
 
   int GetTrainerId() { return static_cast<int>(meta_.trainer_id()); }
 
+  bool IsCompressed() const {
+    return meta_.compress_type() != sendrecv::CompressType::NONE;
+  }
+
+  // Decompress the received compressed gradient into GetVar(), should be
+  // called after all the fields are parsed.
+  bool Decompress();
+
+  // Wait for the sections of the payloads being copied by the RPC threads,
+  // which read the buffers of the source, so it should be called before the
+  // source is released and before the variable is used.
+  void WaitSections();
+
  protected:
+  // The variable that the payload is parsed into, which is a temporary one
+  // if the message is compressed.
+  framework::Variable* GetParseVar() {
+    return IsCompressed() ? &compressed_var_ : GetVar();
+  }
+
   bool ReadRaw(::google::protobuf::io::CodedInputStream* input,
                const platform::DeviceContext& dev_ctx, platform::Place place,
                void* dest, int64_t size);
@@ -121,6 +142,9 @@ class VariableResponse {
   framework::Scope* local_scope_ = nullptr;
 
   sendrecv::VariableMessage meta_;
+  framework::Variable compressed_var_;
+  // The sections of the payloads of the variable being copied.
+  std::vector<std::future<void>> sections_;
 };
 
 };  // namespace distributed
@@ -0,0 +1,506 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/verbs_client.h"
+
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <set>
+#include <vector>
+
+#include "glog/logging.h"  // For VLOG
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/operators/distributed/verbs_serde.h"
+#include "paddle/fluid/platform/profiler.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+struct VerbsClient::Connection {
+  std::unique_ptr<VerbsChannel> channel;
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::vector<int> free_slots;
+  std::vector<std::unique_ptr<Call>> calls;
+  // The variables sent and received by the calls in flight. The buffers of
+  // a variable are used by one call at a time.
+  std::set<std::string> sending_vars;
+  std::set<std::string> receiving_vars;
+  // The buffers of the server which the sent variables are written to.
+  std::unordered_map<std::string, VerbsRegion> remote_buffers;
+  // The buffers that the sent variables are serialized into, and the ones
+  // that the server writes the received variables to.
+  std::unordered_map<std::string, std::unique_ptr<VerbsBuffer>> send_buffers;
+  std::unordered_map<std::string, std::unique_ptr<VerbsBuffer>> recv_buffers;
+};
+
+struct VerbsClient::Call {
+  VarHandlePtr handle;
+  Connection* conn = nullptr;
+  int slot = -1;
+  VerbsMethod method;
+  std::string send_var;
+  std::string recv_var;
+  // The serialized meta of the request.
+  std::string meta;
+  size_t payload_size = 0;
+  std::chrono::steady_clock::time_point deadline;
+  // The call has failed by the deadline, and waits for the reply to free
+  // its slot.
+  bool expired = false;
+};
+
+VerbsClient::VerbsClient() : ok_(true), completed_(false), stopped_(false) {}
+
+void VerbsClient::InitImpl() {
+  events_ = ibv_create_comp_channel(VerbsDevice::Instance().context());
+  PADDLE_ENFORCE_NOT_NULL(events_, "Failed to create the events channel.");
+  // start the client process thread
+  client_thread_.reset(
+      new std::thread(std::bind(&VerbsClient::Proceed, this)));
+}
+
+VerbsClient::~VerbsClient() {
+  Wait();
+  stopped_ = true;
+  if (client_thread_) {
+    client_thread_->join();
+  }
+  {
+    std::lock_guard<std::mutex> guard(channel_mutex_);
+    channel_conns_.clear();
+  }
+  {
+    std::lock_guard<std::mutex> guard(conn_mutex_);
+    connections_.clear();
+  }
+  if (events_ != nullptr) {
+    ibv_destroy_comp_channel(events_);
+  }
+}
+
+void VerbsClient::SendComplete() {
+  std::unique_lock<std::mutex> lk(completed_mutex_);
+  if (!completed_) {
+    std::vector<std::string> eps;
+    {
+      std::lock_guard<std::mutex> guard(conn_mutex_);
+      for (auto& it : connections_) {
+        eps.push_back(it.first);
+      }
+    }
+    for (auto& ep : eps) {
+      VLOG(3) << "send complete message to " << ep;
+      this->AsyncSendComplete(ep);
+    }
+    PADDLE_ENFORCE(this->Wait(), "internal verbs error");
+    completed_ = true;
+  }
+}
+
+VarHandlePtr VerbsClient::AsyncSendVar(const std::string& ep,
+                                       const platform::DeviceContext& ctx,
+                                       const framework::Scope& scope,
+                                       const std::string& var_name,
+                                       int64_t time_out) {
+  VarHandlePtr h(new VarHandle(ep, "SendRPC", var_name, &ctx, &scope));
+  return AsyncCall(h, VerbsMethod::kSendVariable, var_name, "", "",
+                   time_out);
+}
+
+VarHandlePtr VerbsClient::AsyncGetVar(const std::string& ep,
+                                      const platform::DeviceContext& ctx,
+                                      const framework::Scope& scope,
+                                      const std::string& var_name,
+                                      int64_t time_out) {
+  VarHandlePtr h(new VarHandle(ep, "GetRPC", var_name, &ctx, &scope));
+  return AsyncCall(h, VerbsMethod::kGetVariable, "", var_name, "",
+                   time_out);
+}
+
+VarHandlePtr VerbsClient::AsyncPrefetchVar(const std::string& ep,
+                                           const platform::DeviceContext& ctx,
+                                           const framework::Scope& scope,
+                                           const std::string& in_var_name,
+                                           const std::string& out_var_name,
+                                           int64_t time_out) {
+  VarHandlePtr h(
+      new VarHandle(ep, "PrefetchRPC", out_var_name, &ctx, &scope));
+  return AsyncCall(h, VerbsMethod::kPrefetchVariable, in_var_name,
+                   out_var_name, out_var_name, time_out);
+}
+
+VarHandlePtr VerbsClient::AsyncSendBatchBarrier(const std::string& ep,
+                                                int64_t time_out) {
+  VarHandlePtr h(new VarHandle(ep, "BatchBarrierRPC", BATCH_BARRIER_MESSAGE,
+                               nullptr, nullptr));
+  return AsyncCall(h, VerbsMethod::kSendVariable, "", "", "", time_out);
+}
+
+VarHandlePtr VerbsClient::AsyncSendFetchBarrier(const std::string& ep,
+                                                int64_t time_out) {
+  VarHandlePtr h(new VarHandle(ep, "FetchBarrierRPC", FETCH_BARRIER_MESSAGE,
+                               nullptr, nullptr));
+  return AsyncCall(h, VerbsMethod::kGetVariable, "", "", "", time_out);
+}
+
+VarHandlePtr VerbsClient::AsyncSendComplete(const std::string& ep,
+                                            int64_t time_out) {
+  VarHandlePtr h(
+      new VarHandle(ep, "SendCompleteRPC", COMPLETE_MESSAGE, nullptr, nullptr));
+  return AsyncCall(h, VerbsMethod::kSendVariable, "", "", "", time_out);
+}
+
+VarHandlePtr VerbsClient::AsyncCheckpointNotify(const std::string& ep,
+                                                const std::string& dir,
+                                                int64_t time_out) {
+  VarHandlePtr h(new VarHandle(ep, "CheckPointNotifyRPC",
+                               CHECKPOINT_SAVE_MESSAGE, nullptr, nullptr));
+  return AsyncCall(h, VerbsMethod::kCheckpointNotify, "", "", dir,
+                   time_out);
+}
+
+VarHandlePtr VerbsClient::AsyncCall(VarHandlePtr h, VerbsMethod method,
+                                    const std::string& send_var,
+                                    const std::string& recv_var,
+                                    const std::string& out_name,
+                                    int64_t time_out) {
+  req_count_++;
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::milliseconds(time_out);
+  framework::AsyncRPC([h, method, send_var, recv_var, out_name, deadline,
+                       this] {
+    Call* call = new Call;
+    call->handle = h;
+    call->method = method;
+    call->send_var = send_var;
+    call->recv_var = recv_var;
+    call->deadline = deadline;
+    try {
+      call->conn = GetConnection(h->ep());
+      VLOG(3) << h->String() << " begin";
+      platform::RecordRPCEvent record_event(h->method(), h->ctx());
+
+      TakeSlot(call);
+      sendrecv::VariableMessage meta;
+      if (!send_var.empty()) {
+        auto* var = h->scope()->FindVar(send_var);
+        PADDLE_ENFORCE_NOT_NULL(var, "Can not find variable %s to send",
+                                send_var);
+        std::unique_ptr<VerbsBuffer>* buffer = nullptr;
+        {
+          std::lock_guard<std::mutex> guard(call->conn->mutex);
+          buffer = &call->conn->send_buffers[send_var];
+        }
+        call->payload_size = SerializeToVerbsMessage(
+            send_var, var, *h->ctx(),
+            [buffer](size_t size) {
+              EnsureVerbsBuffer(size, buffer);
+              return (*buffer)->data();
+            },
+            &meta, out_name, trainer_id_);
+      } else {
+        meta.set_varname(h->name());
+        meta.set_trainer_id(trainer_id_);
+        if (!out_name.empty()) {
+          meta.set_out_varname(out_name);
+        }
+      }
+      call->meta = meta.SerializeAsString();
+      PostCall(call);
+    } catch (std::exception& e) {
+      LOG(ERROR) << h->String() << " failed: " << e.what();
+      if (call->slot >= 0) {
+        FinishCall(call->conn, call->slot, false);
+      } else {
+        h->Finish(false);
+        delete call;
+        DoneRequest(false);
+      }
+      return;
+    }
+
+    if (UNLIKELY(platform::IsProfileEnabled())) {
+      h->Wait();
+    }
+  });
+  return h;
+}
+
+void VerbsClient::TakeSlot(Call* call) {
+  auto* conn = call->conn;
+  std::unique_lock<std::mutex> lock(conn->mutex);
+  bool taken = conn->cond.wait_until(lock, call->deadline, [conn, call] {
+    return !conn->free_slots.empty() &&
+           (call->send_var.empty() ||
+            conn->sending_vars.count(call->send_var) == 0) &&
+           (call->recv_var.empty() ||
+            conn->receiving_vars.count(call->recv_var) == 0);
+  });
+  PADDLE_ENFORCE(taken, "exceed the deadline waiting for a free slot");
+  call->slot = conn->free_slots.back();
+  conn->free_slots.pop_back();
+  conn->calls[call->slot].reset(call);
+  if (!call->send_var.empty()) conn->sending_vars.insert(call->send_var);
+  if (!call->recv_var.empty()) conn->receiving_vars.insert(call->recv_var);
+}
+
+void VerbsClient::PostCall(Call* call) {
+  auto* conn = call->conn;
+  VerbsMessageHeader header;
+  std::memset(&header, 0, sizeof(header));
+  header.method = call->method;
+  header.status = VerbsStatus::kOK;
+  header.payload_size = call->payload_size;
+  const VerbsBuffer* payload = nullptr;
+  VerbsRegion remote;
+  {
+    std::lock_guard<std::mutex> guard(conn->mutex);
+    if (!call->send_var.empty()) {
+      header.has_var = 1;
+      auto it = conn->remote_buffers.find(call->send_var);
+      if (it == conn->remote_buffers.end() ||
+          it->second.size < call->payload_size) {
+        // Ask the server for a buffer first, the payload is written by the
+        // next post of the call.
+        header.status = VerbsStatus::kNeedBuffer;
+      } else {
+        remote = it->second;
+        payload = conn->send_buffers[call->send_var].get();
+      }
+    }
+    if (!call->recv_var.empty()) {
+      auto& buffer = conn->recv_buffers[call->recv_var];
+      if (buffer != nullptr) {
+        header.region = buffer->Region();
+      }
+    }
+  }
+  conn->channel->PostMessage(call->slot, header, call->meta, payload,
+                             payload != nullptr ? call->payload_size : 0,
+                             remote);
+}
+
+void VerbsClient::ProcessReply(Connection* conn, int slot) {
+  std::string meta_str;
+  VerbsMessageHeader header = conn->channel->ReadMessage(slot, &meta_str);
+  conn->channel->PostRecv();
+
+  Call* call = nullptr;
+  const VerbsBuffer* recv_buffer = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(conn->mutex);
+    call = conn->calls[slot].get();
+    if (call == nullptr) {
+      LOG(ERROR) << "receive a reply without request at slot " << slot;
+      return;
+    }
+    if (call->expired) {
+      call = nullptr;
+    } else if (header.status == VerbsStatus::kNeedBuffer) {
+      if (header.has_var) {
+        EnsureVerbsBuffer(header.payload_size,
+                          &conn->recv_buffers[call->recv_var]);
+      } else {
+        conn->remote_buffers[call->send_var] = header.region;
+      }
+    } else if (header.status == VerbsStatus::kOK && header.has_var) {
+      recv_buffer = conn->recv_buffers[call->recv_var].get();
+    }
+  }
+  // the late reply of an expired call only frees the slot
+  if (call == nullptr) {
+    FinishCall(conn, slot, false);
+    return;
+  }
+
+  if (header.status == VerbsStatus::kNeedBuffer) {
+    VLOG(3) << call->handle->String() << " exchanges the buffer of "
+            << header.payload_size << " bytes";
+    PostCall(call);
+    return;
+  }
+
+  bool ok = header.status == VerbsStatus::kOK;
+  if (ok && header.has_var) {
+    auto& h = call->handle;
+    sendrecv::VariableMessage meta;
+    ok = recv_buffer != nullptr && meta.ParseFromString(meta_str);
+    if (ok) {
+      auto* var = h->scope()->FindVar(meta.varname());
+      ok = DeserializeFromVerbsMessage(meta, recv_buffer->data(),
+                                       header.payload_size, *h->ctx(), var);
+    }
+  }
+  if (!ok) {
+    LOG(ERROR) << call->handle->String() << " meets verbs error";
+  }
+  FinishCall(conn, slot, ok);
+}
+
+void VerbsClient::FinishCall(Connection* conn, int slot, bool ok) {
+  std::unique_ptr<Call> call;
+  {
+    std::lock_guard<std::mutex> guard(conn->mutex);
+    call = std::move(conn->calls[slot]);
+    if (call == nullptr) return;
+    conn->free_slots.push_back(slot);
+    conn->sending_vars.erase(call->send_var);
+    conn->receiving_vars.erase(call->recv_var);
+  }
+  conn->cond.notify_all();
+  // the handle of an expired call is finished already
+  if (call->expired) return;
+
+  VLOG(3) << call->handle->String() << " process";
+  call->handle->Finish(ok);
+  DoneRequest(ok);
+}
+
+void VerbsClient::DoneRequest(bool ok) {
+  bool notify = false;
+  {
+    std::lock_guard<std::mutex> lk(sync_mutex_);
+    if (!ok) ok_ = false;
+    req_count_--;
+    notify = (req_count_ <= 0 || !ok);
+  }
+  if (notify) {
+    sync_cond_.notify_all();
+  }
+}
+
+void VerbsClient::ExpireCalls() {
+  std::vector<Connection*> conns;
+  {
+    std::lock_guard<std::mutex> guard(channel_mutex_);
+    for (auto& it : channel_conns_) {
+      conns.push_back(it.second);
+    }
+  }
+  auto now = std::chrono::steady_clock::now();
+  std::vector<VarHandlePtr> expired;
+  for (auto* conn : conns) {
+    std::lock_guard<std::mutex> guard(conn->mutex);
+    for (auto& call : conn->calls) {
+      if (call != nullptr && !call->expired && call->deadline <= now) {
+        call->expired = true;
+        expired.push_back(call->handle);
+      }
+    }
+  }
+  for (auto& h : expired) {
+    LOG(ERROR) << h->String() << " exceeds the deadline";
+    h->Finish(false);
+    DoneRequest(false);
+  }
+}
+
+bool VerbsClient::Wait() {
+  std::unique_lock<std::mutex> lk(sync_mutex_);
+  sync_cond_.wait(lk, [this] { return (req_count_ == 0 || ok_ == false); });
+  return ok_;
+}
+
+void VerbsClient::Proceed() {
+  const int kPollTimeoutMs = 100;
+  const int kPollBatch = 16;
+  ibv_wc wcs[kPollBatch];
+
+  VLOG(3) << "VerbsClient Proceed begin";
+  auto next_expire = std::chrono::steady_clock::now();
+  while (!stopped_) {
+    if (std::chrono::steady_clock::now() >= next_expire) {
+      ExpireCalls();
+      next_expire = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(kPollTimeoutMs);
+    }
+    VerbsChannel* channel = WaitVerbsEvent(events_, kPollTimeoutMs);
+    if (channel == nullptr) continue;
+    Connection* conn = nullptr;
+    {
+      std::lock_guard<std::mutex> guard(channel_mutex_);
+      conn = channel_conns_.at(channel);
+    }
+
+    int n = 0;
+    while ((n = channel->Poll(wcs, kPollBatch)) > 0) {
+      for (int i = 0; i < n; ++i) {
+        auto& wc = wcs[i];
+        if (wc.status != IBV_WC_SUCCESS) {
+          LOG(ERROR) << "verbs work completion error: "
+                     << ibv_wc_status_str(wc.status);
+          // The opcode of a failed completion is undefined, the failed
+          // request is known by the wr_id.
+          if (wc.wr_id != kVerbsRecvWrId) {
+            FinishCall(conn, static_cast<int>(wc.wr_id), false);
+          }
+          continue;
+        }
+        // The completions of the requests need nothing to do.
+        if (wc.opcode != IBV_WC_RECV_RDMA_WITH_IMM) continue;
+        int slot = static_cast<int>(ntohl(wc.imm_data));
+        try {
+          ProcessReply(conn, slot);
+        } catch (std::exception& e) {
+          LOG(ERROR) << "process the verbs reply error: " << e.what();
+          FinishCall(conn, slot, false);
+        }
+      }
+    }
+  }
+  VLOG(3) << "VerbsClient Proceed end";
+}
+
+VerbsClient::Connection* VerbsClient::GetConnection(const std::string& ep) {
+  std::lock_guard<std::mutex> guard(conn_mutex_);
+  auto it = connections_.find(ep);
+  if (it != connections_.end()) {
+    return it->second.get();
+  }
+
+  std::unique_ptr<Connection> conn(new Connection);
+  conn->channel.reset(
+      new VerbsChannel(events_, FLAGS_rdma_slot_num, FLAGS_rdma_slot_size));
+  conn->calls.resize(FLAGS_rdma_slot_num);
+  for (int i = FLAGS_rdma_slot_num - 1; i >= 0; --i) {
+    conn->free_slots.push_back(i);
+  }
+
+  int fd = TcpConnect(ep);
+  VerbsHandshake local = conn->channel->LocalHandshake();
+  VerbsHandshake remote;
+  TcpWriteAll(fd, &local, sizeof(local));
+  TcpReadAll(fd, &remote, sizeof(remote));
+  close(fd);
+  conn->channel->Connect(remote);
+  VLOG(3) << "connect to " << ep << " by verbs, qp_num: " << remote.qp_num;
+
+  auto* ret = conn.get();
+  {
+    std::lock_guard<std::mutex> channel_guard(channel_mutex_);
+    channel_conns_[ret->channel.get()] = ret;
+  }
+  connections_[ep] = std::move(conn);
+  return ret;
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
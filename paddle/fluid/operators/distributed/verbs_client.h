@@ -0,0 +1,144 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/operators/distributed/request_handler.h"
+#include "paddle/fluid/operators/distributed/rpc_client.h"
+#include "paddle/fluid/operators/distributed/verbs_utils.h"
+#include "paddle/fluid/platform/macros.h"  // for DISABLE_COPY_AND_ASSIGN
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// The RPCClient over RDMA verbs, see verbs_utils.h for the protocol. The
+// completions of all the connections are processed by one thread, like the
+// completion queue of GRPCClient.
+//
+// A request not replied within its time_out fails, and so does Wait(). The
+// errors of a connection are reported by its failed work completions.
+class VerbsClient : public RPCClient {
+ public:
+  VerbsClient();
+  virtual ~VerbsClient();
+
+  VarHandlePtr AsyncSendVar(const std::string& ep,
+                            const platform::DeviceContext& ctx,
+                            const framework::Scope& scope,
+                            const std::string& var_name,
+                            int64_t time_out = FLAGS_rpc_deadline) override;
+
+  VarHandlePtr AsyncGetVar(const std::string& ep,
+                           const platform::DeviceContext& ctx,
+                           const framework::Scope& scope,
+                           const std::string& var_name,
+                           int64_t time_out = FLAGS_rpc_deadline) override;
+
+  VarHandlePtr AsyncPrefetchVar(const std::string& ep,
+                                const platform::DeviceContext& ctx,
+                                const framework::Scope& scope,
+                                const std::string& in_var_name,
+                                const std::string& out_var_name,
+                                int64_t time_out = FLAGS_rpc_deadline) override;
+
+  VarHandlePtr AsyncSendBatchBarrier(
+      const std::string& ep, int64_t time_out = FLAGS_rpc_deadline) override;
+
+  VarHandlePtr AsyncSendFetchBarrier(
+      const std::string& ep, int64_t time_out = FLAGS_rpc_deadline) override;
+
+  VarHandlePtr AsyncCheckpointNotify(
+      const std::string& ep, const std::string& dir,
+      int64_t time_out = FLAGS_rpc_deadline) override;
+
+  VarHandlePtr AsyncSendComplete(
+      const std::string& ep, int64_t time_out = FLAGS_rpc_deadline) override;
+
+  bool Wait() override;
+
+  void SendComplete() override;
+
+ protected:
+  void InitImpl() override;
+
+ private:
+  struct Connection;
+  struct Call;
+
+  // Issue a request in the background. The variable send_var, if not
+  // empty, is sent with the request, and the variable recv_var, if not
+  // empty, is received from the reply into the scope of h. The request
+  // fails if it is not replied within time_out milliseconds.
+  VarHandlePtr AsyncCall(VarHandlePtr h, VerbsMethod method,
+                         const std::string& send_var,
+                         const std::string& recv_var,
+                         const std::string& out_name, int64_t time_out);
+
+  Connection* GetConnection(const std::string& ep);
+
+  // Take a free slot and the variables of the call, wait if they are used
+  // by the other calls.
+  void TakeSlot(Call* call);
+  // Post the request of the call, again if the server asks for a buffer.
+  void PostCall(Call* call);
+  void ProcessReply(Connection* conn, int slot);
+  void FinishCall(Connection* conn, int slot, bool ok);
+  // Fail the calls past their deadlines. Their slots are kept until the
+  // replies arrive, so that a late reply is not taken for another call.
+  void ExpireCalls();
+  // Count a finished request for Wait().
+  void DoneRequest(bool ok);
+
+  void Proceed();
+
+ private:
+  ibv_comp_channel* events_ = nullptr;
+  std::unique_ptr<std::thread> client_thread_;
+
+  // mutex for GetConnection thread safety
+  std::mutex conn_mutex_;
+  std::map<std::string, std::unique_ptr<Connection>> connections_;
+  // The connections of the channels, looked up by the client thread.
+  std::mutex channel_mutex_;
+  std::unordered_map<const VerbsChannel*, Connection*> channel_conns_;
+
+  // mutex for Wait client sync
+  std::mutex sync_mutex_;
+  std::condition_variable sync_cond_;
+  std::atomic<int64_t> req_count_{0};
+  bool ok_;
+
+  // mutex for sending complete message only once
+  std::mutex completed_mutex_;
+  bool completed_;
+
+  std::atomic<bool> stopped_;
+
+  DISABLE_COPY_AND_ASSIGN(VerbsClient);
+};
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,260 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef PADDLE_WITH_CUDA
+#include <nccl.h>
+#endif
+#include <cstring>
+#include <vector>
+
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/operators/distributed/grad_compression.h"
+#include "paddle/fluid/operators/distributed/sendrecvop_utils.h"
+#include "paddle/fluid/operators/distributed/verbs_serde.h"
+#include "paddle/fluid/platform/profiler.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// Copy the tensor data into the host buffer dst.
+static void CopyToHost(const framework::Tensor& tensor,
+                       const platform::DeviceContext& ctx, char* dst) {
+  size_t size = tensor.numel() * framework::SizeOfType(tensor.type());
+  if (size == 0) return;
+  platform::CPUPlace cpu;
+  if (platform::is_gpu_place(tensor.place())) {
+#ifdef PADDLE_WITH_CUDA
+    auto& gpu_dev_ctx = static_cast<const platform::CUDADeviceContext&>(ctx);
+    memory::Copy(cpu, dst, boost::get<platform::CUDAPlace>(tensor.place()),
+                 tensor.data<void>(), size, gpu_dev_ctx.stream());
+    ctx.Wait();
+#else
+    PADDLE_THROW("Unexpected branch");
+#endif
+  } else {
+    memory::Copy(cpu, dst, cpu, tensor.data<void>(), size);
+  }
+}
+
+// Copy size bytes of the host buffer src into the tensor memory dst.
+static void CopyFromHost(const char* src, size_t size,
+                         const platform::DeviceContext& ctx,
+                         platform::Place place, void* dst) {
+  if (size == 0) return;
+  platform::CPUPlace cpu;
+  if (platform::is_gpu_place(place)) {
+#ifdef PADDLE_WITH_CUDA
+    auto& gpu_dev_ctx = static_cast<const platform::CUDADeviceContext&>(ctx);
+    memory::Copy(boost::get<platform::CUDAPlace>(place), dst, cpu, src, size,
+                 gpu_dev_ctx.stream());
+    ctx.Wait();
+#else
+    PADDLE_THROW("Unexpected branch");
+#endif
+  } else {
+    memory::Copy(cpu, dst, cpu, src, size);
+  }
+}
+
+static framework::DDim ToDDim(
+    const ::google::protobuf::RepeatedField<::google::protobuf::int64>& dims) {
+  return framework::make_ddim(std::vector<int64_t>(dims.begin(), dims.end()));
+}
+
+size_t SerializeToVerbsMessage(const std::string& name,
+                               framework::Variable* var,
+                               const platform::DeviceContext& ctx,
+                               const PayloadAllocator& alloc,
+                               sendrecv::VariableMessage* meta,
+                               const std::string& out_name,
+                               const int trainer_id) {
+  platform::RecordRPCEvent record_event("serial", &ctx);
+  meta->set_varname(name);
+  meta->set_trainer_id(trainer_id);
+  if (platform::ShouldSendProfileState()) {
+    if (platform::IsProfileEnabled()) {
+      meta->set_profile(platform::kEnableProfiler);
+    } else {
+      meta->set_profile(platform::kDisableProfiler);
+    }
+  }
+  if (!out_name.empty()) {
+    meta->set_out_varname(out_name);
+  }
+
+  // Send the compressed gradient instead if it is configured by send_op,
+  // the same as SerializeToByteBuffer.
+  framework::Variable compressed;
+  const platform::DeviceContext* send_ctx = &ctx;
+  auto& compressor = GradientCompressor::Instance();
+  if (var->IsType<framework::LoDTensor>() &&
+      compressor.GetCompressType(name) != CompressType::kNone) {
+    CompressType compress_type;
+    if (compressor.Compress(name, *var, ctx, &compressed, &compress_type)) {
+      meta->set_compress_type(
+          static_cast<::sendrecv::CompressType>(compress_type));
+      for (auto dim :
+           framework::vectorize(var->Get<framework::LoDTensor>().dims())) {
+        meta->add_dense_dims(dim);
+      }
+      var = &compressed;
+      send_ctx = platform::DeviceContextPool::Instance().Get(
+          platform::CPUPlace());
+    }
+  }
+
+  size_t payload_size = 0;
+  if (var->IsType<framework::LoDTensor>()) {
+    meta->set_type(::sendrecv::LOD_TENSOR);
+    auto& tensor = var->Get<framework::LoDTensor>();
+    meta->set_data_type(static_cast<sendrecv::VariableMessage::Type>(
+        framework::ToDataType(tensor.type())));
+    for (auto dim : framework::vectorize(tensor.dims())) {
+      meta->add_dims(dim);
+    }
+    const framework::LoD& lod = tensor.lod();
+    if (lod.size() > 0) {
+      meta->set_lod_level(lod.size());
+      for (auto& each : lod) {
+        auto* lod_inner = meta->add_lod();
+        for (auto d : each) {
+          lod_inner->add_lod_data(d);
+        }
+      }
+    }
+    payload_size = tensor.numel() * framework::SizeOfType(tensor.type());
+    CopyToHost(tensor, *send_ctx, alloc(payload_size));
+  } else if (var->IsType<framework::SelectedRows>()) {
+    meta->set_type(::sendrecv::SELECTED_ROWS);
+    auto& slr = var->Get<framework::SelectedRows>();
+    auto& value = slr.value();
+    meta->set_data_type(static_cast<sendrecv::VariableMessage::Type>(
+        framework::ToDataType(value.type())));
+    meta->set_slr_height(slr.height());
+    for (auto dim : framework::vectorize(value.dims())) {
+      meta->add_dims(dim);
+    }
+    PADDLE_ENFORCE_EQ(static_cast<int64_t>(slr.rows().size()),
+                      value.dims()[0],
+                      "The rows of %s mismatch the dims of its value.", name);
+    size_t value_size = value.numel() * framework::SizeOfType(value.type());
+    size_t rows_size = slr.rows().size() * sizeof(int64_t);
+    payload_size = value_size + rows_size;
+    char* payload = alloc(payload_size);
+    CopyToHost(value, *send_ctx, payload);
+    if (rows_size > 0) {
+      std::memcpy(payload + value_size, slr.rows().data(), rows_size);
+    }
+#ifdef PADDLE_WITH_CUDA
+  } else if (var->IsType<ncclUniqueId>()) {
+    meta->set_type(::sendrecv::NCCL_ID);
+    payload_size = NCCL_UNIQUE_ID_BYTES;
+    std::memcpy(alloc(payload_size), var->Get<ncclUniqueId>().internal,
+                payload_size);
+#endif
+  } else {
+    PADDLE_THROW("Serialize does not support type: %s",
+                 typeid(var->Type()).name());
+  }
+  return payload_size;
+}
+
+bool DeserializeFromVerbsMessage(const sendrecv::VariableMessage& meta,
+                                 const char* payload, size_t payload_size,
+                                 const platform::DeviceContext& ctx,
+                                 framework::Variable* var) {
+  if (var == nullptr) {
+    LOG(ERROR) << "recved var should not on current server: "
+               << meta.varname();
+    return false;
+  }
+
+  if (meta.compress_type() != sendrecv::CompressType::NONE) {
+    // The compressed gradient is parsed on CPU then decompressed into var.
+    framework::Variable compressed;
+    sendrecv::VariableMessage compressed_meta(meta);
+    compressed_meta.set_compress_type(sendrecv::CompressType::NONE);
+    auto* cpu_ctx =
+        platform::DeviceContextPool::Instance().Get(platform::CPUPlace());
+    if (!DeserializeFromVerbsMessage(compressed_meta, payload, payload_size,
+                                     *cpu_ctx, &compressed)) {
+      return false;
+    }
+    DecompressVariable(static_cast<CompressType>(meta.compress_type()),
+                       compressed, ToDDim(meta.dense_dims()), ctx, var);
+    return true;
+  }
+
+  if (meta.type() == sendrecv::NCCL_ID) {
+#ifdef PADDLE_WITH_CUDA
+    if (payload_size != NCCL_UNIQUE_ID_BYTES) return false;
+    std::memcpy(var->GetMutable<ncclUniqueId>()->internal, payload,
+                payload_size);
+    return true;
+#else
+    PADDLE_THROW("Not compiled with CUDA!");
+#endif
+  }
+
+  auto dims = ToDDim(meta.dims());
+  auto type = ToTypeIndex(meta.data_type());
+  size_t value_size = framework::product(dims) * framework::SizeOfType(type);
+
+  if (meta.type() == sendrecv::LOD_TENSOR) {
+    if (value_size != payload_size) return false;
+    auto* tensor = var->GetMutable<framework::LoDTensor>();
+    tensor->Resize(dims);
+    framework::LoD lod;
+    for (int i = 0; i < meta.lod_level(); ++i) {
+      framework::Vector<size_t> v;
+      for (int j = 0; j < meta.lod(i).lod_data_size(); ++j) {
+        v.push_back(meta.lod(i).lod_data(j));
+      }
+      lod.push_back(v);
+    }
+    tensor->set_lod(lod);
+    void* data = tensor->mutable_data(ctx.GetPlace(), type);
+    CopyFromHost(payload, payload_size, ctx, tensor->place(), data);
+    return true;
+  }
+
+  if (meta.type() == sendrecv::SELECTED_ROWS) {
+    int64_t rows_num = dims.size() > 0 ? dims[0] : 0;
+    if (value_size + rows_num * sizeof(int64_t) != payload_size) return false;
+    auto* slr = var->GetMutable<framework::SelectedRows>();
+    slr->set_height(meta.slr_height());
+    auto* tensor = slr->mutable_value();
+    tensor->Resize(dims);
+    void* data = tensor->mutable_data(ctx.GetPlace(), type);
+    CopyFromHost(payload, value_size, ctx, tensor->place(), data);
+    // The rows may be unaligned after the value.
+    std::vector<int64_t> rows(rows_num);
+    if (rows_num > 0) {
+      std::memcpy(rows.data(), payload + value_size,
+                  rows_num * sizeof(int64_t));
+    }
+    slr->set_rows(framework::Vector<int64_t>(rows));
+    return true;
+  }
+
+  LOG(ERROR) << "Unknown variable type " << meta.type() << " of "
+             << meta.varname();
+  return false;
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,54 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/variable.h"
+#include "paddle/fluid/operators/distributed/send_recv.pb.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// Return the host buffer of at least size bytes to write a payload to.
+typedef std::function<char*(size_t size)> PayloadAllocator;
+
+// Serialize var into meta, which has no serialized field, and a payload
+// written into the buffer returned by alloc. The payload is the tensor
+// data, followed by the rows of a SelectedRows. Return the payload size.
+size_t SerializeToVerbsMessage(const std::string& name,
+                               framework::Variable* var,
+                               const platform::DeviceContext& ctx,
+                               const PayloadAllocator& alloc,
+                               sendrecv::VariableMessage* meta,
+                               const std::string& out_name = std::string(),
+                               const int trainer_id = 0);
+
+// Deserialize the meta and payload into var, on the place of ctx. Return
+// false if the payload does not match the meta.
+bool DeserializeFromVerbsMessage(const sendrecv::VariableMessage& meta,
+                                 const char* payload, size_t payload_size,
+                                 const platform::DeviceContext& ctx,
+                                 framework::Variable* var);
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,106 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/verbs_serde.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// Serialize var and parse the message back into out.
+static void RoundTrip(const std::string& name, framework::Variable* var,
+                      framework::Variable* out) {
+  platform::CPUDeviceContext ctx;
+  std::vector<char> buffer;
+  sendrecv::VariableMessage meta;
+  size_t payload_size = SerializeToVerbsMessage(
+      name, var, ctx,
+      [&buffer](size_t size) {
+        buffer.resize(size);
+        return buffer.data();
+      },
+      &meta, "", 1);
+  EXPECT_EQ(meta.varname(), name);
+  EXPECT_EQ(meta.trainer_id(), 1);
+
+  // The meta goes through the message slot as bytes.
+  std::string wire;
+  meta.SerializeToString(&wire);
+  sendrecv::VariableMessage parsed;
+  ASSERT_TRUE(parsed.ParseFromString(wire));
+  ASSERT_TRUE(
+      DeserializeFromVerbsMessage(parsed, buffer.data(), payload_size, ctx,
+                                  out));
+  // A truncated payload is rejected.
+  if (payload_size > 0) {
+    framework::Variable bad;
+    EXPECT_FALSE(DeserializeFromVerbsMessage(parsed, buffer.data(),
+                                             payload_size - 1, ctx, &bad));
+  }
+}
+
+TEST(VerbsSerde, LoDTensor) {
+  framework::Variable var, out;
+  auto* tensor = var.GetMutable<framework::LoDTensor>();
+  tensor->Resize({4, 3});
+  framework::LoD lod;
+  lod.push_back(framework::Vector<size_t>({0, 1, 4}));
+  tensor->set_lod(lod);
+  auto* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int i = 0; i < 12; ++i) {
+    data[i] = static_cast<float>(i) * 0.5f;
+  }
+
+  RoundTrip("lod_tensor", &var, &out);
+  auto& result = out.Get<framework::LoDTensor>();
+  EXPECT_EQ(result.dims(), tensor->dims());
+  EXPECT_EQ(result.lod(), lod);
+  for (int i = 0; i < 12; ++i) {
+    EXPECT_EQ(result.data<float>()[i], data[i]);
+  }
+}
+
+TEST(VerbsSerde, SelectedRows) {
+  framework::Variable var, out;
+  auto* slr = var.GetMutable<framework::SelectedRows>();
+  slr->set_height(100);
+  slr->set_rows(framework::Vector<int64_t>({3, 7, 42}));
+  auto* value = slr->mutable_value();
+  // An odd number of int32 elements puts the rows at an unaligned offset.
+  value->Resize({3, 1});
+  auto* data = value->mutable_data<int>(platform::CPUPlace());
+  for (int i = 0; i < 3; ++i) {
+    data[i] = i + 10;
+  }
+
+  RoundTrip("selected_rows", &var, &out);
+  auto& result = out.Get<framework::SelectedRows>();
+  EXPECT_EQ(result.height(), 100);
+  ASSERT_EQ(result.rows().size(), 3UL);
+  EXPECT_EQ(result.rows()[0], 3);
+  EXPECT_EQ(result.rows()[1], 7);
+  EXPECT_EQ(result.rows()[2], 42);
+  EXPECT_EQ(result.value().dims(), value->dims());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(result.value().data<int>()[i], data[i]);
+  }
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
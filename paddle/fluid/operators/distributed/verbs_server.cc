@@ -0,0 +1,405 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/verbs_server.h"
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <utility>
+
+#include "paddle/fluid/operators/distributed/verbs_serde.h"
+#include "paddle/fluid/platform/profiler.h"
+#include "paddle/fluid/string/printf.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+struct AsyncVerbsServer::Connection {
+  std::unique_ptr<VerbsChannel> channel;
+
+  std::mutex mutex;
+  // The buffers that the client writes the sent variables to, and the ones
+  // that the replied variables are serialized into, by variable name. A
+  // client has at most one request of a variable in flight, so a buffer is
+  // used by one request at a time.
+  std::unordered_map<std::string, std::unique_ptr<VerbsBuffer>> recv_buffers;
+  std::unordered_map<std::string, std::unique_ptr<VerbsBuffer>>
+      reply_buffers;
+};
+
+static const char* ToRPCName(VerbsMethod method) {
+  switch (method) {
+    case VerbsMethod::kSendVariable:
+      return kRequestSend;
+    case VerbsMethod::kGetVariable:
+      return kRequestGet;
+    case VerbsMethod::kPrefetchVariable:
+      return kRequestPrefetch;
+    case VerbsMethod::kCheckpointNotify:
+      return kRequestCheckpoint;
+    default:
+      return "";
+  }
+}
+
+// Follow the profiling state of the trainer, the same as
+// GRPCVariableResponse.
+static void ProcessProfileState(int64_t profiling) {
+  int64_t listener_id = platform::ListenerId();
+  if (profiling == 0 || listener_id <= 0) return;
+  if (profiling == platform::kEnableProfiler &&
+      !platform::IsProfileEnabled()) {
+    platform::EnableProfiler(platform::ProfilerState::kCPU);
+  } else if (profiling == platform::kDisableProfiler &&
+             platform::IsProfileEnabled()) {
+    platform::DisableProfiler(
+        platform::EventSortingKey::kDefault,
+        string::Sprintf("/tmp/profile_ps_%lld", listener_id));
+  }
+}
+
+AsyncVerbsServer::AsyncVerbsServer(const std::string& address,
+                                   int client_num)
+    : RPCServer(address, client_num),
+      listen_fd_(-1),
+      events_(nullptr),
+      ready_(0) {}
+
+AsyncVerbsServer::~AsyncVerbsServer() {
+  if (listen_fd_ >= 0) {
+    close(listen_fd_);
+  }
+  channel_conns_.clear();
+  // The channels should be destroyed before the events channel.
+  connections_.clear();
+  if (events_ != nullptr) {
+    ibv_destroy_comp_channel(events_);
+  }
+}
+
+void AsyncVerbsServer::WaitServerReady() {
+  VLOG(4) << "AsyncVerbsServer is wait server ready";
+  std::unique_lock<std::mutex> lock(this->mutex_ready_);
+  condition_ready_.wait(lock, [=] { return this->ready_ == 1; });
+  VLOG(4) << "AsyncVerbsServer WaitSeverReady";
+}
+
+void AsyncVerbsServer::StartServer() {
+  events_ = ibv_create_comp_channel(VerbsDevice::Instance().context());
+  PADDLE_ENFORCE_NOT_NULL(events_, "Failed to create the events channel.");
+  listen_fd_ = TcpListen(bind_address_, &selected_port_);
+  LOG(INFO) << "Server listening on " << bind_address_
+            << " selected port: " << selected_port_;
+
+  for (auto& t : rpc_call_map_) {
+    auto& rpc_name = t.first;
+    auto* queue = new RequestQueue;
+    rpc_queues_[rpc_name].reset(queue);
+    for (int i = 0; i < rpc_thread_num_[rpc_name]; i++) {
+      rpc_threads_[rpc_name].emplace_back(new std::thread(std::bind(
+          &AsyncVerbsServer::HandleRequest, this, rpc_name, queue)));
+      VLOG(4) << rpc_name << " creates threads!";
+    }
+  }
+  accept_thread_.reset(
+      new std::thread(std::bind(&AsyncVerbsServer::AcceptLoop, this)));
+  poll_thread_.reset(
+      new std::thread(std::bind(&AsyncVerbsServer::PollLoop, this)));
+
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_ready_);
+    ready_ = 1;
+  }
+  condition_ready_.notify_all();
+
+  // wait server
+  accept_thread_->join();
+  poll_thread_->join();
+
+  for (auto& t : rpc_threads_) {
+    auto& threads = t.second;
+    // An empty request stops a thread.
+    for (size_t i = 0; i < threads.size(); ++i) {
+      rpc_queues_[t.first]->Push(Request());
+    }
+    for (size_t i = 0; i < threads.size(); ++i) {
+      threads[i]->join();
+      VLOG(4) << t.first << " threads ends!";
+    }
+  }
+}
+
+void AsyncVerbsServer::ShutDownImpl() {
+  is_shut_down_ = true;
+  // Wake up the accept.
+  if (listen_fd_ >= 0) {
+    shutdown(listen_fd_, SHUT_RDWR);
+  }
+  VLOG(4) << "server_ shutdown!";
+}
+
+void AsyncVerbsServer::AcceptLoop() {
+  while (!is_shut_down_) {
+    int fd = accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0) {
+      if (!is_shut_down_) {
+        LOG(WARNING) << "accept on " << bind_address_ << " failed";
+      }
+      continue;
+    }
+    try {
+      VerbsHandshake remote;
+      TcpReadAll(fd, &remote, sizeof(remote));
+      PADDLE_ENFORCE_GT(remote.slot_num, 0U);
+      // Use the slots of the client, so that the flags of the servers and
+      // the clients need not be the same.
+      std::unique_ptr<Connection> conn(new Connection);
+      conn->channel.reset(new VerbsChannel(
+          events_, remote.slot_num, remote.slots.size / remote.slot_num));
+      conn->channel->Connect(remote);
+      VerbsHandshake local = conn->channel->LocalHandshake();
+      {
+        std::lock_guard<std::mutex> guard(conn_mutex_);
+        channel_conns_[conn->channel.get()] = conn.get();
+        connections_.emplace_back(std::move(conn));
+      }
+      TcpWriteAll(fd, &local, sizeof(local));
+      VLOG(3) << "accept a verbs connection, qp_num: " << remote.qp_num;
+    } catch (std::exception& e) {
+      LOG(ERROR) << "failed to connect a client: " << e.what();
+    }
+    close(fd);
+  }
+}
+
+void AsyncVerbsServer::PollLoop() {
+  const int kPollTimeoutMs = 100;
+  const int kPollBatch = 16;
+  ibv_wc wcs[kPollBatch];
+  while (!is_shut_down_) {
+    VerbsChannel* channel = WaitVerbsEvent(events_, kPollTimeoutMs);
+    if (channel == nullptr) continue;
+    Connection* conn = nullptr;
+    {
+      std::lock_guard<std::mutex> guard(conn_mutex_);
+      conn = channel_conns_.at(channel);
+    }
+
+    int n = 0;
+    while ((n = channel->Poll(wcs, kPollBatch)) > 0) {
+      for (int i = 0; i < n; ++i) {
+        auto& wc = wcs[i];
+        if (wc.status != IBV_WC_SUCCESS) {
+          LOG(ERROR) << "verbs work completion error: "
+                     << ibv_wc_status_str(wc.status);
+          continue;
+        }
+        // The completions of the replies need nothing to do.
+        if (wc.opcode != IBV_WC_RECV_RDMA_WITH_IMM) continue;
+
+        Request req;
+        req.conn = conn;
+        req.slot = static_cast<int>(ntohl(wc.imm_data));
+        req.header = channel->ReadMessage(req.slot, &req.meta);
+        channel->PostRecv();
+
+        auto it = rpc_queues_.find(ToRPCName(req.header.method));
+        if (it == rpc_queues_.end()) {
+          LOG(ERROR) << "no handler is registered for the verbs method "
+                     << static_cast<int>(req.header.method);
+          Reply(req, VerbsStatus::kError);
+          continue;
+        }
+        it->second->Push(std::move(req));
+      }
+    }
+  }
+}
+
+void AsyncVerbsServer::HandleRequest(const std::string& rpc_name,
+                                     RequestQueue* queue) {
+  RequestHandler* handler = rpc_call_map_.at(rpc_name);
+  while (true) {
+    Request req = queue->Pop();
+    if (req.conn == nullptr) break;
+    VLOG(4) << "HandleRequest " << rpc_name << ", slot:" << req.slot;
+    try {
+      Process(rpc_name, handler, req);
+    } catch (std::exception& e) {
+      LOG(ERROR) << rpc_name << " error: " << e.what();
+      Reply(req, VerbsStatus::kError);
+    }
+  }
+}
+
+void AsyncVerbsServer::Process(const std::string& rpc_name,
+                               RequestHandler* handler, const Request& req) {
+  sendrecv::VariableMessage meta;
+  if (!meta.ParseFromString(req.meta)) {
+    LOG(ERROR) << rpc_name << " receives a broken message";
+    Reply(req, VerbsStatus::kError);
+    return;
+  }
+  ProcessProfileState(meta.profile());
+
+  auto& header = req.header;
+  auto* conn = req.conn;
+  std::string varname = meta.varname();
+  int trainer_id = static_cast<int>(meta.trainer_id());
+
+  // The payload of the request is in the receive buffer of the variable,
+  // which is allocated by the first request of it.
+  const char* payload = nullptr;
+  if (header.has_var) {
+    std::lock_guard<std::mutex> guard(conn->mutex);
+    auto& buffer = conn->recv_buffers[varname];
+    if (header.status == VerbsStatus::kNeedBuffer) {
+      EnsureVerbsBuffer(header.payload_size, &buffer);
+      Reply(req, VerbsStatus::kNeedBuffer, buffer->Region());
+      return;
+    }
+    PADDLE_ENFORCE(buffer != nullptr && buffer->size() >= header.payload_size,
+                   "The payload of %s is not written to a buffer", varname);
+    payload = buffer->data();
+  }
+  auto* dev_ctx = handler->dev_ctx();
+
+  switch (header.method) {
+    case VerbsMethod::kSendVariable: {
+      VLOG(4) << "RequestSend var_name:" << varname;
+      framework::Scope* scope = handler->scope();
+      framework::Scope* local_scope = nullptr;
+      framework::Variable* invar = nullptr;
+      if (header.has_var) {
+        if (!handler->sync_mode()) {
+          local_scope = &handler->scope()->NewScope();
+          scope = local_scope;
+          invar = scope->Var(varname);
+        } else {
+          invar = scope->FindVar(varname);
+        }
+        if (!DeserializeFromVerbsMessage(meta, payload, header.payload_size,
+                                         *dev_ctx, invar)) {
+          if (local_scope) handler->scope()->DeleteScope(local_scope);
+          Reply(req, VerbsStatus::kError);
+          return;
+        }
+      }
+      framework::Variable* outvar = nullptr;
+      handler->Handle(varname, scope, invar, &outvar, trainer_id);
+      if (local_scope) handler->scope()->DeleteScope(local_scope);
+      Reply(req, VerbsStatus::kOK);
+      break;
+    }
+    case VerbsMethod::kGetVariable: {
+      VLOG(4) << "RequestGet " << varname;
+      auto* scope = handler->scope();
+      auto* invar = scope->FindVar(varname);
+      framework::Variable* outvar = nullptr;
+      handler->Handle(varname, scope, invar, &outvar, trainer_id);
+      if (outvar) {
+        ReplyVar(req, varname, outvar, handler);
+      } else {
+        Reply(req, VerbsStatus::kOK);
+      }
+      break;
+    }
+    case VerbsMethod::kPrefetchVariable: {
+      std::string out_var_name = meta.out_varname();
+      VLOG(4) << "RequestPrefetch, in_var_name: " << varname
+              << " out_var_name: " << out_var_name;
+      auto* local_scope = &handler->scope()->NewScope();
+      auto* invar = local_scope->Var(varname);
+      if (header.has_var &&
+          !DeserializeFromVerbsMessage(meta, payload, header.payload_size,
+                                       *dev_ctx, invar)) {
+        handler->scope()->DeleteScope(local_scope);
+        Reply(req, VerbsStatus::kError);
+        return;
+      }
+      // out var must be created in local scope!
+      framework::Variable* outvar = local_scope->Var(out_var_name);
+      handler->Handle(varname, local_scope, invar, &outvar, trainer_id,
+                      out_var_name);
+      ReplyVar(req, out_var_name, outvar, handler);
+      handler->scope()->DeleteScope(local_scope);
+      break;
+    }
+    case VerbsMethod::kCheckpointNotify: {
+      VLOG(4) << "RequestCheckpointNotify notify: " << varname
+              << ", dir: " << meta.out_varname();
+      handler->Handle(varname, handler->scope(), nullptr, nullptr, trainer_id,
+                      meta.out_varname());
+      Reply(req, VerbsStatus::kOK);
+      break;
+    }
+    default:
+      Reply(req, VerbsStatus::kError);
+  }
+}
+
+void AsyncVerbsServer::ReplyVar(const Request& req, const std::string& name,
+                                framework::Variable* var,
+                                RequestHandler* handler) {
+  std::unique_ptr<VerbsBuffer>* buffer = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(req.conn->mutex);
+    // The elements of an unordered_map are not moved by rehashing.
+    buffer = &req.conn->reply_buffers[name];
+  }
+  sendrecv::VariableMessage meta;
+  size_t payload_size = SerializeToVerbsMessage(
+      name, var, *handler->dev_ctx(),
+      [buffer](size_t size) {
+        EnsureVerbsBuffer(size, buffer);
+        return (*buffer)->data();
+      },
+      &meta);
+
+  VerbsMessageHeader reply;
+  std::memset(&reply, 0, sizeof(reply));
+  reply.method = req.header.method;
+  reply.has_var = 1;
+  reply.payload_size = payload_size;
+  if (payload_size > req.header.region.size) {
+    // The client will retry with a buffer big enough.
+    reply.status = VerbsStatus::kNeedBuffer;
+    req.conn->channel->PostMessage(req.slot, reply, "", nullptr, 0,
+                                   VerbsRegion());
+    return;
+  }
+  reply.status = VerbsStatus::kOK;
+  req.conn->channel->PostMessage(req.slot, reply, meta.SerializeAsString(),
+                                 buffer->get(), payload_size,
+                                 req.header.region);
+}
+
+void AsyncVerbsServer::Reply(const Request& req, VerbsStatus status,
+                             const VerbsRegion& region) {
+  VerbsMessageHeader reply;
+  std::memset(&reply, 0, sizeof(reply));
+  reply.method = req.header.method;
+  reply.status = status;
+  reply.region = region;
+  req.conn->channel->PostMessage(req.slot, reply, "", nullptr, 0,
+                                 VerbsRegion());
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
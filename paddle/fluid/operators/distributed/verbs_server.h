@@ -0,0 +1,99 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/blocking_queue.h"
+#include "paddle/fluid/operators/distributed/request_handler.h"
+#include "paddle/fluid/operators/distributed/rpc_server.h"
+#include "paddle/fluid/operators/distributed/send_recv.pb.h"
+#include "paddle/fluid/operators/distributed/verbs_utils.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// The RPCServer over RDMA verbs, see verbs_utils.h for the protocol. The
+// requests are dispatched to the registered RequestHandlers by
+// rpc_thread_num_ threads per rpc, the same as AsyncGRPCServer.
+class AsyncVerbsServer final : public RPCServer {
+ public:
+  explicit AsyncVerbsServer(const std::string& address, int client_num);
+  virtual ~AsyncVerbsServer();
+
+  void StartServer() override;
+  void WaitServerReady() override;
+
+ private:
+  struct Connection;
+
+  struct Request {
+    Connection* conn = nullptr;
+    int slot = -1;
+    VerbsMessageHeader header;
+    std::string meta;
+  };
+
+  typedef framework::BlockingQueue<Request> RequestQueue;
+
+  void ShutDownImpl() override;
+
+  // Accept the clients and connect their queue pairs.
+  void AcceptLoop();
+  // Poll the completions and queue the received requests.
+  void PollLoop();
+  void HandleRequest(const std::string& rpc_name, RequestQueue* queue);
+  void Process(const std::string& rpc_name, RequestHandler* handler,
+               const Request& req);
+
+  // Serialize var into the reply buffer of the connection and write it to
+  // the client with the reply of req.
+  void ReplyVar(const Request& req, const std::string& name,
+                framework::Variable* var, RequestHandler* handler);
+  void Reply(const Request& req, VerbsStatus status,
+             const VerbsRegion& region = VerbsRegion());
+
+  int listen_fd_;
+  ibv_comp_channel* events_;
+
+  std::mutex conn_mutex_;
+  std::vector<std::unique_ptr<Connection>> connections_;
+  std::unordered_map<const VerbsChannel*, Connection*> channel_conns_;
+
+  std::map<std::string, std::unique_ptr<RequestQueue>> rpc_queues_;
+  std::map<std::string, std::vector<std::unique_ptr<std::thread>>>
+      rpc_threads_;
+  std::unique_ptr<std::thread> accept_thread_;
+  std::unique_ptr<std::thread> poll_thread_;
+
+  std::mutex mutex_ready_;
+  std::condition_variable condition_ready_;
+  int ready_;
+
+  std::atomic<bool> is_shut_down_{false};
+};
+
+};  // namespace distributed
+};  // namespace operators
+};  // namespace paddle
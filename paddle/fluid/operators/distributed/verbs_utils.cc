@@ -0,0 +1,422 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/verbs_utils.h"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>  // NOLINT
+
+#include "glog/logging.h"
+
+DEFINE_string(rdma_device, "",
+              "The name of the RDMA device used by the verbs transport, the "
+              "first one of the system if it is empty.");
+DEFINE_int32(rdma_port, 1, "The port number of the RDMA device.");
+DEFINE_int32(rdma_gid_index, 0,
+             "The GID index of the RDMA port, which should be the RoCE v2 "
+             "one on RoCE NICs.");
+DEFINE_int32(rdma_slot_num, 32,
+             "The number of the message slots of one verbs connection, "
+             "which is the number of the concurrent requests to one server.");
+DEFINE_int64(rdma_slot_size, 64 << 10,
+             "The bytes of one message slot, which holds the meta data of a "
+             "message without the tensor data.");
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+VerbsDevice& VerbsDevice::Instance() {
+  static VerbsDevice device;
+  return device;
+}
+
+VerbsDevice::VerbsDevice() {
+  int num_devices = 0;
+  ibv_device** devices = ibv_get_device_list(&num_devices);
+  PADDLE_ENFORCE(devices != nullptr && num_devices > 0,
+                 "No RDMA device is found.");
+  ibv_device* device = nullptr;
+  for (int i = 0; i < num_devices; ++i) {
+    if (FLAGS_rdma_device.empty() ||
+        FLAGS_rdma_device == ibv_get_device_name(devices[i])) {
+      device = devices[i];
+      break;
+    }
+  }
+  PADDLE_ENFORCE_NOT_NULL(device, "RDMA device %s is not found.",
+                          FLAGS_rdma_device);
+  context_ = ibv_open_device(device);
+  ibv_free_device_list(devices);
+  PADDLE_ENFORCE_NOT_NULL(context_, "Failed to open the RDMA device.");
+
+  pd_ = ibv_alloc_pd(context_);
+  PADDLE_ENFORCE_NOT_NULL(pd_, "Failed to allocate the protection domain.");
+
+  port_ = static_cast<uint8_t>(FLAGS_rdma_port);
+  PADDLE_ENFORCE_EQ(ibv_query_port(context_, port_, &port_attr_), 0,
+                    "Failed to query the RDMA port %d.", FLAGS_rdma_port);
+  PADDLE_ENFORCE_EQ(port_attr_.state, IBV_PORT_ACTIVE,
+                    "The RDMA port %d is not active.", FLAGS_rdma_port);
+  PADDLE_ENFORCE_EQ(
+      ibv_query_gid(context_, port_, FLAGS_rdma_gid_index, &gid_), 0,
+      "Failed to query the GID %d of the RDMA port.", FLAGS_rdma_gid_index);
+  VLOG(3) << "Use RDMA device " << ibv_get_device_name(context_->device)
+          << " port " << FLAGS_rdma_port;
+}
+
+VerbsDevice::~VerbsDevice() {
+  ibv_dealloc_pd(pd_);
+  ibv_close_device(context_);
+}
+
+VerbsBuffer::VerbsBuffer(size_t size) : size_(size) {
+  // Register at least one byte, as an empty region is not allowed.
+  size_t alloc_size = std::max<size_t>(size, 1);
+  PADDLE_ENFORCE_EQ(posix_memalign(reinterpret_cast<void**>(&data_),
+                                   sysconf(_SC_PAGESIZE), alloc_size),
+                    0, "Failed to allocate %d bytes for RDMA.", size);
+  mr_ = ibv_reg_mr(VerbsDevice::Instance().pd(), data_, alloc_size,
+                   IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_WRITE);
+  PADDLE_ENFORCE_NOT_NULL(mr_, "Failed to register %d bytes for RDMA.",
+                          size);
+}
+
+VerbsBuffer::~VerbsBuffer() {
+  ibv_dereg_mr(mr_);
+  free(data_);
+}
+
+VerbsRegion VerbsBuffer::Region() const {
+  VerbsRegion region;
+  region.addr = reinterpret_cast<uint64_t>(data_);
+  region.size = size_;
+  region.rkey = mr_->rkey;
+  return region;
+}
+
+void EnsureVerbsBuffer(size_t size, std::unique_ptr<VerbsBuffer>* buffer) {
+  if (*buffer == nullptr || (*buffer)->size() < size) {
+    buffer->reset();
+    buffer->reset(new VerbsBuffer(size));
+  }
+}
+
+VerbsChannel::VerbsChannel(ibv_comp_channel* events, int slot_num,
+                           size_t slot_size)
+    : slot_num_(slot_num), slot_size_(slot_size) {
+  PADDLE_ENFORCE_GT(slot_num, 0);
+  PADDLE_ENFORCE_GT(slot_size, sizeof(VerbsMessageHeader));
+  auto& device = VerbsDevice::Instance();
+  // Each message takes at most two send requests, the payload and the
+  // message, and one receive request.
+  cq_ = ibv_create_cq(device.context(), slot_num * 4, this, events, 0);
+  PADDLE_ENFORCE_NOT_NULL(cq_, "Failed to create the completion queue.");
+  RequestNotify();
+
+  ibv_qp_init_attr init_attr;
+  std::memset(&init_attr, 0, sizeof(init_attr));
+  init_attr.send_cq = cq_;
+  init_attr.recv_cq = cq_;
+  init_attr.qp_type = IBV_QPT_RC;
+  init_attr.cap.max_send_wr = slot_num * 2;
+  init_attr.cap.max_recv_wr = slot_num;
+  init_attr.cap.max_send_sge = 1;
+  init_attr.cap.max_recv_sge = 1;
+  qp_ = ibv_create_qp(device.pd(), &init_attr);
+  PADDLE_ENFORCE_NOT_NULL(qp_, "Failed to create the queue pair.");
+
+  std::random_device rd;
+  psn_ = rd() & 0xffffff;
+  slots_.reset(new VerbsBuffer(slot_num * slot_size));
+  out_slots_.reset(new VerbsBuffer(slot_num * slot_size));
+}
+
+VerbsChannel::~VerbsChannel() {
+  ibv_destroy_qp(qp_);
+  ibv_destroy_cq(cq_);
+}
+
+VerbsHandshake VerbsChannel::LocalHandshake() const {
+  auto& device = VerbsDevice::Instance();
+  VerbsHandshake handshake;
+  std::memset(&handshake, 0, sizeof(handshake));
+  handshake.qp_num = qp_->qp_num;
+  handshake.psn = psn_;
+  handshake.lid = device.lid();
+  handshake.slot_num = slot_num_;
+  handshake.gid = device.gid();
+  handshake.slots = slots_->Region();
+  return handshake;
+}
+
+void VerbsChannel::Connect(const VerbsHandshake& remote) {
+  PADDLE_ENFORCE_EQ(static_cast<int>(remote.slot_num), slot_num_,
+                    "The number of message slots of the peer mismatches.");
+  PADDLE_ENFORCE_EQ(remote.slots.size, slots_->size(),
+                    "The message slot size of the peer mismatches.");
+  remote_slots_ = remote.slots;
+  auto& device = VerbsDevice::Instance();
+
+  ibv_qp_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_INIT;
+  attr.pkey_index = 0;
+  attr.port_num = device.port();
+  attr.qp_access_flags = IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_WRITE;
+  PADDLE_ENFORCE_EQ(
+      ibv_modify_qp(qp_, &attr, IBV_QP_STATE | IBV_QP_PKEY_INDEX |
+                                    IBV_QP_PORT | IBV_QP_ACCESS_FLAGS),
+      0, "Failed to move the queue pair to INIT.");
+
+  std::memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_RTR;
+  attr.path_mtu = device.active_mtu();
+  attr.dest_qp_num = remote.qp_num;
+  attr.rq_psn = remote.psn;
+  attr.max_dest_rd_atomic = 1;
+  attr.min_rnr_timer = 12;
+  attr.ah_attr.dlid = remote.lid;
+  attr.ah_attr.port_num = device.port();
+  // Route by the GID, which is required by RoCE.
+  attr.ah_attr.is_global = 1;
+  attr.ah_attr.grh.dgid = remote.gid;
+  attr.ah_attr.grh.sgid_index = FLAGS_rdma_gid_index;
+  attr.ah_attr.grh.hop_limit = 1;
+  PADDLE_ENFORCE_EQ(
+      ibv_modify_qp(qp_, &attr, IBV_QP_STATE | IBV_QP_AV | IBV_QP_PATH_MTU |
+                                    IBV_QP_DEST_QPN | IBV_QP_RQ_PSN |
+                                    IBV_QP_MAX_DEST_RD_ATOMIC |
+                                    IBV_QP_MIN_RNR_TIMER),
+      0, "Failed to move the queue pair to RTR.");
+
+  std::memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_RTS;
+  attr.timeout = 14;
+  attr.retry_cnt = 7;
+  attr.rnr_retry = 7;
+  attr.sq_psn = psn_;
+  attr.max_rd_atomic = 1;
+  PADDLE_ENFORCE_EQ(
+      ibv_modify_qp(qp_, &attr, IBV_QP_STATE | IBV_QP_TIMEOUT |
+                                    IBV_QP_RETRY_CNT | IBV_QP_RNR_RETRY |
+                                    IBV_QP_SQ_PSN | IBV_QP_MAX_QP_RD_ATOMIC),
+      0, "Failed to move the queue pair to RTS.");
+
+  for (int i = 0; i < slot_num_; ++i) {
+    PostRecv();
+  }
+}
+
+VerbsMessageHeader VerbsChannel::ReadMessage(int i, std::string* meta) const {
+  PADDLE_ENFORCE(i >= 0 && i < slot_num_);
+  VerbsMessageHeader header;
+  std::memcpy(&header, Slot(i), sizeof(header));
+  PADDLE_ENFORCE_LE(header.meta_size, slot_size_ - sizeof(header));
+  meta->assign(Slot(i) + sizeof(header), header.meta_size);
+  return header;
+}
+
+void VerbsChannel::PostMessage(int i, VerbsMessageHeader header,
+                               const std::string& meta,
+                               const VerbsBuffer* payload, size_t payload_size,
+                               const VerbsRegion& remote) {
+  PADDLE_ENFORCE(i >= 0 && i < slot_num_);
+  size_t message_size = sizeof(header) + meta.size();
+  PADDLE_ENFORCE_LE(message_size, slot_size_,
+                    "The meta of the message is larger than a slot, please "
+                    "increase FLAGS_rdma_slot_size.");
+  header.meta_size = meta.size();
+  std::memcpy(OutSlot(i), &header, sizeof(header));
+  std::memcpy(OutSlot(i) + sizeof(header), meta.data(), meta.size());
+  ibv_sge sges[2];
+  ibv_send_wr wrs[2];
+  std::memset(wrs, 0, sizeof(wrs));
+  ibv_send_wr* first = &wrs[1];
+
+  if (payload != nullptr && payload_size > 0) {
+    PADDLE_ENFORCE_LE(payload_size, remote.size);
+    PADDLE_ENFORCE_LE(payload_size, payload->size());
+    sges[0].addr = reinterpret_cast<uint64_t>(payload->data());
+    sges[0].length = static_cast<uint32_t>(payload_size);
+    sges[0].lkey = payload->lkey();
+    wrs[0].sg_list = &sges[0];
+    wrs[0].num_sge = 1;
+    wrs[0].opcode = IBV_WR_RDMA_WRITE;
+    wrs[0].wr.rdma.remote_addr = remote.addr;
+    wrs[0].wr.rdma.rkey = remote.rkey;
+    wrs[0].next = &wrs[1];
+    first = &wrs[0];
+  }
+
+  sges[1].addr = reinterpret_cast<uint64_t>(OutSlot(i));
+  sges[1].length = static_cast<uint32_t>(message_size);
+  sges[1].lkey = out_slots_->lkey();
+  wrs[1].wr_id = static_cast<uint64_t>(i);
+  wrs[1].sg_list = &sges[1];
+  wrs[1].num_sge = 1;
+  wrs[1].opcode = IBV_WR_RDMA_WRITE_WITH_IMM;
+  // Only the last request is signaled, its completion means the payload is
+  // written too.
+  wrs[1].send_flags = IBV_SEND_SIGNALED;
+  wrs[1].imm_data = htonl(static_cast<uint32_t>(i));
+  wrs[1].wr.rdma.remote_addr = remote_slots_.addr + i * slot_size_;
+  wrs[1].wr.rdma.rkey = remote_slots_.rkey;
+
+  ibv_send_wr* bad_wr = nullptr;
+  PADDLE_ENFORCE_EQ(ibv_post_send(qp_, first, &bad_wr), 0,
+                    "Failed to post the RDMA write.");
+}
+
+void VerbsChannel::PostRecv() {
+  // The message is written into the slot, so the receive request takes no
+  // buffer and only carries the immediate data.
+  ibv_recv_wr wr;
+  std::memset(&wr, 0, sizeof(wr));
+  wr.wr_id = kVerbsRecvWrId;
+  ibv_recv_wr* bad_wr = nullptr;
+  PADDLE_ENFORCE_EQ(ibv_post_recv(qp_, &wr, &bad_wr), 0,
+                    "Failed to post the receive request.");
+}
+
+int VerbsChannel::Poll(ibv_wc* wc, int n) {
+  int ret = ibv_poll_cq(cq_, n, wc);
+  PADDLE_ENFORCE_GE(ret, 0, "Failed to poll the completion queue.");
+  return ret;
+}
+
+void VerbsChannel::RequestNotify() {
+  PADDLE_ENFORCE_EQ(ibv_req_notify_cq(cq_, 0), 0,
+                    "Failed to request the completion notification.");
+}
+
+VerbsChannel* WaitVerbsEvent(ibv_comp_channel* events, int timeout_ms) {
+  pollfd pfd;
+  pfd.fd = events->fd;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+  int ret = poll(&pfd, 1, timeout_ms);
+  if (ret <= 0) return nullptr;
+
+  ibv_cq* cq = nullptr;
+  void* cq_context = nullptr;
+  if (ibv_get_cq_event(events, &cq, &cq_context) != 0) return nullptr;
+  ibv_ack_cq_events(cq, 1);
+  auto* channel = static_cast<VerbsChannel*>(cq_context);
+  // Ask for the next event before polling, so that no completion is missed.
+  channel->RequestNotify();
+  return channel;
+}
+
+static void SplitEndpoint(const std::string& ep, std::string* host,
+                          std::string* port) {
+  auto pos = ep.rfind(':');
+  PADDLE_ENFORCE(pos != std::string::npos, "Invalid endpoint %s", ep);
+  *host = ep.substr(0, pos);
+  *port = ep.substr(pos + 1);
+}
+
+int TcpListen(const std::string& address, int* selected_port) {
+  std::string host, port;
+  SplitEndpoint(address, &host, &port);
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  PADDLE_ENFORCE_GE(fd, 0, "Failed to create the socket.");
+  int on = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+  sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<uint16_t>(std::stoi(port)));
+  if (host.empty() || host == "0.0.0.0" || host == "*") {
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  } else {
+    PADDLE_ENFORCE_EQ(inet_pton(AF_INET, host.c_str(), &addr.sin_addr), 1,
+                      "Invalid address %s", address);
+  }
+  PADDLE_ENFORCE_EQ(bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)),
+                    0, "Failed to bind %s", address);
+  PADDLE_ENFORCE_EQ(listen(fd, 128), 0, "Failed to listen on %s", address);
+
+  socklen_t len = sizeof(addr);
+  getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+  *selected_port = ntohs(addr.sin_port);
+  return fd;
+}
+
+int TcpConnect(const std::string& ep) {
+  std::string host, port;
+  SplitEndpoint(ep, &host, &port);
+
+  addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  // The server may not be started yet, retry like the reconnection of
+  // gRPC channels.
+  while (true) {
+    addrinfo* res = nullptr;
+    PADDLE_ENFORCE_EQ(getaddrinfo(host.c_str(), port.c_str(), &hints, &res),
+                      0, "Failed to resolve %s", ep);
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    PADDLE_ENFORCE_GE(fd, 0, "Failed to create the socket.");
+    int ret = connect(fd, res->ai_addr, res->ai_addrlen);
+    freeaddrinfo(res);
+    if (ret == 0) {
+      int on = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+      return fd;
+    }
+    close(fd);
+    VLOG(3) << "connect to " << ep << " failed, retry";
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+  }
+}
+
+void TcpWriteAll(int fd, const void* data, size_t size) {
+  auto* p = static_cast<const char*>(data);
+  while (size > 0) {
+    ssize_t n = write(fd, p, size);
+    PADDLE_ENFORCE_GT(n, 0, "Failed to write the socket.");
+    p += n;
+    size -= n;
+  }
+}
+
+void TcpReadAll(int fd, void* data, size_t size) {
+  auto* p = static_cast<char*>(data);
+  while (size > 0) {
+    ssize_t n = read(fd, p, size);
+    PADDLE_ENFORCE_GT(n, 0, "Failed to read the socket.");
+    p += n;
+    size -= n;
+  }
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
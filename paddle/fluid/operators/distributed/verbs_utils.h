@@ -0,0 +1,227 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <infiniband/verbs.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/macros.h"
+
+DECLARE_string(rdma_device);
+DECLARE_int32(rdma_port);
+DECLARE_int32(rdma_gid_index);
+DECLARE_int32(rdma_slot_num);
+DECLARE_int64(rdma_slot_size);
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// The verbs transport works as follows:
+//
+// 1. The client connects to the endpoint of the server with TCP, and they
+//    exchange the addresses of their queue pairs and message slots. Then
+//    the TCP connection is closed and everything goes through the reliable
+//    connected queue pair.
+// 2. Each side owns FLAGS_rdma_slot_num registered message slots for the
+//    other side to write to. Request i is written into the slot i of the
+//    server and its reply into the slot i of the client, by
+//    IBV_WR_RDMA_WRITE_WITH_IMM, whose immediate data is the slot index.
+// 3. The tensor data does not go through the slots. The receiver of a
+//    variable keeps one registered buffer per variable and connection, and
+//    tells the sender its address once. After that the data is written
+//    into it directly, before the message with the immediate data, which
+//    is delivered after the data as the queue pair is ordered.
+
+// The address of a registered memory region of the peer.
+struct VerbsRegion {
+  uint64_t addr = 0;
+  uint64_t size = 0;
+  uint32_t rkey = 0;
+  uint32_t reserved = 0;
+};
+
+// Exchanged by TCP to connect the queue pairs.
+struct VerbsHandshake {
+  uint32_t qp_num;
+  uint32_t psn;
+  uint16_t lid;
+  uint16_t reserved;
+  uint32_t slot_num;
+  union ibv_gid gid;
+  VerbsRegion slots;
+};
+
+enum class VerbsMethod : uint32_t {
+  kSendVariable = 0,
+  kGetVariable = 1,
+  kPrefetchVariable = 2,
+  kCheckpointNotify = 3,
+};
+
+enum class VerbsStatus : uint32_t {
+  kOK = 0,
+  // The receiver has no buffer for the payload, or a too small one. The
+  // region of the message is the buffer to use, or empty if the sender
+  // should provide a bigger one with the given payload size.
+  kNeedBuffer = 1,
+  kError = 2,
+};
+
+// The header at the beginning of a message slot, followed by a serialized
+// sendrecv::VariableMessage of meta_size bytes, which has no payload.
+struct VerbsMessageHeader {
+  VerbsMethod method;
+  VerbsStatus status;
+  // Whether the message carries a variable, whose payload may be empty.
+  uint32_t has_var;
+  uint32_t reserved;
+  uint64_t meta_size;
+  // The bytes of the payload of the variable, which are written into the
+  // buffer of the receiver unless the status is kNeedBuffer.
+  uint64_t payload_size;
+  // For a request, where the server should write the payload of the reply.
+  // For a reply of kNeedBuffer, where the client should write the payload
+  // of the request.
+  VerbsRegion region;
+};
+
+// The wr_id of the receive requests, the one of a message is its slot.
+constexpr uint64_t kVerbsRecvWrId = ~0ULL;
+
+// The device, protection domain and port shared by all the connections of
+// this process.
+class VerbsDevice {
+ public:
+  static VerbsDevice& Instance();
+
+  ~VerbsDevice();
+
+  ibv_context* context() const { return context_; }
+  ibv_pd* pd() const { return pd_; }
+  uint8_t port() const { return port_; }
+  uint16_t lid() const { return port_attr_.lid; }
+  ibv_mtu active_mtu() const { return port_attr_.active_mtu; }
+  const union ibv_gid& gid() const { return gid_; }
+
+ private:
+  VerbsDevice();
+
+  ibv_context* context_;
+  ibv_pd* pd_;
+  uint8_t port_;
+  ibv_port_attr port_attr_;
+  union ibv_gid gid_;
+
+  DISABLE_COPY_AND_ASSIGN(VerbsDevice);
+};
+
+// A host buffer registered for local access and remote write, which is
+// registered once and reused by all the messages that go through it.
+class VerbsBuffer {
+ public:
+  explicit VerbsBuffer(size_t size);
+  ~VerbsBuffer();
+
+  char* data() const { return data_; }
+  size_t size() const { return size_; }
+  uint32_t lkey() const { return mr_->lkey; }
+
+  VerbsRegion Region() const;
+
+ private:
+  char* data_;
+  size_t size_;
+  ibv_mr* mr_;
+
+  DISABLE_COPY_AND_ASSIGN(VerbsBuffer);
+};
+
+// Grow *buffer in place to hold size bytes. The content is not kept.
+void EnsureVerbsBuffer(size_t size, std::unique_ptr<VerbsBuffer>* buffer);
+
+// A reliable connected queue pair and the message slots of one peer. The
+// send and receive completions of the channel go to its own completion
+// queue, whose events are delivered to the shared events channel.
+class VerbsChannel {
+ public:
+  VerbsChannel(ibv_comp_channel* events, int slot_num, size_t slot_size);
+  ~VerbsChannel();
+
+  // The handshake to send to the peer.
+  VerbsHandshake LocalHandshake() const;
+
+  // Connect the queue pair to the peer and post the receive requests of
+  // the slots.
+  void Connect(const VerbsHandshake& remote);
+
+  uint32_t qp_num() const { return qp_->qp_num; }
+  int slot_num() const { return slot_num_; }
+  size_t slot_size() const { return slot_size_; }
+
+  // Read the message i written by the peer.
+  VerbsMessageHeader ReadMessage(int i, std::string* meta) const;
+
+  // Write payload_size bytes of payload into remote, if any, then the
+  // header and meta into the slot i of the peer, with i as the immediate
+  // data. The meta_size of the header is set by meta.
+  void PostMessage(int i, VerbsMessageHeader header, const std::string& meta,
+                   const VerbsBuffer* payload, size_t payload_size,
+                   const VerbsRegion& remote);
+
+  // Give back a receive request after the message in a slot is consumed.
+  void PostRecv();
+
+  // Poll at most n completions into wc, return the number of them.
+  int Poll(ibv_wc* wc, int n);
+
+  // Ask for the event of the next completion.
+  void RequestNotify();
+
+ private:
+  ibv_cq* cq_;
+  ibv_qp* qp_;
+  uint32_t psn_;
+  int slot_num_;
+  size_t slot_size_;
+  std::unique_ptr<VerbsBuffer> slots_;
+  std::unique_ptr<VerbsBuffer> out_slots_;
+  VerbsRegion remote_slots_;
+
+  char* Slot(int i) const { return slots_->data() + i * slot_size_; }
+  char* OutSlot(int i) const { return out_slots_->data() + i * slot_size_; }
+
+  DISABLE_COPY_AND_ASSIGN(VerbsChannel);
+};
+
+// Wait at most timeout_ms for a completion event of the channels attached
+// to events, return the channel which has new completions or nullptr.
+VerbsChannel* WaitVerbsEvent(ibv_comp_channel* events, int timeout_ms);
+
+// The TCP helpers used by the handshake.
+int TcpListen(const std::string& address, int* selected_port);
+int TcpConnect(const std::string& ep);
+void TcpWriteAll(int fd, const void* data, size_t size);
+void TcpReadAll(int fd, void* data, size_t size);
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -30,10 +30,18 @@ class DropoutOp : public framework::OperatorWithKernel {
     auto x_dims = ctx->GetInputDim("X");
     ctx->SetOutputDim("Out", x_dims);
     if (ctx->Attrs().Get<bool>("is_test") == false) {
-      ctx->SetOutputDim("Mask", x_dims);
+      ctx->SetOutputDim("Mask", MaskDims(ctx, x_dims));
     }
     ctx->ShareLoD("X", /*->*/ "Out");
   }
+
+  // The dims of the Mask of an X of x_dims.
+  static framework::DDim MaskDims(framework::InferShapeContext* ctx,
+                                  const framework::DDim& x_dims) {
+    if (!ctx->Attrs().Get<bool>("bit_mask")) return x_dims;
+    auto numel = framework::product(x_dims);
+    return framework::make_ddim({numel < 0 ? -1 : DropoutBitMaskSize(numel)});
+  }
 };
 
 class DropoutOpMaker : public framework::OpProtoAndCheckerMaker {
@@ -42,7 +50,23 @@ class DropoutOpMaker : public framework::OpProtoAndCheckerMaker {
     AddInput("X", "The input of dropout op.");
     AddOutput("Out", "The output of dropout op.");
     AddOutput("Mask", "The random sampled dropout mask.").AsIntermediate();
+    AddDropoutAttrs();
+
+    AddComment(R"DOC(
+Dropout Operator.
+
+Dropout refers to randomly dropping out units in a nerual network. It is a
+regularization technique for reducing overfitting by preventing neuron
+co-adaption during training. The dropout operator randomly set (according to
+the given dropout probability) the outputs of some units to zero, while others
+are set equal to their corresponding inputs.
+
+)DOC");
+  }
 
+ protected:
+  // The attributes shared by the fused_dropout_add.
+  void AddDropoutAttrs() {
     AddAttr<float>("dropout_prob", "Probability of setting units to zero.")
         .SetDefault(.5f)
         .AddCustomChecker([](const float& drop_p) {
@@ -81,15 +105,27 @@ class DropoutOpMaker : public framework::OpProtoAndCheckerMaker {
               "dropout_implementation can only be downgrade_in_infer or "
               "upscale_in_train");
         });
+    AddAttr<bool>("bit_mask",
+                  "(bool, default false) Save the Mask as a uint8 tensor of a "
+                  "bit per element, each byte holds the bits of 8 elements.")
+        .SetDefault(false);
+  }
+};
+
+class FusedDropoutAddOpMaker : public DropoutOpMaker {
+ public:
+  void Make() override {
+    AddInput("X", "The input of the dropout.");
+    AddInput("Y", "The residual added to the dropout, of the same shape as X.");
+    AddOutput("Out", "dropout(X) + Y.");
+    AddOutput("Mask", "The random sampled dropout mask.").AsIntermediate();
+    AddDropoutAttrs();
 
     AddComment(R"DOC(
-Dropout Operator.
+Fused Dropout Add Operator.
 
-Dropout refers to randomly dropping out units in a nerual network. It is a
-regularization technique for reducing overfitting by preventing neuron
-co-adaption during training. The dropout operator randomly set (according to
-the given dropout probability) the outputs of some units to zero, while others
-are set equal to their corresponding inputs.
+Out = dropout(X) + Y, the residual connection after a dropout in one pass over
+the data. The attributes and the Mask are the same as those of the dropout.
 
 )DOC");
   }
@@ -113,11 +149,88 @@ class DropoutOpGrad : public framework::OperatorWithKernel {
     PADDLE_ENFORCE_EQ(x_dims, out_dims,
                       "Dimensions of Input(X) and Out@Grad must be the same.");
     auto mask_dims = ctx->GetInputDim("Mask");
-    PADDLE_ENFORCE_EQ(x_dims, mask_dims,
-                      "Dimensions of Input(X) and Mask must be the same.");
+    PADDLE_ENFORCE_EQ(DropoutOp::MaskDims(ctx, x_dims), mask_dims,
+                      "Dimensions of Input(X) and Mask do not match.");
 
     ctx->SetOutputDim(framework::GradVarName("X"), x_dims);
   }
+
+ protected:
+  // The Mask may be a uint8 bit mask.
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        framework::ToDataType(
+            ctx.Input<Tensor>(framework::GradVarName("Out"))->type()),
+        ctx.GetPlace());
+  }
+};
+
+class FusedDropoutAddOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("X"), "Input(X) must not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("Y"), "Input(Y) must not be null.");
+
+    auto x_dims = ctx->GetInputDim("X");
+    PADDLE_ENFORCE_EQ(x_dims, ctx->GetInputDim("Y"),
+                      "Dimensions of Input(X) and Input(Y) must be the same.");
+    ctx->SetOutputDim("Out", x_dims);
+    if (ctx->Attrs().Get<bool>("is_test") == false) {
+      ctx->SetOutputDim("Mask", DropoutOp::MaskDims(ctx, x_dims));
+    }
+    ctx->ShareLoD("X", /*->*/ "Out");
+  }
+};
+
+class FusedDropoutAddOpGrad : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE_EQ(ctx->Attrs().Get<bool>("is_test"), false,
+                      "GradOp is only callable when is_test is false");
+    PADDLE_ENFORCE(ctx->HasInput("Mask"), "Mask must not be null.");
+    PADDLE_ENFORCE(ctx->HasInput(framework::GradVarName("Out")),
+                   "Input(Out@GRAD) must not be null.");
+
+    auto out_dims = ctx->GetInputDim(framework::GradVarName("Out"));
+    if (ctx->HasOutput(framework::GradVarName("X"))) {
+      ctx->SetOutputDim(framework::GradVarName("X"), out_dims);
+    }
+    if (ctx->HasOutput(framework::GradVarName("Y"))) {
+      ctx->SetOutputDim(framework::GradVarName("Y"), out_dims);
+    }
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        framework::ToDataType(
+            ctx.Input<Tensor>(framework::GradVarName("Out"))->type()),
+        ctx.GetPlace());
+  }
+};
+
+// The backward needs only the Mask and Out@GRAD.
+class FusedDropoutAddGradMaker : public framework::SingleGradOpDescMaker {
+ public:
+  using framework::SingleGradOpDescMaker::SingleGradOpDescMaker;
+
+ protected:
+  std::unique_ptr<framework::OpDesc> Apply() const override {
+    auto* op = new framework::OpDesc();
+    op->SetType("fused_dropout_add_grad");
+    op->SetInput("Mask", Output("Mask"));
+    op->SetInput(framework::GradVarName("Out"), OutputGrad("Out"));
+    op->SetOutput(framework::GradVarName("X"), InputGrad("X"));
+    op->SetOutput(framework::GradVarName("Y"), InputGrad("Y"));
+    op->SetAttrMap(Attrs());
+    return std::unique_ptr<framework::OpDesc>(op);
+  }
 };
 
 }  // namespace operators
@@ -125,7 +238,8 @@ class DropoutOpGrad : public framework::OperatorWithKernel {
 
 namespace ops = paddle::operators;
 REGISTER_OPERATOR(dropout, ops::DropoutOp, ops::DropoutOpMaker,
-                  paddle::framework::DefaultGradOpDescMaker<true>);
+                  paddle::framework::DefaultGradOpDescMaker<true>,
+                  paddle::framework::SingleOpInplaceInToOut);
 REGISTER_OPERATOR(dropout_grad, ops::DropoutOpGrad);
 REGISTER_OP_CPU_KERNEL(
     dropout, ops::CPUDropoutKernel<paddle::platform::CPUDeviceContext, float>,
@@ -134,3 +248,16 @@ REGISTER_OP_CPU_KERNEL(
     dropout_grad,
     ops::DropoutGradKernel<paddle::platform::CPUDeviceContext, float>,
     ops::DropoutGradKernel<paddle::platform::CPUDeviceContext, double>);
+
+REGISTER_OPERATOR(fused_dropout_add, ops::FusedDropoutAddOp,
+                  ops::FusedDropoutAddOpMaker, ops::FusedDropoutAddGradMaker);
+REGISTER_OPERATOR(fused_dropout_add_grad, ops::FusedDropoutAddOpGrad);
+REGISTER_OP_CPU_KERNEL(
+    fused_dropout_add,
+    ops::CPUFusedDropoutAddKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::CPUFusedDropoutAddKernel<paddle::platform::CPUDeviceContext, double>);
+REGISTER_OP_CPU_KERNEL(
+    fused_dropout_add_grad,
+    ops::FusedDropoutAddGradKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::FusedDropoutAddGradKernel<paddle::platform::CPUDeviceContext,
+                                   double>);
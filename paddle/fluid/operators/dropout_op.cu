@@ -13,95 +13,144 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #define EIGEN_USE_GPU
-#include <thrust/device_ptr.h>
-#include <thrust/iterator/counting_iterator.h>
-#include <thrust/random.h>
-#include <thrust/transform.h>
 #include <string>
 #include "paddle/fluid/operators/dropout_op.h"
 #include "paddle/fluid/platform/float16.h"
+#include "paddle/fluid/platform/philox.h"
 
 namespace paddle {
 namespace operators {
 
+// The element i is kept by the number i % 4 of the Philox call of the
+// subsequence i / 4, a thread computes the 4 elements of a call.
 template <typename T>
-__global__ void RandomGenerator(const size_t n, const int seed,
+__global__ void RandomGenerator(const size_t n,
+                                const platform::PhiloxSeedOffset seed_offset,
                                 const float dropout_prob, const T* src,
-                                T* mask_data, T* dst,
+                                const T* residual, T* mask_data, T* dst,
                                 bool is_upscale_in_train) {
-  thrust::minstd_rand rng;
-  rng.seed(seed);
-  thrust::uniform_real_distribution<float> dist(0, 1);
+  T scale = static_cast<T>(is_upscale_in_train ? 1.0f / (1.0f - dropout_prob)
+                                               : 1.0f);
+  size_t num_groups = (n + 3) / 4;
+  for (size_t group = blockDim.x * blockIdx.x + threadIdx.x;
+       group < num_groups; group += blockDim.x * gridDim.x) {
+    platform::Philox4x32 rng(seed_offset.seed, group, seed_offset.offset);
+    auto r = rng();
+    for (int j = 0; j < 4; ++j) {
+      size_t idx = group * 4 + j;
+      if (idx >= n) break;
+      bool kept = platform::PhiloxUniform<float>(r.x[j]) >= dropout_prob;
+      T mask = kept ? scale : static_cast<T>(0);
+      T dest = src[idx] * mask;
+      if (residual != nullptr) dest += residual[idx];
+      mask_data[idx] = mask;
+      dst[idx] = dest;
+    }
+  }
+}
+
+// A thread generates the 8 elements of a byte of the bit mask from 2 Philox
+// calls, so the bytes are written without atomics. The elements are kept as
+// in RandomGenerator.
+template <typename T>
+__global__ void RandomBitMaskGenerator(
+    const size_t n, const platform::PhiloxSeedOffset seed_offset,
+    const float dropout_prob, const T* src, const T* residual,
+    uint8_t* mask_data, T* dst, bool is_upscale_in_train) {
+  T scale = static_cast<T>(is_upscale_in_train ? 1.0f / (1.0f - dropout_prob)
+                                               : 1.0f);
+  size_t num_bytes = (n + 7) / 8;
+  for (size_t byte_idx = blockDim.x * blockIdx.x + threadIdx.x;
+       byte_idx < num_bytes; byte_idx += blockDim.x * gridDim.x) {
+    uint8_t bits = 0;
+    for (int k = 0; k < 2; ++k) {
+      size_t group = byte_idx * 2 + k;
+      platform::Philox4x32 rng(seed_offset.seed, group, seed_offset.offset);
+      auto r = rng();
+      for (int j = 0; j < 4; ++j) {
+        size_t idx = group * 4 + j;
+        if (idx >= n) break;
+        bool kept = platform::PhiloxUniform<float>(r.x[j]) >= dropout_prob;
+        T dest = kept ? src[idx] * scale : static_cast<T>(0);
+        if (residual != nullptr) dest += residual[idx];
+        dst[idx] = dest;
+        if (kept) bits |= 1 << (k * 4 + j);
+      }
+    }
+    mask_data[byte_idx] = bits;
+  }
+}
+
+// Out = dropout(X) + residual, the residual is ignored if it is nullptr.
+template <typename Place, typename T>
+void GPUDropoutForward(const framework::ExecutionContext& context,
+                       const Tensor* x, const Tensor* residual, Tensor* y) {
+  y->mutable_data<T>(context.GetPlace());
+  float dropout_prob = context.Attr<float>("dropout_prob");
 
-  int idx = blockDim.x * blockIdx.x + threadIdx.x;
-  int step_size = 0;
+  auto dropout_implementation =
+      context.Attr<std::string>("dropout_implementation");
+  auto& place = *context.template device_context<Place>().eigen_device();
+  if (!context.Attr<bool>("is_test")) {
+    auto* mask = context.Output<Tensor>("Mask");
+    size_t size = framework::product(x->dims());
+    auto* x_data = x->data<T>();
+    const T* residual_data =
+        residual == nullptr ? nullptr : residual->data<T>();
+    auto* y_data = y->mutable_data<T>(context.GetPlace());
 
-  T mask;
-  T dest;
-  for (; idx < n; idx += blockDim.x * gridDim.x) {
-    T s = src[idx];
-    if (step_size == 0) {
-      rng.discard(idx);
-      step_size = blockDim.x * gridDim.x;
+    auto seed_offset = platform::GetPhiloxSeedOffset(
+        context.Attr<bool>("fix_seed"), context.Attr<int>("seed"), 1);
+
+    int threads = 512;
+    auto stream = context.cuda_device_context().stream();
+    bool is_upscale_in_train = dropout_implementation == "upscale_in_train";
+    if (context.Attr<bool>("bit_mask")) {
+      mask->Resize({DropoutBitMaskSize(size)});
+      auto* mask_data = mask->mutable_data<uint8_t>(context.GetPlace());
+      int grid = (DropoutBitMaskSize(size) + threads - 1) / threads;
+      RandomBitMaskGenerator<T><<<grid, threads, 0, stream>>>(
+          size, seed_offset, dropout_prob, x_data, residual_data, mask_data,
+          y_data, is_upscale_in_train);
     } else {
-      rng.discard(step_size);
+      auto* mask_data = mask->mutable_data<T>(context.GetPlace());
+      int grid = ((size + 3) / 4 + threads - 1) / threads;
+      RandomGenerator<T><<<grid, threads, 0, stream>>>(
+          size, seed_offset, dropout_prob, x_data, residual_data, mask_data,
+          y_data, is_upscale_in_train);
     }
-    if (dist(rng) < dropout_prob) {
-      mask = static_cast<T>(0);
+  } else {
+    auto X = EigenMatrix<T>::Reshape(*x, 1);
+    auto Y = EigenMatrix<T>::Reshape(*y, 1);
+    T scale = dropout_implementation == "upscale_in_train"
+                  ? static_cast<T>(1)
+                  : static_cast<T>(1.0f - dropout_prob);
+    if (residual != nullptr) {
+      Y.device(place) = X * scale + EigenMatrix<T>::Reshape(*residual, 1);
+    } else if (dropout_implementation == "upscale_in_train") {
+      Y.device(place) = X;
     } else {
-      if (is_upscale_in_train) {
-        mask = static_cast<T>(1.0f / (1.0f - dropout_prob));
-      } else {
-        mask = static_cast<T>(1);
-      }
+      Y.device(place) = X * scale;
     }
-    dest = s * mask;
-    mask_data[idx] = mask;
-    dst[idx] = dest;
   }
 }
 
-// It seems that Eigen::Tensor::setRandom in GPU will SEGFAULT.
-// Use std::random and thrust::random(thrust is a std library in CUDA) to
-// implement uniform random.
 template <typename Place, typename T>
 class GPUDropoutKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext& context) const override {
-    auto* x = context.Input<Tensor>("X");
-    auto* y = context.Output<Tensor>("Out");
-    y->mutable_data<T>(context.GetPlace());
-    float dropout_prob = context.Attr<float>("dropout_prob");
-
-    auto dropout_implementation =
-        context.Attr<std::string>("dropout_implementation");
-    auto& place = *context.template device_context<Place>().eigen_device();
-    if (!context.Attr<bool>("is_test")) {
-      auto* mask = context.Output<Tensor>("Mask");
-      auto* mask_data = mask->mutable_data<T>(context.GetPlace());
-      size_t size = framework::product(mask->dims());
-      auto* x_data = x->data<T>();
-      auto* y_data = y->mutable_data<T>(context.GetPlace());
-
-      std::random_device rnd;
-      int seed =
-          context.Attr<bool>("fix_seed") ? context.Attr<int>("seed") : rnd();
+    GPUDropoutForward<Place, T>(context, context.Input<Tensor>("X"), nullptr,
+                                context.Output<Tensor>("Out"));
+  }
+};
 
-      int threads = 512;
-      int grid = (x->numel() + threads - 1) / threads;
-      RandomGenerator<
-          T><<<grid, threads, 0, context.cuda_device_context().stream()>>>(
-          size, seed, dropout_prob, x_data, mask_data, y_data,
-          (dropout_implementation == "upscale_in_train"));
-    } else {
-      auto X = EigenMatrix<T>::Reshape(*x, 1);
-      auto Y = EigenMatrix<T>::Reshape(*y, 1);
-      if (dropout_implementation == "upscale_in_train") {
-        Y.device(place) = X;
-      } else {
-        Y.device(place) = X * static_cast<T>(1.0f - dropout_prob);
-      }
-    }
+template <typename Place, typename T>
+class GPUFusedDropoutAddKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    GPUDropoutForward<Place, T>(context, context.Input<Tensor>("X"),
+                                context.Input<Tensor>("Y"),
+                                context.Output<Tensor>("Out"));
   }
 };
 
@@ -116,4 +165,15 @@ REGISTER_OP_CUDA_KERNEL(
     ops::GPUDropoutKernel<plat::CUDADeviceContext, double>);
 REGISTER_OP_CUDA_KERNEL(
     dropout_grad, ops::DropoutGradKernel<plat::CUDADeviceContext, float>,
+    ops::DropoutGradKernel<plat::CUDADeviceContext, plat::float16>,
     ops::DropoutGradKernel<plat::CUDADeviceContext, double>);
+REGISTER_OP_CUDA_KERNEL(
+    fused_dropout_add,
+    ops::GPUFusedDropoutAddKernel<plat::CUDADeviceContext, float>,
+    ops::GPUFusedDropoutAddKernel<plat::CUDADeviceContext, plat::float16>,
+    ops::GPUFusedDropoutAddKernel<plat::CUDADeviceContext, double>);
+REGISTER_OP_CUDA_KERNEL(
+    fused_dropout_add_grad,
+    ops::FusedDropoutAddGradKernel<plat::CUDADeviceContext, float>,
+    ops::FusedDropoutAddGradKernel<plat::CUDADeviceContext, plat::float16>,
+    ops::FusedDropoutAddGradKernel<plat::CUDADeviceContext, double>);
@@ -13,11 +13,15 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 #pragma once
 
+#include <cstring>
 #include <random>
 #include <string>
 
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/platform/for_range.h"
+#include "paddle/fluid/platform/hostdevice.h"
 
 namespace paddle {
 namespace operators {
@@ -27,80 +31,177 @@ template <typename T, int MajorType = Eigen::RowMajor,
           typename IndexType = Eigen::DenseIndex>
 using EigenMatrix = framework::EigenMatrix<T, MajorType, IndexType>;
 
+// With the bit_mask attribute, the Mask is a uint8 tensor holding a bit per
+// element of X, the bit i % 8 of the byte i / 8 is set if the element i is
+// kept. It is 1/8 of the size of a float mask of the same elements.
+inline int64_t DropoutBitMaskSize(int64_t numel) { return (numel + 7) / 8; }
+
+HOSTDEVICE inline bool DropoutBitMaskKept(const uint8_t* mask, int64_t i) {
+  return (mask[i >> 3] >> (i & 7)) & 1;
+}
+
+// The scale of the kept elements in the training.
+inline float DropoutKeptScale(const framework::ExecutionContext& context) {
+  float dropout_prob = context.Attr<float>("dropout_prob");
+  return context.Attr<std::string>("dropout_implementation") ==
+                 "upscale_in_train"
+             ? 1.0f / (1.0f - dropout_prob)
+             : 1.0f;
+}
+
+// Out = dropout(X) + residual, the residual is ignored if it is nullptr. It
+// is shared by the dropout and fused_dropout_add operators.
 template <typename DeviceContext, typename T>
-class CPUDropoutKernel : public framework::OpKernel<T> {
- public:
-  void Compute(const framework::ExecutionContext& context) const override {
-    auto* x = context.Input<Tensor>("X");
-    auto* y = context.Output<Tensor>("Out");
-    const auto* x_data = x->data<T>();
-    auto* y_data = y->mutable_data<T>(context.GetPlace());
-    float dropout_prob = context.Attr<float>("dropout_prob");
-
-    auto dropout_implementation =
-        context.Attr<std::string>("dropout_implementation");
-    if (!context.Attr<bool>("is_test")) {
-      auto* mask = context.Output<Tensor>("Mask");
-      auto* mask_data = mask->mutable_data<T>(context.GetPlace());
-
-      // NOTE: fixed seed should only be used in unittest or for debug.
-      // Guarantee to use random seed in training.
-      std::random_device rnd;
-      std::minstd_rand engine;
-      int seed =
-          context.Attr<bool>("fix_seed") ? context.Attr<int>("seed") : rnd();
-      engine.seed(seed);
-
-      std::uniform_real_distribution<float> dist(0, 1);
-
-      size_t size = framework::product(mask->dims());
-      for (size_t i = 0; i < size; ++i) {
-        if (dist(engine) < dropout_prob) {
-          mask_data[i] = 0;
-          y_data[i] = 0;
+void CPUDropoutForward(const framework::ExecutionContext& context,
+                       const Tensor* x, const Tensor* residual, Tensor* y) {
+  const auto* x_data = x->data<T>();
+  const T* residual_data = residual == nullptr ? nullptr : residual->data<T>();
+  auto* y_data = y->mutable_data<T>(context.GetPlace());
+  float dropout_prob = context.Attr<float>("dropout_prob");
+
+  auto dropout_implementation =
+      context.Attr<std::string>("dropout_implementation");
+  if (!context.Attr<bool>("is_test")) {
+    auto* mask = context.Output<Tensor>("Mask");
+    size_t size = framework::product(x->dims());
+    bool bit_mask = context.Attr<bool>("bit_mask");
+    T* mask_data = nullptr;
+    uint8_t* bit_mask_data = nullptr;
+    if (bit_mask) {
+      mask->Resize({DropoutBitMaskSize(size)});
+      bit_mask_data = mask->mutable_data<uint8_t>(context.GetPlace());
+      memset(bit_mask_data, 0, DropoutBitMaskSize(size));
+    } else {
+      mask_data = mask->mutable_data<T>(context.GetPlace());
+    }
+
+    // NOTE: fixed seed should only be used in unittest or for debug.
+    // Guarantee to use random seed in training.
+    std::random_device rnd;
+    std::minstd_rand engine;
+    int seed =
+        context.Attr<bool>("fix_seed") ? context.Attr<int>("seed") : rnd();
+    engine.seed(seed);
+
+    std::uniform_real_distribution<float> dist(0, 1);
+
+    for (size_t i = 0; i < size; ++i) {
+      T out = 0;
+      T mask_value = 0;
+      if (dist(engine) >= dropout_prob) {
+        if (dropout_implementation == "upscale_in_train") {
+          mask_value = 1.0f / static_cast<T>(1.0f - dropout_prob);
+          out = x_data[i] / static_cast<T>(1.0f - dropout_prob);
         } else {
-          if (dropout_implementation == "upscale_in_train") {
-            mask_data[i] = 1.0f / static_cast<T>(1.0f - dropout_prob);
-            y_data[i] = x_data[i] / static_cast<T>(1.0f - dropout_prob);
-          } else {
-            mask_data[i] = 1;
-            y_data[i] = x_data[i];
-          }
+          mask_value = 1;
+          out = x_data[i];
         }
+        if (bit_mask) bit_mask_data[i >> 3] |= 1 << (i & 7);
       }
+      if (!bit_mask) mask_data[i] = mask_value;
+      y_data[i] = residual_data == nullptr ? out : out + residual_data[i];
+    }
+  } else {
+    auto X = EigenMatrix<T>::Reshape(*x, 1);
+    auto Y = EigenMatrix<T>::Reshape(*y, 1);
+    auto& place =
+        *context.template device_context<DeviceContext>().eigen_device();
+    T scale = dropout_implementation == "upscale_in_train"
+                  ? static_cast<T>(1)
+                  : static_cast<T>(1.0f - dropout_prob);
+    if (residual != nullptr) {
+      Y.device(place) = X * scale + EigenMatrix<T>::Reshape(*residual, 1);
+    } else if (dropout_implementation == "upscale_in_train") {
+      Y.device(place) = X;
     } else {
-      auto X = EigenMatrix<T>::Reshape(*x, 1);
-      auto Y = EigenMatrix<T>::Reshape(*y, 1);
-      auto& place =
-          *context.template device_context<DeviceContext>().eigen_device();
-      if (dropout_implementation == "upscale_in_train") {
-        Y.device(place) = X;
-      } else {
-        Y.device(place) = X * static_cast<T>(1.0f - dropout_prob);
-      }
+      Y.device(place) = X * scale;
     }
   }
+}
+
+template <typename DeviceContext, typename T>
+class CPUDropoutKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    CPUDropoutForward<DeviceContext, T>(context, context.Input<Tensor>("X"),
+                                        nullptr,
+                                        context.Output<Tensor>("Out"));
+  }
 };
 
+template <typename T>
+struct DropoutBitMaskGradFunctor {
+  HOSTDEVICE void operator()(size_t i) const {
+    d_x[i] = DropoutBitMaskKept(mask, i) ? d_y[i] * scale : static_cast<T>(0);
+  }
+
+  const T* d_y;
+  const uint8_t* mask;
+  T scale;
+  T* d_x;
+};
+
+// X@GRAD = Out@GRAD * Mask, shared by the dropout and fused_dropout_add
+// operators.
+template <typename DeviceContext, typename T>
+void DropoutBackward(const framework::ExecutionContext& context,
+                     const Tensor* grad_y, Tensor* grad_x) {
+  PADDLE_ENFORCE(!context.Attr<bool>("is_test"),
+                 "GradOp is only callable when is_test is false");
+  auto* mask = context.Input<Tensor>("Mask");
+  auto* grad_x_data = grad_x->mutable_data<T>(context.GetPlace());
+  auto& dev_ctx = context.template device_context<DeviceContext>();
+
+  if (context.Attr<bool>("bit_mask")) {
+    DropoutBitMaskGradFunctor<T> functor{
+        grad_y->data<T>(), mask->data<uint8_t>(),
+        static_cast<T>(DropoutKeptScale(context)), grad_x_data};
+    platform::ForRange<DeviceContext> for_range(dev_ctx, grad_y->numel());
+    for_range(functor);
+    return;
+  }
+
+  auto M = EigenMatrix<T>::Reshape(*mask, 1);
+  auto dX = EigenMatrix<T>::Reshape(*grad_x, 1);
+  auto dY = EigenMatrix<T>::Reshape(*grad_y, 1);
+  dX.device(*dev_ctx.eigen_device()) = dY * M;
+}
+
 template <typename DeviceContext, typename T>
 class DropoutGradKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext& context) const override {
-    PADDLE_ENFORCE(!context.Attr<bool>("is_test"),
-                   "GradOp is only callable when is_test is false");
-
-    auto* grad_x = context.Output<Tensor>(framework::GradVarName("X"));
-    auto* grad_y = context.Input<Tensor>(framework::GradVarName("Out"));
-    auto* mask = context.Input<Tensor>("Mask");
-    grad_x->mutable_data<T>(context.GetPlace());
+    DropoutBackward<DeviceContext, T>(
+        context, context.Input<Tensor>(framework::GradVarName("Out")),
+        context.Output<Tensor>(framework::GradVarName("X")));
+  }
+};
 
-    auto M = EigenMatrix<T>::Reshape(*mask, 1);
-    auto dX = EigenMatrix<T>::Reshape(*grad_x, 1);
-    auto dY = EigenMatrix<T>::Reshape(*grad_y, 1);
+// Out = dropout(X) + Y, the residual connection of a dropout in a kernel.
+template <typename DeviceContext, typename T>
+class CPUFusedDropoutAddKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    CPUDropoutForward<DeviceContext, T>(context, context.Input<Tensor>("X"),
+                                        context.Input<Tensor>("Y"),
+                                        context.Output<Tensor>("Out"));
+  }
+};
 
-    auto& place =
-        *context.template device_context<DeviceContext>().eigen_device();
-    dX.device(place) = dY * M;
+template <typename DeviceContext, typename T>
+class FusedDropoutAddGradKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto* grad_out = context.Input<Tensor>(framework::GradVarName("Out"));
+    auto* grad_x = context.Output<Tensor>(framework::GradVarName("X"));
+    auto* grad_y = context.Output<Tensor>(framework::GradVarName("Y"));
+    if (grad_x != nullptr) {
+      DropoutBackward<DeviceContext, T>(context, grad_out, grad_x);
+    }
+    if (grad_y != nullptr) {
+      framework::TensorCopy(*grad_out, context.GetPlace(),
+                            context.device_context(), grad_y);
+    }
   }
 };
 
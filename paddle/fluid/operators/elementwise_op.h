@@ -75,6 +75,15 @@ class ElementwiseOpInferVarType : public framework::VarTypeInference {
   }
 };
 
+// Out may be computed in X when Y is broadcast to X, the pass computing in
+// place checks the shapes.
+class ElementwiseOpInplace : public framework::InplaceOpInference {
+ public:
+  framework::InplacePairs operator()() const override {
+    return {{"X", "Out"}};
+  }
+};
+
 class ElementwiseOpMaker : public framework::OpProtoAndCheckerMaker {
  public:
   void Make() final {
@@ -256,7 +265,8 @@ class ElemwiseGradKernel : public framework::OpKernel<T> {
   REGISTER_OPERATOR(op_type, ::paddle::operators::ElementwiseOp,        \
                     __ElemwiseOp##op_type##Maker__,                     \
                     ::paddle::operators::ElementwiseOpInferVarType,     \
-                    ::paddle::framework::DefaultGradOpDescMaker<true>); \
+                    ::paddle::framework::DefaultGradOpDescMaker<true>,  \
+                    ::paddle::operators::ElementwiseOpInplace);         \
   REGISTER_OPERATOR(op_type##_grad, ::paddle::operators::ElementwiseOpGrad)
 
 #define REGISTER_ELEMWISE_EXPLICIT_OP(op_type, op_name, equation, ...) \
@@ -269,6 +279,7 @@ class ElemwiseGradKernel : public framework::OpKernel<T> {
   REGISTER_OPERATOR(op_type, ::paddle::operators::ElementwiseOp,       \
                     __ElemwiseOp##op_type##Maker__,                    \
                     ::paddle::operators::ElementwiseOpInferVarType,    \
-                    op_type##GradMaker);                               \
+                    op_type##GradMaker,                                \
+                    ::paddle::operators::ElementwiseOpInplace);        \
   REGISTER_OPERATOR(op_type##_grad,                                    \
                     ::paddle::operators::ElementwiseOpExplicitGrad)
@@ -17,6 +17,7 @@ limitations under the License. */
 #include <glog/logging.h>
 #include <algorithm>
 #include <iterator>
+#include <type_traits>
 #include <vector>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
@@ -89,6 +90,73 @@ inline framework::DDim trim_trailing_singular_dims(
   return actual_dims;
 }
 
+// The broadcast of y to x, in the fewest dims. The adjacent dims of x that
+// y is broadcast along, or not, are merged into one. y_strides is 0 on the
+// broadcast dims, and the strides of y on the others.
+struct BroadcastDims {
+  static constexpr int kMaxRank = 9;
+
+  int rank;
+  int64_t dims[kMaxRank];
+  int64_t y_strides[kMaxRank];
+};
+
+// Y is aligned to x_dims at axis, each of its dims equals to the one of x or
+// is 1.
+inline BroadcastDims GetBroadcastDims(const framework::DDim &x_dims,
+                                      const framework::DDim &y_dims,
+                                      int axis) {
+  PADDLE_ENFORCE_LE(axis + y_dims.size(), x_dims.size(),
+                    "Broadcast dimension mismatch.");
+  BroadcastDims b;
+  b.rank = 0;
+  // Whether y is broadcast along the last merged dim.
+  bool last_broadcast = false;
+  for (int i = 0; i < x_dims.size(); ++i) {
+    int64_t y_dim =
+        (i >= axis && i < axis + y_dims.size()) ? y_dims[i - axis] : 1;
+    PADDLE_ENFORCE(y_dim == x_dims[i] || y_dim == 1,
+                   "Broadcast dimension mismatch.");
+    if (x_dims[i] == 1) continue;
+    bool broadcast = y_dim == 1;
+    if (b.rank > 0 && broadcast == last_broadcast) {
+      b.dims[b.rank - 1] *= x_dims[i];
+    } else {
+      PADDLE_ENFORCE_LT(b.rank, BroadcastDims::kMaxRank);
+      b.dims[b.rank] = x_dims[i];
+      b.y_strides[b.rank] = broadcast ? 0 : 1;
+      ++b.rank;
+    }
+    last_broadcast = broadcast;
+  }
+  if (b.rank == 0) {
+    b.rank = 1;
+    b.dims[0] = 1;
+    b.y_strides[0] = 0;
+  }
+  int64_t stride = 1;
+  for (int i = b.rank - 1; i >= 0; --i) {
+    if (b.y_strides[i] != 0) {
+      b.y_strides[i] = stride;
+      stride *= b.dims[i];
+    }
+  }
+  return b;
+}
+
+// Whether each dim of y equals to the one of x it is aligned to, so that the
+// broadcast can be described by get_mid_dims. Otherwise it needs the
+// BroadcastDims.
+inline bool IsMidDimsBroadcast(const framework::DDim &x_dims,
+                               const framework::DDim &y_dims, int axis) {
+  for (int i = 0; i < y_dims.size(); ++i) {
+    if (axis + i < x_dims.size() && y_dims[i] != x_dims[axis + i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
 template <typename T, typename DeviceContext>
 class RowwiseTransformIterator;
 
@@ -226,23 +294,112 @@ class TransformFunctor {
         func_(func) {}
 
   inline void Run() const {
-    platform::Transform<DeviceContext> trans;
-    trans(ctx_, x_, x_ + nx_, y_, z_, func_);
+    platform::ParallelFor(ctx_, nx_, [this](int64_t begin, int64_t end) {
+      platform::Transform<DeviceContext> trans;
+      trans(ctx_, x_ + begin, x_ + end, y_ + begin, z_ + begin, func_);
+    });
+  }
+
+  inline void RunRowWise(int n, int pre) const { RunRowWise(ctx_, n, pre); }
+
+  inline void RunMidWise(int n, int pre, int post) const {
+    RunMidWise(ctx_, n, pre, post);
+  }
+
+  inline void RunBroadcast(const BroadcastDims &b) const {
+    RunBroadcast(ctx_, b);
   }
 
-  inline void RunRowWise(int n, int pre) const {
+ private:
+  template <typename Context>
+  inline void RunRowWise(const Context &ctx, int n, int pre) const {
     platform::Transform<DeviceContext> trans;
     trans(ctx_, x_, x_ + nx_, RowwiseTransformIterator<T, DeviceContext>(y_, n),
           z_, func_);
   }
 
-  inline void RunMidWise(int n, int pre, int post) const {
+  inline void RunRowWise(const platform::CPUDeviceContext &ctx, int n,
+                         int pre) const {
+    BroadcastDims b;
+    b.rank = 2;
+    b.dims[0] = pre;
+    b.dims[1] = n;
+    b.y_strides[0] = 0;
+    b.y_strides[1] = 1;
+    RunBroadcast(ctx, b);
+  }
+
+  template <typename Context>
+  inline void RunMidWise(const Context &ctx, int n, int pre, int post) const {
     platform::Transform<DeviceContext> trans;
     trans(ctx_, x_, x_ + nx_,
           MidWiseTransformIterator<T, DeviceContext>(y_, n, post), z_, func_);
   }
 
- private:
+  inline void RunMidWise(const platform::CPUDeviceContext &ctx, int n, int pre,
+                         int post) const {
+    BroadcastDims b;
+    b.rank = 3;
+    b.dims[0] = pre;
+    b.dims[1] = n;
+    b.dims[2] = post;
+    b.y_strides[0] = 0;
+    b.y_strides[1] = 1;
+    b.y_strides[2] = 0;
+    RunBroadcast(ctx, b);
+  }
+
+  // Run the rows of the innermost dim, each of which is a contiguous loop
+  // over x and z with either a contiguous y or a scalar one. The offset of y
+  // is carried from row to row, without any division per element.
+  inline void RunBroadcast(const platform::CPUDeviceContext &ctx,
+                           const BroadcastDims &b) const {
+    int outer_rank = b.rank - 1;
+    int64_t inner = b.dims[outer_rank];
+    bool inner_broadcast = b.y_strides[outer_rank] == 0;
+    int64_t rows = nx_ / inner;
+    if (rows == 0) return;
+    ctx.ParallelFor(
+        rows,
+        [&](int64_t begin, int64_t end) {
+          int64_t idx[BroadcastDims::kMaxRank];
+          int64_t y_offset = 0;
+          int64_t rest = begin;
+          for (int d = outer_rank - 1; d >= 0; --d) {
+            idx[d] = rest % b.dims[d];
+            rest /= b.dims[d];
+            y_offset += idx[d] * b.y_strides[d];
+          }
+          for (int64_t row = begin; row < end; ++row) {
+            const T *x = x_ + row * inner;
+            OutType *z = z_ + row * inner;
+            if (inner_broadcast) {
+              T y = y_[y_offset];
+              for (int64_t i = 0; i < inner; ++i) {
+                z[i] = func_(x[i], y);
+              }
+            } else {
+              const T *y = y_ + y_offset;
+              for (int64_t i = 0; i < inner; ++i) {
+                z[i] = func_(x[i], y[i]);
+              }
+            }
+            for (int d = outer_rank - 1; d >= 0; --d) {
+              y_offset += b.y_strides[d];
+              if (++idx[d] < b.dims[d]) break;
+              y_offset -= b.y_strides[d] * b.dims[d];
+              idx[d] = 0;
+            }
+          }
+        },
+        inner);
+  }
+
+#ifdef __NVCC__
+  inline void RunBroadcast(const platform::CUDADeviceContext &ctx,
+                           const BroadcastDims &b) const;
+#endif
+
   const T *x_;
   const T *y_;
   OutType *z_;
@@ -251,6 +408,40 @@ class TransformFunctor {
   Functor func_;
 };
 
+#ifdef __NVCC__
+// One thread for each element, so the reads of x and the writes of z are
+// coalesced.
+template <typename T, typename OutType, typename Functor>
+__global__ void ElementwiseBroadcastCUDAKernel(const T *x, const T *y,
+                                               OutType *z, int64_t n,
+                                               BroadcastDims b, Functor func) {
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += blockDim.x * gridDim.x) {
+    int64_t rest = i;
+    int64_t y_offset = 0;
+    for (int d = b.rank - 1; d >= 0; --d) {
+      y_offset += (rest % b.dims[d]) * b.y_strides[d];
+      rest /= b.dims[d];
+    }
+    z[i] = func(x[i], y[y_offset]);
+  }
+}
+
+template <typename Functor, typename T, typename DeviceContext,
+          typename OutType>
+inline void TransformFunctor<Functor, T, DeviceContext, OutType>::RunBroadcast(
+    const platform::CUDADeviceContext &ctx, const BroadcastDims &b) const {
+  if (nx_ == 0) return;
+  const int threads = 512;
+  int max_blocks = std::max(ctx.GetMaxPhysicalThreadCount() / threads, 1);
+  int blocks = static_cast<int>(
+      std::min<int64_t>((nx_ + threads - 1) / threads, max_blocks));
+  ElementwiseBroadcastCUDAKernel<T, OutType,
+                                 Functor><<<blocks, threads, 0, ctx.stream()>>>(
+      x_, y_, z_, nx_, b, func_);
+}
+#endif
+
 #define EIGEN_FUNCTOR(name, eigen_op)                                          \
   struct Eigen##name##Functor {                                                \
     template <typename DeviceContext, typename T>                              \
@@ -335,6 +526,76 @@ struct ElemwiseGradNoBroadcast {
   T *dy_;
 };
 
+// The gradient of the broadcast described by BroadcastDims, called once for
+// each element of y. The elements of x broadcast with it are summed into dy,
+// and each element of x is visited by exactly one call, so no atomics are
+// needed on either place.
+template <typename T, typename DX_OP, typename DY_OP>
+struct ElemwiseGradBroadcastDims {
+  ElemwiseGradBroadcastDims(const BroadcastDims &b, const T *x, const T *y,
+                            const T *out, const T *dout, DX_OP dx_op,
+                            DY_OP dy_op, T *dx, T *dy)
+      : b_(b),
+        x_(x),
+        y_(y),
+        out_(out),
+        dout_(dout),
+        dx_op_(dx_op),
+        dy_op_(dy_op),
+        dx_(dx),
+        dy_(dy) {
+    int64_t stride = 1;
+    num_broadcast_ = 1;
+    for (int d = b_.rank - 1; d >= 0; --d) {
+      x_strides_[d] = stride;
+      stride *= b_.dims[d];
+      if (b_.y_strides[d] == 0) num_broadcast_ *= b_.dims[d];
+    }
+  }
+
+  HOSTDEVICE void operator()(size_t j) {
+    int64_t rest = static_cast<int64_t>(j);
+    int64_t x_base = 0;
+    for (int d = b_.rank - 1; d >= 0; --d) {
+      if (b_.y_strides[d] == 0) continue;
+      x_base += (rest % b_.dims[d]) * x_strides_[d];
+      rest /= b_.dims[d];
+    }
+    T val(0);
+    for (int64_t k = 0; k < num_broadcast_; ++k) {
+      rest = k;
+      int64_t x_offset = x_base;
+      for (int d = b_.rank - 1; d >= 0; --d) {
+        if (b_.y_strides[d] != 0) continue;
+        x_offset += (rest % b_.dims[d]) * x_strides_[d];
+        rest /= b_.dims[d];
+      }
+      if (dx_ != nullptr) {
+        dx_[x_offset] =
+            dx_op_(x_[x_offset], y_[j], out_[x_offset], dout_[x_offset]);
+      }
+      if (dy_ != nullptr) {
+        val += dy_op_(x_[x_offset], y_[j], out_[x_offset], dout_[x_offset]);
+      }
+    }
+    if (dy_ != nullptr) {
+      dy_[j] = val;
+    }
+  }
+
+  BroadcastDims b_;
+  int64_t x_strides_[BroadcastDims::kMaxRank];
+  int64_t num_broadcast_;
+  const T *x_;
+  const T *y_;
+  const T *out_;
+  const T *dout_;
+  DX_OP dx_op_;
+  DY_OP dy_op_;
+  T *dx_;
+  T *dy_;
+};
+
 template <typename T, typename DX_OP, typename DY_OP>
 static void ElemwiseGradBroadcast1CPU(const T *x, const T *y, const T *out,
                                       const T *dout, int h, int w, DX_OP dx_op,
@@ -365,7 +626,7 @@ static __global__ void ElemwiseGradBroadcast1CUDAKernel(
   int j = blockIdx.x;
   int i = threadIdx.x;
   int tid = threadIdx.x;
-  T val = 0;
+  T val(0);
 
   do {
     int x_offset = i * w + j;
@@ -433,7 +694,7 @@ static __global__ void ElemwiseGradBroadcast2CUDAKernel(
   int tid = threadIdx.x;
   int j = blockIdx.x;
 
-  T val = 0;
+  T val(0);
   int ttid = tid;
 
   while (true) {
@@ -509,6 +770,21 @@ void ElemwiseGradComputeWithBroadcast(
   auto y_dim = trim_trailing_singular_dims(y_dim_untrimed);
   axis = (y_dim.size() == 0) ? x_dim.size() : axis;
 
+  if (!IsMidDimsBroadcast(x_dim, y_dim, axis)) {
+    auto b = GetBroadcastDims(x_dim, y_dim, axis);
+    int64_t ny = 1;
+    for (int d = 0; d < b.rank; ++d) {
+      if (b.y_strides[d] != 0) ny *= b.dims[d];
+    }
+    platform::ForRange<DeviceContext> for_range(
+        ctx.template device_context<DeviceContext>(), static_cast<size_t>(ny));
+    for_range(ElemwiseGradBroadcastDims<T, DX_OP, DY_OP>(
+        b, x.data<T>(), y.data<T>(), out.data<T>(), dout.data<T>(), dx_op,
+        dy_op, dx == nullptr ? nullptr : dx->mutable_data<T>(ctx.GetPlace()),
+        dy == nullptr ? nullptr : dy->mutable_data<T>(ctx.GetPlace())));
+    return;
+  }
+
   int pre, n, post;
   get_mid_dims(x_dim, y_dim, axis, &pre, &n, &post);
   if (post == 1) {
@@ -667,6 +943,13 @@ void ElementwiseComputeEx(const framework::ExecutionContext &ctx,
   auto y_dims = trim_trailing_singular_dims(y_dims_untrimed);
   axis = (y_dims.size() == 0) ? x_dims.size() : axis;
 
+  // The dims of y could be 1 where the ones of x are not.
+  if (!IsMidDimsBroadcast(x_dims, y_dims, axis) ||
+      std::is_same<DeviceContext, platform::CPUDeviceContext>::value) {
+    functor.RunBroadcast(GetBroadcastDims(x_dims, y_dims, axis));
+    return;
+  }
+
   int pre, n, post;
   get_mid_dims(x_dims, y_dims, axis, &pre, &n, &post);
   if (post == 1) {
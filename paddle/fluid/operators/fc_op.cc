@@ -15,7 +15,9 @@ limitations under the License. */
 #include "paddle/fluid/operators/fc_op.h"
 #include <vector>
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/block_sparse_gemm.h"
 #include "paddle/fluid/operators/math/fc_compute.h"
+#include "paddle/fluid/operators/math/packed_gemm.h"
 
 namespace paddle {
 namespace operators {
@@ -111,6 +113,15 @@ void FCOpMaker::Make() {
   AddAttr<bool>("use_mkldnn",
                 "(bool, default false) Only used in mkldnn kernel")
       .SetDefault(false);
+  AddAttr<bool>(math::kUsePackedWeight,
+                "(bool, default false) Only used in inference, whether to "
+                "pack the constant W once and reuse it.")
+      .SetDefault(false);
+  AddAttr<int>(math::kWeightBlockSize,
+               "(int, default 0) Only used in inference, the size of the "
+               "blocks of the constant sparse W, whose zero blocks are "
+               "skipped. 0 if W is dense.")
+      .SetDefault(0);
   AddComment(R"DOC(
   Fully Connected Operator.
 
@@ -136,6 +147,19 @@ class FCOpKernel : public framework::OpKernel<T> {
     const T* w_data = w->data<T>();
     T* output_data = output->mutable_data<T>(ctx.GetPlace());
     auto blas = math::GetBlas<platform::CPUDeviceContext, T>(ctx);
+    if (math::BlockSparseWeightMatMul<platform::CPUDeviceContext, T>()(
+            ctx, "W", in_dims[0], w_dims[1], w_dims[0], input_data,
+            output_data) ||
+        (ctx.Attr<bool>(math::kUsePackedWeight) &&
+         math::PackedMatMul<platform::CPUDeviceContext, T>()(
+             ctx, "W", false, in_dims[0], w_dims[1], w_dims[0], input_data,
+             output_data))) {
+      if (bias) {
+        math::FCAddBias<T>(in_dims[0], w_dims[1], output_data,
+                           bias->data<T>());
+      }
+      return;
+    }
     math::FCCompute<platform::CPUDeviceContext, T>(
         blas, in_dims[0], w_dims[1], w_dims[0], input_data, w_data, output_data,
         bias ? bias->data<T>() : NULL);
@@ -151,4 +175,5 @@ namespace ops = paddle::operators;
 REGISTER_OPERATOR(fc, ops::FCOp, ops::FCOpMaker,
                   paddle::framework::DefaultGradOpDescMaker<true>);
 REGISTER_OPERATOR(fc_grad, ops::FCOpGrad);
-REGISTER_OP_CPU_KERNEL(fc, ops::FCOpKernel<float>, ops::FCOpKernel<double>);
+REGISTER_OP_CPU_KERNEL(fc, ops::FCOpKernel<float>, ops::FCOpKernel<double>,
+                       ops::FCOpKernel<paddle::platform::bfloat16>);
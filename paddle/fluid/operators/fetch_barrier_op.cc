@@ -40,19 +40,37 @@ class FetchBarrierOp : public framework::OperatorBase {
         distributed::RPCClient::GetInstance<RPCCLIENT_T>(
             Attr<int>("trainer_id"));
 
-    PADDLE_ENFORCE(rpc_client->Wait(), "internal error in RPCClient");
+    // With the received parameters as the inputs, each recv has waited for
+    // its own variables, and the sends of the next step may be in flight, so
+    // only the barriers are waited for.
+    bool wait_all = !HasInputs("X") || Inputs("X").empty();
+    if (wait_all) {
+      PADDLE_ENFORCE(rpc_client->Wait(), "internal error in RPCClient");
+    }
 
+    std::vector<distributed::VarHandlePtr> rets;
     for (auto& ep : eps) {
       VLOG(3) << "fetch barrier, ep: " << ep;
-      rpc_client->AsyncSendFetchBarrier(ep);
+      rets.push_back(rpc_client->AsyncSendFetchBarrier(ep));
+    }
+    if (wait_all) {
+      PADDLE_ENFORCE(rpc_client->Wait(), "internal error in RPCClient");
+    } else {
+      for (auto& ret : rets) {
+        PADDLE_ENFORCE(ret->Wait(), "internal error in RPCClient");
+      }
     }
-    PADDLE_ENFORCE(rpc_client->Wait(), "internal error in RPCClient");
   }
 };
 
 class FetchBarrierOpMaker : public framework::OpProtoAndCheckerMaker {
  public:
   void Make() {
+    AddInput("X",
+             "(Any) The received parameters to wait for, the barrier waits "
+             "for all the RPCs if it is empty")
+        .AsDuplicable()
+        .AsDispensable();
     AddOutput("Out", "(Any) Dummy outputs, used for control dependency")
         .AsDuplicable();
     AddComment(R"DOC(
@@ -51,6 +51,9 @@ class FetchOp : public framework::OperatorBase {
       fetch_list->resize(col + 1);
     }
     auto &dst_item = fetch_list->at(col);
+    // The fetched results of the last run may be used by Python without
+    // copying, so the new results are written to a new memory block.
+    dst_item.clear();
 
     // FIXME(yuyang18): Should we assume the fetch operator always generate
     // CPU outputs?
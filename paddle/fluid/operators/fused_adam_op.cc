@@ -0,0 +1,127 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/adam_op.h"
+#include "paddle/fluid/operators/fused_optimizer_op.h"
+
+namespace paddle {
+namespace operators {
+
+class FusedAdamOp : public FusedOptimizerOp {
+ public:
+  using FusedOptimizerOp::FusedOptimizerOp;
+
+ protected:
+  std::vector<std::string> StateNames() const override {
+    return {"Moment1", "Moment2"};
+  }
+
+  std::vector<std::string> ScalarNames() const override {
+    return {"Beta1Pow", "Beta2Pow"};
+  }
+};
+
+class FusedAdamOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Param", "(LoDTensors) the parameters to update.")
+        .AsDuplicable();
+    AddInput("Grad", "(LoDTensors) the dense gradients of the parameters.")
+        .AsDuplicable();
+    AddInput("LearningRate",
+             "(Tensors) a learning rate shared by the parameters, or one of "
+             "each parameter.")
+        .AsDuplicable();
+    AddInput("Moment1", "(LoDTensors) the first moments of the parameters.")
+        .AsDuplicable();
+    AddInput("Moment2", "(LoDTensors) the second moments of the parameters.")
+        .AsDuplicable();
+    AddInput("Beta1Pow",
+             "(Tensors) the beta1 power accumulators of the parameters.")
+        .AsDuplicable();
+    AddInput("Beta2Pow",
+             "(Tensors) the beta2 power accumulators of the parameters.")
+        .AsDuplicable();
+
+    AddOutput("ParamOut",
+              "(LoDTensors) the updated parameters, sharing the memory with "
+              "Input(Param).")
+        .AsDuplicable();
+    AddOutput("Moment1Out", "(LoDTensors) the updated first moments.")
+        .AsDuplicable();
+    AddOutput("Moment2Out", "(LoDTensors) the updated second moments.")
+        .AsDuplicable();
+
+    AddAttr<float>("beta1",
+                   "(float, default 0.9) "
+                   "Exponential decay rate for the "
+                   "first moment estimates.")
+        .SetDefault(0.9f);
+    AddAttr<float>("beta2",
+                   "(float, default 0.999) "
+                   "exponential decay rate for the "
+                   "second moment estimates.")
+        .SetDefault(0.999f);
+    AddAttr<float>("epsilon",
+                   "(float, default 1.0e-8) "
+                   "Constant for numerical stability")
+        .SetDefault(1.0e-8f);
+    AddComment(R"DOC(
+Fused Adam operator
+
+It updates all the parameters as the adam operator does, in a kernel launch
+for a pack of parameters on the GPU. It is created by the
+fuse_optimizer_ops_pass.
+)DOC");
+  }
+};
+
+template <typename T>
+class FusedAdamCPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    T beta1 = static_cast<T>(ctx.Attr<float>("beta1"));
+    T beta2 = static_cast<T>(ctx.Attr<float>("beta2"));
+    T epsilon = static_cast<T>(ctx.Attr<float>("epsilon"));
+    auto params = ctx.MultiInput<framework::Tensor>("Param");
+    auto grads = ctx.MultiInput<framework::Tensor>("Grad");
+    auto lrs = ctx.MultiInput<framework::Tensor>("LearningRate");
+    auto mom1s = ctx.MultiInput<framework::Tensor>("Moment1");
+    auto mom2s = ctx.MultiInput<framework::Tensor>("Moment2");
+    auto beta1_pows = ctx.MultiInput<framework::Tensor>("Beta1Pow");
+    auto beta2_pows = ctx.MultiInput<framework::Tensor>("Beta2Pow");
+    auto param_outs = ctx.MultiOutput<framework::Tensor>("ParamOut");
+    auto mom1_outs = ctx.MultiOutput<framework::Tensor>("Moment1Out");
+    auto mom2_outs = ctx.MultiOutput<framework::Tensor>("Moment2Out");
+    for (size_t i = 0; i < params.size(); ++i) {
+      AdamFunctor<T, CPUAdam> functor(
+          beta1, beta2, epsilon, beta1_pows[i]->data<T>(),
+          beta2_pows[i]->data<T>(), mom1s[i]->data<T>(),
+          mom1_outs[i]->mutable_data<T>(ctx.GetPlace()), mom2s[i]->data<T>(),
+          mom2_outs[i]->mutable_data<T>(ctx.GetPlace()),
+          FusedLearningRate(lrs, i)->data<T>(), grads[i]->data<T>(),
+          params[i]->data<T>(), param_outs[i]->mutable_data<T>(ctx.GetPlace()));
+      functor(static_cast<size_t>(params[i]->numel()));
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(fused_adam, ops::FusedAdamOp,
+                             ops::FusedAdamOpMaker);
+REGISTER_OP_CPU_KERNEL(fused_adam, ops::FusedAdamCPUKernel<float>,
+                       ops::FusedAdamCPUKernel<double>);
@@ -0,0 +1,62 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/adam_op.h"
+#include "paddle/fluid/operators/fused_optimizer_op.h"
+#include "paddle/fluid/operators/math/multi_tensor_apply.h"
+
+namespace paddle {
+namespace operators {
+
+template <typename T>
+class FusedAdamCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    T beta1 = static_cast<T>(ctx.Attr<float>("beta1"));
+    T beta2 = static_cast<T>(ctx.Attr<float>("beta2"));
+    T epsilon = static_cast<T>(ctx.Attr<float>("epsilon"));
+    auto params = ctx.MultiInput<framework::Tensor>("Param");
+    auto grads = ctx.MultiInput<framework::Tensor>("Grad");
+    auto lrs = ctx.MultiInput<framework::Tensor>("LearningRate");
+    auto mom1s = ctx.MultiInput<framework::Tensor>("Moment1");
+    auto mom2s = ctx.MultiInput<framework::Tensor>("Moment2");
+    auto beta1_pows = ctx.MultiInput<framework::Tensor>("Beta1Pow");
+    auto beta2_pows = ctx.MultiInput<framework::Tensor>("Beta2Pow");
+    auto param_outs = ctx.MultiOutput<framework::Tensor>("ParamOut");
+    auto mom1_outs = ctx.MultiOutput<framework::Tensor>("Moment1Out");
+    auto mom2_outs = ctx.MultiOutput<framework::Tensor>("Moment2Out");
+
+    std::vector<AdamFunctor<T, GPUAdam>> functors;
+    std::vector<int64_t> numels(params.size());
+    functors.reserve(params.size());
+    for (size_t i = 0; i < params.size(); ++i) {
+      functors.emplace_back(
+          beta1, beta2, epsilon, beta1_pows[i]->data<T>(),
+          beta2_pows[i]->data<T>(), mom1s[i]->data<T>(),
+          mom1_outs[i]->mutable_data<T>(ctx.GetPlace()), mom2s[i]->data<T>(),
+          mom2_outs[i]->mutable_data<T>(ctx.GetPlace()),
+          FusedLearningRate(lrs, i)->data<T>(), grads[i]->data<T>(),
+          params[i]->data<T>(), param_outs[i]->mutable_data<T>(ctx.GetPlace()));
+      numels[i] = params[i]->numel();
+    }
+    math::MultiTensorApply(ctx.cuda_device_context(), functors, numels);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(fused_adam, ops::FusedAdamCUDAKernel<float>,
+                        ops::FusedAdamCUDAKernel<double>);
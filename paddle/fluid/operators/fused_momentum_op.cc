@@ -0,0 +1,129 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <math.h>
+#include "paddle/fluid/operators/fused_optimizer_op.h"
+#include "paddle/fluid/operators/momentum_op.h"
+
+namespace paddle {
+namespace operators {
+
+class FusedMomentumOp : public FusedOptimizerOp {
+ public:
+  using FusedOptimizerOp::FusedOptimizerOp;
+
+ protected:
+  std::vector<std::string> StateNames() const override { return {"Velocity"}; }
+};
+
+class FusedMomentumOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Param", "(LoDTensors) the parameters to update.")
+        .AsDuplicable();
+    AddInput("Grad", "(LoDTensors) the dense gradients of the parameters.")
+        .AsDuplicable();
+    AddInput("Velocity", "(LoDTensors) the velocities of the parameters.")
+        .AsDuplicable();
+    AddInput("LearningRate",
+             "(Tensors) a learning rate shared by the parameters, or one of "
+             "each parameter.")
+        .AsDuplicable();
+    AddOutput("ParamOut",
+              "(LoDTensors) the updated parameters, sharing the memory with "
+              "Input(Param).")
+        .AsDuplicable();
+    AddOutput("VelocityOut",
+              "(LoDTensors) the updated velocities, sharing the memory with "
+              "Input(Velocity).")
+        .AsDuplicable();
+    AddAttr<float>("mu", "(float) Momentum coefficient");
+    AddAttr<bool>("use_nesterov",
+                  "(bool, default false) "
+                  "use nesterov momentum")
+        .SetDefault(false);
+    AddAttr<bool>("use_lars",
+                  "(bool, default false) update as the lars_momentum "
+                  "operator, with the local learning rate of each parameter.")
+        .SetDefault(false);
+    AddAttr<float>("lars_coeff", "(float, default 0.001) LARS coefficient.")
+        .SetDefault(0.001);
+    AddAttr<float>("lars_weight_decay",
+                   "(float, default 0.0005) LARS weight decay")
+        .SetDefault(0.0005);
+    AddComment(R"DOC(
+Fused Momentum operator
+
+It updates all the parameters as the momentum operator does, or as the
+lars_momentum operator does if use_lars is true, in a kernel launch for a pack
+of parameters on the GPU. It is created by the fuse_optimizer_ops_pass.
+)DOC");
+  }
+};
+
+template <typename T>
+class FusedMomentumCPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    T mu = static_cast<T>(ctx.Attr<float>("mu"));
+    bool use_nesterov = ctx.Attr<bool>("use_nesterov");
+    bool use_lars = ctx.Attr<bool>("use_lars");
+    T lars_coeff = static_cast<T>(ctx.Attr<float>("lars_coeff"));
+    T lars_weight_decay = static_cast<T>(ctx.Attr<float>("lars_weight_decay"));
+
+    auto params = ctx.MultiInput<framework::Tensor>("Param");
+    auto grads = ctx.MultiInput<framework::Tensor>("Grad");
+    auto velocities = ctx.MultiInput<framework::Tensor>("Velocity");
+    auto lrs = ctx.MultiInput<framework::Tensor>("LearningRate");
+    auto param_outs = ctx.MultiOutput<framework::Tensor>("ParamOut");
+    auto velocity_outs = ctx.MultiOutput<framework::Tensor>("VelocityOut");
+    for (size_t i = 0; i < params.size(); ++i) {
+      param_outs[i]->mutable_data<T>(ctx.GetPlace());
+      velocity_outs[i]->mutable_data<T>(ctx.GetPlace());
+      if (!use_lars) {
+        CPUDenseMomentumFunctor<T> functor(
+            params[i], grads[i], velocities[i], FusedLearningRate(lrs, i), mu,
+            use_nesterov, param_outs[i], velocity_outs[i]);
+        functor();
+        continue;
+      }
+      auto p_out = framework::EigenVector<T>::Flatten(*param_outs[i]);
+      auto v_out = framework::EigenVector<T>::Flatten(*velocity_outs[i]);
+      auto p = framework::EigenVector<T>::Flatten(*params[i]);
+      auto v = framework::EigenVector<T>::Flatten(*velocities[i]);
+      auto g = framework::EigenVector<T>::Flatten(*grads[i]);
+      T lr = FusedLearningRate(lrs, i)->data<T>()[0];
+      Eigen::Tensor<T, 0, Eigen::RowMajor> p_sq = p.square().sum();
+      Eigen::Tensor<T, 0, Eigen::RowMajor> g_sq = g.square().sum();
+      T p_norm = sqrt(p_sq(0));
+      T g_norm = sqrt(g_sq(0));
+      T local_lr = lr;
+      if (p_norm > 0 && g_norm > 0) {
+        local_lr =
+            lr * lars_coeff * p_norm / (g_norm + lars_weight_decay * p_norm);
+      }
+      v_out = v * mu + local_lr * (g + lars_weight_decay * p);
+      p_out = p - v_out;
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(fused_momentum, ops::FusedMomentumOp,
+                             ops::FusedMomentumOpMaker);
+REGISTER_OP_CPU_KERNEL(fused_momentum, ops::FusedMomentumCPUKernel<float>,
+                       ops::FusedMomentumCPUKernel<double>);
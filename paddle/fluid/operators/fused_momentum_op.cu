@@ -0,0 +1,183 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fused_optimizer_op.h"
+#include "paddle/fluid/operators/math/multi_tensor_apply.h"
+#include "paddle/fluid/operators/momentum_op.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+template <typename T>
+struct SquareSumFunctor {
+  const T* x;
+  T* sum;
+};
+
+// sum += x * x over each tensor of the pack, whose sum should be zero first.
+template <typename T>
+__global__ void MultiTensorSquareSumKernel(
+    const math::MultiTensorPack<SquareSumFunctor<T>> pack) {
+  __shared__ T partial[math::kMultiTensorThreads];
+  int64_t begin, end;
+  const auto& functor = math::MultiTensorChunk(pack, &begin, &end);
+  T sum = 0;
+  for (int64_t i = begin + threadIdx.x; i < end; i += blockDim.x) {
+    sum += functor.x[i] * functor.x[i];
+  }
+  partial[threadIdx.x] = sum;
+  __syncthreads();
+  for (int s = blockDim.x / 2; s > 0; s >>= 1) {
+    if (threadIdx.x < s) {
+      partial[threadIdx.x] += partial[threadIdx.x + s];
+    }
+    __syncthreads();
+  }
+  if (threadIdx.x == 0) {
+    platform::CudaAtomicAdd(functor.sum, partial[0]);
+  }
+}
+
+// The update of lars_momentum, from the square sums of the param and grad.
+template <typename T>
+struct LarsMomentumFunctor {
+  const T* param;
+  const T* grad;
+  const T* velocity;
+  const T* lr;
+  const T* square_sums;
+  T mu;
+  T lars_coeff;
+  T lars_weight_decay;
+  T* param_out;
+  T* velocity_out;
+
+  inline HOSTDEVICE void operator()(int64_t i) const {
+    T p_norm = sqrt(square_sums[0]);
+    T g_norm = sqrt(square_sums[1]);
+    T local_lr = lr[0];
+    if (p_norm > 0 && g_norm > 0) {
+      local_lr = lr[0] * lars_coeff * p_norm /
+                 (g_norm + lars_weight_decay * p_norm);
+    }
+    const T p = param[i];
+    T v = velocity[i] * mu + local_lr * (grad[i] + lars_weight_decay * p);
+    velocity_out[i] = v;
+    param_out[i] = p - v;
+  }
+};
+
+template <typename T>
+class FusedMomentumCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    T mu = static_cast<T>(ctx.Attr<float>("mu"));
+    bool use_nesterov = ctx.Attr<bool>("use_nesterov");
+    auto params = ctx.MultiInput<framework::Tensor>("Param");
+    auto grads = ctx.MultiInput<framework::Tensor>("Grad");
+    auto velocities = ctx.MultiInput<framework::Tensor>("Velocity");
+    auto lrs = ctx.MultiInput<framework::Tensor>("LearningRate");
+    auto param_outs = ctx.MultiOutput<framework::Tensor>("ParamOut");
+    auto velocity_outs = ctx.MultiOutput<framework::Tensor>("VelocityOut");
+
+    std::vector<int64_t> numels(params.size());
+    for (size_t i = 0; i < params.size(); ++i) {
+      numels[i] = params[i]->numel();
+    }
+    if (ctx.Attr<bool>("use_lars")) {
+      ComputeLars(ctx, params, grads, velocities, lrs, param_outs,
+                  velocity_outs, numels);
+    } else if (use_nesterov) {
+      ComputeDense<UseNesterov>(ctx, mu, params, grads, velocities, lrs,
+                                param_outs, velocity_outs, numels);
+    } else {
+      ComputeDense<NoNesterov>(ctx, mu, params, grads, velocities, lrs,
+                               param_outs, velocity_outs, numels);
+    }
+  }
+
+ private:
+  template <typename UpdateMethod>
+  void ComputeDense(const framework::ExecutionContext& ctx, T mu,
+                    const std::vector<const framework::Tensor*>& params,
+                    const std::vector<const framework::Tensor*>& grads,
+                    const std::vector<const framework::Tensor*>& velocities,
+                    const std::vector<const framework::Tensor*>& lrs,
+                    const std::vector<framework::Tensor*>& param_outs,
+                    const std::vector<framework::Tensor*>& velocity_outs,
+                    const std::vector<int64_t>& numels) const {
+    std::vector<DenseMomentumFunctor<T, UpdateMethod>> functors;
+    functors.reserve(params.size());
+    for (size_t i = 0; i < params.size(); ++i) {
+      functors.emplace_back(
+          params[i]->data<T>(), grads[i]->data<T>(), velocities[i]->data<T>(),
+          FusedLearningRate(lrs, i)->data<T>(), mu, numels[i],
+          param_outs[i]->mutable_data<T>(ctx.GetPlace()),
+          velocity_outs[i]->mutable_data<T>(ctx.GetPlace()));
+    }
+    math::MultiTensorApply(ctx.cuda_device_context(), functors, numels);
+  }
+
+  void ComputeLars(const framework::ExecutionContext& ctx,
+                   const std::vector<const framework::Tensor*>& params,
+                   const std::vector<const framework::Tensor*>& grads,
+                   const std::vector<const framework::Tensor*>& velocities,
+                   const std::vector<const framework::Tensor*>& lrs,
+                   const std::vector<framework::Tensor*>& param_outs,
+                   const std::vector<framework::Tensor*>& velocity_outs,
+                   const std::vector<int64_t>& numels) const {
+    auto& dev_ctx = ctx.cuda_device_context();
+    size_t num_params = params.size();
+    // The square sums of the param and the grad of each parameter, reduced
+    // by the blocks of all the parameters together.
+    framework::Tensor square_sums;
+    square_sums.Resize({static_cast<int64_t>(2 * num_params)});
+    T* sums = square_sums.mutable_data<T>(ctx.GetPlace());
+    PADDLE_ENFORCE(cudaMemsetAsync(sums, 0, 2 * num_params * sizeof(T),
+                                   dev_ctx.stream()));
+    std::vector<SquareSumFunctor<T>> sum_functors(2 * num_params);
+    std::vector<int64_t> sum_numels(2 * num_params);
+    for (size_t i = 0; i < num_params; ++i) {
+      sum_functors[2 * i] = {params[i]->data<T>(), sums + 2 * i};
+      sum_functors[2 * i + 1] = {grads[i]->data<T>(), sums + 2 * i + 1};
+      sum_numels[2 * i] = numels[i];
+      sum_numels[2 * i + 1] = numels[i];
+    }
+    math::LaunchMultiTensorKernel(dev_ctx, sum_functors, sum_numels,
+                                  MultiTensorSquareSumKernel<T>);
+
+    std::vector<LarsMomentumFunctor<T>> functors(num_params);
+    for (size_t i = 0; i < num_params; ++i) {
+      functors[i] = {params[i]->data<T>(),
+                     grads[i]->data<T>(),
+                     velocities[i]->data<T>(),
+                     FusedLearningRate(lrs, i)->data<T>(),
+                     sums + 2 * i,
+                     static_cast<T>(ctx.Attr<float>("mu")),
+                     static_cast<T>(ctx.Attr<float>("lars_coeff")),
+                     static_cast<T>(ctx.Attr<float>("lars_weight_decay")),
+                     param_outs[i]->mutable_data<T>(ctx.GetPlace()),
+                     velocity_outs[i]->mutable_data<T>(ctx.GetPlace())};
+    }
+    math::MultiTensorApply(dev_ctx, functors, numels);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(fused_momentum, ops::FusedMomentumCUDAKernel<float>,
+                        ops::FusedMomentumCUDAKernel<double>);
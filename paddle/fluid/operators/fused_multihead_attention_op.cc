@@ -0,0 +1,171 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fused_multihead_attention_op.h"
+#include <algorithm>
+#include <cmath>
+#include "paddle/fluid/operators/math/jit_kernel.h"
+
+namespace paddle {
+namespace operators {
+
+void FusedMultiHeadAttentionOp::InferShape(
+    framework::InferShapeContext* ctx) const {
+  PADDLE_ENFORCE(ctx->HasInput("Q"),
+                 "Input(Q) of FusedMultiHeadAttentionOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasInput("K"),
+                 "Input(K) of FusedMultiHeadAttentionOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasInput("V"),
+                 "Input(V) of FusedMultiHeadAttentionOp should not be null.");
+  PADDLE_ENFORCE(
+      ctx->HasOutput("Out"),
+      "Output(Out) of FusedMultiHeadAttentionOp should not be null.");
+
+  auto q_dims = ctx->GetInputDim("Q");
+  auto k_dims = ctx->GetInputDim("K");
+  auto v_dims = ctx->GetInputDim("V");
+  int rank = q_dims.size();
+  PADDLE_ENFORCE_GE(rank, 2, "Input(Q) should be at least 2-D.");
+  PADDLE_ENFORCE(k_dims.size() == rank && v_dims.size() == rank,
+                 "Input(Q, K, V) should have the same rank.");
+  for (int i = 0; i < rank - 2; ++i) {
+    PADDLE_ENFORCE(q_dims[i] == k_dims[i] && q_dims[i] == v_dims[i],
+                   "Input(Q, K, V) should have the same batch dims.");
+  }
+  PADDLE_ENFORCE_EQ(q_dims[rank - 1], k_dims[rank - 1],
+                    "The last dim of Input(Q) and Input(K) should be equal.");
+  PADDLE_ENFORCE_EQ(k_dims[rank - 2], v_dims[rank - 2],
+                    "The sequence length of Input(K) and Input(V) should be "
+                    "equal.");
+
+  auto out_dims = q_dims;
+  out_dims[rank - 1] = v_dims[rank - 1];
+  ctx->SetOutputDim("Out", out_dims);
+}
+
+framework::OpKernelType FusedMultiHeadAttentionOp::GetExpectedKernelType(
+    const framework::ExecutionContext& ctx) const {
+  return framework::OpKernelType(
+      framework::ToDataType(ctx.Input<Tensor>("Q")->type()),
+      ctx.device_context());
+}
+
+framework::OpKernelType FusedMultiHeadAttentionOp::GetKernelTypeForVar(
+    const std::string& var_name, const Tensor& tensor,
+    const framework::OpKernelType& expected_kernel_type) const {
+  if (var_name == "Step") {
+    return framework::OpKernelType(expected_kernel_type.data_type_,
+                                   tensor.place(), tensor.layout());
+  }
+  return framework::OperatorWithKernel::GetKernelTypeForVar(
+      var_name, tensor, expected_kernel_type);
+}
+
+void FusedMultiHeadAttentionOpMaker::Make() {
+  AddInput("Q",
+           "(Tensor) The queries of all the heads, a tensor with shape "
+           "[..., Sq, D], where the leading dims are the batch and the heads.");
+  AddInput("K", "(Tensor) The keys, a tensor with shape [..., Sk, D].");
+  AddInput("V", "(Tensor) The values, a tensor with shape [..., Sk, Dv].");
+  AddInput("BiasQK",
+           "(Tensor, optional) The bias added to Q * K^T, such as the mask, "
+           "which should have the same size as Q * K^T, [..., Sq, Sk].")
+      .AsDispensable();
+  AddInput("Step",
+           "(Tensor, optional) A tensor of one int or int64. If it is set, K "
+           "and V are the caches of kv_cache_append with shape [..., L, D], "
+           "and Q is of the positions [Step, Step + Sq), which only attend "
+           "to the cached positions before Step + Sq. BiasQK should have the "
+           "shape [..., Sq, Step + Sq] then.")
+      .AsDispensable();
+  AddOutput("Out", "(Tensor) The result with shape [..., Sq, Dv].");
+  AddAttr<float>("alpha", "(float, default 1.0) The scale of Q * K^T.")
+      .SetDefault(1.0f);
+  AddAttr<float>("out_scale",
+                 "(float, default 1.0) The scale of Out, which is the scale "
+                 "of the dropout at inference.")
+      .SetDefault(1.0f);
+  AddComment(R"DOC(
+The fusion of the scaled dot-product attention of all the heads:
+
+$$Out = out\_scale * softmax(alpha * Q * K^T + BiasQK) * V$$
+
+It is the chain matmul -> scale -> elementwise_add -> softmax -> dropout ->
+matmul at inference, but only Q * K^T is written to the memory, and the scale,
+the bias and the softmax are computed in one pass over it.
+
+In the incremental decoding, the keys and values of the previous steps are
+read from the caches with the input Step, so each step only computes the
+attention of its new positions.
+)DOC");
+}
+
+template <typename T>
+struct AttentionSoftmax<platform::CPUDeviceContext, T> {
+  void operator()(const platform::CPUDeviceContext& ctx, const T* bias, T* x,
+                  int rows, int cols) const {
+    for (int i = 0; i < rows; ++i) {
+      T* row = x + i * cols;
+      if (bias) {
+        const T* bias_row = bias + i * cols;
+        for (int j = 0; j < cols; ++j) {
+          row[j] += bias_row[j];
+        }
+      }
+      // clip the shifted logits as softmax_op
+      const T kThreshold = static_cast<T>(-64.);
+      T max = *std::max_element(row, row + cols);
+      T sum = static_cast<T>(0);
+      for (int j = 0; j < cols; ++j) {
+        row[j] = std::exp(std::max(row[j] - max, kThreshold));
+        sum += row[j];
+      }
+      for (int j = 0; j < cols; ++j) {
+        row[j] /= sum;
+      }
+    }
+  }
+};
+
+template <>
+struct AttentionSoftmax<platform::CPUDeviceContext, float> {
+  void operator()(const platform::CPUDeviceContext& ctx, const float* bias,
+                  float* x, int rows, int cols) const {
+    auto& pool = math::jitkernel::KernelPool::Instance();
+    if (bias) {
+      const auto& vadd = pool.Get<math::jitkernel::VAddKernel<float>>(cols);
+      for (int i = 0; i < rows; ++i) {
+        vadd->Compute(x + i * cols, bias + i * cols, x + i * cols);
+      }
+    }
+    const auto& softmax =
+        pool.Get<math::jitkernel::SoftmaxKernel<float>>(cols);
+    softmax->Compute(x, x, rows);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fused_multihead_attention, ops::FusedMultiHeadAttentionOp,
+                  ops::FusedMultiHeadAttentionOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+
+REGISTER_OP_CPU_KERNEL(
+    fused_multihead_attention,
+    ops::FusedMultiHeadAttentionKernel<paddle::platform::CPUDeviceContext,
+                                       float>,
+    ops::FusedMultiHeadAttentionKernel<paddle::platform::CPUDeviceContext,
+                                       double>);
@@ -0,0 +1,94 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <cub/cub.cuh>  // NOLINT
+#include "paddle/fluid/operators/fused_multihead_attention_op.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+template <typename T>
+struct MaxOp {
+  __device__ __forceinline__ T operator()(const T& a, const T& b) const {
+    return a > b ? a : b;
+  }
+};
+
+// One block per row, add the bias, and then the softmax.
+template <typename T, int BlockDim>
+__global__ void KeAttentionSoftmax(const T* bias, T* x, int cols) {
+  using BlockReduce = cub::BlockReduce<T, BlockDim>;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  __shared__ T row_max;
+  __shared__ T row_sum;
+
+  T* row = x + static_cast<int64_t>(blockIdx.x) * cols;
+  const T* bias_row =
+      bias ? bias + static_cast<int64_t>(blockIdx.x) * cols : nullptr;
+
+  T local_max = -INFINITY;
+  for (int j = threadIdx.x; j < cols; j += BlockDim) {
+    T val = bias_row ? row[j] + bias_row[j] : row[j];
+    row[j] = val;
+    local_max = val > local_max ? val : local_max;
+  }
+  T max = BlockReduce(temp_storage).Reduce(local_max, MaxOp<T>());
+  if (threadIdx.x == 0) row_max = max;
+  __syncthreads();
+
+  // clip the shifted logits as softmax_op
+  const T kThreshold = static_cast<T>(-64.);
+  T local_sum = 0;
+  for (int j = threadIdx.x; j < cols; j += BlockDim) {
+    T shifted = row[j] - row_max;
+    T val = exp(shifted < kThreshold ? kThreshold : shifted);
+    row[j] = val;
+    local_sum += val;
+  }
+  T sum = BlockReduce(temp_storage).Sum(local_sum);
+  if (threadIdx.x == 0) row_sum = sum;
+  __syncthreads();
+
+  for (int j = threadIdx.x; j < cols; j += BlockDim) {
+    row[j] /= row_sum;
+  }
+}
+
+template <typename T>
+struct AttentionSoftmax<platform::CUDADeviceContext, T> {
+  void operator()(const platform::CUDADeviceContext& ctx, const T* bias, T* x,
+                  int rows, int cols) const {
+    if (cols > 256) {
+      KeAttentionSoftmax<T, 256><<<rows, 256, 0, ctx.stream()>>>(bias, x,
+                                                                  cols);
+    } else if (cols > 64) {
+      KeAttentionSoftmax<T, 128><<<rows, 128, 0, ctx.stream()>>>(bias, x,
+                                                                  cols);
+    } else {
+      KeAttentionSoftmax<T, 32><<<rows, 32, 0, ctx.stream()>>>(bias, x, cols);
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(
+    fused_multihead_attention,
+    ops::FusedMultiHeadAttentionKernel<paddle::platform::CUDADeviceContext,
+                                       float>,
+    ops::FusedMultiHeadAttentionKernel<paddle::platform::CUDADeviceContext,
+                                       double>);
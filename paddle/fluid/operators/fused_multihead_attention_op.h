@@ -0,0 +1,113 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <string>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/kv_cache_op.h"
+#include "paddle/fluid/operators/math/blas.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+class FusedMultiHeadAttentionOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override;
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override;
+
+  framework::OpKernelType GetKernelTypeForVar(
+      const std::string& var_name, const Tensor& tensor,
+      const framework::OpKernelType& expected_kernel_type) const override;
+};
+
+class FusedMultiHeadAttentionOpMaker
+    : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override;
+};
+
+// x[i] = softmax(x[i] + bias[i]) of every row i, bias may be nullptr.
+template <typename DeviceContext, typename T>
+struct AttentionSoftmax {
+  void operator()(const DeviceContext& ctx, const T* bias, T* x, int rows,
+                  int cols) const;
+};
+
+template <typename DeviceContext, typename T>
+class FusedMultiHeadAttentionKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* q = ctx.Input<Tensor>("Q");
+    auto* k = ctx.Input<Tensor>("K");
+    auto* v = ctx.Input<Tensor>("V");
+    auto* bias = ctx.Input<Tensor>("BiasQK");
+    auto* out = ctx.Output<Tensor>("Out");
+    T alpha = static_cast<T>(ctx.Attr<float>("alpha"));
+    T out_scale = static_cast<T>(ctx.Attr<float>("out_scale"));
+
+    auto q_dims = q->dims();
+    int rank = q_dims.size();
+    int seq_q = static_cast<int>(q_dims[rank - 2]);
+    int size_qk = static_cast<int>(q_dims[rank - 1]);
+    int seq_k = static_cast<int>(k->dims()[rank - 2]);
+    int size_v = static_cast<int>(v->dims()[rank - 1]);
+    // K and V are the caches of the incremental decoding, whose positions
+    // after the new rows of the step are not written yet.
+    int64_t k_stride = static_cast<int64_t>(seq_k) * size_qk;
+    int64_t v_stride = static_cast<int64_t>(seq_k) * size_v;
+    auto* step = ctx.Input<Tensor>("Step");
+    if (step) {
+      int len = static_cast<int>(GetCachePosition(*step)) + seq_q;
+      PADDLE_ENFORCE(len >= seq_q && len <= seq_k,
+                     "The step %d exceeds the cache length %d.", len - seq_q,
+                     seq_k);
+      seq_k = len;
+    }
+    int batch = static_cast<int>(q->numel() / (seq_q * size_qk));
+
+    // The attention weights are the only intermediate written to the memory.
+    Tensor qk;
+    T* qk_data = qk.mutable_data<T>(framework::make_ddim({batch, seq_q, seq_k}),
+                                    ctx.GetPlace());
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
+    blas.BatchedGEMM(CblasNoTrans, CblasTrans, seq_q, seq_k, size_qk, alpha,
+                     q->data<T>(), k->data<T>(), static_cast<T>(0), qk_data,
+                     batch, static_cast<int64_t>(seq_q) * size_qk, k_stride);
+
+    const T* bias_data = nullptr;
+    if (bias) {
+      PADDLE_ENFORCE_EQ(bias->numel(), qk.numel(),
+                        "BiasQK should have the same size as Q * K^T.");
+      bias_data = bias->data<T>();
+    }
+    AttentionSoftmax<DeviceContext, T>()(dev_ctx, bias_data, qk_data,
+                                         batch * seq_q, seq_k);
+
+    blas.BatchedGEMM(CblasNoTrans, CblasNoTrans, seq_q, size_v, seq_k,
+                     out_scale, qk_data, v->data<T>(), static_cast<T>(0),
+                     out->mutable_data<T>(ctx.GetPlace()), batch,
+                     static_cast<int64_t>(seq_q) * seq_k, v_stride);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,98 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace operators {
+
+// The base of the optimizer ops updating a list of parameters at once. Each
+// of their duplicable inputs has a tensor per parameter, except that
+// LearningRate may also be a single tensor shared by all the parameters.
+class FusedOptimizerOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+ protected:
+  // The inputs of the same shapes as Param, whose outputs are X + "Out".
+  virtual std::vector<std::string> StateNames() const = 0;
+
+  // The inputs of a scalar per parameter.
+  virtual std::vector<std::string> ScalarNames() const { return {}; }
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInputs("Param"),
+                   "Input(Param) of %s should not be null.", Type());
+    PADDLE_ENFORCE(ctx->HasInputs("Grad"),
+                   "Input(Grad) of %s should not be null.", Type());
+    PADDLE_ENFORCE(ctx->HasInputs("LearningRate"),
+                   "Input(LearningRate) of %s should not be null.", Type());
+    PADDLE_ENFORCE(ctx->HasOutputs("ParamOut"),
+                   "Output(ParamOut) of %s should not be null.", Type());
+
+    auto param_dims = ctx->GetInputsDim("Param");
+    size_t num_params = param_dims.size();
+    for (auto type : ctx->GetInputsVarType("Grad")) {
+      PADDLE_ENFORCE(type == framework::proto::VarType::LOD_TENSOR,
+                     "%s only supports the dense gradients.", Type());
+    }
+    PADDLE_ENFORCE(ctx->GetInputsDim("Grad") == param_dims,
+                   "Param and Grad of %s should have the same dimensions.",
+                   Type());
+    auto lr_dims = ctx->GetInputsDim("LearningRate");
+    PADDLE_ENFORCE(lr_dims.size() == 1 || lr_dims.size() == num_params,
+                   "LearningRate of %s should be one, or one per Param.",
+                   Type());
+    for (auto& dims : lr_dims) {
+      PADDLE_ENFORCE_EQ(framework::product(dims), 1,
+                        "LearningRate of %s should be scalars.", Type());
+    }
+    for (auto& name : StateNames()) {
+      PADDLE_ENFORCE(ctx->GetInputsDim(name) == param_dims,
+                     "Param and %s of %s should have the same dimensions.",
+                     name, Type());
+      ctx->SetOutputsDim(name + "Out", param_dims);
+    }
+    for (auto& name : ScalarNames()) {
+      auto dims = ctx->GetInputsDim(name);
+      PADDLE_ENFORCE_EQ(dims.size(), num_params,
+                        "%s of %s should be one per Param.", name, Type());
+      for (auto& d : dims) {
+        PADDLE_ENFORCE_EQ(framework::product(d), 1,
+                          "%s of %s should be scalars.", name, Type());
+      }
+    }
+    ctx->SetOutputsDim("ParamOut", param_dims);
+  }
+
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    auto params = ctx.MultiInput<framework::LoDTensor>("Param");
+    PADDLE_ENFORCE(!params.empty(), "%s has no Param.", Type());
+    return framework::OpKernelType(framework::ToDataType(params[0]->type()),
+                                   ctx.GetPlace());
+  }
+};
+
+// The learning rate of the i-th parameter of a fused optimizer.
+inline const framework::Tensor* FusedLearningRate(
+    const std::vector<const framework::Tensor*>& learning_rates, size_t i) {
+  return learning_rates.size() == 1 ? learning_rates[0] : learning_rates[i];
+}
+
+}  // namespace operators
+}  // namespace paddle
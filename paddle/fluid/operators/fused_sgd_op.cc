@@ -0,0 +1,81 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/eigen.h"
+#include "paddle/fluid/operators/fused_optimizer_op.h"
+
+namespace paddle {
+namespace operators {
+
+class FusedSGDOp : public FusedOptimizerOp {
+ public:
+  using FusedOptimizerOp::FusedOptimizerOp;
+
+ protected:
+  std::vector<std::string> StateNames() const override { return {}; }
+};
+
+class FusedSGDOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Param", "(LoDTensors) the parameters to update.")
+        .AsDuplicable();
+    AddInput("Grad", "(LoDTensors) the dense gradients of the parameters.")
+        .AsDuplicable();
+    AddInput("LearningRate",
+             "(Tensors) a learning rate shared by the parameters, or one of "
+             "each parameter.")
+        .AsDuplicable();
+    AddOutput("ParamOut",
+              "(LoDTensors) the updated parameters, sharing the memory with "
+              "Input(Param).")
+        .AsDuplicable();
+    AddComment(R"DOC(
+Fused SGD operator
+
+It updates all the parameters as the sgd operator does, in a kernel launch for
+a pack of parameters on the GPU,
+
+$$param\_out_i = param_i - learning\_rate_i * grad_i$$
+
+It is created by the fuse_optimizer_ops_pass.
+)DOC");
+  }
+};
+
+template <typename T>
+class FusedSGDCPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto params = ctx.MultiInput<framework::Tensor>("Param");
+    auto grads = ctx.MultiInput<framework::Tensor>("Grad");
+    auto lrs = ctx.MultiInput<framework::Tensor>("LearningRate");
+    auto param_outs = ctx.MultiOutput<framework::Tensor>("ParamOut");
+    for (size_t i = 0; i < params.size(); ++i) {
+      param_outs[i]->mutable_data<T>(ctx.GetPlace());
+      auto p = framework::EigenVector<T>::Flatten(*params[i]);
+      auto g = framework::EigenVector<T>::Flatten(*grads[i]);
+      auto o = framework::EigenVector<T>::Flatten(*param_outs[i]);
+      o = p - FusedLearningRate(lrs, i)->data<T>()[0] * g;
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(fused_sgd, ops::FusedSGDOp, ops::FusedSGDOpMaker);
+REGISTER_OP_CPU_KERNEL(fused_sgd, ops::FusedSGDCPUKernel<float>,
+                       ops::FusedSGDCPUKernel<double>);
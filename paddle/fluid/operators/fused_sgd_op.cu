@@ -0,0 +1,58 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fused_optimizer_op.h"
+#include "paddle/fluid/operators/math/multi_tensor_apply.h"
+
+namespace paddle {
+namespace operators {
+
+template <typename T>
+struct SGDFunctor {
+  const T* param;
+  const T* grad;
+  const T* lr;
+  T* param_out;
+
+  inline HOSTDEVICE void operator()(int64_t i) const {
+    param_out[i] = param[i] - lr[0] * grad[i];
+  }
+};
+
+template <typename T>
+class FusedSGDCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto params = ctx.MultiInput<framework::Tensor>("Param");
+    auto grads = ctx.MultiInput<framework::Tensor>("Grad");
+    auto lrs = ctx.MultiInput<framework::Tensor>("LearningRate");
+    auto param_outs = ctx.MultiOutput<framework::Tensor>("ParamOut");
+    std::vector<SGDFunctor<T>> functors(params.size());
+    std::vector<int64_t> numels(params.size());
+    for (size_t i = 0; i < params.size(); ++i) {
+      functors[i] = {params[i]->data<T>(), grads[i]->data<T>(),
+                     FusedLearningRate(lrs, i)->data<T>(),
+                     param_outs[i]->mutable_data<T>(ctx.GetPlace())};
+      numels[i] = params[i]->numel();
+    }
+    math::MultiTensorApply(ctx.cuda_device_context(), functors, numels);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(fused_sgd, ops::FusedSGDCUDAKernel<float>,
+                        ops::FusedSGDCUDAKernel<double>);
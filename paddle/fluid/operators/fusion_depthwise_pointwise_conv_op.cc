@@ -0,0 +1,258 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fusion_depthwise_pointwise_conv_op.h"
+#include <algorithm>
+#include <vector>
+#include "paddle/fluid/operators/conv_op.h"
+#include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/depthwise_conv.h"
+
+namespace paddle {
+namespace operators {
+
+void FusionDepthwisePointwiseConvOp::InferShape(
+    framework::InferShapeContext* ctx) const {
+  PADDLE_ENFORCE(
+      ctx->HasInput("Input"),
+      "Input(Input) of FusionDepthwisePointwiseConvOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasInput("DepthwiseFilter"),
+                 "Input(DepthwiseFilter) of FusionDepthwisePointwiseConvOp "
+                 "should not be null.");
+  PADDLE_ENFORCE(ctx->HasInput("PointwiseFilter"),
+                 "Input(PointwiseFilter) of FusionDepthwisePointwiseConvOp "
+                 "should not be null.");
+  PADDLE_ENFORCE(
+      ctx->HasOutput("Output"),
+      "Output(Output) of FusionDepthwisePointwiseConvOp should not be null.");
+
+  auto in_dims = ctx->GetInputDim("Input");
+  auto dw_dims = ctx->GetInputDim("DepthwiseFilter");
+  auto pw_dims = ctx->GetInputDim("PointwiseFilter");
+  std::vector<int> strides = ctx->Attrs().Get<std::vector<int>>("strides");
+  std::vector<int> paddings = ctx->Attrs().Get<std::vector<int>>("paddings");
+  std::vector<int> dilations = ctx->Attrs().Get<std::vector<int>>("dilations");
+  PADDLE_ENFORCE(in_dims.size() == 4 && dw_dims.size() == 4 &&
+                     pw_dims.size() == 4,
+                 "Input(Input, DepthwiseFilter, PointwiseFilter) should be "
+                 "4-D tensors.");
+  PADDLE_ENFORCE(strides.size() == 2U && paddings.size() == 2U &&
+                     dilations.size() == 2U,
+                 "The strides, paddings and dilations should have 2 values.");
+  PADDLE_ENFORCE_EQ(dw_dims[1], 1,
+                    "Each depthwise filter should have one input channel.");
+  PADDLE_ENFORCE_EQ(dw_dims[0] % in_dims[1], 0,
+                    "The depthwise output channels should be a multiple of "
+                    "the input channels.");
+  PADDLE_ENFORCE(pw_dims[1] == dw_dims[0] && pw_dims[2] == 1 &&
+                     pw_dims[3] == 1,
+                 "Input(PointwiseFilter) should be of the shape "
+                 "[K, DepthwiseFilter.dims[0], 1, 1].");
+  if (ctx->HasInput("DepthwiseBias")) {
+    PADDLE_ENFORCE_EQ(framework::product(ctx->GetInputDim("DepthwiseBias")),
+                      dw_dims[0],
+                      "Input(DepthwiseBias) should have a value per "
+                      "depthwise output channel.");
+  }
+  if (ctx->HasInput("PointwiseBias")) {
+    PADDLE_ENFORCE_EQ(framework::product(ctx->GetInputDim("PointwiseBias")),
+                      pw_dims[0],
+                      "Input(PointwiseBias) should have a value per output "
+                      "channel.");
+  }
+
+  std::vector<int64_t> output_shape({in_dims[0], pw_dims[0]});
+  for (size_t i = 0; i < 2; ++i) {
+    output_shape.push_back(
+        ConvOutputSize(in_dims[i + 2], dw_dims[i + 2], dilations[i],
+                       paddings[i], strides[i]));
+  }
+  ctx->SetOutputDim("Output", framework::make_ddim(output_shape));
+  ctx->ShareLoD("Input", "Output");
+}
+
+framework::OpKernelType FusionDepthwisePointwiseConvOp::GetExpectedKernelType(
+    const framework::ExecutionContext& ctx) const {
+  return framework::OpKernelType(
+      framework::ToDataType(ctx.Input<Tensor>("Input")->type()),
+      ctx.device_context());
+}
+
+void FusionDepthwisePointwiseConvOpMaker::Make() {
+  AddInput("Input",
+           "(Tensor) The input tensor of the shape [N, C, H, W] in the NCHW "
+           "format.");
+  AddInput("DepthwiseFilter",
+           "(Tensor) The filter of the depthwise convolution, of the shape "
+           "[C * M, 1, K_h, K_w], where M is the channel multiplier.");
+  AddInput("DepthwiseBias",
+           "(Tensor) The bias of the depthwise convolution, of the shape "
+           "[C * M]. It is a dispensable input.")
+      .AsDispensable();
+  AddInput("PointwiseFilter",
+           "(Tensor) The filter of the 1x1 convolution, of the shape "
+           "[K, C * M, 1, 1].");
+  AddInput("PointwiseBias",
+           "(Tensor) The bias of the 1x1 convolution, of the shape [K]. It "
+           "is a dispensable input.")
+      .AsDispensable();
+  AddOutput("Output",
+            "(Tensor) The output tensor of the shape [N, K, H_out, W_out].");
+  AddAttr<std::vector<int>>("strides",
+                            "(vector<int> default:{1, 1}), the strides "
+                            "(h_stride, w_stride) of the depthwise "
+                            "convolution.")
+      .SetDefault({1, 1});
+  AddAttr<std::vector<int>>("paddings",
+                            "(vector<int> default:{0, 0}), the paddings "
+                            "(h_pad, w_pad) of the depthwise convolution.")
+      .SetDefault({0, 0});
+  AddAttr<std::vector<int>>("dilations",
+                            "(vector<int> default:{1, 1}), the dilations "
+                            "(h_dilation, w_dilation) of the depthwise "
+                            "convolution.")
+      .SetDefault({1, 1});
+  AddAttr<bool>("fuse_relu",
+                "(bool, default true) Whether to apply relu to the output of "
+                "the depthwise convolution.")
+      .SetDefault(true);
+  AddComment(R"DOC(
+Fusion Depthwise and Pointwise Convolution Operator.
+
+Computes the depthwise separable convolution block of MobileNet,
+
+    Output = conv1x1(relu(depthwise_conv(Input) + DepthwiseBias))
+             + PointwiseBias,
+
+on CPU for inference. The batch norm after the depthwise convolution is
+expected to be folded into DepthwiseFilter and DepthwiseBias. The output
+rows are computed in tiles, whose depthwise results stay in the cache until
+the 1x1 convolution, a GEMM, reads them, instead of going through the memory
+as a whole intermediate tensor.
+)DOC");
+}
+
+// The bytes of the depthwise results of a tile, which should fit in the L2
+// cache together with the 1x1 filter.
+constexpr int64_t kDepthwiseTileBytes = 128 * 1024;
+
+template <typename T>
+class FusionDepthwisePointwiseConvKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    using DeviceContext = paddle::platform::CPUDeviceContext;
+    auto* input = ctx.Input<Tensor>("Input");
+    auto* dw_filter = ctx.Input<Tensor>("DepthwiseFilter");
+    auto* dw_bias = ctx.Input<Tensor>("DepthwiseBias");
+    auto* pw_filter = ctx.Input<Tensor>("PointwiseFilter");
+    auto* pw_bias = ctx.Input<Tensor>("PointwiseBias");
+    auto* output = ctx.Output<Tensor>("Output");
+    std::vector<int> strides = ctx.Attr<std::vector<int>>("strides");
+    std::vector<int> paddings = ctx.Attr<std::vector<int>>("paddings");
+    std::vector<int> dilations = ctx.Attr<std::vector<int>>("dilations");
+    const bool fuse_relu = ctx.Attr<bool>("fuse_relu");
+
+    const int batch_size = static_cast<int>(input->dims()[0]);
+    const int input_channels = static_cast<int>(input->dims()[1]);
+    const int input_height = static_cast<int>(input->dims()[2]);
+    const int input_width = static_cast<int>(input->dims()[3]);
+    const int dw_channels = static_cast<int>(dw_filter->dims()[0]);
+    const int filter_height = static_cast<int>(dw_filter->dims()[2]);
+    const int filter_width = static_cast<int>(dw_filter->dims()[3]);
+    const int output_channels = static_cast<int>(output->dims()[1]);
+    const int output_height = static_cast<int>(output->dims()[2]);
+    const int output_width = static_cast<int>(output->dims()[3]);
+    const int filter_multiplier = dw_channels / input_channels;
+    const int input_size = input_height * input_width;
+    const int output_size = output_height * output_width;
+    const int filter_size = filter_height * filter_width;
+
+    const int64_t row_bytes =
+        static_cast<int64_t>(dw_channels) * output_width * sizeof(T);
+    const int tile_rows = static_cast<int>(std::max<int64_t>(
+        1, std::min<int64_t>(output_height, kDepthwiseTileBytes / row_bytes)));
+    const int num_tiles = (output_height + tile_rows - 1) / tile_rows;
+
+    const T* x_data = input->data<T>();
+    const T* dw_data = dw_filter->data<T>();
+    const T* dw_bias_data = dw_bias ? dw_bias->data<T>() : nullptr;
+    const T* pw_data = pw_filter->data<T>();
+    const T* pw_bias_data = pw_bias ? pw_bias->data<T>() : nullptr;
+    T* y_data = output->mutable_data<T>(ctx.GetPlace());
+
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
+    dev_ctx.ParallelFor(
+        batch_size * num_tiles,
+        [&](int64_t begin, int64_t end) {
+          std::vector<T> buffer(dw_channels * tile_rows * output_width);
+          for (int64_t t = begin; t < end; ++t) {
+            const int i = static_cast<int>(t / num_tiles);
+            const int row_begin = static_cast<int>(t % num_tiles) * tile_rows;
+            const int row_end = std::min(output_height, row_begin + tile_rows);
+            const int tile_size = (row_end - row_begin) * output_width;
+
+            // the depthwise convolution of the tile, [dw_channels, tile_size]
+            for (int c = 0; c < dw_channels; ++c) {
+              T* dw_out = buffer.data() + c * tile_size;
+              std::fill(dw_out, dw_out + tile_size,
+                        dw_bias_data ? dw_bias_data[c] : static_cast<T>(0));
+              math::DepthwiseConvRows(
+                  x_data + (i * input_channels + c / filter_multiplier) *
+                               input_size,
+                  dw_data + c * filter_size, input_height, input_width,
+                  output_width, filter_height, filter_width, strides,
+                  paddings, dilations, row_begin, row_end, dw_out);
+              if (fuse_relu) {
+                for (int j = 0; j < tile_size; ++j) {
+                  dw_out[j] = std::max(dw_out[j], static_cast<T>(0));
+                }
+              }
+            }
+
+            // the 1x1 convolution of the tile into the columns
+            // [row_begin * output_width, row_end * output_width) of the
+            // output of the image
+            T* y = y_data + i * output_channels * output_size +
+                   row_begin * output_width;
+            blas.GEMM(false, false, output_channels, tile_size, dw_channels,
+                      static_cast<T>(1), pw_data, dw_channels, buffer.data(),
+                      tile_size, static_cast<T>(0), y, output_size);
+            if (pw_bias_data) {
+              for (int k = 0; k < output_channels; ++k) {
+                T* y_row = y + k * output_size;
+                for (int j = 0; j < tile_size; ++j) {
+                  y_row[j] += pw_bias_data[k];
+                }
+              }
+            }
+          }
+        },
+        static_cast<int64_t>(dw_channels) * tile_rows * output_width *
+            (filter_size + output_channels));
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fusion_depthwise_pointwise_conv,
+                  ops::FusionDepthwisePointwiseConvOp,
+                  ops::FusionDepthwisePointwiseConvOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+
+REGISTER_OP_CPU_KERNEL(fusion_depthwise_pointwise_conv,
+                       ops::FusionDepthwisePointwiseConvKernel<float>,
+                       ops::FusionDepthwisePointwiseConvKernel<double>);
@@ -0,0 +1,172 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fusion_elementwise_chain_op.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+DECLARE_int32(paddle_num_threads);
+
+namespace paddle {
+namespace operators {
+
+int GetElementwiseChainOpType(const std::string& type) {
+  static const std::unordered_map<std::string, int> types = {
+      {"elementwise_add", kChainAdd}, {"elementwise_sub", kChainSub},
+      {"elementwise_mul", kChainMul}, {"elementwise_div", kChainDiv},
+      {"elementwise_max", kChainMax}, {"elementwise_min", kChainMin},
+      {"relu", kChainRelu},           {"sigmoid", kChainSigmoid},
+      {"tanh", kChainTanh},           {"exp", kChainExp},
+      {"abs", kChainAbs},             {"square", kChainSquare},
+      {"sqrt", kChainSqrt},           {"scale", kChainScale},
+  };
+  auto it = types.find(type);
+  PADDLE_ENFORCE(it != types.end(),
+                 "The functor %s is not supported by the elementwise chain.",
+                 type);
+  return it->second;
+}
+
+void FusionElementwiseChainOp::InferShape(
+    framework::InferShapeContext* ctx) const {
+  PADDLE_ENFORCE(ctx->HasInput("X"),
+                 "Input(X) of FusionElementwiseChainOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                 "Output(Out) of FusionElementwiseChainOp should not be null.");
+  auto functors = ctx->Attrs().Get<std::vector<std::string>>("functor_list");
+  PADDLE_ENFORCE(!functors.empty(), "Attr(functor_list) should not be empty.");
+  size_t num_binary = 0;
+  for (auto& functor : functors) {
+    if (IsBinaryElementwiseChainOp(GetElementwiseChainOpType(functor))) {
+      ++num_binary;
+    }
+  }
+  if (num_binary > 0) {
+    PADDLE_ENFORCE_EQ(ctx->Inputs("Y").size(), num_binary,
+                      "Input(Y) should match the binary functors.");
+    PADDLE_ENFORCE_EQ(ctx->Attrs().Get<std::vector<int>>("axis").size(),
+                      num_binary,
+                      "Attr(axis) should match the binary functors.");
+  }
+
+  ctx->SetOutputDim("Out", ctx->GetInputDim("X"));
+  ctx->ShareLoD("X", "Out");
+}
+
+framework::OpKernelType FusionElementwiseChainOp::GetExpectedKernelType(
+    const framework::ExecutionContext& ctx) const {
+  return framework::OpKernelType(
+      framework::ToDataType(ctx.Input<framework::LoDTensor>("X")->type()),
+      ctx.device_context());
+}
+
+void FusionElementwiseChainOpMaker::Make() {
+  AddInput("X", "(LoDTensor) the head of the chain.");
+  AddInput("Y",
+           "(Tensor) the other inputs of the binary functors, in the order of "
+           "the functors. Each of them is broadcasted to X as the Y of the "
+           "elementwise ops.")
+      .AsDuplicable()
+      .AsDispensable();
+  AddOutput("Out", "(LoDTensor) the output of the chain, the same shape as X.");
+  AddAttr<std::vector<std::string>>(
+      "functor_list",
+      "(vector<string>) the ops of the chain in order, any of elementwise_add, "
+      "elementwise_sub, elementwise_mul, elementwise_div, elementwise_max, "
+      "elementwise_min, relu, sigmoid, tanh, exp, abs, square, sqrt and "
+      "scale.");
+  AddAttr<std::vector<int>>("axis",
+                            "(vector<int>) the axis of each binary functor.")
+      .SetDefault({});
+  AddAttr<std::vector<float>>(
+      "scale", "(vector<float>) the scale of each scale functor.")
+      .SetDefault({});
+  AddAttr<std::vector<float>>(
+      "bias",
+      "(vector<float>) the bias added after the scale of each scale functor.")
+      .SetDefault({});
+  AddComment(R"DOC(
+The fusion of a chain of elementwise and activation ops, where each op takes
+the output of the previous one as its Input(X).
+
+$$x_0 = X, \quad x_{i+1} = f_i(x_i, Y_i), \quad Out = x_{n}$$
+
+The chain is computed element by element, so no intermediate is written back
+to the memory. It is created by the elementwise_chain_fuse_pass for inference.
+)DOC");
+}
+
+template <typename T>
+struct ElementwiseChainFunctor<platform::CPUDeviceContext, T> {
+  void operator()(const platform::CPUDeviceContext& ctx,
+                  const ElementwiseChain<T>& chain, const T* x, int64_t numel,
+                  T* out) const {
+    // Run the steps one by one over a tile in the cache, so that each of the
+    // inner loops could be vectorized.
+    constexpr int64_t kTile = 1024;
+    int64_t num_tiles = (numel + kTile - 1) / kTile;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (FLAGS_paddle_num_threads > 1)
+#endif
+    for (int64_t t = 0; t < num_tiles; ++t) {
+      int64_t begin = t * kTile;
+      int64_t end = std::min(numel, begin + kTile);
+      T* dst = out + begin;
+      if (dst != x + begin) {
+        std::memcpy(dst, x + begin, (end - begin) * sizeof(T));
+      }
+      for (int s = 0; s < chain.num_steps; ++s) {
+        const ElementwiseChainStep& step = chain.steps[s];
+        const T* y = chain.y[s];
+        if (y == nullptr) {
+          for (int64_t i = 0; i < end - begin; ++i) {
+            dst[i] = ApplyElementwiseChainStep<T>(step, dst[i], 0);
+          }
+        } else if (step.post == 1 && step.n >= numel) {
+          for (int64_t i = begin; i < end; ++i) {
+            dst[i - begin] = ApplyElementwiseChainStep<T>(step, dst[i - begin],
+                                                          y[i]);
+          }
+        } else if (step.post == 1) {
+          int64_t j = begin % step.n;
+          for (int64_t i = 0; i < end - begin; ++i) {
+            dst[i] = ApplyElementwiseChainStep<T>(step, dst[i], y[j]);
+            if (++j == step.n) j = 0;
+          }
+        } else {
+          for (int64_t i = begin; i < end; ++i) {
+            dst[i - begin] = ApplyElementwiseChainStep<T>(
+                step, dst[i - begin], y[(i / step.post) % step.n]);
+          }
+        }
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fusion_elementwise_chain, ops::FusionElementwiseChainOp,
+                  ops::FusionElementwiseChainOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+
+REGISTER_OP_CPU_KERNEL(
+    fusion_elementwise_chain,
+    ops::FusionElementwiseChainKernel<paddle::platform::CPUDeviceContext,
+                                      float>,
+    ops::FusionElementwiseChainKernel<paddle::platform::CPUDeviceContext,
+                                      double>);
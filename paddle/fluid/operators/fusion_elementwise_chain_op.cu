@@ -0,0 +1,57 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include "paddle/fluid/operators/fusion_elementwise_chain_op.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+// The chain is a kernel parameter, so each thread reads X and Y once and
+// writes Out once, whatever the length of the chain is.
+template <typename T>
+__global__ void KeElementwiseChain(const ElementwiseChain<T> chain,
+                                   const T* x, int64_t numel, T* out) {
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < numel;
+       i += blockDim.x * gridDim.x) {
+    out[i] = ApplyElementwiseChain<T>(chain, x[i], i);
+  }
+}
+
+template <typename T>
+struct ElementwiseChainFunctor<platform::CUDADeviceContext, T> {
+  void operator()(const platform::CUDADeviceContext& ctx,
+                  const ElementwiseChain<T>& chain, const T* x, int64_t numel,
+                  T* out) const {
+    if (numel == 0) return;
+    const int threads = 512;
+    int max_blocks = std::max(ctx.GetMaxPhysicalThreadCount() / threads, 1);
+    int blocks = static_cast<int>(
+        std::min<int64_t>((numel + threads - 1) / threads, max_blocks));
+    KeElementwiseChain<T><<<blocks, threads, 0, ctx.stream()>>>(chain, x, numel,
+                                                                out);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(
+    fusion_elementwise_chain,
+    ops::FusionElementwiseChainKernel<paddle::platform::CUDADeviceContext,
+                                      float>,
+    ops::FusionElementwiseChainKernel<paddle::platform::CUDADeviceContext,
+                                      double>);
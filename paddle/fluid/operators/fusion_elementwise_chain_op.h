@@ -0,0 +1,208 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <math.h>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/elementwise_op_function.h"
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace operators {
+
+using LoDTensor = framework::LoDTensor;
+using Tensor = framework::Tensor;
+
+class FusionElementwiseChainOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override;
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override;
+};
+
+class FusionElementwiseChainOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override;
+};
+
+// The chain is passed to the CUDA kernel by value, so its length is limited.
+// It should be the same as kMaxChainLength of elementwise_chain_fuse_pass.
+constexpr int kMaxElementwiseChainSteps = 16;
+
+enum ElementwiseChainOpType {
+  kChainAdd,
+  kChainSub,
+  kChainMul,
+  kChainDiv,
+  kChainMax,
+  kChainMin,
+  kChainRelu,
+  kChainSigmoid,
+  kChainTanh,
+  kChainExp,
+  kChainAbs,
+  kChainSquare,
+  kChainSqrt,
+  kChainScale,
+};
+
+// Return the ElementwiseChainOpType of an op in the functor_list.
+int GetElementwiseChainOpType(const std::string& type);
+
+inline bool IsBinaryElementwiseChainOp(int type) { return type <= kChainMin; }
+
+struct ElementwiseChainStep {
+  int type;
+  // Y of a binary step is broadcasted as [pre, n, post] to the shape of x,
+  // see also get_mid_dims.
+  int n;
+  int post;
+  // x * scale + bias of a scale step
+  float scale;
+  float bias;
+};
+
+template <typename T>
+struct ElementwiseChain {
+  int num_steps;
+  ElementwiseChainStep steps[kMaxElementwiseChainSteps];
+  const T* y[kMaxElementwiseChainSteps];
+};
+
+template <typename T>
+HOSTDEVICE inline T ApplyElementwiseChainStep(const ElementwiseChainStep& step,
+                                              T x, T y) {
+  switch (step.type) {
+    case kChainAdd:
+      return x + y;
+    case kChainSub:
+      return x - y;
+    case kChainMul:
+      return x * y;
+    case kChainDiv:
+      return x / y;
+    case kChainMax:
+      return x > y ? x : y;
+    case kChainMin:
+      return x < y ? x : y;
+    case kChainRelu:
+      return x > static_cast<T>(0) ? x : static_cast<T>(0);
+    case kChainSigmoid:
+      return static_cast<T>(1) / (static_cast<T>(1) + exp(-x));
+    case kChainTanh:
+      return tanh(x);
+    case kChainExp:
+      return exp(x);
+    case kChainAbs:
+      return x < static_cast<T>(0) ? -x : x;
+    case kChainSquare:
+      return x * x;
+    case kChainSqrt:
+      return sqrt(x);
+    case kChainScale:
+      return x * static_cast<T>(step.scale) + static_cast<T>(step.bias);
+  }
+  return x;
+}
+
+// Compute the i-th element of the chain, where x is the i-th element of X.
+template <typename T>
+HOSTDEVICE inline T ApplyElementwiseChain(const ElementwiseChain<T>& chain,
+                                          T x, int64_t i) {
+  for (int s = 0; s < chain.num_steps; ++s) {
+    const ElementwiseChainStep& step = chain.steps[s];
+    T y = static_cast<T>(0);
+    if (chain.y[s] != nullptr) {
+      y = chain.y[s][(i / step.post) % step.n];
+    }
+    x = ApplyElementwiseChainStep<T>(step, x, y);
+  }
+  return x;
+}
+
+// out[i] = ApplyElementwiseChain(chain, x[i], i) of the numel elements.
+template <typename DeviceContext, typename T>
+struct ElementwiseChainFunctor {
+  void operator()(const DeviceContext& ctx, const ElementwiseChain<T>& chain,
+                  const T* x, int64_t numel, T* out) const;
+};
+
+template <typename DeviceContext, typename T>
+class FusionElementwiseChainKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<LoDTensor>("X");
+    auto ys = ctx.MultiInput<Tensor>("Y");
+    auto* out = ctx.Output<LoDTensor>("Out");
+    auto functors = ctx.Attr<std::vector<std::string>>("functor_list");
+    auto axis = ctx.Attr<std::vector<int>>("axis");
+    auto scale = ctx.Attr<std::vector<float>>("scale");
+    auto bias = ctx.Attr<std::vector<float>>("bias");
+    PADDLE_ENFORCE_LE(functors.size(),
+                      static_cast<size_t>(kMaxElementwiseChainSteps),
+                      "The chain has too many functors.");
+    PADDLE_ENFORCE_EQ(scale.size(), bias.size(),
+                      "Attr(scale) and Attr(bias) should have the same size.");
+
+    auto x_dims = x->dims();
+    ElementwiseChain<T> chain;
+    chain.num_steps = static_cast<int>(functors.size());
+    size_t num_binary = 0;
+    size_t num_scale = 0;
+    for (int s = 0; s < chain.num_steps; ++s) {
+      auto& step = chain.steps[s];
+      step.type = GetElementwiseChainOpType(functors[s]);
+      step.n = 1;
+      step.post = 1;
+      step.scale = 1.f;
+      step.bias = 0.f;
+      chain.y[s] = nullptr;
+      if (IsBinaryElementwiseChainOp(step.type)) {
+        PADDLE_ENFORCE_LT(num_binary, ys.size(),
+                          "Input(Y) is less than the binary functors.");
+        PADDLE_ENFORCE_LT(num_binary, axis.size(),
+                          "Attr(axis) is less than the binary functors.");
+        auto* y = ys[num_binary];
+        auto y_dims = trim_trailing_singular_dims(y->dims());
+        int y_axis = axis[num_binary] == -1 ? x_dims.size() - y_dims.size()
+                                            : axis[num_binary];
+        int pre;
+        get_mid_dims(x_dims, y_dims, y_axis, &pre, &step.n, &step.post);
+        chain.y[s] = y->data<T>();
+        ++num_binary;
+      } else if (step.type == kChainScale) {
+        PADDLE_ENFORCE_LT(num_scale, scale.size(),
+                          "Attr(scale) is less than the scale functors.");
+        step.scale = scale[num_scale];
+        step.bias = bias[num_scale];
+        ++num_scale;
+      }
+    }
+    PADDLE_ENFORCE_EQ(num_binary, ys.size(),
+                      "Input(Y) should match the binary functors.");
+
+    ElementwiseChainFunctor<DeviceContext, T>()(
+        ctx.template device_context<DeviceContext>(), chain, x->data<T>(),
+        x->numel(), out->mutable_data<T>(ctx.GetPlace()));
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
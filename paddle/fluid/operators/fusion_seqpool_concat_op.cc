@@ -0,0 +1,143 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fusion_seqpool_concat_op.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include "paddle/fluid/operators/math/jit_kernel.h"
+
+namespace paddle {
+namespace operators {
+
+void FusionSeqPoolConcatOp::InferShape(
+    framework::InferShapeContext* ctx) const {
+  PADDLE_ENFORCE_GE(ctx->Inputs("X").size(), 1UL,
+                    "Inputs(X) of FusionSeqPoolConcatOp should not be empty.");
+  PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                 "Output(Out) of FusionSeqPoolConcatOp should not be null.");
+  PADDLE_ENFORCE_EQ(ctx->Attrs().Get<int>("axis"), 1,
+                    "FusionSeqPoolConcatOp only supports concat axis=1.");
+
+  auto ins_dims = ctx->GetInputsDim("X");
+  int64_t width = 0;
+  for (auto& dims : ins_dims) {
+    PADDLE_ENFORCE_EQ(dims.size(), 2, "Inputs(X) should be 2-D tensors.");
+    width += dims[1];
+  }
+  // The number of the sequences is only known from the LoD at runtime.
+  ctx->SetOutputDim("Out", {-1, width});
+}
+
+framework::OpKernelType FusionSeqPoolConcatOp::GetExpectedKernelType(
+    const framework::ExecutionContext& ctx) const {
+  return framework::OpKernelType(
+      framework::ToDataType(ctx.MultiInput<LoDTensor>("X")[0]->type()),
+      ctx.device_context());
+}
+
+void FusionSeqPoolConcatOpMaker::Make() {
+  AddInput("X",
+           "(LoDTensor) The sequences of the slots, each with shape (T_i, M_i) "
+           "and 1-level LoD of the same number of sequences.")
+      .AsDuplicable();
+  AddOutput("Out",
+            "(Tensor) The pooled slots concatenated, a tensor with shape "
+            "(N, M_0 + M_1 + ...), where N is the number of the sequences.");
+  AddAttr<std::string>("pooltype",
+                       "(string, default 'SUM') The pooling type of "
+                       "sequence_pool, 'SUM', 'AVERAGE' or 'SQRT'.")
+      .SetDefault("SUM")
+      .InEnum({"SUM", "AVERAGE", "SQRT"});
+  AddAttr<int>("axis",
+               "(int, default 1) The axis of concat, only 1 is supported.")
+      .SetDefault(1);
+  AddComment(R"DOC(
+Fusion Sequence Pool and Concat Operator.
+
+It is the sequence_pool of every input followed by the concat of the pooled
+results along axis 1, as the embedding slots of the CTR models. Each slot is
+pooled by one SIMD kernel written to its columns of Out, and the slots are
+pooled in parallel.
+)DOC");
+}
+
+template <typename T>
+class FusionSeqPoolConcatKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto ins = ctx.MultiInput<LoDTensor>("X");
+    auto* out = ctx.Output<LoDTensor>("Out");
+    std::string pooltype = ctx.Attr<std::string>("pooltype");
+
+    auto& ref_lod = ins[0]->lod();
+    PADDLE_ENFORCE_EQ(ref_lod.size(), 1UL, "Only support input lod size is 1.");
+    const int bs = static_cast<int>(ref_lod[0].size()) - 1;
+    std::vector<int> offsets(ins.size() + 1, 0);
+    int64_t numel = 0;
+    for (size_t i = 0; i < ins.size(); ++i) {
+      auto& lod = ins[i]->lod();
+      PADDLE_ENFORCE_EQ(lod.size(), 1UL, "Only support input lod size is 1.");
+      PADDLE_ENFORCE_EQ(static_cast<int>(lod[0].size()) - 1, bs,
+                        "Batch size of all inputs should be equal.");
+      PADDLE_ENFORCE_EQ(static_cast<int64_t>(lod[0].back()), ins[i]->dims()[0],
+                        "The LoD of the input %d does not match its height.",
+                        i);
+      offsets[i + 1] = offsets[i] + static_cast<int>(ins[i]->dims()[1]);
+      numel += ins[i]->numel();
+    }
+    const int width = offsets.back();
+    out->Resize({bs, width});
+    T* y = out->mutable_data<T>(ctx.GetPlace());
+
+    auto& pool = math::jitkernel::KernelPool::Instance();
+    std::vector<std::shared_ptr<const math::jitkernel::SequencePoolKernel<T>>>
+        kernels(ins.size());
+    for (size_t i = 0; i < ins.size(); ++i) {
+      kernels[i] =
+          pool.template Get<math::jitkernel::SequencePoolKernel<T>,
+                            const std::string&, int>(
+              pooltype, offsets[i + 1] - offsets[i]);
+    }
+
+    // Each item pools all the sequences of a slot into its columns.
+    auto& dev_ctx = ctx.template device_context<platform::CPUDeviceContext>();
+    dev_ctx.ParallelFor(
+        static_cast<int64_t>(ins.size()),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            auto& lod = ins[i]->lod()[0];
+            const T* x = ins[i]->data<T>();
+            int w = offsets[i + 1] - offsets[i];
+            for (int j = 0; j < bs; ++j) {
+              kernels[i]->Compute(x + lod[j] * w, y + j * width + offsets[i],
+                                  static_cast<int>(lod[j + 1] - lod[j]));
+            }
+          }
+        },
+        numel / static_cast<int64_t>(ins.size()) + 1);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fusion_seqpool_concat, ops::FusionSeqPoolConcatOp,
+                  ops::FusionSeqPoolConcatOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+
+REGISTER_OP_CPU_KERNEL(fusion_seqpool_concat,
+                       ops::FusionSeqPoolConcatKernel<float>,
+                       ops::FusionSeqPoolConcatKernel<double>);
@@ -14,11 +14,13 @@ limitations under the License. */
 
 #pragma once
 #include <memory.h>
+#include <algorithm>
 #include <cstring>
 
 #include "paddle/fluid/framework/ddim.h"
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/place.h"
 
 namespace paddle {
@@ -26,6 +28,46 @@ namespace operators {
 
 using framework::Tensor;
 
+// The rows are prefetched this many indexes before they are copied, at most
+// kGatherPrefetchBytes of each, the hardware prefetcher follows the rest.
+constexpr int64_t kGatherPrefetchDistance = 8;
+constexpr size_t kGatherPrefetchBytes = 256;
+
+inline void PrefetchRow(const void* row, size_t bytes) {
+#if defined(__GNUC__)
+  const char* p = static_cast<const char*>(row);
+  bytes = std::min(bytes, kGatherPrefetchBytes);
+  for (size_t offset = 0; offset < bytes; offset += 64) {
+    __builtin_prefetch(p + offset);
+  }
+#endif
+}
+
+/**
+ * Copy the rows src[index[i]] of slice_size elements to the rows output[i],
+ * in parallel over the index, prefetching the upcoming rows of src, which
+ * are far apart in a large table.
+ */
+template <typename T, typename IndexT>
+void GatherRows(const platform::CPUDeviceContext& ctx, const T* src,
+                const IndexT* index, int64_t index_size, int64_t slice_size,
+                T* output) {
+  const size_t slice_bytes = slice_size * sizeof(T);
+  ctx.ParallelFor(
+      index_size,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          if (i + kGatherPrefetchDistance < end) {
+            PrefetchRow(src + index[i + kGatherPrefetchDistance] * slice_size,
+                        slice_bytes);
+          }
+          memcpy(output + i * slice_size, src + index[i] * slice_size,
+                 slice_bytes);
+        }
+      },
+      slice_size);
+}
+
 /**
  * A thin wrapper for gathering on cpu tensor
  * Return a new tensor from source tensor, gathered according to index
@@ -51,12 +93,8 @@ void CPUGather(const platform::DeviceContext& ctx, const Tensor& src,
   int slice_size = 1;
   for (int i = 1; i < src_dims.size(); ++i) slice_size *= src_dims[i];
 
-  const size_t slice_bytes = slice_size * sizeof(T);
-
-  for (int64_t i = 0; i < index_size; ++i) {
-    int index_ = p_index[i];
-    memcpy(p_output + i * slice_size, p_src + index_ * slice_size, slice_bytes);
-  }
+  GatherRows(static_cast<const platform::CPUDeviceContext&>(ctx), p_src,
+             p_index, index_size, slice_size, p_output);
 }
 
 }  // namespace operators
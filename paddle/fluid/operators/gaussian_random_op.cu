@@ -11,28 +11,39 @@ distributed under the License is distributed on an "AS IS" BASIS,
 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
-#include <thrust/random.h>
-#include <thrust/transform.h>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/platform/for_range.h"
+#include "paddle/fluid/platform/philox.h"
 
 namespace paddle {
 namespace operators {
 
+// A thread fills the 4 elements of a group from a Philox call, see
+// UniformGenerator.
 template <typename T>
 struct GaussianGenerator {
   T mean_, std_;
-  unsigned int seed_;
+  platform::PhiloxSeedOffset seed_offset_;
+  int64_t size_;
+  T* data_;
 
-  __host__ __device__ GaussianGenerator(T mean, T std, int seed)
-      : mean_(mean), std_(std), seed_(seed) {}
+  GaussianGenerator(T mean, T std, platform::PhiloxSeedOffset seed_offset,
+                    int64_t size, T* data)
+      : mean_(mean),
+        std_(std),
+        seed_offset_(seed_offset),
+        size_(size),
+        data_(data) {}
 
-  __host__ __device__ T operator()(const unsigned int n) const {
-    thrust::minstd_rand rng;
-    rng.seed(seed_);
-    thrust::normal_distribution<T> dist(mean_, std_);
-    rng.discard(n);
-    return dist(rng);
+  HOSTDEVICE void operator()(size_t group) const {
+    platform::Philox4x32 rng(seed_offset_.seed, group, seed_offset_.offset);
+    T normal[4];
+    platform::PhiloxNormal(rng(), normal);
+    for (int i = 0; i < 4; ++i) {
+      int64_t idx = static_cast<int64_t>(group) * 4 + i;
+      if (idx < size_) data_[idx] = mean_ + std_ * normal[i];
+    }
   }
 };
 
@@ -42,18 +53,15 @@ class GPUGaussianRandomKernel : public framework::OpKernel<T> {
   void Compute(const framework::ExecutionContext& context) const override {
     auto* tensor = context.Output<framework::Tensor>("Out");
     T* data = tensor->mutable_data<T>(context.GetPlace());
-    unsigned int seed = static_cast<unsigned int>(context.Attr<int>("seed"));
-    if (seed == 0) {
-      std::random_device rd;
-      seed = rd();
-    }
+    int seed = context.Attr<int>("seed");
+    auto seed_offset = platform::GetPhiloxSeedOffset(seed != 0, seed, 1);
     T mean = static_cast<T>(context.Attr<float>("mean"));
     T std = static_cast<T>(context.Attr<float>("std"));
-    thrust::counting_iterator<unsigned int> index_sequence_begin(0);
     int64_t size = tensor->numel();
-    thrust::transform(index_sequence_begin, index_sequence_begin + size,
-                      thrust::device_ptr<T>(data),
-                      GaussianGenerator<T>(mean, std, seed));
+    platform::ForRange<platform::CUDADeviceContext> for_range(
+        context.template device_context<platform::CUDADeviceContext>(),
+        (size + 3) / 4);
+    for_range(GaussianGenerator<T>(mean, std, seed_offset, size, data));
   }
 };
 
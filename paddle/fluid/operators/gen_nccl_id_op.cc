@@ -53,10 +53,16 @@ class GenNCCLIdOp : public framework::OperatorBase {
  private:
   void GenerateAndSend(framework::Scope* scope,
                        const platform::DeviceContext& dev_ctx) const {
-    auto var = scope->FindVar(NCCL_ID_VARNAME);
-    PADDLE_ENFORCE_NOT_NULL(var);
-    auto id = var->GetMutable<ncclUniqueId>();
-    PADDLE_ENFORCE(platform::dynload::ncclGetUniqueId(id));
+    std::vector<std::string> id_names = {NCCL_ID_VARNAME};
+    for (auto& name : Outputs("NCCLIDInter")) {
+      id_names.emplace_back(name);
+    }
+    for (auto& name : id_names) {
+      auto var = scope->FindVar(name);
+      PADDLE_ENFORCE_NOT_NULL(var, "Can not find variable %s.", name);
+      auto id = var->GetMutable<ncclUniqueId>();
+      PADDLE_ENFORCE(platform::dynload::ncclGetUniqueId(id));
+    }
 
     std::vector<std::string> endpoint_list =
         Attr<std::vector<std::string>>("endpoint_list");
@@ -65,7 +71,9 @@ class GenNCCLIdOp : public framework::OperatorBase {
 
     for (auto& ep : endpoint_list) {
       VLOG(3) << "sending nccl id to " << ep;
-      client->AsyncSendVar(ep, dev_ctx, *scope, NCCL_ID_VARNAME);
+      for (auto& name : id_names) {
+        client->AsyncSendVar(ep, dev_ctx, *scope, name);
+      }
     }
     client->Wait();
     for (auto& ep : endpoint_list) {
@@ -112,11 +120,18 @@ class GenNCCLIdOpMaker : public framework::OpProtoAndCheckerMaker {
  public:
   void Make() override {
     AddOutput("NCCLID", "Raw variable contains a NCCL UniqueId instaces.");
+    AddOutput("NCCLIDInter",
+              "Raw variables contain the NCCL UniqueIds of the inter-trainer "
+              "communicators of the hierarchical allreduce, one for each "
+              "local device.")
+        .AsDuplicable()
+        .AsDispensable();
     AddComment(R"DOC(
 GenNCCLId operator
 
 For trainer 0: generate a new UniqueId and send it to all the other trainers.
 For trainer 1~n: start a gRPC server to get the UniqueId, once got, stop the server.
+The UniqueIds of NCCLIDInter, if there are any, are generated and sent in the same way.
 )DOC");
     AddAttr<std::string>("endpoint",
                          "(string), e.g. 127.0.0.1:6175 "
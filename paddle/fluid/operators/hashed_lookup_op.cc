@@ -0,0 +1,176 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/hashed_lookup_op.h"
+#include <memory>
+#include "paddle/fluid/framework/var_type_inference.h"
+
+namespace paddle {
+namespace operators {
+
+class HashedLookupOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("W"),
+                   "Input(W) of HashedLookupOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("Ids"),
+                   "Input(Ids) of HashedLookupOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                   "Output(Out) of HashedLookupOp should not be null.");
+
+    auto table_dims = ctx->GetInputDim("W");
+    auto ids_dims = ctx->GetInputDim("Ids");
+    PADDLE_ENFORCE_EQ(table_dims.size(), 2);
+    PADDLE_ENFORCE_EQ(ids_dims.size(), 2);
+    PADDLE_ENFORCE_EQ(ids_dims[1], 1,
+                      "The last dimension of the 'Ids' tensor must be 1.");
+    PADDLE_ENFORCE_GT(ctx->Attrs().Get<int>("num_hash"), 0);
+
+    auto pooltype = ctx->Attrs().Get<std::string>("pooltype");
+    if (pooltype == "NONE") {
+      ctx->SetOutputDim("Out", {ids_dims[0], table_dims[1]});
+      ctx->ShareLoD("Ids", /*->*/ "Out");
+    } else {
+      // The number of sequences is only known at runtime.
+      ctx->SetOutputDim("Out", {-1, table_dims[1]});
+      if (ctx->IsRuntime()) {
+        auto* ids = boost::get<framework::Variable*>(ctx->GetInputVarPtrs(
+                                                         "Ids")[0])
+                        ->GetMutable<framework::LoDTensor>();
+        PADDLE_ENFORCE_EQ(ids->lod().size(), 1UL,
+                          "The Ids of hashed_lookup must be sequences to "
+                          "pool");
+        ctx->SetOutputDim("Out",
+                          {static_cast<int64_t>(ids->lod()[0].size() - 1),
+                           table_dims[1]});
+      }
+    }
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    auto data_type = framework::GetDataTypeOfVar(ctx.InputVar("W"));
+    return framework::OpKernelType(data_type, ctx.device_context());
+  }
+};
+
+class HashedLookupOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("W",
+             "(Tensor) The embedding table of the hashed ids, which is a "
+             "learnable parameter of shape [rows, width].");
+    AddInput("Ids",
+             "(LoDTensor) The raw int64 ids of shape [N, 1], such as the "
+             "feature hashes, a sequence of ids per instance of the slot.");
+    AddOutput("Out",
+              "(LoDTensor) The pooled embeddings of the sequences, of shape "
+              "[number of sequences, width], or the embeddings of the ids "
+              "with the LoD of Ids if pooltype is NONE.");
+    AddAttr<int>("num_hash",
+                 "(int, default 1) The number of hashes of an id, the "
+                 "embedding of the id is the sum of the rows it hashes to.")
+        .SetDefault(1);
+    AddAttr<std::string>("pooltype",
+                         "(string, default 'SUM') Pool the embeddings of a "
+                         "sequence by SUM, AVERAGE or SQRT, the sum divided "
+                         "by the square root of the length, or NONE.")
+        .SetDefault("SUM")
+        .InEnum({"SUM", "AVERAGE", "SQRT", "NONE"});
+    AddAttr<bool>("is_sparse",
+                  "(boolean, default false) Sparse update.")
+        .SetDefault(false);
+    AddComment(R"DOC(
+Hashed Lookup Operator.
+
+Look up the embeddings of the raw ids without a vocabulary, the k-th hash of
+an id is the row XXH64(id, seed = k) % rows of W, and the embedding of the id
+sums its num_hash rows. The embeddings of each sequence of Ids are pooled in
+the same kernel, which fuses the hash, lookup_table and sequence_pool ops of
+a slot.
+
+The collisions of the ids are spread over num_hash rows, so that two ids
+only share their embedding if all their hashes collide.
+
+)DOC");
+  }
+};
+
+class HashedLookupGradOpDescMaker
+    : public framework::SingleGradOpDescMaker {
+ public:
+  using framework::SingleGradOpDescMaker::SingleGradOpDescMaker;
+
+ protected:
+  std::unique_ptr<framework::OpDesc> Apply() const override {
+    auto* op = new framework::OpDesc();
+    op->SetType("hashed_lookup_grad");
+    op->SetInput("W", Input("W"));
+    op->SetInput("Ids", Input("Ids"));
+    op->SetInput(framework::GradVarName("Out"), OutputGrad("Out"));
+    op->SetOutput(framework::GradVarName("W"), InputGrad("W"));
+    op->SetAttrMap(Attrs());
+    return std::unique_ptr<framework::OpDesc>(op);
+  }
+};
+
+class HashedLookupOpGrad : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    ctx->SetOutputDim(framework::GradVarName("W"), ctx->GetInputDim("W"));
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    auto data_type = framework::GetDataTypeOfVar(
+        ctx.InputVar(framework::GradVarName("Out")));
+    return framework::OpKernelType(data_type, ctx.device_context());
+  }
+};
+
+class HashedLookupOpGradVarTypeInference
+    : public framework::VarTypeInference {
+ public:
+  void operator()(const framework::OpDesc& op_desc,
+                  framework::BlockDesc* block) const override {
+    auto out_var_name = op_desc.Output(framework::GradVarName("W")).front();
+    bool is_sparse = boost::get<bool>(op_desc.GetAttr("is_sparse"));
+    block->Var(out_var_name)
+        ->SetType(is_sparse ? framework::proto::VarType::SELECTED_ROWS
+                            : framework::proto::VarType::LOD_TENSOR);
+    block->Var(out_var_name)
+        ->SetDataType(block->Var(op_desc.Input("W")[0])->GetDataType());
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(hashed_lookup, ops::HashedLookupOp,
+                  ops::HashedLookupGradOpDescMaker, ops::HashedLookupOpMaker);
+REGISTER_OPERATOR(hashed_lookup_grad, ops::HashedLookupOpGrad,
+                  ops::HashedLookupOpGradVarTypeInference);
+
+REGISTER_OP_CPU_KERNEL(hashed_lookup, ops::HashedLookupKernel<float>,
+                       ops::HashedLookupKernel<double>);
+REGISTER_OP_CPU_KERNEL(hashed_lookup_grad,
+                       ops::HashedLookupGradKernel<float>,
+                       ops::HashedLookupGradKernel<double>);
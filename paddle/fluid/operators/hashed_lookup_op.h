@@ -0,0 +1,174 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+extern "C" {
+#include <xxhash.h>
+}
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/operators/lookup_table_op.h"
+
+namespace paddle {
+namespace operators {
+
+// The row of the table of rows rows the id hashes to with the seed.
+inline int64_t HashedRow(int64_t id, int seed, int64_t rows) {
+  return static_cast<int64_t>(XXH64(&id, sizeof(id), seed) %
+                              static_cast<uint64_t>(rows));
+}
+
+// The offsets of the pooled sequences of the ids, a sequence per id if the
+// ids are not pooled.
+inline std::vector<size_t> PoolOffsets(const LoDTensor &ids, bool pooled) {
+  if (!pooled) {
+    std::vector<size_t> offsets(ids.numel() + 1);
+    for (size_t i = 0; i < offsets.size(); ++i) offsets[i] = i;
+    return offsets;
+  }
+  PADDLE_ENFORCE_EQ(ids.lod().size(), 1UL,
+                    "The Ids of hashed_lookup must be sequences to pool");
+  PADDLE_ENFORCE_EQ(ids.lod()[0].back(), static_cast<size_t>(ids.numel()));
+  return std::vector<size_t>(ids.lod()[0].begin(), ids.lod()[0].end());
+}
+
+// The factor of the sum of a sequence of the length for the pooltype.
+template <typename T>
+T PoolScale(const std::string &pooltype, size_t length) {
+  if (length == 0 || pooltype == "SUM" || pooltype == "NONE") {
+    return static_cast<T>(1);
+  }
+  if (pooltype == "AVERAGE") return static_cast<T>(1. / length);
+  return static_cast<T>(1. / std::sqrt(static_cast<double>(length)));
+}
+
+template <typename T>
+class HashedLookupKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *table_t = context.Input<LoDTensor>("W");
+    auto *ids_t = context.Input<LoDTensor>("Ids");
+    auto *output_t = context.Output<LoDTensor>("Out");
+    int num_hash = context.Attr<int>("num_hash");
+    auto pooltype = context.Attr<std::string>("pooltype");
+
+    int64_t rows = table_t->dims()[0];
+    int64_t row_width = table_t->dims()[1];
+    const auto *table = table_t->data<T>();
+    const auto *ids = ids_t->data<int64_t>();
+    auto offsets = PoolOffsets(*ids_t, pooltype != "NONE");
+    auto *output = output_t->mutable_data<T>(context.GetPlace());
+
+    auto &dev_ctx =
+        context.template device_context<platform::CPUDeviceContext>();
+    const int64_t num_seqs = offsets.size() - 1;
+    dev_ctx.ParallelFor(
+        num_seqs,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t s = begin; s < end; ++s) {
+            T *dst = output + s * row_width;
+            std::fill(dst, dst + row_width, static_cast<T>(0));
+            for (size_t i = offsets[s]; i < offsets[s + 1]; ++i) {
+              for (int k = 0; k < num_hash; ++k) {
+                const T *src = table + HashedRow(ids[i], k, rows) * row_width;
+                for (int64_t j = 0; j < row_width; ++j) {
+                  dst[j] += src[j];
+                }
+              }
+            }
+            T scale = PoolScale<T>(pooltype, offsets[s + 1] - offsets[s]);
+            if (scale != static_cast<T>(1)) {
+              for (int64_t j = 0; j < row_width; ++j) {
+                dst[j] *= scale;
+              }
+            }
+          }
+        },
+        num_hash * row_width * ids_t->numel() / std::max<int64_t>(num_seqs, 1));
+  }
+};
+
+template <typename T>
+class HashedLookupGradKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *table_t = context.Input<LoDTensor>("W");
+    auto *ids_t = context.Input<LoDTensor>("Ids");
+    auto *d_output_t = context.Input<LoDTensor>(framework::GradVarName("Out"));
+    int num_hash = context.Attr<int>("num_hash");
+    auto pooltype = context.Attr<std::string>("pooltype");
+
+    int64_t rows = table_t->dims()[0];
+    int64_t row_width = table_t->dims()[1];
+    const auto *ids = ids_t->data<int64_t>();
+    const auto *d_output = d_output_t->data<T>();
+    auto offsets = PoolOffsets(*ids_t, pooltype != "NONE");
+    auto &dev_ctx =
+        context.template device_context<platform::CPUDeviceContext>();
+
+    if (context.Attr<bool>("is_sparse")) {
+      // A row of gradient per hash of each id, merged by the rows.
+      const int64_t num_rows = ids_t->numel() * num_hash;
+      std::vector<int64_t> hashed(num_rows);
+      Tensor expanded;
+      T *expanded_data = expanded.mutable_data<T>(
+          framework::make_ddim({num_rows, row_width}), context.GetPlace());
+      for (size_t s = 0; s + 1 < offsets.size(); ++s) {
+        T scale = PoolScale<T>(pooltype, offsets[s + 1] - offsets[s]);
+        const T *src = d_output + s * row_width;
+        for (size_t i = offsets[s]; i < offsets[s + 1]; ++i) {
+          for (int k = 0; k < num_hash; ++k) {
+            int64_t r = i * num_hash + k;
+            hashed[r] = HashedRow(ids[i], k, rows);
+            T *dst = expanded_data + r * row_width;
+            for (int64_t j = 0; j < row_width; ++j) {
+              dst[j] = src[j] * scale;
+            }
+          }
+        }
+      }
+      auto *d_table =
+          context.Output<SelectedRows>(framework::GradVarName("W"));
+      d_table->set_height(rows);
+      MergeRowsGrad(dev_ctx, hashed.data(), num_rows, row_width,
+                    expanded_data, d_table);
+    } else {
+      auto *d_table_t = context.Output<LoDTensor>(framework::GradVarName("W"));
+      T *d_table = d_table_t->mutable_data<T>(context.GetPlace());
+      std::fill(d_table, d_table + d_table_t->numel(), static_cast<T>(0));
+      for (size_t s = 0; s + 1 < offsets.size(); ++s) {
+        T scale = PoolScale<T>(pooltype, offsets[s + 1] - offsets[s]);
+        const T *src = d_output + s * row_width;
+        for (size_t i = offsets[s]; i < offsets[s + 1]; ++i) {
+          for (int k = 0; k < num_hash; ++k) {
+            T *dst = d_table + HashedRow(ids[i], k, rows) * row_width;
+            for (int64_t j = 0; j < row_width; ++j) {
+              dst[j] += src[j] * scale;
+            }
+          }
+        }
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -108,6 +108,11 @@ class HierarchicalSigmoidOpMaker : public framework::OpProtoAndCheckerMaker {
         .AsIntermediate();
     AddAttr<AttrType>("num_classes", "(int, required), The number of classes")
         .SetDefault(2);
+    AddAttr<bool>("is_sparse",
+                  "(boolean, default false) "
+                  "Sparse update. If true, the gradient of W is a "
+                  "SelectedRows of the rows on the paths of the labels.")
+        .SetDefault(false);
     AddComment(R"DOC(
 The hierarchical sigmoid operator organize the classes into a binary tree.
 At each node, a sigmoid function is used to calculate the probability of
@@ -146,6 +151,30 @@ class HierarchicalSigmoidGradOp : public framework::OperatorWithKernel {
   }
 };
 
+class HierarchicalSigmoidGradOpVarTypeInference
+    : public framework::VarTypeInference {
+ public:
+  void operator()(const framework::OpDesc& op_desc,
+                  framework::BlockDesc* block) const override {
+    auto w_grad = op_desc.Output(framework::GradVarName("W"));
+    if (w_grad.empty()) return;
+    auto& w_grad_name = w_grad.front();
+    bool is_sparse = boost::get<bool>(op_desc.GetAttr("is_sparse"));
+    if (is_sparse) {
+      VLOG(3) << "hierarchical_sigmoid_grad op " << framework::GradVarName("W")
+              << " is set to SelectedRows";
+      block->Var(w_grad_name)
+          ->SetType(framework::proto::VarType::SELECTED_ROWS);
+    } else {
+      VLOG(3) << "hierarchical_sigmoid_grad op " << framework::GradVarName("W")
+              << " is set to LoDTensor";
+      block->Var(w_grad_name)->SetType(framework::proto::VarType::LOD_TENSOR);
+    }
+    block->Var(w_grad_name)
+        ->SetDataType(block->Var(op_desc.Input("W").front())->GetDataType());
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -153,7 +182,8 @@ namespace ops = paddle::operators;
 REGISTER_OPERATOR(hierarchical_sigmoid, ops::HierarchicalSigmoidOp,
                   ops::HierarchicalSigmoidOpMaker<int>,
                   paddle::framework::DefaultGradOpDescMaker<true>);
-REGISTER_OPERATOR(hierarchical_sigmoid_grad, ops::HierarchicalSigmoidGradOp);
+REGISTER_OPERATOR(hierarchical_sigmoid_grad, ops::HierarchicalSigmoidGradOp,
+                  ops::HierarchicalSigmoidGradOpVarTypeInference);
 REGISTER_OP_CPU_KERNEL(
     hierarchical_sigmoid,
     ops::HierarchicalSigmoidOpKernel<paddle::platform::CPUDeviceContext, float>,
@@ -0,0 +1,289 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include "paddle/fluid/operators/hierarchical_sigmoid_op.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+namespace {
+
+#define CUDA_1D_KERNEL_LOOP(i, n)                              \
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < (n); \
+       i += blockDim.x * gridDim.x)
+
+int const kNumCUDAThreads = 512;
+int const kNumMaxinumBlocks = 4096;
+
+static inline int NumBlocks(const int n) {
+  return std::min((n + kNumCUDAThreads - 1) / kNumCUDAThreads,
+                  kNumMaxinumBlocks);
+}
+
+// pre_out(i, j) = clip(bias(index(i, j)) + w.row(index(i, j)) * x.row(i)) on
+// the path of the i-th label, and 0 out of the path.
+template <typename T>
+__global__ void PreOutKernel(const int64_t *ids, const T *x, const T *w,
+                             const T *bias, const size_t num_classes,
+                             const int batch_size, const int code_length,
+                             const int dim, T *pre_out) {
+  CUDA_1D_KERNEL_LOOP(idx, batch_size * code_length) {
+    const int i = idx / code_length;
+    const int j = idx % code_length;
+    math::SimpleCode code(static_cast<size_t>(ids[i]), num_classes);
+    T value = static_cast<T>(0.0);
+    if (j < code.get_length()) {
+      const size_t index = code.calc_index(j);
+      if (bias) value = bias[index];
+      const T *w_row = w + index * dim;
+      const T *x_row = x + i * dim;
+      for (int k = 0; k < dim; ++k) {
+        value += w_row[k] * x_row[k];
+      }
+    }
+    // clip to [-40, 40] as the CPU kernel does
+    value = value < static_cast<T>(-40.0) ? static_cast<T>(-40.0) : value;
+    pre_out[idx] = value > static_cast<T>(40.0) ? static_cast<T>(40.0) : value;
+  }
+}
+
+// out(i) = \sum_j softrelu(pre_out(i, j)) - \sum_j bit(i, j) * pre_out(i, j),
+// and pre_out is replaced with its softrelu for the backward.
+template <typename T>
+__global__ void OutKernel(const int64_t *ids, const size_t num_classes,
+                          const int batch_size, const int code_length,
+                          T *pre_out, T *out) {
+  CUDA_1D_KERNEL_LOOP(i, batch_size) {
+    math::SimpleCode code(static_cast<size_t>(ids[i]), num_classes);
+    const int length = code.get_length();
+    T *pre_out_row = pre_out + i * code_length;
+    T sum = static_cast<T>(0.0);
+    for (int j = 0; j < code_length; ++j) {
+      if (j < length && code.calc_bit(j)) sum -= pre_out_row[j];
+      pre_out_row[j] = log(static_cast<T>(1.0) + exp(pre_out_row[j]));
+      sum += pre_out_row[j];
+    }
+    out[i] = sum;
+  }
+}
+
+// pre_out_grad(i, j) = (sigmoid(pre_out(i, j)) - bit(i, j)) * out_grad(i),
+// given the softrelu pre_out of the forward.
+template <typename T>
+__global__ void PreOutGradKernel(const int64_t *ids, const T *pre_out,
+                                 const T *out_grad, const size_t num_classes,
+                                 const int batch_size, const int code_length,
+                                 T *pre_out_grad) {
+  CUDA_1D_KERNEL_LOOP(idx, batch_size * code_length) {
+    const int i = idx / code_length;
+    const int j = idx % code_length;
+    math::SimpleCode code(static_cast<size_t>(ids[i]), num_classes);
+    T grad = static_cast<T>(1.0) - static_cast<T>(1.0) / exp(pre_out[idx]);
+    if (j < code.get_length() && code.calc_bit(j)) grad -= 1;
+    pre_out_grad[idx] = grad * out_grad[i];
+  }
+}
+
+template <typename T>
+__global__ void BiasGradKernel(const int64_t *ids, const T *pre_out_grad,
+                               const size_t num_classes, const int batch_size,
+                               const int code_length, T *bias_grad) {
+  CUDA_1D_KERNEL_LOOP(idx, batch_size * code_length) {
+    const int i = idx / code_length;
+    const int j = idx % code_length;
+    math::SimpleCode code(static_cast<size_t>(ids[i]), num_classes);
+    if (j < code.get_length()) {
+      platform::CudaAtomicAdd(bias_grad + code.calc_index(j),
+                              pre_out_grad[idx]);
+    }
+  }
+}
+
+template <typename T>
+__global__ void WeightGradKernel(const int64_t *ids, const T *pre_out_grad,
+                                 const T *x, const size_t num_classes,
+                                 const int batch_size, const int code_length,
+                                 const int dim, T *w_grad) {
+  CUDA_1D_KERNEL_LOOP(idx, batch_size * code_length * dim) {
+    const int k = idx % dim;
+    const int ij = idx / dim;
+    const int i = ij / code_length;
+    const int j = ij % code_length;
+    math::SimpleCode code(static_cast<size_t>(ids[i]), num_classes);
+    if (j < code.get_length()) {
+      platform::CudaAtomicAdd(w_grad + code.calc_index(j) * dim + k,
+                              pre_out_grad[ij] * x[i * dim + k]);
+    }
+  }
+}
+
+// The layout of the sparse gradient is that of
+// MatrixBitCodeFunctor::MulGradWeight, one row per (sample, bit).
+template <typename T>
+__global__ void SparseWeightGradKernel(const int64_t *ids,
+                                       const T *pre_out_grad, const T *x,
+                                       const size_t num_classes,
+                                       const int batch_size,
+                                       const int code_length, const int dim,
+                                       int64_t *rows, T *w_grad) {
+  CUDA_1D_KERNEL_LOOP(idx, batch_size * code_length * dim) {
+    const int k = idx % dim;
+    const int ij = idx / dim;
+    const int i = ij / code_length;
+    const int j = ij % code_length;
+    math::SimpleCode code(static_cast<size_t>(ids[i]), num_classes);
+    const bool on_path = j < code.get_length();
+    if (k == 0) {
+      rows[ij] = on_path ? static_cast<int64_t>(code.calc_index(j)) : 0;
+    }
+    w_grad[idx] = on_path ? pre_out_grad[ij] * x[i * dim + k] : 0;
+  }
+}
+
+template <typename T>
+__global__ void InputGradKernel(const int64_t *ids, const T *pre_out_grad,
+                                const T *w, const size_t num_classes,
+                                const int batch_size, const int code_length,
+                                const int dim, T *x_grad) {
+  CUDA_1D_KERNEL_LOOP(idx, batch_size * dim) {
+    const int i = idx / dim;
+    const int k = idx % dim;
+    math::SimpleCode code(static_cast<size_t>(ids[i]), num_classes);
+    const int length = code.get_length();
+    T sum = static_cast<T>(0.0);
+    for (int j = 0; j < length; ++j) {
+      sum +=
+          pre_out_grad[i * code_length + j] * w[code.calc_index(j) * dim + k];
+    }
+    x_grad[idx] = sum;
+  }
+}
+
+}  // namespace
+
+template <typename T>
+class HierarchicalSigmoidCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &ctx) const override {
+    auto *in = ctx.Input<framework::Tensor>("X");
+    auto *w = ctx.Input<framework::Tensor>("W");
+    auto *label = ctx.Input<framework::Tensor>("Label");
+    auto *bias = ctx.Input<framework::Tensor>("Bias");
+    auto *out = ctx.Output<framework::Tensor>("Out");
+    auto *pre_out = ctx.Output<framework::Tensor>("PreOut");
+    size_t num_classes = static_cast<size_t>(ctx.Attr<int>("num_classes"));
+    int code_length = static_cast<int>(math::FindLastSet(num_classes - 1));
+    int batch_size = static_cast<int>(in->dims()[0]);
+    int dim = static_cast<int>(in->dims()[1]);
+    auto stream =
+        ctx.template device_context<platform::CUDADeviceContext>().stream();
+
+    auto *pre_out_data = pre_out->mutable_data<T>(
+        framework::make_ddim({static_cast<int64_t>(batch_size),
+                              static_cast<int64_t>(code_length)}),
+        ctx.GetPlace());
+    auto *out_data = out->mutable_data<T>(ctx.GetPlace());
+    const int64_t *ids = label->data<int64_t>();
+
+    int num = batch_size * code_length;
+    PreOutKernel<T><<<NumBlocks(num), kNumCUDAThreads, 0, stream>>>(
+        ids, in->data<T>(), w->data<T>(), bias ? bias->data<T>() : nullptr,
+        num_classes, batch_size, code_length, dim, pre_out_data);
+    OutKernel<T><<<NumBlocks(batch_size), kNumCUDAThreads, 0, stream>>>(
+        ids, num_classes, batch_size, code_length, pre_out_data, out_data);
+  }
+};
+
+template <typename T>
+class HierarchicalSigmoidGradCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &ctx) const override {
+    auto *in = ctx.Input<framework::Tensor>("X");
+    auto *w = ctx.Input<framework::Tensor>("W");
+    auto *in_grad = ctx.Output<framework::Tensor>(framework::GradVarName("X"));
+    auto *bias_grad =
+        ctx.Output<framework::Tensor>(framework::GradVarName("Bias"));
+    auto *label = ctx.Input<framework::Tensor>("Label");
+    auto *pre_out = ctx.Input<framework::Tensor>("PreOut");
+    auto *out_grad =
+        ctx.Input<framework::Tensor>(framework::GradVarName("Out"));
+    size_t num_classes = static_cast<size_t>(ctx.Attr<int>("num_classes"));
+    int batch_size = static_cast<int>(pre_out->dims()[0]);
+    int code_length = static_cast<int>(pre_out->dims()[1]);
+    int dim = static_cast<int>(in->dims()[1]);
+    auto &dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
+    auto stream = dev_ctx.stream();
+    const int64_t *ids = label->data<int64_t>();
+    math::SetConstant<platform::CUDADeviceContext, T> zero;
+
+    framework::Tensor pre_out_grad;
+    auto *pre_out_grad_data =
+        pre_out_grad.mutable_data<T>(pre_out->dims(), ctx.GetPlace());
+    int num = batch_size * code_length;
+    PreOutGradKernel<T><<<NumBlocks(num), kNumCUDAThreads, 0, stream>>>(
+        ids, pre_out->data<T>(), out_grad->data<T>(), num_classes, batch_size,
+        code_length, pre_out_grad_data);
+
+    if (bias_grad) {
+      bias_grad->mutable_data<T>(ctx.GetPlace());
+      zero(dev_ctx, bias_grad, static_cast<T>(0.0));
+      BiasGradKernel<T><<<NumBlocks(num), kNumCUDAThreads, 0, stream>>>(
+          ids, pre_out_grad_data, num_classes, batch_size, code_length,
+          bias_grad->data<T>());
+    }
+
+    int w_num = num * dim;
+    if (ctx.Attr<bool>("is_sparse")) {
+      auto *w_grad =
+          ctx.Output<framework::SelectedRows>(framework::GradVarName("W"));
+      framework::Vector<int64_t> rows(num);
+      auto *w_grad_data = w_grad->mutable_value()->mutable_data<T>(
+          framework::make_ddim(
+              {static_cast<int64_t>(num), static_cast<int64_t>(dim)}),
+          ctx.GetPlace());
+      SparseWeightGradKernel<T><<<NumBlocks(w_num), kNumCUDAThreads, 0,
+                                  stream>>>(
+          ids, pre_out_grad_data, in->data<T>(), num_classes, batch_size,
+          code_length, dim, rows.CUDAMutableData(ctx.GetPlace()),
+          w_grad_data);
+      w_grad->set_rows(rows);
+      w_grad->set_height(w->dims()[0]);
+    } else {
+      auto *w_grad = ctx.Output<framework::Tensor>(framework::GradVarName("W"));
+      w_grad->mutable_data<T>(ctx.GetPlace());
+      zero(dev_ctx, w_grad, static_cast<T>(0.0));
+      WeightGradKernel<T><<<NumBlocks(w_num), kNumCUDAThreads, 0, stream>>>(
+          ids, pre_out_grad_data, in->data<T>(), num_classes, batch_size,
+          code_length, dim, w_grad->data<T>());
+    }
+
+    int x_num = batch_size * dim;
+    InputGradKernel<T><<<NumBlocks(x_num), kNumCUDAThreads, 0, stream>>>(
+        ids, pre_out_grad_data, w->data<T>(), num_classes, batch_size,
+        code_length, dim, in_grad->mutable_data<T>(ctx.GetPlace()));
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(hierarchical_sigmoid,
+                        ops::HierarchicalSigmoidCUDAKernel<float>,
+                        ops::HierarchicalSigmoidCUDAKernel<double>);
+REGISTER_OP_CUDA_KERNEL(hierarchical_sigmoid_grad,
+                        ops::HierarchicalSigmoidGradCUDAKernel<float>,
+                        ops::HierarchicalSigmoidGradCUDAKernel<double>);
@@ -87,7 +87,6 @@ class HierarchicalSigmoidGradOpKernel : public framework::OpKernel<T> {
     auto* in = ctx.Input<framework::Tensor>("X");
     auto* w = ctx.Input<framework::Tensor>("W");
     auto* in_grad = ctx.Output<framework::Tensor>(framework::GradVarName("X"));
-    auto* w_grad = ctx.Output<framework::Tensor>(framework::GradVarName("W"));
     auto* bias_grad =
         ctx.Output<framework::Tensor>(framework::GradVarName("Bias"));
     auto* label = ctx.Input<framework::Tensor>("Label");
@@ -98,11 +97,9 @@ class HierarchicalSigmoidGradOpKernel : public framework::OpKernel<T> {
 
     pre_out_grad.mutable_data<T>(pre_out->dims(), ctx.GetPlace());
     in_grad->mutable_data<T>(ctx.GetPlace());
-    w_grad->mutable_data<T>(ctx.GetPlace());
     auto& dev_ctx = ctx.template device_context<DeviceContext>();
     math::SetConstant<DeviceContext, T> zero;
     zero(dev_ctx, in_grad, static_cast<T>(0.0));
-    zero(dev_ctx, w_grad, static_cast<T>(0.0));
 
     size_t num_classes = static_cast<size_t>(ctx.Attr<int>("num_classes"));
     math::MatrixBitCodeFunctor<T> bit_code(num_classes, label->data<int64_t>());
@@ -126,7 +123,18 @@ class HierarchicalSigmoidGradOpKernel : public framework::OpKernel<T> {
       zero(dev_ctx, bias_grad, static_cast<T>(0.0));
       bit_code.AddGrad(pre_out_grad, bias_grad);
     }
-    bit_code.MulGradWeight(pre_out_grad, w_grad, *in);
+    if (ctx.Attr<bool>("is_sparse")) {
+      auto* w_grad =
+          ctx.Output<framework::SelectedRows>(framework::GradVarName("W"));
+      w_grad->set_height(w->dims()[0]);
+      bit_code.MulGradWeight(pre_out_grad, w_grad, *in);
+    } else {
+      auto* w_grad =
+          ctx.Output<framework::Tensor>(framework::GradVarName("W"));
+      w_grad->mutable_data<T>(ctx.GetPlace());
+      zero(dev_ctx, w_grad, static_cast<T>(0.0));
+      bit_code.MulGradWeight(pre_out_grad, w_grad, *in);
+    }
     bit_code.MulGradError(pre_out_grad, *w, in_grad);
   }
 };
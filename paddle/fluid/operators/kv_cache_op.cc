@@ -0,0 +1,170 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/kv_cache_op.h"
+#include <string>
+
+namespace paddle {
+namespace operators {
+
+class KVCacheOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        framework::ToDataType(ctx.Input<Tensor>("Cache")->type()),
+        ctx.device_context());
+  }
+
+  // The step is read on CPU, do not copy it to the device of the kernel.
+  framework::OpKernelType GetKernelTypeForVar(
+      const std::string& var_name, const Tensor& tensor,
+      const framework::OpKernelType& expected_kernel_type) const override {
+    if (var_name == "Step") {
+      return framework::OpKernelType(expected_kernel_type.data_type_,
+                                     tensor.place(), tensor.layout());
+    }
+    return framework::OperatorWithKernel::GetKernelTypeForVar(
+        var_name, tensor, expected_kernel_type);
+  }
+};
+
+class KVCacheAppendOp : public KVCacheOp {
+ public:
+  using KVCacheOp::KVCacheOp;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("Cache"),
+                   "Input(Cache) of KVCacheAppendOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("X"),
+                   "Input(X) of KVCacheAppendOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("Step"),
+                   "Input(Step) of KVCacheAppendOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("CacheOut"),
+                   "Output(CacheOut) of KVCacheAppendOp should not be null.");
+
+    auto cache_dims = ctx->GetInputDim("Cache");
+    auto x_dims = ctx->GetInputDim("X");
+    int rank = cache_dims.size();
+    PADDLE_ENFORCE_GE(rank, 2, "Input(Cache) should be at least 2-D.");
+    PADDLE_ENFORCE_EQ(x_dims.size(), rank,
+                      "Input(X) and Input(Cache) should have the same rank.");
+    for (int i = 0; i < rank; ++i) {
+      if (i == rank - 2) continue;
+      PADDLE_ENFORCE_EQ(x_dims[i], cache_dims[i],
+                        "Input(X) and Input(Cache) should only differ in the "
+                        "sequence length.");
+    }
+    PADDLE_ENFORCE_LE(x_dims[rank - 2], cache_dims[rank - 2],
+                      "Input(X) has more rows than Input(Cache).");
+    ctx->SetOutputDim("CacheOut", cache_dims);
+  }
+};
+
+class KVCacheAppendOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Cache",
+             "(Tensor) The preallocated keys or values of a layer, a tensor "
+             "with shape [..., L, D], where L is the max decoding length.");
+    AddInput("X",
+             "(Tensor) The keys or values of the new positions, a tensor with "
+             "shape [..., S, D], S is usually 1.");
+    AddInput("Step",
+             "(Tensor) A tensor of one int or int64, the position of the "
+             "first new row, usually the counter of the decoding loop.");
+    AddOutput("CacheOut",
+              "(Tensor) The updated cache, which should be the same variable "
+              "as Cache to update it in place.");
+    AddComment(R"DOC(
+Append the keys or values of the new decoding positions to the cache:
+
+$$CacheOut[..., Step:Step + S, :] = X$$
+
+The positions before Step are kept, so the attention of an incremental decoder
+only projects the keys and values of the new positions at each step, and reads
+the others from the cache with fused_multihead_attention.
+)DOC");
+  }
+};
+
+class KVCacheReorderOp : public KVCacheOp {
+ public:
+  using KVCacheOp::KVCacheOp;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("Cache"),
+                   "Input(Cache) of KVCacheReorderOp should not be null.");
+    PADDLE_ENFORCE(
+        ctx->HasInput("SelectedIds"),
+        "Input(SelectedIds) of KVCacheReorderOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("CacheOut"),
+                   "Output(CacheOut) of KVCacheReorderOp should not be null.");
+    auto cache_dims = ctx->GetInputDim("Cache");
+    PADDLE_ENFORCE_GE(cache_dims.size(), 3,
+                      "Input(Cache) should be at least 3-D.");
+    // The number of the selected ids is only known at runtime.
+    auto out_dims = cache_dims;
+    out_dims[0] = -1;
+    ctx->SetOutputDim("CacheOut", out_dims);
+  }
+};
+
+class KVCacheReorderOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Cache",
+             "(LoDTensor) The keys or values of the prefixes, a tensor with "
+             "shape [N, ..., L, D], where N is the number of the prefixes.");
+    AddInput("SelectedIds",
+             "(LoDTensor) The selected ids of beam_search, with 2-level LoD.");
+    AddInput("Step",
+             "(Tensor, optional) A tensor of one int or int64, only the "
+             "positions in [0, Step] are reordered. All the positions are "
+             "reordered if it is not set.")
+        .AsDispensable();
+    AddOutput("CacheOut",
+              "(LoDTensor) The caches of the selected ids, a tensor with shape "
+              "[M, ..., L, D], where M is the number of the selected ids.");
+    AddComment(R"DOC(
+Reorder the cache of the keys or values after the beams are pruned by
+beam_search. Each selected id gets the cache of the prefix it extends, which
+is found from the LoD of SelectedIds, so a prefix with several selected ids is
+copied several times and the pruned prefixes are dropped.
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(kv_cache_append, ops::KVCacheAppendOp,
+                  ops::KVCacheAppendOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OPERATOR(kv_cache_reorder, ops::KVCacheReorderOp,
+                  ops::KVCacheReorderOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+
+REGISTER_OP_CPU_KERNEL(
+    kv_cache_append,
+    ops::KVCacheAppendKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::KVCacheAppendKernel<paddle::platform::CPUDeviceContext, double>);
+REGISTER_OP_CPU_KERNEL(
+    kv_cache_reorder,
+    ops::KVCacheReorderKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::KVCacheReorderKernel<paddle::platform::CPUDeviceContext, double>);
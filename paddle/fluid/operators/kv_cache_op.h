@@ -0,0 +1,190 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/platform/for_range.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+using LoDTensor = framework::LoDTensor;
+
+// The position of the decoding step, a tensor of one int or int64 which is
+// usually the counter of the while op on CPU.
+inline int64_t GetCachePosition(const Tensor& step) {
+  PADDLE_ENFORCE_EQ(step.numel(), 1, "The step should have one element.");
+  Tensor cpu_step;
+  const Tensor* t = &step;
+  if (!platform::is_cpu_place(step.place())) {
+    framework::TensorCopySync(step, platform::CPUPlace(), &cpu_step);
+    t = &cpu_step;
+  }
+  if (t->type() == typeid(int)) {
+    return static_cast<int64_t>(t->data<int>()[0]);
+  }
+  return t->data<int64_t>()[0];
+}
+
+// Copy the new rows x [batch, rows, width] to the rows [pos, pos + rows) of
+// the cache [batch, max_len, width].
+template <typename T>
+struct CacheAppendFunctor {
+  CacheAppendFunctor(const T* x, T* cache, int64_t rows, int64_t max_len,
+                     int64_t width, int64_t pos)
+      : x_(x),
+        cache_(cache),
+        x_size_(rows * width),
+        cache_size_(max_len * width),
+        offset_(pos * width) {}
+
+  HOSTDEVICE void operator()(size_t i) const {
+    int64_t b = i / x_size_;
+    int64_t r = i % x_size_;
+    cache_[b * cache_size_ + offset_ + r] = x_[i];
+  }
+
+  const T* x_;
+  T* cache_;
+  int64_t x_size_;
+  int64_t cache_size_;
+  int64_t offset_;
+};
+
+// Gather the first len positions of the caches of the parents,
+// out[i][h] = cache[parent[i]][h] of every head h.
+template <typename T>
+struct CacheReorderFunctor {
+  CacheReorderFunctor(const T* cache, const int64_t* parent, T* out,
+                      int64_t heads, int64_t max_len, int64_t len,
+                      int64_t width)
+      : cache_(cache),
+        parent_(parent),
+        out_(out),
+        row_size_(heads * max_len * width),
+        head_size_(max_len * width),
+        copy_size_(len * width),
+        heads_(heads) {}
+
+  HOSTDEVICE void operator()(size_t i) const {
+    int64_t row = i / (heads_ * copy_size_);
+    int64_t rem = i % (heads_ * copy_size_);
+    int64_t offset = rem / copy_size_ * head_size_ + rem % copy_size_;
+    out_[row * row_size_ + offset] = cache_[parent_[row] * row_size_ + offset];
+  }
+
+  const T* cache_;
+  const int64_t* parent_;
+  T* out_;
+  int64_t row_size_;
+  int64_t head_size_;
+  int64_t copy_size_;
+  int64_t heads_;
+};
+
+template <typename DeviceContext, typename T>
+class KVCacheAppendKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* cache = ctx.Input<Tensor>("Cache");
+    auto* x = ctx.Input<Tensor>("X");
+    auto* out = ctx.Output<Tensor>("CacheOut");
+    int64_t pos = GetCachePosition(*ctx.Input<Tensor>("Step"));
+
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    // The cache is updated in place when CacheOut is Cache.
+    if (out != cache) {
+      framework::TensorCopy(*cache, ctx.GetPlace(), dev_ctx, out);
+    }
+    auto dims = out->dims();
+    int rank = dims.size();
+    int64_t max_len = dims[rank - 2];
+    int64_t width = dims[rank - 1];
+    int64_t rows = x->dims()[rank - 2];
+    PADDLE_ENFORCE(pos >= 0 && pos + rows <= max_len,
+                   "The step %d with %d new rows exceeds the cache length %d.",
+                   pos, rows, max_len);
+
+    platform::ForRange<DeviceContext> for_range(dev_ctx, x->numel());
+    for_range(CacheAppendFunctor<T>(x->data<T>(),
+                                    out->mutable_data<T>(ctx.GetPlace()), rows,
+                                    max_len, width, pos));
+  }
+};
+
+template <typename DeviceContext, typename T>
+class KVCacheReorderKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* cache = ctx.Input<LoDTensor>("Cache");
+    auto* ids = ctx.Input<LoDTensor>("SelectedIds");
+    auto* step = ctx.Input<Tensor>("Step");
+    auto* out = ctx.Output<LoDTensor>("CacheOut");
+
+    auto dims = cache->dims();
+    int rank = dims.size();
+    int64_t max_len = dims[rank - 2];
+    int64_t width = dims[rank - 1];
+    int64_t heads = cache->numel() / (dims[0] * max_len * width);
+    // Only the positions up to the step are cached.
+    int64_t len = step ? GetCachePosition(*step) + 1 : max_len;
+    PADDLE_ENFORCE(len > 0 && len <= max_len,
+                   "The step %d exceeds the cache length %d.", len - 1,
+                   max_len);
+
+    // The level 1 of the LoD of the selected ids maps each prefix to the ids
+    // selected from it, so the parent of the i-th id is the prefix whose
+    // range has i.
+    auto& lod = ids->lod();
+    PADDLE_ENFORCE_EQ(lod.size(), 2UL,
+                      "Input(SelectedIds) should be the output of beam_search "
+                      "with 2-level LoD.");
+    auto& prefix = lod[1];
+    PADDLE_ENFORCE_EQ(static_cast<int64_t>(prefix.size()) - 1, dims[0],
+                      "The caches should be of the prefixes of beam_search.");
+    std::vector<int64_t> parent;
+    for (size_t i = 0; i + 1 < prefix.size(); ++i) {
+      for (size_t j = prefix[i]; j < prefix[i + 1]; ++j) {
+        parent.push_back(static_cast<int64_t>(i));
+      }
+    }
+
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    Tensor parent_t;
+    framework::TensorFromVector(parent, dev_ctx, &parent_t);
+
+    // Gather into a new buffer as CacheOut is usually the same variable as
+    // Cache, the positions after len are left uninitialized.
+    auto out_dims = dims;
+    out_dims[0] = static_cast<int64_t>(parent.size());
+    Tensor reordered;
+    T* out_data = reordered.mutable_data<T>(out_dims, ctx.GetPlace());
+    if (!parent.empty()) {
+      platform::ForRange<DeviceContext> for_range(
+          dev_ctx, parent.size() * heads * len * width);
+      for_range(CacheReorderFunctor<T>(cache->data<T>(),
+                                       parent_t.data<int64_t>(), out_data,
+                                       heads, max_len, len, width));
+    }
+    out->ShareDataWith(reordered);
+    out->set_lod(framework::LoD());
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
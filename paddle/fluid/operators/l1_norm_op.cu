@@ -14,10 +14,28 @@ limitations under the License. */
 
 #define EIGEN_USE_GPU
 #include "paddle/fluid/operators/l1_norm_op.h"
+#include "paddle/fluid/operators/reduce_op.cu.h"
+
+namespace paddle {
+namespace operators {
+
+// Out = sum(abs(X)), abs is fused into the reduction.
+template <typename T>
+class L1NormCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *x = context.Input<framework::Tensor>("X");
+    auto *out = context.Output<framework::Tensor>("Out");
+    out->mutable_data<T>(context.GetPlace());
+    ReduceAllCUDA<T>(context, *x, out, AbsFunctor<T>());
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
 
 namespace ops = paddle::operators;
-REGISTER_OP_CUDA_KERNEL(
-    l1_norm, ops::L1NormKernel<paddle::platform::CUDADeviceContext, float>);
+REGISTER_OP_CUDA_KERNEL(l1_norm, ops::L1NormCUDAKernel<float>);
 REGISTER_OP_CUDA_KERNEL(
     l1_norm_grad,
     ops::L1NormGradKernel<paddle::platform::CUDADeviceContext, float>);
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include <cub/cub.cuh>
 #include "paddle/fluid/operators/layer_norm_op.h"
+#include "paddle/fluid/operators/welford.cu.h"
 
 namespace paddle {
 namespace operators {
@@ -63,6 +64,73 @@ struct PairForLayerNormAddFunctor {
   }
 };
 
+// The rows of up to kMaxWarpFeatureSize elements are normalized by a warp
+// each, kWarpsPerBlock rows a block. The statistics are gathered in a single
+// pass by Welford's algorithm and merged by the warp shuffles, without the
+// shared memory and the barriers of the block reduce.
+static constexpr int kMaxWarpFeatureSize = 4096;
+static constexpr int kWarpsPerBlock = 4;
+
+template <typename T>
+__global__ void LayerNormForwardWarp(const T *x, const T *scale, const T *bias,
+                                     T *y, T *mean, T *var, float epsilon,
+                                     int batch_size, int feature_size) {
+  int row = blockIdx.x * kWarpsPerBlock + threadIdx.y;
+  if (row >= batch_size) return;
+  const T *x_row = x + row * feature_size;
+  T *y_row = y + row * feature_size;
+
+  WelfordData<T> data;
+  for (int j = threadIdx.x; j < feature_size; j += blockDim.x) {
+    data.Update(x_row[j]);
+  }
+  data = WarpWelfordReduce(data);
+  T row_var = data.m2 / feature_size;
+  if (threadIdx.x == 0) {
+    mean[row] = data.mean;
+    var[row] = row_var;
+  }
+
+  T inv_std = static_cast<T>(1) / real_sqrt(row_var + static_cast<T>(epsilon));
+  for (int j = threadIdx.x; j < feature_size; j += blockDim.x) {
+    T out = (x_row[j] - data.mean) * inv_std;
+    if (scale != nullptr) out *= scale[j];
+    if (bias != nullptr) out += bias[j];
+    y_row[j] = out;
+  }
+}
+
+// d_x of the rows of up to kMaxWarpFeatureSize elements, a warp each. With
+// g = d_y * scale and x_hat = (x - mean) / std, sum(g) and sum(g * x_hat) are
+// reduced in one pass and d_x = (g - mean(g) - x_hat * mean(g * x_hat)) / std.
+template <typename T>
+__global__ void LayerNormBackwardDXWarp(const T *x, const T *d_y,
+                                        const T *scale, const T *mean,
+                                        const T *var, T *d_x, float epsilon,
+                                        int batch_size, int feature_size) {
+  int row = blockIdx.x * kWarpsPerBlock + threadIdx.y;
+  if (row >= batch_size) return;
+  int offset = row * feature_size;
+  T row_mean = mean[row];
+  T inv_std =
+      static_cast<T>(1) / real_sqrt(var[row] + static_cast<T>(epsilon));
+
+  T sum_g = 0, sum_g_x_hat = 0;
+  for (int j = threadIdx.x; j < feature_size; j += blockDim.x) {
+    T g = scale != nullptr ? d_y[offset + j] * scale[j] : d_y[offset + j];
+    sum_g += g;
+    sum_g_x_hat += g * (x[offset + j] - row_mean) * inv_std;
+  }
+  T mean_g = WarpAllReduceSum(sum_g) / feature_size;
+  T mean_g_x_hat = WarpAllReduceSum(sum_g_x_hat) / feature_size;
+
+  for (int j = threadIdx.x; j < feature_size; j += blockDim.x) {
+    T g = scale != nullptr ? d_y[offset + j] * scale[j] : d_y[offset + j];
+    T x_hat = (x[offset + j] - row_mean) * inv_std;
+    d_x[offset + j] = (g - mean_g - x_hat * mean_g_x_hat) * inv_std;
+  }
+}
+
 template <typename T, int BlockDim>
 __global__ void LayerNormForward(const T *x, const T *scale, const T *bias,
                                  T *y, T *mean, T *var, float epsilon,
@@ -324,6 +392,17 @@ static void LayerNormBackward(const T *x, const T *d_y, const T *scale,
                       ((d_bias != nullptr ? 1 : 0));
   if (gradient_flag == 0) return;
 
+  if (d_x != nullptr && feature_size <= kMaxWarpFeatureSize) {
+    dim3 threads(32, kWarpsPerBlock);
+    int blocks = (batch_size + kWarpsPerBlock - 1) / kWarpsPerBlock;
+    LayerNormBackwardDXWarp<T><<<blocks, threads, 0, stream>>>(
+        x, d_y, scale, mean, var, d_x, epsilon, batch_size, feature_size);
+    // Only d_scale and d_bias are left to the kernels below.
+    d_x = nullptr;
+    gradient_flag &= 3;
+    if (gradient_flag == 0) return;
+  }
+
   if (batch_size == 1) {
     LayerNormBackwardWhenBatchSizeIsOne<
         T><<<(feature_size + kMaxBlockDim - 1) / kMaxBlockDim, kMaxBlockDim, 0,
@@ -456,6 +535,15 @@ class LayerNormKernel<platform::CUDADeviceContext, T>
 
     auto stream = ctx.cuda_device_context().stream();
 
+    if (feature_size > 1 && feature_size <= kMaxWarpFeatureSize) {
+      dim3 threads(32, kWarpsPerBlock);
+      int blocks = (batch_size + kWarpsPerBlock - 1) / kWarpsPerBlock;
+      LayerNormForwardWarp<T><<<blocks, threads, 0, stream>>>(
+          x_data, scale_data, bias_data, y_data, mean_data, var_data, epsilon,
+          batch_size, feature_size);
+      return;
+    }
+
     switch (GetDesiredBlockDim(feature_size)) {
       FIXED_BLOCK_DIM_CASE(
           LayerNormForward<T, kBlockDim><<<batch_size, kBlockDim, 0, stream>>>(
@@ -17,6 +17,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/elementwise_op_function.h"
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/jit_kernel.h"
 #include "paddle/fluid/operators/math/math_function.h"
 
 namespace paddle {
@@ -161,6 +162,32 @@ using Tensor = framework::Tensor;
 using LoDTensor = framework::LoDTensor;
 using DataLayout = framework::DataLayout;
 
+// Normalize the rows of x by the fused jit kernel on CPU. Return false if it
+// is not applicable.
+template <typename DeviceContext, typename T>
+struct JITLayerNorm {
+  bool operator()(const Tensor& x, const Tensor* scale, const Tensor* bias,
+                  float epsilon, int left, int right, Tensor* out,
+                  Tensor* mean, Tensor* var) const {
+    return false;
+  }
+};
+
+template <>
+struct JITLayerNorm<platform::CPUDeviceContext, float> {
+  bool operator()(const Tensor& x, const Tensor* scale, const Tensor* bias,
+                  float epsilon, int left, int right, Tensor* out,
+                  Tensor* mean, Tensor* var) const {
+    const auto& ker =
+        math::jitkernel::KernelPool::Instance()
+            .template Get<math::jitkernel::LayerNormKernel<float>>(right);
+    ker->Compute(x.data<float>(), out->data<float>(), mean->data<float>(),
+                 var->data<float>(), scale ? scale->data<float>() : nullptr,
+                 bias ? bias->data<float>() : nullptr, left, epsilon);
+    return true;
+  }
+};
+
 template <typename DeviceContext, typename T>
 class LayerNormKernel : public framework::OpKernel<T> {
  public:
@@ -190,6 +217,10 @@ class LayerNormKernel : public framework::OpKernel<T> {
     Tensor out;
     out.ShareDataWith(*y);
     out.Resize(matrix_shape);
+    if (JITLayerNorm<DeviceContext, T>()(x, scale, bias, epsilon, left, right,
+                                         &out, mean, var)) {
+      return;
+    }
 
     auto& dev_ctx = ctx.template device_context<DeviceContext>();
     RowwiseMean2D<DeviceContext, T> row_mean(left, right, ctx.device_context());
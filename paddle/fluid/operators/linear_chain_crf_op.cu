@@ -12,16 +12,416 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <algorithm>
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/operators/linear_chain_crf_op.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
 
-namespace ops = paddle::operators;
+namespace paddle {
+namespace operators {
+
+namespace {
+
+#define CUDA_1D_KERNEL_LOOP(i, n)                              \
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < (n); \
+       i += blockDim.x * gridDim.x)
+
+int const kNumCUDAThreads = 512;
+int const kNumMaxinumBlocks = 4096;
+
+static inline int NumBlocks(const int n) {
+  return std::min((n + kNumCUDAThreads - 1) / kNumCUDAThreads,
+                  kNumMaxinumBlocks);
+}
+
+// The power of two threads of a block to run the tags of a sequence.
+static inline int NumThreads(const int tag_num) {
+  int threads = 32;
+  while (threads < tag_num && threads < kNumCUDAThreads) threads <<= 1;
+  return threads;
+}
+
+// The 1st row of w are transition weights for start mask.
+// The 2nd row of w are transition weights for end mask.
+// Transition weights between other tags begin from the 3rd row of w.
+const int kStateTransBaseIdx = 2;
+
+// The errors found by the kernels. Any thread sets the flag of an error to 1
+// and the flags are checked on the host after the kernel, as the CPU kernels
+// enforce them.
+enum CRFError { kInvalidLabel = 0, kZeroNormalizer = 1, kNumCRFErrors = 2 };
+
+static void EnforceNoCRFError(const Tensor& errors) {
+  Tensor cpu_errors;
+  framework::TensorCopySync(errors, platform::CPUPlace(), &cpu_errors);
+  const int* flags = cpu_errors.data<int>();
+  PADDLE_ENFORCE(!flags[kInvalidLabel],
+                 "An invalid tag label that execesses the largest tag number.");
+  PADDLE_ENFORCE(!flags[kZeroNormalizer],
+                 "The unnormalized probabilities of all possible unfinished "
+                 "sequences must be greater than 0.");
+}
+
+__device__ inline bool IsValidLabel(const int64_t label, const int tag_num) {
+  return label >= 0 && label < tag_num;
+}
+
+// Sums val of all the threads of a block whose size is a power of two.
+template <typename T>
+__device__ T BlockReduceSum(T val, T* shm) {
+  shm[threadIdx.x] = val;
+  __syncthreads();
+  for (int s = blockDim.x / 2; s > 0; s >>= 1) {
+    if (threadIdx.x < s) shm[threadIdx.x] += shm[threadIdx.x + s];
+    __syncthreads();
+  }
+  T sum = shm[0];
+  __syncthreads();
+  return sum;
+}
+
+template <typename T>
+__global__ void ExpKernel(const T* x, const int num, T* y) {
+  CUDA_1D_KERNEL_LOOP(i, num) { y[i] = exp(x[i]); }
+}
+
+template <typename T>
+__global__ void EmissionExpsKernel(const T* x, const int batch_size,
+                                   const int tag_num, T* x_row_max,
+                                   T* x_exps) {
+  CUDA_1D_KERNEL_LOOP(k, batch_size) {
+    const T* x_row = x + k * tag_num;
+    T max_value = x_row[0];
+    for (int i = 1; i < tag_num; ++i) {
+      max_value = x_row[i] > max_value ? x_row[i] : max_value;
+    }
+    for (int i = 0; i < tag_num; ++i) {
+      x_exps[k * tag_num + i] = exp(x_row[i] - max_value);
+    }
+    x_row_max[k] = max_value;
+  }
+}
+
+// One block runs the forward algorithm of one sequence, the threads of the
+// block run the tags. Every row of alpha is L1 normalized to avoid underflow
+// or overflow, and the normalizers are accumulated into log(Z).
+template <typename T>
+__global__ void ForwardKernel(const size_t* lod, const T* x,
+                              const T* x_row_max, const T* x_exps,
+                              const T* w, const T* w_exps,
+                              const int64_t* label, const int tag_num,
+                              T* alpha, T* ll, int* errors) {
+  __shared__ T shm[kNumCUDAThreads];
+  const int start = static_cast<int>(lod[blockIdx.x]);
+  const int seq_len = static_cast<int>(lod[blockIdx.x + 1]) - start;
+  if (seq_len == 0) {
+    // If an empty input sequence is given, pad 0 for its cost.
+    if (threadIdx.x == 0) ll[blockIdx.x] = 0;
+    return;
+  }
+  x += start * tag_num;
+  x_row_max += start;
+  x_exps += start * tag_num;
+  alpha += start * tag_num;
+  label += start;
+
+  T partial = 0;
+  for (int i = threadIdx.x; i < tag_num; i += blockDim.x) {
+    alpha[i] = w_exps[i] * x_exps[i];
+    partial += alpha[i];
+  }
+  T sum = BlockReduceSum(partial, shm);
+  // sum is the same in all the threads, so they return together.
+  if (sum == 0) {
+    if (threadIdx.x == 0) errors[kZeroNormalizer] = 1;
+    return;
+  }
+  for (int i = threadIdx.x; i < tag_num; i += blockDim.x) alpha[i] /= sum;
+  T log_z = x_row_max[0] + log(sum);
+
+  for (int k = 1; k < seq_len; ++k) {
+    __syncthreads();
+    partial = 0;
+    for (int i = threadIdx.x; i < tag_num; i += blockDim.x) {
+      T s = 0;
+      for (int j = 0; j < tag_num; ++j) {
+        s += alpha[(k - 1) * tag_num + j] *
+             w_exps[(j + kStateTransBaseIdx) * tag_num + i];
+      }
+      alpha[k * tag_num + i] = x_exps[k * tag_num + i] * s;
+      partial += alpha[k * tag_num + i];
+    }
+    sum = BlockReduceSum(partial, shm);
+    if (sum == 0) {
+      if (threadIdx.x == 0) errors[kZeroNormalizer] = 1;
+      return;
+    }
+    for (int i = threadIdx.x; i < tag_num; i += blockDim.x) {
+      alpha[k * tag_num + i] /= sum;
+    }
+    log_z += x_row_max[k] + log(sum);
+  }
+  __syncthreads();
+
+  partial = 0;
+  for (int i = threadIdx.x; i < tag_num; i += blockDim.x) {
+    partial += alpha[(seq_len - 1) * tag_num + i] * w_exps[tag_num + i];
+  }
+  log_z += log(BlockReduceSum(partial, shm));
+
+  // The score of the label sequence.
+  partial = 0;
+  for (int k = threadIdx.x; k < seq_len; k += blockDim.x) {
+    if (!IsValidLabel(label[k], tag_num) ||
+        (k > 0 && !IsValidLabel(label[k - 1], tag_num))) {
+      errors[kInvalidLabel] = 1;
+      continue;
+    }
+    partial += x[k * tag_num + label[k]];
+    partial += k == 0 ? w[label[0]]
+                      : w[(label[k - 1] + kStateTransBaseIdx) * tag_num +
+                          label[k]];
+    if (k == seq_len - 1) partial += w[tag_num + label[k]];
+  }
+  T score = BlockReduceSum(partial, shm);
+  if (threadIdx.x == 0) ll[blockIdx.x] = log_z - score;
+}
+
+// One block runs the backward algorithm and the gradients of one sequence.
+// The gradients of the transition weights are accumulated over the
+// sequences by atomic adds.
+template <typename T>
+__global__ void BackwardKernel(const size_t* lod, const T* x_exps,
+                               const T* w_exps, const T* alpha,
+                               const int64_t* label, const T* ll_grad,
+                               const int tag_num, T* beta, T* x_grad,
+                               T* w_grad, int* errors) {
+  __shared__ T shm[kNumCUDAThreads];
+  const int start = static_cast<int>(lod[blockIdx.x]);
+  const int seq_len = static_cast<int>(lod[blockIdx.x + 1]) - start;
+  if (seq_len == 0) return;
+  x_exps += start * tag_num;
+  alpha += start * tag_num;
+  label += start;
+  beta += start * tag_num;
+  x_grad += start * tag_num;
+  const T g = ll_grad[blockIdx.x];
+
+  // The labels are checked before any gradient is written, as all the
+  // threads of the block must agree on returning.
+  T partial = 0;
+  for (int k = threadIdx.x; k < seq_len; k += blockDim.x) {
+    if (!IsValidLabel(label[k], tag_num)) partial = 1;
+  }
+  if (BlockReduceSum(partial, shm) != 0) {
+    if (threadIdx.x == 0) errors[kInvalidLabel] = 1;
+    return;
+  }
 
-REGISTER_OP_CUDA_KERNEL(
-    linear_chain_crf,
-    ops::LinearChainCRFOpKernel<paddle::platform::CUDADeviceContext, float>,
-    ops::LinearChainCRFOpKernel<paddle::platform::CUDADeviceContext, double>);
-REGISTER_OP_CUDA_KERNEL(
-    linear_chain_crf_grad,
-    ops::LinearChainCRFGradOpKernel<paddle::platform::CUDADeviceContext, float>,
-    ops::LinearChainCRFGradOpKernel<paddle::platform::CUDADeviceContext,
-                                    double>);
+  T* last_beta = beta + (seq_len - 1) * tag_num;
+  partial = 0;
+  for (int i = threadIdx.x; i < tag_num; i += blockDim.x) {
+    last_beta[i] = w_exps[tag_num + i];
+    partial += last_beta[i];
+  }
+  T sum = BlockReduceSum(partial, shm);
+  if (sum == 0) {
+    if (threadIdx.x == 0) errors[kZeroNormalizer] = 1;
+    return;
+  }
+  for (int i = threadIdx.x; i < tag_num; i += blockDim.x) last_beta[i] /= sum;
+
+  for (int k = seq_len - 2; k >= 0; --k) {
+    __syncthreads();
+    partial = 0;
+    for (int i = threadIdx.x; i < tag_num; i += blockDim.x) {
+      T s = 0;
+      for (int j = 0; j < tag_num; ++j) {
+        s += w_exps[(i + kStateTransBaseIdx) * tag_num + j] *
+             x_exps[(k + 1) * tag_num + j] * beta[(k + 1) * tag_num + j];
+      }
+      beta[k * tag_num + i] = s;
+      partial += s;
+    }
+    sum = BlockReduceSum(partial, shm);
+    if (sum == 0) {
+      if (threadIdx.x == 0) errors[kZeroNormalizer] = 1;
+      return;
+    }
+    for (int i = threadIdx.x; i < tag_num; i += blockDim.x) {
+      beta[k * tag_num + i] /= sum;
+    }
+  }
+  __syncthreads();
+
+  for (int k = 0; k < seq_len; ++k) {
+    partial = 0;
+    for (int i = threadIdx.x; i < tag_num; i += blockDim.x) {
+      partial += alpha[k * tag_num + i] * beta[k * tag_num + i];
+    }
+    sum = BlockReduceSum(partial, shm);
+    for (int i = threadIdx.x; i < tag_num; i += blockDim.x) {
+      x_grad[k * tag_num + i] =
+          alpha[k * tag_num + i] * beta[k * tag_num + i] / sum * g -
+          (i == label[k] ? g : static_cast<T>(0));
+    }
+  }
+  if (w_grad == nullptr) return;
+
+  for (int i = threadIdx.x; i < tag_num; i += blockDim.x) {
+    platform::CudaAtomicAdd(w_grad + i, x_grad[i]);
+    platform::CudaAtomicAdd(w_grad + tag_num + i,
+                            x_grad[(seq_len - 1) * tag_num + i]);
+  }
+  // The marginal of the transition (i -> j) between position k - 1 and k is
+  // proportional to w_exps(i, j) * alpha(k - 1, i) * x_exps(k, j) *
+  // beta(k, j), the normalizers of the rows cancel out here.
+  for (int k = 1; k < seq_len; ++k) {
+    partial = 0;
+    for (int p = threadIdx.x; p < tag_num * tag_num; p += blockDim.x) {
+      const int i = p / tag_num;
+      const int j = p % tag_num;
+      partial += w_exps[(i + kStateTransBaseIdx) * tag_num + j] *
+                 alpha[(k - 1) * tag_num + i] * x_exps[k * tag_num + j] *
+                 beta[k * tag_num + j];
+    }
+    sum = BlockReduceSum(partial, shm);
+    for (int p = threadIdx.x; p < tag_num * tag_num; p += blockDim.x) {
+      const int i = p / tag_num;
+      const int j = p % tag_num;
+      platform::CudaAtomicAdd(
+          w_grad + (i + kStateTransBaseIdx) * tag_num + j,
+          w_exps[(i + kStateTransBaseIdx) * tag_num + j] *
+              alpha[(k - 1) * tag_num + i] * x_exps[k * tag_num + j] *
+              beta[k * tag_num + j] / sum * g);
+    }
+    if (threadIdx.x == 0) {
+      platform::CudaAtomicAdd(
+          w_grad + (label[k - 1] + kStateTransBaseIdx) * tag_num + label[k],
+          -g);
+    }
+  }
+}
+
+}  // namespace
+
+template <typename T>
+class LinearChainCRFCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    PADDLE_ENFORCE_EQ(ctx.Input<LoDTensor>("Emission")->NumLevels(), 1UL,
+                      "The Input(Emission) should be a sequence.");
+    PADDLE_ENFORCE_EQ(ctx.Input<LoDTensor>("Label")->NumLevels(), 1UL,
+                      "The Input(Label) should be a sequence.");
+    const auto& in_lod = ctx.Input<LoDTensor>("Label")->lod();
+    PADDLE_ENFORCE(in_lod.size(), "Input(Label) must be a sequence.");
+    const size_t level = 0;
+    const int seq_num = static_cast<int>(in_lod[level].size() - 1);
+
+    const LoDTensor* emission_weights = ctx.Input<LoDTensor>("Emission");
+    const Tensor* transition_weights = ctx.Input<Tensor>("Transition");
+    const LoDTensor* label = ctx.Input<LoDTensor>("Label");
+
+    Tensor* emission_exps = ctx.Output<Tensor>("EmissionExps");
+    Tensor* transition_exps = ctx.Output<Tensor>("TransitionExps");
+    Tensor* alpha = ctx.Output<Tensor>("Alpha");
+    Tensor* ll = ctx.Output<Tensor>("LogLikelihood");
+
+    auto emission_dims = emission_weights->dims();
+    const int batch_size = static_cast<int>(emission_dims[0]);
+    const int tag_num = static_cast<int>(emission_dims[1]);
+    auto stream =
+        ctx.template device_context<platform::CUDADeviceContext>().stream();
+
+    Tensor emission_row_max;
+    T* x_row_max = emission_row_max.mutable_data<T>(
+        framework::make_ddim({static_cast<int64_t>(batch_size), 1}),
+        ctx.GetPlace());
+    T* x_exps = emission_exps->mutable_data<T>(ctx.GetPlace());
+    EmissionExpsKernel<T><<<NumBlocks(batch_size), kNumCUDAThreads, 0,
+                            stream>>>(emission_weights->data<T>(), batch_size,
+                                      tag_num, x_row_max, x_exps);
+
+    const int w_num = static_cast<int>(transition_weights->numel());
+    T* w_exps = transition_exps->mutable_data<T>(ctx.GetPlace());
+    ExpKernel<T><<<NumBlocks(w_num), kNumCUDAThreads, 0, stream>>>(
+        transition_weights->data<T>(), w_num, w_exps);
+
+    ll->Resize({static_cast<int64_t>(seq_num), 1});
+    T* log_likelihood = ll->mutable_data<T>(ctx.GetPlace());
+    T* alpha_value = alpha->mutable_data<T>(ctx.GetPlace());
+    if (seq_num == 0) return;
+    Tensor errors;
+    int* error_flags = errors.mutable_data<int>(
+        framework::make_ddim({kNumCRFErrors}), ctx.GetPlace());
+    math::SetConstant<platform::CUDADeviceContext, int>()(
+        ctx.template device_context<platform::CUDADeviceContext>(), &errors,
+        0);
+    ForwardKernel<T><<<seq_num, NumThreads(tag_num), 0, stream>>>(
+        in_lod[level].CUDAData(ctx.GetPlace()), emission_weights->data<T>(),
+        x_row_max, x_exps, transition_weights->data<T>(), w_exps,
+        label->data<int64_t>(), tag_num, alpha_value, log_likelihood,
+        error_flags);
+    EnforceNoCRFError(errors);
+  }
+};
+
+template <typename T>
+class LinearChainCRFGradCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    const size_t level = 0;  // currently, only support sequence.
+    const auto& lod = ctx.Input<LoDTensor>("Label")->lod();
+    PADDLE_ENFORCE(lod.size(), "Input(Label) must be a sequence.");
+    const int seq_num = static_cast<int>(lod[level].size() - 1);
+
+    const Tensor* label = ctx.Input<LoDTensor>("Label");
+    const Tensor* emission_exps = ctx.Input<Tensor>("EmissionExps");
+    const Tensor* transition_exps = ctx.Input<Tensor>("TransitionExps");
+    const Tensor* alpha = ctx.Input<Tensor>("Alpha");
+    const Tensor* ll_grad =
+        ctx.Input<Tensor>(framework::GradVarName("LogLikelihood"));
+
+    Tensor* emission_grad =
+        ctx.Output<Tensor>(framework::GradVarName("Emission"));
+    Tensor* transition_grad =
+        ctx.Output<Tensor>(framework::GradVarName("Transition"));
+
+    PADDLE_ENFORCE(emission_grad, "Output(Emission@Grad) should not be null.");
+    auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
+    T* x_grad = emission_grad->mutable_data<T>(ctx.GetPlace());
+    T* w_grad = nullptr;
+    if (transition_grad) {
+      w_grad = transition_grad->mutable_data<T>(ctx.GetPlace());
+      math::SetConstant<platform::CUDADeviceContext, T>()(
+          dev_ctx, transition_grad, static_cast<T>(0));
+    }
+    if (seq_num == 0) return;
+
+    auto emission_dims = emission_exps->dims();
+    const int tag_num = static_cast<int>(emission_dims[1]);
+    Tensor beta;
+    T* beta_value = beta.mutable_data<T>(emission_dims, ctx.GetPlace());
+    Tensor errors;
+    int* error_flags = errors.mutable_data<int>(
+        framework::make_ddim({kNumCRFErrors}), ctx.GetPlace());
+    math::SetConstant<platform::CUDADeviceContext, int>()(dev_ctx, &errors, 0);
+
+    BackwardKernel<T><<<seq_num, NumThreads(tag_num), 0, dev_ctx.stream()>>>(
+        lod[level].CUDAData(ctx.GetPlace()), emission_exps->data<T>(),
+        transition_exps->data<T>(), alpha->data<T>(), label->data<int64_t>(),
+        ll_grad->data<T>(), tag_num, beta_value, x_grad, w_grad, error_flags);
+    EnforceNoCRFError(errors);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(linear_chain_crf,
+                        ops::LinearChainCRFCUDAKernel<float>,
+                        ops::LinearChainCRFCUDAKernel<double>);
+REGISTER_OP_CUDA_KERNEL(linear_chain_crf_grad,
+                        ops::LinearChainCRFGradCUDAKernel<float>,
+                        ops::LinearChainCRFGradCUDAKernel<double>);
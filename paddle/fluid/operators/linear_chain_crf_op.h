@@ -13,9 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <algorithm>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/platform/for_range.h"
 
 namespace paddle {
 namespace operators {
@@ -111,25 +113,35 @@ class LinearChainCRFOpKernel : public framework::OpKernel<T> {
     w_exps.device(place) = w.exp();
 
     T* log_likelihood = ll->data<T>();
-    for (size_t i = 0; i < seq_num; ++i) {
-      int start_pos = static_cast<int>(in_lod[level][i]);
-      int end_pos = static_cast<int>(in_lod[level][i + 1]);
-      if (end_pos == start_pos) {
-        // If an empty input sequence is given, pad 0 for its cost.
-        log_likelihood[i] = 0.;
-        continue;
-      }
-
-      const Tensor one_seq = emission_weights->Slice(start_pos, end_pos);
-      Tensor one_seq_row_max = emission_row_max.Slice(start_pos, end_pos);
-      Tensor one_seq_exps = emission_exps->Slice(start_pos, end_pos);
-      const Tensor one_seq_label = label->Slice(start_pos, end_pos);
-      Tensor one_seq_alpha = alpha->Slice(start_pos, end_pos);
-
-      log_likelihood[i] = ForwardOneSequence(
-          one_seq, one_seq_row_max, one_seq_exps, *transition_weights,
-          *transition_exps, one_seq_label, &one_seq_alpha);
-    }
+    // The sequences are independent, run them by the intra-op thread pool.
+    platform::ParallelFor(
+        ctx.template device_context<platform::CPUDeviceContext>(),
+        static_cast<int64_t>(seq_num),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            int start_pos = static_cast<int>(in_lod[level][i]);
+            int end_pos = static_cast<int>(in_lod[level][i + 1]);
+            if (end_pos == start_pos) {
+              // If an empty input sequence is given, pad 0 for its cost.
+              log_likelihood[i] = 0.;
+              continue;
+            }
+
+            const Tensor one_seq =
+                emission_weights->Slice(start_pos, end_pos);
+            Tensor one_seq_row_max =
+                emission_row_max.Slice(start_pos, end_pos);
+            Tensor one_seq_exps = emission_exps->Slice(start_pos, end_pos);
+            const Tensor one_seq_label = label->Slice(start_pos, end_pos);
+            Tensor one_seq_alpha = alpha->Slice(start_pos, end_pos);
+
+            log_likelihood[i] = ForwardOneSequence(
+                one_seq, one_seq_row_max, one_seq_exps, *transition_weights,
+                *transition_exps, one_seq_label, &one_seq_alpha);
+          }
+        },
+        static_cast<int64_t>(batch_size * tag_num * tag_num /
+                             std::max<size_t>(seq_num, 1)));
   };
 
  private:
@@ -16,7 +16,10 @@ limitations under the License. */
 #include <csignal>
 #include <cstdlib>
 #include <fstream>
+#include <string>
 #include <thread>  // NOLINT
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "gflags/gflags.h"
@@ -25,6 +28,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/math/math_function.h"
 
 #include "paddle/fluid/operators/distributed/request_handler_impl.h"
+#include "paddle/fluid/operators/distributed/rpc_metrics.h"
 #include "paddle/fluid/operators/listen_and_serv_op.h"
 
 DEFINE_int32(rpc_send_thread_num, 5, "number of threads for rpc send");
@@ -77,6 +81,47 @@ static void ParallelExecuteBlocks(
   for (size_t i = 0; i < fs.size(); ++i) fs[i].wait();
 }
 
+// Run the blocks in order, the consecutive blocks with the same parent run
+// in parallel.
+static void ExecuteOptimizeBlocks(
+    const std::vector<int> &blkids, framework::Executor *executor,
+    const std::vector<std::shared_ptr<framework::ExecutorPrepareContext>>
+        &prepared,
+    framework::ProgramDesc *program, framework::Scope *scope) {
+  if (blkids.empty()) return;
+  // NOTE: if is_gpu_place, CUDA kernels are launched by multiple threads
+  // and this will still work.
+  // TODO(Yancey1989): need to use ParallelExecutor for future
+  int32_t last_parent_blkid = program->Block(blkids[0]).Parent();
+  std::vector<size_t> parallel_blkids;
+  for (int blkid : blkids) {
+    if (program->Block(blkid).Parent() != last_parent_blkid) {
+      ParallelExecuteBlocks(parallel_blkids, executor, prepared, program,
+                            scope);
+      parallel_blkids.clear();
+      last_parent_blkid = program->Block(blkid).Parent();
+    }
+    parallel_blkids.push_back(blkid);
+  }
+  ParallelExecuteBlocks(parallel_blkids, executor, prepared, program, scope);
+}
+
+static DoubleFindMap<std::string, int32_t> ParseGradToBlockId(
+    const std::vector<std::string> &grad_to_block_id_str) {
+  DoubleFindMap<std::string, int32_t> grad_to_block_id;
+  for (const auto &grad_and_id : grad_to_block_id_str) {
+    std::vector<std::string> pieces;
+    split(grad_and_id, ':', &pieces);
+    VLOG(3) << "after split, key = " << pieces[0] << ", id=" << pieces[1];
+    PADDLE_ENFORCE_EQ(pieces.size(), 2);
+    PADDLE_ENFORCE_EQ(grad_to_block_id.count(pieces[0]), 0);
+
+    int block_id = std::stoi(pieces[1]);
+    grad_to_block_id[pieces[0]] = block_id;
+  }
+  return grad_to_block_id;
+}
+
 ListenAndServOp::ListenAndServOp(const std::string &type,
                                  const framework::VariableNameMap &inputs,
                                  const framework::VariableNameMap &outputs,
@@ -127,14 +172,63 @@ void ListenAndServOp::RunSyncLoop(
       optimize_prepared.begin(),
       std::shared_ptr<framework::ExecutorPrepareContext>(nullptr));
 
+  std::vector<int> optimize_blkids;
+  for (auto *block : optimize_blocks) {
+    optimize_blkids.push_back(block->ID());
+  }
+
+  // With pipeline_optimize, the block of a gradient runs in the send
+  // handler once all the trainers have sent the gradient. The blocks before
+  // the first one of a gradient, i.e. the learning rate decay, run before
+  // receiving the gradients, and the rest after the batch barrier.
+  bool pipeline_optimize = Attr<bool>("pipeline_optimize");
+  auto *send_handler = static_cast<distributed::RequestSendHandler *>(
+      request_send_handler_.get());
+  std::unordered_map<std::string,
+                     std::shared_ptr<framework::ExecutorPrepareContext>>
+      grad_to_prepared_ctx;
+  std::unordered_map<int, std::string> blkid_to_grad;
+  std::vector<int> pre_send_blkids;
+  if (pipeline_optimize) {
+    auto grad_to_block_id =
+        ParseGradToBlockId(Attr<std::vector<std::string>>("grad_to_block_id"));
+    std::unordered_map<int, int> grads_of_block;
+    for (auto &grad_and_id : grad_to_block_id) {
+      ++grads_of_block[grad_and_id.second];
+    }
+    for (auto &grad_and_id : grad_to_block_id) {
+      // a block shared by several gradients waits for the batch barrier
+      if (grads_of_block[grad_and_id.second] != 1) continue;
+      grad_to_prepared_ctx[grad_and_id.first] =
+          optimize_prepared[grad_and_id.second];
+      blkid_to_grad[grad_and_id.second] = grad_and_id.first;
+    }
+    while (!optimize_blkids.empty() &&
+           grads_of_block.count(optimize_blkids.front()) == 0) {
+      pre_send_blkids.push_back(optimize_blkids.front());
+      optimize_blkids.erase(optimize_blkids.begin());
+    }
+    send_handler->SetGradToPreparedCtx(&grad_to_prepared_ctx);
+    send_handler->SetPipelineOptimize(true);
+  }
+
   // Trainers will get all parameters from pserver in the
   // startup program, so we will wait RequestGet first
   rpc_service_->SetCond(distributed::kRequestGet);
   rpc_service_->WaitBarrier(distributed::kRequestGet);
   rpc_service_->ResetBarrierCounter();
 
+  auto &metrics = distributed::MetricsRegistry::Instance();
+  auto *steps = metrics.GetCounter("pserver_steps_total",
+                                   "The steps of the sync training.");
+  auto *optimize_seconds = metrics.GetHistogram(
+      "pserver_optimize_seconds", "The time running the optimize blocks.",
+      distributed::MetricLabel("mode", "sync"));
+
   while (true) {
     rpc_service_->Profiler().OneStep();
+    ExecuteOptimizeBlocks(pre_send_blkids, executor, optimize_prepared,
+                          program, recv_scope);
     // Get from multiple trainers, we don't care about the order in which
     // the gradients arrives, just add suffix 0~n and merge the gradient.
     rpc_service_->SetCond(distributed::kRequestSend);
@@ -146,29 +240,28 @@ void ListenAndServOp::RunSyncLoop(
       break;
     }
 
-    // NOTE: if is_gpu_place, CUDA kernels are launched by multiple threads
-    // and this will still work.
     // The optimize blocks which have the same parent ID would run parallel
-    // TODO(Yancey1989): need to use ParallelExecutor for future
-    int32_t last_parent_blkid = optimize_blocks[0]->Parent();
-    std::vector<size_t> parallel_blkids;
-    parallel_blkids.push_back(optimize_blocks[0]->ID());
     double ts = GetTimestamp();
-    for (size_t i = 1; i < optimize_blocks.size(); ++i) {
-      // skip the first optimize block because it is already in the
-      // parallel_blkids.
-      int blkid = optimize_blocks[i]->ID();
-      if (program->Block(blkid).Parent() != last_parent_blkid) {
-        ParallelExecuteBlocks(parallel_blkids, executor, optimize_prepared,
-                              program, recv_scope);
-        parallel_blkids.clear();
-        last_parent_blkid = program->Block(blkid).Parent();
+    if (pipeline_optimize) {
+      // the gradients not sent by all the trainers are optimized here
+      auto optimized = send_handler->ResetOptimizedGrads();
+      std::vector<int> rest_blkids;
+      for (int blkid : optimize_blkids) {
+        auto it = blkid_to_grad.find(blkid);
+        if (it == blkid_to_grad.end() || optimized.count(it->second) == 0) {
+          rest_blkids.push_back(blkid);
+        }
       }
-      parallel_blkids.push_back(blkid);
+      ExecuteOptimizeBlocks(rest_blkids, executor, optimize_prepared, program,
+                            recv_scope);
+    } else {
+      ExecuteOptimizeBlocks(optimize_blkids, executor, optimize_prepared,
+                            program, recv_scope);
     }
-    ParallelExecuteBlocks(parallel_blkids, executor, optimize_prepared, program,
-                          recv_scope);
-    VLOG(2) << "run all blocks spent " << GetTimestamp() - ts << "(ms)";
+    double optimize_ms = GetTimestamp() - ts;
+    VLOG(2) << "run all blocks spent " << optimize_ms << "(ms)";
+    optimize_seconds->Observe(optimize_ms / 1000);
+    steps->Add();
 
     ResetReceivedVars(recv_scope, dev_ctx, rpc_service_->NeedResetAllVars());
 
@@ -218,25 +311,8 @@ void ListenAndServOp::RunAsyncLoop(framework::Executor *executor,
                                    framework::ProgramDesc *program,
                                    framework::Scope *recv_scope) const {
   VLOG(2) << "RunAsyncLoop";
-  auto grad_to_block_id_str =
-      Attr<std::vector<std::string>>("grad_to_block_id");
-  DoubleFindMap<std::string, int32_t> grad_to_block_id;
-
-  auto append_block_maps = [](DoubleFindMap<std::string, int32_t> *out_map,
-                              const std::string &grad_and_id) {
-    std::vector<std::string> pieces;
-    split(grad_and_id, ':', &pieces);
-    VLOG(3) << "after split, key = " << pieces[0] << ", id=" << pieces[1];
-    PADDLE_ENFORCE_EQ(pieces.size(), 2);
-    PADDLE_ENFORCE_EQ(out_map->count(pieces[0]), 0);
-
-    int block_id = std::stoi(pieces[1]);
-    (*out_map)[pieces[0]] = block_id;
-  };
-
-  for (const auto &grad_and_id : grad_to_block_id_str) {
-    append_block_maps(&grad_to_block_id, grad_and_id);
-  }
+  auto grad_to_block_id =
+      ParseGradToBlockId(Attr<std::vector<std::string>>("grad_to_block_id"));
 
   size_t num_blocks = program->Size();
   PADDLE_ENFORCE_GE(num_blocks, 2,
@@ -338,6 +414,9 @@ void ListenAndServOp::RunImpl(const framework::Scope &scope,
           << ", checkpoint_block_id: " << checkpoint_block_id;
 
   rpc_service_.reset(new RPCSERVER_T(endpoint, fan_in));
+  if (!sync_mode) {
+    rpc_service_->SetStaleness(Attr<int>("staleness"));
+  }
 
   request_send_handler_.reset(
       new distributed::RequestSendHandler(sync_mode, dc_sgd));
@@ -458,6 +537,14 @@ class ListenAndServOpMaker : public framework::OpProtoAndCheckerMaker {
     AddAttr<bool>("sync_mode", "if works at sync_mode or not").SetDefault(true);
     AddAttr<bool>("dc_asgd", "set to true will enable DC-ASGD training.")
         .SetDefault(false);
+    AddAttr<bool>("pipeline_optimize",
+                  "In sync mode, optimize a parameter once its gradients from "
+                  "all the trainers arrive, while receiving the others.")
+        .SetDefault(false);
+    AddAttr<int>("staleness",
+                 "In async mode, how many steps a trainer can be ahead of the "
+                 "slowest one, 0 means no bound.")
+        .SetDefault(0);
     AddAttr<std::vector<framework::BlockDesc *>>(
         kOptimizeBlocks, "Optimize blocks to run on server side.")
         .SetDefault({});
@@ -12,8 +12,13 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 #include <fstream>
+#include <unordered_map>
 #include "paddle/fluid/framework/data_type_transform.h"
+#include "paddle/fluid/framework/mapped_file.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/sharded_params_file.h"
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/operators/checkpoint_writer.h"
 #include "paddle/fluid/platform/device_context.h"
 
 namespace paddle {
@@ -30,13 +35,11 @@ class LoadCombineOp : public framework::OperatorBase {
  private:
   void RunImpl(const framework::Scope &scope,
                const platform::Place &place) const override {
+    // The file may be being written by an async save op.
+    AsyncCheckpointWriter::Instance().Wait();
     auto filename = Attr<std::string>("file_path");
     auto load_as_fp16 = Attr<bool>("load_as_fp16");
 
-    std::ifstream fin(filename);
-    PADDLE_ENFORCE(static_cast<bool>(fin),
-                   "Cannot open file %s for load_combine op", filename);
-
     auto out_var_names = Outputs("Out");
     PADDLE_ENFORCE_GT(
         static_cast<int>(out_var_names.size()), 0,
@@ -45,6 +48,19 @@ class LoadCombineOp : public framework::OperatorBase {
     platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
     auto &dev_ctx = *pool.Get(place);
 
+    if (framework::IsMappableParamsFile(filename)) {
+      LoadMapped(scope, place, filename, out_var_names, load_as_fp16);
+      return;
+    }
+    if (framework::IsShardedParamsFile(filename)) {
+      LoadSharded(scope, place, filename, out_var_names, load_as_fp16);
+      return;
+    }
+
+    std::ifstream fin(filename);
+    PADDLE_ENFORCE(static_cast<bool>(fin),
+                   "Cannot open file %s for load_combine op", filename);
+
     for (size_t i = 0; i < out_var_names.size(); i++) {
       auto *out_var = scope.FindVar(out_var_names[i]);
 
@@ -60,26 +76,136 @@ class LoadCombineOp : public framework::OperatorBase {
       // Get data from fin to tensor
       DeserializeFromStream(fin, tensor, dev_ctx);
 
-      auto in_dtype = framework::ToDataType(tensor->type());
-      auto out_dtype =
-          load_as_fp16 ? framework::proto::VarType::FP16 : in_dtype;
-
-      if (in_dtype != out_dtype) {
-        // convert to float16 tensor
-        auto in_kernel_type = framework::OpKernelType(in_dtype, place);
-        auto out_kernel_type = framework::OpKernelType(out_dtype, place);
-        framework::LoDTensor fp16_tensor;
-        // copy LoD info to the new tensor
-        fp16_tensor.set_lod(tensor->lod());
-        framework::TransDataType(in_kernel_type, out_kernel_type, *tensor,
-                                 &fp16_tensor);
-
-        // reset output tensor
-        out_var->Clear();
-        tensor = out_var->GetMutable<framework::LoDTensor>();
-        tensor->set_lod(fp16_tensor.lod());
-        tensor->ShareDataWith(fp16_tensor);
+      MaybeConvertToFP16(out_var, place, load_as_fp16);
+    }
+  }
+
+  // Load the tensors of a mappable parameters file. On CPU the tensors
+  // reference the mapped file directly instead of being read and copied.
+  void LoadMapped(const framework::Scope &scope, const platform::Place &place,
+                  const std::string &filename,
+                  const std::vector<std::string> &out_var_names,
+                  bool load_as_fp16) const {
+    auto file = std::make_shared<framework::MappedFile>(filename);
+    size_t offset = framework::MappableParamsBegin(*file);
+    for (auto &name : out_var_names) {
+      auto *out_var = scope.FindVar(name);
+      PADDLE_ENFORCE(out_var != nullptr, "Output variable %s cannot be found",
+                     name);
+      auto *tensor = out_var->GetMutable<framework::LoDTensor>();
+      if (platform::is_cpu_place(place)) {
+        offset = framework::DeserializeFromMappedFile(file, offset, tensor);
+      } else {
+        framework::LoDTensor mapped;
+        offset = framework::DeserializeFromMappedFile(file, offset, &mapped);
+        framework::TensorCopySync(mapped, place, tensor);
+        tensor->set_lod(mapped.lod());
       }
+      MaybeConvertToFP16(out_var, place, load_as_fp16);
+    }
+  }
+
+  // Load the tensors of a sharded parameters file by their names, the shards
+  // in parallel. Only the tensors of out_var_names are read, so a pruned
+  // program loads its parameters from the file of the whole program.
+  void LoadSharded(const framework::Scope &scope, const platform::Place &place,
+                   const std::string &filename,
+                   const std::vector<std::string> &out_var_names,
+                   bool load_as_fp16) const {
+    std::vector<framework::ShardedParamsEntry> entries;
+    uint32_t num_shards = framework::ReadShardedParamsIndex(filename, &entries);
+    std::unordered_map<std::string, const framework::ShardedParamsEntry *>
+        index;
+    for (auto &entry : entries) {
+      index[entry.name] = &entry;
+    }
+
+    bool is_cpu = platform::is_cpu_place(place);
+    std::vector<const framework::ShardedParamsEntry *> out_entries;
+    std::vector<framework::LoDTensor *> out_tensors;
+    // The tensors are read to CPU in parallel, and copied to the device here.
+    std::vector<framework::LoDTensor> cpu_tensors(
+        is_cpu ? 0 : out_var_names.size());
+    for (size_t i = 0; i < out_var_names.size(); ++i) {
+      auto &name = out_var_names[i];
+      auto *out_var = scope.FindVar(name);
+      PADDLE_ENFORCE(out_var != nullptr, "Output variable %s cannot be found",
+                     name);
+      auto it = index.find(name);
+      PADDLE_ENFORCE(it != index.end(), "Variable %s is not saved in %s", name,
+                     filename);
+      out_entries.push_back(it->second);
+      out_tensors.push_back(is_cpu ? out_var->GetMutable<framework::LoDTensor>()
+                                   : &cpu_tensors[i]);
+    }
+
+    auto &cpu_ctx =
+        *platform::DeviceContextPool::Instance().Get(platform::CPUPlace());
+    auto read_shard = [&](uint32_t shard) {
+      auto path = framework::ShardedParamsShardPath(filename, shard);
+      std::ifstream fin;
+      bool opened = false;
+      for (size_t i = 0; i < out_entries.size(); ++i) {
+        if (out_entries[i]->shard != shard) continue;
+        if (!opened) {
+          fin.open(path, std::ios::in | std::ios::binary);
+          PADDLE_ENFORCE(static_cast<bool>(fin),
+                         "Cannot open file %s for load_combine op", path);
+          opened = true;
+        }
+        fin.seekg(static_cast<std::streamoff>(out_entries[i]->offset));
+        PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot read %s of file %s",
+                       out_var_names[i], path);
+        DeserializeFromStream(fin, out_tensors[i], cpu_ctx);
+      }
+    };
+
+    auto *io_pool = framework::ThreadPoolIO::GetInstanceIO();
+    std::vector<std::future<std::unique_ptr<platform::EnforceNotMet>>> futures;
+    for (uint32_t shard = 0; shard < num_shards; ++shard) {
+      futures.emplace_back(io_pool->RunAndGetException(
+          [&read_shard, shard] { read_shard(shard); }));
+    }
+    std::unique_ptr<platform::EnforceNotMet> error;
+    for (auto &f : futures) {
+      auto ex = f.get();
+      if (ex != nullptr && error == nullptr) error = std::move(ex);
+    }
+    if (error != nullptr) throw *error;
+
+    for (size_t i = 0; i < out_var_names.size(); ++i) {
+      auto *out_var = scope.FindVar(out_var_names[i]);
+      if (!is_cpu) {
+        auto *tensor = out_var->GetMutable<framework::LoDTensor>();
+        framework::TensorCopySync(cpu_tensors[i], place, tensor);
+        tensor->set_lod(cpu_tensors[i].lod());
+      }
+      MaybeConvertToFP16(out_var, place, load_as_fp16);
+    }
+  }
+
+  void MaybeConvertToFP16(framework::Variable *out_var,
+                          const platform::Place &place,
+                          bool load_as_fp16) const {
+    auto *tensor = out_var->GetMutable<framework::LoDTensor>();
+    auto in_dtype = framework::ToDataType(tensor->type());
+    auto out_dtype = load_as_fp16 ? framework::proto::VarType::FP16 : in_dtype;
+
+    if (in_dtype != out_dtype) {
+      // convert to float16 tensor
+      auto in_kernel_type = framework::OpKernelType(in_dtype, place);
+      auto out_kernel_type = framework::OpKernelType(out_dtype, place);
+      framework::LoDTensor fp16_tensor;
+      // copy LoD info to the new tensor
+      fp16_tensor.set_lod(tensor->lod());
+      framework::TransDataType(in_kernel_type, out_kernel_type, *tensor,
+                               &fp16_tensor);
+
+      // reset output tensor
+      out_var->Clear();
+      tensor = out_var->GetMutable<framework::LoDTensor>();
+      tensor->set_lod(fp16_tensor.lod());
+      tensor->ShareDataWith(fp16_tensor);
     }
   }
 };
@@ -114,6 +240,13 @@ in the SaveCombine operator. Hence, the LoadCombine operator is tightly coupled
 with the SaveCombine operator, and can only deserialize one or more LoDTensors 
 that were saved using the SaveCombine operator.
 
+The files saved with page_aligned are mapped into memory, and on CPU the
+loaded LoDTensors reference the mapped memory instead of a copy of it.
+
+The files saved with num_shards are read in parallel, one shard per thread.
+The LoDTensors are found by their names in the index of the file, so any of
+the LoDTensors saved in the file could be loaded, in any order.
+
 )DOC");
   }
 };
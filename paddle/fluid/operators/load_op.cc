@@ -11,10 +11,12 @@ distributed under the License is distributed on an "AS IS" BASIS,
 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
+#include <cstring>
 #include <fstream>
 
 #include "paddle/fluid/framework/data_type_transform.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/checkpoint_writer.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/profiler.h"
 
@@ -31,6 +33,9 @@ class LoadOp : public framework::OperatorBase {
  private:
   void RunImpl(const framework::Scope &scope,
                const platform::Place &place) const override {
+    // The file may be being written by an async save op.
+    AsyncCheckpointWriter::Instance().Wait();
+
     // FIXME(yuyang18): We save variable to local file now, but we should change
     // it to save an output stream.
     auto filename = Attr<std::string>("file_path");
@@ -91,9 +96,41 @@ class LoadOp : public framework::OperatorBase {
     // get device context from pool
     platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
     auto &dev_ctx = *pool.Get(place);
+    if (Attr<bool>("merge") && selectedRows->value().IsInitialized()) {
+      MergeSelectedRows(fin, dev_ctx, selectedRows);
+      return;
+    }
     framework::DeserializeFromStream(fin, selectedRows, dev_ctx);
     selectedRows->SyncIndex();
   }
+
+  // Write the rows of the file, e.g. an incremental checkpoint, into the
+  // table, where the rows not in the table are added.
+  void MergeSelectedRows(std::istream &fin,
+                         const platform::DeviceContext &dev_ctx,
+                         framework::SelectedRows *table) const {
+    framework::SelectedRows rows;
+    framework::DeserializeFromStream(fin, &rows, dev_ctx);
+    PADDLE_ENFORCE(platform::is_cpu_place(table->place()),
+                   "Only the sparse table on CPU could be merged into");
+    PADDLE_ENFORCE_EQ(rows.value().type(), table->value().type());
+    PADDLE_ENFORCE_EQ(
+        rows.value().numel() * table->value().dims()[0],
+        table->value().numel() * static_cast<int64_t>(rows.rows().size()),
+        "The rows should have the same width as the table");
+    if (rows.rows().empty()) {
+      return;
+    }
+    size_t row_bytes = rows.value().numel() / rows.rows().size() *
+                       framework::SizeOfType(rows.value().type());
+    auto *src = static_cast<const char *>(rows.value().data<void>());
+    auto *dst = static_cast<char *>(table->mutable_value()->mutable_data(
+        platform::CPUPlace(), table->value().type()));
+    for (size_t i = 0; i < rows.rows().size(); ++i) {
+      int64_t index = table->AutoGrownIndex(rows.rows()[i], true);
+      std::memcpy(dst + index * row_bytes, src + i * row_bytes, row_bytes);
+    }
+  }
 };
 
 class LoadOpProtoMaker : public framework::OpProtoAndCheckerMaker {
@@ -106,6 +143,12 @@ class LoadOpProtoMaker : public framework::OpProtoAndCheckerMaker {
         "converted to float16 data type. Otherwise, the tensor will be "
         "directly loaded without data type conversion. Default is false.")
         .SetDefault(false);
+    AddAttr<bool>("merge",
+                  "For SelectedRows. If true, the rows of the file are "
+                  "written into the existing table instead of replacing it, "
+                  "to apply the incremental checkpoints saved by the save op "
+                  "with incremental=true. Default is false.")
+        .SetDefault(false);
     AddAttr<std::string>("file_path",
                          R"(Variable will be loaded from "file_path")")
         .AddCustomChecker(
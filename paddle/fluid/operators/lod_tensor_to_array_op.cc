@@ -131,32 +131,60 @@ class LoDTensorToArrayOp : public framework::OperatorBase {
       }
     }
 
+    // The steps are laid out one after another in a single time-major buffer,
+    // out[i] is the view of the rows of the i-th step in it. The rows are
+    // gathered into the buffer at once, and not at all if the time-major
+    // order is the order of x, e.g. for a single sequence.
+    size_t total_height = 0;
+    bool in_order = true;
+    for (auto &ranges : copy_ranges) {
+      for (auto &each_range : ranges) {
+        if (each_range.end == each_range.begin) continue;
+        in_order &= each_range.begin == total_height;
+        total_height += each_range.end - each_range.begin;
+      }
+    }
+    framework::Tensor buffer;
+    if (in_order) {
+      buffer.ShareDataWith(x);
+    } else {
+      auto x_dim = x.dims();
+      x_dim[0] = static_cast<int64_t>(total_height);
+      buffer.Resize(x_dim);
+      buffer.mutable_data(x.place(), x.type());
+    }
+
     auto &outputs = *const_cast<framework::Scope &>(scope)
                          .Var()
                          ->GetMutable<std::map<size_t, framework::Tensor>>();
 
+    size_t offset = 0;
     for (size_t i = 0; i < max_seq_len; ++i) {
-      auto &ranges = copy_ranges[i];
-      size_t height = std::accumulate(
-          ranges.begin(), ranges.end(), 0UL,
-          [](size_t a, const CopyRange &b) { return a + b.end - b.begin; });
-      auto x_dim = x.dims();
-      x_dim[0] = static_cast<int64_t>(height);
-      out[i].Resize(x_dim);
-      out[i].mutable_data(x.place(), x.type());
-      size_t offset = 0;
-      for (auto &each_range : ranges) {
+      size_t begin = offset;
+      for (auto &each_range : copy_ranges[i]) {
         size_t len = each_range.end - each_range.begin;
         if (len == 0) {
           continue;
         }
-        // out[i][offset: offset+len] = x[each_range.begin: each_range.end]
-        auto slice = out[i].Slice(static_cast<int>(offset),
-                                  static_cast<int>(offset + len));
-        outputs.insert({each_range.begin, slice});
+        // buffer[offset: offset+len] = x[each_range.begin: each_range.end]
+        if (!in_order) {
+          outputs.insert({each_range.begin,
+                          buffer.Slice(static_cast<int>(offset),
+                                       static_cast<int>(offset + len))});
+        }
         offset += len;
       }
+      if (offset > begin) {
+        out[i].ShareDataWith(
+            buffer.Slice(static_cast<int>(begin), static_cast<int>(offset)));
+      } else {
+        auto x_dim = x.dims();
+        x_dim[0] = 0;
+        out[i].Resize(x_dim);
+        out[i].mutable_data(x.place(), x.type());
+      }
     }
+    if (in_order) return;
 
     LoDTensorToArrayFunctor functor(x);
     for (auto &out_pair : outputs) {
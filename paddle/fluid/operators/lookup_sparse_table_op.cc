@@ -14,10 +14,20 @@ limitations under the License. */
 
 #include <algorithm>
 
+#include <gflags/gflags.h>
+
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/math_function.h"
 
+DEFINE_int64(sparse_table_evict_min_freq, 0,
+             "Evict the rows of the sparse tables accessed less than this "
+             "times when the tables are full, 0 means disabled.");
+DEFINE_int64(sparse_table_evict_ttl, 0,
+             "Evict the rows of the sparse tables not accessed for this "
+             "seconds when the tables are full, 0 means disabled.");
+DECLARE_string(sparse_table_spill_dir);
+
 namespace paddle {
 namespace operators {
 
@@ -65,6 +75,15 @@ class LookupSparseTableOp : public framework::OperatorBase {
     PADDLE_ENFORCE_EQ(framework::ToDataType(w_t->value().type()),
                       framework::proto::VarType::FP32,
                       "The sparse table only support FP32");
+    if (!w_t->EvictionEnabled() && (FLAGS_sparse_table_evict_min_freq > 0 ||
+                                    FLAGS_sparse_table_evict_ttl > 0)) {
+      w_t->EnableEviction(FLAGS_sparse_table_evict_min_freq,
+                          FLAGS_sparse_table_evict_ttl,
+                          FLAGS_sparse_table_spill_dir);
+    }
+    if (w_t->NeedEvict(ids_t.numel())) {
+      w_t->EvictRows();
+    }
     w_t->Get(ids_t, out_t, true);
   }
 };
@@ -40,7 +40,11 @@ class LookupTableOp : public framework::OperatorWithKernel {
 
     auto output_dims =
         framework::vectorize(framework::slice_ddim(ids_dims, 0, ids_rank - 1));
-    output_dims.push_back(table_dims[1]);
+    int64_t row_width = table_dims[1];
+    if (ctx->Attrs().Get<std::string>("table_format") == kTableInt8Rowwise) {
+      row_width -= kInt8RowwiseExtraBytes;
+    }
+    output_dims.push_back(row_width);
     ctx->SetOutputDim("Out", framework::make_ddim(output_dims));
 
     if (ctx->GetOutputsVarType("Out")[0] ==
@@ -52,7 +56,10 @@ class LookupTableOp : public framework::OperatorWithKernel {
  protected:
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext& ctx) const override {
-    auto data_type = framework::GetDataTypeOfVar(ctx.InputVar("W"));
+    // The quantized tables are looked up to float.
+    auto data_type = ctx.Attr<std::string>("table_format").empty()
+                         ? framework::GetDataTypeOfVar(ctx.InputVar("W"))
+                         : framework::proto::VarType::FP32;
     return framework::OpKernelType(data_type, ctx.device_context());
   }
 };
@@ -87,6 +94,14 @@ class LookupTableOpMaker : public framework::OpProtoAndCheckerMaker {
                   "(boolean, default false) "
                   "If the grad op reuse the input's variable.")
         .SetDefault(false);
+    AddAttr<std::string>("table_format",
+                         "(string, default \"\") "
+                         "The format of W quantized for inference, "
+                         "\"float16\" or \"int8_rowwise\", whose rows are "
+                         "the uint8 codes followed by the float scale and "
+                         "bias of the row. Out is float for both. Empty if W "
+                         "is not quantized.")
+        .SetDefault("");
     AddComment(R"DOC(
 Lookup Table Operator.
 
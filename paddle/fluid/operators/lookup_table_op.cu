@@ -77,6 +77,8 @@ class LookupTableCUDAKernel : public framework::OpKernel<T> {
     auto *ids_t = context.Input<LoDTensor>("Ids");
     auto *output_t = context.Output<LoDTensor>("Out");
     int64_t padding_idx = context.Attr<int64_t>("padding_idx");
+    PADDLE_ENFORCE(context.Attr<std::string>("table_format").empty(),
+                   "The quantized tables are only looked up on CPU");
 
     size_t N = table_t->dims()[0];
     size_t D = table_t->dims()[1];
@@ -14,14 +14,18 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/operators/gather.h"
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/platform/float16.h"
 
 namespace paddle {
 namespace operators {
@@ -33,6 +37,67 @@ using DDim = framework::DDim;
 
 constexpr int64_t kNoPadding = -1;
 
+// The formats of the tables quantized for inference, which are dequantized
+// when the rows are gathered.
+constexpr char kTableFloat16[] = "float16";
+// A row is the uint8 codes of its elements followed by the float scale and
+// bias of the row, the value of the code c is c * scale + bias.
+constexpr char kTableInt8Rowwise[] = "int8_rowwise";
+constexpr int64_t kInt8RowwiseExtraBytes = 2 * sizeof(float);
+
+/*
+ * Gather the rows ids of a quantized table of the format to the rows of
+ * output, which are zeros for the padding_idx.
+ */
+template <typename T>
+void DequantizeRows(const platform::CPUDeviceContext &dev_ctx,
+                    const LoDTensor &table, const std::string &format,
+                    const int64_t *ids, int64_t ids_numel,
+                    int64_t padding_idx, int64_t row_width, T *output) {
+  if (format == kTableFloat16) {
+    const auto *data = table.data<platform::float16>();
+    dev_ctx.ParallelFor(
+        ids_numel,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            T *dst = output + i * row_width;
+            if (ids[i] == padding_idx) {
+              std::fill(dst, dst + row_width, static_cast<T>(0));
+              continue;
+            }
+            const auto *src = data + ids[i] * row_width;
+            for (int64_t j = 0; j < row_width; ++j) {
+              dst[j] = static_cast<T>(static_cast<float>(src[j]));
+            }
+          }
+        },
+        row_width);
+  } else if (format == kTableInt8Rowwise) {
+    const auto *data = table.data<uint8_t>();
+    const int64_t row_bytes = row_width + kInt8RowwiseExtraBytes;
+    dev_ctx.ParallelFor(
+        ids_numel,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            T *dst = output + i * row_width;
+            if (ids[i] == padding_idx) {
+              std::fill(dst, dst + row_width, static_cast<T>(0));
+              continue;
+            }
+            const uint8_t *codes = data + ids[i] * row_bytes;
+            float scale_bias[2];
+            memcpy(scale_bias, codes + row_width, sizeof(scale_bias));
+            for (int64_t j = 0; j < row_width; ++j) {
+              dst[j] = static_cast<T>(codes[j] * scale_bias[0] + scale_bias[1]);
+            }
+          }
+        },
+        row_width);
+  } else {
+    PADDLE_THROW("Unknown table_format %s of lookup_table", format);
+  }
+}
+
 template <typename T>
 class LookupTableKernel : public framework::OpKernel<T> {
  public:
@@ -42,6 +107,7 @@ class LookupTableKernel : public framework::OpKernel<T> {
     auto *table_var = context.InputVar("W");
 
     int64_t padding_idx = context.Attr<int64_t>("padding_idx");
+    auto table_format = context.Attr<std::string>("table_format");
     int64_t *ids = const_cast<int64_t *>(ids_t->data<int64_t>());
     int64_t ids_numel = ids_t->numel();
 
@@ -49,21 +115,49 @@ class LookupTableKernel : public framework::OpKernel<T> {
       auto *table_t = context.Input<LoDTensor>("W");
       int64_t row_number = table_t->dims()[0];
       int64_t row_width = table_t->dims()[1];
+      if (table_format == kTableInt8Rowwise) {
+        row_width -= kInt8RowwiseExtraBytes;
+      }
 
-      auto *table = table_t->data<T>();
       auto *output = output_t->mutable_data<T>(context.GetPlace());
 
+      bool has_padding = false;
       for (int64_t i = 0; i < ids_numel; ++i) {
         if (padding_idx != kNoPadding && ids[i] == padding_idx) {
-          memset(output + i * row_width, 0, row_width * sizeof(T));
+          has_padding = true;
         } else {
           PADDLE_ENFORCE_LT(ids[i], row_number);
           PADDLE_ENFORCE_GE(ids[i], 0, "ids %d", i);
-          memcpy(output + i * row_width, table + ids[i] * row_width,
-                 row_width * sizeof(T));
         }
       }
+      auto &dev_ctx =
+          context.template device_context<platform::CPUDeviceContext>();
+      if (!table_format.empty()) {
+        DequantizeRows(dev_ctx, *table_t, table_format, ids, ids_numel,
+                       padding_idx, row_width, output);
+        return;
+      }
+      auto *table = table_t->data<T>();
+      if (!has_padding) {
+        GatherRows(dev_ctx, table, ids, ids_numel, row_width, output);
+      } else {
+        dev_ctx.ParallelFor(
+            ids_numel,
+            [&](int64_t begin, int64_t end) {
+              for (int64_t i = begin; i < end; ++i) {
+                if (ids[i] == padding_idx) {
+                  memset(output + i * row_width, 0, row_width * sizeof(T));
+                } else {
+                  memcpy(output + i * row_width, table + ids[i] * row_width,
+                         row_width * sizeof(T));
+                }
+              }
+            },
+            row_width);
+      }
     } else if (table_var->IsType<SelectedRows>()) {
+      PADDLE_ENFORCE(table_format.empty(),
+                     "The SelectedRows table can not be quantized");
       const auto &table_t = table_var->Get<SelectedRows>();
       int64_t row_width = table_t.value().dims()[1];
       const auto *table = table_t.value().data<T>();
@@ -85,6 +179,60 @@ class LookupTableKernel : public framework::OpKernel<T> {
   }
 };
 
+/*
+ * Write the sparse gradient of the rows ids with the gradients d_output of
+ * the lookups, already merged: the rows are sorted and unique, and the
+ * gradients of a row are summed in the order of the lookups.
+ */
+template <typename T>
+void MergeRowsGrad(const platform::CPUDeviceContext &dev_ctx,
+                   const int64_t *ids, int64_t ids_num, int64_t row_width,
+                   const T *d_output, SelectedRows *d_table) {
+  std::vector<std::pair<int64_t, int64_t>> order(ids_num);
+  for (int64_t i = 0; i < ids_num; ++i) {
+    order[i] = std::make_pair(ids[i], i);
+  }
+  std::sort(order.begin(), order.end());
+  std::vector<int64_t> rows;
+  std::vector<int64_t> starts;
+  for (int64_t i = 0; i < ids_num; ++i) {
+    if (i == 0 || order[i].first != order[i - 1].first) {
+      rows.push_back(order[i].first);
+      starts.push_back(i);
+    }
+  }
+  starts.push_back(ids_num);
+
+  auto *value = d_table->mutable_value();
+  value->Resize({static_cast<int64_t>(rows.size()), row_width});
+  T *value_data = value->mutable_data<T>(dev_ctx.GetPlace());
+  const size_t row_bytes = row_width * sizeof(T);
+  dev_ctx.ParallelFor(
+      static_cast<int64_t>(rows.size()),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t r = begin; r < end; ++r) {
+          if (r + kGatherPrefetchDistance < end) {
+            PrefetchRow(
+                d_output +
+                    order[starts[r + kGatherPrefetchDistance]].second *
+                        row_width,
+                row_bytes);
+          }
+          T *dst = value_data + r * row_width;
+          memcpy(dst, d_output + order[starts[r]].second * row_width,
+                 row_bytes);
+          for (int64_t i = starts[r] + 1; i < starts[r + 1]; ++i) {
+            const T *src = d_output + order[i].second * row_width;
+            for (int64_t j = 0; j < row_width; ++j) {
+              dst[j] += src[j];
+            }
+          }
+        }
+      },
+      ids_num / std::max<int64_t>(rows.size(), 1) * row_width);
+  d_table->set_rows(rows);
+}
+
 template <typename T>
 class LookupTableGradKernel : public framework::OpKernel<T> {
  public:
@@ -113,13 +261,7 @@ class LookupTableGradKernel : public framework::OpKernel<T> {
       auto *ids_data = ids->data<int64_t>();
       int64_t ids_num = ids->numel();
 
-      std::vector<int64_t> new_rows;
-      new_rows.resize(ids_num);
-      std::memcpy(&new_rows[0], ids_data, ids_num * sizeof(int64_t));
-      d_table->set_rows(new_rows);
-
       auto *d_table_value = d_table->mutable_value();
-      d_table_value->Resize({ids_num, table_dim[1]});
       // FIXME(minqiyang):
       // memory optimization will NOT reuse Tensor with SelectedRows
       // so we could just share the tensor here directly.
@@ -129,20 +271,19 @@ class LookupTableGradKernel : public framework::OpKernel<T> {
       // the InferVarType's bug was fixed
       bool grad_inplace = context.Attr<bool>("grad_inplace");
       if (grad_inplace) {
+        std::vector<int64_t> new_rows(ids_data, ids_data + ids_num);
+        d_table->set_rows(new_rows);
+        d_table_value->Resize({ids_num, table_dim[1]});
         d_table_value->ShareDataWith(*d_output);
       } else {
-        d_table_value->mutable_data<T>(context.GetPlace());
-
-        d_table->set_height(table_dim[0]);
-
-        auto *d_output_data = d_output->data<T>();
-        auto *d_table_data = d_table_value->data<T>();
-
         auto d_output_dims = d_output->dims();
         PADDLE_ENFORCE_EQ(
-            d_table_value->dims(),
+            framework::make_ddim({ids_num, table_dim[1]}),
             framework::flatten_to_2d(d_output_dims, d_output_dims.size() - 1));
-        memcpy(d_table_data, d_output_data, sizeof(T) * d_output->numel());
+        d_table->set_height(table_dim[0]);
+        MergeRowsGrad(
+            context.template device_context<platform::CPUDeviceContext>(),
+            ids_data, ids_num, table_dim[1], d_output->data<T>(), d_table);
       }
     } else {
       auto *ids = context.Input<LoDTensor>("Ids");
@@ -0,0 +1,129 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <map>
+#include <random>
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/selected_rows.h"
+
+USE_OP(lookup_table);
+
+namespace paddle {
+namespace operators {
+
+constexpr int64_t kRows = 1000;
+constexpr int64_t kWidth = 16;
+constexpr int64_t kNumIds = 5000;
+
+void PrepareInputs(framework::Scope* scope, std::vector<int64_t>* ids) {
+  platform::CPUPlace place;
+  std::mt19937 rng(100);
+  std::uniform_int_distribution<int64_t> id_dist(0, kRows - 1);
+  std::uniform_real_distribution<float> value_dist(-1, 1);
+
+  auto* table = scope->Var("W")->GetMutable<framework::LoDTensor>();
+  float* table_data = table->mutable_data<float>({kRows, kWidth}, place);
+  for (int64_t i = 0; i < kRows * kWidth; ++i) {
+    table_data[i] = value_dist(rng);
+  }
+  auto* ids_t = scope->Var("Ids")->GetMutable<framework::LoDTensor>();
+  int64_t* ids_data = ids_t->mutable_data<int64_t>({kNumIds, 1}, place);
+  ids->resize(kNumIds);
+  for (int64_t i = 0; i < kNumIds; ++i) {
+    ids_data[i] = (*ids)[i] = id_dist(rng);
+  }
+  auto* d_out = scope->Var("Out@GRAD")->GetMutable<framework::LoDTensor>();
+  float* d_out_data = d_out->mutable_data<float>({kNumIds, kWidth}, place);
+  for (int64_t i = 0; i < kNumIds * kWidth; ++i) {
+    d_out_data[i] = value_dist(rng);
+  }
+}
+
+TEST(LookupTableOp, gather_with_padding) {
+  framework::Scope scope;
+  platform::CPUPlace place;
+  std::vector<int64_t> ids;
+  PrepareInputs(&scope, &ids);
+  scope.Var("Out")->GetMutable<framework::LoDTensor>();
+
+  for (int64_t padding_idx : {static_cast<int64_t>(-1), ids[7]}) {
+    framework::AttributeMap attrs;
+    attrs.insert({"padding_idx", padding_idx});
+    auto op = framework::OpRegistry::CreateOp(
+        "lookup_table", {{"W", {"W"}}, {"Ids", {"Ids"}}}, {{"Out", {"Out"}}},
+        attrs);
+    op->Run(scope, place);
+
+    auto& table = scope.FindVar("W")->Get<framework::LoDTensor>();
+    auto& out = scope.FindVar("Out")->Get<framework::LoDTensor>();
+    ASSERT_EQ(out.numel(), kNumIds * kWidth);
+    for (int64_t i = 0; i < kNumIds; ++i) {
+      for (int64_t j = 0; j < kWidth; ++j) {
+        float expected = ids[i] == padding_idx
+                             ? 0.f
+                             : table.data<float>()[ids[i] * kWidth + j];
+        ASSERT_EQ(out.data<float>()[i * kWidth + j], expected);
+      }
+    }
+  }
+}
+
+TEST(LookupTableGradOp, merged_sparse_grad) {
+  framework::Scope scope;
+  platform::CPUPlace place;
+  std::vector<int64_t> ids;
+  PrepareInputs(&scope, &ids);
+  scope.Var("W@GRAD")->GetMutable<framework::SelectedRows>();
+
+  framework::AttributeMap attrs;
+  attrs.insert({"is_sparse", true});
+  attrs.insert({"grad_inplace", false});
+  auto op = framework::OpRegistry::CreateOp(
+      "lookup_table_grad",
+      {{"W", {"W"}}, {"Ids", {"Ids"}}, {"Out@GRAD", {"Out@GRAD"}}},
+      {{"W@GRAD", {"W@GRAD"}}}, attrs);
+  op->Run(scope, place);
+
+  // the gradients summed in the order of the ids
+  std::map<int64_t, std::vector<float>> expected;
+  auto& d_out = scope.FindVar("Out@GRAD")->Get<framework::LoDTensor>();
+  for (int64_t i = 0; i < kNumIds; ++i) {
+    auto& row = expected[ids[i]];
+    row.resize(kWidth, 0.f);
+    for (int64_t j = 0; j < kWidth; ++j) {
+      row[j] += d_out.data<float>()[i * kWidth + j];
+    }
+  }
+
+  auto& d_table = scope.FindVar("W@GRAD")->Get<framework::SelectedRows>();
+  EXPECT_EQ(d_table.height(), kRows);
+  ASSERT_EQ(d_table.rows().size(), expected.size());
+  ASSERT_EQ(d_table.value().dims()[0],
+            static_cast<int64_t>(expected.size()));
+  size_t r = 0;
+  for (auto& pair : expected) {
+    ASSERT_EQ(d_table.rows()[r], pair.first);
+    for (int64_t j = 0; j < kWidth; ++j) {
+      EXPECT_FLOAT_EQ(d_table.value().data<float>()[r * kWidth + j],
+                      pair.second[j]);
+    }
+    ++r;
+  }
+}
+
+}  // namespace operators
+}  // namespace paddle
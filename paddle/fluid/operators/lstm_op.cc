@@ -178,6 +178,12 @@ class LSTMOpMaker : public framework::OpProtoAndCheckerMaker {
                          "`tanh` by default.")
         .SetDefault("tanh")
         .InEnum({"sigmoid", "tanh", "relu", "identity"});
+    AddAttr<bool>("use_persistent_kernel",
+                  "(bool, default: False) "
+                  "whether to compute all the steps by one persistent kernel. "
+                  "Only used on GPU when the hidden size is no larger than "
+                  "256, which saves the launches of the long sequences.")
+        .SetDefault(false);
     AddComment(R"DOC(
 Long-Short Term Memory (LSTM) Operator.
 
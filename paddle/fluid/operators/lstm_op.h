@@ -114,8 +114,27 @@ class LSTMKernel : public framework::OpKernel<T> {
     auto cand_act = math::detail::GetActivationType(
         ctx.Attr<std::string>("candidate_activation"));
 
+    bool computed = false;
+    if (ctx.Attr<bool>("use_persistent_kernel")) {
+      Tensor ordered_h0;
+      if (hidden_t0) {
+        ReorderInitState<DeviceContext, T>(device_ctx, *hidden_t0, order,
+                                           &ordered_h0, true);
+      }
+      lstm_value.gate_value = batch_gate->data<T>();
+      lstm_value.output_value = batch_hidden.data<T>();
+      lstm_value.state_value = batch_cell.data<T>();
+      lstm_value.state_active_value = batch_cell_pre_act->data<T>();
+      computed = math::PersistentLstmFunctor<DeviceContext, T>::compute(
+          device_ctx, lstm_value, weight->data<T>(),
+          hidden_t0 ? ordered_h0.data<T>() : nullptr, batch_starts,
+          static_cast<int>(order.size()), frame_size, gate_act, cell_act,
+          cand_act);
+    }
+
     auto blas = math::GetBlas<DeviceContext, T>(device_ctx);
-    for (size_t n = 0; n < num_batch; n++) {
+    // step by step if the persistent kernel is not available
+    for (size_t n = 0; !computed && n < num_batch; n++) {
       int bstart = static_cast<int>(batch_starts[n]);
       int bend = static_cast<int>(batch_starts[n + 1]);
 
@@ -15,6 +15,7 @@
 #include <limits>
 #include <vector>
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/platform/bfloat16.h"
 
 namespace paddle {
 namespace operators {
@@ -250,6 +251,135 @@ struct CBlas<platform::float16> {
 #endif
 };
 
+// The bfloat16 GEMM converts the matrices to float and accumulates the
+// products in float by the float GEMM, only the result is rounded to
+// bfloat16.
+template <>
+struct CBlas<platform::bfloat16> {
+  template <typename ORDER>
+  static void GEMM(ORDER order, CBLAS_TRANSPOSE trans_a,
+                   CBLAS_TRANSPOSE trans_b, int M, int N, int K,
+                   platform::bfloat16 alpha, const platform::bfloat16 *A,
+                   int lda, const platform::bfloat16 *B, int ldb,
+                   platform::bfloat16 beta, platform::bfloat16 *C, int ldc) {
+    int a_rows = trans_a == CblasNoTrans ? M : K;
+    int a_cols = trans_a == CblasNoTrans ? K : M;
+    int b_rows = trans_b == CblasNoTrans ? K : N;
+    int b_cols = trans_b == CblasNoTrans ? N : K;
+    std::vector<float> a(static_cast<size_t>(a_rows) * a_cols);
+    std::vector<float> b(static_cast<size_t>(b_rows) * b_cols);
+    std::vector<float> c(static_cast<size_t>(M) * N);
+    ToFloat(A, a_rows, a_cols, lda, a.data());
+    ToFloat(B, b_rows, b_cols, ldb, b.data());
+    float f_beta = static_cast<float>(beta);
+    if (f_beta != 0.f) {
+      ToFloat(C, M, N, ldc, c.data());
+    }
+    CBlas<float>::GEMM(order, trans_a, trans_b, M, N, K,
+                       static_cast<float>(alpha), a.data(), a_cols, b.data(),
+                       b_cols, f_beta, c.data(), N);
+    for (int i = 0; i < M; ++i) {
+      platform::FloatToBFloat16(c.data() + i * N, C + i * ldc, N);
+    }
+  }
+
+  template <typename ORDER>
+  static void GEMV(ORDER order, CBLAS_TRANSPOSE trans_a, int M, int N,
+                   platform::bfloat16 alpha, const platform::bfloat16 *A,
+                   int lda, const platform::bfloat16 *X, int incx,
+                   platform::bfloat16 beta, platform::bfloat16 *Y, int incy) {
+    PADDLE_ENFORCE(incx == 1 && incy == 1,
+                   "bfloat16 GEMV only supports the contiguous vectors");
+    int x_size = trans_a == CblasNoTrans ? N : M;
+    int y_size = trans_a == CblasNoTrans ? M : N;
+    std::vector<float> a(static_cast<size_t>(M) * N);
+    std::vector<float> x(x_size);
+    std::vector<float> y(y_size);
+    ToFloat(A, M, N, lda, a.data());
+    platform::BFloat16ToFloat(X, x.data(), x_size);
+    float f_beta = static_cast<float>(beta);
+    if (f_beta != 0.f) {
+      platform::BFloat16ToFloat(Y, y.data(), y_size);
+    }
+    CBlas<float>::GEMV(order, trans_a, M, N, static_cast<float>(alpha),
+                       a.data(), N, x.data(), 1, f_beta, y.data(), 1);
+    platform::FloatToBFloat16(y.data(), Y, y_size);
+  }
+
+  static void AXPY(int n, platform::bfloat16 alpha,
+                   const platform::bfloat16 *x, int incx,
+                   platform::bfloat16 *y, int incy) {
+    float f_alpha = static_cast<float>(alpha);
+    for (int i = 0; i < n; ++i) {
+      float xi = static_cast<float>(x[i * incx]);
+      float yi = static_cast<float>(y[i * incy]);
+      y[i * incy] = platform::bfloat16(yi + f_alpha * xi);
+    }
+  }
+
+  static void VCOPY(int n, const platform::bfloat16 *x, int incx,
+                    platform::bfloat16 *y, int incy) {
+    for (int i = 0; i < n; ++i) {
+      y[i * incy] = x[i * incx];
+    }
+  }
+
+  static void VADD(int n, const platform::bfloat16 *x,
+                   const platform::bfloat16 *y, platform::bfloat16 *z) {
+    for (int i = 0; i < n; ++i) {
+      z[i] = x[i] + y[i];
+    }
+  }
+
+  static void VMUL(int n, const platform::bfloat16 *x,
+                   const platform::bfloat16 *y, platform::bfloat16 *z) {
+    for (int i = 0; i < n; ++i) {
+      z[i] = x[i] * y[i];
+    }
+  }
+
+  static void VEXP(int n, const platform::bfloat16 *x, platform::bfloat16 *y) {
+    for (int i = 0; i < n; ++i) {
+      y[i] = platform::bfloat16(std::exp(static_cast<float>(x[i])));
+    }
+  }
+
+  static platform::bfloat16 DOT(int n, const platform::bfloat16 *x, int incx,
+                                const platform::bfloat16 *y, int incy) {
+    float sum = 0.f;
+    for (int i = 0; i < n; ++i) {
+      sum += static_cast<float>(x[i * incx]) * static_cast<float>(y[i * incy]);
+    }
+    return platform::bfloat16(sum);
+  }
+
+  static void SCAL(int n, platform::bfloat16 a, platform::bfloat16 *x,
+                   int incx) {
+    for (int i = 0; i < n; ++i) {
+      x[i * incx] = a * x[i * incx];
+    }
+  }
+
+  static void SMM_GEMM(...) {
+    PADDLE_THROW("bfloat16 SMM_GEMM not supported on CPU");
+  }
+#ifdef PADDLE_WITH_MKLML
+  static void GEMM_BATCH(...) {
+    PADDLE_THROW("bfloat16 GEMM_BATCH not supported on CPU");
+  }
+#endif
+
+ private:
+  // Copy the rows x cols matrix of the leading dimension ld to the dense
+  // float matrix out.
+  static void ToFloat(const platform::bfloat16 *in, int rows, int cols, int ld,
+                      float *out) {
+    for (int i = 0; i < rows; ++i) {
+      platform::BFloat16ToFloat(in + i * ld, out + i * cols, cols);
+    }
+  }
+};
+
 #ifdef PADDLE_WITH_MKLML
 template <>
 template <typename T>
@@ -367,7 +497,7 @@ void Blas<platform::CPUDeviceContext>::VADD(int n, const T *x, const T *y,
   CBlas<T>::VADD(n, x, y, z);
 #else
   this->template VCOPY<T>(n, y, z);
-  this->template AXPY<T>(n, 1., x, z);
+  this->template AXPY<T>(n, static_cast<T>(1), x, z);
 #endif
 }
 
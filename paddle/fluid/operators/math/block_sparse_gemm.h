@@ -0,0 +1,249 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The attribute of mul and fc, set by the inference analyzer to the size of
+// the blocks of a constant sparse weight, 0 if the weight is dense.
+constexpr char kWeightBlockSize[] = "weight_block_size";
+// The suffix of the variable caching the block-sparse weight in its scope.
+constexpr char kBlockSparseSuffix[] = "@BLOCK_SPARSE";
+
+/*
+ * A k x n weight in the block compressed sparse row format. A block is
+ * block_size consecutive elements of a row, the weights of an input to
+ * block_size consecutive outputs, and only the blocks having a nonzero are
+ * kept. The blocks of the row i are [row_offsets[i], row_offsets[i + 1]), the
+ * block b starts at the column block_cols[b] * block_size and its elements
+ * are values[b * block_size, (b + 1) * block_size).
+ */
+template <typename T>
+class BlockSparseMatrix {
+ public:
+  BlockSparseMatrix() = default;
+  BlockSparseMatrix(const BlockSparseMatrix&) = delete;
+  BlockSparseMatrix& operator=(const BlockSparseMatrix&) = delete;
+
+  // n must be a multiple of block_size.
+  void FromDense(const T* w, int64_t k, int64_t n, int block_size) {
+    PADDLE_ENFORCE(block_size > 0 && n % block_size == 0,
+                   "The width %d is not a multiple of the block size %d", n,
+                   block_size);
+    k_ = k;
+    n_ = n;
+    block_size_ = block_size;
+    row_offsets_.assign(1, 0);
+    block_cols_.clear();
+    values_.clear();
+    for (int64_t i = 0; i < k; ++i) {
+      for (int64_t c = 0; c < n / block_size; ++c) {
+        const T* block = w + i * n + c * block_size;
+        if (std::all_of(block, block + block_size,
+                        [](T v) { return v == static_cast<T>(0); })) {
+          continue;
+        }
+        block_cols_.push_back(static_cast<int32_t>(c));
+        values_.insert(values_.end(), block, block + block_size);
+      }
+      row_offsets_.push_back(static_cast<int64_t>(block_cols_.size()));
+    }
+  }
+
+  bool empty() const { return row_offsets_.empty(); }
+  int64_t k() const { return k_; }
+  int64_t n() const { return n_; }
+  int block_size() const { return block_size_; }
+  int64_t num_blocks() const { return block_cols_.size(); }
+  const int64_t* row_offsets() const { return row_offsets_.data(); }
+  const int32_t* block_cols() const { return block_cols_.data(); }
+  const T* values() const { return values_.data(); }
+
+ private:
+  int64_t k_{0};
+  int64_t n_{0};
+  int block_size_{0};
+  std::vector<int64_t> row_offsets_;
+  std::vector<int32_t> block_cols_;
+  std::vector<T> values_;
+};
+
+// The fraction of the zero blocks of a k x n weight.
+template <typename T>
+double BlockSparsity(const T* w, int64_t k, int64_t n, int block_size) {
+  if (block_size <= 0 || n % block_size != 0 || k * n == 0) return 0.;
+  int64_t zeros = 0;
+  for (int64_t i = 0; i < k * n; i += block_size) {
+    zeros += std::all_of(w + i, w + i + block_size,
+                         [](T v) { return v == static_cast<T>(0); });
+  }
+  return static_cast<double>(zeros) * block_size / (k * n);
+}
+
+namespace detail {
+
+// The rows of x sharing the loads of the blocks.
+constexpr int64_t kBlockSparseRowTile = 4;
+
+// Compute the rows [begin, end) of out, a block of BlockSize elements is a
+// vector register of AVX512 for 16 floats. BlockSize 0 reads the block size
+// of w.
+template <typename T, int BlockSize>
+void BlockSparseRows(const BlockSparseMatrix<T>& w, int64_t begin, int64_t end,
+                     const T* x, T* out) {
+  const int64_t k = w.k();
+  const int64_t n = w.n();
+  const int bs = BlockSize > 0 ? BlockSize : w.block_size();
+  const int64_t* row_offsets = w.row_offsets();
+  const int32_t* block_cols = w.block_cols();
+  const T* values = w.values();
+  for (int64_t r = begin; r < end; r += kBlockSparseRowTile) {
+    const int64_t rows = std::min(kBlockSparseRowTile, end - r);
+    T* out_rows = out + r * n;
+    std::fill(out_rows, out_rows + rows * n, static_cast<T>(0));
+    for (int64_t i = 0; i < k; ++i) {
+      T xs[kBlockSparseRowTile];
+      bool nonzero = false;
+      for (int64_t t = 0; t < rows; ++t) {
+        xs[t] = x[(r + t) * k + i];
+        nonzero |= xs[t] != static_cast<T>(0);
+      }
+      if (!nonzero) continue;
+      for (int64_t b = row_offsets[i]; b < row_offsets[i + 1]; ++b) {
+        const T* v = values + b * bs;
+        T* dst = out_rows + block_cols[b] * bs;
+        for (int64_t t = 0; t < rows; ++t) {
+          T* d = dst + t * n;
+          for (int j = 0; j < bs; ++j) {
+            d[j] += xs[t] * v[j];
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace detail
+
+// Compute out (m x n) = x (m x k) * w, skipping the zero blocks of w.
+template <typename T>
+void BlockSparseMatMul(const platform::CPUDeviceContext& dev_ctx,
+                       const BlockSparseMatrix<T>& w, int64_t m, const T* x,
+                       T* out) {
+  const int64_t tile = detail::kBlockSparseRowTile;
+  dev_ctx.ParallelFor(
+      (m + tile - 1) / tile,
+      [&](int64_t begin, int64_t end) {
+        begin *= tile;
+        end = std::min(end * tile, m);
+        switch (w.block_size()) {
+          case 4:
+            detail::BlockSparseRows<T, 4>(w, begin, end, x, out);
+            break;
+          case 8:
+            detail::BlockSparseRows<T, 8>(w, begin, end, x, out);
+            break;
+          case 16:
+            detail::BlockSparseRows<T, 16>(w, begin, end, x, out);
+            break;
+          default:
+            detail::BlockSparseRows<T, 0>(w, begin, end, x, out);
+        }
+      },
+      tile * (w.num_blocks() * w.block_size() + w.k()));
+}
+
+/*
+ * Compute out (m x n) = x (m x k) * w, where w is the input `w_param` of the
+ * op, k x n, if the op has the attribute kWeightBlockSize.
+ *
+ * The block-sparse w is cached in the scope of w as the variable
+ * w@BLOCK_SPARSE, which the analyzer creates, or the first call converts w
+ * to. It is only valid while w is not changed.
+ *
+ * Return false if the weight is not block-sparse, then the caller should
+ * compute it by the dense GEMM.
+ */
+template <typename DeviceContext, typename T>
+struct BlockSparseWeightMatMul {
+  bool operator()(const framework::ExecutionContext& ctx,
+                  const std::string& w_param, int m, int n, int k, const T* x,
+                  T* out) const {
+    return false;
+  }
+};
+
+template <typename T>
+struct CPUBlockSparseWeightMatMul {
+  bool operator()(const framework::ExecutionContext& ctx,
+                  const std::string& w_param, int m, int n, int k, const T* x,
+                  T* out) const {
+    int block_size = ctx.Attr<int>(kWeightBlockSize);
+    if (block_size <= 0 || n % block_size != 0) {
+      return false;
+    }
+    auto* w_var = ctx.InputVar(w_param);
+    auto* scope = ctx.scope().FindScope(w_var);
+    if (scope == nullptr) {
+      return false;
+    }
+    const std::string name = ctx.op().Input(w_param) + kBlockSparseSuffix;
+    BlockSparseMatrix<T>* sparse = nullptr;
+    {
+      // the scope of weight is shared by the predictors of all the threads
+      static std::mutex mutex;
+      std::lock_guard<std::mutex> lock(mutex);
+      sparse = const_cast<framework::Scope*>(scope)
+                   ->Var(name)
+                   ->GetMutable<BlockSparseMatrix<T>>();
+      if (sparse->empty()) {
+        auto& w = w_var->Get<framework::LoDTensor>();
+        PADDLE_ENFORCE_EQ(w.numel(), static_cast<int64_t>(n) * k,
+                          "The weight %s does not match the GEMM",
+                          ctx.op().Input(w_param));
+        sparse->FromDense(w.data<T>(), k, n, block_size);
+      }
+    }
+    PADDLE_ENFORCE(sparse->n() == n && sparse->k() == k,
+                   "The block-sparse weight %s is %d x %d, but %d x %d is "
+                   "wanted",
+                   name, sparse->k(), sparse->n(), k, n);
+    BlockSparseMatMul(ctx.template device_context<platform::CPUDeviceContext>(),
+                      *sparse, m, x, out);
+    return true;
+  }
+};
+
+template <>
+struct BlockSparseWeightMatMul<platform::CPUDeviceContext, float>
+    : public CPUBlockSparseWeightMatMul<float> {};
+
+template <>
+struct BlockSparseWeightMatMul<platform::CPUDeviceContext, double>
+    : public CPUBlockSparseWeightMatMul<double> {};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
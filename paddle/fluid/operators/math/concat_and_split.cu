@@ -13,35 +13,111 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <algorithm>
+#include <cstring>
 #include <vector>
-#include "paddle/fluid/framework/mixed_vector.h"
+#include "paddle/fluid/memory/malloc.h"
 #include "paddle/fluid/operators/math/concat_and_split.h"
 #include "paddle/fluid/platform/cuda_primitives.h"
+#include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/float16.h"
 
 namespace paddle {
 namespace operators {
 namespace math {
 
+// The pointers and the column offsets of up to kMaxPackedTensors tensors are
+// passed in the kernel parameters, which need no upload.
+constexpr int kMaxPackedTensors = 64;
+
+template <typename T>
+struct PackedTensorArgs {
+  T* data[kMaxPackedTensors];
+  int cols[kMaxPackedTensors + 1];
+
+  HOSTDEVICE inline T* ptr(int i) const { return data[i]; }
+  HOSTDEVICE inline int col(int i) const { return cols[i]; }
+};
+
+// The pointers and the column offsets of more tensors in the device memory.
 template <typename T>
-__global__ void ConcatKernel(T** inputs, const int* input_cols, int col_size,
-                             const int output_rows, const int output_cols,
-                             T* output) {
+struct DeviceTensorArgs {
+  T** data;
+  const int* cols;
+
+  HOSTDEVICE inline T* ptr(int i) const { return data[i]; }
+  HOSTDEVICE inline int col(int i) const { return cols[i]; }
+};
+
+/*
+ * Calls launcher(args) with the pointers and the column offsets of the
+ * tensors. More than kMaxPackedTensors of them are written to a pinned
+ * buffer and uploaded on the stream of the context, and both buffers are
+ * released in the order of the stream, so the call never blocks the host.
+ */
+template <typename T, typename Launcher>
+void LaunchWithTensorArgs(const platform::CUDADeviceContext& context,
+                          const std::vector<T*>& ptrs,
+                          const std::vector<int>& cols,
+                          const Launcher& launcher) {
+  size_t num = ptrs.size();
+  if (num <= static_cast<size_t>(kMaxPackedTensors)) {
+    PackedTensorArgs<T> args;
+    std::copy(ptrs.begin(), ptrs.end(), args.data);
+    std::copy(cols.begin(), cols.end(), args.cols);
+    launcher(args);
+    return;
+  }
+
+  size_t ptrs_bytes = num * sizeof(T*);
+  size_t cols_bytes = (num + 1) * sizeof(int);
+  size_t bytes = ptrs_bytes + cols_bytes;
+  auto* host = reinterpret_cast<char*>(
+      memory::Alloc(platform::CUDAPinnedPlace(), bytes));
+  PADDLE_ENFORCE_NOT_NULL(host, "Failed to allocate %d bytes of pinned memory",
+                          bytes);
+  std::memcpy(host, ptrs.data(), ptrs_bytes);
+  std::memcpy(host + ptrs_bytes, cols.data(), cols_bytes);
+
+  auto place = boost::get<platform::CUDAPlace>(context.GetPlace());
+  auto* dev =
+      reinterpret_cast<char*>(memory::Alloc(place, bytes, context.stream()));
+  PADDLE_ENFORCE(cudaMemcpyAsync(dev, host, bytes, cudaMemcpyHostToDevice,
+                                 context.stream()));
+  DeviceTensorArgs<T> args;
+  args.data = reinterpret_cast<T**>(dev);
+  args.cols = reinterpret_cast<const int*>(dev + ptrs_bytes);
+  launcher(args);
+
+  memory::Free(place, dev, context.stream());
+  context.AddStreamCallback(
+      [host] { memory::Free(platform::CUDAPinnedPlace(), host); });
+}
+
+// The inputs are of the same width fixed_col if it is positive.
+template <typename T, typename Args>
+__global__ void ConcatKernel(Args inputs, int fixed_col, const int output_rows,
+                             const int output_cols, T* output) {
   int tid_x = blockIdx.x * blockDim.x + threadIdx.x;
   int curr_segment = 0;
-  int curr_offset = input_cols[0];
+  int curr_offset = 0;
   for (; tid_x < output_cols; tid_x += blockDim.x * gridDim.x) {
-    int curr_col_offset = input_cols[curr_segment + 1];
-    while (curr_col_offset <= tid_x) {
-      curr_offset = curr_col_offset;
-      ++curr_segment;
-      curr_col_offset = input_cols[curr_segment + 1];
+    int local_col, segment_width;
+    if (fixed_col > 0) {
+      curr_segment = tid_x / fixed_col;
+      local_col = tid_x - curr_segment * fixed_col;
+      segment_width = fixed_col;
+    } else {
+      int curr_col_offset = inputs.col(curr_segment + 1);
+      while (curr_col_offset <= tid_x) {
+        curr_offset = curr_col_offset;
+        ++curr_segment;
+        curr_col_offset = inputs.col(curr_segment + 1);
+      }
+      local_col = tid_x - curr_offset;
+      segment_width = curr_col_offset - curr_offset;
     }
 
-    int local_col = tid_x - curr_offset;
-    int segment_width = curr_col_offset - curr_offset;
-
-    T* input_ptr = inputs[curr_segment];
+    const T* input_ptr = inputs.ptr(curr_segment);
     int tid_y = blockIdx.y * blockDim.y + threadIdx.y;
     for (; tid_y < output_rows; tid_y += blockDim.y * gridDim.y)
       output[tid_y * output_cols + tid_x] =
@@ -49,41 +125,31 @@ __global__ void ConcatKernel(T** inputs, const int* input_cols, int col_size,
   }
 }
 
-template <typename T>
-__global__ void ConcatKernel(T** inputs_data, const int fixed_in_col,
-                             const int out_rows, const int out_cols,
-                             T* output_data) {
-  int tid_x = blockIdx.x * blockDim.x + threadIdx.x;
-  for (; tid_x < out_cols; tid_x += blockDim.x * gridDim.x) {
-    int split = tid_x * 1.0 / fixed_in_col;
-    int in_offset = tid_x - split * fixed_in_col;
-    T* input_ptr = inputs_data[split];
-    int tid_y = blockIdx.y * blockDim.y + threadIdx.y;
-    for (; tid_y < out_rows; tid_y += blockDim.y * gridDim.y) {
-      output_data[tid_y * out_cols + tid_x] =
-          input_ptr[tid_y * fixed_in_col + in_offset];
-    }
-  }
-}
-
-template <typename T>
+// The outputs are of the same width fixed_col if it is positive.
+template <typename T, typename Args>
 __global__ void SplitKernel(const T* input_data, const int in_row,
-                            const int in_col, const int* out_cols,
-                            int out_cols_size, T** outputs_data) {
+                            const int in_col, int fixed_col, Args outputs) {
   int tid_x = blockIdx.x * blockDim.x + threadIdx.x;
   int curr_segment = 0;
-  int curr_offset = out_cols[0];
+  int curr_offset = 0;
   for (; tid_x < in_col; tid_x += blockDim.x * gridDim.x) {
-    int curr_col_offset = out_cols[curr_segment + 1];
-    while (curr_col_offset <= tid_x) {
-      curr_offset = curr_col_offset;
-      ++curr_segment;
-      curr_col_offset = out_cols[curr_segment + 1];
+    int local_col, segment_width;
+    if (fixed_col > 0) {
+      curr_segment = tid_x / fixed_col;
+      local_col = tid_x - curr_segment * fixed_col;
+      segment_width = fixed_col;
+    } else {
+      int curr_col_offset = outputs.col(curr_segment + 1);
+      while (curr_col_offset <= tid_x) {
+        curr_offset = curr_col_offset;
+        ++curr_segment;
+        curr_col_offset = outputs.col(curr_segment + 1);
+      }
+      local_col = tid_x - curr_offset;
+      segment_width = curr_col_offset - curr_offset;
     }
 
-    int local_col = tid_x - curr_offset;
-    int segment_width = curr_col_offset - curr_offset;
-    T* output_ptr = outputs_data[curr_segment];
+    T* output_ptr = outputs.ptr(curr_segment);
     if (output_ptr != nullptr) {
       int tid_y = blockIdx.y * blockDim.y + threadIdx.y;
       for (; tid_y < in_row; tid_y += blockDim.y * gridDim.y)
@@ -93,27 +159,65 @@ __global__ void SplitKernel(const T* input_data, const int in_row,
   }
 }
 
-template <typename T>
-__global__ void SplitKernel(const T* input_data, const int in_row,
-                            const int in_col, const int fixed_out_col,
-                            T** outputs_data) {
-  int tid_x = blockIdx.x * blockDim.x + threadIdx.x;
-  for (; tid_x < in_col; tid_x += blockDim.x * gridDim.x) {
-    int split = tid_x / fixed_out_col;
-    int in_offset = tid_x - split * fixed_out_col;
-    T* output_ptr = outputs_data[split];
-    if (output_ptr != nullptr) {
-      int tid_y = blockIdx.y * blockDim.y + threadIdx.y;
-      for (; tid_y < in_row; tid_y += blockDim.y * gridDim.y)
-        output_ptr[tid_y * fixed_out_col + in_offset] =
-            input_data[tid_y * in_col + tid_x];
-    }
+// set the thread block and grid according to CurrentDeviceId
+static void GetBlockAndGridSize(const platform::CUDADeviceContext& context,
+                                int rows, int cols, dim3* block_size,
+                                dim3* grid_size) {
+  const int kThreadsPerBlock = 1024;
+  int block_cols = kThreadsPerBlock;
+  if (cols < kThreadsPerBlock) {  // block_cols is aligned by 32.
+    block_cols = ((cols + 31) >> 5) << 5;
   }
+  int block_rows = kThreadsPerBlock / block_cols;
+  *block_size = dim3(block_cols, block_rows, 1);
+
+  int max_threads = context.GetMaxPhysicalThreadCount();
+  int max_blocks = std::max(max_threads / kThreadsPerBlock, 1);
+
+  int grid_cols = std::min((cols + block_cols - 1) / block_cols, max_blocks);
+  int grid_rows =
+      std::min(max_blocks / grid_cols, std::max(rows / block_rows, 1));
+  *grid_size = dim3(grid_cols, grid_rows, 1);
 }
 
+template <typename T>
+struct ConcatLauncher {
+  template <typename Args>
+  void operator()(const Args& inputs) const {
+    ConcatKernel<T, Args><<<grid_size, block_size, 0, context->stream()>>>(
+        inputs, fixed_col, rows, cols, output);
+  }
+
+  const platform::CUDADeviceContext* context;
+  dim3 grid_size;
+  dim3 block_size;
+  int fixed_col;
+  int rows;
+  int cols;
+  T* output;
+};
+
+template <typename T>
+struct SplitLauncher {
+  template <typename Args>
+  void operator()(const Args& outputs) const {
+    SplitKernel<T, Args><<<grid_size, block_size, 0, context->stream()>>>(
+        input, rows, cols, fixed_col, outputs);
+  }
+
+  const platform::CUDADeviceContext* context;
+  dim3 grid_size;
+  dim3 block_size;
+  const T* input;
+  int rows;
+  int cols;
+  int fixed_col;
+};
+
 /*
  * All tensors' dimension should be the same and the values of
  * each dimension must be the same, except the axis dimension.
+ * Any number of inputs are copied in one launch.
  */
 template <typename T>
 class ConcatFunctor<platform::CUDADeviceContext, T> {
@@ -131,10 +235,8 @@ class ConcatFunctor<platform::CUDADeviceContext, T> {
     int in_col = input[0].numel() / in_row;
     int out_row = in_row, out_col = 0;
 
-    framework::Vector<int16_t> inputs_data(in_num * sizeof(T*) / 2);
-    framework::Vector<int> inputs_col(in_num + 1);
-    T** inputs_ptr = reinterpret_cast<T**>(inputs_data.data());
-
+    std::vector<T*> inputs_ptr(in_num);
+    std::vector<int> inputs_col(in_num + 1);
     inputs_col[0] = 0;
     bool sameShape = true;
     for (int i = 0; i < in_num; ++i) {
@@ -147,46 +249,22 @@ class ConcatFunctor<platform::CUDADeviceContext, T> {
       inputs_ptr[i] = const_cast<T*>(input[i].data<T>());
     }
 
-    T** dev_ins_data =
-        reinterpret_cast<T**>(inputs_data.CUDAMutableData(context.GetPlace()));
-
-    // computation
-    // set the thread block and grid according to CurrentDeviceId
-    const int kThreadsPerBlock = 1024;
-    int block_cols = kThreadsPerBlock;
-    if (out_col < kThreadsPerBlock) {  // block_cols is aligned by 32.
-      block_cols = ((out_col + 31) >> 5) << 5;
-    }
-    int block_rows = kThreadsPerBlock / block_cols;
-    dim3 block_size = dim3(block_cols, block_rows, 1);
-
-    int max_threads = context.GetMaxPhysicalThreadCount();
-    int max_blocks = std::max(max_threads / kThreadsPerBlock, 1);
-
-    int grid_cols =
-        std::min((out_col + block_cols - 1) / block_cols, max_blocks);
-    int grid_rows =
-        std::min(max_blocks / grid_cols, std::max(out_row / block_rows, 1));
-    dim3 grid_size = dim3(grid_cols, grid_rows, 1);
-
-    if (sameShape) {
-      ConcatKernel<<<grid_size, block_size, 0, context.stream()>>>(
-          dev_ins_data, in_col, out_row, out_col, output->data<T>());
-    } else {
-      const int* dev_ins_col_data = inputs_col.CUDAData(context.GetPlace());
-      ConcatKernel<<<grid_size, block_size, 0, context.stream()>>>(
-          dev_ins_data, dev_ins_col_data, static_cast<int>(inputs_col.size()),
-          out_row, out_col, output->data<T>());
-    }
-    // Wait() must be called because `inputs_data` may be destructed before
-    // kernel ends
-    context.Wait();
+    ConcatLauncher<T> launcher;
+    launcher.context = &context;
+    GetBlockAndGridSize(context, out_row, out_col, &launcher.block_size,
+                        &launcher.grid_size);
+    launcher.fixed_col = sameShape ? in_col : 0;
+    launcher.rows = out_row;
+    launcher.cols = out_col;
+    launcher.output = output->data<T>();
+    LaunchWithTensorArgs(context, inputs_ptr, inputs_col, launcher);
   }
 };
 
 /*
  * All tensors' dimension should be the same and the values of
  * each dimension must be the same, except the axis dimension.
+ * Any number of outputs are copied in one launch.
  */
 template <typename T>
 class SplitFunctor<platform::CUDADeviceContext, T> {
@@ -207,10 +285,8 @@ class SplitFunctor<platform::CUDADeviceContext, T> {
     int in_col = 0, in_row = out_row;
     bool sameShape = true;
 
-    framework::Vector<int16_t> outputs_data(o_num * sizeof(T*) / 2);
-    framework::Vector<int> outputs_cols(o_num + 1);
-    T** outputs_ptr = reinterpret_cast<T**>(outputs_data.data());
-
+    std::vector<T*> outputs_ptr(o_num);
+    std::vector<int> outputs_cols(o_num + 1);
     outputs_cols[0] = 0;
     for (int i = 0; i < o_num; ++i) {
       int t_col = ref_inputs.at(i)->numel() / out_row;
@@ -226,39 +302,15 @@ class SplitFunctor<platform::CUDADeviceContext, T> {
       }
     }
 
-    T** dev_out_gpu_data =
-        reinterpret_cast<T**>(outputs_data.CUDAMutableData(context.GetPlace()));
-
-    // computation
-    const int kThreadsPerBlock = 1024;
-    int block_cols = kThreadsPerBlock;
-    if (in_col < kThreadsPerBlock) {  // block_cols is aligned by 32.
-      block_cols = ((in_col + 31) >> 5) << 5;
-    }
-    int block_rows = kThreadsPerBlock / block_cols;
-    dim3 block_size = dim3(block_cols, block_rows, 1);
-
-    int max_threads = context.GetMaxPhysicalThreadCount();
-    int max_blocks = std::max(max_threads / kThreadsPerBlock, 1);
-
-    int grid_cols =
-        std::min((in_col + block_cols - 1) / block_cols, max_blocks);
-    int grid_rows =
-        std::min(max_blocks / grid_cols, std::max(out_row / block_rows, 1));
-    dim3 grid_size = dim3(grid_cols, grid_rows, 1);
-
-    if (sameShape) {
-      SplitKernel<<<grid_size, block_size, 0, context.stream()>>>(
-          input.data<T>(), in_row, in_col, out0_col, dev_out_gpu_data);
-    } else {
-      const int* dev_outs_col_data = outputs_cols.CUDAData(context.GetPlace());
-      SplitKernel<<<grid_size, block_size, 0, context.stream()>>>(
-          input.data<T>(), in_row, in_col, dev_outs_col_data,
-          static_cast<int>(outputs_cols.size()), dev_out_gpu_data);
-    }
-    // Wait() must be called because `outputs_data` may be destructed before
-    // kernel ends
-    context.Wait();
+    SplitLauncher<T> launcher;
+    launcher.context = &context;
+    GetBlockAndGridSize(context, out_row, in_col, &launcher.block_size,
+                        &launcher.grid_size);
+    launcher.input = input.data<T>();
+    launcher.rows = in_row;
+    launcher.cols = in_col;
+    launcher.fixed_col = sameShape ? out0_col : 0;
+    LaunchWithTensorArgs(context, outputs_ptr, outputs_cols, launcher);
   }
 };
 
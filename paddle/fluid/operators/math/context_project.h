@@ -306,6 +306,101 @@ class ContextProjectGradFunctor {
   }
 };
 
+/*
+ * \brief The context projection fused with the projection by the filter,
+ * out = ContextProject(in) * filter, computed on the LoD batch directly.
+ *
+ * The j-th block of context_length * input_hidden_size columns of the col
+ * data is the input shifted by context_start + j rows, so for every sequence
+ * and every context offset, the valid rows of the shifted input, which are
+ * contiguous in the input, are multiplied by the j-th block of rows of the
+ * filter and accumulated into the output. No col data is materialized, and
+ * the padding rows, which are zeros, are skipped. It only supports the
+ * untrainable padding and context_stride = 1.
+ *
+ * \param filter        The shape of Filter:
+ *                        [context_length * input_hidden_size, output_size].
+ * \param out           The shape of Out: [mini-batch, output_size].
+ */
+template <typename DeviceContext, typename T>
+class ContextProjectMatMulFunctor {
+ public:
+  void operator()(const DeviceContext& context, const LoDTensor& in,
+                  const Tensor& filter, const int context_start,
+                  const int context_length, Tensor* out) {
+    auto lod_level_0 = in.lod()[0];
+    int sequence_width = static_cast<int>(in.dims()[1]);
+    int output_width = static_cast<int>(filter.dims()[1]);
+    auto blas = math::GetBlas<DeviceContext, T>(context);
+    const T* in_data = in.data<T>();
+    const T* filter_data = filter.data<T>();
+    T* out_data = out->data<T>();
+
+    for (int i = 0; i < static_cast<int>(lod_level_0.size()) - 1; ++i) {
+      int begin = static_cast<int>(lod_level_0[i]);
+      int height = static_cast<int>(lod_level_0[i + 1]) - begin;
+      for (int j = 0; j < context_length; ++j) {
+        int shift = context_start + j;
+        // The rows of output whose shifted input row is in the sequence.
+        int row_begin = std::max(0, -shift);
+        int row_end = std::min(height, height - shift);
+        if (row_begin >= row_end) continue;
+        blas.GEMM(CblasNoTrans, CblasNoTrans, row_end - row_begin,
+                  output_width, sequence_width, static_cast<T>(1),
+                  in_data + (begin + row_begin + shift) * sequence_width,
+                  filter_data + j * sequence_width * output_width,
+                  static_cast<T>(1),
+                  out_data + (begin + row_begin) * output_width);
+      }
+    }
+  }
+};
+
+/*
+ * \brief The gradients of ContextProjectMatMulFunctor. The gradients are
+ * accumulated into in_grad and filter_grad, either of them may be nullptr.
+ */
+template <typename DeviceContext, typename T>
+class ContextProjectMatMulGradFunctor {
+ public:
+  void operator()(const DeviceContext& context, const LoDTensor& in,
+                  const Tensor& filter, const Tensor& out_grad,
+                  const int context_start, const int context_length,
+                  Tensor* in_grad, Tensor* filter_grad) {
+    auto lod_level_0 = in.lod()[0];
+    int sequence_width = static_cast<int>(in.dims()[1]);
+    int output_width = static_cast<int>(filter.dims()[1]);
+    auto blas = math::GetBlas<DeviceContext, T>(context);
+    const T* out_grad_data = out_grad.data<T>();
+
+    for (int i = 0; i < static_cast<int>(lod_level_0.size()) - 1; ++i) {
+      int begin = static_cast<int>(lod_level_0[i]);
+      int height = static_cast<int>(lod_level_0[i + 1]) - begin;
+      for (int j = 0; j < context_length; ++j) {
+        int shift = context_start + j;
+        int row_begin = std::max(0, -shift);
+        int row_end = std::min(height, height - shift);
+        if (row_begin >= row_end) continue;
+        int rows = row_end - row_begin;
+        const T* dout = out_grad_data + (begin + row_begin) * output_width;
+        int in_offset = (begin + row_begin + shift) * sequence_width;
+        int filter_offset = j * sequence_width * output_width;
+        if (in_grad) {
+          blas.GEMM(CblasNoTrans, CblasTrans, rows, sequence_width,
+                    output_width, static_cast<T>(1), dout,
+                    filter.data<T>() + filter_offset, static_cast<T>(1),
+                    in_grad->data<T>() + in_offset);
+        }
+        if (filter_grad) {
+          blas.GEMM(CblasTrans, CblasNoTrans, sequence_width, output_width,
+                    rows, static_cast<T>(1), in.data<T>() + in_offset, dout,
+                    static_cast<T>(1), filter_grad->data<T>() + filter_offset);
+        }
+      }
+    }
+  }
+};
+
 }  // namespace math
 }  // namespace operators
 }  // namespace paddle
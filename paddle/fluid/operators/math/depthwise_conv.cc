@@ -0,0 +1,327 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/depthwise_conv.h"
+#include <algorithm>
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+// The output pixel whose 3x3 input window starts at (ih0, iw0), which may be
+// partly out of the plane.
+static inline float Conv3x3Pixel(const float* x, const float* w,
+                                 int input_height, int input_width, int ih0,
+                                 int iw0) {
+  float sum = 0.f;
+  for (int p = 0; p < 3; ++p) {
+    const int ih = ih0 + p;
+    if (ih < 0 || ih >= input_height) continue;
+    for (int q = 0; q < 3; ++q) {
+      const int iw = iw0 + q;
+      if (iw < 0 || iw >= input_width) continue;
+      sum += w[p * 3 + q] * x[ih * input_width + iw];
+    }
+  }
+  return sum;
+}
+
+// Accumulates a filter row w into 4 output pixels from the input row x.
+static inline float32x4_t Conv3x3Row(float32x4_t acc, const float* x,
+                                     const float* w, int stride) {
+  float32x4_t x0, x1, x2;
+  if (stride == 1) {
+    x0 = vld1q_f32(x);
+    x1 = vld1q_f32(x + 1);
+    x2 = vld1q_f32(x + 2);
+  } else {
+    float32x4x2_t even_odd = vld2q_f32(x);
+    x0 = even_odd.val[0];
+    x1 = even_odd.val[1];
+    x2 = vld2q_f32(x + 2).val[0];
+  }
+  acc = vmlaq_n_f32(acc, x0, w[0]);
+  acc = vmlaq_n_f32(acc, x1, w[1]);
+  return vmlaq_n_f32(acc, x2, w[2]);
+}
+
+template <>
+bool DepthwiseConv3x3Plane<float>(const float* x, const float* w,
+                                  int input_height, int input_width,
+                                  int output_height, int output_width,
+                                  int filter_height, int filter_width,
+                                  const std::vector<int>& strides,
+                                  const std::vector<int>& paddings,
+                                  const std::vector<int>& dilations,
+                                  float* y) {
+  const int stride = strides[0];
+  if (filter_height != 3 || filter_width != 3 || strides[1] != stride ||
+      (stride != 1 && stride != 2) || dilations[0] != 1 || dilations[1] != 1) {
+    return false;
+  }
+  const int pad_h = paddings[0];
+  const int pad_w = paddings[1];
+  // The input columns loaded for 4 output pixels.
+  const int span = stride == 1 ? 6 : 10;
+  // The first output column whose window is inside the row.
+  const int ow_begin = std::min(output_width, (pad_w + stride - 1) / stride);
+  for (int oh = 0; oh < output_height; ++oh) {
+    float* y_row = y + oh * output_width;
+    const int ih0 = oh * stride - pad_h;
+    int ow = 0;
+    if (ih0 >= 0 && ih0 + 2 < input_height) {
+      const float* x_row = x + ih0 * input_width;
+      for (; ow < ow_begin; ++ow) {
+        y_row[ow] += Conv3x3Pixel(x, w, input_height, input_width, ih0,
+                                  ow * stride - pad_w);
+      }
+      for (; ow + 4 <= output_width &&
+             ow * stride - pad_w + span <= input_width;
+           ow += 4) {
+        const float* x0 = x_row + ow * stride - pad_w;
+        float32x4_t acc = vld1q_f32(y_row + ow);
+        acc = Conv3x3Row(acc, x0, w, stride);
+        acc = Conv3x3Row(acc, x0 + input_width, w + 3, stride);
+        acc = Conv3x3Row(acc, x0 + 2 * input_width, w + 6, stride);
+        vst1q_f32(y_row + ow, acc);
+      }
+    }
+    for (; ow < output_width; ++ow) {
+      y_row[ow] += Conv3x3Pixel(x, w, input_height, input_width, ih0,
+                                ow * stride - pad_w);
+    }
+  }
+  return true;
+}
+#endif
+
+/*
+ * The CPU depthwise convolution. The input is of the shape
+ * [N, C_in, H, W], the filter [C_out, 1, K_h, K_w] and the output
+ * [N, C_out, H_out, W_out], where C_out is a multiple of C_in and the
+ * output channel c is computed from the input channel c / (C_out / C_in).
+ */
+template <typename T>
+class DepthwiseConvFunctor<platform::CPUDeviceContext, T> {
+ public:
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& input,
+                  const framework::Tensor& filter,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations,
+                  framework::Tensor* output) {
+    const int batch_size = static_cast<int>(input.dims()[0]);
+    const int input_channels = static_cast<int>(input.dims()[1]);
+    const int input_height = static_cast<int>(input.dims()[2]);
+    const int input_width = static_cast<int>(input.dims()[3]);
+    const int output_channels = static_cast<int>(output->dims()[1]);
+    const int output_height = static_cast<int>(output->dims()[2]);
+    const int output_width = static_cast<int>(output->dims()[3]);
+    const int filter_height = static_cast<int>(filter.dims()[2]);
+    const int filter_width = static_cast<int>(filter.dims()[3]);
+    const int filter_multiplier = output_channels / input_channels;
+    PADDLE_ENFORCE_EQ(filter.dims()[0], output_channels);
+    PADDLE_ENFORCE_EQ(filter_multiplier * input_channels, output_channels);
+
+    const T* input_data = input.data<T>();
+    const T* filter_data = filter.data<T>();
+    T* output_data = output->mutable_data<T>(context.GetPlace());
+    const int input_size = input_height * input_width;
+    const int output_size = output_height * output_width;
+    const int filter_size = filter_height * filter_width;
+    context.ParallelFor(
+        batch_size * output_channels,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t k = begin; k < end; ++k) {
+            const int i = static_cast<int>(k / output_channels);
+            const int c = static_cast<int>(k % output_channels);
+            const T* x = input_data +
+                         (i * input_channels + c / filter_multiplier) *
+                             input_size;
+            T* y = output_data + k * output_size;
+            std::fill(y, y + output_size, static_cast<T>(0));
+            const T* w = filter_data + c * filter_size;
+            if (DepthwiseConv3x3Plane(x, w, input_height, input_width,
+                                      output_height, output_width,
+                                      filter_height, filter_width, strides,
+                                      paddings, dilations, y)) {
+              continue;
+            }
+            DepthwiseConvRows(x, w, input_height, input_width, output_width,
+                              filter_height, filter_width, strides, paddings,
+                              dilations, 0, output_height, y);
+          }
+        },
+        filter_size * output_size);
+  }
+};
+
+template <typename T>
+class DepthwiseConvInputGradFunctor<platform::CPUDeviceContext, T> {
+ public:
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& input,
+                  const framework::Tensor& filter,
+                  const framework::Tensor& output_grad,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations,
+                  framework::Tensor* input_grad) {
+    const int batch_size = static_cast<int>(input.dims()[0]);
+    const int input_channels = static_cast<int>(input.dims()[1]);
+    const int input_height = static_cast<int>(input.dims()[2]);
+    const int input_width = static_cast<int>(input.dims()[3]);
+    const int output_channels = static_cast<int>(output_grad.dims()[1]);
+    const int output_height = static_cast<int>(output_grad.dims()[2]);
+    const int output_width = static_cast<int>(output_grad.dims()[3]);
+    const int filter_height = static_cast<int>(filter.dims()[2]);
+    const int filter_width = static_cast<int>(filter.dims()[3]);
+    const int filter_multiplier = output_channels / input_channels;
+
+    const T* output_grad_data = output_grad.data<T>();
+    const T* filter_data = filter.data<T>();
+    T* input_grad_data = input_grad->mutable_data<T>(context.GetPlace());
+    const int input_size = input_height * input_width;
+    const int output_size = output_height * output_width;
+    const int filter_size = filter_height * filter_width;
+    // Each task owns an input channel and scatters the gradients of all its
+    // output channels into it, so no two tasks write the same element.
+    context.ParallelFor(
+        batch_size * input_channels,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t k = begin; k < end; ++k) {
+            const int i = static_cast<int>(k / input_channels);
+            const int c_in = static_cast<int>(k % input_channels);
+            T* dx = input_grad_data + k * input_size;
+            std::fill(dx, dx + input_size, static_cast<T>(0));
+            for (int m = 0; m < filter_multiplier; ++m) {
+              const int c = c_in * filter_multiplier + m;
+              const T* dy =
+                  output_grad_data + (i * output_channels + c) * output_size;
+              const T* w = filter_data + c * filter_size;
+              for (int kh = 0; kh < filter_height; ++kh) {
+                const int h_offset = kh * dilations[0] - paddings[0];
+                for (int kw = 0; kw < filter_width; ++kw) {
+                  const T weight = w[kh * filter_width + kw];
+                  const int w_offset = kw * dilations[1] - paddings[1];
+                  int ow_begin, ow_end;
+                  DepthwiseConvColumnRange(w_offset, strides[1], input_width,
+                                           output_width, &ow_begin, &ow_end);
+                  for (int oh = 0; oh < output_height; ++oh) {
+                    const int ih = oh * strides[0] + h_offset;
+                    if (ih < 0 || ih >= input_height) continue;
+                    const T* dy_row = dy + oh * output_width;
+                    T* dx_row = dx + ih * input_width;
+                    for (int ow = ow_begin; ow < ow_end; ++ow) {
+                      dx_row[ow * strides[1] + w_offset] +=
+                          weight * dy_row[ow];
+                    }
+                  }
+                }
+              }
+            }
+          }
+        },
+        filter_multiplier * filter_size * output_size);
+  }
+};
+
+template <typename T>
+class DepthwiseConvFilterGradFunctor<platform::CPUDeviceContext, T> {
+ public:
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& input,
+                  const framework::Tensor& output_grad,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations,
+                  framework::Tensor* filter_grad) {
+    const int batch_size = static_cast<int>(input.dims()[0]);
+    const int input_channels = static_cast<int>(input.dims()[1]);
+    const int input_height = static_cast<int>(input.dims()[2]);
+    const int input_width = static_cast<int>(input.dims()[3]);
+    const int output_channels = static_cast<int>(output_grad.dims()[1]);
+    const int output_height = static_cast<int>(output_grad.dims()[2]);
+    const int output_width = static_cast<int>(output_grad.dims()[3]);
+    const int filter_height = static_cast<int>(filter_grad->dims()[2]);
+    const int filter_width = static_cast<int>(filter_grad->dims()[3]);
+    const int filter_multiplier = output_channels / input_channels;
+
+    const T* input_data = input.data<T>();
+    const T* output_grad_data = output_grad.data<T>();
+    T* filter_grad_data = filter_grad->mutable_data<T>(context.GetPlace());
+    const int input_size = input_height * input_width;
+    const int output_size = output_height * output_width;
+    const int filter_size = filter_height * filter_width;
+    // Each task owns the filter of an output channel and reduces over the
+    // batch, so the result does not depend on the number of threads.
+    context.ParallelFor(
+        output_channels,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t c = begin; c < end; ++c) {
+            T* dw = filter_grad_data + c * filter_size;
+            for (int kh = 0; kh < filter_height; ++kh) {
+              const int h_offset = kh * dilations[0] - paddings[0];
+              for (int kw = 0; kw < filter_width; ++kw) {
+                const int w_offset = kw * dilations[1] - paddings[1];
+                int ow_begin, ow_end;
+                DepthwiseConvColumnRange(w_offset, strides[1], input_width,
+                                         output_width, &ow_begin, &ow_end);
+                T sum = static_cast<T>(0);
+                for (int i = 0; i < batch_size; ++i) {
+                  const T* x = input_data +
+                               (i * input_channels + c / filter_multiplier) *
+                                   input_size;
+                  const T* dy = output_grad_data +
+                                (i * output_channels + c) * output_size;
+                  for (int oh = 0; oh < output_height; ++oh) {
+                    const int ih = oh * strides[0] + h_offset;
+                    if (ih < 0 || ih >= input_height) continue;
+                    const T* x_row = x + ih * input_width;
+                    const T* dy_row = dy + oh * output_width;
+                    for (int ow = ow_begin; ow < ow_end; ++ow) {
+                      sum += dy_row[ow] * x_row[ow * strides[1] + w_offset];
+                    }
+                  }
+                }
+                dw[kh * filter_width + kw] = sum;
+              }
+            }
+          }
+        },
+        batch_size * filter_size * output_size);
+  }
+};
+
+template class DepthwiseConvFunctor<platform::CPUDeviceContext, float>;
+template class DepthwiseConvFunctor<platform::CPUDeviceContext, double>;
+
+template class DepthwiseConvInputGradFunctor<platform::CPUDeviceContext,
+                                             float>;
+template class DepthwiseConvInputGradFunctor<platform::CPUDeviceContext,
+                                             double>;
+
+template class DepthwiseConvFilterGradFunctor<platform::CPUDeviceContext,
+                                              float>;
+template class DepthwiseConvFilterGradFunctor<platform::CPUDeviceContext,
+                                              double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
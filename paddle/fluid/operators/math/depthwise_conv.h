@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <algorithm>
 #include <vector>
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/platform/device_context.h"
@@ -59,6 +60,81 @@ class DepthwiseConvFilterGradFunctor {
                   framework::Tensor* filter_grad);
 };
 
+// The output columns [*begin, *end) whose input column
+// ow * stride + offset is inside [0, input_width).
+inline void DepthwiseConvColumnRange(int offset, int stride, int input_width,
+                                     int output_width, int* begin, int* end) {
+  *begin = offset >= 0 ? 0 : (-offset + stride - 1) / stride;
+  *end = input_width - 1 - offset < 0
+             ? 0
+             : std::min(output_width, (input_width - 1 - offset) / stride + 1);
+}
+
+// Accumulates the convolution of the input plane x, of the size
+// input_height x input_width, and the filter w, of the size
+// filter_height x filter_width, into the output rows [row_begin, row_end)
+// of y, which points to the row row_begin. The inner loops run over the
+// contiguous output columns so that the compiler vectorizes them.
+template <typename T>
+inline void DepthwiseConvRows(const T* x, const T* w, int input_height,
+                              int input_width, int output_width,
+                              int filter_height, int filter_width,
+                              const std::vector<int>& strides,
+                              const std::vector<int>& paddings,
+                              const std::vector<int>& dilations,
+                              int row_begin, int row_end, T* y) {
+  for (int kh = 0; kh < filter_height; ++kh) {
+    const int h_offset = kh * dilations[0] - paddings[0];
+    for (int kw = 0; kw < filter_width; ++kw) {
+      const T weight = w[kh * filter_width + kw];
+      const int w_offset = kw * dilations[1] - paddings[1];
+      int ow_begin, ow_end;
+      DepthwiseConvColumnRange(w_offset, strides[1], input_width, output_width,
+                               &ow_begin, &ow_end);
+      for (int oh = row_begin; oh < row_end; ++oh) {
+        const int ih = oh * strides[0] + h_offset;
+        if (ih < 0 || ih >= input_height) continue;
+        const T* x_row = x + ih * input_width;
+        T* y_row = y + (oh - row_begin) * output_width;
+        if (strides[1] == 1) {
+          for (int ow = ow_begin; ow < ow_end; ++ow) {
+            y_row[ow] += weight * x_row[ow + w_offset];
+          }
+        } else {
+          for (int ow = ow_begin; ow < ow_end; ++ow) {
+            y_row[ow] += weight * x_row[ow * strides[1] + w_offset];
+          }
+        }
+      }
+    }
+  }
+}
+
+// Accumulates the 3x3 convolution with the stride 1 or 2 and the dilation 1
+// of the input plane x and the filter w into the output plane y by NEON,
+// returns false for the other convolutions, or without NEON.
+template <typename T>
+inline bool DepthwiseConv3x3Plane(const T* x, const T* w, int input_height,
+                                  int input_width, int output_height,
+                                  int output_width, int filter_height,
+                                  int filter_width,
+                                  const std::vector<int>& strides,
+                                  const std::vector<int>& paddings,
+                                  const std::vector<int>& dilations, T* y) {
+  return false;
+}
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+template <>
+bool DepthwiseConv3x3Plane<float>(const float* x, const float* w,
+                                  int input_height, int input_width,
+                                  int output_height, int output_width,
+                                  int filter_height, int filter_width,
+                                  const std::vector<int>& strides,
+                                  const std::vector<int>& paddings,
+                                  const std::vector<int>& dilations, float* y);
+#endif
+
 }  // namespace math
 }  // namespace operators
 }  // namespace paddle
@@ -0,0 +1,177 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/depthwise_conv.h"
+#include <gtest/gtest.h>
+#include <sys/time.h>
+#include <random>
+#include <vector>
+#include "glog/logging.h"
+#include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/im2col.h"
+
+namespace {
+
+inline double GetCurrentUS() {
+  struct timeval time;
+  gettimeofday(&time, NULL);
+  return 1e+6 * time.tv_sec + time.tv_usec;
+}
+constexpr int repeat = 20;
+
+void RandomVec(const int n, float* a) {
+  std::mt19937 rng(100);
+  std::uniform_real_distribution<float> uniform_dist(-1, 1);
+  for (int i = 0; i < n; ++i) {
+    a[i] = uniform_dist(rng);
+  }
+}
+
+// Compares the forward and the backward of the depthwise convolution with
+// the naive loops, and the forward speed with im2col + GEMM per channel.
+void TestAndBench(int n, int c, int h, int w, int multiplier, int filter_size,
+                  int stride, int pad, int dilation) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  const int k = c * multiplier;
+  const int dkernel = dilation * (filter_size - 1) + 1;
+  const int oh = (h + 2 * pad - dkernel) / stride + 1;
+  const int ow = (w + 2 * pad - dkernel) / stride + 1;
+  const int fsize = filter_size * filter_size;
+
+  paddle::framework::Tensor input, filter, output, output_grad;
+  paddle::framework::Tensor input_grad, filter_grad;
+  float* x = input.mutable_data<float>({n, c, h, w}, place);
+  float* f = filter.mutable_data<float>({k, 1, filter_size, filter_size},
+                                        place);
+  float* dy = output_grad.mutable_data<float>({n, k, oh, ow}, place);
+  output.mutable_data<float>({n, k, oh, ow}, place);
+  input_grad.mutable_data<float>({n, c, h, w}, place);
+  filter_grad.mutable_data<float>({k, 1, filter_size, filter_size}, place);
+  RandomVec(n * c * h * w, x);
+  RandomVec(k * fsize, f);
+  RandomVec(n * k * oh * ow, dy);
+
+  std::vector<int> strides({stride, stride});
+  std::vector<int> paddings({pad, pad});
+  std::vector<int> dilations({dilation, dilation});
+  paddle::operators::math::DepthwiseConvFunctor<
+      paddle::platform::CPUDeviceContext, float>
+      depthwise;
+  paddle::operators::math::DepthwiseConvInputGradFunctor<
+      paddle::platform::CPUDeviceContext, float>
+      depthwise_input_grad;
+  paddle::operators::math::DepthwiseConvFilterGradFunctor<
+      paddle::platform::CPUDeviceContext, float>
+      depthwise_filter_grad;
+  auto st = GetCurrentUS();
+  for (int i = 0; i < repeat; ++i) {
+    depthwise(context, input, filter, strides, paddings, dilations, &output);
+  }
+  auto mt = GetCurrentUS();
+  depthwise_input_grad(context, input, filter, output_grad, strides, paddings,
+                       dilations, &input_grad);
+  depthwise_filter_grad(context, input, output_grad, strides, paddings,
+                        dilations, &filter_grad);
+
+  // the naive loops
+  std::vector<float> ref_y(n * k * oh * ow, 0.f);
+  std::vector<float> ref_dx(n * c * h * w, 0.f);
+  std::vector<float> ref_dw(k * fsize, 0.f);
+  for (int i = 0; i < n; ++i) {
+    for (int o = 0; o < k; ++o) {
+      const int ci = (i * c + o / multiplier) * h * w;
+      for (int y = 0; y < oh; ++y) {
+        for (int z = 0; z < ow; ++z) {
+          const int yi = ((i * k + o) * oh + y) * ow + z;
+          for (int p = 0; p < filter_size; ++p) {
+            for (int q = 0; q < filter_size; ++q) {
+              const int ih = y * stride - pad + p * dilation;
+              const int iw = z * stride - pad + q * dilation;
+              if (ih < 0 || ih >= h || iw < 0 || iw >= w) continue;
+              const int xi = ci + ih * w + iw;
+              const int wi = o * fsize + p * filter_size + q;
+              ref_y[yi] += f[wi] * x[xi];
+              ref_dx[xi] += f[wi] * dy[yi];
+              ref_dw[wi] += x[xi] * dy[yi];
+            }
+          }
+        }
+      }
+    }
+  }
+  const float* y = output.data<float>();
+  for (int i = 0; i < n * k * oh * ow; ++i) {
+    EXPECT_NEAR(y[i], ref_y[i], 1e-4);
+  }
+  const float* dx = input_grad.data<float>();
+  for (int i = 0; i < n * c * h * w; ++i) {
+    EXPECT_NEAR(dx[i], ref_dx[i], 1e-4);
+  }
+  const float* dw = filter_grad.data<float>();
+  for (int i = 0; i < k * fsize; ++i) {
+    EXPECT_NEAR(dw[i], ref_dw[i], 1e-3);
+  }
+
+  // im2col + GEMM per channel, as the grouped convolution does
+  paddle::framework::Tensor col;
+  col.mutable_data<float>({1, filter_size, filter_size, oh, ow}, place);
+  std::vector<float> gemm_y(k * oh * ow);
+  paddle::operators::math::Im2ColFunctor<
+      paddle::operators::math::ColFormat::kCFO,
+      paddle::platform::CPUDeviceContext, float>
+      im2col;
+  auto blas = paddle::operators::math::GetBlas<
+      paddle::platform::CPUDeviceContext, float>(context);
+  mt = GetCurrentUS();
+  for (int r = 0; r < repeat; ++r) {
+    for (int i = 0; i < n; ++i) {
+      for (int g = 0; g < c; ++g) {
+        paddle::framework::Tensor in_slice =
+            input.Slice(i, i + 1).Resize({c, h, w}).Slice(g, g + 1);
+        im2col(context, in_slice, dilations, strides, {pad, pad, pad, pad},
+               &col);
+        blas.GEMM(CblasNoTrans, CblasNoTrans, multiplier, oh * ow, fsize, 1.f,
+                  f + g * multiplier * fsize, col.data<float>(), 0.f,
+                  gemm_y.data() + g * multiplier * oh * ow);
+      }
+    }
+  }
+  auto et = GetCurrentUS();
+  VLOG(3) << "Depthwise conv " << filter_size << "x" << filter_size << " of ["
+          << n << ", " << c << ", " << h << ", " << w << "] with multiplier "
+          << multiplier << ": depthwise takes " << (mt - st) / repeat
+          << " us, im2col + gemm takes " << (et - mt) / repeat << " us";
+}
+
+}  // namespace
+
+TEST(DepthwiseConv, mobilenet) {
+  TestAndBench(2, 32, 56, 56, 1, 3, 1, 1, 1);
+  TestAndBench(2, 64, 28, 29, 1, 3, 2, 1, 1);
+  TestAndBench(1, 16, 15, 15, 1, 5, 1, 2, 1);
+}
+
+TEST(DepthwiseConv, multiplier_and_dilation) {
+  TestAndBench(2, 4, 17, 19, 2, 3, 1, 1, 1);
+  TestAndBench(1, 3, 20, 20, 3, 3, 1, 2, 2);
+  TestAndBench(3, 2, 9, 9, 1, 3, 3, 0, 1);
+}
+
+TEST(DepthwiseConv, narrow_planes) {
+  // The planes narrower than a vector of the 3x3 convolutions.
+  TestAndBench(1, 3, 4, 3, 1, 3, 1, 1, 1);
+  TestAndBench(1, 3, 7, 5, 1, 3, 2, 1, 1);
+  TestAndBench(2, 2, 9, 11, 1, 3, 2, 0, 1);
+}
@@ -84,6 +84,87 @@ __global__ void KeLstmForward(Op op, LstmMetaValue<T> value, int frame_size,
   value.output_value[frame_idx] = r_out;
 }
 
+/*
+ * Compute all the steps of the sequences in one launch, the recurrent
+ * projection included. Every block runs one sequence, and every thread one
+ * of the 4 * frame_size gates, the hidden state of the last step is kept in
+ * the shared memory.
+ * threads(frame_size * 4)
+ * grid(num_seqs)
+ */
+template <class T, class Op>
+__global__ void KePersistentLstmForward(
+    Op op, LstmMetaValue<T> value, const T* weight, const T* h0,
+    const size_t* batch_starts, int num_steps, int frame_size,
+    ActivationType active_node, ActivationType active_gate,
+    ActivationType active_state) {
+  extern __shared__ char shared_mem[];
+  T* prev_out = reinterpret_cast<T*>(shared_mem);
+  T* gates = prev_out + frame_size;
+
+  const int seq_idx = blockIdx.x;
+  const int gate_idx = threadIdx.x;
+  const int gate_size = frame_size * 4;
+  const bool is_frame = gate_idx < frame_size;
+
+  T r_prev_state = 0;
+  T r_checkI = 0;
+  T r_checkF = 0;
+  T r_checkO = 0;
+  if (is_frame) {
+    prev_out[gate_idx] = h0 ? h0[seq_idx * frame_size + gate_idx] : 0;
+    if (value.prev_state_value) {
+      r_prev_state = value.prev_state_value[seq_idx * frame_size + gate_idx];
+    }
+    r_checkI = value.check_ig ? value.check_ig[gate_idx] : 0;
+    r_checkF = value.check_fg ? value.check_fg[gate_idx] : 0;
+    r_checkO = value.check_og ? value.check_og[gate_idx] : 0;
+  }
+  __syncthreads();
+
+  for (int n = 0; n < num_steps; ++n) {
+    // the sequences are sorted by length, so the sequence is in the batch of
+    // this step iff it is not over
+    const int row = static_cast<int>(batch_starts[n]) + seq_idx;
+    if (row >= static_cast<int>(batch_starts[n + 1])) break;
+    T* gate_value = value.gate_value + row * gate_size;
+
+    T r_gate = gate_value[gate_idx];
+    if (n > 0 || h0) {
+      for (int i = 0; i < frame_size; ++i) {
+        r_gate += prev_out[i] * weight[i * gate_size + gate_idx];
+      }
+    }
+    gates[gate_idx] = r_gate;
+    __syncthreads();
+
+    if (is_frame) {
+      T r_value_in = gates[gate_idx];
+      T r_value_ig = gates[gate_idx + frame_size];
+      T r_value_fg = gates[gate_idx + frame_size * 2];
+      T r_value_og = gates[gate_idx + frame_size * 3];
+      T r_state;
+      T r_state_atv;
+      T r_out;
+      op(&r_value_in, &r_value_ig, &r_value_fg, &r_value_og, &r_prev_state,
+         &r_state, &r_state_atv, &r_out, &r_checkI, &r_checkF, &r_checkO,
+         active_node, active_gate, active_state);
+
+      gate_value[gate_idx] = r_value_in;
+      gate_value[gate_idx + frame_size] = r_value_ig;
+      gate_value[gate_idx + frame_size * 2] = r_value_fg;
+      gate_value[gate_idx + frame_size * 3] = r_value_og;
+
+      value.state_value[row * frame_size + gate_idx] = r_state;
+      value.state_active_value[row * frame_size + gate_idx] = r_state_atv;
+      value.output_value[row * frame_size + gate_idx] = r_out;
+      prev_out[gate_idx] = r_out;
+      r_prev_state = r_state;
+    }
+    __syncthreads();
+  }
+}
+
 /*
  * threads(frame_per_block, batch_per_block)
  * grid(frame_blocks, batch_blocks)
@@ -215,6 +296,30 @@ void gpu_lstm_forward(const platform::DeviceContext& context, Op op,
   }
 }
 
+/*
+ * The value points to the first rows of the tensors in the batch layout given
+ * by batch_starts, and h0 and prev_state_value are in the sorted order of the
+ * sequences. batch_starts should be on the device.
+ */
+template <class T, class Op>
+void gpu_persistent_lstm_forward(const platform::DeviceContext& context,
+                                 Op op, LstmMetaValue<T> value,
+                                 const T* weight, const T* h0,
+                                 const size_t* batch_starts, int num_steps,
+                                 int num_seqs, int frame_size,
+                                 ActivationType active_node,
+                                 ActivationType active_gate,
+                                 ActivationType active_state) {
+  dim3 threads(frame_size * 4);
+  dim3 grid(num_seqs);
+  size_t shared_size = sizeof(T) * frame_size * 5;
+  auto stream =
+      reinterpret_cast<const platform::CUDADeviceContext&>(context).stream();
+  KePersistentLstmForward<T, Op><<<grid, threads, shared_size, stream>>>(
+      op, value, weight, h0, batch_starts, num_steps, frame_size, active_node,
+      active_gate, active_state);
+}
+
 template <class T, class Op>
 void gpu_lstm_backward(const platform::DeviceContext& context, Op op,
                        LstmMetaValue<T> value, LstmMetaGrad<T> grad,
@@ -0,0 +1,119 @@
+/* Copyright (c) 2016 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/direct_conv.h"
+#include <algorithm>
+#include "paddle/fluid/operators/math/depthwise_conv.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+template <typename T>
+class DirectConvFunctor<platform::CPUDeviceContext, T> {
+ public:
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& input,
+                  const framework::Tensor& filter,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations,
+                  framework::Tensor* output) {
+    PADDLE_ENFORCE_EQ(input.dims().size(), 3);
+    PADDLE_ENFORCE_EQ(filter.dims().size(), 4);
+    PADDLE_ENFORCE_EQ(output->dims().size(), 3);
+    const int input_channels = static_cast<int>(input.dims()[0]);
+    const int input_height = static_cast<int>(input.dims()[1]);
+    const int input_width = static_cast<int>(input.dims()[2]);
+    const int output_channels = static_cast<int>(output->dims()[0]);
+    const int output_height = static_cast<int>(output->dims()[1]);
+    const int output_width = static_cast<int>(output->dims()[2]);
+    const int filter_height = static_cast<int>(filter.dims()[2]);
+    const int filter_width = static_cast<int>(filter.dims()[3]);
+    PADDLE_ENFORCE_EQ(filter.dims()[0], output_channels);
+    PADDLE_ENFORCE_EQ(filter.dims()[1], input_channels);
+    const int stride_height = strides[0];
+    const int stride_width = strides[1];
+
+    const T* input_data = input.data<T>();
+    const T* filter_data = filter.data<T>();
+    T* output_data = output->data<T>();
+    const int input_size = input_height * input_width;
+    const int output_size = output_height * output_width;
+    context.ParallelFor(
+        output_channels,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t k = begin; k < end; ++k) {
+            T* y = output_data + k * output_size;
+            std::fill(y, y + output_size, static_cast<T>(0));
+            const T* w = filter_data + k * input_channels * filter_height *
+                                           filter_width;
+            for (int c = 0; c < input_channels; ++c) {
+              const T* x = input_data + c * input_size;
+              if (DepthwiseConv3x3Plane(x, w, input_height, input_width,
+                                        output_height, output_width,
+                                        filter_height, filter_width, strides,
+                                        paddings, dilations, y)) {
+                w += filter_height * filter_width;
+                continue;
+              }
+              for (int kh = 0; kh < filter_height; ++kh) {
+                const int h_offset = kh * dilations[0] - paddings[0];
+                for (int kw = 0; kw < filter_width; ++kw) {
+                  const T weight = *w++;
+                  // The output columns whose input column
+                  // ow * stride_width + w_offset is inside the input.
+                  const int w_offset = kw * dilations[1] - paddings[1];
+                  const int ow_begin =
+                      w_offset >= 0
+                          ? 0
+                          : (-w_offset + stride_width - 1) / stride_width;
+                  const int ow_end =
+                      input_width - 1 - w_offset < 0
+                          ? 0
+                          : std::min(output_width,
+                                     (input_width - 1 - w_offset) /
+                                             stride_width +
+                                         1);
+                  for (int oh = 0; oh < output_height; ++oh) {
+                    const int ih = oh * stride_height + h_offset;
+                    if (ih < 0 || ih >= input_height) continue;
+                    const T* x_row = x + ih * input_width;
+                    T* y_row = y + oh * output_width;
+                    if (stride_width == 1) {
+                      for (int ow = ow_begin; ow < ow_end; ++ow) {
+                        y_row[ow] += weight * x_row[ow + w_offset];
+                      }
+                    } else {
+                      for (int ow = ow_begin; ow < ow_end; ++ow) {
+                        y_row[ow] +=
+                            weight * x_row[ow * stride_width + w_offset];
+                      }
+                    }
+                  }
+                }
+              }
+            }
+          }
+        },
+        input_channels * filter_height * filter_width * output_size);
+  }
+};
+
+template class DirectConvFunctor<platform::CPUDeviceContext, float>;
+template class DirectConvFunctor<platform::CPUDeviceContext, double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
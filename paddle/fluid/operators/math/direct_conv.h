@@ -0,0 +1,49 @@
+/* Copyright (c) 2016 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <vector>
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * \brief The direct convolution without im2col, for the convolutions with
+ * few input channels, whose im2col buffer costs more than the tiny GEMM.
+ *
+ * Each output plane is accumulated by the rows of the input planes scaled
+ * by the filter weights, so the inner loop runs over the contiguous output
+ * columns and is vectorized by the compiler when the stride is 1. The output
+ * channels are run by the intra-op thread pool.
+ *
+ * input: [input_channels, input_height, input_width]
+ * filter: [output_channels, input_channels, filter_height, filter_width]
+ * output: [output_channels, output_height, output_width]
+ */
+template <typename DeviceContext, typename T>
+class DirectConvFunctor {
+ public:
+  void operator()(const DeviceContext& context, const framework::Tensor& input,
+                  const framework::Tensor& filter,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations, framework::Tensor* output);
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
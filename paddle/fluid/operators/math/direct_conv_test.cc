@@ -0,0 +1,107 @@
+/* Copyright (c) 2016 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/direct_conv.h"
+#include <gtest/gtest.h>
+#include <sys/time.h>
+#include <random>
+#include <vector>
+#include "glog/logging.h"
+#include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/im2col.h"
+
+namespace {
+
+inline double GetCurrentUS() {
+  struct timeval time;
+  gettimeofday(&time, NULL);
+  return 1e+6 * time.tv_sec + time.tv_usec;
+}
+constexpr int repeat = 20;
+
+void RandomVec(const int n, float* a) {
+  std::mt19937 rng(100);
+  std::uniform_real_distribution<float> uniform_dist(-1, 1);
+  for (int i = 0; i < n; ++i) {
+    a[i] = uniform_dist(rng);
+  }
+}
+
+// Compares the direct convolution with im2col + GEMM.
+void TestAndBench(int c, int h, int w, int k, int filter_size, int stride,
+                  int pad, int dilation) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  const int dkernel = dilation * (filter_size - 1) + 1;
+  const int oh = (h + 2 * pad - dkernel) / stride + 1;
+  const int ow = (w + 2 * pad - dkernel) / stride + 1;
+
+  paddle::framework::Tensor input, filter, output;
+  float* x = input.mutable_data<float>({c, h, w}, place);
+  float* f =
+      filter.mutable_data<float>({k, c, filter_size, filter_size}, place);
+  float* y = output.mutable_data<float>({k, oh, ow}, place);
+  RandomVec(c * h * w, x);
+  RandomVec(k * c * filter_size * filter_size, f);
+
+  std::vector<int> strides({stride, stride});
+  std::vector<int> paddings({pad, pad});
+  std::vector<int> dilations({dilation, dilation});
+  paddle::operators::math::DirectConvFunctor<
+      paddle::platform::CPUDeviceContext, float>
+      direct;
+  auto st = GetCurrentUS();
+  for (int i = 0; i < repeat; ++i) {
+    direct(context, input, filter, strides, paddings, dilations, &output);
+  }
+  auto mt = GetCurrentUS();
+
+  paddle::framework::Tensor col, gemm_output;
+  col.mutable_data<float>({c, filter_size, filter_size, oh, ow}, place);
+  float* ref = gemm_output.mutable_data<float>({k, oh * ow}, place);
+  paddle::operators::math::Im2ColFunctor<
+      paddle::operators::math::ColFormat::kCFO,
+      paddle::platform::CPUDeviceContext, float>
+      im2col;
+  auto blas = paddle::operators::math::GetBlas<
+      paddle::platform::CPUDeviceContext, float>(context);
+  for (int i = 0; i < repeat; ++i) {
+    im2col(context, input, dilations, strides, {pad, pad, pad, pad}, &col);
+    blas.GEMM(CblasNoTrans, CblasNoTrans, k, oh * ow,
+              c * filter_size * filter_size, 1.f, f, col.data<float>(), 0.f,
+              ref);
+  }
+  auto et = GetCurrentUS();
+  for (int i = 0; i < k * oh * ow; ++i) {
+    EXPECT_NEAR(y[i], ref[i], 1e-4);
+  }
+  VLOG(3) << "Conv " << filter_size << "x" << filter_size << " of [" << c
+          << ", " << h << ", " << w << "] to " << k
+          << " channels: direct takes " << (mt - st) / repeat
+          << " us, im2col + gemm takes " << (et - mt) / repeat << " us";
+}
+
+}  // namespace
+
+TEST(DirectConv, few_channels) {
+  TestAndBench(3, 64, 64, 16, 3, 1, 1, 1);
+  TestAndBench(1, 28, 28, 8, 5, 1, 2, 1);
+  TestAndBench(3, 32, 31, 8, 3, 2, 1, 1);
+}
+
+TEST(DirectConv, depthwise_and_dilation) {
+  TestAndBench(1, 17, 19, 1, 3, 1, 1, 1);
+  TestAndBench(2, 20, 20, 4, 3, 1, 2, 2);
+  TestAndBench(1, 9, 9, 2, 3, 3, 0, 1);
+}
@@ -0,0 +1,106 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <type_traits>
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The attributes of conv2d and mul, set by the quantization-aware training to
+// the bits their inputs are fake quantized with by the abs max, 0 if the input
+// is not quantized.
+constexpr char kInputQuantBits[] = "input_quant_bits";
+constexpr char kFilterQuantBits[] = "filter_quant_bits";
+constexpr char kXQuantBits[] = "x_quant_bits";
+constexpr char kYQuantBits[] = "y_quant_bits";
+
+/*
+ * out = round(in * bin_cnt / scale) * scale / bin_cnt, where scale is the abs
+ * max of in and bin_cnt = 2^(bit_length - 1) - 1, the result of the pair of
+ * fake_quantize_abs_max and fake_dequantize_max_abs in one pass. Only CPU
+ * has it.
+ */
+template <typename DeviceContext, typename T>
+struct FakeQuantDequantAbsMaxFunctor {
+  void operator()(const DeviceContext& dev_ctx, const framework::Tensor& in,
+                  int bit_length, framework::Tensor* out) const {
+    PADDLE_THROW("The fused fake quantization only runs on CPU");
+  }
+};
+
+template <typename T>
+struct FakeQuantDequantAbsMaxFunctor<platform::CPUDeviceContext, T> {
+  void operator()(const platform::CPUDeviceContext& dev_ctx,
+                  const framework::Tensor& in, int bit_length,
+                  framework::Tensor* out) const {
+    using AccT = typename std::conditional<std::is_same<T, double>::value,
+                                           double, float>::type;
+    const T* x = in.data<T>();
+    T* y = out->mutable_data<T>(in.dims(), dev_ctx.GetPlace());
+    const int64_t n = in.numel();
+    AccT scale = 0;
+    for (int64_t i = 0; i < n; ++i) {
+      scale = std::max(scale, std::abs(static_cast<AccT>(x[i])));
+    }
+    if (scale == static_cast<AccT>(0)) {
+      std::fill(y, y + n, static_cast<T>(0));
+      return;
+    }
+    const AccT bin_cnt = static_cast<AccT>((1 << (bit_length - 1)) - 1);
+    const AccT to_quant = bin_cnt / scale;
+    const AccT to_float = scale / bin_cnt;
+    dev_ctx.ParallelFor(n, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        y[i] = static_cast<T>(std::round(static_cast<AccT>(x[i]) * to_quant) *
+                              to_float);
+      }
+    });
+  }
+};
+
+/*
+ * The input in of an op fused with its fake quantization, quantized and
+ * dequantized into buffer with the bits of the attribute attr, or in itself
+ * if the op does not have attr or it is 0.
+ *
+ * The backward of the op gets the same quantized input, and its gradient is
+ * passed straight through the quantization, as the fake quantization ops do.
+ */
+template <typename DeviceContext, typename T>
+const framework::Tensor* FakeQuantizedInput(
+    const framework::ExecutionContext& ctx, const std::string& attr,
+    const framework::Tensor* in, framework::Tensor* buffer) {
+  auto& attrs = ctx.op().Attrs();
+  if (attrs.find(attr) == attrs.end()) return in;
+  int bits = ctx.Attr<int>(attr);
+  if (bits <= 0) return in;
+  PADDLE_ENFORCE_LE(bits, 16, "The %s of %s should be at most 16", attr,
+                    ctx.op().Type());
+  FakeQuantDequantAbsMaxFunctor<DeviceContext, T>()(
+      ctx.template device_context<DeviceContext>(), *in, bits, buffer);
+  return buffer;
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
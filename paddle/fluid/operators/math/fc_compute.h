@@ -16,6 +16,7 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/jit_kernel.h"
+#include "paddle/fluid/platform/bfloat16.h"
 
 DECLARE_int32(paddle_num_threads);
 
@@ -23,14 +24,10 @@ namespace paddle {
 namespace operators {
 namespace math {
 
-template <typename DeviceContext, typename T>
-inline void FCCompute(const BlasT<DeviceContext, T>& blas, const int M,
-                      const int N, const int K, const T* X, const T* W, T* Y,
-                      const T* B = NULL, bool relu = false) {
-  blas.MatMul(M, N, K, X, W, Y);
-  if (B == NULL) {
-    return;
-  }
+// Add the bias B to each row of Y (M x N), and then apply relu if needed.
+template <typename T>
+inline void FCAddBias(const int M, const int N, T* Y, const T* B,
+                      bool relu = false) {
   if (relu) {
     const auto& vaddrelu = jitkernel::KernelPool::Instance()
                                .template Get<jitkernel::VAddReluKernel<T>>(N);
@@ -52,6 +49,55 @@ inline void FCCompute(const BlasT<DeviceContext, T>& blas, const int M,
   }
 }
 
+// The jit kernels are of float, bfloat16 is rounded from the float results.
+template <>
+inline void FCAddBias<platform::bfloat16>(const int M, const int N,
+                                          platform::bfloat16* Y,
+                                          const platform::bfloat16* B,
+                                          bool relu) {
+  for (int i = 0; i < M; i++) {
+    platform::bfloat16* dst = Y + i * N;
+    for (int j = 0; j < N; j++) {
+      float v = static_cast<float>(dst[j]) + static_cast<float>(B[j]);
+      dst[j] = platform::bfloat16(relu && v < 0.f ? 0.f : v);
+    }
+  }
+}
+
+// Y (M x N) = X (M x K) * W (K x N).
+template <typename DeviceContext, typename T>
+inline void FCMatMul(const BlasT<DeviceContext, T>& blas, const int M,
+                     const int N, const int K, const T* X, const T* W, T* Y) {
+  if (jitkernel::GEMMKernel<T>::UseJIT(M, N, K, false, false)) {
+    const auto& gemm =
+        jitkernel::KernelPool::Instance()
+            .template Get<jitkernel::GEMMKernel<T>, int, int, int, bool, bool>(
+                M, N, K, false, false);
+    gemm->Compute(X, W, Y);
+  } else {
+    blas.MatMul(M, N, K, X, W, Y);
+  }
+}
+
+template <typename DeviceContext>
+inline void FCMatMul(const BlasT<DeviceContext, platform::bfloat16>& blas,
+                     const int M, const int N, const int K,
+                     const platform::bfloat16* X, const platform::bfloat16* W,
+                     platform::bfloat16* Y) {
+  blas.MatMul(M, N, K, X, W, Y);
+}
+
+template <typename DeviceContext, typename T>
+inline void FCCompute(const BlasT<DeviceContext, T>& blas, const int M,
+                      const int N, const int K, const T* X, const T* W, T* Y,
+                      const T* B = NULL, bool relu = false) {
+  FCMatMul(blas, M, N, K, X, W, Y);
+  if (B == NULL) {
+    return;
+  }
+  FCAddBias<T>(M, N, Y, B, relu);
+}
+
 }  // namespace math
 }  // namespace operators
 }  // namespace paddle
@@ -0,0 +1,130 @@
+/* Copyright (c) 2016 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/implicit_gemm_conv.h"
+#include "gflags/gflags.h"
+
+DEFINE_bool(conv_cuda_implicit_gemm, true,
+            "Whether to select the implicit GEMM by the shapes for the 2-D "
+            "convolutions and transposed convolutions on GPU without cuDNN, "
+            "instead of always using im2col + GEMM, which needs a col buffer "
+            "per image.");
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+bool UseImplicitGemmConv(const ImplicitGemmConvShape& s, bool transpose) {
+  if (!FLAGS_conv_cuda_implicit_gemm) return false;
+  // The 1x1 convolution without the col buffer is a GEMM of cuBLAS already.
+  if (!transpose && s.filter_height == 1 && s.filter_width == 1 &&
+      s.stride_height == 1 && s.stride_width == 1 && s.padding_height == 0 &&
+      s.padding_width == 0) {
+    return false;
+  }
+  // The GEMM of im2col reads every element of the col buffer once per tile
+  // of the output channels. With a single tile, writing and reading the col
+  // buffer costs more than the implicit GEMM, which reads the input only.
+  // The groups and the small planes also split the fallback into many small
+  // GEMMs, while the implicit GEMM runs the whole batch by one launch.
+  const int m_size = s.output_channels / s.groups;
+  const int col_width = transpose ? s.input_height * s.input_width
+                                  : s.output_height * s.output_width;
+  return m_size <= 64 || s.groups > 1 || col_width <= 256;
+}
+
+// The reference of the CUDA kernels, each output channel is run by the
+// intra-op thread pool.
+template <typename T, bool kTranspose>
+static void ImplicitGemmConv(const platform::CPUDeviceContext& context,
+                             const framework::Tensor& input,
+                             const framework::Tensor& filter,
+                             const ImplicitGemmConvShape& s,
+                             framework::Tensor* output) {
+  const T* input_data = input.data<T>();
+  const T* filter_data = filter.data<T>();
+  T* output_data = output->data<T>();
+  const int m_size = s.output_channels / s.groups;
+  const int k_size =
+      s.input_channels / s.groups * s.filter_height * s.filter_width;
+  const int n_size = s.batch_size * s.output_height * s.output_width;
+  context.ParallelFor(
+      s.output_channels,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t row = begin; row < end; ++row) {
+          const int g = static_cast<int>(row) / m_size;
+          const int m = static_cast<int>(row) % m_size;
+          for (int n = 0; n < n_size; ++n) {
+            T sum = static_cast<T>(0);
+            for (int k = 0; k < k_size; ++k) {
+              sum += ImplicitGemmConvFilter<T, kTranspose>(filter_data, s, g,
+                                                           m, k) *
+                     ImplicitGemmConvInput<T, kTranspose>(input_data, s, g, k,
+                                                          n);
+            }
+            output_data[ImplicitGemmConvOutputOffset(s, g, m, n)] = sum;
+          }
+        }
+      },
+      static_cast<int64_t>(n_size) * k_size);
+}
+
+template <typename T>
+class ImplicitGemmConvFunctor<platform::CPUDeviceContext, T> {
+ public:
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& input,
+                  const framework::Tensor& filter,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations, int groups,
+                  framework::Tensor* output) {
+    PADDLE_ENFORCE_EQ(input.dims().size(), 4);
+    PADDLE_ENFORCE_EQ(filter.dims().size(), 4);
+    PADDLE_ENFORCE_EQ(output->dims().size(), 4);
+    auto shape = MakeImplicitGemmConvShape(input, filter, strides, paddings,
+                                           dilations, groups, *output);
+    ImplicitGemmConv<T, false>(context, input, filter, shape, output);
+  }
+};
+
+template <typename T>
+class ImplicitGemmConvTransposeFunctor<platform::CPUDeviceContext, T> {
+ public:
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& input,
+                  const framework::Tensor& filter,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations, int groups,
+                  framework::Tensor* output) {
+    PADDLE_ENFORCE_EQ(input.dims().size(), 4);
+    PADDLE_ENFORCE_EQ(filter.dims().size(), 4);
+    PADDLE_ENFORCE_EQ(output->dims().size(), 4);
+    auto shape = MakeImplicitGemmConvShape(input, filter, strides, paddings,
+                                           dilations, groups, *output);
+    ImplicitGemmConv<T, true>(context, input, filter, shape, output);
+  }
+};
+
+template class ImplicitGemmConvFunctor<platform::CPUDeviceContext, float>;
+template class ImplicitGemmConvFunctor<platform::CPUDeviceContext, double>;
+template class ImplicitGemmConvTransposeFunctor<platform::CPUDeviceContext,
+                                                float>;
+template class ImplicitGemmConvTransposeFunctor<platform::CPUDeviceContext,
+                                                double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
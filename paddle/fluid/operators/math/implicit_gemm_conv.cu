@@ -0,0 +1,178 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <vector>
+#include "paddle/fluid/operators/math/implicit_gemm_conv.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// A block computes a kTileM x kTileN tile of the output matrix of a group,
+// each of its threads computes kThreadM x kThreadN of the elements strided
+// by the threads in a row or column, so that the shared memory is read
+// without bank conflicts and the output is written coalesced.
+static constexpr int kTileM = 64;
+static constexpr int kTileN = 64;
+static constexpr int kTileK = 8;
+static constexpr int kThreadM = 4;
+static constexpr int kThreadN = 4;
+static constexpr int kThreadsM = kTileM / kThreadM;
+static constexpr int kThreadsN = kTileN / kThreadN;
+static constexpr int kThreads = kThreadsM * kThreadsN;
+
+template <typename T, bool kTranspose>
+__global__ void KernelImplicitGemmConv(const T* input, const T* filter,
+                                       ImplicitGemmConvShape s, T* output) {
+  __shared__ T filter_tile[kTileK][kTileM];
+  __shared__ T input_tile[kTileK][kTileN];
+
+  const int g = blockIdx.z;
+  const int m_size = s.output_channels / s.groups;
+  const int k_size =
+      s.input_channels / s.groups * s.filter_height * s.filter_width;
+  const int n_size = s.batch_size * s.output_height * s.output_width;
+  const int m_begin = blockIdx.y * kTileM;
+  const int n_begin = blockIdx.x * kTileN;
+  const int tid = threadIdx.x;
+  const int tm = tid / kThreadsN;
+  const int tn = tid % kThreadsN;
+
+  T sum[kThreadM][kThreadN];
+  for (int i = 0; i < kThreadM; ++i) {
+    for (int j = 0; j < kThreadN; ++j) {
+      sum[i][j] = static_cast<T>(0);
+    }
+  }
+
+  for (int k_begin = 0; k_begin < k_size; k_begin += kTileK) {
+    // The consecutive threads load the consecutive k of the filter rows and
+    // the consecutive n of the input, which are contiguous in memory.
+    for (int i = tid; i < kTileK * kTileM; i += kThreads) {
+      const int k = k_begin + i % kTileK;
+      const int m = m_begin + i / kTileK;
+      filter_tile[i % kTileK][i / kTileK] =
+          k < k_size && m < m_size
+              ? ImplicitGemmConvFilter<T, kTranspose>(filter, s, g, m, k)
+              : static_cast<T>(0);
+    }
+    for (int i = tid; i < kTileK * kTileN; i += kThreads) {
+      const int k = k_begin + i / kTileN;
+      const int n = n_begin + i % kTileN;
+      input_tile[i / kTileN][i % kTileN] =
+          k < k_size && n < n_size
+              ? ImplicitGemmConvInput<T, kTranspose>(input, s, g, k, n)
+              : static_cast<T>(0);
+    }
+    __syncthreads();
+
+#pragma unroll
+    for (int k = 0; k < kTileK; ++k) {
+      T a[kThreadM];
+      T b[kThreadN];
+#pragma unroll
+      for (int i = 0; i < kThreadM; ++i) {
+        a[i] = filter_tile[k][tm + i * kThreadsM];
+      }
+#pragma unroll
+      for (int j = 0; j < kThreadN; ++j) {
+        b[j] = input_tile[k][tn + j * kThreadsN];
+      }
+#pragma unroll
+      for (int i = 0; i < kThreadM; ++i) {
+#pragma unroll
+        for (int j = 0; j < kThreadN; ++j) {
+          sum[i][j] += a[i] * b[j];
+        }
+      }
+    }
+    __syncthreads();
+  }
+
+  for (int i = 0; i < kThreadM; ++i) {
+    const int m = m_begin + tm + i * kThreadsM;
+    if (m >= m_size) break;
+    for (int j = 0; j < kThreadN; ++j) {
+      const int n = n_begin + tn + j * kThreadsN;
+      if (n >= n_size) break;
+      output[ImplicitGemmConvOutputOffset(s, g, m, n)] = sum[i][j];
+    }
+  }
+}
+
+template <typename T, bool kTranspose>
+static void ImplicitGemmConv(const platform::CUDADeviceContext& context,
+                             const framework::Tensor& input,
+                             const framework::Tensor& filter,
+                             const ImplicitGemmConvShape& s,
+                             framework::Tensor* output) {
+  const int m_size = s.output_channels / s.groups;
+  const int n_size = s.batch_size * s.output_height * s.output_width;
+  dim3 grid((n_size + kTileN - 1) / kTileN, (m_size + kTileM - 1) / kTileM,
+            s.groups);
+  KernelImplicitGemmConv<T, kTranspose><<<grid, kThreads, 0,
+                                          context.stream()>>>(
+      input.data<T>(), filter.data<T>(), s, output->data<T>());
+}
+
+template <typename T>
+class ImplicitGemmConvFunctor<platform::CUDADeviceContext, T> {
+ public:
+  void operator()(const platform::CUDADeviceContext& context,
+                  const framework::Tensor& input,
+                  const framework::Tensor& filter,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations, int groups,
+                  framework::Tensor* output) {
+    PADDLE_ENFORCE_EQ(input.dims().size(), 4);
+    PADDLE_ENFORCE_EQ(filter.dims().size(), 4);
+    PADDLE_ENFORCE_EQ(output->dims().size(), 4);
+    auto shape = MakeImplicitGemmConvShape(input, filter, strides, paddings,
+                                           dilations, groups, *output);
+    ImplicitGemmConv<T, false>(context, input, filter, shape, output);
+  }
+};
+
+template <typename T>
+class ImplicitGemmConvTransposeFunctor<platform::CUDADeviceContext, T> {
+ public:
+  void operator()(const platform::CUDADeviceContext& context,
+                  const framework::Tensor& input,
+                  const framework::Tensor& filter,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations, int groups,
+                  framework::Tensor* output) {
+    PADDLE_ENFORCE_EQ(input.dims().size(), 4);
+    PADDLE_ENFORCE_EQ(filter.dims().size(), 4);
+    PADDLE_ENFORCE_EQ(output->dims().size(), 4);
+    auto shape = MakeImplicitGemmConvShape(input, filter, strides, paddings,
+                                           dilations, groups, *output);
+    ImplicitGemmConv<T, true>(context, input, filter, shape, output);
+  }
+};
+
+template class ImplicitGemmConvFunctor<platform::CUDADeviceContext, float>;
+template class ImplicitGemmConvFunctor<platform::CUDADeviceContext, double>;
+template class ImplicitGemmConvTransposeFunctor<platform::CUDADeviceContext,
+                                                float>;
+template class ImplicitGemmConvTransposeFunctor<platform::CUDADeviceContext,
+                                                double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
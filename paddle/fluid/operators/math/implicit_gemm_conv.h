@@ -0,0 +1,188 @@
+/* Copyright (c) 2016 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <vector>
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * \brief The 2-D convolution as a GEMM of the filter and the implicit im2col
+ * matrix of the input, whose tiles are gathered from the input directly
+ * instead of a col buffer per image.
+ *
+ * The GEMM of a group is [M, K] x [K, N], where M is the output channels of
+ * the group, K is input_channels / groups * filter_height * filter_width and
+ * N is batch_size * output_height * output_width, so all the images of the
+ * batch are computed by one launch.
+ *
+ * input: [batch_size, input_channels, input_height, input_width]
+ * filter: [output_channels, input_channels / groups, filter_height,
+ *          filter_width]
+ * output: [batch_size, output_channels, output_height, output_width]
+ */
+template <typename DeviceContext, typename T>
+class ImplicitGemmConvFunctor {
+ public:
+  void operator()(const DeviceContext& context, const framework::Tensor& input,
+                  const framework::Tensor& filter,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations, int groups,
+                  framework::Tensor* output);
+};
+
+/*
+ * \brief The 2-D transposed convolution as the same GEMM, whose implicit
+ * matrix gathers for each output pixel the input pixels it is scattered
+ * from, i.e. the ones at (y + padding - k * dilation) / stride when the
+ * division is exact. So neither the col buffer nor col2im is needed, and no
+ * output is written twice.
+ *
+ * input: [batch_size, input_channels, input_height, input_width]
+ * filter: [input_channels, output_channels / groups, filter_height,
+ *          filter_width]
+ * output: [batch_size, output_channels, output_height, output_width]
+ */
+template <typename DeviceContext, typename T>
+class ImplicitGemmConvTransposeFunctor {
+ public:
+  void operator()(const DeviceContext& context, const framework::Tensor& input,
+                  const framework::Tensor& filter,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations, int groups,
+                  framework::Tensor* output);
+};
+
+// The shapes of a 2-D implicit GEMM convolution, the input and the output
+// are the ones of the operator, i.e. swapped for the transposed convolution.
+struct ImplicitGemmConvShape {
+  int batch_size;
+  int input_channels;
+  int input_height;
+  int input_width;
+  int output_channels;
+  int output_height;
+  int output_width;
+  int filter_height;
+  int filter_width;
+  int stride_height;
+  int stride_width;
+  int padding_height;
+  int padding_width;
+  int dilation_height;
+  int dilation_width;
+  int groups;
+};
+
+inline ImplicitGemmConvShape MakeImplicitGemmConvShape(
+    const framework::Tensor& input, const framework::Tensor& filter,
+    const std::vector<int>& strides, const std::vector<int>& paddings,
+    const std::vector<int>& dilations, int groups,
+    const framework::Tensor& output) {
+  ImplicitGemmConvShape shape;
+  shape.batch_size = static_cast<int>(input.dims()[0]);
+  shape.input_channels = static_cast<int>(input.dims()[1]);
+  shape.input_height = static_cast<int>(input.dims()[2]);
+  shape.input_width = static_cast<int>(input.dims()[3]);
+  shape.output_channels = static_cast<int>(output.dims()[1]);
+  shape.output_height = static_cast<int>(output.dims()[2]);
+  shape.output_width = static_cast<int>(output.dims()[3]);
+  shape.filter_height = static_cast<int>(filter.dims()[2]);
+  shape.filter_width = static_cast<int>(filter.dims()[3]);
+  shape.stride_height = strides[0];
+  shape.stride_width = strides[1];
+  shape.padding_height = paddings[0];
+  shape.padding_width = paddings[1];
+  shape.dilation_height = dilations[0];
+  shape.dilation_width = dilations[1];
+  shape.groups = groups;
+  return shape;
+}
+
+// Whether the implicit GEMM is estimated to be faster than im2col (or col2im
+// for the transposed convolution) and a GEMM per image and group, with
+// FLAGS_conv_cuda_implicit_gemm.
+bool UseImplicitGemmConv(const ImplicitGemmConvShape& shape, bool transpose);
+
+// The element (m, k) of the filter matrix of the group g.
+template <typename T, bool kTranspose>
+HOSTDEVICE inline T ImplicitGemmConvFilter(const T* filter,
+                                           const ImplicitGemmConvShape& s,
+                                           int g, int m, int k) {
+  const int output_step = s.output_channels / s.groups;
+  if (!kTranspose) {
+    const int k_size =
+        s.input_channels / s.groups * s.filter_height * s.filter_width;
+    return filter[(g * output_step + m) * k_size + k];
+  }
+  const int filter_size = s.filter_height * s.filter_width;
+  const int c = g * (s.input_channels / s.groups) + k / filter_size;
+  return filter[(c * output_step + m) * filter_size + k % filter_size];
+}
+
+// The element (k, n) of the implicit im2col matrix of the group g, which is
+// zero in the paddings.
+template <typename T, bool kTranspose>
+HOSTDEVICE inline T ImplicitGemmConvInput(const T* input,
+                                          const ImplicitGemmConvShape& s,
+                                          int g, int k, int n) {
+  const int filter_size = s.filter_height * s.filter_width;
+  const int c = g * (s.input_channels / s.groups) + k / filter_size;
+  const int kh = k % filter_size / s.filter_width;
+  const int kw = k % s.filter_width;
+  const int output_size = s.output_height * s.output_width;
+  const int b = n / output_size;
+  const int oh = n % output_size / s.output_width;
+  const int ow = n % s.output_width;
+  int ih, iw;
+  if (!kTranspose) {
+    ih = oh * s.stride_height - s.padding_height + kh * s.dilation_height;
+    iw = ow * s.stride_width - s.padding_width + kw * s.dilation_width;
+  } else {
+    // The input pixel scattered to (oh, ow) by the filter element (kh, kw).
+    ih = oh + s.padding_height - kh * s.dilation_height;
+    iw = ow + s.padding_width - kw * s.dilation_width;
+    if (ih < 0 || iw < 0 || ih % s.stride_height || iw % s.stride_width) {
+      return static_cast<T>(0);
+    }
+    ih /= s.stride_height;
+    iw /= s.stride_width;
+  }
+  if (ih < 0 || ih >= s.input_height || iw < 0 || iw >= s.input_width) {
+    return static_cast<T>(0);
+  }
+  return input[((b * s.input_channels + c) * s.input_height + ih) *
+                   s.input_width +
+               iw];
+}
+
+// The offset of the element (m, n) of the output matrix of the group g.
+HOSTDEVICE inline int ImplicitGemmConvOutputOffset(
+    const ImplicitGemmConvShape& s, int g, int m, int n) {
+  const int output_size = s.output_height * s.output_width;
+  const int b = n / output_size;
+  const int c = g * (s.output_channels / s.groups) + m;
+  return (b * s.output_channels + c) * output_size + n % output_size;
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,156 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/implicit_gemm_conv.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "paddle/fluid/framework/tensor_util.h"
+
+namespace {
+
+void RandomVec(const int n, float* a) {
+  std::mt19937 rng(100);
+  std::uniform_real_distribution<float> uniform_dist(-1, 1);
+  for (int i = 0; i < n; ++i) {
+    a[i] = uniform_dist(rng);
+  }
+}
+
+struct ConvCase {
+  int n, c, h, w, k, groups, filter_size, stride, pad, dilation;
+};
+
+// Compares the implicit GEMM convolution, or the transposed one, with the
+// naive loops, which scatter each input pixel to the outputs for the
+// transposed convolution.
+void TestImplicitGemmConv(const ConvCase& t, bool transpose) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  const int dkernel = t.dilation * (t.filter_size - 1) + 1;
+  const int oh = transpose ? (t.h - 1) * t.stride - 2 * t.pad + dkernel
+                           : (t.h + 2 * t.pad - dkernel) / t.stride + 1;
+  const int ow = transpose ? (t.w - 1) * t.stride - 2 * t.pad + dkernel
+                           : (t.w + 2 * t.pad - dkernel) / t.stride + 1;
+  const int fsize = t.filter_size * t.filter_size;
+  const int c_step = t.c / t.groups;
+  const int k_step = t.k / t.groups;
+
+  paddle::framework::Tensor input, filter, output;
+  float* x = input.mutable_data<float>({t.n, t.c, t.h, t.w}, place);
+  float* f = transpose
+                 ? filter.mutable_data<float>(
+                       {t.c, k_step, t.filter_size, t.filter_size}, place)
+                 : filter.mutable_data<float>(
+                       {t.k, c_step, t.filter_size, t.filter_size}, place);
+  output.mutable_data<float>({t.n, t.k, oh, ow}, place);
+  RandomVec(input.numel(), x);
+  RandomVec(filter.numel(), f);
+
+  std::vector<int> strides({t.stride, t.stride});
+  std::vector<int> paddings({t.pad, t.pad});
+  std::vector<int> dilations({t.dilation, t.dilation});
+  if (transpose) {
+    paddle::operators::math::ImplicitGemmConvTransposeFunctor<
+        paddle::platform::CPUDeviceContext, float>()(
+        context, input, filter, strides, paddings, dilations, t.groups,
+        &output);
+  } else {
+    paddle::operators::math::ImplicitGemmConvFunctor<
+        paddle::platform::CPUDeviceContext, float>()(
+        context, input, filter, strides, paddings, dilations, t.groups,
+        &output);
+  }
+
+  std::vector<float> ref(output.numel(), 0.f);
+  for (int i = 0; i < t.n; ++i) {
+    for (int c = 0; c < t.c; ++c) {
+      const int g = c / c_step;
+      for (int o = g * k_step; o < (g + 1) * k_step; ++o) {
+        const int wi = transpose ? (c * k_step + o - g * k_step) * fsize
+                                 : (o * c_step + c - g * c_step) * fsize;
+        const int in_h = transpose ? t.h : oh;
+        const int in_w = transpose ? t.w : ow;
+        for (int y = 0; y < in_h; ++y) {
+          for (int z = 0; z < in_w; ++z) {
+            for (int p = 0; p < t.filter_size; ++p) {
+              for (int q = 0; q < t.filter_size; ++q) {
+                // (y, z) is the input pixel of the transposed convolution
+                // and the output pixel of the convolution.
+                const int sy = y * t.stride - t.pad + p * t.dilation;
+                const int sz = z * t.stride - t.pad + q * t.dilation;
+                const float weight = f[wi + p * t.filter_size + q];
+                if (transpose) {
+                  if (sy < 0 || sy >= oh || sz < 0 || sz >= ow) continue;
+                  ref[((i * t.k + o) * oh + sy) * ow + sz] +=
+                      weight * x[((i * t.c + c) * t.h + y) * t.w + z];
+                } else {
+                  if (sy < 0 || sy >= t.h || sz < 0 || sz >= t.w) continue;
+                  ref[((i * t.k + o) * oh + y) * ow + z] +=
+                      weight * x[((i * t.c + c) * t.h + sy) * t.w + sz];
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  const float* y = output.data<float>();
+  for (int64_t i = 0; i < output.numel(); ++i) {
+    EXPECT_NEAR(y[i], ref[i], 1e-4);
+  }
+
+#ifdef PADDLE_WITH_CUDA
+  paddle::platform::CUDAPlace gpu(0);
+  paddle::platform::CUDADeviceContext gpu_context(gpu);
+  paddle::framework::Tensor gpu_input, gpu_filter, gpu_output, cpu_output;
+  paddle::framework::TensorCopySync(input, gpu, &gpu_input);
+  paddle::framework::TensorCopySync(filter, gpu, &gpu_filter);
+  gpu_output.mutable_data<float>(output.dims(), gpu);
+  if (transpose) {
+    paddle::operators::math::ImplicitGemmConvTransposeFunctor<
+        paddle::platform::CUDADeviceContext, float>()(
+        gpu_context, gpu_input, gpu_filter, strides, paddings, dilations,
+        t.groups, &gpu_output);
+  } else {
+    paddle::operators::math::ImplicitGemmConvFunctor<
+        paddle::platform::CUDADeviceContext, float>()(
+        gpu_context, gpu_input, gpu_filter, strides, paddings, dilations,
+        t.groups, &gpu_output);
+  }
+  gpu_context.Wait();
+  paddle::framework::TensorCopySync(gpu_output, place, &cpu_output);
+  const float* gpu_y = cpu_output.data<float>();
+  for (int64_t i = 0; i < output.numel(); ++i) {
+    EXPECT_NEAR(gpu_y[i], ref[i], 1e-4);
+  }
+#endif
+}
+
+const std::vector<ConvCase> kCases = {
+    {2, 3, 9, 11, 4, 1, 3, 1, 1, 1},  {1, 8, 12, 12, 6, 2, 3, 2, 1, 1},
+    {2, 4, 10, 9, 8, 4, 3, 1, 2, 2},  {1, 5, 7, 7, 70, 1, 1, 1, 0, 1},
+    {3, 6, 13, 8, 9, 3, 5, 3, 2, 1},  {1, 16, 5, 6, 130, 1, 3, 1, 1, 1},
+};
+
+}  // namespace
+
+TEST(ImplicitGemmConv, conv) {
+  for (auto& t : kCases) TestImplicitGemmConv(t, false);
+}
+
+TEST(ImplicitGemmConv, conv_transpose) {
+  for (auto& t : kCases) TestImplicitGemmConv(t, true);
+}
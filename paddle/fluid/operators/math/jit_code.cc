@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/math/jit_code.h"
+#include <algorithm>
 #include "paddle/fluid/operators/math/jit_kernel.h"
 #include "paddle/fluid/platform/cpu_info.h"
 
@@ -66,6 +67,91 @@ void VMulJitCode::generate() {
   ret();
 }
 
+// The sizes larger than this are left to blas, which does better with packing.
+#define GEMM_JIT_MAX_SIZE 64
+
+bool GEMMJitCode::init(int m, int n, int k, bool trans_a, bool trans_b) {
+  // b is loaded by vectors of the rows, which a transposed b has not.
+  if (trans_b || m <= 0 || n <= 0 || k <= 0 || m > GEMM_JIT_MAX_SIZE ||
+      n > GEMM_JIT_MAX_SIZE || k > GEMM_JIT_MAX_SIZE) {
+    return false;
+  }
+  return (MayIUse(avx512f) && n % AVX512_FLOAT_BLOCK == 0) ||
+         (MayIUse(avx2) && n % AVX2_FLOAT_BLOCK == 0);
+}
+
+template <typename reg_t>
+void GEMMJitCode::GenerateBlock(int row, int rows, int col, int vecs,
+                                int block) {
+  // the offsets of a(i, l) are i * a_row + l * a_col
+  const int a_row = (trans_a_ ? 1 : k_) * sizeof(float);
+  const int a_col = (trans_a_ ? m_ : 1) * sizeof(float);
+  const int vec_size = block * sizeof(float);
+  // vecs registers of b, one of the broadcast a and rows * vecs of c
+  reg_t bcast(vecs);
+  auto acc = [&](int i, int j) { return reg_t(vecs + 1 + i * vecs + j); };
+  auto compute = [&](bool first) {
+    for (int j = 0; j < vecs; ++j) {
+      vmovups(reg_t(j), ptr[reg_b + j * vec_size]);
+    }
+    for (int i = 0; i < rows; ++i) {
+      vbroadcastss(bcast, ptr[reg_a + i * a_row]);
+      for (int j = 0; j < vecs; ++j) {
+        if (first) {
+          vmulps(acc(i, j), bcast, reg_t(j));
+        } else {
+          vfmadd231ps(acc(i, j), bcast, reg_t(j));
+        }
+      }
+    }
+    add(reg_a, a_col);
+    add(reg_b, n_ * sizeof(float));
+  };
+
+  lea(reg_a, ptr[param1 + row * a_row]);
+  lea(reg_b, ptr[param2 + col * sizeof(float)]);
+  // the first step initializes the sums, so c need not be zeroed
+  compute(true);
+  if (k_ > 1) {
+    Label l_next_k;
+    mov(reg_k, k_ - 1);
+    L(l_next_k);
+    compute(false);
+    dec(reg_k);
+    jnz(l_next_k, T_NEAR);
+  }
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < vecs; ++j) {
+      int offset = ((row + i) * n_ + col + j * block) * sizeof(float);
+      vmovups(ptr[param3 + offset], acc(i, j));
+    }
+  }
+}
+
+void GEMMJitCode::generate() {
+  // avx512 has 32 registers for blocks of 6 rows x 4 vectors, avx2 has 16 for
+  // blocks of 4 rows x 3 vectors.
+  const bool use_avx512 = MayIUse(avx512f) && n_ % AVX512_FLOAT_BLOCK == 0;
+  const int block = use_avx512 ? AVX512_FLOAT_BLOCK : AVX2_FLOAT_BLOCK;
+  const int max_rows = use_avx512 ? 6 : 4;
+  const int max_vecs = use_avx512 ? 4 : 3;
+  const int num_vecs = n_ / block;
+  for (int row = 0; row < m_; row += max_rows) {
+    int rows = std::min(max_rows, m_ - row);
+    for (int vec = 0; vec < num_vecs; vec += max_vecs) {
+      int vecs = std::min(max_vecs, num_vecs - vec);
+      if (use_avx512) {
+        GenerateBlock<zmm_t>(row, rows, vec * block, vecs, block);
+      } else {
+        GenerateBlock<ymm_t>(row, rows, vec * block, vecs, block);
+      }
+    }
+  }
+  ret();
+}
+
+#undef GEMM_JIT_MAX_SIZE
+
 }  // namespace gen
 }  // namespace jitkernel
 }  // namespace math
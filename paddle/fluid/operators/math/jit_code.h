@@ -53,6 +53,34 @@ class VMulJitCode : public JitCode {
   ymm_t ymm_dst = ymm_t(2);
 };
 
+// c = a * b, where a is m x k (or k x m if trans_a), b is k x n and c is m x n,
+// all dense and row major. The whole c is computed by register blocks of
+// several rows and vectors, which keep the partial sums until the end of k.
+class GEMMJitCode : public JitCode {
+ public:
+  DECLARE_JIT_CODE(GEMMJitCode);
+  explicit GEMMJitCode(int m, int n, int k, bool trans_a,
+                       size_t code_size = 256 * 1024, void* code_ptr = nullptr)
+      : JitCode(code_size, code_ptr), m_(m), n_(n), k_(k), trans_a_(trans_a) {}
+  static bool init(int m, int n, int k, bool trans_a, bool trans_b);
+  void generate() override;
+
+ private:
+  template <typename reg_t>
+  void GenerateBlock(int row, int rows, int col, int vecs, int block);
+
+  int m_, n_, k_;
+  bool trans_a_;
+  reg64_t param1{abi_param1};
+  reg64_t param2{abi_param2};
+  reg64_t param3{abi_param3};
+
+  // volatile on both the SysV and the Windows ABI
+  reg64_t reg_a{rax};
+  reg64_t reg_b{r10};
+  reg64_t reg_k{r11};
+};
+
 }  // namespace gen
 }  // namespace jitkernel
 }  // namespace math
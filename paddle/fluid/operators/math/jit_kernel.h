@@ -152,6 +152,48 @@ class GRUKernel : public Kernel {
   virtual void ComputeHtPart2(T *gates, const T *ht_1, T *ht) const = 0;
 };
 
+// c = a * b of small matrices, where a is m x k (or k x m if trans_a), b is
+// k x n (or n x k if trans_b) and c is m x n, all dense and row major.
+template <typename T>
+class GEMMKernel : public Kernel {
+ public:
+  // Whether the sizes have a jitcode, the others should better go to blas.
+  static bool UseJIT(int m, int n, int k, bool trans_a, bool trans_b);
+  virtual void Compute(const T *a, const T *b, T *c) const = 0;
+};
+
+template <>
+bool GEMMKernel<float>::UseJIT(int m, int n, int k, bool trans_a,
+                               bool trans_b);
+template <>
+bool GEMMKernel<double>::UseJIT(int m, int n, int k, bool trans_a,
+                                bool trans_b);
+
+// Row wise softmax of bs rows with d columns.
+template <typename T>
+class SoftmaxKernel : public Kernel {
+ public:
+  virtual void Compute(const T *x, T *y, int bs) const = 0;
+};
+
+// Normalize height rows with d columns, the mean and variance of each row are
+// saved too. The scale and bias could be nullptr.
+template <typename T>
+class LayerNormKernel : public Kernel {
+ public:
+  virtual void Compute(const T *x, T *out, T *mean, T *var, const T *scale,
+                       const T *bias, int height,
+                       const float epsilon) const = 0;
+};
+
+// Pool h rows with d columns into one row, the pooltype could be "SUM",
+// "AVERAGE", "SQRT" or "MAX".
+template <typename T>
+class SequencePoolKernel : public Kernel {
+ public:
+  virtual void Compute(const T *x, T *y, int h) const = 0;
+};
+
 template <typename T>
 class CRFDecodeKernel : public Kernel {
  public:
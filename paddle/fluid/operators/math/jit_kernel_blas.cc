@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/math/jit_kernel.h"
 #include <string>
+#include <type_traits>
 #include "paddle/fluid/operators/math/jit_kernel_macro.h"
 #include "paddle/fluid/platform/enforce.h"
 
@@ -114,6 +115,113 @@ bool VMulKernelImpl<double>::useMKL(int d) {
 
 REGISTER_JITKERNEL(vmul, VMulKernel);
 
+/* GEMM JitKernel */
+template <typename T>
+void GEMMRefer(int m, int n, int k, bool trans_a, bool trans_b, const T* a,
+               const T* b, T* c) {
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      T sum = static_cast<T>(0);
+      for (int l = 0; l < k; ++l) {
+        sum += a[trans_a ? l * m + i : i * k + l] *
+               b[trans_b ? j * k + l : l * n + j];
+      }
+      c[i * n + j] = sum;
+    }
+  }
+}
+
+template <>
+bool GEMMKernel<float>::UseJIT(int m, int n, int k, bool trans_a,
+                               bool trans_b) {
+#ifdef PADDLE_WITH_XBYAK
+  return gen::GEMMJitCode::init(m, n, k, trans_a, trans_b);
+#else
+  return false;
+#endif
+}
+
+template <>
+bool GEMMKernel<double>::UseJIT(int m, int n, int k, bool trans_a,
+                                bool trans_b) {
+  return false;
+}
+
+template <typename T>
+class GEMMKernelImpl : public GEMMKernel<T> {
+ public:
+  static inline std::string name(int m, int n, int k, bool trans_a,
+                                 bool trans_b) {
+    std::string key = std::string("gemm") +
+                      (std::is_same<T, float>::value ? "f" : "d") +
+                      std::to_string(m) + "x" + std::to_string(n) + "x" +
+                      std::to_string(k) + (trans_a ? "t" : "n") +
+                      (trans_b ? "t" : "n");
+    return key + (GEMMKernel<T>::UseJIT(m, n, k, trans_a, trans_b) ? "jit"
+                                                                    : "any");
+  }
+
+  GEMMKernelImpl(int m, int n, int k, bool trans_a, bool trans_b)
+      : GEMMKernel<T>(),
+        m_(m),
+        n_(n),
+        k_(k),
+        trans_a_(trans_a),
+        trans_b_(trans_b) {
+#ifdef PADDLE_WITH_XBYAK
+    if (GEMMKernel<T>::UseJIT(m, n, k, trans_a, trans_b)) {
+      // roughly estimate the size of code
+      size_t sz = 96 + (m / 4 + 1) * (n / AVX_FLOAT_BLOCK + 1) * 256;
+      jitcode_.reset(
+          new gen::GEMMJitCode(m, n, k, trans_a, sz > 4096 ? sz : 4096));
+      jitfunc_ = jitcode_->getCode<void (*)(const T*, const T*, T*)>();
+    }
+#endif
+  }
+
+  void Compute(const T* a, const T* b, T* c) const override {
+#ifdef PADDLE_WITH_XBYAK
+    if (jitfunc_) {
+      jitfunc_(a, b, c);
+      return;
+    }
+#endif
+    GEMMRefer<T>(m_, n_, k_, trans_a_, trans_b_, a, b, c);
+  }
+
+ private:
+  int m_, n_, k_;
+  bool trans_a_, trans_b_;
+#ifdef PADDLE_WITH_XBYAK
+  std::unique_ptr<gen::GEMMJitCode> jitcode_{nullptr};
+  void (*jitfunc_)(const T*, const T*, T*){nullptr};
+#endif
+};
+
+#define JITKERNEL_DECLARE_GEMM(ker_class, ker_dtype)                \
+  template <>                                                       \
+  std::shared_ptr<const ker_class<ker_dtype>>                       \
+  KernelPool::Get<ker_class<ker_dtype>, int, int, int, bool, bool>( \
+      int m, int n, int k, bool trans_a, bool trans_b)
+
+#define JITKERNEL_FIND_KEY_GEMM(ker_class, ker_dtype) \
+  std::string key =                                   \
+      ker_class##Impl<ker_dtype>::name(m, n, k, trans_a, trans_b)
+
+#define JITKERNEL_GEMM_IMPL(ker_class, ker_dtype)                   \
+  p = std::dynamic_pointer_cast<ker_class<ker_dtype>>(              \
+      std::make_shared<ker_class##Impl<ker_dtype>>(m, n, k, trans_a, \
+                                                   trans_b))
+
+REGISTER_JITKERNEL_WITH_DTYPE(GEMMKernel, float, JITKERNEL_DECLARE_GEMM,
+                              JITKERNEL_FIND_KEY_GEMM, JITKERNEL_GEMM_IMPL);
+REGISTER_JITKERNEL_WITH_DTYPE(GEMMKernel, double, JITKERNEL_DECLARE_GEMM,
+                              JITKERNEL_FIND_KEY_GEMM, JITKERNEL_GEMM_IMPL);
+
+#undef JITKERNEL_DECLARE_GEMM
+#undef JITKERNEL_FIND_KEY_GEMM
+#undef JITKERNEL_GEMM_IMPL
+
 /* VADD JitKernel */
 template <typename T, platform::jit::cpu_isa_t isa, jit_block>
 class VAddKernelImpl : public VAddKernel<T> {
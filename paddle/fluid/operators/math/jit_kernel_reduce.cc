@@ -0,0 +1,296 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/jit_kernel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include "paddle/fluid/operators/math/jit_kernel_macro.h"
+#include "paddle/fluid/platform/enforce.h"
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+namespace paddle {
+namespace operators {
+namespace math {
+namespace jitkernel {
+namespace jit = platform::jit;
+
+/* The reductions of one row */
+template <typename T, jit::cpu_isa_t isa>
+struct RowOps {
+  static T Sum(const T* x, int n) {
+    T sum = static_cast<T>(0);
+    for (int i = 0; i < n; ++i) {
+      sum += x[i];
+    }
+    return sum;
+  }
+  static T SquareSum(const T* x, int n) {
+    T sum = static_cast<T>(0);
+    for (int i = 0; i < n; ++i) {
+      sum += x[i] * x[i];
+    }
+    return sum;
+  }
+  static T Max(const T* x, int n) {
+    T max = x[0];
+    for (int i = 1; i < n; ++i) {
+      max = x[i] > max ? x[i] : max;
+    }
+    return max;
+  }
+  // y = max(x, y)
+  static void VMax(const T* x, T* y, int n) {
+    for (int i = 0; i < n; ++i) {
+      y[i] = x[i] > y[i] ? x[i] : y[i];
+    }
+  }
+};
+
+#ifdef __AVX__
+struct AVXFloatRowOps {
+  static float HorizontalSum(__m256 x) {
+    __m128 tmp = _mm_add_ps(_mm256_castps256_ps128(x),
+                            _mm256_extractf128_ps(x, 1));
+    tmp = _mm_hadd_ps(tmp, tmp);
+    tmp = _mm_hadd_ps(tmp, tmp);
+    return _mm_cvtss_f32(tmp);
+  }
+  static float HorizontalMax(__m256 x) {
+    __m128 tmp = _mm_max_ps(_mm256_castps256_ps128(x),
+                            _mm256_extractf128_ps(x, 1));
+    tmp = _mm_max_ps(tmp, _mm_shuffle_ps(tmp, tmp, _MM_SHUFFLE(1, 0, 3, 2)));
+    tmp = _mm_max_ps(tmp, _mm_shuffle_ps(tmp, tmp, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(tmp);
+  }
+  static float Sum(const float* x, int n) {
+    __m256 acc = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + AVX_FLOAT_BLOCK <= n; i += AVX_FLOAT_BLOCK) {
+      acc = _mm256_add_ps(acc, _mm256_loadu_ps(x + i));
+    }
+    float sum = HorizontalSum(acc);
+    for (; i < n; ++i) {
+      sum += x[i];
+    }
+    return sum;
+  }
+  static float SquareSum(const float* x, int n) {
+    __m256 acc = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + AVX_FLOAT_BLOCK <= n; i += AVX_FLOAT_BLOCK) {
+      __m256 tmp = _mm256_loadu_ps(x + i);
+      acc = _mm256_add_ps(acc, _mm256_mul_ps(tmp, tmp));
+    }
+    float sum = HorizontalSum(acc);
+    for (; i < n; ++i) {
+      sum += x[i] * x[i];
+    }
+    return sum;
+  }
+  static float Max(const float* x, int n) {
+    if (n < AVX_FLOAT_BLOCK) {
+      return RowOps<float, jit::isa_any>::Max(x, n);
+    }
+    __m256 acc = _mm256_loadu_ps(x);
+    int i = AVX_FLOAT_BLOCK;
+    for (; i + AVX_FLOAT_BLOCK <= n; i += AVX_FLOAT_BLOCK) {
+      acc = _mm256_max_ps(acc, _mm256_loadu_ps(x + i));
+    }
+    float max = HorizontalMax(acc);
+    for (; i < n; ++i) {
+      max = x[i] > max ? x[i] : max;
+    }
+    return max;
+  }
+  static void VMax(const float* x, float* y, int n) {
+    int i = 0;
+    for (; i + AVX_FLOAT_BLOCK <= n; i += AVX_FLOAT_BLOCK) {
+      _mm256_storeu_ps(y + i, _mm256_max_ps(_mm256_loadu_ps(x + i),
+                                            _mm256_loadu_ps(y + i)));
+    }
+    for (; i < n; ++i) {
+      y[i] = x[i] > y[i] ? x[i] : y[i];
+    }
+  }
+};
+
+#define AVX_FLOAT_ROW_OPS(isa) \
+  template <>                  \
+  struct RowOps<float, isa> : public AVXFloatRowOps {}
+
+AVX_FLOAT_ROW_OPS(jit::avx);
+#ifdef __AVX2__
+AVX_FLOAT_ROW_OPS(jit::avx2);
+#endif
+#ifdef __AVX512F__
+AVX_FLOAT_ROW_OPS(jit::avx512f);
+#endif
+
+#undef AVX_FLOAT_ROW_OPS
+#endif
+
+/* Softmax JitKernel */
+template <typename T, jit::cpu_isa_t isa, jit_block>
+class SoftmaxKernelImpl : public SoftmaxKernel<T> {
+ public:
+  explicit SoftmaxKernelImpl(int d) : SoftmaxKernel<T>() {
+    this->num_ = d;
+    vaddbias_ = KernelPool::Instance().template Get<VAddBiasKernel<T>>(d);
+    vexp_ = KernelPool::Instance().template Get<VExpKernel<T>>(d);
+    vscal_ = KernelPool::Instance().template Get<VScalKernel<T>>(d);
+  }
+  void Compute(const T* x, T* y, int bs) const override {
+    // clip the shifted logits as math::ValueClip, so that no probability
+    // underflows to zero
+    const T kThreshold = static_cast<T>(-64.);
+    const int d = this->num_;
+    for (int i = 0; i < bs; ++i, x += d, y += d) {
+      vaddbias_->Compute(-RowOps<T, isa>::Max(x, d), x, y);
+      for (int j = 0; j < d; ++j) {
+        y[j] = y[j] < kThreshold ? kThreshold : y[j];
+      }
+      vexp_->Compute(y, y);
+      vscal_->Compute(static_cast<T>(1) / RowOps<T, isa>::Sum(y, d), y);
+    }
+  }
+
+ private:
+  std::shared_ptr<const VAddBiasKernel<T>> vaddbias_;
+  std::shared_ptr<const VExpKernel<T>> vexp_;
+  std::shared_ptr<const VScalKernel<T>> vscal_;
+};
+
+REGISTER_JITKERNEL_DEPRECATED(softmax, SoftmaxKernel);
+
+/* LayerNorm JitKernel */
+template <typename T, jit::cpu_isa_t isa, jit_block>
+class LayerNormKernelImpl : public LayerNormKernel<T> {
+ public:
+  explicit LayerNormKernelImpl(int d) : LayerNormKernel<T>() {
+    this->num_ = d;
+    vaddbias_ = KernelPool::Instance().template Get<VAddBiasKernel<T>>(d);
+    vscal_ = KernelPool::Instance().template Get<VScalKernel<T>>(d);
+    vmul_ = KernelPool::Instance().template Get<VMulKernel<T>>(d);
+    vadd_ = KernelPool::Instance().template Get<VAddKernel<T>>(d);
+  }
+  void Compute(const T* x, T* out, T* mean, T* var, const T* scale,
+               const T* bias, int height, const float epsilon) const override {
+    const int d = this->num_;
+    for (int i = 0; i < height; ++i, x += d, out += d) {
+      mean[i] = RowOps<T, isa>::Sum(x, d) / d;
+      vaddbias_->Compute(-mean[i], x, out);
+      var[i] = RowOps<T, isa>::SquareSum(out, d) / d;
+      vscal_->Compute(
+          static_cast<T>(1) / std::sqrt(var[i] + static_cast<T>(epsilon)),
+          out);
+      if (scale) {
+        vmul_->Compute(out, scale, out, d);
+      }
+      if (bias) {
+        vadd_->Compute(out, bias, out);
+      }
+    }
+  }
+
+ private:
+  std::shared_ptr<const VAddBiasKernel<T>> vaddbias_;
+  std::shared_ptr<const VScalKernel<T>> vscal_;
+  std::shared_ptr<const VMulKernel<T>> vmul_;
+  std::shared_ptr<const VAddKernel<T>> vadd_;
+};
+
+REGISTER_JITKERNEL_DEPRECATED(layer_norm, LayerNormKernel);
+
+/* SequencePool JitKernel */
+enum class SequencePoolType { kSum, kAverage, kSqrt, kMax };
+
+template <typename T, jit::cpu_isa_t isa, jit_block>
+class SequencePoolKernelImpl : public SequencePoolKernel<T> {
+ public:
+  SequencePoolKernelImpl(const std::string& pooltype, int d)
+      : SequencePoolKernel<T>() {
+    this->num_ = d;
+    if (pooltype == "SUM") {
+      type_ = SequencePoolType::kSum;
+    } else if (pooltype == "AVERAGE") {
+      type_ = SequencePoolType::kAverage;
+    } else if (pooltype == "SQRT") {
+      type_ = SequencePoolType::kSqrt;
+    } else if (pooltype == "MAX") {
+      type_ = SequencePoolType::kMax;
+    } else {
+      PADDLE_THROW("Not support pooltype %s of SequencePoolKernel", pooltype);
+    }
+    vadd_ = KernelPool::Instance().template Get<VAddKernel<T>>(d);
+    vscal_ = KernelPool::Instance().template Get<VScalKernel<T>>(d);
+  }
+  void Compute(const T* x, T* y, int h) const override {
+    const int d = this->num_;
+    if (h == 0) {
+      std::fill(y, y + d, static_cast<T>(0));
+      return;
+    }
+    std::memcpy(y, x, d * sizeof(T));
+    for (int r = 1; r < h; ++r) {
+      x += d;
+      if (type_ == SequencePoolType::kMax) {
+        RowOps<T, isa>::VMax(x, y, d);
+      } else {
+        vadd_->Compute(x, y, y);
+      }
+    }
+    if (type_ == SequencePoolType::kAverage) {
+      vscal_->Compute(static_cast<T>(1) / h, y);
+    } else if (type_ == SequencePoolType::kSqrt) {
+      vscal_->Compute(static_cast<T>(1) / std::sqrt(static_cast<T>(h)), y);
+    }
+  }
+
+ private:
+  SequencePoolType type_;
+  std::shared_ptr<const VAddKernel<T>> vadd_;
+  std::shared_ptr<const VScalKernel<T>> vscal_;
+};
+
+#define JITKERNEL_DECLARE_SEQ_POOL(ker_class, ker_dtype)                  \
+  template <>                                                             \
+  std::shared_ptr<const SequencePoolKernel<ker_dtype>>                    \
+  KernelPool::Get<SequencePoolKernel<ker_dtype>, const std::string&, int>( \
+      const std::string& pooltype, int d)
+
+#define JITKERNEL_KEY_SEQ_POOL(ker_key, dtype_key) \
+  #ker_key #dtype_key + std::to_string(d) + pooltype
+
+#define JITKERNEL_NEW_SEQ_POOL_IMPL(ker, dtype, isa, k) \
+  p = std::dynamic_pointer_cast<ker<dtype>>(            \
+      std::make_shared<ker##Impl<dtype, isa, k>>(pooltype, d))
+
+REGISTER_JITKERNEL_ARGS_DEPRECATED(seq_pool, SequencePoolKernel,
+                                   JITKERNEL_DECLARE_SEQ_POOL,
+                                   JITKERNEL_KEY_SEQ_POOL,
+                                   JITKERNEL_NEW_SEQ_POOL_IMPL);
+
+#undef JITKERNEL_DECLARE_SEQ_POOL
+#undef JITKERNEL_KEY_SEQ_POOL
+#undef JITKERNEL_NEW_SEQ_POOL_IMPL
+
+}  // namespace jitkernel
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -633,6 +633,159 @@ TEST(JitKernel, vmul) {
   }
 }
 
+void gemm_ref(const int m, const int n, const int k, bool trans_a,
+              const float* a, const float* b, float* c) {
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      float sum = 0.f;
+      for (int l = 0; l < k; ++l) {
+        sum += a[trans_a ? l * m + i : i * k + l] * b[l * n + j];
+      }
+      c[i * n + j] = sum;
+    }
+  }
+}
+
+TEST(JitKernel, gemm) {
+  namespace jit = paddle::operators::math::jitkernel;
+  for (int m : {1, 3, 4, 7, 16, 33}) {
+    for (int n : {8, 16, 24, 48, 64, 10}) {
+      for (int k : {1, 5, 16, 64}) {
+        for (bool trans_a : {false, true}) {
+          std::vector<float> a(m * k), b(k * n);
+          std::vector<float> cref(m * n), ctgt(m * n);
+          RandomVec<float>(m * k, a.data(), -2.f, 2.f);
+          RandomVec<float>(k * n, b.data(), -2.f, 2.f);
+          const auto& ker =
+              jit::KernelPool::Instance()
+                  .template Get<jit::GEMMKernel<float>, int, int, int, bool,
+                                bool>(m, n, k, trans_a, false);
+          auto trefs = GetCurrentUS();
+          for (int i = 0; i < repeat / 100; ++i) {
+            gemm_ref(m, n, k, trans_a, a.data(), b.data(), cref.data());
+          }
+          auto trefe = GetCurrentUS();
+          auto ttgts = GetCurrentUS();
+          for (int i = 0; i < repeat / 100; ++i) {
+            ker->Compute(a.data(), b.data(), ctgt.data());
+          }
+          auto ttgte = GetCurrentUS();
+          VLOG(3) << "GEMM " << m << "x" << n << "x" << k
+                  << (trans_a ? " trans_a" : "") << ": jit "
+                  << jit::GEMMKernel<float>::UseJIT(m, n, k, trans_a, false)
+                  << ", refer takes: " << (trefe - trefs) / (repeat / 100)
+                  << " us, tgt takes: " << (ttgte - ttgts) / (repeat / 100);
+          for (int i = 0; i < m * n; ++i) {
+            EXPECT_NEAR(ctgt[i], cref[i], 1e-3);
+          }
+        }
+      }
+    }
+  }
+  // the sizes larger than the threshold are left to blas
+  EXPECT_FALSE(jit::GEMMKernel<float>::UseJIT(128, 8, 8, false, false));
+  EXPECT_FALSE(jit::GEMMKernel<float>::UseJIT(8, 8, 8, false, true));
+  EXPECT_FALSE(jit::GEMMKernel<double>::UseJIT(8, 8, 8, false, false));
+}
+
+void softmax_ref(const int bs, const int d, const float* x, float* y) {
+  for (int i = 0; i < bs; ++i, x += d, y += d) {
+    float max = x[0];
+    for (int j = 1; j < d; ++j) {
+      max = x[j] > max ? x[j] : max;
+    }
+    float sum = 0.f;
+    for (int j = 0; j < d; ++j) {
+      y[j] = std::exp(x[j] - max);
+      sum += y[j];
+    }
+    for (int j = 0; j < d; ++j) {
+      y[j] /= sum;
+    }
+  }
+}
+
+TEST(JitKernel, softmax) {
+  namespace jit = paddle::operators::math::jitkernel;
+  const int bs = 4;
+  for (int d : {1, 7, 8, 15, 16, 30, 256, 1000}) {
+    std::vector<float> x(bs * d), yref(bs * d), ytgt(bs * d);
+    RandomVec<float>(bs * d, x.data(), -5.f, 5.f);
+    const auto& ker =
+        jit::KernelPool::Instance().template Get<jit::SoftmaxKernel<float>>(d);
+    softmax_ref(bs, d, x.data(), yref.data());
+    ker->Compute(x.data(), ytgt.data(), bs);
+    for (int i = 0; i < bs * d; ++i) {
+      EXPECT_NEAR(ytgt[i], yref[i], 1e-5);
+    }
+  }
+}
+
+TEST(JitKernel, layer_norm) {
+  namespace jit = paddle::operators::math::jitkernel;
+  const int height = 4;
+  const float epsilon = 1e-5f;
+  for (int d : {1, 7, 8, 15, 16, 30, 256, 1000}) {
+    std::vector<float> x(height * d), out(height * d), scale(d), bias(d);
+    std::vector<float> mean(height), var(height);
+    RandomVec<float>(height * d, x.data(), -5.f, 5.f);
+    RandomVec<float>(d, scale.data(), -2.f, 2.f);
+    RandomVec<float>(d, bias.data(), -2.f, 2.f);
+    const auto& ker = jit::KernelPool::Instance()
+                          .template Get<jit::LayerNormKernel<float>>(d);
+    ker->Compute(x.data(), out.data(), mean.data(), var.data(), scale.data(),
+                 bias.data(), height, epsilon);
+    for (int i = 0; i < height; ++i) {
+      const float* row = x.data() + i * d;
+      float mean_ref = 0.f, var_ref = 0.f;
+      for (int j = 0; j < d; ++j) {
+        mean_ref += row[j];
+      }
+      mean_ref /= d;
+      for (int j = 0; j < d; ++j) {
+        var_ref += (row[j] - mean_ref) * (row[j] - mean_ref);
+      }
+      var_ref /= d;
+      EXPECT_NEAR(mean[i], mean_ref, 1e-4);
+      EXPECT_NEAR(var[i], var_ref, 1e-3);
+      for (int j = 0; j < d; ++j) {
+        float ref = (row[j] - mean_ref) / std::sqrt(var_ref + epsilon) *
+                        scale[j] +
+                    bias[j];
+        EXPECT_NEAR(out[i * d + j], ref, 1e-3);
+      }
+    }
+  }
+}
+
+TEST(JitKernel, seq_pool) {
+  namespace jit = paddle::operators::math::jitkernel;
+  const int h = 5;
+  for (int d : {1, 7, 8, 15, 16, 30, 256}) {
+    std::vector<float> x(h * d), y(d);
+    RandomVec<float>(h * d, x.data());
+    for (std::string type : {"SUM", "AVERAGE", "SQRT", "MAX"}) {
+      const auto& ker = jit::KernelPool::Instance()
+                            .template Get<jit::SequencePoolKernel<float>,
+                                          const std::string&, int>(type, d);
+      ker->Compute(x.data(), y.data(), h);
+      for (int j = 0; j < d; ++j) {
+        float ref = x[j];
+        for (int i = 1; i < h; ++i) {
+          float v = x[i * d + j];
+          ref = type == "MAX" ? (v > ref ? v : ref) : ref + v;
+        }
+        if (type == "AVERAGE") {
+          ref /= h;
+        } else if (type == "SQRT") {
+          ref /= std::sqrt(static_cast<float>(h));
+        }
+        EXPECT_NEAR(y[j], ref, 1e-3);
+      }
+    }
+  }
+}
+
 void vadd_ref(const int n, const float* x, const float* y, float* z) {
   for (int i = 0; i < n; ++i) {
     z[i] = x[i] + y[i];
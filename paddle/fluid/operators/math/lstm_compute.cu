@@ -47,10 +47,30 @@ struct LstmUnitGradFunctor<platform::CUDADeviceContext, T> {
   }
 };
 
+template <class T>
+bool PersistentLstmFunctor<platform::CUDADeviceContext, T>::compute(
+    const platform::CUDADeviceContext& context, LstmMetaValue<T> value,
+    const T* weight, const T* h0, const framework::Vector<size_t>& batch_starts,
+    int num_seqs, int frame_size, const detail::ActivationType& gate_act,
+    const detail::ActivationType& cell_act,
+    const detail::ActivationType& cand_act) {
+  if (frame_size * 4 > 1024) {
+    return false;
+  }
+  int num_steps = static_cast<int>(batch_starts.size()) - 1;
+  detail::gpu_persistent_lstm_forward<T>(
+      context, detail::forward::lstm<T>(), value, weight, h0,
+      batch_starts.CUDAData(context.GetPlace()), num_steps, num_seqs,
+      frame_size, cand_act, gate_act, cell_act);
+  return true;
+}
+
 template class LstmUnitFunctor<platform::CUDADeviceContext, float>;
 template class LstmUnitFunctor<platform::CUDADeviceContext, double>;
 template class LstmUnitGradFunctor<platform::CUDADeviceContext, float>;
 template class LstmUnitGradFunctor<platform::CUDADeviceContext, double>;
+template struct PersistentLstmFunctor<platform::CUDADeviceContext, float>;
+template struct PersistentLstmFunctor<platform::CUDADeviceContext, double>;
 
 }  // namespace math
 }  // namespace operators
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include "paddle/fluid/framework/mixed_vector.h"
 #include "paddle/fluid/operators/math/detail/activation_functions.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -66,6 +67,39 @@ class LstmUnitGradFunctor {
                       const detail::ActivationType &cand_act);
 };
 
+/*
+ * Compute all the steps of the sequences in the batch layout given by
+ * batch_starts by one persistent kernel, the projection of the hidden by
+ * weight included, instead of one GEMM and one LstmUnitFunctor per step.
+ * h0 may be nullptr. Return false if the device or frame_size is not supported.
+ */
+template <typename DeviceContext, typename T>
+struct PersistentLstmFunctor {
+  static bool compute(const DeviceContext &context, LstmMetaValue<T> value,
+                      const T *weight, const T *h0,
+                      const framework::Vector<size_t> &batch_starts,
+                      int num_seqs, int frame_size,
+                      const detail::ActivationType &gate_act,
+                      const detail::ActivationType &cell_act,
+                      const detail::ActivationType &cand_act) {
+    return false;
+  }
+};
+
+#ifdef PADDLE_WITH_CUDA
+template <typename T>
+struct PersistentLstmFunctor<platform::CUDADeviceContext, T> {
+  // One thread per gate, so frame_size should be no larger than 256.
+  static bool compute(const platform::CUDADeviceContext &context,
+                      LstmMetaValue<T> value, const T *weight, const T *h0,
+                      const framework::Vector<size_t> &batch_starts,
+                      int num_seqs, int frame_size,
+                      const detail::ActivationType &gate_act,
+                      const detail::ActivationType &cell_act,
+                      const detail::ActivationType &cand_act);
+};
+#endif
+
 }  // namespace math
 }  // namespace operators
 }  // namespace paddle
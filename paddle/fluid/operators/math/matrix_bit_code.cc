@@ -13,7 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/math/matrix_bit_code.h"
+#include <algorithm>
 #include <iostream>
+#include <vector>
 namespace paddle {
 namespace operators {
 namespace math {
@@ -124,6 +126,38 @@ void MatrixBitCodeFunctor<T>::MulGradWeight(const framework::Tensor& tmat,
   }
 }
 
+template <typename T>
+void MatrixBitCodeFunctor<T>::MulGradWeight(const framework::Tensor& tmat,
+                                            framework::SelectedRows* weight,
+                                            const framework::Tensor& input) {
+  SimpleCodeTable code_table(num_classes_);
+  size_t num_samples = tmat.dims()[0];
+  size_t input_width = input.dims()[1];
+  size_t tmat_width = tmat.dims()[1];
+  auto tmat_value = tmat.data<T>();
+  auto input_value = input.data<T>();
+  std::vector<int64_t> rows(num_samples * tmat_width, 0);
+  auto* weight_value = weight->mutable_value()->mutable_data<T>(
+      framework::make_ddim({static_cast<int64_t>(rows.size()),
+                            static_cast<int64_t>(input_width)}),
+      tmat.place());
+  std::fill(weight_value, weight_value + rows.size() * input_width,
+            static_cast<T>(0.0));
+  for (size_t i = 0; i < num_samples; ++i) {
+    auto code = code_table(static_cast<size_t>(ids_[i]));
+    int code_length = code.get_length();
+    for (int j = 0; j < code_length; ++j) {
+      size_t row = i * tmat_width + j;
+      rows[row] = static_cast<int64_t>(code.calc_index(j));
+      for (size_t k = 0; k < input_width; ++k) {
+        weight_value[input_width * row + k] =
+            tmat_value[i * tmat_width + j] * input_value[input_width * i + k];
+      }
+    }
+  }
+  weight->set_rows(rows);
+}
+
 template <typename T>
 void MatrixBitCodeFunctor<T>::MulGradError(const framework::Tensor& tmat,
                                            const framework::Tensor& weight,
@@ -14,8 +14,10 @@ limitations under the License. */
 
 #pragma once
 #include "paddle/fluid/framework/eigen.h"
+#include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/hostdevice.h"
 
 #if defined(_WIN32)
 #include <intrin.h>
@@ -95,7 +97,8 @@ inline size_t FindLastSet(size_t x) { return sizeof(size_t) * 8 - clz(x); }
 }
 
 struct SimpleCode {
-  SimpleCode(size_t code, size_t num_classes) : c_(code + num_classes) {}
+  HOSTDEVICE SimpleCode(size_t code, size_t num_classes)
+      : c_(code + num_classes) {}
   /**
    * Here the id of root shoud be 1 rather than 0, thus the encoding of class c
    * is `c + num_classes` and all siblings can get the same weight indice using
@@ -105,9 +108,19 @@ struct SimpleCode {
    * Binary classification path is the suffixes of encoding, thus leave out the
    * left most bit in calc_bit.
    */
-  inline size_t calc_index(int bit) const { return (c_ >> (bit + 1)) - 1; }
-  inline bool calc_bit(int bit) const { return c_ & (1 << bit); }
-  inline int get_length() const { return FindLastSet(c_) - 1; }
+  HOSTDEVICE inline size_t calc_index(int bit) const {
+    return (c_ >> (bit + 1)) - 1;
+  }
+  HOSTDEVICE inline bool calc_bit(int bit) const { return c_ & (1 << bit); }
+  // The CUDA kernels of hierarchical_sigmoid compute the codes on device.
+  HOSTDEVICE inline int get_length() const {
+#ifdef __CUDA_ARCH__
+    return 8 * sizeof(unsigned long long) -  // NOLINT
+           __clzll(static_cast<unsigned long long>(c_)) - 1;  // NOLINT
+#else
+    return FindLastSet(c_) - 1;
+#endif
+  }
 
  private:
   size_t c_;
@@ -160,6 +173,14 @@ class MatrixBitCodeFunctor {
   */
   void MulGradWeight(const framework::Tensor& tmat, framework::Tensor* weight,
                      const framework::Tensor& input);
+  /* For j < code_length
+      weight.row(i * code_length + j) = tmat(i, j) * input.row(i)
+     and rows(i * code_length + j) = index(i, j). The rows out of the path
+     of a sample are 0 and have zero gradients.
+  */
+  void MulGradWeight(const framework::Tensor& tmat,
+                     framework::SelectedRows* weight,
+                     const framework::Tensor& input);
   /* For j < code_length
     input.row(i) += tmat(i, j) * weight.row(index(i, j))
   */
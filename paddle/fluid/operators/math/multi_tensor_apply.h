@@ -0,0 +1,126 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <algorithm>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// Each block of a multi-tensor kernel runs over a chunk of a tensor, so the
+// small and the big tensors of a pack are balanced over the blocks.
+constexpr int64_t kMultiTensorChunkSize = 4096;
+constexpr int kMultiTensorThreads = 512;
+
+// The functors of a pack of tensors, passed to the kernel by value. So the
+// pack is limited by the 4KB of the kernel parameters, and a list of tensors
+// takes a launch per pack.
+template <typename Functor>
+struct MultiTensorPack {
+  static constexpr int kMaxTensors =
+      3072 / (sizeof(Functor) + sizeof(int64_t) + sizeof(int));
+  static_assert(kMaxTensors > 0, "The functor is too big to be packed.");
+
+  int num_tensors;
+  int64_t numel[kMaxTensors];
+  // The first block of each tensor, and the number of blocks at the end.
+  int block_offsets[kMaxTensors + 1];
+  typename std::aligned_storage<sizeof(Functor), alignof(Functor)>::type
+      functors[kMaxTensors];
+
+  HOSTDEVICE const Functor& functor(int t) const {
+    return *reinterpret_cast<const Functor*>(&functors[t]);
+  }
+};
+
+#ifdef __NVCC__
+// Find the functor of the tensor of this block, and the chunk [begin, end)
+// of the tensor to run.
+template <typename Functor>
+__device__ inline const Functor& MultiTensorChunk(
+    const MultiTensorPack<Functor>& pack, int64_t* begin, int64_t* end) {
+  int t = 0;
+  while (static_cast<int>(blockIdx.x) >= pack.block_offsets[t + 1]) {
+    ++t;
+  }
+  *begin = static_cast<int64_t>(blockIdx.x - pack.block_offsets[t]) *
+           kMultiTensorChunkSize;
+  *end = min(*begin + kMultiTensorChunkSize, pack.numel[t]);
+  return pack.functor(t);
+}
+
+// functor(i) for each element i of each tensor of the pack.
+template <typename Functor>
+__global__ void MultiTensorApplyKernel(const MultiTensorPack<Functor> pack) {
+  int64_t begin, end;
+  const Functor& functor = MultiTensorChunk(pack, &begin, &end);
+  for (int64_t i = begin + threadIdx.x; i < end; i += blockDim.x) {
+    functor(i);
+  }
+}
+
+// Launch kernel over the packs of functors[i], each running over numels[i]
+// elements.
+template <typename Functor>
+void LaunchMultiTensorKernel(const platform::CUDADeviceContext& ctx,
+                             const std::vector<Functor>& functors,
+                             const std::vector<int64_t>& numels,
+                             void (*kernel)(const MultiTensorPack<Functor>)) {
+  PADDLE_ENFORCE_EQ(functors.size(), numels.size());
+  MultiTensorPack<Functor> pack;
+  pack.num_tensors = 0;
+  pack.block_offsets[0] = 0;
+  auto launch = [&] {
+    if (pack.num_tensors > 0) {
+      kernel<<<pack.block_offsets[pack.num_tensors], kMultiTensorThreads, 0,
+               ctx.stream()>>>(pack);
+    }
+    pack.num_tensors = 0;
+  };
+  for (size_t i = 0; i < functors.size(); ++i) {
+    if (numels[i] == 0) continue;
+    int t = pack.num_tensors;
+    int64_t blocks =
+        (numels[i] + kMultiTensorChunkSize - 1) / kMultiTensorChunkSize;
+    new (&pack.functors[t]) Functor(functors[i]);
+    pack.numel[t] = numels[i];
+    pack.block_offsets[t + 1] =
+        pack.block_offsets[t] + static_cast<int>(blocks);
+    if (++pack.num_tensors == MultiTensorPack<Functor>::kMaxTensors) {
+      launch();
+    }
+  }
+  launch();
+}
+
+// Run functors[i](j) for each j in [0, numels[i]) by a launch per pack.
+template <typename Functor>
+void MultiTensorApply(const platform::CUDADeviceContext& ctx,
+                      const std::vector<Functor>& functors,
+                      const std::vector<int64_t>& numels) {
+  LaunchMultiTensorKernel(ctx, functors, numels,
+                          MultiTensorApplyKernel<Functor>);
+}
+#endif
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
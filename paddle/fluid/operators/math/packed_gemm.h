@@ -0,0 +1,141 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <string>
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/jit_kernel.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The attribute of mul, fc and matmul, set by the inference analyzer when the
+// weight is a persistable which never changes.
+constexpr char kUsePackedWeight[] = "use_packed_weight";
+
+/*
+ * Compute out (m x n) = x (m x k) * w, where w is the input `w_param` of the
+ * op, k x n, or n x k if trans_w.
+ *
+ * The w is packed by MKL at the first call, and cached in the scope of w as
+ * the variable w@PACKED (w@PACKED_T if trans_w), so that the later requests
+ * only call GEMM_COMPUTE. It is only valid while w is not changed.
+ *
+ * Return false if the packed GEMM is not available or not worth it, then the
+ * caller should compute it by the plain GEMM.
+ */
+template <typename DeviceContext, typename T>
+struct PackedMatMul {
+  bool operator()(const framework::ExecutionContext& ctx,
+                  const std::string& w_param, bool trans_w, int m, int n,
+                  int k, const T* x, T* out) const {
+    return false;
+  }
+};
+
+#ifdef PADDLE_WITH_MKLML
+template <typename T>
+class PackedWeight {
+ public:
+  PackedWeight() = default;
+  PackedWeight(const PackedWeight&) = delete;
+  PackedWeight& operator=(const PackedWeight&) = delete;
+  ~PackedWeight() {
+    if (data_) {
+      CBlas<T>::GEMM_FREE(data_);
+    }
+  }
+
+  bool empty() const { return data_ == nullptr; }
+
+  void Pack(const BlasT<platform::CPUDeviceContext, T>& blas, const T* w,
+            bool trans_w, int n, int k) {
+    // the height of c is not needed by a packed b, see also gru_op
+    data_ = blas.GEMM_ALLOC(CblasBMatrix, 1, n, k);
+    PADDLE_ENFORCE_NOT_NULL(data_, "Failed to allocate the packed weight");
+    blas.GEMM_PACK(CblasBMatrix, trans_w ? CblasTrans : CblasNoTrans, 1, n, k,
+                   static_cast<T>(1), w, trans_w ? k : n, data_);
+    n_ = n;
+    k_ = k;
+  }
+
+  const T* data() const { return data_; }
+  int n() const { return n_; }
+  int k() const { return k_; }
+
+ private:
+  T* data_{nullptr};
+  int n_{0};
+  int k_{0};
+};
+
+// Only float and double have the MKL packed GEMM, not the float16 kernels.
+template <typename T>
+struct CPUPackedMatMul {
+  bool operator()(const framework::ExecutionContext& ctx,
+                  const std::string& w_param, bool trans_w, int m, int n,
+                  int k, const T* x, T* out) const {
+    // the jitcode is faster for the small matrices
+    if (jitkernel::GEMMKernel<T>::UseJIT(m, n, k, false, trans_w)) {
+      return false;
+    }
+    auto* w_var = ctx.InputVar(w_param);
+    auto* scope = ctx.scope().FindScope(w_var);
+    if (scope == nullptr) {
+      return false;
+    }
+    auto blas = GetBlas<platform::CPUDeviceContext, T>(ctx);
+    const std::string name = ctx.op().Input(w_param) +
+                             (trans_w ? "@PACKED_T" : "@PACKED");
+    PackedWeight<T>* packed = nullptr;
+    {
+      // the scope of weight is shared by the predictors of all the threads
+      static std::mutex mutex;
+      std::lock_guard<std::mutex> lock(mutex);
+      packed = const_cast<framework::Scope*>(scope)
+                   ->Var(name)
+                   ->GetMutable<PackedWeight<T>>();
+      if (packed->empty()) {
+        auto& w = w_var->Get<framework::LoDTensor>();
+        PADDLE_ENFORCE_EQ(w.numel(), static_cast<int64_t>(n) * k,
+                          "The weight %s does not match the GEMM",
+                          ctx.op().Input(w_param));
+        packed->Pack(blas, w.data<T>(), trans_w, n, k);
+      }
+    }
+    PADDLE_ENFORCE(packed->n() == n && packed->k() == k,
+                   "The packed weight %s is %d x %d, but %d x %d is wanted",
+                   name, packed->k(), packed->n(), k, n);
+    blas.GEMM_COMPUTE(CblasNoTrans, CblasPacked, m, n, k, x, k, packed->data(),
+                      n, static_cast<T>(0), out, n);
+    return true;
+  }
+};
+
+template <>
+struct PackedMatMul<platform::CPUDeviceContext, float>
+    : public CPUPackedMatMul<float> {};
+
+template <>
+struct PackedMatMul<platform::CPUDeviceContext, double>
+    : public CPUPackedMatMul<double> {};
+#endif
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -14,11 +14,53 @@ limitations under the License. */
 #include "paddle/fluid/operators/math/pooling.h"
 #include <algorithm>
 #include <vector>
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
 
 namespace paddle {
 namespace operators {
 namespace math {
 
+// Pools the first output columns of a row of the 2x2 pooling with the
+// stride 2 and no padding, from the input rows x0 and x1, by NEON. Returns
+// the number of the columns pooled, 0 without NEON.
+template <typename PoolProcess, typename T>
+inline int Pool2x2Stride2Row(PoolProcess pool_process, const T* x0,
+                             const T* x1, int input_width, int output_width,
+                             T* y) {
+  return 0;
+}
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+inline int Pool2x2Stride2Row(MaxPool<float> pool_process, const float* x0,
+                             const float* x1, int input_width,
+                             int output_width, float* y) {
+  const int n = std::min(output_width, input_width / 2) / 4 * 4;
+  for (int pw = 0; pw < n; pw += 4) {
+    float32x4x2_t a = vld2q_f32(x0 + 2 * pw);
+    float32x4x2_t b = vld2q_f32(x1 + 2 * pw);
+    vst1q_f32(y + pw, vmaxq_f32(vmaxq_f32(a.val[0], a.val[1]),
+                                vmaxq_f32(b.val[0], b.val[1])));
+  }
+  return n;
+}
+
+inline int Pool2x2Stride2Row(AvgPool<float> pool_process, const float* x0,
+                             const float* x1, int input_width,
+                             int output_width, float* y) {
+  const int n = std::min(output_width, input_width / 2) / 4 * 4;
+  for (int pw = 0; pw < n; pw += 4) {
+    float32x4x2_t a = vld2q_f32(x0 + 2 * pw);
+    float32x4x2_t b = vld2q_f32(x1 + 2 * pw);
+    float32x4_t sum = vaddq_f32(vaddq_f32(a.val[0], a.val[1]),
+                                vaddq_f32(b.val[0], b.val[1]));
+    vst1q_f32(y + pw, vmulq_n_f32(sum, 0.25f));
+  }
+  return n;
+}
+#endif
+
 /*
  * All tensors are in NCHW format.
  * Ksize, strides, paddings are two elements. These two elements represent
@@ -51,13 +93,23 @@ class Pool2dFunctor<platform::CPUDeviceContext, PoolProcess, T> {
     const T* input_data = input.data<T>();
     T* output_data = output->mutable_data<T>(context.GetPlace());
 
+    const bool pool_2x2 = ksize_height == 2 && ksize_width == 2 &&
+                          stride_height == 2 && stride_width == 2 &&
+                          padding_height == 0 && padding_width == 0;
     for (int i = 0; i < batch_size; i++) {
       for (int c = 0; c < output_channels; ++c) {
         for (int ph = 0; ph < output_height; ++ph) {
           int hstart = ph * stride_height - padding_height;
           int hend = std::min(hstart + ksize_height, input_height);
           hstart = std::max(hstart, 0);
-          for (int pw = 0; pw < output_width; ++pw) {
+          int pw = 0;
+          if (pool_2x2 && hend - hstart == 2) {
+            pw = Pool2x2Stride2Row(
+                pool_process, input_data + hstart * input_width,
+                input_data + (hstart + 1) * input_width, input_width,
+                output_width, output_data + ph * output_width);
+          }
+          for (; pw < output_width; ++pw) {
             int wstart = pw * stride_width - padding_width;
             int wend = std::min(wstart + ksize_width, input_width);
             wstart = std::max(wstart, 0);
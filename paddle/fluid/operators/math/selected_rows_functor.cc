@@ -12,10 +12,13 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
-#include <set>
-#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <type_traits>
 
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/jit_kernel.h"
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
 
 namespace paddle {
@@ -229,24 +232,27 @@ template struct SelectedRowsAddToTensor<platform::CPUDeviceContext, int64_t>;
 // add or mul.
 namespace scatter {
 
-template <typename DeviceContext, typename T>
-typename std::enable_if<
-    std::is_floating_point<T>::value &&
-    std::is_same<DeviceContext, platform::CPUDeviceContext>::value>::type
-elementwise_add_to(const DeviceContext& ctx, BlasT<DeviceContext, T>* blas,
-                   size_t data_len, const T* in, T* out) {
-  blas->AXPY(data_len, 1., in, out);
+// out += in of the rows of width elements, by the jit VAdd kernel for the
+// floating points.
+template <typename T>
+typename std::enable_if<std::is_floating_point<T>::value,
+                        std::function<void(const T*, T*)>>::type
+RowAddFunction(int64_t width) {
+  auto vadd = jitkernel::KernelPool::Instance()
+                  .template Get<jitkernel::VAddKernel<T>>(
+                      static_cast<int>(width));
+  return [vadd](const T* in, T* out) { vadd->Compute(in, out, out); };
 }
 
-template <typename DeviceContext, typename T>
-typename std::enable_if<
-    !std::is_floating_point<T>::value &&
-    std::is_same<DeviceContext, platform::CPUDeviceContext>::value>::type
-elementwise_add_to(const DeviceContext& ctx, BlasT<DeviceContext, T>* blas,
-                   size_t data_len, const T* in, T* out) {
-  for (int64_t i = 0; i < data_len; i++) {
-    out[i] += in[i];
-  }
+template <typename T>
+typename std::enable_if<!std::is_floating_point<T>::value,
+                        std::function<void(const T*, T*)>>::type
+RowAddFunction(int64_t width) {
+  return [width](const T* in, T* out) {
+    for (int64_t i = 0; i < width; ++i) {
+      out[i] += in[i];
+    }
+  };
 }
 
 template <typename T>
@@ -287,7 +293,6 @@ struct MergeAdd<platform::CPUDeviceContext, T> {
     auto input_width = has_value_input->value().dims()[1];
     auto input_height = has_value_input->height();
     framework::SelectedRows& out = *output;
-    std::set<int64_t> merged_row_set;
     for (auto* input : inputs) {
       if (input->rows().size() == 0) {
         continue;
@@ -297,41 +302,59 @@ struct MergeAdd<platform::CPUDeviceContext, T> {
                         "dimension except for the first one");
       PADDLE_ENFORCE_EQ(input_height, input->height(),
                         "all input should have same height");
-      merged_row_set.insert(input->rows().begin(), input->rows().end());
-    }
-    std::vector<int64_t> merge_rows(merged_row_set.begin(),
-                                    merged_row_set.end());
-    std::unordered_map<int64_t, size_t> rows_to_id;
-    for (size_t i = 0; i < merge_rows.size(); ++i) {
-      rows_to_id[merge_rows[i]] = i;
     }
-    out.set_rows(merge_rows);
-    out.set_height(input_height);
-    out.mutable_value()->mutable_data<T>(
-        framework::make_ddim(
-            {static_cast<int64_t>(merge_rows.size()), input_width}),
-        context.GetPlace());
-
-    math::SetConstant<platform::CPUDeviceContext, T> constant_functor;
-    constant_functor(context, out.mutable_value(), 0.0);
+    std::vector<int64_t> merge_rows = MergedRows(inputs);
+    size_t num_merged = merge_rows.size();
 
-    auto* out_data = out.mutable_value()->data<T>();
-
-    auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
+    // The input rows of each merged row, sorted by the merged rows, so each
+    // merged row is summed by one thread without any lookup.
+    std::vector<size_t> offsets(num_merged + 1, 0);
+    std::vector<size_t> out_ids;
+    for (auto* input : inputs) {
+      for (auto row : input->rows()) {
+        size_t id = std::lower_bound(merge_rows.begin(), merge_rows.end(),
+                                     row) -
+                    merge_rows.begin();
+        out_ids.push_back(id);
+        ++offsets[id + 1];
+      }
+    }
+    for (size_t i = 0; i < num_merged; ++i) {
+      offsets[i + 1] += offsets[i];
+    }
+    std::vector<const T*> sources(out_ids.size());
+    std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+    size_t k = 0;
     for (auto* input : inputs) {
       if (input->rows().size() == 0) {
         continue;
       }
       auto* input_data = input->value().data<T>();
-      auto& input_rows = input->rows();
-
-      for (size_t i = 0; i < input_rows.size(); i++) {
-        size_t out_i = rows_to_id[input_rows[i]];
-        elementwise_add_to<platform::CPUDeviceContext, T>(
-            context, &blas, static_cast<size_t>(input_width),
-            &input_data[i * input_width], &out_data[out_i * input_width]);
+      for (size_t i = 0; i < input->rows().size(); ++i) {
+        sources[next[out_ids[k++]]++] = input_data + i * input_width;
       }
     }
+
+    out.set_rows(merge_rows);
+    out.set_height(input_height);
+    auto* out_data = out.mutable_value()->mutable_data<T>(
+        framework::make_ddim({static_cast<int64_t>(num_merged), input_width}),
+        context.GetPlace());
+
+    auto add_row = RowAddFunction<T>(input_width);
+    context.ParallelFor(
+        static_cast<int64_t>(num_merged),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            T* dst = out_data + i * input_width;
+            std::memcpy(dst, sources[offsets[i]], input_width * sizeof(T));
+            for (size_t s = offsets[i] + 1; s < offsets[i + 1]; ++s) {
+              add_row(sources[s], dst);
+            }
+          }
+        },
+        input_width * static_cast<int64_t>(sources.size()) /
+            static_cast<int64_t>(num_merged));
   }
 };
 
@@ -12,7 +12,8 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
-#include <set>
+#include <algorithm>
+#include <numeric>
 #include <vector>
 
 #include "paddle/fluid/operators/math/math_function.h"
@@ -227,32 +228,72 @@ template struct SelectedRowsAddToTensor<platform::CUDADeviceContext, float>;
 template struct SelectedRowsAddToTensor<platform::CUDADeviceContext, double>;
 template struct SelectedRowsAddToTensor<platform::CUDADeviceContext, int>;
 template struct SelectedRowsAddToTensor<platform::CUDADeviceContext, int64_t>;
+template struct SelectedRowsAddToTensor<platform::CUDADeviceContext,
+                                        platform::float16>;
 
 namespace scatter {
 
-template <typename T, int block_size>
-__global__ void MergeAddKernel(const T* input, const int64_t* input_rows,
-                               T* out, const int64_t* out_rows,
-                               size_t out_rows_size, int64_t row_numel) {
-  const int ty = blockIdx.x;
-  int tid = threadIdx.x;
-  __shared__ size_t out_idx;
-
-  if (tid == 0) {
-    for (size_t i = 0; i < out_rows_size; i++) {
-      if (input_rows[ty] == out_rows[i]) {
-        out_idx = i;
-      }
+// Each block sums a segment of the input rows of the same merged row, so
+// neither a search of the merged rows nor an atomic add is needed. The
+// segments of an input are of distinct merged rows.
+template <typename T>
+__global__ void MergeAddSegmentKernel(const T* input, const int64_t* order,
+                                      const int64_t* segment_offsets,
+                                      const int64_t* segment_out_rows, T* out,
+                                      int64_t row_numel) {
+  const int64_t segment = blockIdx.x;
+  const int64_t begin = segment_offsets[segment];
+  const int64_t end = segment_offsets[segment + 1];
+  out += segment_out_rows[segment] * row_numel;
+  for (int64_t j = threadIdx.x; j < row_numel; j += blockDim.x) {
+    T sum(0);
+    for (int64_t s = begin; s < end; ++s) {
+      sum += input[order[s] * row_numel + j];
     }
+    out[j] += sum;
   }
+}
 
-  __syncthreads();
-
-  input += ty * row_numel;
-  out += out_idx * row_numel;
-  for (int index = tid; index < row_numel; index += block_size) {
-    paddle::platform::CudaAtomicAdd(out + index, input[index]);
+// out[merged row] += the rows of input, where merge_rows are sorted.
+template <typename T>
+static void MergeAddSegments(const platform::CUDADeviceContext& context,
+                             const framework::SelectedRows& input,
+                             const std::vector<int64_t>& merge_rows,
+                             T* out_data, int64_t row_numel) {
+  const auto& rows = input.rows();
+  size_t num_rows = rows.size();
+  if (num_rows == 0) return;
+  std::vector<int64_t> out_ids(num_rows);
+  for (size_t i = 0; i < num_rows; ++i) {
+    out_ids[i] =
+        std::lower_bound(merge_rows.begin(), merge_rows.end(), rows[i]) -
+        merge_rows.begin();
   }
+  std::vector<int64_t> order(num_rows);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+    return out_ids[a] < out_ids[b];
+  });
+
+  // [order | segment offsets | segment out rows], copied to the GPU at once.
+  std::vector<int64_t> index(order);
+  std::vector<int64_t> segment_out_rows;
+  for (size_t i = 0; i < num_rows; ++i) {
+    if (i == 0 || out_ids[order[i]] != out_ids[order[i - 1]]) {
+      index.push_back(i);
+      segment_out_rows.push_back(out_ids[order[i]]);
+    }
+  }
+  index.push_back(num_rows);
+  size_t num_segments = segment_out_rows.size();
+  index.insert(index.end(), segment_out_rows.begin(), segment_out_rows.end());
+
+  framework::Vector<int64_t> gpu_index(index);
+  const int64_t* index_data = gpu_index.CUDAData(context.GetPlace());
+  const int threads = 256;
+  MergeAddSegmentKernel<T><<<num_segments, threads, 0, context.stream()>>>(
+      input.value().data<T>(), index_data, index_data + num_rows,
+      index_data + num_rows + num_segments + 1, out_data, row_numel);
 }
 
 template <typename T>
@@ -267,39 +308,9 @@ struct MergeAdd<platform::CUDADeviceContext, T> {
   void operator()(const platform::CUDADeviceContext& context,
                   const framework::SelectedRows& input,
                   framework::SelectedRows* output) {
-    framework::Vector<int64_t> input_rows(input.rows());
-    if (input_rows.size() == 0) {
-      return;
-    }
-
-    framework::SelectedRows& out = *output;
-    std::set<int64_t> row_set(input_rows.begin(), input_rows.end());
-    std::vector<int64_t> merge_rows_cpu(row_set.begin(), row_set.end());
-    framework::Vector<int64_t> merge_rows(merge_rows_cpu);
-
-    auto input_width = input.value().dims()[1];
-
-    out.set_rows(merge_rows);
-    out.set_height(input.height());
-    out.mutable_value()->mutable_data<T>(
-        framework::make_ddim(
-            {static_cast<int64_t>(merge_rows.size()), input_width}),
-        context.GetPlace());
-
-    math::SetConstant<platform::CUDADeviceContext, T> constant_functor;
-    constant_functor(context, out.mutable_value(), 0.0);
-
-    auto* out_data = out.mutable_value()->data<T>();
-    auto* input_data = input.value().data<T>();
-
-    const int block_size = 256;
-    dim3 threads(block_size, 1);
-    dim3 grid1(input_rows.size(), 1);
-
-    MergeAddKernel<T, 256><<<grid1, threads, 0, context.stream()>>>(
-        input_data, input_rows.CUDAData(context.GetPlace()), out_data,
-        out.mutable_rows()->CUDAMutableData(context.GetPlace()),
-        out.rows().size(), input_width);
+    std::vector<const framework::SelectedRows*> inputs;
+    inputs.push_back(&input);
+    (*this)(context, inputs, output);
   }
 
   void operator()(const platform::CUDADeviceContext& context,
@@ -323,7 +334,6 @@ struct MergeAdd<platform::CUDADeviceContext, T> {
     auto input_width = has_value_input->value().dims()[1];
     auto input_height = has_value_input->height();
     framework::SelectedRows& out = *output;
-    std::set<int64_t> merged_row_set;
     for (auto* input : inputs) {
       if (input->rows().size() == 0) {
         continue;
@@ -333,10 +343,8 @@ struct MergeAdd<platform::CUDADeviceContext, T> {
                         "dimension except for the first one");
       PADDLE_ENFORCE_EQ(input_height, input->height(),
                         "all input should have same height");
-      merged_row_set.insert(input->rows().begin(), input->rows().end());
     }
-    std::vector<int64_t> merge_rows_cpu(merged_row_set.begin(),
-                                        merged_row_set.end());
+    std::vector<int64_t> merge_rows_cpu = MergedRows(inputs);
     framework::Vector<int64_t> merge_rows(merge_rows_cpu);
 
     out.set_rows(merge_rows);
@@ -347,25 +355,12 @@ struct MergeAdd<platform::CUDADeviceContext, T> {
         context.GetPlace());
 
     math::SetConstant<platform::CUDADeviceContext, T> constant_functor;
-    constant_functor(context, out.mutable_value(), 0.0);
+    constant_functor(context, out.mutable_value(), static_cast<T>(0));
 
     auto* out_data = out.mutable_value()->data<T>();
-
-    const int block_size = 256;
-    dim3 threads(block_size, 1);
-
     for (auto* input : inputs) {
-      if (input->rows().size() == 0) {
-        continue;
-      }
-      auto* input_data = input->value().data<T>();
-      auto& input_rows = input->rows();
-      dim3 grid1(input_rows.size(), 1);
-
-      MergeAddKernel<T, 256><<<grid1, threads, 0, context.stream()>>>(
-          input_data, input_rows.CUDAData(context.GetPlace()), out_data,
-          out.mutable_rows()->CUDAMutableData(context.GetPlace()),
-          out.rows().size(), input_width);
+      MergeAddSegments<T>(context, *input, merge_rows_cpu, out_data,
+                          input_width);
     }
   }
 };
@@ -374,6 +369,7 @@ template struct MergeAdd<platform::CUDADeviceContext, float>;
 template struct MergeAdd<platform::CUDADeviceContext, double>;
 template struct MergeAdd<platform::CUDADeviceContext, int>;
 template struct MergeAdd<platform::CUDADeviceContext, int64_t>;
+template struct MergeAdd<platform::CUDADeviceContext, platform::float16>;
 
 template <typename T, int block_size>
 __global__ void UpdateToTensorKernel(const T* selected_rows,
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 #pragma once
 
+#include <algorithm>
 #include <map>
 #include <vector>
 
@@ -73,6 +74,18 @@ struct SelectedRowsAddToTensor {
 };
 
 namespace scatter {
+// The sorted distinct rows of the non-empty inputs of MergeAdd.
+inline std::vector<int64_t> MergedRows(
+    const std::vector<const framework::SelectedRows*>& inputs) {
+  std::vector<int64_t> rows;
+  for (auto* input : inputs) {
+    rows.insert(rows.end(), input->rows().begin(), input->rows().end());
+  }
+  std::sort(rows.begin(), rows.end());
+  rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+  return rows;
+}
+
 // functors for manuplating SelectedRows data
 template <typename DeviceContext, typename T>
 struct MergeAdd {
@@ -13,6 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
+#include <chrono>  // NOLINT
+#include <random>
+#include <set>
 #include <vector>
 #include "gtest/gtest.h"
 #include "paddle/fluid/operators/math/math_function.h"
@@ -450,3 +453,52 @@ TEST(selected_rows_functor, cpu_sum_to) {
   // row9: 2.0 + 3.0
   EXPECT_EQ(tensor1_data[9 * row_numel + 6], 5.0);
 }
+
+// Many duplicated ids, as the gradient of lookup_table on a large batch.
+TEST(selected_rows_functor, cpu_merge_add_duplicated) {
+  paddle::platform::CPUPlace cpu_place;
+  paddle::platform::CPUDeviceContext ctx(cpu_place);
+
+  int64_t height = 1000;
+  int64_t row_numel = 64;
+  int64_t num_ids = 100000;
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<int64_t> dist(0, height - 1);
+  std::vector<int64_t> rows(num_ids);
+  for (auto& row : rows) {
+    row = dist(rng);
+  }
+  paddle::framework::SelectedRows input(rows, height);
+  auto* in_data = input.mutable_value()->mutable_data<float>(
+      paddle::framework::make_ddim({num_ids, row_numel}), cpu_place);
+  std::vector<double> expected(height * row_numel, 0);
+  for (int64_t i = 0; i < num_ids; ++i) {
+    for (int64_t j = 0; j < row_numel; ++j) {
+      in_data[i * row_numel + j] = static_cast<float>((i + j) % 7);
+      expected[rows[i] * row_numel + j] += (i + j) % 7;
+    }
+  }
+
+  paddle::framework::SelectedRows output;
+  paddle::operators::math::scatter::MergeAdd<paddle::platform::CPUDeviceContext,
+                                             float>
+      merge_add_functor;
+  auto start = std::chrono::steady_clock::now();
+  merge_add_functor(ctx, input, &output);
+  auto end = std::chrono::steady_clock::now();
+  LOG(INFO) << "MergeAdd of " << num_ids << " rows of " << row_numel
+            << " floats: "
+            << std::chrono::duration<double, std::micro>(end - start).count()
+            << " us";
+
+  std::set<int64_t> row_set(rows.begin(), rows.end());
+  std::vector<int64_t> expected_rows(row_set.begin(), row_set.end());
+  EXPECT_EQ(output.rows(), expected_rows);
+  auto* out_data = output.value().data<float>();
+  for (size_t i = 0; i < expected_rows.size(); ++i) {
+    for (int64_t j = 0; j < row_numel; ++j) {
+      EXPECT_EQ(out_data[i * row_numel + j],
+                static_cast<float>(expected[expected_rows[i] * row_numel + j]));
+    }
+  }
+}
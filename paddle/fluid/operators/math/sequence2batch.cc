@@ -39,14 +39,20 @@ class CopyMatrixRowsFunctor<platform::CPUDeviceContext, T> {
     auto* src_data = src.data<T>();
     auto* dst_data = dst->data<T>();
     const int sz = width * sizeof(T);
-    if (is_src_index) {
-      for (int i = 0; i < height; ++i) {
-        memcpy(dst_data + i * width, src_data + index[i] * width, sz);
+    // Copy the runs of consecutive indexes at once, which are the long tails
+    // of the skewed sequences in the batch order, or the whole tensor when all
+    // the sequences have one step.
+    for (int i = 0; i < height;) {
+      int j = i + 1;
+      while (j < height && index[j] == index[j - 1] + 1) {
+        ++j;
       }
-    } else {
-      for (int i = 0; i < height; ++i) {
-        memcpy(dst_data + index[i] * width, src_data + i * width, sz);
+      if (is_src_index) {
+        memcpy(dst_data + i * width, src_data + index[i] * width, sz * (j - i));
+      } else {
+        memcpy(dst_data + index[i] * width, src_data + i * width, sz * (j - i));
       }
+      i = j;
     }
   }
 };
@@ -86,8 +86,12 @@ class LoDTensor2BatchFunctor {
       seq_info.emplace_back(lod[seq_id], length, seq_id);
     }
 
-    std::sort(seq_info.begin(), seq_info.end(),
-              [](SeqInfo a, SeqInfo b) { return a.length > b.length; });
+    // The stable sort keeps the sequences of the same length in the input
+    // order, so that the rows to copy are more often consecutive.
+    std::stable_sort(seq_info.begin(), seq_info.end(),
+                     [](const SeqInfo& a, const SeqInfo& b) {
+                       return a.length > b.length;
+                     });
 
     // Calculate the start position of each batch.
     // example:  sequences = {s0, s1, s2}
@@ -0,0 +1,90 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/sequence2batch.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+template <typename T>
+void TestSequence2Batch(const paddle::framework::LoD& lod, const int width,
+                        bool is_reverse) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  const int64_t height = static_cast<int64_t>(lod[0].back());
+
+  paddle::framework::LoDTensor seq;
+  seq.set_lod(lod);
+  T* seq_data = seq.mutable_data<T>({height, width}, place);
+  for (int64_t i = 0; i < seq.numel(); ++i) {
+    seq_data[i] = static_cast<T>(i);
+  }
+
+  paddle::framework::LoDTensor batch;
+  batch.mutable_data<T>(seq.dims(), place);
+  paddle::operators::math::LoDTensor2BatchFunctor<
+      paddle::platform::CPUDeviceContext, T>
+      to_batch;
+  to_batch(context, seq, &batch, true, is_reverse);
+
+  // every row of batch is the row of seq at batch lod[1]
+  const auto& seq2batch_idx = batch.lod()[1];
+  ASSERT_EQ(seq2batch_idx.size(), static_cast<size_t>(height));
+  const T* batch_data = batch.data<T>();
+  for (int64_t i = 0; i < height; ++i) {
+    for (int j = 0; j < width; ++j) {
+      EXPECT_EQ(batch_data[i * width + j],
+                seq_data[seq2batch_idx[i] * width + j]);
+    }
+  }
+
+  // the sequences of the same length stay in the input order
+  const auto& seq_order = batch.lod()[2];
+  for (size_t i = 1; i < seq_order.size(); ++i) {
+    size_t pre_len = lod[0][seq_order[i - 1] + 1] - lod[0][seq_order[i - 1]];
+    size_t len = lod[0][seq_order[i] + 1] - lod[0][seq_order[i]];
+    EXPECT_GE(pre_len, len);
+    if (pre_len == len) {
+      EXPECT_LT(seq_order[i - 1], seq_order[i]);
+    }
+  }
+
+  paddle::framework::LoDTensor seq_back;
+  seq_back.mutable_data<T>(seq.dims(), place);
+  paddle::operators::math::Batch2LoDTensorFunctor<
+      paddle::platform::CPUDeviceContext, T>
+      to_seq;
+  to_seq(context, batch, &seq_back);
+  const T* seq_back_data = seq_back.data<T>();
+  for (int64_t i = 0; i < seq.numel(); ++i) {
+    EXPECT_EQ(seq_back_data[i], seq_data[i]);
+  }
+}
+
+TEST(Sequence2Batch, CPU) {
+  paddle::framework::LoD lod1;
+  lod1.push_back(std::vector<size_t>{0, 4, 9, 12});
+  TestSequence2Batch<float>(lod1, 3, false);
+  TestSequence2Batch<float>(lod1, 3, true);
+
+  // the skewed lengths, which have a long tail of one sequence
+  paddle::framework::LoD lod2;
+  lod2.push_back(std::vector<size_t>{0, 1, 2, 40, 42, 43});
+  TestSequence2Batch<double>(lod2, 5, false);
+  TestSequence2Batch<double>(lod2, 5, true);
+
+  // all the sequences have one step
+  paddle::framework::LoD lod3;
+  lod3.push_back(std::vector<size_t>{0, 1, 2, 3, 4});
+  TestSequence2Batch<float>(lod3, 2, false);
+}
@@ -19,7 +19,9 @@ namespace paddle {
 namespace operators {
 namespace math {
 
-template <typename T, CopyType Type>
+// Every block row pads a step of a sequence, so the blocks of the long and the
+// short sequences do the same work.
+template <typename T>
 __global__ void SequencePaddingKernel(
     T* dst, const T* src, const T* pad_value, bool is_constant_pad,
     const size_t* seq_offsets, const size_t seq_num, const size_t pad_seq_len,
@@ -33,22 +35,57 @@ __global__ void SequencePaddingKernel(
                                ? (seq_idx * pad_seq_len + step_idx) * step_width
                                : (step_idx * seq_num + seq_idx) * step_width;
 
-  T* dst_data = dst + (Type == kSeqToPad ? pad_data_offset : seq_data_offset);
-  const T* src_data =
-      src + (Type == kSeqToPad ? seq_data_offset : pad_data_offset);
+  T* dst_data = dst + pad_data_offset;
+  const T* src_data = src + seq_data_offset;
 
   if (step_idx < seq_len) {
     float scale = norm_by_len ? (1.0f / static_cast<float>(seq_len)) : 1.0f;
     for (size_t i = threadIdx.x; i < step_width; i += blockDim.x) {
       dst_data[i] = scale * src_data[i];
     }
-  } else if (step_idx < pad_seq_len && Type == kSeqToPad) {
+  } else if (step_idx < pad_seq_len) {
     for (size_t i = threadIdx.x; i < step_width; i += blockDim.x) {
       dst_data[i] = is_constant_pad ? pad_value[0] : pad_value[i];
     }
   }
 }
 
+// Every block row copies a row of the sequences, whose sequence is found by
+// the binary search of seq_offsets, so no block is left idle by the padding
+// steps of the short sequences.
+template <typename T>
+__global__ void SequenceUnpaddingKernel(
+    T* dst, const T* src, const size_t* seq_offsets, const size_t seq_num,
+    const size_t seq_rows, const size_t pad_seq_len, const size_t step_width,
+    bool norm_by_len, const PadLayout layout) {
+  size_t row = blockIdx.x * blockDim.y + threadIdx.y;
+  if (row >= seq_rows) return;
+
+  size_t low = 0;
+  size_t high = seq_num;
+  while (high - low > 1) {
+    size_t mid = (low + high) >> 1;
+    if (seq_offsets[mid] <= row) {
+      low = mid;
+    } else {
+      high = mid;
+    }
+  }
+  size_t seq_idx = low;
+  size_t seq_len = seq_offsets[seq_idx + 1] - seq_offsets[seq_idx];
+  size_t step_idx = row - seq_offsets[seq_idx];
+  size_t pad_data_offset = layout == kBatchLengthWidth
+                               ? (seq_idx * pad_seq_len + step_idx) * step_width
+                               : (step_idx * seq_num + seq_idx) * step_width;
+
+  T* dst_data = dst + row * step_width;
+  const T* src_data = src + pad_data_offset;
+  float scale = norm_by_len ? (1.0f / static_cast<float>(seq_len)) : 1.0f;
+  for (size_t i = threadIdx.x; i < step_width; i += blockDim.x) {
+    dst_data[i] = scale * src_data[i];
+  }
+}
+
 template <typename T>
 class PaddingLoDTensorFunctor<platform::CUDADeviceContext, T> {
  public:
@@ -58,8 +95,9 @@ class PaddingLoDTensorFunctor<platform::CUDADeviceContext, T> {
                   const framework::LoDTensor& pad_value, int pad_seq_len = -1,
                   int lod_level = 0, bool norm_by_times = false,
                   const PadLayout layout = kBatchLengthWidth) {
-    auto seq_lod = seq_tensor.lod();
-    const auto seq_offsets = framework::ToAbsOffset(seq_lod)[lod_level];
+    // The last level is shared by the absolute offsets, with its device copy.
+    const auto seq_offsets =
+        framework::ToAbsOffset(seq_tensor.lod())[lod_level];
     const auto& seq_tensor_dims = seq_tensor.dims();
     const auto& pad_tensor_dims = pad_tensor->dims();
     int max_seq_len = MaximumSequenceLength(seq_offsets);
@@ -102,7 +140,7 @@ class PaddingLoDTensorFunctor<platform::CUDADeviceContext, T> {
     T* pad_data = pad_tensor->data<T>();
     const T* pad_value_data = pad_value.data<T>();
 
-    SequencePaddingKernel<T, kSeqToPad><<<grid, threads, 0, context.stream()>>>(
+    SequencePaddingKernel<T><<<grid, threads, 0, context.stream()>>>(
         pad_data, seq_data, pad_value_data, pad_value.numel() == 1,
         seq_offsets.CUDAData(context.GetPlace()), seq_num, pad_seq_len,
         step_width, norm_by_times, layout);
@@ -146,17 +184,16 @@ class UnpaddingLoDTensorFunctor<platform::CUDADeviceContext, T> {
     size_t block_dim_y = kBlockSize / block_dim_x;
     dim3 threads(block_dim_x, block_dim_y);
 
-    size_t grid_dim_x = (pad_seq_len + block_dim_y - 1) / block_dim_y;
-    size_t grid_dim_y = seq_num;
-    dim3 grid(grid_dim_x, grid_dim_y);
+    size_t seq_rows = seq_tensor_dims[0];
+    if (seq_rows == 0) return;
+    dim3 grid((seq_rows + block_dim_y - 1) / block_dim_y);
 
     const T* pad_data = pad_tensor.data<T>();
     T* seq_data = seq_tensor->data<T>();
 
-    SequencePaddingKernel<T, kPadToSeq><<<grid, threads, 0, context.stream()>>>(
-        seq_data, pad_data, nullptr, false,
-        seq_offsets.CUDAData(context.GetPlace()), seq_num, pad_seq_len,
-        step_width, norm_by_times, layout);
+    SequenceUnpaddingKernel<T><<<grid, threads, 0, context.stream()>>>(
+        seq_data, pad_data, seq_offsets.CUDAData(context.GetPlace()), seq_num,
+        seq_rows, pad_seq_len, step_width, norm_by_times, layout);
   }
 };
 
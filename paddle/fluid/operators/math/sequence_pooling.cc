@@ -15,6 +15,7 @@ limitations under the License. */
 #include <string>
 
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/jit_kernel.h"
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/operators/math/sequence_pooling.h"
 
@@ -224,6 +225,22 @@ class SequencePoolFunctor<platform::CPUDeviceContext, T> {
                   const std::string pooltype, const framework::LoDTensor& input,
                   framework::Tensor* output, bool is_test,
                   framework::Tensor* index = nullptr) {
+    if (pooltype == "SUM" || pooltype == "AVERAGE" || pooltype == "SQRT" ||
+        (pooltype == "MAX" && is_test)) {
+      auto lod = input.lod()[0];
+      int w = static_cast<int>(input.numel() / input.dims()[0]);
+      const auto& pool =
+          jitkernel::KernelPool::Instance()
+              .template Get<jitkernel::SequencePoolKernel<T>,
+                            const std::string&, int>(pooltype, w);
+      const T* in_data = input.data<T>();
+      T* out_data = output->data<T>();
+      for (int i = 0; i < static_cast<int>(lod.size()) - 1; ++i) {
+        pool->Compute(in_data + lod[i] * w, out_data + i * w,
+                      static_cast<int>(lod[i + 1] - lod[i]));
+      }
+      return;
+    }
     if (pooltype == "MAX") {
       if (is_test) {
         math::MaxSeqPoolFunctor<T, true> max_pool;
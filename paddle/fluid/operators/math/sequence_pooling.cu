@@ -12,6 +12,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <algorithm>
 #include <string>
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/operators/math/sequence_pooling.h"
@@ -23,73 +24,6 @@ namespace math {
 
 #define FLT_MAX __FLT_MAX__
 
-template <typename T>
-struct MaxPoolFunctor {
-  HOSTDEVICE void operator()(const T* input, const size_t start,
-                             const size_t end, const size_t item_dim, T* output,
-                             int* index) {
-    for (int tid = threadIdx.x; tid < item_dim; tid += blockDim.x) {
-      T max_val = static_cast<T>(-FLT_MAX);
-      int max_index = -1;
-      for (int i = start; i < end; ++i) {
-        if (max_val < input[item_dim * i + tid]) {
-          max_val = input[item_dim * i + tid];
-          max_index = i;
-        }
-      }
-      output[tid] = max_val;
-      index[tid] = max_index;
-    }
-  }
-};
-
-template <typename T>
-struct AvgPoolFunctor {
-  HOSTDEVICE void operator()(const T* input, const size_t start,
-                             const size_t end, const size_t item_dim, T* output,
-                             int* index) {
-    for (int tid = threadIdx.x; tid < item_dim; tid += blockDim.x) {
-      T val = static_cast<T>(0);
-      for (int i = start; i < end; ++i) {
-        val += input[item_dim * i + tid];
-      }
-      // end, start is lod, so end - start != 0
-      output[tid] = val / static_cast<T>(end - start);
-    }
-  }
-};
-
-template <typename T>
-struct SumPoolFunctor {
-  HOSTDEVICE void operator()(const T* input, const size_t start,
-                             const size_t end, const size_t item_dim, T* output,
-                             int* index) {
-    for (int tid = threadIdx.x; tid < item_dim; tid += blockDim.x) {
-      T val = static_cast<T>(0);
-      for (int i = start; i < end; ++i) {
-        val += input[item_dim * i + tid];
-      }
-      output[tid] = val;
-    }
-  }
-};
-
-template <typename T>
-struct SqrtPoolFunctor {
-  HOSTDEVICE void operator()(const T* input, const size_t start,
-                             const size_t end, const size_t item_dim, T* output,
-                             int* index) {
-    for (int tid = threadIdx.x; tid < item_dim; tid += blockDim.x) {
-      T val = static_cast<T>(0);
-      for (int i = start; i < end; ++i) {
-        val += input[item_dim * i + tid];
-      }
-      // end, start is lod, so end - start != 0
-      output[tid] = val / sqrt(end - start);
-    }
-  }
-};
-
 template <typename T>
 struct LastPoolFunctor {
   HOSTDEVICE void operator()(const T* input, const size_t start,
@@ -128,6 +62,239 @@ __global__ void sequence_pool_kernel(Range_OP op, const T* input,
   op(input, start, end, item_dim, &output[bid * item_dim], index_offset);
 }
 
+enum SequencePoolType {
+  kSequencePoolMax,
+  kSequencePoolAverage,
+  kSequencePoolSum,
+  kSequencePoolSqrt,
+};
+
+template <typename T, int kPool>
+__device__ __forceinline__ void SequencePoolReduce(T* val, int* index, T x,
+                                                   int x_index) {
+  if (kPool == kSequencePoolMax) {
+    // keep the first max, as the sequential scan does
+    if (*val < x || (*val == x && x_index < *index)) {
+      *val = x;
+      *index = x_index;
+    }
+  } else {
+    *val += x;
+  }
+}
+
+template <typename T, int kPool>
+__device__ __forceinline__ T SequencePoolFinalize(T val, size_t length) {
+  if (kPool == kSequencePoolAverage) {
+    // end, start is lod, so end - start != 0
+    return val / static_cast<T>(length);
+  } else if (kPool == kSequencePoolSqrt) {
+    return val / sqrt(static_cast<T>(length));
+  }
+  return val;
+}
+
+// The rows of every piece are reduced by the threadIdx.y of a block, and
+// the columns are strided by the threadIdx.x. The piece of a long sequence
+// writes a partial result, which is merged by sequence_pool_merge_kernel.
+template <typename T, int kPool, int BlockSize>
+__global__ void sequence_pool_balanced_kernel(const T* input,
+                                              const int* pieces,
+                                              const int* packs,
+                                              const size_t item_dim, T* output,
+                                              int* index, T* partial,
+                                              int* partial_index) {
+  __shared__ T shared_val[BlockSize];
+  __shared__ int shared_index[BlockSize];
+  const int tid = threadIdx.y * blockDim.x + threadIdx.x;
+  for (int p = packs[blockIdx.x]; p < packs[blockIdx.x + 1]; ++p) {
+    const int seq = pieces[4 * p];
+    const int start = pieces[4 * p + 1];
+    const int end = pieces[4 * p + 2];
+    const int part = pieces[4 * p + 3];
+    // all the threads run the same iterations for the __syncthreads
+    for (size_t col = threadIdx.x; col < item_dim + threadIdx.x;
+         col += blockDim.x) {
+      T val = static_cast<T>(kPool == kSequencePoolMax ? -FLT_MAX : 0);
+      int max_index = -1;
+      if (col < item_dim) {
+        for (int i = start + threadIdx.y; i < end; i += blockDim.y) {
+          SequencePoolReduce<T, kPool>(&val, &max_index,
+                                       input[item_dim * i + col], i);
+        }
+      }
+      shared_val[tid] = val;
+      shared_index[tid] = max_index;
+      __syncthreads();
+      for (int stride = blockDim.y / 2; stride > 0; stride /= 2) {
+        if (threadIdx.y < stride) {
+          int other = tid + stride * blockDim.x;
+          SequencePoolReduce<T, kPool>(&shared_val[tid], &shared_index[tid],
+                                       shared_val[other], shared_index[other]);
+        }
+        __syncthreads();
+      }
+      if (threadIdx.y == 0 && col < item_dim) {
+        if (part < 0) {
+          output[seq * item_dim + col] =
+              SequencePoolFinalize<T, kPool>(shared_val[tid], end - start);
+          if (kPool == kSequencePoolMax && index != nullptr) {
+            index[seq * item_dim + col] = shared_index[tid];
+          }
+        } else {
+          partial[part * item_dim + col] = shared_val[tid];
+          if (kPool == kSequencePoolMax) {
+            partial_index[part * item_dim + col] = shared_index[tid];
+          }
+        }
+      }
+      __syncthreads();
+    }
+  }
+}
+
+// Merge the partial results [first, last) of each split sequence.
+template <typename T, int kPool>
+__global__ void sequence_pool_merge_kernel(const T* partial,
+                                           const int* partial_index,
+                                           const int* splits, const size_t* lod,
+                                           const size_t item_dim, T* output,
+                                           int* index) {
+  const int seq = splits[3 * blockIdx.x];
+  const int first = splits[3 * blockIdx.x + 1];
+  const int last = splits[3 * blockIdx.x + 2];
+  for (int col = threadIdx.x; col < item_dim; col += blockDim.x) {
+    T val = static_cast<T>(kPool == kSequencePoolMax ? -FLT_MAX : 0);
+    int max_index = -1;
+    for (int p = first; p < last; ++p) {
+      SequencePoolReduce<T, kPool>(
+          &val, &max_index, partial[p * item_dim + col],
+          kPool == kSequencePoolMax ? partial_index[p * item_dim + col] : -1);
+    }
+    output[seq * item_dim + col] =
+        SequencePoolFinalize<T, kPool>(val, lod[seq + 1] - lod[seq]);
+    if (kPool == kSequencePoolMax && index != nullptr) {
+      index[seq * item_dim + col] = max_index;
+    }
+  }
+}
+
+/*
+ * Balance the sequences of any lengths over the blocks for the reduce pools.
+ * Every sequence longer than rows_per_piece is split into the pieces of
+ * rows_per_piece rows, whose partial results are merged at the second phase,
+ * and the consecutive short pieces are packed into a block together, so that
+ * every block reduces nearly rows_per_piece rows.
+ */
+struct SequencePoolPlan {
+  SequencePoolPlan(const framework::Vector<size_t>& lod, int max_blocks) {
+    const size_t kMinPieceRows = 64;
+    size_t rows_per_piece =
+        std::max(kMinPieceRows, (lod.back() + max_blocks - 1) / max_blocks);
+    num_partials = 0;
+    for (size_t i = 0; i + 1 < lod.size(); ++i) {
+      size_t start = lod[i];
+      size_t end = lod[i + 1];
+      if (end - start <= rows_per_piece) {
+        AddPiece(i, start, end, -1);
+        continue;
+      }
+      int first = num_partials;
+      for (size_t s = start; s < end; s += rows_per_piece) {
+        AddPiece(i, s, std::min(end, s + rows_per_piece), num_partials++);
+      }
+      splits.push_back(static_cast<int>(i));
+      splits.push_back(first);
+      splits.push_back(num_partials);
+    }
+
+    packs.push_back(0);
+    size_t pack_rows = 0;
+    size_t num_pieces = pieces.size() / 4;
+    for (size_t p = 0; p < num_pieces; ++p) {
+      size_t rows = pieces[4 * p + 2] - pieces[4 * p + 1];
+      if (pack_rows > 0 && pack_rows + rows > rows_per_piece) {
+        packs.push_back(static_cast<int>(p));
+        pack_rows = 0;
+      }
+      pack_rows += rows;
+    }
+    if (num_pieces > 0) {
+      packs.push_back(static_cast<int>(num_pieces));
+    }
+    num_packs = static_cast<int>(packs.size()) - 1;
+    num_splits = static_cast<int>(splits.size() / 3);
+  }
+
+  void AddPiece(size_t seq, size_t start, size_t end, int partial) {
+    pieces.push_back(static_cast<int>(seq));
+    pieces.push_back(static_cast<int>(start));
+    pieces.push_back(static_cast<int>(end));
+    pieces.push_back(partial);
+  }
+
+  // (sequence, start, end, partial or -1 if not split) of every piece
+  framework::Vector<int> pieces;
+  // the pieces [packs[b], packs[b + 1]) are computed by the block b
+  framework::Vector<int> packs;
+  // (sequence, first partial, last partial) of every split sequence
+  framework::Vector<int> splits;
+  int num_packs;
+  int num_partials;
+  int num_splits;
+};
+
+template <typename T, int kPool>
+static void BalancedSequencePool(const platform::CUDADeviceContext& context,
+                                 const framework::LoDTensor& input,
+                                 size_t item_dim, framework::Tensor* output,
+                                 framework::Tensor* index) {
+  auto& lod = input.lod()[0];
+  T* output_data = output->mutable_data<T>(context.GetPlace());
+  int* index_data = nullptr;
+  if (kPool == kSequencePoolMax && index != nullptr) {
+    index_data = index->data<int>();
+  }
+
+  const int kBlockSize = 256;
+  int max_blocks =
+      std::max(context.GetMaxPhysicalThreadCount() / kBlockSize, 1);
+  SequencePoolPlan plan(lod, max_blocks);
+  if (plan.num_packs == 0) return;
+
+  framework::Tensor partial;
+  framework::Tensor partial_index;
+  T* partial_data = nullptr;
+  int* partial_index_data = nullptr;
+  if (plan.num_partials > 0) {
+    auto dims = framework::make_ddim(
+        {plan.num_partials, static_cast<int64_t>(item_dim)});
+    partial_data = partial.mutable_data<T>(dims, context.GetPlace());
+    if (kPool == kSequencePoolMax) {
+      partial_index_data =
+          partial_index.mutable_data<int>(dims, context.GetPlace());
+    }
+  }
+
+  int threads_x = 32;
+  while (threads_x < item_dim && threads_x < kBlockSize) {
+    threads_x *= 2;
+  }
+  dim3 threads(threads_x, kBlockSize / threads_x);
+  sequence_pool_balanced_kernel<T, kPool, kBlockSize><<<
+      plan.num_packs, threads, 0, context.stream()>>>(
+      input.data<T>(), plan.pieces.CUDAData(context.GetPlace()),
+      plan.packs.CUDAData(context.GetPlace()), item_dim, output_data,
+      index_data, partial_data, partial_index_data);
+  if (plan.num_splits > 0) {
+    sequence_pool_merge_kernel<T, kPool><<<plan.num_splits, kBlockSize, 0,
+                                           context.stream()>>>(
+        partial_data, partial_index_data,
+        plan.splits.CUDAData(context.GetPlace()),
+        lod.CUDAData(context.GetPlace()), item_dim, output_data, index_data);
+  }
+}
+
 template <typename T>
 class SequencePoolFunctor<platform::CUDADeviceContext, T> {
  public:
@@ -140,29 +307,17 @@ class SequencePoolFunctor<platform::CUDADeviceContext, T> {
     dim3 threads(1024, 1);
     dim3 grid(lod.size(), 1);
     if (pooltype == "MAX") {
-      sequence_pool_kernel<
-          T, MaxPoolFunctor<T>><<<grid, threads, 0, context.stream()>>>(
-          MaxPoolFunctor<T>(), input.data<T>(),
-          lod.CUDAData(context.GetPlace()), lod.size(), item_dim,
-          output->mutable_data<T>(context.GetPlace()), index->data<int>());
+      BalancedSequencePool<T, kSequencePoolMax>(context, input, item_dim,
+                                                output, index);
     } else if (pooltype == "AVERAGE") {
-      sequence_pool_kernel<
-          T, AvgPoolFunctor<T>><<<grid, threads, 0, context.stream()>>>(
-          AvgPoolFunctor<T>(), input.data<T>(),
-          lod.CUDAData(context.GetPlace()), lod.size(), item_dim,
-          output->mutable_data<T>(context.GetPlace()), nullptr);
+      BalancedSequencePool<T, kSequencePoolAverage>(context, input, item_dim,
+                                                    output, index);
     } else if (pooltype == "SUM") {
-      sequence_pool_kernel<
-          T, SumPoolFunctor<T>><<<grid, threads, 0, context.stream()>>>(
-          SumPoolFunctor<T>(), input.data<T>(),
-          lod.CUDAData(context.GetPlace()), lod.size(), item_dim,
-          output->mutable_data<T>(context.GetPlace()), nullptr);
+      BalancedSequencePool<T, kSequencePoolSum>(context, input, item_dim,
+                                                output, index);
     } else if (pooltype == "SQRT") {
-      sequence_pool_kernel<
-          T, SqrtPoolFunctor<T>><<<grid, threads, 0, context.stream()>>>(
-          SqrtPoolFunctor<T>(), input.data<T>(),
-          lod.CUDAData(context.GetPlace()), lod.size(), item_dim,
-          output->mutable_data<T>(context.GetPlace()), nullptr);
+      BalancedSequencePool<T, kSequencePoolSqrt>(context, input, item_dim,
+                                                 output, index);
     } else if (pooltype == "LAST") {
       sequence_pool_kernel<
           T, LastPoolFunctor<T>><<<grid, threads, 0, context.stream()>>>(
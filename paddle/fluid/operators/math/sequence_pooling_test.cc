@@ -14,6 +14,9 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/math/sequence_pooling.h"
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
 #include <vector>
 
 template <typename DeviceContext, typename Place, typename T>
@@ -123,4 +126,71 @@ TEST(SequencePoolingGrad, CUDA_SUM) {
   TestSequencePoolingSum<paddle::platform::CUDADeviceContext,
                          paddle::platform::CUDAPlace, float>(lod2);
 }
+
+// Compare the CUDA reduce pools with the CPU ones on the skewed lengths, where
+// the long sequences are split over the blocks and the short ones are packed.
+void TestSequencePoolingForward(const paddle::framework::LoD& lod,
+                                const std::string& pooltype,
+                                int64_t second_dim) {
+  paddle::framework::LoDTensor cpu_in;
+  auto in_dims = paddle::framework::make_ddim(
+      {static_cast<int64_t>(lod[0].back()), second_dim});
+  float* in_data = cpu_in.mutable_data<float>(in_dims,
+                                              paddle::platform::CPUPlace());
+  for (int64_t i = 0; i < cpu_in.numel(); ++i) {
+    // a few equal values to check the index of the first max
+    in_data[i] = static_cast<float>((i * 7919) % 1013) / 1013.f;
+  }
+  cpu_in.set_lod(lod);
+  auto out_dims = paddle::framework::make_ddim(
+      {static_cast<int64_t>(lod[0].size() - 1), second_dim});
+
+  paddle::framework::Tensor cpu_out;
+  paddle::framework::Tensor cpu_index;
+  cpu_out.mutable_data<float>(out_dims, paddle::platform::CPUPlace());
+  cpu_index.mutable_data<int>(out_dims, paddle::platform::CPUPlace());
+  paddle::platform::CPUDeviceContext cpu_ctx;
+  paddle::operators::math::SequencePoolFunctor<
+      paddle::platform::CPUDeviceContext, float>()(cpu_ctx, pooltype, cpu_in,
+                                                   &cpu_out, false, &cpu_index);
+
+  paddle::platform::CUDAPlace place;
+  paddle::platform::CUDADeviceContext ctx(place);
+  paddle::framework::LoDTensor in;
+  paddle::framework::Tensor out;
+  paddle::framework::Tensor index;
+  TensorCopySync(cpu_in, place, &in);
+  in.set_lod(lod);
+  out.mutable_data<float>(out_dims, place);
+  index.mutable_data<int>(out_dims, place);
+  paddle::operators::math::SequencePoolFunctor<
+      paddle::platform::CUDADeviceContext, float>()(ctx, pooltype, in, &out,
+                                                    false, &index);
+  ctx.Wait();
+
+  paddle::framework::Tensor gpu_out;
+  paddle::framework::Tensor gpu_index;
+  TensorCopySync(out, paddle::platform::CPUPlace(), &gpu_out);
+  TensorCopySync(index, paddle::platform::CPUPlace(), &gpu_index);
+  for (int64_t i = 0; i < cpu_out.numel(); ++i) {
+    float expected = cpu_out.data<float>()[i];
+    EXPECT_NEAR(gpu_out.data<float>()[i], expected,
+                1e-4 * std::max(1.f, std::abs(expected)))
+        << pooltype << " at " << i;
+    if (pooltype == "MAX") {
+      EXPECT_EQ(gpu_index.data<int>()[i], cpu_index.data<int>()[i])
+          << "at " << i;
+    }
+  }
+}
+
+TEST(SequencePooling, CUDA_SKEWED_LOD) {
+  paddle::framework::LoD lod;
+  lod.push_back(std::vector<size_t>{0, 3, 3003, 3008, 3009, 3709, 3712});
+  for (auto pooltype :
+       std::vector<std::string>({"MAX", "AVERAGE", "SUM", "SQRT"})) {
+    TestSequencePoolingForward(lod, pooltype, 10);
+    TestSequencePoolingForward(lod, pooltype, 300);
+  }
+}
 #endif
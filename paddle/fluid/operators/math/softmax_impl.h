@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/operators/math/jit_kernel.h"
 
 namespace paddle {
 namespace operators {
@@ -32,10 +33,35 @@ struct ValueClip {
   }
 };
 
+// Compute the softmax of rows by the jit kernel on CPU. Return false if it is
+// not applicable.
+template <typename DeviceContext, typename T>
+struct JITSoftmax {
+  bool operator()(const framework::Tensor* X, framework::Tensor* Y) const {
+    return false;
+  }
+};
+
+template <>
+struct JITSoftmax<platform::CPUDeviceContext, float> {
+  bool operator()(const framework::Tensor* X, framework::Tensor* Y) const {
+    const int batch_size = static_cast<int>(X->dims()[0]);
+    const int num_classes = static_cast<int>(X->dims()[1]);
+    const auto& ker = jitkernel::KernelPool::Instance()
+                          .template Get<jitkernel::SoftmaxKernel<float>>(
+                              num_classes);
+    ker->Compute(X->data<float>(), Y->data<float>(), batch_size);
+    return true;
+  }
+};
+
 template <typename DeviceContext, typename T>
 void SoftmaxFunctor<DeviceContext, T>::operator()(const DeviceContext& context,
                                                   const framework::Tensor* X,
                                                   framework::Tensor* Y) {
+  if (JITSoftmax<DeviceContext, T>()(X, Y)) {
+    return;
+  }
   auto logits = EigenMatrix<T>::From(*X);
   auto softmax = EigenMatrix<T>::From(*Y);
 
@@ -0,0 +1,204 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+
+#include "paddle/fluid/operators/math/transpose.h"
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include "paddle/fluid/platform/float16.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+void CoalesceTransposeDims(const std::vector<int64_t>& dims,
+                           const std::vector<int>& axis,
+                           std::vector<int64_t>* new_dims,
+                           std::vector<int>* new_axis) {
+  PADDLE_ENFORCE_EQ(dims.size(), axis.size(),
+                    "the axis should be a permutation of the dims");
+  int rank = static_cast<int>(dims.size());
+  std::vector<int> index(rank, -1);
+  std::vector<int64_t> kept_dims;
+  for (int i = 0; i < rank; ++i) {
+    if (dims[i] != 1) {
+      index[i] = static_cast<int>(kept_dims.size());
+      kept_dims.push_back(dims[i]);
+    }
+  }
+  if (kept_dims.empty()) {
+    *new_dims = {1};
+    *new_axis = {0};
+    return;
+  }
+  std::vector<int> kept_axis;
+  for (int a : axis) {
+    PADDLE_ENFORCE(a >= 0 && a < rank, "invalid axis %d", a);
+    if (index[a] >= 0) kept_axis.push_back(index[a]);
+  }
+
+  // The runs of the adjacent input axes in the output, as (first axis, axes).
+  std::vector<std::pair<int, int>> groups;
+  for (size_t i = 0; i < kept_axis.size(); ++i) {
+    if (i > 0 && kept_axis[i] == kept_axis[i - 1] + 1) {
+      ++groups.back().second;
+    } else {
+      groups.emplace_back(kept_axis[i], 1);
+    }
+  }
+  // The merged input axes are in the order of their first axis.
+  std::vector<int> order(groups.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&groups](int a, int b) {
+    return groups[a].first < groups[b].first;
+  });
+  new_dims->assign(groups.size(), 1);
+  new_axis->assign(groups.size(), 0);
+  for (size_t j = 0; j < order.size(); ++j) {
+    const auto& group = groups[order[j]];
+    for (int k = group.first; k < group.first + group.second; ++k) {
+      (*new_dims)[j] *= kept_dims[k];
+    }
+    (*new_axis)[order[j]] = static_cast<int>(j);
+  }
+}
+
+namespace {
+
+constexpr int64_t kTile = 32;
+
+// dst[c][r] = src[r][c] for the tile at (r0, c0) of a rows x cols matrix,
+// the tile of both fits in the L1 cache.
+template <typename T>
+void TransposeTile(const T* src, T* dst, int64_t rows, int64_t cols,
+                   int64_t r0, int64_t c0) {
+  int64_t r1 = std::min(r0 + kTile, rows);
+  int64_t c1 = std::min(c0 + kTile, cols);
+  for (int64_t c = c0; c < c1; ++c) {
+    const T* s = src + c;
+    T* d = dst + c * rows;
+    for (int64_t r = r0; r < r1; ++r) {
+      d[r] = s[r * cols];
+    }
+  }
+}
+
+// Copy the rows [begin, end) of inner elements of the output, the strides of
+// the input are indexed by the output axes.
+template <typename T>
+void PermutedCopy(const T* src, T* dst, const std::vector<int64_t>& out_dims,
+                  const std::vector<int64_t>& strides, int64_t inner,
+                  int64_t begin, int64_t end) {
+  int rank = static_cast<int>(out_dims.size());
+  std::vector<int64_t> idx(rank);
+  int64_t rest = begin;
+  int64_t offset = 0;
+  for (int j = rank - 1; j >= 0; --j) {
+    idx[j] = rest % out_dims[j];
+    rest /= out_dims[j];
+    offset += idx[j] * strides[j];
+  }
+  for (int64_t i = begin; i < end; ++i) {
+    if (inner == 1) {
+      dst[i] = src[offset];
+    } else {
+      std::copy(src + offset, src + offset + inner, dst + i * inner);
+    }
+    for (int j = rank - 1; j >= 0; --j) {
+      offset += strides[j];
+      if (++idx[j] < out_dims[j]) break;
+      offset -= strides[j] * out_dims[j];
+      idx[j] = 0;
+    }
+  }
+}
+
+}  // namespace
+
+template <typename T>
+struct TransposeFunctor<platform::CPUDeviceContext, T> {
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& in, framework::Tensor* out,
+                  const std::vector<int>& axis) {
+    std::vector<int64_t> dims;
+    std::vector<int> perm;
+    CoalesceTransposeDims(framework::vectorize(in.dims()), axis, &dims, &perm);
+    const T* src = in.data<T>();
+    T* dst = out->data<T>();
+    int64_t numel = in.numel();
+    int rank = static_cast<int>(dims.size());
+    if (rank == 1) {
+      std::copy(src, src + numel, dst);
+      return;
+    }
+
+    // The coalesced {1, 0} or {0, 2, 1}.
+    if (rank == 2 || (rank == 3 && perm[0] == 0)) {
+      int64_t batch = rank == 3 ? dims[0] : 1;
+      int64_t rows = dims[rank - 2];
+      int64_t cols = dims[rank - 1];
+      int64_t row_tiles = (rows + kTile - 1) / kTile;
+      context.ParallelFor(batch * row_tiles,
+                          [&](int64_t begin, int64_t end) {
+                            for (int64_t t = begin; t < end; ++t) {
+                              int64_t b = t / row_tiles;
+                              int64_t r0 = (t % row_tiles) * kTile;
+                              for (int64_t c0 = 0; c0 < cols; c0 += kTile) {
+                                TransposeTile(src + b * rows * cols,
+                                              dst + b * rows * cols, rows,
+                                              cols, r0, c0);
+                              }
+                            }
+                          },
+                          kTile * cols);
+      return;
+    }
+
+    std::vector<int64_t> in_strides(rank, 1);
+    for (int i = rank - 2; i >= 0; --i) {
+      in_strides[i] = in_strides[i + 1] * dims[i + 1];
+    }
+    std::vector<int64_t> out_dims(rank);
+    std::vector<int64_t> strides(rank);
+    for (int j = 0; j < rank; ++j) {
+      out_dims[j] = dims[perm[j]];
+      strides[j] = in_strides[perm[j]];
+    }
+    // The innermost axis stays innermost, copy the contiguous rows.
+    int64_t inner = 1;
+    if (perm.back() == rank - 1) {
+      inner = dims.back();
+      out_dims.pop_back();
+      strides.pop_back();
+    }
+    context.ParallelFor(numel / inner,
+                        [&](int64_t begin, int64_t end) {
+                          PermutedCopy(src, dst, out_dims, strides, inner,
+                                       begin, end);
+                        },
+                        inner);
+  }
+};
+
+template struct TransposeFunctor<platform::CPUDeviceContext, float>;
+template struct TransposeFunctor<platform::CPUDeviceContext, double>;
+template struct TransposeFunctor<platform::CPUDeviceContext, int>;
+template struct TransposeFunctor<platform::CPUDeviceContext, int64_t>;
+template struct TransposeFunctor<platform::CPUDeviceContext,
+                                 platform::float16>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,151 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+
+#include <algorithm>
+#include <vector>
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/operators/math/transpose.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+#include "paddle/fluid/platform/float16.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+static constexpr int kTileDim = 32;
+static constexpr int kBlockRows = 8;
+static constexpr int kMaxRank = 9;
+
+// out[b][c][r] = in[b][r][c]. A block reads a tile by the rows of the input
+// and writes it by the rows of the output through the shared memory, so both
+// are coalesced, the padding column avoids the bank conflicts.
+template <typename T>
+__global__ void TiledTransposeKernel(const T* in, T* out, int64_t batch,
+                                     int rows, int cols) {
+  __shared__ T tile[kTileDim][kTileDim + 1];
+  int row_tiles = (rows + kTileDim - 1) / kTileDim;
+  int c0 = blockIdx.x * kTileDim;
+  for (int64_t b = blockIdx.z; b < batch; b += gridDim.z) {
+    const T* src = in + b * rows * cols;
+    T* dst = out + b * rows * cols;
+    for (int ty = blockIdx.y; ty < row_tiles; ty += gridDim.y) {
+      int r0 = ty * kTileDim;
+      int c = c0 + threadIdx.x;
+      for (int j = threadIdx.y; j < kTileDim; j += kBlockRows) {
+        if (r0 + j < rows && c < cols) {
+          tile[j][threadIdx.x] = src[(r0 + j) * cols + c];
+        }
+      }
+      __syncthreads();
+      int r = r0 + threadIdx.x;
+      for (int j = threadIdx.y; j < kTileDim; j += kBlockRows) {
+        if (c0 + j < cols && r < rows) {
+          dst[(c0 + j) * rows + r] = tile[threadIdx.x][j];
+        }
+      }
+      __syncthreads();
+    }
+  }
+}
+
+struct PermuteDims {
+  int rank;
+  int64_t out_dims[kMaxRank];
+  // The strides of the input, indexed by the output axes.
+  int64_t strides[kMaxRank];
+};
+
+template <typename T>
+__global__ void PermuteKernel(const T* in, T* out, int64_t n,
+                              PermuteDims dims) {
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += blockDim.x * gridDim.x) {
+    int64_t rest = i;
+    int64_t offset = 0;
+    for (int j = dims.rank - 1; j >= 0; --j) {
+      offset += (rest % dims.out_dims[j]) * dims.strides[j];
+      rest /= dims.out_dims[j];
+    }
+    out[i] = in[offset];
+  }
+}
+
+template <typename T>
+struct TransposeFunctor<platform::CUDADeviceContext, T> {
+  void operator()(const platform::CUDADeviceContext& context,
+                  const framework::Tensor& in, framework::Tensor* out,
+                  const std::vector<int>& axis) {
+    std::vector<int64_t> dims;
+    std::vector<int> perm;
+    CoalesceTransposeDims(framework::vectorize(in.dims()), axis, &dims, &perm);
+    const T* src = in.data<T>();
+    T* dst = out->data<T>();
+    int64_t numel = in.numel();
+    int rank = static_cast<int>(dims.size());
+    auto stream = context.stream();
+    if (numel == 0) return;
+    if (rank == 1) {
+      auto place = boost::get<platform::CUDAPlace>(context.GetPlace());
+      memory::Copy(place, dst, place, src, numel * sizeof(T), stream);
+      return;
+    }
+
+    // The coalesced {1, 0} or {0, 2, 1}.
+    if (rank == 2 || (rank == 3 && perm[0] == 0)) {
+      int64_t batch = rank == 3 ? dims[0] : 1;
+      int rows = static_cast<int>(dims[rank - 2]);
+      int cols = static_cast<int>(dims[rank - 1]);
+      dim3 threads(kTileDim, kBlockRows);
+      dim3 grid((cols + kTileDim - 1) / kTileDim,
+                std::min((rows + kTileDim - 1) / kTileDim, 65535),
+                static_cast<int>(std::min<int64_t>(batch, 65535)));
+      TiledTransposeKernel<T><<<grid, threads, 0, stream>>>(src, dst, batch,
+                                                            rows, cols);
+      return;
+    }
+
+    PADDLE_ENFORCE_LE(rank, kMaxRank, "the coalesced rank %d is too large",
+                      rank);
+    PermuteDims permute;
+    permute.rank = rank;
+    int64_t stride = 1;
+    std::vector<int64_t> in_strides(rank);
+    for (int i = rank - 1; i >= 0; --i) {
+      in_strides[i] = stride;
+      stride *= dims[i];
+    }
+    for (int j = 0; j < rank; ++j) {
+      permute.out_dims[j] = dims[perm[j]];
+      permute.strides[j] = in_strides[perm[j]];
+    }
+    const int threads = 512;
+    int max_blocks = std::max(context.GetMaxPhysicalThreadCount() / threads, 1);
+    int blocks = static_cast<int>(
+        std::min<int64_t>((numel + threads - 1) / threads, max_blocks));
+    PermuteKernel<T><<<blocks, threads, 0, stream>>>(src, dst, numel,
+                                                     permute);
+  }
+};
+
+template struct TransposeFunctor<platform::CUDADeviceContext, float>;
+template struct TransposeFunctor<platform::CUDADeviceContext, double>;
+template struct TransposeFunctor<platform::CUDADeviceContext, int>;
+template struct TransposeFunctor<platform::CUDADeviceContext, int64_t>;
+template struct TransposeFunctor<platform::CUDADeviceContext,
+                                 platform::float16>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
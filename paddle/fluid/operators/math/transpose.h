@@ -0,0 +1,47 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+
+#pragma once
+#include <vector>
+
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// Transpose the permutation to the smallest rank: the axes of size 1 are
+// dropped, and the input axes that stay adjacent and in order in the output
+// are merged. E.g. [N, C, H, W] by {0, 2, 3, 1} is [N, C, H * W] by
+// {0, 2, 1}, a batched 2-D transpose.
+void CoalesceTransposeDims(const std::vector<int64_t>& dims,
+                           const std::vector<int>& axis,
+                           std::vector<int64_t>* new_dims,
+                           std::vector<int>* new_axis);
+
+// Out = transpose(In, axis) for the tensors of any rank. After the dims are
+// coalesced, a copy, a tiled (batched) 2-D transpose, or a copy of the
+// contiguous rows if the innermost axis stays innermost, e.g. [B, S, H, D]
+// by {0, 2, 1, 3}, runs instead of the Eigen shuffle.
+template <typename DeviceContext, typename T>
+struct TransposeFunctor {
+  void operator()(const DeviceContext& context, const framework::Tensor& in,
+                  framework::Tensor* out, const std::vector<int>& axis);
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
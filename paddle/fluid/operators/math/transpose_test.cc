@@ -0,0 +1,131 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+
+#include "paddle/fluid/operators/math/transpose.h"
+#include <gtest/gtest.h>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <vector>
+#include "glog/logging.h"
+
+namespace math = paddle::operators::math;
+using paddle::framework::Tensor;
+
+// The reference out[idx] = in[permuted idx].
+template <typename T>
+void NaiveTranspose(const std::vector<int64_t>& dims,
+                    const std::vector<int>& axis, const T* in, T* out) {
+  int rank = dims.size();
+  std::vector<int64_t> in_strides(rank, 1);
+  for (int i = rank - 2; i >= 0; --i) {
+    in_strides[i] = in_strides[i + 1] * dims[i + 1];
+  }
+  int64_t numel = rank > 0 ? in_strides[0] * dims[0] : 1;
+  for (int64_t i = 0; i < numel; ++i) {
+    int64_t rest = i;
+    int64_t offset = 0;
+    for (int j = rank - 1; j >= 0; --j) {
+      offset += (rest % dims[axis[j]]) * in_strides[axis[j]];
+      rest /= dims[axis[j]];
+    }
+    out[i] = in[offset];
+  }
+}
+
+double TransposeOnCPU(const std::vector<int64_t>& dims,
+                      const std::vector<int>& axis, int repeat = 1) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  Tensor in, out;
+  std::vector<int64_t> out_dims;
+  for (int a : axis) out_dims.push_back(dims[a]);
+  float* in_data =
+      in.mutable_data<float>(paddle::framework::make_ddim(dims), place);
+  float* out_data =
+      out.mutable_data<float>(paddle::framework::make_ddim(out_dims), place);
+  for (int64_t i = 0; i < in.numel(); ++i) in_data[i] = i;
+
+  math::TransposeFunctor<paddle::platform::CPUDeviceContext, float> transpose;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeat; ++i) {
+    transpose(context, in, &out, axis);
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  std::vector<float> expected(in.numel());
+  NaiveTranspose(dims, axis, in_data, expected.data());
+  for (int64_t i = 0; i < out.numel(); ++i) {
+    EXPECT_EQ(out_data[i], expected[i]) << "at " << i;
+  }
+  return elapsed.count() / repeat;
+}
+
+TEST(Transpose, CoalesceDims) {
+  std::vector<int64_t> dims;
+  std::vector<int> axis;
+  math::CoalesceTransposeDims({2, 3, 4, 5}, {0, 2, 3, 1}, &dims, &axis);
+  EXPECT_EQ(dims, std::vector<int64_t>({2, 3, 20}));
+  EXPECT_EQ(axis, std::vector<int>({0, 2, 1}));
+
+  math::CoalesceTransposeDims({2, 3, 4, 5}, {0, 2, 1, 3}, &dims, &axis);
+  EXPECT_EQ(dims, std::vector<int64_t>({2, 3, 4, 5}));
+  EXPECT_EQ(axis, std::vector<int>({0, 2, 1, 3}));
+
+  // The axes of size 1 are dropped, making the permutation a copy.
+  math::CoalesceTransposeDims({1, 3, 1, 5}, {2, 1, 0, 3}, &dims, &axis);
+  EXPECT_EQ(dims, std::vector<int64_t>({15}));
+  EXPECT_EQ(axis, std::vector<int>({0}));
+
+  math::CoalesceTransposeDims({1, 1}, {1, 0}, &dims, &axis);
+  EXPECT_EQ(dims, std::vector<int64_t>({1}));
+  EXPECT_EQ(axis, std::vector<int>({0}));
+}
+
+TEST(Transpose, CPU) {
+  TransposeOnCPU({7}, {0});
+  TransposeOnCPU({33, 65}, {1, 0});
+  TransposeOnCPU({3, 40, 70}, {0, 2, 1});
+  TransposeOnCPU({2, 3, 4, 5}, {0, 2, 1, 3});
+  TransposeOnCPU({2, 3, 4, 5}, {3, 1, 0, 2});
+  TransposeOnCPU({2, 1, 4, 5}, {0, 3, 2, 1});
+  TransposeOnCPU({2, 3, 2, 3, 2, 3, 2}, {6, 0, 5, 1, 4, 2, 3});
+}
+
+TEST(Transpose, CPUBandwidth) {
+  // [B, S, H, D] to [B, H, S, D] of the attention, and the 2-D transpose.
+  for (auto shape : {std::vector<int64_t>({8, 128, 16, 64}),
+                     std::vector<int64_t>({2048, 2048})}) {
+    std::vector<int> axis = shape.size() == 4 ? std::vector<int>({0, 2, 1, 3})
+                                              : std::vector<int>({1, 0});
+    double seconds = TransposeOnCPU(shape, axis, 10);
+    int64_t numel = 1;
+    for (auto d : shape) numel *= d;
+    size_t bytes = numel * sizeof(float);
+
+    // The bandwidth of memcpy is the peak a transpose can reach.
+    std::vector<char> src(bytes, 1), dst(bytes);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 10; ++i) {
+      std::memcpy(dst.data(), src.data(), bytes);
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    double copy_seconds = elapsed.count() / 10;
+    LOG(INFO) << "transpose of " << numel << " floats: "
+              << 2. * bytes / seconds / 1e9 << " GB/s, "
+              << 100. * copy_seconds / seconds << "% of memcpy";
+  }
+}
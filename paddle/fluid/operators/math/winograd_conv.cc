@@ -0,0 +1,206 @@
+/* Copyright (c) 2016 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/winograd_conv.h"
+#include "paddle/fluid/operators/math/blas.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The 2x2 output tile of the 4x4 input tile.
+static constexpr int kTileSize = 4;
+static constexpr int kOutputTileSize = 2;
+static constexpr int kTileElements = kTileSize * kTileSize;
+
+// U = G * g * G^T, where
+// G = [[1, 0, 0], [1/2, 1/2, 1/2], [1/2, -1/2, 1/2], [0, 0, 1]].
+template <typename T>
+static inline void TransformFilterTile(const T* g, T* u, int stride) {
+  T t[kTileSize][3];
+  for (int j = 0; j < 3; ++j) {
+    t[0][j] = g[j];
+    t[1][j] = static_cast<T>(0.5) * (g[j] + g[3 + j] + g[6 + j]);
+    t[2][j] = static_cast<T>(0.5) * (g[j] - g[3 + j] + g[6 + j]);
+    t[3][j] = g[6 + j];
+  }
+  for (int i = 0; i < kTileSize; ++i) {
+    u[(i * kTileSize) * stride] = t[i][0];
+    u[(i * kTileSize + 1) * stride] =
+        static_cast<T>(0.5) * (t[i][0] + t[i][1] + t[i][2]);
+    u[(i * kTileSize + 2) * stride] =
+        static_cast<T>(0.5) * (t[i][0] - t[i][1] + t[i][2]);
+    u[(i * kTileSize + 3) * stride] = t[i][2];
+  }
+}
+
+// V = B^T * d * B, where
+// B^T = [[1, 0, -1, 0], [0, 1, 1, 0], [0, -1, 1, 0], [0, 1, 0, -1]].
+template <typename T>
+static inline void TransformInputTile(const T d[kTileSize][kTileSize], T* v,
+                                      int stride) {
+  T t[kTileSize][kTileSize];
+  for (int j = 0; j < kTileSize; ++j) {
+    t[0][j] = d[0][j] - d[2][j];
+    t[1][j] = d[1][j] + d[2][j];
+    t[2][j] = d[2][j] - d[1][j];
+    t[3][j] = d[1][j] - d[3][j];
+  }
+  for (int i = 0; i < kTileSize; ++i) {
+    v[(i * kTileSize) * stride] = t[i][0] - t[i][2];
+    v[(i * kTileSize + 1) * stride] = t[i][1] + t[i][2];
+    v[(i * kTileSize + 2) * stride] = t[i][2] - t[i][1];
+    v[(i * kTileSize + 3) * stride] = t[i][1] - t[i][3];
+  }
+}
+
+// Y = A^T * m * A, where A^T = [[1, 1, 1, 0], [0, 1, -1, -1]].
+template <typename T>
+static inline void TransformOutputTile(const T* m, int stride,
+                                       T y[kOutputTileSize][kOutputTileSize]) {
+  T s[kOutputTileSize][kTileSize];
+  for (int j = 0; j < kTileSize; ++j) {
+    s[0][j] = m[j * stride] + m[(kTileSize + j) * stride] +
+              m[(2 * kTileSize + j) * stride];
+    s[1][j] = m[(kTileSize + j) * stride] - m[(2 * kTileSize + j) * stride] -
+              m[(3 * kTileSize + j) * stride];
+  }
+  for (int i = 0; i < kOutputTileSize; ++i) {
+    y[i][0] = s[i][0] + s[i][1] + s[i][2];
+    y[i][1] = s[i][1] - s[i][2] - s[i][3];
+  }
+}
+
+template <typename T>
+class WinogradConv3x3Functor<platform::CPUDeviceContext, T> {
+ public:
+  void TransformFilter(const platform::CPUDeviceContext& context,
+                       const framework::Tensor& filter,
+                       framework::Tensor* transformed_filter) {
+    PADDLE_ENFORCE_EQ(filter.dims().size(), 4);
+    PADDLE_ENFORCE(filter.dims()[2] == 3 && filter.dims()[3] == 3,
+                   "The Winograd convolution only supports 3x3 filters.");
+    const int output_channels = static_cast<int>(filter.dims()[0]);
+    const int input_channels = static_cast<int>(filter.dims()[1]);
+    const int num = output_channels * input_channels;
+    const T* filter_data = filter.data<T>();
+    T* u = transformed_filter->mutable_data<T>(
+        {kTileElements, output_channels, input_channels}, context.GetPlace());
+    for (int i = 0; i < num; ++i) {
+      TransformFilterTile(filter_data + i * 9, u + i, num);
+    }
+  }
+
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& input,
+                  const framework::Tensor& transformed_filter,
+                  const std::vector<int>& paddings,
+                  framework::Tensor* output) {
+    PADDLE_ENFORCE_EQ(input.dims().size(), 3);
+    PADDLE_ENFORCE_EQ(output->dims().size(), 3);
+    const int input_channels = static_cast<int>(input.dims()[0]);
+    const int input_height = static_cast<int>(input.dims()[1]);
+    const int input_width = static_cast<int>(input.dims()[2]);
+    const int output_channels = static_cast<int>(output->dims()[0]);
+    const int output_height = static_cast<int>(output->dims()[1]);
+    const int output_width = static_cast<int>(output->dims()[2]);
+    PADDLE_ENFORCE_EQ(transformed_filter.dims()[1], output_channels);
+    PADDLE_ENFORCE_EQ(transformed_filter.dims()[2], input_channels);
+    const int padding_height = paddings[0];
+    const int padding_width = paddings[1];
+
+    const int tile_rows = (output_height + kOutputTileSize - 1) /
+                          kOutputTileSize;
+    const int tile_cols = (output_width + kOutputTileSize - 1) /
+                          kOutputTileSize;
+    const int num_tiles = tile_rows * tile_cols;
+
+    const T* input_data = input.data<T>();
+    framework::Tensor transformed_input;
+    T* v = transformed_input.mutable_data<T>(
+        {kTileElements, input_channels, num_tiles}, context.GetPlace());
+    const int v_stride = input_channels * num_tiles;
+    context.ParallelFor(
+        input_channels,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t c = begin; c < end; ++c) {
+            const T* x = input_data + c * input_height * input_width;
+            for (int tile = 0; tile < num_tiles; ++tile) {
+              const int h0 =
+                  (tile / tile_cols) * kOutputTileSize - padding_height;
+              const int w0 =
+                  (tile % tile_cols) * kOutputTileSize - padding_width;
+              T d[kTileSize][kTileSize];
+              for (int i = 0; i < kTileSize; ++i) {
+                const int h = h0 + i;
+                for (int j = 0; j < kTileSize; ++j) {
+                  const int w = w0 + j;
+                  d[i][j] = (h >= 0 && h < input_height && w >= 0 &&
+                             w < input_width)
+                                ? x[h * input_width + w]
+                                : static_cast<T>(0);
+                }
+              }
+              TransformInputTile(d, v + c * num_tiles + tile, v_stride);
+            }
+          }
+        },
+        num_tiles * kTileElements);
+
+    // The 16 products of the transformed filters and the transformed input.
+    framework::Tensor products;
+    T* m = products.mutable_data<T>(
+        {kTileElements, output_channels, num_tiles}, context.GetPlace());
+    const T* u = transformed_filter.data<T>();
+    auto blas = GetBlas<platform::CPUDeviceContext, T>(context);
+    for (int e = 0; e < kTileElements; ++e) {
+      blas.GEMM(CblasNoTrans, CblasNoTrans, output_channels, num_tiles,
+                input_channels, static_cast<T>(1),
+                u + e * output_channels * input_channels,
+                v + e * input_channels * num_tiles, static_cast<T>(0),
+                m + e * output_channels * num_tiles);
+    }
+
+    T* output_data = output->data<T>();
+    const int m_stride = output_channels * num_tiles;
+    context.ParallelFor(
+        output_channels,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t k = begin; k < end; ++k) {
+            T* y = output_data + k * output_height * output_width;
+            for (int tile = 0; tile < num_tiles; ++tile) {
+              const int h0 = (tile / tile_cols) * kOutputTileSize;
+              const int w0 = (tile % tile_cols) * kOutputTileSize;
+              T out[kOutputTileSize][kOutputTileSize];
+              TransformOutputTile(m + k * num_tiles + tile, m_stride, out);
+              for (int i = 0; i < kOutputTileSize && h0 + i < output_height;
+                   ++i) {
+                for (int j = 0; j < kOutputTileSize && w0 + j < output_width;
+                     ++j) {
+                  y[(h0 + i) * output_width + w0 + j] = out[i][j];
+                }
+              }
+            }
+          }
+        },
+        num_tiles * kTileElements);
+  }
+};
+
+template class WinogradConv3x3Functor<platform::CPUDeviceContext, float>;
+template class WinogradConv3x3Functor<platform::CPUDeviceContext, double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,55 @@
+/* Copyright (c) 2016 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <vector>
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * \brief The Winograd F(2x2, 3x3) convolution of the 3x3 filters with
+ * stride 1 and dilation 1, see `Fast Algorithms for Convolutional Neural
+ * Networks <https://arxiv.org/abs/1509.09308>`_.
+ *
+ * The input is split into 4x4 tiles overlapped by 2, which are transformed
+ * with the transformed filters into 16 matrices. The 16 products of them
+ * are computed by GEMMs and transformed back into the 2x2 output tiles.
+ *
+ * The filter is transformed by TransformFilter once and reused for all the
+ * images.
+ * filter: [output_channels, input_channels, 3, 3]
+ * transformed_filter: [16, output_channels, input_channels]
+ * input: [input_channels, input_height, input_width]
+ * paddings: {padding_height, padding_width}
+ * output: [output_channels, output_height, output_width]
+ */
+template <typename DeviceContext, typename T>
+class WinogradConv3x3Functor {
+ public:
+  void TransformFilter(const DeviceContext& context,
+                       const framework::Tensor& filter,
+                       framework::Tensor* transformed_filter);
+
+  void operator()(const DeviceContext& context, const framework::Tensor& input,
+                  const framework::Tensor& transformed_filter,
+                  const std::vector<int>& paddings, framework::Tensor* output);
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,130 @@
+/* Copyright (c) 2016 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/winograd_conv.h"
+#include <gtest/gtest.h>
+#include <sys/time.h>
+#include <random>
+#include <vector>
+#include "glog/logging.h"
+#include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/im2col.h"
+
+namespace {
+
+inline double GetCurrentUS() {
+  struct timeval time;
+  gettimeofday(&time, NULL);
+  return 1e+6 * time.tv_sec + time.tv_usec;
+}
+constexpr int repeat = 20;
+
+void RandomVec(const int n, float* a) {
+  std::mt19937 rng(100);
+  std::uniform_real_distribution<float> uniform_dist(-1, 1);
+  for (int i = 0; i < n; ++i) {
+    a[i] = uniform_dist(rng);
+  }
+}
+
+// The naive convolution with stride 1 and dilation 1.
+void RefConv3x3(const float* x, const float* w, int c, int h, int width,
+                int k, int pad, int oh, int ow, float* y) {
+  for (int o = 0; o < k; ++o) {
+    for (int i = 0; i < oh; ++i) {
+      for (int j = 0; j < ow; ++j) {
+        float sum = 0;
+        for (int ic = 0; ic < c; ++ic) {
+          for (int fh = 0; fh < 3; ++fh) {
+            for (int fw = 0; fw < 3; ++fw) {
+              int ih = i - pad + fh;
+              int iw = j - pad + fw;
+              if (ih < 0 || ih >= h || iw < 0 || iw >= width) continue;
+              sum += x[(ic * h + ih) * width + iw] *
+                     w[((o * c + ic) * 3 + fh) * 3 + fw];
+            }
+          }
+        }
+        y[(o * oh + i) * ow + j] = sum;
+      }
+    }
+  }
+}
+
+void TestAndBench(int c, int h, int w, int k, int pad) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  const int oh = h + 2 * pad - 2;
+  const int ow = w + 2 * pad - 2;
+
+  paddle::framework::Tensor input, filter, transformed_filter, output;
+  float* x = input.mutable_data<float>({c, h, w}, place);
+  float* f = filter.mutable_data<float>({k, c, 3, 3}, place);
+  float* y = output.mutable_data<float>({k, oh, ow}, place);
+  RandomVec(c * h * w, x);
+  RandomVec(k * c * 9, f);
+  std::vector<float> ref(k * oh * ow);
+  RefConv3x3(x, f, c, h, w, k, pad, oh, ow, ref.data());
+
+  paddle::operators::math::WinogradConv3x3Functor<
+      paddle::platform::CPUDeviceContext, float>
+      winograd;
+  std::vector<int> paddings({pad, pad});
+  auto st = GetCurrentUS();
+  for (int i = 0; i < repeat; ++i) {
+    winograd.TransformFilter(context, filter, &transformed_filter);
+    winograd(context, input, transformed_filter, paddings, &output);
+  }
+  auto mt = GetCurrentUS();
+  for (int i = 0; i < k * oh * ow; ++i) {
+    EXPECT_NEAR(y[i], ref[i], 1e-4);
+  }
+
+  // im2col + GEMM
+  paddle::framework::Tensor col, gemm_output;
+  col.mutable_data<float>({c, 3, 3, oh, ow}, place);
+  gemm_output.mutable_data<float>({k, oh * ow}, place);
+  paddle::operators::math::Im2ColFunctor<
+      paddle::operators::math::ColFormat::kCFO,
+      paddle::platform::CPUDeviceContext, float>
+      im2col;
+  auto blas = paddle::operators::math::GetBlas<
+      paddle::platform::CPUDeviceContext, float>(context);
+  auto gt = GetCurrentUS();
+  for (int i = 0; i < repeat; ++i) {
+    im2col(context, input, {1, 1}, {1, 1}, {pad, pad, pad, pad}, &col);
+    blas.GEMM(CblasNoTrans, CblasNoTrans, k, oh * ow, c * 9, 1.f, f,
+              col.data<float>(), 0.f, gemm_output.data<float>());
+  }
+  auto et = GetCurrentUS();
+  for (int i = 0; i < k * oh * ow; ++i) {
+    EXPECT_NEAR(gemm_output.data<float>()[i], ref[i], 1e-4);
+  }
+  VLOG(3) << "Conv 3x3 of [" << c << ", " << h << ", " << w << "] to " << k
+          << " channels: winograd takes " << (mt - st) / repeat
+          << " us, im2col + gemm takes " << (et - gt) / repeat << " us";
+}
+
+}  // namespace
+
+TEST(WinogradConv3x3, small_channels) {
+  TestAndBench(4, 8, 8, 4, 1);
+  TestAndBench(8, 33, 17, 16, 1);
+  TestAndBench(16, 56, 56, 16, 1);
+}
+
+TEST(WinogradConv3x3, odd_output_and_no_padding) {
+  TestAndBench(5, 9, 7, 6, 0);
+  TestAndBench(32, 15, 15, 32, 2);
+}
@@ -18,6 +18,8 @@ limitations under the License. */
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/detail/safe_ref.h"
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/jit_kernel.h"
+#include "paddle/fluid/operators/math/packed_gemm.h"
 
 namespace paddle {
 namespace operators {
@@ -43,6 +45,51 @@ static framework::DDim ColumnMatrixFromVector(const framework::DDim &y_dim) {
   return framework::make_ddim({y_dim[0], 1});
 }
 
+/**
+ * Multiply the small and unbatched matrices by the jitcode of GEMM, which
+ * saves the overhead of blas. Return false if it is not applicable.
+ */
+template <typename DeviceContext, typename T>
+struct JITMatMul {
+  bool operator()(const framework::Tensor &x, const math::MatDescriptor &dim_a,
+                  const framework::Tensor &y, const math::MatDescriptor &dim_b,
+                  T alpha, framework::Tensor *out) const {
+    return false;
+  }
+};
+
+// Only float has the jitcode, and the CPU kernel of float16 has no jit kernel.
+template <>
+struct JITMatMul<platform::CPUDeviceContext, float> {
+  using T = float;
+  bool operator()(const framework::Tensor &x, const math::MatDescriptor &dim_a,
+                  const framework::Tensor &y, const math::MatDescriptor &dim_b,
+                  T alpha, framework::Tensor *out) const {
+    if (dim_a.batch_size_ != 0 || dim_b.batch_size_ != 0) {
+      return false;
+    }
+    int m = static_cast<int>(dim_a.height_);
+    int n = static_cast<int>(dim_b.width_);
+    int k = static_cast<int>(dim_a.width_);
+    if (!math::jitkernel::GEMMKernel<T>::UseJIT(m, n, k, dim_a.trans_,
+                                                dim_b.trans_)) {
+      return false;
+    }
+    auto &pool = math::jitkernel::KernelPool::Instance();
+    const auto &gemm =
+        pool.template Get<math::jitkernel::GEMMKernel<T>, int, int, int, bool,
+                          bool>(m, n, k, dim_a.trans_, dim_b.trans_);
+    T *out_data = out->data<T>();
+    gemm->Compute(x.data<T>(), y.data<T>(), out_data);
+    if (alpha != static_cast<T>(1)) {
+      const auto &scal =
+          pool.template Get<math::jitkernel::VScalKernel<T>>(m * n);
+      scal->Compute(alpha, out_data);
+    }
+    return true;
+  }
+};
+
 template <typename DeviceContext, typename T>
 class MatMulKernel : public framework::OpKernel<T> {
  public:
@@ -60,6 +107,18 @@ class MatMulKernel : public framework::OpKernel<T> {
     auto mat_dim_b = math::CreateMatrixDescriptor(
         ColumnMatrixFromVector(y.dims()), 0, context.Attr<bool>("transpose_Y"));
     auto scale = static_cast<T>(context.Attr<float>("alpha"));
+    if (JITMatMul<DeviceContext, T>()(x, mat_dim_a, y, mat_dim_b, scale,
+                                      out)) {
+      return;
+    }
+    if (context.Attr<bool>(math::kUsePackedWeight) &&
+        scale == static_cast<T>(1) && mat_dim_a.batch_size_ == 0 &&
+        mat_dim_b.batch_size_ == 0 && !mat_dim_a.trans_ &&
+        math::PackedMatMul<DeviceContext, T>()(
+            context, "Y", mat_dim_b.trans_, mat_dim_a.height_,
+            mat_dim_b.width_, mat_dim_a.width_, x.data<T>(), out->data<T>())) {
+      return;
+    }
     blas.MatMul(x, mat_dim_a, y, mat_dim_b, scale, out, T(0));
   }
 };
@@ -337,6 +396,10 @@ class MatMulOpMaker : public framework::OpProtoAndCheckerMaker {
         )DOC")
         .SetDefault(false);
     AddAttr<float>("alpha", "The scale of Out").SetDefault(1.0f);
+    AddAttr<bool>(math::kUsePackedWeight,
+                  "(bool, default false) Only used in inference, whether to "
+                  "pack the constant Y once and reuse it.")
+        .SetDefault(false);
     AddComment(R"DOC(
 MatMul Operator.
 
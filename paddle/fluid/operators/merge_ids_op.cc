@@ -28,6 +28,11 @@ class MergeIdsOpMaker : public framework::OpProtoAndCheckerMaker {
              "(LoDTensors) multi input tensor with shape{Rows, N}, N is the "
              "size of embedding table")
         .AsDuplicable();
+    AddInput("Index",
+             "(LoDTensor) the row of each id of Ids in the concatenated X, "
+             "the output Index of split_ids. The rows are gathered by the "
+             "Index instead of looking the ids up in Rows if it is set.")
+        .AsDispensable();
     AddOutput("Out", "(LoDTensor) The merged outputs of the input tensors.")
         .AsDuplicable();
 
@@ -43,7 +48,8 @@ merge_ids_op should be used after split_ids_op and prefetch_op, split_ids_op
 prefetch_op will send them to parameter server to prefetch embedding value
 back. During split, the order of ids is disordered. In merge_ids_op we use
 the original Ids to restore the order of the fetched embedding value and
- also pass the lod information to the merged output.
+ also pass the lod information to the merged output. If the Index output by
+split_ids_op is set, each row is gathered from the row of X in it directly.
 
 
 Example:
@@ -14,12 +14,14 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
+#include "paddle/fluid/platform/for_range.h"
 
 namespace paddle {
 namespace operators {
@@ -64,6 +66,11 @@ class MergeIdsOpKernel : public framework::OpKernel<T> {
         row_size, row_ids_size,
         "the merged X dim[0] and merged Rows dim[0] should be the same");
 
+    if (ctx.HasInput("Index")) {
+      MergeByIndex(ctx, ids, x_tensors, outs, row_size, embedding_size);
+      return;
+    }
+
     std::unordered_map<int64_t, std::tuple<int64_t, int64_t>>
         selected_rows_idx_map;
     for (int i = 0; i < x_tensors.size(); ++i) {
@@ -99,6 +106,59 @@ class MergeIdsOpKernel : public framework::OpKernel<T> {
       }
     }
   }
+
+ private:
+  // Gather the rows of the concatenated X recorded by split_ids in the
+  // Index, which are the inverse permutation of its partition.
+  void MergeByIndex(const framework::ExecutionContext &ctx,
+                    const std::vector<const framework::LoDTensor *> &ids,
+                    const std::vector<const framework::LoDTensor *> &x_tensors,
+                    const std::vector<framework::LoDTensor *> &outs,
+                    int64_t row_size, int64_t embedding_size) const {
+    auto &dev_ctx = ctx.template device_context<platform::CPUDeviceContext>();
+    const auto *index = ctx.Input<framework::LoDTensor>("Index");
+
+    // The first row of each X in the concatenated X.
+    std::vector<int64_t> x_begin(x_tensors.size() + 1, 0);
+    for (size_t i = 0; i < x_tensors.size(); ++i) {
+      x_begin[i + 1] = x_begin[i] + x_tensors[i]->dims()[0];
+    }
+
+    int64_t ids_size = 0;
+    for (auto *out_ids : ids) {
+      ids_size += out_ids->dims()[0];
+    }
+    PADDLE_ENFORCE_EQ(index->numel(), ids_size,
+                      "the Index should have a row of each id");
+
+    const int64_t *index_data = index->data<int64_t>();
+    for (size_t i = 0; i < outs.size(); ++i) {
+      auto *out = outs[i];
+      out->set_lod(ids[i]->lod());
+
+      int64_t nums = ids[i]->dims()[0];
+      auto *out_data = out->mutable_data<T>(
+          framework::make_ddim({nums, embedding_size}), ctx.GetPlace());
+      platform::ParallelFor(
+          dev_ctx, nums,
+          [&](int64_t begin, int64_t end) {
+            for (int64_t j = begin; j < end; ++j) {
+              int64_t row = index_data[j];
+              PADDLE_ENFORCE(row >= 0 && row < row_size,
+                             "the Index %d is out of the rows of X", row);
+              size_t k =
+                  std::upper_bound(x_begin.begin(), x_begin.end(), row) -
+                  x_begin.begin() - 1;
+              const T *x_data = x_tensors[k]->data<T>();
+              memcpy(out_data + embedding_size * j,
+                     x_data + (row - x_begin[k]) * embedding_size,
+                     sizeof(T) * embedding_size);
+            }
+          },
+          embedding_size);
+      index_data += nums;
+    }
+  }
 };
 
 }  // namespace operators
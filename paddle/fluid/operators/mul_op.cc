@@ -110,6 +110,27 @@ class MulOpMaker : public framework::OpProtoAndCheckerMaker {
         )DOC")
         .SetDefault(1)
         .EqualGreaterThan(1);
+    AddAttr<bool>(math::kUsePackedWeight,
+                  "(bool, default false) Only used in inference, whether to "
+                  "pack the constant Y once and reuse it.")
+        .SetDefault(false);
+    AddAttr<int>(math::kWeightBlockSize,
+                 "(int, default 0) Only used in inference on CPU, the size of "
+                 "the blocks of the constant sparse Y, whose zero blocks are "
+                 "skipped. 0 if Y is dense.")
+        .SetDefault(0);
+    AddAttr<int>(math::kXQuantBits,
+                 "(int, default 0) Only used in the quantization-aware "
+                 "training on CPU, the bits X is fake quantized with by its "
+                 "abs max before the multiplication, 0 if it is not "
+                 "quantized.")
+        .SetDefault(0);
+    AddAttr<int>(math::kYQuantBits,
+                 "(int, default 0) Only used in the quantization-aware "
+                 "training on CPU, the bits Y is fake quantized with by its "
+                 "abs max before the multiplication, 0 if it is not "
+                 "quantized.")
+        .SetDefault(0);
     AddComment(R"DOC(
 Mul Operator.
 
@@ -182,7 +203,11 @@ REGISTER_OPERATOR(mul, ops::MulOp, ops::MulOpMaker, ops::MulOpGradMaker);
 REGISTER_OPERATOR(mul_grad, ops::MulGradOp);
 REGISTER_OP_CPU_KERNEL(
     mul, ops::MulKernel<paddle::platform::CPUDeviceContext, float>,
-    ops::MulKernel<paddle::platform::CPUDeviceContext, double>);
+    ops::MulKernel<paddle::platform::CPUDeviceContext, double>,
+    ops::MulKernel<paddle::platform::CPUDeviceContext,
+                   paddle::platform::bfloat16>);
 REGISTER_OP_CPU_KERNEL(
     mul_grad, ops::MulGradKernel<paddle::platform::CPUDeviceContext, float>,
-    ops::MulGradKernel<paddle::platform::CPUDeviceContext, double>);
+    ops::MulGradKernel<paddle::platform::CPUDeviceContext, double>,
+    ops::MulGradKernel<paddle::platform::CPUDeviceContext,
+                       paddle::platform::bfloat16>);
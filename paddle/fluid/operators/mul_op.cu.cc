@@ -22,4 +22,6 @@ REGISTER_OP_CUDA_KERNEL(mul, ops::MulKernel<plat::CUDADeviceContext, float>,
                         ops::MulKernel<plat::CUDADeviceContext, plat::float16>);
 REGISTER_OP_CUDA_KERNEL(mul_grad,
                         ops::MulGradKernel<plat::CUDADeviceContext, float>,
-                        ops::MulGradKernel<plat::CUDADeviceContext, double>);
+                        ops::MulGradKernel<plat::CUDADeviceContext, double>,
+                        ops::MulGradKernel<plat::CUDADeviceContext,
+                                           plat::float16>);
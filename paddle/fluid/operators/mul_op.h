@@ -16,7 +16,10 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/block_sparse_gemm.h"
+#include "paddle/fluid/operators/math/fake_quant.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/math/packed_gemm.h"
 
 namespace paddle {
 namespace operators {
@@ -27,8 +30,11 @@ template <typename DeviceContext, typename T>
 class MulKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext& context) const override {
-    const Tensor* x = context.Input<Tensor>("X");
-    const Tensor* y = context.Input<Tensor>("Y");
+    Tensor x_quant, y_quant;
+    const Tensor* x = math::FakeQuantizedInput<DeviceContext, T>(
+        context, math::kXQuantBits, context.Input<Tensor>("X"), &x_quant);
+    const Tensor* y = math::FakeQuantizedInput<DeviceContext, T>(
+        context, math::kYQuantBits, context.Input<Tensor>("Y"), &y_quant);
     Tensor* z = context.Output<Tensor>("Out");
     const Tensor x_matrix =
         x->dims().size() > 2
@@ -47,9 +53,23 @@ class MulKernel : public framework::OpKernel<T> {
       z->Resize({x_matrix.dims()[0], y_matrix.dims()[1]});
     }
 
-    auto blas = math::GetBlas<DeviceContext, T>(context);
-
-    blas.MatMul(x_matrix, y_matrix, z);
+    // The cached sparse and packed weights are not quantized.
+    const bool y_quantized = y == &y_quant;
+    bool sparse =
+        !y_quantized &&
+        math::BlockSparseWeightMatMul<DeviceContext, T>()(
+            context, "Y", x_matrix.dims()[0], y_matrix.dims()[1],
+            x_matrix.dims()[1], x_matrix.data<T>(), z->data<T>());
+    bool packed =
+        !sparse && !y_quantized &&
+        context.Attr<bool>(math::kUsePackedWeight) &&
+        math::PackedMatMul<DeviceContext, T>()(
+            context, "Y", false, x_matrix.dims()[0], y_matrix.dims()[1],
+            x_matrix.dims()[1], x_matrix.data<T>(), z->data<T>());
+    if (!sparse && !packed) {
+      auto blas = math::GetBlas<DeviceContext, T>(context);
+      blas.MatMul(x_matrix, y_matrix, z);
+    }
     if (z_dim.size() != 2) {
       z->Resize(z_dim);
     }
@@ -64,12 +84,18 @@ class MulGradKernel : public framework::OpKernel<T> {
     int y_num_col_dims = ctx.template Attr<int>("y_num_col_dims");
     auto* x = ctx.Input<framework::LoDTensor>("X");
     auto* y = ctx.Input<framework::LoDTensor>("Y");
+    // The gradients of the fake quantized inputs are passed straight through.
+    Tensor x_quant, y_quant;
+    const Tensor* x_in = math::FakeQuantizedInput<DeviceContext, T>(
+        ctx, math::kXQuantBits, x, &x_quant);
+    const Tensor* y_in = math::FakeQuantizedInput<DeviceContext, T>(
+        ctx, math::kYQuantBits, y, &y_quant);
     auto x_matrix = x->dims().size() > 2
-                        ? framework::ReshapeToMatrix(*x, x_num_col_dims)
-                        : static_cast<const Tensor&>(*x);
+                        ? framework::ReshapeToMatrix(*x_in, x_num_col_dims)
+                        : *x_in;
     auto y_matrix = y->dims().size() > 2
-                        ? framework::ReshapeToMatrix(*y, y_num_col_dims)
-                        : static_cast<const Tensor&>(*y);
+                        ? framework::ReshapeToMatrix(*y_in, y_num_col_dims)
+                        : *y_in;
     auto* dout = ctx.Input<framework::LoDTensor>(framework::GradVarName("Out"));
 
     Tensor dout_mat;
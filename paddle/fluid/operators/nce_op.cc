@@ -127,6 +127,11 @@ class NCEOpMaker : public framework::OpProtoAndCheckerMaker {
                               "for every samples. Under normal conditions, "
                               "user should avoid setting this attribute.")
         .SetDefault({});
+    AddAttr<bool>("is_sparse",
+                  "(boolean, default false) "
+                  "Sparse update. If true, the gradient of Weight is a "
+                  "SelectedRows of the sampled labels.")
+        .SetDefault(false);
     AddComment(R"DOC(
 Compute and return the noise-contrastive estimation training loss. See 
 `Noise-contrastive estimation: A new estimation principle for unnormalized 
@@ -178,13 +183,38 @@ class NCEOpGrad : public framework::OperatorWithKernel {
   }
 };
 
+class NCEOpGradVarTypeInference : public framework::VarTypeInference {
+ public:
+  void operator()(const framework::OpDesc& op_desc,
+                  framework::BlockDesc* block) const override {
+    auto weight_grad = op_desc.Output(framework::GradVarName("Weight"));
+    if (weight_grad.empty()) return;
+    auto& weight_grad_name = weight_grad.front();
+    bool is_sparse = boost::get<bool>(op_desc.GetAttr("is_sparse"));
+    if (is_sparse) {
+      VLOG(3) << "nce_op_grad op " << weight_grad_name
+              << " is set to SelectedRows";
+      block->Var(weight_grad_name)
+          ->SetType(framework::proto::VarType::SELECTED_ROWS);
+    } else {
+      VLOG(3) << "nce_op_grad op " << weight_grad_name
+              << " is set to LoDTensor";
+      block->Var(weight_grad_name)
+          ->SetType(framework::proto::VarType::LOD_TENSOR);
+    }
+    block->Var(weight_grad_name)
+        ->SetDataType(
+            block->Var(op_desc.Input("Weight").front())->GetDataType());
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
 namespace ops = paddle::operators;
 REGISTER_OPERATOR(nce, ops::NCEOp, ops::NCEOpMaker,
                   paddle::framework::DefaultGradOpDescMaker<true>);
-REGISTER_OPERATOR(nce_grad, ops::NCEOpGrad);
+REGISTER_OPERATOR(nce_grad, ops::NCEOpGrad, ops::NCEOpGradVarTypeInference);
 REGISTER_OP_CPU_KERNEL(nce, ops::NCEKernel<paddle::platform::CPUPlace, float>,
                        ops::NCEKernel<paddle::platform::CPUPlace, double>);
 REGISTER_OP_CPU_KERNEL(nce_grad,
@@ -0,0 +1,323 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <thrust/random.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/nce_op.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+namespace {
+
+#define CUDA_1D_KERNEL_LOOP(i, n)                              \
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < (n); \
+       i += blockDim.x * gridDim.x)
+
+int const kNumCUDAThreads = 512;
+int const kNumMaxinumBlocks = 4096;
+
+static inline int NumBlocks(const int n) {
+  return std::min((n + kNumCUDAThreads - 1) / kNumCUDAThreads,
+                  kNumMaxinumBlocks);
+}
+
+// The true labels first, then the custom or uniformly sampled negative
+// classes, as PrepareSamples does on CPU.
+__global__ void SampleLabelsKernel(const int64_t *label, const int *custom_neg,
+                                   const int num_samples, const int num_label,
+                                   const int num_sample_labels,
+                                   const int num_total_classes,
+                                   const unsigned int seed,
+                                   int64_t *sample_labels) {
+  CUDA_1D_KERNEL_LOOP(idx, num_samples * num_sample_labels) {
+    const int i = idx / num_sample_labels;
+    const int j = idx % num_sample_labels;
+    if (j < num_label) {
+      sample_labels[idx] = label[i * num_label + j];
+    } else if (custom_neg) {
+      sample_labels[idx] = custom_neg[j - num_label];
+    } else {
+      thrust::minstd_rand rng;
+      rng.seed(seed);
+      thrust::uniform_int_distribution<int> dist(0, num_total_classes - 1);
+      rng.discard(idx);
+      sample_labels[idx] = dist(rng);
+    }
+  }
+}
+
+// sample_logits(i, j) = sigmoid(bias(l) + input.row(i) * weight.row(l)),
+// l = sample_labels(i, j).
+template <typename T>
+__global__ void SampleLogitsKernel(const int64_t *sample_labels, const T *x,
+                                   const T *weight, const T *bias,
+                                   const int num, const int num_sample_labels,
+                                   const int dim, T *sample_logits) {
+  CUDA_1D_KERNEL_LOOP(idx, num) {
+    const int i = idx / num_sample_labels;
+    const int64_t l = sample_labels[idx];
+    T o = bias ? bias[l] : static_cast<T>(0.0);
+    const T *x_row = x + i * dim;
+    const T *w_row = weight + l * dim;
+    for (int k = 0; k < dim; ++k) {
+      o += x_row[k] * w_row[k];
+    }
+    sample_logits[idx] =
+        static_cast<T>(1.0) / (static_cast<T>(1.0) + exp(-o));
+  }
+}
+
+template <typename T>
+__global__ void CostKernel(const T *sample_logits, const T *sample_weight,
+                           const int num_samples, const int num_true_class,
+                           const int num_sample_labels, const T b, T *cost) {
+  CUDA_1D_KERNEL_LOOP(i, num_samples) {
+    const T w = sample_weight ? sample_weight[i] : static_cast<T>(1.0);
+    const T *o = sample_logits + i * num_sample_labels;
+    T sum = static_cast<T>(0.0);
+    for (int j = 0; j < num_sample_labels; ++j) {
+      sum -= j < num_true_class ? log(o[j] / (o[j] + b)) : log(b / (o[j] + b));
+    }
+    cost[i] = w * sum;
+  }
+}
+
+template <typename T>
+__global__ void SampleGradKernel(const T *sample_logits, const T *sample_weight,
+                                 const T *cost_grad, const int num,
+                                 const int num_true_class,
+                                 const int num_sample_labels, const T b,
+                                 T *sample_grad) {
+  CUDA_1D_KERNEL_LOOP(idx, num) {
+    const int i = idx / num_sample_labels;
+    const T o = sample_logits[idx];
+    const T w = sample_weight ? sample_weight[i] : static_cast<T>(1.0);
+    const T g = (idx % num_sample_labels) < num_true_class
+                    ? w * (b / (o + b)) * (o - 1)
+                    : w * (o * (1 - o) / (o + b));
+    sample_grad[idx] = g * cost_grad[i];
+  }
+}
+
+template <typename T>
+__global__ void BiasGradKernel(const int64_t *sample_labels,
+                               const T *sample_grad, const int num,
+                               T *bias_grad) {
+  CUDA_1D_KERNEL_LOOP(idx, num) {
+    platform::CudaAtomicAdd(bias_grad + sample_labels[idx], sample_grad[idx]);
+  }
+}
+
+template <typename T>
+__global__ void WeightGradKernel(const int64_t *sample_labels,
+                                 const T *sample_grad, const T *x,
+                                 const int num, const int num_sample_labels,
+                                 const int dim, T *weight_grad) {
+  CUDA_1D_KERNEL_LOOP(idx, num * dim) {
+    const int s = idx / dim;
+    const int k = idx % dim;
+    const int i = s / num_sample_labels;
+    platform::CudaAtomicAdd(weight_grad + sample_labels[s] * dim + k,
+                            sample_grad[s] * x[i * dim + k]);
+  }
+}
+
+template <typename T>
+__global__ void SparseWeightGradKernel(const T *sample_grad, const T *x,
+                                       const int num,
+                                       const int num_sample_labels,
+                                       const int dim, T *weight_grad) {
+  CUDA_1D_KERNEL_LOOP(idx, num * dim) {
+    const int s = idx / dim;
+    const int i = s / num_sample_labels;
+    weight_grad[idx] = sample_grad[s] * x[i * dim + idx % dim];
+  }
+}
+
+template <typename T>
+__global__ void InputGradKernel(const int64_t *sample_labels,
+                                const T *sample_grad, const T *weight,
+                                const int num_samples,
+                                const int num_sample_labels, const int dim,
+                                T *x_grad) {
+  CUDA_1D_KERNEL_LOOP(idx, num_samples * dim) {
+    const int i = idx / dim;
+    const int k = idx % dim;
+    T sum = static_cast<T>(0.0);
+    for (int j = 0; j < num_sample_labels; ++j) {
+      const int s = i * num_sample_labels + j;
+      sum += sample_grad[s] * weight[sample_labels[s] * dim + k];
+    }
+    x_grad[idx] = sum;
+  }
+}
+
+}  // namespace
+
+template <typename T>
+class NCECUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *input = context.Input<Tensor>("Input");
+    auto *label = context.Input<Tensor>("Label");
+    auto *weight = context.Input<Tensor>("Weight");
+    auto *bias = context.Input<Tensor>("Bias");
+    auto *sample_weight = context.Input<Tensor>("SampleWeight");
+    auto *sample_labels = context.Output<Tensor>("SampleLabels");
+    auto *sample_logits = context.Output<Tensor>("SampleLogits");
+    auto *cost = context.Output<Tensor>("Cost");
+    int num_total_classes = context.Attr<int>("num_total_classes");
+    int num_neg_samples = context.Attr<int>("num_neg_samples");
+    std::vector<int> custom_neg_classes =
+        context.Attr<std::vector<int>>("custom_neg_classes");
+    auto stream =
+        context.template device_context<platform::CUDADeviceContext>()
+            .stream();
+
+    auto label_dims = label->dims();
+    int num_samples = static_cast<int>(label_dims[0]);
+    int num_label =
+        label_dims.size() == 2 ? static_cast<int>(label_dims[1]) : 1;
+    int num_sample_labels = static_cast<int>(sample_labels->dims()[1]);
+    int dim = static_cast<int>(input->dims()[1]);
+    int num = num_samples * num_sample_labels;
+
+    framework::Vector<int> custom_neg(custom_neg_classes);
+    std::random_device rd;
+    auto *sample_labels_data =
+        sample_labels->mutable_data<int64_t>(context.GetPlace());
+    SampleLabelsKernel<<<NumBlocks(num), kNumCUDAThreads, 0, stream>>>(
+        label->data<int64_t>(),
+        custom_neg_classes.empty() ? nullptr
+                                   : custom_neg.CUDAData(context.GetPlace()),
+        num_samples, num_label, num_sample_labels, num_total_classes, rd(),
+        sample_labels_data);
+
+    auto *sample_logits_data =
+        sample_logits->mutable_data<T>(context.GetPlace());
+    SampleLogitsKernel<T><<<NumBlocks(num), kNumCUDAThreads, 0, stream>>>(
+        sample_labels_data, input->data<T>(), weight->data<T>(),
+        bias ? bias->data<T>() : nullptr, num, num_sample_labels, dim,
+        sample_logits_data);
+
+    T b = 1. / num_total_classes * num_neg_samples;
+    int num_true_class = static_cast<int>(label_dims[1]);
+    CostKernel<T><<<NumBlocks(num_samples), kNumCUDAThreads, 0, stream>>>(
+        sample_logits_data,
+        sample_weight ? sample_weight->data<T>() : nullptr, num_samples,
+        num_true_class, num_sample_labels, b,
+        cost->mutable_data<T>(context.GetPlace()));
+  }
+};
+
+template <typename T>
+class NCEGradCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *input = context.Input<Tensor>("Input");
+    auto *label = context.Input<Tensor>("Label");
+    auto *weight = context.Input<Tensor>("Weight");
+    auto *sample_weight = context.Input<Tensor>("SampleWeight");
+    auto *sample_labels = context.Input<Tensor>("SampleLabels");
+    auto *sample_logits = context.Input<Tensor>("SampleLogits");
+    auto *d_cost = context.Input<Tensor>(framework::GradVarName("Cost"));
+    int num_total_classes = context.Attr<int>("num_total_classes");
+    int num_neg_samples = context.Attr<int>("num_neg_samples");
+    auto &dev_ctx =
+        context.template device_context<platform::CUDADeviceContext>();
+    auto stream = dev_ctx.stream();
+    math::SetConstant<platform::CUDADeviceContext, T> zero;
+
+    int num_samples = static_cast<int>(sample_labels->dims()[0]);
+    int num_sample_labels = static_cast<int>(sample_labels->dims()[1]);
+    int num_true_class = static_cast<int>(label->dims()[1]);
+    int dim = static_cast<int>(input->dims()[1]);
+    int num = num_samples * num_sample_labels;
+    const int64_t *sample_labels_data = sample_labels->data<int64_t>();
+    T b = 1. / num_total_classes * num_neg_samples;
+
+    Tensor sample_grad;  // tmp tensor
+    auto *sample_grad_data =
+        sample_grad.mutable_data<T>(sample_labels->dims(), context.GetPlace());
+    SampleGradKernel<T><<<NumBlocks(num), kNumCUDAThreads, 0, stream>>>(
+        sample_logits->data<T>(),
+        sample_weight ? sample_weight->data<T>() : nullptr, d_cost->data<T>(),
+        num, num_true_class, num_sample_labels, b, sample_grad_data);
+
+    auto *d_bias = context.Output<Tensor>(framework::GradVarName("Bias"));
+    if (d_bias != nullptr) {
+      d_bias->mutable_data<T>(context.GetPlace());
+      zero(dev_ctx, d_bias, static_cast<T>(0.0));
+      BiasGradKernel<T><<<NumBlocks(num), kNumCUDAThreads, 0, stream>>>(
+          sample_labels_data, sample_grad_data, num, d_bias->data<T>());
+    }
+
+    if (context.Attr<bool>("is_sparse")) {
+      auto *d_w = context.Output<framework::SelectedRows>(
+          framework::GradVarName("Weight"));
+      if (d_w != nullptr) {
+        framework::Vector<int64_t> rows(num);
+        memory::Copy(boost::get<platform::CUDAPlace>(context.GetPlace()),
+                     rows.CUDAMutableData(context.GetPlace()),
+                     boost::get<platform::CUDAPlace>(context.GetPlace()),
+                     sample_labels_data, num * sizeof(int64_t), stream);
+        d_w->set_rows(rows);
+        d_w->set_height(weight->dims()[0]);
+        auto *d_w_data = d_w->mutable_value()->mutable_data<T>(
+            framework::make_ddim(
+                {static_cast<int64_t>(num), static_cast<int64_t>(dim)}),
+            context.GetPlace());
+        SparseWeightGradKernel<T><<<NumBlocks(num * dim), kNumCUDAThreads, 0,
+                                    stream>>>(sample_grad_data,
+                                              input->data<T>(), num,
+                                              num_sample_labels, dim, d_w_data);
+      }
+    } else {
+      auto *d_w = context.Output<Tensor>(framework::GradVarName("Weight"));
+      if (d_w != nullptr) {
+        d_w->mutable_data<T>(context.GetPlace());
+        zero(dev_ctx, d_w, static_cast<T>(0.0));
+        WeightGradKernel<T><<<NumBlocks(num * dim), kNumCUDAThreads, 0,
+                              stream>>>(sample_labels_data, sample_grad_data,
+                                        input->data<T>(), num,
+                                        num_sample_labels, dim,
+                                        d_w->data<T>());
+      }
+    }
+
+    auto *d_x = context.Output<Tensor>(framework::GradVarName("Input"));
+    if (d_x != nullptr) {
+      InputGradKernel<T><<<NumBlocks(num_samples * dim), kNumCUDAThreads, 0,
+                           stream>>>(sample_labels_data, sample_grad_data,
+                                     weight->data<T>(), num_samples,
+                                     num_sample_labels, dim,
+                                     d_x->mutable_data<T>(context.GetPlace()));
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(nce, ops::NCECUDAKernel<float>,
+                        ops::NCECUDAKernel<double>);
+REGISTER_OP_CUDA_KERNEL(nce_grad, ops::NCEGradCUDAKernel<float>,
+                        ops::NCEGradCUDAKernel<double>);
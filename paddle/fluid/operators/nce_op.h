@@ -19,6 +19,7 @@ limitations under the License. */
 #include <vector>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/selected_rows.h"
 #include "unsupported/Eigen/CXX11/Tensor"
 namespace paddle {
 namespace operators {
@@ -183,16 +184,41 @@ class NCEGradKernel : public framework::OpKernel<T> {
       }
     }
     // get d_w
-    auto d_w = context.Output<Tensor>(framework::GradVarName("Weight"));
-    if (d_w != nullptr) {
-      auto d_w_data = d_w->mutable_data<T>(context.GetPlace());
-      std::fill(d_w_data, d_w_data + d_w->numel(), 0.0);
-      auto d_w_matrix = EigenMatrix<T>::From(*d_w);
-      auto x_matrix = EigenMatrix<T>::From(*(context.Input<Tensor>("Input")));
-      for (int64_t i = 0; i < sample_labels->numel(); ++i) {
-        d_w_matrix.chip(sample_labels_data[i], 0) +=
-            x_matrix.chip(static_cast<int>(i / sample_labels->dims()[1]), 0) *
-            sample_grad_data[i];
+    if (context.Attr<bool>("is_sparse")) {
+      // one row of the sparse gradient per sampled label
+      auto d_w = context.Output<framework::SelectedRows>(
+          framework::GradVarName("Weight"));
+      if (d_w != nullptr) {
+        const int64_t num_samples = sample_labels->numel();
+        std::vector<int64_t> rows(sample_labels_data,
+                                  sample_labels_data + num_samples);
+        d_w->set_rows(rows);
+        d_w->set_height(context.Input<Tensor>("Weight")->dims()[0]);
+        auto* d_w_value = d_w->mutable_value();
+        d_w_value->mutable_data<T>(
+            framework::make_ddim(
+                {num_samples, context.Input<Tensor>("Input")->dims()[1]}),
+            context.GetPlace());
+        auto d_w_matrix = EigenMatrix<T>::From(*d_w_value);
+        auto x_matrix = EigenMatrix<T>::From(*(context.Input<Tensor>("Input")));
+        for (int64_t i = 0; i < num_samples; ++i) {
+          d_w_matrix.chip(i, 0) =
+              x_matrix.chip(static_cast<int>(i / sample_labels->dims()[1]), 0) *
+              sample_grad_data[i];
+        }
+      }
+    } else {
+      auto d_w = context.Output<Tensor>(framework::GradVarName("Weight"));
+      if (d_w != nullptr) {
+        auto d_w_data = d_w->mutable_data<T>(context.GetPlace());
+        std::fill(d_w_data, d_w_data + d_w->numel(), 0.0);
+        auto d_w_matrix = EigenMatrix<T>::From(*d_w);
+        auto x_matrix = EigenMatrix<T>::From(*(context.Input<Tensor>("Input")));
+        for (int64_t i = 0; i < sample_labels->numel(); ++i) {
+          d_w_matrix.chip(sample_labels_data[i], 0) +=
+              x_matrix.chip(static_cast<int>(i / sample_labels->dims()[1]), 0) *
+              sample_grad_data[i];
+        }
       }
     }
     // get d_x
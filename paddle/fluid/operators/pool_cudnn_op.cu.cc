@@ -27,6 +27,14 @@ using PoolingMode = platform::PoolingMode;
 template <typename T>
 using ScalingParamType = typename platform::CudnnDataType<T>::ScalingParamType;
 
+static DataLayout PoolLayout(const framework::ExecutionContext &ctx,
+                             size_t num_spatial_dims) {
+  if (ctx.Attr<std::string>("data_format") == "NHWC") {
+    return DataLayout::kNHWC;
+  }
+  return num_spatial_dims == 2U ? DataLayout::kNCHW : DataLayout::kNCDHW;
+}
+
 template <typename T>
 class PoolCUDNNOpKernel : public framework::OpKernel<T> {
  public:
@@ -45,10 +53,12 @@ class PoolCUDNNOpKernel : public framework::OpKernel<T> {
     std::vector<int> ksize = ctx.Attr<std::vector<int>>("ksize");
     std::vector<int> strides = ctx.Attr<std::vector<int>>("strides");
     std::vector<int> paddings = ctx.Attr<std::vector<int>>("paddings");
+    DataLayout layout = PoolLayout(ctx, strides.size());
     if (ctx.Attr<bool>("global_pooling")) {
+      const int spatial_begin = layout == DataLayout::kNHWC ? 1 : 2;
       for (size_t i = 0; i < ksize.size(); ++i) {
         paddings[i] = 0;
-        ksize[i] = static_cast<int>(input->dims()[i + 2]);
+        ksize[i] = static_cast<int>(input->dims()[i + spatial_begin]);
       }
     }
 
@@ -56,13 +66,6 @@ class PoolCUDNNOpKernel : public framework::OpKernel<T> {
     ScopedTensorDescriptor input_desc;
     ScopedTensorDescriptor output_desc;
     ScopedPoolingDescriptor pool_desc;
-    DataLayout layout;
-
-    if (strides.size() == 2U) {
-      layout = DataLayout::kNCHW;
-    } else {
-      layout = DataLayout::kNCDHW;
-    }
 
     cudnnTensorDescriptor_t cudnn_input_desc = input_desc.descriptor<T>(
         layout, framework::vectorize2int(input->dims()));
@@ -108,10 +111,12 @@ class PoolCUDNNGradOpKernel : public framework::OpKernel<T> {
     std::vector<int> strides = ctx.Attr<std::vector<int>>("strides");
     std::vector<int> paddings = ctx.Attr<std::vector<int>>("paddings");
 
+    DataLayout layout = PoolLayout(ctx, strides.size());
     if (ctx.Attr<bool>("global_pooling")) {
+      const int spatial_begin = layout == DataLayout::kNHWC ? 1 : 2;
       for (size_t i = 0; i < ksize.size(); ++i) {
         paddings[i] = 0;
-        ksize[i] = static_cast<int>(input->dims()[i + 2]);
+        ksize[i] = static_cast<int>(input->dims()[i + spatial_begin]);
       }
     }
 
@@ -123,13 +128,6 @@ class PoolCUDNNGradOpKernel : public framework::OpKernel<T> {
     ScopedTensorDescriptor input_desc;
     ScopedTensorDescriptor output_desc;
     ScopedPoolingDescriptor pool_desc;
-    DataLayout layout;
-
-    if (strides.size() == 2U) {
-      layout = DataLayout::kNCHW;
-    } else {
-      layout = DataLayout::kNCDHW;
-    }
 
     cudnnTensorDescriptor_t cudnn_input_desc = input_desc.descriptor<T>(
         layout, framework::vectorize2int(input->dims()));
@@ -178,7 +176,8 @@ REGISTER_OP_KERNEL(pool2d, CUDNN, plat::CUDAPlace,
                    ops::PoolCUDNNOpKernel<plat::float16>);
 REGISTER_OP_KERNEL(pool2d_grad, CUDNN, plat::CUDAPlace,
                    ops::PoolCUDNNGradOpKernel<float>,
-                   ops::PoolCUDNNGradOpKernel<double>);
+                   ops::PoolCUDNNGradOpKernel<double>,
+                   ops::PoolCUDNNGradOpKernel<plat::float16>);
 
 REGISTER_OP_KERNEL(pool3d, CUDNN, plat::CUDAPlace,
                    ops::PoolCUDNNOpKernel<float>,
@@ -186,4 +185,5 @@ REGISTER_OP_KERNEL(pool3d, CUDNN, plat::CUDAPlace,
                    ops::PoolCUDNNOpKernel<plat::float16>);
 REGISTER_OP_KERNEL(pool3d_grad, CUDNN, plat::CUDAPlace,
                    ops::PoolCUDNNGradOpKernel<float>,
-                   ops::PoolCUDNNGradOpKernel<double>);
+                   ops::PoolCUDNNGradOpKernel<double>,
+                   ops::PoolCUDNNGradOpKernel<plat::float16>);
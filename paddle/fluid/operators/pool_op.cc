@@ -55,12 +55,18 @@ void PoolOp::InferShape(framework::InferShapeContext *ctx) const {
 
   PADDLE_ENFORCE(in_x_dims.size() == 4 || in_x_dims.size() == 5,
                  "Pooling intput should be 4-D or 5-D tensor.");
+  // The channels are the last dim of the NHWC input and output.
+  const bool channel_last =
+      ctx->Attrs().Get<std::string>("data_format") == "NHWC";
+  PADDLE_ENFORCE(!channel_last || in_x_dims.size() == 4,
+                 "The NHWC layout only supports pool2d.");
+  const int spatial_begin = channel_last ? 1 : 2;
 
   if (ctx->Attrs().Get<bool>("global_pooling")) {
     ksize.resize(static_cast<size_t>(in_x_dims.size()) - 2);
     for (size_t i = 0; i < ksize.size(); ++i) {
       paddings[i] = 0;
-      ksize[i] = static_cast<int>(in_x_dims[i + 2]);
+      ksize[i] = static_cast<int>(in_x_dims[i + spatial_begin]);
     }
   }
 
@@ -71,11 +77,14 @@ void PoolOp::InferShape(framework::InferShapeContext *ctx) const {
   PADDLE_ENFORCE_EQ(ksize.size(), paddings.size(),
                     "Paddings size and pooling size should be the same.");
 
-  std::vector<int64_t> output_shape({in_x_dims[0], in_x_dims[1]});
+  std::vector<int64_t> output_shape({in_x_dims[0]});
+  if (!channel_last) output_shape.push_back(in_x_dims[1]);
   for (size_t i = 0; i < ksize.size(); ++i) {
-    output_shape.push_back(PoolOutputSize(in_x_dims[i + 2], ksize[i],
-                                          paddings[i], strides[i], ceil_mode));
+    output_shape.push_back(PoolOutputSize(in_x_dims[i + spatial_begin],
+                                          ksize[i], paddings[i], strides[i],
+                                          ceil_mode));
   }
+  if (channel_last) output_shape.push_back(in_x_dims[3]);
   ctx->SetOutputDim("Out", framework::make_ddim(output_shape));
   ctx->ShareLoD("X", "Out");
 }
@@ -98,6 +107,13 @@ framework::OpKernelType PoolOp::GetExpectedKernelType(
     layout_ = framework::DataLayout::kMKLDNN;
   }
 #endif
+  if (layout_ == framework::DataLayout::kNHWC) {
+    PADDLE_ENFORCE_EQ(library_, framework::LibraryType::kCUDNN,
+                      "the NHWC layout can only be used when CUDNN is used");
+    // The cudnn kernel reads data_format itself, the input should not be
+    // transformed to the layout.
+    layout_ = framework::DataLayout::kAnyLayout;
+  }
 
   return framework::OpKernelType(
       framework::ToDataType(ctx.Input<Tensor>("X")->type()), ctx.GetPlace(),
@@ -129,6 +145,13 @@ framework::OpKernelType PoolOpGrad::GetExpectedKernelType(
     layout_ = framework::DataLayout::kMKLDNN;
   }
 #endif
+  if (layout_ == framework::DataLayout::kNHWC) {
+    PADDLE_ENFORCE_EQ(library_, framework::LibraryType::kCUDNN,
+                      "the NHWC layout can only be used when CUDNN is used");
+    // The cudnn kernel reads data_format itself, the input should not be
+    // transformed to the layout.
+    layout_ = framework::DataLayout::kAnyLayout;
+  }
 
   auto input_data_type = framework::ToDataType(ctx.Input<Tensor>("X")->type());
   if (input_data_type == framework::proto::VarType::FP16) {
@@ -201,10 +224,9 @@ void Pool2dOpMaker::Make() {
       .SetDefault(false);
   AddAttr<std::string>(
       "data_format",
-      "(string, default NCHW) Only used in "
-      "An optional string from: \"NHWC\", \"NCHW\". "
-      "Defaults to \"NHWC\". Specify the data format of the output data, "
-      "the input will be transformed automatically. ")
+      "(string, default AnyLayout) An optional string from: \"NHWC\", "
+      "\"NCHW\", \"AnyLayout\". \"NHWC\" is only supported by the cudnn "
+      "kernel, where Input(X) and Output(Out) are NHWC. The others are NCHW.")
       .SetDefault("AnyLayout");
   // TODO(dzhwinter): need to registered layout transform function
 
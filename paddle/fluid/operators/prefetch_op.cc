@@ -12,13 +12,17 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <algorithm>
+#include <cstring>
 #include <future>  // NOLINT
 #include <ostream>
+#include <vector>
 
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/detail/macros.h"
+#include "paddle/fluid/operators/distributed/prefetch_cache.h"
 #include "paddle/fluid/operators/send_recv_util.h"
 
 namespace paddle {
@@ -45,6 +49,11 @@ class PrefetchOp : public framework::OperatorBase {
         distributed::RPCClient::GetInstance<RPCCLIENT_T>(
             Attr<int>("trainer_id"));
 
+    if (Attr<int>("cache_size") > 0) {
+      RunWithCache(scope, place, rpc_client);
+      return;
+    }
+
     std::vector<distributed::VarHandlePtr> rets;
     for (size_t i = 0; i < ins.size(); i++) {
       if (NeedSend(scope, ins[i])) {
@@ -60,6 +69,127 @@ class PrefetchOp : public framework::OperatorBase {
       PADDLE_ENFORCE(rets[i]->Wait(), "internal error in RPCClient");
     }
   }
+
+ private:
+  // Only fetch the rows not in the trainer side cache.
+  void RunWithCache(const framework::Scope& scope,
+                    const platform::Place& place,
+                    distributed::RPCClient* rpc_client) const {
+    auto ins = Inputs("X");
+    auto outs = Outputs("Out");
+    std::vector<std::string> epmap = Attr<std::vector<std::string>>("epmap");
+
+    // the ids are looked up and the rows are written on the host
+    PADDLE_ENFORCE(platform::is_cpu_place(place),
+                   "The prefetch cache only supports CPUPlace, set "
+                   "cache_size to 0 to prefetch on the other places.");
+    platform::CPUPlace cpu;
+    auto& ctx = *platform::DeviceContextPool::Instance().Get(cpu);
+
+    auto* cache = distributed::PrefetchCache::Get(
+        Attr<std::string>("table_name"), Attr<int>("cache_size"),
+        Attr<int>("cache_staleness"));
+    cache->NextStep();
+
+    // apply the rows refreshed in the background during the last step
+    auto* refresh_scope = cache->refresh_scope();
+    for (auto& refresh : cache->TakeRefreshes()) {
+      PADDLE_ENFORCE(refresh.handle->Wait(), "internal error in RPCClient");
+      auto& ids = refresh_scope->FindVar(ins[refresh.index])
+                      ->Get<framework::LoDTensor>();
+      auto& rows = refresh_scope->FindVar(outs[refresh.index])
+                       ->Get<framework::LoDTensor>();
+      cache->Update(ids.data<int64_t>(), ids.numel(), rows.data<float>(),
+                    rows.numel() / ids.numel(), refresh.step);
+    }
+
+    auto& local_scope = scope.NewScope();
+    std::vector<std::vector<int64_t>> missed(ins.size());
+    std::vector<size_t> fetched;
+    std::vector<distributed::VarHandlePtr> rets;
+    for (size_t i = 0; i < ins.size(); i++) {
+      if (!NeedSend(scope, ins[i])) {
+        VLOG(3) << "don't send no-initialied variable: " << ins[i];
+        continue;
+      }
+      auto& ids = scope.FindVar(ins[i])->Get<framework::LoDTensor>();
+      auto* out = scope.FindVar(outs[i])->GetMutable<framework::LoDTensor>();
+      int64_t width = cache->width();
+      int64_t num = ids.numel();
+      if (width > 0) {
+        out->Resize({num, width});
+        cache->Lookup(ids.data<int64_t>(), num, out->mutable_data<float>(cpu),
+                      &missed[i]);
+      } else {
+        for (int64_t j = 0; j < num; ++j) missed[i].push_back(j);
+      }
+      if (missed[i].empty()) continue;
+
+      auto* missed_ids =
+          local_scope.Var(ins[i])->GetMutable<framework::LoDTensor>();
+      auto* missed_data = missed_ids->mutable_data<int64_t>(
+          {static_cast<int64_t>(missed[i].size()), 1}, cpu);
+      for (size_t j = 0; j < missed[i].size(); ++j) {
+        missed_data[j] = ids.data<int64_t>()[missed[i][j]];
+      }
+      VLOG(3) << "sending " << missed[i].size() << " of " << num << " ids in "
+              << ins[i] << " to " << epmap[i];
+      rets.push_back(rpc_client->AsyncPrefetchVar(epmap[i], ctx, local_scope,
+                                                  ins[i], outs[i]));
+      fetched.push_back(i);
+    }
+    for (size_t i = 0; i < rets.size(); i++) {
+      PADDLE_ENFORCE(rets[i]->Wait(), "internal error in RPCClient");
+    }
+
+    for (auto i : fetched) {
+      auto& missed_ids =
+          local_scope.FindVar(ins[i])->Get<framework::LoDTensor>();
+      auto& rows = local_scope.FindVar(outs[i])->Get<framework::LoDTensor>();
+      int64_t width = rows.numel() / missed_ids.numel();
+      cache->Update(missed_ids.data<int64_t>(), missed_ids.numel(),
+                    rows.data<float>(), width, cache->step());
+
+      auto& ids = scope.FindVar(ins[i])->Get<framework::LoDTensor>();
+      auto* out = scope.FindVar(outs[i])->GetMutable<framework::LoDTensor>();
+      out->Resize({ids.numel(), width});
+      auto* out_data = out->mutable_data<float>(cpu);
+      for (size_t j = 0; j < missed[i].size(); ++j) {
+        std::memcpy(out_data + missed[i][j] * width,
+                    rows.data<float>() + j * width, width * sizeof(float));
+      }
+    }
+    scope.DeleteScope(&local_scope);
+
+    if (Attr<bool>("pipeline")) {
+      // refresh the cached rows used by this step while it computes
+      for (size_t i = 0; i < ins.size(); i++) {
+        if (!NeedSend(scope, ins[i])) continue;
+        auto& ids = scope.FindVar(ins[i])->Get<framework::LoDTensor>();
+        int64_t num = ids.numel();
+        std::vector<int64_t> hits;
+        size_t k = 0;
+        for (int64_t j = 0; j < num; ++j) {
+          if (k < missed[i].size() && missed[i][k] == j) {
+            ++k;
+          } else {
+            hits.push_back(ids.data<int64_t>()[j]);
+          }
+        }
+        if (hits.empty()) continue;
+        auto* refresh_ids =
+            refresh_scope->Var(ins[i])->GetMutable<framework::LoDTensor>();
+        auto* refresh_data = refresh_ids->mutable_data<int64_t>(
+            {static_cast<int64_t>(hits.size()), 1}, cpu);
+        std::copy(hits.begin(), hits.end(), refresh_data);
+        refresh_scope->Var(outs[i]);
+        cache->AddRefresh({i, cache->step(),
+                           rpc_client->AsyncPrefetchVar(epmap[i], ctx,
+                                                        *refresh_scope, ins[i],
+                                                        outs[i])});
+      }
+    }
+  }
 };
 
 class PrefetchOpMaker : public framework::OpProtoAndCheckerMaker {
@@ -76,11 +206,33 @@ class PrefetchOpMaker : public framework::OpProtoAndCheckerMaker {
         "(string vector, default 127.0.0.1:6164)"
         "Server endpoints in the order of input variables for mapping")
         .SetDefault({"127.0.0.1:6164"});
+    AddAttr<std::string>("table_name",
+                         "(string, default \"\") The name of the table, "
+                         "the key of the prefetch cache.")
+        .SetDefault("");
+    AddAttr<int>("cache_size",
+                 "(int, default 0) The number of the rows cached on the "
+                 "trainer, 0 means not caching. Only CPUPlace supports "
+                 "caching.")
+        .SetDefault(0);
+    AddAttr<int>("cache_staleness",
+                 "(int, default 1) The number of the following steps a "
+                 "cached row can be reused in.")
+        .SetDefault(1);
+    AddAttr<bool>("pipeline",
+                  "(bool, default false) Refresh the cached rows used by a "
+                  "step in the background while the step computes.")
+        .SetDefault(false);
     AddComment(R"DOC(
 Prefetch operator
 
 This operator will send Ids variables to listen_and_serve op at
 the parameter server and fetch result back.
+
+With cache_size, the fetched rows are cached on the trainer and only the
+ids not in the cache are sent. In the pipeline mode, the cached rows used
+by a step are fetched again in the background, so the hot rows stay
+fresh without blocking the next step.
 )DOC");
   }
 };
@@ -0,0 +1,109 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace operators {
+
+using framework::Tensor;
+
+template <typename Q>
+static void Quantize(const float* in, int64_t numel, float scale, Q* out) {
+  constexpr float lower = std::numeric_limits<Q>::min();
+  constexpr float upper = std::numeric_limits<Q>::max();
+  for (int64_t i = 0; i < numel; ++i) {
+    float value = std::round(in[i] * scale);
+    out[i] = static_cast<Q>(std::min(std::max(value, lower), upper));
+  }
+}
+
+template <typename T>
+class QuantizeKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* input = ctx.Input<Tensor>("Input");
+    auto* output = ctx.Output<Tensor>("Output");
+    float scale = ctx.Attr<float>("Scale");
+    const T* input_data = input->data<T>();
+    if (ctx.Attr<bool>("is_negative_input")) {
+      Quantize(input_data, input->numel(), scale,
+               output->mutable_data<int8_t>(ctx.GetPlace()));
+    } else {
+      Quantize(input_data, input->numel(), scale,
+               output->mutable_data<uint8_t>(ctx.GetPlace()));
+    }
+  }
+};
+
+class QuantizeOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("Input"),
+                   "Input(Input) of QuantizeOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Output"),
+                   "Output(Output) of QuantizeOp should not be null.");
+
+    ctx->ShareDim("Input", /*->*/ "Output");
+    ctx->ShareLoD("Input", /*->*/ "Output");
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        framework::ToDataType(ctx.Input<Tensor>("Input")->type()),
+        ctx.GetPlace());
+  }
+};
+
+class QuantizeOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Input", "(Tensor) The FP32 tensor to be quantized.");
+    AddOutput("Output",
+              "(Tensor) The INT8 tensor if is_negative_input, "
+              "the UINT8 tensor otherwise.");
+    AddAttr<float>("Scale", "(float) The scale the Input is quantized with.")
+        .SetDefault(1.0f);
+    AddAttr<bool>("is_negative_input",
+                  "(bool, default false) Whether the Input has negative "
+                  "values, quantize it to INT8 instead of UINT8.")
+        .SetDefault(false);
+    AddComment(R"DOC(
+QuantizeOp operator.
+
+It quantizes the FP32 tensors to the INT8 or UINT8 inputs of the quantized
+operators, the values out of the range of the type are saturated:
+
+$$Output = round(Input * Scale)$$
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+
+REGISTER_OPERATOR(quantize, ops::QuantizeOp, ops::QuantizeOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OP_CPU_KERNEL(quantize, ops::QuantizeKernel<float>);
@@ -0,0 +1,33 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+// Concat the instances slot by slot along the first dim into a batch, where
+// the LoDs of the instances are merged. The instances should have the same
+// data types and the same shapes except the first dims.
+void MergeInstancesToBatch(
+    const std::vector<std::vector<framework::LoDTensor>>& instances,
+    std::vector<framework::LoDTensor>* out);
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
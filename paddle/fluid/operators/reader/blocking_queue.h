@@ -14,8 +14,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>  // NOLINT
-#include <deque>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
 
 #include "paddle/fluid/platform/enforce.h"
 
@@ -30,100 +35,235 @@ class BlockingQueue {
   // framework::Channel, but which has currently a deadlock bug. BlockingQueue
   // is a workaround and a simplified version of framework::Channel as it
   // doesn't support GPU and it implements on buffered blocking queue.
+  //
+  // The elements are kept in a bounded lock-free ring buffer, where each cell
+  // has a sequence number telling whether it is ready to be written or read
+  // in the current lap. Send and Receive spin for a while when the queue is
+  // full or empty, and then park on a condition variable, so the mutex is
+  // only locked by the waiting threads and the threads waking them.
  public:
   explicit BlockingQueue(size_t capacity, bool speed_test_mode = false)
-      : capacity_(capacity), speed_test_mode_(speed_test_mode), closed_(false) {
+      : capacity_(capacity),
+        speed_test_mode_(speed_test_mode),
+        closed_(false),
+        send_pos_(0),
+        receive_pos_(0),
+        num_waiting_senders_(0),
+        num_waiting_receivers_(0) {
     PADDLE_ENFORCE_GT(
         capacity_, 0,
         "The capacity of a reader::BlockingQueue must be greater than 0.");
-  }
-
-  bool Send(const T& elem) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    send_cv_.wait(lock, [&] { return queue_.size() < capacity_ || closed_; });
-    if (closed_) {
-      VLOG(5)
-          << "WARNING: Sending an element to a closed reader::BlokcingQueue.";
-      return false;
+    cells_.reset(new Cell[capacity_]);
+    for (size_t i = 0; i < capacity_; ++i) {
+      cells_[i].seq.store(i, std::memory_order_relaxed);
     }
-    PADDLE_ENFORCE_LT(queue_.size(), capacity_);
-    queue_.push_back(elem);
-    receive_cv_.notify_one();
-    return true;
   }
 
-  bool Send(T&& elem) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    send_cv_.wait(lock, [&] { return queue_.size() < capacity_ || closed_; });
-    if (closed_) {
-      VLOG(5)
-          << "WARNING: Sending an element to a closed reader::BlokcingQueue.";
-      return false;
-    }
-    PADDLE_ENFORCE_LT(queue_.size(), capacity_);
-    queue_.emplace_back(std::move(elem));
-    receive_cv_.notify_one();
-    return true;
-  }
+  bool Send(const T& elem) { return SendImpl(elem); }
+
+  bool Send(T&& elem) { return SendImpl(std::move(elem)); }
 
   bool Receive(T* elem) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    receive_cv_.wait(lock, [&] { return !queue_.empty() || closed_; });
-    if (!queue_.empty()) {
-      PADDLE_ENFORCE_NOT_NULL(elem);
-      *elem = queue_.front();
-      if (LIKELY(!speed_test_mode_)) {
-        queue_.pop_front();
+    PADDLE_ENFORCE_NOT_NULL(elem);
+    for (int i = 0; i < kSpinCount; ++i) {
+      if (TryReceive(elem, !speed_test_mode_)) {
+        NotifySenders();
+        return true;
+      }
+      if (closed_.load()) {
+        break;
+      }
+      std::this_thread::yield();
+    }
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        num_waiting_receivers_.fetch_add(1);
+        receive_cv_.wait(lock, [&] { return CanReceive() || closed_.load(); });
+        num_waiting_receivers_.fetch_sub(1);
+      }
+      // The elements sent before Close are still received. Another receiver
+      // may take the element after the wait, so try it again.
+      if (TryReceive(elem, !speed_test_mode_)) {
+        NotifySenders();
+        return true;
+      }
+      if (closed_.load()) {
+        return false;
       }
-      send_cv_.notify_one();
-      return true;
-    } else {
-      PADDLE_ENFORCE(closed_);
-      return false;
     }
   }
 
+  // ReOpen drops the elements in the queue. It should not be called along
+  // with Send or Receive.
   void ReOpen() {
+    T elem;
+    while (TryReceive(&elem, true)) {
+    }
     std::lock_guard<std::mutex> lock(mutex_);
-    closed_ = false;
-    std::deque<T> new_deque;
-    queue_.swap(new_deque);
+    closed_.store(false);
     send_cv_.notify_all();
     receive_cv_.notify_all();
   }
 
   void Close() {
     std::lock_guard<std::mutex> lock(mutex_);
-    closed_ = true;
+    closed_.store(true);
     send_cv_.notify_all();
     receive_cv_.notify_all();
   }
 
-  bool IsClosed() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return closed_;
-  }
+  bool IsClosed() const { return closed_.load(); }
 
-  size_t Cap() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return capacity_;
-  }
+  size_t Cap() const { return capacity_; }
 
   size_t Size() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return queue_.size();
+    size_t receive_pos = receive_pos_.load();
+    size_t send_pos = send_pos_.load();
+    return send_pos > receive_pos ? send_pos - receive_pos : 0;
   }
 
  private:
+  // The number of the tries before parking.
+  static constexpr int kSpinCount = 64;
+
+  struct Cell {
+    std::atomic<size_t> seq;
+    T data;
+  };
+
+  template <typename U>
+  bool SendImpl(U&& elem) {
+    for (int i = 0; i < kSpinCount; ++i) {
+      if (closed_.load()) {
+        VLOG(5) << "WARNING: Sending an element to a closed "
+                   "reader::BlokcingQueue.";
+        return false;
+      }
+      if (TrySend(&elem)) {
+        NotifyReceivers();
+        return true;
+      }
+      std::this_thread::yield();
+    }
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        num_waiting_senders_.fetch_add(1);
+        send_cv_.wait(lock, [&] { return CanSend() || closed_.load(); });
+        num_waiting_senders_.fetch_sub(1);
+      }
+      if (closed_.load()) {
+        VLOG(5) << "WARNING: Sending an element to a closed "
+                   "reader::BlokcingQueue.";
+        return false;
+      }
+      // Another sender may take the cell after the wait, so try it again.
+      if (TrySend(&elem)) {
+        NotifyReceivers();
+        return true;
+      }
+    }
+  }
+
+  template <typename U>
+  bool TrySend(U* elem) {
+    size_t pos = send_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells_[pos % capacity_];
+      size_t seq = cell.seq.load(std::memory_order_acquire);
+      if (seq == pos) {
+        if (send_pos_.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_relaxed)) {
+          cell.data = std::forward<U>(*elem);
+          cell.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (seq < pos) {
+        return false;  // full
+      } else {
+        pos = send_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Receive the front of the queue, which is kept in the queue if pop is
+  // false. The front is never taken by others in the speed test mode, so it
+  // could be copied safely.
+  bool TryReceive(T* elem, bool pop) {
+    size_t pos = receive_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells_[pos % capacity_];
+      size_t seq = cell.seq.load(std::memory_order_acquire);
+      if (seq == pos + 1) {
+        if (!pop) {
+          *elem = cell.data;
+          return true;
+        }
+        if (receive_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          *elem = std::move(cell.data);
+          cell.seq.store(pos + capacity_, std::memory_order_release);
+          return true;
+        }
+      } else if (seq < pos + 1) {
+        return false;  // empty
+      } else {
+        pos = receive_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool CanSend() const {
+    size_t pos = send_pos_.load();
+    return cells_[pos % capacity_].seq.load() == pos;
+  }
+
+  bool CanReceive() const {
+    size_t pos = receive_pos_.load();
+    return cells_[pos % capacity_].seq.load() == pos + 1;
+  }
+
+  // The waiting counter is increased under the mutex before checking the
+  // predicate, so a thread parked after a check is always notified.
+  void NotifySenders() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (num_waiting_senders_.load() > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      send_cv_.notify_one();
+    }
+  }
+
+  void NotifyReceivers() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (num_waiting_receivers_.load() > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      receive_cv_.notify_one();
+    }
+  }
+
   size_t capacity_;
   bool speed_test_mode_;
-  bool closed_;
-  std::deque<T> queue_;
+  std::atomic<bool> closed_;
+  std::unique_ptr<Cell[]> cells_;
+
+  // The positions are written by different threads, so keep them in
+  // different cache lines.
+  std::atomic<size_t> send_pos_;
+  char pad0_[64];
+  std::atomic<size_t> receive_pos_;
+  char pad1_[64];
 
+  std::atomic<int> num_waiting_senders_;
+  std::atomic<int> num_waiting_receivers_;
   mutable std::mutex mutex_;
   mutable std::condition_variable receive_cv_;
   mutable std::condition_variable send_cv_;
 };
+
+template <typename T>
+constexpr int BlockingQueue<T>::kSpinCount;
+
 }  // namespace reader
 }  // namespace operators
 }  // namespace paddle
@@ -14,6 +14,8 @@
 
 #include "paddle/fluid/operators/reader/buffered_reader.h"
 #include <vector>
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/memory/memcpy.h"
 
 namespace paddle {
 namespace operators {
@@ -35,6 +37,9 @@ BufferedReader::BufferedReader(
       buffer_size_(buffer_size) {
   cpu_buffer_.resize(buffer_size);
   gpu_buffer_.resize(buffer_size);
+#ifdef PADDLE_WITH_CUDA
+  pinned_buffer_.resize(buffer_size);
+#endif
   ReadTillBufferFullAsync();
 }
 
@@ -57,8 +62,24 @@ void BufferedReader::ReadAsync(size_t i) {
     if (platform::is_gpu_place(place_)) {
       TensorVec &gpu = gpu_buffer_[i];
       gpu.resize(cpu.size());
+#ifdef PADDLE_WITH_CUDA
+      TensorVec &pinned = pinned_buffer_[i];
+      pinned.resize(cpu.size());
+#endif
       for (size_t i = 0; i < cpu.size(); ++i) {
-        framework::TensorCopySync(cpu[i], place_, &gpu[i]);
+#ifdef PADDLE_WITH_CUDA
+        if (platform::is_cpu_place(cpu[i].place())) {
+          // Stage the pageable batch in the pinned buffer of the slot, which
+          // only grows to the largest batch, so the upload is a DMA copy
+          // without the bounce buffer of the driver.
+          StageToPinned(cpu[i], &pinned[i]);
+          framework::TensorCopyOnCopyStream(pinned[i], place_, &gpu[i]);
+        } else {
+          framework::TensorCopyOnCopyStream(cpu[i], place_, &gpu[i]);
+        }
+#else
+        framework::TensorCopyOnCopyStream(cpu[i], place_, &gpu[i]);
+#endif
         gpu[i].set_lod(cpu[i].lod());
       }
     }
@@ -66,6 +87,22 @@ void BufferedReader::ReadAsync(size_t i) {
   }));
 }
 
+#ifdef PADDLE_WITH_CUDA
+void BufferedReader::StageToPinned(const framework::LoDTensor &src,
+                                   framework::LoDTensor *pinned) {
+  src.check_memory_size();
+  pinned->Resize(src.dims());
+  pinned->set_layout(src.layout());
+  // mutable_data reuses the allocation unless the batch is larger than any
+  // batch staged before.
+  auto dst_ptr = pinned->mutable_data(platform::CUDAPinnedPlace(), src.type());
+  auto size = src.numel() * framework::SizeOfType(src.type());
+  memory::Copy(platform::CUDAPinnedPlace(), dst_ptr,
+               boost::get<platform::CPUPlace>(src.place()), src.data<void>(),
+               size);
+}
+#endif
+
 void BufferedReader::ShutdownImpl() {
   reader_->Shutdown();
   while (!position_.empty()) {
@@ -39,6 +39,12 @@ class BufferedReader : public framework::DecoratedReader {
 
   void ReadAsync(size_t i);
 
+#ifdef PADDLE_WITH_CUDA
+  // Copy src into the pinned staging tensor of a slot.
+  void StageToPinned(const framework::LoDTensor& src,
+                     framework::LoDTensor* pinned);
+#endif
+
  protected:
   void ShutdownImpl() override;
   void StartImpl() override;
@@ -58,6 +64,11 @@ class BufferedReader : public framework::DecoratedReader {
   // buffers and prevent alloc every time.
   std::vector<TensorVec> cpu_buffer_;
   std::vector<TensorVec> gpu_buffer_;
+#ifdef PADDLE_WITH_CUDA
+  // The CUDAPinnedPlace staging buffers of the slots, the CPU batches are
+  // uploaded to gpu_buffer_ through them.
+  std::vector<TensorVec> pinned_buffer_;
+#endif
   size_t prev_pos_{-1UL};
 };
 
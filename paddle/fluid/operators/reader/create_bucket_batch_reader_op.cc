@@ -0,0 +1,234 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <deque>
+#include "paddle/fluid/operators/reader/batch_util.h"
+#include "paddle/fluid/operators/reader/reader_op_registry.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+// BucketBatchReader puts the instances into the buckets by their lengths and
+// yields a batch of a bucket once it is full, so that the instances of a
+// batch have similar lengths and the padding is small. A bucket is full when
+// it has batch_size instances, or when the next instance would make the
+// padded tokens, i.e. the number of instances times the max length, exceed
+// batch_tokens. At most pool_size instances are kept in the buckets, beyond
+// which the largest bucket is yielded even if it is not full.
+class BucketBatchReader : public framework::DecoratedReader {
+ public:
+  BucketBatchReader(const std::shared_ptr<ReaderBase>& reader,
+                    const std::vector<int>& bucket_boundaries,
+                    size_t batch_size, size_t batch_tokens, size_t pool_size,
+                    size_t length_slot, bool discard_leftover)
+      : DecoratedReader(reader),
+        bucket_boundaries_(bucket_boundaries),
+        batch_size_(batch_size),
+        batch_tokens_(batch_tokens),
+        pool_size_(pool_size),
+        length_slot_(length_slot),
+        discard_leftover_(discard_leftover),
+        buckets_(bucket_boundaries.size() + 1) {
+    PADDLE_ENFORCE(std::is_sorted(bucket_boundaries_.begin(),
+                                  bucket_boundaries_.end()),
+                   "The bucket_boundaries should be sorted.");
+  }
+
+  void ReadNextImpl(std::vector<framework::LoDTensor>* out) override;
+
+ private:
+  struct Bucket {
+    std::vector<std::vector<framework::LoDTensor>> instances;
+    size_t max_length{0};
+  };
+
+  void ShutdownImpl() override {
+    reader_->Shutdown();
+    Reset();
+  }
+
+  void StartImpl() override {
+    Reset();
+    reader_->Start();
+  }
+
+  void Reset() {
+    for (auto& bucket : buckets_) {
+      bucket.instances.clear();
+      bucket.max_length = 0;
+    }
+    ready_.clear();
+    num_pooled_ = 0;
+    eof_ = false;
+  }
+
+  void AddInstance(std::vector<framework::LoDTensor>* ins);
+
+  void YieldBucket(Bucket* bucket);
+
+  std::vector<int> bucket_boundaries_;
+  size_t batch_size_;
+  size_t batch_tokens_;
+  size_t pool_size_;
+  size_t length_slot_;
+  bool discard_leftover_;
+
+  std::vector<Bucket> buckets_;
+  std::deque<std::vector<framework::LoDTensor>> ready_;
+  size_t num_pooled_{0};
+  bool eof_{false};
+};
+
+void BucketBatchReader::ReadNextImpl(std::vector<framework::LoDTensor>* out) {
+  while (ready_.empty() && !eof_) {
+    std::vector<framework::LoDTensor> ins;
+    reader_->ReadNext(&ins);
+    if (ins.empty()) {
+      eof_ = true;
+      if (!discard_leftover_) {
+        for (auto& bucket : buckets_) {
+          YieldBucket(&bucket);
+        }
+      }
+      break;
+    }
+    AddInstance(&ins);
+  }
+  out->clear();
+  if (ready_.empty()) {
+    return;
+  }
+  out->swap(ready_.front());
+  ready_.pop_front();
+}
+
+void BucketBatchReader::AddInstance(std::vector<framework::LoDTensor>* ins) {
+  PADDLE_ENFORCE_LT(length_slot_, ins->size(),
+                    "The length_slot is out of the slots of the reader.");
+  size_t length = static_cast<size_t>((*ins)[length_slot_].dims()[0]);
+  size_t bucket_id =
+      std::upper_bound(bucket_boundaries_.begin(), bucket_boundaries_.end(),
+                       static_cast<int>(length)) -
+      bucket_boundaries_.begin();
+  auto& bucket = buckets_[bucket_id];
+  if (batch_tokens_ > 0 && !bucket.instances.empty() &&
+      (bucket.instances.size() + 1) * std::max(bucket.max_length, length) >
+          batch_tokens_) {
+    YieldBucket(&bucket);
+  }
+  bucket.instances.emplace_back();
+  bucket.instances.back().swap(*ins);
+  bucket.max_length = std::max(bucket.max_length, length);
+  ++num_pooled_;
+  if (batch_size_ > 0 && bucket.instances.size() >= batch_size_) {
+    YieldBucket(&bucket);
+  }
+  if (num_pooled_ > pool_size_) {
+    auto largest = std::max_element(
+        buckets_.begin(), buckets_.end(), [](const Bucket& a, const Bucket& b) {
+          return a.instances.size() < b.instances.size();
+        });
+    YieldBucket(&*largest);
+  }
+}
+
+void BucketBatchReader::YieldBucket(Bucket* bucket) {
+  if (bucket->instances.empty()) {
+    return;
+  }
+  ready_.emplace_back();
+  MergeInstancesToBatch(bucket->instances, &ready_.back());
+  num_pooled_ -= bucket->instances.size();
+  bucket->instances.clear();
+  bucket->max_length = 0;
+}
+
+class CreateBucketBatchReaderOp : public framework::OperatorBase {
+ public:
+  using framework::OperatorBase::OperatorBase;
+
+ private:
+  void RunImpl(const framework::Scope& scope,
+               const platform::Place& dev_place) const override {
+    auto* out = scope.FindVar(Output("Out"))
+                    ->template GetMutable<framework::ReaderHolder>();
+    if (out->Get() != nullptr) {
+      return;
+    }
+    int batch_size = Attr<int>("batch_size");
+    int batch_tokens = Attr<int>("batch_tokens");
+    PADDLE_ENFORCE(batch_size > 0 || batch_tokens > 0,
+                   "Either batch_size or batch_tokens should be positive.");
+    const auto& underlying_reader = scope.FindVar(Input("UnderlyingReader"))
+                                        ->Get<framework::ReaderHolder>();
+    out->Reset(framework::MakeDecoratedReader<BucketBatchReader>(
+        underlying_reader, Attr<std::vector<int>>("bucket_boundaries"),
+        static_cast<size_t>(batch_size), static_cast<size_t>(batch_tokens),
+        static_cast<size_t>(Attr<int>("pool_size")),
+        static_cast<size_t>(Attr<int>("length_slot")),
+        Attr<bool>("discard_leftover")));
+  }
+};
+
+class CreateBucketBatchReaderOpMaker : public DecoratedReaderMakerBase {
+ protected:
+  void Apply() override {
+    AddAttr<std::vector<int>>(
+        "bucket_boundaries",
+        "The sorted upper bounds (exclusive) of the lengths of the buckets. "
+        "The instances not less than the last bound are in the last bucket.")
+        .SetDefault({});
+    AddAttr<int>("batch_size",
+                 "The max number of the instances of a batch. 0 means no "
+                 "limit.")
+        .SetDefault(0)
+        .GreaterThan(-1);
+    AddAttr<int>("batch_tokens",
+                 "The max padded tokens of a batch, i.e. the number of the "
+                 "instances times the max length. 0 means no limit.")
+        .SetDefault(0)
+        .GreaterThan(-1);
+    AddAttr<int>("pool_size",
+                 "The max number of the instances kept in the buckets.")
+        .SetDefault(1024)
+        .GreaterThan(0);
+    AddAttr<int>("length_slot",
+                 "The slot whose first dim is the length of an instance.")
+        .SetDefault(0)
+        .GreaterThan(-1);
+    AddAttr<bool>("discard_leftover",
+                  "If true, the instances left in the buckets at the end of "
+                  "the pass will be discarded.")
+        .SetDefault(false);
+    AddComment(R"DOC(
+      CreateBucketBatchReader Operator
+
+      A bucket batch reader takes another reader as its 'underlying reader',
+      groups the underlying reader's outputs by their lengths and then yields
+      them in batches of similar lengths. The size of a batch is limited by
+      batch_size, or by batch_tokens, the max padded tokens of a batch.
+    )DOC");
+  }
+};
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators::reader;
+REGISTER_DECORATED_READER_OPERATOR(create_bucket_batch_reader,
+                                   ops::CreateBucketBatchReaderOp,
+                                   ops::CreateBucketBatchReaderOpMaker);
@@ -22,7 +22,7 @@ template <bool ThreadSafe>
 class RecordIOFileReader : public framework::FileReader {
  public:
   explicit RecordIOFileReader(const std::string& filename)
-      : scanner_(filename),
+      : scanner_(filename, RecordIOScannerOptions()),
         dev_ctx_(*platform::DeviceContextPool::Instance().Get(
             platform::CPUPlace())) {
     if (ThreadSafe) {
@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include <random>
+#include <utility>
+#include <vector>
 #include "glog/logging.h"
 #include "paddle/fluid/operators/detail/safe_ref.h"
 #include "paddle/fluid/operators/reader/reader_op_registry.h"
@@ -21,66 +23,78 @@ namespace paddle {
 namespace operators {
 namespace reader {
 
+// ShuffleReader keeps a pool of buffer_size instances, yields a random one
+// of them each time and puts the next instance of the underlying reader in
+// its place. So the instances are shuffled incrementally, without refilling
+// the whole buffer, and each output is mixed with the instances read from
+// all the files behind the underlying reader during the last buffer_size
+// reads.
 class ShuffleReader : public framework::DecoratedReader {
  public:
   ShuffleReader(const std::shared_ptr<ReaderBase>& reader, size_t buffer_size,
                 size_t seed = 0)
-      : DecoratedReader(reader), buffer_size_(buffer_size), seed_(seed) {
+      : DecoratedReader(reader), buffer_size_(buffer_size) {
     VLOG(10) << "Create shuffle reader of " << reader_;
-    if (seed_ == 0) {
+    if (seed == 0) {
       std::random_device device;
-      seed_ = device();
+      seed = device();
     }
-    ReloadBuffer();
+    engine_.seed(seed);
   }
 
   void ReadNextImpl(std::vector<framework::LoDTensor>* out) override {
     out->clear();
-    if (iteration_pos_ >= buffer_.size()) {
-      VLOG(10) << "Resetting shuffle buffer";
-      ReloadBuffer();
-      if (buffer_.empty()) {
-        return;
-      }
+    if (!filled_) {
+      FillBuffer();
+    }
+    if (buffer_.empty()) {
+      return;
+    }
+    std::uniform_int_distribution<size_t> dist(0, buffer_.size() - 1);
+    size_t pos = dist(engine_);
+    out->swap(buffer_[pos]);
+    if (!eof_) {
+      reader_->ReadNext(&buffer_[pos]);
+      eof_ = buffer_[pos].empty();
+    }
+    if (eof_) {
+      buffer_[pos].swap(buffer_.back());
+      buffer_.pop_back();
     }
-    *out = buffer_[iteration_pos_++];
   }
 
  private:
   void ShutdownImpl() override {
     reader_->Shutdown();
     buffer_.clear();
-    iteration_pos_ = 0;
+    filled_ = false;
+    eof_ = false;
   }
 
-  void StartImpl() override {
-    reader_->Start();
-    ReloadBuffer();
-  }
+  void StartImpl() override { reader_->Start(); }
 
-  void ReloadBuffer() {
+  void FillBuffer() {
     buffer_.clear();
     buffer_.reserve(buffer_size_);
-    iteration_pos_ = 0;
+    eof_ = false;
     for (size_t i = 0; i < buffer_size_; ++i) {
       std::vector<framework::LoDTensor> ins;
       reader_->ReadNext(&ins);
       if (ins.empty()) {
+        eof_ = true;
         break;
       }
-      buffer_.emplace_back(ins);
+      buffer_.emplace_back(std::move(ins));
     }
-    std::mt19937 g(seed_);
-    std::shuffle(buffer_.begin(), buffer_.end(), g);
-    seed_ = g();  // update seed_;
+    filled_ = true;
     VLOG(10) << "random buffer size = " << buffer_.size();
   }
 
   size_t buffer_size_;
   std::vector<std::vector<framework::LoDTensor>> buffer_;
-
-  size_t iteration_pos_;
-  size_t seed_;
+  bool filled_{false};
+  bool eof_{false};
+  std::mt19937 engine_;
 };
 
 class CreateShuffleReaderOp : public framework::OperatorBase {
@@ -98,7 +112,8 @@ class CreateShuffleReaderOp : public framework::OperatorBase {
     const auto& underlying_reader = scope.FindVar(Input("UnderlyingReader"))
                                         ->Get<framework::ReaderHolder>();
     out->Reset(framework::MakeDecoratedReader<ShuffleReader>(
-        underlying_reader, static_cast<size_t>(Attr<int>("buffer_size"))));
+        underlying_reader, static_cast<size_t>(Attr<int>("buffer_size")),
+        static_cast<size_t>(Attr<int>("seed"))));
   }
 };
 
@@ -106,11 +121,15 @@ class CreateShuffleReaderOpMaker : public DecoratedReaderMakerBase {
  protected:
   void Apply() override {
     AddAttr<int>("buffer_size", "The shuffle buffer size.").GreaterThan(0);
+    AddAttr<int>("seed", "The random seed. 0 means a random one.")
+        .SetDefault(0);
     AddComment(R"DOC(
       CreateShuffleReader Operator
 
       A shuffle reader takes another reader as its 'underlying reader'
       and yields the underlying reader's outputs in a shuffled order.
+      Each output is drawn at random from a buffer of buffer_size instances,
+      and replaced by the next instance of the underlying reader.
     )DOC");
   }
 };
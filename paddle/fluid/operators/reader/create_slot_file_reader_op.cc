@@ -0,0 +1,176 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstring>
+#include "paddle/fluid/operators/reader/reader_op_registry.h"
+#include "paddle/fluid/operators/reader/slot_file.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+// SlotFileReader reads the slot files in order and yields the batches of
+// batch_size instances. Each output is the ids of a slot of the batch as an
+// int64 LoDTensor of [num_ids, 1] with the LoD of the instances, which is
+// assembled by copying the contiguous ids of the chunks.
+class SlotFileReader : public framework::FileReader {
+ public:
+  SlotFileReader(const std::vector<std::string>& file_names, size_t batch_size)
+      : file_names_(file_names), batch_size_(batch_size) {
+    PADDLE_ENFORCE(!file_names_.empty(), "No slot file to be read.");
+    PADDLE_ENFORCE_GT(batch_size_, 0UL);
+    StartImpl();
+  }
+
+ protected:
+  void ReadNextImpl(std::vector<framework::LoDTensor>* out) override;
+
+  void StartImpl() override {
+    file_id_ = 0;
+    scanner_.reset(new SlotFileScanner(file_names_[0]));
+    num_slots_ = scanner_->NumSlots();
+    chunk_.reset();
+    pos_ = 0;
+  }
+
+ private:
+  // A range of the instances of a chunk in the batch.
+  struct Segment {
+    std::shared_ptr<const SlotChunk> chunk;
+    size_t begin;
+    size_t end;
+  };
+
+  // Make chunk_ have the instances left. Return false at the end of the
+  // last file.
+  bool LoadChunk();
+
+  std::vector<std::string> file_names_;
+  size_t batch_size_;
+  size_t file_id_{0};
+  uint32_t num_slots_{0};
+  std::unique_ptr<SlotFileScanner> scanner_;
+  std::shared_ptr<const SlotChunk> chunk_;
+  size_t pos_{0};
+};
+
+bool SlotFileReader::LoadChunk() {
+  while (chunk_ == nullptr || pos_ >= chunk_->num_instances) {
+    std::shared_ptr<SlotChunk> chunk(new SlotChunk());
+    if (scanner_->NextChunk(chunk.get())) {
+      chunk_ = chunk;
+      pos_ = 0;
+      continue;
+    }
+    if (++file_id_ >= file_names_.size()) {
+      chunk_.reset();
+      return false;
+    }
+    scanner_.reset(new SlotFileScanner(file_names_[file_id_]));
+    PADDLE_ENFORCE_EQ(scanner_->NumSlots(), num_slots_,
+                      "The slot files should have the same number of slots.");
+  }
+  return true;
+}
+
+void SlotFileReader::ReadNextImpl(std::vector<framework::LoDTensor>* out) {
+  out->clear();
+  std::vector<Segment> segments;
+  size_t num_instances = 0;
+  while (num_instances < batch_size_ && LoadChunk()) {
+    size_t need = batch_size_ - num_instances;
+    size_t end = std::min<size_t>(chunk_->num_instances, pos_ + need);
+    segments.push_back(Segment{chunk_, pos_, end});
+    num_instances += end - pos_;
+    pos_ = end;
+  }
+  if (num_instances == 0) {
+    return;
+  }
+
+  out->resize(num_slots_);
+  for (uint32_t slot = 0; slot < num_slots_; ++slot) {
+    size_t num_ids = 0;
+    for (auto& seg : segments) {
+      auto& offsets = seg.chunk->offsets[slot];
+      num_ids += offsets[seg.end] - offsets[seg.begin];
+    }
+    auto& tensor = (*out)[slot];
+    tensor.Resize({static_cast<int64_t>(num_ids), 1});
+    int64_t* dst = tensor.mutable_data<int64_t>(platform::CPUPlace());
+    framework::LoD lod(1);
+    auto& lod_level = lod[0];
+    lod_level.reserve(num_instances + 1);
+    lod_level.push_back(0);
+    for (auto& seg : segments) {
+      auto& offsets = seg.chunk->offsets[slot];
+      size_t begin = offsets[seg.begin];
+      size_t size = offsets[seg.end] - begin;
+      std::memcpy(dst, seg.chunk->ids[slot].data() + begin,
+                  size * sizeof(int64_t));
+      dst += size;
+      size_t base = lod_level.back();
+      for (size_t i = seg.begin + 1; i <= seg.end; ++i) {
+        lod_level.push_back(base + offsets[i] - begin);
+      }
+    }
+    tensor.set_lod(lod);
+  }
+}
+
+class CreateSlotFileReaderOp : public framework::OperatorBase {
+ public:
+  using framework::OperatorBase::OperatorBase;
+
+ private:
+  void RunImpl(const framework::Scope& scope,
+               const platform::Place& dev_place) const override {
+    auto* out = scope.FindVar(Output("Out"))
+                    ->template GetMutable<framework::ReaderHolder>();
+    if (out->Get() != nullptr) {
+      return;
+    }
+    out->Reset(std::make_shared<SlotFileReader>(
+        Attr<std::vector<std::string>>("file_names"),
+        static_cast<size_t>(Attr<int>("batch_size"))));
+  }
+};
+
+class CreateSlotFileReaderOpMaker : public FileReaderMakerBase {
+ protected:
+  void Apply() override {
+    AddAttr<std::vector<std::string>>("file_names",
+                                      "The slot files read in order.");
+    AddAttr<int>("batch_size", "The number of the instances of a batch.")
+        .GreaterThan(0);
+    AddComment(R"DOC(
+Open the slot files and return the reader of their batches.
+
+A slot file keeps the sparse slots of the instances by columns in chunks. The
+reader yields an int64 LoDTensor of [num_ids, 1] for each slot, of which the
+LoD gives the ids of each instance of the batch, to be fed to lookup_table.
+    )DOC");
+  }
+};
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
+
+namespace reader = paddle::operators::reader;
+
+REGISTER_FILE_READER_OPERATOR(create_slot_file_reader,
+                              reader::CreateSlotFileReaderOp,
+                              reader::CreateSlotFileReaderOpMaker);
@@ -0,0 +1,316 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <condition_variable>  // NOLINT
+#include <exception>
+#include <map>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include "paddle/fluid/operators/detail/safe_ref.h"
+#include "paddle/fluid/operators/reader/reader_op_registry.h"
+#include "paddle/fluid/operators/reader/reader_transform.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+// TransformReader reads the underlying reader and runs the transforms on the
+// worker threads, so that the decoding and the augmentation of the instances
+// run in parallel out of Python.
+class TransformReader : public framework::DecoratedReader {
+ public:
+  TransformReader(const std::shared_ptr<ReaderBase>& reader,
+                  std::vector<std::unique_ptr<ReaderTransform>>&& transforms,
+                  size_t thread_num, bool keep_order, size_t buffer_size,
+                  size_t seed)
+      : DecoratedReader(reader),
+        transforms_(std::move(transforms)),
+        thread_num_(thread_num),
+        keep_order_(keep_order),
+        buffer_size_(buffer_size),
+        seed_(seed) {
+    PADDLE_ENFORCE_GT(thread_num_, 0UL);
+    PADDLE_ENFORCE_GT(buffer_size_, 0UL);
+    if (seed_ == 0) {
+      std::random_device device;
+      seed_ = device();
+    }
+    StartWorkers();
+  }
+
+  ~TransformReader() { StopWorkers(); }
+
+  void ReadNextImpl(std::vector<framework::LoDTensor>* out) override;
+
+ private:
+  void ShutdownImpl() override {
+    StopWorkers();
+    reader_->Shutdown();
+  }
+
+  void StartImpl() override {
+    reader_->Start();
+    StartWorkers();
+  }
+
+  void StartWorkers();
+  void StopWorkers();
+  void Work(size_t thread_id);
+
+  // Whether the output could take the instance of the sequence id.
+  bool HasRoom(size_t seq) const {
+    return keep_order_ ? seq < next_out_ + buffer_size_
+                       : ready_.size() < buffer_size_;
+  }
+
+  std::vector<std::unique_ptr<ReaderTransform>> transforms_;
+  size_t thread_num_;
+  bool keep_order_;
+  size_t buffer_size_;
+  size_t seed_;
+  size_t pass_{0};
+
+  std::vector<std::thread> workers_;
+  // Serialize the reading of the underlying reader.
+  std::mutex read_mutex_;
+  size_t next_read_{0};
+  bool read_end_{false};
+
+  // The transformed instances by their sequence ids.
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::map<size_t, std::vector<framework::LoDTensor>> ready_;
+  size_t next_out_{0};
+  size_t num_running_{0};
+  bool closed_{false};
+  std::exception_ptr error_;
+};
+
+void TransformReader::StartWorkers() {
+  next_read_ = 0;
+  read_end_ = false;
+  ready_.clear();
+  next_out_ = 0;
+  closed_ = false;
+  error_ = nullptr;
+  num_running_ = thread_num_;
+  ++pass_;
+  for (size_t i = 0; i < thread_num_; ++i) {
+    workers_.emplace_back([this, i] { Work(i); });
+  }
+}
+
+void TransformReader::StopWorkers() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+  ready_.clear();
+}
+
+void TransformReader::Work(size_t thread_id) {
+  std::minstd_rand engine(
+      static_cast<std::minstd_rand::result_type>(seed_ + pass_ * thread_num_ +
+                                                 thread_id));
+  try {
+    while (true) {
+      std::vector<framework::LoDTensor> instance;
+      size_t seq;
+      {
+        std::lock_guard<std::mutex> lock(read_mutex_);
+        if (read_end_) {
+          break;
+        }
+        reader_->ReadNext(&instance);
+        if (instance.empty()) {
+          read_end_ = true;
+          break;
+        }
+        seq = next_read_++;
+      }
+      for (auto& transform : transforms_) {
+        transform->Apply(&instance, &engine);
+      }
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&] { return closed_ || HasRoom(seq); });
+      if (closed_) {
+        break;
+      }
+      ready_.emplace(seq, std::move(instance));
+      cv_.notify_all();
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    error_ = std::current_exception();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    --num_running_;
+  }
+  cv_.notify_all();
+}
+
+void TransformReader::ReadNextImpl(std::vector<framework::LoDTensor>* out) {
+  out->clear();
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto has_next = [&] {
+    return keep_order_ ? ready_.count(next_out_) > 0 : !ready_.empty();
+  };
+  cv_.wait(lock, [&] {
+    return has_next() || error_ != nullptr || num_running_ == 0;
+  });
+  if (error_ != nullptr) {
+    std::rethrow_exception(error_);
+  }
+  if (!has_next()) {
+    return;
+  }
+  // The first one is the next in order, or any of them if the order is not
+  // kept.
+  auto it = ready_.begin();
+  *out = std::move(it->second);
+  ready_.erase(it);
+  ++next_out_;
+  cv_.notify_all();
+}
+
+class CreateTransformReaderOp : public framework::OperatorBase {
+ public:
+  using framework::OperatorBase::OperatorBase;
+
+ private:
+  void RunImpl(const framework::Scope& scope,
+               const platform::Place& dev_place) const override {
+    auto* out = detail::Ref(scope.FindVar(Output("Out")))
+                    .GetMutable<framework::ReaderHolder>();
+    if (out->Get() != nullptr) {
+      return;
+    }
+    const auto& underlying_reader = scope.FindVar(Input("UnderlyingReader"))
+                                        ->Get<framework::ReaderHolder>();
+    std::vector<std::unique_ptr<ReaderTransform>> transforms;
+    for (auto& name : Attr<std::vector<std::string>>("transforms")) {
+      transforms.emplace_back(CreateReaderTransform(name, Attrs()));
+    }
+    out->Reset(framework::MakeDecoratedReader<TransformReader>(
+        underlying_reader, std::move(transforms),
+        static_cast<size_t>(Attr<int>("thread_num")),
+        Attr<bool>("keep_order"),
+        static_cast<size_t>(Attr<int>("buffer_size")),
+        static_cast<size_t>(Attr<int>("seed"))));
+  }
+};
+
+class CreateTransformReaderOpMaker : public DecoratedReaderMakerBase {
+ protected:
+  void Apply() override {
+    AddAttr<std::vector<std::string>>(
+        "transforms",
+        "The names of the registered reader transforms, which are applied "
+        "in order, e.g. random_crop and normalize.");
+    AddAttr<int>("thread_num", "The number of the worker threads.")
+        .SetDefault(1)
+        .GreaterThan(0);
+    AddAttr<bool>("keep_order",
+                  "Whether to yield the instances in the order of the "
+                  "underlying reader.")
+        .SetDefault(false);
+    AddAttr<int>("buffer_size",
+                 "The number of the transformed instances buffered.")
+        .SetDefault(16)
+        .GreaterThan(0);
+    AddAttr<int>("seed",
+                 "The random seed of the transforms, 0 for a random one.")
+        .SetDefault(0);
+    AddAttr<std::vector<int>>("shape_concat",
+                              "The concat of the shapes of the outputs.");
+    AddAttr<std::vector<int>>("ranks", "The ranks of each output.");
+    AddAttr<std::vector<int>>("lod_levels", "The LoD levels of each output.");
+    AddAttr<std::vector<int>>("dtypes", "The data types of each output.");
+    AddAttr<std::vector<int>>("crop_shape",
+                              "The trailing dims of the random_crop.")
+        .SetDefault({});
+    AddAttr<std::vector<float>>("mean", "The mean of the normalize.")
+        .SetDefault({});
+    AddAttr<std::vector<float>>("std", "The std of the normalize.")
+        .SetDefault({});
+    AddComment(R"DOC(
+      CreateTransformReader Operator
+
+      A transform reader takes another reader as its 'underlying reader', and
+      runs the registered reader transforms (see REGISTER_READER_TRANSFORM) on
+      each of its outputs on several worker threads. The attributes of this
+      op are given to the transforms, and the shapes, the LoD levels and the
+      data types of the outputs are declared by the attributes.
+    )DOC");
+  }
+};
+
+class TransformReaderInferShape : public framework::InferShapeBase {
+ public:
+  void operator()(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(!ctx->IsRuntime(),
+                   "'TransformReaderInferShape' should only be invoked during "
+                   "compile time.");
+    PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                   "The output decorated reader should not be null.");
+    const auto shape_concat =
+        ctx->Attrs().Get<std::vector<int>>("shape_concat");
+    const auto ranks = ctx->Attrs().Get<std::vector<int>>("ranks");
+    std::vector<framework::DDim> shapes = RestoreShapes(shape_concat, ranks);
+    ctx->SetReaderDims("Out", shapes);
+
+    const auto lod_levels = ctx->Attrs().Get<std::vector<int>>("lod_levels");
+    PADDLE_ENFORCE_EQ(lod_levels.size(), shapes.size(),
+                      "The number of 'lod_levels'(%d) doesn't match the "
+                      "number of 'shapes'(%d).",
+                      lod_levels.size(), shapes.size());
+    auto* out_reader =
+        boost::get<framework::VarDesc*>(ctx->GetOutputVarPtrs("Out")[0]);
+    out_reader->SetLoDLevels(lod_levels);
+  }
+};
+
+class TransformReaderInferVarType : public framework::VarTypeInference {
+ public:
+  void operator()(const framework::OpDesc& op_desc,
+                  framework::BlockDesc* block) const override {
+    framework::VarDesc* out_reader = block->FindVar(op_desc.Output("Out")[0]);
+    PADDLE_ENFORCE_NOT_NULL(out_reader);
+    out_reader->SetType(framework::proto::VarType::READER);
+    auto dtypes = boost::get<std::vector<int>>(op_desc.GetAttr("dtypes"));
+    std::vector<framework::proto::VarType::Type> res_data_types;
+    for (int dtype : dtypes) {
+      res_data_types.push_back(
+          static_cast<framework::proto::VarType::Type>(dtype));
+    }
+    out_reader->SetDataTypes(res_data_types);
+  }
+};
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators::reader;
+REGISTER_OPERATOR(create_transform_reader, ops::CreateTransformReaderOp,
+                  ops::CreateTransformReaderOpMaker,
+                  ops::TransformReaderInferShape,
+                  ops::TransformReaderInferVarType,
+                  paddle::framework::EmptyGradOpMaker)
@@ -12,14 +12,18 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cmath>
+#include <numeric>
+#include <random>
 #include <stdexcept>
 #include <thread>  // NOLINT
+#include <unordered_map>
 #include "ThreadPool.h"
-#include "paddle/fluid/framework/blocking_queue.h"
 #include "paddle/fluid/operators/reader/blocking_queue.h"
 #include "paddle/fluid/operators/reader/buffered_reader.h"
 #include "paddle/fluid/operators/reader/reader_op_registry.h"
+#include "paddle/fluid/recordio/scanner.h"
 
 namespace paddle {
 namespace operators {
@@ -85,7 +89,10 @@ class PreemptiveReaderContainer : public IReaderContainer {
   using FutureList = std::list<std::future<FutureItem>>;
 
  public:
-  explicit PreemptiveReaderContainer(size_t thread_num) : pool_(thread_num) {}
+  // Each reader has at most one element in the complete_queue_, so the queue
+  // never blocks with the capacity of num_readers.
+  PreemptiveReaderContainer(size_t thread_num, size_t num_readers)
+      : pool_(thread_num), complete_queue_(std::max<size_t>(num_readers, 1)) {}
 
   void Stop() override {
     if (!pending_.empty()) {
@@ -101,9 +108,7 @@ class PreemptiveReaderContainer : public IReaderContainer {
         done_.emplace_back(std::move(reader));
       }
       pending_.clear();
-      bool timeout;
-      complete_queue_.PopAll(1000, &timeout);
-      PADDLE_ENFORCE(!timeout);
+      complete_queue_.ReOpen();
     }
   }
 
@@ -116,7 +121,8 @@ class PreemptiveReaderContainer : public IReaderContainer {
 
   void ReadNext(std::vector<framework::LoDTensor>* out) override {
     if (!pending_.empty()) {
-      auto future_it = complete_queue_.Pop();
+      FutureList::iterator future_it;
+      PADDLE_ENFORCE(complete_queue_.Receive(&future_it));
       FutureItem item = future_it->get();
       if (item.exception_) {
         for (auto it = futures_.begin(); it != futures_.end(); ++it) {
@@ -166,12 +172,12 @@ class PreemptiveReaderContainer : public IReaderContainer {
           (*reader_it)->Shutdown();
           (*reader_it)->Start();
         }
-        complete_queue_.Push(future_it);
+        complete_queue_.Send(future_it);
         return item;
       } catch (...) {
         FutureItem item;
         item.exception_ = std::current_exception();
-        complete_queue_.Push(future_it);
+        complete_queue_.Send(future_it);
         return item;
       }
     });
@@ -179,11 +185,124 @@ class PreemptiveReaderContainer : public IReaderContainer {
 
   FutureList futures_;
   ThreadPool pool_;
-  framework::BlockingQueue<FutureList::iterator> complete_queue_;
+  BlockingQueue<FutureList::iterator> complete_queue_;
   std::list<std::unique_ptr<framework::ReaderBase>> pending_;
   std::list<std::unique_ptr<framework::ReaderBase>> done_;
 };
 
+// The chunks of the recordio files shared by the trainers.
+struct RecordIOChunks {
+  struct Chunk {
+    size_t file_id;
+    size_t chunk_id;
+  };
+
+  RecordIOChunks(const std::vector<std::string>& file_names, int num_trainers,
+                 int trainer_id, int num_readers, bool shuffle, int seed)
+      : file_names(file_names),
+        num_trainers(num_trainers),
+        trainer_id(trainer_id),
+        num_readers(num_readers),
+        shuffle(shuffle),
+        seed(seed) {
+    for (size_t i = 0; i < file_names.size(); ++i) {
+      recordio::Scanner scanner(file_names[i]);
+      PADDLE_ENFORCE(scanner.HasIndex(),
+                     "The file %s has no chunk index, which is written when "
+                     "the recordio writer is closed.",
+                     file_names[i]);
+      for (size_t c = 0; c < scanner.NumChunks(); ++c) {
+        chunks.push_back({i, c});
+      }
+    }
+  }
+
+  // The chunks of all the files are shuffled in the same order on all the
+  // trainers at every pass, then the trainer takes every num_trainers-th of
+  // them from trainer_id, so the trainers read disjoint chunks, and they are
+  // dealt to the readers of the trainer in turn.
+  std::vector<Chunk> ChunksOfReader(int reader_id, size_t pass) const {
+    std::vector<size_t> order(chunks.size());
+    std::iota(order.begin(), order.end(), 0);
+    if (shuffle) {
+      std::mt19937 engine(static_cast<std::mt19937::result_type>(seed + pass));
+      std::shuffle(order.begin(), order.end(), engine);
+    }
+    std::vector<Chunk> result;
+    size_t stride = static_cast<size_t>(num_trainers) * num_readers;
+    size_t first = static_cast<size_t>(reader_id) * num_trainers + trainer_id;
+    for (size_t i = first; i < order.size(); i += stride) {
+      result.push_back(chunks[order[i]]);
+    }
+    return result;
+  }
+
+  std::vector<std::string> file_names;
+  std::vector<Chunk> chunks;
+  int num_trainers;
+  int trainer_id;
+  int num_readers;
+  bool shuffle;
+  int seed;
+};
+
+class RecordIOChunkReader : public framework::FileReader {
+ public:
+  RecordIOChunkReader(const std::shared_ptr<const RecordIOChunks>& chunks,
+                      int reader_id)
+      : all_chunks_(chunks),
+        reader_id_(reader_id),
+        dev_ctx_(*platform::DeviceContextPool::Instance().Get(
+            platform::CPUPlace())) {
+    Reset();
+  }
+
+ protected:
+  void ReadNextImpl(std::vector<framework::LoDTensor>* out) override {
+    while (num_left_records_ == 0) {
+      if (next_chunk_ == chunks_.size()) {
+        out->clear();
+        return;
+      }
+      auto& chunk = chunks_[next_chunk_++];
+      auto& scanner = scanners_[chunk.file_id];
+      if (!scanner) {
+        scanner.reset(new recordio::Scanner(
+            all_chunks_->file_names[chunk.file_id], RecordIOScannerOptions()));
+      }
+      scanner->Seek(chunk.chunk_id);
+      scanner_ = scanner.get();
+      num_left_records_ = scanner->NumRecords(chunk.chunk_id);
+    }
+    --num_left_records_;
+    if (!framework::ReadFromRecordIO(scanner_, dev_ctx_, out)) {
+      out->clear();
+    }
+  }
+
+  void StartImpl() override {
+    ++pass_;
+    Reset();
+  }
+
+ private:
+  void Reset() {
+    chunks_ = all_chunks_->ChunksOfReader(reader_id_, pass_);
+    next_chunk_ = 0;
+    num_left_records_ = 0;
+  }
+
+  std::shared_ptr<const RecordIOChunks> all_chunks_;
+  int reader_id_;
+  const platform::DeviceContext& dev_ctx_;
+  size_t pass_{0};
+  std::vector<RecordIOChunks::Chunk> chunks_;
+  size_t next_chunk_{0};
+  uint32_t num_left_records_{0};
+  std::unordered_map<size_t, std::unique_ptr<recordio::Scanner>> scanners_;
+  recordio::Scanner* scanner_{nullptr};
+};
+
 class MultiFileReader : public framework::ReaderBase {
  public:
   MultiFileReader(const std::vector<std::string>& file_names,
@@ -194,6 +313,14 @@ class MultiFileReader : public framework::ReaderBase {
     }
   }
 
+  MultiFileReader(std::vector<std::unique_ptr<framework::ReaderBase>>&& readers,
+                  std::unique_ptr<IReaderContainer>&& container)
+      : container_(std::move(container)) {
+    for (auto& reader : readers) {
+      container_->AppendReader(std::move(reader));
+    }
+  }
+
   ~MultiFileReader() { container_->Stop(); }
 
  protected:
@@ -227,17 +354,40 @@ class OpenFilesOp : public framework::OperatorBase {
 
     auto* out = scope.FindVar(Output("Out"))
                     ->template GetMutable<framework::ReaderHolder>();
-    std::unique_ptr<IReaderContainer> container;
+    int num_trainers = Attr<int>("num_trainers");
+    int trainer_id = Attr<int>("trainer_id");
+    bool shuffle_chunks = Attr<bool>("shuffle_chunks");
+    bool read_chunks = num_trainers > 1 || shuffle_chunks;
+    int num_readers = static_cast<int>(file_names.size());
+    if (read_chunks) {
+      num_readers = is_test ? 1 : std::max(Attr<int>("thread_num"), 1);
+    }
 
+    std::unique_ptr<IReaderContainer> container;
     if (is_test) {
       container.reset(new OrderedReaderContainer());
     } else {
       container.reset(new PreemptiveReaderContainer(
-          static_cast<size_t>(Attr<int>("thread_num"))));
+          static_cast<size_t>(Attr<int>("thread_num")),
+          static_cast<size_t>(num_readers)));
     }
 
-    std::shared_ptr<framework::ReaderBase> reader(
-        new MultiFileReader(file_names, std::move(container)));
+    std::shared_ptr<framework::ReaderBase> reader;
+    if (read_chunks) {
+      PADDLE_ENFORCE(trainer_id >= 0 && trainer_id < num_trainers,
+                     "The trainer_id should be in [0, num_trainers).");
+      auto chunks = std::make_shared<const RecordIOChunks>(
+          file_names, num_trainers, trainer_id, num_readers, shuffle_chunks,
+          Attr<int>("seed"));
+      std::vector<std::unique_ptr<framework::ReaderBase>> readers;
+      for (int i = 0; i < num_readers; ++i) {
+        readers.emplace_back(new RecordIOChunkReader(chunks, i));
+      }
+      reader.reset(
+          new MultiFileReader(std::move(readers), std::move(container)));
+    } else {
+      reader.reset(new MultiFileReader(file_names, std::move(container)));
+    }
     auto buffer_size = Attr<int>("buffer_size");
     if (buffer_size > 1) {
       reader = framework::MakeDecoratedReader<BufferedReader>(
@@ -264,6 +414,21 @@ class OpenFilesOpMaker : public FileReaderMakerBase {
                  "when is_test = False");
     AddAttr<int>("buffer_size", "The reading buffer of these files.")
         .GreaterThan(0);
+    AddAttr<int>("num_trainers",
+                 "The recordio chunks of the files are split among the "
+                 "trainers if it is greater than 1.")
+        .SetDefault(1)
+        .GreaterThan(0);
+    AddAttr<int>("trainer_id", "The id of this trainer in [0, num_trainers).")
+        .SetDefault(0);
+    AddAttr<bool>("shuffle_chunks",
+                  "Shuffle the recordio chunks of all the files at every "
+                  "pass. The files should be closed with the chunk index.")
+        .SetDefault(false);
+    AddAttr<int>("seed",
+                 "The random seed of shuffle_chunks, which should be the same "
+                 "on all the trainers.")
+        .SetDefault(0);
   }
 };
 
@@ -199,6 +199,44 @@ TEST(BlockingQueue, MultiSenderMultiReaderTest) {
   MultiSenderMultiReceiver(2, to_send_2, 3, 0, 50);
 }
 
+TEST(BlockingQueue, ManySmallElementsTest) {
+  // Many small elements through a small queue, so the senders and the
+  // receivers keep parking and waking each other.
+  const size_t sender_num = 4;
+  const size_t receiver_num = 4;
+  const size_t elem_num = 20000;
+  BlockingQueue<size_t> q(8);
+  std::vector<std::thread> senders;
+  for (size_t s_idx = 0; s_idx < sender_num; ++s_idx) {
+    senders.emplace_back([&, s_idx] {
+      for (size_t i = 0; i < elem_num; ++i) {
+        EXPECT_TRUE(q.Send(s_idx * elem_num + i));
+      }
+    });
+  }
+  std::vector<size_t> counts(sender_num * elem_num, 0);
+  std::vector<std::thread> receivers;
+  for (size_t r_idx = 0; r_idx < receiver_num; ++r_idx) {
+    receivers.emplace_back([&] {
+      size_t elem;
+      while (q.Receive(&elem)) {
+        ++counts[elem];
+      }
+    });
+  }
+  for (auto& t : senders) {
+    t.join();
+  }
+  q.Close();
+  for (auto& t : receivers) {
+    t.join();
+  }
+  for (size_t count : counts) {
+    EXPECT_EQ(count, 1UL);
+  }
+  EXPECT_EQ(q.Size(), 0UL);
+}
+
 struct MyClass {
   MyClass() : val_(0) {}
   explicit MyClass(int val) : val_(val) {}
@@ -13,13 +13,41 @@
 // limitations under the License.
 
 #include "paddle/fluid/operators/reader/reader_op_registry.h"
+#include <fstream>
+#include <sstream>
 #include <string>
 #include <vector>
 
+DEFINE_int32(recordio_decode_threads, 0,
+             "The number of the threads each recordio file reader "
+             "decompresses the upcoming chunks on. They are decompressed on "
+             "the reading thread if it is 0.");
+DEFINE_bool(recordio_verify_checksum, true,
+            "Check the CRC32 of the recordio chunks. It could be turned off "
+            "for the files on the trusted local disks.");
+DEFINE_string(recordio_zstd_dict, "",
+              "The path of the dictionary the Zstd compressed recordio files "
+              "were written with.");
+
 namespace paddle {
 namespace operators {
 namespace reader {
 
+recordio::ScannerOptions RecordIOScannerOptions() {
+  recordio::ScannerOptions options;
+  options.verify_checksum = FLAGS_recordio_verify_checksum;
+  options.num_decode_threads = FLAGS_recordio_decode_threads;
+  if (!FLAGS_recordio_zstd_dict.empty()) {
+    std::ifstream fin(FLAGS_recordio_zstd_dict, std::ios::binary);
+    PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open file %s",
+                   FLAGS_recordio_zstd_dict);
+    std::stringstream buffer;
+    buffer << fin.rdbuf();
+    options.zstd_dict = buffer.str();
+  }
+  return options;
+}
+
 std::vector<framework::DDim> RestoreShapes(const std::vector<int>& shape_concat,
                                            const std::vector<int>& ranks) {
   std::vector<framework::DDim> res;
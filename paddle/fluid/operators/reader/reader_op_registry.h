@@ -18,6 +18,7 @@
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/reader.h"
+#include "paddle/fluid/recordio/scanner.h"
 
 namespace paddle {
 namespace operators {
@@ -41,6 +42,10 @@ int RegisterFileReader(const std::string& filetype) {
 std::unique_ptr<framework::ReaderBase> CreateReaderByFileName(
     const std::string& file_name);
 
+// The options of the recordio scanners of the readers, set by the flags
+// recordio_decode_threads, recordio_verify_checksum and recordio_zstd_dict.
+recordio::ScannerOptions RecordIOScannerOptions();
+
 extern std::vector<framework::DDim> RestoreShapes(
     const std::vector<int>& shape_concat, const std::vector<int>& ranks);
 
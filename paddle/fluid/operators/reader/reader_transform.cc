@@ -0,0 +1,174 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/reader/reader_transform.h"
+#include <cstring>
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+std::unordered_map<std::string, ReaderTransformCreator>&
+ReaderTransformRegistry() {
+  static std::unordered_map<std::string, ReaderTransformCreator> regs;
+  return regs;
+}
+
+std::unique_ptr<ReaderTransform> CreateReaderTransform(
+    const std::string& name, const framework::AttributeMap& attrs) {
+  auto it = ReaderTransformRegistry().find(name);
+  PADDLE_ENFORCE(it != ReaderTransformRegistry().end(),
+                 "No reader transform registered for '%s'.", name);
+  return std::unique_ptr<ReaderTransform>(it->second(attrs));
+}
+
+template <typename T>
+static T GetTransformAttr(const framework::AttributeMap& attrs,
+                          const std::string& name) {
+  auto it = attrs.find(name);
+  PADDLE_ENFORCE(it != attrs.end(), "The reader transform needs Attr(%s).",
+                 name);
+  return boost::get<T>(it->second);
+}
+
+static void CopyCrop(const char* src, char* dst, const framework::DDim& dims,
+                     const framework::DDim& crop_dims,
+                     const std::vector<int64_t>& offsets, size_t elem_size,
+                     int dim) {
+  int64_t src_stride = elem_size;
+  int64_t dst_stride = elem_size;
+  for (int i = dim + 1; i < dims.size(); ++i) {
+    src_stride *= dims[i];
+    dst_stride *= crop_dims[i];
+  }
+  src += offsets[dim] * src_stride;
+  if (dim + 1 == dims.size()) {
+    std::memcpy(dst, src, crop_dims[dim] * elem_size);
+    return;
+  }
+  for (int64_t i = 0; i < crop_dims[dim]; ++i) {
+    CopyCrop(src + i * src_stride, dst + i * dst_stride, dims, crop_dims,
+             offsets, elem_size, dim + 1);
+  }
+}
+
+// Crop the trailing dims of the first slot to Attr(crop_shape) at a random
+// offset, e.g. [C, H, W] to [C, h, w] by crop_shape = [h, w].
+class RandomCropTransform : public ReaderTransform {
+ public:
+  explicit RandomCropTransform(const framework::AttributeMap& attrs)
+      : crop_shape_(GetTransformAttr<std::vector<int>>(attrs, "crop_shape")) {
+    PADDLE_ENFORCE(!crop_shape_.empty(),
+                   "Attr(crop_shape) of random_crop should not be empty.");
+  }
+
+  void Apply(std::vector<framework::LoDTensor>* instance,
+             std::minstd_rand* engine) const override {
+    PADDLE_ENFORCE(!instance->empty());
+    auto& in = instance->front();
+    auto dims = in.dims();
+    int rank = dims.size();
+    int num_crop_dims = static_cast<int>(crop_shape_.size());
+    PADDLE_ENFORCE_LE(num_crop_dims, rank,
+                      "Attr(crop_shape) has more dims than the data.");
+    auto crop_dims = dims;
+    std::vector<int64_t> offsets(rank, 0);
+    for (int i = 0; i < num_crop_dims; ++i) {
+      int d = rank - num_crop_dims + i;
+      PADDLE_ENFORCE_LE(crop_shape_[i], dims[d],
+                        "The crop is larger than the data.");
+      crop_dims[d] = crop_shape_[i];
+      std::uniform_int_distribution<int64_t> dist(0, dims[d] - crop_shape_[i]);
+      offsets[d] = dist(*engine);
+    }
+
+    framework::LoDTensor out;
+    out.Resize(crop_dims);
+    size_t elem_size = framework::SizeOfType(in.type());
+    auto* dst = static_cast<char*>(
+        out.mutable_data(platform::CPUPlace(), in.type()));
+    CopyCrop(static_cast<const char*>(in.data<void>()), dst, dims, crop_dims,
+             offsets, elem_size, 0);
+    if (num_crop_dims < rank) {
+      out.set_lod(in.lod());
+    }
+    in = out;
+  }
+
+ private:
+  std::vector<int> crop_shape_;
+};
+
+// (x - mean) / std of the first slot as float, where Attr(mean) and Attr(std)
+// have the size of either 1 or the first dim of the data, e.g. the channels
+// of [C, H, W].
+class NormalizeTransform : public ReaderTransform {
+ public:
+  explicit NormalizeTransform(const framework::AttributeMap& attrs)
+      : mean_(GetTransformAttr<std::vector<float>>(attrs, "mean")),
+        std_(GetTransformAttr<std::vector<float>>(attrs, "std")) {
+    PADDLE_ENFORCE(!mean_.empty() && mean_.size() == std_.size(),
+                   "Attr(mean) and Attr(std) of normalize should have the "
+                   "same size.");
+    for (auto& s : std_) {
+      PADDLE_ENFORCE_NE(s, 0.f, "Attr(std) should not be 0.");
+    }
+  }
+
+  void Apply(std::vector<framework::LoDTensor>* instance,
+             std::minstd_rand* engine) const override {
+    PADDLE_ENFORCE(!instance->empty());
+    auto& in = instance->front();
+    int64_t numel = in.numel();
+    int64_t num_channels = mean_.size();
+    PADDLE_ENFORCE(num_channels == 1 || num_channels == in.dims()[0],
+                   "The size of Attr(mean) should be 1 or the first dim.");
+    int64_t channel_size = numel / (num_channels == 1 ? 1 : num_channels);
+
+    framework::LoDTensor out;
+    out.Resize(in.dims());
+    out.set_lod(in.lod());
+    float* dst = out.mutable_data<float>(platform::CPUPlace());
+    if (in.type() == typeid(uint8_t)) {
+      Normalize(in.data<uint8_t>(), numel, channel_size, dst);
+    } else if (in.type() == typeid(float)) {
+      Normalize(in.data<float>(), numel, channel_size, dst);
+    } else {
+      PADDLE_THROW("normalize only supports the data of uint8 and float.");
+    }
+    in = out;
+  }
+
+ private:
+  template <typename T>
+  void Normalize(const T* src, int64_t numel, int64_t channel_size,
+                 float* dst) const {
+    for (int64_t i = 0; i < numel; ++i) {
+      size_t c = mean_.size() == 1 ? 0 : i / channel_size;
+      dst[i] = (static_cast<float>(src[i]) - mean_[c]) / std_[c];
+    }
+  }
+
+  std::vector<float> mean_;
+  std::vector<float> std_;
+};
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
+
+namespace reader = paddle::operators::reader;
+
+REGISTER_READER_TRANSFORM(random_crop, reader::RandomCropTransform);
+REGISTER_READER_TRANSFORM(normalize, reader::NormalizeTransform);
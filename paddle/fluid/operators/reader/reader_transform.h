@@ -0,0 +1,73 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+// A ReaderTransform decodes or augments the instances read by the
+// create_transform_reader op. Apply is called on several worker threads at
+// the same time, each of which passes its own random engine.
+class ReaderTransform {
+ public:
+  virtual ~ReaderTransform() {}
+
+  virtual void Apply(std::vector<framework::LoDTensor>* instance,
+                     std::minstd_rand* engine) const = 0;
+};
+
+// The creator takes the attributes of the create_transform_reader op.
+using ReaderTransformCreator =
+    std::function<ReaderTransform*(const framework::AttributeMap&)>;
+
+std::unordered_map<std::string, ReaderTransformCreator>&
+ReaderTransformRegistry();
+
+template <typename Transform>
+int RegisterReaderTransform(const std::string& name) {
+  ReaderTransformRegistry()[name] = [](const framework::AttributeMap& attrs) {
+    return new Transform(attrs);
+  };
+  return 0;
+}
+
+std::unique_ptr<ReaderTransform> CreateReaderTransform(
+    const std::string& name, const framework::AttributeMap& attrs);
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
+
+#define REGISTER_READER_TRANSFORM(_name, _transform)            \
+  STATIC_ASSERT_GLOBAL_NAMESPACE(                               \
+      _reg_reader_transform_##_name,                            \
+      "Must use REGISTER_READER_TRANSFORM in global namespace"); \
+  int TouchReaderTransform##_name() { return 0; }               \
+  int _reg_reader_transform_entry_##_name =                     \
+      paddle::operators::reader::RegisterReaderTransform<_transform>(#_name)
+
+#define USE_READER_TRANSFORM(name)           \
+  extern int TouchReaderTransform##name();   \
+  static int _use_reader_transform_##name = TouchReaderTransform##name()
@@ -0,0 +1,351 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/reader/shared_memory_queue.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include "paddle/fluid/framework/data_type.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+struct SharedMemoryQueue::Header {
+  pthread_mutex_t mutex;
+  pthread_cond_t not_full;
+  pthread_cond_t not_empty;
+  size_t num_slots;
+  size_t slot_size;
+  // The ready slots are ready_[head], ..., ready_[(head + size - 1) % n].
+  size_t head;
+  size_t size;
+  // The free slots are free_[0], ..., free_[num_free - 1].
+  size_t num_free;
+  size_t num_writers;
+  bool closed;
+};
+
+// Returns the slot of a popped batch after its tensors are destroyed.
+struct SharedMemoryQueue::SlotHolder {
+  SlotHolder(std::shared_ptr<SharedMemoryQueue> queue, size_t slot)
+      : queue_(std::move(queue)), slot_(slot) {}
+
+  ~SlotHolder() { queue_->ReleaseSlot(slot_); }
+
+  std::shared_ptr<SharedMemoryQueue> queue_;
+  size_t slot_;
+};
+
+namespace {
+
+constexpr size_t kSlotAlignment = 64;
+
+size_t AlignUp(size_t size) {
+  return (size + kSlotAlignment - 1) / kSlotAlignment * kSlotAlignment;
+}
+
+class SharedMutexLock {
+ public:
+  explicit SharedMutexLock(pthread_mutex_t* mutex) : mutex_(mutex) {
+    int ret = pthread_mutex_lock(mutex_);
+    // A writer process died with the lock, the queue is still consistent,
+    // only the slot it was writing is lost.
+    if (ret == EOWNERDEAD) {
+      ret = pthread_mutex_consistent(mutex_);
+    }
+    PADDLE_ENFORCE_EQ(ret, 0, "Cannot lock the shared memory queue");
+  }
+
+  ~SharedMutexLock() { pthread_mutex_unlock(mutex_); }
+
+ private:
+  pthread_mutex_t* mutex_;
+};
+
+class SlotWriter {
+ public:
+  SlotWriter(uint8_t* slot, size_t slot_size)
+      : slot_(slot), slot_size_(slot_size), offset_(0) {}
+
+  template <typename T>
+  void Write(const T& value) {
+    WriteBytes(&value, sizeof(T));
+  }
+
+  void WriteBytes(const void* data, size_t size) {
+    PADDLE_ENFORCE_LE(offset_ + size, slot_size_,
+                      "The batch does not fit in a slot of %d bytes",
+                      slot_size_);
+    std::memcpy(slot_ + offset_, data, size);
+    offset_ += size;
+  }
+
+  void Align() { offset_ = AlignUp(offset_); }
+
+ private:
+  uint8_t* slot_;
+  size_t slot_size_;
+  size_t offset_;
+};
+
+class SlotReader {
+ public:
+  explicit SlotReader(uint8_t* slot) : slot_(slot), offset_(0) {}
+
+  template <typename T>
+  T Read() {
+    T value;
+    std::memcpy(&value, Data(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  uint8_t* Data(size_t size) {
+    uint8_t* data = slot_ + offset_;
+    offset_ += size;
+    return data;
+  }
+
+  void Align() { offset_ = AlignUp(offset_); }
+
+ private:
+  uint8_t* slot_;
+  size_t offset_;
+};
+
+}  // namespace
+
+SharedMemoryQueue::SharedMemoryQueue(const std::string& name,
+                                     size_t num_slots, size_t slot_size)
+    : name_(name) {
+  PADDLE_ENFORCE_GT(num_slots, 0UL);
+  PADDLE_ENFORCE_GT(slot_size, 0UL);
+  slot_size = AlignUp(slot_size);
+  size_t header_size = AlignUp(sizeof(Header)) +
+                       AlignUp(2 * num_slots * sizeof(size_t));
+  mapped_size_ = header_size + num_slots * slot_size;
+
+  int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  PADDLE_ENFORCE_GE(fd, 0, "Cannot create the shared memory %s", name_);
+  // The forked processes keep using the memory without the name.
+  shm_unlink(name_.c_str());
+  if (ftruncate(fd, mapped_size_) != 0) {
+    close(fd);
+    PADDLE_THROW("Cannot allocate %d bytes of shared memory", mapped_size_);
+  }
+  void* data = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    fd, 0);
+  close(fd);
+  PADDLE_ENFORCE(data != MAP_FAILED, "Cannot map the shared memory %s",
+                 name_);
+
+  auto* base = static_cast<uint8_t*>(data);
+  header_ = new (base) Header();
+  ready_ = reinterpret_cast<size_t*>(base + AlignUp(sizeof(Header)));
+  free_ = ready_ + num_slots;
+  slots_ = base + header_size;
+
+  pthread_mutexattr_t mutex_attr;
+  pthread_mutexattr_init(&mutex_attr);
+  pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+  pthread_mutexattr_setrobust(&mutex_attr, PTHREAD_MUTEX_ROBUST);
+  pthread_mutex_init(&header_->mutex, &mutex_attr);
+  pthread_mutexattr_destroy(&mutex_attr);
+  pthread_condattr_t cond_attr;
+  pthread_condattr_init(&cond_attr);
+  pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+  pthread_cond_init(&header_->not_full, &cond_attr);
+  pthread_cond_init(&header_->not_empty, &cond_attr);
+  pthread_condattr_destroy(&cond_attr);
+
+  header_->num_slots = num_slots;
+  header_->slot_size = slot_size;
+  header_->head = 0;
+  header_->size = 0;
+  header_->num_free = num_slots;
+  for (size_t i = 0; i < num_slots; ++i) {
+    free_[i] = i;
+  }
+  header_->num_writers = 0;
+  header_->closed = false;
+}
+
+SharedMemoryQueue::~SharedMemoryQueue() { munmap(header_, mapped_size_); }
+
+uint8_t* SharedMemoryQueue::Slot(size_t slot) const {
+  return slots_ + slot * header_->slot_size;
+}
+
+bool SharedMemoryQueue::Push(const std::vector<framework::LoDTensor>& tensors) {
+  size_t slot;
+  {
+    SharedMutexLock lock(&header_->mutex);
+    while (!header_->closed && header_->num_free == 0) {
+      pthread_cond_wait(&header_->not_full, &header_->mutex);
+    }
+    if (header_->closed) return false;
+    slot = free_[--header_->num_free];
+  }
+
+  try {
+    SlotWriter writer(Slot(slot), header_->slot_size);
+    writer.Write<uint64_t>(tensors.size());
+    for (auto& tensor : tensors) {
+      PADDLE_ENFORCE(platform::is_cpu_place(tensor.place()),
+                     "Only the CPU tensors can be pushed");
+      writer.Write<int32_t>(framework::ToDataType(tensor.type()));
+      auto& dims = tensor.dims();
+      writer.Write<int32_t>(dims.size());
+      for (int i = 0; i < dims.size(); ++i) {
+        writer.Write<int64_t>(dims[i]);
+      }
+      auto& lod = tensor.lod();
+      writer.Write<uint64_t>(lod.size());
+      for (auto& level : lod) {
+        writer.Write<uint64_t>(level.size());
+        for (size_t i = 0; i < level.size(); ++i) {
+          writer.Write<uint64_t>(level[i]);
+        }
+      }
+      size_t size = tensor.numel() * framework::SizeOfType(tensor.type());
+      writer.Write<uint64_t>(size);
+      writer.Align();
+      if (size > 0) {
+        writer.WriteBytes(tensor.data<void>(), size);
+      }
+      writer.Align();
+    }
+  } catch (...) {
+    ReleaseSlot(slot);
+    throw;
+  }
+
+  SharedMutexLock lock(&header_->mutex);
+  if (header_->closed) {
+    // The batch is dropped, like the batches in the queue by ReOpen.
+    free_[header_->num_free++] = slot;
+    pthread_cond_signal(&header_->not_full);
+    return false;
+  }
+  ready_[(header_->head + header_->size) % header_->num_slots] = slot;
+  ++header_->size;
+  pthread_cond_signal(&header_->not_empty);
+  return true;
+}
+
+bool SharedMemoryQueue::Pop(std::vector<framework::LoDTensor>* tensors) {
+  PADDLE_ENFORCE_NOT_NULL(tensors);
+  size_t slot;
+  {
+    SharedMutexLock lock(&header_->mutex);
+    while (!header_->closed && header_->size == 0) {
+      pthread_cond_wait(&header_->not_empty, &header_->mutex);
+    }
+    if (header_->size == 0) return false;
+    slot = ready_[header_->head];
+    header_->head = (header_->head + 1) % header_->num_slots;
+    --header_->size;
+  }
+
+  std::shared_ptr<SlotHolder> holder(
+      new SlotHolder(shared_from_this(), slot));
+  SlotReader reader(Slot(slot));
+  tensors->clear();
+  tensors->resize(reader.Read<uint64_t>());
+  for (auto& tensor : *tensors) {
+    auto type = framework::ToTypeIndex(
+        static_cast<framework::proto::VarType::Type>(reader.Read<int32_t>()));
+    std::vector<int64_t> dims(reader.Read<int32_t>());
+    for (auto& dim : dims) {
+      dim = reader.Read<int64_t>();
+    }
+    framework::LoD lod(reader.Read<uint64_t>());
+    for (auto& level : lod) {
+      size_t level_size = reader.Read<uint64_t>();
+      for (size_t i = 0; i < level_size; ++i) {
+        level.push_back(reader.Read<uint64_t>());
+      }
+    }
+    size_t size = reader.Read<uint64_t>();
+    reader.Align();
+    uint8_t* data = reader.Data(size);
+    reader.Align();
+
+    tensor.Resize(framework::make_ddim(dims));
+    tensor.set_lod(lod);
+    if (size > 0) {
+      tensor.ShareExternalData(data, size, type, holder);
+    } else {
+      tensor.mutable_data(platform::CPUPlace(), type);
+    }
+  }
+  return true;
+}
+
+void SharedMemoryQueue::ReleaseSlot(size_t slot) {
+  SharedMutexLock lock(&header_->mutex);
+  free_[header_->num_free++] = slot;
+  pthread_cond_signal(&header_->not_full);
+}
+
+void SharedMemoryQueue::Close() {
+  SharedMutexLock lock(&header_->mutex);
+  header_->closed = true;
+  pthread_cond_broadcast(&header_->not_full);
+  pthread_cond_broadcast(&header_->not_empty);
+}
+
+void SharedMemoryQueue::ReOpen(size_t num_writers) {
+  SharedMutexLock lock(&header_->mutex);
+  while (header_->size > 0) {
+    free_[header_->num_free++] = ready_[header_->head];
+    header_->head = (header_->head + 1) % header_->num_slots;
+    --header_->size;
+  }
+  header_->num_writers = num_writers;
+  header_->closed = false;
+  pthread_cond_broadcast(&header_->not_full);
+}
+
+void SharedMemoryQueue::WriterDone() {
+  SharedMutexLock lock(&header_->mutex);
+  if (header_->num_writers > 0 && --header_->num_writers == 0) {
+    header_->closed = true;
+    pthread_cond_broadcast(&header_->not_full);
+    pthread_cond_broadcast(&header_->not_empty);
+  }
+}
+
+bool SharedMemoryQueue::IsClosed() const {
+  SharedMutexLock lock(&header_->mutex);
+  return header_->closed;
+}
+
+size_t SharedMemoryQueue::Cap() const { return header_->num_slots; }
+
+size_t SharedMemoryQueue::Size() const {
+  SharedMutexLock lock(&header_->mutex);
+  return header_->size;
+}
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,86 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+/*
+ * A queue of batches in POSIX shared memory, which is written by several
+ * processes and read by one. The writers are the processes forked after it
+ * is created, the name is removed at once so the memory is freed with the
+ * last process using it. The batches are serialized into a ring of
+ * num_slots preallocated slots of slot_size bytes. The tensors popped share
+ * the memory of their slot, which is reused after all of them are destroyed.
+ *
+ * The queue is closed after Close() or after all the writers of ReOpen()
+ * call WriterDone(). The batches pushed before are still popped.
+ */
+class SharedMemoryQueue
+    : public std::enable_shared_from_this<SharedMemoryQueue> {
+ public:
+  SharedMemoryQueue(const std::string& name, size_t num_slots,
+                    size_t slot_size);
+
+  ~SharedMemoryQueue();
+
+  // Serialize the CPU tensors into a free slot, waiting for one while all
+  // the slots are used. Return false if the queue is closed.
+  bool Push(const std::vector<framework::LoDTensor>& tensors);
+
+  // Return false if the queue is closed and has no batch.
+  bool Pop(std::vector<framework::LoDTensor>* tensors);
+
+  void Close();
+
+  // Drop the batches in the queue and expect num_writers writers. It should
+  // not be called along with Push.
+  void ReOpen(size_t num_writers);
+
+  void WriterDone();
+
+  bool IsClosed() const;
+
+  size_t Cap() const;
+
+  size_t Size() const;
+
+  const std::string& Name() const { return name_; }
+
+ private:
+  struct Header;
+  struct SlotHolder;
+
+  uint8_t* Slot(size_t slot) const;
+  void ReleaseSlot(size_t slot);
+
+  std::string name_;
+  size_t mapped_size_;
+  Header* header_;
+  size_t* ready_;
+  size_t* free_;
+  uint8_t* slots_;
+};
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,152 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sys/wait.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+
+#include "paddle/fluid/operators/reader/shared_memory_queue.h"
+
+using paddle::framework::LoD;
+using paddle::framework::LoDTensor;
+using paddle::framework::make_ddim;
+using paddle::operators::reader::SharedMemoryQueue;
+using paddle::platform::CPUPlace;
+
+static std::shared_ptr<SharedMemoryQueue> CreateQueue(const std::string& name,
+                                                      size_t num_slots,
+                                                      size_t slot_size) {
+  return std::make_shared<SharedMemoryQueue>(
+      "/" + name + "_" + std::to_string(getpid()), num_slots, slot_size);
+}
+
+static std::vector<LoDTensor> MakeBatch(int value) {
+  std::vector<LoDTensor> batch(2);
+  float* data = batch[0].mutable_data<float>(make_ddim({3, 4}), CPUPlace());
+  for (int i = 0; i < 12; ++i) {
+    data[i] = value + i;
+  }
+  batch[0].set_lod(LoD({{0, 1, 3}}));
+  *batch[1].mutable_data<int64_t>(make_ddim({1}), CPUPlace()) = value;
+  return batch;
+}
+
+static void CheckBatch(const std::vector<LoDTensor>& batch, int value) {
+  ASSERT_EQ(batch.size(), 2UL);
+  EXPECT_EQ(batch[0].dims(), make_ddim({3, 4}));
+  EXPECT_EQ(batch[0].lod(), LoD({{0, 1, 3}}));
+  for (int i = 0; i < 12; ++i) {
+    EXPECT_EQ(batch[0].data<float>()[i], value + i);
+  }
+  EXPECT_EQ(batch[1].dims(), make_ddim({1}));
+  EXPECT_EQ(batch[1].data<int64_t>()[0], value);
+}
+
+TEST(SharedMemoryQueue, PushAndPop) {
+  auto queue = CreateQueue("shared_memory_queue_push_pop", 4, 1024);
+  queue->ReOpen(1);
+  EXPECT_EQ(queue->Cap(), 4UL);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(queue->Push(MakeBatch(i)));
+  }
+  EXPECT_EQ(queue->Size(), 3UL);
+  queue->WriterDone();
+  EXPECT_TRUE(queue->IsClosed());
+
+  // The batches pushed before closing are popped in order.
+  std::vector<LoDTensor> batch;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(queue->Pop(&batch));
+    CheckBatch(batch, i);
+  }
+  EXPECT_FALSE(queue->Pop(&batch));
+  EXPECT_FALSE(queue->Push(MakeBatch(0)));
+}
+
+TEST(SharedMemoryQueue, ReuseSlots) {
+  auto queue = CreateQueue("shared_memory_queue_reuse_slots", 1, 1024);
+  queue->ReOpen(1);
+  EXPECT_TRUE(queue->Push(MakeBatch(0)));
+  std::vector<LoDTensor> batch;
+  ASSERT_TRUE(queue->Pop(&batch));
+
+  // The only slot is used by the tensors popped.
+  std::atomic<bool> pushed(false);
+  std::thread writer([&] {
+    EXPECT_TRUE(queue->Push(MakeBatch(1)));
+    pushed = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(pushed);
+  CheckBatch(batch, 0);
+  batch.clear();
+  writer.join();
+  EXPECT_TRUE(pushed);
+
+  ASSERT_TRUE(queue->Pop(&batch));
+  CheckBatch(batch, 1);
+}
+
+TEST(SharedMemoryQueue, BatchTooLarge) {
+  auto queue = CreateQueue("shared_memory_queue_too_large", 1, 128);
+  queue->ReOpen(1);
+  EXPECT_THROW(queue->Push(MakeBatch(0)), paddle::platform::EnforceNotMet);
+
+  // The slot is returned.
+  std::vector<LoDTensor> small(1);
+  small[0].mutable_data<float>(make_ddim({1}), CPUPlace());
+  EXPECT_TRUE(queue->Push(small));
+}
+
+TEST(SharedMemoryQueue, MultiProcess) {
+  const int num_writers = 3;
+  const int num_batches = 10;
+  auto queue = CreateQueue("shared_memory_queue_multi_process", 2, 1024);
+  queue->ReOpen(num_writers);
+  std::vector<pid_t> pids;
+  for (int i = 0; i < num_writers; ++i) {
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+      for (int j = 0; j < num_batches; ++j) {
+        queue->Push(MakeBatch(i * num_batches + j));
+      }
+      queue->WriterDone();
+      _exit(0);
+    }
+    pids.push_back(pid);
+  }
+
+  std::vector<int> counts(num_writers * num_batches, 0);
+  std::vector<LoDTensor> batch;
+  while (queue->Pop(&batch)) {
+    int value = static_cast<int>(batch[1].data<int64_t>()[0]);
+    CheckBatch(batch, value);
+    ++counts[value];
+  }
+  for (int count : counts) {
+    EXPECT_EQ(count, 1);
+  }
+  for (pid_t pid : pids) {
+    int status;
+    waitpid(pid, &status, 0);
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+  }
+}
@@ -0,0 +1,135 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/reader/slot_file.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+template <typename T>
+static void WriteValue(std::ostream* out, const T& value) {
+  out->write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static void WriteArray(std::ostream* out, const std::vector<T>& values) {
+  out->write(reinterpret_cast<const char*>(values.data()),
+             values.size() * sizeof(T));
+}
+
+template <typename T>
+static bool ReadValue(std::istream* in, T* value) {
+  in->read(reinterpret_cast<char*>(value), sizeof(T));
+  return static_cast<size_t>(in->gcount()) == sizeof(T);
+}
+
+template <typename T>
+static void ReadArray(std::istream* in, size_t size, std::vector<T>* values) {
+  values->resize(size);
+  in->read(reinterpret_cast<char*>(values->data()), size * sizeof(T));
+  PADDLE_ENFORCE_EQ(static_cast<size_t>(in->gcount()), size * sizeof(T),
+                    "The slot file is truncated.");
+}
+
+SlotFileWriter::SlotFileWriter(std::ostream* out, uint32_t num_slots,
+                               uint32_t max_chunk_instances)
+    : out_(out),
+      num_slots_(num_slots),
+      max_chunk_instances_(max_chunk_instances) {
+  PADDLE_ENFORCE_NOT_NULL(out_);
+  PADDLE_ENFORCE_GT(num_slots_, 0U);
+  PADDLE_ENFORCE_GT(max_chunk_instances_, 0U);
+  chunk_.offsets.assign(num_slots_, std::vector<uint64_t>(1, 0));
+  chunk_.ids.resize(num_slots_);
+  WriteValue(out_, kSlotFileMagic);
+  WriteValue(out_, num_slots_);
+}
+
+void SlotFileWriter::Write(const std::vector<std::vector<int64_t>>& instance) {
+  PADDLE_ENFORCE(!closed_, "The slot file writer is closed.");
+  PADDLE_ENFORCE_EQ(instance.size(), num_slots_,
+                    "The instance should have %d slots.", num_slots_);
+  for (uint32_t i = 0; i < num_slots_; ++i) {
+    auto& ids = chunk_.ids[i];
+    ids.insert(ids.end(), instance[i].begin(), instance[i].end());
+    chunk_.offsets[i].push_back(ids.size());
+  }
+  if (++chunk_.num_instances >= max_chunk_instances_) {
+    Flush();
+  }
+}
+
+void SlotFileWriter::Flush() {
+  if (chunk_.num_instances == 0) {
+    return;
+  }
+  WriteValue(out_, chunk_.num_instances);
+  for (uint32_t i = 0; i < num_slots_; ++i) {
+    WriteValue(out_, static_cast<uint64_t>(chunk_.ids[i].size()));
+    WriteArray(out_, chunk_.offsets[i]);
+    WriteArray(out_, chunk_.ids[i]);
+    chunk_.offsets[i].resize(1);
+    chunk_.ids[i].clear();
+  }
+  chunk_.num_instances = 0;
+  out_->flush();
+}
+
+void SlotFileWriter::Close() {
+  if (!closed_) {
+    Flush();
+    closed_ = true;
+  }
+}
+
+SlotFileScanner::SlotFileScanner(const std::string& filename)
+    : filename_(filename) {
+  Reset();
+}
+
+void SlotFileScanner::Reset() {
+  if (in_.is_open()) {
+    in_.close();
+  }
+  in_.clear();
+  in_.open(filename_, std::ios::binary);
+  PADDLE_ENFORCE(in_.is_open(), "Cannot open the slot file %s", filename_);
+  uint32_t magic;
+  PADDLE_ENFORCE(ReadValue(&in_, &magic) && magic == kSlotFileMagic,
+                 "%s is not a slot file.", filename_);
+  PADDLE_ENFORCE(ReadValue(&in_, &num_slots_), "The slot file is truncated.");
+}
+
+bool SlotFileScanner::NextChunk(SlotChunk* chunk) {
+  if (!ReadValue(&in_, &chunk->num_instances)) {
+    return false;
+  }
+  chunk->offsets.resize(num_slots_);
+  chunk->ids.resize(num_slots_);
+  for (uint32_t i = 0; i < num_slots_; ++i) {
+    uint64_t num_ids;
+    PADDLE_ENFORCE(ReadValue(&in_, &num_ids), "The slot file is truncated.");
+    ReadArray(&in_, chunk->num_instances + 1, &chunk->offsets[i]);
+    PADDLE_ENFORCE_EQ(chunk->offsets[i].back(), num_ids,
+                      "The offsets of the slot file are broken.");
+    ReadArray(&in_, num_ids, &chunk->ids[i]);
+  }
+  return true;
+}
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,94 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+// A slot file keeps the sparse slots of the instances by columns, so that
+// the ids of a slot of many instances could be read by one copy. The file
+// is a header of
+//
+//   uint32 magic number kSlotFileMagic
+//   uint32 the number of the slots
+//
+// followed by the chunks, each of which is
+//
+//   uint32 the number of the instances n
+//   then for each slot:
+//     uint64 the number of the ids m
+//     uint64 offsets[n + 1], where the ids of the i-th instance are
+//            ids[offsets[i], offsets[i + 1])
+//     int64  ids[m]
+//
+// in the native byte order.
+constexpr uint32_t kSlotFileMagic = 0x544f4c53;  // "SLOT"
+
+struct SlotChunk {
+  uint32_t num_instances{0};
+  std::vector<std::vector<uint64_t>> offsets;
+  std::vector<std::vector<int64_t>> ids;
+};
+
+class SlotFileWriter {
+ public:
+  // Instances are written in chunks of max_chunk_instances.
+  SlotFileWriter(std::ostream* out, uint32_t num_slots,
+                 uint32_t max_chunk_instances = 1024);
+
+  ~SlotFileWriter() { Close(); }
+
+  // Append an instance, which has the ids of each slot.
+  void Write(const std::vector<std::vector<int64_t>>& instance);
+
+  void Flush();
+
+  void Close();
+
+ private:
+  std::ostream* out_;
+  uint32_t num_slots_;
+  uint32_t max_chunk_instances_;
+  SlotChunk chunk_;
+  bool closed_{false};
+};
+
+class SlotFileScanner {
+ public:
+  explicit SlotFileScanner(const std::string& filename);
+
+  uint32_t NumSlots() const { return num_slots_; }
+
+  // Read the next chunk. Return false at the end of the file.
+  bool NextChunk(SlotChunk* chunk);
+
+  void Reset();
+
+ private:
+  std::string filename_;
+  std::ifstream in_;
+  uint32_t num_slots_{0};
+};
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
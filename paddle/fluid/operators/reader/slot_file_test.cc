@@ -0,0 +1,54 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/reader/slot_file.h"
+#include <cstdio>
+#include <fstream>
+#include "gtest/gtest.h"
+
+using paddle::operators::reader::SlotChunk;
+using paddle::operators::reader::SlotFileScanner;
+using paddle::operators::reader::SlotFileWriter;
+
+TEST(SlotFile, WriteAndScan) {
+  const std::string filename = "/tmp/slot_file_test.slot";
+  {
+    std::ofstream fout(filename, std::ios::binary);
+    SlotFileWriter writer(&fout, 2, 2);
+    writer.Write({{1, 2, 3}, {10}});
+    writer.Write({{}, {20, 21}});
+    writer.Write({{4}, {30}});
+  }
+
+  SlotFileScanner scanner(filename);
+  EXPECT_EQ(scanner.NumSlots(), 2U);
+  SlotChunk chunk;
+  ASSERT_TRUE(scanner.NextChunk(&chunk));
+  EXPECT_EQ(chunk.num_instances, 2U);
+  EXPECT_EQ(chunk.offsets[0], (std::vector<uint64_t>{0, 3, 3}));
+  EXPECT_EQ(chunk.ids[0], (std::vector<int64_t>{1, 2, 3}));
+  EXPECT_EQ(chunk.offsets[1], (std::vector<uint64_t>{0, 1, 3}));
+  EXPECT_EQ(chunk.ids[1], (std::vector<int64_t>{10, 20, 21}));
+
+  ASSERT_TRUE(scanner.NextChunk(&chunk));
+  EXPECT_EQ(chunk.num_instances, 1U);
+  EXPECT_EQ(chunk.ids[0], (std::vector<int64_t>{4}));
+  EXPECT_EQ(chunk.ids[1], (std::vector<int64_t>{30}));
+  EXPECT_FALSE(scanner.NextChunk(&chunk));
+
+  scanner.Reset();
+  ASSERT_TRUE(scanner.NextChunk(&chunk));
+  EXPECT_EQ(chunk.num_instances, 2U);
+  std::remove(filename.c_str());
+}
@@ -12,6 +12,8 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <string>
+#include <unordered_set>
 #include <vector>
 #include "paddle/fluid/framework/executor.h"
 #include "paddle/fluid/framework/op_registry.h"
@@ -28,6 +30,7 @@ constexpr char kStates[] = "states";
 constexpr char kStepBlock[] = "sub_block";
 constexpr char kReverse[] = "reverse";
 constexpr char kIsTrain[] = "is_train";
+constexpr char kCheckpointInterval[] = "checkpoint_interval";
 #define GRAD_SUFFIX "@GRAD"
 constexpr char kInputGrads[] = "inputs" GRAD_SUFFIX;
 constexpr char kOutputGrads[] = "outputs" GRAD_SUFFIX;
@@ -181,6 +184,59 @@ class RecurrentBase : public framework::OperatorBase {
     }
   }
 
+  // Whether only every checkpoint_interval-th step scope keeps its ex-states
+  // after the forward, and the other steps are recomputed in the backward.
+  int CheckpointInterval() const {
+    if (!Attr<bool>(kIsTrain) || Attrs().count(kCheckpointInterval) == 0) {
+      return 0;
+    }
+    return Attr<int>(kCheckpointInterval);
+  }
+
+  // Erase the local variables of the step scope except the kept ones.
+  static void ClearStepScope(framework::Scope *scope,
+                             const std::vector<std::string> &kept_vars) {
+    std::unordered_set<std::string> kept(kept_vars.begin(), kept_vars.end());
+    std::vector<std::string> erased;
+    for (auto &name : scope->LocalVarNames()) {
+      if (kept.count(name) == 0) {
+        erased.push_back(name);
+      }
+    }
+    scope->EraseVars(erased);
+    scope->DropKids();
+  }
+
+  // Link the sliced inputs and the ex-states of the step_id-th forward step.
+  // The initial states are linked at the first step, the states of the
+  // ex-scope otherwise.
+  void LinkForwardStep(const framework::Scope &scope, size_t seq_len,
+                       size_t step_id, framework::Scope *cur_scope,
+                       const framework::Scope *ex_scope) const {
+    size_t seq_offset = Attr<bool>(kReverse) ? seq_len - step_id - 1 : step_id;
+    // Link outside::input --> inside::input
+    //   inside::input = outside::input[seq_offset: seq_offset+1]
+    LinkTensorWithCallback(
+        scope, Inputs(kInputs), cur_scope, Inputs(kInputs),
+        [&seq_offset](const framework::Tensor &outside,
+                      framework::Tensor *inside) {
+          inside->ShareDataWith(outside.Slice(seq_offset, seq_offset + 1));
+          auto dims = framework::vectorize(inside->dims());
+          dims.erase(dims.begin());
+          inside->Resize(framework::make_ddim(dims));
+        });
+
+    if (step_id == 0) {
+      // Link initial states  --> ex_states
+      LinkTensor(scope, Inputs(kInitialStates), cur_scope,
+                 Attr<std::vector<std::string>>(kExStates));
+    } else if (ex_scope != nullptr) {
+      // Link ex_scope::state --> cur_scope::ex_state
+      LinkTensor(*ex_scope, Attr<std::vector<std::string>>(kStates), cur_scope,
+                 Attr<std::vector<std::string>>(kExStates));
+    }
+  }
+
   // (seq_len, shape) -> return [seq_len] + list(shape)
   static framework::DDim PrependDims(size_t seq_len,
                                      const framework::DDim &src) {
@@ -233,44 +289,34 @@ class RecurrentOp : public RecurrentBase {
     VLOG(3) << "Static RNN input sequence length = " << seq_len;
     StepScopes scopes = CreateStepScopes(scope, seq_len);
     auto reverse = Attr<bool>(kReverse);
+    int checkpoint_interval = CheckpointInterval();
 
     framework::Executor executor(place);
     auto *block = Attr<framework::BlockDesc *>(kStepBlock);
 
     auto *program = block->Program();
+    auto ctx = executor.Prepare(*program, block->ID());
+    if (Attr<bool>(kIsTrain)) {
+      // The backward reads the variables of the step scopes.
+      ctx->DisableEagerDeletion();
+    } else {
+      // The temporaries of a step are freed after their last use, but the
+      // states and the outputs are read after the step.
+      ctx->SkipEagerDeletionVars(Outputs(kOutputs));
+      ctx->SkipEagerDeletionVars(Attr<std::vector<std::string>>(kStates));
+    }
 
     for (size_t i = 0; i < seq_len; ++i) {
       size_t seq_offset = reverse ? seq_len - i - 1 : i;
       VLOG(3) << "Recurrent operate at the time step " << seq_offset;
 
       auto &cur_scope = scopes.CurScope();
-
-      // Link outside::input --> inside::input
-      //   inside::input = outside::input[seq_offset: seq_offset+1]
-      LinkTensorWithCallback(
-          scope, Inputs(kInputs), &cur_scope, Inputs(kInputs),
-          [&seq_offset](const framework::Tensor &outside,
-                        framework::Tensor *inside) {
-            inside->ShareDataWith(outside.Slice(seq_offset, seq_offset + 1));
-            auto dims = framework::vectorize(inside->dims());
-            dims.erase(dims.begin());
-            inside->Resize(framework::make_ddim(dims));
-          });
-
-      if (i == 0) {
-        // Link initial states  --> ex_states
-        LinkTensor(scope, Inputs(kInitialStates), &cur_scope,
-                   Attr<std::vector<std::string>>(kExStates));
-      } else {
-        auto &ex_scope = scopes.ExScope();
-        // Link ex_scope::state --> cur_scope::ex_state
-        LinkTensor(ex_scope, Attr<std::vector<std::string>>(kStates),
-                   &cur_scope, Attr<std::vector<std::string>>(kExStates));
-      }
+      LinkForwardStep(scope, seq_len, i, &cur_scope,
+                      i == 0 ? nullptr : &scopes.ExScope());
 
       // Every inputs are linked now, execute!
-      executor.Run(*program, &cur_scope, block->ID(),
-                   false /*create_local_scope*/);
+      executor.RunPreparedContext(ctx.get(), &cur_scope,
+                                  false /*create_local_scope*/);
 
       // get device context from pool
       platform::DeviceContextPool &pool =
@@ -294,10 +340,28 @@ class RecurrentOp : public RecurrentBase {
             framework::TensorCopy(src_tensor, place, dev_ctx, &dst_out);
           });
 
+      // The ex-scope is not used by the later steps. With checkpoints, only
+      // the ex-states of the checkpoint steps are kept for the backward,
+      // which recomputes the other variables.
+      if (checkpoint_interval > 0 && i > 0) {
+        ClearForwardStepScope(&scopes.ExScope(), i - 1, checkpoint_interval);
+      }
+      if (checkpoint_interval > 0 && i + 1 == seq_len) {
+        ClearForwardStepScope(&cur_scope, i, checkpoint_interval);
+      }
       scopes.Next();
     }
   }
 
+  void ClearForwardStepScope(framework::Scope *scope, size_t step_id,
+                             int checkpoint_interval) const {
+    if (step_id % checkpoint_interval == 0) {
+      ClearStepScope(scope, Attr<std::vector<std::string>>(kExStates));
+    } else {
+      ClearStepScope(scope, {});
+    }
+  }
+
  private:
   StepScopes CreateStepScopes(const framework::Scope &scope,
                               size_t seq_len) const {
@@ -332,9 +396,25 @@ class RecurrentGradOp : public RecurrentBase {
     platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
     auto &dev_ctx = *pool.Get(place);
 
+    int checkpoint_interval = CheckpointInterval();
+    auto *step_scopes =
+        scope.FindVar(Input(kStepScopes))->GetMutable<StepScopeVar>();
+    if (checkpoint_interval > 0) {
+      PADDLE_ENFORCE_GE(block->ForwardBlockID(), 0,
+                        "The step block of recurrent_grad should know its "
+                        "forward block to recompute the forward steps.");
+    }
+
     for (size_t step_id = 0; step_id < seq_len; ++step_id) {
       size_t seq_offset = reverse ? step_id : seq_len - step_id - 1;
       VLOG(3) << "Recurrent backward operate at the time step " << seq_offset;
+      size_t forward_id = seq_len - step_id - 1;
+      if (checkpoint_interval > 0 &&
+          (step_id == 0 || (forward_id + 1) % checkpoint_interval == 0)) {
+        RecomputeForward(scope, place, *block->ForwardBlock(), seq_len,
+                         forward_id - forward_id % checkpoint_interval,
+                         forward_id, step_scopes);
+      }
       auto &cur_scope = scopes.CurScope();
       // Link outside::output_grads --> inside::output_grads
       //   inside::output_grad = outside::output_grad[seq_offset:seq_offset+1]
@@ -470,11 +550,35 @@ class RecurrentGradOp : public RecurrentBase {
             });
         VLOG(5) << "Link initialize state gradient finished ";
       }
+      // The ex-scope, whose gradients of the ex-states are linked to this
+      // step, is not used any more.
+      if (checkpoint_interval > 0 && step_id != 0) {
+        ClearStepScope(&scopes.ExScope(), {});
+      }
       scopes.Next();
     }
   }
 
  private:
+  // Run the forward steps from begin to end again in their step scopes, where
+  // the begin-th step scope is a checkpoint keeping its ex-states.
+  void RecomputeForward(const framework::Scope &scope,
+                        const platform::Place &place,
+                        const framework::BlockDesc &forward_block,
+                        size_t seq_len, size_t begin, size_t end,
+                        StepScopeVar *step_scopes) const {
+    VLOG(3) << "Recompute the forward steps from " << begin << " to " << end;
+    PADDLE_ENFORCE_LT(end, step_scopes->size());
+    framework::Executor executor(place);
+    for (size_t i = begin; i <= end; ++i) {
+      auto *cur_scope = (*step_scopes)[i];
+      LinkForwardStep(scope, seq_len, i, cur_scope,
+                      i == begin ? nullptr : (*step_scopes)[i - 1]);
+      executor.Run(*forward_block.Program(), cur_scope, forward_block.ID(),
+                   false /*create_local_scope*/);
+    }
+  }
+
   StepScopes CreateStepScopes(const framework::Scope &scope,
                               size_t seq_len) const {
     auto *var = scope.FindVar(Input(kStepScopes));
@@ -560,6 +664,13 @@ if reverse is True
       o          o          o         o
 )DOC").SetDefault(false);
     AddAttr<bool>(kIsTrain, "").SetDefault(true);
+    AddAttr<int>(kCheckpointInterval,
+                 "(int, default 0) If it is positive, only every "
+                 "checkpoint_interval-th step keeps its ex-states for the "
+                 "backward, which recomputes the other steps from them. "
+                 "Setting it to about sqrt(seq_len) trades one more forward "
+                 "for O(sqrt(seq_len)) memory of the step scopes.")
+        .SetDefault(0);
     AddComment(R"DOC(
 Static Length Recurrent Operator.
 
@@ -12,17 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "paddle/fluid/operators/reduce_op.cu.h"
 #include "paddle/fluid/operators/reduce_min_max_op.h"
 
 REGISTER_OP_CUDA_KERNEL(reduce_max,
-                        ops::ReduceKernel<paddle::platform::CUDADeviceContext,
-                                          float, ops::MaxFunctor>,
-                        ops::ReduceKernel<paddle::platform::CUDADeviceContext,
-                                          double, ops::MaxFunctor>,
-                        ops::ReduceKernel<paddle::platform::CUDADeviceContext,
-                                          int, ops::MaxFunctor>,
-                        ops::ReduceKernel<paddle::platform::CUDADeviceContext,
-                                          int64_t, ops::MaxFunctor>);
+                        ops::ReduceCUDAKernel<float, ops::MaxReducer>,
+                        ops::ReduceCUDAKernel<double, ops::MaxReducer>,
+                        ops::ReduceCUDAKernel<int, ops::MaxReducer>,
+                        ops::ReduceCUDAKernel<int64_t, ops::MaxReducer>);
 REGISTER_OP_CUDA_KERNEL(
     reduce_max_grad, ops::ReduceGradKernel<paddle::platform::CUDADeviceContext,
                                            float, ops::MaxOrMinGradFunctor>,
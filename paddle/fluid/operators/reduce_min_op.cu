@@ -12,17 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "paddle/fluid/operators/reduce_op.cu.h"
 #include "paddle/fluid/operators/reduce_min_max_op.h"
 
 REGISTER_OP_CUDA_KERNEL(reduce_min,
-                        ops::ReduceKernel<paddle::platform::CUDADeviceContext,
-                                          float, ops::MinFunctor>,
-                        ops::ReduceKernel<paddle::platform::CUDADeviceContext,
-                                          double, ops::MinFunctor>,
-                        ops::ReduceKernel<paddle::platform::CUDADeviceContext,
-                                          int, ops::MinFunctor>,
-                        ops::ReduceKernel<paddle::platform::CUDADeviceContext,
-                                          int64_t, ops::MinFunctor>);
+                        ops::ReduceCUDAKernel<float, ops::MinReducer>,
+                        ops::ReduceCUDAKernel<double, ops::MinReducer>,
+                        ops::ReduceCUDAKernel<int, ops::MinReducer>,
+                        ops::ReduceCUDAKernel<int64_t, ops::MinReducer>);
 REGISTER_OP_CUDA_KERNEL(
     reduce_min_grad, ops::ReduceGradKernel<paddle::platform::CUDADeviceContext,
                                            float, ops::MaxOrMinGradFunctor>,
@@ -0,0 +1,104 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <limits>
+#include <vector>
+
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/cub_reduce.h"
+
+namespace paddle {
+namespace operators {
+
+// The dims of X reduced by a reduce op, in [0, rank).
+inline std::vector<int> GetReduceDims(const framework::ExecutionContext& ctx,
+                                      const framework::DDim& x_dims) {
+  std::vector<int> reduce_dims;
+  if (ctx.Attr<bool>("reduce_all")) {
+    for (int i = 0; i < x_dims.size(); ++i) reduce_dims.push_back(i);
+  } else {
+    for (auto e : ctx.Attr<std::vector<int>>("dim")) {
+      reduce_dims.push_back(e >= 0 ? e : e + x_dims.size());
+    }
+  }
+  return reduce_dims;
+}
+
+inline int GetReduceNum(const framework::DDim& x_dims,
+                        const std::vector<int>& reduce_dims) {
+  int reduce_num = 1;
+  for (auto d : reduce_dims) reduce_num *= x_dims[d];
+  return reduce_num;
+}
+
+// The reducers with their identity for the CUB reduction.
+template <typename T>
+struct SumReducer {
+  using Op = cub::Sum;
+  static T Init() { return static_cast<T>(0); }
+};
+
+template <typename T>
+struct MaxReducer {
+  using Op = cub::Max;
+  static T Init() { return std::numeric_limits<T>::lowest(); }
+};
+
+template <typename T>
+struct MinReducer {
+  using Op = cub::Min;
+  static T Init() { return std::numeric_limits<T>::max(); }
+};
+
+template <typename T>
+struct ProdReducer {
+  using Op = CustomMul;
+  static T Init() { return static_cast<T>(1); }
+};
+
+// The CUDA kernel of a reduce op, which reduces any dims of X with cub
+// instead of the Eigen reduction.
+template <typename T, template <typename> class Reducer>
+class ReduceCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto* input = context.Input<framework::Tensor>("X");
+    auto* output = context.Output<framework::Tensor>("Out");
+    auto reduce_dims = GetReduceDims(context, input->dims());
+    using Op = typename Reducer<T>::Op;
+
+    auto stream = context.cuda_device_context().stream();
+    TensorReduce<T, T, Op, IdentityFunctor<T>>(*input, output, reduce_dims,
+                                               Reducer<T>::Init(), Op(),
+                                               IdentityFunctor<T>(), stream);
+  }
+};
+
+// Reduce all the elements of X to the scalar Out, e.g. the norms.
+template <typename T, typename TransformOp>
+void ReduceAllCUDA(const framework::ExecutionContext& context,
+                   const framework::Tensor& x, framework::Tensor* out,
+                   const TransformOp& transformer) {
+  // Reduce the flattened tensor, whose dims are merged anyway.
+  framework::Tensor flat;
+  flat.ShareDataWith(x).Resize(framework::make_ddim({x.numel()}));
+  auto stream = context.cuda_device_context().stream();
+  TensorReduce<T, T, cub::Sum, TransformOp>(flat, out, {0}, static_cast<T>(0),
+                                            cub::Sum(), transformer, stream);
+}
+
+}  // namespace operators
+}  // namespace paddle
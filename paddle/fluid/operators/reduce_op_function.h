@@ -13,9 +13,12 @@
 // limitations under the License.
 
 #pragma once
+#include <algorithm>
+#include <type_traits>
 #include <vector>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/platform/for_range.h"
 
 namespace paddle {
 namespace operators {
@@ -63,10 +66,53 @@ void ReduceFunctor(const DeviceContext& context, const framework::Tensor& input,
   if (D == 1) {
     auto out = EigenScalar<T>::From(*output);
     functor(place, &x, &out, reduce_dim);
-  } else {
-    auto out = EigenTensor<T, (D - R_D)>::From(*output, out_dims);
+    return;
+  }
+  auto out = EigenTensor<T, (D - R_D)>::From(*output, out_dims);
+  // On CPU, split the reduction along the biggest kept dim, each chunk of
+  // which is reduced separately.
+  int split_dim = -1;
+  int out_split_dim = 0;
+  if (std::is_same<DeviceContext, platform::CPUDeviceContext>::value) {
+    int out_dim = 0;
+    for (int d = 0; d < x_rank; ++d) {
+      if (std::find(dims_ref.begin(), dims_ref.end(), d) != dims_ref.end()) {
+        continue;
+      }
+      if (split_dim < 0 || x.dimension(d) > x.dimension(split_dim)) {
+        split_dim = d;
+        out_split_dim = out_dim;
+      }
+      ++out_dim;
+    }
+  }
+  if (split_dim < 0 || x.dimension(split_dim) <= 1) {
     functor(place, &x, &out, reduce_dim);
+    return;
   }
+  int64_t extent = x.dimension(split_dim);
+  platform::ParallelFor(
+      context, extent,
+      [&](int64_t begin, int64_t end) {
+        Eigen::array<Eigen::DenseIndex, D> x_offsets, x_extents;
+        for (size_t d = 0; d < D; ++d) {
+          x_offsets[d] = 0;
+          x_extents[d] = x.dimension(d);
+        }
+        x_offsets[split_dim] = begin;
+        x_extents[split_dim] = end - begin;
+        Eigen::array<Eigen::DenseIndex, D - R_D> out_offsets, out_extents;
+        for (size_t d = 0; d < D - R_D; ++d) {
+          out_offsets[d] = 0;
+          out_extents[d] = out.dimension(d);
+        }
+        out_offsets[out_split_dim] = begin;
+        out_extents[out_split_dim] = end - begin;
+        auto x_chunk = x.slice(x_offsets, x_extents);
+        auto out_chunk = out.slice(out_offsets, out_extents);
+        functor(place, &x_chunk, &out_chunk, reduce_dim);
+      },
+      x.size() / extent);
 }
 
 template <typename DeviceContext, typename T, size_t D, typename Functor>
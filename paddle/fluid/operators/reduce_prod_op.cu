@@ -12,17 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "paddle/fluid/operators/reduce_op.cu.h"
 #include "paddle/fluid/operators/reduce_prod_op.h"
 
 REGISTER_OP_CUDA_KERNEL(reduce_prod,
-                        ops::ReduceKernel<paddle::platform::CUDADeviceContext,
-                                          float, ops::ProdFunctor>,
-                        ops::ReduceKernel<paddle::platform::CUDADeviceContext,
-                                          double, ops::ProdFunctor>,
-                        ops::ReduceKernel<paddle::platform::CUDADeviceContext,
-                                          int, ops::ProdFunctor>,
-                        ops::ReduceKernel<paddle::platform::CUDADeviceContext,
-                                          int64_t, ops::ProdFunctor>);
+                        ops::ReduceCUDAKernel<float, ops::ProdReducer>,
+                        ops::ReduceCUDAKernel<double, ops::ProdReducer>,
+                        ops::ReduceCUDAKernel<int, ops::ProdReducer>,
+                        ops::ReduceCUDAKernel<int64_t, ops::ProdReducer>);
 REGISTER_OP_CUDA_KERNEL(
     reduce_prod_grad, ops::ReduceGradKernel<paddle::platform::CUDADeviceContext,
                                             float, ops::ProdGradFunctor>,
@@ -12,6 +12,7 @@ limitations under the License. */
 #pragma once
 #include <algorithm>
 #include <limits>
+#include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/math_function.h"
 
@@ -23,34 +24,76 @@ using LoDTensor = framework::LoDTensor;
 
 static constexpr int kROISize = 4;
 
+// The sampling grid of a ROI, each bin of it averages roi_bin_grid_h *
+// roi_bin_grid_w bilinear samples.
 template <class T>
-void PreCalcForBilinearInterpolate(
-    const platform::DeviceContext& ctx, const int height, const int width,
-    const int pooled_height, const int pooled_width, const int iy_upper,
-    const int ix_upper, T roi_ymin, T roi_xmin, T bin_size_h, T bin_size_w,
-    int roi_bin_grid_h, int roi_bin_grid_w, Tensor* pre_pos, Tensor* pre_w) {
+struct ROIAlignGrid {
+  T roi_ymin;
+  T roi_xmin;
+  T bin_size_h;
+  T bin_size_w;
+  int roi_bin_grid_h;
+  int roi_bin_grid_w;
+};
+
+template <class T>
+ROIAlignGrid<T> GetROIAlignGrid(const T* roi, float spatial_scale,
+                                int pooled_height, int pooled_width,
+                                int sampling_ratio) {
+  ROIAlignGrid<T> grid;
+  grid.roi_xmin = roi[0] * spatial_scale;
+  grid.roi_ymin = roi[1] * spatial_scale;
+  T roi_xmax = roi[2] * spatial_scale;
+  T roi_ymax = roi[3] * spatial_scale;
+  T roi_width = std::max(roi_xmax - grid.roi_xmin, static_cast<T>(1.));
+  T roi_height = std::max(roi_ymax - grid.roi_ymin, static_cast<T>(1.));
+  grid.bin_size_h = static_cast<T>(roi_height) / static_cast<T>(pooled_height);
+  grid.bin_size_w = static_cast<T>(roi_width) / static_cast<T>(pooled_width);
+  grid.roi_bin_grid_h = (sampling_ratio > 0)
+                            ? sampling_ratio
+                            : ceil(roi_height / pooled_height);
+  grid.roi_bin_grid_w = (sampling_ratio > 0)
+                            ? sampling_ratio
+                            : ceil(roi_width / pooled_width);
+  return grid;
+}
+
+// Calculate the kROISize pixels and weights of every sample of the bins of a
+// ROI, in the order of the bins. The weights are divided by the samples of a
+// bin, so a bin is the weighted sum of its pixels. The samples out of the map
+// have zero weights. They are the same for all the channels, so they are
+// calculated once per ROI.
+template <class T>
+void PreCalcForBilinearInterpolate(const int height, const int width,
+                                   const int pooled_height,
+                                   const int pooled_width,
+                                   const ROIAlignGrid<T>& grid,
+                                   int* pre_pos_data, T* pre_w_data) {
   int pre_calc_index = 0;
-  int* pre_pos_data = pre_pos->mutable_data<int>(ctx.GetPlace());
-  T* pre_w_data = pre_w->mutable_data<T>(ctx.GetPlace());
+  const int iy_upper = grid.roi_bin_grid_h;
+  const int ix_upper = grid.roi_bin_grid_w;
+  const T count = static_cast<T>(iy_upper * ix_upper);
   for (int ph = 0; ph < pooled_height; ph++) {
     for (int pw = 0; pw < pooled_width; pw++) {
       for (int iy = 0; iy < iy_upper; iy++) {
         // calculate y of sample points
-        T y = roi_ymin + ph * bin_size_h +
-              static_cast<T>(iy + .5f) * bin_size_h /
-                  static_cast<T>(roi_bin_grid_h);
+        T y = grid.roi_ymin + ph * grid.bin_size_h +
+              static_cast<T>(iy + .5f) * grid.bin_size_h /
+                  static_cast<T>(iy_upper);
         // calculate x of samle points
         for (int ix = 0; ix < ix_upper; ix++) {
-          T x = roi_xmin + pw * bin_size_w +
-                static_cast<T>(ix + .5f) * bin_size_w /
-                    static_cast<T>(roi_bin_grid_w);
+          T x = grid.roi_xmin + pw * grid.bin_size_w +
+                static_cast<T>(ix + .5f) * grid.bin_size_w /
+                    static_cast<T>(ix_upper);
+          int* pos = pre_pos_data + pre_calc_index * kROISize;
+          T* w = pre_w_data + pre_calc_index * kROISize;
+          pre_calc_index += 1;
           // deal with elements out of map
           if (y < -1.0 || y > height || x < -1.0 || x > width) {
             for (int i = 0; i < kROISize; ++i) {
-              pre_pos_data[i + pre_calc_index * kROISize] = 0;
-              pre_w_data[i + pre_calc_index * kROISize] = 0;
+              pos[i] = 0;
+              w[i] = 0;
             }
-            pre_calc_index += 1;
             continue;
           }
           y = y <= 0 ? 0 : y;
@@ -74,62 +117,30 @@ void PreCalcForBilinearInterpolate(
           }
           T ly = y - y_low, lx = x - x_low;
           T hy = 1. - ly, hx = 1. - lx;
-          pre_pos_data[pre_calc_index * kROISize] = y_low * width + x_low;
-          pre_pos_data[pre_calc_index * kROISize + 1] = y_low * width + x_high;
-          pre_pos_data[pre_calc_index * kROISize + 2] = y_high * width + x_low;
-          pre_pos_data[pre_calc_index * kROISize + 3] = y_high * width + x_high;
-          pre_w_data[pre_calc_index * kROISize] = hy * hx;
-          pre_w_data[pre_calc_index * kROISize + 1] = hy * lx;
-          pre_w_data[pre_calc_index * kROISize + 2] = ly * hx;
-          pre_w_data[pre_calc_index * kROISize + 3] = ly * lx;
-          pre_calc_index += 1;
+          pos[0] = y_low * width + x_low;
+          pos[1] = y_low * width + x_high;
+          pos[2] = y_high * width + x_low;
+          pos[3] = y_high * width + x_high;
+          w[0] = hy * hx / count;
+          w[1] = hy * lx / count;
+          w[2] = ly * hx / count;
+          w[3] = ly * lx / count;
         }
       }
     }
   }
 }
 
-template <class T>
-void bilinear_interpolate_gradient(const int height, const int width, T y, T x,
-                                   const T out_grad_this_bin, const T count,
-                                   T* batch_grad_data) {
-  int x_low, y_low, x_high, y_high;
-  T w1, w2, w3, w4;
-  if (y < -1.0 || y > height || x < -1.0 || x > width) {
-    w1 = w2 = w3 = w4 = 0;
-    x_low = x_high = y_low = y_high = -1;
-    return;
-  }
-  y = y <= 0 ? 0 : y;
-  x = x <= 0 ? 0 : x;
-  y_low = static_cast<int>(y);
-  x_low = static_cast<int>(x);
-  if (y_low >= height - 1) {
-    y_high = y_low = height - 1;
-    y = static_cast<T>(y_low);
-  } else {
-    y_high = y_low + 1;
-  }
-
-  if (x_low >= width - 1) {
-    x_high = x_low = width - 1;
-    x = static_cast<T>(x_low);
-  } else {
-    x_high = x_low + 1;
-  }
-
-  T ly = y - y_low, lx = x - x_low;
-  T hy = 1. - ly, hx = 1. - lx;
-  w1 = hy * hx, w2 = hy * lx, w3 = ly * hx, w4 = ly * lx;
-  T diff1 = out_grad_this_bin * w1 / count;
-  T diff2 = out_grad_this_bin * w2 / count;
-  T diff3 = out_grad_this_bin * w3 / count;
-  T diff4 = out_grad_this_bin * w4 / count;
-  if (x_low >= 0 && x_high >= 0 && y_low >= 0 && y_high >= 0) {
-    *(batch_grad_data + y_low * width + x_low) += diff1;
-    *(batch_grad_data + y_low * width + x_high) += diff2;
-    *(batch_grad_data + y_high * width + x_low) += diff3;
-    *(batch_grad_data + y_high * width + x_high) += diff4;
+// The image of each ROI.
+inline void GetROIBatchIds(const framework::LoDTensor& rois,
+                           std::vector<int>* roi_batch_ids) {
+  auto rois_lod = rois.lod().back();
+  int rois_batch_size = rois_lod.size() - 1;
+  roi_batch_ids->resize(rois.dims()[0]);
+  for (int n = 0; n < rois_batch_size; ++n) {
+    for (size_t i = rois_lod[n]; i < rois_lod[n + 1]; ++i) {
+      (*roi_batch_ids)[i] = n;
+    }
   }
 }
 
@@ -158,12 +169,6 @@ class CPUROIAlignOpKernel : public framework::OpKernel<T> {
     auto roi_stride = framework::stride(rois->dims());
     auto out_stride = framework::stride(out->dims());
 
-    const T* input_data = in->data<T>();
-    framework::Tensor roi_batch_id_list;
-    roi_batch_id_list.Resize({rois_num});
-    int* roi_batch_id_data =
-        roi_batch_id_list.mutable_data<int>(ctx.GetPlace());
-
     auto rois_lod = rois->lod().back();
     int rois_batch_size = rois_lod.size() - 1;
     PADDLE_ENFORCE_EQ(
@@ -172,70 +177,54 @@ class CPUROIAlignOpKernel : public framework::OpKernel<T> {
     int rois_num_with_lod = rois_lod[rois_batch_size];
     PADDLE_ENFORCE_EQ(rois_num, rois_num_with_lod,
                       "The rois_num from input and lod must be the same.");
-    for (int n = 0; n < rois_batch_size; ++n) {
-      for (size_t i = rois_lod[n]; i < rois_lod[n + 1]; ++i) {
-        roi_batch_id_data[i] = n;
-      }
-    }
+    std::vector<int> roi_batch_ids;
+    GetROIBatchIds(*rois, &roi_batch_ids);
+
+    const T* input_data = in->data<T>();
     T* output_data = out->mutable_data<T>(ctx.GetPlace());
     const T* rois_data = rois->data<T>();
-    for (int n = 0; n < rois_num; ++n) {
-      int roi_batch_id = roi_batch_id_data[n];
-      T roi_xmin = rois_data[0] * spatial_scale;
-      T roi_ymin = rois_data[1] * spatial_scale;
-      T roi_xmax = rois_data[2] * spatial_scale;
-      T roi_ymax = rois_data[3] * spatial_scale;
-
-      T roi_width = std::max(roi_xmax - roi_xmin, static_cast<T>(1.));
-      T roi_height = std::max(roi_ymax - roi_ymin, static_cast<T>(1.));
-      T bin_size_h = static_cast<T>(roi_height) / static_cast<T>(pooled_height);
-      T bin_size_w = static_cast<T>(roi_width) / static_cast<T>(pooled_width);
-      const T* batch_data = input_data + roi_batch_id * in_stride[0];
+    const int pooled_size = pooled_height * pooled_width;
+    // The ROIs are run by the intra-op thread pool, each of them samples
+    // its bins once for all the channels.
+    dev_ctx.ParallelFor(
+        rois_num,
+        [&](int64_t begin, int64_t end) {
+          std::vector<int> pre_pos;
+          std::vector<T> pre_w;
+          for (int64_t n = begin; n < end; ++n) {
+            auto grid = GetROIAlignGrid(rois_data + n * roi_stride[0],
+                                        spatial_scale, pooled_height,
+                                        pooled_width, sampling_ratio);
+            const int bin_samples =
+                grid.roi_bin_grid_h * grid.roi_bin_grid_w * kROISize;
+            pre_pos.resize(pooled_size * bin_samples);
+            pre_w.resize(pooled_size * bin_samples);
+            PreCalcForBilinearInterpolate(height, width, pooled_height,
+                                          pooled_width, grid, pre_pos.data(),
+                                          pre_w.data());
 
-      int roi_bin_grid_h = (sampling_ratio > 0)
-                               ? sampling_ratio
-                               : ceil(roi_height / pooled_height);
-      int roi_bin_grid_w = (sampling_ratio > 0)
-                               ? sampling_ratio
-                               : ceil(roi_width / pooled_width);
-      const T count = roi_bin_grid_h * roi_bin_grid_w;
-      Tensor pre_pos;
-      Tensor pre_w;
-      int pre_size = count * out_stride[1];
-      pre_pos.Resize({pre_size, kROISize});
-      pre_w.Resize({pre_size, kROISize});
-
-      PreCalcForBilinearInterpolate(
-          dev_ctx, height, width, pooled_height, pooled_width, roi_bin_grid_h,
-          roi_bin_grid_w, roi_ymin, roi_xmin, bin_size_h, bin_size_w,
-          roi_bin_grid_h, roi_bin_grid_w, &pre_pos, &pre_w);
-      const int* pre_pos_data = pre_pos.data<int>();
-      const T* pre_w_data = pre_w.data<T>();
-      for (int c = 0; c < channels; c++) {
-        int pre_calc_index = 0;
-        for (int ph = 0; ph < pooled_height; ph++) {
-          for (int pw = 0; pw < pooled_width; pw++) {
-            const int pool_index = ph * pooled_width + pw;
-            T output_val = 0;
-            for (int iy = 0; iy < roi_bin_grid_h; iy++) {
-              for (int ix = 0; ix < roi_bin_grid_w; ix++) {
-                for (int i = 0; i < kROISize; i++) {
-                  int pos = pre_pos_data[pre_calc_index * kROISize + i];
-                  T w = pre_w_data[pre_calc_index * kROISize + i];
-                  output_val += w * batch_data[pos];
+            const T* batch_data =
+                input_data + roi_batch_ids[n] * in_stride[0];
+            T* roi_output_data = output_data + n * out_stride[0];
+            for (int c = 0; c < channels; c++) {
+              const T* channel_data = batch_data + c * in_stride[1];
+              T* channel_output_data = roi_output_data + c * out_stride[1];
+              const int* pos = pre_pos.data();
+              const T* w = pre_w.data();
+              for (int pool_index = 0; pool_index < pooled_size;
+                   ++pool_index) {
+                T output_val = 0;
+                for (int i = 0; i < bin_samples; ++i) {
+                  output_val += w[i] * channel_data[pos[i]];
                 }
-                pre_calc_index += 1;
+                channel_output_data[pool_index] = output_val;
+                pos += bin_samples;
+                w += bin_samples;
               }
             }
-            output_val /= count;
-            output_data[pool_index] = output_val;
           }
-        }
-        batch_data += in_stride[1];
-        output_data += out_stride[1];
-      }
-      rois_data += roi_stride[0];
-    }
+        },
+        static_cast<int64_t>(channels) * out_stride[1]);
   }
 };
 
@@ -261,71 +250,72 @@ class CPUROIAlignGradOpKernel : public framework::OpKernel<T> {
     int height = in_dims[2];
     int width = in_dims[3];
     int rois_num = rois->dims()[0];
-    Tensor roi_batch_id_list;
-    roi_batch_id_list.Resize({rois_num});
-    int* roi_batch_id_data =
-        roi_batch_id_list.mutable_data<int>(ctx.GetPlace());
-
-    auto rois_lod = rois->lod().back();
-    int rois_batch_size = rois_lod.size() - 1;
-    for (int n = 0; n < rois_batch_size; ++n) {
-      for (size_t i = rois_lod[n]; i < rois_lod[n + 1]; ++i) {
-        roi_batch_id_data[i] = n;
-      }
-    }
+    std::vector<int> roi_batch_ids;
+    GetROIBatchIds(*rois, &roi_batch_ids);
 
     const T* rois_data = rois->data<T>();
     const T* out_grad_data = out_grad->data<T>();
     T* in_grad_data = in_grad->mutable_data<T>(ctx.GetPlace());
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    math::SetConstant<DeviceContext, T> set_zero;
+    set_zero(dev_ctx, in_grad, static_cast<T>(0));
 
     auto in_stride = framework::stride(in->dims());
     auto roi_stride = framework::stride(rois->dims());
     auto out_stride = framework::stride(out_grad->dims());
+    const int pooled_size = pooled_height * pooled_width;
 
+    // The samples of all the ROIs are calculated once in parallel.
+    std::vector<int> bin_samples(rois_num);
+    std::vector<size_t> offsets(rois_num + 1, 0);
+    std::vector<ROIAlignGrid<T>> grids(rois_num);
     for (int n = 0; n < rois_num; ++n) {
-      int roi_batch_idx = roi_batch_id_data[n];
-      T roi_xmin = rois_data[0] * spatial_scale;
-      T roi_ymin = rois_data[1] * spatial_scale;
-      T roi_xmax = rois_data[2] * spatial_scale;
-      T roi_ymax = rois_data[3] * spatial_scale;
-      T roi_width = std::max(roi_xmax - roi_xmin, static_cast<T>(1.));
-      T roi_height = std::max(roi_ymax - roi_ymin, static_cast<T>(1.));
-      T bin_size_h = static_cast<T>(roi_height) / static_cast<T>(pooled_height);
-      T bin_size_w = static_cast<T>(roi_width) / static_cast<T>(pooled_width);
-      for (int c = 0; c < channels; ++c) {
-        T* batch_grad_data =
-            in_grad_data + roi_batch_idx * in_stride[0] + c * in_stride[1];
-        const T* batch_out_grad_data =
-            out_grad_data + n * out_stride[0] + c * out_stride[1];
-        for (int ph = 0; ph < pooled_height; ++ph) {
-          for (int pw = 0; pw < pooled_width; ++pw) {
-            int pool_index = ph * pooled_width + pw;
-            T out_grad_this_bin = batch_out_grad_data[pool_index];
-            int roi_bin_grid_h = (sampling_ratio > 0)
-                                     ? sampling_ratio
-                                     : ceil(roi_height / pooled_height);
-            int roi_bin_grid_w = (sampling_ratio > 0)
-                                     ? sampling_ratio
-                                     : ceil(roi_width / pooled_width);
-            T count = roi_bin_grid_h * roi_bin_grid_w;
-            for (int iy = 0; iy < roi_bin_grid_h; iy++) {
-              const T y = roi_ymin + ph * bin_size_h +
-                          static_cast<T>(iy + .5f) * bin_size_h /
-                              static_cast<T>(roi_bin_grid_h);
-              for (int ix = 0; ix < roi_bin_grid_w; ix++) {
-                const T x = roi_xmin + pw * bin_size_w +
-                            static_cast<T>(ix + .5f) * bin_size_w /
-                                static_cast<T>(roi_bin_grid_w);
-                bilinear_interpolate_gradient(height, width, y, x,
-                                              out_grad_this_bin, count,
-                                              batch_grad_data);
+      grids[n] = GetROIAlignGrid(rois_data + n * roi_stride[0], spatial_scale,
+                                 pooled_height, pooled_width, sampling_ratio);
+      bin_samples[n] =
+          grids[n].roi_bin_grid_h * grids[n].roi_bin_grid_w * kROISize;
+      offsets[n + 1] = offsets[n] + pooled_size * bin_samples[n];
+    }
+    std::vector<int> pre_pos(offsets[rois_num]);
+    std::vector<T> pre_w(offsets[rois_num]);
+    dev_ctx.ParallelFor(
+        rois_num,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t n = begin; n < end; ++n) {
+            PreCalcForBilinearInterpolate(
+                height, width, pooled_height, pooled_width, grids[n],
+                pre_pos.data() + offsets[n], pre_w.data() + offsets[n]);
+          }
+        },
+        pooled_size * kROISize);
+
+    // The ROIs of an image overlap, so the channels are run in parallel,
+    // whose gradients are disjoint.
+    dev_ctx.ParallelFor(
+        channels,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t c = begin; c < end; ++c) {
+            for (int n = 0; n < rois_num; ++n) {
+              T* batch_grad_data = in_grad_data +
+                                   roi_batch_ids[n] * in_stride[0] +
+                                   c * in_stride[1];
+              const T* batch_out_grad_data =
+                  out_grad_data + n * out_stride[0] + c * out_stride[1];
+              const int* pos = pre_pos.data() + offsets[n];
+              const T* w = pre_w.data() + offsets[n];
+              for (int pool_index = 0; pool_index < pooled_size;
+                   ++pool_index) {
+                const T out_grad_this_bin = batch_out_grad_data[pool_index];
+                for (int i = 0; i < bin_samples[n]; ++i) {
+                  batch_grad_data[pos[i]] += w[i] * out_grad_this_bin;
+                }
+                pos += bin_samples[n];
+                w += bin_samples[n];
               }
             }
           }
-        }
-      }
-      rois_data += roi_stride[0];
-    }
+        },
+        static_cast<int64_t>(offsets[rois_num]));
   }
 };
 }  // namespace operators
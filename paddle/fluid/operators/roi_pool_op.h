@@ -14,7 +14,9 @@ limitations under the License. */
 
 #pragma once
 #include <algorithm>
+#include <array>
 #include <limits>
+#include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/math_function.h"
 
@@ -73,72 +75,84 @@ class CPUROIPoolOpKernel : public framework::OpKernel<T> {
     int64_t* argmax_data = argmax->mutable_data<int64_t>(ctx.GetPlace());
 
     const T* rois_data = rois->data<T>();
-    for (int n = 0; n < rois_num; ++n) {
-      int roi_batch_id = roi_batch_id_data[n];
-      int roi_start_w = round(rois_data[0] * spatial_scale);
-      int roi_start_h = round(rois_data[1] * spatial_scale);
-      int roi_end_w = round(rois_data[2] * spatial_scale);
-      int roi_end_h = round(rois_data[3] * spatial_scale);
-
-      // Force malformed ROIs to be 1x1
-      int roi_height = std::max(roi_end_h - roi_start_h + 1, 1);
-      int roi_width = std::max(roi_end_w - roi_start_w + 1, 1);
-
-      const float bin_size_h =
-          static_cast<float>(roi_height) / static_cast<float>(pooled_height);
-      const float bin_size_w =
-          static_cast<float>(roi_width) / static_cast<float>(pooled_width);
-
-      const T* batch_data = input_data + roi_batch_id * in_stride[0];
-
-      for (int c = 0; c < channels; ++c) {
-        for (int ph = 0; ph < pooled_height; ++ph) {
-          for (int pw = 0; pw < pooled_width; ++pw) {
-            //  Compute pooling region for this output unit:
-            //  start (included) = floor(ph * roi_height / pooled_height_)
-            //  end (excluded) = ceil((ph + 1) * roi_height / pooled_height_)
-            int hstart =
-                static_cast<int>(floor(static_cast<float>(ph) * bin_size_h));
-            int wstart =
-                static_cast<int>(floor(static_cast<float>(pw) * bin_size_w));
-            int hend =
-                static_cast<int>(ceil(static_cast<float>(ph + 1) * bin_size_h));
-            int wend =
-                static_cast<int>(ceil(static_cast<float>(pw + 1) * bin_size_w));
-
-            hstart = std::min(std::max(hstart + roi_start_h, 0), height);
-            hend = std::min(std::max(hend + roi_start_h, 0), height);
-            wstart = std::min(std::max(wstart + roi_start_w, 0), width);
-            wend = std::min(std::max(wend + roi_start_w, 0), width);
-
-            const int pool_index = ph * pooled_width + pw;
-
-            // Define an empty pooling region to be zero
-            bool is_empty = (hend <= hstart) || (wend <= wstart);
-            output_data[pool_index] =
-                is_empty ? 0 : -std::numeric_limits<T>::max();
-            argmax_data[pool_index] = -1;
-
-            for (int h = hstart; h < hend; ++h) {
-              for (int w = wstart; w < wend; ++w) {
-                const int index = h * width + w;
-                if (batch_data[index] > output_data[pool_index]) {
-                  output_data[pool_index] = batch_data[index];
-                  argmax_data[pool_index] = index;
+    const int pooled_size = pooled_height * pooled_width;
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    // The ROIs are run by the intra-op thread pool, the pooling regions of
+    // the bins of a ROI are calculated once for all the channels.
+    dev_ctx.ParallelFor(
+        rois_num,
+        [&](int64_t begin, int64_t end) {
+          std::vector<std::array<int, kROISize>> bins(pooled_size);
+          for (int64_t n = begin; n < end; ++n) {
+            const T* roi = rois_data + n * roi_stride[0];
+            int roi_start_w = round(roi[0] * spatial_scale);
+            int roi_start_h = round(roi[1] * spatial_scale);
+            int roi_end_w = round(roi[2] * spatial_scale);
+            int roi_end_h = round(roi[3] * spatial_scale);
+
+            // Force malformed ROIs to be 1x1
+            int roi_height = std::max(roi_end_h - roi_start_h + 1, 1);
+            int roi_width = std::max(roi_end_w - roi_start_w + 1, 1);
+
+            const float bin_size_h = static_cast<float>(roi_height) /
+                                     static_cast<float>(pooled_height);
+            const float bin_size_w = static_cast<float>(roi_width) /
+                                     static_cast<float>(pooled_width);
+
+            for (int ph = 0; ph < pooled_height; ++ph) {
+              for (int pw = 0; pw < pooled_width; ++pw) {
+                //  Compute pooling region for this output unit:
+                //  start (included) = floor(ph * roi_height / pooled_height_)
+                //  end (excluded) = ceil((ph + 1) * roi_height /
+                //  pooled_height_)
+                int hstart = static_cast<int>(
+                    floor(static_cast<float>(ph) * bin_size_h));
+                int wstart = static_cast<int>(
+                    floor(static_cast<float>(pw) * bin_size_w));
+                int hend = static_cast<int>(
+                    ceil(static_cast<float>(ph + 1) * bin_size_h));
+                int wend = static_cast<int>(
+                    ceil(static_cast<float>(pw + 1) * bin_size_w));
+
+                auto& bin = bins[ph * pooled_width + pw];
+                bin[0] = std::min(std::max(hstart + roi_start_h, 0), height);
+                bin[1] = std::min(std::max(hend + roi_start_h, 0), height);
+                bin[2] = std::min(std::max(wstart + roi_start_w, 0), width);
+                bin[3] = std::min(std::max(wend + roi_start_w, 0), width);
+              }
+            }
+
+            const T* batch_data =
+                input_data + roi_batch_id_data[n] * in_stride[0];
+            for (int c = 0; c < channels; ++c) {
+              const T* channel_data = batch_data + c * in_stride[1];
+              T* channel_output_data =
+                  output_data + n * out_stride[0] + c * out_stride[1];
+              int64_t* channel_argmax_data =
+                  argmax_data + n * argmax_stride[0] + c * argmax_stride[1];
+              for (int pool_index = 0; pool_index < pooled_size;
+                   ++pool_index) {
+                const auto& bin = bins[pool_index];
+                // Define an empty pooling region to be zero
+                bool is_empty = (bin[1] <= bin[0]) || (bin[3] <= bin[2]);
+                T max_val = is_empty ? 0 : -std::numeric_limits<T>::max();
+                int64_t max_index = -1;
+                for (int h = bin[0]; h < bin[1]; ++h) {
+                  const T* row = channel_data + h * width;
+                  for (int w = bin[2]; w < bin[3]; ++w) {
+                    if (row[w] > max_val) {
+                      max_val = row[w];
+                      max_index = h * width + w;
+                    }
+                  }
                 }
+                channel_output_data[pool_index] = max_val;
+                channel_argmax_data[pool_index] = max_index;
               }
             }
           }
-        }
-
-        batch_data += in_stride[1];
-        output_data += out_stride[1];
-        argmax_data += argmax_stride[1];
-      }
-      // Increment ROI data pointer
-      rois_data += roi_stride[0];
-    }
-    return;
+        },
+        static_cast<int64_t>(channels) * out_stride[1]);
   }
 };
 
@@ -171,7 +185,6 @@ class CPUROIPoolGradOpKernel : public framework::OpKernel<T> {
         }
       }
 
-      const T* rois_data = rois->data<T>();
       const T* out_grad_data = out_grad->data<T>();
       const int64_t* argmax_data = argmax->data<int64_t>();
       T* in_grad_data = in_grad->mutable_data<T>(ctx.GetPlace());
@@ -181,30 +194,37 @@ class CPUROIPoolGradOpKernel : public framework::OpKernel<T> {
 
       auto in_stride = framework::stride(in->dims());
       auto argmax_stride = framework::stride(argmax->dims());
-      auto roi_stride = framework::stride(rois->dims());
       auto out_stride = framework::stride(out_grad->dims());
 
       int channels = in->dims()[1];
 
-      for (int n = 0; n < rois_num; ++n) {
-        int roi_batch_idx = roi_batch_id_data[n];
-        T* batch_grad_data = in_grad_data + roi_batch_idx * in_stride[0];
-        for (int c = 0; c < channels; ++c) {
-          for (int ph = 0; ph < pooled_height; ++ph) {
-            for (int pw = 0; pw < pooled_width; ++pw) {
-              int pool_index = ph * pooled_width + pw;
-              if (argmax_data[pool_index] >= 0) {
-                auto index = argmax_data[pool_index];
-                batch_grad_data[index] += out_grad_data[pool_index];
+      // The ROIs of an image overlap, so the channels are run by the
+      // intra-op thread pool, whose gradients are disjoint.
+      auto& dev_ctx = ctx.template device_context<DeviceContext>();
+      const int pooled_size = pooled_height * pooled_width;
+      dev_ctx.ParallelFor(
+          channels,
+          [&](int64_t begin, int64_t end) {
+            for (int64_t c = begin; c < end; ++c) {
+              for (int n = 0; n < rois_num; ++n) {
+                T* batch_grad_data = in_grad_data +
+                                     roi_batch_id_data[n] * in_stride[0] +
+                                     c * in_stride[1];
+                const T* batch_out_grad_data =
+                    out_grad_data + n * out_stride[0] + c * out_stride[1];
+                const int64_t* batch_argmax_data =
+                    argmax_data + n * argmax_stride[0] + c * argmax_stride[1];
+                for (int pool_index = 0; pool_index < pooled_size;
+                     ++pool_index) {
+                  if (batch_argmax_data[pool_index] >= 0) {
+                    auto index = batch_argmax_data[pool_index];
+                    batch_grad_data[index] += batch_out_grad_data[pool_index];
+                  }
+                }
               }
             }
-          }
-          batch_grad_data += in_stride[1];
-          out_grad_data += out_stride[1];
-          argmax_data += argmax_stride[1];
-        }
-        rois_data += roi_stride[0];
-      }
+          },
+          static_cast<int64_t>(rois_num) * pooled_size);
     }
   }
 };
@@ -13,7 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/row_conv_op.h"
-#include "paddle/fluid/framework/eigen.h"
+#include <algorithm>
 
 namespace paddle {
 namespace operators {
@@ -21,10 +21,6 @@ namespace operators {
 using LoDTensor = framework::LoDTensor;
 using framework::Tensor;
 
-template <typename T, int MajorType = Eigen::RowMajor,
-          typename IndexType = Eigen::DenseIndex>
-using EigenMatrix = framework::EigenMatrix<T, MajorType, IndexType>;
-
 class RowConvOp : public framework::OperatorWithKernel {
  public:
   using framework::OperatorWithKernel::OperatorWithKernel;
@@ -135,6 +131,9 @@ https://github.com/PaddlePaddle/Paddle/issues/2228#issuecomment-303903645 .
   }
 };
 
+// The kernels work on the rows of the LoD batch directly, every time step
+// accumulates the weighted future rows with the contiguous loops over the
+// feature dimension, which the compiler vectorizes.
 template <typename T>
 class RowConvKernel<platform::CPUDeviceContext, T>
     : public framework::OpKernel<T> {
@@ -144,36 +143,27 @@ class RowConvKernel<platform::CPUDeviceContext, T>
     auto *filter = context.Input<Tensor>("Filter");
     auto *out = context.Output<LoDTensor>("Out");
 
-    out->mutable_data<T>(context.GetPlace());
+    T *out_data = out->mutable_data<T>(context.GetPlace());
+    const T *in_data = x->data<T>();
+    const T *weights = filter->data<T>();
 
     auto batch_indices = x->lod()[0];
-    auto input_dim = x->dims()[1];  // 'in' is of size T x N
+    int input_dim = static_cast<int>(x->dims()[1]);  // 'in' is of size T x N
     size_t num_sequence = batch_indices.size() - 1;
+    int future_context = static_cast<int>(filter->dims()[0]);
 
-    auto future_context = filter->dims()[0];
-    auto weights = EigenMatrix<T>::From(*filter);
-
+    std::fill(out_data, out_data + x->numel(), static_cast<T>(0));
     for (size_t i = 0; i < num_sequence; i++) {
       int start = static_cast<int>(batch_indices[i]);
       int end = static_cast<int>(batch_indices[i + 1]);
-      int current_timesteps = end - start;
-      Tensor cur_input_sequence =
-          x->Slice(start, end);  // Current input sequence
-      Tensor cur_output_sequence =
-          out->Slice(start, end);  // Current output sequence
-      auto cip_seq = EigenMatrix<T>::From(cur_input_sequence);
-      auto cot_seq = EigenMatrix<T>::From(cur_output_sequence);
-
-      for (int k = 0; k < current_timesteps;
-           k++) {  // For different time steps in the same sequence
-        for (int w = 0; (w < future_context) && ((k + w) < current_timesteps);
-             w++) {
+      for (int k = start; k < end; k++) {
+        T *cur_out = out_data + k * input_dim;
+        int context = std::min(future_context, end - k);
+        for (int w = 0; w < context; w++) {
+          const T *cur_in = in_data + (k + w) * input_dim;
+          const T *cur_weights = weights + w * input_dim;
           for (int d = 0; d < input_dim; d++) {
-            if (w == 0) {
-              cot_seq(k, d) = weights(w, d) * cip_seq(k + w, d);
-            } else {
-              cot_seq(k, d) += weights(w, d) * cip_seq(k + w, d);
-            }
+            cur_out[d] += cur_weights[d] * cur_in[d];
           }
         }
       }
@@ -192,36 +182,29 @@ class RowConvGradKernel<platform::CPUDeviceContext, T>
     auto *dx = context.Output<LoDTensor>(framework::GradVarName("X"));
     auto *d_filter = context.Output<Tensor>(framework::GradVarName("Filter"));
 
-    auto input_dim = x->dims()[1];  // 'x' is of size T x N
+    int input_dim = static_cast<int>(x->dims()[1]);  // 'x' is of size T x N
     auto batch_indices = x->lod()[0];
     size_t num_sequence = batch_indices.size() - 1;
-    auto future_context = filter->dims()[0];
+    int future_context = static_cast<int>(filter->dims()[0]);
+    const T *in_data = x->data<T>();
+    const T *dout_data = d_out->data<T>();
 
     if (d_filter) {
-      d_filter->mutable_data<T>(context.GetPlace());
-      auto dweights =
-          EigenMatrix<T>::From(*d_filter);  // Gradient of weight matrix
-      dweights.setZero();
+      // Gradient of weight matrix
+      T *dweights = d_filter->mutable_data<T>(context.GetPlace());
+      std::fill(dweights, dweights + d_filter->numel(), static_cast<T>(0));
 
       for (size_t i = 0; i < num_sequence; i++) {  // For different sequences
         int start = static_cast<int>(batch_indices[i]);
         int end = static_cast<int>(batch_indices[i + 1]);
-
-        Tensor cur_input = x->Slice(start, end);  // Current input sequence
-        Tensor cur_doutput =
-            d_out->Slice(start, end);  // Current output grad sequence
-
-        auto cur_ip = EigenMatrix<T>::From(cur_input);
-        auto cur_dout = EigenMatrix<T>::From(cur_doutput);
-        int current_timesteps = end - start;
-
-        for (int k = 0; k < current_timesteps;
-             k++) {  // For different time steps in the same sequence
-          for (int w = 0; (w < future_context) && ((k + w) < current_timesteps);
-               w++) {
-            // For dweights (Updating the gradient of weight matrix)
+        for (int k = start; k < end; k++) {
+          const T *cur_dout = dout_data + k * input_dim;
+          int context = std::min(future_context, end - k);
+          for (int w = 0; w < context; w++) {
+            const T *cur_in = in_data + (k + w) * input_dim;
+            T *cur_dweights = dweights + w * input_dim;
             for (int d = 0; d < input_dim; d++) {
-              dweights(w, d) += cur_ip(k + w, d) * cur_dout(k, d);
+              cur_dweights[d] += cur_in[d] * cur_dout[d];
             }
           }
         }
@@ -229,29 +212,22 @@ class RowConvGradKernel<platform::CPUDeviceContext, T>
     }
 
     if (dx) {
-      dx->mutable_data<T>(context.GetPlace());
-      auto weights = EigenMatrix<T>::From(*filter);
+      // Gradient wrt input
+      T *din_data = dx->mutable_data<T>(context.GetPlace());
+      const T *weights = filter->data<T>();
+      std::fill(din_data, din_data + dx->numel(), static_cast<T>(0));
+
       for (size_t i = 0; i < num_sequence; i++) {  // For different sequences
         int start = static_cast<int>(batch_indices[i]);
         int end = static_cast<int>(batch_indices[i + 1]);
-
-        Tensor cur_doutput =
-            d_out->Slice(start, end);  // Current output grad sequence
-        Tensor cur_dinput =
-            dx->Slice(start, end);  // Current input grad sequence
-
-        auto cur_dout = EigenMatrix<T>::From(cur_doutput);
-        auto cur_dip = EigenMatrix<T>::From(cur_dinput);
-        cur_dip.setZero();
-        int current_timesteps = end - start;
-
-        for (int k = 0; k < current_timesteps;
-             k++) {  // For different time steps in the same sequence
-          for (int w = 0; (w < future_context) && ((k + w) < current_timesteps);
-               w++) {
-            // For dinput (Updating the gradient wrt input)
+        for (int k = start; k < end; k++) {
+          const T *cur_dout = dout_data + k * input_dim;
+          int context = std::min(future_context, end - k);
+          for (int w = 0; w < context; w++) {
+            T *cur_din = din_data + (k + w) * input_dim;
+            const T *cur_weights = weights + w * input_dim;
             for (int d = 0; d < input_dim; d++) {
-              cur_dip(k + w, d) += weights(w, d) * cur_dout(k, d);
+              cur_din[d] += cur_weights[d] * cur_dout[d];
             }
           }
         }
@@ -0,0 +1,215 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/sampled_softmax_with_cross_entropy_op.h"
+
+#include <vector>
+
+namespace paddle {
+namespace operators {
+
+class SampledSoftmaxWithCrossEntropyOp
+    : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("Input"), "Input(Input) should be not null.");
+    PADDLE_ENFORCE(ctx->HasInput("Label"), "Input(Label) should be not null.");
+    PADDLE_ENFORCE(ctx->HasInput("Weight"),
+                   "Input(Weight) should be not null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Loss"), "Output(Loss) should be not null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Softmax"),
+                   "Output(Softmax) should be not null.");
+    PADDLE_ENFORCE(ctx->HasOutput("SampledLabels"),
+                   "Output(SampledLabels) should be not null.");
+
+    auto x_dims = ctx->GetInputDim("Input");
+    auto label_dims = ctx->GetInputDim("Label");
+    auto w_dims = ctx->GetInputDim("Weight");
+    PADDLE_ENFORCE_EQ(x_dims.size(), 2, "The rank of Input(Input) must be 2.");
+    PADDLE_ENFORCE_EQ(label_dims.size(), 2,
+                      "The rank of Input(Label) must be 2.");
+    PADDLE_ENFORCE_EQ(label_dims[1], 1,
+                      "Only one true label per sample is supported.");
+    PADDLE_ENFORCE_EQ(x_dims[0], label_dims[0],
+                      "Input(Input) and Input(Label) must have the same "
+                      "batch size.");
+    PADDLE_ENFORCE_EQ(x_dims[1], w_dims[1],
+                      "Input(Input) and Input(Weight) must have the same "
+                      "feature size.");
+    auto num_total_classes = ctx->Attrs().Get<int>("num_total_classes");
+    auto num_samples = ctx->Attrs().Get<int>("num_samples");
+    PADDLE_ENFORCE_EQ(num_total_classes, w_dims[0]);
+    PADDLE_ENFORCE_GT(num_samples, 0);
+    if (ctx->HasInput("Bias")) {
+      PADDLE_ENFORCE_EQ(w_dims[0], ctx->GetInputDim("Bias")[0]);
+    }
+    auto custom_neg_classes =
+        ctx->Attrs().Get<std::vector<int>>("custom_neg_classes");
+    if (custom_neg_classes.size() > 0) {
+      PADDLE_ENFORCE_EQ(custom_neg_classes.size(),
+                        static_cast<size_t>(num_samples));
+    }
+
+    ctx->SetOutputDim("Loss", {x_dims[0], 1});
+    ctx->SetOutputDim("Softmax", {x_dims[0], num_samples + 1});
+    ctx->SetOutputDim("SampledLabels", {x_dims[0], num_samples + 1});
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        framework::ToDataType(ctx.Input<Tensor>("Input")->type()),
+        ctx.GetPlace());
+  }
+};
+
+class SampledSoftmaxWithCrossEntropyOpMaker
+    : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Input", "(Tensor) A tensor of shape [batch_size, dim].");
+    AddInput("Label",
+             "(Tensor) A tensor of shape [batch_size, 1] in int64 type, "
+             "the true class of each sample.");
+    AddInput("Weight",
+             "(Tensor) A tensor of shape [num_total_classes, dim], the "
+             "weight of the output layer.");
+    AddInput("Bias",
+             "(Tensor) A tensor of shape [num_total_classes, 1], the bias "
+             "of the output layer. It is a dispensable input.")
+        .AsDispensable();
+    AddOutput("Loss",
+              "(Tensor) A tensor of shape [batch_size, 1]. The sampled "
+              "softmax cross entropy of the samples.");
+    AddOutput("Softmax",
+              "An intermediate tensor of shape [batch_size, num_samples + 1], "
+              "the softmax of the logits of the true and the sampled classes. "
+              "It is used in backward kernel to compute grads.")
+        .AsIntermediate();
+    AddOutput("SampledLabels",
+              "An intermediate tensor of shape [batch_size, num_samples + 1] "
+              "in int64 type. The first column is the true class and the "
+              "others are the sampled classes of each sample.")
+        .AsIntermediate();
+    AddAttr<int>("num_total_classes",
+                 "Total number of classes in all samples.");
+    AddAttr<int>("num_samples",
+                 "The number of classes sampled for each sample. The default "
+                 "value is 10.")
+        .SetDefault(10);
+    AddAttr<std::vector<int>>("custom_neg_classes",
+                              "This attribute only be used in unitest. Classes "
+                              "in this list wiil be used as sampled classes "
+                              "for every samples. Under normal conditions, "
+                              "user should avoid setting this attribute.")
+        .SetDefault({});
+    AddAttr<int>("seed",
+                 "Random seed of the sampler. 0 means use a seed generated "
+                 "by the system.")
+        .SetDefault(0);
+    AddAttr<bool>("is_sparse",
+                  "(boolean, default false) "
+                  "Sparse update. If true, the gradient of Weight is a "
+                  "SelectedRows of the sampled classes.")
+        .SetDefault(false);
+    AddComment(R"DOC(
+Sampled Softmax With Cross Entropy Operator.
+
+Computes the softmax cross entropy of the true class against num_samples
+classes drawn for each sample from the log-uniform (Zipfian) distribution
+    P(c) = (log(c + 2) - log(c + 1)) / log(num_total_classes + 1),
+instead of all the num_total_classes classes. The classes should be sorted
+by their frequencies in descending order. The logit of a sampled class c is
+corrected by subtracting log(num_samples * P(c)), see `On Using Very Large
+Target Vocabulary for Neural Machine Translation
+<https://arxiv.org/abs/1412.2007>`_. The sampled classes may contain the
+true class.
+)DOC");
+  }
+};
+
+class SampledSoftmaxWithCrossEntropyOpGrad
+    : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("Input"));
+    PADDLE_ENFORCE(ctx->HasInput("Weight"));
+    PADDLE_ENFORCE(ctx->HasInput("Softmax"));
+    PADDLE_ENFORCE(ctx->HasInput("SampledLabels"));
+    PADDLE_ENFORCE(ctx->HasInput(framework::GradVarName("Loss")),
+                   "The input(Loss@GRAD) should not be null.");
+
+    auto x_grad_name = framework::GradVarName("Input");
+    if (ctx->HasOutput(x_grad_name)) {
+      ctx->SetOutputDim(x_grad_name, ctx->GetInputDim("Input"));
+    }
+    auto w_grad_name = framework::GradVarName("Weight");
+    if (ctx->HasOutput(w_grad_name)) {
+      ctx->SetOutputDim(w_grad_name, ctx->GetInputDim("Weight"));
+    }
+    auto bias_grad_name = framework::GradVarName("Bias");
+    if (ctx->HasOutput(bias_grad_name)) {
+      ctx->SetOutputDim(bias_grad_name, ctx->GetInputDim("Bias"));
+    }
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        framework::ToDataType(ctx.Input<Tensor>("Input")->type()),
+        ctx.GetPlace());
+  }
+};
+
+class SampledSoftmaxWithCrossEntropyOpGradVarTypeInference
+    : public framework::VarTypeInference {
+ public:
+  void operator()(const framework::OpDesc& op_desc,
+                  framework::BlockDesc* block) const override {
+    auto weight_grad = op_desc.Output(framework::GradVarName("Weight"));
+    if (weight_grad.empty()) return;
+    auto& weight_grad_name = weight_grad.front();
+    bool is_sparse = boost::get<bool>(op_desc.GetAttr("is_sparse"));
+    block->Var(weight_grad_name)
+        ->SetType(is_sparse ? framework::proto::VarType::SELECTED_ROWS
+                            : framework::proto::VarType::LOD_TENSOR);
+    block->Var(weight_grad_name)
+        ->SetDataType(
+            block->Var(op_desc.Input("Weight").front())->GetDataType());
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(sampled_softmax_with_cross_entropy,
+                  ops::SampledSoftmaxWithCrossEntropyOp,
+                  ops::SampledSoftmaxWithCrossEntropyOpMaker,
+                  paddle::framework::DefaultGradOpDescMaker<true>);
+REGISTER_OPERATOR(sampled_softmax_with_cross_entropy_grad,
+                  ops::SampledSoftmaxWithCrossEntropyOpGrad,
+                  ops::SampledSoftmaxWithCrossEntropyOpGradVarTypeInference);
+REGISTER_OP_CPU_KERNEL(sampled_softmax_with_cross_entropy,
+                       ops::SampledSoftmaxWithCrossEntropyKernel<float>,
+                       ops::SampledSoftmaxWithCrossEntropyKernel<double>);
+REGISTER_OP_CPU_KERNEL(sampled_softmax_with_cross_entropy_grad,
+                       ops::SampledSoftmaxWithCrossEntropyGradKernel<float>,
+                       ops::SampledSoftmaxWithCrossEntropyGradKernel<double>);
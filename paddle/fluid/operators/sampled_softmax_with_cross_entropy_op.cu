@@ -0,0 +1,286 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <thrust/random.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/sampled_softmax_with_cross_entropy_op.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+namespace {
+
+#define CUDA_1D_KERNEL_LOOP(i, n)                              \
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < (n); \
+       i += blockDim.x * gridDim.x)
+
+int const kNumCUDAThreads = 512;
+int const kNumMaxinumBlocks = 4096;
+
+static inline int NumBlocks(const int n) {
+  return std::min((n + kNumCUDAThreads - 1) / kNumCUDAThreads,
+                  kNumMaxinumBlocks);
+}
+
+// The true label first, then the custom or log-uniformly sampled classes.
+template <typename T>
+__global__ void SampleLabelsKernel(const int64_t *label, const int *custom_neg,
+                                   const int num, const int width,
+                                   const int num_total_classes,
+                                   const T log_range, const unsigned int seed,
+                                   int64_t *sampled_labels) {
+  CUDA_1D_KERNEL_LOOP(idx, num) {
+    const int j = idx % width;
+    if (j == 0) {
+      sampled_labels[idx] = label[idx / width];
+    } else if (custom_neg) {
+      sampled_labels[idx] = custom_neg[j - 1];
+    } else {
+      thrust::minstd_rand rng;
+      rng.seed(seed);
+      thrust::uniform_real_distribution<T> dist(0, 1);
+      rng.discard(idx);
+      sampled_labels[idx] =
+          LogUniformSample(dist(rng), log_range, num_total_classes);
+    }
+  }
+}
+
+template <typename T>
+__global__ void SampledLogitsKernel(const int64_t *sampled_labels, const T *x,
+                                    const T *weight, const T *bias,
+                                    const int num, const int width,
+                                    const int dim, const T log_range,
+                                    T *logits) {
+  CUDA_1D_KERNEL_LOOP(idx, num) {
+    logits[idx] = SampledLogit(x + (idx / width) * dim, weight, bias,
+                               sampled_labels[idx], dim, width - 1,
+                               log_range);
+  }
+}
+
+template <typename T>
+__global__ void SoftmaxWithCrossEntropyKernel(const int batch_size,
+                                              const int width, T *softmax,
+                                              T *loss) {
+  CUDA_1D_KERNEL_LOOP(i, batch_size) {
+    loss[i] = SoftmaxWithCrossEntropy(softmax + i * width, width);
+  }
+}
+
+template <typename T>
+__global__ void LogitsGradKernel(const T *softmax, const T *loss_grad,
+                                 const int num, const int width,
+                                 T *logits_grad) {
+  CUDA_1D_KERNEL_LOOP(idx, num) {
+    const T label = idx % width == 0 ? static_cast<T>(1.0) : 0;
+    logits_grad[idx] = loss_grad[idx / width] * (softmax[idx] - label);
+  }
+}
+
+template <typename T>
+__global__ void BiasGradKernel(const int64_t *sampled_labels,
+                               const T *logits_grad, const int num,
+                               T *bias_grad) {
+  CUDA_1D_KERNEL_LOOP(idx, num) {
+    platform::CudaAtomicAdd(bias_grad + sampled_labels[idx], logits_grad[idx]);
+  }
+}
+
+template <typename T>
+__global__ void WeightGradKernel(const int64_t *sampled_labels,
+                                 const T *logits_grad, const T *x,
+                                 const int num, const int width, const int dim,
+                                 T *weight_grad) {
+  CUDA_1D_KERNEL_LOOP(idx, num * dim) {
+    const int s = idx / dim;
+    const int k = idx % dim;
+    platform::CudaAtomicAdd(weight_grad + sampled_labels[s] * dim + k,
+                            logits_grad[s] * x[(s / width) * dim + k]);
+  }
+}
+
+template <typename T>
+__global__ void SparseWeightGradKernel(const T *logits_grad, const T *x,
+                                       const int num, const int width,
+                                       const int dim, T *weight_grad) {
+  CUDA_1D_KERNEL_LOOP(idx, num * dim) {
+    const int s = idx / dim;
+    weight_grad[idx] = logits_grad[s] * x[(s / width) * dim + idx % dim];
+  }
+}
+
+template <typename T>
+__global__ void InputGradKernel(const int64_t *sampled_labels,
+                                const T *logits_grad, const T *weight,
+                                const int batch_size, const int width,
+                                const int dim, T *x_grad) {
+  CUDA_1D_KERNEL_LOOP(idx, batch_size * dim) {
+    const int i = idx / dim;
+    const int k = idx % dim;
+    T sum = static_cast<T>(0.0);
+    for (int j = 0; j < width; ++j) {
+      const int s = i * width + j;
+      sum += logits_grad[s] * weight[sampled_labels[s] * dim + k];
+    }
+    x_grad[idx] = sum;
+  }
+}
+
+}  // namespace
+
+template <typename T>
+class SampledSoftmaxWithCrossEntropyCUDAKernel
+    : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *input = context.Input<Tensor>("Input");
+    auto *label = context.Input<Tensor>("Label");
+    auto *weight = context.Input<Tensor>("Weight");
+    auto *bias = context.Input<Tensor>("Bias");
+    auto *sampled_labels = context.Output<Tensor>("SampledLabels");
+    auto *softmax = context.Output<Tensor>("Softmax");
+    auto *loss = context.Output<Tensor>("Loss");
+    int num_total_classes = context.Attr<int>("num_total_classes");
+    int num_samples = context.Attr<int>("num_samples");
+    std::vector<int> custom_neg_classes =
+        context.Attr<std::vector<int>>("custom_neg_classes");
+    unsigned int seed = static_cast<unsigned int>(context.Attr<int>("seed"));
+    if (seed == 0) {
+      std::random_device rd;
+      seed = rd();
+    }
+    auto stream =
+        context.template device_context<platform::CUDADeviceContext>()
+            .stream();
+
+    int batch_size = static_cast<int>(input->dims()[0]);
+    int dim = static_cast<int>(input->dims()[1]);
+    int width = num_samples + 1;
+    int num = batch_size * width;
+    const T log_range = log(static_cast<T>(num_total_classes + 1));
+
+    framework::Vector<int> custom_neg(custom_neg_classes);
+    auto *labels_data =
+        sampled_labels->mutable_data<int64_t>(context.GetPlace());
+    SampleLabelsKernel<T><<<NumBlocks(num), kNumCUDAThreads, 0, stream>>>(
+        label->data<int64_t>(),
+        custom_neg_classes.empty() ? nullptr
+                                   : custom_neg.CUDAData(context.GetPlace()),
+        num, width, num_total_classes, log_range, seed, labels_data);
+
+    auto *softmax_data = softmax->mutable_data<T>(context.GetPlace());
+    SampledLogitsKernel<T><<<NumBlocks(num), kNumCUDAThreads, 0, stream>>>(
+        labels_data, input->data<T>(), weight->data<T>(),
+        bias ? bias->data<T>() : nullptr, num, width, dim, log_range,
+        softmax_data);
+    SoftmaxWithCrossEntropyKernel<
+        T><<<NumBlocks(batch_size), kNumCUDAThreads, 0, stream>>>(
+        batch_size, width, softmax_data,
+        loss->mutable_data<T>(context.GetPlace()));
+  }
+};
+
+template <typename T>
+class SampledSoftmaxWithCrossEntropyGradCUDAKernel
+    : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *input = context.Input<Tensor>("Input");
+    auto *weight = context.Input<Tensor>("Weight");
+    auto *sampled_labels = context.Input<Tensor>("SampledLabels");
+    auto *softmax = context.Input<Tensor>("Softmax");
+    auto *d_loss = context.Input<Tensor>(framework::GradVarName("Loss"));
+    auto &dev_ctx =
+        context.template device_context<platform::CUDADeviceContext>();
+    auto stream = dev_ctx.stream();
+    math::SetConstant<platform::CUDADeviceContext, T> zero;
+
+    int batch_size = static_cast<int>(input->dims()[0]);
+    int dim = static_cast<int>(input->dims()[1]);
+    int width = static_cast<int>(sampled_labels->dims()[1]);
+    int num = batch_size * width;
+    const int64_t *labels_data = sampled_labels->data<int64_t>();
+
+    Tensor logits_grad;
+    auto *logits_grad_data =
+        logits_grad.mutable_data<T>(sampled_labels->dims(), context.GetPlace());
+    LogitsGradKernel<T><<<NumBlocks(num), kNumCUDAThreads, 0, stream>>>(
+        softmax->data<T>(), d_loss->data<T>(), num, width, logits_grad_data);
+
+    auto *d_bias = context.Output<Tensor>(framework::GradVarName("Bias"));
+    if (d_bias != nullptr) {
+      d_bias->mutable_data<T>(context.GetPlace());
+      zero(dev_ctx, d_bias, static_cast<T>(0.0));
+      BiasGradKernel<T><<<NumBlocks(num), kNumCUDAThreads, 0, stream>>>(
+          labels_data, logits_grad_data, num, d_bias->data<T>());
+    }
+
+    if (context.Attr<bool>("is_sparse")) {
+      auto *d_w = context.Output<framework::SelectedRows>(
+          framework::GradVarName("Weight"));
+      if (d_w != nullptr) {
+        auto gpu_place = boost::get<platform::CUDAPlace>(context.GetPlace());
+        framework::Vector<int64_t> rows(num);
+        memory::Copy(gpu_place, rows.CUDAMutableData(context.GetPlace()),
+                     gpu_place, labels_data, num * sizeof(int64_t), stream);
+        d_w->set_rows(rows);
+        d_w->set_height(weight->dims()[0]);
+        auto *d_w_data = d_w->mutable_value()->mutable_data<T>(
+            framework::make_ddim(
+                {static_cast<int64_t>(num), static_cast<int64_t>(dim)}),
+            context.GetPlace());
+        SparseWeightGradKernel<T><<<NumBlocks(num * dim), kNumCUDAThreads, 0,
+                                    stream>>>(logits_grad_data,
+                                              input->data<T>(), num, width,
+                                              dim, d_w_data);
+      }
+    } else {
+      auto *d_w = context.Output<Tensor>(framework::GradVarName("Weight"));
+      if (d_w != nullptr) {
+        d_w->mutable_data<T>(context.GetPlace());
+        zero(dev_ctx, d_w, static_cast<T>(0.0));
+        WeightGradKernel<T><<<NumBlocks(num * dim), kNumCUDAThreads, 0,
+                              stream>>>(labels_data, logits_grad_data,
+                                        input->data<T>(), num, width, dim,
+                                        d_w->data<T>());
+      }
+    }
+
+    auto *d_x = context.Output<Tensor>(framework::GradVarName("Input"));
+    if (d_x != nullptr) {
+      InputGradKernel<T><<<NumBlocks(batch_size * dim), kNumCUDAThreads, 0,
+                           stream>>>(labels_data, logits_grad_data,
+                                     weight->data<T>(), batch_size, width, dim,
+                                     d_x->mutable_data<T>(context.GetPlace()));
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(sampled_softmax_with_cross_entropy,
+                        ops::SampledSoftmaxWithCrossEntropyCUDAKernel<float>,
+                        ops::SampledSoftmaxWithCrossEntropyCUDAKernel<double>);
+REGISTER_OP_CUDA_KERNEL(
+    sampled_softmax_with_cross_entropy_grad,
+    ops::SampledSoftmaxWithCrossEntropyGradCUDAKernel<float>,
+    ops::SampledSoftmaxWithCrossEntropyGradCUDAKernel<double>);
@@ -0,0 +1,234 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <math.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+/**
+ * Sample an integer from [0, range) by the log-uniform (Zipfian)
+ * distribution
+ *   P(x) = (1/ln(range+1)) * ln(1 + 1/(x + 1))
+ * from u, a uniform value in [0, 1), by the inverse transform sampling.
+ */
+template <typename T>
+HOSTDEVICE inline int64_t LogUniformSample(const T u, const T log_range,
+                                           const int64_t range) {
+  const int64_t value = static_cast<int64_t>(exp(u * log_range)) - 1;
+  // Mathematically, value should be < range, but might not be due to some
+  // floating point roundoff, so we mod by range.
+  return value % range;
+}
+
+template <typename T>
+HOSTDEVICE inline T LogUniformProbability(const int64_t value,
+                                          const T log_range) {
+  return log((value + static_cast<T>(2.0)) / (value + static_cast<T>(1.0))) /
+         log_range;
+}
+
+// logits(i, j) = input.row(i) * weight.row(l) + bias(l) - log(Q(l)), where
+// l = sampled_labels(i, j) and Q(l) = num_samples * P(l) is the expected
+// count of l in the samples.
+template <typename T>
+HOSTDEVICE inline T SampledLogit(const T* x_row, const T* weight,
+                                 const T* bias, const int64_t label,
+                                 const int dim, const int num_samples,
+                                 const T log_range) {
+  T logit = bias ? bias[label] : static_cast<T>(0.0);
+  const T* w_row = weight + label * dim;
+  for (int k = 0; k < dim; ++k) {
+    logit += x_row[k] * w_row[k];
+  }
+  return logit - log(num_samples * LogUniformProbability(label, log_range));
+}
+
+// Replaces the logits of a row with the softmax of them and returns the
+// cross entropy of the true label in the first column.
+template <typename T>
+HOSTDEVICE inline T SoftmaxWithCrossEntropy(T* logits, const int width) {
+  T max_logit = logits[0];
+  for (int j = 1; j < width; ++j) {
+    max_logit = logits[j] > max_logit ? logits[j] : max_logit;
+  }
+  const T true_logit = logits[0] - max_logit;
+  T sum = static_cast<T>(0.0);
+  for (int j = 0; j < width; ++j) {
+    logits[j] = exp(logits[j] - max_logit);
+    sum += logits[j];
+  }
+  const T loss = log(sum) - true_logit;
+  for (int j = 0; j < width; ++j) {
+    logits[j] /= sum;
+  }
+  return loss;
+}
+
+template <typename T>
+class SampledSoftmaxWithCrossEntropyKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto* input = context.Input<Tensor>("Input");
+    auto* label = context.Input<Tensor>("Label");
+    auto* weight = context.Input<Tensor>("Weight");
+    auto* bias = context.Input<Tensor>("Bias");
+    auto* sampled_labels = context.Output<Tensor>("SampledLabels");
+    auto* softmax = context.Output<Tensor>("Softmax");
+    auto* loss = context.Output<Tensor>("Loss");
+    int num_total_classes = context.Attr<int>("num_total_classes");
+    int num_samples = context.Attr<int>("num_samples");
+    std::vector<int> custom_neg_classes =
+        context.Attr<std::vector<int>>("custom_neg_classes");
+    unsigned int seed = static_cast<unsigned int>(context.Attr<int>("seed"));
+    if (seed == 0) {
+      std::random_device rd;
+      seed = rd();
+    }
+    std::minstd_rand engine(seed);
+    std::uniform_real_distribution<T> dist(0, 1);
+
+    int batch_size = static_cast<int>(input->dims()[0]);
+    int dim = static_cast<int>(input->dims()[1]);
+    int width = num_samples + 1;
+    const T log_range = log(static_cast<T>(num_total_classes + 1));
+    const int64_t* label_data = label->data<int64_t>();
+    const T* x_data = input->data<T>();
+    const T* w_data = weight->data<T>();
+    const T* bias_data = bias ? bias->data<T>() : nullptr;
+    auto* labels_data =
+        sampled_labels->mutable_data<int64_t>(context.GetPlace());
+    auto* softmax_data = softmax->mutable_data<T>(context.GetPlace());
+    auto* loss_data = loss->mutable_data<T>(context.GetPlace());
+
+    for (int i = 0; i < batch_size; ++i) {
+      int64_t* labels_row = labels_data + i * width;
+      T* softmax_row = softmax_data + i * width;
+      labels_row[0] = label_data[i];
+      for (int j = 1; j < width; ++j) {
+        labels_row[j] =
+            custom_neg_classes.empty()
+                ? LogUniformSample(dist(engine), log_range, num_total_classes)
+                : custom_neg_classes[j - 1];
+      }
+      for (int j = 0; j < width; ++j) {
+        softmax_row[j] = SampledLogit(x_data + i * dim, w_data, bias_data,
+                                      labels_row[j], dim, num_samples,
+                                      log_range);
+      }
+      loss_data[i] = SoftmaxWithCrossEntropy(softmax_row, width);
+    }
+  }
+};
+
+template <typename T>
+class SampledSoftmaxWithCrossEntropyGradKernel
+    : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto* input = context.Input<Tensor>("Input");
+    auto* weight = context.Input<Tensor>("Weight");
+    auto* sampled_labels = context.Input<Tensor>("SampledLabels");
+    auto* softmax = context.Input<Tensor>("Softmax");
+    auto* d_loss = context.Input<Tensor>(framework::GradVarName("Loss"));
+
+    int batch_size = static_cast<int>(input->dims()[0]);
+    int dim = static_cast<int>(input->dims()[1]);
+    int width = static_cast<int>(sampled_labels->dims()[1]);
+    int num = batch_size * width;
+    const int64_t* labels_data = sampled_labels->data<int64_t>();
+    const T* softmax_data = softmax->data<T>();
+    const T* d_loss_data = d_loss->data<T>();
+    const T* x_data = input->data<T>();
+    const T* w_data = weight->data<T>();
+
+    // the gradient of the logits
+    Tensor logits_grad;
+    T* logits_grad_data =
+        logits_grad.mutable_data<T>(sampled_labels->dims(), context.GetPlace());
+    for (int s = 0; s < num; ++s) {
+      logits_grad_data[s] =
+          d_loss_data[s / width] *
+          (softmax_data[s] - static_cast<T>(s % width == 0 ? 1.0 : 0.0));
+    }
+
+    auto* d_bias = context.Output<Tensor>(framework::GradVarName("Bias"));
+    if (d_bias != nullptr) {
+      T* d_bias_data = d_bias->mutable_data<T>(context.GetPlace());
+      std::fill(d_bias_data, d_bias_data + d_bias->numel(), 0.0);
+      for (int s = 0; s < num; ++s) {
+        d_bias_data[labels_data[s]] += logits_grad_data[s];
+      }
+    }
+
+    if (context.Attr<bool>("is_sparse")) {
+      // one row of the sparse gradient per sampled label
+      auto* d_w = context.Output<framework::SelectedRows>(
+          framework::GradVarName("Weight"));
+      if (d_w != nullptr) {
+        d_w->set_rows(std::vector<int64_t>(labels_data, labels_data + num));
+        d_w->set_height(weight->dims()[0]);
+        T* d_w_data = d_w->mutable_value()->mutable_data<T>(
+            framework::make_ddim({static_cast<int64_t>(num),
+                                  static_cast<int64_t>(dim)}),
+            context.GetPlace());
+        for (int s = 0; s < num; ++s) {
+          const T* x_row = x_data + (s / width) * dim;
+          for (int k = 0; k < dim; ++k) {
+            d_w_data[s * dim + k] = logits_grad_data[s] * x_row[k];
+          }
+        }
+      }
+    } else {
+      auto* d_w = context.Output<Tensor>(framework::GradVarName("Weight"));
+      if (d_w != nullptr) {
+        T* d_w_data = d_w->mutable_data<T>(context.GetPlace());
+        std::fill(d_w_data, d_w_data + d_w->numel(), 0.0);
+        for (int s = 0; s < num; ++s) {
+          const T* x_row = x_data + (s / width) * dim;
+          T* d_w_row = d_w_data + labels_data[s] * dim;
+          for (int k = 0; k < dim; ++k) {
+            d_w_row[k] += logits_grad_data[s] * x_row[k];
+          }
+        }
+      }
+    }
+
+    auto* d_x = context.Output<Tensor>(framework::GradVarName("Input"));
+    if (d_x != nullptr) {
+      T* d_x_data = d_x->mutable_data<T>(context.GetPlace());
+      std::fill(d_x_data, d_x_data + d_x->numel(), 0.0);
+      for (int s = 0; s < num; ++s) {
+        const T* w_row = w_data + labels_data[s] * dim;
+        T* d_x_row = d_x_data + (s / width) * dim;
+        for (int k = 0; k < dim; ++k) {
+          d_x_row[k] += logits_grad_data[s] * w_row[k];
+        }
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
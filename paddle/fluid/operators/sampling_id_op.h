@@ -17,11 +17,11 @@
 #include <algorithm>
 #include <iostream>
 #include <iterator>
-#include <random>
 #include <sstream>
 #include <vector>
 
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/platform/philox.h"
 
 namespace paddle {
 namespace operators {
@@ -43,19 +43,21 @@ class SamplingIdKernel : public framework::OpKernel<T> {
     std::vector<T> ins_vector;
     framework::TensorToVector(*input, context.device_context(), &ins_vector);
 
-    unsigned int seed = static_cast<unsigned int>(context.Attr<int>("seed"));
-    std::minstd_rand engine;
-    if (seed == 0) {
-      seed = std::random_device()();
-    }
-    engine.seed(seed);
-    std::uniform_real_distribution<T> dist(
-        static_cast<T>(context.Attr<float>("min")),
-        static_cast<T>(context.Attr<float>("max")));
+    // The row i is sampled by the number i % 4 of the Philox call of the
+    // subsequence i / 4, which gives the same ids on all the devices.
+    int seed = context.Attr<int>("seed");
+    auto seed_offset = platform::GetPhiloxSeedOffset(seed != 0, seed, 1);
+    T min = static_cast<T>(context.Attr<float>("min"));
+    T max = static_cast<T>(context.Attr<float>("max"));
 
     std::vector<int64_t> ids(batch_size);
+    platform::Philox4x32::Result numbers;
     for (int i = 0; i < batch_size; ++i) {
-      T r = dist(engine);
+      if (i % 4 == 0) {
+        numbers = platform::Philox4x32(seed_offset.seed, i / 4,
+                                       seed_offset.offset)();
+      }
+      T r = min + (max - min) * platform::PhiloxUniform<T>(numbers.x[i % 4]);
       int idx = width - 1;
       for (int j = 0; j < width; ++j) {
         if ((r -= ins_vector[i * width + j]) < 0) {
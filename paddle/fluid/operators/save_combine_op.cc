@@ -20,13 +20,21 @@ limitations under the License. */
 #include "paddle/fluid/framework/data_type_transform.h"
 #include "paddle/fluid/framework/framework.pb.h"
 #include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/mapped_file.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/sharded_params_file.h"
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/operators/checkpoint_writer.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/port.h"
 
 namespace paddle {
 namespace operators {
 
+// The stream buffer of every shard file, so that the tensors are written to
+// the file in large writes.
+constexpr size_t kShardWriteBufferSize = 4 << 20;
+
 class SaveCombineOp : public framework::OperatorBase {
  public:
   SaveCombineOp(const std::string &type,
@@ -41,6 +49,7 @@ class SaveCombineOp : public framework::OperatorBase {
     auto filename = Attr<std::string>("file_path");
     auto overwrite = Attr<bool>("overwrite");
     auto save_as_fp16 = Attr<bool>("save_as_fp16");
+    auto page_aligned = Attr<bool>("page_aligned");
 
     bool is_present = FileExists(filename);
     if (is_present && !overwrite) {
@@ -49,9 +58,6 @@ class SaveCombineOp : public framework::OperatorBase {
     }
 
     MkDirRecursively(DirName(filename).c_str());
-    std::ofstream fout(filename);
-    PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open %s to write",
-                   filename);
 
     auto inp_var_names = Inputs("X");
     PADDLE_ENFORCE_GT(static_cast<int>(inp_var_names.size()), 0,
@@ -61,6 +67,13 @@ class SaveCombineOp : public framework::OperatorBase {
     platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
     auto &dev_ctx = *pool.Get(place);
 
+    bool async_write = Attr<bool>("async_write");
+    int num_shards = Attr<int>("num_shards");
+    PADDLE_ENFORCE_GE(num_shards, 0, "Attr(num_shards) should be >= 0");
+    PADDLE_ENFORCE(num_shards == 0 || (!page_aligned && !async_write),
+                   "The sharded file could not be page_aligned or async_write");
+    auto tensors = std::make_shared<std::vector<framework::LoDTensor>>();
+    tensors->reserve(inp_var_names.size());
     for (size_t i = 0; i < inp_var_names.size(); i++) {
       auto *var = scope.FindVar(inp_var_names[i]);
 
@@ -72,27 +85,119 @@ class SaveCombineOp : public framework::OperatorBase {
                      inp_var_names[i]);
 
       auto &tensor = var->Get<framework::LoDTensor>();
-      // Serialize tensors one by one
 
       // Check types to see if a fp16 transformation is required
       auto in_dtype = framework::ToDataType(tensor.type());
       auto out_dtype =
           save_as_fp16 ? framework::proto::VarType::FP16 : in_dtype;
 
+      framework::LoDTensor out;
       if (in_dtype != out_dtype) {
         auto in_kernel_type = framework::OpKernelType(in_dtype, place);
         auto out_kernel_type = framework::OpKernelType(out_dtype, place);
-        framework::LoDTensor out;
-        // copy LoD info to the new tensor
-        out.set_lod(tensor.lod());
         framework::TransDataType(in_kernel_type, out_kernel_type, tensor, &out);
-        framework::SerializeToStream(fout, out, dev_ctx);
       } else {
-        framework::SerializeToStream(fout, tensor, dev_ctx);
+        out.ShareDataWith(tensor);
+      }
+      // copy LoD info to the new tensor
+      out.set_lod(tensor.lod());
+
+      if (async_write || num_shards > 0) {
+        // Copy the tensor to CPU, and serialize the copy on the background
+        // threads, while the tensor is being updated when async_write.
+        tensors->emplace_back();
+        framework::TensorCopySync(out, platform::CPUPlace(), &tensors->back());
+        tensors->back().set_lod(out.lod());
+      } else {
+        tensors->emplace_back(out);
       }
     }
+
+    if (num_shards > 0) {
+      SaveSharded(filename, inp_var_names, *tensors,
+                  static_cast<uint32_t>(num_shards),
+                  *pool.Get(platform::CPUPlace()));
+      return;
+    }
+
+    auto write = [tensors, page_aligned](
+        std::ostream *os, const platform::DeviceContext &ctx) {
+      if (page_aligned) {
+        framework::WriteMappableParamsHeader(*os);
+      }
+      // Serialize tensors one by one
+      for (auto &tensor : *tensors) {
+        if (page_aligned) {
+          framework::SerializeToMappableStream(*os, tensor, ctx);
+        } else {
+          framework::SerializeToStream(*os, tensor, ctx);
+        }
+      }
+    };
+
+    if (async_write) {
+      auto &cpu_ctx = *pool.Get(platform::CPUPlace());
+      AsyncCheckpointWriter::Instance().Submit(
+          filename,
+          [write, &cpu_ctx](std::ostream *os) { write(os, cpu_ctx); });
+      return;
+    }
+
+    std::ofstream fout(filename);
+    PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open %s to write",
+                   filename);
+    write(&fout, dev_ctx);
     fout.close();
   }
+
+  // Write the CPU tensors to the shards in parallel, one IO thread per shard,
+  // and then the index.
+  void SaveSharded(const std::string &filename,
+                   const std::vector<std::string> &names,
+                   const std::vector<framework::LoDTensor> &tensors,
+                   uint32_t num_shards,
+                   const platform::DeviceContext &cpu_ctx) const {
+    std::vector<size_t> sizes;
+    sizes.reserve(tensors.size());
+    for (auto &tensor : tensors) {
+      sizes.push_back(tensor.numel() * framework::SizeOfType(tensor.type()));
+    }
+    auto shards = framework::AssignParamsToShards(sizes, num_shards);
+
+    std::vector<framework::ShardedParamsEntry> entries(names.size());
+    auto write_shard = [&](uint32_t shard) {
+      auto path = framework::ShardedParamsShardPath(filename, shard);
+      std::vector<char> buffer(kShardWriteBufferSize);
+      std::ofstream fout;
+      fout.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+      fout.open(path, std::ios::out | std::ios::binary);
+      PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open %s to write", path);
+      for (size_t i = 0; i < tensors.size(); ++i) {
+        if (shards[i] != shard) continue;
+        entries[i].name = names[i];
+        entries[i].shard = shard;
+        entries[i].offset = static_cast<uint64_t>(fout.tellp());
+        framework::SerializeToStream(fout, tensors[i], cpu_ctx);
+      }
+      fout.close();
+      PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot write %s", path);
+    };
+
+    auto *io_pool = framework::ThreadPoolIO::GetInstanceIO();
+    std::vector<std::future<std::unique_ptr<platform::EnforceNotMet>>> futures;
+    for (uint32_t shard = 0; shard < num_shards; ++shard) {
+      futures.emplace_back(io_pool->RunAndGetException(
+          [&write_shard, shard] { write_shard(shard); }));
+    }
+    std::unique_ptr<platform::EnforceNotMet> error;
+    for (auto &f : futures) {
+      auto ex = f.get();
+      if (ex != nullptr && error == nullptr) error = std::move(ex);
+    }
+    if (error != nullptr) throw *error;
+    // The index is written last, so an incomplete file is never loaded.
+    framework::WriteShardedParamsIndex(filename, num_shards, entries);
+  }
 };
 
 class SaveCombineOpProtoMaker : public framework::OpProtoAndCheckerMaker {
@@ -118,6 +223,27 @@ to a file on disk.
                   "type and then saved. Otherwise, the tensor will be "
                   "directly saved without data type conversion.")
         .SetDefault(false);
+    AddAttr<bool>("page_aligned",
+                  "(boolean, default false)"
+                  "If true, the data of every tensor is aligned to the page "
+                  "size in the file, so that load_combine maps the file "
+                  "into memory instead of reading it.")
+        .SetDefault(false);
+    AddAttr<bool>("async_write",
+                  "(boolean, default false)"
+                  "If true, the variables are copied and the copies are "
+                  "written to the file on a background thread, so the op "
+                  "returns before the file is flushed. The load ops wait "
+                  "for the pending writes.")
+        .SetDefault(false);
+    AddAttr<int>("num_shards",
+                 "(int, default 0)"
+                 "If it is greater than 0, the tensors are written to "
+                 "num_shards shard files in parallel, and the file at "
+                 "file_path is the index of the tensors in the shards, so "
+                 "that load_combine reads any of the tensors without reading "
+                 "the others.")
+        .SetDefault(0);
     AddAttr<std::string>(
         "file_path",
         "(string)"
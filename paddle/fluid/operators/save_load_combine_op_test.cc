@@ -300,6 +300,105 @@ TEST(LoadCombineFP16Op, CPU) {
                                                 actual_lod4, numel4);
 }
 
+// The tensors saved with page_aligned are loaded from the mapped file, the
+// data of every one of them starts at a page boundary.
+TEST(SaveLoadCombineOp, CPUPageAligned) {
+  paddle::framework::Scope scope;
+  paddle::platform::CPUPlace place;
+
+  std::vector<int> lod1 = {0, 1, 2, 3, 10};
+  int numel1 = 100;
+  paddle::framework::LoD expect_lod1;
+  float* expect1 = CreateForSaveCombineOp<float, float>(
+      10, 10, lod1, "test_var1", place, &scope, &expect_lod1);
+
+  std::vector<int> lod2 = {0, 2, 5, 10};
+  int numel2 = 200;
+  paddle::framework::LoD expect_lod2;
+  float* expect2 = CreateForSaveCombineOp<float, float>(
+      10, 20, lod2, "test_var2", place, &scope, &expect_lod2);
+
+  std::string filename = "check_tensor_page_aligned.ls";
+  paddle::framework::AttributeMap attrs;
+  attrs.insert({"file_path", std::string(filename)});
+  attrs.insert({"page_aligned", true});
+
+  auto save_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "save_combine", {{"X", {"test_var1", "test_var2"}}}, {}, attrs);
+  save_combine_op->Run(scope, place);
+
+  auto target1 = GeneratePlaceholderBeforeLoad("out_var1", &scope);
+  auto target2 = GeneratePlaceholderBeforeLoad("out_var2", &scope);
+
+  attrs.erase("page_aligned");
+  auto load_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "load_combine", {}, {{"Out", {"out_var1", "out_var2"}}}, attrs);
+  load_combine_op->Run(scope, place);
+
+  paddle::framework::LoD actual_lod1, actual_lod2;
+  float* actual1 =
+      GetValuesAfterLoadCombineOp<float>(target1, scope, &actual_lod1);
+  float* actual2 =
+      GetValuesAfterLoadCombineOp<float>(target2, scope, &actual_lod2);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(actual1) % 4096, 0UL);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(actual2) % 4096, 0UL);
+
+  CheckValues<float, float>(expect1, actual1, expect_lod1, actual_lod1, numel1);
+  CheckValues<float, float>(expect2, actual2, expect_lod2, actual_lod2, numel2);
+}
+
+// The tensors saved with num_shards are found by their names, so a part of
+// them is loaded in another order.
+TEST(SaveLoadCombineOp, CPUSharded) {
+  paddle::framework::Scope scope;
+  paddle::platform::CPUPlace place;
+
+  std::vector<int> lod1 = {0, 1, 2, 3, 10};
+  int numel1 = 100;
+  paddle::framework::LoD expect_lod1;
+  float* expect1 = CreateForSaveCombineOp<float, float>(
+      10, 10, lod1, "test_var1", place, &scope, &expect_lod1);
+
+  std::vector<int> lod2 = {0, 2, 5, 10};
+  paddle::framework::LoD expect_lod2;
+  CreateForSaveCombineOp<float, float>(10, 20, lod2, "test_var2", place,
+                                       &scope, &expect_lod2);
+
+  std::vector<int> lod3 = {0, 20};
+  int numel3 = 4000;
+  paddle::framework::LoD expect_lod3;
+  int* expect3 = CreateForSaveCombineOp<int, int>(20, 200, lod3, "test_var3",
+                                                  place, &scope, &expect_lod3);
+
+  std::string filename = "check_tensor_sharded.ls";
+  paddle::framework::AttributeMap attrs;
+  attrs.insert({"file_path", std::string(filename)});
+  attrs.insert({"num_shards", 2});
+
+  auto save_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "save_combine", {{"X", {"test_var1", "test_var2", "test_var3"}}}, {},
+      attrs);
+  save_combine_op->Run(scope, place);
+
+  paddle::framework::Scope load_scope;
+  auto target3 = GeneratePlaceholderBeforeLoad("test_var3", &load_scope);
+  auto target1 = GeneratePlaceholderBeforeLoad("test_var1", &load_scope);
+
+  attrs.erase("num_shards");
+  auto load_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "load_combine", {}, {{"Out", {"test_var3", "test_var1"}}}, attrs);
+  load_combine_op->Run(load_scope, place);
+
+  paddle::framework::LoD actual_lod1, actual_lod3;
+  float* actual1 =
+      GetValuesAfterLoadCombineOp<float>(target1, load_scope, &actual_lod1);
+  int* actual3 =
+      GetValuesAfterLoadCombineOp<int>(target3, load_scope, &actual_lod3);
+
+  CheckValues<float, float>(expect1, actual1, expect_lod1, actual_lod1, numel1);
+  CheckValues<int, int>(expect3, actual3, expect_lod3, actual_lod3, numel3);
+}
+
 // Test with original SaveLoadTest
 TEST(SaveLoadTestWithCombineOp, CPU) {
   paddle::framework::Scope scope;
@@ -23,6 +23,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/framework/variable.h"
+#include "paddle/fluid/operators/checkpoint_writer.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/port.h"
 
@@ -78,27 +79,42 @@ class SaveOp : public framework::OperatorBase {
     platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
     auto &dev_ctx = *pool.Get(place);
 
-    // FIXME(yuyang18): We save variable to local file now, but we should change
-    // it to save an output stream.
-    std::ofstream fout(filename);
-    PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open %s to write",
-                   filename);
-
     auto save_as_fp16 = Attr<bool>("save_as_fp16");
     auto in_dtype = framework::ToDataType(tensor.type());
     auto out_dtype = save_as_fp16 ? framework::proto::VarType::FP16 : in_dtype;
 
+    framework::LoDTensor out;
     if (in_dtype != out_dtype) {
       auto in_kernel_type = framework::OpKernelType(in_dtype, place);
       auto out_kernel_type = framework::OpKernelType(out_dtype, place);
-      framework::LoDTensor out;
       framework::TransDataType(in_kernel_type, out_kernel_type, tensor, &out);
       // copy LoD info to the new tensor
       out.set_lod(tensor.lod());
-      framework::SerializeToStream(fout, out, dev_ctx);
     } else {
-      framework::SerializeToStream(fout, tensor, dev_ctx);
+      out.ShareDataWith(tensor);
+      out.set_lod(tensor.lod());
+    }
+
+    if (Attr<bool>("async_write")) {
+      // Copy the tensor to CPU, and serialize the copy on the background
+      // thread while the tensor is being updated.
+      auto snapshot = std::make_shared<framework::LoDTensor>();
+      framework::TensorCopySync(out, platform::CPUPlace(), snapshot.get());
+      snapshot->set_lod(out.lod());
+      auto &cpu_ctx = *pool.Get(platform::CPUPlace());
+      AsyncCheckpointWriter::Instance().Submit(
+          filename, [snapshot, &cpu_ctx](std::ostream *os) {
+            framework::SerializeToStream(*os, *snapshot, cpu_ctx);
+          });
+      return;
     }
+
+    // FIXME(yuyang18): We save variable to local file now, but we should change
+    // it to save an output stream.
+    std::ofstream fout(filename);
+    PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open %s to write",
+                   filename);
+    framework::SerializeToStream(fout, out, dev_ctx);
     fout.close();
   }
 
@@ -114,18 +130,50 @@ class SaveOp : public framework::OperatorBase {
 
     MkDirRecursively(DirName(filename).c_str());
 
-    auto &selectedRows = var->Get<framework::SelectedRows>();
+    auto *selectedRows = var->GetMutable<framework::SelectedRows>();
 
     // get device context from pool
     platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
     auto &dev_ctx = *pool.Get(place);
 
+    // The first incremental checkpoint saves the whole table, and the later
+    // ones only the rows updated since the previous one, which are merged
+    // into the table by the load op with merge=true.
+    std::shared_ptr<framework::SelectedRows> snapshot;
+    if (Attr<bool>("incremental") && selectedRows->UpdatedRowsTracked()) {
+      snapshot = std::make_shared<framework::SelectedRows>();
+      selectedRows->TakeUpdatedRows(snapshot.get());
+      VLOG(4) << "SaveSelectedRows saves " << snapshot->rows().size()
+              << " updated rows";
+    } else {
+      if (Attr<bool>("incremental")) {
+        selectedRows->TrackUpdatedRows();
+      }
+      // The spilled rows are serialized from their files, which are not
+      // snapshotted, so the table spilling is saved synchronously.
+      if (Attr<bool>("async_write") &&
+          selectedRows->spilled_rows() == nullptr) {
+        snapshot = std::make_shared<framework::SelectedRows>();
+        selectedRows->Snapshot(snapshot.get());
+      }
+    }
+
+    if (snapshot != nullptr && Attr<bool>("async_write")) {
+      auto &cpu_ctx = *pool.Get(platform::CPUPlace());
+      AsyncCheckpointWriter::Instance().Submit(
+          filename, [snapshot, &cpu_ctx](std::ostream *os) {
+            framework::SerializeToStream(*os, *snapshot, cpu_ctx);
+          });
+      return;
+    }
+
     // FIXME(yuyang18): We save variable to local file now, but we should change
     // it to save an output stream.
     std::ofstream fout(filename);
     PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open %s to write",
                    filename);
-    framework::SerializeToStream(fout, selectedRows, dev_ctx);
+    framework::SerializeToStream(
+        fout, snapshot != nullptr ? *snapshot : *selectedRows, dev_ctx);
     fout.close();
   }
 };
@@ -149,6 +197,20 @@ This operator will serialize and write LoDTensor / SelectedRows variable to file
                   "type and then saved. Otherwise, the tensor will be "
                   "directly saved without data type conversion.")
         .SetDefault(false);
+    AddAttr<bool>("async_write",
+                  "(boolean, default false)"
+                  "If true, the variable is copied and the copy is written "
+                  "to the file on a background thread, so the op returns "
+                  "before the file is flushed. The load op waits for the "
+                  "pending writes.")
+        .SetDefault(false);
+    AddAttr<bool>("incremental",
+                  "(boolean, default false)"
+                  "For the SelectedRows of a distributed lookup table. If "
+                  "true, the first save writes the whole table and the "
+                  "later ones only the rows updated since the previous "
+                  "save, which are applied by the load op with merge=true.")
+        .SetDefault(false);
     AddAttr<std::string>("file_path",
                          "(string)"
                          "The \"file_path\" where the variable will be saved.")
@@ -13,11 +13,16 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <algorithm>
 #include <cstring>
+#include <utility>
+#include <vector>
 
 #include "paddle/fluid/framework/ddim.h"
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/operators/gather.h"
+#include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/place.h"
 
 namespace paddle {
@@ -57,10 +62,36 @@ void ScatterAssign(const platform::DeviceContext& ctx, const Tensor& src,
 
   const size_t slice_bytes = slice_size * sizeof(T);
 
+  // Sort the index with the positions, so that the rows of output are
+  // written in order, and only the last update of a duplicated index, which
+  // the serial order keeps, is copied.
+  std::vector<std::pair<int, int>> order(index_size);
   for (int i = 0; i < index_size; ++i) {
-    int index_ = p_index[i];
-    memcpy(p_output + index_ * slice_size, p_src + i * slice_size, slice_bytes);
+    order[i] = std::make_pair(p_index[i], i);
   }
+  std::sort(order.begin(), order.end());
+  auto last = std::unique(
+      order.rbegin(), order.rend(),
+      [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+        return a.first == b.first;
+      });
+  order.erase(order.begin(), last.base());
+
+  auto& dev_ctx = static_cast<const platform::CPUDeviceContext&>(ctx);
+  dev_ctx.ParallelFor(
+      static_cast<int64_t>(order.size()),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          if (i + kGatherPrefetchDistance < end) {
+            PrefetchRow(
+                p_src + order[i + kGatherPrefetchDistance].second * slice_size,
+                slice_bytes);
+          }
+          memcpy(p_output + order[i].first * slice_size,
+                 p_src + order[i].second * slice_size, slice_bytes);
+        }
+      },
+      slice_size);
 }
 
 }  // namespace operators
@@ -16,6 +16,7 @@ limitations under the License. */
 #include <gtest/gtest.h>
 #include <iostream>
 #include <string>
+#include <vector>
 #include "paddle/fluid/framework/ddim.h"
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/platform/place.h"
@@ -60,3 +61,34 @@ TEST(scatter, ScatterUpdate) {
   delete index;
   delete output;
 }
+
+TEST(scatter, ScatterUpdateDuplicatedIndex) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext ctx(place);
+  const int num_index = 20000;
+  const int num_rows = 1000;
+  const int width = 8;
+
+  paddle::framework::Tensor src, index, output;
+  float* p_src = src.mutable_data<float>(
+      paddle::framework::make_ddim({num_index, width}), place);
+  int* p_index =
+      index.mutable_data<int>(paddle::framework::make_ddim({num_index}), place);
+  float* p_output = output.mutable_data<float>(
+      paddle::framework::make_ddim({num_rows, width}), place);
+  for (int i = 0; i < num_index * width; ++i) p_src[i] = static_cast<float>(i);
+  for (int i = 0; i < num_index; ++i) p_index[i] = (i * 7919) % num_rows;
+  for (int i = 0; i < num_rows * width; ++i) p_output[i] = -1.0f;
+
+  // The last update of a row is kept, as the serial order does.
+  std::vector<float> expected(num_rows * width, -1.0f);
+  for (int i = 0; i < num_index; ++i) {
+    for (int j = 0; j < width; ++j) {
+      expected[p_index[i] * width + j] = p_src[i * width + j];
+    }
+  }
+  paddle::operators::ScatterAssign<float>(ctx, src, index, &output);
+  for (int i = 0; i < num_rows * width; ++i) {
+    EXPECT_EQ(p_output[i], expected[i]);
+  }
+}
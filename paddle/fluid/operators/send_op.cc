@@ -20,6 +20,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/detail/macros.h"
+#include "paddle/fluid/operators/distributed/grad_compression.h"
 #include "paddle/fluid/operators/send_recv_util.h"
 #include "paddle/fluid/platform/profiler.h"
 
@@ -39,6 +40,11 @@ class SendOp : public framework::OperatorBase {
 
     std::vector<std::string> epmap = Attr<std::vector<std::string>>("epmap");
     int sync_send = Attr<int>("sync_mode");
+    auto compress_types = Attr<std::vector<int>>("compress_types");
+    PADDLE_ENFORCE(
+        compress_types.empty() || compress_types.size() == ins.size(),
+        "compress_types should be empty or have one type for each input.");
+    float topk_ratio = Attr<float>("topk_ratio");
 
     platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
     auto& ctx = *pool.Get(place);
@@ -51,6 +57,11 @@ class SendOp : public framework::OperatorBase {
     for (size_t i = 0; i < ins.size(); i++) {
       if (NeedSend(scope, ins[i])) {
         VLOG(3) << "sending " << ins[i] << " to " << epmap[i];
+        if (!compress_types.empty()) {
+          distributed::GradientCompressor::Instance().SetCompressType(
+              ins[i], static_cast<distributed::CompressType>(compress_types[i]),
+              topk_ratio);
+        }
         rets.push_back(rpc_client->AsyncSendVar(epmap[i], ctx, scope, ins[i]));
       } else {
         VLOG(3) << "don't send no-initialied variable: " << ins[i];
@@ -86,6 +97,16 @@ This operator will send variables to listen_and_serve op at the parameter server
                                       "Server endpoints in the order of input "
                                       "variables for mapping")
         .SetDefault({"127.0.0.1:6164"});
+    AddAttr<std::vector<int>>(
+        "compress_types",
+        "(int vector, default {}) The compression of each input variable, "
+        "0 for none, 1 for float16, 2 for top-k sparsification. Only the "
+        "dense float gradients are compressed.")
+        .SetDefault({});
+    AddAttr<float>("topk_ratio",
+                   "(float, default 0.01) The ratio of the elements sent by "
+                   "the top-k sparsification.")
+        .SetDefault(0.01f);
   }
 };
 
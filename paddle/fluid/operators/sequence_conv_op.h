@@ -51,13 +51,22 @@ class SequenceConvKernel : public framework::OpKernel<T> {
     int down_pad = std::max(0, context_start + context_length - 1);
     int sequence_width = static_cast<int>(in->dims()[1]);
 
+    math::SetConstant<DeviceContext, T> set_zero;
+    auto& dev_ctx = context.template device_context<DeviceContext>();
+    if (!padding_trainable) {
+      // The zero padding contributes nothing, so project the shifted input
+      // rows by the filter directly without the col data.
+      set_zero(dev_ctx, out, static_cast<T>(0));
+      math::ContextProjectMatMulFunctor<DeviceContext, T> seq_project_matmul;
+      seq_project_matmul(dev_ctx, *in, filter, context_start, context_length,
+                         out);
+      return;
+    }
+
     framework::DDim col_shape = {in->dims()[0],
                                  context_length * sequence_width};
     Tensor col;
     col.mutable_data<T>(col_shape, context.GetPlace());
-    // Because if padding_trainable is false, padding data should be zeros.
-    math::SetConstant<DeviceContext, T> set_zero;
-    auto& dev_ctx = context.template device_context<DeviceContext>();
     auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
     set_zero(dev_ctx, &col, static_cast<T>(0));
     math::ContextProjectFunctor<DeviceContext, T> seq_project_functor;
@@ -97,6 +106,23 @@ class SequenceConvGradKernel : public framework::OpKernel<T> {
 
     math::SetConstant<DeviceContext, T> set_zero;
     auto& dev_ctx = context.template device_context<DeviceContext>();
+    if (!padding_trainable) {
+      if (in_g) {
+        in_g->mutable_data<T>(context.GetPlace());
+        in_g->set_lod(in->lod());
+        set_zero(dev_ctx, in_g, static_cast<T>(0));
+      }
+      if (filter_g) {
+        filter_g->mutable_data<T>(context.GetPlace());
+        set_zero(dev_ctx, filter_g, static_cast<T>(0));
+      }
+      math::ContextProjectMatMulGradFunctor<DeviceContext, T>
+          seq_project_matmul_grad;
+      seq_project_matmul_grad(dev_ctx, *in, *filter, *out_g, context_start,
+                              context_length, in_g, filter_g);
+      return;
+    }
+
     auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
     // use col_shape in the im2col calculation
     framework::DDim col_shape = {in->dims()[0],
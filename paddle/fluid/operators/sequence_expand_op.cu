@@ -14,64 +14,141 @@ limitations under the License. */
 
 #include <algorithm>
 #include "paddle/fluid/operators/sequence_expand_op.h"
-#include "paddle/fluid/platform/cuda_primitives.h"
 
 namespace paddle {
 namespace operators {
 
 using LoDTensor = framework::LoDTensor;
 
-template <typename T>
-__global__ void sequence_expand_kernel(const T* x_data, const size_t* x_lod,
-                                       const size_t* ref_lod,
-                                       const size_t* offset,
-                                       const size_t lod_size,
-                                       /* default=1,
-                                          the instance length*/
-                                       const int x_item_length, T* out_data) {
-  int bid = blockIdx.x;
-  if (bid >= lod_size - 1) return;
-
-  int x_item_count = x_lod[bid + 1] - x_lod[bid];
-  int repeats = ref_lod[bid + 1] - ref_lod[bid];
-  int out_offset = static_cast<int>(offset[bid]);
-  int x_offset = x_lod[bid];
-  for (int tid_z = threadIdx.z; tid_z < repeats; tid_z += blockDim.z) {
-    for (int tid_y = threadIdx.y; tid_y < x_item_count; tid_y += blockDim.y) {
-      for (int tid_x = threadIdx.x; tid_x < x_item_length;
-           tid_x += blockDim.x) {
-        out_data[(out_offset + tid_z * x_item_count + tid_y) * x_item_length +
-                 tid_x] = x_data[(x_offset + tid_y) * x_item_length + tid_x];
-      }
+// The sequences whose offsets in Out a block scans into its shared memory,
+// the offsets of more sequences are computed on the host.
+constexpr int kMaxScanSeqNum = 2048;
+constexpr int kExpandThreads = 256;
+
+// The rows of Out expanded from the sequence i of X.
+__device__ __forceinline__ size_t OutputRows(const size_t* x_lod,
+                                             const size_t* ref_lod, int i) {
+  return (ref_lod[i + 1] - ref_lod[i]) * (x_lod[i + 1] - x_lod[i]);
+}
+
+// The last i in [0, seq_num) whose offsets[i] <= value.
+__device__ __forceinline__ int SequenceOf(const size_t* offsets, int seq_num,
+                                          size_t value) {
+  int low = 0;
+  int high = seq_num;
+  while (high - low > 1) {
+    int mid = (low + high) >> 1;
+    if (offsets[mid] <= value) {
+      low = mid;
+    } else {
+      high = mid;
     }
   }
+  return low;
+}
+
+/*
+ * The offsets of the sequences of X in Out, which are offsets[i] - *base.
+ *
+ * A row of X is a sequence if x_lod is nullptr, then the offsets are the
+ * ref_lod itself. Otherwise they are the out_offset computed on the host,
+ * or scanned by the block from the lengths of the sequences into scan if
+ * out_offset is nullptr. All the threads of the block should call it.
+ */
+__device__ const size_t* OutputOffsets(const size_t* x_lod,
+                                       const size_t* ref_lod,
+                                       const size_t* out_offset, int seq_num,
+                                       size_t* scan, size_t* partial,
+                                       size_t* base) {
+  if (x_lod == nullptr) {
+    *base = ref_lod[0];
+    return ref_lod;
+  }
+  *base = 0;
+  if (out_offset != nullptr) return out_offset;
+
+  // Each thread sums the rows of a chunk of the sequences, and the sums of
+  // the chunks are scanned in the shared memory.
+  const int tid = threadIdx.x;
+  const int chunk = (seq_num + blockDim.x - 1) / blockDim.x;
+  const int begin = min(tid * chunk, seq_num);
+  const int end = min(begin + chunk, seq_num);
+  size_t sum = 0;
+  for (int i = begin; i < end; ++i) {
+    sum += OutputRows(x_lod, ref_lod, i);
+  }
+  partial[tid] = sum;
+  __syncthreads();
+  for (int stride = 1; stride < blockDim.x; stride <<= 1) {
+    size_t prev = tid >= stride ? partial[tid - stride] : 0;
+    __syncthreads();
+    partial[tid] += prev;
+    __syncthreads();
+  }
+  size_t offset = partial[tid] - sum;
+  for (int i = begin; i < end; ++i) {
+    scan[i] = offset;
+    offset += OutputRows(x_lod, ref_lod, i);
+  }
+  __syncthreads();
+  return scan;
 }
 
+// Every thread copies the elements of Out from X, found by the binary search
+// of their rows, so the long and the short sequences are balanced.
 template <typename T>
-__global__ void sequence_expand_grad_kernel(
-    const T* dout_data, const size_t* ref_lod, const size_t* dx_lod,
-    const size_t* offset, const size_t lod_size,
-    /* default=1,
-       the instance length*/
-    const int x_item_length, T* dx_data) {
-  int bid = blockIdx.x;
-  if (bid >= lod_size - 1) return;
-  int x_item_count = dx_lod[bid + 1] - dx_lod[bid];
-  int repeats = ref_lod[bid + 1] - ref_lod[bid];
-  int out_offset = static_cast<int>(offset[bid]);
-  int x_offset = dx_lod[bid];
-
-  for (int tid_z = threadIdx.z; tid_z < repeats; tid_z += blockDim.z) {
-    for (int tid_y = threadIdx.y; tid_y < x_item_count; tid_y += blockDim.y) {
-      for (int tid_x = threadIdx.x; tid_x < x_item_length;
-           tid_x += blockDim.x) {
-        platform::CudaAtomicAdd(
-            &dx_data[(x_offset + tid_y) * x_item_length + tid_x],
-            dout_data[(out_offset + tid_z * x_item_count + tid_y) *
-                          x_item_length +
-                      tid_x]);
-      }
+__global__ void SequenceExpandKernel(const T* x_data, const size_t* x_lod,
+                                     const size_t* ref_lod,
+                                     const size_t* out_offset, int seq_num,
+                                     int64_t out_numel, int64_t width,
+                                     T* out_data) {
+  __shared__ size_t scan[kMaxScanSeqNum];
+  __shared__ size_t partial[kExpandThreads];
+  size_t base;
+  const size_t* offsets = OutputOffsets(x_lod, ref_lod, out_offset, seq_num,
+                                        scan, partial, &base);
+  for (int64_t idx = static_cast<int64_t>(blockIdx.x) * blockDim.x +
+                     threadIdx.x;
+       idx < out_numel; idx += static_cast<int64_t>(blockDim.x) * gridDim.x) {
+    const size_t row = idx / width;
+    const int i = SequenceOf(offsets, seq_num, row + base);
+    const size_t out_start = offsets[i] - base;
+    const size_t x_start = x_lod ? x_lod[i] : i;
+    const size_t x_len = x_lod ? x_lod[i + 1] - x_start : 1;
+    const size_t x_row = x_start + (row - out_start) % x_len;
+    out_data[idx] = x_data[x_row * width + idx % width];
+  }
+}
+
+// Every thread sums an element of dX over the repeats of its sequence, which
+// needs no atomics and is deterministic.
+template <typename T>
+__global__ void SequenceExpandGradKernel(const T* dout_data,
+                                         const size_t* x_lod,
+                                         const size_t* ref_lod,
+                                         const size_t* out_offset, int seq_num,
+                                         int64_t dx_numel, int64_t width,
+                                         T* dx_data) {
+  __shared__ size_t scan[kMaxScanSeqNum];
+  __shared__ size_t partial[kExpandThreads];
+  size_t base;
+  const size_t* offsets = OutputOffsets(x_lod, ref_lod, out_offset, seq_num,
+                                        scan, partial, &base);
+  for (int64_t idx = static_cast<int64_t>(blockIdx.x) * blockDim.x +
+                     threadIdx.x;
+       idx < dx_numel; idx += static_cast<int64_t>(blockDim.x) * gridDim.x) {
+    const size_t row = idx / width;
+    const int i =
+        x_lod ? SequenceOf(x_lod, seq_num, row) : static_cast<int>(row);
+    const size_t x_start = x_lod ? x_lod[i] : i;
+    const size_t x_len = x_lod ? x_lod[i + 1] - x_start : 1;
+    const size_t repeats = ref_lod[i + 1] - ref_lod[i];
+    size_t out_row = offsets[i] - base + (row - x_start);
+    T sum = static_cast<T>(0);
+    for (size_t r = 0; r < repeats; ++r, out_row += x_len) {
+      sum += dout_data[out_row * width + idx % width];
     }
+    dx_data[idx] = sum;
   }
 }
 
@@ -88,6 +165,40 @@ void GetOutputOffset(const framework::Vector<size_t>& x_lod,
   }
 }
 
+/*
+ * Launch the kernel of sequence_expand or its gradient over the numel
+ * elements of the output, in a single launch reading the device copies
+ * of the LoDs, which are cached by the LoDs of the variables.
+ *
+ * x_has_lod is false if x_lod is the fake LoD of the rows of X, which is
+ * not uploaded. The offsets of the sequences in Out are computed by the
+ * kernel, or on the host for more than kMaxScanSeqNum sequences.
+ */
+template <typename T, typename Kernel>
+void LaunchSequenceExpand(const platform::CUDADeviceContext& context,
+                          Kernel kernel, const T* in, bool x_has_lod,
+                          const framework::Vector<size_t>& x_lod,
+                          const framework::Vector<size_t>& ref_lod,
+                          int64_t numel, int64_t width, T* out) {
+  if (numel == 0) return;
+  const int seq_num = static_cast<int>(ref_lod.size()) - 1;
+  const auto& place = context.GetPlace();
+  framework::Vector<size_t> out_offset;
+  const size_t* out_offset_data = nullptr;
+  if (x_has_lod && seq_num > kMaxScanSeqNum) {
+    out_offset.resize(x_lod.size());
+    GetOutputOffset(x_lod, ref_lod, &out_offset);
+    out_offset_data = out_offset.CUDAData(place);
+  }
+  const int max_blocks =
+      std::max(context.GetMaxPhysicalThreadCount() / kExpandThreads, 1);
+  const int blocks = static_cast<int>(std::min<int64_t>(
+      (numel + kExpandThreads - 1) / kExpandThreads, max_blocks));
+  kernel<<<blocks, kExpandThreads, 0, context.stream()>>>(
+      in, x_has_lod ? x_lod.CUDAData(place) : nullptr, ref_lod.CUDAData(place),
+      out_offset_data, seq_num, numel, width, out);
+}
+
 template <typename T>
 struct SequenceExpandFunctor<platform::CUDADeviceContext, T> {
   void operator()(
@@ -95,22 +206,11 @@ struct SequenceExpandFunctor<platform::CUDADeviceContext, T> {
       const framework::Vector<size_t>& x_lod,   /*expand source lod*/
       const framework::Vector<size_t>& ref_lod, /*expand referenced lod*/
       LoDTensor* out) {
-    int x_item_length = x.numel() / x.dims()[0];
-    framework::Vector<size_t> out_offset(x_lod.size());
-    GetOutputOffset(x_lod, ref_lod, &out_offset);
-
-    int thread_x = std::min(32, std::max(static_cast<int>(ref_lod.size()), 16));
-    int thread_y = 16;
-    int thread_z = 1024 / thread_x / thread_y;
-    int block_x = static_cast<int>(ref_lod.size());
-    dim3 block_size(thread_x, thread_y, thread_z);
-    dim3 grid_size(block_x, 1);
-
-    sequence_expand_kernel<<<grid_size, block_size, 0, context.stream()>>>(
-        x.data<T>(), x_lod.CUDAData(context.GetPlace()),
-        ref_lod.CUDAData(context.GetPlace()),
-        out_offset.CUDAData(context.GetPlace()), x_lod.size(), x_item_length,
-        out->mutable_data<T>(context.GetPlace()));
+    int64_t x_item_length = x.numel() / x.dims()[0];
+    LaunchSequenceExpand(context, SequenceExpandKernel<T>, x.data<T>(),
+                         x.lod().size() == 1, x_lod, ref_lod, out->numel(),
+                         x_item_length,
+                         out->mutable_data<T>(context.GetPlace()));
   }
 };
 
@@ -121,21 +221,12 @@ struct SequenceExpandGradFunctor<platform::CUDADeviceContext, T> {
                   const framework::Vector<size_t>& x_lod, /*expand source lod*/
                   const framework::Vector<size_t>& ref_lod, /*expand based lod*/
                   LoDTensor* dx) {
-    int x_item_length = framework::product(dx->dims()) / dx->dims()[0];
-    framework::Vector<size_t> out_offset(x_lod.size());
-    GetOutputOffset(x_lod, ref_lod, &out_offset);
-
-    int thread_x = std::min(32, std::max(static_cast<int>(ref_lod.size()), 16));
-    int thread_y = 16;
-    int thread_z = 1024 / thread_x / thread_y;
-    int block_x = static_cast<int>(ref_lod.size());
-    dim3 block_size(thread_x, thread_y, thread_z);
-    dim3 grid_size(block_x, 1);
-    sequence_expand_grad_kernel<<<grid_size, block_size, 0, context.stream()>>>(
-        dout.data<T>(), ref_lod.CUDAData(context.GetPlace()),
-        x_lod.CUDAData(context.GetPlace()),
-        out_offset.CUDAData(context.GetPlace()), ref_lod.size(), x_item_length,
-        dx->mutable_data<T>(context.GetPlace()));
+    int64_t x_item_length = framework::product(dx->dims()) / dx->dims()[0];
+    // dx has the LoD of X.
+    T* dx_data = dx->mutable_data<T>(context.GetPlace());
+    LaunchSequenceExpand(context, SequenceExpandGradKernel<T>, dout.data<T>(),
+                         dx->lod().size() == 1, x_lod, ref_lod, dx->numel(),
+                         x_item_length, dx_data);
   }
 };
 
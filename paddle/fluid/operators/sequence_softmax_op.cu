@@ -15,6 +15,7 @@ limitations under the License. */
 #include <algorithm>
 #include <cub/cub.cuh>  // NOLINT
 #include "paddle/fluid/operators/sequence_softmax_op.h"
+#include "paddle/fluid/platform/cuda_device_function.h"
 
 namespace paddle {
 namespace operators {
@@ -30,106 +31,224 @@ using BlockReduce = cub::BlockReduce<T, BlockDim>;
 template <typename T, int BlockDim>
 using BlockReduceTempStorage = typename BlockReduce<T, BlockDim>::TempStorage;
 
+// A sequence longer than this is computed by a whole block instead of a warp,
+// so that a few long sequences do not keep their warps busy long after the
+// short ones are done.
+static constexpr size_t kSoftmaxWarpSpan = 256;
+
+template <typename T>
+__device__ __forceinline__ T WarpReduceMax(T val) {
+  unsigned mask = 0u;
+  CREATE_SHFL_MASK(mask, true);
+  for (int offset = 16; offset > 0; offset /= 2) {
+    T other = platform::CudaShuffleDownSync(mask, val, offset);
+    val = val > other ? val : other;
+  }
+  return platform::CudaShuffleSync(mask, val, 0);
+}
+
+template <typename T>
+__device__ __forceinline__ T WarpReduceSum(T val) {
+  unsigned mask = 0u;
+  CREATE_SHFL_MASK(mask, true);
+  for (int offset = 16; offset > 0; offset /= 2) {
+    val += platform::CudaShuffleDownSync(mask, val, offset);
+  }
+  return platform::CudaShuffleSync(mask, val, 0);
+}
+
 template <typename T, int BlockDim>
-__global__ void sequence_softmax_kernel(const T *in_data, const size_t *ref_lod,
-                                        const size_t src_hight, T *out_data) {
+__device__ void BlockSequenceSoftmax(const T *in_data, size_t start,
+                                     size_t span, T *out_data) {
   __shared__ BlockReduceTempStorage<T, BlockDim> temp_storage;
   __shared__ T shared_max_data;
   __shared__ T shared_sum_data;
 
-  for (int i = blockIdx.x; i < src_hight; i += gridDim.x) {
-    size_t start = ref_lod[i];
-    size_t span = ref_lod[i + 1] - start;
+  // Find the max ele
+  T max_ele = -FLT_MAX;
+  for (int tid = threadIdx.x; tid < span; tid += blockDim.x) {
+    T ele = in_data[start + tid];
+    max_ele = max_ele > ele ? max_ele : ele;
+  }
+  max_ele = BlockReduce<T, BlockDim>(temp_storage).Reduce(max_ele, cub::Max());
+  if (threadIdx.x == 0) {
+    shared_max_data = max_ele;
+  }
+  __syncthreads();
 
-    // Find the max ele
-    T max_ele = -FLT_MAX;
-    for (int tid = threadIdx.x; tid < span; tid += blockDim.x) {
-      T ele = in_data[start + tid];
-      max_ele = max_ele > ele ? max_ele : ele;
-    }
-    max_ele =
-        BlockReduce<T, BlockDim>(temp_storage).Reduce(max_ele, cub::Max());
-    if (threadIdx.x == 0) {
-      shared_max_data = max_ele;
-    }
-    __syncthreads();
+  // sum
+  T sum_data = 0;
+  for (int tid = threadIdx.x; tid < span; tid += blockDim.x) {
+    T ele = in_data[start + tid];
+    sum_data += real_exp(ele - shared_max_data);
+  }
+  sum_data =
+      BlockReduce<T, BlockDim>(temp_storage).Reduce(sum_data, cub::Sum());
+  if (threadIdx.x == 0) {
+    shared_sum_data = sum_data;
+  }
+  __syncthreads();
 
-    // sum
-    T sum_data = 0;
-    for (int tid = threadIdx.x; tid < span; tid += blockDim.x) {
-      T ele = in_data[start + tid];
-      sum_data += real_exp(ele - shared_max_data);
-    }
-    sum_data =
-        BlockReduce<T, BlockDim>(temp_storage).Reduce(sum_data, cub::Sum());
-    if (threadIdx.x == 0) {
-      shared_sum_data = sum_data;
-    }
-    __syncthreads();
+  // get final resit
+  for (int tid = threadIdx.x; tid < span; tid += blockDim.x) {
+    T ele = in_data[start + tid];
+    ele = real_exp(ele - shared_max_data) / shared_sum_data;
+    out_data[start + tid] = ele;
+  }
+}
 
-    // get final resit
-    for (int tid = threadIdx.x; tid < span; tid += blockDim.x) {
-      T ele = in_data[start + tid];
-      ele = real_exp(ele - shared_max_data) / shared_sum_data;
-      out_data[start + tid] = ele;
+template <typename T>
+__device__ void WarpSequenceSoftmax(const T *in_data, size_t start,
+                                    size_t span, T *out_data) {
+  int lane = threadIdx.x % 32;
+  T max_ele = -FLT_MAX;
+  for (int tid = lane; tid < span; tid += 32) {
+    T ele = in_data[start + tid];
+    max_ele = max_ele > ele ? max_ele : ele;
+  }
+  max_ele = WarpReduceMax(max_ele);
+
+  T sum_data = 0;
+  for (int tid = lane; tid < span; tid += 32) {
+    sum_data += real_exp(in_data[start + tid] - max_ele);
+  }
+  sum_data = WarpReduceSum(sum_data);
+
+  for (int tid = lane; tid < span; tid += 32) {
+    out_data[start + tid] = real_exp(in_data[start + tid] - max_ele) / sum_data;
+  }
+}
+
+// The first num_long blocks compute the long_seqs, one block each, and the
+// rest compute the short_seqs, one warp each.
+template <typename T, int BlockDim>
+__global__ void sequence_softmax_kernel(const T *in_data, const size_t *ref_lod,
+                                        const int *long_seqs, int num_long,
+                                        const int *short_seqs, int num_short,
+                                        T *out_data) {
+  if (blockIdx.x < num_long) {
+    int i = long_seqs[blockIdx.x];
+    BlockSequenceSoftmax<T, BlockDim>(in_data, ref_lod[i],
+                                      ref_lod[i + 1] - ref_lod[i], out_data);
+  } else {
+    int k = (blockIdx.x - num_long) * (BlockDim / 32) + threadIdx.x / 32;
+    if (k < num_short) {
+      int i = short_seqs[k];
+      WarpSequenceSoftmax<T>(in_data, ref_lod[i], ref_lod[i + 1] - ref_lod[i],
+                             out_data);
     }
   }
 }
 
 template <typename T, int BlockDim>
-__global__ void sequence_softmax_grad_kernel(const T *softmax_grad_data,
-                                             const T *softmax_data,
-                                             const size_t *ref_lod,
-                                             const size_t src_hight,
-                                             T *dx_data) {
+__device__ void BlockSequenceSoftmaxGrad(const T *softmax_grad_data,
+                                         const T *softmax_data, size_t start,
+                                         size_t span, T *dx_data) {
   __shared__ BlockReduceTempStorage<T, BlockDim> temp_storage;
   __shared__ T shared_data;
 
-  for (int i = blockIdx.x; i < src_hight; i += gridDim.x) {
-    size_t start = ref_lod[i];
-    size_t span = ref_lod[i + 1] - start;
+  T result = 0;
+  for (int tid = threadIdx.x; tid < span; tid += blockDim.x) {
+    size_t idx = start + tid;
+    T s_g_d = softmax_grad_data[idx];
+    T s_d = softmax_data[idx];
+    result += s_g_d * s_d;
+  }
+  result = BlockReduce<T, BlockDim>(temp_storage).Reduce(result, cub::Sum());
+  if (threadIdx.x == 0) {
+    shared_data = result;
+  }
+  __syncthreads();
 
-    T result = 0;
-    for (int tid = threadIdx.x; tid < span; tid += blockDim.x) {
-      size_t idx = start + tid;
-      T s_g_d = softmax_grad_data[idx];
-      T s_d = softmax_data[idx];
-      result += s_g_d * s_d;
-    }
-    result = BlockReduce<T, BlockDim>(temp_storage).Reduce(result, cub::Sum());
-    if (threadIdx.x == 0) {
-      shared_data = result;
-    }
-    __syncthreads();
+  for (int tid = threadIdx.x; tid < span; tid += blockDim.x) {
+    size_t idx = start + tid;
+    T s_g_d = softmax_grad_data[idx];
+    T s_d = softmax_data[idx];
+    dx_data[idx] = (s_g_d - shared_data) * s_d;
+  }
+}
+
+template <typename T>
+__device__ void WarpSequenceSoftmaxGrad(const T *softmax_grad_data,
+                                        const T *softmax_data, size_t start,
+                                        size_t span, T *dx_data) {
+  int lane = threadIdx.x % 32;
+  T result = 0;
+  for (int tid = lane; tid < span; tid += 32) {
+    size_t idx = start + tid;
+    result += softmax_grad_data[idx] * softmax_data[idx];
+  }
+  result = WarpReduceSum(result);
 
-    for (int tid = threadIdx.x; tid < span; tid += blockDim.x) {
-      size_t idx = start + tid;
-      T s_g_d = softmax_grad_data[idx];
-      T s_d = softmax_data[idx];
-      dx_data[idx] = (s_g_d - shared_data) * s_d;
+  for (int tid = lane; tid < span; tid += 32) {
+    size_t idx = start + tid;
+    dx_data[idx] = (softmax_grad_data[idx] - result) * softmax_data[idx];
+  }
+}
+
+template <typename T, int BlockDim>
+__global__ void sequence_softmax_grad_kernel(
+    const T *softmax_grad_data, const T *softmax_data, const size_t *ref_lod,
+    const int *long_seqs, int num_long, const int *short_seqs, int num_short,
+    T *dx_data) {
+  if (blockIdx.x < num_long) {
+    int i = long_seqs[blockIdx.x];
+    BlockSequenceSoftmaxGrad<T, BlockDim>(softmax_grad_data, softmax_data,
+                                          ref_lod[i],
+                                          ref_lod[i + 1] - ref_lod[i], dx_data);
+  } else {
+    int k = (blockIdx.x - num_long) * (BlockDim / 32) + threadIdx.x / 32;
+    if (k < num_short) {
+      int i = short_seqs[k];
+      WarpSequenceSoftmaxGrad<T>(softmax_grad_data, softmax_data, ref_lod[i],
+                                 ref_lod[i + 1] - ref_lod[i], dx_data);
     }
   }
 }
 
+// The indexes of the sequences computed by a block and by a warp.
+struct SoftmaxSequences {
+  SoftmaxSequences(const framework::Vector<size_t> &ref_lod,
+                   int threads_per_block) {
+    for (size_t i = 0; i + 1 < ref_lod.size(); ++i) {
+      if (ref_lod[i + 1] - ref_lod[i] > kSoftmaxWarpSpan) {
+        long_seqs.push_back(static_cast<int>(i));
+      } else {
+        short_seqs.push_back(static_cast<int>(i));
+      }
+    }
+    num_long = static_cast<int>(long_seqs.size());
+    num_short = static_cast<int>(short_seqs.size());
+    int warps_per_block = threads_per_block / 32;
+    blocks = num_long + (num_short + warps_per_block - 1) / warps_per_block;
+    // Vector::CUDAData of an empty Vector is not valid.
+    if (long_seqs.empty()) long_seqs.push_back(0);
+    if (short_seqs.empty()) short_seqs.push_back(0);
+  }
+
+  framework::Vector<int> long_seqs;
+  framework::Vector<int> short_seqs;
+  int num_long;
+  int num_short;
+  int blocks;
+};
+
 template <typename T>
 struct SequenceSoftmaxFunctor<platform::CUDADeviceContext, T> {
   void operator()(const platform::CUDADeviceContext &context,
                   const LoDTensor &x,
                   const framework::Vector<size_t> &ref_lod, /*referenced lod*/
                   LoDTensor *out) {
-    int hight = ref_lod.size() - 1;
+    const int kThreadsPerBlock = 256;
+    SoftmaxSequences seqs(ref_lod, kThreadsPerBlock);
+    T *out_data = out->mutable_data<T>(context.GetPlace());
+    if (seqs.blocks == 0) return;
 
-    const int kThreadsPerBlock = 32;
-    int thread_x = kThreadsPerBlock;
-    int max_threads = context.GetMaxPhysicalThreadCount();
-    int max_blocks = std::max(max_threads / kThreadsPerBlock, 1);
-
-    dim3 block_size(thread_x);
-    dim3 grid_size(max_blocks);
-    sequence_softmax_kernel<
-        T, kThreadsPerBlock><<<grid_size, block_size, 0, context.stream()>>>(
-        x.data<T>(), ref_lod.CUDAData(context.GetPlace()), hight,
-        out->mutable_data<T>(context.GetPlace()));
+    sequence_softmax_kernel<T, kThreadsPerBlock><<<
+        seqs.blocks, kThreadsPerBlock, 0, context.stream()>>>(
+        x.data<T>(), ref_lod.CUDAData(context.GetPlace()),
+        seqs.long_seqs.CUDAData(context.GetPlace()), seqs.num_long,
+        seqs.short_seqs.CUDAData(context.GetPlace()), seqs.num_short, out_data);
   }
 };
 
@@ -139,20 +258,16 @@ struct SequenceSoftmaxGradFunctor<platform::CUDADeviceContext, T> {
                   const LoDTensor &dout, const LoDTensor &out,
                   const framework::Vector<size_t> &ref_lod, /*referenced lod*/
                   LoDTensor *dx) {
-    size_t hight = ref_lod.size() - 1;
-
-    const int kThreadsPerBlock = 32;
-    int thread_x = kThreadsPerBlock;
-    int max_threads = context.GetMaxPhysicalThreadCount();
-    int max_blocks = std::max(max_threads / kThreadsPerBlock, 1);
-
-    dim3 block_size(thread_x);
-    dim3 grid_size(max_blocks);
+    const int kThreadsPerBlock = 256;
+    SoftmaxSequences seqs(ref_lod, kThreadsPerBlock);
+    T *dx_data = dx->mutable_data<T>(context.GetPlace());
+    if (seqs.blocks == 0) return;
 
-    sequence_softmax_grad_kernel<
-        T, kThreadsPerBlock><<<grid_size, block_size, 0, context.stream()>>>(
+    sequence_softmax_grad_kernel<T, kThreadsPerBlock><<<
+        seqs.blocks, kThreadsPerBlock, 0, context.stream()>>>(
         dout.data<T>(), out.data<T>(), ref_lod.CUDAData(context.GetPlace()),
-        hight, dx->mutable_data<T>(context.GetPlace()));
+        seqs.long_seqs.CUDAData(context.GetPlace()), seqs.num_long,
+        seqs.short_seqs.CUDAData(context.GetPlace()), seqs.num_short, dx_data);
   }
 };
 
@@ -108,17 +108,29 @@ class SGDOpKernel : public framework::OpKernel<T> {
       const auto *lr = learning_rate->data<T>();
       const auto *grad_data = grad.value().data<T>();
       auto *out_data = param_out->mutable_value()->data<T>();
+      // the slots of the rows must not be reused by an eviction until the
+      // rows are updated
+      framework::RWLockGuard guard(param_out->evict_lock(),
+                                   framework::RWLockGuard::Status::kRDLock);
       for (size_t i = 0; i < grad.rows().size(); i++) {
         PADDLE_ENFORCE(grad.rows()[i] < grad.height(),
                        "Input rows index should less than height");
-        int64_t id_index = param_out->AutoGrownIndex(grad.rows()[i], false);
-        PADDLE_ENFORCE_GE(id_index, static_cast<int64_t>(0),
-                          "id should be in the table");
+        int64_t id_index = param_out->ExistingIndex(grad.rows()[i]);
+        if (id_index < 0) {
+          // the row was dropped by an eviction after the gradient was
+          // computed, the gradient is stale
+          PADDLE_ENFORCE(param_out->EvictionEnabled(), "key %d not found",
+                         grad.rows()[i]);
+          VLOG(4) << "skip the gradient of the evicted row " << grad.rows()[i];
+          continue;
+        }
         for (int64_t j = 0; j < grad_row_width; j++) {
           out_data[id_index * grad_row_width + j] -=
               lr[0] * grad_data[i * grad_row_width + j];
         }
       }
+      param_out->MarkUpdated(grad.rows().data(),
+                             static_cast<int64_t>(grad.rows().size()));
     } else {
       PADDLE_THROW("Unsupported Variable Type of Parameter");
     }
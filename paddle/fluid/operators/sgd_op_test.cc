@@ -0,0 +1,86 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/selected_rows.h"
+
+USE_OP(sgd);
+
+namespace paddle {
+namespace operators {
+
+TEST(SGDOp, sparse_table_with_evicted_rows) {
+  framework::Scope scope;
+  platform::CPUPlace place;
+  constexpr int64_t kHeight = 10;
+  constexpr int64_t kTableSize = 4;
+  constexpr int64_t kWidth = 2;
+
+  auto* table = scope.Var("Param")->GetMutable<framework::SelectedRows>();
+  table->set_height(kHeight);
+  auto* data =
+      table->mutable_value()->mutable_data<float>({kTableSize, kWidth}, place);
+  for (int64_t key = 0; key < kTableSize; ++key) {
+    table->AutoGrownIndex(key, true);
+  }
+  for (int64_t i = 0; i < kTableSize * kWidth; ++i) {
+    data[i] = 1.f;
+  }
+  // the keys 2 and 3 are dropped by the second eviction, without a spill
+  // tier
+  table->EnableEviction(2, 0, "");
+  ASSERT_EQ(table->EvictRows(), 0);
+  for (int64_t key : {0, 0, 1, 1}) {
+    table->AutoGrownIndex(key, false);
+  }
+  ASSERT_EQ(table->EvictRows(), 2);
+  ASSERT_FALSE(table->HasKey(2));
+
+  auto* grad = scope.Var("Grad")->GetMutable<framework::SelectedRows>();
+  grad->set_height(kHeight);
+  grad->set_rows({0, 2});
+  float* grad_data =
+      grad->mutable_value()->mutable_data<float>({2, kWidth}, place);
+  for (int64_t i = 0; i < 2 * kWidth; ++i) {
+    grad_data[i] = 1.f;
+  }
+  auto* lr = scope.Var("LearningRate")->GetMutable<framework::LoDTensor>();
+  lr->mutable_data<float>({1}, place)[0] = 0.5f;
+
+  auto op = framework::OpRegistry::CreateOp(
+      "sgd", {{"Param", {"Param"}},
+              {"Grad", {"Grad"}},
+              {"LearningRate", {"LearningRate"}}},
+      {{"ParamOut", {"Param"}}}, framework::AttributeMap());
+  // the gradient of the evicted key is skipped
+  op->Run(scope, place);
+
+  ASSERT_FALSE(table->HasKey(2));
+  int64_t index = table->ExistingIndex(0);
+  ASSERT_GE(index, 0);
+  for (int64_t j = 0; j < kWidth; ++j) {
+    ASSERT_EQ(data[index * kWidth + j], 0.5f);
+  }
+  index = table->ExistingIndex(1);
+  ASSERT_GE(index, 0);
+  for (int64_t j = 0; j < kWidth; ++j) {
+    ASSERT_EQ(data[index * kWidth + j], 1.f);
+  }
+}
+
+}  // namespace operators
+}  // namespace paddle
@@ -61,11 +61,17 @@ class ShrinkRNNMemoryOp : public ArrayOp {
       framework::AppendLoD(out_lod, lod_offset.first);
     }
 
+    // The active sequences are the first rows of the memory, so the shrunk
+    // memory is a view of them unless it is on another device.
     if (dst_num_rows != 0) {
-      out_tensor.mutable_data(place, x_tensor.type());
-      auto dev_ctx = platform::DeviceContextPool::Instance().Get(place);
-      framework::TensorCopy(x_tensor.Slice(0, height), place, *dev_ctx,
-                            &out_tensor);
+      if (platform::is_same_place(x_tensor.place(), place)) {
+        out_tensor.ShareDataWith(x_tensor.Slice(0, height));
+      } else {
+        out_tensor.mutable_data(place, x_tensor.type());
+        auto dev_ctx = platform::DeviceContextPool::Instance().Get(place);
+        framework::TensorCopy(x_tensor.Slice(0, height), place, *dev_ctx,
+                              &out_tensor);
+      }
     }
   }
 };
@@ -0,0 +1,172 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/sparse_mul_op.h"
+#include <memory>
+#include "paddle/fluid/framework/var_type_inference.h"
+
+namespace paddle {
+namespace operators {
+
+class SparseMulOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("W"),
+                   "Input(W) of SparseMulOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("Ids"),
+                   "Input(Ids) of SparseMulOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                   "Output(Out) of SparseMulOp should not be null.");
+
+    auto table_dims = ctx->GetInputDim("W");
+    auto ids_dims = ctx->GetInputDim("Ids");
+    PADDLE_ENFORCE_EQ(table_dims.size(), 2);
+    PADDLE_ENFORCE_EQ(ids_dims.size(), 2);
+    PADDLE_ENFORCE_EQ(ids_dims[1], 1,
+                      "The last dimension of the 'Ids' tensor must be 1.");
+    if (ctx->HasInput("Values")) {
+      auto values_dims = ctx->GetInputDim("Values");
+      PADDLE_ENFORCE_EQ(values_dims.size(), 2);
+      PADDLE_ENFORCE_EQ(values_dims[1], 1,
+                        "The last dimension of the 'Values' tensor must be "
+                        "1.");
+    }
+
+    // The number of instances is only known at runtime.
+    ctx->SetOutputDim("Out", {-1, table_dims[1]});
+    if (ctx->IsRuntime()) {
+      auto* ids = boost::get<framework::Variable*>(
+                      ctx->GetInputVarPtrs("Ids")[0])
+                      ->GetMutable<framework::LoDTensor>();
+      PADDLE_ENFORCE_EQ(ids->lod().size(), 1UL,
+                        "The Ids of sparse_mul must have the offsets of the "
+                        "instances as the LoD");
+      ctx->SetOutputDim("Out",
+                        {static_cast<int64_t>(ids->lod()[0].size() - 1),
+                         table_dims[1]});
+    }
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    auto data_type = framework::GetDataTypeOfVar(ctx.InputVar("W"));
+    return framework::OpKernelType(data_type, ctx.device_context());
+  }
+};
+
+class SparseMulOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Ids",
+             "(LoDTensor) The int64 column ids of the nonzeros of the sparse "
+             "rows, of shape [nnz, 1]. The LoD is the offsets of the "
+             "nonzeros of each row.");
+    AddInput("Values",
+             "(LoDTensor, optional) The values of the nonzeros, of shape "
+             "[nnz, 1]. The nonzeros are ones if it is not given.")
+        .AsDispensable();
+    AddInput("W",
+             "(Tensor or SelectedRows) The dense matrix of shape [width, "
+             "size], a learnable parameter. A SelectedRows W must have the "
+             "rows of the ids, such as the rows prefetched from the "
+             "pservers.");
+    AddOutput("Out",
+              "(Tensor) The product of the sparse rows and W, of shape "
+              "[number of rows, size].");
+    AddAttr<bool>("is_sparse",
+                  "(boolean, default false) Sparse update.")
+        .SetDefault(false);
+    AddComment(R"DOC(
+Sparse Mul Operator.
+
+Multiply a sparse matrix in the CSR format by the dense matrix W, where the
+row i of the sparse matrix has the nonzeros Values[k] at the columns Ids[k]
+for k in [lod[i], lod[i + 1]):
+
+$$Out[i] = \sum_{k} Values[k] * W[Ids[k]]$$
+
+It is the linear layer of the wide models over millions of hashed features,
+in place of a lookup_table and a sequence_pool, and its cost scales with the
+nonzeros rather than the width. The gradient of W is a SelectedRows of the
+rows of the ids if is_sparse, there is no gradient of Values.
+
+)DOC");
+  }
+};
+
+class SparseMulGradOpDescMaker : public framework::SingleGradOpDescMaker {
+ public:
+  using framework::SingleGradOpDescMaker::SingleGradOpDescMaker;
+
+ protected:
+  std::unique_ptr<framework::OpDesc> Apply() const override {
+    auto* op = new framework::OpDesc();
+    op->SetType("sparse_mul_grad");
+    op->SetInput("Ids", Input("Ids"));
+    op->SetInput("Values", Input("Values"));
+    op->SetInput("W", Input("W"));
+    op->SetInput(framework::GradVarName("Out"), OutputGrad("Out"));
+    op->SetOutput(framework::GradVarName("W"), InputGrad("W"));
+    op->SetAttrMap(Attrs());
+    return std::unique_ptr<framework::OpDesc>(op);
+  }
+};
+
+class SparseMulOpGrad : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    ctx->SetOutputDim(framework::GradVarName("W"), ctx->GetInputDim("W"));
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    auto data_type = framework::GetDataTypeOfVar(
+        ctx.InputVar(framework::GradVarName("Out")));
+    return framework::OpKernelType(data_type, ctx.device_context());
+  }
+};
+
+class SparseMulOpGradVarTypeInference : public framework::VarTypeInference {
+ public:
+  void operator()(const framework::OpDesc& op_desc,
+                  framework::BlockDesc* block) const override {
+    auto out_var_name = op_desc.Output(framework::GradVarName("W")).front();
+    bool is_sparse = boost::get<bool>(op_desc.GetAttr("is_sparse"));
+    block->Var(out_var_name)
+        ->SetType(is_sparse ? framework::proto::VarType::SELECTED_ROWS
+                            : framework::proto::VarType::LOD_TENSOR);
+    block->Var(out_var_name)
+        ->SetDataType(block->Var(op_desc.Input("W")[0])->GetDataType());
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(sparse_mul, ops::SparseMulOp, ops::SparseMulGradOpDescMaker,
+                  ops::SparseMulOpMaker);
+REGISTER_OPERATOR(sparse_mul_grad, ops::SparseMulOpGrad,
+                  ops::SparseMulOpGradVarTypeInference);
+
+REGISTER_OP_CPU_KERNEL(sparse_mul, ops::SparseMulKernel<float>,
+                       ops::SparseMulKernel<double>);
+REGISTER_OP_CPU_KERNEL(sparse_mul_grad, ops::SparseMulGradKernel<float>,
+                       ops::SparseMulGradKernel<double>);
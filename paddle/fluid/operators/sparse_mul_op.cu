@@ -0,0 +1,164 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include "paddle/fluid/framework/eigen.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/sparse_mul_op.h"
+#include "paddle/fluid/platform/assert.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+// threadIdx.x runs over the columns of a row of the sparse matrix, and
+// threadIdx.y over the rows.
+static dim3 SparseMulThreads(int64_t row_width) {
+  int x = static_cast<int>(std::min<int64_t>(row_width, 32));
+  return dim3(x, 256 / x);
+}
+
+static dim3 SparseMulGrids(const dim3 &threads, int64_t num_instances) {
+  int64_t y = (num_instances + threads.y - 1) / threads.y;
+  return dim3(1, static_cast<int>(std::min<int64_t>(std::max<int64_t>(y, 1),
+                                                    65535)));
+}
+
+template <typename T>
+__global__ void SparseMul(T *output, const T *table, const int64_t *ids,
+                          const T *values, const size_t *offsets,
+                          const int64_t height, const int64_t num_instances,
+                          const int64_t D) {
+  for (int64_t i = blockIdx.y * blockDim.y + threadIdx.y; i < num_instances;
+       i += gridDim.y * blockDim.y) {
+    for (int64_t j = threadIdx.x; j < D; j += blockDim.x) {
+      T sum = 0;
+      for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+        int64_t id = ids[k];
+        PADDLE_ASSERT(id >= 0);
+        PADDLE_ASSERT(id < height);
+        T value = values ? values[k] : static_cast<T>(1);
+        sum += value * table[id * D + j];
+      }
+      output[i * D + j] = sum;
+    }
+  }
+}
+
+// A row of gradient per nonzero if Sparse, otherwise the gradients are
+// added to the rows of the ids.
+template <typename T, bool Sparse>
+__global__ void SparseMulGrad(T *d_table, const T *d_output,
+                              const int64_t *ids, const T *values,
+                              const size_t *offsets,
+                              const int64_t num_instances, const int64_t D) {
+  for (int64_t i = blockIdx.y * blockDim.y + threadIdx.y; i < num_instances;
+       i += gridDim.y * blockDim.y) {
+    for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+      T value = values ? values[k] : static_cast<T>(1);
+      T *dst = d_table + (Sparse ? k : ids[k]) * D;
+      for (int64_t j = threadIdx.x; j < D; j += blockDim.x) {
+        if (Sparse) {
+          dst[j] = value * d_output[i * D + j];
+        } else {
+          paddle::platform::CudaAtomicAdd(&dst[j], value * d_output[i * D + j]);
+        }
+      }
+    }
+  }
+}
+
+template <typename T>
+class SparseMulCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    PADDLE_ENFORCE(context.InputVar("W")->IsType<LoDTensor>(),
+                   "The W of sparse_mul must be a dense tensor on GPU");
+    auto *table_t = context.Input<LoDTensor>("W");
+    auto *ids_t = context.Input<LoDTensor>("Ids");
+    auto *output_t = context.Output<LoDTensor>("Out");
+
+    const auto &offsets = SparseMulOffsets(*ids_t);
+    int64_t num_instances = offsets.size() - 1;
+    int64_t D = table_t->dims()[1];
+    auto *output = output_t->mutable_data<T>(context.GetPlace());
+
+    auto threads = SparseMulThreads(D);
+    auto grids = SparseMulGrids(threads, num_instances);
+    SparseMul<T><<<grids, threads, 0,
+                   context.cuda_device_context().stream()>>>(
+        output, table_t->data<T>(), ids_t->data<int64_t>(),
+        SparseMulValues<T>(context, *ids_t),
+        offsets.CUDAData(context.GetPlace()), table_t->dims()[0],
+        num_instances, D);
+  }
+};
+
+template <typename T>
+class SparseMulGradCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto &dev_ctx =
+        context.template device_context<platform::CUDADeviceContext>();
+    auto *table_t = context.Input<LoDTensor>("W");
+    auto *ids_t = context.Input<LoDTensor>("Ids");
+    auto *d_output_t = context.Input<LoDTensor>(framework::GradVarName("Out"));
+
+    const auto &offsets = SparseMulOffsets(*ids_t);
+    int64_t num_instances = offsets.size() - 1;
+    int64_t D = table_t->dims()[1];
+    const int64_t *ids = ids_t->data<int64_t>();
+    const T *values = SparseMulValues<T>(context, *ids_t);
+    const size_t *offsets_data = offsets.CUDAData(context.GetPlace());
+    auto threads = SparseMulThreads(D);
+    auto grids = SparseMulGrids(threads, num_instances);
+
+    if (context.Attr<bool>("is_sparse")) {
+      auto *d_table = context.Output<SelectedRows>(framework::GradVarName("W"));
+      int64_t nnz = ids_t->numel();
+      // The rows are not merged, like the sparse gradient of lookup_table.
+      framework::Vector<int64_t> rows;
+      rows.resize(nnz);
+      auto gpu_place = boost::get<platform::CUDAPlace>(context.GetPlace());
+      memory::Copy(gpu_place, rows.CUDAMutableData(context.GetPlace()),
+                   gpu_place, ids, nnz * sizeof(int64_t), dev_ctx.stream());
+      d_table->set_rows(rows);
+      d_table->set_height(table_t->dims()[0]);
+
+      auto *d_table_value = d_table->mutable_value();
+      d_table_value->Resize({nnz, D});
+      T *d_table_data = d_table_value->mutable_data<T>(context.GetPlace());
+      SparseMulGrad<T, true><<<grids, threads, 0, dev_ctx.stream()>>>(
+          d_table_data, d_output_t->data<T>(), ids, values, offsets_data,
+          num_instances, D);
+    } else {
+      auto *d_table_t = context.Output<LoDTensor>(framework::GradVarName("W"));
+      T *d_table = d_table_t->mutable_data<T>(context.GetPlace());
+      auto t = framework::EigenVector<T>::Flatten(*d_table_t);
+      t.device(*dev_ctx.eigen_device()) = t.constant(static_cast<T>(0));
+      SparseMulGrad<T, false><<<grids, threads, 0, dev_ctx.stream()>>>(
+          d_table, d_output_t->data<T>(), ids, values, offsets_data,
+          num_instances, D);
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(sparse_mul, ops::SparseMulCUDAKernel<float>,
+                        ops::SparseMulCUDAKernel<double>);
+REGISTER_OP_CUDA_KERNEL(sparse_mul_grad, ops::SparseMulGradCUDAKernel<float>,
+                        ops::SparseMulGradCUDAKernel<double>);
@@ -0,0 +1,181 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/operators/lookup_table_op.h"
+
+namespace paddle {
+namespace operators {
+
+// The offsets of the nonzeros of each instance in the Ids of sparse_mul.
+inline const framework::Vector<size_t> &SparseMulOffsets(const LoDTensor &ids) {
+  PADDLE_ENFORCE_EQ(ids.lod().size(), 1UL,
+                    "The Ids of sparse_mul must have the offsets of the "
+                    "instances as the LoD");
+  PADDLE_ENFORCE_EQ(ids.lod()[0].back(), static_cast<size_t>(ids.numel()));
+  return ids.lod()[0];
+}
+
+// The values of the nonzeros, nullptr if they are all ones.
+template <typename T>
+const T *SparseMulValues(const framework::ExecutionContext &context,
+                         const LoDTensor &ids) {
+  if (!context.HasInput("Values")) return nullptr;
+  auto *values_t = context.Input<LoDTensor>("Values");
+  PADDLE_ENFORCE_EQ(values_t->numel(), ids.numel(),
+                    "The Values of sparse_mul must match the Ids");
+  return values_t->data<T>();
+}
+
+template <typename T>
+class SparseMulKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *ids_t = context.Input<LoDTensor>("Ids");
+    auto *output_t = context.Output<LoDTensor>("Out");
+    auto *table_var = context.InputVar("W");
+
+    const auto &offsets = SparseMulOffsets(*ids_t);
+    const auto *ids = ids_t->data<int64_t>();
+    const T *values = SparseMulValues<T>(context, *ids_t);
+    const int64_t nnz = ids_t->numel();
+
+    // The rows of the table of the nonzeros.
+    const Tensor *table_t;
+    std::vector<int64_t> rows(nnz);
+    if (table_var->IsType<LoDTensor>()) {
+      table_t = &table_var->Get<LoDTensor>();
+      int64_t height = table_t->dims()[0];
+      for (int64_t k = 0; k < nnz; ++k) {
+        PADDLE_ENFORCE(ids[k] >= 0 && ids[k] < height,
+                       "The id %d of sparse_mul is out of [0, %d)", ids[k],
+                       height);
+        rows[k] = ids[k];
+      }
+    } else {
+      const auto &table = table_var->Get<SelectedRows>();
+      table_t = &table.value();
+      for (int64_t k = 0; k < nnz; ++k) {
+        rows[k] = table.Index(ids[k]);
+        PADDLE_ENFORCE_GE(rows[k], 0, "The id %d does not exist in W",
+                          ids[k]);
+      }
+    }
+    int64_t row_width = table_t->dims()[1];
+    const T *table = table_t->data<T>();
+    T *output = output_t->mutable_data<T>(context.GetPlace());
+
+    auto &dev_ctx =
+        context.template device_context<platform::CPUDeviceContext>();
+    const int64_t num_instances = offsets.size() - 1;
+    dev_ctx.ParallelFor(
+        num_instances,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            T *dst = output + i * row_width;
+            std::fill(dst, dst + row_width, static_cast<T>(0));
+            for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+              const T *src = table + rows[k] * row_width;
+              T value = values ? values[k] : static_cast<T>(1);
+              for (int64_t j = 0; j < row_width; ++j) {
+                dst[j] += value * src[j];
+              }
+            }
+          }
+        },
+        row_width * nnz / std::max<int64_t>(num_instances, 1));
+  }
+};
+
+template <typename T>
+class SparseMulGradKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *ids_t = context.Input<LoDTensor>("Ids");
+    auto *d_output_t = context.Input<LoDTensor>(framework::GradVarName("Out"));
+    auto *table_var = context.InputVar("W");
+
+    const auto &offsets = SparseMulOffsets(*ids_t);
+    const auto *ids = ids_t->data<int64_t>();
+    const T *values = SparseMulValues<T>(context, *ids_t);
+    const T *d_output = d_output_t->data<T>();
+    const int64_t nnz = ids_t->numel();
+    const int64_t num_instances = offsets.size() - 1;
+    auto &dev_ctx =
+        context.template device_context<platform::CPUDeviceContext>();
+
+    if (context.Attr<bool>("is_sparse")) {
+      int64_t height, row_width;
+      if (table_var->IsType<LoDTensor>()) {
+        height = table_var->Get<LoDTensor>().dims()[0];
+        row_width = table_var->Get<LoDTensor>().dims()[1];
+      } else {
+        height = table_var->Get<SelectedRows>().height();
+        row_width = table_var->Get<SelectedRows>().value().dims()[1];
+      }
+      // A row of gradient per nonzero, merged by the ids.
+      Tensor expanded;
+      T *expanded_data = expanded.mutable_data<T>(
+          framework::make_ddim({nnz, row_width}), context.GetPlace());
+      dev_ctx.ParallelFor(
+          num_instances,
+          [&](int64_t begin, int64_t end) {
+            for (int64_t i = begin; i < end; ++i) {
+              const T *src = d_output + i * row_width;
+              for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+                T value = values ? values[k] : static_cast<T>(1);
+                T *dst = expanded_data + k * row_width;
+                for (int64_t j = 0; j < row_width; ++j) {
+                  dst[j] = value * src[j];
+                }
+              }
+            }
+          },
+          row_width * nnz / std::max<int64_t>(num_instances, 1));
+      auto *d_table =
+          context.Output<SelectedRows>(framework::GradVarName("W"));
+      d_table->set_height(height);
+      MergeRowsGrad(dev_ctx, ids, nnz, row_width, expanded_data, d_table);
+    } else {
+      PADDLE_ENFORCE(table_var->IsType<LoDTensor>(),
+                     "The dense gradient of sparse_mul requires a dense W");
+      auto *d_table_t = context.Output<LoDTensor>(framework::GradVarName("W"));
+      int64_t height = d_table_t->dims()[0];
+      int64_t row_width = d_table_t->dims()[1];
+      T *d_table = d_table_t->mutable_data<T>(context.GetPlace());
+      std::fill(d_table, d_table + d_table_t->numel(), static_cast<T>(0));
+      for (int64_t i = 0; i < num_instances; ++i) {
+        const T *src = d_output + i * row_width;
+        for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+          PADDLE_ENFORCE(ids[k] >= 0 && ids[k] < height);
+          T value = values ? values[k] : static_cast<T>(1);
+          T *dst = d_table + ids[k] * row_width;
+          for (int64_t j = 0; j < row_width; ++j) {
+            dst[j] += value * src[j];
+          }
+        }
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
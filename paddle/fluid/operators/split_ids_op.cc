@@ -25,6 +25,11 @@ class SplitIdsOpMaker : public framework::OpProtoAndCheckerMaker {
 
     AddOutput("Out", "(LoDTensors) The outputs of the input Ids.")
         .AsDuplicable();
+    AddOutput("Index",
+              "(LoDTensor) the row of each input id in the concatenated "
+              "outputs with shape{batch_num, 1}, which merge_ids uses to "
+              "restore the order. Only for the LoDTensor Ids.")
+        .AsDispensable();
 
     AddComment(R"DOC(
 Split a LoDTensor of Ids into multi LoDTensors, the number is pserver's number
@@ -41,6 +46,7 @@ Example:
         out0 = [3, 6]
         out1 = [1, 4]
         out2 = [2, 5]
+  Index = [2, 4, 0, 3, 5, 1, 4, 0]
 )DOC");
   }
 };
@@ -58,6 +64,15 @@ class SplitIdsOp : public framework::OperatorWithKernel {
     if (ids_var_type == framework::proto::VarType::LOD_TENSOR) {
       PADDLE_ENFORCE_EQ(ids_dims[0].size(), 2);
     }
+    if (ctx->HasOutput("Index")) {
+      PADDLE_ENFORCE_EQ(ids_var_type, framework::proto::VarType::LOD_TENSOR,
+                        "only the LoDTensor Ids have the Index");
+      int64_t batch_size = 0;
+      for (auto &dims : ids_dims) {
+        batch_size = dims[0] < 0 || batch_size < 0 ? -1 : batch_size + dims[0];
+      }
+      ctx->SetOutputDim("Index", framework::make_ddim({batch_size, 1}));
+    }
   }
 
  protected:
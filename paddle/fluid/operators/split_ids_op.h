@@ -14,16 +14,20 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
 #include <iterator>
-#include <set>
-#include <unordered_map>
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
+#include "paddle/fluid/platform/for_range.h"
 
 namespace paddle {
 namespace operators {
 
+// The ids are partitioned to the shards by the blocks of this size, the ids
+// of each block keep their order in the shards.
+constexpr int64_t kSplitIdsBlockSize = 4096;
+
 template <typename DeviceContext, typename T>
 class SplitIdsOpKernel : public framework::OpKernel<T> {
  public:
@@ -33,6 +37,7 @@ class SplitIdsOpKernel : public framework::OpKernel<T> {
       PADDLE_THROW("SplitIds do not support GPU kernel");
     }
 
+    auto &dev_ctx = ctx.template device_context<platform::CPUDeviceContext>();
     const auto ids_vars = ctx.MultiInputVar("Ids");
 
     PADDLE_ENFORCE_GT(ids_vars.size(), 0, "The number of Ids should > 0");
@@ -55,30 +60,88 @@ class SplitIdsOpKernel : public framework::OpKernel<T> {
         offset += ids->numel();
       }
 
-      std::set<T> st(all_ids.begin(), all_ids.end());
-      all_ids.assign(st.begin(), st.end());
+      std::vector<T> uniq_ids(all_ids);
+      std::sort(uniq_ids.begin(), uniq_ids.end());
+      uniq_ids.erase(std::unique(uniq_ids.begin(), uniq_ids.end()),
+                     uniq_ids.end());
+      const int64_t uniq_num = static_cast<int64_t>(uniq_ids.size());
 
       auto outs = ctx.MultiOutput<framework::LoDTensor>("Out");
       const size_t shard_num = outs.size();
-      std::vector<std::vector<T>> out_ids;
-      out_ids.resize(outs.size());
-
-      // split id by their shard_num.
-      for (int i = 0; i < all_ids.size(); ++i) {
-        T id = all_ids[i];
-        size_t shard_id = static_cast<size_t>(id) % shard_num;
-        out_ids[shard_id].push_back(id);
+      auto shard_of = [shard_num](T id) {
+        return static_cast<size_t>(id) % shard_num;
+      };
+
+      // Count the ids of each block in the shards.
+      const int64_t block_num =
+          (uniq_num + kSplitIdsBlockSize - 1) / kSplitIdsBlockSize;
+      std::vector<int64_t> offsets(block_num * shard_num, 0);
+      platform::ParallelFor(
+          dev_ctx, block_num,
+          [&](int64_t begin, int64_t end) {
+            for (int64_t b = begin; b < end; ++b) {
+              int64_t *count = offsets.data() + b * shard_num;
+              int64_t last = std::min(uniq_num, (b + 1) * kSplitIdsBlockSize);
+              for (int64_t i = b * kSplitIdsBlockSize; i < last; ++i) {
+                ++count[shard_of(uniq_ids[i])];
+              }
+            }
+          },
+          kSplitIdsBlockSize);
+
+      // Turn the counts into the offsets of the blocks in the shards, and
+      // create tensor for each shard to send to parameter server.
+      std::vector<T *> shard_data(shard_num);
+      std::vector<int64_t> shard_begin(shard_num);
+      int64_t shard_end = 0;
+      for (size_t s = 0; s < shard_num; ++s) {
+        int64_t rows = 0;
+        for (int64_t b = 0; b < block_num; ++b) {
+          int64_t count = offsets[b * shard_num + s];
+          offsets[b * shard_num + s] = rows;
+          rows += count;
+        }
+        shard_data[s] =
+            outs[s]->mutable_data<T>(framework::make_ddim({rows, 1}), place);
+        shard_begin[s] = shard_end;
+        shard_end += rows;
       }
 
-      // create tensor for each shard and send to parameter server
-      for (size_t i = 0; i < out_ids.size(); ++i) {
-        auto *shard_t = outs[i];
-        std::vector<T> ids = out_ids[i];
-        auto *shard_data = shard_t->mutable_data<T>(
-            framework::make_ddim({static_cast<int64_t>(ids.size()), 1}), place);
-        for (size_t i = 0; i < ids.size(); ++i) {
-          shard_data[i] = ids[i];
-        }
+      // Scatter the ids to the shards, recording the row of each id in the
+      // concatenated outputs if the Index is required.
+      bool has_index = ctx.HasOutput("Index");
+      std::vector<int64_t> uniq_rows(has_index ? uniq_num : 0);
+      platform::ParallelFor(
+          dev_ctx, block_num,
+          [&](int64_t begin, int64_t end) {
+            for (int64_t b = begin; b < end; ++b) {
+              std::vector<int64_t> pos(offsets.begin() + b * shard_num,
+                                       offsets.begin() + (b + 1) * shard_num);
+              int64_t last = std::min(uniq_num, (b + 1) * kSplitIdsBlockSize);
+              for (int64_t i = b * kSplitIdsBlockSize; i < last; ++i) {
+                size_t s = shard_of(uniq_ids[i]);
+                shard_data[s][pos[s]] = uniq_ids[i];
+                if (has_index) uniq_rows[i] = shard_begin[s] + pos[s];
+                ++pos[s];
+              }
+            }
+          },
+          kSplitIdsBlockSize);
+
+      if (has_index) {
+        auto *index = ctx.Output<framework::LoDTensor>("Index");
+        int64_t *index_data = index->mutable_data<int64_t>(
+            framework::make_ddim({batch_size, 1}), place);
+        platform::ParallelFor(dev_ctx, batch_size,
+                              [&](int64_t begin, int64_t end) {
+                                for (int64_t i = begin; i < end; ++i) {
+                                  auto it = std::lower_bound(uniq_ids.begin(),
+                                                             uniq_ids.end(),
+                                                             all_ids[i]);
+                                  index_data[i] =
+                                      uniq_rows[it - uniq_ids.begin()];
+                                }
+                              });
       }
     } else if (ids_var->IsType<framework::SelectedRows>()) {
       const auto *ids_selected_rows = ctx.Input<framework::SelectedRows>("Ids");
@@ -93,25 +156,31 @@ class SplitIdsOpKernel : public framework::OpKernel<T> {
       for (auto &out : outs) {
         out->mutable_rows()->clear();
       }
-      // get rows for outputs
-      std::unordered_map<int64_t, size_t> id_to_index;
+      // get rows for outputs, and the input row of each output row
+      std::vector<std::vector<size_t>> src_rows(shard_num);
       for (size_t i = 0; i < ids_rows.size(); ++i) {
-        id_to_index[ids_rows[i]] = i;
         size_t shard_id = static_cast<size_t>(ids_rows[i]) % shard_num;
         outs[shard_id]->mutable_rows()->push_back(ids_rows[i]);
+        src_rows[shard_id].push_back(i);
       }
 
       int64_t row_width = ids_dims[1];
-      for (auto &out : outs) {
+      for (size_t s = 0; s < shard_num; ++s) {
+        auto *out = outs[s];
         out->set_height(ids_selected_rows->height());
         framework::DDim ddim = framework::make_ddim(
             {static_cast<int64_t>(out->rows().size()), row_width});
         T *output = out->mutable_value()->mutable_data<T>(ddim, place);
-        for (int64_t i = 0; i < ddim[0]; ++i) {
-          memcpy(output + i * row_width,
-                 ids_data + id_to_index[out->rows()[i]] * row_width,
-                 row_width * sizeof(T));
-        }
+        const auto &src = src_rows[s];
+        platform::ParallelFor(dev_ctx, ddim[0],
+                              [&](int64_t begin, int64_t end) {
+                                for (int64_t i = begin; i < end; ++i) {
+                                  memcpy(output + i * row_width,
+                                         ids_data + src[i] * row_width,
+                                         row_width * sizeof(T));
+                                }
+                              },
+                              row_width);
       }
     }
   }
@@ -40,7 +40,8 @@ class SplitOpKernel : public framework::OpKernel<T> {
 
     auto& dev_ctx = ctx.template device_context<DeviceContext>();
     // Sometimes direct copies will be faster, this maybe need deeply analysis.
-    if (axis == 0 && outs.size() < 10) {
+    // On GPU the SplitFunctor copies all the outputs in one launch.
+    if (axis == 0 && outs.size() < 10 && platform::is_cpu_place(place)) {
       StridedMemcpyWithAxis0<T>(dev_ctx, *in, shape_refer, &outs);
     } else {
       math::SplitFunctor<DeviceContext, T> functor;
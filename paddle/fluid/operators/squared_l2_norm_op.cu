@@ -13,12 +13,29 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #define EIGEN_USE_GPU
+#include "paddle/fluid/operators/reduce_op.cu.h"
 #include "paddle/fluid/operators/squared_l2_norm_op.h"
 
+namespace paddle {
+namespace operators {
+
+// Out = sum(square(X)), square is fused into the reduction.
+template <typename T>
+class SquaredL2NormCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *x = context.Input<framework::Tensor>("X");
+    auto *out = context.Output<framework::Tensor>("Out");
+    out->mutable_data<T>(context.GetPlace());
+    ReduceAllCUDA<T>(context, *x, out, SquareFunctor<T>());
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
 namespace ops = paddle::operators;
-REGISTER_OP_CUDA_KERNEL(
-    squared_l2_norm,
-    ops::SquaredL2NormKernel<paddle::platform::CUDADeviceContext, float>);
+REGISTER_OP_CUDA_KERNEL(squared_l2_norm, ops::SquaredL2NormCUDAKernel<float>);
 REGISTER_OP_CUDA_KERNEL(
     squared_l2_norm_grad,
     ops::SquaredL2NormGradKernel<paddle::platform::CUDADeviceContext, float>);
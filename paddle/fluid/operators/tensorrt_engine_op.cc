@@ -21,7 +21,13 @@
 
 namespace paddle {
 
-DEFINE_int32(tensorrt_engine_batch_size, 1, "the batch_size of TensorRT");
+DEFINE_int32(tensorrt_engine_batch_size, 1,
+             "the batch_size of TensorRT, deprecated since the batch size is "
+             "taken from the inputs of the engine");
+DEFINE_string(tensorrt_engine_cache_dir, "",
+              "the directory caching the serialized TensorRT engines of a "
+              "model, so that the restarted processes skip the building. "
+              "Disabled if empty.");
 
 namespace operators {
 
@@ -34,6 +40,10 @@ class TensorRTEngineOpMaker : public framework::OpProtoAndCheckerMaker {
     AddAttr<std::string>("engine_uniq_key", "unique key for the TRT engine.");
     AddAttr<int>("max_batch_size", "the maximum batch size.");
     AddAttr<int>("workspace_size", "the workspace size.");
+    AddAttr<std::string>("precision_mode",
+                         "FP32 or INT8, the INT8 engine is calibrated with "
+                         "the inputs recorded in the calibration runs.")
+        .SetDefault("FP32");
     AddComment("TensorRT engine operator.");
   }
 };
@@ -16,18 +16,30 @@
 
 #ifdef PADDLE_WITH_CUDA
 
+#include <unistd.h>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/inference/analysis/helper.h"
 #include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
 #include "paddle/fluid/inference/tensorrt/engine.h"
+#include "paddle/fluid/inference/tensorrt/trt_int8_calibrator.h"
+#include "paddle/fluid/platform/gpu_info.h"
 
 namespace paddle {
 
 DECLARE_int32(tensorrt_engine_batch_size);
+DECLARE_string(tensorrt_engine_cache_dir);
 
 namespace operators {
 
@@ -60,10 +72,52 @@ nvinfer1::Dims Vec2TRT_Dims(const std::vector<int64_t>& shape) {
   return nvinfer1::DimsCHW(shape[1], 1, 1);
 }
 
+// The key of the engine for the inputs of the shapes, the batch dim is
+// dropped since an engine runs any batch size up to its max_batch_size.
+std::string ShapeKey(const std::vector<std::vector<int64_t>>& shapes) {
+  std::string key;
+  for (auto& shape : shapes) {
+    key += "_";
+    for (size_t i = 1; i < shape.size(); ++i) {
+      if (i > 1) key += "x";
+      key += std::to_string(shape[i]);
+    }
+  }
+  return key;
+}
+
+bool ReadFile(const std::string& path, std::string* data) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return false;
+  data->assign(std::istreambuf_iterator<char>(file),
+               std::istreambuf_iterator<char>());
+  return !file.bad();
+}
+
+// Write to a temporary file first, so that the processes sharing the cache
+// never read a partial engine.
+void WriteFile(const std::string& path, const std::string& data) {
+  std::string tmp_path = path + ".tmp" + std::to_string(getpid());
+  {
+    std::ofstream file(tmp_path, std::ios::binary);
+    file.write(data.data(), data.size());
+    if (!file) {
+      LOG(WARNING) << "fail to write the TensorRT engine cache " << tmp_path;
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "fail to write the TensorRT engine cache " << path;
+    std::remove(tmp_path.c_str());
+  }
+}
+
 }  // namespace
 
 using inference::Singleton;
 using inference::tensorrt::TRT_EngineManager;
+using inference::tensorrt::TRTCalibrationStore;
+using inference::tensorrt::TRTInt8Calibrator;
 
 class TensorRTEngineOp : public framework::OperatorWithKernel {
  public:
@@ -89,15 +143,9 @@ template <typename DeviceContext, typename T>
 class TensorRTEngineKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext& context) const override {
-    auto engine_name = context.Attr<std::string>("engine_uniq_key");
     int max_batch_size = context.Attr<int>("max_batch_size");
-    if (!Singleton<TRT_EngineManager>::Global().HasEngine(engine_name)) {
-      Prepare(context);
-    }
-    auto* engine = Singleton<TRT_EngineManager>::Global().Get(engine_name);
     auto input_names = context.op().Inputs("Xs");
     PADDLE_ENFORCE(!input_names.empty(), "should pass more than one inputs");
-    PADDLE_ENFORCE_LE(FLAGS_tensorrt_engine_batch_size, max_batch_size);
 
     std::vector<std::string> output_maps =
         context.Attr<std::vector<std::string>>("output_name_mapping");
@@ -107,6 +155,32 @@ class TensorRTEngineKernel : public framework::OpKernel<T> {
     for (const auto& param : params) {
       parameters.insert(param);
     }
+    // The engines are built for the shapes of the inputs, and the batch size
+    // is the first dim of them.
+    std::vector<std::vector<int64_t>> input_shapes;
+    for (const auto& x : input_names) {
+      if (parameters.count(x)) continue;
+      auto& t = inference::analysis::GetFromScope<framework::LoDTensor>(
+          context.scope(), x);
+      input_shapes.push_back(framework::vectorize(t.dims()));
+    }
+    PADDLE_ENFORCE(!input_shapes.empty() && !input_shapes[0].empty(),
+                   "the inputs of TensorRT engine are not set");
+    int batch_size = static_cast<int>(input_shapes[0][0]);
+    PADDLE_ENFORCE_GT(batch_size, 0);
+    PADDLE_ENFORCE_LE(batch_size, max_batch_size);
+    if (context.Attr<std::string>("precision_mode") == "INT8" &&
+        Singleton<TRTCalibrationStore>::Global().calibrating()) {
+      Calibrate(context, parameters);
+      return;
+    }
+
+    auto engine_name =
+        context.Attr<std::string>("engine_uniq_key") + ShapeKey(input_shapes);
+    if (!Singleton<TRT_EngineManager>::Global().HasEngine(engine_name)) {
+      Prepare(context, engine_name, input_shapes);
+    }
+    auto* engine = Singleton<TRT_EngineManager>::Global().Get(engine_name);
     // Convert input tensor from fluid to engine.
     for (const auto& x : context.Inputs("Xs")) {
       if (parameters.count(x)) continue;
@@ -122,8 +196,7 @@ class TensorRTEngineKernel : public framework::OpKernel<T> {
       }
     }
     // Execute the engine.
-    PADDLE_ENFORCE_GT(FLAGS_tensorrt_engine_batch_size, 0);
-    engine->Execute(FLAGS_tensorrt_engine_batch_size);
+    engine->Execute(batch_size);
 
     // Convert output tensor from engine to fluid
     int output_index = 0;
@@ -131,12 +204,11 @@ class TensorRTEngineKernel : public framework::OpKernel<T> {
     for (const auto& y : context.Outputs("Ys")) {
       VLOG(4) << y;
       // convert output and copy to fluid.
-      nvinfer1::ITensor* trt_t = engine->GetITensor(output_maps[output_index]);
-      auto dims = trt_t->getDimensions();
-      // Use the output ITensor's dims to reshape the Fluid Tensor.
-      // The ITensor doesn't contain the batch size dim.
+      auto dims = engine->GetBindingDims(output_maps[output_index]);
+      // Use the output binding's dims to reshape the Fluid Tensor.
+      // The binding doesn't contain the batch size dim.
       std::vector<int> ddim;
-      ddim.push_back(FLAGS_tensorrt_engine_batch_size);
+      ddim.push_back(batch_size);
       for (int i = 0; i < dims.nbDims; i++) {
         ddim.push_back(dims.d[i]);
       }
@@ -151,8 +223,8 @@ class TensorRTEngineKernel : public framework::OpKernel<T> {
       // tensor.
       // if (platform::is_cpu_place(fluid_t->place())) {
       // TODO(Superjomn) change this float to dtype size.
-      auto size = inference::analysis::AccuDims(dims.d, dims.nbDims) *
-                  FLAGS_tensorrt_engine_batch_size;
+      auto size =
+          inference::analysis::AccuDims(dims.d, dims.nbDims) * batch_size;
       engine->GetOutputInGPU(
           output_maps[output_index],
           fluid_t->mutable_data<float>(platform::CUDAPlace(
@@ -166,8 +238,86 @@ class TensorRTEngineKernel : public framework::OpKernel<T> {
   }
 
  protected:
-  void Prepare(const framework::ExecutionContext& context) const {
-    VLOG(4) << "Prepare engine";
+  // The file caching the serialized engine, empty if the cache is disabled.
+  // The cache directory should only hold the engines of one model, since
+  // the weights are not in the key.
+  std::string CachePath(const framework::ExecutionContext& context,
+                        const std::string& shape_key) const {
+    if (FLAGS_tensorrt_engine_cache_dir.empty()) return "";
+    std::string key = context.Attr<std::string>("subgraph") + shape_key +
+                      "_" +
+                      std::to_string(context.Attr<int>("max_batch_size")) +
+                      "_" +
+                      std::to_string(context.Attr<int>("workspace_size"));
+    auto precision_mode = context.Attr<std::string>("precision_mode");
+    if (precision_mode != "FP32") key += "_" + precision_mode;
+    int device = boost::get<platform::CUDAPlace>(context.GetPlace()).device;
+    return FLAGS_tensorrt_engine_cache_dir + "/trt_" +
+           std::to_string(std::hash<std::string>()(key)) + "_sm" +
+           std::to_string(platform::GetCUDAComputeCapability(device)) + "_v" +
+           std::to_string(NV_TENSORRT_VERSION) + ".engine";
+  }
+
+  // The file caching the INT8 calibration table of the sub-graph, which is
+  // shared by the engines of all the input shapes and GPU models.
+  std::string CalibrationTablePath(
+      const framework::ExecutionContext& context) const {
+    if (FLAGS_tensorrt_engine_cache_dir.empty()) return "";
+    return FLAGS_tensorrt_engine_cache_dir + "/trt_" +
+           std::to_string(std::hash<std::string>()(
+               context.Attr<std::string>("subgraph"))) +
+           "_v" + std::to_string(NV_TENSORRT_VERSION) + ".calib";
+  }
+
+  // Record the inputs to calibrate the INT8 engine with, and run the
+  // sub-graph in fluid to produce the outputs for the operators after it.
+  void Calibrate(const framework::ExecutionContext& context,
+                 const std::unordered_set<std::string>& parameters) const {
+    std::map<std::string, const framework::Tensor*> inputs;
+    for (const auto& x : context.Inputs("Xs")) {
+      if (parameters.count(x)) continue;
+      inputs[x] = &inference::analysis::GetFromScope<framework::LoDTensor>(
+          context.scope(), x);
+    }
+    Singleton<TRTCalibrationStore>::Global().Record(
+        context.Attr<std::string>("engine_uniq_key"), inputs);
+
+    framework::proto::BlockDesc block_desc;
+    block_desc.ParseFromString(context.Attr<std::string>("subgraph"));
+    // The variables inside the sub-graph are renamed, create them in a local
+    // scope.
+    auto& scope = context.scope().NewScope();
+    for (auto& op_desc : block_desc.ops()) {
+      for (auto& output : op_desc.outputs()) {
+        for (auto& name : output.arguments()) {
+          scope.Var(name);
+        }
+      }
+    }
+    for (auto& op_desc : block_desc.ops()) {
+      framework::OpRegistry::CreateOp(op_desc)->Run(scope, context.GetPlace());
+    }
+
+    auto output_maps =
+        context.Attr<std::vector<std::string>>("output_name_mapping");
+    auto outputs = context.Outputs("Ys");
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      auto& src = inference::analysis::GetFromScope<framework::LoDTensor>(
+          scope, output_maps[i]);
+      auto* fluid_v = context.scope().FindVar(outputs[i]);
+      PADDLE_ENFORCE_NOT_NULL(fluid_v, "no output variable called %s",
+                              outputs[i]);
+      auto* fluid_t = fluid_v->GetMutable<framework::LoDTensor>();
+      framework::TensorCopySync(src, context.GetPlace(), fluid_t);
+      fluid_t->set_lod(src.lod());
+    }
+    context.scope().DeleteScope(&scope);
+  }
+
+  void Prepare(const framework::ExecutionContext& context,
+               const std::string& engine_name,
+               const std::vector<std::vector<int64_t>>& input_shapes) const {
+    VLOG(4) << "Prepare engine " << engine_name;
     // Get the ProgramDesc and pass to convert.
     framework::proto::BlockDesc block_desc;
     block_desc.ParseFromString(context.Attr<std::string>("subgraph"));
@@ -186,15 +336,29 @@ class TensorRTEngineKernel : public framework::OpKernel<T> {
     // TODO(Superjomn) replace this with a different stream
     auto* engine = Singleton<TRT_EngineManager>::Global().Create(
         max_batch_size, workspace_size, nullptr /*engine hold its own stream*/,
-        context.Attr<std::string>("engine_uniq_key"),
+        engine_name,
         boost::get<platform::CUDAPlace>(context.GetPlace()).device);
 
+    // Skip the building if the engine is cached by an earlier process.
+    std::string cache_path = CachePath(context, ShapeKey(input_shapes));
+    std::string serialized;
+    if (!cache_path.empty() && ReadFile(cache_path, &serialized)) {
+      if (engine->Deserialize(serialized)) {
+        VLOG(3) << "Load TensorRT engine " << engine_name << " from "
+                << cache_path;
+        return;
+      }
+      LOG(WARNING) << "fail to load the TensorRT engine cache " << cache_path
+                   << ", build it again";
+    }
+
     engine->InitNetwork();
 
     framework::BlockDesc block(nullptr /*programdesc*/, &block_desc);
     VLOG(4) << "parsed var size " << block.AllVars().size();
     // Add inputs
     VLOG(4) << "declare inputs";
+    size_t input_index = 0;
     for (auto& input : context.Inputs("Xs")) {
       if (parameters.count(input)) continue;
       VLOG(4) << "declare input " << input;
@@ -204,14 +368,8 @@ class TensorRTEngineKernel : public framework::OpKernel<T> {
       PADDLE_ENFORCE(var, "no variable called %s", input);
       PADDLE_ENFORCE_EQ(var->GetType(), FluidDT::VarType_Type_LOD_TENSOR,
                         "TensorRT engine only takes LoDTensor as input");
-      auto shape = var->GetShape();
-      // For the special batch_size placeholder -1, drop it and pass the real
-      // shape of data.
-      // TODO(Superjomn) fix this with batch broadcast, or it can't handle
-      // variational batch size.
-      if (shape[0] == -1) {
-        shape[0] = FLAGS_tensorrt_engine_batch_size;
-      }
+      // Use the real shape of the data, the dims of the variable may be -1.
+      auto& shape = input_shapes[input_index++];
       engine->DeclareInput(
           input, FluidDataType2TRT(
                      var->Proto()->type().lod_tensor().tensor().data_type()),
@@ -226,7 +384,41 @@ class TensorRTEngineKernel : public framework::OpKernel<T> {
       engine->DeclareOutput(output);
     }
 
+    // Calibrate with the recorded batches, unless the table is calibrated
+    // for another input shape or cached by an earlier process.
+    std::unique_ptr<TRTInt8Calibrator> calibrator;
+    auto engine_key = context.Attr<std::string>("engine_uniq_key");
+    auto& calib_store = Singleton<TRTCalibrationStore>::Global();
+    std::string table_path = CalibrationTablePath(context);
+    bool calibrating = false;
+    if (context.Attr<std::string>("precision_mode") == "INT8") {
+      std::string table = calib_store.Table(engine_key);
+      if (table.empty() && !table_path.empty()) {
+        ReadFile(table_path, &table);
+      }
+      auto& batches = calib_store.Batches(engine_key);
+      PADDLE_ENFORCE(!table.empty() || !batches.empty(),
+                     "the INT8 TensorRT engine needs the "
+                     "int8_calibration_data or a calibration table cached in "
+                     "FLAGS_tensorrt_engine_cache_dir");
+      calibrating = table.empty();
+      calibrator.reset(new TRTInt8Calibrator(
+          batches, table,
+          boost::get<platform::CUDAPlace>(context.GetPlace()).device));
+      engine->EnableInt8(calibrator.get());
+    }
+
     engine->FreezeNetwork();
+
+    if (calibrating && !calibrator->table().empty()) {
+      calib_store.SetTable(engine_key, calibrator->table());
+      if (!table_path.empty()) WriteFile(table_path, calibrator->table());
+    }
+
+    if (!cache_path.empty()) {
+      engine->Serialize(&serialized);
+      WriteFile(cache_path, serialized);
+    }
   }
 };
 
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/cub_sort.h"
 #include "paddle/fluid/operators/top_k_op.h"
 #include "paddle/fluid/platform/assert.h"
 #include "paddle/fluid/platform/cuda_device_function.h"
@@ -291,6 +292,44 @@ __global__ void KeMatrixTopK(T* output, int output_stride, int64_t* indices,
   }
 }
 
+// Copy the first k columns of every row of the sorted src to dst.
+template <typename T>
+__global__ void KeCopyTopK(const T* src, int64_t width, T* dst, int64_t k,
+                           int64_t num) {
+  int64_t i = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  if (i < num) {
+    dst[i] = src[i / k * width + i % k];
+  }
+}
+
+// Get the top k by sorting all the rows, which is faster than KeMatrixTopK
+// for the large k or the long rows.
+template <typename T>
+void RadixTopK(const platform::CUDADeviceContext& dev_ctx, const T* input,
+               int64_t height, int64_t width, int64_t k, T* output,
+               int64_t* indices) {
+  framework::Tensor ids_in_t, ids_out_t, sorted_t;
+  auto dims = framework::make_ddim({height, width});
+  int64_t* ids_in = ids_in_t.mutable_data<int64_t>(dims, dev_ctx.GetPlace());
+  int64_t* ids_out = ids_out_t.mutable_data<int64_t>(dims, dev_ctx.GetPlace());
+  T* sorted = sorted_t.mutable_data<T>(dims, dev_ctx.GetPlace());
+
+  const int kThreads = 256;
+  int64_t numel = height * width;
+  detail::SegmentIndicesKernel<int64_t><<<
+      (numel + kThreads - 1) / kThreads, kThreads, 0, dev_ctx.stream()>>>(
+      ids_in, static_cast<int>(numel), static_cast<int>(width));
+  SegmentedSortPairs<T, int64_t>(dev_ctx, input, sorted, ids_in, ids_out,
+                                 height, width, /* descending= */ true);
+
+  int64_t num_out = height * k;
+  int blocks = static_cast<int>((num_out + kThreads - 1) / kThreads);
+  KeCopyTopK<T><<<blocks, kThreads, 0, dev_ctx.stream()>>>(
+      sorted, width, output, k, num_out);
+  KeCopyTopK<int64_t><<<blocks, kThreads, 0, dev_ctx.stream()>>>(
+      ids_out, width, indices, k, num_out);
+}
+
 inline static int GetDesiredBlockDim(int dim) {
   if (dim > 128) {
     return 256;
@@ -338,12 +377,21 @@ class TopkOpCUDAKernel : public framework::OpKernel<T> {
 
     if (k > input_width) k = input_width;
 
+    // KeMatrixTopK takes k rounds of block reduce, and one block per row.
+    const size_t kMaxMatrixTopK = 32;
+    const size_t kMaxMatrixWidth = 100000;
+    auto& dev_ctx = ctx.cuda_device_context();
+    if (k > kMaxMatrixTopK || input_width > kMaxMatrixWidth) {
+      RadixTopK<T>(dev_ctx, input_data, input_height, input_width, k,
+                   output_data, indices_data);
+      return;
+    }
+
     // NOTE: pass lds and dim same to input width.
     // NOTE: old matrix implementation of stride is different to eigen.
     // TODO(typhoonzero): refine this kernel.
     const int kMaxHeight = 2048;
     int gridx = input_height < kMaxHeight ? input_height : kMaxHeight;
-    auto& dev_ctx = ctx.cuda_device_context();
     switch (GetDesiredBlockDim(input_width)) {
       FIXED_BLOCK_DIM(
           KeMatrixTopK<T, 5,
@@ -0,0 +1,107 @@
+/* Copyright (c) 2016 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/data_layout_transform.h"
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace operators {
+
+using DataLayout = framework::DataLayout;
+
+class TransferLayoutOp : public framework::OperatorBase {
+ public:
+  TransferLayoutOp(const std::string &type,
+                   const framework::VariableNameMap &inputs,
+                   const framework::VariableNameMap &outputs,
+                   const framework::AttributeMap &attrs)
+      : OperatorBase(type, inputs, outputs, attrs) {}
+
+ private:
+  void RunImpl(const framework::Scope &scope,
+               const platform::Place &place) const override {
+    auto *x = scope.FindVar(Input("X"));
+    PADDLE_ENFORCE(x != nullptr, "Input(X) of TransferLayoutOp is not found.");
+    auto *out = scope.FindVar(Output("Out"));
+    PADDLE_ENFORCE(out != nullptr,
+                   "Output(Out) of TransferLayoutOp is not found.");
+    auto &in_tensor = x->Get<framework::LoDTensor>();
+    auto *out_tensor = out->GetMutable<framework::LoDTensor>();
+
+    auto in_layout = in_tensor.layout();
+    auto dst_layout = static_cast<DataLayout>(Attr<int>("dst_layout"));
+    auto data_type = framework::ToDataType(in_tensor.type());
+    framework::OpKernelType kernel_type_for_var(data_type, in_tensor.place(),
+                                                in_layout);
+    framework::OpKernelType expected_kernel_type(data_type, in_tensor.place(),
+                                                 dst_layout);
+    if (in_layout == DataLayout::kMKLDNN && dst_layout != DataLayout::kMKLDNN) {
+      framework::TransDataLayoutFromMKLDNN(
+          kernel_type_for_var, expected_kernel_type, in_tensor, out_tensor);
+    } else if (in_layout != DataLayout::kMKLDNN &&
+               dst_layout != DataLayout::kMKLDNN &&
+               framework::NeedTransformLayout(in_layout, dst_layout)) {
+      framework::TransDataLayout(kernel_type_for_var, expected_kernel_type,
+                                 in_tensor, out_tensor);
+    } else {
+      // Already in the layout, Out is an alias of X.
+      out_tensor->ShareDataWith(in_tensor);
+    }
+    out_tensor->set_lod(in_tensor.lod());
+  }
+};
+
+class TransferLayoutOpProtoMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X", "(LoDTensor) The input tensor.");
+    AddOutput("Out",
+              "(LoDTensor) The data of X in the layout Attr(dst_layout).");
+    AddAttr<int>("dst_layout",
+                 "(int, default kNCHW) The DataLayout of Out. kAnyLayout is "
+                 "the same as kNCHW for an MKLDNN input.")
+        .SetDefault(static_cast<int>(DataLayout::kNCHW));
+    AddComment(R"DOC(TransferLayout Operator
+
+Transform X to the layout Attr(dst_layout), e.g. reorder the output of an
+MKLDNN kernel back to NCHW once for all its non-MKLDNN readers. Out shares the
+data of X when no transform is needed.
+
+It is inserted by the mkldnn_layout_propagation_pass, and should not be
+configured by users directly.
+)DOC");
+  }
+};
+
+class TransferLayoutInferShape : public framework::InferShapeBase {
+ public:
+  void operator()(framework::InferShapeContext *context) const override {
+    PADDLE_ENFORCE(context->HasInput("X"),
+                   "Input(X) of TransferLayoutOp should not be null.");
+    PADDLE_ENFORCE(context->HasOutput("Out"),
+                   "Output(Out) of TransferLayoutOp should not be null.");
+    context->SetOutputDim("Out", context->GetInputDim("X"));
+    context->ShareLoD("X", "Out");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(transfer_layout, ops::TransferLayoutOp,
+                  ops::TransferLayoutOpProtoMaker,
+                  ops::TransferLayoutInferShape,
+                  paddle::framework::EmptyGradOpMaker);
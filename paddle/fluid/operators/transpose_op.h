@@ -17,44 +17,11 @@ limitations under the License. */
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/math/transpose.h"
 
 namespace paddle {
 namespace operators {
 
-template <typename DeviceContext, typename T>
-inline void TransCompute(const int dim, const DeviceContext& dev_ctx,
-                         const framework::Tensor& in, framework::Tensor* out,
-                         const std::vector<int>& axis) {
-  switch (dim) {
-    case 1:
-      math::Transpose<DeviceContext, T, 1> trans1;
-      trans1(dev_ctx, in, out, axis);
-      break;
-    case 2:
-      math::Transpose<DeviceContext, T, 2> trans2;
-      trans2(dev_ctx, in, out, axis);
-      break;
-    case 3:
-      math::Transpose<DeviceContext, T, 3> trans3;
-      trans3(dev_ctx, in, out, axis);
-      break;
-    case 4:
-      math::Transpose<DeviceContext, T, 4> trans4;
-      trans4(dev_ctx, in, out, axis);
-      break;
-    case 5:
-      math::Transpose<DeviceContext, T, 5> trans5;
-      trans5(dev_ctx, in, out, axis);
-      break;
-    case 6:
-      math::Transpose<DeviceContext, T, 6> trans6;
-      trans6(dev_ctx, in, out, axis);
-      break;
-    default:
-      PADDLE_THROW("Tensors with rank at most 6 are supported");
-  }
-}
-
 template <typename DeviceContext, typename T>
 class TransposeKernel : public framework::OpKernel<T> {
  public:
@@ -64,9 +31,9 @@ class TransposeKernel : public framework::OpKernel<T> {
     out->mutable_data<T>(context.GetPlace());
 
     std::vector<int> axis = context.Attr<std::vector<int>>("axis");
-    int ndims = axis.size();
     auto& dev_ctx = context.template device_context<DeviceContext>();
-    TransCompute<DeviceContext, T>(ndims, dev_ctx, *x, out, axis);
+    math::TransposeFunctor<DeviceContext, T> transpose;
+    transpose(dev_ctx, *x, out, axis);
   }
 };
 
@@ -88,10 +55,9 @@ class TransposeGradKernel : public framework::OpKernel<T> {
       reversed_axis[axis[i]] = i;
     }
 
-    int ndims = axis.size();
     auto& dev_ctx = context.template device_context<DeviceContext>();
-    TransCompute<DeviceContext, T>(ndims, dev_ctx, *out_grad, x_grad,
-                                   reversed_axis);
+    math::TransposeFunctor<DeviceContext, T> transpose;
+    transpose(dev_ctx, *out_grad, x_grad, reversed_axis);
   }
 };
 
@@ -12,37 +12,51 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
-#include <thrust/random.h>
-#include <thrust/transform.h>
 #include <limits>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/platform/for_range.h"
+#include "paddle/fluid/platform/philox.h"
 
 namespace paddle {
 namespace operators {
 
+// A thread fills the 4 elements of a group from a Philox call, see
+// UniformGenerator.
 template <typename T>
 struct TruncatedNormal {
   T mean, std;
   T a_normal_cdf;
   T b_normal_cdf;
-  unsigned int seed;
+  platform::PhiloxSeedOffset seed_offset;
   T numeric_min;
+  int64_t size;
+  T* data;
 
-  __host__ __device__ TruncatedNormal(T mean, T std, T numeric_min, int seed)
-      : mean(mean), std(std), seed(seed), numeric_min(numeric_min) {
+  TruncatedNormal(T mean, T std, T numeric_min,
+                  platform::PhiloxSeedOffset seed_offset, int64_t size,
+                  T* data)
+      : mean(mean),
+        std(std),
+        seed_offset(seed_offset),
+        numeric_min(numeric_min),
+        size(size),
+        data(data) {
     a_normal_cdf = (1.0 + erff(-2.0 / sqrtf(2.0))) / 2.0;
     b_normal_cdf = (1.0 + erff(2.0 / sqrtf(2.0))) / 2.0;
   }
 
-  __host__ __device__ T operator()(const unsigned int n) const {
-    thrust::minstd_rand rng;
-    rng.seed(seed);
-    thrust::uniform_real_distribution<T> dist(numeric_min, 1);
-    rng.discard(n);
-    T value = dist(rng);
-    auto p = a_normal_cdf + (b_normal_cdf - a_normal_cdf) * value;
-    return std::sqrt(2.0) * erfinvf(2 * p - 1) * std + mean;
+  HOSTDEVICE void operator()(size_t group) const {
+    platform::Philox4x32 rng(seed_offset.seed, group, seed_offset.offset);
+    auto r = rng();
+    for (int i = 0; i < 4; ++i) {
+      int64_t idx = static_cast<int64_t>(group) * 4 + i;
+      if (idx >= size) break;
+      T value =
+          numeric_min + (1 - numeric_min) * platform::PhiloxUniform<T>(r.x[i]);
+      auto p = a_normal_cdf + (b_normal_cdf - a_normal_cdf) * value;
+      data[idx] = std::sqrt(2.0) * erfinvf(2 * p - 1) * std + mean;
+    }
   }
 };
 
@@ -53,19 +67,16 @@ class GPUTruncatedGaussianRandomKernel : public framework::OpKernel<T> {
     auto* tensor = context.Output<framework::Tensor>("Out");
     T* data = tensor->mutable_data<T>(context.GetPlace());
 
-    unsigned int seed = static_cast<unsigned int>(context.Attr<int>("seed"));
-    if (seed == 0) {
-      std::random_device rd;
-      seed = rd();
-    }
+    int seed = context.Attr<int>("seed");
+    auto seed_offset = platform::GetPhiloxSeedOffset(seed != 0, seed, 1);
     T mean = static_cast<T>(context.Attr<float>("mean"));
     T std = static_cast<T>(context.Attr<float>("std"));
-    thrust::counting_iterator<unsigned int> index_sequence_begin(0);
     int64_t size = tensor->numel();
-    thrust::transform(
-        index_sequence_begin, index_sequence_begin + size,
-        thrust::device_ptr<T>(data),
-        TruncatedNormal<T>(mean, std, std::numeric_limits<T>::min(), seed));
+    platform::ForRange<platform::CUDADeviceContext> for_range(
+        context.template device_context<platform::CUDADeviceContext>(),
+        (size + 3) / 4);
+    for_range(TruncatedNormal<T>(mean, std, std::numeric_limits<T>::min(),
+                                 seed_offset, size, data));
   }
 };
 
@@ -11,34 +11,45 @@ distributed under the License is distributed on an "AS IS" BASIS,
 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
-#include <thrust/random.h>
-#include <thrust/transform.h>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/platform/for_range.h"
+#include "paddle/fluid/platform/philox.h"
 
 namespace paddle {
 namespace operators {
 
+// A thread fills the 4 elements of a group with the numbers of a Philox
+// call, whose subsequence is the group, so the data only depends on the
+// seed and the offset.
 template <typename T>
 struct UniformGenerator {
   T min_, max_;
-  unsigned int seed_;
+  platform::PhiloxSeedOffset seed_offset_;
+  int64_t size_;
+  T* data_;
 
-  __host__ __device__ UniformGenerator(T min, T max, int seed)
-      : min_(min), max_(max), seed_(seed) {}
+  UniformGenerator(T min, T max, platform::PhiloxSeedOffset seed_offset,
+                   int64_t size, T* data)
+      : min_(min),
+        max_(max),
+        seed_offset_(seed_offset),
+        size_(size),
+        data_(data) {}
 
-  __host__ __device__ T operator()(const unsigned int n) const {
-    thrust::minstd_rand rng;
-    rng.seed(seed_);
-    thrust::uniform_real_distribution<T> dist(min_, max_);
-    rng.discard(n);
-    return dist(rng);
+  HOSTDEVICE void operator()(size_t group) const {
+    platform::Philox4x32 rng(seed_offset_.seed, group, seed_offset_.offset);
+    auto r = rng();
+    for (int i = 0; i < 4; ++i) {
+      int64_t idx = static_cast<int64_t>(group) * 4 + i;
+      if (idx < size_) {
+        data_[idx] =
+            min_ + (max_ - min_) * platform::PhiloxUniform<T>(r.x[i]);
+      }
+    }
   }
 };
 
-// It seems that Eigen::Tensor::random in GPU will SEGFAULT.
-// Use std::random and thrust::random(thrust is a std library in CUDA) to
-// implement uniform random.
 template <typename T>
 class GPUUniformRandomKernel : public framework::OpKernel<T> {
  public:
@@ -57,18 +68,15 @@ class GPUUniformRandomKernel : public framework::OpKernel<T> {
           "supports SelectedRows and LoDTensor");
     }
     T* data = tensor->mutable_data<T>(context.GetPlace());
-    unsigned int seed = static_cast<unsigned int>(context.Attr<int>("seed"));
-    if (seed == 0) {
-      std::random_device rd;
-      seed = rd();
-    }
+    int seed = context.Attr<int>("seed");
+    auto seed_offset = platform::GetPhiloxSeedOffset(seed != 0, seed, 1);
     T min = static_cast<T>(context.Attr<float>("min"));
     T max = static_cast<T>(context.Attr<float>("max"));
-    thrust::counting_iterator<unsigned int> index_sequence_begin(0);
     int64_t size = tensor->numel();
-    thrust::transform(index_sequence_begin, index_sequence_begin + size,
-                      thrust::device_ptr<T>(data),
-                      UniformGenerator<T>(min, max, seed));
+    platform::ForRange<platform::CUDADeviceContext> for_range(
+        context.template device_context<platform::CUDADeviceContext>(),
+        (size + 3) / 4);
+    for_range(UniformGenerator<T>(min, max, seed_offset, size, data));
   }
 };
 
@@ -283,11 +283,15 @@ USE_OP(reshape);
 namespace ops = paddle::operators;
 REGISTER_OPERATOR(unsqueeze, ops::UnsqueezeOp, ops::UnsqueezeOpMaker,
                   ops::UnsqueezeOpInferShape,
-                  paddle::framework::DefaultGradOpDescMaker<true>);
+                  paddle::framework::DefaultGradOpDescMaker<true>,
+                  paddle::framework::SingleOpShareDataInToOut);
 REGISTER_OPERATOR(unsqueeze_grad, ops::UnsqueezeGradOp,
-                  ops::UnsqueezeGradInferShape);
+                  ops::UnsqueezeGradInferShape,
+                  paddle::framework::SingleGradOpShareDataInToOut);
 
 REGISTER_OPERATOR(unsqueeze2, ops::Unsqueeze2Op, ops::Unsqueeze2OpMaker,
-                  ops::Unsqueeze2OpInferShape, ops::Unsqueeze2GradOpMaker);
+                  ops::Unsqueeze2OpInferShape, ops::Unsqueeze2GradOpMaker,
+                  paddle::framework::SingleOpShareDataInToOut);
 REGISTER_OPERATOR(unsqueeze2_grad, ops::Unsqueeze2GradOp,
-                  ops::Unsqueeze2GradInferShape);
+                  ops::Unsqueeze2GradInferShape,
+                  paddle::framework::SingleGradOpShareDataInToOut);
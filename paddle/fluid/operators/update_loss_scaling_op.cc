@@ -0,0 +1,136 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/update_loss_scaling_op.h"
+
+namespace paddle {
+namespace operators {
+
+class UpdateLossScalingOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInputs("X"),
+                   "Inputs(X) of UpdateLossScalingOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("AllFinite"),
+                   "Input(AllFinite) of UpdateLossScalingOp should not be "
+                   "null.");
+    PADDLE_ENFORCE(ctx->HasInput("LossScaling"),
+                   "Input(LossScaling) of UpdateLossScalingOp should not be "
+                   "null.");
+    PADDLE_ENFORCE(ctx->HasInput("GoodSteps"),
+                   "Input(GoodSteps) of UpdateLossScalingOp should not be "
+                   "null.");
+    PADDLE_ENFORCE(ctx->HasInput("BadSteps"),
+                   "Input(BadSteps) of UpdateLossScalingOp should not be "
+                   "null.");
+    PADDLE_ENFORCE(ctx->HasOutputs("Out"),
+                   "Outputs(Out) of UpdateLossScalingOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("LossScalingOut"),
+                   "Output(LossScalingOut) of UpdateLossScalingOp should not "
+                   "be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("GoodStepsOut"),
+                   "Output(GoodStepsOut) of UpdateLossScalingOp should not be "
+                   "null.");
+    PADDLE_ENFORCE(ctx->HasOutput("BadStepsOut"),
+                   "Output(BadStepsOut) of UpdateLossScalingOp should not be "
+                   "null.");
+
+    auto x_dims = ctx->GetInputsDim("X");
+    auto out_names = ctx->Outputs("Out");
+    PADDLE_ENFORCE_EQ(x_dims.size(), out_names.size(),
+                      "Inputs(X) and Outputs(Out) should have the same size.");
+    for (auto name : {"AllFinite", "LossScaling", "GoodSteps", "BadSteps"}) {
+      PADDLE_ENFORCE_EQ(framework::product(ctx->GetInputDim(name)), 1,
+                        "Input(%s) should hold a single element.", name);
+    }
+    ctx->SetOutputsDim("Out", x_dims);
+    ctx->SetOutputDim("LossScalingOut", {1});
+    ctx->SetOutputDim("GoodStepsOut", {1});
+    ctx->SetOutputDim("BadStepsOut", {1});
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        framework::ToDataType(ctx.Input<Tensor>("LossScaling")->type()),
+        ctx.GetPlace());
+  }
+};
+
+class UpdateLossScalingOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X", "(Tensors) The gradients of the scaled loss.")
+        .AsDuplicable();
+    AddInput("AllFinite",
+             "(Tensor) A bool tensor of one element, whether all the "
+             "gradients are finite, e.g. the output of isfinite.");
+    AddInput("LossScaling", "(Tensor) The loss scaling of this step.");
+    AddInput("GoodSteps",
+             "(Tensor) An int tensor of one element, the number of the steps "
+             "without overflow since the last update of the loss scaling.");
+    AddInput("BadSteps",
+             "(Tensor) An int tensor of one element, the number of the steps "
+             "with overflow since the last update of the loss scaling.");
+    AddOutput("Out",
+              "(Tensors) The unscaled gradients, or zeros if any gradient "
+              "overflows.")
+        .AsDuplicable();
+    AddOutput("LossScalingOut", "(Tensor) The loss scaling of the next step.");
+    AddOutput("GoodStepsOut", "(Tensor) The updated GoodSteps.");
+    AddOutput("BadStepsOut", "(Tensor) The updated BadSteps.");
+    AddAttr<int>("incr_every_n_steps",
+                 "Increase the loss scaling after the gradients are finite "
+                 "in this number of consecutive steps.")
+        .SetDefault(1000);
+    AddAttr<int>("decr_every_n_nan_or_inf",
+                 "Decrease the loss scaling after the gradients overflow in "
+                 "this number of consecutive steps.")
+        .SetDefault(2);
+    AddAttr<float>("incr_ratio", "The ratio to increase the loss scaling.")
+        .SetDefault(2.0f);
+    AddAttr<float>("decr_ratio", "The ratio to decrease the loss scaling.")
+        .SetDefault(0.5f);
+    AddComment(R"DOC(
+UpdateLossScaling Operator.
+
+Unscale the gradients of a loss multiplied by LossScaling for mixed precision
+training, and update the scaling dynamically:
+
+$$Out = X / LossScaling$$ if AllFinite, else $$Out = 0$$.
+
+The loss scaling is multiplied by incr_ratio after incr_every_n_steps
+consecutive steps with finite gradients, and by decr_ratio (but not below 1)
+after decr_every_n_nan_or_inf consecutive steps with overflowing gradients.
+Zeroing the gradients skips the update of an overflowing step. All the
+tensors are read on the device, so the operator never waits for the device.
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(update_loss_scaling, ops::UpdateLossScalingOp,
+                  ops::UpdateLossScalingOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    update_loss_scaling,
+    ops::UpdateLossScalingKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::UpdateLossScalingKernel<paddle::platform::CPUDeviceContext, double>);
@@ -0,0 +1,135 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/platform/for_range.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+// Out = X / loss_scaling if all the gradients are finite, else 0. The flag is
+// read by the kernel, so the host never waits for the device.
+template <typename T>
+struct UnscaleGradFunctor {
+  UnscaleGradFunctor(const T* x, const bool* all_finite,
+                     const T* loss_scaling, T* out)
+      : x_(x),
+        all_finite_(all_finite),
+        loss_scaling_(loss_scaling),
+        out_(out) {}
+
+  HOSTDEVICE void operator()(size_t i) const {
+    out_[i] = all_finite_[0] ? x_[i] / loss_scaling_[0] : static_cast<T>(0);
+  }
+
+  const T* x_;
+  const bool* all_finite_;
+  const T* loss_scaling_;
+  T* out_;
+};
+
+// Run by a single thread after the gradients are unscaled with the previous
+// loss scaling.
+template <typename T>
+struct UpdateLossScalingFunctor {
+  HOSTDEVICE void operator()(size_t i) const {
+    T loss_scaling = loss_scaling_[0];
+    int good_steps = good_steps_[0];
+    int bad_steps = bad_steps_[0];
+    if (all_finite_[0]) {
+      bad_steps = 0;
+      if (++good_steps == incr_every_n_steps_) {
+        loss_scaling *= static_cast<T>(incr_ratio_);
+        good_steps = 0;
+      }
+    } else {
+      good_steps = 0;
+      if (++bad_steps == decr_every_n_nan_or_inf_) {
+        loss_scaling *= static_cast<T>(decr_ratio_);
+        if (loss_scaling < static_cast<T>(1)) loss_scaling = static_cast<T>(1);
+        bad_steps = 0;
+      }
+    }
+    loss_scaling_out_[0] = loss_scaling;
+    good_steps_out_[0] = good_steps;
+    bad_steps_out_[0] = bad_steps;
+  }
+
+  const bool* all_finite_;
+  const T* loss_scaling_;
+  const int* good_steps_;
+  const int* bad_steps_;
+  int incr_every_n_steps_;
+  int decr_every_n_nan_or_inf_;
+  float incr_ratio_;
+  float decr_ratio_;
+  T* loss_scaling_out_;
+  int* good_steps_out_;
+  int* bad_steps_out_;
+};
+
+template <typename DeviceContext, typename T>
+class UpdateLossScalingKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto xs = ctx.MultiInput<Tensor>("X");
+    auto outs = ctx.MultiOutput<Tensor>("Out");
+    PADDLE_ENFORCE_EQ(xs.size(), outs.size(),
+                      "Input(X) and Output(Out) should have the same size.");
+    auto* all_finite = ctx.Input<Tensor>("AllFinite");
+    auto* loss_scaling = ctx.Input<Tensor>("LossScaling");
+    auto* good_steps = ctx.Input<Tensor>("GoodSteps");
+    auto* bad_steps = ctx.Input<Tensor>("BadSteps");
+    PADDLE_ENFORCE(all_finite->type() == typeid(bool),
+                   "Input(AllFinite) should be the bool output of isfinite.");
+
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    const bool* all_finite_data = all_finite->data<bool>();
+    const T* loss_scaling_data = loss_scaling->data<T>();
+    for (size_t i = 0; i < xs.size(); ++i) {
+      T* out_data = outs[i]->mutable_data<T>(ctx.GetPlace());
+      platform::ForRange<DeviceContext> for_range(
+          dev_ctx, static_cast<size_t>(xs[i]->numel()));
+      for_range(UnscaleGradFunctor<T>(xs[i]->data<T>(), all_finite_data,
+                                      loss_scaling_data, out_data));
+    }
+
+    // The gradients are unscaled before the scaling is overwritten in place,
+    // the kernels run in order on the stream.
+    UpdateLossScalingFunctor<T> update;
+    update.all_finite_ = all_finite_data;
+    update.loss_scaling_ = loss_scaling_data;
+    update.good_steps_ = good_steps->data<int>();
+    update.bad_steps_ = bad_steps->data<int>();
+    update.incr_every_n_steps_ = ctx.Attr<int>("incr_every_n_steps");
+    update.decr_every_n_nan_or_inf_ = ctx.Attr<int>("decr_every_n_nan_or_inf");
+    update.incr_ratio_ = ctx.Attr<float>("incr_ratio");
+    update.decr_ratio_ = ctx.Attr<float>("decr_ratio");
+    update.loss_scaling_out_ =
+        ctx.Output<Tensor>("LossScalingOut")->mutable_data<T>(ctx.GetPlace());
+    update.good_steps_out_ =
+        ctx.Output<Tensor>("GoodStepsOut")->mutable_data<int>(ctx.GetPlace());
+    update.bad_steps_out_ =
+        ctx.Output<Tensor>("BadStepsOut")->mutable_data<int>(ctx.GetPlace());
+    platform::ForRange<DeviceContext> for_range(dev_ctx, 1);
+    for_range(update);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,95 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include "paddle/fluid/platform/cuda_device_function.h"
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace operators {
+
+// The mean, the sum of the squared deviations from the mean and the number of
+// the values, updated by Welford's algorithm one value at a time. Unlike
+// E[x^2] - E[x]^2, the variance keeps its precision when the mean is large
+// compared to the deviations.
+template <typename T>
+struct WelfordData {
+  HOSTDEVICE WelfordData() : mean(0), m2(0), count(0) {}
+  HOSTDEVICE WelfordData(T mean, T m2, T count)
+      : mean(mean), m2(m2), count(count) {}
+
+  HOSTDEVICE void Update(T x) {
+    count += 1;
+    T delta = x - mean;
+    mean += delta / count;
+    m2 += delta * (x - mean);
+  }
+
+  T mean;
+  T m2;
+  T count;
+};
+
+// Merge the data of two sets of values, by Chan's parallel algorithm.
+template <typename T>
+struct WelfordMergeFunctor {
+  HOSTDEVICE WelfordData<T> operator()(const WelfordData<T> &a,
+                                       const WelfordData<T> &b) const {
+    if (b.count == 0) return a;
+    if (a.count == 0) return b;
+    T count = a.count + b.count;
+    T delta = b.mean - a.mean;
+    T ratio = b.count / count;
+    return WelfordData<T>(a.mean + delta * ratio,
+                          a.m2 + b.m2 + delta * delta * a.count * ratio, count);
+  }
+};
+
+// Merge the data of the 32 threads of a warp by the warp shuffles, all the
+// threads of the warp get the result.
+template <typename T>
+__device__ __forceinline__ WelfordData<T> WarpWelfordReduce(
+    WelfordData<T> val) {
+  const int kWarpSize = 32;
+  unsigned mask = 0u;
+  CREATE_SHFL_MASK(mask, true);
+  WelfordMergeFunctor<T> merge;
+  for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+    WelfordData<T> other(
+        platform::CudaShuffleDownSync(mask, val.mean, offset),
+        platform::CudaShuffleDownSync(mask, val.m2, offset),
+        platform::CudaShuffleDownSync(mask, val.count, offset));
+    val = merge(val, other);
+  }
+  return WelfordData<T>(platform::CudaShuffleSync(mask, val.mean, 0),
+                        platform::CudaShuffleSync(mask, val.m2, 0),
+                        platform::CudaShuffleSync(mask, val.count, 0));
+}
+
+// Sum a value over the threads of a warp, all the threads get the sum.
+template <typename T>
+__device__ __forceinline__ T WarpAllReduceSum(T val) {
+  const int kWarpSize = 32;
+  unsigned mask = 0u;
+  CREATE_SHFL_MASK(mask, true);
+  for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+    val += platform::CudaShuffleDownSync(mask, val, offset);
+  }
+  return platform::CudaShuffleSync(mask, val, 0);
+}
+
+}  // namespace operators
+}  // namespace paddle
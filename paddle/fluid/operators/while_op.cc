@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
+#include <mutex>  // NOLINT
 #include <vector>
 #include "paddle/fluid/framework/executor.h"
 #include "paddle/fluid/framework/lod_tensor_array.h"
@@ -19,6 +21,7 @@
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/framework/var_type.h"
 #include "paddle/fluid/operators/detail/safe_ref.h"
+#include "paddle/fluid/operators/detail/scalar_condition.h"
 
 namespace paddle {
 namespace operators {
@@ -33,6 +36,52 @@ static constexpr char kX[] = "X";
 static constexpr char kXGRAD[] = "X@GRAD";
 static constexpr char kOutputs[] = "Out";
 
+// The operators of the step block are created once and cached on the while op
+// instead of on every run. A context is taken out of the pool while it runs,
+// since the ops may be shared by the executors of several threads.
+class PreparedStepBlockPool {
+ public:
+  std::unique_ptr<framework::ExecutorPrepareContext> Acquire(
+      const framework::BlockDesc &block) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!free_ctxs_.empty()) {
+        auto ctx = std::move(free_ctxs_.back());
+        free_ctxs_.pop_back();
+        return ctx;
+      }
+    }
+    return framework::Executor::Prepare(*block.Program(), block.ID());
+  }
+
+  void Release(std::unique_ptr<framework::ExecutorPrepareContext> ctx) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_ctxs_.push_back(std::move(ctx));
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<framework::ExecutorPrepareContext>> free_ctxs_;
+};
+
+// Give the context back to the pool when the run ends, even by exception.
+class PreparedStepBlockGuard {
+ public:
+  PreparedStepBlockGuard(PreparedStepBlockPool *pool,
+                         const framework::BlockDesc &block)
+      : pool_(pool), ctx_(pool->Acquire(block)) {}
+
+  ~PreparedStepBlockGuard() { pool_->Release(std::move(ctx_)); }
+
+  framework::ExecutorPrepareContext *get() const { return ctx_.get(); }
+
+ private:
+  PreparedStepBlockPool *pool_;
+  std::unique_ptr<framework::ExecutorPrepareContext> ctx_;
+
+  DISABLE_COPY_AND_ASSIGN(PreparedStepBlockGuard);
+};
+
 class WhileOp : public framework::OperatorBase {
  public:
   WhileOp(const std::string &type, const framework::VariableNameMap &inputs,
@@ -50,25 +99,37 @@ class WhileOp : public framework::OperatorBase {
     framework::Executor executor(dev_place);
     auto *block = Attr<framework::BlockDesc *>(kStepBlock);
 
-    auto *program = block->Program();
-
     auto step_scopes =
         scope.FindVar(Output(kStepScopes))->GetMutable<StepScopeVar>();
 
-    PADDLE_ENFORCE(platform::is_cpu_place(cond.place()),
-                   "Condition of while op must in CPU memory.");
-
     bool is_test = Attr<bool>("is_test");
-    auto ctx = executor.Prepare(*program, block->ID());
-    while (cond.data<bool>()[0]) {
+    PreparedStepBlockGuard ctx(&prepared_, *block);
+    if (is_test) {
+      // No gradient needs the scopes of the former steps, so all the steps
+      // share a single scope, which is kept in StepScopes and reused by the
+      // later runs in the same scope. Its variables are created only once,
+      // and the temporaries of a step are freed after their last use.
+      bool create_vars = false;
+      if (step_scopes->size() != 1 || !scope.HasKid(step_scopes->front())) {
+        step_scopes->assign(1, &scope.NewScope());
+        create_vars = true;
+      }
+      auto *current_scope = step_scopes->front();
+      while (detail::ReadScalarCondition(cond)) {
+        executor.RunPreparedContext(ctx.get(), current_scope, false,
+                                    create_vars, true, true);
+        create_vars = false;
+      }
+      return;
+    }
+    while (detail::ReadScalarCondition(cond)) {
       auto &current_scope = scope.NewScope();
       step_scopes->push_back(&current_scope);
       executor.RunPreparedContext(ctx.get(), &current_scope, false, true, true);
-      if (is_test) {
-        scope.DeleteScope(&current_scope);
-      }
     }
   }
+
+  mutable PreparedStepBlockPool prepared_;
 };
 
 class WhileOpMaker : public framework::OpProtoAndCheckerMaker {
@@ -115,8 +176,7 @@ class WhileGradOp : public framework::OperatorBase {
     auto &dev_ctx = *pool.Get(dev_place);
     framework::Executor executor(dev_place);
     auto *block = Attr<framework::BlockDesc *>(kStepBlock);
-    auto *program = block->Program();
-    auto ctx = executor.Prepare(*program, block->ID());
+    PreparedStepBlockGuard ctx(&prepared_, *block);
 
     auto *step_scopes =
         scope.FindVar(Input(kStepScopes))->GetMutable<StepScopeVar>();
@@ -259,7 +319,10 @@ class WhileGradOp : public framework::OperatorBase {
       dev_ctx.Wait();
       const_cast<framework::Scope &>(scope).DeleteScope(&cur_scope);
     }
+    step_scopes->clear();
   }
+
+  mutable PreparedStepBlockPool prepared_;
 };
 
 class WhileGradOpDescMaker : public framework::SingleGradOpDescMaker {
@@ -0,0 +1,128 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+#include "paddle/fluid/platform/bfloat16.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace platform {
+
+TEST(bfloat16, conversion_cpu) {
+  // Conversion from float
+  EXPECT_EQ(bfloat16(1.0f).x, 0x3f80);
+  EXPECT_EQ(bfloat16(0.5f).x, 0x3f00);
+  EXPECT_EQ(bfloat16(0.33333f).x, 0x3eab);
+  EXPECT_EQ(bfloat16(0.0f).x, 0x0000);
+  EXPECT_EQ(bfloat16(-0.0f).x, 0x8000);
+  EXPECT_EQ(bfloat16(3.0f).x, 0x4040);
+
+  // Round to the nearest, ties to even
+  EXPECT_EQ(bfloat16(1.00390625f).x, 0x3f80);
+  EXPECT_EQ(bfloat16(1.01171875f).x, 0x3f82);
+  EXPECT_EQ(bfloat16(1.005f).x, 0x3f81);
+  EXPECT_EQ(bfloat16(std::numeric_limits<float>::max()).x, 0x7f80);
+
+  // Conversion from double, int and bool
+  EXPECT_EQ(bfloat16(0.5).x, 0x3f00);
+  EXPECT_EQ(bfloat16(-1).x, 0xbf80);
+  EXPECT_EQ(bfloat16(2).x, 0x4000);
+  EXPECT_EQ(bfloat16(true).x, 0x3f80);
+  EXPECT_EQ(bfloat16(false).x, 0x0000);
+
+  // Assignment operator
+  bfloat16 v_assign;
+  v_assign = bfloat16(0);
+  EXPECT_EQ(v_assign.x, 0x0000);
+  v_assign = 0.5f;
+  EXPECT_EQ(v_assign.x, 0x3f00);
+  v_assign = -1;
+  EXPECT_EQ(v_assign.x, 0xbf80);
+
+  // Conversion operator
+  EXPECT_EQ(static_cast<float>(bfloat16(0.5f)), 0.5f);
+  EXPECT_NEAR(static_cast<double>(bfloat16(0.33333)), 0.33333, 0.002);
+  EXPECT_EQ(static_cast<int>(bfloat16(-1)), -1);
+  EXPECT_EQ(static_cast<bool>(bfloat16(true)), true);
+  // The exponent range of float is kept
+  EXPECT_EQ(static_cast<float>(bfloat16(65536.0f * 65536.0f)),
+            65536.0f * 65536.0f);
+}
+
+TEST(bfloat16, arithmetic_cpu) {
+  EXPECT_EQ(static_cast<float>(bfloat16(1) + bfloat16(1)), 2);
+  EXPECT_EQ(static_cast<float>(bfloat16(5) + bfloat16(-5)), 0);
+  EXPECT_EQ(static_cast<float>(bfloat16(3) - bfloat16(5)), -2);
+  EXPECT_NEAR(static_cast<float>(bfloat16(3.3f) * bfloat16(2.0f)), 6.6f,
+              0.05);
+  EXPECT_NEAR(static_cast<float>(bfloat16(2.0f) / bfloat16(3.0f)), 0.66667f,
+              0.005);
+  EXPECT_EQ(static_cast<float>(-bfloat16(512.0f)), -512.0f);
+  bfloat16 a(1.0f);
+  a += bfloat16(2.0f);
+  a *= bfloat16(2.0f);
+  EXPECT_EQ(static_cast<float>(a), 6.0f);
+}
+
+TEST(bfloat16, comparison_cpu) {
+  EXPECT_TRUE(bfloat16(1.0f) == bfloat16(1.0f));
+  EXPECT_FALSE(bfloat16(-1.0f) == bfloat16(-0.5f));
+  EXPECT_TRUE(bfloat16(1.0f) != bfloat16(0.5f));
+  EXPECT_TRUE(bfloat16(1.0f) < bfloat16(2.0f));
+  EXPECT_TRUE(bfloat16(1.0f) <= bfloat16(1.0f));
+  EXPECT_TRUE(bfloat16(2.0f) > bfloat16(1.0f));
+  EXPECT_TRUE(bfloat16(2.0f) >= bfloat16(2.0f));
+  EXPECT_TRUE(bfloat16(0.0f) == bfloat16(-0.0f));
+}
+
+TEST(bfloat16, isinf_isnan) {
+  EXPECT_TRUE(std::isinf(bfloat16(INFINITY)));
+  EXPECT_TRUE(std::isinf(raw_uint16_to_bfloat16(0xff80)));
+  EXPECT_TRUE(std::isnan(bfloat16(NAN)));
+  EXPECT_TRUE(std::isnan(raw_uint16_to_bfloat16(0x7fc0)));
+  EXPECT_FALSE(std::isnan(bfloat16(1.0f)));
+  PADDLE_ASSERT(std::is_floating_point<bfloat16>::value);
+}
+
+TEST(bfloat16, array_conversion) {
+  std::vector<float> input(37);
+  for (size_t i = 0; i < input.size(); ++i) {
+    input[i] = 0.37f * i - 5.0f;
+  }
+  std::vector<bfloat16> bf16(input.size());
+  FloatToBFloat16(input.data(), bf16.data(), input.size());
+  std::vector<float> output(input.size());
+  BFloat16ToFloat(bf16.data(), output.data(), bf16.size());
+  for (size_t i = 0; i < input.size(); ++i) {
+    EXPECT_EQ(bf16[i].x, bfloat16(input[i]).x);
+    EXPECT_EQ(output[i], static_cast<float>(bf16[i]));
+    EXPECT_NEAR(output[i], input[i], std::fabs(input[i]) / 128);
+  }
+}
+
+TEST(bfloat16, lod_tensor_cpu) {
+  framework::LoDTensor lod_tensor;
+  lod_tensor.Resize({4, 1});
+  bfloat16* data_ptr = lod_tensor.mutable_data<bfloat16>(CPUPlace());
+  EXPECT_NE(data_ptr, nullptr);
+  EXPECT_EQ(framework::ToDataType(lod_tensor.type()),
+            framework::proto::VarType::BF16);
+  for (int i = 0; i < 4; ++i) {
+    data_ptr[i] = bfloat16(i);
+    EXPECT_EQ(static_cast<float>(data_ptr[i]), i);
+  }
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/platform/cpu_helper.h"
+#include "gflags/gflags.h"
 #include "paddle/fluid/platform/enforce.h"
 
 #ifdef PADDLE_WITH_MKLML
@@ -24,10 +25,18 @@ limitations under the License. */
 #include <cblas.h>
 #endif
 
+DEFINE_bool(cpu_unified_runtime, false,
+            "Run the inter-op tasks, the IO and RPC tasks and the intra-op "
+            "loops of the CPU on one set of worker threads sized to the "
+            "physical cores, instead of a pool for each of them. The BLAS "
+            "and OpenMP threads are set to 1, so they do not oversubscribe "
+            "the cores.");
+
 namespace paddle {
 namespace platform {
 
 void SetNumThreads(int num_threads) {
+  if (FLAGS_cpu_unified_runtime) num_threads = 1;
 #ifdef PADDLE_USE_OPENBLAS
   int real_num_threads = num_threads > 1 ? num_threads : 1;
   openblas_set_num_threads(real_num_threads);
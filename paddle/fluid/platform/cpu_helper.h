@@ -19,7 +19,9 @@ limitations under the License. */
 namespace paddle {
 namespace platform {
 
-//! Set the number of threads in use.
+//! Set the number of threads in use. With FLAGS_cpu_unified_runtime the math
+//! libraries run on the calling thread only, since the parallelism comes from
+//! the threads of the unified CPU runtime.
 void SetNumThreads(int num_threads);
 
 }  // namespace platform
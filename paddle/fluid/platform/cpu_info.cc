@@ -30,8 +30,18 @@ limitations under the License. */
 #include <unistd.h>
 #endif  // _WIN32
 
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
 #include <algorithm>
+#include <fstream>
+#include <set>
+#include <thread>  // NOLINT
+#include <utility>
 #include "gflags/gflags.h"
+#include "glog/logging.h"
 
 DEFINE_double(fraction_of_cpu_memory_to_use, 1,
               "Default use 100% of CPU memory for PaddlePaddle,"
@@ -116,6 +126,138 @@ size_t CUDAPinnedMaxChunkSize() {
   return CUDAPinnedMaxAllocSize() / 256;
 }
 
+std::vector<int> ParseCPUList(const std::string& list) {
+  std::vector<int> cpus;
+  size_t pos = 0;
+  while (pos < list.size()) {
+    size_t end = list.find(',', pos);
+    if (end == std::string::npos) end = list.size();
+    auto range = list.substr(pos, end - pos);
+    pos = end + 1;
+    if (range.find_first_of("0123456789") == std::string::npos) continue;
+    size_t dash = range.find('-');
+    int first = std::stoi(range.substr(0, dash));
+    int last = dash == std::string::npos ? first
+                                         : std::stoi(range.substr(dash + 1));
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+#ifdef __linux__
+static std::string ReadSysfs(const std::string& path) {
+  std::ifstream file(path);
+  std::string content;
+  std::getline(file, content);
+  return content;
+}
+
+// The same as MPOL_PREFERRED, MPOL_BIND and MPOL_MF_MOVE of numaif.h.
+constexpr int kMpolPreferred = 1;
+constexpr int kMpolBind = 2;
+constexpr unsigned kMpolMfMove = 1 << 1;
+
+static std::vector<unsigned long> NumaNodeMask(int node) {  // NOLINT
+  constexpr int kBits = 8 * sizeof(unsigned long);          // NOLINT
+  std::vector<unsigned long> mask(node / kBits + 1, 0);     // NOLINT
+  mask[node / kBits] = 1UL << (node % kBits);
+  return mask;
+}
+#endif
+
+int CpuPhysicalCoreCount() {
+  static int count = [] {
+    int logical = std::max<int>(std::thread::hardware_concurrency(), 1);
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) != 0) return logical;
+    std::set<std::pair<std::string, std::string>> cores;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (!CPU_ISSET(cpu, &cpu_set)) continue;
+      auto dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                 "/topology/";
+      auto core = ReadSysfs(dir + "core_id");
+      if (core.empty()) return std::min(CPU_COUNT(&cpu_set), logical);
+      cores.emplace(ReadSysfs(dir + "physical_package_id"), core);
+    }
+    return cores.empty() ? logical : static_cast<int>(cores.size());
+#else
+    return logical;
+#endif
+  }();
+  return count;
+}
+
+int NumaNodeCount() {
+#ifdef __linux__
+  static int count = [] {
+    auto nodes = ParseCPUList(ReadSysfs("/sys/devices/system/node/online"));
+    return nodes.empty() ? 1 : nodes.back() + 1;
+  }();
+  return count;
+#else
+  return 1;
+#endif
+}
+
+std::vector<int> NumaNodeCPUs(int node) {
+#ifdef __linux__
+  return ParseCPUList(ReadSysfs("/sys/devices/system/node/node" +
+                                std::to_string(node) + "/cpulist"));
+#else
+  return {};
+#endif
+}
+
+static thread_local int current_numa_node = -1;
+
+bool BindCurrentThreadToNumaNode(int node) {
+  if (current_numa_node == node) return true;
+#ifdef __linux__
+  auto cpus = NumaNodeCPUs(node);
+  if (node < 0 || cpus.empty()) {
+    LOG(WARNING) << "Fail to bind to the NUMA node " << node
+                 << ", its CPUs are unknown";
+    return false;
+  }
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (int cpu : cpus) {
+    CPU_SET(cpu, &cpu_set);
+  }
+  if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+    LOG(WARNING) << "Fail to pin the thread to the NUMA node " << node;
+    return false;
+  }
+  auto mask = NumaNodeMask(node);
+  if (syscall(SYS_set_mempolicy, kMpolPreferred, mask.data(),
+              mask.size() * 8 * sizeof(mask[0])) != 0) {
+    LOG(WARNING) << "Fail to prefer the memory of the NUMA node " << node;
+  }
+  current_numa_node = node;
+  return true;
+#else
+  LOG(WARNING) << "NUMA binding is only supported on Linux";
+  return false;
+#endif
+}
+
+int CurrentNumaNode() { return current_numa_node; }
+
+bool BindMemoryToNumaNode(void* p, size_t size, int node) {
+#ifdef __linux__
+  if (node < 0 || size == 0) return false;
+  auto mask = NumaNodeMask(node);
+  return syscall(SYS_mbind, p, size, kMpolBind, mask.data(),
+                 mask.size() * 8 * sizeof(mask[0]), kMpolMfMove) == 0;
+#else
+  return false;
+#endif
+}
+
 namespace jit {
 #ifdef PADDLE_WITH_XBYAK
 static Xbyak::util::Cpu cpu;
@@ -15,6 +15,8 @@ limitations under the License. */
 #pragma once
 
 #include <stddef.h>
+#include <string>
+#include <vector>
 
 namespace paddle {
 namespace platform {
@@ -37,6 +39,33 @@ size_t CUDAPinnedMinChunkSize();
 //! Get the maximum chunk size for buddy allocator.
 size_t CUDAPinnedMaxChunkSize();
 
+//! Get the number of the NUMA nodes, 1 if the topology is unknown.
+int NumaNodeCount();
+
+//! Get the CPUs of a NUMA node, empty if the topology is unknown.
+std::vector<int> NumaNodeCPUs(int node);
+
+//! Get the number of the physical cores the process may run on, counting the
+//! hyper-threads of a core once. It falls back to the logical CPUs if the
+//! topology is unknown.
+int CpuPhysicalCoreCount();
+
+//! Parse a CPU or node list of sysfs, e.g. "0-3,8,10-11".
+std::vector<int> ParseCPUList(const std::string& list);
+
+//! Pin the current thread and the threads it creates after, e.g. the OpenMP
+//! threads, to the CPUs of a NUMA node, and prefer the memory of the node for
+//! their allocations. The CPU memory allocated by Paddle on the thread comes
+//! from an arena of the node after. Return false if the binding fails.
+bool BindCurrentThreadToNumaNode(int node);
+
+//! Get the NUMA node the current thread is bound to, -1 if it is not bound.
+int CurrentNumaNode();
+
+//! Move the pages of [p, p + size) to a NUMA node and allocate them there
+//! after. p should be aligned to the page size. Return false if it fails.
+bool BindMemoryToNumaNode(void* p, size_t size, int node);
+
 namespace jit {
 typedef enum {
   isa_any,
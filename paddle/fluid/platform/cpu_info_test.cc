@@ -13,8 +13,11 @@
 // limitations under the License.
 #include "paddle/fluid/platform/cpu_info.h"
 
+#include <algorithm>
 #include <ostream>
 #include <sstream>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "gflags/gflags.h"
 #include "glog/logging.h"
@@ -32,3 +35,31 @@ TEST(CpuMemoryUsage, Print) {
                                        use_percent, memory_size)
             << std::endl;
 }
+
+TEST(CpuInfo, ParseCPUList) {
+  EXPECT_EQ(paddle::platform::ParseCPUList("0-3,8,10-11"),
+            std::vector<int>({0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(paddle::platform::ParseCPUList("5"), std::vector<int>({5}));
+  EXPECT_TRUE(paddle::platform::ParseCPUList("").empty());
+}
+
+TEST(CpuInfo, CpuPhysicalCoreCount) {
+  int cores = paddle::platform::CpuPhysicalCoreCount();
+  EXPECT_GE(cores, 1);
+  EXPECT_LE(cores, std::max<int>(std::thread::hardware_concurrency(), 1));
+}
+
+TEST(CpuInfo, BindCurrentThreadToNumaNode) {
+  int num_nodes = paddle::platform::NumaNodeCount();
+  ASSERT_GE(num_nodes, 1);
+  EXPECT_EQ(paddle::platform::CurrentNumaNode(), -1);
+  // The test thread is bound in a new thread, which is not bound at first.
+  std::thread t([num_nodes] {
+    int node = num_nodes - 1;
+    if (paddle::platform::NumaNodeCPUs(node).empty()) return;
+    EXPECT_TRUE(paddle::platform::BindCurrentThreadToNumaNode(node));
+    EXPECT_EQ(paddle::platform::CurrentNumaNode(), node);
+  });
+  t.join();
+  EXPECT_EQ(paddle::platform::CurrentNumaNode(), -1);
+}
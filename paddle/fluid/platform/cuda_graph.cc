@@ -0,0 +1,81 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/cuda_graph.h"
+
+#ifdef PADDLE_WITH_CUDA
+#include "glog/logging.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace platform {
+
+#if CUDART_VERSION >= 10010
+CUDAGraph::~CUDAGraph() {
+  if (exec_ != nullptr) cudaGraphExecDestroy(exec_);
+  if (graph_ != nullptr) cudaGraphDestroy(graph_);
+}
+
+bool CUDAGraph::IsSupported() { return true; }
+
+void CUDAGraph::BeginCapture(cudaStream_t stream) {
+  // The relaxed mode allows the allocations of the other threads, the
+  // kernels do not depend on them.
+  PADDLE_ENFORCE(
+      cudaStreamBeginCapture(stream, cudaStreamCaptureModeRelaxed));
+}
+
+std::unique_ptr<CUDAGraph> CUDAGraph::EndCapture(cudaStream_t stream) {
+  std::unique_ptr<CUDAGraph> graph(new CUDAGraph);
+  auto err = cudaStreamEndCapture(stream, &graph->graph_);
+  if (err != cudaSuccess) {
+    // Clear the error of the invalidated capture.
+    cudaGetLastError();
+    VLOG(3) << "The capture is invalidated: " << cudaGetErrorString(err);
+    return nullptr;
+  }
+  err = cudaGraphInstantiate(&graph->exec_, graph->graph_, nullptr, nullptr,
+                             0);
+  if (err != cudaSuccess) {
+    cudaGetLastError();
+    VLOG(3) << "Cannot instantiate the graph: " << cudaGetErrorString(err);
+    return nullptr;
+  }
+  return graph;
+}
+
+void CUDAGraph::Replay(cudaStream_t stream) const {
+  PADDLE_ENFORCE(cudaGraphLaunch(exec_, stream));
+}
+#else
+CUDAGraph::~CUDAGraph() {}
+
+bool CUDAGraph::IsSupported() { return false; }
+
+void CUDAGraph::BeginCapture(cudaStream_t stream) {
+  PADDLE_THROW("The CUDA graph needs CUDA 10.1 or later.");
+}
+
+std::unique_ptr<CUDAGraph> CUDAGraph::EndCapture(cudaStream_t stream) {
+  PADDLE_THROW("The CUDA graph needs CUDA 10.1 or later.");
+}
+
+void CUDAGraph::Replay(cudaStream_t stream) const {
+  PADDLE_THROW("The CUDA graph needs CUDA 10.1 or later.");
+}
+#endif
+
+}  // namespace platform
+}  // namespace paddle
+#endif
@@ -0,0 +1,56 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#ifdef PADDLE_WITH_CUDA
+#include <cuda_runtime.h>
+#include <memory>
+
+namespace paddle {
+namespace platform {
+
+/*
+ * The kernels launched on a stream between BeginCapture and EndCapture,
+ * which are recorded instead of run, and replayed at once on the same memory
+ * with the parameters of the capture. Only CUDA 10.1 and later support it.
+ */
+class CUDAGraph {
+ public:
+  ~CUDAGraph();
+
+  static bool IsSupported();
+
+  // The calling thread should not synchronize the stream, or copy between
+  // the host and the device, until EndCapture.
+  static void BeginCapture(cudaStream_t stream);
+
+  // The captured graph, or nullptr if the capture is invalidated, e.g. by a
+  // synchronization in it.
+  static std::unique_ptr<CUDAGraph> EndCapture(cudaStream_t stream);
+
+  void Replay(cudaStream_t stream) const;
+
+ private:
+  CUDAGraph() = default;
+
+#if CUDART_VERSION >= 10010
+  cudaGraph_t graph_{nullptr};
+  cudaGraphExec_t exec_{nullptr};
+#endif
+};
+
+}  // namespace platform
+}  // namespace paddle
+#endif
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
 #include <vector>
 
 #include "paddle/fluid/framework/operator.h"
@@ -172,8 +173,7 @@ class CudnnDataType<double> {
   }
 };
 
-inline cudnnTensorFormat_t GetCudnnTensorFormat(
-    const DataLayout& order) {  // Not use
+inline cudnnTensorFormat_t GetCudnnTensorFormat(const DataLayout& order) {
   switch (order) {
     case DataLayout::kNHWC:
       return CUDNN_TENSOR_NHWC;
@@ -200,15 +200,21 @@ class ScopedTensorDescriptor {
                                             const cudnnDataType_t type,
                                             const std::vector<int>& dims,
                                             const int groups = 1) {
-    // the format is not used now, will add later
     std::vector<int> strides(dims.size());
     strides[dims.size() - 1] = 1;
     for (int i = dims.size() - 2; i >= 0; i--) {
       strides[i] = dims[i + 1] * strides[i + 1];
     }
-    // Update tensor descriptor dims setting if groups > 1
-    // NOTE: Assume using NCHW or NCDHW order
     std::vector<int> dims_with_group(dims.begin(), dims.end());  // copy
+    if (format == CUDNN_TENSOR_NHWC) {
+      // dims are in NHWC(NDHWC) order, but cudnn takes them in NCHW(NCDHW)
+      // order along with the strides of the channel-last memory.
+      std::rotate(dims_with_group.begin() + 1, dims_with_group.end() - 1,
+                  dims_with_group.end());
+      std::rotate(strides.begin() + 1, strides.end() - 1, strides.end());
+    }
+    // Update tensor descriptor dims setting if groups > 1, the strides are
+    // kept so that a group is a view of the whole tensor.
     if (groups > 1) {
       dims_with_group[1] = dims_with_group[1] / groups;
     }
@@ -248,7 +254,13 @@ class ScopedFilterDescriptor {
     // output image channels, C is the number of input image channels,
     // D is the depth of the filter, H is the height of the filter, and W is the
     // width of the filter.
+    // The NHWC(NDHWC) filter is MHWC(MDHWC), cudnn takes its dims in MCHW
+    // (MCDHW) order as well.
     std::vector<int> kernel_with_group(kernel.begin(), kernel.end());
+    if (format == CUDNN_TENSOR_NHWC) {
+      std::rotate(kernel_with_group.begin() + 1, kernel_with_group.end() - 1,
+                  kernel_with_group.end());
+    }
     if (groups > 1) {
       kernel_with_group[0] /= groups;
       // NOTE: input filter(C) of the filter is already asserted to be C/groups.
@@ -10,22 +10,83 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 #include "paddle/fluid/platform/device_context.h"
 
+#include <algorithm>
 #include <set>
 #include <string>
 #include <unordered_set>
 #include <vector>
 
+#include "gflags/gflags.h"
 #include "paddle/fluid/memory/memory.h"
+#include "paddle/fluid/platform/intra_op_thread_pool.h"
 #ifdef PADDLE_WITH_CUDA
 #include "paddle/fluid/framework/rw_lock.h"
 #endif
 
+DECLARE_int64(cpu_intra_op_grain_size);
+
+#ifdef PADDLE_WITH_MKLDNN
+DEFINE_int32(mkldnn_cache_capacity, 0,
+             "The number of the groups of the MKLDNN primitives and memories "
+             "cached for each thread, e.g. one group for each operator and "
+             "input shape. The least recently used groups are evicted beyond "
+             "it, so that the variable input shapes do not fill the memory. "
+             "0 means unlimited.");
+#endif
+
+#ifdef PADDLE_WITH_CUDA
+DEFINE_bool(cudnn_share_workspace, true,
+            "Share the cudnn workspaces among the device contexts of a GPU, "
+            "e.g. of the streams of the predictors, instead of each holding "
+            "a workspace as large as its largest request.");
+#endif
+
 namespace paddle {
 namespace platform {
 
 DeviceContextPool* DeviceContextPool::pool = nullptr;
 
+namespace {
+// The device context set by ScopedDeviceContextOverride on the thread.
+thread_local DeviceContext* override_ctx = nullptr;
+
+#ifdef PADDLE_WITH_CUDA
+void SetThreadStream(DeviceContext* ctx) {
+  if (ctx != nullptr && is_gpu_place(ctx->GetPlace())) {
+    auto* cuda_ctx = static_cast<CUDADeviceContext*>(ctx);
+    memory::SetThreadStream(boost::get<CUDAPlace>(ctx->GetPlace()).device,
+                            cuda_ctx->stream());
+  } else {
+    memory::SetThreadStream(-1, nullptr);
+  }
+}
+#endif
+}  // namespace
+
+ScopedDeviceContextOverride::ScopedDeviceContextOverride(DeviceContext* ctx)
+    : prev_(override_ctx) {
+  override_ctx = ctx;
+#ifdef PADDLE_WITH_CUDA
+  SetThreadStream(ctx);
+#endif
+}
+
+ScopedDeviceContextOverride::~ScopedDeviceContextOverride() {
+  override_ctx = prev_;
+#ifdef PADDLE_WITH_CUDA
+  SetThreadStream(prev_);
+#endif
+}
+
 platform::DeviceContext* DeviceContextPool::Get(const platform::Place& place) {
+  if (override_ctx != nullptr && override_ctx->GetPlace() == place) {
+    return override_ctx;
+  }
+  return GetDefault(place);
+}
+
+platform::DeviceContext* DeviceContextPool::GetDefault(
+    const platform::Place& place) {
   auto it = device_contexts_.find(place);
   if (it == device_contexts_.end()) {
     PADDLE_THROW(
@@ -35,6 +96,48 @@ platform::DeviceContext* DeviceContextPool::Get(const platform::Place& place) {
   return it->second.get().get();
 }
 
+platform::DeviceContext* DeviceContextPool::GetStreamContext(
+    const platform::Place& place, int stream_id) {
+  // The context of the stream 0 is created first, so its stream stays the
+  // default stream of the memory allocations.
+  auto* ctx = GetDefault(place);
+  if (stream_id == 0 || !is_gpu_place(place)) return ctx;
+#ifdef PADDLE_WITH_CUDA
+  std::lock_guard<std::mutex> lock(stream_contexts_mutex_);
+  auto& stream_ctx = stream_contexts_[std::make_pair(place, stream_id)];
+  if (stream_ctx == nullptr) {
+    VLOG(3) << "Create the stream " << stream_id << " of " << place;
+    stream_ctx.reset(new CUDADeviceContext(boost::get<CUDAPlace>(place)));
+  }
+  return stream_ctx.get();
+#else
+  return ctx;
+#endif
+}
+
+void DeviceContextPool::JoinStreamContexts(const platform::Place& place) {
+#ifdef PADDLE_WITH_CUDA
+  if (!is_gpu_place(place)) return;
+  std::vector<CUDADeviceContext*> ctxes;
+  {
+    std::lock_guard<std::mutex> lock(stream_contexts_mutex_);
+    for (auto& item : stream_contexts_) {
+      if (item.first.first == place) {
+        ctxes.push_back(static_cast<CUDADeviceContext*>(item.second.get()));
+      }
+    }
+  }
+  if (ctxes.empty()) return;
+  auto* main_ctx = static_cast<CUDADeviceContext*>(GetDefault(place));
+  for (auto* ctx : ctxes) {
+    main_ctx->WaitContext(*ctx);
+  }
+  for (auto* ctx : ctxes) {
+    ctx->WaitContext(*main_ctx);
+  }
+#endif
+}
+
 template <typename DevCtx, typename PlaceType>
 inline void EmplaceDeviceContext(
     std::map<Place, std::shared_future<std::unique_ptr<DeviceContext>>>*
@@ -98,6 +201,19 @@ Eigen::DefaultDevice* CPUDeviceContext::eigen_device() const {
 
 Place CPUDeviceContext::GetPlace() const { return place_; }
 
+void CPUDeviceContext::ParallelFor(
+    int64_t n, const std::function<void(int64_t, int64_t)>& fn,
+    int64_t elements_per_item) const {
+  elements_per_item = std::max<int64_t>(elements_per_item, 1);
+  int64_t grain_size = std::max<int64_t>(
+      FLAGS_cpu_intra_op_grain_size / elements_per_item, 1);
+  if (n < 2 * grain_size) {
+    fn(0, n);
+    return;
+  }
+  IntraOpThreadPool::GetInstance()->ParallelFor(n, grain_size, fn);
+}
+
 #ifdef PADDLE_WITH_CUDA
 
 class EigenCudaStreamDevice : public Eigen::StreamInterface {
@@ -153,8 +269,92 @@ class EigenCudaStreamDevice : public Eigen::StreamInterface {
   mutable unsigned int* semaphore_;
 };
 
+CudnnWorkspacePool& CudnnWorkspacePool::Instance(int device) {
+  // Never destroyed, since the workspaces can not be freed after the CUDA
+  // runtime is unloaded at exit.
+  static auto* pools = new std::map<int, std::unique_ptr<CudnnWorkspacePool>>;
+  static std::mutex mtx;
+  std::lock_guard<std::mutex> lock(mtx);
+  auto& pool = (*pools)[device];
+  if (!pool) {
+    pool.reset(new CudnnWorkspacePool(device));
+  }
+  return *pool;
+}
+
+void* CudnnWorkspacePool::Borrow(size_t len, cudaStream_t stream) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  // Prefer the workspaces with no pending work of the other streams, then
+  // the smallest ones.
+  auto ready = [stream](const Workspace& w) {
+    return w.stream == stream || cudaEventQuery(w.event) == cudaSuccess;
+  };
+  int best = -1;
+  bool best_ready = false;
+  for (size_t i = 0; i < workspaces_.size(); ++i) {
+    auto& w = workspaces_[i];
+    if (w.lent || w.len < len) continue;
+    bool w_ready = ready(w);
+    if (best < 0 || (w_ready && !best_ready) ||
+        (w_ready == best_ready && w.len < workspaces_[best].len)) {
+      best = static_cast<int>(i);
+      best_ready = w_ready;
+    }
+  }
+  if (best < 0) {
+    // The new workspace replaces the free ones which are too small, so the
+    // pool holds about the workspaces used at the same time.
+    SetDeviceId(device_);
+    for (auto it = workspaces_.begin(); it != workspaces_.end();) {
+      if (!it->lent) {
+        PADDLE_ENFORCE(cudaEventSynchronize(it->event));
+        PADDLE_ENFORCE(cudaEventDestroy(it->event));
+        paddle::memory::Free(CUDAPlace(device_), it->ptr);
+        it = workspaces_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    Workspace w;
+    w.ptr = paddle::memory::Alloc(CUDAPlace(device_), len);
+    w.len = len;
+    w.stream = stream;
+    w.lent = false;
+    PADDLE_ENFORCE(cudaEventCreateWithFlags(&w.event, cudaEventDisableTiming));
+    VLOG(3) << "allocate a cudnn workspace of " << len << " bytes on GPU "
+            << device_;
+    workspaces_.push_back(w);
+    best = static_cast<int>(workspaces_.size()) - 1;
+  }
+  auto& w = workspaces_[best];
+  if (w.stream != stream) {
+    PADDLE_ENFORCE(cudaStreamWaitEvent(stream, w.event, 0));
+  }
+  w.stream = stream;
+  w.lent = true;
+  return w.ptr;
+}
+
+void CudnnWorkspacePool::Return(void* workspace, cudaStream_t stream) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  for (auto& w : workspaces_) {
+    if (w.ptr == workspace) {
+      PADDLE_ENFORCE(w.lent, "the cudnn workspace is not borrowed");
+      PADDLE_ENFORCE(cudaEventRecord(w.event, stream));
+      w.stream = stream;
+      w.lent = false;
+      return;
+    }
+  }
+  PADDLE_THROW("the cudnn workspace is not in the pool");
+}
+
 CudnnHolder::CudnnHolder(const cudaStream_t* stream, const CUDAPlace& place)
-    : workspace_(nullptr), workspace_len_(0), stream_(stream), place_(place) {
+    : workspace_(nullptr),
+      workspace_len_(0),
+      stream_(stream),
+      place_(place),
+      share_workspace_(FLAGS_cudnn_share_workspace) {
   PADDLE_ENFORCE(dynload::cudnnCreate(&cudnn_handle_));
   PADDLE_ENFORCE(dynload::cudnnSetStream(cudnn_handle_, *stream_));
 }
@@ -191,6 +391,17 @@ CUDADeviceContext::CUDADeviceContext(CUDAPlace place)
   eigen_device_.reset(new Eigen::GpuDevice(eigen_stream_.get()));
   PADDLE_ENFORCE(dynload::cublasCreate(&cublas_handle_));
   PADDLE_ENFORCE(dynload::cublasSetStream(cublas_handle_, stream_));
+  // The copies never wait for the legacy default stream, and are
+  // scheduled before the kernels of the lower priority streams.
+  int least_priority, greatest_priority;
+  PADDLE_ENFORCE(
+      cudaDeviceGetStreamPriorityRange(&least_priority, &greatest_priority));
+  PADDLE_ENFORCE(cudaStreamCreateWithPriority(
+      &copy_stream_, cudaStreamNonBlocking, greatest_priority));
+  PADDLE_ENFORCE(
+      cudaEventCreateWithFlags(&compute_event_, cudaEventDisableTiming));
+  PADDLE_ENFORCE(
+      cudaEventCreateWithFlags(&copy_event_, cudaEventDisableTiming));
   if (dynload::HasCUDNN()) {
     cudnn_holder_.reset(new CudnnHolder(&stream_, place));
   }
@@ -206,15 +417,21 @@ CUDADeviceContext::CUDADeviceContext(CUDAPlace place)
                           << "." << (runtime_version_ % 100) / 10;
 
   callback_manager_.reset(new StreamCallbackManager(stream_));
+  memory::SetDefaultStream(place_, stream_);
 }
 
 CUDADeviceContext::~CUDADeviceContext() {
   SetDeviceId(place_.device);
   Wait();
   WaitStreamCallback();
+  memory::ResetDefaultStream(place_, stream_);
   PADDLE_ENFORCE(dynload::cublasDestroy(cublas_handle_));
   eigen_stream_.reset();
   eigen_device_.reset();
+  PADDLE_ENFORCE(cudaStreamSynchronize(copy_stream_));
+  PADDLE_ENFORCE(cudaEventDestroy(compute_event_));
+  PADDLE_ENFORCE(cudaEventDestroy(copy_event_));
+  PADDLE_ENFORCE(cudaStreamDestroy(copy_stream_));
   PADDLE_ENFORCE(cudaStreamDestroy(stream_));
 }
 
@@ -251,6 +468,32 @@ CudnnWorkspaceHandle CUDADeviceContext::cudnn_workspace_handle() const {
 
 cudaStream_t CUDADeviceContext::stream() const { return stream_; }
 
+cudaStream_t CUDADeviceContext::copy_stream() const { return copy_stream_; }
+
+void CUDADeviceContext::CopyStreamWaitCompute() const {
+  SetDeviceId(place_.device);
+  std::lock_guard<std::mutex> guard(copy_mtx_);
+  PADDLE_ENFORCE(cudaEventRecord(compute_event_, stream_));
+  PADDLE_ENFORCE(cudaStreamWaitEvent(copy_stream_, compute_event_, 0));
+}
+
+void CUDADeviceContext::ComputeWaitCopyStream() const {
+  SetDeviceId(place_.device);
+  std::lock_guard<std::mutex> guard(copy_mtx_);
+  PADDLE_ENFORCE(cudaEventRecord(copy_event_, copy_stream_));
+  PADDLE_ENFORCE(cudaStreamWaitEvent(stream_, copy_event_, 0));
+}
+
+void CUDADeviceContext::WaitContext(const CUDADeviceContext& other) const {
+  SetDeviceId(place_.device);
+  cudaEvent_t event;
+  PADDLE_ENFORCE(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+  PADDLE_ENFORCE(cudaEventRecord(event, other.stream()));
+  PADDLE_ENFORCE(cudaStreamWaitEvent(stream_, event, 0));
+  // The event is released once it completes.
+  PADDLE_ENFORCE(cudaEventDestroy(event));
+}
+
 CUDAPinnedDeviceContext::CUDAPinnedDeviceContext() {
   eigen_device_.reset(new Eigen::DefaultDevice());
 }
@@ -282,60 +525,73 @@ thread_local int cur_thread_id = 0;
 void set_cur_thread_id(int tid) { cur_thread_id = tid; }
 int get_cur_thread_id(void) { return cur_thread_id; }
 
-void MKLDNNDeviceContext::SetBlob(const std::string& name,
-                                  std::shared_ptr<void> data) const {
-  BlobMap* pMap = p_blobmap_.get();
-  std::shared_ptr<KeyBlob> pBlob = nullptr;
-
-  int tid = platform::get_cur_thread_id();
-
-  std::lock_guard<std::mutex> lock(*p_mutex_.get());
-
-  // Find KeyBlob for current thread
-  auto map_it = pMap->find(tid);
-
-  if (map_it == pMap->end()) {
-    // 1st time to set blob in current thread
-    pBlob = std::shared_ptr<KeyBlob>(new KeyBlob());
-    (*pMap)[tid] = pBlob;
-  } else {
-    pBlob = map_it->second;
+KeyBlob::GroupList::iterator KeyBlob::Touch(const std::string& name,
+                                            bool create) {
+  auto prefix = name.substr(0, name.find('@'));
+  auto it = index_.find(prefix);
+  if (it == index_.end()) {
+    if (!create) return groups_.end();
+    groups_.emplace_front();
+    groups_.front().prefix = prefix;
+    it = index_.emplace(prefix, groups_.begin()).first;
+  } else if (it->second != groups_.begin()) {
+    groups_.splice(groups_.begin(), groups_, it->second);
   }
+  return it->second;
+}
 
-  // Find Key in found (or newly created) KeyBlob
-  auto key_it = pBlob->find(name);
+std::shared_ptr<void> KeyBlob::Get(const std::string& name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto group = Touch(name, false);
+  if (group == groups_.end()) return nullptr;
+  auto it = group->blobs.find(name);
+  return it == group->blobs.end() ? nullptr : it->second;
+}
 
-  if (key_it == pBlob->end()) {
-    (*pBlob)[name] = data;  // create new blob
-  } else {
-    key_it->second = data;  // set data to existing blob
+void KeyBlob::Set(const std::string& name, std::shared_ptr<void> data,
+                  size_t capacity) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto group = Touch(name, true);
+  group->blobs[name] = std::move(data);
+  while (capacity > 0 && groups_.size() > capacity) {
+    VLOG(4) << "Evict the MKLDNN blobs of " << groups_.back().prefix;
+    index_.erase(groups_.back().prefix);
+    groups_.pop_back();
   }
-
-  // lock will be automatically released when out of scope
-  return;
 }
 
-std::shared_ptr<void> MKLDNNDeviceContext::GetBlob(
-    const std::string& name) const {
-  BlobMap* pMap = p_blobmap_.get();
-  std::shared_ptr<KeyBlob> pBlob = nullptr;
+size_t KeyBlob::num_groups() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return groups_.size();
+}
 
+KeyBlob* MKLDNNDeviceContext::GetKeyBlob() const {
   int tid = platform::get_cur_thread_id();
-
+  // Only the lookup of the blobs of the thread is serialized, the blobs of
+  // different threads are set and found in parallel.
   std::lock_guard<std::mutex> lock(*p_mutex_.get());
+  auto& blob = (*p_blobmap_)[tid];
+  if (blob == nullptr) {
+    // 1st time to set blob in current thread
+    blob.reset(new KeyBlob());
+  }
+  return blob.get();
+}
 
-  // Find KeyBlob for current thread firstly
-  auto map_it = pMap->find(tid);
-  if (map_it == pMap->end()) return nullptr;
-  pBlob = map_it->second;
-
-  // Find Blob via name
-  auto key_it = pBlob->find(name);
+void MKLDNNDeviceContext::SetBlob(const std::string& name,
+                                  std::shared_ptr<void> data) const {
+  GetKeyBlob()->Set(name, std::move(data),
+                    static_cast<size_t>(std::max(FLAGS_mkldnn_cache_capacity,
+                                                 0)));
+}
 
-  if (key_it == pBlob->end()) return nullptr;
+std::shared_ptr<void> MKLDNNDeviceContext::GetBlob(
+    const std::string& name) const {
+  return GetKeyBlob()->Get(name);
+}
 
-  // lock will be automatically released when out of scope
-  return key_it->second;
+size_t MKLDNNDeviceContext::GetNumBlobGroups() const {
+  return GetKeyBlob()->num_groups();
 }
 
 #endif
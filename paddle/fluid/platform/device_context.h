@@ -11,10 +11,13 @@ limitations under the License. */
 #pragma once
 
 #include <future>  // NOLINT
+#include <list>
+#include <functional>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #ifdef PADDLE_WITH_CUDA
@@ -57,6 +60,13 @@ class CPUDeviceContext : public DeviceContext {
 
   Place GetPlace() const override;
 
+  // Split the loop over [0, n) into the chunks run by the intra-op thread
+  // pool, if the elements of the loop, n * elements_per_item, are enough.
+  // fn(begin, end) should be safe to call on disjoint ranges at the same
+  // time.
+  void ParallelFor(int64_t n, const std::function<void(int64_t, int64_t)>& fn,
+                   int64_t elements_per_item = 1) const;
+
  private:
   CPUPlace place_;
   std::unique_ptr<Eigen::DefaultDevice> eigen_device_;
@@ -73,6 +83,42 @@ struct DefaultDeviceContextType<platform::CPUPlace> {
 #ifdef PADDLE_WITH_CUDA
 
 class EigenCudaStreamDevice;
+
+/*! \brief  The cudnn workspaces of a GPU, shared by the cudnn holders of
+ *  all the device contexts on it instead of each holding a workspace of
+ *  its largest request. A workspace is lent to one stream at a time, and
+ *  the stream borrowing a workspace last used by another stream waits for
+ *  the work of that stream on it. */
+class CudnnWorkspacePool {
+ public:
+  static CudnnWorkspacePool& Instance(int device);
+
+  /*! \brief  Lend a workspace of at least len bytes to the work issued to
+   *  stream from now on. */
+  void* Borrow(size_t len, cudaStream_t stream);
+
+  /*! \brief  Return a workspace borrowed, which is used by the work issued
+   *  to stream so far. */
+  void Return(void* workspace, cudaStream_t stream);
+
+ private:
+  explicit CudnnWorkspacePool(int device) : device_(device) {}
+
+  struct Workspace {
+    void* ptr;
+    size_t len;
+    // The stream using the workspace last, and the event after its work.
+    cudaStream_t stream;
+    cudaEvent_t event;
+    bool lent;
+  };
+
+  int device_;
+  std::mutex mtx_;
+  std::vector<Workspace> workspaces_;
+  DISABLE_COPY_AND_ASSIGN(CudnnWorkspacePool);
+};
+
 class CudnnHolder {
  public:
   CudnnHolder(const cudaStream_t* stream, const CUDAPlace& place);
@@ -85,6 +131,17 @@ class CudnnHolder {
 
   template <typename Callback>
   void RunFuncImpl(Callback&& cudnn_func, size_t required_workspace_len) {
+    if (share_workspace_) {
+      if (required_workspace_len == 0) {
+        cudnn_func(nullptr);
+        return;
+      }
+      auto& pool = CudnnWorkspacePool::Instance(place_.device);
+      void* workspace = pool.Borrow(required_workspace_len, *stream_);
+      cudnn_func(workspace);
+      pool.Return(workspace, *stream_);
+      return;
+    }
     if (required_workspace_len > workspace_len_) {
       ReallocateWorkspace(required_workspace_len);
     }
@@ -99,6 +156,8 @@ class CudnnHolder {
 
   const cudaStream_t* stream_;  // not owned;
   const CUDAPlace place_;
+  // Borrow the workspaces from the CudnnWorkspacePool of the GPU.
+  bool share_workspace_;
 
   std::mutex mtx_;
 };
@@ -166,6 +225,22 @@ class CUDADeviceContext : public DeviceContext {
   /*! \brief  Return cuda stream in the device context. */
   cudaStream_t stream() const;
 
+  /*! \brief  Return the stream dedicated to the host-device copies, the
+   *  copies on it overlap the kernels on stream(). */
+  cudaStream_t copy_stream() const;
+
+  /*! \brief  Make the copies issued to copy_stream() from now on wait
+   *  for the work issued to stream() so far. */
+  void CopyStreamWaitCompute() const;
+
+  /*! \brief  Make the work issued to stream() from now on wait for the
+   *  copies issued to copy_stream() so far. */
+  void ComputeWaitCopyStream() const;
+
+  /*! \brief  Make the work issued to stream() from now on wait for the
+   *  work issued to the stream of other so far. */
+  void WaitContext(const CUDADeviceContext& other) const;
+
   template <typename Callback>
   void RecordEvent(cudaEvent_t ev, Callback callback) {
     std::lock_guard<std::mutex> guard(mtx_);
@@ -193,6 +268,12 @@ class CUDADeviceContext : public DeviceContext {
   cudaStream_t stream_;
   cublasHandle_t cublas_handle_;
 
+  cudaStream_t copy_stream_;
+  // the events ordering stream_ and copy_stream_
+  cudaEvent_t compute_event_;
+  cudaEvent_t copy_event_;
+  mutable std::mutex copy_mtx_;
+
   int compute_capability_;
   int runtime_version_;
   int driver_version_;
@@ -234,7 +315,37 @@ struct DefaultDeviceContextType<platform::CUDAPinnedPlace> {
 #endif
 
 #ifdef PADDLE_WITH_MKLDNN
-using KeyBlob = std::unordered_map<std::string, std::shared_ptr<void>>;
+// The blobs of one thread. They are grouped by the prefix of their names
+// before the first '@', e.g. the hash of the shapes and the attributes of an
+// operator, since the blobs of a group are created and reused together. The
+// least recently used groups are evicted beyond the capacity.
+class KeyBlob {
+ public:
+  std::shared_ptr<void> Get(const std::string& name);
+
+  // Evict the least recently used groups but this one to keep the number of
+  // groups within capacity, which is unlimited if it is 0.
+  void Set(const std::string& name, std::shared_ptr<void> data,
+           size_t capacity);
+
+  size_t num_groups() const;
+
+ private:
+  struct Group {
+    std::string prefix;
+    std::unordered_map<std::string, std::shared_ptr<void>> blobs;
+  };
+  using GroupList = std::list<Group>;
+
+  // Find the group of name and move it to the front.
+  GroupList::iterator Touch(const std::string& name, bool create);
+
+  mutable std::mutex mutex_;
+  // The most recently used group comes first.
+  GroupList groups_;
+  std::unordered_map<std::string, GroupList::iterator> index_;
+};
+
 using BlobMap = std::unordered_map<int, std::shared_ptr<KeyBlob>>;
 
 void set_cur_thread_id(int);
@@ -253,7 +364,15 @@ class MKLDNNDeviceContext : public CPUDeviceContext {
   // Find a saved blob. Return nullptr if not found
   std::shared_ptr<void> GetBlob(const std::string& name) const;
 
+  // The number of blob groups of the current thread,
+  // see FLAGS_mkldnn_cache_capacity.
+  size_t GetNumBlobGroups() const;
+
  private:
+  // The blobs of the current thread.
+  KeyBlob* GetKeyBlob() const;
+
+
   mkldnn::engine engine_;
   std::shared_ptr<BlobMap> p_blobmap_;
   std::shared_ptr<std::mutex> p_mutex_;
@@ -290,12 +409,43 @@ class DeviceContextPool {
 
   size_t size() const { return device_contexts_.size(); }
 
+  /*! \brief  Return the device context of the stream stream_id in the
+   *  stream pool of a GPU place, the stream 0 is the one of Get(place).
+   *  The other places have only the stream 0. */
+  platform::DeviceContext* GetStreamContext(const platform::Place& place,
+                                            int stream_id);
+
+  /*! \brief  Order the streams in the stream pool of a place, so that the
+   *  work issued to any of them from now on waits for the work issued to
+   *  all of them so far. Waiting for Get(place) then waits for all. */
+  void JoinStreamContexts(const platform::Place& place);
+
  private:
+  /*! \brief  Get(place), ignoring the ScopedDeviceContextOverride */
+  platform::DeviceContext* GetDefault(const platform::Place& place);
+
   static DeviceContextPool* pool;
   std::map<Place, std::shared_future<std::unique_ptr<DeviceContext>>>
       device_contexts_;
+  std::mutex stream_contexts_mutex_;
+  std::map<std::pair<Place, int>, std::unique_ptr<DeviceContext>>
+      stream_contexts_;
   DISABLE_COPY_AND_ASSIGN(DeviceContextPool);
 };
 
+/*! \brief  Make DeviceContextPool::Get return ctx for the place of ctx on
+ *  the current thread while it is alive, so that the kernels run in its
+ *  scope use ctx, e.g. a context of the stream pool. The plain memory
+ *  allocations of the place are also ordered on the stream of ctx. */
+class ScopedDeviceContextOverride {
+ public:
+  explicit ScopedDeviceContextOverride(DeviceContext* ctx);
+  ~ScopedDeviceContextOverride();
+
+ private:
+  DeviceContext* prev_;
+  DISABLE_COPY_AND_ASSIGN(ScopedDeviceContextOverride);
+};
+
 }  // namespace platform
 }  // namespace paddle
@@ -15,9 +15,12 @@ limitations under the License. */
 
 #include <vector>
 
+#include "gflags/gflags.h"
 #include "glog/logging.h"
 #include "gtest/gtest.h"
 
+DECLARE_bool(cudnn_share_workspace);
+
 TEST(Device, Init) {
   using paddle::platform::DeviceContext;
   using paddle::platform::CUDADeviceContext;
@@ -69,3 +72,32 @@ TEST(Device, DeviceContextPool) {
     ASSERT_NE(dev_ctx, nullptr);
   }
 }
+
+TEST(Device, CudnnWorkspacePool) {
+  using paddle::platform::CUDADeviceContext;
+  using paddle::platform::CUDAPlace;
+
+  CUDADeviceContext ctx0(CUDAPlace(0));
+  CUDADeviceContext ctx1(CUDAPlace(0));
+  void* workspace0 = nullptr;
+  void* workspace1 = nullptr;
+  {
+    auto handle0 = ctx0.cudnn_workspace_handle();
+    auto handle1 = ctx1.cudnn_workspace_handle();
+    handle0.RunFunc([&](void* w) { workspace0 = w; }, 1 << 20);
+    // The workspace lent to ctx0 is not shared at the same time.
+    handle1.RunFunc([&](void* w) { workspace1 = w; }, 1 << 10);
+  }
+  ASSERT_NE(workspace0, nullptr);
+  ASSERT_NE(workspace1, nullptr);
+  if (FLAGS_cudnn_share_workspace) {
+    EXPECT_NE(workspace0, workspace1);
+    // Both requests later fit in the returned workspaces.
+    void* reused = nullptr;
+    ctx1.cudnn_workspace_handle().RunFunc([&](void* w) { reused = w; },
+                                          1 << 20);
+    EXPECT_EQ(reused, workspace0);
+  }
+  ctx0.Wait();
+  ctx1.Wait();
+}
@@ -13,11 +13,15 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 #include "paddle/fluid/platform/device_tracer.h"
 
+#include <unistd.h>
 #include <deque>
 #include <fstream>
+#include <iomanip>
 #include <map>
 #include <mutex>  // NOLINT
 #include <numeric>
+#include <set>
+#include <sstream>
 #include <string>
 #include <thread>  // NOLINT
 #include <vector>
@@ -25,6 +29,7 @@ limitations under the License. */
 #include "glog/logging.h"
 #include "google/protobuf/text_format.h"
 #include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/string/printf.h"
 
 namespace paddle {
@@ -37,6 +42,90 @@ thread_local std::deque<std::string> annotation_stack;
 
 std::once_flag tracer_once_flag;
 DeviceTracer *tracer = nullptr;
+
+std::string JsonEscape(const std::string &str) {
+  std::ostringstream os;
+  for (char c : str) {
+    switch (c) {
+      case '"':
+        os << "\\\"";
+        break;
+      case '\\':
+        os << "\\\\";
+        break;
+      case '\n':
+        os << "\\n";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          os << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+             << static_cast<int>(c) << std::dec;
+        } else {
+          os << c;
+        }
+    }
+  }
+  return os.str();
+}
+
+// The Chrome trace events of a process, the timestamps are in us.
+class ChromeTraceWriter {
+ public:
+  explicit ChromeTraceWriter(std::ostream *os) : os_(os), first_(true) {
+    *os_ << "{\"traceEvents\": [\n";
+  }
+
+  ~ChromeTraceWriter() { *os_ << "\n],\n\"displayTimeUnit\": \"ns\"}\n"; }
+
+  void Complete(const std::string &cat, const std::string &name, int64_t pid,
+                int64_t tid, uint64_t start_ns, uint64_t end_ns) {
+    Begin();
+    *os_ << "{\"ph\": \"X\", \"cat\": \"" << cat << "\", \"name\": \""
+         << JsonEscape(name) << "\", \"pid\": " << pid
+         << ", \"tid\": " << tid << ", \"ts\": " << Us(start_ns)
+         << ", \"dur\": " << Us(end_ns > start_ns ? end_ns - start_ns : 0)
+         << "}";
+  }
+
+  // The flow from the slice enclosing start_ns to the one enclosing end_ns.
+  void Flow(bool is_start, uint64_t id, int64_t pid, int64_t tid,
+            uint64_t ts_ns) {
+    Begin();
+    *os_ << "{\"ph\": \"" << (is_start ? "s" : "f") << "\", "
+         << (is_start ? "" : "\"bp\": \"e\", ")
+         << "\"cat\": \"rpc\", \"name\": \"rpc\", \"id\": \"0x" << std::hex
+         << id << std::dec << "\", \"pid\": " << pid << ", \"tid\": " << tid
+         << ", \"ts\": " << Us(ts_ns) << "}";
+  }
+
+  void ProcessName(int64_t pid, const std::string &name) {
+    Begin();
+    *os_ << "{\"ph\": \"M\", \"name\": \"process_name\", \"pid\": " << pid
+         << ", \"args\": {\"name\": \"" << JsonEscape(name) << "\"}}";
+  }
+
+  void ThreadName(int64_t pid, int64_t tid, const std::string &name) {
+    Begin();
+    *os_ << "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": " << pid
+         << ", \"tid\": " << tid << ", \"args\": {\"name\": \""
+         << JsonEscape(name) << "\"}}";
+  }
+
+ private:
+  void Begin() {
+    if (!first_) *os_ << ",\n";
+    first_ = false;
+  }
+
+  static std::string Us(uint64_t ns) {
+    std::ostringstream os;
+    os << ns / 1000 << "." << std::setw(3) << std::setfill('0') << ns % 1000;
+    return os.str();
+  }
+
+  std::ostream *os_;
+  bool first_;
+};
 }  // namespace
 #ifdef PADDLE_WITH_CUPTI
 
@@ -211,6 +300,14 @@ class DeviceTracerImpl : public DeviceTracer {
         CPURecord{anno, start_ns, end_ns, device_id, thread_id});
   }
 
+  void AddRPCRecords(const std::string &name, const std::string &peer,
+                     uint64_t start_ns, uint64_t end_ns, uint64_t flow_id,
+                     bool is_client) {
+    std::lock_guard<std::mutex> l(trace_mu_);
+    rpc_records_.push_back(
+        RPCRecord{name, peer, start_ns, end_ns, flow_id, is_client});
+  }
+
   void AddMemRecords(const std::string &name, uint64_t start_ns,
                      uint64_t end_ns, int64_t device_id, int64_t stream_id,
                      uint32_t correlation_id, uint64_t bytes) {
@@ -317,6 +414,77 @@ class DeviceTracerImpl : public DeviceTracer {
     return profile_pb;
   }
 
+  void GenChromeTrace(const std::string &trace_path) {
+    std::lock_guard<std::mutex> l(trace_mu_);
+    std::ofstream fout(trace_path, std::ios::out | std::ios::trunc);
+    PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open %s to write",
+                   trace_path);
+    // The pids are unique among the processes, so that the traces of the
+    // trainers and the pservers could be merged: the CPU lanes are in
+    // pid * 100, the lanes of GPU i in pid * 100 + 1 + i, and the RPC lanes
+    // in pid * 100 + 99.
+    const int64_t cpu_pid = static_cast<int64_t>(getpid()) * 100;
+    const int64_t rpc_pid = cpu_pid + 99;
+    auto gpu_pid = [cpu_pid](int64_t device_id) {
+      return cpu_pid + 1 + device_id;
+    };
+    std::string pid_str = std::to_string(getpid());
+    {
+      ChromeTraceWriter writer(&fout);
+      writer.ProcessName(cpu_pid, "CPU (" + pid_str + ")");
+      std::map<int64_t, std::set<int64_t>> gpu_streams;
+      for (const KernelRecord &r : kernel_records_) {
+        auto it = correlations_.find(r.correlation_id);
+        if (it == correlations_.end()) continue;
+        writer.Complete("kernel", it->second, gpu_pid(r.device_id),
+                        r.stream_id, r.start_ns, r.end_ns);
+        gpu_streams[r.device_id].insert(r.stream_id);
+      }
+      for (const MemRecord &r : mem_records_) {
+        writer.Complete("memcpy", r.name, gpu_pid(r.device_id), r.stream_id,
+                        r.start_ns, r.end_ns);
+        gpu_streams[r.device_id].insert(r.stream_id);
+      }
+      for (auto &device : gpu_streams) {
+        writer.ProcessName(gpu_pid(device.first),
+                           string::Sprintf("GPU %d (%s)", device.first,
+                                           pid_str));
+        for (int64_t stream : device.second) {
+          writer.ThreadName(gpu_pid(device.first), stream,
+                            string::Sprintf("stream %d", stream));
+        }
+      }
+
+      std::set<int64_t> threads;
+      for (const CPURecord &r : cpu_records_) {
+        writer.Complete("cpu", r.name, cpu_pid, r.thread_id, r.start_ns,
+                        r.end_ns);
+        threads.insert(r.thread_id);
+      }
+      for (int64_t thread : threads) {
+        writer.ThreadName(cpu_pid, thread,
+                          string::Sprintf("thread %d", thread));
+      }
+
+      std::map<std::string, int64_t> peers;
+      for (const RPCRecord &r : rpc_records_) {
+        auto peer = peers.emplace(r.peer, static_cast<int64_t>(peers.size()));
+        int64_t tid = peer.first->second;
+        if (peer.second) {
+          writer.ThreadName(rpc_pid, tid, r.peer);
+        }
+        writer.Complete("rpc", r.name, rpc_pid, tid, r.start_ns, r.end_ns);
+        if (r.flow_id != 0) {
+          writer.Flow(r.is_client, r.flow_id, rpc_pid, tid, r.start_ns);
+        }
+      }
+      if (!rpc_records_.empty()) {
+        writer.ProcessName(rpc_pid, "RPC (" + pid_str + ")");
+      }
+    }
+    fout.close();
+  }
+
   void Disable() {
 #ifdef PADDLE_WITH_CUPTI
     // flush might cause additional calls to DeviceTracker.
@@ -359,6 +527,7 @@ class DeviceTracerImpl : public DeviceTracer {
   std::vector<KernelRecord> kernel_records_;
   std::vector<MemRecord> mem_records_;
   std::vector<CPURecord> cpu_records_;
+  std::vector<RPCRecord> rpc_records_;
   std::unordered_map<uint32_t, std::string> correlations_;
 };
 
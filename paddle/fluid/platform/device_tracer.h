@@ -45,7 +45,7 @@ inline uint64_t PosixInNsec() { return static_cast<uint64_t>(0); }
 // DeviceTracer performs the following tasks:
 // 1. Register cuda callbacks for various events: kernel, memcpy, etc.
 // 2. Collect cuda statistics: start/end ts, memory, etc.
-// 3. Generate a protobuf for further analysis.
+// 3. Generate a protobuf for further analysis, or a Chrome trace.
 class DeviceTracer {
  public:
   struct KernelRecord {
@@ -71,6 +71,17 @@ class DeviceTracer {
     uint32_t correlation_id;
     uint64_t bytes;
   };
+  // The RPCs with the same flow_id are the two ends of a call, possibly in
+  // two processes, which are linked by a flow arrow in the Chrome trace.
+  struct RPCRecord {
+    std::string name;
+    // The endpoint of the other end.
+    std::string peer;
+    uint64_t start_ns;
+    uint64_t end_ns;
+    uint64_t flow_id;
+    bool is_client;
+  };
 
   virtual ~DeviceTracer() {}
   // Needs to be called once before use.
@@ -92,6 +103,10 @@ class DeviceTracer {
                              uint64_t end_ns, int64_t device_id,
                              int64_t thread_id) = 0;
 
+  virtual void AddRPCRecords(const std::string& name, const std::string& peer,
+                             uint64_t start_ns, uint64_t end_ns,
+                             uint64_t flow_id, bool is_client) = 0;
+
   // Add a cuda kernel stats. `correlation_id` will be mapped to annotation
   // added before for human readability.
   virtual void AddKernelRecords(uint64_t start, uint64_t end, int64_t device_id,
@@ -100,6 +115,11 @@ class DeviceTracer {
   // Generate a proto after done (Disabled).
   virtual proto::Profile GenProfile(const std::string& profile_path) = 0;
 
+  // Generate a Chrome trace JSON after done (Disabled), with a lane for
+  // every CPU thread, every CUDA stream and every RPC peer. The traces of
+  // the processes are merged by concatenating their "traceEvents".
+  virtual void GenChromeTrace(const std::string& trace_path) = 0;
+
   virtual bool IsEnabled() = 0;
 };
 
@@ -140,11 +140,14 @@ CUDNN_DNN_ROUTINE_EACH_AFTER_R4(DECLARE_DYNAMIC_LOAD_CUDNN_WRAP)
 
 // APIs in R5
 #if CUDNN_VERSION >= 5000
-#define CUDNN_DNN_ROUTINE_EACH_R5(__macro)  \
-  __macro(cudnnCreateActivationDescriptor); \
-  __macro(cudnnSetActivationDescriptor);    \
-  __macro(cudnnGetActivationDescriptor);    \
-  __macro(cudnnDestroyActivationDescriptor);
+#define CUDNN_DNN_ROUTINE_EACH_R5(__macro)                \
+  __macro(cudnnCreateActivationDescriptor);               \
+  __macro(cudnnSetActivationDescriptor);                  \
+  __macro(cudnnGetActivationDescriptor);                  \
+  __macro(cudnnDestroyActivationDescriptor);              \
+  __macro(cudnnFindConvolutionForwardAlgorithmEx);        \
+  __macro(cudnnFindConvolutionBackwardDataAlgorithmEx);   \
+  __macro(cudnnFindConvolutionBackwardFilterAlgorithmEx);
 CUDNN_DNN_ROUTINE_EACH_R5(DECLARE_DYNAMIC_LOAD_CUDNN_WRAP)
 #endif
 
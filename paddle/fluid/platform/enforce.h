@@ -248,6 +248,33 @@ inline void throw_on_error(T e) {
   throw_on_error(e, "");
 }
 
+// Whether the condition of PADDLE_ENFORCE fails, the message is only built
+// and thrown by throw_on_error when it does.
+template <typename T>
+inline bool is_error(const T& stat) {
+  return !stat;
+}
+
+#ifdef PADDLE_WITH_CUDA
+inline bool is_error(cudaError_t e) { return e != cudaSuccess; }
+
+inline bool is_error(curandStatus_t stat) {
+  return stat != CURAND_STATUS_SUCCESS;
+}
+
+inline bool is_error(cudnnStatus_t stat) {
+  return stat != CUDNN_STATUS_SUCCESS;
+}
+
+inline bool is_error(cublasStatus_t stat) {
+  return stat != CUBLAS_STATUS_SUCCESS;
+}
+
+#if !defined(__APPLE__) && !defined(_WIN32)
+inline bool is_error(ncclResult_t stat) { return stat != ncclSuccess; }
+#endif  // __APPLE__ and windows
+#endif  // PADDLE_WITH_CUDA
+
 #if !defined(_WIN32)
 #define PADDLE_THROW(...)                                              \
   do {                                                                 \
@@ -257,21 +284,46 @@ inline void throw_on_error(T e) {
         __FILE__, __LINE__);                                           \
   } while (false)
 
+// PADDLE_ENFORCE passes all its arguments to Enforce, so that the commas of
+// the template arguments in the condition are not split by the preprocessor.
+// The condition is evaluated once, and the message is only formatted and
+// thrown on the unlikely failure. The message arguments are still evaluated
+// on every call, the preprocessor cannot separate them from the condition.
+// Only the PADDLE_ENFORCE_EQ/NE/GT/GE/LT/LE family evaluates them on failure.
+// EnforceFailed is kept out of line and cold, away from the hot code.
 #ifndef REPLACE_ENFORCE_GLOG
-#define PADDLE_ENFORCE(...)                                             \
-  do {                                                                  \
-    try {                                                               \
-      ::paddle::platform::throw_on_error(__VA_ARGS__);                  \
-    } catch (...) {                                                     \
-      throw ::paddle::platform::EnforceNotMet(std::current_exception(), \
-                                              __FILE__, __LINE__);      \
-    }                                                                   \
-  } while (false)
-
+template <typename T, typename... Args>
+__attribute__((noinline, cold)) void EnforceFailed(const char* file, int line,
+                                                   const T& cond,
+                                                   const Args&... args) {
+  try {
+    throw_on_error(cond, args...);
+  } catch (...) {
+    throw EnforceNotMet(std::current_exception(), file, line);
+  }
+}
 #else
-#define PADDLE_ENFORCE(...) ::paddle::platform::throw_on_error(__VA_ARGS__);
+template <typename T, typename... Args>
+__attribute__((noinline, cold)) void EnforceFailed(const char* file, int line,
+                                                   const T& cond,
+                                                   const Args&... args) {
+  throw_on_error(cond, args...);
+}
 #endif  // REPLACE_ENFORCE_GLOG
 
+template <typename T, typename... Args>
+inline void Enforce(const char* file, int line, const T& cond,
+                    const Args&... args) {
+  if (UNLIKELY(is_error(cond))) {
+    EnforceFailed(file, line, cond, args...);
+  }
+}
+
+#define PADDLE_ENFORCE(...)                                       \
+  do {                                                            \
+    ::paddle::platform::Enforce(__FILE__, __LINE__, __VA_ARGS__); \
+  } while (false)
+
 #else  // !_WIN32
 // disable enforce, caused by the varardic macro exception error
 #define PADDLE_THROW(x)                                      \
@@ -12,6 +12,9 @@ limitations under the License. */
 #include <array>
 #include <iostream>
 #include <memory>
+#include <ostream>
+#include <string>
+#include <type_traits>
 
 #include "gtest/gtest.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -39,6 +42,53 @@ TEST(ENFORCE, FAILED) {
   EXPECT_TRUE(caught_exception);
 }
 
+// Counts its formatting into the message of PADDLE_ENFORCE.
+struct FormatCounter {
+  int* num_formatted;
+};
+
+std::ostream& operator<<(std::ostream& os, const FormatCounter& counter) {
+  ++*counter.num_formatted;
+  return os << "message";
+}
+
+TEST(ENFORCE, LAZY_MESSAGE) {
+  int num_formatted = 0;
+  FormatCounter message{&num_formatted};
+  int num_evaluated = 0;
+  auto cond = [&num_evaluated](bool ret) {
+    ++num_evaluated;
+    return ret;
+  };
+  PADDLE_ENFORCE(cond(true), "Enforce is ok %s", message);
+  EXPECT_EQ(num_evaluated, 1);
+  EXPECT_EQ(num_formatted, 0);
+
+  bool caught_exception = false;
+  try {
+    PADDLE_ENFORCE(cond(false), "Enforce is not ok %s", message);
+  } catch (paddle::platform::EnforceNotMet error) {
+    caught_exception = true;
+    EXPECT_TRUE(HasPrefix(StringPiece(error.what()), "Enforce is not ok"));
+  }
+  EXPECT_TRUE(caught_exception);
+  EXPECT_EQ(num_evaluated, 2);
+  EXPECT_EQ(num_formatted, 1);
+}
+
+TEST(ENFORCE, TEMPLATE_CONDITION) {
+  PADDLE_ENFORCE(std::is_same<int, int>::value, "Enforce is ok");
+  bool caught_exception = false;
+  try {
+    PADDLE_ENFORCE(std::is_same<int, float>::value, "Enforce is not ok %d",
+                   123);
+  } catch (paddle::platform::EnforceNotMet error) {
+    caught_exception = true;
+    EXPECT_TRUE(HasPrefix(StringPiece(error.what()), "Enforce is not ok 123"));
+  }
+  EXPECT_TRUE(caught_exception);
+}
+
 TEST(ENFORCE, NO_ARG_OK) {
   int a = 2;
   int b = 2;
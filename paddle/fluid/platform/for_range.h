@@ -26,17 +26,36 @@ struct ForRange {
   void operator()(Function func) const;
 };
 
+// Call fn(begin, end) on the chunks of [0, n), which are run by the intra-op
+// thread pool on CPU, see CPUDeviceContext::ParallelFor. The other devices
+// call fn(0, n) once.
+template <typename DeviceContext, typename Function>
+inline void ParallelFor(const DeviceContext& dev_ctx, int64_t n, Function fn,
+                        int64_t elements_per_item = 1) {
+  fn(0, n);
+}
+
+template <typename Function>
+inline void ParallelFor(const CPUDeviceContext& dev_ctx, int64_t n,
+                        Function fn, int64_t elements_per_item = 1) {
+  dev_ctx.ParallelFor(n, fn, elements_per_item);
+}
+
 template <>
 struct ForRange<CPUDeviceContext> {
-  ForRange(const CPUDeviceContext& dev_ctx, size_t limit) : limit_(limit) {}
+  ForRange(const CPUDeviceContext& dev_ctx, size_t limit)
+      : dev_ctx_(dev_ctx), limit_(limit) {}
 
   template <typename Function>
   void operator()(Function func) const {
-    for (size_t i = 0; i < limit_; ++i) {
-      func(i);
-    }
+    dev_ctx_.ParallelFor(limit_, [&func](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        func(static_cast<size_t>(i));
+      }
+    });
   }
 
+  const CPUDeviceContext& dev_ctx_;
   size_t limit_;
 };
 
@@ -62,6 +81,7 @@ struct ForRange<CUDADeviceContext> {
 
   template <typename Function>
   inline void operator()(Function func) const {
+    if (limit_ == 0) return;
     constexpr int num_threads = 1024;
     int block_size = limit_ <= num_threads ? limit_ : num_threads;
     int grid_size = (limit_ + num_threads - 1) / num_threads;
@@ -0,0 +1,224 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/intra_op_thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <utility>
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/fluid/platform/cpu_helper.h"
+#include "paddle/fluid/platform/cpu_info.h"
+
+DEFINE_int32(cpu_intra_op_num_threads, 1,
+             "The threads of the pool that splits the big CPU elementwise, "
+             "reduce and activation kernels, including the thread running "
+             "the kernel. 1 to run the kernels serially.");
+DEFINE_int64(cpu_intra_op_grain_size, 32768,
+             "The minimum elements of a chunk that a CPU kernel is split "
+             "into, the smaller kernels run serially.");
+DEFINE_int32(cpu_runtime_num_threads, 0,
+             "The threads of the unified CPU runtime, 0 to use the physical "
+             "cores the process may run on, at least 3.");
+DEFINE_int32(cpu_runtime_max_io_tasks, 0,
+             "The IO tasks the unified CPU runtime runs at the same time, 0 "
+             "to use a quarter of its threads, at least 1.");
+DECLARE_bool(cpu_unified_runtime);
+
+namespace paddle {
+namespace platform {
+
+namespace {
+// Whether the thread is running a chunk of a ParallelFor.
+thread_local bool in_parallel_for = false;
+}  // namespace
+
+struct IntraOpThreadPool::Job {
+  const std::function<void(int64_t, int64_t)>* fn;
+  int64_t n;
+  int64_t chunk_size;
+  int64_t num_chunks;
+  std::atomic<int64_t> next_chunk{0};
+  std::atomic<int64_t> num_done{0};
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::exception_ptr error;
+};
+
+IntraOpThreadPool::IntraOpThreadPool(int num_threads)
+    : num_threads_(std::max(num_threads, 1)) {
+  int num_workers = std::max(num_threads_ - 1, 1);
+  max_running_tasks_[static_cast<int>(TaskPriority::kRPC)] = num_workers;
+  max_running_tasks_[static_cast<int>(TaskPriority::kCompute)] =
+      std::max(num_workers - 1, 1);
+  max_running_tasks_[static_cast<int>(TaskPriority::kIO)] =
+      FLAGS_cpu_runtime_max_io_tasks > 0
+          ? std::min(FLAGS_cpu_runtime_max_io_tasks, num_workers)
+          : std::max(num_workers / 4, 1);
+  for (int i = 1; i < num_threads_; ++i) {
+    workers_.emplace_back([this] { WorkerLoop(); });
+  }
+}
+
+IntraOpThreadPool::~IntraOpThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+IntraOpThreadPool* IntraOpThreadPool::GetInstance() {
+  static IntraOpThreadPool* pool = [] {
+    if (!FLAGS_cpu_unified_runtime) {
+      return new IntraOpThreadPool(FLAGS_cpu_intra_op_num_threads);
+    }
+    int num_threads = FLAGS_cpu_runtime_num_threads > 0
+                          ? FLAGS_cpu_runtime_num_threads
+                          : CpuPhysicalCoreCount();
+    num_threads = std::max(num_threads, 3);
+    VLOG(1) << "The unified CPU runtime has " << num_threads << " threads";
+    return new IntraOpThreadPool(num_threads);
+  }();
+  return pool;
+}
+
+void IntraOpThreadPool::Schedule(std::function<void()> fn,
+                                 TaskPriority priority) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // The pool of one thread starts its worker for the first task.
+    if (workers_.empty()) {
+      workers_.emplace_back([this] { WorkerLoop(); });
+    }
+    tasks_[static_cast<int>(priority)].push_back(std::move(fn));
+  }
+  cv_.notify_one();
+}
+
+bool IntraOpThreadPool::HasRunnableTask() const {
+  for (int i = 0; i < 3; ++i) {
+    if (!tasks_[i].empty() && running_tasks_[i] < max_running_tasks_[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void IntraOpThreadPool::ParallelFor(
+    int64_t n, int64_t grain_size,
+    const std::function<void(int64_t, int64_t)>& fn) {
+  if (n <= 0) return;
+  int64_t num_chunks = std::min<int64_t>(
+      num_threads_, std::max<int64_t>(n / std::max<int64_t>(grain_size, 1), 1));
+  if (num_chunks == 1 || in_parallel_for) {
+    fn(0, n);
+    return;
+  }
+
+  auto job = std::make_shared<Job>();
+  job->fn = &fn;
+  job->n = n;
+  job->chunk_size = (n + num_chunks - 1) / num_chunks;
+  job->num_chunks = (n + job->chunk_size - 1) / job->chunk_size;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int64_t i = 1; i < job->num_chunks; ++i) {
+      jobs_.push_back(job);
+    }
+  }
+  for (int64_t i = 1; i < job->num_chunks; ++i) {
+    cv_.notify_one();
+  }
+
+  RunChunks(job.get());
+  std::unique_lock<std::mutex> lock(job->mutex);
+  job->cv.wait(lock, [&] { return job->num_done == job->num_chunks; });
+  if (job->error) {
+    std::rethrow_exception(job->error);
+  }
+}
+
+void IntraOpThreadPool::RunChunks(Job* job) {
+  in_parallel_for = true;
+  while (true) {
+    int64_t chunk = job->next_chunk++;
+    if (chunk >= job->num_chunks) break;
+    int64_t begin = chunk * job->chunk_size;
+    int64_t end = std::min(job->n, begin + job->chunk_size);
+    try {
+      (*job->fn)(begin, end);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(job->mutex);
+      if (!job->error) job->error = std::current_exception();
+    }
+    if (++job->num_done == job->num_chunks) {
+      std::lock_guard<std::mutex> lock(job->mutex);
+      job->cv.notify_all();
+    }
+  }
+  in_parallel_for = false;
+}
+
+void IntraOpThreadPool::WorkerLoop() {
+  // The math libraries do not start their own threads on the workers.
+  if (FLAGS_cpu_unified_runtime) SetNumThreads(1);
+  while (true) {
+    std::shared_ptr<Job> job;
+    std::function<void()> task;
+    int priority = 0;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock,
+               [this] { return stop_ || !jobs_.empty() || HasRunnableTask(); });
+      if (stop_) return;
+      if (!jobs_.empty()) {
+        job = std::move(jobs_.front());
+        jobs_.pop_front();
+      } else {
+        for (; priority < 3; ++priority) {
+          if (!tasks_[priority].empty() &&
+              running_tasks_[priority] < max_running_tasks_[priority]) {
+            break;
+          }
+        }
+        task = std::move(tasks_[priority].front());
+        tasks_[priority].pop_front();
+        ++running_tasks_[priority];
+      }
+    }
+    if (job) {
+      RunChunks(job.get());
+      continue;
+    }
+    task();
+    task = nullptr;
+    bool held_back;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --running_tasks_[priority];
+      held_back = !tasks_[priority].empty();
+    }
+    // A task held back by the limit of its priority may run now.
+    if (held_back) cv_.notify_all();
+  }
+}
+
+}  // namespace platform
+}  // namespace paddle
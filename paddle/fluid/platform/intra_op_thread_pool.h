@@ -0,0 +1,97 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace paddle {
+namespace platform {
+
+// The priorities of the tasks scheduled on the pool, a free worker runs the
+// chunks of the ParallelFor first, then the tasks in this order.
+enum class TaskPriority {
+  // The short RPC tasks sending and receiving the variables, which the
+  // distributed ops wait for.
+  kRPC = 0,
+  // The inter-op tasks, e.g. the ops run by the parallel executor.
+  kCompute = 1,
+  // The file IO tasks, at most FLAGS_cpu_runtime_max_io_tasks of which run
+  // at the same time.
+  kIO = 2,
+};
+
+/*
+ * The threads splitting the loops of one CPU kernel, e.g. a big elementwise
+ * op. A ParallelFor runs the chunks of a range on the calling thread and the
+ * workers, and returns after all of them finish. It may be called by several
+ * threads at the same time. The ParallelFor called inside a chunk runs
+ * serially, so the nested loops do not wait for each other.
+ *
+ * With FLAGS_cpu_unified_runtime the pool is also the CPU runtime of the
+ * process, framework::ThreadPool schedules its tasks here, so the inter-op
+ * tasks, their intra-op loops and the IO share one set of workers. The compute
+ * tasks leave a worker free, so the RPC tasks and the loops they wait for are
+ * never starved by the blocked compute tasks.
+ */
+class IntraOpThreadPool {
+ public:
+  explicit IntraOpThreadPool(int num_threads);
+  ~IntraOpThreadPool();
+
+  // The pool of FLAGS_cpu_intra_op_num_threads threads. With
+  // FLAGS_cpu_unified_runtime it has FLAGS_cpu_runtime_num_threads threads,
+  // the physical cores by default.
+  static IntraOpThreadPool* GetInstance();
+
+  int num_threads() const { return num_threads_; }
+
+  // Run fn on a worker, fn should not throw. The pool of one thread starts a
+  // worker to run the tasks, which is not used by the ParallelFor.
+  void Schedule(std::function<void()> fn,
+                TaskPriority priority = TaskPriority::kCompute);
+
+  // Call fn(begin, end) on the chunks of [0, n), each of which has at least
+  // grain_size elements, unless n is smaller. The first exception thrown by
+  // fn is rethrown after all the chunks finish.
+  void ParallelFor(int64_t n, int64_t grain_size,
+                   const std::function<void(int64_t, int64_t)>& fn);
+
+ private:
+  struct Job;
+  void WorkerLoop();
+  static void RunChunks(Job* job);
+  // Whether a task may run now, called with mutex_ held.
+  bool HasRunnableTask() const;
+
+  int num_threads_;
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::shared_ptr<Job>> jobs_;
+  std::deque<std::function<void()>> tasks_[3];
+  int running_tasks_[3] = {0, 0, 0};
+  int max_running_tasks_[3];
+  bool stop_{false};
+};
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,135 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/intra_op_thread_pool.h"
+#include <atomic>
+#include <future>  // NOLINT
+#include <memory>
+#include <stdexcept>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace platform {
+
+TEST(IntraOpThreadPool, ParallelFor) {
+  IntraOpThreadPool pool(4);
+  for (int64_t n : {0, 1, 100, 1000, 4097}) {
+    std::vector<int> visited(n, 0);
+    std::atomic<int> num_chunks{0};
+    pool.ParallelFor(n, 256, [&](int64_t begin, int64_t end) {
+      ++num_chunks;
+      EXPECT_TRUE(end - begin >= 256 || end - begin == n);
+      for (int64_t i = begin; i < end; ++i) {
+        ++visited[i];
+      }
+    });
+    for (int64_t i = 0; i < n; ++i) {
+      EXPECT_EQ(visited[i], 1);
+    }
+    EXPECT_LE(num_chunks, 4);
+  }
+}
+
+TEST(IntraOpThreadPool, NestedAndConcurrent) {
+  IntraOpThreadPool pool(3);
+  const int64_t n = 3000;
+  std::vector<std::thread> threads;
+  std::vector<int64_t> sums(4, 0);
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      std::atomic<int64_t> sum{0};
+      pool.ParallelFor(n, 100, [&](int64_t begin, int64_t end) {
+        // The nested loop runs serially on this thread.
+        auto tid = std::this_thread::get_id();
+        pool.ParallelFor(end - begin, 1, [&](int64_t b, int64_t e) {
+          EXPECT_EQ(std::this_thread::get_id(), tid);
+          EXPECT_EQ(b, 0);
+          EXPECT_EQ(e, end - begin);
+          for (int64_t i = begin + b; i < begin + e; ++i) sum += i;
+        });
+      });
+      sums[t] = sum;
+    });
+  }
+  for (auto& t : threads) t.join();
+  for (auto sum : sums) {
+    EXPECT_EQ(sum, n * (n - 1) / 2);
+  }
+}
+
+TEST(IntraOpThreadPool, Exception) {
+  IntraOpThreadPool pool(2);
+  auto fn = [](int64_t begin, int64_t end) {
+    if (begin == 0) throw std::runtime_error("the first chunk fails");
+  };
+  EXPECT_THROW(pool.ParallelFor(1000, 10, fn), std::runtime_error);
+}
+
+TEST(IntraOpThreadPool, Schedule) {
+  // The pool of one thread starts a worker for the tasks.
+  for (int num_threads : {1, 4}) {
+    IntraOpThreadPool pool(num_threads);
+    std::atomic<int> sum{0};
+    std::vector<std::future<void>> futures;
+    for (auto priority :
+         {TaskPriority::kRPC, TaskPriority::kCompute, TaskPriority::kIO}) {
+      for (int i = 0; i < 10; ++i) {
+        auto done = std::make_shared<std::promise<void>>();
+        futures.push_back(done->get_future());
+        pool.Schedule([&sum, done] {
+          ++sum;
+          done->set_value();
+        }, priority);
+      }
+    }
+    for (auto& f : futures) f.wait();
+    EXPECT_EQ(sum, 30);
+  }
+}
+
+TEST(IntraOpThreadPool, ComputeTasksLeaveAWorker) {
+  IntraOpThreadPool pool(4);
+  // The compute tasks waiting for an RPC task take at most 2 of 3 workers.
+  std::promise<void> rpc_done;
+  std::shared_future<void> rpc_future(rpc_done.get_future());
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < 4; ++i) {
+    auto done = std::make_shared<std::promise<void>>();
+    futures.push_back(done->get_future());
+    pool.Schedule([rpc_future, done] {
+      rpc_future.wait();
+      done->set_value();
+    });
+  }
+  pool.Schedule([&rpc_done] { rpc_done.set_value(); }, TaskPriority::kRPC);
+  for (auto& f : futures) f.wait();
+}
+
+TEST(IntraOpThreadPool, ParallelForInTask) {
+  IntraOpThreadPool pool(4);
+  std::promise<int64_t> result;
+  pool.Schedule([&] {
+    std::atomic<int64_t> sum{0};
+    pool.ParallelFor(1000, 10, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) sum += i;
+    });
+    result.set_value(sum);
+  });
+  EXPECT_EQ(result.get_future().get(), 999 * 1000 / 2);
+}
+
+}  // namespace platform
+}  // namespace paddle
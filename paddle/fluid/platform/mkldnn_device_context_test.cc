@@ -0,0 +1,70 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+#include "paddle/fluid/platform/device_context.h"
+
+DECLARE_int32(mkldnn_cache_capacity);
+
+namespace paddle {
+namespace platform {
+
+TEST(KeyBlob, EvictLeastRecentlyUsedGroup) {
+  KeyBlob blob;
+  auto data = std::make_shared<int>(1);
+  blob.Set("a@p", data, 2);
+  blob.Set("a@pd", data, 2);
+  blob.Set("b@p", data, 2);
+  EXPECT_EQ(blob.num_groups(), 2UL);
+
+  // a is used more recently than b.
+  EXPECT_EQ(blob.Get("a@p"), data);
+  blob.Set("c@p", data, 2);
+  EXPECT_EQ(blob.num_groups(), 2UL);
+  EXPECT_EQ(blob.Get("b@p"), nullptr);
+  // The blobs of a group are evicted together.
+  EXPECT_EQ(blob.Get("a@p"), data);
+  EXPECT_EQ(blob.Get("a@pd"), data);
+  EXPECT_EQ(blob.Get("c@p"), data);
+  EXPECT_EQ(blob.Get("a@mem"), nullptr);
+
+  // No limit with the capacity 0.
+  for (int i = 0; i < 10; ++i) {
+    blob.Set(std::to_string(i) + "@p", data, 0);
+  }
+  EXPECT_EQ(blob.num_groups(), 12UL);
+}
+
+TEST(MKLDNNDeviceContext, BlobsOfThreads) {
+  FLAGS_mkldnn_cache_capacity = 1;
+  MKLDNNDeviceContext ctx(CPUPlace{});
+  auto data = std::make_shared<int>(1);
+  set_cur_thread_id(1);
+  ctx.SetBlob("a@p", data);
+  set_cur_thread_id(2);
+  EXPECT_EQ(ctx.GetBlob("a@p"), nullptr);
+  ctx.SetBlob("b@p", data);
+  // The other threads do not evict the blobs of thread 1.
+  set_cur_thread_id(1);
+  EXPECT_EQ(ctx.GetBlob("a@p"), data);
+  ctx.SetBlob("c@p", data);
+  EXPECT_EQ(ctx.GetBlob("a@p"), nullptr);
+  EXPECT_EQ(ctx.GetNumBlobGroups(), 1UL);
+  set_cur_thread_id(0);
+  FLAGS_mkldnn_cache_capacity = 0;
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -23,6 +23,9 @@
 #include "paddle/fluid/platform/enforce.h"
 
 #define NCCL_ID_VARNAME "NCCLID"
+// The prefix of the ids of the inter-node communicators used by the
+// hierarchical all reduce, one id per local device.
+#define NCCL_INTER_ID_VARNAME_PREFIX "NCCLID_INTER_"
 
 namespace paddle {
 namespace platform {
@@ -64,12 +67,24 @@ class NCCLGroupGuard {
   }
 };
 
+inline std::string InterNCCLIdVarName(size_t local_rank) {
+  return NCCL_INTER_ID_VARNAME_PREFIX + std::to_string(local_rank);
+}
+
 struct NCCLContext {
   std::unique_ptr<CUDADeviceContext> ctx_;
   ncclComm_t comm_;
+  // The communicators of the hierarchical all reduce. The local one covers
+  // the devices of this trainer, the inter one covers the devices of the same
+  // local rank on all the trainers.
+  ncclComm_t local_comm_;
+  ncclComm_t inter_comm_;
 
   explicit NCCLContext(int dev_id)
-      : ctx_(new CUDADeviceContext(CUDAPlace(dev_id))), comm_{nullptr} {}
+      : ctx_(new CUDADeviceContext(CUDAPlace(dev_id))),
+        comm_{nullptr},
+        local_comm_{nullptr},
+        inter_comm_{nullptr} {}
 
   cudaStream_t stream() const { return ctx_->stream(); }
 
@@ -125,6 +140,42 @@ struct NCCLContextMap {
     }
   }
 
+  // Create the communicators of the hierarchical all reduce. inter_ids[i] is
+  // the id shared by the i-th device of every trainer.
+  void InitHierarchicalComms(const std::vector<ncclUniqueId *> &inter_ids,
+                             size_t num_trainers, size_t trainer_id) {
+    PADDLE_ENFORCE_EQ(inter_ids.size(), order_.size(),
+                      "Each local device needs an inter-node NCCL id.");
+    std::unique_ptr<ncclComm_t[]> local_comms(new ncclComm_t[order_.size()]);
+    {
+      std::lock_guard<std::mutex> guard(NCCLGroupGuard::NCCLMutex());
+      PADDLE_ENFORCE(platform::dynload::ncclCommInitAll(
+          local_comms.get(), static_cast<int>(order_.size()), order_.data()));
+    }
+    std::unique_ptr<ncclComm_t[]> inter_comms(new ncclComm_t[order_.size()]);
+    {
+      NCCLGroupGuard guard;
+      for (size_t i = 0; i < order_.size(); ++i) {
+        PADDLE_ENFORCE_NOT_NULL(inter_ids[i]);
+        VLOG(3) << "init inter nccl rank: " << trainer_id
+                << " nranks: " << num_trainers << " local rank: " << i;
+        PADDLE_ENFORCE(cudaSetDevice(order_[i]));
+        PADDLE_ENFORCE(platform::dynload::ncclCommInitRank(
+            inter_comms.get() + i, static_cast<int>(num_trainers),
+            *inter_ids[i], static_cast<int>(trainer_id)));
+      }
+    }
+    for (size_t i = 0; i < order_.size(); ++i) {
+      auto &ctx = contexts_.at(order_[i]);
+      ctx.local_comm_ = local_comms[i];
+      ctx.inter_comm_ = inter_comms[i];
+    }
+  }
+
+  bool HasHierarchicalComms() const {
+    return contexts_.at(order_[0]).inter_comm_ != nullptr;
+  }
+
   NCCLContextMap(const NCCLContextMap &other) = delete;
   NCCLContextMap &operator=(const NCCLContextMap &other) = delete;
 
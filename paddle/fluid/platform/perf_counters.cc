@@ -0,0 +1,125 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/perf_counters.h"
+
+#include <gflags/gflags.h>
+#include <errno.h>
+#include <glog/logging.h>
+#include <string.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+
+DEFINE_bool(profile_perf_counters, false,
+            "Read the hardware counters around the ops in the profiler, "
+            "and report the IPC, cache misses and memory bandwidth of the "
+            "ops. It is only supported on Linux.");
+
+namespace paddle {
+namespace platform {
+
+bool IsPerfCountersEnabled() { return FLAGS_profile_perf_counters; }
+
+#ifdef __linux__
+namespace {
+
+// The counters of a thread, opened as a group on the first read so they are
+// scheduled onto the PMU together.
+class ThreadPerfCounters {
+ public:
+  ThreadPerfCounters() {
+    const uint64_t kConfigs[kNumPerfCounters] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES};
+    for (int i = 0; i < kNumPerfCounters; ++i) {
+      perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.size = sizeof(attr);
+      attr.config = kConfigs[i];
+      attr.disabled = i == 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP;
+      int group_fd = i == 0 ? -1 : fds_[0];
+      fds_[i] = static_cast<int>(
+          syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+      if (fds_[i] < 0) {
+        static std::atomic<bool> warned(false);
+        if (!warned.exchange(true)) {
+          LOG(WARNING) << "Cannot open the hardware counters: "
+                       << strerror(errno)
+                       << ", see /proc/sys/kernel/perf_event_paranoid.";
+        }
+        Close();
+        return;
+      }
+    }
+    ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+
+  ~ThreadPerfCounters() { Close(); }
+
+  bool Available() const { return fds_[0] >= 0; }
+
+  void Read(uint64_t values[kNumPerfCounters]) const {
+    // The number of the counters followed by their values.
+    uint64_t buf[1 + kNumPerfCounters];
+    if (!Available() || read(fds_[0], buf, sizeof(buf)) != sizeof(buf)) {
+      memset(values, 0, sizeof(uint64_t) * kNumPerfCounters);
+      return;
+    }
+    memcpy(values, buf + 1, sizeof(uint64_t) * kNumPerfCounters);
+  }
+
+ private:
+  void Close() {
+    for (int i = 0; i < kNumPerfCounters; ++i) {
+      if (fds_[i] >= 0) close(fds_[i]);
+      fds_[i] = -1;
+    }
+  }
+
+  int fds_[kNumPerfCounters] = {-1, -1, -1};
+};
+
+ThreadPerfCounters& GetThreadPerfCounters() {
+  static thread_local ThreadPerfCounters counters;
+  return counters;
+}
+
+}  // namespace
+
+void ReadPerfCounters(uint64_t values[kNumPerfCounters]) {
+  GetThreadPerfCounters().Read(values);
+}
+
+bool PerfCountersAvailable() { return GetThreadPerfCounters().Available(); }
+#else
+void ReadPerfCounters(uint64_t values[kNumPerfCounters]) {
+  for (int i = 0; i < kNumPerfCounters; ++i) values[i] = 0;
+}
+
+bool PerfCountersAvailable() { return false; }
+#endif
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,50 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace paddle {
+namespace platform {
+
+/*
+ * The hardware performance counters of the calling thread, counted in the
+ * user space by perf_event_open on Linux. They are read around the ops by
+ * the profiler when FLAGS_profile_perf_counters is set, so the profiling
+ * report tells the IPC and the memory traffic of each op, i.e. whether it
+ * is compute- or memory-bound.
+ */
+enum PerfCounter {
+  kPerfCycles,
+  kPerfInstructions,
+  // The last level cache misses, each one reads a cache line from memory.
+  kPerfCacheMisses,
+  kNumPerfCounters,
+};
+
+constexpr int kCacheLineBytes = 64;
+
+bool IsPerfCountersEnabled();
+
+// Read the counters of the calling thread into values, which are 0 if the
+// counters are not available, e.g. not on Linux or not permitted by
+// /proc/sys/kernel/perf_event_paranoid.
+void ReadPerfCounters(uint64_t values[kNumPerfCounters]);
+
+// Whether the counters can be read by the calling thread.
+bool PerfCountersAvailable();
+
+}  // namespace platform
+}  // namespace paddle
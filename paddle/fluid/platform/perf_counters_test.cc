@@ -0,0 +1,50 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/perf_counters.h"
+
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace platform {
+
+TEST(PerfCounters, Read) {
+  uint64_t start[kNumPerfCounters];
+  ReadPerfCounters(start);
+  if (!PerfCountersAvailable()) {
+    for (int i = 0; i < kNumPerfCounters; ++i) {
+      EXPECT_EQ(start[i], 0UL);
+    }
+    LOG(WARNING) << "The hardware counters are not available, skip the test.";
+    return;
+  }
+
+  std::vector<double> data(1 << 20, 1.);
+  double sum = 0.;
+  for (double d : data) sum += d;
+  EXPECT_EQ(sum, static_cast<double>(data.size()));
+
+  uint64_t end[kNumPerfCounters];
+  ReadPerfCounters(end);
+  EXPECT_GT(end[kPerfCycles], start[kPerfCycles]);
+  // The loop runs more than an instruction per element.
+  EXPECT_GT(end[kPerfInstructions] - start[kPerfInstructions], data.size());
+  EXPECT_GE(end[kPerfCacheMisses], start[kPerfCacheMisses]);
+}
+
+}  // namespace platform
+}  // namespace paddle
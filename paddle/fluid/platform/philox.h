@@ -0,0 +1,164 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace platform {
+
+/*
+ * Philox4x32-10, the counter based generator of Salmon et al., "Parallel
+ * Random Numbers: As Easy as 1, 2, 3". The numbers are a function of the
+ * seed and the 128-bit counter, so a thread computes its numbers without
+ * the state of the other threads: the subsequence picks the numbers of an
+ * element, or a group of elements, and the offset skips the numbers used by
+ * the previous launches. Each call returns 4 numbers and moves the offset by
+ * one.
+ */
+class Philox4x32 {
+ public:
+  struct Result {
+    uint32_t x[4];
+  };
+
+  HOSTDEVICE Philox4x32(uint64_t seed, uint64_t subsequence,
+                        uint64_t offset) {
+    key_[0] = static_cast<uint32_t>(seed);
+    key_[1] = static_cast<uint32_t>(seed >> 32);
+    counter_[0] = static_cast<uint32_t>(offset);
+    counter_[1] = static_cast<uint32_t>(offset >> 32);
+    counter_[2] = static_cast<uint32_t>(subsequence);
+    counter_[3] = static_cast<uint32_t>(subsequence >> 32);
+  }
+
+  HOSTDEVICE Result operator()() {
+    Result result = Compute(counter_, key_);
+    if (++counter_[0] == 0) ++counter_[1];
+    return result;
+  }
+
+  HOSTDEVICE static Result Compute(const uint32_t counter[4],
+                                   const uint32_t key[2]) {
+    uint32_t ctr[4] = {counter[0], counter[1], counter[2], counter[3]};
+    uint32_t k[2] = {key[0], key[1]};
+    for (int i = 0; i < kRounds; ++i) {
+      if (i > 0) {
+        k[0] += kWeyl0;
+        k[1] += kWeyl1;
+      }
+      uint32_t hi0, hi1;
+      uint32_t lo0 = MulHiLo(kMul0, ctr[0], &hi0);
+      uint32_t lo1 = MulHiLo(kMul1, ctr[2], &hi1);
+      ctr[0] = hi1 ^ ctr[1] ^ k[0];
+      ctr[1] = lo1;
+      ctr[2] = hi0 ^ ctr[3] ^ k[1];
+      ctr[3] = lo0;
+    }
+    Result result;
+    for (int i = 0; i < 4; ++i) result.x[i] = ctr[i];
+    return result;
+  }
+
+ private:
+  static constexpr int kRounds = 10;
+  static constexpr uint32_t kMul0 = 0xD2511F53;
+  static constexpr uint32_t kMul1 = 0xCD9E8D57;
+  static constexpr uint32_t kWeyl0 = 0x9E3779B9;
+  static constexpr uint32_t kWeyl1 = 0xBB67AE85;
+
+  HOSTDEVICE static uint32_t MulHiLo(uint32_t a, uint32_t b, uint32_t* hi) {
+#ifdef __CUDA_ARCH__
+    *hi = __umulhi(a, b);
+    return a * b;
+#else
+    uint64_t product = static_cast<uint64_t>(a) * b;
+    *hi = static_cast<uint32_t>(product >> 32);
+    return static_cast<uint32_t>(product);
+#endif
+  }
+
+  uint32_t counter_[4];
+  uint32_t key_[2];
+};
+
+// A uniform number in [0, 1) from a 32-bit random number.
+template <typename T>
+HOSTDEVICE inline T PhiloxUniform(uint32_t x);
+
+template <>
+HOSTDEVICE inline float PhiloxUniform<float>(uint32_t x) {
+  // The 24 bits of the mantissa, the float of x / 2^32 may round up to 1.
+  return static_cast<float>(x >> 8) * (1.0f / 16777216.0f);
+}
+
+template <>
+HOSTDEVICE inline double PhiloxUniform<double>(uint32_t x) {
+  return static_cast<double>(x) * (1.0 / 4294967296.0);
+}
+
+// The 4 normal numbers of N(0, 1) from the 4 numbers of a call, by the
+// Box-Muller transform.
+HOSTDEVICE inline void PhiloxNormal(const Philox4x32::Result& r,
+                                    float out[4]) {
+  const float kTwoPi = 6.2831853071795864f;
+  for (int i = 0; i < 4; i += 2) {
+    // 1 - u is in (0, 1], whose log is finite.
+    float u = 1.0f - PhiloxUniform<float>(r.x[i]);
+    float radius = ::sqrtf(-2.0f * ::logf(u));
+    float theta = kTwoPi * PhiloxUniform<float>(r.x[i + 1]);
+    out[i] = radius * ::cosf(theta);
+    out[i + 1] = radius * ::sinf(theta);
+  }
+}
+
+HOSTDEVICE inline void PhiloxNormal(const Philox4x32::Result& r,
+                                    double out[4]) {
+  const double kTwoPi = 6.2831853071795864;
+  for (int i = 0; i < 4; i += 2) {
+    double u = 1.0 - PhiloxUniform<double>(r.x[i]);
+    double radius = ::sqrt(-2.0 * ::log(u));
+    double theta = kTwoPi * PhiloxUniform<double>(r.x[i + 1]);
+    out[i] = radius * ::cos(theta);
+    out[i + 1] = radius * ::sin(theta);
+  }
+}
+
+struct PhiloxSeedOffset {
+  uint64_t seed;
+  uint64_t offset;
+};
+
+// The seed and the offset of a random op, which calls the generator
+// `increment` times per subsequence. A fixed seed always gives the same
+// numbers. Otherwise the ops share a seed drawn once per process and each
+// op starts past the numbers used by the previous ones.
+inline PhiloxSeedOffset GetPhiloxSeedOffset(bool fix_seed, uint64_t seed,
+                                            uint64_t increment) {
+  if (fix_seed) return {seed, 0};
+  static const uint64_t process_seed =
+      (static_cast<uint64_t>(std::random_device()()) << 32) |
+      std::random_device()();
+  static std::atomic<uint64_t> offset(0);
+  return {process_seed, offset.fetch_add(increment)};
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,95 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "paddle/fluid/platform/philox.h"
+#include <cmath>
+#include "gtest/gtest.h"
+
+using paddle::platform::Philox4x32;
+
+void ExpectResult(const Philox4x32::Result& result,
+                  const uint32_t expected[4]) {
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(result.x[i], expected[i]) << "number " << i;
+  }
+}
+
+// The known answers of Random123.
+TEST(Philox4x32, KnownAnswers) {
+  {
+    uint32_t counter[4] = {0, 0, 0, 0};
+    uint32_t key[2] = {0, 0};
+    uint32_t expected[4] = {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8};
+    ExpectResult(Philox4x32::Compute(counter, key), expected);
+  }
+  {
+    uint32_t counter[4] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff};
+    uint32_t key[2] = {0xffffffff, 0xffffffff};
+    uint32_t expected[4] = {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd};
+    ExpectResult(Philox4x32::Compute(counter, key), expected);
+  }
+  {
+    uint32_t counter[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344};
+    uint32_t key[2] = {0xa4093822, 0x299f31d0};
+    uint32_t expected[4] = {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1};
+    ExpectResult(Philox4x32::Compute(counter, key), expected);
+  }
+}
+
+TEST(Philox4x32, Offset) {
+  Philox4x32 rng(1234, 5, 0);
+  rng();
+  auto second = rng();
+  ExpectResult(Philox4x32(1234, 5, 1)(), second.x);
+
+  // The carry of the offset into its high word.
+  Philox4x32 carry(1234, 5, 0xffffffffULL);
+  carry();
+  ExpectResult(Philox4x32(1234, 5, 0x100000000ULL)(), carry().x);
+}
+
+TEST(Philox4x32, Distribution) {
+  const int kGroups = 1 << 14;
+  double sum = 0, sum_normal = 0, sum_normal_sq = 0;
+  for (int g = 0; g < kGroups; ++g) {
+    auto r = Philox4x32(42, g, 0)();
+    float normal[4];
+    paddle::platform::PhiloxNormal(r, normal);
+    for (int i = 0; i < 4; ++i) {
+      float u = paddle::platform::PhiloxUniform<float>(r.x[i]);
+      ASSERT_GE(u, 0.0f);
+      ASSERT_LT(u, 1.0f);
+      sum += u;
+      ASSERT_TRUE(std::isfinite(normal[i]));
+      sum_normal += normal[i];
+      sum_normal_sq += normal[i] * normal[i];
+    }
+  }
+  double n = 4.0 * kGroups;
+  EXPECT_NEAR(sum / n, 0.5, 0.01);
+  EXPECT_NEAR(sum_normal / n, 0.0, 0.02);
+  EXPECT_NEAR(sum_normal_sq / n, 1.0, 0.03);
+}
+
+TEST(Philox4x32, SeedOffset) {
+  auto fixed = paddle::platform::GetPhiloxSeedOffset(true, 7, 3);
+  EXPECT_EQ(fixed.seed, 7UL);
+  EXPECT_EQ(fixed.offset, 0UL);
+
+  auto first = paddle::platform::GetPhiloxSeedOffset(false, 0, 3);
+  auto second = paddle::platform::GetPhiloxSeedOffset(false, 0, 1);
+  EXPECT_EQ(first.seed, second.seed);
+  EXPECT_EQ(second.offset, first.offset + 3);
+}
@@ -16,18 +16,21 @@ limitations under the License. */
 
 #include <sys/time.h>
 #include <algorithm>
+#include <atomic>
 #include <iomanip>
 #include <limits>
 #include <map>
 #include <mutex>  // NOLINT
 #include <random>
 #include <string>
+#include <unordered_map>
 #ifdef PADDLE_WITH_CUDA
 #include <cuda.h>
 #endif  // PADDLE_WITH_CUDA
 #include "glog/logging.h"
 #include "paddle/fluid/framework/block_desc.h"
 #include "paddle/fluid/platform/device_tracer.h"
+#include "paddle/fluid/platform/sampling_profiler.h"
 #include "paddle/fluid/string/printf.h"
 
 DEFINE_bool(enable_rpc_profiler, false, "Enable rpc profiler or not.");
@@ -41,8 +44,10 @@ static int64_t profiler_lister_id = 0;
 static bool should_send_profile_state = false;
 std::mutex profiler_mu;
 
-// The profiler state, the initial value is ProfilerState::kDisabled
-static ProfilerState g_state = ProfilerState::kDisabled;
+// The profiler state, the initial value is ProfilerState::kDisabled. It is
+// written under profiler_mu, and read without the lock first by the
+// RecordEvents, so the disabled profiler does not serialize the ops.
+static std::atomic<ProfilerState> g_state(ProfilerState::kDisabled);
 // The thread local event list only can be accessed by the specific thread
 // The thread index of each thread
 static thread_local int32_t g_thread_id;
@@ -114,6 +119,11 @@ Event::Event(EventType type, std::string name, uint32_t thread_id,
   }
 #endif
   cpu_ns_ = GetTimeInNsec();
+  if (type != EventType::kMark && IsPerfCountersEnabled()) {
+    ReadPerfCounters(perf_counters_);
+  } else {
+    std::fill(perf_counters_, perf_counters_ + kNumPerfCounters, 0);
+  }
 }
 
 const EventType& Event::type() const { return type_; }
@@ -172,7 +182,12 @@ void PopEvent(const std::string& name, const DeviceContext* dev_ctx) {
 }
 
 RecordEvent::RecordEvent(const std::string& name, const DeviceContext* dev_ctx)
-    : is_enabled_(false), start_ns_(PosixInNsec()) {
+    : is_enabled_(false), start_ns_(PosixInNsec()), sampled_event_id_(-1) {
+  if (IsSampling()) {
+    sampled_event_id_ = SampledEventId(name);
+    sampled_start_ns_ = SamplingClockNs();
+  }
+  if (g_state == ProfilerState::kDisabled) return;
   std::lock_guard<std::mutex> l(profiler_mu);
   if (g_state == ProfilerState::kDisabled) return;
   is_enabled_ = true;
@@ -184,6 +199,10 @@ RecordEvent::RecordEvent(const std::string& name, const DeviceContext* dev_ctx)
 }
 
 RecordEvent::~RecordEvent() {
+  if (sampled_event_id_ >= 0) {
+    RecordSampledEvent(sampled_event_id_, sampled_start_ns_, SamplingClockNs());
+  }
+  if (!is_enabled_) return;
   std::lock_guard<std::mutex> l(profiler_mu);
   if (g_state == ProfilerState::kDisabled || !is_enabled_) return;
   DeviceTracer* tracer = GetDeviceTracer();
@@ -196,14 +215,64 @@ RecordEvent::~RecordEvent() {
 }
 
 RecordRPCEvent::RecordRPCEvent(const std::string& name,
-                               const DeviceContext* dev_ctx) {
+                               const DeviceContext* dev_ctx)
+    : flow_id_(0), is_client_(false), start_ns_(0) {
   if (FLAGS_enable_rpc_profiler) {
     event_.reset(new platform::RecordEvent(name, dev_ctx));
   }
 }
 
+RecordRPCEvent::RecordRPCEvent(const std::string& name,
+                               const DeviceContext* dev_ctx,
+                               const std::string& peer, uint64_t flow_id,
+                               bool is_client)
+    : RecordRPCEvent(name, dev_ctx) {
+  if (!FLAGS_enable_rpc_profiler || g_state == ProfilerState::kDisabled) {
+    return;
+  }
+  name_ = name;
+  peer_ = peer;
+  flow_id_ = flow_id;
+  is_client_ = is_client;
+  start_ns_ = PosixInNsec();
+}
+
+RecordRPCEvent::~RecordRPCEvent() {
+  if (peer_.empty() || g_state == ProfilerState::kDisabled) return;
+  DeviceTracer* tracer = GetDeviceTracer();
+  if (tracer) {
+    tracer->AddRPCRecords(name_, peer_, start_ns_, PosixInNsec(), flow_id_,
+                          is_client_);
+  }
+}
+
+uint64_t NextRPCFlowId(const std::string& method, int64_t trainer_id,
+                       const std::string& var_name) {
+  if (!FLAGS_enable_rpc_profiler) return 0;
+  static std::mutex mutex;
+  static std::unordered_map<std::string, uint64_t> counts;
+  std::string key = string::Sprintf("%s/%d/%s", method, trainer_id, var_name);
+  uint64_t count;
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    count = counts[key]++;
+  }
+  // The FNV-1a hash of the key and the count, never 0.
+  uint64_t hash = 14695981039346656037ULL;
+  auto mix = [&hash](const char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+      hash ^= static_cast<unsigned char>(data[i]);
+      hash *= 1099511628211ULL;
+    }
+  };
+  mix(key.data(), key.size());
+  mix(reinterpret_cast<const char*>(&count), sizeof(count));
+  return hash == 0 ? 1 : hash;
+}
+
 RecordBlock::RecordBlock(int block_id)
     : is_enabled_(false), start_ns_(PosixInNsec()) {
+  if (g_state == ProfilerState::kDisabled) return;
   std::lock_guard<std::mutex> l(profiler_mu);
   if (g_state == ProfilerState::kDisabled) return;
   is_enabled_ = true;
@@ -212,6 +281,7 @@ RecordBlock::RecordBlock(int block_id)
 }
 
 RecordBlock::~RecordBlock() {
+  if (!is_enabled_) return;
   std::lock_guard<std::mutex> l(profiler_mu);
   if (g_state == ProfilerState::kDisabled || !is_enabled_) return;
   DeviceTracer* tracer = GetDeviceTracer();
@@ -280,6 +350,12 @@ struct EventItem {
   double max_time;
   double ave_time;
   float ratio;
+  // The hardware counters and the CPU time of the calls, with
+  // FLAGS_profile_perf_counters.
+  uint64_t cycles;
+  uint64_t instructions;
+  uint64_t cache_misses;
+  double cpu_time;
 };
 
 // Print results
@@ -298,7 +374,7 @@ void PrintProfiler(const std::vector<std::vector<EventItem>>& events_table,
   } else if (g_state == ProfilerState::kAll) {
     place = "All";
   } else {
-    PADDLE_THROW("Invalid profiler state", g_state);
+    PADDLE_THROW("Invalid profiler state", g_state.load());
   }
 
   if (merge_thread) {
@@ -315,7 +391,15 @@ void PrintProfiler(const std::vector<std::vector<EventItem>>& events_table,
             << "Calls" << std::setw(data_width) << "Total"
             << std::setw(data_width) << "Min." << std::setw(data_width)
             << "Max." << std::setw(data_width) << "Ave."
-            << std::setw(data_width) << "Ratio." << std::endl;
+            << std::setw(data_width) << "Ratio.";
+  // The IPC, the last level cache misses per call, and the memory bandwidth
+  // of the cache misses in the CPU time.
+  bool print_counters = IsPerfCountersEnabled();
+  if (print_counters) {
+    std::cout << std::setw(data_width) << "IPC" << std::setw(data_width)
+              << "Miss/Call" << std::setw(data_width) << "GB/s";
+  }
+  std::cout << std::endl;
   for (size_t i = 0; i < events_table.size(); ++i) {
     for (size_t j = 0; j < events_table[i].size(); ++j) {
       const EventItem& event_item = events_table[i][j];
@@ -325,7 +409,21 @@ void PrintProfiler(const std::vector<std::vector<EventItem>>& events_table,
                 << std::setw(data_width) << event_item.min_time
                 << std::setw(data_width) << event_item.max_time
                 << std::setw(data_width) << event_item.ave_time
-                << std::setw(data_width) << event_item.ratio << std::endl;
+                << std::setw(data_width) << event_item.ratio;
+      if (print_counters) {
+        double ipc = event_item.cycles == 0
+                         ? 0.
+                         : static_cast<double>(event_item.instructions) /
+                               event_item.cycles;
+        double gbps = event_item.cpu_time <= 0.
+                          ? 0.
+                          : event_item.cache_misses * kCacheLineBytes /
+                                (event_item.cpu_time * 1e6);
+        std::cout << std::setw(data_width) << ipc << std::setw(data_width)
+                  << event_item.cache_misses / event_item.calls
+                  << std::setw(data_width) << gbps;
+      }
+      std::cout << std::endl;
     }
   }
   std::cout << std::endl;
@@ -414,6 +512,13 @@ void ParseEvents(const std::vector<std::vector<Event>>& events,
                                   ? rit->CudaElapsedMs((*analyze_events)[i][j])
                                   : rit->CpuElapsedMs((*analyze_events)[i][j]);
           total += event_time;
+          const Event& pop_event = (*analyze_events)[i][j];
+          uint64_t cycles = rit->PerfCounterDelta(pop_event, kPerfCycles);
+          uint64_t instructions =
+              rit->PerfCounterDelta(pop_event, kPerfInstructions);
+          uint64_t cache_misses =
+              rit->PerfCounterDelta(pop_event, kPerfCacheMisses);
+          double cpu_time = rit->CpuElapsedMs(pop_event);
 
           std::string event_name;
           if (merge_thread) {
@@ -427,9 +532,10 @@ void ParseEvents(const std::vector<std::vector<Event>>& events,
 
           if (event_idx.find(event_name) == event_idx.end()) {
             event_idx[event_name] = event_items.size();
-            EventItem event_item = {event_name, 1,          event_time,
-                                    event_time, event_time, event_time,
-                                    0.};
+            EventItem event_item = {event_name,   1,          event_time,
+                                    event_time,   event_time, event_time,
+                                    0.,           cycles,     instructions,
+                                    cache_misses, cpu_time};
             event_items.push_back(event_item);
           } else {
             int index = event_idx[event_name];
@@ -442,6 +548,10 @@ void ParseEvents(const std::vector<std::vector<Event>>& events,
             // max time
             event_items[index].max_time =
                 std::max(event_time, event_items[index].max_time);
+            event_items[index].cycles += cycles;
+            event_items[index].instructions += instructions;
+            event_items[index].cache_misses += cache_misses;
+            event_items[index].cpu_time += cpu_time;
           }
 
           // remove the push marker from the list
@@ -492,7 +602,14 @@ void DisableProfiler(EventSortingKey sorted_key,
   DeviceTracer* tracer = GetDeviceTracer();
   if (tracer->IsEnabled()) {
     tracer->Disable();
-    tracer->GenProfile(profile_path);
+    const std::string json_suffix = ".json";
+    if (profile_path.size() > json_suffix.size() &&
+        profile_path.compare(profile_path.size() - json_suffix.size(),
+                             json_suffix.size(), json_suffix) == 0) {
+      tracer->GenChromeTrace(profile_path);
+    } else {
+      tracer->GenProfile(profile_path);
+    }
   }
   g_state = ProfilerState::kDisabled;
   should_send_profile_state = true;
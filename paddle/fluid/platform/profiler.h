@@ -18,6 +18,7 @@ limitations under the License. */
 #include <string>
 #include <vector>
 #include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/perf_counters.h"
 
 namespace paddle {
 namespace platform {
@@ -43,6 +44,11 @@ class Event {
 
   double CpuElapsedMs(const Event& e) const;
   double CudaElapsedMs(const Event& e) const;
+  // The increase of the hardware counter of the thread up to e, see
+  // perf_counters.h.
+  uint64_t PerfCounterDelta(const Event& e, PerfCounter counter) const {
+    return e.perf_counters_[counter] - perf_counters_[counter];
+  }
 
  private:
   EventType type_;
@@ -50,6 +56,7 @@ class Event {
   uint32_t thread_id_;
   int64_t cpu_ns_;
   bool has_cuda_;
+  uint64_t perf_counters_[kNumPerfCounters];
 #ifdef PADDLE_WITH_CUDA
   cudaEvent_t event_ = nullptr;
   int device_ = -1;
@@ -85,18 +92,38 @@ struct RecordEvent {
   // Need to distinguish name by op type, block_id, program_id and perhaps
   // different kernel invocations within an op.
   std::string full_name_;
+  // The event id of the sampling profiler, or -1 if it is not sampled.
+  int sampled_event_id_;
+  uint64_t sampled_start_ns_;
 };
 
 class RecordRPCEvent {
  public:
   // dev_ctx can be set to nullptr if device is cpu.
   RecordRPCEvent(const std::string& name, const DeviceContext* dev_ctx);
-  ~RecordRPCEvent() {}
+  // The RPC with the peer endpoint is also recorded in the RPC lane of the
+  // peer in the timeline, and linked to the other end of the call with the
+  // same flow_id, see NextRPCFlowId.
+  RecordRPCEvent(const std::string& name, const DeviceContext* dev_ctx,
+                 const std::string& peer, uint64_t flow_id, bool is_client);
+  ~RecordRPCEvent();
 
  private:
   std::unique_ptr<RecordEvent> event_;
+  std::string name_;
+  std::string peer_;
+  uint64_t flow_id_;
+  bool is_client_;
+  uint64_t start_ns_;
 };
 
+// The flow id of the n-th call of the method on the variable by the trainer,
+// if this process has made n - 1 such calls before. So the client and the
+// server of a call get the same id if they both count all the calls, which
+// they do when FLAGS_enable_rpc_profiler is set, otherwise it returns 0.
+uint64_t NextRPCFlowId(const std::string& method, int64_t trainer_id,
+                       const std::string& var_name);
+
 struct RecordBlock {
   explicit RecordBlock(int block_id);
   ~RecordBlock();
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/platform/profiler.h"
+#include <fstream>
+#include <sstream>
 #include <string>
 #ifdef PADDLE_WITH_CUDA
 #include <cuda_runtime.h>
@@ -162,6 +164,46 @@ TEST(RecordEvent, RecordEvent) {
   DisableProfiler(EventSortingKey::kTotal, "/tmp/profiler");
 }
 
+DECLARE_bool(enable_rpc_profiler);
+
+TEST(RecordRPCEvent, ChromeTrace) {
+  using paddle::platform::ProfilerState;
+  using paddle::platform::EventSortingKey;
+  FLAGS_enable_rpc_profiler = true;
+  // The two ends of a call get the same flow id.
+  uint64_t flow_id = paddle::platform::NextRPCFlowId("SendRPC", 0, "w@GRAD");
+  EXPECT_NE(flow_id, 0UL);
+  EXPECT_NE(paddle::platform::NextRPCFlowId("SendRPC", 0, "w@GRAD"), flow_id);
+
+  paddle::platform::EnableProfiler(ProfilerState::kCPU);
+  {
+    paddle::platform::RecordEvent record_event("chrome_trace_op", nullptr);
+  }
+  {
+    paddle::platform::RecordRPCEvent record_event("SendRPC", nullptr,
+                                                  "127.0.0.1:6174", flow_id,
+                                                  true);
+  }
+  {
+    paddle::platform::RecordRPCEvent record_event("RequestSend", nullptr,
+                                                  "trainer 0", flow_id, false);
+  }
+  std::string path = "/tmp/profiler_chrome_trace.json";
+  paddle::platform::DisableProfiler(EventSortingKey::kTotal, path);
+  FLAGS_enable_rpc_profiler = false;
+
+  std::ifstream fin(path);
+  std::stringstream ss;
+  ss << fin.rdbuf();
+  std::string trace = ss.str();
+  EXPECT_EQ(trace.find("{\"traceEvents\": ["), 0UL);
+  EXPECT_NE(trace.find("\"name\": \"chrome_trace_op\""), std::string::npos);
+  EXPECT_NE(trace.find("\"args\": {\"name\": \"127.0.0.1:6174\"}"),
+            std::string::npos);
+  EXPECT_NE(trace.find("\"ph\": \"s\""), std::string::npos);
+  EXPECT_NE(trace.find("\"ph\": \"f\", \"bp\": \"e\""), std::string::npos);
+}
+
 #ifdef PADDLE_WITH_CUDA
 TEST(TMP, stream_wait) {
   cudaStream_t stream;
@@ -0,0 +1,288 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/sampling_profiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#include "gflags/gflags.h"
+
+DEFINE_int32(sampling_profiler_period, 0,
+             "Profile 1 in sampling_profiler_period iterations with the "
+             "sampling profiler, 0 to disable it.");
+
+namespace paddle {
+namespace platform {
+
+namespace detail {
+std::atomic<bool> g_sampling_active(false);
+}  // namespace detail
+
+struct SampleRecord {
+  int event_id;
+  uint64_t start_ns;
+  uint64_t end_ns;
+};
+
+// The single producer, single consumer ring buffer of a thread. The thread
+// pushes the records, and they are drained under g_sampling_mutex.
+class SampleBuffer {
+ public:
+  // It should be a power of 2.
+  static constexpr size_t kCapacity = 4096;
+
+  bool Push(const SampleRecord& record) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == kCapacity) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    records_[head & (kCapacity - 1)] = record;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  template <typename Callback>
+  void Drain(Callback callback) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_.load(std::memory_order_acquire);
+    for (; tail != head; ++tail) {
+      callback(records_[tail & (kCapacity - 1)]);
+    }
+    tail_.store(tail, std::memory_order_release);
+  }
+
+  uint64_t TakeDropped() {
+    return dropped_.exchange(0, std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<size_t> head_{0};
+  std::atomic<size_t> tail_{0};
+  std::atomic<uint64_t> dropped_{0};
+  SampleRecord records_[kCapacity];
+};
+
+// The histogram of the latencies in ns, with 4 buckets per power of 2, so
+// the percentiles are within 25% of the true ones.
+class LatencyHistogram {
+ public:
+  static constexpr int kNumBuckets = 252;
+
+  void Add(uint64_t ns) {
+    ++count_;
+    total_ns_ += ns;
+    min_ns_ = count_ == 1 ? ns : std::min(min_ns_, ns);
+    max_ns_ = std::max(max_ns_, ns);
+    ++buckets_[BucketOf(ns)];
+  }
+
+  // The upper bound of the q-th quantile.
+  uint64_t Percentile(double q) const {
+    uint64_t rank = static_cast<uint64_t>(q * count_);
+    uint64_t seen = 0;
+    for (int b = 0; b < kNumBuckets; ++b) {
+      seen += buckets_[b];
+      if (seen > rank) {
+        return std::min(max_ns_, LowerBound(b + 1) - 1);
+      }
+    }
+    return max_ns_;
+  }
+
+  uint64_t count() const { return count_; }
+  uint64_t total_ns() const { return total_ns_; }
+  uint64_t min_ns() const { return min_ns_; }
+  uint64_t max_ns() const { return max_ns_; }
+
+ private:
+  static int BucketOf(uint64_t ns) {
+    if (ns < 4) return static_cast<int>(ns);
+    int msb = 0;
+    while (msb < 63 && (ns >> (msb + 1)) != 0) ++msb;
+    return (msb - 1) * 4 + static_cast<int>((ns >> (msb - 2)) & 3);
+  }
+
+  static uint64_t LowerBound(int bucket) {
+    if (bucket < 4) return static_cast<uint64_t>(bucket);
+    if (bucket >= kNumBuckets) return UINT64_MAX;
+    int msb = bucket / 4 + 1;
+    return static_cast<uint64_t>(4 + bucket % 4) << (msb - 2);
+  }
+
+  uint64_t count_ = 0;
+  uint64_t total_ns_ = 0;
+  uint64_t min_ns_ = 0;
+  uint64_t max_ns_ = 0;
+  uint64_t buckets_[kNumBuckets] = {0};
+};
+
+static std::atomic<int> g_sampling_period(-1);
+static std::atomic<uint64_t> g_num_iterations(0);
+static thread_local int g_iteration_depth = 0;
+
+// Guards the names of the events.
+static std::mutex g_event_names_mutex;
+static std::unordered_map<std::string, int> g_event_ids;
+static std::vector<std::string> g_event_names;
+
+// Guards the buffers and the aggregated histograms.
+static std::mutex g_sampling_mutex;
+static std::vector<std::shared_ptr<SampleBuffer>> g_sample_buffers;
+static std::vector<LatencyHistogram> g_histograms;
+static uint64_t g_num_sampled_iterations = 0;
+static uint64_t g_num_dropped = 0;
+
+static thread_local std::shared_ptr<SampleBuffer> g_sample_buffer;
+
+static int SamplingPeriod() {
+  int period = g_sampling_period.load(std::memory_order_relaxed);
+  if (period < 0) {
+    period = std::max(FLAGS_sampling_profiler_period, 0);
+    g_sampling_period.store(period, std::memory_order_relaxed);
+  }
+  return period;
+}
+
+int SampledEventId(const std::string& name) {
+  // Look up the names of this thread first, so the lock is only taken for
+  // the first time the thread sees a name.
+  static thread_local std::unordered_map<std::string, int> cached_ids;
+  auto it = cached_ids.find(name);
+  if (it != cached_ids.end()) return it->second;
+
+  std::lock_guard<std::mutex> guard(g_event_names_mutex);
+  auto res = g_event_ids.emplace(name, static_cast<int>(g_event_names.size()));
+  if (res.second) {
+    g_event_names.push_back(name);
+  }
+  cached_ids.emplace(name, res.first->second);
+  return res.first->second;
+}
+
+void RecordSampledEvent(int event_id, uint64_t start_ns, uint64_t end_ns) {
+  if (!g_sample_buffer) {
+    g_sample_buffer = std::make_shared<SampleBuffer>();
+    std::lock_guard<std::mutex> guard(g_sampling_mutex);
+    g_sample_buffers.push_back(g_sample_buffer);
+  }
+  g_sample_buffer->Push(
+      SampleRecord{event_id, start_ns, std::max(start_ns, end_ns)});
+}
+
+// Aggregate the records of all the threads, g_sampling_mutex should be held.
+static void DrainSampleBuffers() {
+  for (auto& buffer : g_sample_buffers) {
+    buffer->Drain([](const SampleRecord& record) {
+      if (static_cast<size_t>(record.event_id) >= g_histograms.size()) {
+        g_histograms.resize(record.event_id + 1);
+      }
+      g_histograms[record.event_id].Add(record.end_ns - record.start_ns);
+    });
+    g_num_dropped += buffer->TakeDropped();
+  }
+}
+
+SampledIteration::SampledIteration()
+    : is_outermost_(g_iteration_depth++ == 0), is_sampled_(false) {
+  if (!is_outermost_) return;
+  int period = SamplingPeriod();
+  if (period == 0) return;
+  if (g_num_iterations.fetch_add(1, std::memory_order_relaxed) % period != 0) {
+    return;
+  }
+  // The iterations running at the same time are profiled together, and only
+  // the one which started the sampling ends it.
+  bool expected = false;
+  is_sampled_ = detail::g_sampling_active.compare_exchange_strong(expected,
+                                                                  true);
+}
+
+SampledIteration::~SampledIteration() {
+  --g_iteration_depth;
+  if (!is_sampled_) return;
+  detail::g_sampling_active.store(false, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> guard(g_sampling_mutex);
+  ++g_num_sampled_iterations;
+  DrainSampleBuffers();
+}
+
+void SetSamplingProfilerPeriod(int period) {
+  g_sampling_period.store(std::max(period, 0), std::memory_order_relaxed);
+}
+
+std::string SamplingProfilerReport() {
+  std::vector<std::string> names;
+  {
+    std::lock_guard<std::mutex> guard(g_event_names_mutex);
+    names = g_event_names;
+  }
+  std::lock_guard<std::mutex> guard(g_sampling_mutex);
+  DrainSampleBuffers();
+
+  std::vector<int> ids;
+  for (size_t i = 0; i < g_histograms.size() && i < names.size(); ++i) {
+    if (g_histograms[i].count() > 0) ids.push_back(static_cast<int>(i));
+  }
+  std::sort(ids.begin(), ids.end(), [](int a, int b) {
+    return g_histograms[a].total_ns() > g_histograms[b].total_ns();
+  });
+
+  size_t name_width = 5;
+  for (int id : ids) {
+    name_width = std::max(name_width, names[id].size());
+  }
+  name_width += 2;
+  const int data_width = 12;
+  auto ms = [](uint64_t ns) { return static_cast<double>(ns) / 1000000.0; };
+
+  std::ostringstream os;
+  os << "Sampled iterations: " << g_num_sampled_iterations
+     << ", dropped events: " << g_num_dropped << "\n";
+  os << std::setw(name_width) << std::left << "Event" << std::setw(data_width)
+     << "Calls" << std::setw(data_width) << "Total" << std::setw(data_width)
+     << "Ave" << std::setw(data_width) << "Min" << std::setw(data_width)
+     << "Max" << std::setw(data_width) << "P50" << std::setw(data_width)
+     << "P90" << std::setw(data_width) << "P99"
+     << "\n";
+  for (int id : ids) {
+    auto& h = g_histograms[id];
+    os << std::setw(name_width) << names[id] << std::setw(data_width)
+       << h.count() << std::setw(data_width) << ms(h.total_ns())
+       << std::setw(data_width) << ms(h.total_ns()) / h.count()
+       << std::setw(data_width) << ms(h.min_ns()) << std::setw(data_width)
+       << ms(h.max_ns()) << std::setw(data_width) << ms(h.Percentile(0.5))
+       << std::setw(data_width) << ms(h.Percentile(0.9))
+       << std::setw(data_width) << ms(h.Percentile(0.99)) << "\n";
+  }
+  os << "Times are in ms.\n";
+  return os.str();
+}
+
+void ResetSamplingProfiler() {
+  std::lock_guard<std::mutex> guard(g_sampling_mutex);
+  DrainSampleBuffers();
+  g_histograms.clear();
+  g_num_sampled_iterations = 0;
+  g_num_dropped = 0;
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,81 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <string>
+
+namespace paddle {
+namespace platform {
+
+/*
+ * The sampling profiler, which is cheap enough to be always on in
+ * production.
+ *
+ * Only 1 in FLAGS_sampling_profiler_period iterations is profiled. The ops
+ * run in a sampled iteration are recorded by their interned event ids into
+ * the lock-free ring buffer of every thread, and at the end of the iteration
+ * the records are aggregated into a latency histogram of every event. The
+ * other iterations pay for an atomic load per op.
+ */
+
+namespace detail {
+extern std::atomic<bool> g_sampling_active;
+}  // namespace detail
+
+// Whether the current iteration is sampled.
+inline bool IsSampling() {
+  return detail::g_sampling_active.load(std::memory_order_relaxed);
+}
+
+inline uint64_t SamplingClockNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// The interned id of the event name, which is the same for the same name.
+int SampledEventId(const std::string& name);
+
+// Record an event of the sampled iteration into the buffer of this thread.
+// The event is dropped if the buffer is full.
+void RecordSampledEvent(int event_id, uint64_t start_ns, uint64_t end_ns);
+
+// An iteration, e.g. a run of the program or a request of inference. The
+// iterations nested in another one of the same thread are not counted.
+class SampledIteration {
+ public:
+  SampledIteration();
+  ~SampledIteration();
+
+ private:
+  bool is_outermost_;
+  bool is_sampled_;
+};
+
+// Profile 1 in period iterations, or nothing if period is 0. It overrides
+// FLAGS_sampling_profiler_period.
+void SetSamplingProfilerPeriod(int period);
+
+// The report of the latency histograms aggregated so far, one line per event
+// sorted by the total time.
+std::string SamplingProfilerReport();
+
+void ResetSamplingProfiler();
+
+}  // namespace platform
+}  // namespace paddle
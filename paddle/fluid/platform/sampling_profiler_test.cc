@@ -0,0 +1,94 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/sampling_profiler.h"
+
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace platform {
+
+static void RunIteration(int op_a, int op_b) {
+  SampledIteration iteration;
+  if (!IsSampling()) return;
+  RecordSampledEvent(op_a, 1000, 2000);
+  {
+    // The nested iteration is not counted.
+    SampledIteration nested;
+    RecordSampledEvent(op_b, 1000, 1000 + 4000000);
+  }
+}
+
+TEST(SamplingProfiler, Period) {
+  int op_a = SampledEventId("sampled_op_a");
+  int op_b = SampledEventId("sampled_op_b");
+  EXPECT_EQ(SampledEventId("sampled_op_a"), op_a);
+  EXPECT_NE(op_a, op_b);
+
+  SetSamplingProfilerPeriod(0);
+  for (int i = 0; i < 4; ++i) RunIteration(op_a, op_b);
+  EXPECT_EQ(SamplingProfilerReport().find("sampled_op_a"), std::string::npos);
+
+  SetSamplingProfilerPeriod(3);
+  ResetSamplingProfiler();
+  for (int i = 0; i < 9; ++i) RunIteration(op_a, op_b);
+  EXPECT_FALSE(IsSampling());
+  std::string report = SamplingProfilerReport();
+  EXPECT_NE(report.find("Sampled iterations: 3,"), std::string::npos);
+  // op_b takes the most time, so it is the first.
+  auto pos_a = report.find("sampled_op_a");
+  auto pos_b = report.find("sampled_op_b");
+  ASSERT_NE(pos_a, std::string::npos);
+  ASSERT_NE(pos_b, std::string::npos);
+  EXPECT_LT(pos_b, pos_a);
+
+  ResetSamplingProfiler();
+  EXPECT_EQ(SamplingProfilerReport().find("sampled_op_a"), std::string::npos);
+  SetSamplingProfilerPeriod(0);
+}
+
+TEST(SamplingProfiler, Threads) {
+  int op = SampledEventId("sampled_op_threads");
+  SetSamplingProfilerPeriod(1);
+  ResetSamplingProfiler();
+  {
+    SampledIteration iteration;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([op] {
+        for (int i = 0; i < 100; ++i) {
+          auto start = SamplingClockNs();
+          RecordSampledEvent(op, start, SamplingClockNs());
+        }
+      });
+    }
+    for (auto& t : threads) t.join();
+  }
+  std::string report = SamplingProfilerReport();
+  auto pos = report.find("sampled_op_threads");
+  ASSERT_NE(pos, std::string::npos);
+  std::istringstream line(report.substr(pos));
+  std::string name;
+  int calls;
+  line >> name >> calls;
+  EXPECT_EQ(calls, 400);
+  SetSamplingProfilerPeriod(0);
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,80 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/pybind/async_run.h"
+
+#include <chrono>  // NOLINT
+#include <utility>
+
+#include "paddle/fluid/framework/lod_tensor_array.h"
+
+PYBIND11_MAKE_OPAQUE(paddle::framework::LoDTensorArray);
+
+namespace paddle {
+namespace pybind {
+
+RunHandle::RunHandle(std::function<framework::FeedFetchList()> run)
+    // A thread of its own, the runs may use the shared thread pool and
+    // should not wait for a task of it.
+    : future_(std::async(std::launch::async, std::move(run))) {}
+
+RunHandle::~RunHandle() {
+  if (future_.valid()) {
+    py::gil_scoped_release release;
+    future_.wait();
+  }
+}
+
+bool RunHandle::IsDone() const {
+  return !future_.valid() ||
+         future_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void RunHandle::Wait() {
+  if (future_.valid()) {
+    try {
+      fetched_ = future_.get();
+    } catch (...) {
+      exception_ = std::current_exception();
+    }
+  }
+  if (exception_) {
+    std::rethrow_exception(exception_);
+  }
+}
+
+const framework::FeedFetchList& RunHandle::Fetched() {
+  Wait();
+  return fetched_;
+}
+
+void BindRunHandle(py::module* m) {
+  py::class_<RunHandle>(*m, "RunHandle")
+      .def("is_done", &RunHandle::IsDone)
+      .def("wait",
+           [](RunHandle& self) {
+             py::gil_scoped_release release;
+             self.Wait();
+           })
+      .def("fetched", [](RunHandle& self) {
+        {
+          py::gil_scoped_release release;
+          self.Wait();
+        }
+        return self.Fetched();
+      });
+}
+
+}  // namespace pybind
+}  // namespace paddle
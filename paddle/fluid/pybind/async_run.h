@@ -0,0 +1,56 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <exception>
+#include <functional>
+#include <future>  // NOLINT
+#include "paddle/fluid/framework/feed_fetch_type.h"
+#include "pybind11/pybind11.h"
+
+namespace py = pybind11;
+
+namespace paddle {
+namespace pybind {
+
+/*
+ * The handle of a run in a background thread, which does not hold the GIL,
+ * so that Python prepares the next batch meanwhile. The run returns the
+ * fetched results, which are kept by the handle until they are read.
+ */
+class RunHandle {
+ public:
+  explicit RunHandle(std::function<framework::FeedFetchList()> run);
+
+  // The handle is destroyed by Python with the GIL held, it waits for the
+  // run without the GIL.
+  ~RunHandle();
+
+  bool IsDone() const;
+
+  // Wait for the run to finish, and rethrow the exception of the run.
+  void Wait();
+
+  const framework::FeedFetchList& Fetched();
+
+ private:
+  std::future<framework::FeedFetchList> future_;
+  framework::FeedFetchList fetched_;
+  std::exception_ptr exception_;
+};
+
+void BindRunHandle(py::module* m);
+
+}  // namespace pybind
+}  // namespace paddle
@@ -0,0 +1,141 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/pybind/batch_assembler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <future>  // NOLINT
+
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/framework/threadpool.h"
+
+namespace paddle {
+namespace pybind {
+
+namespace {
+
+// The batches smaller than this are copied by the calling thread, the copies
+// are shorter than scheduling the tasks.
+constexpr size_t kMinParallelBytes = 1 << 20;
+
+size_t SlotBytes(const SlotData& slot) {
+  size_t bytes = 0;
+  for (auto& chunk : slot.chunks) bytes += chunk.bytes;
+  return bytes;
+}
+
+}  // namespace
+
+framework::DDim SlotDims(const SlotData& slot) {
+  std::vector<int64_t> dims{slot.num_leaves};
+  dims.insert(dims.end(), slot.leaf_dims.begin(), slot.leaf_dims.end());
+  if (slot.var_shape.empty() || slot.var_shape.size() == dims.size()) {
+    return framework::make_ddim(dims);
+  }
+
+  int64_t numel = framework::product(framework::make_ddim(dims));
+  int64_t known = 1;
+  int negative = -1;
+  for (size_t i = 0; i < slot.var_shape.size(); ++i) {
+    if (slot.var_shape[i] < 0) {
+      negative = i;
+    } else {
+      known *= slot.var_shape[i];
+    }
+  }
+  std::vector<int64_t> shape(slot.var_shape);
+  if (negative >= 0) {
+    PADDLE_ENFORCE(known > 0 && numel % known == 0,
+                   "%d elements cannot be reshaped to %s", numel,
+                   framework::make_ddim(slot.var_shape));
+    shape[negative] = numel / known;
+  } else {
+    PADDLE_ENFORCE_EQ(numel, known, "%d elements cannot be reshaped to %s",
+                      numel, framework::make_ddim(slot.var_shape));
+  }
+  return framework::make_ddim(shape);
+}
+
+void BatchAssembler::AssembleSlot(const SlotData& slot,
+                                  framework::LoDTensor* tensor) const {
+  auto type = framework::ToTypeIndex(slot.dtype);
+  tensor->Resize(SlotDims(slot));
+  PADDLE_ENFORCE_EQ(SlotBytes(slot),
+                    tensor->numel() * framework::SizeOfType(type),
+                    "The leaves of a slot should have the same size");
+
+  bool to_gpu = platform::is_gpu_place(place_);
+  platform::Place host_place = platform::CPUPlace();
+  if (platform::is_cuda_pinned_place(place_) ||
+      (to_gpu && use_pinned_memory_)) {
+    host_place = platform::CUDAPinnedPlace();
+  }
+  framework::LoDTensor staging;
+  auto* host = to_gpu ? &staging : tensor;
+  if (to_gpu) staging.Resize(tensor->dims());
+
+  auto* dst = static_cast<char*>(host->mutable_data(host_place, type));
+  for (auto& chunk : slot.chunks) {
+    std::memcpy(dst, chunk.data, chunk.bytes);
+    dst += chunk.bytes;
+  }
+  if (to_gpu) framework::TensorCopySync(staging, place_, tensor);
+  if (!slot.lengths.empty()) {
+    tensor->set_lod(framework::ConvertToOffsetBasedLoD(slot.lengths));
+  }
+}
+
+std::vector<framework::LoDTensor> BatchAssembler::Assemble(
+    const std::vector<SlotData>& slots) const {
+  std::vector<framework::LoDTensor> tensors(slots.size());
+  size_t bytes = 0;
+  for (auto& slot : slots) bytes += SlotBytes(slot);
+  int num_tasks = std::min<int>(num_threads_, slots.size());
+  if (num_tasks <= 1 || bytes < kMinParallelBytes) {
+    for (size_t i = 0; i < slots.size(); ++i) {
+      AssembleSlot(slots[i], &tensors[i]);
+    }
+    return tensors;
+  }
+
+  // The slots are dealt to the tasks in turn, the calling thread runs the
+  // first task.
+  auto run = [&](int task) {
+    for (size_t i = task; i < slots.size(); i += num_tasks) {
+      AssembleSlot(slots[i], &tensors[i]);
+    }
+  };
+  std::vector<std::future<void>> futures;
+  for (int task = 1; task < num_tasks; ++task) {
+    futures.emplace_back(framework::Async([&run, task] { run(task); }));
+  }
+  // The tasks use the tensors, they are waited for before an exception of
+  // the calling thread is thrown.
+  std::exception_ptr error;
+  try {
+    run(0);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  for (auto& f : futures) f.wait();
+  if (error) std::rethrow_exception(error);
+  for (auto& f : futures) f.get();
+  return tensors;
+}
+
+}  // namespace pybind
+}  // namespace paddle
@@ -0,0 +1,82 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace pybind {
+
+/*
+ * The data of a slot of a batch, gathered from the samples by the Python
+ * binding. The elements of the leaves, i.e. the items at the last LoD level,
+ * are in the chunks in the order of the samples.
+ */
+struct SlotData {
+  struct Chunk {
+    const void* data;
+    size_t bytes;
+  };
+
+  explicit SlotData(framework::proto::VarType::Type dtype) : dtype(dtype) {}
+
+  framework::proto::VarType::Type dtype;
+  // The recursive sequence lengths of the LoD levels.
+  framework::LoD lengths;
+  std::vector<Chunk> chunks;
+  int64_t num_leaves{0};
+  // The dims of a leaf, all the leaves have the same number of elements.
+  std::vector<int64_t> leaf_dims;
+  // The dims of the variable fed, with a negative dim for the batch. It is
+  // empty if the variable has more than one negative dim.
+  std::vector<int64_t> var_shape;
+};
+
+// The dims of the tensor of a slot, [num_leaves] + leaf_dims, or var_shape
+// with the negative dim inferred if the ranks differ.
+framework::DDim SlotDims(const SlotData& slot);
+
+/*
+ * BatchAssembler - Copy the data of the slots of a batch into LoDTensors, each
+ * tensor is allocated once with its final size. The data for a GPU is staged
+ * in CUDA pinned memory with use_pinned_memory, which speeds up the copy to
+ * the device.
+ */
+class BatchAssembler {
+ public:
+  BatchAssembler(const platform::Place& place, bool use_pinned_memory,
+                 int num_threads)
+      : place_(place),
+        use_pinned_memory_(use_pinned_memory),
+        num_threads_(num_threads) {}
+
+  // The chunks of the slots must be valid until Assemble returns.
+  std::vector<framework::LoDTensor> Assemble(
+      const std::vector<SlotData>& slots) const;
+
+ private:
+  void AssembleSlot(const SlotData& slot, framework::LoDTensor* tensor) const;
+
+  platform::Place place_;
+  bool use_pinned_memory_;
+  int num_threads_;
+};
+
+}  // namespace pybind
+}  // namespace paddle
@@ -0,0 +1,119 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/pybind/batch_assembler.h"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace pybind {
+
+using framework::proto::VarType;
+
+// A slot of int64 sequences of the ids in [0, num_ids), the sequences have
+// the given lengths and the chunks split them.
+SlotData MakeSequenceSlot(const std::vector<int64_t>& ids,
+                          const std::vector<size_t>& lengths) {
+  SlotData slot(VarType::INT64);
+  slot.lengths.emplace_back(lengths);
+  for (size_t i = 0; i < ids.size(); i += 3) {
+    size_t n = std::min<size_t>(3, ids.size() - i);
+    slot.chunks.push_back({ids.data() + i, n * sizeof(int64_t)});
+  }
+  slot.num_leaves = ids.size();
+  slot.var_shape = {-1, 1};
+  return slot;
+}
+
+TEST(BatchAssembler, SlotDims) {
+  SlotData slot(VarType::FP32);
+  slot.num_leaves = 4;
+  slot.leaf_dims = {784};
+  slot.var_shape = {-1, 1, 28, 28};
+  EXPECT_EQ(SlotDims(slot), framework::make_ddim({4, 1, 28, 28}));
+
+  // The dims of the data are kept if the ranks are the same.
+  slot.var_shape = {-1, 784};
+  EXPECT_EQ(SlotDims(slot), framework::make_ddim({4, 784}));
+  slot.var_shape.clear();
+  EXPECT_EQ(SlotDims(slot), framework::make_ddim({4, 784}));
+
+  // The scalar labels become [batch, 1].
+  slot.leaf_dims.clear();
+  slot.var_shape = {-1, 1};
+  EXPECT_EQ(SlotDims(slot), framework::make_ddim({4, 1}));
+
+  slot.leaf_dims = {3};
+  slot.var_shape = {-1, 5, 1};
+  EXPECT_THROW(SlotDims(slot), platform::EnforceNotMet);
+}
+
+void CheckAssemble(int num_threads, size_t num_ids) {
+  std::vector<int64_t> ids(num_ids);
+  std::iota(ids.begin(), ids.end(), 0);
+  std::vector<size_t> lengths{num_ids / 2, num_ids - num_ids / 2};
+
+  std::vector<float> image(2 * 6);
+  std::iota(image.begin(), image.end(), 0.f);
+  SlotData dense(VarType::FP32);
+  dense.chunks.push_back({image.data(), 6 * sizeof(float)});
+  dense.chunks.push_back({image.data() + 6, 6 * sizeof(float)});
+  dense.num_leaves = 2;
+  dense.leaf_dims = {6};
+  dense.var_shape = {-1, 2, 3};
+
+  std::vector<SlotData> slots{MakeSequenceSlot(ids, lengths), dense,
+                              MakeSequenceSlot(ids, {num_ids})};
+  BatchAssembler assembler(platform::CPUPlace(), false, num_threads);
+  auto tensors = assembler.Assemble(slots);
+  ASSERT_EQ(tensors.size(), 3UL);
+
+  for (size_t i : {0, 2}) {
+    auto& t = tensors[i];
+    EXPECT_EQ(t.dims(), framework::make_ddim({static_cast<int64_t>(num_ids),
+                                              1}));
+    ASSERT_EQ(t.lod().size(), 1UL);
+    EXPECT_EQ(t.lod()[0].back(), num_ids);
+    for (size_t j = 0; j < num_ids; ++j) {
+      ASSERT_EQ(t.data<int64_t>()[j], ids[j]);
+    }
+  }
+  EXPECT_EQ(tensors[0].lod()[0][1], lengths[0]);
+
+  EXPECT_EQ(tensors[1].dims(), framework::make_ddim({2, 2, 3}));
+  EXPECT_TRUE(tensors[1].lod().empty());
+  for (size_t j = 0; j < image.size(); ++j) {
+    EXPECT_EQ(tensors[1].data<float>()[j], image[j]);
+  }
+}
+
+TEST(BatchAssembler, Assemble) { CheckAssemble(1, 10); }
+
+// The large batches are copied by the thread pool.
+TEST(BatchAssembler, AssembleInThreads) { CheckAssemble(3, 1 << 18); }
+
+TEST(BatchAssembler, MismatchedSize) {
+  std::vector<int64_t> ids(5);
+  auto slot = MakeSequenceSlot(ids, {5});
+  slot.num_leaves = 6;
+  BatchAssembler assembler(platform::CPUPlace(), false, 1);
+  EXPECT_THROW(assembler.Assemble({slot}), platform::EnforceNotMet);
+}
+
+}  // namespace pybind
+}  // namespace paddle
@@ -0,0 +1,279 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/pybind/data_feeder.h"
+
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "paddle/fluid/pybind/batch_assembler.h"
+#include "pybind11/numpy.h"
+#include "pybind11/stl.h"
+
+namespace paddle {
+namespace pybind {
+
+namespace {
+
+using framework::proto::VarType;
+
+template <typename T>
+T CastScalar(py::handle obj, std::true_type /* is_integral */) {
+  return static_cast<T>(
+      py::int_(py::reinterpret_borrow<py::object>(obj)).cast<int64_t>());
+}
+
+template <typename T>
+T CastScalar(py::handle obj, std::false_type /* is_integral */) {
+  return static_cast<T>(
+      py::float_(py::reinterpret_borrow<py::object>(obj)).cast<double>());
+}
+
+bool IsSequence(py::handle obj) {
+  return PySequence_Check(obj.ptr()) && !PyUnicode_Check(obj.ptr()) &&
+         !PyBytes_Check(obj.ptr());
+}
+
+/*
+ * Gather the data of a slot from the samples, the numpy arrays of the right
+ * type are copied by BatchAssembler from their own buffers, and the Python
+ * lists and scalars are converted into a staging buffer.
+ */
+class SlotWalker {
+ public:
+  SlotWalker(VarType::Type dtype, int lod_level,
+             const std::vector<int64_t>& var_shape)
+      : slot_(dtype), lod_level_(lod_level) {
+    slot_.lengths.resize(lod_level);
+    slot_.var_shape = var_shape;
+  }
+
+  void Walk(py::handle samples) {
+    PADDLE_ENFORCE(IsSequence(samples), "A slot should be a list of samples");
+    switch (slot_.dtype) {
+      case VarType::FP32:
+        WalkSamples<float>(samples);
+        break;
+      case VarType::FP64:
+        WalkSamples<double>(samples);
+        break;
+      case VarType::INT32:
+        WalkSamples<int>(samples);
+        break;
+      case VarType::INT64:
+        WalkSamples<int64_t>(samples);
+        break;
+      case VarType::UINT8:
+        WalkSamples<uint8_t>(samples);
+        break;
+      default:
+        PADDLE_THROW(
+            "dtype must be any of [int32, float32, int64, float64, uint8]");
+    }
+    // The staging buffer does not grow any more.
+    for (size_t i = 0; i < staging_offsets_.size(); ++i) {
+      auto& chunk = slot_.chunks[staging_chunks_[i]];
+      chunk.data = staging_.data() + staging_offsets_[i];
+    }
+  }
+
+  const SlotData& slot() const { return slot_; }
+
+ private:
+  template <typename T>
+  using Array = py::array_t<T, py::array::c_style | py::array::forcecast>;
+
+  template <typename T>
+  void WalkSamples(py::handle samples) {
+    for (auto sample : samples) {
+      WalkImpl<T>(sample, 0);
+    }
+  }
+
+  // The data of a sample is at level 0, the leaves are at lod_level_.
+  template <typename T>
+  void WalkImpl(py::handle data, int level) {
+    if (level == lod_level_) {
+      AddLeaf<T>(data);
+      return;
+    }
+    // A numpy array of the leaves of a sequence is copied as a whole.
+    if (level + 1 == lod_level_ && py::isinstance<py::array>(data)) {
+      auto array = Array<T>::ensure(data);
+      PADDLE_ENFORCE(static_cast<bool>(array),
+                     "failed to convert a numpy array");
+      PADDLE_ENFORCE(array.ndim() > 0,
+                     "A sequence should not be a numpy scalar");
+      int64_t len = array.shape()[0];
+      slot_.lengths[level].push_back(len);
+      std::vector<int64_t> dims(array.shape() + 1,
+                                array.shape() + array.ndim());
+      for (int64_t i = 0; i < len; ++i) CheckLeaf(dims);
+      AddArrayChunk(array);
+      return;
+    }
+    PADDLE_ENFORCE(IsSequence(data),
+                   "The data at LoD level %d should be a sequence", level);
+    slot_.lengths[level].push_back(py::len(data));
+    for (auto item : data) {
+      WalkImpl<T>(item, level + 1);
+    }
+  }
+
+  template <typename T>
+  void AddLeaf(py::handle leaf) {
+    if (py::isinstance<py::array>(leaf)) {
+      auto array = Array<T>::ensure(leaf);
+      PADDLE_ENFORCE(static_cast<bool>(array),
+                     "failed to convert a numpy array");
+      CheckLeaf(std::vector<int64_t>(array.shape(),
+                                     array.shape() + array.ndim()));
+      AddArrayChunk(array);
+      return;
+    }
+
+    size_t offset = staging_.size();
+    std::vector<int64_t> dims;
+    Flatten<T>(leaf, 0, &dims);
+    CheckLeaf(dims);
+    size_t bytes = staging_.size() - offset;
+    if (bytes == 0) return;
+    // The consecutive leaves in the staging buffer are copied at once.
+    if (!staging_chunks_.empty() &&
+        staging_chunks_.back() + 1 == slot_.chunks.size()) {
+      slot_.chunks.back().bytes += bytes;
+      return;
+    }
+    staging_chunks_.push_back(slot_.chunks.size());
+    staging_offsets_.push_back(offset);
+    slot_.chunks.push_back({nullptr, bytes});
+  }
+
+  // Append the elements of the nested sequences to the staging buffer, the
+  // dims are those of the first items.
+  template <typename T>
+  void Flatten(py::handle obj, size_t depth, std::vector<int64_t>* dims) {
+    if (!IsSequence(obj)) {
+      T value = CastScalar<T>(obj, std::is_integral<T>());
+      auto* bytes = reinterpret_cast<const char*>(&value);
+      staging_.insert(staging_.end(), bytes, bytes + sizeof(T));
+      return;
+    }
+    if (dims->size() == depth) dims->push_back(py::len(obj));
+    for (auto item : obj) {
+      Flatten<T>(item, depth + 1, dims);
+    }
+  }
+
+  void CheckLeaf(const std::vector<int64_t>& dims) {
+    if (slot_.num_leaves == 0) {
+      slot_.leaf_dims = dims;
+    } else {
+      PADDLE_ENFORCE(dims == slot_.leaf_dims,
+                     "The items of a slot at its last LoD level should have "
+                     "the same shape, got %s and %s",
+                     framework::make_ddim(dims),
+                     framework::make_ddim(slot_.leaf_dims));
+    }
+    ++slot_.num_leaves;
+  }
+
+  void AddArrayChunk(const py::array& array) {
+    if (array.nbytes() == 0) return;
+    slot_.chunks.push_back({array.data(), static_cast<size_t>(array.nbytes())});
+    arrays_.push_back(array);
+  }
+
+  SlotData slot_;
+  int lod_level_;
+  // The arrays whose buffers are in the chunks.
+  std::vector<py::object> arrays_;
+  std::vector<char> staging_;
+  // The indices of the chunks in the staging buffer and their offsets.
+  std::vector<size_t> staging_chunks_;
+  std::vector<size_t> staging_offsets_;
+};
+
+}  // namespace
+
+void BindBatchAssembler(py::module* m) {
+  py::class_<BatchAssembler>(*m, "BatchAssembler", R"DOC(
+    Convert the slots of a batch into LoDTensors. A slot is a list of the
+    samples' data of a variable, each is a nested sequence or a numpy array
+    of lod_level levels over the items of the variable. Calling assemble
+    returns the list of the LoDTensors of the slots.
+
+    The data for a CUDAPlace is staged in pinned memory with
+    use_pinned_memory, the slots are copied by up to num_threads threads.
+    )DOC")
+      .def("__init__",
+           [](BatchAssembler& self, const platform::CPUPlace& place,
+              bool use_pinned_memory, int num_threads) {
+             new (&self) BatchAssembler(place, use_pinned_memory, num_threads);
+           },
+           py::arg("place"), py::arg("use_pinned_memory") = false,
+           py::arg("num_threads") = 1)
+      .def("__init__",
+           [](BatchAssembler& self, const platform::CUDAPlace& place,
+              bool use_pinned_memory, int num_threads) {
+             new (&self) BatchAssembler(place, use_pinned_memory, num_threads);
+           },
+           py::arg("place"), py::arg("use_pinned_memory") = false,
+           py::arg("num_threads") = 1)
+      .def("__init__",
+           [](BatchAssembler& self, const platform::CUDAPinnedPlace& place,
+              bool use_pinned_memory, int num_threads) {
+             new (&self) BatchAssembler(place, use_pinned_memory, num_threads);
+           },
+           py::arg("place"), py::arg("use_pinned_memory") = false,
+           py::arg("num_threads") = 1)
+      .def("assemble",
+           [](const BatchAssembler& self, const py::list& slots,
+              const std::vector<int>& lod_levels,
+              const std::vector<std::vector<int64_t>>& shapes,
+              const std::vector<VarType::Type>& dtypes) {
+             PADDLE_ENFORCE(slots.size() == lod_levels.size() &&
+                                slots.size() == shapes.size() &&
+                                slots.size() == dtypes.size(),
+                            "Each slot should have a lod_level, a shape and "
+                            "a dtype");
+             // The walkers hold the buffers until the tensors are copied.
+             std::vector<std::unique_ptr<SlotWalker>> walkers;
+             std::vector<SlotData> data;
+             for (size_t i = 0; i < slots.size(); ++i) {
+               walkers.emplace_back(
+                   new SlotWalker(dtypes[i], lod_levels[i], shapes[i]));
+               walkers.back()->Walk(slots[i]);
+               data.push_back(walkers.back()->slot());
+             }
+             std::vector<framework::LoDTensor> tensors;
+             {
+               py::gil_scoped_release release;
+               tensors = self.Assemble(data);
+             }
+             py::list ret;
+             for (auto& t : tensors) {
+               ret.append(py::cast(std::move(t)));
+             }
+             return ret;
+           },
+           py::arg("slots"), py::arg("lod_levels"), py::arg("shapes"),
+           py::arg("dtypes"));
+}
+
+}  // namespace pybind
+}  // namespace paddle
@@ -28,19 +28,28 @@ limitations under the License. */
 #include "paddle/fluid/framework/lod_rank_table.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/lod_tensor_array.h"
+#include "paddle/fluid/framework/op_phase_profiler.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/parallel_executor.h"
+#include "paddle/fluid/framework/pipeline_executor.h"
 #include "paddle/fluid/framework/prune.h"
 #include "paddle/fluid/framework/reader.h"
 #include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/framework/version.h"
+#include "paddle/fluid/memory/memory_profiler.h"
 #include "paddle/fluid/operators/activation_op.h"
 #include "paddle/fluid/operators/reader/lod_tensor_blocking_queue.h"
+#ifndef _WIN32
+#include "paddle/fluid/operators/reader/shared_memory_queue.h"
+#endif
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/init.h"
 #include "paddle/fluid/platform/place.h"
 #include "paddle/fluid/platform/profiler.h"
+#include "paddle/fluid/platform/sampling_profiler.h"
+#include "paddle/fluid/pybind/async_run.h"
 #include "paddle/fluid/pybind/const_value.h"
+#include "paddle/fluid/pybind/data_feeder.h"
 #include "paddle/fluid/pybind/exception.h"
 #include "paddle/fluid/pybind/protobuf.h"
 #include "paddle/fluid/pybind/pybind.h"  // NOLINT
@@ -94,6 +103,8 @@ PYBIND11_PLUGIN(core) {
   py::class_<Tensor>(m, "Tensor", py::buffer_protocol())
       .def_buffer(
           [](Tensor &self) -> py::buffer_info { return CastToPyBuffer(self); })
+      .def("_is_initialized",
+           [](const Tensor &self) { return self.IsInitialized(); })
       .def("_get_dims",
            [](const Tensor &self) { return vectorize(self.dims()); })
       .def("_set_dims",
@@ -128,14 +139,22 @@ PYBIND11_PLUGIN(core) {
            [](Tensor &self, paddle::platform::CUDAPinnedPlace &place) {
              self.mutable_data<float>(place);
            })
-      .def("set", PyCPUTensorSetFromArray<float>)
-      .def("set", PyCPUTensorSetFromArray<int>)
-      .def("set", PyCPUTensorSetFromArray<double>)
-      .def("set", PyCPUTensorSetFromArray<int64_t>)
-      .def("set", PyCPUTensorSetFromArray<bool>)
-      .def("set", PyCPUTensorSetFromArray<uint16_t>)
-      .def("set", PyCPUTensorSetFromArray<uint8_t>)
-      .def("set", PyCPUTensorSetFromArray<int8_t>)
+      .def("set", PyCPUTensorSetFromArray<float>, py::arg("array"),
+           py::arg("place"), py::arg("zero_copy") = false)
+      .def("set", PyCPUTensorSetFromArray<int>, py::arg("array"),
+           py::arg("place"), py::arg("zero_copy") = false)
+      .def("set", PyCPUTensorSetFromArray<double>, py::arg("array"),
+           py::arg("place"), py::arg("zero_copy") = false)
+      .def("set", PyCPUTensorSetFromArray<int64_t>, py::arg("array"),
+           py::arg("place"), py::arg("zero_copy") = false)
+      .def("set", PyCPUTensorSetFromArray<bool>, py::arg("array"),
+           py::arg("place"), py::arg("zero_copy") = false)
+      .def("set", PyCPUTensorSetFromArray<uint16_t>, py::arg("array"),
+           py::arg("place"), py::arg("zero_copy") = false)
+      .def("set", PyCPUTensorSetFromArray<uint8_t>, py::arg("array"),
+           py::arg("place"), py::arg("zero_copy") = false)
+      .def("set", PyCPUTensorSetFromArray<int8_t>, py::arg("array"),
+           py::arg("place"), py::arg("zero_copy") = false)
 #ifdef PADDLE_WITH_CUDA
       .def("set", PyCUDATensorSetFromArray<float>)
       .def("set", PyCUDATensorSetFromArray<int>)
@@ -374,6 +393,36 @@ All parameter, weight, gradient are variables in Paddle.
       .def("close", &LoDTensorBlockingQueue::Close)
       .def("is_closed", &LoDTensorBlockingQueue::IsClosed);
 
+#ifndef _WIN32
+  using SharedMemoryQueue = ::paddle::operators::reader::SharedMemoryQueue;
+  py::class_<SharedMemoryQueue, std::shared_ptr<SharedMemoryQueue>>(
+      m, "SharedMemoryQueue", "")
+      .def(py::init<const std::string &, size_t, size_t>())
+      .def("push",
+           [](SharedMemoryQueue &self,
+              const std::vector<framework::LoDTensor> &lod_tensor_vec) {
+             pybind11::gil_scoped_release release;
+             return self.Push(lod_tensor_vec);
+           })
+      .def("forward_to",
+           [](SharedMemoryQueue &self, LoDTensorBlockingQueue *queue) {
+             // The batches share the memory of their slots, and are only
+             // moved to the queue of the reader.
+             pybind11::gil_scoped_release release;
+             std::vector<framework::LoDTensor> lod_tensor_vec;
+             while (self.Pop(&lod_tensor_vec) &&
+                    queue->Push(std::move(lod_tensor_vec))) {
+             }
+             queue->Close();
+           })
+      .def("reopen", &SharedMemoryQueue::ReOpen)
+      .def("writer_done", &SharedMemoryQueue::WriterDone)
+      .def("size", &SharedMemoryQueue::Size)
+      .def("capacity", &SharedMemoryQueue::Cap)
+      .def("close", &SharedMemoryQueue::Close)
+      .def("is_closed", &SharedMemoryQueue::IsClosed);
+#endif
+
   m.def("init_lod_tensor_blocking_queue",
         [](Variable &var, size_t capacity,
            const std::vector<std::vector<int64_t>> &shapes)
@@ -551,11 +600,34 @@ All parameter, weight, gradient are variables in Paddle.
   py::class_<framework::Executor>(m, "Executor")
       .def(py::init<const platform::Place &>())
       .def("close", &Executor::Close)
-      .def("run", [](Executor &self, const ProgramDesc &prog, Scope *scope,
-                     int block_id, bool create_local_scope, bool create_vars) {
-        pybind11::gil_scoped_release release;
-        self.Run(prog, scope, block_id, create_local_scope, create_vars);
-      });
+      .def("run",
+           [](Executor &self, const ProgramDesc &prog, Scope *scope,
+              int block_id, bool create_local_scope, bool create_vars,
+              bool use_prepared_cache) {
+             pybind11::gil_scoped_release release;
+             self.Run(prog, scope, block_id, create_local_scope, create_vars,
+                      use_prepared_cache);
+           },
+           py::arg("prog"), py::arg("scope"), py::arg("block_id"),
+           py::arg("create_local_scope"), py::arg("create_vars"),
+           py::arg("use_prepared_cache") = false)
+      .def("run_async",
+           [](Executor &self, const ProgramDesc &prog, Scope *scope,
+              const std::string &fetch_var_name, size_t fetch_count,
+              bool use_prepared_cache) {
+             return new RunHandle([&self, &prog, scope, fetch_var_name,
+                                   fetch_count, use_prepared_cache] {
+               self.Run(prog, scope, 0, true, true, use_prepared_cache);
+               FeedFetchList fetched;
+               for (size_t i = 0; i < fetch_count; ++i) {
+                 fetched.push_back(GetFetchVariable(*scope, fetch_var_name, i));
+               }
+               return fetched;
+             });
+           },
+           py::keep_alive<0, 1>(), py::keep_alive<0, 2>(),
+           py::keep_alive<0, 3>())
+      .def("drop_prepared_contexts", &Executor::DropPreparedContexts);
 
   m.def("init_gflags", framework::InitGflags);
   m.def("init_glog", framework::InitGLOG);
@@ -642,6 +714,19 @@ All parameter, weight, gradient are variables in Paddle.
   m.def("disable_profiler", platform::DisableProfiler);
   m.def("is_profiler_enabled", platform::IsProfileEnabled);
   m.def("reset_profiler", platform::ResetProfiler);
+  m.def("set_sampling_profiler_period", platform::SetSamplingProfilerPeriod);
+  m.def("sampling_profiler_report", platform::SamplingProfilerReport);
+  m.def("reset_sampling_profiler", platform::ResetSamplingProfiler);
+  m.def("enable_memory_profiler", memory::EnableMemoryProfiler);
+  m.def("disable_memory_profiler", memory::DisableMemoryProfiler);
+  m.def("memory_profiler_report", memory::MemoryProfilerReport);
+  m.def("enable_op_phase_profiler", []() {
+    framework::ResetOpPhaseProfiler();
+    FLAGS_profile_op_phases = true;
+  });
+  m.def("disable_op_phase_profiler",
+        []() { FLAGS_profile_op_phases = false; });
+  m.def("op_phase_profiler_report", framework::OpPhaseProfilerReport);
 
   py::class_<ir::Pass, std::shared_ptr<ir::Pass>> pass(m, "Pass");
   pass.def(py::init())
@@ -753,6 +838,59 @@ All parameter, weight, gradient are variables in Paddle.
         self.type_ = experimental ? ExecutionStrategy::kExperimental
                                   : ExecutionStrategy::kDefault;
       });
+  exec_strategy.def_property(
+      "use_priority_scheduling",
+      [](const ExecutionStrategy &self) {
+        return self.use_priority_scheduling_;
+      },
+      [](ExecutionStrategy &self, bool use_priority_scheduling) {
+        self.use_priority_scheduling_ = use_priority_scheduling;
+      },
+      R"DOC(The type is BOOL, only used with use_experimental_executor. If it
+                is true, the ready operators are run in the order of their longest
+                paths to the end of the graph, which are estimated from the run
+                time of the operators, and the communication operators are run
+                first to overlap with the computation. Default False.
+              )DOC");
+  exec_strategy.def_property(
+      "recycle_local_scopes",
+      [](const ExecutionStrategy &self) { return self.recycle_local_scopes_; },
+      [](ExecutionStrategy &self, bool recycle_local_scopes) {
+        self.recycle_local_scopes_ = recycle_local_scopes;
+      },
+      R"DOC(The type is BOOL. If it is true, the local scopes are kept every
+                num_iteration_per_drop_scope iterations, and only their
+                variables are reset in place, which avoids the burst of
+                releasing and allocating the memory. It works best with the
+                eager deletion of the variables. Default False.
+              )DOC");
+  exec_strategy.def_property(
+      "delay_fetch",
+      [](const ExecutionStrategy &self) { return self.delay_fetch_; },
+      [](ExecutionStrategy &self, bool delay_fetch) {
+        self.delay_fetch_ = delay_fetch;
+      },
+      R"DOC(The type is BOOL. If it is true, the fetched variables of a run
+                are copied to the host without blocking the run, and are
+                returned by the next run instead, so fetching e.g. the loss
+                every iteration costs nothing. The first run returns None
+                for each of them, and the last results are returned by one
+                more run. Default False.
+              )DOC");
+  exec_strategy.def_property(
+      "use_work_stealing_executor",
+      [](const ExecutionStrategy &self) {
+        return self.type_ == ExecutionStrategy::kWorkStealing;
+      },
+      [](ExecutionStrategy &self, bool work_stealing) {
+        self.type_ = work_stealing ? ExecutionStrategy::kWorkStealing
+                                   : ExecutionStrategy::kDefault;
+      },
+      R"DOC(The type is BOOL, if it is true, the ready operators are run by
+                workers with their own lock-free deques, which steal the
+                operators from each other when idle. It reduces the contention
+                of dispatching operators with many threads. Default False.
+              )DOC");
 
   py::class_<BuildStrategy> build_strategy(pe, "BuildStrategy", R"DOC(
     BuildStrategy allows the user to more preciously control how to
@@ -821,6 +959,28 @@ All parameter, weight, gradient are variables in Paddle.
           [](BuildStrategy &self, bool b) {
             self.enable_data_balance_ = b;
           })  // FIXME(chengudo): enable_data_balance seems not important
+      .def_property(
+          "overlap_broadcast",
+          [](const BuildStrategy &self) { return self.overlap_broadcast_; },
+          [](BuildStrategy &self, bool b) { self.overlap_broadcast_ = b; },
+          R"DOC(The type is BOOL, if set True in Reduce strategy on GPUs, the
+                parameters optimized on a device are broadcast to the others
+                at the beginning of the next iteration, in the order the
+                forward ops read them, so the broadcasts overlap the forward
+                computation. The parameters on the other devices are one
+                iteration behind until ParallelExecutor.sync_deferred_broadcasts
+                is called, e.g. before saving them. Default False.)DOC")
+      .def_property(
+          "data_balance_by_tokens",
+          [](const BuildStrategy &self) {
+            return self.data_balance_by_tokens_;
+          },
+          [](BuildStrategy &self, bool b) { self.data_balance_by_tokens_ = b; },
+          R"DOC(The type is BOOL, if set True, the data balance moves the
+                sequences so that the devices get about the same number of
+                tokens, the elements of the last LoD level, instead of the
+                same number of the sequences. It only works when
+                enable_data_balance is True. Default False.)DOC")
       .def_property(
           "enable_sequential_execution",
           [](const BuildStrategy &self) {
@@ -839,6 +999,19 @@ All parameter, weight, gradient are variables in Paddle.
             self.remove_unnecessary_lock_ = b;
           },
           R"DOC(The type is BOOL. If set True, some locks in GPU ops would be released and ParallelExecutor would run faster. Default False.)DOC")
+      .def_property(
+          "num_compute_streams",
+          [](const BuildStrategy &self) { return self.num_compute_streams_; },
+          [](BuildStrategy &self, size_t num_streams) {
+            PADDLE_ENFORCE_GE(num_streams, 1UL,
+                              "num_compute_streams should be at least 1.");
+            self.num_compute_streams_ = num_streams;
+          },
+          R"DOC(The type is INT. If it is larger than 1, the independent
+                     chains of ops on each GPU, e.g. the branches of an
+                     Inception block, run on up to num_compute_streams CUDA
+                     streams. It needs FLAGS_use_stream_ordered_allocator
+                     and does not work with the eager deletion. Default 1.)DOC")
       .def_property(
           "fuse_elewise_add_act_ops",
           [](const BuildStrategy &self) {
@@ -850,6 +1023,78 @@ All parameter, weight, gradient are variables in Paddle.
           R"DOC(The type is BOOL, fuse_elewise_add_act_ops indicate whether
                      to fuse elementwise_add_op and activation_op,
                      it may make the execution faster. Default False)DOC")
+      .def_property(
+          "fuse_all_reduce_ops",
+          [](const BuildStrategy &self) { return self.fuse_all_reduce_ops_; },
+          [](BuildStrategy &self, bool b) { self.fuse_all_reduce_ops_ = b; },
+          R"DOC(The type is BOOL. If set True, the dense gradients are all reduced
+                together in buckets instead of one by one, which launches fewer
+                NCCL calls. It only works in AllReduce mode. Default False.)DOC")
+      .def_property(
+          "fuse_all_reduce_bucket_size",
+          [](const BuildStrategy &self) {
+            return self.fuse_all_reduce_bucket_size_;
+          },
+          [](BuildStrategy &self, size_t size) {
+            PADDLE_ENFORCE_GT(size, 0,
+                              "fuse_all_reduce_bucket_size should be > 0.");
+            self.fuse_all_reduce_bucket_size_ = size;
+          },
+          R"DOC(The type is INT. The bytes of the gradients that are all reduced
+                together when fuse_all_reduce_ops is True. Default 32MB.)DOC")
+      .def_property(
+          "fuse_dropout_add_ops",
+          [](const BuildStrategy &self) { return self.fuse_dropout_add_ops_; },
+          [](BuildStrategy &self, bool b) { self.fuse_dropout_add_ops_ = b; },
+          R"DOC(The type is BOOL. If set True, a dropout whose output is
+                only added to a tensor of the same shape, like the residual
+                connections, is fused with the add, and so are their grads,
+                which saves the memory and the bandwidth of the dropout
+                output. Default False.)DOC")
+      .def_property(
+          "fuse_optimizer_ops",
+          [](const BuildStrategy &self) { return self.fuse_optimizer_ops_; },
+          [](BuildStrategy &self, bool b) { self.fuse_optimizer_ops_ = b; },
+          R"DOC(The type is BOOL. If set True, the sgd, momentum, lars_momentum
+                and adam ops of the dense gradients are fused into the
+                multi-tensor optimizer ops, which update many parameters in
+                a kernel launch. It does not work in Reduce mode.
+                Default False.)DOC")
+      .def_property(
+          "num_accumulation_steps",
+          [](const BuildStrategy &self) {
+            return self.num_accumulation_steps_;
+          },
+          [](BuildStrategy &self, size_t steps) {
+            PADDLE_ENFORCE_GT(steps, 0,
+                              "num_accumulation_steps should be > 0.");
+            self.num_accumulation_steps_ = steps;
+          },
+          R"DOC(The type is INT. If it is greater than 1, each run computes the
+                dense gradients of one micro-batch and sums them into the
+                persistable buffers, and the all reduce and the optimize ops
+                are only run, with the averaged gradients, in every
+                num_accumulation_steps runs. It works like a batch
+                num_accumulation_steps times larger without copying the
+                graph. Default 1.)DOC")
+      .def_property(
+          "use_hierarchical_allreduce",
+          [](const BuildStrategy &self) {
+            return self.use_hierarchical_allreduce_;
+          },
+          [](BuildStrategy &self, bool b) {
+            self.use_hierarchical_allreduce_ = b;
+          },
+          R"DOC(The type is BOOL. If set True and there are more than one trainers
+                in nccl2 mode, the gradients are reduced inside each trainer first,
+                then all reduced across the trainers, which uses the inter-node
+                bandwidth better. The program should be transpiled with
+                DistributeTranspilerConfig.use_hierarchical_allreduce. Default False.)DOC")
+      .def("load_collective_config", &BuildStrategy::LoadCollectiveConfig,
+           R"DOC(Set reduce_strategy, fuse_all_reduce_ops and
+                fuse_all_reduce_bucket_size from the config file written by
+                the collective_benchmark tool, which measures the NCCL
+                collectives of the devices and picks the fastest settings.)DOC")
       .def("_create_passes_from_strategy",
            [](BuildStrategy &self) -> std::shared_ptr<ir::PassBuilder> {
              return self.CreatePassesFromStrategy();
@@ -874,7 +1119,37 @@ All parameter, weight, gradient are variables in Paddle.
            &ParallelExecutor::FeedTensorsIntoLocalScopes)
       .def("feed_and_split_tensor_into_local_scopes",
            &ParallelExecutor::FeedAndSplitTensorIntoLocalScopes)
-      .def("run", [](ParallelExecutor &self,
+      .def("run",
+           [](ParallelExecutor &self,
+              const std::vector<std::string> &fetch_tensors,
+              const std::string &fetched_var_name) {
+             pybind11::gil_scoped_release release;
+             self.Run(fetch_tensors, fetched_var_name);
+           })
+      .def("run_async",
+           [](ParallelExecutor &self,
+              const std::vector<std::string> &fetch_tensors,
+              const std::string &fetched_var_name, Scope *scope) {
+             return new RunHandle(
+                 [&self, fetch_tensors, fetched_var_name, scope] {
+                   self.Run(fetch_tensors, fetched_var_name);
+                   return scope->FindVar(fetched_var_name)
+                       ->Get<FeedFetchList>();
+                 });
+           },
+           py::keep_alive<0, 1>(), py::keep_alive<0, 4>())
+      .def("sync_deferred_broadcasts",
+           [](ParallelExecutor &self) {
+             pybind11::gil_scoped_release release;
+             self.SyncDeferredBroadcasts();
+           });
+
+  py::class_<PipelineExecutor>(m, "PipelineExecutor")
+      .def(py::init<const std::vector<platform::Place> &, size_t,
+                    const ProgramDesc &, Scope *, const ExecutionStrategy &>())
+      .def("feed_and_split_tensor_into_micro_batches",
+           &PipelineExecutor::FeedAndSplitTensorIntoMicroBatches)
+      .def("run", [](PipelineExecutor &self,
                      const std::vector<std::string> &fetch_tensors,
                      const std::string &fetched_var_name) {
         pybind11::gil_scoped_release release;
@@ -882,6 +1157,8 @@ All parameter, weight, gradient are variables in Paddle.
       });
 
   BindRecordIOWriter(&m);
+  BindRunHandle(&m);
+  BindBatchAssembler(&m);
   return m.ptr();
 }
 }  // namespace pybind
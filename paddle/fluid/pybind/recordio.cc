@@ -29,10 +29,10 @@ namespace {
 class RecordIOWriter {
  public:
   RecordIOWriter(const std::string& filename, recordio::Compressor compressor,
-                 size_t max_num_record)
+                 size_t max_num_record, const std::string& zstd_dict)
       : closed_(false),
         stream_(filename),
-        writer_(&stream_, compressor, max_num_record) {}
+        writer_(&stream_, compressor, max_num_record, zstd_dict) {}
 
   void AppendTensor(const framework::LoDTensor& tensor) {
     tensors_.push_back(tensor);
@@ -47,7 +47,7 @@ class RecordIOWriter {
 
   void Close() {
     PADDLE_ENFORCE(tensors_.empty());
-    writer_.Flush();
+    writer_.Close();
     stream_.close();
     closed_ = true;
   }
@@ -71,14 +71,20 @@ void BindRecordIOWriter(py::module* m) {
   py::class_<RecordIOWriter> writer(*m, "RecordIOWriter", "");
   py::enum_<recordio::Compressor>(writer, "Compressor", "")
       .value("Snappy", recordio::Compressor::kSnappy)
+      .value("LZ4", recordio::Compressor::kLZ4)
+      .value("Zstd", recordio::Compressor::kZstd)
       .value("NoCompress", recordio::Compressor::kNoCompress);
 
   writer
       .def("__init__",
            [](RecordIOWriter& self, const std::string& filename,
-              recordio::Compressor compressor, size_t max_num_record) {
-             new (&self) RecordIOWriter(filename, compressor, max_num_record);
-           })
+              recordio::Compressor compressor, size_t max_num_record,
+              const std::string& zstd_dict) {
+             new (&self) RecordIOWriter(filename, compressor, max_num_record,
+                                        zstd_dict);
+           },
+           py::arg("filename"), py::arg("compressor"),
+           py::arg("max_num_record"), py::arg("zstd_dict") = "")
       .def("append_tensor", &RecordIOWriter::AppendTensor)
       .def("complete_append_tensor", &RecordIOWriter::CompleteAppendTensor)
       .def("close", &RecordIOWriter::Close);
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 #include <Python.h>
+#include <memory>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -126,12 +127,34 @@ void TensorSetElement(framework::Tensor *self, size_t offset, T elem) {
   }
 }
 
-template <typename T>
-void PyCPUTensorSetFromArray(
+namespace details {
+
+// Keeps obj alive while a tensor uses its buffer. The tensor may be destroyed
+// by any thread, so the reference is released with the GIL held.
+inline std::shared_ptr<void> HoldPyObject(pybind11::object obj) {
+  return std::shared_ptr<void>(
+      new pybind11::object(std::move(obj)), [](void *ptr) {
+        auto *obj = static_cast<pybind11::object *>(ptr);
+        if (Py_IsInitialized()) {
+          pybind11::gil_scoped_acquire acquire;
+          delete obj;
+        } else {
+          // The interpreter is finalized, leak the object.
+          obj->release();
+          delete obj;
+        }
+      });
+}
+
+// PaddleT is the element type of the tensor, the array has the elements of
+// type T of the same size.
+template <typename T, typename PaddleT>
+void CPUTensorSetFromArray(
     framework::Tensor *self,
-    pybind11::array_t<T, pybind11::array::c_style | pybind11::array::forcecast>
-        array,
-    paddle::platform::CPUPlace place) {
+    const pybind11::array_t<
+        T, pybind11::array::c_style | pybind11::array::forcecast> &array,
+    paddle::platform::CPUPlace place, bool zero_copy) {
+  static_assert(sizeof(T) == sizeof(PaddleT), "The element sizes differ");
   std::vector<int64_t> dims;
   dims.reserve(array.ndim());
   for (size_t i = 0; i < array.ndim(); ++i) {
@@ -139,8 +162,31 @@ void PyCPUTensorSetFromArray(
   }
 
   self->Resize(framework::make_ddim(dims));
-  auto *dst = self->mutable_data<T>(place);
-  std::memcpy(dst, array.data(), sizeof(T) * array.size());
+  size_t size = sizeof(T) * array.size();
+  // The array is C-contiguous, forcecast copies it otherwise. Its buffer is
+  // used read-only, the operators writing the tensor copy it first.
+  auto *data = const_cast<T *>(array.data());
+  if (zero_copy && size > 0 &&
+      reinterpret_cast<uintptr_t>(data) % alignof(PaddleT) == 0) {
+    self->ShareExternalData(data, size, typeid(PaddleT), HoldPyObject(array),
+                            true);
+    return;
+  }
+  auto *dst = self->mutable_data<PaddleT>(place);
+  std::memcpy(dst, array.data(), size);
+}
+
+}  // namespace details
+
+// With zero_copy, the tensor uses the buffer of the array, which must not be
+// changed while the tensor is used.
+template <typename T>
+void PyCPUTensorSetFromArray(
+    framework::Tensor *self,
+    pybind11::array_t<T, pybind11::array::c_style | pybind11::array::forcecast>
+        array,
+    paddle::platform::CPUPlace place, bool zero_copy) {
+  details::CPUTensorSetFromArray<T, T>(self, array, place, zero_copy);
 }
 
 template <>
@@ -151,16 +197,9 @@ inline void PyCPUTensorSetFromArray(
     pybind11::array_t<uint16_t,
                       pybind11::array::c_style | pybind11::array::forcecast>
         array,
-    paddle::platform::CPUPlace place) {
-  std::vector<int64_t> dims;
-  dims.reserve(array.ndim());
-  for (size_t i = 0; i < array.ndim(); ++i) {
-    dims.push_back(static_cast<int>(array.shape()[i]));
-  }
-
-  self->Resize(framework::make_ddim(dims));
-  auto *dst = self->mutable_data<platform::float16>(place);
-  std::memcpy(dst, array.data(), sizeof(uint16_t) * array.size());
+    paddle::platform::CPUPlace place, bool zero_copy) {
+  details::CPUTensorSetFromArray<uint16_t, platform::float16>(self, array,
+                                                              place, zero_copy);
 }
 
 #ifdef PADDLE_WITH_CUDA
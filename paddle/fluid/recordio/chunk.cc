@@ -14,8 +14,11 @@
 
 #include "paddle/fluid/recordio/chunk.h"
 
+#include <lz4.h>
 #include <zlib.h>
+#include <zstd.h>
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <sstream>
 
@@ -25,6 +28,7 @@
 namespace paddle {
 namespace recordio {
 constexpr size_t kMaxBufSize = 1024;
+constexpr int kZstdLevel = 3;
 
 /**
  * Read Stream by a fixed sized buffer.
@@ -76,7 +80,74 @@ static uint32_t Crc32Stream(std::istream& in, size_t limit = 0) {
   return crc;
 }
 
-bool Chunk::Write(std::ostream& os, Compressor ct) const {
+static uint32_t Crc32Buffer(const std::string& buf) {
+  uint32_t crc = static_cast<uint32_t>(crc32(0, nullptr, 0));
+  return static_cast<uint32_t>(
+      crc32(crc, reinterpret_cast<const Bytef*>(buf.data()),
+            static_cast<uInt>(buf.size())));
+}
+
+// LZ4 and Zstd compress the records of a chunk as a whole block rather than
+// a stream. The block starts with the uint32 size of the raw records.
+static bool IsBlockCompressor(Compressor ct) {
+  return ct == Compressor::kLZ4 || ct == Compressor::kZstd;
+}
+
+static std::string CompressBlock(Compressor ct, const std::string& zstd_dict,
+                                 const std::string& raw) {
+  uint32_t raw_size = static_cast<uint32_t>(raw.size());
+  std::string block;
+  if (ct == Compressor::kLZ4) {
+    int bound = LZ4_compressBound(static_cast<int>(raw_size));
+    block.resize(sizeof(uint32_t) + bound);
+    int size = LZ4_compress_default(raw.data(), &block[sizeof(uint32_t)],
+                                    static_cast<int>(raw_size), bound);
+    PADDLE_ENFORCE_GT(size, 0, "Failed to compress the chunk by LZ4.");
+    block.resize(sizeof(uint32_t) + size);
+  } else {
+    size_t bound = ZSTD_compressBound(raw_size);
+    block.resize(sizeof(uint32_t) + bound);
+    std::unique_ptr<ZSTD_CCtx, size_t (*)(ZSTD_CCtx*)> cctx(ZSTD_createCCtx(),
+                                                          ZSTD_freeCCtx);
+    size_t size = ZSTD_compress_usingDict(
+        cctx.get(), &block[sizeof(uint32_t)], bound, raw.data(), raw_size,
+        zstd_dict.data(), zstd_dict.size(), kZstdLevel);
+    PADDLE_ENFORCE(!ZSTD_isError(size), "Failed to compress the chunk by %s",
+                   ZSTD_getErrorName(size));
+    block.resize(sizeof(uint32_t) + size);
+  }
+  std::memcpy(&block[0], &raw_size, sizeof(uint32_t));
+  return block;
+}
+
+static std::string DecompressBlock(Compressor ct, const std::string& zstd_dict,
+                                   const std::string& block) {
+  PADDLE_ENFORCE_GE(block.size(), sizeof(uint32_t), "The chunk is truncated.");
+  uint32_t raw_size;
+  std::memcpy(&raw_size, block.data(), sizeof(uint32_t));
+  const char* src = block.data() + sizeof(uint32_t);
+  size_t src_size = block.size() - sizeof(uint32_t);
+  std::string raw(raw_size, '\0');
+  if (ct == Compressor::kLZ4) {
+    int size = LZ4_decompress_safe(src, &raw[0], static_cast<int>(src_size),
+                                   static_cast<int>(raw_size));
+    PADDLE_ENFORCE_EQ(size, static_cast<int>(raw_size),
+                      "Failed to decompress the chunk by LZ4.");
+  } else {
+    std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)> dctx(ZSTD_createDCtx(),
+                                                          ZSTD_freeDCtx);
+    size_t size = ZSTD_decompress_usingDict(dctx.get(), &raw[0], raw_size, src,
+                                            src_size, zstd_dict.data(),
+                                            zstd_dict.size());
+    PADDLE_ENFORCE(!ZSTD_isError(size), "Failed to decompress the chunk by %s",
+                   ZSTD_getErrorName(size));
+    PADDLE_ENFORCE_EQ(size, raw_size, "The chunk is truncated.");
+  }
+  return raw;
+}
+
+bool Chunk::Write(std::ostream& os, Compressor ct,
+                  const std::string& zstd_dict) const {
   // NOTE(dzhwinter): don't check records.numBytes instead, because
   // empty records are allowed.
   if (records_.empty()) {
@@ -90,6 +161,10 @@ bool Chunk::Write(std::ostream& os, Compressor ct) const {
     case Compressor::kSnappy:
       compressed_stream.reset(new snappy::oSnappyStream(sout));
       break;
+    case Compressor::kLZ4:
+    case Compressor::kZstd:
+      compressed_stream.reset(new std::stringstream());
+      break;
     default:
       PADDLE_THROW("Not implemented");
   }
@@ -102,6 +177,11 @@ bool Chunk::Write(std::ostream& os, Compressor ct) const {
         .write(record.data(), record.size());
   }
 
+  if (IsBlockCompressor(ct)) {
+    auto* raw = static_cast<std::stringstream*>(compressed_stream.get());
+    std::string block = CompressBlock(ct, zstd_dict, raw->str());
+    sout.write(block.data(), block.size());
+  }
   if (compressed_stream) {
     compressed_stream.reset();
   }
@@ -118,57 +198,90 @@ bool Chunk::Write(std::ostream& os, Compressor ct) const {
   return true;
 }
 
-bool Chunk::Parse(std::istream& sin) {
-  ChunkParser parser(sin);
+bool Chunk::Parse(std::istream& sin, bool verify_checksum,
+                  const std::string& zstd_dict) {
+  ChunkParser parser(sin, verify_checksum, zstd_dict);
   if (!parser.Init()) {
     return false;
   }
   Clear();
   while (parser.HasNext()) {
-    Add(parser.Next());
+    Add(parser.Next().ToString());
   }
   return true;
 }
 
-ChunkParser::ChunkParser(std::istream& sin) : in_(sin) {}
-bool ChunkParser::Init() {
-  pos_ = 0;
-  bool ok = header_.Parse(in_);
-  if (!ok) {
-    return ok;
+DecodedChunk::DecodedChunk(std::string&& buffer, uint32_t num_records)
+    : buffer_(std::move(buffer)), num_records_(num_records) {}
+
+string::Piece DecodedChunk::Next() {
+  if (!HasNext()) {
+    return string::Piece();
   }
-  auto beg_pos = in_.tellg();
-  uint32_t crc = Crc32Stream(in_, header_.CompressSize());
-  PADDLE_ENFORCE_EQ(header_.Checksum(), crc);
-  in_.seekg(beg_pos, in_.beg);
+  ++pos_;
+  uint32_t rec_len;
+  PADDLE_ENFORCE_LE(offset_ + sizeof(uint32_t), buffer_.size(),
+                    "The chunk is truncated.");
+  std::memcpy(&rec_len, buffer_.data() + offset_, sizeof(uint32_t));
+  offset_ += sizeof(uint32_t);
+  PADDLE_ENFORCE_LE(offset_ + rec_len, buffer_.size(),
+                    "The chunk is truncated.");
+  string::Piece record(buffer_.data() + offset_, rec_len);
+  offset_ += rec_len;
+  return record;
+}
 
-  switch (header_.CompressType()) {
-    case Compressor::kNoCompress:
-      break;
-    case Compressor::kSnappy:
-      compressed_stream_.reset(new snappy::iSnappyStream(in_));
-      break;
-    default:
-      PADDLE_THROW("Not implemented");
+ChunkParser::ChunkParser(std::istream& sin, bool verify_checksum,
+                         const std::string& zstd_dict)
+    : in_(sin), verify_checksum_(verify_checksum), zstd_dict_(zstd_dict) {}
+
+bool ChunkParser::Init() {
+  Header header;
+  std::string payload;
+  if (!ReadRawChunk(in_, &header, &payload)) {
+    chunk_ = DecodedChunk();
+    return false;
   }
+  chunk_ = DecodeChunk(header, std::move(payload), verify_checksum_,
+                       zstd_dict_);
   return true;
 }
 
-bool ChunkParser::HasNext() const { return pos_ < header_.NumRecords(); }
+bool ReadRawChunk(std::istream& in, Header* header, std::string* payload) {
+  if (!header->Parse(in)) {
+    return false;
+  }
+  payload->resize(header->CompressSize());
+  in.read(&(*payload)[0], payload->size());
+  PADDLE_ENFORCE_EQ(static_cast<size_t>(in.gcount()), payload->size(),
+                    "The chunk is truncated.");
+  return true;
+}
 
-std::string ChunkParser::Next() {
-  if (!HasNext()) {
-    return "";
+DecodedChunk DecodeChunk(const Header& header, std::string payload,
+                         bool verify_checksum, const std::string& zstd_dict) {
+  if (verify_checksum) {
+    PADDLE_ENFORCE_EQ(header.Checksum(), Crc32Buffer(payload));
+  }
+  switch (header.CompressType()) {
+    case Compressor::kNoCompress:
+      // The payload is the records themselves.
+      return DecodedChunk(std::move(payload), header.NumRecords());
+    case Compressor::kSnappy: {
+      std::istringstream source(payload);
+      snappy::iSnappyStream in(source);
+      std::ostringstream raw;
+      PipeStream(in, raw);
+      return DecodedChunk(raw.str(), header.NumRecords());
+    }
+    case Compressor::kLZ4:
+    case Compressor::kZstd:
+      return DecodedChunk(
+          DecompressBlock(header.CompressType(), zstd_dict, payload),
+          header.NumRecords());
+    default:
+      PADDLE_THROW("Not implemented");
   }
-  ++pos_;
-  std::istream& stream = compressed_stream_ ? *compressed_stream_ : in_;
-  uint32_t rec_len;
-  stream.read(reinterpret_cast<char*>(&rec_len), sizeof(uint32_t));
-  std::string buf;
-  buf.resize(rec_len);
-  stream.read(&buf[0], rec_len);
-  PADDLE_ENFORCE_EQ(rec_len, stream.gcount());
-  return buf;
 }
 }  // namespace recordio
 }  // namespace paddle
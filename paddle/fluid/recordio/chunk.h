@@ -19,6 +19,7 @@
 
 #include "paddle/fluid/platform/macros.h"
 #include "paddle/fluid/recordio/header.h"
+#include "paddle/fluid/string/piece.h"
 
 namespace paddle {
 namespace recordio {
@@ -32,15 +33,17 @@ class Chunk {
     records_.emplace_back(buf);
   }
   // dump the chunk into w, and clears the chunk and makes it ready for
-  // the next add invocation.
-  bool Write(std::ostream& fo, Compressor ct) const;
+  // the next add invocation. The zstd_dict is only used by kZstd.
+  bool Write(std::ostream& fo, Compressor ct,
+             const std::string& zstd_dict = "") const;
   void Clear() {
     records_.clear();
     num_bytes_ = 0;
   }
 
   // returns true if ok, false if eof
-  bool Parse(std::istream& sin);
+  bool Parse(std::istream& sin, bool verify_checksum = true,
+             const std::string& zstd_dict = "");
   size_t NumBytes() const { return num_bytes_; }
   size_t NumRecords() const { return records_.size(); }
   const std::string& Record(int i) const { return records_[i]; }
@@ -54,20 +57,53 @@ class Chunk {
   DISABLE_COPY_AND_ASSIGN(Chunk);
 };
 
+// The decompressed records of a chunk in one buffer, each of which is the
+// uint32 size followed by the bytes. The records are handed out as the views
+// into the buffer, which are valid as long as the DecodedChunk is.
+class DecodedChunk {
+ public:
+  DecodedChunk() = default;
+  DecodedChunk(std::string&& buffer, uint32_t num_records);
+
+  bool HasNext() const { return pos_ < num_records_; }
+  string::Piece Next();
+
+ private:
+  std::string buffer_;
+  uint32_t num_records_{0};
+  uint32_t pos_{0};
+  size_t offset_{0};
+};
+
 class ChunkParser {
  public:
-  explicit ChunkParser(std::istream& sin);
+  // The CRC32 of the chunks is not checked if verify_checksum is false, and
+  // the chunks compressed by kZstd are decompressed with the zstd_dict they
+  // were written with.
+  explicit ChunkParser(std::istream& sin, bool verify_checksum = true,
+                       const std::string& zstd_dict = "");
 
+  // Read and decompress the next chunk, returns false if eof.
   bool Init();
-  std::string Next();
-  bool HasNext() const;
+  // The record is valid until the next Init.
+  string::Piece Next() { return chunk_.Next(); }
+  bool HasNext() const { return chunk_.HasNext(); }
 
  private:
-  Header header_;
-  uint32_t pos_{0};
   std::istream& in_;
-  std::unique_ptr<std::istream> compressed_stream_;
+  bool verify_checksum_;
+  std::string zstd_dict_;
+  DecodedChunk chunk_;
 };
 
+// Read the header and the compressed payload of the next chunk without
+// decoding it, returns false if eof.
+bool ReadRawChunk(std::istream& in, Header* header, std::string* payload);
+
+// Check and decompress the payload read by ReadRawChunk. It does not touch
+// any stream, so the chunks could be decoded on the other threads.
+DecodedChunk DecodeChunk(const Header& header, std::string payload,
+                         bool verify_checksum, const std::string& zstd_dict);
+
 }  // namespace recordio
 }  // namespace paddle
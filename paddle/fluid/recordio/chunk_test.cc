@@ -15,6 +15,8 @@
 #include "paddle/fluid/recordio/chunk.h"
 
 #include <sstream>
+#include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -45,3 +47,45 @@ TEST(Chunk, Compressor) {
   ch.Parse(ss);
   ASSERT_EQ(ch.NumBytes(), 18ul);
 }
+
+TEST(Chunk, BlockCompressor) {
+  std::string dict = "0123456789012345678901234567890123456789";
+  for (auto ct : {paddle::recordio::Compressor::kLZ4,
+                  paddle::recordio::Compressor::kZstd}) {
+    paddle::recordio::Chunk ch;
+    ch.Add(std::string(100, 'a'));
+    ch.Add("");
+    ch.Add("0123456789");
+    std::stringstream ss;
+    ch.Write(ss, ct, dict);
+    ASSERT_LE(ss.tellp(), 100);
+
+    paddle::recordio::Chunk parsed;
+    ASSERT_TRUE(parsed.Parse(ss, true, dict));
+    ASSERT_EQ(parsed.NumRecords(), 3UL);
+    ASSERT_EQ(parsed.Record(0), std::string(100, 'a'));
+    ASSERT_EQ(parsed.Record(1), "");
+    ASSERT_EQ(parsed.Record(2), "0123456789");
+  }
+}
+
+TEST(Chunk, DecodeChunk) {
+  paddle::recordio::Chunk ch;
+  ch.Add("12345");
+  ch.Add("123");
+  std::stringstream ss;
+  ch.Write(ss, paddle::recordio::Compressor::kSnappy);
+
+  paddle::recordio::Header header;
+  std::string payload;
+  ASSERT_TRUE(paddle::recordio::ReadRawChunk(ss, &header, &payload));
+  auto chunk = paddle::recordio::DecodeChunk(header, payload, true, "");
+  // the records are the views into one buffer of the chunk
+  auto first = chunk.Next();
+  auto second = chunk.Next();
+  ASSERT_EQ(first, "12345");
+  ASSERT_EQ(second, "123");
+  ASSERT_EQ(first.data() + first.len() + sizeof(uint32_t), second.data());
+  ASSERT_FALSE(chunk.HasNext());
+  ASSERT_FALSE(paddle::recordio::ReadRawChunk(ss, &header, &payload));
+}
@@ -37,6 +37,15 @@ bool Header::Parse(std::istream& is) {
   if (read_size < sizeof(uint32_t)) {
     return false;
   }
+  if (magic == kIndexMagicNumber) {
+    // skip the (offset, num_records) of the chunks and the trailer
+    uint32_t num_chunks;
+    is.read(reinterpret_cast<char*>(&num_chunks), sizeof(uint32_t));
+    is.ignore(static_cast<std::streamsize>(num_chunks) *
+                  (sizeof(uint64_t) + sizeof(uint32_t)) +
+              sizeof(uint64_t) + sizeof(uint32_t));
+    return Parse(is);
+  }
   PADDLE_ENFORCE_EQ(magic, kMagicNumber);
 
   is.read(reinterpret_cast<char*>(&num_records_), sizeof(uint32_t))
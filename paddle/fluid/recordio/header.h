@@ -21,6 +21,8 @@ namespace recordio {
 
 // MagicNumber for memory checking
 constexpr uint32_t kMagicNumber = 0x01020304;
+// The magic number of the chunk index at the end of a file, see index.h.
+constexpr uint32_t kIndexMagicNumber = 0x04030201;
 
 enum class Compressor : uint32_t {
   // NoCompression means writing raw chunk data into files.
@@ -33,6 +35,13 @@ enum class Compressor : uint32_t {
   // Gzip is a well-known compression algorithm.  It is
   // recommmended only you are looking for compression ratio.
   kGzip = 2,
+  // LZ4 decompresses several times faster than Snappy at a similar
+  // compression ratio.
+  kLZ4 = 3,
+  // Zstd compresses close to Gzip and decompresses much faster.  It
+  // could take a dictionary trained on the records, which helps the
+  // small records a lot.
+  kZstd = 4,
 };
 
 // Header is the metadata of Chunk
@@ -43,7 +52,7 @@ class Header {
 
   void Write(std::ostream& os) const;
 
-  // returns true if OK, false if eof
+  // returns true if OK, false if eof. The chunk index is skipped.
   bool Parse(std::istream& is);
 
   uint32_t NumRecords() const { return num_records_; }
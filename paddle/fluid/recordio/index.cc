@@ -0,0 +1,77 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/recordio/index.h"
+
+namespace paddle {
+namespace recordio {
+
+constexpr std::streamoff kTrailerSize = sizeof(uint64_t) + sizeof(uint32_t);
+
+void Index::Write(std::ostream& os, uint64_t offset) const {
+  uint32_t num_chunks = static_cast<uint32_t>(offsets_.size());
+  os.write(reinterpret_cast<const char*>(&kIndexMagicNumber), sizeof(uint32_t))
+      .write(reinterpret_cast<const char*>(&num_chunks), sizeof(uint32_t));
+  for (size_t i = 0; i < offsets_.size(); ++i) {
+    os.write(reinterpret_cast<const char*>(&offsets_[i]), sizeof(uint64_t))
+        .write(reinterpret_cast<const char*>(&num_records_[i]),
+               sizeof(uint32_t));
+  }
+  os.write(reinterpret_cast<const char*>(&offset), sizeof(uint64_t))
+      .write(reinterpret_cast<const char*>(&kIndexMagicNumber),
+             sizeof(uint32_t));
+}
+
+bool Index::Load(std::istream& is) {
+  offsets_.clear();
+  num_records_.clear();
+  is.clear();
+  is.seekg(0, std::ios::end);
+  std::streamoff size = is.tellg();
+  if (size < kTrailerSize) {
+    return false;
+  }
+  uint64_t offset;
+  uint32_t magic;
+  is.seekg(size - kTrailerSize, std::ios::beg);
+  is.read(reinterpret_cast<char*>(&offset), sizeof(uint64_t))
+      .read(reinterpret_cast<char*>(&magic), sizeof(uint32_t));
+  if (!is || magic != kIndexMagicNumber ||
+      offset >= static_cast<uint64_t>(size)) {
+    return false;
+  }
+
+  uint32_t num_chunks;
+  is.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+  is.read(reinterpret_cast<char*>(&magic), sizeof(uint32_t))
+      .read(reinterpret_cast<char*>(&num_chunks), sizeof(uint32_t));
+  if (!is || magic != kIndexMagicNumber) {
+    return false;
+  }
+  offsets_.resize(num_chunks);
+  num_records_.resize(num_chunks);
+  for (uint32_t i = 0; i < num_chunks; ++i) {
+    is.read(reinterpret_cast<char*>(&offsets_[i]), sizeof(uint64_t))
+        .read(reinterpret_cast<char*>(&num_records_[i]), sizeof(uint32_t));
+  }
+  if (!is) {
+    offsets_.clear();
+    num_records_.clear();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace recordio
+}  // namespace paddle
@@ -0,0 +1,59 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <sstream>
+#include <vector>
+
+#include "paddle/fluid/recordio/header.h"
+
+namespace paddle {
+namespace recordio {
+
+/*
+ * The index of the chunks, appended to the end of a file by Writer::Close.
+ *
+ *   kIndexMagicNumber, num_chunks (uint32)
+ *   offset (uint64), num_records (uint32) of each chunk
+ *   offset of the index (uint64), kIndexMagicNumber
+ *
+ * The fixed-size trailer locates the index from the end of the file, and the
+ * leading magic number lets a sequential reader skip it.
+ */
+class Index {
+ public:
+  void Add(uint64_t offset, uint32_t num_records) {
+    offsets_.push_back(offset);
+    num_records_.push_back(num_records);
+  }
+
+  // offset is where the index is written.
+  void Write(std::ostream& os, uint64_t offset) const;
+
+  // Load the index from the end of a seekable stream, returns false if there
+  // is no index. The position of the stream is not restored.
+  bool Load(std::istream& is);
+
+  size_t NumChunks() const { return offsets_.size(); }
+  uint64_t ChunkOffset(size_t i) const { return offsets_[i]; }
+  uint32_t NumRecords(size_t i) const { return num_records_[i]; }
+
+ private:
+  std::vector<uint64_t> offsets_;
+  std::vector<uint32_t> num_records_;
+};
+
+}  // namespace recordio
+}  // namespace paddle
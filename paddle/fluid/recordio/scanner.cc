@@ -14,42 +14,118 @@
 
 #include "paddle/fluid/recordio/scanner.h"
 
+#include <algorithm>
 #include <string>
+#include <utility>
 
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
 namespace recordio {
 
-Scanner::Scanner(std::unique_ptr<std::istream> &&stream)
-    : stream_(std::move(stream)), parser_(*stream_) {
+Scanner::Scanner(std::unique_ptr<std::istream> &&stream,
+                 const ScannerOptions &options)
+    : options_(options), stream_(std::move(stream)) {
+  if (options_.num_decode_threads > 0) {
+    pool_.reset(new ::ThreadPool(options_.num_decode_threads));
+  }
+  LoadIndex();
   Reset();
 }
 
-Scanner::Scanner(const std::string &filename)
-    : stream_(new std::ifstream(filename)), parser_(*stream_) {
+Scanner::Scanner(const std::string &filename, const ScannerOptions &options)
+    : options_(options), stream_(new std::ifstream(filename)) {
   PADDLE_ENFORCE(static_cast<bool>(*stream_), "Cannot open file %s", filename);
+  if (options_.num_decode_threads > 0) {
+    pool_.reset(new ::ThreadPool(options_.num_decode_threads));
+  }
+  LoadIndex();
   Reset();
 }
 
+void Scanner::LoadIndex() { has_index_ = index_.Load(*stream_); }
+
 void Scanner::Reset() {
   stream_->clear();
   stream_->seekg(0, std::ios::beg);
-  parser_.Init();
+  StartReading();
 }
 
-std::string Scanner::Next() {
-  if (stream_->eof()) {
-    return "";
+void Scanner::StartReading() {
+  // The chunks being decoded are dropped, and their tasks only touch the
+  // copies of the payloads.
+  pending_.clear();
+  stream_end_ = false;
+  chunk_ = DecodedChunk();
+  has_next_chunk_ = FetchChunk(&next_chunk_);
+}
+
+void Scanner::Prefetch() {
+  size_t num_prefetch =
+      static_cast<size_t>(std::max(options_.num_prefetch_chunks, 1));
+  while (!stream_end_ && pending_.size() < num_prefetch) {
+    Header header;
+    std::shared_ptr<std::string> payload(new std::string());
+    if (!ReadRawChunk(*stream_, &header, payload.get())) {
+      stream_end_ = true;
+      break;
+    }
+    bool verify_checksum = options_.verify_checksum;
+    // The pool is destroyed before options_, so the dictionary outlives
+    // the tasks.
+    const std::string *zstd_dict = &options_.zstd_dict;
+    pending_.emplace_back(
+        pool_->enqueue([header, payload, verify_checksum, zstd_dict] {
+          return DecodeChunk(header, std::move(*payload), verify_checksum,
+                             *zstd_dict);
+        }));
   }
+}
 
-  auto res = parser_.Next();
-  if (!parser_.HasNext() && HasNext()) {
-    parser_.Init();
+bool Scanner::FetchChunk(DecodedChunk *chunk) {
+  do {
+    if (pool_) {
+      Prefetch();
+      if (pending_.empty()) {
+        return false;
+      }
+      *chunk = pending_.front().get();
+      pending_.pop_front();
+      Prefetch();
+    } else {
+      Header header;
+      std::string payload;
+      if (!ReadRawChunk(*stream_, &header, &payload)) {
+        return false;
+      }
+      *chunk = DecodeChunk(header, std::move(payload),
+                           options_.verify_checksum, options_.zstd_dict);
+    }
+  } while (!chunk->HasNext());
+  return true;
+}
+
+string::Piece Scanner::Next() {
+  if (!chunk_.HasNext()) {
+    if (!has_next_chunk_) {
+      return string::Piece();
+    }
+    std::swap(chunk_, next_chunk_);
+    has_next_chunk_ = FetchChunk(&next_chunk_);
   }
-  return res;
+  return chunk_.Next();
 }
 
-bool Scanner::HasNext() const { return !stream_->eof(); }
+bool Scanner::HasNext() const { return chunk_.HasNext() || has_next_chunk_; }
+
+void Scanner::Seek(size_t chunk_id) {
+  PADDLE_ENFORCE(has_index_, "The file has no chunk index to seek.");
+  PADDLE_ENFORCE_LT(chunk_id, index_.NumChunks(), "The chunk is out of range.");
+  stream_->clear();
+  stream_->seekg(static_cast<std::streamoff>(index_.ChunkOffset(chunk_id)),
+                 std::ios::beg);
+  StartReading();
+  PADDLE_ENFORCE(HasNext(), "Cannot parse the chunk %d.", chunk_id);
+}
 }  // namespace recordio
 }  // namespace paddle
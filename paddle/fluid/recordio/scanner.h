@@ -14,30 +14,85 @@
 
 #pragma once
 
+#include <deque>
 #include <fstream>
+#include <future>  // NOLINT
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "ThreadPool.h"
 #include "paddle/fluid/recordio/chunk.h"
+#include "paddle/fluid/recordio/index.h"
 
 namespace paddle {
 namespace recordio {
 
+struct ScannerOptions {
+  // Check the CRC32 of each chunk. It could be turned off for the files on
+  // the trusted local disks.
+  bool verify_checksum{true};
+  // The dictionary the kZstd chunks were written with.
+  std::string zstd_dict;
+  // The chunks are decompressed on a pool of the threads if it is positive,
+  // ahead of the records being consumed.
+  int num_decode_threads{0};
+  // The number of the chunks decompressed ahead.
+  int num_prefetch_chunks{4};
+};
+
 class Scanner {
  public:
-  explicit Scanner(std::unique_ptr<std::istream>&& stream);
+  explicit Scanner(std::unique_ptr<std::istream>&& stream,
+                   const ScannerOptions& options = ScannerOptions());
 
-  explicit Scanner(const std::string& filename);
+  explicit Scanner(const std::string& filename,
+                   const ScannerOptions& options = ScannerOptions());
 
   void Reset();
 
-  std::string Next();
+  // The record is a view into the decoded chunk, which is valid until the
+  // next call of Next, Reset or Seek.
+  string::Piece Next();
 
   bool HasNext() const;
 
+  // Whether the file has the chunk index written by Writer::Close.
+  bool HasIndex() const { return has_index_; }
+  size_t NumChunks() const { return index_.NumChunks(); }
+  uint32_t NumRecords(size_t chunk_id) const {
+    return index_.NumRecords(chunk_id);
+  }
+
+  // Move to the first record of the chunk, and Next() goes on to the later
+  // chunks then. The file should have the index.
+  void Seek(size_t chunk_id);
+
  private:
+  void LoadIndex();
+  // Start to read the chunks from the current position of the stream.
+  void StartReading();
+  // Read the raw chunks and decode them on the pool, until there are
+  // num_prefetch_chunks of them being decoded.
+  void Prefetch();
+  // Fetch the next chunk that has records, returns false if eof.
+  bool FetchChunk(DecodedChunk* chunk);
+
+  ScannerOptions options_;
   std::unique_ptr<std::istream> stream_;
-  ChunkParser parser_;
+  Index index_;
+  bool has_index_{false};
+
+  // The chunk being consumed, and the next one is fetched ahead so that the
+  // records of the current one stay valid until it is consumed.
+  DecodedChunk chunk_;
+  DecodedChunk next_chunk_;
+  bool has_next_chunk_{false};
+
+  // Used if options_.num_decode_threads > 0.
+  std::unique_ptr<::ThreadPool> pool_;
+  std::deque<std::future<DecodedChunk>> pending_;
+  bool stream_end_{false};
 };
 }  // namespace recordio
 }  // namespace paddle
@@ -28,10 +28,26 @@ void Writer::Write(const std::string& record) {
 }
 
 void Writer::Flush() {
-  cur_chunk_.Write(stream_, compressor_);
+  std::streamoff offset = stream_.tellp();
+  uint32_t num_records = static_cast<uint32_t>(cur_chunk_.NumRecords());
+  if (cur_chunk_.Write(stream_, compressor_, zstd_dict_)) {
+    if (offset < 0) {
+      indexable_ = false;
+    } else {
+      index_.Add(static_cast<uint64_t>(offset), num_records);
+    }
+  }
   cur_chunk_.Clear();
 }
 
+void Writer::Close() {
+  Flush();
+  std::streamoff offset = stream_.tellp();
+  if (indexable_ && offset >= 0) {
+    index_.Write(stream_, static_cast<uint64_t>(offset));
+  }
+}
+
 Writer::~Writer() {
   PADDLE_ENFORCE(cur_chunk_.Empty(), "Writer must be flushed when destroy.");
 }
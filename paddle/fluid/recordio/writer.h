@@ -16,21 +16,31 @@
 #include <string>
 
 #include "paddle/fluid/recordio/chunk.h"
+#include "paddle/fluid/recordio/index.h"
+
 namespace paddle {
 namespace recordio {
 
 class Writer {
  public:
+  // The zstd_dict is used to compress the chunks if the compressor is kZstd,
+  // and the Scanner should take the same one.
   Writer(std::ostream* sout, Compressor compressor,
-         size_t max_num_records_in_chunk = 1000)
+         size_t max_num_records_in_chunk = 1000,
+         const std::string& zstd_dict = "")
       : stream_(*sout),
         max_num_records_in_chunk_(max_num_records_in_chunk),
-        compressor_(compressor) {}
+        compressor_(compressor),
+        zstd_dict_(zstd_dict) {}
 
   void Write(const std::string& record);
 
   void Flush();
 
+  // Flush the last chunk and append the index of the chunks, which lets the
+  // Scanner seek to any chunk. Nothing should be written after it.
+  void Close();
+
   ~Writer();
 
  private:
@@ -38,6 +48,10 @@ class Writer {
   size_t max_num_records_in_chunk_;
   Chunk cur_chunk_;
   Compressor compressor_;
+  std::string zstd_dict_;
+  Index index_;
+  // false if the offset of a chunk is unknown, e.g. a pipe
+  bool indexable_{true};
 };
 
 }  // namespace recordio
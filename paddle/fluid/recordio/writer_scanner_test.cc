@@ -14,6 +14,7 @@
 
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "paddle/fluid/recordio/scanner.h"
@@ -68,3 +69,104 @@ TEST(WriterScanner, TinyChunk) {
     ASSERT_FALSE(scanner.HasNext());
   }
 }
+
+TEST(WriterScanner, Seek) {
+  std::stringstream* stream = new std::stringstream();
+  {
+    paddle::recordio::Writer writer(
+        stream, paddle::recordio::Compressor::kSnappy, 2 /*max chunk num*/);
+    writer.Write("ABC");
+    writer.Write("BCD");
+    writer.Write("CDE");
+    writer.Write("DEFG");
+    writer.Write("EFG");
+    writer.Close();
+  }
+
+  {
+    stream->seekg(0, std::ios::beg);
+    std::unique_ptr<std::istream> stream_ptr(stream);
+    paddle::recordio::Scanner scanner(std::move(stream_ptr));
+    ASSERT_TRUE(scanner.HasIndex());
+    ASSERT_EQ(scanner.NumChunks(), 3UL);
+    ASSERT_EQ(scanner.NumRecords(0), 2U);
+    ASSERT_EQ(scanner.NumRecords(2), 1U);
+
+    // the sequential scan skips the index
+    std::vector<std::string> records;
+    while (scanner.HasNext()) {
+      records.push_back(scanner.Next().ToString());
+    }
+    ASSERT_EQ(records, std::vector<std::string>(
+                           {"ABC", "BCD", "CDE", "DEFG", "EFG"}));
+
+    scanner.Seek(1);
+    ASSERT_EQ(scanner.Next(), "CDE");
+    ASSERT_EQ(scanner.Next(), "DEFG");
+    ASSERT_EQ(scanner.Next(), "EFG");
+    ASSERT_FALSE(scanner.HasNext());
+
+    scanner.Seek(0);
+    ASSERT_EQ(scanner.Next(), "ABC");
+    scanner.Seek(2);
+    ASSERT_EQ(scanner.Next(), "EFG");
+  }
+}
+
+TEST(WriterScanner, NoIndex) {
+  std::stringstream* stream = new std::stringstream();
+  {
+    paddle::recordio::Writer writer(stream,
+                                    paddle::recordio::Compressor::kNoCompress);
+    writer.Write("ABC");
+    writer.Flush();
+  }
+  stream->seekg(0, std::ios::beg);
+  std::unique_ptr<std::istream> stream_ptr(stream);
+  paddle::recordio::Scanner scanner(std::move(stream_ptr));
+  ASSERT_FALSE(scanner.HasIndex());
+  ASSERT_EQ(scanner.Next(), "ABC");
+  ASSERT_FALSE(scanner.HasNext());
+}
+
+TEST(WriterScanner, ParallelDecode) {
+  std::vector<std::string> expected;
+  for (int i = 0; i < 50; ++i) {
+    expected.push_back(std::string(i % 7, 'A' + i % 26));
+  }
+  for (auto ct : {paddle::recordio::Compressor::kSnappy,
+                  paddle::recordio::Compressor::kLZ4,
+                  paddle::recordio::Compressor::kZstd}) {
+    std::stringstream* stream = new std::stringstream();
+    {
+      paddle::recordio::Writer writer(stream, ct, 3 /*max chunk num*/);
+      for (auto& record : expected) {
+        writer.Write(record);
+      }
+      writer.Close();
+    }
+
+    stream->seekg(0, std::ios::beg);
+    std::unique_ptr<std::istream> stream_ptr(stream);
+    paddle::recordio::ScannerOptions options;
+    options.verify_checksum = false;
+    options.num_decode_threads = 2;
+    options.num_prefetch_chunks = 3;
+    paddle::recordio::Scanner scanner(std::move(stream_ptr), options);
+    for (int pass = 0; pass < 2; ++pass) {
+      std::vector<std::string> records;
+      while (scanner.HasNext()) {
+        records.push_back(scanner.Next().ToString());
+      }
+      ASSERT_EQ(records, expected);
+      scanner.Reset();
+    }
+
+    scanner.Seek(16);
+    ASSERT_EQ(scanner.Next(), expected[48]);
+    ASSERT_EQ(scanner.Next(), expected[49]);
+    ASSERT_FALSE(scanner.HasNext());
+    scanner.Seek(1);
+    ASSERT_EQ(scanner.Next(), expected[3]);
+  }
+}
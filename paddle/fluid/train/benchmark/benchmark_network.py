@@ -0,0 +1,272 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Generate the training programs of the native benchmark, whose data are read
+from a random data generator, so that the C++ trainer measures the executor
+only. Each model is saved to <output_dir>/<model>/{startup,main}_program.
+"""
+
+from __future__ import print_function
+
+import argparse
+import os
+
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.framework as framework
+
+
+def random_reader(shapes, batch_size):
+    # Each instance is a tensor of the shape, the batch reader concatenates
+    # batch_size instances along the first dim.
+    reader = fluid.layers.random_data_generator(
+        low=0.0,
+        high=1.0,
+        shapes=shapes,
+        lod_levels=[0] * len(shapes))
+    batch_reader = fluid.layers.batch(reader, batch_size=batch_size)
+    reader = fluid.layers.double_buffer(batch_reader)
+    # Every device keeps its readers in its local scope across iterations.
+    batch_reader.persistable = True
+    reader.persistable = True
+    return fluid.layers.read_file(reader)
+
+
+def random_ids(data, dict_size):
+    # The generator yields floats in [0, 1), which are scaled to the ids.
+    ids = fluid.layers.scale(data, scale=float(dict_size - 1))
+    return fluid.layers.cast(ids, dtype='int64')
+
+
+def conv_bn(input, num_filters, filter_size, stride=1, act='relu'):
+    conv = fluid.layers.conv2d(
+        input=input,
+        num_filters=num_filters,
+        filter_size=filter_size,
+        stride=stride,
+        padding=(filter_size - 1) // 2,
+        act=None,
+        bias_attr=False)
+    return fluid.layers.batch_norm(input=conv, act=act)
+
+
+def bottleneck(input, num_filters, stride):
+    conv0 = conv_bn(input, num_filters, 1)
+    conv1 = conv_bn(conv0, num_filters, 3, stride=stride)
+    conv2 = conv_bn(conv1, num_filters * 4, 1, act=None)
+    if stride != 1 or input.shape[1] != num_filters * 4:
+        input = conv_bn(input, num_filters * 4, 1, stride=stride, act=None)
+    return fluid.layers.elementwise_add(x=input, y=conv2, act='relu')
+
+
+def resnet(args):
+    class_dim = 1000
+    image, label = random_reader([[1, 3, 224, 224], [1, 1]], args.batch_size)
+    label = random_ids(label, class_dim)
+
+    conv = conv_bn(image, 64, 7, stride=2)
+    conv = fluid.layers.pool2d(
+        input=conv, pool_size=3, pool_stride=2, pool_padding=1,
+        pool_type='max')
+    for i, depth in enumerate([3, 4, 6, 3]):
+        for j in range(depth):
+            conv = bottleneck(conv, 64 * 2**i, 2 if j == 0 and i != 0 else 1)
+    pool = fluid.layers.pool2d(
+        input=conv, pool_type='avg', global_pooling=True)
+    predict = fluid.layers.fc(input=pool, size=class_dim, act='softmax')
+    cost = fluid.layers.cross_entropy(input=predict, label=label)
+    avg_cost = fluid.layers.mean(x=cost)
+    fluid.optimizer.Momentum(
+        learning_rate=0.01, momentum=0.9).minimize(avg_cost)
+
+
+def multi_head_attention(queries, keys, d_model, n_head, seq_len, bias=None):
+    d_key = d_model // n_head
+
+    def split_heads(x):
+        x = fluid.layers.reshape(x, shape=[0, seq_len, n_head, d_key])
+        return fluid.layers.transpose(x, perm=[0, 2, 1, 3])
+
+    q = split_heads(fluid.layers.fc(queries, d_model, num_flatten_dims=2))
+    k = split_heads(fluid.layers.fc(keys, d_model, num_flatten_dims=2))
+    v = split_heads(fluid.layers.fc(keys, d_model, num_flatten_dims=2))
+    product = fluid.layers.matmul(
+        q, k, transpose_y=True, alpha=d_key**-0.5)
+    if bias is not None:
+        product = fluid.layers.elementwise_add(product, bias, axis=2)
+    weights = fluid.layers.softmax(product)
+    out = fluid.layers.matmul(weights, v)
+    out = fluid.layers.transpose(out, perm=[0, 2, 1, 3])
+    out = fluid.layers.reshape(out, shape=[0, seq_len, d_model])
+    return fluid.layers.fc(out, d_model, num_flatten_dims=2)
+
+
+def add_and_norm(x, y):
+    return fluid.layers.layer_norm(
+        fluid.layers.elementwise_add(x, y), begin_norm_axis=2)
+
+
+def feed_forward(x, d_model):
+    hidden = fluid.layers.fc(x, d_model * 4, num_flatten_dims=2, act='relu')
+    return fluid.layers.fc(hidden, d_model, num_flatten_dims=2)
+
+
+def embed(ids, dict_size, d_model, seq_len, name):
+    emb = fluid.layers.embedding(
+        ids, size=[dict_size, d_model],
+        param_attr=fluid.ParamAttr(name=name + '_word_emb'))
+    emb = fluid.layers.reshape(emb, shape=[-1, seq_len, d_model])
+    pos = fluid.layers.create_parameter(
+        shape=[seq_len, d_model], dtype='float32', name=name + '_pos_emb')
+    return fluid.layers.elementwise_add(emb, pos, axis=1)
+
+
+def transformer(args):
+    dict_size, d_model, n_head, n_layer = 30000, 512, 8, 6
+    seq_len = args.seq_len
+    src, trg, trg_next = random_reader([[seq_len, 1]] * 3, args.batch_size)
+
+    enc = embed(random_ids(src, dict_size), dict_size, d_model, seq_len, 'src')
+    for _ in range(n_layer):
+        enc = add_and_norm(
+            enc, multi_head_attention(enc, enc, d_model, n_head, seq_len))
+        enc = add_and_norm(enc, feed_forward(enc, d_model))
+
+    # The decoder only attends to the previous positions.
+    mask = np.triu(np.full([seq_len, seq_len], -1e9, dtype='float32'), 1)
+    bias = fluid.layers.assign(mask)
+    bias.stop_gradient = True
+    dec = embed(random_ids(trg, dict_size), dict_size, d_model, seq_len, 'trg')
+    for _ in range(n_layer):
+        dec = add_and_norm(
+            dec,
+            multi_head_attention(dec, dec, d_model, n_head, seq_len, bias))
+        dec = add_and_norm(
+            dec, multi_head_attention(dec, enc, d_model, n_head, seq_len))
+        dec = add_and_norm(dec, feed_forward(dec, d_model))
+
+    logits = fluid.layers.fc(dec, dict_size, num_flatten_dims=2)
+    logits = fluid.layers.reshape(logits, shape=[-1, dict_size])
+    cost = fluid.layers.softmax_with_cross_entropy(
+        logits=logits, label=random_ids(trg_next, dict_size))
+    avg_cost = fluid.layers.mean(x=cost)
+    fluid.optimizer.Adam(learning_rate=0.001).minimize(avg_cost)
+
+
+def ctr_dnn(args):
+    dict_size, num_slots, num_dense = 1000001, 26, 13
+    shapes = [[1, num_dense]] + [[1, 1]] * (num_slots + 1)
+    data = random_reader(shapes, args.batch_size)
+    dense, slots, label = data[0], data[1:-1], data[-1]
+
+    embs = []
+    for slot in slots:
+        emb = fluid.layers.embedding(
+            input=random_ids(slot, dict_size),
+            size=[dict_size, 10],
+            is_sparse=True,
+            param_attr=fluid.ParamAttr(name='slot_emb'))
+        embs.append(emb)
+    hidden = fluid.layers.concat(embs + [dense], axis=1)
+    for _ in range(3):
+        hidden = fluid.layers.fc(input=hidden, size=400, act='relu')
+    predict = fluid.layers.fc(input=hidden, size=2, act='softmax')
+    cost = fluid.layers.cross_entropy(
+        input=predict, label=random_ids(label, 2))
+    avg_cost = fluid.layers.mean(x=cost)
+    fluid.optimizer.Adagrad(learning_rate=0.0001).minimize(avg_cost)
+
+
+def seq2seq(args):
+    dict_size, emb_dim, hidden_dim = 30000, 512, 512
+    seq_len = args.seq_len
+    src, trg, trg_next = random_reader([[seq_len, 1]] * 3, args.batch_size)
+    # All the sequences of a batch have seq_len tokens.
+    lod = list(range(0, (args.batch_size + 1) * seq_len, seq_len))
+
+    def gru(ids, name, h_0=None):
+        ids = fluid.layers.lod_reset(random_ids(ids, dict_size),
+                                     target_lod=lod)
+        emb = fluid.layers.embedding(
+            input=ids,
+            size=[dict_size, emb_dim],
+            param_attr=fluid.ParamAttr(name=name + '_emb'))
+        proj = fluid.layers.fc(input=emb, size=hidden_dim * 3)
+        return fluid.layers.dynamic_gru(
+            input=proj, size=hidden_dim, h_0=h_0)
+
+    enc = gru(src, 'src')
+    dec = gru(trg, 'trg', h_0=fluid.layers.sequence_last_step(enc))
+    predict = fluid.layers.fc(input=dec, size=dict_size, act='softmax')
+    cost = fluid.layers.cross_entropy(
+        input=predict, label=random_ids(trg_next, dict_size))
+    avg_cost = fluid.layers.mean(x=cost)
+    fluid.optimizer.Adam(learning_rate=0.001).minimize(avg_cost)
+
+
+MODELS = {
+    'resnet': resnet,
+    'transformer': transformer,
+    'ctr_dnn': ctr_dnn,
+    'seq2seq': seq2seq,
+}
+
+
+def save_program_desc(network_func, args, dirname):
+    startup_program = framework.Program()
+    train_program = framework.Program()
+
+    with framework.program_guard(train_program, startup_program):
+        with fluid.unique_name.guard():
+            network_func(args)
+
+    if not os.path.exists(dirname):
+        os.makedirs(dirname)
+    with open(os.path.join(dirname, "startup_program"), "wb") as f:
+        f.write(startup_program.desc.serialize_to_string())
+    with open(os.path.join(dirname, "main_program"), "wb") as f:
+        f.write(train_program.desc.serialize_to_string())
+
+
+def parse_args():
+    parser = argparse.ArgumentParser('Native benchmark programs.')
+    parser.add_argument(
+        '--model',
+        type=str,
+        default='all',
+        choices=['all'] + sorted(MODELS.keys()),
+        help='The model to generate.')
+    parser.add_argument(
+        '--batch_size', type=int, default=32, help='The batch size per device.')
+    parser.add_argument(
+        '--seq_len',
+        type=int,
+        default=64,
+        help='The length of the sequences of transformer and seq2seq.')
+    parser.add_argument(
+        '--output_dir',
+        type=str,
+        default='.',
+        help='The directory to save the programs.')
+    return parser.parse_args()
+
+
+if __name__ == '__main__':
+    args = parse_args()
+    models = sorted(MODELS.keys()) if args.model == 'all' else [args.model]
+    for model in models:
+        save_program_desc(MODELS[model], args,
+                          os.path.join(args.output_dir, model))
+        print("saved %s to %s" % (model, os.path.join(args.output_dir, model)))
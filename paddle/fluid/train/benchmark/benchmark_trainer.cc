@@ -0,0 +1,288 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sys/resource.h>
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/feed_fetch_type.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/parallel_executor.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/init.h"
+#include "paddle/fluid/platform/place.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/platform/gpu_info.h"
+#endif
+
+DEFINE_string(dirname, "",
+              "Directory of the startup_program and main_program generated by "
+              "benchmark_network.py.");
+DEFINE_bool(use_gpu, false, "Train on the GPUs.");
+DEFINE_int32(device_count, 0,
+             "The number of the devices, 0 means all the GPUs, or 1 CPU.");
+DEFINE_int32(skip_steps, 10, "The warm up steps excluded from the report.");
+DEFINE_int32(iterations, 100, "The measured steps.");
+DEFINE_int32(log_period, 10,
+             "Fetch and print the loss every log_period steps.");
+
+// ExecutionStrategy
+DEFINE_int32(num_threads, 0, "The threads of the executor, 0 means default.");
+DEFINE_string(executor_type, "default",
+              "The SSA graph executor, default, experimental or "
+              "work_stealing.");
+DEFINE_bool(allow_op_delay, false, "ExecutionStrategy.allow_op_delay");
+DEFINE_int32(num_iteration_per_drop_scope, 100,
+             "ExecutionStrategy.num_iteration_per_drop_scope");
+DEFINE_bool(use_priority_scheduling, false,
+            "ExecutionStrategy.use_priority_scheduling");
+DEFINE_bool(recycle_local_scopes, false,
+            "ExecutionStrategy.recycle_local_scopes");
+
+// BuildStrategy
+DEFINE_string(reduce_strategy, "allreduce",
+              "The gradients aggregation, allreduce or reduce.");
+DEFINE_bool(fuse_elewise_add_act_ops, false,
+            "BuildStrategy.fuse_elewise_add_act_ops");
+DEFINE_bool(fuse_all_reduce_ops, false, "BuildStrategy.fuse_all_reduce_ops");
+DEFINE_bool(fuse_broadcast_op, false, "BuildStrategy.fuse_broadcast_op");
+DEFINE_bool(overlap_broadcast, false, "BuildStrategy.overlap_broadcast");
+DEFINE_bool(enable_sequential_execution, false,
+            "BuildStrategy.enable_sequential_execution");
+DEFINE_bool(remove_unnecessary_lock, false,
+            "BuildStrategy.remove_unnecessary_lock");
+
+namespace paddle {
+namespace train {
+
+void ReadBinaryFile(const std::string& filename, std::string* contents) {
+  std::ifstream fin(filename, std::ios::in | std::ios::binary);
+  PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open file %s", filename);
+  fin.seekg(0, std::ios::end);
+  contents->clear();
+  contents->resize(fin.tellg());
+  fin.seekg(0, std::ios::beg);
+  fin.read(&(contents->at(0)), contents->size());
+  fin.close();
+}
+
+std::unique_ptr<framework::ProgramDesc> Load(const std::string& filename) {
+  VLOG(3) << "loading program from " << filename;
+  std::string program_desc_str;
+  ReadBinaryFile(filename, &program_desc_str);
+  return std::unique_ptr<framework::ProgramDesc>(
+      new framework::ProgramDesc(program_desc_str));
+}
+
+std::vector<platform::Place> GetPlaces() {
+  std::vector<platform::Place> places;
+  if (FLAGS_use_gpu) {
+#ifdef PADDLE_WITH_CUDA
+    int count = FLAGS_device_count > 0 ? FLAGS_device_count
+                                       : platform::GetCUDADeviceCount();
+    for (int i = 0; i < count; ++i) {
+      places.emplace_back(platform::CUDAPlace(i));
+    }
+#else
+    PADDLE_THROW("Not compiled with CUDA");
+#endif
+  } else {
+    int count = std::max(FLAGS_device_count, 1);
+    places.assign(count, platform::CPUPlace());
+  }
+  return places;
+}
+
+framework::details::ExecutionStrategy GetExecutionStrategy() {
+  framework::details::ExecutionStrategy strategy;
+  strategy.use_cuda_ = FLAGS_use_gpu;
+  strategy.num_threads_ = FLAGS_num_threads;
+  strategy.allow_op_delay_ = FLAGS_allow_op_delay;
+  strategy.num_iteration_per_drop_scope_ = FLAGS_num_iteration_per_drop_scope;
+  strategy.use_priority_scheduling_ = FLAGS_use_priority_scheduling;
+  strategy.recycle_local_scopes_ = FLAGS_recycle_local_scopes;
+  if (FLAGS_executor_type == "experimental") {
+    strategy.type_ = framework::details::ExecutionStrategy::kExperimental;
+  } else if (FLAGS_executor_type == "work_stealing") {
+    strategy.type_ = framework::details::ExecutionStrategy::kWorkStealing;
+  } else {
+    PADDLE_ENFORCE_EQ(FLAGS_executor_type, "default",
+                      "Unknown executor_type %s", FLAGS_executor_type);
+  }
+  return strategy;
+}
+
+framework::details::BuildStrategy GetBuildStrategy() {
+  framework::details::BuildStrategy strategy;
+  if (FLAGS_reduce_strategy == "reduce") {
+    strategy.reduce_ =
+        framework::details::BuildStrategy::ReduceStrategy::kReduce;
+  } else {
+    PADDLE_ENFORCE_EQ(FLAGS_reduce_strategy, "allreduce",
+                      "Unknown reduce_strategy %s", FLAGS_reduce_strategy);
+  }
+  strategy.fuse_elewise_add_act_ops_ = FLAGS_fuse_elewise_add_act_ops;
+  strategy.fuse_all_reduce_ops_ = FLAGS_fuse_all_reduce_ops;
+  strategy.fuse_broadcast_op_ = FLAGS_fuse_broadcast_op;
+  strategy.overlap_broadcast_ = FLAGS_overlap_broadcast;
+  strategy.enable_sequential_execution_ = FLAGS_enable_sequential_execution;
+  strategy.remove_unnecessary_lock_ = FLAGS_remove_unnecessary_lock;
+  return strategy;
+}
+
+// The instances each device reads in a step, which is the batch size of the
+// batch reader of the program.
+int GetBatchSize(const framework::ProgramDesc& program) {
+  for (auto* op : program.Block(0).AllOps()) {
+    if (op->Type() == "create_batch_reader") {
+      return boost::get<int>(op->GetAttr("batch_size"));
+    }
+  }
+  PADDLE_THROW("The program does not read the data by a batch reader");
+}
+
+// The memory allocated on the places, each place is counted once.
+size_t GetMemoryUsage(const std::vector<platform::Place>& places) {
+  size_t usage = 0;
+  std::vector<platform::Place> counted;
+  for (auto& place : places) {
+    if (std::find(counted.begin(), counted.end(), place) != counted.end()) {
+      continue;
+    }
+    counted.push_back(place);
+    usage += memory::memory_usage(place);
+  }
+  return usage;
+}
+
+void Run() {
+  PADDLE_ENFORCE(!FLAGS_dirname.empty(), "--dirname is required");
+  auto places = GetPlaces();
+  auto startup_program = Load(FLAGS_dirname + "/startup_program");
+  auto train_program = Load(FLAGS_dirname + "/main_program");
+  const auto& block = train_program->Block(0);
+
+  // The loss is the output of the last forward mean op.
+  std::string loss_name = "";
+  for (auto* op_desc : block.AllOps()) {
+    if (op_desc->Type() == "mean") {
+      loss_name = op_desc->Output("Out")[0];
+    }
+  }
+  PADDLE_ENFORCE_NE(loss_name, "", "loss not found");
+
+  // The parameters are the persistable variables having gradients.
+  std::unordered_set<std::string> params;
+  std::unordered_set<std::string> bcast_vars;
+  for (auto* var : block.AllVars()) {
+    if (!var->Persistable() ||
+        var->GetType() != framework::proto::VarType::LOD_TENSOR) {
+      continue;
+    }
+    bcast_vars.insert(var->Name());
+    if (block.HasVar(framework::GradVarName(var->Name()))) {
+      params.insert(var->Name());
+    }
+  }
+
+  framework::Scope scope;
+  framework::Executor executor(places[0]);
+  executor.Run(*startup_program, &scope, 0);
+
+  auto exec_strategy = GetExecutionStrategy();
+  auto build_strategy = GetBuildStrategy();
+  framework::ParallelExecutor pe(places, params, bcast_vars, *train_program,
+                                 loss_name, &scope, {}, exec_strategy,
+                                 build_strategy);
+
+  const std::string fetch_var_name = "@FETCHED_VAR_NAME@";
+  const int64_t samples_per_step =
+      static_cast<int64_t>(GetBatchSize(*train_program)) * places.size();
+  std::vector<double> step_times;
+  size_t peak_memory = 0;
+  for (int i = 0; i < FLAGS_skip_steps + FLAGS_iterations; ++i) {
+    bool log = FLAGS_log_period > 0 && (i + 1) % FLAGS_log_period == 0;
+    std::vector<std::string> fetch_list;
+    if (log) fetch_list.push_back(loss_name);
+
+    auto start = std::chrono::steady_clock::now();
+    pe.Run(fetch_list, fetch_var_name);
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    if (i >= FLAGS_skip_steps) step_times.push_back(elapsed.count());
+    peak_memory = std::max(peak_memory, GetMemoryUsage(places));
+    if (log) {
+      auto& fetched = scope.FindVar(fetch_var_name)
+                          ->Get<framework::FeedFetchList>()
+                          .front();
+      framework::LoDTensor loss;
+      framework::TensorCopySync(fetched, platform::CPUPlace(), &loss);
+      double sum = 0;
+      for (int64_t j = 0; j < loss.numel(); ++j) sum += loss.data<float>()[j];
+      std::cout << "step: " << i << " loss: " << sum / loss.numel()
+                << " step_time: " << elapsed.count() << "s" << std::endl;
+    }
+  }
+  PADDLE_ENFORCE(!step_times.empty(), "--iterations should be positive");
+
+  double total = 0;
+  for (auto t : step_times) total += t;
+  double mean = total / step_times.size();
+  double variance = 0;
+  for (auto t : step_times) variance += (t - mean) * (t - mean);
+  variance /= step_times.size();
+  std::sort(step_times.begin(), step_times.end());
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  // A single line in key=value pairs, so that the runs of different
+  // strategies are easy to collect and compare.
+  std::cout << "model=" << FLAGS_dirname << " devices=" << places.size()
+            << " use_gpu=" << FLAGS_use_gpu
+            << " executor_type=" << FLAGS_executor_type
+            << " reduce_strategy=" << FLAGS_reduce_strategy
+            << " samples_per_sec=" << samples_per_step / mean
+            << " step_time_mean=" << mean
+            << " step_time_stddev=" << std::sqrt(variance)
+            << " step_time_min=" << step_times.front()
+            << " step_time_p50=" << step_times[step_times.size() / 2]
+            << " step_time_max=" << step_times.back()
+            << " peak_memory_mb=" << peak_memory / (1 << 20)
+            << " max_rss_mb=" << usage.ru_maxrss / 1024 << std::endl;
+}
+
+}  // namespace train
+}  // namespace paddle
+
+int main(int argc, char** argv) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  paddle::framework::InitDevices(false);
+  paddle::train::Run();
+  return 0;
+}
@@ -0,0 +1,34 @@
+#!/bin/bash
+# This script runs the native training benchmark of all the models with some
+# ExecutionStrategy and BuildStrategy settings, and collects the summary lines.
+#
+# Usage: run_benchmark.sh <benchmark_trainer> <models_dir> [trainer flags]
+
+set -e
+
+trainer=$1
+models_dir=$2
+shift 2
+
+settings=(
+  "--executor_type=default"
+  "--executor_type=experimental"
+  "--executor_type=work_stealing"
+  "--fuse_all_reduce_ops=true"
+  "--fuse_elewise_add_act_ops=true"
+  "--reduce_strategy=reduce"
+  "--reduce_strategy=reduce --overlap_broadcast=true"
+)
+
+mkdir -p logs
+for model in resnet transformer ctr_dnn seq2seq; do
+  for setting in "${settings[@]}"; do
+    log=logs/${model}$(echo ${setting} | tr -d '-' | tr ' =' '__').log
+    echo "${model} ${setting}"
+    # The Reduce strategy fails on a single device, go on with the others.
+    ${trainer} --dirname=${models_dir}/${model} ${setting} "$@" > ${log} 2>&1 \
+      || echo "failed, see ${log}"
+    grep "samples_per_sec" ${log} >> logs/summary.txt || true
+  done
+done
+cat logs/summary.txt
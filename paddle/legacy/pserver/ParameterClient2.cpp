@@ -373,6 +373,45 @@ void ParameterClient2::sendParameter(
   }
 }
 
+void ParameterClient2::sendParameterStaged(ParameterUpdateMode updateMode,
+                                           ParameterType parameterType,
+                                           int64_t numSamples,
+                                           real cost) {
+  SendJobPtr sendJob = std::make_shared<SendJob>();
+  prepareSendData(updateMode,
+                  parameterType,
+                  allSegments_,
+                  numSamples,
+                  cost,
+                  /* sendBackParameter= */ false,
+                  PARAMETER_VALUE,
+                  BATCH_START_AND_FINISH,
+                  sendJob.get());
+
+  size_t totalSize = 0;
+  for (auto& iovs : sendJob->parallelInputIovs) {
+    for (auto& iov : iovs) {
+      totalSize += iov.iov_len;
+    }
+  }
+  /// the buffer only grows, the push of a batch usually allocates nothing
+  if (stagingBuffer_.size() < totalSize) {
+    stagingBuffer_.resize(totalSize);
+  }
+  char* staging = stagingBuffer_.data();
+  for (auto& iovs : sendJob->parallelInputIovs) {
+    for (auto& iov : iovs) {
+      memcpy(staging, iov.iov_base, iov.iov_len);
+      iov.iov_base = staging;
+      staging += iov.iov_len;
+    }
+  }
+
+  for (int i = 0; i < threadNum_; i++) {
+    sendJobQueue_[i]->enqueue(sendJob);
+  }
+}
+
 void ParameterClient2::recvParameter() { recvSyncBarrier_->wait(); }
 
 void ParameterClient2::send(int threadId) {
@@ -337,6 +337,22 @@ class ParameterClient2 : public BaseClient {
                   batchStatus);
   }
 
+  /**
+   * @brief Sends all parameters to parameter servers in the background like
+   *        sendParameter(), but the data of parameterType are copied to a
+   *        staging buffer first, so the parameter may change before the
+   *        paired recvParameter(). It lets the sparse rows of the next batch
+   *        be prefetched, and the gradients be cleared, while the gradients
+   *        of the current batch are being pushed.
+   *
+   * @note  At most one staged send may be in flight, it has to be paired with
+   *        a recvParameter() before the next one.
+   */
+  void sendParameterStaged(ParameterUpdateMode updateMode,
+                           ParameterType parameterType,
+                           int64_t numSamples,
+                           real cost);
+
   /// Get all parameters from parameter servers
   void getParameter(ParameterType recvParameterType = PARAMETER_VALUE,
                     ParameterType sendBackParameterType = PARAMETER_VALUE) {
@@ -596,6 +612,9 @@ class ParameterClient2 : public BaseClient {
   /// thread pool for parallelizing all connections to pservers
   std::unique_ptr<SyncThreadPool> syncThreadPool_;
 
+  /// copy of the data being sent by sendParameterStaged()
+  std::vector<char> stagingBuffer_;
+
   bool passFinish_;
 };
 
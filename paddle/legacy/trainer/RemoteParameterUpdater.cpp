@@ -593,7 +593,9 @@ SparseRemoteParameterUpdater::SparseRemoteParameterUpdater(
       passCount_(0),
       expectedPassCount_(expectedPassCount),
       testing_(testing),
-      useApplyInPserver_(false) {}
+      useApplyInPserver_(false),
+      pipelineUpdate_(false),
+      pushPending_(false) {}
 
 void SparseRemoteParameterUpdater::init(
     const std::vector<ParameterPtr>& parameters) {
@@ -618,6 +620,28 @@ void SparseRemoteParameterUpdater::init(
     startController();
     useApplyInPserver_ = useApplyInPserver(config_);
   }
+
+  if (FLAGS_pipeline_sparse_remote_update && !testing_) {
+    if (config_.algorithm() == TrainAlgorithm::AsyncSGD) {
+      // The rows are sharded to the pservers in the same way, and each
+      // connection is served by its own worker thread of the pserver.
+      prefetchClient_.reset(new ParameterClient2(
+          false, FLAGS_port + FLAGS_ports_num, FLAGS_ports_num_for_sparse));
+      prefetchClient_->init(parameters_);
+      prefetchClient_->setTrainerId(FLAGS_trainer_id);
+      pipelineUpdate_ = true;
+    } else {
+      LOG(WARNING) << "pipeline_sparse_remote_update only supports AsyncSGD";
+    }
+  }
+}
+
+void SparseRemoteParameterUpdater::waitPush() {
+  if (pushPending_) {
+    REGISTER_TIMER("waitSparsePush");
+    parameterClient_->recvParameter();
+    pushPending_ = false;
+  }
 }
 
 void SparseRemoteParameterUpdater::startController() {
@@ -688,6 +712,14 @@ void SparseRemoteParameterUpdater::finishBatch(real cost) {
   ParameterType sendType = PARAMETER_GRADIENT;
 
   REGISTER_TIMER("sendSparseParam");
+  if (pipelineUpdate_) {
+    // The gradients are staged, so the next batch may clear them and
+    // prefetch its rows before the push finishes.
+    waitPush();
+    parameterClient_->sendParameterStaged(mode, sendType, batchSize_, 0);
+    pushPending_ = true;
+    return;
+  }
   parameterClient_->sendAndReceiveParameter(mode,
                                             sendType,
                                             batchSize_,
@@ -698,6 +730,7 @@ void SparseRemoteParameterUpdater::finishBatch(real cost) {
 }
 
 void SparseRemoteParameterUpdater::startPass() {
+  waitPush();
   if (config_.algorithm() == TrainAlgorithm::SGD) {
     parameterClient_->waitPassStart();
   } else {
@@ -713,6 +746,7 @@ void SparseRemoteParameterUpdater::startPass() {
 }
 
 bool SparseRemoteParameterUpdater::finishPass() {
+  waitPush();
   if (config_.algorithm() == TrainAlgorithm::SGD) {
     parameterClient_->waitPassFinish();
   } else {
@@ -732,6 +766,7 @@ bool SparseRemoteParameterUpdater::finishPass() {
 // Trainer will call getParametersRemote at batch start or before save,
 // so we do not get values in apply() and restore().
 void SparseRemoteParameterUpdater::apply() {
+  waitPush();
   if (useApplyInPserver_) {
     PreparedOperations ops;
     ops.addOperation(PSERVER_OP_APPLY);
@@ -745,6 +780,9 @@ void SparseRemoteParameterUpdater::restore() {}
 
 void SparseRemoteParameterUpdater::getParametersRemote(bool fullSize,
                                                        bool apply) {
+  if (fullSize) {
+    waitPush();
+  }
   ParameterType sendBackParameterType =
       (useApplyInPserver_ && apply) ? PARAMETER_APPLY : PARAMETER_VALUE;
   std::function<void()> getParams;
@@ -757,6 +795,15 @@ void SparseRemoteParameterUpdater::getParametersRemote(bool fullSize,
     applyL1 = [](Parameter& para, real decayRate) {
       para.getBuf(PARAMETER_VALUE)->applyL1(/*lr=*/1.0f, decayRate);
     };
+  } else if (pipelineUpdate_) {
+    // Overlaps the push of the last batch, which is waited in finishBatch().
+    getParams = [&] {
+      prefetchClient_->getParameterSparse(
+          /* recvParameterType= */ PARAMETER_VALUE, sendBackParameterType);
+    };
+    applyL1 = [](Parameter& para, real decayRate) {
+      para.getMat(PARAMETER_VALUE)->applyL1(/*lr=*/1.0f, decayRate);
+    };
   } else {
     getParams = [&] {
       parameterClient_->getParameterSparse(
@@ -808,6 +855,7 @@ void SparseRemoteParameterUpdater::loadParametersRemote(
 
 void SparseRemoteParameterUpdater::saveParametersRemote(
     const std::string& dirName) {
+  waitPush();
   if (FLAGS_trainer_id == 0) {
     parameterClient_->saveValueVector(dirName);
   }
@@ -268,6 +268,7 @@ class SparseRemoteParameterUpdater : public ParameterUpdater {
                                int expectedPassCount,
                                bool testing);
   ~SparseRemoteParameterUpdater() {
+    waitPush();
     if (controllerThread_) {
       controllerThread_->join();
     }
@@ -313,11 +314,21 @@ class SparseRemoteParameterUpdater : public ParameterUpdater {
   /// start controller thread
   void startController();
 
+  /// wait for the gradients pushed in the background by finishBatch()
+  void waitPush();
+
  protected:
   /// optimization config
   OptimizationConfig config_;
   /// internal parameter client
   std::unique_ptr<ParameterClient2> parameterClient_;
+  /**
+   * client on its own connections for prefetching the sparse rows while
+   * parameterClient_ is pushing the gradients, if pipelineUpdate_
+   */
+  std::unique_ptr<ParameterClient2> prefetchClient_;
+  bool pipelineUpdate_;
+  bool pushPending_;
   int64_t batchSize_;
   std::unique_ptr<std::thread> controllerThread_;
   int64_t passCount_;
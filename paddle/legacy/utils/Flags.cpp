@@ -55,6 +55,12 @@ DEFINE_int32(ports_num_for_sparse,
              " following ports on parameter server will be visited"
              " for sending sparse parameter:"
              " [port+ports_num, port+ports_num+ports_num_for_sparse-1]");
+DEFINE_bool(pipeline_sparse_remote_update,
+            false,
+            "Push the sparse gradients of a batch in the background, and"
+            " prefetch the sparse rows of the next batch meanwhile on another"
+            " set of connections. Only for AsyncSGD, the prefetched rows may"
+            " miss the update of the last batch");
 DEFINE_string(nics, "xgbe0,xgbe1", "network device name for pservers");
 DEFINE_string(rdma_tcp, "tcp", "use rdma or tcp rdma transport protocol");
 DEFINE_int32(trainer_id,
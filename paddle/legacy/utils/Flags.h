@@ -24,6 +24,7 @@ DECLARE_int32(gpu_id);
 DECLARE_int32(trainer_count);
 DECLARE_int32(ports_num);
 DECLARE_int32(ports_num_for_sparse);
+DECLARE_bool(pipeline_sparse_remote_update);
 DECLARE_string(nics);
 DECLARE_string(rdma_tcp);
 DECLARE_int32(trainer_id);
@@ -44,15 +44,19 @@ from . import clip
 from . import profiler
 from . import unique_name
 from . import recordio_writer
+from . import slot_file_writer
 from . import parallel_executor
 from .parallel_executor import *
+from . import pipeline_executor
+from .pipeline_executor import *
 from paddle.fluid.layers.math_op_patch import monkey_patch_variable
 
 Tensor = LoDTensor
 
 __all__ = framework.__all__ + executor.__all__ + \
     trainer.__all__ + inferencer.__all__ + transpiler.__all__ + \
-    parallel_executor.__all__ + lod_tensor.__all__ + [
+    parallel_executor.__all__ + pipeline_executor.__all__ + \
+    lod_tensor.__all__ + [
         'io',
         'initializer',
         'layers',
@@ -76,6 +80,7 @@ __all__ = framework.__all__ + executor.__all__ + \
         'profiler',
         'unique_name',
         'recordio_writer',
+        'slot_file_writer',
         'Scope',
     ]
 
@@ -114,20 +119,43 @@ def __bootstrap__():
         'eager_delete_scope', 'use_mkldnn', 'initial_cpu_memory_in_mb',
         'init_allocated_mem', 'free_idle_memory', 'paddle_num_threads',
         'dist_threadpool_size', 'cpu_deterministic', 'eager_delete_tensor_gb',
-        'reader_queue_speed_test_mode'
+        'reader_queue_speed_test_mode', 'enable_kernel_cache',
+        'cache_shape_deterministic_outputs',
+        'use_thread_cached_allocator', 'thread_cache_size_in_kb',
+        'recordio_decode_threads', 'recordio_verify_checksum',
+        'recordio_zstd_dict', 'sampling_profiler_period',
+        'profile_perf_counters', 'profile_op_phases', 'cpu_huge_pages',
+        'idle_memory_release_ms', 'idle_memory_reserve_in_mb',
+        'size_class_pool_places', 'size_class_pool_cache_size_in_mb',
+        'cpu_all_reduce_num_threads', 'cpu_unified_runtime',
+        'cpu_runtime_num_threads', 'cpu_runtime_max_io_tasks'
     ]
     if core.is_compiled_with_dist():
         read_env_flags.append('rpc_deadline')
         read_env_flags.append('rpc_server_profile_period')
         read_env_flags.append('rpc_server_profile_path')
+        read_env_flags.append('rpc_server_metrics_port')
         read_env_flags.append('enable_rpc_profiler')
         read_env_flags.append('rpc_send_thread_num')
         read_env_flags.append('rpc_get_thread_num')
         read_env_flags.append('rpc_prefetch_thread_num')
+        read_env_flags.append('rpc_hot_rows_capacity')
+        read_env_flags.append('rpc_hot_rows_report_interval')
+        read_env_flags.append('rpc_send_batch_bytes')
+        read_env_flags.append('rpc_send_batch_delay_ms')
+        read_env_flags.append('rpc_client_cq_num')
+        read_env_flags.append('rpc_client_channel_num')
+        read_env_flags.append('sparse_table_evict_min_freq')
+        read_env_flags.append('sparse_table_evict_ttl')
+        read_env_flags.append('sparse_table_spill_dir')
 
     if core.is_compiled_with_cuda():
         read_env_flags += [
-            'fraction_of_gpu_memory_to_use', 'cudnn_deterministic'
+            'fraction_of_gpu_memory_to_use', 'cudnn_deterministic',
+            'use_stream_ordered_allocator', 'cudnn_exhaustive_search',
+            'cudnn_algo_cache_file', 'use_cuda_pinned_pool',
+            'cuda_pinned_region_size_in_mb', 'cudnn_share_workspace',
+            'conv_cuda_implicit_gemm'
         ]
     core.init_gflags([sys.argv[0]] +
                      ["--tryfromenv=" + ",".join(read_env_flags)])
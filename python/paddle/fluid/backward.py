@@ -339,6 +339,17 @@ def _append_backward_ops_(block,
             if not hasattr(cb, '__call__'):
                 raise ValueError("'callback' must be a callable object.")
 
+    grad_op_descs = _create_grad_op_descs_(block, ops, no_grad_dict,
+                                           grad_to_var, callbacks)
+    _append_grad_op_descs_(block, grad_op_descs, target_block, no_grad_dict,
+                           grad_to_var, callbacks)
+
+
+def _create_grad_op_descs_(block, ops, no_grad_dict, grad_to_var, callbacks):
+    """
+    Create the grad op descs of ops in the reversed order, and the grad ops of
+    their sub-blocks in the new blocks.
+    """
     # grad_op_descs holds created grad_op, and will be appended to target_block
     grad_op_descs = []
     program = block.program
@@ -370,7 +381,15 @@ def _append_backward_ops_(block,
 
         grad_op_descs.extend(grad_op_desc)
         grad_to_var.update(op_grad_to_var)
+    return grad_op_descs
+
 
+def _append_grad_op_descs_(block, grad_op_descs, target_block, no_grad_dict,
+                           grad_to_var, callbacks):
+    """
+    Accumulate the repetitive gradients, remove the unnecessary grad ops, and
+    append the op descs to target_block.
+    """
     grad_op_descs = _addup_repetitive_outputs_(grad_op_descs)
 
     grad_op_descs = _remove_no_grad_branch_(grad_op_descs,
@@ -390,6 +409,122 @@ def _append_backward_ops_(block,
                 cb(block=target_block, context=grad_to_var)
 
 
+def _is_recomputable_(op):
+    """
+    The random ops would not give the same outputs again, and the ops with
+    sub-blocks write the variables of their sub-blocks, which can not be
+    renamed. Their outputs are kept instead of recomputed.
+    """
+    return not op.has_attr("seed") and not op.has_attr("sub_block")
+
+
+def _append_backward_ops_with_checkpoints_(block, ops, target_block,
+                                           no_grad_dict, grad_to_var,
+                                           callbacks, checkpoints,
+                                           recompute_to_var):
+    """
+    Create all grad ops as _append_backward_ops_ does, but only the forward
+    outputs of the checkpoints are used by them. The ops are cut into the
+    segments ending at the ops writing a checkpoint. The forward ops of each
+    segment, except the last one, are copied to write new variables right
+    before its grad ops, which read them instead of the forward outputs. So
+    the forward activations between the checkpoints are freed once the
+    forward uses them.
+
+    Args:
+        checkpoints(set): the names of the checkpoint variables
+        recompute_to_var(dict)(output argument):
+            key(str): recomputed variable name
+            val(str): corresponding forward variable name
+    """
+    segments = [[]]
+    for op in ops:
+        segments[-1].append(op)
+        if _some_in_set_(op.desc.output_arg_names(), checkpoints):
+            segments.append([])
+    if len(segments[-1]) == 0:
+        segments.pop()
+
+    # The checkpoints, the variables not written by ops, such as the feeds and
+    # the parameters, and the outputs of the ops not recomputable are kept.
+    written = set()
+    for op in ops:
+        if _is_recomputable_(op):
+            written.update(op.desc.output_arg_names())
+    written -= set(checkpoints)
+
+    grad_op_descs = []
+    for seg_idx in reversed(range(len(segments))):
+        segment = segments[seg_idx]
+        seg_grad_descs = _create_grad_op_descs_(block, segment, no_grad_dict,
+                                                grad_to_var, callbacks)
+        if seg_idx + 1 == len(segments):
+            # The activations of the last segment are used right away.
+            grad_op_descs.extend(seg_grad_descs)
+            continue
+
+        renamed = dict()
+        for op in segment:
+            if not _is_recomputable_(op):
+                continue
+            for name in op.desc.output_arg_names():
+                if name in written and name not in renamed:
+                    renamed[name] = unique_name.generate(name + "@RECOMPUTE")
+        needed = set()
+        for op_desc in seg_grad_descs:
+            needed.update(
+                [n for n in op_desc.input_arg_names() if n in renamed])
+
+        # Only the ops whose outputs are needed by the later recomputed ops
+        # or the grad ops are recomputed.
+        recompute_descs = []
+        for op in reversed(segment):
+            if not _is_recomputable_(op) or not _some_in_set_(
+                    op.desc.output_arg_names(), needed):
+                continue
+            op_desc = core.OpDesc()
+            op_desc.copy_from(op.desc)
+            for name in op.desc.output_arg_names():
+                if name not in renamed:
+                    # a checkpoint or a kept output is not written again
+                    renamed[name] = unique_name.generate(name + "@RECOMPUTE")
+                op_desc._rename_output(name, renamed[name])
+                recompute_to_var[renamed[name]] = name
+            for name in op.desc.input_arg_names():
+                if name in written and name in renamed:
+                    op_desc._rename_input(name, renamed[name])
+                    needed.add(name)
+            recompute_descs.insert(0, op_desc)
+
+        for op_desc in seg_grad_descs:
+            for name in op_desc.input_arg_names():
+                if name in written and name in renamed:
+                    op_desc._rename_input(name, renamed[name])
+        grad_op_descs.extend(recompute_descs)
+        grad_op_descs.extend(seg_grad_descs)
+
+    _append_grad_op_descs_(block, grad_op_descs, target_block, no_grad_dict,
+                           grad_to_var, callbacks)
+
+
+def _create_recompute_vars_(block, recompute_to_var):
+    """
+    Create the recomputed variables as their forward variables.
+    """
+    for name, fwd_name in six.iteritems(recompute_to_var):
+        fwd_var = block.desc.find_var_recursive(cpt.to_bytes(fwd_name))
+        var = block.desc.var(cpt.to_bytes(name))
+        var.set_type(fwd_var.type())
+        if fwd_var.type() in [
+                core.VarDesc.VarType.LOD_TENSOR,
+                core.VarDesc.VarType.SELECTED_ROWS
+        ]:
+            var.set_shape(fwd_var.shape())
+            var.set_dtype(fwd_var.dtype())
+        if fwd_var.type() == core.VarDesc.VarType.LOD_TENSOR:
+            var.set_lod_level(fwd_var.lod_level())
+
+
 def _append_backward_vars_(block, start_op_idx, grad_to_var, grad_info_map):
     """
     Create new variables required by backward pass.
@@ -466,8 +601,11 @@ def _get_stop_gradients_(program):
     return no_grad_dict
 
 
-def append_backward(loss, parameter_list=None, no_grad_set=None,
-                    callbacks=None):
+def append_backward(loss,
+                    parameter_list=None,
+                    no_grad_set=None,
+                    callbacks=None,
+                    checkpoints=None):
     """
     Append backward part to main_program.
 
@@ -512,6 +650,15 @@ def append_backward(loss, parameter_list=None, no_grad_set=None,
                                                and the value is the op_desc of the
                                                gradient operator who has just
                                                triggered the callable object.
+        checkpoints(list[Variable|string]|None): The checkpoint variables in
+                                               the Block 0. If it is set, the
+                                               forward activations between
+                                               the checkpoints are freed
+                                               after the forward, and
+                                               recomputed from the
+                                               checkpoints right before
+                                               their grad operators.
+                                               Default: None
 
     Returns:
         list[(Variable,Variable)]: Pairs of parameter and its
@@ -579,14 +726,26 @@ def append_backward(loss, parameter_list=None, no_grad_set=None,
     op_path = _find_op_path_(root_block, [loss], [], block_no_grad_set)
     no_grad_dict[0].update(list(map(_append_grad_suffix_, block_no_grad_set)))
 
-    _append_backward_ops_(root_block, op_path, root_block, no_grad_dict,
-                          grad_to_var, callbacks)
+    recompute_to_var = dict()
+    if checkpoints:
+        checkpoint_names = set([
+            cpt.to_text(var.name if isinstance(var, framework.Variable) else
+                        var) for var in checkpoints
+        ])
+        _append_backward_ops_with_checkpoints_(
+            root_block, op_path, root_block, no_grad_dict, grad_to_var,
+            callbacks, checkpoint_names, recompute_to_var)
+    else:
+        _append_backward_ops_(root_block, op_path, root_block, no_grad_dict,
+                              grad_to_var, callbacks)
 
     # Because calc_gradient may be called multiple times,
     # we need rename the internal gradient variables so that they have
     # different names.
     _rename_grad_(root_block, fwd_op_num, grad_to_var, {})
 
+    _create_recompute_vars_(root_block, recompute_to_var)
+
     _append_backward_vars_(root_block, fwd_op_num, grad_to_var, grad_info_map)
 
     program.current_block_idx = current_block_idx
@@ -0,0 +1,292 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+from ... import core
+from ... import layers
+from ...backward import append_backward
+from ...clip import append_gradient_clip_ops, error_clip_callback
+from ...framework import program_guard
+from ...layers.control_flow import ConditionalBlock
+from ...regularizer import append_regularization_ops
+from ... import unique_name
+from .fp16_lists import AutoMixedPrecisionLists
+from .fp16_utils import rewrite_program
+
+__all__ = ["decorate"]
+
+
+class OptimizerWithMixedPrecision(object):
+    """
+    Optimizer with mixed precision training, returned by decorate. The
+    forward operators are rewritten to the dtype of the operator lists,
+    float16 or bfloat16, the loss is multiplied by the loss scaling before
+    the backward, and the gradients are unscaled before the optimizer updates
+    the float32 parameters.
+
+    The loss scaling is updated on the device. The gradients of a step with
+    any Inf or NaN gradient are zeroed, and the optimization operators run in
+    a conditional block on the flag of all the gradients being finite, so
+    that the step changes neither the parameters nor the accumulators, e.g.
+    the velocity of Momentum or the moments of Adam. The flag is read by the
+    host to run the block.
+
+    Args:
+        optimizer (Optimizer): The optimizer updating the parameters.
+        amp_lists (AutoMixedPrecisionLists): The operator lists.
+        init_loss_scaling (float): The initial loss scaling.
+        use_dynamic_loss_scaling (bool): Whether to update the loss scaling.
+        incr_every_n_steps (int): Increase the loss scaling after this number
+            of consecutive steps with finite gradients.
+        decr_every_n_nan_or_inf (int): Decrease the loss scaling after this
+            number of consecutive steps with overflowing gradients.
+        incr_ratio (float): The ratio to increase the loss scaling.
+        decr_ratio (float): The ratio to decrease the loss scaling.
+    """
+
+    def __init__(self, optimizer, amp_lists, init_loss_scaling,
+                 use_dynamic_loss_scaling, incr_every_n_steps,
+                 decr_every_n_nan_or_inf, incr_ratio, decr_ratio):
+        self._optimizer = optimizer
+        self._amp_lists = amp_lists
+        self._init_loss_scaling = init_loss_scaling
+        self._use_dynamic_loss_scaling = use_dynamic_loss_scaling
+        self._incr_every_n_steps = incr_every_n_steps
+        self._decr_every_n_nan_or_inf = decr_every_n_nan_or_inf
+        self._incr_ratio = incr_ratio
+        self._decr_ratio = decr_ratio
+        self._loss = None
+        self._loss_scaling = None
+        self._num_good_steps = None
+        self._num_bad_steps = None
+
+    def get_loss_scaling(self):
+        """Return the variable of the loss scaling, created by backward."""
+        return self._loss_scaling
+
+    def _create_loss_scaling_vars(self):
+        self._loss_scaling = layers.create_global_var(
+            name=unique_name.generate("loss_scaling"),
+            shape=[1],
+            value=self._init_loss_scaling,
+            dtype='float32',
+            persistable=True)
+        self._num_good_steps = layers.create_global_var(
+            name=unique_name.generate("num_good_steps"),
+            shape=[1],
+            value=0,
+            dtype='int32',
+            persistable=True)
+        self._num_bad_steps = layers.create_global_var(
+            name=unique_name.generate("num_bad_steps"),
+            shape=[1],
+            value=0,
+            dtype='int32',
+            persistable=True)
+
+    def backward(self,
+                 loss,
+                 startup_program=None,
+                 parameter_list=None,
+                 no_grad_set=None):
+        """
+        Rewrite the program of loss to mixed precision, and append the
+        backward of the scaled loss.
+
+        Args:
+            loss (Variable): The loss to minimize.
+            startup_program (Program|None): The startup program initializing
+                the loss scaling.
+            parameter_list (list|None): The parameters to update.
+            no_grad_set (set|None): The variables without gradients.
+
+        Returns:
+            A tuple of the scaled loss and the list of (param, scaled grad).
+        """
+        with program_guard(loss.block.program, startup_program):
+            rewrite_program(loss.block.program, self._amp_lists)
+            if loss.dtype != core.VarDesc.VarType.FP32:
+                loss = layers.cast(loss, 'float32')
+            self._loss = loss
+            self._create_loss_scaling_vars()
+            scaled_loss = layers.elementwise_mul(loss, self._loss_scaling)
+            params_grads = append_backward(scaled_loss, parameter_list,
+                                           no_grad_set, [error_clip_callback])
+        return scaled_loss, params_grads
+
+    def apply_gradients(self, params_grads, startup_program=None):
+        """
+        Unscale the gradients, update the loss scaling and append the
+        optimization operators.
+
+        Args:
+            params_grads (list): The list of (param, scaled grad) returned by
+                backward.
+            startup_program (Program|None): The startup program of the
+                optimizer.
+
+        Returns:
+            The list of the optimization operators, which are in the
+            conditional block on the gradients being finite if there is any
+            gradient.
+        """
+        program = self._loss.block.program
+        with program_guard(program, startup_program):
+            block = program.global_block()
+            grads = [g for _, g in params_grads if g is not None]
+            all_finite = None
+            for grad in grads:
+                finite = block.create_var(
+                    name=unique_name.generate("isfinite"), dtype='bool')
+                block.append_op(
+                    type='isfinite',
+                    inputs={'X': grad},
+                    outputs={'Out': finite})
+                if all_finite is None:
+                    all_finite = finite
+                else:
+                    all_finite = layers.logical_and(all_finite, finite)
+
+            if all_finite is not None:
+                # A static loss scaling is never multiplied.
+                dynamic = self._use_dynamic_loss_scaling
+                block.append_op(
+                    type='update_loss_scaling',
+                    inputs={
+                        'X': grads,
+                        'AllFinite': all_finite,
+                        'LossScaling': self._loss_scaling,
+                        'GoodSteps': self._num_good_steps,
+                        'BadSteps': self._num_bad_steps
+                    },
+                    outputs={
+                        'Out': grads,
+                        'LossScalingOut': self._loss_scaling,
+                        'GoodStepsOut': self._num_good_steps,
+                        'BadStepsOut': self._num_bad_steps
+                    },
+                    attrs={
+                        'incr_every_n_steps': self._incr_every_n_steps,
+                        'decr_every_n_nan_or_inf':
+                        self._decr_every_n_nan_or_inf,
+                        'incr_ratio': self._incr_ratio if dynamic else 1.0,
+                        'decr_ratio': self._decr_ratio if dynamic else 1.0
+                    })
+
+            params_grads = sorted(params_grads, key=lambda x: x[0].name)
+            params_grads = append_gradient_clip_ops(params_grads)
+            params_grads = append_regularization_ops(
+                params_grads, self._optimizer.regularization)
+            if all_finite is None:
+                return self._optimizer._create_optimization_pass(
+                    params_grads, self._loss, startup_program)
+            # The optimizers still move the parameters by their accumulators
+            # with zero gradients, so they are skipped in the overflowing
+            # steps.
+            finite_block = ConditionalBlock(
+                [all_finite], is_scalar_condition=True)
+            with finite_block.block():
+                optimize_ops = self._optimizer._create_optimization_pass(
+                    params_grads, self._loss, startup_program)
+        return optimize_ops
+
+    def minimize(self,
+                 loss,
+                 startup_program=None,
+                 parameter_list=None,
+                 no_grad_set=None):
+        """
+        Append the backward of the scaled loss and the optimization
+        operators.
+
+        Args:
+            loss (Variable): The loss to minimize.
+            startup_program (Program|None): The startup program.
+            parameter_list (list|None): The parameters to update.
+            no_grad_set (set|None): The variables without gradients.
+
+        Returns:
+            A tuple of the optimization operators and the list of
+            (param, grad).
+        """
+        scaled_loss, params_grads = self.backward(
+            loss, startup_program, parameter_list, no_grad_set)
+        optimize_ops = self.apply_gradients(params_grads, startup_program)
+        return optimize_ops, params_grads
+
+
+def decorate(optimizer,
+             amp_lists=None,
+             init_loss_scaling=None,
+             incr_every_n_steps=1000,
+             decr_every_n_nan_or_inf=2,
+             incr_ratio=2.0,
+             decr_ratio=0.5,
+             use_dynamic_loss_scaling=None,
+             dtype='float16'):
+    """
+    Decorate an optimizer to train the program in mixed precision, with the
+    operators of the float16 white list running on the tensor cores, or the
+    operators of the bfloat16 white list running on CPU.
+
+    The bfloat16 has the exponent range of float32, so its gradients hardly
+    underflow, and the loss is not scaled by default.
+
+    Args:
+        optimizer (Optimizer): The optimizer to decorate.
+        amp_lists (AutoMixedPrecisionLists|None): The operator lists, the
+            default lists of dtype if None.
+        init_loss_scaling (float|None): The initial loss scaling, 2**15 for
+            float16 and 1.0 for bfloat16 if None.
+        incr_every_n_steps (int): Increase the loss scaling after this number
+            of consecutive steps with finite gradients.
+        decr_every_n_nan_or_inf (int): Decrease the loss scaling after this
+            number of consecutive steps with overflowing gradients.
+        incr_ratio (float): The ratio to increase the loss scaling.
+        decr_ratio (float): The ratio to decrease the loss scaling.
+        use_dynamic_loss_scaling (bool|None): Whether to update the loss
+            scaling, the steps with overflowing gradients are skipped either
+            way. True for float16 and False for bfloat16 if None.
+        dtype (str): The low precision, 'float16' or 'bfloat16'.
+
+    Returns:
+        An optimizer with mixed precision training.
+
+    Examples:
+        .. code-block:: python
+
+            loss = network()
+            optimizer = fluid.optimizer.Momentum(
+                learning_rate=0.1, momentum=0.9)
+            mp_optimizer = fluid.contrib.mixed_precision.decorate(optimizer)
+            mp_optimizer.minimize(loss)
+
+            # bfloat16 on CPU
+            bf16_optimizer = fluid.contrib.mixed_precision.decorate(
+                optimizer, dtype='bfloat16')
+    """
+    if amp_lists is None:
+        amp_lists = AutoMixedPrecisionLists(dtype=dtype)
+    elif amp_lists.dtype != dtype:
+        raise ValueError("The operator lists of %s do not match the dtype %s" %
+                         (amp_lists.dtype, dtype))
+    bf16 = dtype == 'bfloat16'
+    if init_loss_scaling is None:
+        init_loss_scaling = 1.0 if bf16 else 2**15
+    if use_dynamic_loss_scaling is None:
+        use_dynamic_loss_scaling = not bf16
+    return OptimizerWithMixedPrecision(
+        optimizer, amp_lists, init_loss_scaling, use_dynamic_loss_scaling,
+        incr_every_n_steps, decr_every_n_nan_or_inf, incr_ratio, decr_ratio)
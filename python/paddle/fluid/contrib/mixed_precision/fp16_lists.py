@@ -0,0 +1,136 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import copy
+
+__all__ = ["AutoMixedPrecisionLists"]
+
+
+class AutoMixedPrecisionLists(object):
+    """
+    AutoMixedPrecisionLists is a class for the operator lists of mixed
+    precision training, the operators of the white list run in float16, the
+    ones of the black list run in float32, and the ones of the gray list run
+    in float16 if their inputs produced by other operators are all float16.
+    The other operators run in float32.
+
+    Args:
+        custom_white_list (set): Users' custom white list, its operators are
+            moved from the other lists to the white list.
+        custom_black_list (set): Users' custom black list, its operators are
+            moved from the other lists to the black list.
+        dtype (str): 'float16' for the tensor cores of GPU, or 'bfloat16' for
+            CPU, whose white and gray lists only have the operators having
+            bfloat16 CPU kernels.
+    """
+
+    def __init__(self,
+                 custom_white_list=None,
+                 custom_black_list=None,
+                 dtype='float16'):
+        if dtype not in ['float16', 'bfloat16']:
+            raise ValueError("Mixed precision only supports float16 and "
+                             "bfloat16, but got %s" % dtype)
+        self.dtype = dtype
+        self._custom_white_list = custom_white_list
+        self._custom_black_list = custom_black_list
+        if dtype == 'bfloat16':
+            self.white_list = copy.copy(bf16_white_list)
+            self.gray_list = copy.copy(bf16_gray_list)
+        else:
+            self.white_list = copy.copy(white_list)
+            self.gray_list = copy.copy(gray_list)
+        self.black_list = copy.copy(black_list)
+        self._update_list()
+
+    def _update_list(self):
+        """
+        Update the black, white and gray lists according to users' custom
+        lists.
+        """
+        if self._custom_white_list and self._custom_black_list:
+            for op_name in self._custom_white_list:
+                if op_name in self._custom_black_list:
+                    raise ValueError("Custom white list overlap "
+                                     "custom black list")
+        if self._custom_white_list:
+            for op_name in self._custom_white_list:
+                self.black_list.discard(op_name)
+                self.gray_list.discard(op_name)
+                self.white_list.add(op_name)
+        if self._custom_black_list:
+            for op_name in self._custom_black_list:
+                self.white_list.discard(op_name)
+                self.gray_list.discard(op_name)
+                self.black_list.add(op_name)
+
+
+# The operators benefiting from the tensor cores, which are numerically safe
+# in float16.
+white_list = {
+    'conv2d',
+    'matmul',
+    'mul',
+}
+
+# The operators numerically dangerous in float16, their results may
+# overflow, e.g. exp, or lose the precision of the accumulation, e.g. mean,
+# and the ones without a float16 gradient kernel.
+black_list = {
+    'exp',
+    'log',
+    'square',
+    'pow',
+    'mean',
+    'sum',
+    'reduce_sum',
+    'reduce_mean',
+    'softmax',
+    'softmax_with_cross_entropy',
+    'chunked_softmax_with_cross_entropy',
+    'sigmoid_cross_entropy_with_logits',
+    'cross_entropy',
+    'batch_norm',
+    'layer_norm',
+}
+
+# The operators running in the precision of their inputs.
+gray_list = {
+    'elementwise_add',
+    'relu',
+    'leaky_relu',
+    'tanh',
+    'sigmoid',
+    'pool2d',
+    'dropout',
+    'scale',
+    'reshape2',
+    'transpose2',
+}
+
+# The operators having the bfloat16 CPU kernels, the GEMMs of mul and conv2d
+# accumulate in float32.
+bf16_white_list = {
+    'conv2d',
+    'mul',
+}
+
+bf16_gray_list = {
+    'elementwise_add',
+    'elementwise_mul',
+    'relu',
+    'leaky_relu',
+    'tanh',
+    'sigmoid',
+}
@@ -0,0 +1,164 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+from ... import core
+
+__all__ = ["rewrite_program"]
+
+_valid_types = [
+    core.VarDesc.VarType.LOD_TENSOR, core.VarDesc.VarType.SELECTED_ROWS,
+    core.VarDesc.VarType.LOD_TENSOR_ARRAY
+]
+
+
+def _dtype_to_str(dtype):
+    """
+    Convert specific variable type to its corresponding string.
+
+    Args:
+        dtype (VarType): Variable type.
+    """
+    if dtype == core.VarDesc.VarType.FP16:
+        return 'fp16'
+    elif dtype == core.VarDesc.VarType.BF16:
+        return 'bf16'
+    else:
+        return 'fp32'
+
+
+def _insert_cast_op(block, op, idx, src_dtype, dest_dtype):
+    """
+    Insert the cast ops before op to cast its inputs of src_dtype to
+    dest_dtype, and set the dtype of its float32 outputs to dest_dtype if
+    dest_dtype is float16 or bfloat16.
+
+    Args:
+        block (Block): The block of op.
+        op (Operator): The operator to run in dest_dtype.
+        idx (int): The index of op in block.
+        src_dtype (VarType): The input dtype to cast from.
+        dest_dtype (VarType): The dtype op runs in.
+
+    Returns:
+        int: The number of the inserted cast ops.
+    """
+    num_cast_ops = 0
+    for in_name in op.input_names:
+        for in_var_name in op.input(in_name):
+            in_var = block._var_recursive(in_var_name)
+            if in_var.type not in _valid_types or in_var.dtype != src_dtype:
+                continue
+            cast_name = in_var.name + '.cast_' + _dtype_to_str(dest_dtype)
+            out_var = block.vars.get(cast_name)
+            # The cast of a variable is shared by its consumers.
+            if out_var is None or out_var.dtype != dest_dtype:
+                out_var = block.create_var(
+                    name=cast_name,
+                    dtype=dest_dtype,
+                    persistable=False,
+                    stop_gradient=in_var.stop_gradient)
+                block._insert_op(
+                    idx,
+                    type="cast",
+                    inputs={"X": in_var},
+                    outputs={"Out": out_var},
+                    attrs={
+                        "in_dtype": in_var.dtype,
+                        "out_dtype": out_var.dtype
+                    })
+                num_cast_ops += 1
+            op._rename_input(in_var.name, out_var.name)
+
+    if dest_dtype != core.VarDesc.VarType.FP32:
+        for out_name in op.output_names:
+            for out_var_name in op.output(out_name):
+                out_var = block._var_recursive(out_var_name)
+                if out_var.type not in _valid_types:
+                    continue
+                if out_var.dtype == src_dtype:
+                    out_var.desc.set_dtype(dest_dtype)
+    return num_cast_ops
+
+
+def _is_fp16_supported(op, dtype):
+    """
+    Whether op has the kernels of dtype. The plain CUDA kernels of the ops
+    with a cuDNN implementation have no float16 kernels, and the MKLDNN
+    kernels have no bfloat16 kernels.
+    """
+    if dtype == core.VarDesc.VarType.BF16:
+        return not op.has_attr('use_mkldnn') or not op.attr('use_mkldnn')
+    return not op.has_attr('use_cudnn') or op.attr('use_cudnn')
+
+
+def rewrite_program(main_prog, amp_lists):
+    """
+    Rewrite the forward operators of the global block of main_prog to run in
+    float16, or bfloat16 if amp_lists.dtype is bfloat16, according to
+    amp_lists, the cast ops are inserted between the operators of different
+    precisions. The parameters are kept in float32 as the master weights
+    updated by the optimizer, they are cast to the low precision by the
+    operators using them.
+
+    An operator of the white list runs in the low precision, and an operator
+    of the gray list runs in the low precision if its inputs produced by
+    other operators are all of the low precision and at least one of them
+    is. The other operators run in float32.
+
+    Args:
+        main_prog (Program): The main program, called before the backward.
+        amp_lists (AutoMixedPrecisionLists): The operator lists.
+    """
+    fp32 = core.VarDesc.VarType.FP32
+    # fp16 below is the low precision of amp_lists.
+    if getattr(amp_lists, 'dtype', 'float16') == 'bfloat16':
+        fp16 = core.VarDesc.VarType.BF16
+    else:
+        fp16 = core.VarDesc.VarType.FP16
+    block = main_prog.global_block()
+    ops = list(block.ops)
+
+    fp16_ops = []
+    # Whether the variables are produced by a float16 operator.
+    fp16_vars = {}
+    for op in ops:
+        if op.type == 'cast':
+            is_fp16 = op.attr('out_dtype') == fp16
+        elif not _is_fp16_supported(op, fp16):
+            is_fp16 = False
+        elif op.type in amp_lists.white_list:
+            is_fp16 = True
+        elif op.type in amp_lists.gray_list:
+            produced = [
+                fp16_vars[name] for name in op.input_arg_names
+                if name in fp16_vars
+            ]
+            is_fp16 = len(produced) > 0 and all(produced)
+        else:
+            is_fp16 = False
+        fp16_ops.append(is_fp16)
+        for name in op.output_arg_names:
+            fp16_vars[name] = is_fp16
+
+    idx = 0
+    for op, is_fp16 in zip(ops, fp16_ops):
+        # The cast ops of the users keep their dtypes.
+        if op.type != 'cast':
+            if is_fp16:
+                idx += _insert_cast_op(block, op, idx, fp32, fp16)
+            else:
+                idx += _insert_cast_op(block, op, idx, fp16, fp32)
+        idx += 1
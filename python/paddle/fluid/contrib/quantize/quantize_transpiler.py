@@ -31,6 +31,23 @@ __all__ = ['QuantizeTranspiler']
 
 _QUANTIZABLE_OP_TYPES = ['conv2d', 'depthwise_conv2d', 'mul']
 
+# The attributes of the bits the inputs of the ops and their gradient ops are
+# fake quantized with inside the kernels.
+_FUSED_QUANT_ATTRS = {
+    'conv2d': {
+        'Input': 'input_quant_bits',
+        'Filter': 'filter_quant_bits'
+    },
+    'depthwise_conv2d': {
+        'Input': 'input_quant_bits',
+        'Filter': 'filter_quant_bits'
+    },
+    'mul': {
+        'X': 'x_quant_bits',
+        'Y': 'y_quant_bits'
+    },
+}
+
 
 def _quantized_var_name(var_name):
     """
@@ -210,6 +227,91 @@ class QuantizeTranspiler(object):
                     if op.type in grad_op_types:
                         _transpile_backward(block, op)
 
+    def fuse_fake_quant_ops(self, program=None):
+        """Collapse the pairs of fake_quantize_abs_max and
+        fake_dequantize_max_abs inserted by training_transpile into the
+        conv2d, depthwise_conv2d and mul ops and their gradient ops, which
+        then fake quantize their inputs inside the CPU kernels without
+        writing the quantized tensors, and pass the gradients straight
+        through the quantization as before.
+
+        Only the pairs used by nothing but these ops are collapsed, the
+        range_abs_max quantization keeps its ops. Call it on the training
+        program after training_transpile, and keep the test program unfused
+        so that freeze_program can freeze it.
+
+        Args:
+            program (Program): the program transpiled by training_transpile.
+
+        Examples:
+
+        .. code-block:: python
+
+            t = fluid.contrib.QuantizeTranspiler()
+            t.training_transpile(main_program)
+            t.fuse_fake_quant_ops(main_program)
+        """
+        program = default_main_program() if program is None else program
+
+        def _fused_attrs(op):
+            op_type = op.type
+            if op_type.endswith('_grad'):
+                op_type = op_type[:-len('_grad')]
+            return _FUSED_QUANT_ATTRS.get(op_type)
+
+        def _fusable(op, name):
+            attrs = _fused_attrs(op)
+            if attrs is None:
+                return False
+            if op.has_attr('use_mkldnn') and op.attr('use_mkldnn'):
+                return False
+            for slot in op.input_names:
+                if name in op.input(slot) and slot not in attrs:
+                    return False
+            return True
+
+        for block in program.blocks:
+            producers = {}
+            users = collections.defaultdict(list)
+            for op in block.ops:
+                for name in op.output_arg_names:
+                    producers[name] = op
+                for name in op.input_arg_names:
+                    users[name].append(op)
+
+            pairs = []
+            for op in block.ops:
+                if op.type != 'fake_dequantize_max_abs':
+                    continue
+                quant_name = op.input('X')[0]
+                scale_name = op.input('Scale')[0]
+                quant_op = producers.get(quant_name)
+                if quant_op is None or \
+                        quant_op.type != 'fake_quantize_abs_max' or \
+                        quant_op.output('OutScale')[0] != scale_name:
+                    continue
+                bits = quant_op.attr('bit_length')
+                if op.attr('max_range') != float((1 << (bits - 1)) - 1):
+                    continue
+                if len(users[quant_name]) != 1 or len(users[scale_name]) != 1:
+                    continue
+                dequant_name = op.output('Out')[0]
+                if not all(_fusable(u, dequant_name)
+                           for u in users[dequant_name]):
+                    continue
+                pairs.append((quant_op, op, dequant_name, bits))
+
+            for quant_op, dequant_op, dequant_name, bits in pairs:
+                name = quant_op.input('X')[0]
+                for user in users[dequant_name]:
+                    for slot, attr in _fused_attrs(user).items():
+                        if dequant_name in user.input(slot):
+                            user._set_attr(attr, bits)
+                    user._rename_input(dequant_name, name)
+                block._remove_op(block.ops.index(quant_op))
+                block._remove_op(block.ops.index(dequant_op))
+        self._remove_unused_var(program)
+
     def _create_global_step(self):
         if self.weight_quantize_type == 'range_abs_max' or \
             self.activation_quantize_type == 'range_abs_max':
@@ -0,0 +1,174 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+from paddle.fluid.contrib.mixed_precision import AutoMixedPrecisionLists
+from paddle.fluid.contrib.mixed_precision import decorate
+
+
+def fc_net():
+    image = fluid.layers.data(name='image', shape=[32], dtype='float32')
+    label = fluid.layers.data(name='label', shape=[1], dtype='int64')
+    hidden = fluid.layers.fc(image, size=64, act='relu')
+    hidden = fluid.layers.fc(hidden, size=64, act='relu')
+    logits = fluid.layers.fc(hidden, size=10)
+    loss = fluid.layers.softmax_with_cross_entropy(logits, label)
+    return fluid.layers.mean(loss)
+
+
+class TestMixedPrecision(unittest.TestCase):
+    def build(self, optimizer=None, **kwargs):
+        main = fluid.Program()
+        startup = fluid.Program()
+        with fluid.program_guard(main, startup):
+            loss = fc_net()
+            if optimizer is None:
+                optimizer = fluid.optimizer.SGD(learning_rate=0.01)
+            optimizer = decorate(optimizer, **kwargs)
+            optimizer.minimize(loss)
+        return main, startup, loss, optimizer
+
+    def all_ops(self, program):
+        return [op for block in program.blocks for op in block.ops]
+
+    def test_rewrite(self):
+        main, _, _, _ = self.build()
+        block = main.global_block()
+        fp16 = core.VarDesc.VarType.FP16
+        fp32 = core.VarDesc.VarType.FP32
+        for op in self.all_ops(main):
+            if op.type == 'mul':
+                for name in op.input_arg_names:
+                    self.assertEqual(block.var(name).dtype, fp16)
+            if op.type in ['softmax_with_cross_entropy', 'mean']:
+                for name in op.input('Logits' if op.type != 'mean' else 'X'):
+                    self.assertEqual(block.var(name).dtype, fp32)
+            if op.type == 'sgd':
+                # The master weights are updated in float32.
+                for name in op.input_arg_names:
+                    self.assertNotEqual(block.var(name).dtype, fp16)
+        op_types = [op.type for op in block.ops]
+        self.assertIn('cast', op_types)
+        self.assertEqual(op_types.count('update_loss_scaling'), 1)
+        # The parameters are updated only if the gradients are finite.
+        self.assertNotIn('sgd', op_types)
+        self.assertLess(
+            op_types.index('update_loss_scaling'),
+            op_types.index('conditional_block'))
+        self.assertIn('sgd', [op.type for op in main.block(1).ops])
+
+    def test_skip_optimizer(self):
+        adam = fluid.optimizer.Adam(learning_rate=0.01)
+        main, _, _, _ = self.build(optimizer=adam)
+        block = main.global_block()
+        ops = dict((op.type, op) for op in block.ops)
+        self.assertEqual(ops['conditional_block'].input('Cond'),
+                         ops['update_loss_scaling'].input('AllFinite'))
+        # Neither the moments nor the powers of beta are updated in the
+        # overflowing steps.
+        sub_op_types = [op.type for op in main.block(1).ops]
+        self.assertIn('adam', sub_op_types)
+        self.assertIn('scale', sub_op_types)
+        for op in block.ops:
+            self.assertNotEqual(op.type, 'adam')
+
+    def test_rewrite_bf16(self):
+        main, _, _, optimizer = self.build(dtype='bfloat16')
+        block = main.global_block()
+        bf16 = core.VarDesc.VarType.BF16
+        for op in self.all_ops(main):
+            if op.type == 'mul':
+                for name in op.input_arg_names:
+                    self.assertEqual(block.var(name).dtype, bf16)
+            if op.type == 'softmax_with_cross_entropy':
+                for name in op.input('Logits'):
+                    self.assertNotEqual(block.var(name).dtype, bf16)
+            if op.type == 'sgd':
+                for name in op.input_arg_names:
+                    self.assertNotEqual(block.var(name).dtype, bf16)
+        self.assertEqual(optimizer._init_loss_scaling, 1.0)
+        self.assertFalse(optimizer._use_dynamic_loss_scaling)
+        self.assertRaises(
+            ValueError,
+            decorate,
+            fluid.optimizer.SGD(learning_rate=0.01),
+            amp_lists=AutoMixedPrecisionLists(),
+            dtype='bfloat16')
+
+    def test_train_bf16(self):
+        main, startup, loss, _ = self.build(dtype='bfloat16')
+        exe = fluid.Executor(fluid.CPUPlace())
+        exe.run(startup)
+        feed = {
+            'image': np.random.random((8, 32)).astype('float32'),
+            'label': np.random.randint(0, 10, (8, 1)).astype('int64')
+        }
+        losses = []
+        for _ in range(4):
+            loss_v, = exe.run(main, feed=feed, fetch_list=[loss])
+            losses.append(loss_v[0])
+        self.assertTrue(np.isfinite(losses).all())
+        # The float32 master weights are trained in bfloat16.
+        self.assertLess(losses[-1], losses[0])
+
+    def test_custom_lists(self):
+        amp_lists = AutoMixedPrecisionLists(custom_black_list={'mul'})
+        self.assertNotIn('mul', amp_lists.white_list)
+        main, _, _, _ = self.build(amp_lists=amp_lists)
+        for op in self.all_ops(main):
+            self.assertNotEqual(op.type, 'cast')
+        self.assertRaises(
+            ValueError,
+            AutoMixedPrecisionLists,
+            custom_white_list={'mul'},
+            custom_black_list={'mul'})
+
+    def test_train(self):
+        if not core.is_compiled_with_cuda():
+            return
+        main, startup, loss, optimizer = self.build(
+            init_loss_scaling=2**30, incr_every_n_steps=2)
+        place = fluid.CUDAPlace(0)
+        exe = fluid.Executor(place)
+        exe.run(startup)
+        scaling = optimizer.get_loss_scaling()
+        param = main.global_block().all_parameters()[0]
+        feed = {
+            'image': np.random.random((8, 32)).astype('float32'),
+            'label': np.random.randint(0, 10, (8, 1)).astype('int64')
+        }
+        prev_param = np.array(fluid.global_scope().find_var(param.name)
+                              .get_tensor())
+        losses = []
+        for _ in range(4):
+            loss_v, scaling_v = exe.run(main,
+                                        feed=feed,
+                                        fetch_list=[loss, scaling])
+            losses.append(loss_v[0])
+        # The gradients overflow in float16 with the huge scaling, which is
+        # decreased every two steps without updating the parameters.
+        self.assertEqual(scaling_v[0], 2**28)
+        cur_param = np.array(fluid.global_scope().find_var(param.name)
+                             .get_tensor())
+        self.assertTrue(np.array_equal(prev_param, cur_param))
+        self.assertTrue(np.isfinite(losses).all())
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -176,6 +176,63 @@ class TestQuantizeTranspiler(unittest.TestCase):
         self.act_quant_op_type = 'fake_quantize_range_abs_max'
         self.residual_block_quant('range_abs_max')
 
+    def test_fuse_fake_quant_ops(self):
+        def build_program(main, startup):
+            main.random_seed = 1
+            startup.random_seed = 1
+            with fluid.unique_name.guard():
+                with fluid.program_guard(main, startup):
+                    img = fluid.layers.data(
+                        name='image', shape=[1, 8, 8], dtype='float32')
+                    label = fluid.layers.data(
+                        name='label', shape=[1], dtype='int64')
+                    conv = fluid.layers.conv2d(
+                        img, num_filters=4, filter_size=3, act='relu')
+                    prediction = fluid.layers.fc(conv, size=10, act='softmax')
+                    loss = fluid.layers.mean(
+                        fluid.layers.cross_entropy(prediction, label))
+                    fluid.optimizer.SGD(learning_rate=0.1).minimize(loss)
+            return loss
+
+        losses = []
+        for fuse in [False, True]:
+            main = fluid.Program()
+            startup = fluid.Program()
+            loss = build_program(main, startup)
+            t = QuantizeTranspiler()
+            t.training_transpile(main, startup)
+            if fuse:
+                t.fuse_fake_quant_ops(main)
+                op_types = [op.type for op in main.global_block().ops]
+                self.assertNotIn('fake_quantize_abs_max', op_types)
+                self.assertNotIn('fake_dequantize_max_abs', op_types)
+                for op in main.global_block().ops:
+                    if op.type in ['conv2d', 'conv2d_grad']:
+                        self.assertEqual(op.attr('input_quant_bits'), 8)
+                        self.assertEqual(op.attr('filter_quant_bits'), 8)
+                    if op.type in ['mul', 'mul_grad']:
+                        self.assertEqual(op.attr('x_quant_bits'), 8)
+                        self.assertEqual(op.attr('y_quant_bits'), 8)
+
+            np.random.seed(0)
+            exe = fluid.Executor(fluid.CPUPlace())
+            scope = fluid.Scope()
+            with fluid.scope_guard(scope):
+                exe.run(startup)
+                step_losses = []
+                for _ in range(3):
+                    feed = {
+                        'image': np.random.random(
+                            (4, 1, 8, 8)).astype('float32'),
+                        'label': np.random.randint(0, 10, (4, 1)).astype(
+                            'int64')
+                    }
+                    loss_v, = exe.run(main, feed=feed, fetch_list=[loss])
+                    step_losses.append(loss_v[0])
+            losses.append(step_losses)
+        # The fused kernels train as the fake quantization ops do.
+        self.assertTrue(np.allclose(losses[0], losses[1], atol=1e-4))
+
     def freeze_program(self, use_cuda, seed):
         def build_program(main, startup, is_test):
             main.random_seed = seed
@@ -15,7 +15,6 @@
 from __future__ import print_function
 
 from . import core
-import numpy
 import os
 import six
 from six.moves import zip, range, xrange
@@ -26,58 +25,11 @@ from .framework import Variable, default_main_program
 __all__ = ['DataFeeder']
 
 
-class DataToLoDTensorConverter(object):
-    def __init__(self, place, lod_level, shape, dtype):
-        self.place = place
-        self.lod_level = lod_level
-        self.shape = shape
-        negtive_count = 0
-        for s in self.shape:
-            if s < 0:
-                negtive_count += 1
-            if negtive_count > 1:
-                self.shape = None
-                break
-        if dtype == core.VarDesc.VarType.FP32:
-            self.dtype = 'float32'
-        elif dtype == core.VarDesc.VarType.INT64:
-            self.dtype = 'int64'
-        elif dtype == core.VarDesc.VarType.FP64:
-            self.dtype = 'float64'
-        elif dtype == core.VarDesc.VarType.INT32:
-            self.dtype = 'int32'
-        elif dtype == core.VarDesc.VarType.UINT8:
-            self.dtype = 'uint8'
-        else:
-            raise ValueError("dtype must be any of [int32, float32, int64, "
-                             "float64, uint8]")
-
-        self.data = []
-        self.lod = []
-
-        for i in six.moves.range(lod_level):
-            self.lod.append([])
-
-    def feed(self, data):
-        self._feed_impl_(data, self.lod, self.lod_level)
-
-    def _feed_impl_(self, data, lod, lod_level):
-        if lod_level == 0:
-            self.data.append(data)
-        else:
-            lod[0].append(len(data))
-            for each_data in data:
-                self._feed_impl_(each_data, lod[1:], lod_level - 1)
-
-    def done(self):
-        arr = numpy.array(self.data, dtype=self.dtype)
-        if self.shape and len(arr.shape) != len(self.shape):
-            arr = arr.reshape(self.shape)
-        t = core.LoDTensor()
-        t.set(arr, self.place)
-        if self.lod_level > 0:
-            t.set_recursive_sequence_lengths(self.lod)
-        return t
+_SUPPORTED_DTYPES = [
+    core.VarDesc.VarType.FP32, core.VarDesc.VarType.INT64,
+    core.VarDesc.VarType.FP64, core.VarDesc.VarType.INT32,
+    core.VarDesc.VarType.UINT8
+]
 
 
 class DataFeeder(object):
@@ -159,6 +111,9 @@ class DataFeeder(object):
             if batch_size_dim == -1:
                 raise ValueError("Variable {0} must has a batch size dimension",
                                  each_var.name)
+            if each_var.dtype not in _SUPPORTED_DTYPES:
+                raise ValueError("dtype must be any of [int32, float32, int64, "
+                                 "float64, uint8]")
             self.feed_lod_level.append(each_var.lod_level)
             self.feed_shapes.append(shape)
 
@@ -175,28 +130,29 @@ class DataFeeder(object):
         Returns:
             dict: the result of conversion.
         """
-        converter = []
-        for lod_level, shape, dtype in six.moves.zip(
-                self.feed_lod_level, self.feed_shapes, self.feed_dtypes):
-            converter.append(
-                DataToLoDTensorConverter(
-                    place=self.place,
-                    lod_level=lod_level,
-                    shape=shape,
-                    dtype=dtype))
-
+        slots = [[] for _ in self.feed_names]
         for each_sample in iterable:
-            assert len(each_sample) == len(converter), (
+            assert len(each_sample) == len(slots), (
                 "The number of fields in data (%s) does not match " +
-                "len(feed_list) (%s)") % (len(each_sample), len(converter))
-            for each_converter, each_slot in six.moves.zip(converter,
-                                                           each_sample):
-                each_converter.feed(each_slot)
-        ret_dict = {}
-        for each_name, each_converter in six.moves.zip(self.feed_names,
-                                                       converter):
-            ret_dict[each_name] = each_converter.done()
-        return ret_dict
+                "len(feed_list) (%s)") % (len(each_sample), len(slots))
+            for each_slot, each_data in six.moves.zip(slots, each_sample):
+                each_slot.append(each_data)
+
+        # The tensors are filled in C++, the data for a GPU is staged in
+        # pinned memory and the slots are copied in threads.
+        assembler = core.BatchAssembler(
+            self.place,
+            use_pinned_memory=isinstance(self.place, core.CUDAPlace),
+            num_threads=min(len(slots), multiprocessing.cpu_count()))
+        shapes = []
+        for shape in self.feed_shapes:
+            # The batch size dimension is inferred if it is the only
+            # negative one, the shape of the data is kept otherwise.
+            negative_count = len([s for s in shape if s < 0])
+            shapes.append(list(shape) if negative_count == 1 else [])
+        tensors = assembler.assemble(slots, self.feed_lod_level, shapes,
+                                     self.feed_dtypes)
+        return dict(six.moves.zip(self.feed_names, tensors))
 
     def feed_parallel(self, iterable, num_places=None):
         """
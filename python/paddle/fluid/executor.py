@@ -79,18 +79,27 @@ def as_numpy(tensor):
     Returns:
         numpy.ndarray
     """
+    return _as_numpy(tensor, copy=True)
+
+
+def _as_numpy(tensor, copy):
+    # Without copy, the ndarray uses the memory of the CPU tensor, which must
+    # not be reused by the later runs.
     if isinstance(tensor, core.LoDTensorArray):
-        return [as_numpy(t) for t in tensor]
+        return [_as_numpy(t, copy) for t in tensor]
     if isinstance(tensor, list):
-        return [as_numpy(t) for t in tensor]
+        return [_as_numpy(t, copy) for t in tensor]
     assert isinstance(tensor, core.LoDTensor)
+    # Nothing is fetched yet, e.g. by the first run delaying the fetches.
+    if not tensor._is_initialized():
+        return None
     lod = tensor.lod()
     if len(lod) > 0:
         raise RuntimeError("Some of your fetched tensors hold LoD information. \
             They can not be completely cast to Python ndarray. \
             Please set the parameter 'return_numpy' as 'False' to \
             return LoDTensor itself directly.")
-    return np.array(tensor)
+    return np.array(tensor, copy=copy)
 
 
 def has_feed_operators(block, feed_targets, feed_holder_name):
@@ -249,10 +258,61 @@ def _as_lodtensor(data, place):
                 ")
     # single tensor case
     tensor = core.LoDTensor()
-    tensor.set(data, place)
+    if isinstance(place, core.CPUPlace):
+        # The operators writing the feed tensor copy it first, so it can use
+        # the memory of the array.
+        tensor.set(data, place, zero_copy=True)
+    else:
+        tensor.set(data, place)
     return tensor
 
 
+class RunHandle(object):
+    """
+    The handle of a run started by :code:`Executor.run_async` or
+    :code:`ParallelExecutor.run_async`. The run does not hold the GIL, so
+    Python can prepare the next batch meanwhile. The fetched results are
+    converted when :code:`result()` is called.
+    """
+
+    def __init__(self, handle, return_numpy):
+        self._handle = handle
+        self._return_numpy = return_numpy
+        self._result = None
+
+    def done(self):
+        """
+        Return whether the run has finished.
+        """
+        return self._handle.is_done()
+
+    def wait(self):
+        """
+        Wait for the run to finish, raise the error of the run if it failed.
+        """
+        self._handle.wait()
+
+    def result(self):
+        """
+        Wait for the run to finish, and return the fetched results as
+        :code:`run` does.
+        """
+        if self._result is None:
+            arr = self._handle.fetched()
+            if self._return_numpy:
+                self._result = _as_numpy(arr, copy=False)
+            else:
+                self._result = [arr[i] for i in six.moves.range(len(arr))]
+        return self._result
+
+    def _wait_quietly(self):
+        # The error of the run is raised by wait() or result().
+        try:
+            self._handle.wait()
+        except Exception:
+            pass
+
+
 class Executor(object):
     """
     An Executor in Python, only support the single-GPU running. For multi-cards, please refer to
@@ -280,6 +340,7 @@ class Executor(object):
         self.executor = core.Executor(p)
         self.program_caches = dict()
         self._closed = False
+        self._pending = None
 
     def _get_program_cache(self, program_cache_key):
         return self.program_caches.get(program_cache_key, None)
@@ -368,9 +429,17 @@ class Executor(object):
             >>> exe.close()
         """
         if not self._closed:
+            self._wait_pending()
             self.executor.close()
             self._closed = True
 
+    def _wait_pending(self):
+        # The runs of an executor are serial, the next one waits for the
+        # last asynchronous run.
+        if self._pending is not None:
+            self._pending._wait_quietly()
+            self._pending = None
+
     def run(self,
             program=None,
             feed=None,
@@ -423,8 +492,61 @@ class Executor(object):
             >>>     fetch_list=[loss.name])
         """
 
+        program, fetch_list, scope = self._prepare(
+            program, feed, fetch_list, feed_var_name, fetch_var_name, scope,
+            use_program_cache)
+        self.executor.run(program.desc, scope, 0, True, True,
+                          use_program_cache)
+        outs = self._fetch_data(fetch_list, fetch_var_name, scope)
+        if return_numpy:
+            # The fetch operators write the new results to new tensors.
+            outs = _as_numpy(outs, copy=False)
+        return outs
+
+    def run_async(self,
+                  program=None,
+                  feed=None,
+                  fetch_list=None,
+                  feed_var_name='feed',
+                  fetch_var_name='fetch',
+                  scope=None,
+                  return_numpy=True,
+                  use_program_cache=False):
+        """
+        Start to run program like :code:`run`, and return a
+        :code:`RunHandle` of the run without waiting for it. The run does not
+        hold the GIL, so Python can prepare the next batch meanwhile. The
+        next run of this Executor waits for it.
+
+        Args:
+            The same as :code:`run`.
+
+        Returns:
+            RunHandle: the handle of the run, :code:`handle.result()` returns
+            the fetch result according to fetch_list.
+
+        Examples:
+
+            >>> handle = exe.run_async(feed={'X': x}, fetch_list=[loss.name])
+            >>> # prepare the next batch while the program runs
+            >>> x = numpy.random.random(size=(10, 1)).astype('float32')
+            >>> loss_value, = handle.result()
+        """
+        program, fetch_list, scope = self._prepare(
+            program, feed, fetch_list, feed_var_name, fetch_var_name, scope,
+            use_program_cache)
+        handle = RunHandle(
+            self.executor.run_async(program.desc, scope, fetch_var_name,
+                                    len(fetch_list), use_program_cache),
+            return_numpy)
+        self._pending = handle
+        return handle
+
+    def _prepare(self, program, feed, fetch_list, feed_var_name,
+                 fetch_var_name, scope, use_program_cache):
         if self._closed:
             raise RuntimeError("Attempted to use a closed Executor")
+        self._wait_pending()
 
         if feed is None:
             feed = {}
@@ -458,7 +580,9 @@ class Executor(object):
                 self._add_program_cache(cache_key, cached_program)
             program = cached_program
         else:
-            self.program_caches.pop(cache_key, None)
+            cached_program = self.program_caches.pop(cache_key, None)
+            if cached_program is not None:
+                self.executor.drop_prepared_contexts(cached_program.desc)
             program = self._add_feed_fetch_ops(
                 program=program,
                 feed=feed,
@@ -467,8 +591,4 @@ class Executor(object):
                 fetch_var_name=fetch_var_name)
 
         self._feed_data(program, feed, feed_var_name, scope)
-        self.executor.run(program.desc, scope, 0, True, True)
-        outs = self._fetch_data(fetch_list, fetch_var_name, scope)
-        if return_numpy:
-            outs = as_numpy(outs)
-        return outs
+        return program, fetch_list, scope
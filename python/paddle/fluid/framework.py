@@ -41,6 +41,7 @@ __all__ = [
     'default_main_program',
     'program_guard',
     'name_scope',
+    'pipeline_stage',
 ]
 
 EMPTY_VAR_NAME = core.kEmptyVarName()
@@ -104,6 +105,36 @@ def name_scope(prefix=None):
     _name_scope = _name_scope.parent()
 
 
+_pipeline_stage = None
+
+
+@contextlib.contextmanager
+def pipeline_stage(stage):
+    """
+    Assign the operators created in the guard to a stage of the
+    PipelineExecutor, i.e. the index of the place running them. The gradient
+    operators run on the stages of their forward operators, and the
+    optimize operators on the stages of their gradients.
+
+    Args:
+        stage(int): the index of the stage.
+
+    Examples:
+        .. code-block:: python
+          with fluid.pipeline_stage(0):
+             hidden = fluid.layers.fc(input=image, size=200)
+          with fluid.pipeline_stage(1):
+             prediction = fluid.layers.fc(input=hidden, size=10)
+    """
+    assert isinstance(stage, int) and stage >= 0, \
+        "the pipeline stage should be a non-negative int."
+    global _pipeline_stage
+    old_stage = _pipeline_stage
+    _pipeline_stage = stage
+    yield
+    _pipeline_stage = old_stage
+
+
 def _full_name_scope():
     global _name_scope
     scope = _name_scope
@@ -138,6 +169,9 @@ def convert_np_dtype_to_dtype_(np_dtype):
         core.VarDesc.VarType: the data type in Paddle.
 
     """
+    # numpy has no bfloat16.
+    if np_dtype == 'bfloat16':
+        return core.VarDesc.VarType.BF16
     dtype = np.dtype(np_dtype)
     if dtype == np.float32:
         return core.VarDesc.VarType.FP32
@@ -177,7 +211,8 @@ def dtype_is_floating(dtype):
         dtype = convert_np_dtype_to_dtype_(dtype)
 
     return dtype in [
-        core.VarDesc.VarType.FP16, core.VarDesc.VarType.FP32,
+        core.VarDesc.VarType.FP16, core.VarDesc.VarType.BF16,
+        core.VarDesc.VarType.FP32,
         core.VarDesc.VarType.FP64
     ]
 
@@ -650,6 +685,9 @@ class Operator(object):
                 attr_val = op_attrs[attr_name]
                 self._update_desc_attr(attr_name, attr_val)
 
+        if _pipeline_stage is not None:
+            self._update_desc_attr('pipeline_stage', _pipeline_stage)
+
         self.desc.check_attrs()
         if self._has_kernel(type):
             self.desc.infer_var_type(self.block.desc)
@@ -91,7 +91,9 @@ def save_vars(executor,
               main_program=None,
               vars=None,
               predicate=None,
-              filename=None):
+              filename=None,
+              async_write=False,
+              num_shards=0):
     """
     Save variables to the given directory by executor.
 
@@ -125,6 +127,18 @@ def save_vars(executor,
         filename(str|None): The file which to save all variables. If you prefer to save
                             variables separately, set it to None.
                             Default: None
+        async_write(bool): If True, the variables are copied and written to
+                           the files on a background thread, so the training
+                           goes on while the files are flushed. The load ops
+                           wait for the pending writes.
+                           Default: False
+        num_shards(int): If it is greater than 0 and `filename` is not None,
+                         the variables are written to `num_shards` shard
+                         files in parallel, and `filename` is the index of
+                         them. Any part of the variables, e.g. the parameters
+                         of a pruned inference program, could be loaded from
+                         the index file by `load_vars`.
+                         Default: 0
 
     Returns:
         None
@@ -167,7 +181,9 @@ def save_vars(executor,
             executor,
             dirname=dirname,
             vars=list(filter(predicate, main_program.list_vars())),
-            filename=filename)
+            filename=filename,
+            async_write=async_write,
+            num_shards=num_shards)
     else:
         save_program = Program()
         save_block = save_program.global_block()
@@ -183,7 +199,10 @@ def save_vars(executor,
                     type='save',
                     inputs={'X': [new_var]},
                     outputs={},
-                    attrs={'file_path': os.path.join(dirname, new_var.name)})
+                    attrs={
+                        'file_path': os.path.join(dirname, new_var.name),
+                        'async_write': async_write
+                    })
             else:
                 save_var_map[new_var.name] = new_var
 
@@ -196,7 +215,11 @@ def save_vars(executor,
                 type='save_combine',
                 inputs={'X': save_var_list},
                 outputs={},
-                attrs={'file_path': os.path.join(dirname, filename)})
+                attrs={
+                    'file_path': os.path.join(dirname, filename),
+                    'async_write': async_write,
+                    'num_shards': num_shards
+                })
 
         executor.run(save_program)
 
@@ -249,7 +272,12 @@ def save_params(executor, dirname, main_program=None, filename=None):
         filename=filename)
 
 
-def save_persistables(executor, dirname, main_program=None, filename=None):
+def save_persistables(executor,
+                      dirname,
+                      main_program=None,
+                      filename=None,
+                      async_write=False,
+                      num_shards=0):
     """
     This function filters out all variables with `persistable==True` from the
     give `main_program` and then saves these variables to the folder `dirname`
@@ -270,6 +298,13 @@ def save_persistables(executor, dirname, main_program=None, filename=None):
         filename(str|None): The file to saved all variables. If you prefer to
                             save variables in differnet files, set it to None.
                             Default: None
+        async_write(bool): If True, the variables are copied and written to
+                           the files on a background thread. See save_vars.
+                           Default: False
+        num_shards(int): If it is greater than 0 and `filename` is not None,
+                         the variables are written to the shard files in
+                         parallel. See save_vars.
+                         Default: 0
 
     Returns:
         None
@@ -289,7 +324,9 @@ def save_persistables(executor, dirname, main_program=None, filename=None):
         main_program=main_program,
         vars=None,
         predicate=is_persistable,
-        filename=filename)
+        filename=filename,
+        async_write=async_write,
+        num_shards=num_shards)
 
 
 def load_vars(executor,
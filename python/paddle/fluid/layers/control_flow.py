@@ -432,13 +432,22 @@ class StaticRNN(object):
 
     StaticRNN class is used to create a StaticRNN. The RNN will have its
     own parameters like inputs, outputs, memories, status and length.
+
+    Args:
+        name(str|None): The name of the RNN.
+        checkpoint_interval(int): If it is positive, only the memories of
+            every checkpoint_interval-th step are kept for the backward,
+            which recomputes the other steps from them. About the square
+            root of the sequence length saves the most memory. Default 0
+            keeps every step.
     """
     BEFORE_RNN_BLOCK = 0
     IN_RNN_BLOCK = 1
     AFTER_RNN_BLOCK = 2
 
-    def __init__(self, name=None):
+    def __init__(self, name=None, checkpoint_interval=0):
         self.helper = LayerHelper("static_rnn", name=name)
+        self.checkpoint_interval = checkpoint_interval
         self.memories = {}  # memory map, from pre_mem.name --> MemoryLink
         self.inputs = []  # input variable list in current block
         self.outputs = []  # output variable list in parent block
@@ -629,7 +638,8 @@ class StaticRNN(object):
             attrs={
                 'ex_states': pre_memories,
                 'states': memories,
-                'sub_block': rnn_block
+                'sub_block': rnn_block,
+                'checkpoint_interval': self.checkpoint_interval
             })
 
 
@@ -15,6 +15,7 @@
 from __future__ import print_function
 import contextlib
 import multiprocessing
+import os
 import six
 import threading
 
@@ -29,7 +30,8 @@ from ..layer_helper import LayerHelper
 from ..unique_name import generate as unique_name
 
 __all__ = [
-    'data', 'open_files', 'read_file', 'shuffle', 'batch', 'double_buffer',
+    'data', 'open_files', 'open_slot_files', 'read_file', 'shuffle',
+    'transform', 'batch', 'bucket_batch', 'double_buffer',
     'random_data_generator', 'py_reader', 'Preprocessor', 'load'
 ]
 
@@ -496,6 +498,15 @@ def py_reader(capacity,
     called when the pass ends and :code:`fluid.core.EOFException` raises.
     Note that :code:`Program.clone()` method cannot clone :code:`py_reader`.
 
+    The Reader also provides
+    :code:`decorate_multiprocess_tensor_providers(providers, slot_size)`, to
+    run each generator of the list :code:`providers` in a worker process
+    forked by :code:`start()`, so the Python data preprocessing is not
+    limited by the GIL. The workers write the batches into a ring of
+    :code:`capacity` slots of :code:`slot_size` bytes in shared memory, which
+    are read without copying. A slot should hold the data, LoD and shapes of
+    the largest batch. It is only supported on Linux.
+
     Args:
        capacity(int): The buffer capacity maintained by :code:`py_reader`.
        shapes(list|tuple): List of tuples which declaring data shapes.
@@ -654,6 +665,9 @@ def py_reader(capacity,
     reader.thread = None
     reader.tensor_provider = None
     reader.exited = False
+    reader.shm_queue = None
+    reader.tensor_providers = None
+    reader.workers = []
 
     def start_provide_thread(func):
         def __provider_thread__():
@@ -678,8 +692,51 @@ def py_reader(capacity,
         reader.thread.daemon = True
         reader.thread.start()
 
+    def start_provide_processes(providers):
+        reader.shm_queue.reopen(len(providers))
+
+        def __provider_process__(func):
+            try:
+                for tensors in func():
+                    array = core.LoDTensorArray()
+                    for item in tensors:
+                        if not isinstance(item, core.LoDTensor):
+                            tmp = core.LoDTensor()
+                            tmp.set(item, core.CPUPlace(), zero_copy=True)
+                            item = tmp
+
+                        array.append(item)
+
+                    if not reader.shm_queue.push(array):
+                        break
+            finally:
+                reader.shm_queue.writer_done()
+
+        # The workers are forked, and write to the memory they inherit.
+        reader.workers = [
+            multiprocessing.Process(
+                target=__provider_process__, args=(func, ))
+            for func in providers
+        ]
+        for worker in reader.workers:
+            worker.daemon = True
+            worker.start()
+
+        reader.thread = threading.Thread(
+            target=reader.shm_queue.forward_to, args=(feed_queue, ))
+        reader.thread.daemon = True
+        reader.thread.start()
+
     def __set_tensor_provider__(func):
         reader.tensor_provider = func
+        reader.tensor_providers = None
+
+    def __set_multiprocess_tensor_providers__(providers, slot_size):
+        if reader.shm_queue is None:
+            reader.shm_queue = core.SharedMemoryQueue(
+                "/%s_%d" % (queue_name, os.getpid()), capacity, slot_size)
+        reader.tensor_providers = providers
+        reader.tensor_provider = None
 
     def __set_paddle_reader__(paddle_reader):
         with program_guard(Program(), Program()):
@@ -707,16 +764,27 @@ def py_reader(capacity,
 
     def __reset__():
         current_reset_method()
-        if reader.thread is not None and reader.tensor_provider is not None:
+        if reader.thread is not None and reader.tensor_providers is not None:
+            reader.shm_queue.close()
+            reader.thread.join()
+            for worker in reader.workers:
+                worker.join()
+            reader.workers = []
+        elif reader.thread is not None and reader.tensor_provider is not None:
             reader.exited = True
             reader.thread.join()
             reader.exited = False
 
     def __start__():
-        start_provide_thread(reader.tensor_provider)
+        if reader.tensor_providers is not None:
+            start_provide_processes(reader.tensor_providers)
+        else:
+            start_provide_thread(reader.tensor_provider)
 
     reader.reset = __reset__
     reader.decorate_tensor_provider = __set_tensor_provider__
+    reader.decorate_multiprocess_tensor_providers = \
+        __set_multiprocess_tensor_providers__
     reader.decorate_paddle_reader = __set_paddle_reader__
     reader.start = __start__
 
@@ -730,7 +798,11 @@ def open_files(filenames,
                thread_num=None,
                buffer_size=None,
                pass_num=1,
-               is_test=None):
+               is_test=None,
+               num_trainers=1,
+               trainer_id=0,
+               shuffle_chunks=False,
+               seed=0):
     """
     Open files
 
@@ -751,6 +823,17 @@ def open_files(filenames,
             is used for testing, the order of data generated is same as the file
             order. Otherwise, it is not guaranteed the order of data is same
             between every epoch. [Default: False].
+       num_trainers(int): The number of trainers reading these files. If it is
+            greater than 1, the recordio chunks of all the files are split
+            among the trainers, so each trainer reads a disjoint part of them.
+            The files should be written with the chunk index, which is done
+            when the recordio writer is closed. [Default: 1].
+       trainer_id(int): The id of this trainer in [0, num_trainers).
+            [Default: 0].
+       shuffle_chunks(bool): Whether to shuffle the recordio chunks of all the
+            files at every pass. [Default: False].
+       seed(int): The random seed of shuffle_chunks. It should be the same on
+            all the trainers. [Default: 0].
 
     Returns:
        Variable: A Reader Variable via which we can get file data.
@@ -796,7 +879,11 @@ def open_files(filenames,
         'ranks': ranks,
         'file_names': filenames,
         'thread_num': thread_num,
-        'buffer_size': buffer_size
+        'buffer_size': buffer_size,
+        'num_trainers': int(num_trainers),
+        'trainer_id': int(trainer_id),
+        'shuffle_chunks': bool(shuffle_chunks),
+        'seed': int(seed)
     }
     if is_test is not None:
         attrs['is_test'] = is_test
@@ -814,6 +901,65 @@ def open_files(filenames,
     return monkey_patch_reader_methods(main_prog_reader)
 
 
+def open_slot_files(filenames, num_slots, batch_size, pass_num=1):
+    """
+    Open the slot files written by
+    fluid.slot_file_writer.convert_reader_to_slot_file and return the reader
+    of their batches.
+
+    The reader yields an int64 LoDTensor of [num_ids, 1] for each of the
+    num_slots slots, whose LoD gives the ids of each instance of the batch,
+    so it could be fed to embedding directly. The ids of a slot of the batch
+    are copied from the columns of the files without parsing the instances.
+
+    Args:
+        filenames(list): The slot files read in order.
+        num_slots(int): The number of the slots of the files.
+        batch_size(int): The number of the instances of a batch.
+        pass_num(int): Number of passes to run.
+
+    Returns:
+        Variable: The reader of the batches.
+
+    Examples:
+        .. code-block:: python
+
+            reader = fluid.layers.open_slot_files(
+                filenames=['./part-0.slot', './part-1.slot'],
+                num_slots=3,
+                batch_size=512)
+            reader = fluid.layers.double_buffer(reader)
+            slots = fluid.layers.read_file(reader)
+            embs = [fluid.layers.embedding(
+                input=slot, size=[1000000, 16], is_sparse=True)
+                    for slot in slots]
+    """
+    var_name = unique_name('open_slot_files')
+    startup_blk = default_startup_program().current_block()
+    startup_var = startup_blk.create_var(name=var_name)
+    startup_blk.append_op(
+        type='create_slot_file_reader',
+        outputs={'Out': [startup_var]},
+        attrs={
+            'shape_concat': [-1, 1] * num_slots,
+            'lod_levels': [1] * num_slots,
+            'ranks': [2] * num_slots,
+            'file_names': list(filenames),
+            'batch_size': int(batch_size)
+        })
+
+    startup_var.desc.set_dtypes(
+        [convert_np_dtype_to_dtype_('int64')] * num_slots)
+    startup_var.persistable = True
+    main_prog_var = _copy_reader_var_(default_main_program().current_block(),
+                                      startup_var)
+
+    if pass_num > 1:
+        main_prog_var = multi_pass(reader=main_prog_var, pass_num=pass_num)
+
+    return monkey_patch_reader_methods(main_prog_var)
+
+
 def __create_shared_decorated_reader__(op_type, reader, attrs):
     var_name = unique_name(op_type)
     startup_blk = default_startup_program().current_block()
@@ -842,12 +988,111 @@ def __create_unshared_decorated_reader__(op_type, reader, attrs, name=None):
     return monkey_patch_reader_methods(new_reader)
 
 
-def shuffle(reader, buffer_size):
+def shuffle(reader, buffer_size, seed=0):
     """
     Shuffle the reader.
+
+    Each output is drawn at random from a buffer of buffer_size instances,
+    and replaced by the next instance of the reader, so the instances read
+    from different files are mixed without refilling the whole buffer.
+
+    Args:
+        reader(Variable): The reader to be shuffled.
+        buffer_size(int): The number of the instances in the buffer.
+        seed(int): The random seed. 0 means a random one.
+
+    Returns:
+        Variable: The shuffled reader.
     """
+    attrs = {'buffer_size': int(buffer_size), 'seed': int(seed)}
+    return __create_unshared_decorated_reader__('create_shuffle_reader',
+                                                reader, attrs)
+
+
+def transform(reader,
+              transforms,
+              shapes,
+              dtypes,
+              lod_levels=None,
+              thread_num=1,
+              keep_order=False,
+              buffer_size=16,
+              crop_shape=None,
+              mean=None,
+              std=None,
+              seed=0,
+              name=None):
+    """
+    Apply the C++ transforms to each instance of the reader with a pool of
+    threads. The transforms are registered by REGISTER_READER_TRANSFORM and
+    applied in order, so the decoding and augmentation of the instances are
+    not run by the Python interpreter.
+
+    The built-in transforms are 'random_crop', which crops the trailing dims
+    of the first slot to crop_shape at a random offset, and 'normalize',
+    which computes (x - mean) / std of the first slot per channel.
+
+    Args:
+        reader(Variable): The reader to be transformed.
+        transforms(list): The names of the transforms applied in order.
+        shapes(list): The shapes of the slots after the transforms.
+        dtypes(list): The data types of the slots after the transforms.
+        lod_levels(list|None): The LoD levels of the slots. Default all 0.
+        thread_num(int): The number of threads running the transforms.
+        keep_order(bool): Whether to output the instances in the order of
+            the underlying reader.
+        buffer_size(int): The max number of the transformed instances.
+        crop_shape(list|None): The shape of 'random_crop'.
+        mean(list|None): The mean of 'normalize'.
+        std(list|None): The std of 'normalize'.
+        seed(int): The random seed of the transforms. 0 means random.
+        name(str|None): The name of the reader variable.
+
+    Returns:
+        Variable: The transformed reader.
+
+    Examples:
+        .. code-block:: python
+
+            reader = fluid.layers.open_files(filenames=['./data.recordio'],
+                                             shapes=[[-1, 3, 36, 36], [-1, 1]],
+                                             dtypes=['float32', 'int64'])
+            reader = fluid.layers.transform(
+                reader,
+                transforms=['random_crop', 'normalize'],
+                shapes=[[-1, 3, 32, 32], [-1, 1]],
+                dtypes=['float32', 'int64'],
+                thread_num=4,
+                crop_shape=[32, 32],
+                mean=[127.5, 127.5, 127.5],
+                std=[127.5, 127.5, 127.5])
+            reader = fluid.layers.batch(reader, batch_size=32)
+            reader = fluid.layers.double_buffer(reader)
+            img, label = fluid.layers.read_file(reader)
+    """
+    if lod_levels is None:
+        lod_levels = [0] * len(shapes)
+    shape_concat = []
+    ranks = []
+    for shape in shapes:
+        shape_concat.extend(shape)
+        ranks.append(len(shape))
+    attrs = {
+        'transforms': list(transforms),
+        'thread_num': int(thread_num),
+        'keep_order': bool(keep_order),
+        'buffer_size': int(buffer_size),
+        'seed': int(seed),
+        'shape_concat': shape_concat,
+        'ranks': ranks,
+        'lod_levels': lod_levels,
+        'dtypes': [int(convert_np_dtype_to_dtype_(dt)) for dt in dtypes],
+        'crop_shape': list(crop_shape or []),
+        'mean': [float(m) for m in mean or []],
+        'std': [float(s) for s in std or []]
+    }
     return __create_unshared_decorated_reader__(
-        'create_shuffle_reader', reader, {'buffer_size': int(buffer_size)})
+        'create_transform_reader', reader, attrs, name=name)
 
 
 def batch(reader, batch_size):
@@ -890,6 +1135,66 @@ def batch(reader, batch_size):
         'create_batch_reader', reader, {'batch_size': int(batch_size)})
 
 
+def bucket_batch(reader,
+                 batch_size=0,
+                 batch_tokens=0,
+                 bucket_boundaries=None,
+                 pool_size=1024,
+                 length_slot=0,
+                 discard_leftover=False):
+    """
+    This layer is a reader decorator. It groups the instances of the reader
+    into the buckets by their lengths, and yields a batch of a bucket once it
+    is full, so that the sequences of a batch have similar lengths and the
+    padding is small.
+
+    The length of an instance is the first dim of its slot length_slot, i.e.
+    the number of the tokens of a LoD slot. A bucket is full when it has
+    batch_size instances, or when the next instance would make its padded
+    tokens, the number of instances times the max length, exceed
+    batch_tokens. At most pool_size instances are kept in the buckets.
+
+    Args:
+        reader(Variable): The reader to be decorated.
+        batch_size(int): The max number of the instances of a batch. 0 means
+            no limit.
+        batch_tokens(int): The max padded tokens of a batch. 0 means no
+            limit. At least one of batch_size and batch_tokens is positive.
+        bucket_boundaries(list|None): The sorted upper bounds (exclusive) of
+            the lengths of the buckets. None means a single bucket.
+        pool_size(int): The max number of the instances in the buckets.
+        length_slot(int): The slot measuring the length of an instance.
+        discard_leftover(bool): Whether to discard the instances left in the
+            buckets at the end of a pass.
+
+    Returns:
+        Variable: The reader yielding the batches.
+
+    Examples:
+        .. code-block:: python
+
+            reader = fluid.layers.open_files(filenames=['./wmt.recordio'],
+                                             shapes=[[-1, 1], [-1, 1]],
+                                             lod_levels=[1, 1],
+                                             dtypes=['int64', 'int64'])
+            reader = fluid.layers.bucket_batch(
+                reader,
+                batch_tokens=4096,
+                bucket_boundaries=[8, 16, 32, 64, 128])
+            src, trg = fluid.layers.read_file(reader)
+    """
+    attrs = {
+        'batch_size': int(batch_size),
+        'batch_tokens': int(batch_tokens),
+        'bucket_boundaries': [int(b) for b in bucket_boundaries or []],
+        'pool_size': int(pool_size),
+        'length_slot': int(length_slot),
+        'discard_leftover': bool(discard_leftover)
+    }
+    return __create_unshared_decorated_reader__('create_bucket_batch_reader',
+                                                reader, attrs)
+
+
 def double_buffer(reader, place=None, name=None):
     """
     Wrap a double buffer reader. The data will copy to target place with a
@@ -113,6 +113,12 @@ def auc(input,
         slide_steps: when calc batch auc, we can not only use step currently but the previous steps can be used. slide_steps=1 means use the current step, slide_steps=3 means use current step and the previous second steps, slide_steps=0 use all of the steps.
 
 
+    The statistics of the thresholds are kept in persistable variables in
+    the C++ operators. When the program runs by ParallelExecutor on several
+    devices, the statistics of each batch are summed over the devices, so
+    both the batch AUC and the global AUC are computed over all the devices
+    without fetching the statistics.
+
     Returns:
         Variable: A scalar representing the current AUC.
 
@@ -149,6 +155,18 @@ def auc(input,
             var, Constant(
                 value=0.0, force_cpu=True))
 
+    # The statistics of this batch, which are summed over the devices by
+    # ParallelExecutor, so the AUCs are global ones.
+    cur_stat_pos = helper.create_variable_for_type_inference(dtype="int64")
+    cur_stat_neg = helper.create_variable_for_type_inference(dtype="int64")
+    helper.append_op(
+        type="auc_stat",
+        inputs={"Predict": [input],
+                "Label": [label]},
+        attrs={"num_thresholds": num_thresholds},
+        outputs={"StatPos": [cur_stat_pos],
+                 "StatNeg": [cur_stat_neg]})
+
     # Batch AUC
     helper.append_op(
         type="auc",
@@ -156,7 +174,9 @@ def auc(input,
             "Predict": [input],
             "Label": [label],
             "StatPos": [batch_stat_pos],
-            "StatNeg": [batch_stat_neg]
+            "StatNeg": [batch_stat_neg],
+            "BatchStatPos": [cur_stat_pos],
+            "BatchStatNeg": [cur_stat_neg]
         },
         attrs={
             "curve": curve,
@@ -175,7 +195,9 @@ def auc(input,
             "Predict": [input],
             "Label": [label],
             "StatPos": [stat_pos],
-            "StatNeg": [stat_neg]
+            "StatNeg": [stat_neg],
+            "BatchStatPos": [cur_stat_pos],
+            "BatchStatNeg": [cur_stat_neg]
         },
         attrs={
             "curve": curve,
@@ -31,6 +31,8 @@ from functools import reduce
 __all__ = [
     'fc',
     'embedding',
+    'hashed_embedding',
+    'sparse_fc',
     'dynamic_lstm',
     'dynamic_lstmp',
     'dynamic_gru',
@@ -79,11 +81,13 @@ __all__ = [
     'im2sequence',
     'nce',
     'hsigmoid',
+    'sampled_softmax_with_cross_entropy',
     'beam_search',
     'row_conv',
     'multiplex',
     'layer_norm',
     'softmax_with_cross_entropy',
+    'chunked_softmax_with_cross_entropy',
     'smooth_l1',
     'one_hot',
     'autoincreased_step_counter',
@@ -161,6 +165,9 @@ __all__ = [
     'grid_sampler',
     'log_loss',
     'add_position_encoding',
+    'kv_cache_append',
+    'kv_cache_reorder',
+    'kv_cache_attention',
 ]
 
 
@@ -336,6 +343,138 @@ def embedding(input,
     return tmp
 
 
+def hashed_embedding(input,
+                     size,
+                     num_hash=1,
+                     pool_type='sum',
+                     is_sparse=False,
+                     param_attr=None,
+                     dtype='float32'):
+    """
+    **Hashed Embedding Layer**
+
+    This layer looks up the embeddings of raw int64 IDs, such as the feature
+    hashes, without a vocabulary. The k-th hash of an ID is the row
+    :math:`XXH64(id, k) \\% size[0]` of the table, the embedding of the ID is
+    the sum of its :attr:`num_hash` rows, and the embeddings of each sequence
+    of :attr:`input` are pooled, in one operator.
+
+    Two IDs share their embedding only if all their hashes collide, so in a
+    table of :math:`m` rows about :math:`(1 - e^{-kn/m})^k` of :math:`n`
+    distinct IDs fully collide with :math:`k` hashes, instead of
+    :math:`1 - e^{-n/m}` with one hash.
+
+    Args:
+        input(Variable): The LoDTensor of the int64 IDs, of shape [N, 1] with
+            a sequence of IDs per instance.
+        size(tuple|list): The shape of the table, the number of rows the IDs
+            hash to and the size of each embedding vector.
+        num_hash(int): The number of hashes of an ID.
+        pool_type(str): Pool the embeddings of a sequence by 'sum',
+            'average', 'sqrt', the sum divided by the square root of the
+            length, or 'none' to return the embedding of each ID.
+        is_sparse(bool): The flag indicating whether to use sparse update.
+        param_attr(ParamAttr): Parameters for this layer
+        dtype(np.dtype|core.VarDesc.VarType|str): The type of data : float32,
+            float64
+
+    Returns:
+        Variable: The pooled embeddings of the sequences, or the embeddings \
+                  of the IDs with the LoD of :attr:`input` for 'none'.
+
+    Examples:
+        .. code-block:: python
+
+          ids = fluid.layers.data(
+              name='ids', shape=[1], dtype='int64', lod_level=1)
+          emb = fluid.layers.hashed_embedding(
+              input=ids, size=[1000000, 16], num_hash=2)
+    """
+
+    helper = LayerHelper('hashed_embedding', **locals())
+    w = helper.create_parameter(
+        attr=helper.param_attr, shape=size, dtype=dtype, is_bias=False)
+    out = helper.create_variable_for_type_inference(dtype)
+    helper.append_op(
+        type='hashed_lookup',
+        inputs={'Ids': input,
+                'W': w},
+        outputs={'Out': out},
+        attrs={
+            'num_hash': num_hash,
+            'pooltype': pool_type.upper(),
+            'is_sparse': is_sparse
+        })
+    return out
+
+
+def sparse_fc(input,
+              size,
+              values=None,
+              is_sparse=False,
+              param_attr=None,
+              bias_attr=None,
+              act=None,
+              dtype='float32'):
+    """
+    **Sparse Fully Connected Layer**
+
+    This layer multiplies the sparse rows of :attr:`input` and :attr:`values`
+    by a weight of shape :attr:`size`, such as the wide part of a wide and
+    deep model over hashed features. The row :math:`i` has the nonzeros
+    :math:`values[k]` at the columns :math:`input[k]` of the :math:`k` in its
+    sequence:
+
+    .. math::
+
+        Out[i] = Act(\\sum_{k} values[k] * W[input[k]] + Bias)
+
+    The cost scales with the nonzeros instead of the width of the rows.
+
+    Args:
+        input(Variable): The LoDTensor of the int64 column IDs of the
+            nonzeros, of shape [N, 1] with a sequence of IDs per row.
+        size(tuple|list): The shape of the weight, the width of the rows and
+            the size of the output.
+        values(Variable|None): The LoDTensor of the values of the nonzeros,
+            of shape [N, 1] with the LoD of :attr:`input`, or None if they
+            are all ones.
+        is_sparse(bool): The flag indicating whether to use sparse update.
+        param_attr(ParamAttr): Parameters for this layer
+        bias_attr(ParamAttr|bool|None): The bias of the output, False for no
+            bias.
+        act(str|None): Activation to be applied to the output.
+        dtype(np.dtype|core.VarDesc.VarType|str): The type of data : float32,
+            float64
+
+    Returns:
+        Variable: The output of shape [number of rows, size[1]].
+
+    Examples:
+        .. code-block:: python
+
+          ids = fluid.layers.data(
+              name='ids', shape=[1], dtype='int64', lod_level=1)
+          wide = fluid.layers.sparse_fc(
+              input=ids, size=[1000000, 1], is_sparse=True)
+    """
+
+    helper = LayerHelper('sparse_fc', **locals())
+    w = helper.create_parameter(
+        attr=helper.param_attr, shape=size, dtype=dtype, is_bias=False)
+    inputs = {'Ids': input, 'W': w}
+    if values is not None:
+        inputs['Values'] = values
+    pre_bias = helper.create_variable_for_type_inference(dtype)
+    helper.append_op(
+        type='sparse_mul',
+        inputs=inputs,
+        outputs={'Out': pre_bias},
+        attrs={'is_sparse': is_sparse})
+    pre_activation = helper.append_bias_op(pre_bias, dim_start=1)
+    return helper.append_activation(pre_activation)
+
+
 @templatedoc(op_type="lstm")
 def dynamic_lstm(input,
                  size,
@@ -1020,7 +1159,8 @@ def dropout(x,
             is_test=False,
             seed=None,
             name=None,
-            dropout_implementation="downgrade_in_infer"):
+            dropout_implementation="downgrade_in_infer",
+            bit_mask=False):
     """
     Computes dropout.
 
@@ -1053,6 +1193,10 @@ def dropout(x,
                                             ratio of 0 is dropout_prob)
                                            dropout op can be removed from the program. 
                                            the program will be efficient
+        bit_mask (bool): Whether to keep the mask for the backward as one bit
+                         per element in a uint8 tensor instead of a tensor
+                         of the type of `x`, which saves the memory of the
+                         training. Default False.
                                         
 
 
@@ -1070,7 +1214,7 @@ def dropout(x,
     helper = LayerHelper('dropout', **locals())
     out = helper.create_variable_for_type_inference(dtype=x.dtype)
     mask = helper.create_variable_for_type_inference(
-        dtype=x.dtype, stop_gradient=True)
+        dtype='uint8' if bit_mask else x.dtype, stop_gradient=True)
 
     if (seed is None or seed == 0) and helper.main_program.random_seed != 0:
         seed = helper.main_program.random_seed
@@ -1086,6 +1230,7 @@ def dropout(x,
             'fix_seed': seed is not None,
             'seed': seed if seed is not None else 0,
             'dropout_implementation': dropout_implementation,
+            'bit_mask': bit_mask,
         })
     return out
 
@@ -4282,7 +4427,8 @@ def nce(input,
         param_attr=None,
         bias_attr=None,
         num_neg_samples=None,
-        name=None):
+        name=None,
+        is_sparse=False):
     """
     ${comment}
 
@@ -4305,6 +4451,7 @@ def nce(input,
         num_neg_samples (int): ${num_neg_samples_comment}
         name (str|None): A name for this layer(optional). If set None, the layer
              will be named automatically. Default: None.
+        is_sparse (bool): ${is_sparse_comment}
 
     Returns:
         Variable: The output nce loss.
@@ -4370,7 +4517,8 @@ def nce(input,
 
     attrs = {
         'num_total_classes': int(num_total_classes),
-        'num_neg_samples': num_neg_samples
+        'num_neg_samples': num_neg_samples,
+        'is_sparse': is_sparse
     }
 
     helper.append_op(
@@ -4390,7 +4538,8 @@ def hsigmoid(input,
              num_classes,
              param_attr=None,
              bias_attr=None,
-             name=None):
+             name=None,
+             is_sparse=False):
     """
     The hierarchical sigmoid operator is used to accelerate the training
     process of language model. This operator organizes the classes into a
@@ -4422,6 +4571,9 @@ def hsigmoid(input,
              is not set, the bias is initialized zero. Default: None.
         name (str|None): A name for this layer(optional). If set None, the layer
              will be named automatically. Default: None.
+        is_sparse (bool): Whether the gradient of the weights is a
+             SelectedRows of the internal nodes on the paths of the labels,
+             which updates only those rows. Default: False.
 
     Returns:
         Out: (Tensor) The cost of hierarchical sigmoid operator. the shape is [N, 1]
@@ -4460,10 +4612,89 @@ def hsigmoid(input,
         inputs=inputs,
         outputs={"Out": out,
                  "PreOut": pre_out},
-        attrs={"num_classes": num_classes})
+        attrs={"num_classes": num_classes,
+               "is_sparse": is_sparse})
     return out
 
 
+@templatedoc()
+def sampled_softmax_with_cross_entropy(input,
+                                       label,
+                                       num_total_classes,
+                                       num_samples=10,
+                                       param_attr=None,
+                                       bias_attr=None,
+                                       seed=0,
+                                       is_sparse=False,
+                                       name=None):
+    """
+    ${comment}
+
+    Args:
+        input (Variable): The input tensor variable with shape
+            :math:`[N \\times D]`, where :math:`N` is the size of mini-batch,
+            and :math:`D` is the feature size.
+        label (Variable): The int64 tensor variable of the true classes with
+            shape :math:`[N \\times 1]`.
+        num_total_classes (int): ${num_total_classes_comment}
+        num_samples (int): ${num_samples_comment}
+        param_attr (ParamAttr|None): The parameter attribute for the weights
+             of shape [num_total_classes, D]. Default: None.
+        bias_attr (ParamAttr|bool|None): The parameter attribute for the bias
+             of shape [num_total_classes, 1]. If it is set to False, no bias
+             will be added. Default: None.
+        seed (int): ${seed_comment}
+        is_sparse (bool): ${is_sparse_comment}
+        name (str|None): A name for this layer(optional). If set None, the layer
+             will be named automatically. Default: None.
+
+    Returns:
+        Variable: The sampled softmax cross entropy loss with shape [N, 1].
+
+    Examples:
+        .. code-block:: python
+
+            x = fluid.layers.data(name='x', shape=[128], dtype='float32')
+            y = fluid.layers.data(name='y', shape=[1], dtype='int64')
+            loss = fluid.layers.sampled_softmax_with_cross_entropy(
+                input=x, label=y, num_total_classes=100000, num_samples=64)
+    """
+    helper = LayerHelper('sampled_softmax_with_cross_entropy', **locals())
+    dim = input.shape[1]
+    w = helper.create_parameter(
+        attr=helper.param_attr,
+        shape=[num_total_classes, dim],
+        is_bias=False,
+        dtype=input.dtype)
+    inputs = {'Input': input, 'Label': label, 'Weight': w}
+    if helper.bias_attr:
+        b = helper.create_parameter(
+            attr=helper.bias_attr,
+            shape=[num_total_classes, 1],
+            is_bias=True,
+            dtype=input.dtype)
+        inputs['Bias'] = b
+    loss = helper.create_variable_for_type_inference(dtype=input.dtype)
+    softmax = helper.create_variable_for_type_inference(dtype=input.dtype)
+    sampled_labels = helper.create_variable_for_type_inference(
+        dtype=label.dtype)
+    helper.append_op(
+        type='sampled_softmax_with_cross_entropy',
+        inputs=inputs,
+        outputs={
+            'Loss': loss,
+            'Softmax': softmax,
+            'SampledLabels': sampled_labels
+        },
+        attrs={
+            'num_total_classes': int(num_total_classes),
+            'num_samples': int(num_samples),
+            'seed': int(seed),
+            'is_sparse': is_sparse
+        })
+    return loss
+
+
 def transpose(x, perm, name=None):
     """
     Permute the dimensions of `input` according to `perm`.
@@ -4817,6 +5048,66 @@ def softmax_with_cross_entropy(logits,
     return loss
 
 
+def chunked_softmax_with_cross_entropy(logits,
+                                       label,
+                                       soft_label=False,
+                                       ignore_index=-100,
+                                       chunk_size=4096):
+    """
+    **Chunked Softmax With Cross Entropy Operator.**
+
+    It computes the same loss as :code:`softmax_with_cross_entropy` without
+    keeping the softmax of shape [N x K] for the backward, which saves the
+    memory of the large class numbers, like the vocabularies of hundreds of
+    thousands words. The log-sum-exp of each row is computed online over the
+    chunks of :attr:`chunk_size` classes, and the backward computes the
+    softmax again from it.
+
+    Args:
+        logits (Variable): The unscaled log probabilities, which is a 2-D tensor
+            with shape [N x K]. N is the batch_size, and K is the class number.
+        label (Variable): The ground truth which is a 2-D tensor. If soft_label
+            is set to false, Label is a Tensor<int64> with shape [N x 1] of
+            the class ids. If soft_label is set to true, Label is a
+            Tensor<float/double> with shape [N x K], whose rows sum to one.
+        soft_label (bool): A flag to indicate whether to interpretate the given
+            labels as soft labels. By default, `soft_label` is set to False.
+        ignore_index (int): Specifies a target value that is ignored and does
+            not contribute to the loss and the input gradient. Only valid if
+            soft_label is set to False. Default: -100
+        chunk_size (int): The number of classes reduced in a chunk, the GPU
+            reduces the chunks of a row in parallel. Default: 4096
+
+    Returns:
+        Variable: The cross entropy loss is a 2-D tensor with shape [N x 1].
+
+    Examples:
+        .. code-block:: python
+
+            data = fluid.layers.data(name='data', shape=[128], dtype='float32')
+            label = fluid.layers.data(name='label', shape=[1], dtype='int64')
+            fc = fluid.layers.fc(input=data, size=500000)
+            out = fluid.layers.chunked_softmax_with_cross_entropy(
+                logits=fc, label=label)
+    """
+    helper = LayerHelper('chunked_softmax_with_cross_entropy', **locals())
+    loss = helper.create_variable_for_type_inference(dtype=logits.dtype)
+    log_sum_exp = helper.create_variable_for_type_inference(
+        dtype=logits.dtype)
+    helper.append_op(
+        type='chunked_softmax_with_cross_entropy',
+        inputs={'Logits': logits,
+                'Label': label},
+        outputs={'Loss': loss,
+                 'LogSumExp': log_sum_exp},
+        attrs={
+            'soft_label': soft_label,
+            'ignore_index': ignore_index,
+            'chunk_size': chunk_size
+        })
+    return loss
+
+
 def smooth_l1(x, y, inside_weight=None, outside_weight=None, sigma=None):
     """
     This layer computes the smooth L1 loss for Variable :attr:`x` and :attr:`y`.
@@ -7985,3 +8276,138 @@ def add_position_encoding(input, alpha, beta, name=None):
         attrs={"alpha": alpha,
                "beta": beta})
     return out
+
+
+def kv_cache_append(cache, x, step):
+    """
+    **Key/Value Cache Append Layer**
+
+    Write the keys or values of the new decoding positions into the
+    preallocated cache of a layer in place, i.e.
+    :code:`cache[..., step:step + S, :] = x`. The incremental decoder only
+    projects the new positions at each step and reads the previous ones from
+    the cache with :code:`kv_cache_attention`.
+
+    Args:
+        cache (Variable): The cache with shape [..., L, D], where L is the
+            max decoding length, usually [batch * beam, heads, L, D].
+        x (Variable): The keys or values of the new positions with shape
+            [..., S, D].
+        step (Variable): A tensor with one int or int64, the position of the
+            first new row, usually the counter of the decoding loop.
+
+    Returns:
+        Variable: The cache, which is updated in place.
+
+    Examples:
+        .. code-block:: python
+
+          k_cache = fluid.layers.kv_cache_append(k_cache, k, step)
+    """
+    helper = LayerHelper('kv_cache_append', **locals())
+    helper.append_op(
+        type="kv_cache_append",
+        inputs={"Cache": cache,
+                "X": x,
+                "Step": step},
+        outputs={"CacheOut": cache})
+    return cache
+
+
+def kv_cache_reorder(cache, selected_ids, step=None):
+    """
+    **Key/Value Cache Reorder Layer**
+
+    Reorder the cache after the beams are pruned by :code:`beam_search`, so
+    the i-th selected id gets the cache of the prefix it extends. The cache
+    is replaced in place.
+
+    Args:
+        cache (Variable): The cache of the prefixes of beam_search with shape
+            [N, ..., L, D].
+        selected_ids (Variable): The selected ids of beam_search.
+        step (Variable|None): A tensor with one int or int64, only the
+            positions in [0, step] are copied. All the positions are copied
+            if it is None.
+
+    Returns:
+        Variable: The cache with shape [M, ..., L, D], where M is the number
+            of the selected ids.
+
+    Examples:
+        .. code-block:: python
+
+          selected_ids, selected_scores = fluid.layers.beam_search(
+              pre_ids, pre_scores, ids, scores, beam_size, end_id)
+          k_cache = fluid.layers.kv_cache_reorder(k_cache, selected_ids, step)
+    """
+    helper = LayerHelper('kv_cache_reorder', **locals())
+    inputs = {"Cache": cache, "SelectedIds": selected_ids}
+    if step is not None:
+        inputs["Step"] = step
+    helper.append_op(
+        type="kv_cache_reorder",
+        inputs=inputs,
+        outputs={"CacheOut": cache})
+    return cache
+
+
+def kv_cache_attention(query,
+                       key_cache,
+                       value_cache,
+                       step,
+                       bias_qk=None,
+                       alpha=1.0,
+                       name=None):
+    """
+    **Cached Attention Layer**
+
+    The scaled dot-product attention of the new decoding positions over the
+    cached keys and values:
+
+    .. math::
+        Out = softmax(\\alpha * Q * K[..., :step + S, :]^T + BiasQK) *
+              V[..., :step + S, :]
+
+    where S is the number of the new positions of the query.
+
+    Args:
+        query (Variable): The queries of the new positions with shape
+            [..., S, D].
+        key_cache (Variable): The key cache of kv_cache_append with shape
+            [..., L, D].
+        value_cache (Variable): The value cache of kv_cache_append with shape
+            [..., L, Dv].
+        step (Variable): A tensor with one int or int64, the position of the
+            first new row.
+        bias_qk (Variable|None): The bias added to Q * K^T with shape
+            [..., S, step + S].
+        alpha (float): The scale of Q * K^T.
+        name (str|None): The name of the output.
+
+    Returns:
+        Variable: The attention output with shape [..., S, Dv].
+
+    Examples:
+        .. code-block:: python
+
+          k_cache = fluid.layers.kv_cache_append(k_cache, k, step)
+          v_cache = fluid.layers.kv_cache_append(v_cache, v, step)
+          out = fluid.layers.kv_cache_attention(
+              q, k_cache, v_cache, step, alpha=d_key**-0.5)
+    """
+    helper = LayerHelper('kv_cache_attention', **locals())
+    dtype = helper.input_dtype(input_param_name='query')
+    if name is None:
+        out = helper.create_variable_for_type_inference(dtype=dtype)
+    else:
+        out = helper.create_variable(name=name, dtype=dtype, persistable=False)
+    inputs = {"Q": query, "K": key_cache, "V": value_cache, "Step": step}
+    if bias_qk is not None:
+        inputs["BiasQK"] = bias_qk
+    helper.append_op(
+        type="fused_multihead_attention",
+        inputs=inputs,
+        outputs={"Out": out},
+        attrs={"alpha": float(alpha)})
+    return out
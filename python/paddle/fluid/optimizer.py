@@ -220,8 +220,13 @@ class Optimizer(object):
         program = loss.block.program
         self._dtype = loss.dtype
         with program_guard(program, startup_program):
-            global_block = framework.default_main_program().global_block()
-            start = len(global_block.ops)
+            # The operators are appended to the block of loss, or to the
+            # current block if it is a sub-block of it, e.g. to run them only
+            # on a condition.
+            target_block = framework.default_main_program().current_block()
+            if target_block.parent_idx != loss.block.idx:
+                target_block = loss.block
+            start = len(target_block.ops)
             self.helper = LayerHelper(self.__class__.__name__)
             self._create_accumulators(loss.block,
                                       [p[0] for p in parameters_and_grads])
@@ -234,16 +239,16 @@ class Optimizer(object):
                 with param_and_grad[0].block.program._optimized_guard(
                         param_and_grad), name_scope("optimizer"):
                     if param_and_grad[0].trainable is True:
-                        optimize_op = self._append_optimize_op(loss.block,
+                        optimize_op = self._append_optimize_op(target_block,
                                                                param_and_grad)
                         optimize_ops.append(optimize_op)
 
             # Get custom finish ops for subclasses
             # FIXME: Need to fix this once we figure out how to handle dependencies
-            self._finish_update(loss.block, parameters_and_grads)
+            self._finish_update(target_block, parameters_and_grads)
 
-            end = len(global_block.ops)
-            return global_block._slice_ops(start, end)
+            end = len(target_block.ops)
+            return target_block._slice_ops(start, end)
 
     def minimize(self,
                  loss,
@@ -592,6 +597,11 @@ class AdamOptimizer(Optimizer):
         regularization: A Regularizer, such as
                         fluid.regularizer.L2DecayRegularizer.
         name: A optional name prefix.
+        lazy_mode(bool: false): If True, a sparse gradient, such as the
+            gradient of an embedding, only updates the moments and the rows
+            of the parameter in it, and each row corrects the beta powers by
+            its own update steps. It is much faster for the big tables, but
+            not the same as the dense Adam.
 
     Examples:
         .. code-block:: python
@@ -604,6 +614,7 @@ class AdamOptimizer(Optimizer):
     _moment2_acc_str = "moment2"
     _beta1_pow_acc_str = "beta1_pow_acc"
     _beta2_pow_acc_str = "beta2_pow_acc"
+    _row_step_acc_str = "row_step"
 
     def __init__(self,
                  learning_rate=0.001,
@@ -611,7 +622,8 @@ class AdamOptimizer(Optimizer):
                  beta2=0.999,
                  epsilon=1e-8,
                  regularization=None,
-                 name=None):
+                 name=None,
+                 lazy_mode=False):
         assert learning_rate is not None
         assert beta1 is not None
         assert beta2 is not None
@@ -624,6 +636,7 @@ class AdamOptimizer(Optimizer):
         self._beta1 = beta1
         self._beta2 = beta2
         self._epsilon = epsilon
+        self._lazy_mode = lazy_mode
 
     def _create_accumulators(self, block, parameters):
         assert isinstance(block, framework.Block)
@@ -632,6 +645,12 @@ class AdamOptimizer(Optimizer):
         for p in parameters:
             self._add_accumulator(self._moment1_acc_str, p)
             self._add_accumulator(self._moment2_acc_str, p)
+            if self._lazy_mode:
+                self._add_accumulator(
+                    name=self._row_step_acc_str,
+                    param=p,
+                    dtype='int64',
+                    shape=[p.shape[0]])
             self._add_accumulator(
                 name=self._beta1_pow_acc_str,
                 param=p,
@@ -657,27 +676,36 @@ class AdamOptimizer(Optimizer):
         beta2_pow_acc = self._get_accumulator(self._beta2_pow_acc_str,
                                               param_and_grad[0])
 
+        inputs = {
+            "Param": param_and_grad[0],
+            "Grad": param_and_grad[1],
+            "LearningRate": self._create_param_lr(param_and_grad),
+            "Moment1": moment1,
+            "Moment2": moment2,
+            "Beta1Pow": beta1_pow_acc,
+            "Beta2Pow": beta2_pow_acc
+        }
+        outputs = {
+            "ParamOut": param_and_grad[0],
+            "Moment1Out": moment1,
+            "Moment2Out": moment2
+        }
+        if self._lazy_mode:
+            row_step = self._get_accumulator(self._row_step_acc_str,
+                                             param_and_grad[0])
+            inputs["RowStep"] = row_step
+            outputs["RowStepOut"] = row_step
+
         # create the adam optimize op
         adam_op = block.append_op(
             type=self.type,
-            inputs={
-                "Param": param_and_grad[0],
-                "Grad": param_and_grad[1],
-                "LearningRate": self._create_param_lr(param_and_grad),
-                "Moment1": moment1,
-                "Moment2": moment2,
-                "Beta1Pow": beta1_pow_acc,
-                "Beta2Pow": beta2_pow_acc
-            },
-            outputs={
-                "ParamOut": param_and_grad[0],
-                "Moment1Out": moment1,
-                "Moment2Out": moment2
-            },
+            inputs=inputs,
+            outputs=outputs,
             attrs={
                 "beta1": self._beta1,
                 "beta2": self._beta2,
-                "epsilon": self._epsilon
+                "epsilon": self._epsilon,
+                "lazy_mode": self._lazy_mode
             })
 
         return adam_op
@@ -686,7 +714,6 @@ class AdamOptimizer(Optimizer):
         """Update Beta1 and Beta2 Power accumulators
         """
         assert isinstance(block, framework.Block)
-        main_block = block.program.global_block()
         for param, grad in param_and_grads:
             if grad is None:
                 continue
@@ -696,13 +723,13 @@ class AdamOptimizer(Optimizer):
                                                       param)
                 beta2_pow_acc = self._get_accumulator(self._beta2_pow_acc_str,
                                                       param)
-                main_block.append_op(
+                block.append_op(
                     type="scale",
                     inputs={"X": beta1_pow_acc},
                     outputs={"Out": beta1_pow_acc},
                     attrs={"scale": self._beta1})
 
-                main_block.append_op(
+                block.append_op(
                     type="scale",
                     inputs={"X": beta2_pow_acc},
                     outputs={"Out": beta2_pow_acc},
@@ -825,7 +852,6 @@ class AdamaxOptimizer(Optimizer):
         """Update Beta1 Power accumulator
         """
         assert isinstance(block, framework.Block)
-        main_block = block.program.global_block()
         for param, grad in parameters_and_grads:
             if grad is None:
                 continue
@@ -833,7 +859,7 @@ class AdamaxOptimizer(Optimizer):
                 [param, grad]), name_scope('adamx'):
                 beta1_pow_acc = self._get_accumulator(self._beta1_pow_acc_str,
                                                       param)
-                main_block.append_op(
+                block.append_op(
                     type="scale",
                     inputs={"X": beta1_pow_acc},
                     outputs={"Out": beta1_pow_acc},
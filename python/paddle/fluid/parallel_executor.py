@@ -165,6 +165,7 @@ class ParallelExecutor(object):
             if loss_name else six.u(''), scope, local_scopes, exec_strategy,
             build_strategy, num_trainers, trainer_id)
         self.scope = scope
+        self._pending = None
 
     def run(self, fetch_list, feed=None, feed_dict=None, return_numpy=True):
         """
@@ -231,6 +232,77 @@ class ParallelExecutor(object):
                 loss = pe.run(feed=feeder.feed(cur_batch),
                               fetch_list=[avg_cost.name]))
         """
+        self._prepare(feed, feed_dict)
+        fetch_var_name = '@FETCHED_VAR_NAME@'
+        self.executor.run(fetch_list, fetch_var_name)
+        arr = self.scope.find_var(fetch_var_name).get_lod_tensor_array()
+
+        if return_numpy:
+            return executor.as_numpy(arr)
+
+        return [arr[i] for i in range(len(arr))]
+
+    def run_async(self, fetch_list, feed=None, return_numpy=True):
+        """
+        Start to run the parallel executor like :code:`run`, and return a
+        :code:`RunHandle` of the run without waiting for it. The run does not
+        hold the GIL, so Python can prepare the next batch meanwhile. The
+        next run of this ParallelExecutor waits for it.
+
+        Args:
+            fetch_list(list): The fetched variable names
+            feed(list|dict|None): The feed variables, see :code:`run`.
+            return_numpy(bool): Whether converts the fetched tensor to numpy.
+                Default: True.
+
+        Returns:
+            RunHandle: the handle of the run, :code:`handle.result()` returns
+            the fetched result list.
+
+        Examples:
+            .. code-block:: python
+
+                handle = pe.run_async(feed=feeder.feed(cur_batch),
+                                      fetch_list=[avg_cost.name])
+                # prepare the next batch while the program runs
+                next_batch = next(reader)
+                loss, = handle.result()
+        """
+        self._prepare(feed, None)
+        fetch_var_name = '@FETCHED_VAR_NAME@'
+        handle = executor.RunHandle(
+            self.executor.run_async(fetch_list, fetch_var_name, self.scope),
+            return_numpy)
+        self._pending = handle
+        return handle
+
+    def sync_deferred_broadcasts(self):
+        """
+        Broadcast the parameters optimized in the last run to all the
+        devices. With :code:`build_strategy.overlap_broadcast`, they are
+        broadcast at the beginning of the next run, so the parameters in the
+        scope are one iteration behind until this is called, e.g. before
+        saving or evaluating them.
+
+        Examples:
+            .. code-block:: python
+
+                pe.run(feed=feeder.feed(batch), fetch_list=[avg_cost.name])
+                pe.sync_deferred_broadcasts()
+                fluid.io.save_persistables(exe, "./model")
+        """
+        if self._pending is not None:
+            self._pending._wait_quietly()
+            self._pending = None
+        self.executor.sync_deferred_broadcasts()
+
+    def _prepare(self, feed, feed_dict):
+        # The runs are serial, the next one waits for the last asynchronous
+        # run.
+        if self._pending is not None:
+            self._pending._wait_quietly()
+            self._pending = None
+
         if feed is None and feed_dict is not None:
             feed = feed_dict
             print(
@@ -273,15 +345,6 @@ class ParallelExecutor(object):
                 res.append(res_dict)
             self.executor.feed_tensors_into_local_scopes(res)
 
-        fetch_var_name = '@FETCHED_VAR_NAME@'
-        self.executor.run(fetch_list, fetch_var_name)
-        arr = self.scope.find_var(fetch_var_name).get_lod_tensor_array()
-
-        if return_numpy:
-            return executor.as_numpy(arr)
-
-        return [arr[i] for i in range(len(arr))]
-
     @property
     def device_count(self):
         return len(self._act_places)
@@ -0,0 +1,136 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+from . import core
+from . import framework
+from . import executor
+from .parallel_executor import ExecutionStrategy
+
+__all__ = ['PipelineExecutor']
+
+
+class PipelineExecutor(object):
+    """
+    PipelineExecutor is designed for pipeline parallelism, which partitions
+    the program into stages of the operators, each stage on a device, and
+    splits a batch into micro-batches streaming through the stages, so that
+    the stages run on the different micro-batches at the same time. The
+    activations and their gradients are copied between the devices of the
+    stages, and the gradients of the parameters are averaged over the
+    micro-batches before the optimize operators run once in each iteration.
+
+    The operators are assigned to the stages by fluid.pipeline_stage, and
+    the gradient operators run on the stages of their forward operators.
+
+    Args:
+        places (list(CPUPlace|CUDAPlace)): The place of each stage, which
+            should be all CPUPlace or all CUDAPlace.
+        num_micro_batches (int): The number of micro-batches a batch is split
+            into.
+        main_program (Program): The program that need to run, if not provided,
+            then default_main_program will be used. Default None.
+        scope(Scope): scope to run with, default use fluid.global_scope().
+        exec_strategy(ExecutionStrategy): exec_strategy is used to control how
+            to run the SSA graph, for example how many threads are used.
+            Default None.
+
+    Examples:
+        .. code-block:: python
+
+          with fluid.pipeline_stage(0):
+              hidden = fluid.layers.fc(input=image, size=200)
+          with fluid.pipeline_stage(1):
+              prediction = fluid.layers.fc(input=hidden, size=10)
+              loss = fluid.layers.mean(
+                  fluid.layers.cross_entropy(input=prediction, label=label))
+          fluid.optimizer.SGD(learning_rate=0.01).minimize(loss)
+
+          exe = fluid.Executor(fluid.CPUPlace())
+          exe.run(fluid.default_startup_program())
+          pipe_exe = fluid.PipelineExecutor(
+              places=[fluid.CUDAPlace(0), fluid.CUDAPlace(1)],
+              num_micro_batches=4)
+          # The losses of the micro-batches.
+          losses, = pipe_exe.run(fetch_list=[loss.name],
+                                 feed={'image': image_data,
+                                       'label': label_data})
+    """
+
+    def __init__(self,
+                 places,
+                 num_micro_batches,
+                 main_program=None,
+                 scope=None,
+                 exec_strategy=None):
+        assert places, "no place for execution"
+        use_cuda = isinstance(places[0], core.CUDAPlace)
+        self._places = []
+        for place in places:
+            p = core.Place()
+            p.set_place(place)
+            self._places.append(p)
+
+        if exec_strategy is None:
+            exec_strategy = ExecutionStrategy()
+        exec_strategy.use_cuda = use_cuda
+        if exec_strategy.num_threads == 0:
+            exec_strategy.num_threads = len(self._places) * (4 if use_cuda
+                                                             else 2)
+
+        main = main_program
+        main = main if main else framework.default_main_program()
+        if scope == None:
+            scope = executor.global_scope()
+        self.scope = scope
+
+        self.executor = core.PipelineExecutor(self._places, num_micro_batches,
+                                              main.desc, scope,
+                                              exec_strategy)
+
+    def run(self, fetch_list, feed=None, return_numpy=True):
+        """
+        Run the pipeline over a batch with fetch_list.
+
+        Args:
+            fetch_list(list): The fetched variable names. The variable
+                generated in each micro-batch, e.g. the loss, is fetched
+                from all the micro-batches and merged.
+            feed(dict|None): The feed variables, each of which is split into
+                the micro-batches.
+            return_numpy(bool): Whether converts the fetched tensor to numpy.
+                Default: True.
+
+        Returns:
+            List: The fetched result list.
+        """
+        if feed is not None:
+            feed_tensor_dict = dict()
+            for feed_name in feed:
+                feed_tensor = feed[feed_name]
+                if not isinstance(feed_tensor, core.LoDTensor):
+                    feed_tensor = core.LoDTensor()
+                    feed_tensor.set(feed[feed_name], core.CPUPlace())
+                feed_tensor_dict[feed_name] = feed_tensor
+            self.executor.feed_and_split_tensor_into_micro_batches(
+                feed_tensor_dict)
+
+        fetch_var_name = '@FETCHED_VAR_NAME@'
+        self.executor.run(fetch_list, fetch_var_name)
+        arr = self.scope.find_var(fetch_var_name).get_lod_tensor_array()
+
+        if return_numpy:
+            return executor.as_numpy(arr)
+
+        return [arr[i] for i in range(len(arr))]
@@ -21,7 +21,10 @@ import six
 
 __all__ = [
     'cuda_profiler', 'reset_profiler', 'profiler', 'start_profiler',
-    'stop_profiler'
+    'stop_profiler', 'start_sampling_profiler', 'stop_sampling_profiler',
+    'sampling_profiler_report', 'start_memory_profiler', 'stop_memory_profiler',
+    'memory_profiler_report', 'start_op_phase_profiler',
+    'stop_op_phase_profiler', 'op_phase_profiler_report'
 ]
 
 NVPROF_CONFIG = [
@@ -179,7 +182,12 @@ def stop_profiler(sorted_key=None, profile_path='/tmp/profile'):
             The `min` means sorting by the minimum execution time.
             The `ave` means sorting by the average execution time.
         profile_path (string) : If state == 'All', it will write a profile
-            proto output file.
+            proto output file. If it ends with '.json', a Chrome trace is
+            written instead, with a lane for every CPU thread, CUDA stream
+            and RPC peer, which is opened by chrome://tracing directly. The
+            traces of the trainers and the pservers are merged by
+            tools/timeline.py --chrome_trace_path, where the RPCs are linked
+            to their handling in the pservers.
 
     Raises:
         ValueError: If `sorted_key` is not in
@@ -230,6 +238,11 @@ def profiler(state, sorted_key=None, profile_path='/tmp/profile'):
     Then users can visualize this file to see the timeline, please refer
     https://github.com/PaddlePaddle/Paddle/blob/develop/doc/fluid/howto/optimization/timeline.md
 
+    With the environment variable `FLAGS_profile_perf_counters=1` on Linux,
+    the report also has the IPC, the last level cache misses per call and
+    the memory bandwidth of each operator, read from the hardware counters
+    of the CPU, which tell whether an operator is compute- or memory-bound.
+
     Args:
         state (string) : The profiling state, which should be 'CPU' or 'GPU',
             telling the profiler to use CPU timer or GPU timer for profiling.
@@ -246,7 +259,12 @@ def profiler(state, sorted_key=None, profile_path='/tmp/profile'):
             The `min` means sorting by the minimum execution time.
             The `ave` means sorting by the average execution time.
         profile_path (string) : If state == 'All', it will write a profile
-            proto output file.
+            proto output file. If it ends with '.json', a Chrome trace is
+            written instead, with a lane for every CPU thread, CUDA stream
+            and RPC peer, which is opened by chrome://tracing directly. The
+            traces of the trainers and the pservers are merged by
+            tools/timeline.py --chrome_trace_path, where the RPCs are linked
+            to their handling in the pservers.
 
     Raises:
         ValueError: If `state` is not in ['CPU', 'GPU', 'All']. If `sorted_key` is
@@ -270,3 +288,152 @@ def profiler(state, sorted_key=None, profile_path='/tmp/profile'):
     start_profiler(state)
     yield
     stop_profiler(sorted_key, profile_path)
+
+
+def start_sampling_profiler(period=100):
+    """
+    Start the sampling profiler, which profiles 1 in `period` iterations,
+    i.e. the runs of the executors or the requests of the inference. It is
+    cheap enough to be always on in production, and it could also be enabled
+    by the environment variable `FLAGS_sampling_profiler_period`.
+
+    The latencies of the operators in the sampled iterations are aggregated
+    into histograms, see `fluid.profiler.sampling_profiler_report`. The
+    latencies of the GPU operators are the times to launch them.
+
+    Args:
+        period (int): Profile 1 in `period` iterations.
+
+    Examples:
+
+        .. code-block:: python
+
+            import paddle.fluid.profiler as profiler
+
+            profiler.start_sampling_profiler(100)
+            for iter in range(1000):
+                exe.run(...)
+            print(profiler.sampling_profiler_report())
+    """
+    if period <= 0:
+        raise ValueError("The period of the sampling profiler should be > 0")
+    core.set_sampling_profiler_period(period)
+
+
+def stop_sampling_profiler(reset=False):
+    """
+    Stop the sampling profiler. The histograms aggregated so far are kept
+    for `fluid.profiler.sampling_profiler_report` unless `reset` is True.
+
+    Args:
+        reset (bool): Clear the aggregated histograms.
+    """
+    core.set_sampling_profiler_period(0)
+    if reset:
+        core.reset_sampling_profiler()
+
+
+def sampling_profiler_report():
+    """
+    Return the report of the sampling profiler, one line per operator sorted
+    by the total time, with the number of the calls, the total, average,
+    minimum, maximum and the 50th, 90th and 99th percentile latencies.
+
+    Returns:
+        str: The report.
+    """
+    return core.sampling_profiler_report()
+
+
+def start_memory_profiler():
+    """
+    Start the memory profiler, which records the allocations and the frees
+    of the memory, tagged with the operators allocating them and the output
+    variables holding them. The records of the previous profiling are
+    cleared, and only the allocations since then are tracked.
+
+    It tracks the peak memory of each place and the allocations live at the
+    peak, see `fluid.profiler.memory_profiler_report`.
+
+    Examples:
+
+        .. code-block:: python
+
+            import paddle.fluid.profiler as profiler
+
+            profiler.start_memory_profiler()
+            for iter in range(10):
+                exe.run(...)
+            profiler.stop_memory_profiler()
+            print(profiler.memory_profiler_report())
+    """
+    core.enable_memory_profiler()
+
+
+def stop_memory_profiler():
+    """
+    Stop the memory profiler. The records are kept for
+    `fluid.profiler.memory_profiler_report`.
+    """
+    core.disable_memory_profiler()
+
+
+def memory_profiler_report():
+    """
+    Return the report of the memory profiler. For each place, it has the
+    current and the peak memory, the free memory and the fragmentation of
+    the allocator, the bytes live at the peak by operator, and the largest
+    allocations live at the peak with their variables and operators.
+
+    Returns:
+        str: The report.
+    """
+    return core.memory_profiler_report()
+
+
+def start_op_phase_profiler():
+    """
+    Start the op phase profiler, which accumulates the time of each phase of
+    running the operators by the operator type: the InferShape, the kernel
+    selection, the data transforms of the inputs, the kernel and the eager
+    deletion of the Executor. It also counts the layout, data type and place
+    transforms of the inputs with their bytes. The records of the previous
+    profiling are cleared.
+
+    It can also be enabled by the environment variable
+    FLAGS_profile_op_phases. The CUDA kernels are timed by their launches
+    unless FLAGS_benchmark is also set.
+
+    Examples:
+
+        .. code-block:: python
+
+            import paddle.fluid.profiler as profiler
+
+            profiler.start_op_phase_profiler()
+            for iter in range(10):
+                exe.run(...)
+            profiler.stop_op_phase_profiler()
+            print(profiler.op_phase_profiler_report())
+    """
+    core.enable_op_phase_profiler()
+
+
+def stop_op_phase_profiler():
+    """
+    Stop the op phase profiler. The records are kept for
+    `fluid.profiler.op_phase_profiler_report`.
+    """
+    core.disable_op_phase_profiler()
+
+
+def op_phase_profiler_report():
+    """
+    Return the report of the op phase profiler, the operators sorted by the
+    total time, with the time of each phase and the count and the MB of
+    each kind of the data transforms.
+
+    Returns:
+        str: The report.
+    """
+    return core.op_phase_profiler_report()
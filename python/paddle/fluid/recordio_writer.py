@@ -25,8 +25,10 @@ __all__ = [
 @contextlib.contextmanager
 def create_recordio_writer(filename,
                            compressor=core.RecordIOWriter.Compressor.Snappy,
-                           max_num_records=1000):
-    writer = core.RecordIOWriter(filename, compressor, max_num_records)
+                           max_num_records=1000,
+                           zstd_dict=""):
+    writer = core.RecordIOWriter(filename, compressor, max_num_records,
+                                 zstd_dict)
     yield writer
     writer.close()
 
@@ -37,7 +39,8 @@ def convert_reader_to_recordio_file(
         feeder,
         compressor=core.RecordIOWriter.Compressor.Snappy,
         max_num_records=1000,
-        feed_order=None):
+        feed_order=None,
+        zstd_dict=""):
     """
     Convert a Python Reader to a recordio file.
 
@@ -67,12 +70,15 @@ def convert_reader_to_recordio_file(
             :ref:`api_guide_python_reader`.
         feeder(DataFeeder): The DataFeeder instance. Used to convert
             :code:`reader_creator` to :code: `lod_tensor`
-        compressor: Must in fluid.core.RecordIOWriter.Compressor.Snappy or
-            fluid.core.RecordIOWriter.Compressor.NoCompress. Use :code:`Snappy`
-            by default.
+        compressor: Must in fluid.core.RecordIOWriter.Compressor.Snappy,
+            LZ4, Zstd or NoCompress. Use :code:`Snappy` by default. LZ4 and
+            Zstd decompress much faster than Snappy and Gzip respectively.
         max_num_records(int): Maximum number of records in one chuck. Each record
             is each return value from reader function
         feed_order(list): The order of variable names that the reader returns
+        zstd_dict(bytes): The dictionary to compress the chunks by Zstd. The
+            readers should load it from the file given by the flag
+            :code:`FLAGS_recordio_zstd_dict`.
 
     Returns:
         int: the number of record that saved.
@@ -80,8 +86,8 @@ def convert_reader_to_recordio_file(
     if feed_order is None:
         feed_order = feeder.feed_names
     counter = 0
-    with create_recordio_writer(filename, compressor,
-                                max_num_records) as writer:
+    with create_recordio_writer(filename, compressor, max_num_records,
+                                zstd_dict) as writer:
         for batch in reader_creator():
             res = feeder.feed(batch)
             for each in feed_order:
@@ -98,7 +104,8 @@ def convert_reader_to_recordio_files(
         feeder,
         compressor=core.RecordIOWriter.Compressor.Snappy,
         max_num_records=1000,
-        feed_order=None):
+        feed_order=None,
+        zstd_dict=""):
     """
     convert a python reader to many recordio files.
 
@@ -123,7 +130,7 @@ def convert_reader_to_recordio_files(
         if idx >= batch_per_file and idx % batch_per_file == 0:
             filename = "%s-%05d%s" % (f_name, f_idx, f_ext)
             with create_recordio_writer(filename, compressor,
-                                        max_num_records) as writer:
+                                        max_num_records, zstd_dict) as writer:
                 for l in lines:
                     res = feeder.feed(l)
                     for each in feed_order:
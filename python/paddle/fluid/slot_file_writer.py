@@ -0,0 +1,106 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+from __future__ import print_function
+
+import struct
+
+__all__ = ['convert_reader_to_slot_file']
+
+# The magic number of the slot files, see
+# paddle/fluid/operators/reader/slot_file.h for the format.
+SLOT_FILE_MAGIC = 0x544f4c53
+
+
+class SlotFileWriter(object):
+    """
+    Write the instances of sparse slots to a slot file by chunks, where each
+    instance is a list of the ids of each slot.
+    """
+
+    def __init__(self, filename, num_slots, max_chunk_instances=1024):
+        if num_slots <= 0:
+            raise ValueError("num_slots should be positive")
+        self.file = open(filename, 'wb')
+        self.num_slots = num_slots
+        self.max_chunk_instances = max_chunk_instances
+        self.chunk = []
+        self.file.write(struct.pack('=II', SLOT_FILE_MAGIC, num_slots))
+
+    def write(self, instance):
+        if len(instance) != self.num_slots:
+            raise ValueError("The instance should have %d slots" %
+                             self.num_slots)
+        self.chunk.append(instance)
+        if len(self.chunk) >= self.max_chunk_instances:
+            self.flush()
+
+    def flush(self):
+        if not self.chunk:
+            return
+        self.file.write(struct.pack('=I', len(self.chunk)))
+        for slot in range(self.num_slots):
+            offsets = [0]
+            ids = []
+            for instance in self.chunk:
+                ids.extend(int(i) for i in instance[slot])
+                offsets.append(len(ids))
+            self.file.write(struct.pack('=Q', len(ids)))
+            self.file.write(struct.pack('=%dQ' % len(offsets), *offsets))
+            self.file.write(struct.pack('=%dq' % len(ids), *ids))
+        self.chunk = []
+
+    def close(self):
+        self.flush()
+        self.file.close()
+
+
+def convert_reader_to_slot_file(filename,
+                                reader_creator,
+                                num_slots,
+                                max_chunk_instances=1024):
+    """
+    Convert a Python Reader of the sparse instances to a slot file, which
+    is read by fluid.layers.open_slot_files.
+
+    Each instance of the reader is a list of num_slots lists, the ids of each
+    slot. The slot file keeps the ids by columns, so the ids of a slot of a
+    batch are read by one copy rather than parsing each instance.
+
+    Examples:
+
+        >>> import paddle.fluid as fluid
+        >>>
+        >>> def reader():
+        >>>     yield [[1, 2, 3], [7], [0]]
+        >>>     yield [[4], [8, 9], [1]]
+        >>>
+        >>> fluid.slot_file_writer.convert_reader_to_slot_file(
+        >>>     './data.slot', reader, num_slots=3)
+
+    Args:
+        filename(str): The slot file to write.
+        reader_creator(callable): The Python Reader of the instances.
+        num_slots(int): The number of the slots of each instance.
+        max_chunk_instances(int): The number of the instances of a chunk.
+
+    Returns:
+        int: The number of the instances written.
+    """
+    writer = SlotFileWriter(filename, num_slots, max_chunk_instances)
+    counter = 0
+    for instance in reader_creator():
+        writer.write(instance)
+        counter += 1
+    writer.close()
+    return counter
@@ -40,9 +40,13 @@ class TestParallelExecutorBase(unittest.TestCase):
                                   use_parallel_executor=True,
                                   use_reduce=False,
                                   fuse_elewise_add_act_ops=False,
+                                  fuse_all_reduce_ops=False,
                                   optimizer=fluid.optimizer.Adam,
                                   use_fast_executor=False,
-                                  enable_sequential_execution=False):
+                                  use_work_stealing_executor=False,
+                                  use_priority_scheduling=False,
+                                  enable_sequential_execution=False,
+                                  overlap_broadcast=False):
         def run_executor(exe, feed, fetch_list, program=None):
             if isinstance(exe, fluid.ParallelExecutor):
                 res = exe.run(fetch_list=fetch_list, feed=feed)
@@ -77,12 +81,18 @@ class TestParallelExecutorBase(unittest.TestCase):
             exec_strategy.allow_op_delay = allow_op_delay
             if use_fast_executor:
                 exec_strategy.use_experimental_executor = True
+            if use_priority_scheduling:
+                exec_strategy.use_priority_scheduling = True
+            if use_work_stealing_executor:
+                exec_strategy.use_work_stealing_executor = True
 
             build_strategy = fluid.BuildStrategy()
             build_strategy.reduce_strategy = fluid.BuildStrategy.ReduceStrategy.Reduce \
                 if use_reduce else fluid.BuildStrategy.ReduceStrategy.AllReduce
             build_strategy.fuse_elewise_add_act_ops = fuse_elewise_add_act_ops
+            build_strategy.fuse_all_reduce_ops = fuse_all_reduce_ops
             build_strategy.enable_sequential_execution = enable_sequential_execution
+            build_strategy.overlap_broadcast = overlap_broadcast
             if use_cuda and core.is_compiled_with_cuda():
                 build_strategy.remove_unnecessary_lock = True
 
@@ -313,5 +313,86 @@ class TestSparseAdamOp(unittest.TestCase):
             self.check_with_place(place)
 
 
+class TestLazySparseAdamOp(unittest.TestCase):
+    def check_with_place(self, place):
+        beta1 = 0.78
+        beta2 = 0.836
+        epsilon = 1e-4
+        height = 10
+        rows = [0, 4, 7]
+        row_numel = 12
+        param = np.random.random((height, row_numel)).astype("float32")
+        moment1 = np.random.random((height, row_numel)).astype("float32")
+        moment2 = np.random.random((height, row_numel)).astype("float32")
+        row_step = np.arange(height).astype("int64")
+        lr = np.array([2.0]).astype("float32")
+        grad = np.random.random((len(rows), row_numel)).astype("float32")
+
+        scope = core.Scope()
+        for name, value in [("Param", param), ("Moment1", moment1),
+                            ("Moment2", moment2), ("RowStep", row_step),
+                            ("LearningRate", lr),
+                            ("Beta1Pow", np.array([beta1]).astype("float32")),
+                            ("Beta2Pow", np.array([beta2]).astype("float32"))]:
+            scope.var(name).get_tensor().set(value, place)
+        grad_selected_rows = scope.var('Grad').get_selected_rows()
+        grad_selected_rows.set_height(height)
+        grad_selected_rows.set_rows(rows)
+        grad_selected_rows.get_tensor().set(grad, place)
+
+        adam_op = Operator(
+            "adam",
+            Param="Param",
+            Grad="Grad",
+            LearningRate="LearningRate",
+            Moment1="Moment1",
+            Moment2="Moment2",
+            Beta1Pow="Beta1Pow",
+            Beta2Pow="Beta2Pow",
+            RowStep="RowStep",
+            ParamOut="Param",
+            Moment1Out="Moment1",
+            Moment2Out="Moment2",
+            RowStepOut="RowStep",
+            beta1=beta1,
+            beta2=beta2,
+            epsilon=epsilon,
+            lazy_mode=True)
+        adam_op.run(scope, place)
+
+        # The rows not in the gradient are not changed.
+        param_out = param.copy()
+        moment1_out = moment1.copy()
+        moment2_out = moment2.copy()
+        row_step_out = row_step.copy()
+        for idx, row_id in enumerate(rows):
+            step = row_step[row_id] + 1
+            moment1_out[row_id] = beta1 * moment1[row_id] + (
+                1 - beta1) * grad[idx]
+            moment2_out[row_id] = beta2 * moment2[row_id] + (
+                1 - beta2) * np.square(grad[idx])
+            lr_t = lr * np.sqrt(1 - beta2**step) / (1 - beta1**step)
+            param_out[row_id] = param[row_id] - lr_t * (moment1_out[row_id] / (
+                np.sqrt(moment2_out[row_id]) + epsilon))
+            row_step_out[row_id] = step
+
+        for name, expected in [("Param", param_out), ("Moment1", moment1_out),
+                               ("Moment2", moment2_out)]:
+            actual = np.array(scope.var(name).get_tensor())
+            self.assertTrue(
+                np.allclose(
+                    actual, expected, rtol=1e-5, atol=1e-6), name)
+        self.assertTrue(
+            np.array_equal(
+                np.array(scope.var("RowStep").get_tensor()), row_step_out))
+
+    def test_lazy_sparse_adam(self):
+        places = [core.CPUPlace()]
+        if core.is_compiled_with_cuda():
+            places.append(core.CUDAPlace(0))
+        for place in places:
+            self.check_with_place(place)
+
+
 if __name__ == "__main__":
     unittest.main()
@@ -57,5 +57,69 @@ class TestAucOp(OpTest):
         self.check_output()
 
 
+class TestAucOpWithBatchStat(OpTest):
+    def setUp(self):
+        self.op_type = "auc"
+        pred = np.random.random((128, 2)).astype("float32")
+        labels = np.random.randint(0, 2, (128, 1))
+        num_thresholds = 200
+
+        stat_pos = np.zeros((num_thresholds + 1, )).astype("int64")
+        stat_neg = np.zeros((num_thresholds + 1, )).astype("int64")
+
+        python_auc = metrics.Auc(name="auc",
+                                 curve='ROC',
+                                 num_thresholds=num_thresholds)
+        python_auc.update(pred, labels)
+        batch_stat_pos = np.array(python_auc._stat_pos).reshape(1, -1)
+        batch_stat_neg = np.array(python_auc._stat_neg).reshape(1, -1)
+
+        # The batch statistics are used instead of Predict and Label.
+        self.inputs = {
+            'Predict': np.zeros((128, 2)).astype("float32"),
+            'Label': np.zeros((128, 1)).astype("int64"),
+            "StatPos": stat_pos,
+            "StatNeg": stat_neg,
+            "BatchStatPos": batch_stat_pos.astype("int64"),
+            "BatchStatNeg": batch_stat_neg.astype("int64")
+        }
+        self.attrs = {
+            'curve': 'ROC',
+            'num_thresholds': num_thresholds,
+            "slide_steps": 1
+        }
+        self.outputs = {
+            'AUC': np.array(python_auc.eval()),
+            'StatPosOut': np.array(python_auc._stat_pos),
+            'StatNegOut': np.array(python_auc._stat_neg)
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestAucStatOp(OpTest):
+    def setUp(self):
+        self.op_type = "auc_stat"
+        pred = np.random.random((128, 2)).astype("float32")
+        labels = np.random.randint(0, 2, (128, 1)).astype("int64")
+        num_thresholds = 200
+
+        python_auc = metrics.Auc(name="auc",
+                                 curve='ROC',
+                                 num_thresholds=num_thresholds)
+        python_auc.update(pred, labels)
+
+        self.inputs = {'Predict': pred, 'Label': labels}
+        self.attrs = {'num_thresholds': num_thresholds}
+        self.outputs = {
+            'StatPos': np.array(python_auc._stat_pos).reshape(1, -1),
+            'StatNeg': np.array(python_auc._stat_neg).reshape(1, -1)
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,81 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+from paddle.fluid.backward import append_backward
+from paddle.fluid.framework import Program, program_guard
+
+
+class TestBackwardRecompute(unittest.TestCase):
+    def build_program(self, use_checkpoints):
+        main = Program()
+        startup = Program()
+        with program_guard(main, startup):
+            x = fluid.layers.data(name='x', shape=[16], dtype='float32')
+            checkpoints = []
+            hidden = x
+            for i in range(4):
+                hidden = fluid.layers.fc(
+                    input=hidden,
+                    size=16,
+                    act='tanh',
+                    param_attr=fluid.ParamAttr(
+                        name='w_%d' % i,
+                        initializer=fluid.initializer.Constant(0.1 * (i + 1))),
+                    bias_attr=fluid.ParamAttr(name='b_%d' % i))
+                checkpoints.append(hidden)
+            loss = fluid.layers.mean(hidden)
+            params_grads = append_backward(
+                loss, checkpoints=checkpoints[:-1] if use_checkpoints else None)
+        return main, startup, params_grads
+
+    def test_recompute_ops(self):
+        main, _, _ = self.build_program(True)
+        recompute_ops = [
+            op for op in main.global_block().ops
+            if any('@RECOMPUTE' in name for name in op.output_arg_names)
+        ]
+        self.assertTrue(len(recompute_ops) > 0)
+        for op in recompute_ops:
+            # No checkpoint is used by the grad ops through a recomputed var.
+            for name in op.input_arg_names:
+                self.assertTrue(core.grad_var_suffix() not in name)
+
+    def run_program(self, use_checkpoints):
+        main, startup, params_grads = self.build_program(use_checkpoints)
+        exe = fluid.Executor(fluid.CPUPlace())
+        scope = core.Scope()
+        with fluid.scope_guard(scope):
+            exe.run(startup)
+            x = np.random.RandomState(1).rand(8, 16).astype('float32')
+            return exe.run(main,
+                           feed={'x': x},
+                           fetch_list=[g for _, g in params_grads])
+
+    def test_same_gradients(self):
+        expected = self.run_program(False)
+        actual = self.run_program(True)
+        self.assertEqual(len(expected), len(actual))
+        for e, a in zip(expected, actual):
+            self.assertTrue(np.allclose(e, a, atol=1e-6))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,65 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+class TestBindConcatSlicesOp(unittest.TestCase):
+    """The concat output is written in place by relu and scale from the second
+    run, and is copied again when the shapes change."""
+
+    def check(self, place):
+        main = fluid.Program()
+        startup = fluid.Program()
+        with fluid.program_guard(main, startup):
+            x = fluid.layers.data(
+                name='x', shape=[1, -1, 4], append_batch_size=False)
+            a = fluid.layers.relu(x)
+            b = fluid.layers.scale(x, scale=2.0)
+            out = fluid.layers.concat([a, b], axis=1)
+            main.global_block()._prepend_op(
+                type='bind_concat_slices',
+                attrs={
+                    'input_names': [a.name, b.name],
+                    'output_name': out.name,
+                    'axis': 1
+                })
+
+        exe = fluid.Executor(place)
+        scope = core.Scope()
+        for length in [3, 3, 3, 5, 5, 2]:
+            x_np = np.random.uniform(-1, 1, (1, length, 4)).astype('float32')
+            expected = np.concatenate(
+                (np.maximum(x_np, 0), x_np * 2.0), axis=1)
+            result, = exe.run(main,
+                              feed={'x': x_np},
+                              fetch_list=[out],
+                              scope=scope)
+            self.assertTrue(np.allclose(result, expected))
+
+    def test_cpu(self):
+        self.check(fluid.CPUPlace())
+
+    def test_gpu(self):
+        if core.is_compiled_with_cuda():
+            self.check(fluid.CUDAPlace(0))
+
+
+if __name__ == '__main__':
+    unittest.main()
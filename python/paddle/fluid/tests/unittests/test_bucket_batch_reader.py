@@ -0,0 +1,90 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+
+import numpy as np
+import paddle
+import paddle.fluid as fluid
+
+
+class TestBucketBatchReader(unittest.TestCase):
+    def setUp(self):
+        self.num_instances = 200
+        self.file_name = './bucket_batch_reader_test.recordio'
+        np.random.seed(1)
+        self.lengths = np.random.randint(1, 50, size=self.num_instances)
+
+        def reader():
+            for length in self.lengths:
+                yield [np.arange(length).astype('int64').reshape([-1, 1])]
+
+        with fluid.program_guard(fluid.Program(), fluid.Program()):
+            feeder = fluid.DataFeeder(
+                feed_list=[
+                    fluid.layers.data(
+                        name='word', shape=[1], dtype='int64', lod_level=1)
+                ],
+                place=fluid.CPUPlace())
+            fluid.recordio_writer.convert_reader_to_recordio_file(
+                self.file_name, paddle.batch(
+                    reader, batch_size=1), feeder)
+
+    def read_batches(self, **kwargs):
+        with fluid.program_guard(fluid.Program(), fluid.Program()):
+            reader = fluid.layers.open_files(
+                filenames=[self.file_name],
+                shapes=[[-1, 1]],
+                lod_levels=[1],
+                dtypes=['int64'])
+            reader = fluid.layers.bucket_batch(reader, **kwargs)
+            word, = fluid.layers.read_file(reader)
+
+            exe = fluid.Executor(fluid.CPUPlace())
+            exe.run(fluid.default_startup_program())
+            batches = []
+            while True:
+                try:
+                    word_val, = exe.run(fetch_list=[word], return_numpy=False)
+                except fluid.core.EOFException:
+                    break
+                batches.append(word_val.recursive_sequence_lengths()[0])
+            return batches
+
+    def test_bucket_boundaries(self):
+        boundaries = [10, 20, 40]
+        batches = self.read_batches(
+            batch_size=8, bucket_boundaries=boundaries)
+        total = 0
+        for lengths in batches:
+            self.assertLessEqual(len(lengths), 8)
+            buckets = np.searchsorted(boundaries, lengths, side='right')
+            self.assertEqual(len(set(buckets)), 1)
+            total += len(lengths)
+        self.assertEqual(total, self.num_instances)
+
+    def test_batch_tokens(self):
+        batches = self.read_batches(
+            batch_tokens=200, bucket_boundaries=[10, 20, 40], pool_size=64)
+        total = 0
+        for lengths in batches:
+            self.assertLessEqual(len(lengths) * max(lengths), 200)
+            total += len(lengths)
+        self.assertEqual(total, self.num_instances)
+
+
+if __name__ == '__main__':
+    unittest.main()
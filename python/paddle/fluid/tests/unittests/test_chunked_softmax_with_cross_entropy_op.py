@@ -0,0 +1,116 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+
+from op_test import OpTest
+from test_softmax_op import stable_softmax
+
+
+class TestChunkedSoftmaxWithCrossEntropyOp(OpTest):
+    """
+    Test the chunked softmax with cross entropy with hard labels.
+    """
+
+    def init_params(self):
+        self.batch_size = 41
+        self.class_num = 37
+        self.chunk_size = 8
+        self.ignore_index = -100
+
+    def setUp(self):
+        self.init_params()
+        self.op_type = "chunked_softmax_with_cross_entropy"
+        logits = np.random.uniform(
+            -5.0, 5.0, [self.batch_size, self.class_num]).astype("float64")
+        softmax = np.apply_along_axis(stable_softmax, 1, logits)
+        labels = np.random.randint(
+            0, self.class_num, [self.batch_size, 1], dtype="int64")
+        if self.ignore_index >= 0:
+            labels[::3] = self.ignore_index
+
+        loss = np.array(
+            [[0.0 if labels[i][0] == self.ignore_index else
+              -np.log(softmax[i][labels[i][0]])]
+             for i in range(self.batch_size)]).astype("float64")
+        log_sum_exp = np.log(np.sum(np.exp(logits), axis=1, keepdims=True))
+
+        self.inputs = {"Logits": logits, "Label": labels}
+        self.outputs = {"Loss": loss, "LogSumExp": log_sum_exp}
+        self.attrs = {
+            "chunk_size": self.chunk_size,
+            "ignore_index": self.ignore_index
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad(self):
+        self.check_grad(["Logits"], "Loss")
+
+
+class TestChunkedSoftmaxWithCrossEntropyOpOneChunk(
+        TestChunkedSoftmaxWithCrossEntropyOp):
+    def init_params(self):
+        self.batch_size = 13
+        self.class_num = 37
+        self.chunk_size = 4096
+        self.ignore_index = -100
+
+
+class TestChunkedSoftmaxWithCrossEntropyOpIgnoreIndex(
+        TestChunkedSoftmaxWithCrossEntropyOp):
+    def init_params(self):
+        self.batch_size = 41
+        self.class_num = 37
+        self.chunk_size = 5
+        self.ignore_index = 3
+
+
+class TestChunkedSoftmaxWithCrossEntropyOpSoftLabel(OpTest):
+    """
+    Test the chunked softmax with cross entropy with soft labels.
+    """
+
+    def setUp(self):
+        self.op_type = "chunked_softmax_with_cross_entropy"
+        batch_size = 41
+        class_num = 37
+
+        logits = np.random.uniform(-5.0, 5.0,
+                                   [batch_size, class_num]).astype("float64")
+        softmax = np.apply_along_axis(stable_softmax, 1, logits)
+        labels = np.random.uniform(0.1, 1.0,
+                                   [batch_size, class_num]).astype("float64")
+        labels /= np.sum(labels, axis=1, keepdims=True)
+        loss = (-labels * np.log(softmax)).sum(
+            axis=1, keepdims=True).astype("float64")
+        log_sum_exp = np.log(np.sum(np.exp(logits), axis=1, keepdims=True))
+
+        self.inputs = {"Logits": logits, "Label": labels}
+        self.outputs = {"Loss": loss, "LogSumExp": log_sum_exp}
+        self.attrs = {"soft_label": True, "chunk_size": 10}
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad(self):
+        self.check_grad(["Logits"], "Loss")
+
+
+if __name__ == "__main__":
+    unittest.main()
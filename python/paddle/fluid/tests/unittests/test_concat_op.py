@@ -64,5 +64,39 @@ class TestConcatOp3(TestConcatOp):
         pass
 
 
+class TestConcatOpManyInputs(OpTest):
+    """More inputs than the kernel parameters of the CUDA kernel hold."""
+
+    def setUp(self):
+        self.op_type = "concat"
+        self.init_test_data()
+        self.inputs = {
+            'X': [('x%d' % i, x) for i, x in enumerate(self.xs)]
+        }
+        self.attrs = {'axis': self.axis}
+        self.outputs = {'Out': np.concatenate(self.xs, axis=self.axis)}
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad(self):
+        self.check_grad(['x0', 'x37', 'x99'], 'Out')
+
+    def init_test_data(self):
+        self.xs = [
+            np.random.random((3, i % 3 + 1, 2)).astype('float32')
+            for i in range(100)
+        ]
+        self.axis = 1
+
+
+class TestConcatOpManyInputsSameShape(TestConcatOpManyInputs):
+    def init_test_data(self):
+        self.xs = [
+            np.random.random((2, 3)).astype('float32') for i in range(100)
+        ]
+        self.axis = 0
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -223,6 +223,34 @@ class TestWithInput1x1Filter1x1(TestConv2dOp):
 
 
 #----------------Conv2dCUDNN----------------
+class TestFakeQuantConv2dOp(OpTest):
+    def setUp(self):
+        self.op_type = "conv2d"
+        input = np.random.random((2, 3, 5, 5)).astype("float32") - 0.5
+        filter = np.random.random((6, 3, 3, 3)).astype("float32") - 0.5
+
+        def fake_quant_dequant(x, bits):
+            scale = np.abs(x).max()
+            bin_cnt = (1 << (bits - 1)) - 1
+            return np.round(x * bin_cnt / scale) * scale / bin_cnt
+
+        conv2d_param = {'stride': [1, 1], 'pad': [1, 1], 'dilation': [1, 1]}
+        output = conv2d_forward_naive(
+            fake_quant_dequant(input, 8),
+            fake_quant_dequant(filter, 8), 1, conv2d_param).astype("float32")
+        self.inputs = {'Input': input, 'Filter': filter}
+        self.attrs = {
+            'strides': [1, 1],
+            'paddings': [1, 1],
+            'input_quant_bits': 8,
+            'filter_quant_bits': 8
+        }
+        self.outputs = {'Output': output}
+
+    def test_check_output(self):
+        self.check_output_with_place(core.CPUPlace(), atol=1e-5)
+
+
 class TestCUDNN(TestConv2dOp):
     def init_kernel_type(self):
         self.use_cudnn = True
@@ -325,6 +353,45 @@ class TestFP16CUDNNWithInput1x1Filter1x1(TestWithInput1x1Filter1x1):
                 self.check_output_with_place(place, atol=2e-2)
 
 
+#----------------Conv2dCUDNN NHWC----------------
+def to_nhwc(x):
+    return np.ascontiguousarray(np.transpose(x, (0, 2, 3, 1)))
+
+
+@unittest.skipIf(not core.is_compiled_with_cuda(),
+                 "core is not compiled with CUDA")
+class TestCUDNNNHWC(TestCUDNN):
+    def setUp(self):
+        super(TestCUDNNNHWC, self).setUp()
+        # The filter is MHWC along with the NHWC input and output.
+        self.attrs['data_format'] = "NHWC"
+        self.inputs['Input'] = to_nhwc(self.inputs['Input'])
+        self.inputs['Filter'] = to_nhwc(self.inputs['Filter'])
+        self.outputs['Output'] = to_nhwc(self.outputs['Output'])
+
+
+@unittest.skipIf(not core.is_compiled_with_cuda(),
+                 "core is not compiled with CUDA")
+class TestCUDNNNHWCWithGroup(TestCUDNNWithGroup):
+    def setUp(self):
+        super(TestCUDNNNHWCWithGroup, self).setUp()
+        self.attrs['data_format'] = "NHWC"
+        self.inputs['Input'] = to_nhwc(self.inputs['Input'])
+        self.inputs['Filter'] = to_nhwc(self.inputs['Filter'])
+        self.outputs['Output'] = to_nhwc(self.outputs['Output'])
+
+
+@unittest.skipIf(not core.is_compiled_with_cuda(),
+                 "core is not compiled with CUDA")
+class TestFP16CUDNNNHWC(TestFP16CUDNN):
+    def setUp(self):
+        super(TestFP16CUDNNNHWC, self).setUp()
+        self.attrs['data_format'] = "NHWC"
+        self.inputs['Input'] = to_nhwc(self.inputs['Input'])
+        self.inputs['Filter'] = to_nhwc(self.inputs['Filter'])
+        self.outputs['Output'] = to_nhwc(self.outputs['Output'])
+
+
 class TestDepthwiseConv(TestConv2dOp):
     def init_test_case(self):
         self.use_cuda = True
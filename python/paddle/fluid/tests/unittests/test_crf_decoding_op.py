@@ -89,9 +89,14 @@ class TestCRFDecodingOp1(OpTest):
     with grouth truth not being given.
     """
 
+    def init_sizes(self):
+        self.seq_num = 3
+        self.tag_num = 17
+
     def set_test_data(self):
-        SEQ_NUM = 3
-        TAG_NUM = 17
+        self.init_sizes()
+        SEQ_NUM = self.seq_num
+        TAG_NUM = self.tag_num
         MAX_SEQ_LEN = 10
 
         lod = [[]]
@@ -122,6 +127,16 @@ class TestCRFDecodingOp1(OpTest):
         self.check_output()
 
 
+class TestCRFDecodingOpBatch(TestCRFDecodingOp1):
+    """
+    Decode a large batch of sequences, which are run by several threads.
+    """
+
+    def init_sizes(self):
+        self.seq_num = 128
+        self.tag_num = 23
+
+
 class TestCRFDecodingOp2(OpTest):
     """
     Compare the dynamic program with brute force computation with
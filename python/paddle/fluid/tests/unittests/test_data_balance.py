@@ -85,6 +85,7 @@ class TestDataBalance(unittest.TestCase):
         self.lod_data_file_name = './data_balance_with_lod_test.recordio'
         self.total_ins_num = 50
         self.batch_size = 12
+        self.balance_by_tokens = False
         self.prepare_data()
         self.prepare_lod_data()
 
@@ -107,6 +108,7 @@ class TestDataBalance(unittest.TestCase):
 
             build_strategy = fluid.BuildStrategy()
             build_strategy.enable_data_balance = True
+            build_strategy.data_balance_by_tokens = self.balance_by_tokens
             parallel_exe = fluid.ParallelExecutor(
                 use_cuda=self.use_cuda,
                 main_program=main_prog,
@@ -152,6 +154,7 @@ class TestDataBalance(unittest.TestCase):
             exe.run(startup_prog)
             build_strategy = fluid.BuildStrategy()
             build_strategy.enable_data_balance = True
+            build_strategy.data_balance_by_tokens = self.balance_by_tokens
             parallel_exe = fluid.ParallelExecutor(
                 use_cuda=self.use_cuda,
                 main_program=main_prog,
@@ -193,5 +196,11 @@ class TestDataBalance(unittest.TestCase):
         self.main_lod()
 
 
+class TestDataBalanceByTokens(TestDataBalance):
+    def setUp(self):
+        TestDataBalance.setUp(self)
+        self.balance_by_tokens = True
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,102 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+import unittest
+
+
+class TestDataFeeder(unittest.TestCase):
+    def setUp(self):
+        self.main_program = fluid.Program()
+        with fluid.program_guard(self.main_program, fluid.Program()):
+            self.img = fluid.layers.data(name='image', shape=[1, 2, 3])
+            self.label = fluid.layers.data(
+                name='label', shape=[1], dtype='int64')
+            self.words = fluid.layers.data(
+                name='words', shape=[1], dtype='int64', lod_level=1)
+            self.paragraphs = fluid.layers.data(
+                name='paragraphs', shape=[2], dtype='float32', lod_level=2)
+
+    def feed(self, samples, place=None):
+        feeder = fluid.DataFeeder(
+            [self.img, self.label, self.words, self.paragraphs],
+            place or fluid.CPUPlace(),
+            program=self.main_program)
+        return feeder.feed(samples)
+
+    def check(self, samples, place=None):
+        result = self.feed(samples, place)
+
+        img = np.array(result['image'])
+        self.assertEqual(img.shape, (len(samples), 1, 2, 3))
+        for i, sample in enumerate(samples):
+            self.assertTrue(
+                np.array_equal(img[i].flatten(),
+                               np.array(sample[0], dtype='float32').flatten()))
+
+        label = np.array(result['label'])
+        self.assertEqual(label.shape, (len(samples), 1))
+        self.assertEqual(label.dtype, np.int64)
+        self.assertEqual(label.flatten().tolist(),
+                         [int(np.array(s[1]).item()) for s in samples])
+
+        words = result['words']
+        self.assertEqual(words.recursive_sequence_lengths(),
+                         [[len(s[2]) for s in samples]])
+        expected = np.concatenate([np.array(s[2]).flatten() for s in samples])
+        self.assertEqual(np.array(words).shape, (len(expected), 1))
+        self.assertEqual(np.array(words).flatten().tolist(), expected.tolist())
+
+        paragraphs = result['paragraphs']
+        self.assertEqual(paragraphs.recursive_sequence_lengths(),
+                         [[len(s[3]) for s in samples],
+                          [len(seq) for s in samples for seq in s[3]]])
+        expected = [
+            np.array(seq, dtype='float32').reshape([-1, 2])
+            for s in samples for seq in s[3]
+        ]
+        self.assertTrue(
+            np.array_equal(np.array(paragraphs), np.concatenate(expected)))
+
+    def test_lists(self):
+        self.check([([0] * 6, [9], [1, 2, 3], [[[1, 2]], [[3, 4], [5, 6]]]),
+                    ([1.5] * 6, [1], [4], [[[7, 8]]])])
+
+    def test_numpy_arrays(self):
+        samples = []
+        for i in range(4):
+            samples.append((np.random.random([1, 2, 3]).astype('float32'),
+                            np.array(i), np.arange(i + 1).reshape([-1, 1]), [
+                                np.random.random([2, 2]), np.random.random(
+                                    [i + 1, 2]).astype('float32')
+                            ]))
+        self.check(samples)
+
+    def test_cuda_place(self):
+        if core.is_compiled_with_cuda():
+            self.check(
+                [([0] * 6, 9, [1, 2, 3], [[[1, 2]]])], place=fluid.CUDAPlace(0))
+
+    def test_wrong_shape(self):
+        with self.assertRaises(core.EnforceNotMet):
+            self.feed([([0] * 6, [9], [1, 2], [[[1, 2]]]),
+                       ([0] * 5, [1], [4], [[[7, 8]]])])
+
+
+if __name__ == "__main__":
+    unittest.main()
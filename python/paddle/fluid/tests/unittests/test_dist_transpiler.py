@@ -213,6 +213,96 @@ class TestBasicModelWithLargeBlockSize(TranspilerTest):
         self.assertEqual(set(pserver_params), set(trainer_params))
 
 
+class TestGradientCompression(TranspilerTest):
+    def transpiler_test_impl(self):
+        config = fluid.DistributeTranspilerConfig()
+        config.gradient_compression = {"fc_w": "topk", "fc_b": "fp16"}
+        config.topk_ratio = 0.05
+
+        trainer, _ = self.get_trainer(config)
+
+        compress_types = {}
+        for op in trainer.global_block().ops:
+            if op.type == "send":
+                for name in op.input("X"):
+                    compress_types[name] = (op.attr("compress_types"),
+                                            op.attr("topk_ratio"))
+        self.assertEqual(len(compress_types), 3)
+        for name, (types, ratio) in six.iteritems(compress_types):
+            if name.startswith("fc_w@GRAD"):
+                self.assertTrue(all([t == 2 for t in types]))
+                self.assertAlmostEqual(ratio, 0.05)
+            elif name.startswith("fc_b@GRAD"):
+                self.assertTrue(all([t == 1 for t in types]))
+
+
+class TestAsyncStaleness(TranspilerTest):
+    def transpiler_test_impl(self):
+        config = fluid.DistributeTranspilerConfig()
+        config.staleness = 3
+
+        pserver, _ = self.get_pserver(self.pserver1_ep, config, False)
+        trainer, _ = self.get_trainer(config)
+
+        listen_op = pserver.global_block().ops[0]
+        self.assertFalse(listen_op.attr("sync_mode"))
+        self.assertEqual(listen_op.attr("staleness"), 3)
+
+        ops = [op.type for op in trainer.global_block().ops]
+        self.assertIn("send_barrier", ops)
+        self.assertNotIn("fetch_barrier", ops)
+        self.assertLess(ops.index("send_barrier"), ops.index("recv"))
+
+
+class TestPipelineOptimize(TranspilerTest):
+    def transpiler_test_impl(self):
+        config = fluid.DistributeTranspilerConfig()
+        config.pipeline_optimize = True
+
+        pserver, _ = self.get_pserver(self.pserver1_ep, config)
+        listen_op = pserver.global_block().ops[0]
+        self.assertTrue(listen_op.attr("sync_mode"))
+        self.assertTrue(listen_op.attr("pipeline_optimize"))
+
+
+class TestOverlapRecv(TranspilerTest):
+    def transpiler_test_impl(self):
+        config = fluid.DistributeTranspilerConfig()
+        config.overlap_recv = True
+
+        trainer, trainer_startup = self.get_trainer(config)
+
+        self.assertEqual(
+            [op.type for op in trainer_startup.global_block().ops],
+            ['fill_constant', 'fill_constant', 'uniform_random'])
+
+        ops = trainer.global_block().ops
+        self.assertEqual([op.type for op in ops], [
+            'recv', 'recv', 'fetch_barrier', 'concat', 'mul', 'elementwise_add',
+            'elementwise_sub', 'square', 'mean', 'fill_constant', 'mean_grad',
+            'square_grad', 'elementwise_sub_grad', 'elementwise_add_grad',
+            'send', 'mul_grad', 'split_byref', 'send', 'send_barrier'
+        ])
+        # the parameters are received in the order the forward ops use them
+        self.assertEqual(ops[0].output("Out"), ["fc_w.block0", "fc_w.block1"])
+        self.assertEqual(ops[1].output("Out"), ["fc_b"])
+        self.assertTrue(ops[0].attr("sync_mode"))
+        # the forward ops do not depend on the fetch barrier
+        self.assertEqual(ops[2].input("X"),
+                         ["fc_w.block0", "fc_w.block1", "fc_b"])
+        self.assertIn(ops[2].output("Out")[0], ops[-1].input("X"))
+
+        # the sync program gets the last update of the parameters
+        sync = self.transpiler.get_trainer_sync_program()
+        ops = sync.global_block().ops
+        self.assertEqual([op.type for op in ops],
+                         ['recv', 'recv', 'fetch_barrier', 'concat'])
+        self.assertEqual(ops[3].output("Out"), ["fc_w"])
+        self.assertTrue(sync.global_block().var("fc_w").persistable)
+        self.assertTrue(sync.global_block().var("fc_b").persistable)
+        self.assertFalse(sync.global_block().var("fc_w.block0").persistable)
+
+
 class TestNoSliceVar(TranspilerTest):
     def setUp(self):
         super(TestNoSliceVar, self).setUp()
@@ -674,6 +764,28 @@ class TestDistLookupTableSliceSize(TestDistLookupTableBase):
         self.assertEqual(row_size, calc_row_size)
 
 
+class TestDistLookupTablePrefetchCache(TestDistLookupTableBase):
+    def net_conf(self):
+        self.network_with_table(is_sparse=True, is_distributed=True)
+
+    def transpiler_test_impl(self):
+        config = fluid.DistributeTranspilerConfig()
+        config.prefetch_cache_size = 1000
+        config.prefetch_cache_staleness = 2
+        config.prefetch_pipeline = True
+        trainer, _ = self.get_trainer(config)
+
+        prefetch_ops = [
+            op for op in trainer.global_block().ops if op.type == "prefetch"
+        ]
+        self.assertEqual(len(prefetch_ops), 1)
+        op = prefetch_ops[0]
+        self.assertEqual(op.attr("table_name"), self.lookup_table_name)
+        self.assertEqual(op.attr("cache_size"), 1000)
+        self.assertEqual(op.attr("cache_staleness"), 2)
+        self.assertTrue(op.attr("pipeline"))
+
+
 class TestDistArgsInProgram(TestDistLookupTableBase):
     def net_conf(self):
         self.network_with_table(is_sparse=True, is_distributed=True)
@@ -775,6 +887,33 @@ class TestNCCL2Transpile(TranspilerTest):
         else:
             pass
 
+    def test_nccl2_hierarchical_allreduce_transpile(self):
+        if fluid.core.is_compiled_with_cuda():  #test nccl2 only with cuda
+            main = fluid.Program()
+            startup = fluid.Program()
+            with fluid.program_guard(main, startup):
+                self.net_conf()
+
+            config = fluid.DistributeTranspilerConfig()
+            config.mode = "nccl2"
+            config.use_hierarchical_allreduce = True
+            config.hierarchical_allreduce_num_devices = 2
+            t = fluid.DistributeTranspiler(config=config)
+            t.transpile(
+                0,
+                trainers="127.0.0.1:6174,127.0.0.1:6175",
+                current_endpoint="127.0.0.1:6174",
+                startup_program=startup)
+            gen_nccl_id_op = startup.global_block().ops[-1]
+            self.assertEqual(gen_nccl_id_op.type, "gen_nccl_id")
+            self.assertEqual(
+                gen_nccl_id_op.output("NCCLIDInter"),
+                ["NCCLID_INTER_0", "NCCLID_INTER_1"])
+            for name in gen_nccl_id_op.output("NCCLIDInter"):
+                self.assertIsNotNone(startup.global_block().vars.get(name))
+        else:
+            pass
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -59,6 +59,56 @@ class TestDropoutOp3(TestDropoutOp):
         }
 
 
+class TestDropoutOpBitMask(TestDropoutOp):
+    def setUp(self):
+        self.op_type = "dropout"
+        self.inputs = {'X': np.random.random((5, 3)).astype("float32")}
+        self.attrs = {
+            'dropout_prob': 0.0,
+            'fix_seed': True,
+            'is_test': False,
+            'bit_mask': True
+        }
+        # 15 bits kept in 2 bytes
+        self.outputs = {
+            'Out': self.inputs['X'],
+            'Mask': np.array([255, 127]).astype('uint8')
+        }
+
+
+class TestDropoutOpBitMask2(TestDropoutOp):
+    def setUp(self):
+        self.op_type = "dropout"
+        self.inputs = {'X': np.random.random((32, 64)).astype("float32")}
+        self.attrs = {
+            'dropout_prob': 1.0,
+            'fix_seed': True,
+            'is_test': False,
+            'bit_mask': True
+        }
+        self.outputs = {
+            'Out': np.zeros((32, 64)).astype('float32'),
+            'Mask': np.zeros((32 * 64 // 8, )).astype('uint8')
+        }
+
+
+class TestDropoutOpBitMask3(TestDropoutOp):
+    def setUp(self):
+        self.op_type = "dropout"
+        self.inputs = {'X': np.random.random((32, 64, 2)).astype("float32")}
+        self.attrs = {
+            'dropout_prob': 0.0,
+            'fix_seed': True,
+            'is_test': False,
+            'bit_mask': True,
+            'dropout_implementation': 'upscale_in_train'
+        }
+        self.outputs = {
+            'Out': self.inputs['X'],
+            'Mask': np.full((32 * 64 * 2 // 8, ), 255).astype('uint8')
+        }
+
+
 class TestDropoutOp4(OpTest):
     def setUp(self):
         self.op_type = "dropout"
@@ -0,0 +1,63 @@
+# Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import os
+os.environ['FLAGS_eager_delete_tensor_gb'] = '0.0'
+
+import unittest
+import numpy
+import paddle.fluid as fluid
+import paddle.fluid.layers as layers
+import paddle.fluid.core as core
+
+
+class TestEagerDeletionWhileOp(unittest.TestCase):
+    def run_loop(self, place):
+        main = fluid.Program()
+        startup = fluid.Program()
+        with fluid.program_guard(main, startup):
+            x = layers.data(
+                "x", shape=[10], append_batch_size=False, dtype='float32')
+            i = layers.zeros(shape=[1], dtype='int64')
+            steps = layers.fill_constant(shape=[1], dtype='int64', value=5)
+            acc = layers.zeros(shape=[10], dtype='float32')
+            cond = layers.less_than(x=i, y=steps)
+            while_op = layers.While(cond=cond, is_test=True)
+            with while_op.block():
+                # the temporaries of a step are freed after their last use,
+                # x is read by every step and freed after the loop.
+                tmp = layers.scale(x, scale=2.0)
+                tmp = layers.elementwise_add(tmp, x)
+                layers.assign(layers.elementwise_add(acc, tmp), acc)
+                layers.increment(x=i, in_place=True)
+                layers.less_than(x=i, y=steps, cond=cond)
+
+        exe = fluid.Executor(place)
+        exe.run(startup)
+        data = numpy.random.random(size=[10]).astype('float32')
+        out, = exe.run(main, feed={'x': data}, fetch_list=[acc])
+        self.assertTrue(numpy.allclose(out, data * 15., atol=1e-5))
+
+    def test_cpu(self):
+        self.run_loop(core.CPUPlace())
+
+    def test_gpu(self):
+        if core.is_compiled_with_cuda():
+            self.run_loop(core.CUDAPlace(0))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -278,5 +278,16 @@ class TestFP16ElementwiseAddOp_channelwise_add(TestFP16ElementwiseAddOp):
         self.axis = -1
 
 
+class TestElementwiseAddOp_broadcast_inner_one(TestElementwiseAddOp):
+    # Y is broadcast along its dims of size 1 as well as the ones it lacks.
+    def init_input_output(self):
+        self.x = np.random.rand(2, 3, 4, 5).astype(self.dtype)
+        self.y = np.random.rand(2, 1, 4).astype(self.dtype)
+        self.out = self.x + self.y.reshape(2, 1, 4, 1)
+
+    def init_axis(self):
+        self.axis = 0
+
+
 if __name__ == '__main__':
     unittest.main()
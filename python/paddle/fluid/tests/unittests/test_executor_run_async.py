@@ -0,0 +1,84 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+
+import numpy
+import paddle.fluid.core as core
+from paddle.fluid.executor import Executor
+from paddle.fluid.framework import Program, program_guard
+from paddle.fluid.layers import mul, data
+
+
+class TestExecutorRunAsync(unittest.TestCase):
+    def test_mul(self):
+        with program_guard(Program(), Program()):
+            self.check_mul()
+
+    def check_mul(self):
+        a = data(name='a', shape=[784], dtype='float32')
+        b = data(
+            name='b',
+            shape=[784, 100],
+            dtype='float32',
+            append_batch_size=False)
+        out = mul(x=a, y=b)
+        place = core.CPUPlace()
+        exe = Executor(place)
+
+        handles = []
+        inputs = []
+        for use_program_cache in [False, True, True]:
+            a_np = numpy.random.random((100, 784)).astype('float32')
+            b_np = numpy.random.random((784, 100)).astype('float32')
+            inputs.append((a_np, b_np))
+            # The next run waits for the last one.
+            handles.append(
+                exe.run_async(
+                    feed={'a': a_np,
+                          'b': b_np},
+                    fetch_list=[out],
+                    use_program_cache=use_program_cache))
+
+        # The results of the earlier runs are kept by their handles.
+        for handle, (a_np, b_np) in zip(handles, inputs):
+            outs = handle.result()
+            self.assertTrue(handle.done())
+            self.assertEqual((100, 100), outs[0].shape)
+            self.assertTrue(numpy.allclose(outs[0], numpy.dot(a_np, b_np)))
+
+    def test_error(self):
+        with program_guard(Program(), Program()):
+            self.check_error()
+
+    def check_error(self):
+        a = data(name='x', shape=[784], dtype='float32')
+        b = data(
+            name='y',
+            shape=[784, 100],
+            dtype='float32',
+            append_batch_size=False)
+        out = mul(x=a, y=b)
+        exe = Executor(core.CPUPlace())
+        a_np = numpy.random.random((100, 784)).astype('float32')
+        b_np = numpy.random.random((10, 100)).astype('float32')
+        handle = exe.run_async(feed={'x': a_np, 'y': b_np}, fetch_list=[out])
+        self.assertRaises(core.EnforceNotMet, handle.wait)
+        self.assertRaises(core.EnforceNotMet, handle.result)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,96 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+class TestFusedDropoutAddOp(OpTest):
+    def setUp(self):
+        self.op_type = "fused_dropout_add"
+        self.init_test_case()
+        x = np.random.random(self.shape).astype("float32")
+        y = np.random.random(self.shape).astype("float32")
+        self.inputs = {'X': x, 'Y': y}
+        self.attrs = {
+            'dropout_prob': self.prob,
+            'fix_seed': True,
+            'is_test': False,
+            'bit_mask': self.bit_mask
+        }
+        keep = 1.0 - self.prob
+        if self.bit_mask:
+            numel = x.size
+            mask = np.full(((numel + 7) // 8, ), 255 if keep else 0)
+            if keep and numel % 8:
+                mask[-1] = (1 << (numel % 8)) - 1
+            mask = mask.astype('uint8')
+        else:
+            mask = np.full(self.shape, keep).astype('float32')
+        self.outputs = {'Out': x * keep + y, 'Mask': mask}
+
+    def init_test_case(self):
+        self.shape = (32, 64)
+        self.prob = 0.0
+        self.bit_mask = False
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad_normal(self):
+        self.check_grad(['X', 'Y'], 'Out', max_relative_error=0.05)
+
+
+class TestFusedDropoutAddOp2(TestFusedDropoutAddOp):
+    def init_test_case(self):
+        self.shape = (32, 64)
+        self.prob = 1.0
+        self.bit_mask = False
+
+    def test_check_grad_normal(self):
+        self.check_grad(['Y'], 'Out', no_grad_set=set(['X']))
+
+
+class TestFusedDropoutAddOpBitMask(TestFusedDropoutAddOp):
+    def init_test_case(self):
+        self.shape = (5, 3, 7)
+        self.prob = 0.0
+        self.bit_mask = True
+
+
+class TestFusedDropoutAddOpBitMask2(TestFusedDropoutAddOp2):
+    def init_test_case(self):
+        self.shape = (5, 3, 7)
+        self.prob = 1.0
+        self.bit_mask = True
+
+
+class TestFusedDropoutAddOpInfer(OpTest):
+    def setUp(self):
+        self.op_type = "fused_dropout_add"
+        x = np.random.random((32, 64)).astype("float32")
+        y = np.random.random((32, 64)).astype("float32")
+        self.inputs = {'X': x, 'Y': y}
+        self.attrs = {'dropout_prob': 0.35, 'is_test': True}
+        self.outputs = {'Out': x * (1.0 - 0.35) + y}
+
+    def test_check_output(self):
+        self.check_output()
+
+
+if __name__ == '__main__':
+    unittest.main()
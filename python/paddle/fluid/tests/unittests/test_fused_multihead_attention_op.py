@@ -0,0 +1,114 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+def attention(q, k, v, bias, alpha, out_scale):
+    qk = np.matmul(q, np.swapaxes(k, -1, -2)) * alpha
+    if bias is not None:
+        qk = qk + bias
+    shifted = np.clip(qk - np.max(qk, axis=-1, keepdims=True), -64., 0.)
+    exps = np.exp(shifted)
+    weights = exps / np.sum(exps, axis=-1, keepdims=True)
+    return np.matmul(weights, v) * out_scale
+
+
+class TestFusedMultiHeadAttentionOp(OpTest):
+    def set_conf(self):
+        pass
+
+    def setUp(self):
+        self.op_type = 'fused_multihead_attention'
+        self.batch_size = 2
+        self.num_heads = 4
+        self.seq_q = 5
+        self.seq_k = 7
+        self.size_qk = 16
+        self.size_v = 8
+        self.alpha = 0.25
+        self.out_scale = 1.0
+        self.with_bias = True
+        self.set_conf()
+
+        batch = [self.batch_size, self.num_heads]
+        q = np.random.uniform(
+            -1, 1, batch + [self.seq_q, self.size_qk]).astype('float32')
+        k = np.random.uniform(
+            -1, 1, batch + [self.seq_k, self.size_qk]).astype('float32')
+        v = np.random.uniform(
+            -1, 1, batch + [self.seq_k, self.size_v]).astype('float32')
+        self.inputs = {'Q': q, 'K': k, 'V': v}
+        bias = None
+        if self.with_bias:
+            bias = np.random.uniform(
+                -1, 1, batch + [self.seq_q, self.seq_k]).astype('float32')
+            self.inputs['BiasQK'] = bias
+        self.attrs = {'alpha': self.alpha, 'out_scale': self.out_scale}
+        self.outputs = {
+            'Out': attention(q, k, v, bias, self.alpha, self.out_scale)
+        }
+
+    def test_check_output(self):
+        self.check_output(atol=1e-5)
+
+
+class TestFusedMultiHeadAttentionOpNoBias(TestFusedMultiHeadAttentionOp):
+    def set_conf(self):
+        self.with_bias = False
+        self.out_scale = 0.9
+
+
+class TestFusedMultiHeadAttentionOpLargeLogits(TestFusedMultiHeadAttentionOp):
+    def set_conf(self):
+        # the shifted logits less than -64 are clipped
+        self.alpha = 64.0
+        self.seq_k = 300
+
+
+
+class TestFusedMultiHeadAttentionOpCache(OpTest):
+    def setUp(self):
+        # the query of the step 3 attends to the first 4 positions of the
+        # caches of length 7
+        self.op_type = 'fused_multihead_attention'
+        step = 3
+        batch = [2, 4]
+        q = np.random.uniform(-1, 1, batch + [1, 16]).astype('float32')
+        k = np.random.uniform(-1, 1, batch + [7, 16]).astype('float32')
+        v = np.random.uniform(-1, 1, batch + [7, 8]).astype('float32')
+        bias = np.random.uniform(-1, 1, batch + [1, step + 1]).astype('float32')
+        self.inputs = {
+            'Q': q,
+            'K': k,
+            'V': v,
+            'BiasQK': bias,
+            'Step': np.array([step]).astype('int64')
+        }
+        self.attrs = {'alpha': 0.25}
+        self.outputs = {
+            'Out': attention(q, k[:, :, :step + 1], v[:, :, :step + 1], bias,
+                             0.25, 1.0)
+        }
+
+    def test_check_output(self):
+        self.check_output(atol=1e-5)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,146 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+from test_adam_op import adam_step
+
+SHAPES = [(10, 20), (3, 1), (257, ), (64, 33)]
+
+
+def _named(prefix, values):
+    return [(prefix + str(i), v) for i, v in enumerate(values)]
+
+
+class TestFusedSGDOp(OpTest):
+    def setUp(self):
+        self.op_type = "fused_sgd"
+        params = [np.random.random(s).astype("float32") for s in SHAPES]
+        grads = [np.random.random(s).astype("float32") for s in SHAPES]
+        lr = np.array([0.1]).astype("float32")
+        self.inputs = {
+            'Param': _named('p', params),
+            'Grad': _named('g', grads),
+            'LearningRate': [('lr', lr)]
+        }
+        self.outputs = {
+            'ParamOut':
+            _named('p_out', [p - lr * g for p, g in zip(params, grads)])
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestFusedMomentumOp(OpTest):
+    def setUp(self):
+        self.op_type = "fused_momentum"
+        self.init_attrs()
+        params = [np.random.random(s).astype("float32") for s in SHAPES]
+        grads = [np.random.random(s).astype("float32") for s in SHAPES]
+        velocities = [np.random.random(s).astype("float32") for s in SHAPES]
+        lrs = [
+            np.array([0.001 * (i + 1)]).astype("float32")
+            for i in range(len(SHAPES))
+        ]
+        self.inputs = {
+            'Param': _named('p', params),
+            'Grad': _named('g', grads),
+            'Velocity': _named('v', velocities),
+            'LearningRate': _named('lr', lrs)
+        }
+        param_outs = []
+        velocity_outs = []
+        for p, g, v, lr in zip(params, grads, velocities, lrs):
+            p_out, v_out = self.update(p, g, v, lr)
+            param_outs.append(p_out)
+            velocity_outs.append(v_out)
+        self.outputs = {
+            'ParamOut': _named('p_out', param_outs),
+            'VelocityOut': _named('v_out', velocity_outs)
+        }
+
+    def init_attrs(self):
+        self.attrs = {'mu': 0.9, 'use_nesterov': True}
+
+    def update(self, p, g, v, lr):
+        mu = self.attrs['mu']
+        v_out = mu * v + g
+        p_out = p - (g + v_out * mu) * lr
+        return p_out, v_out
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestFusedLarsMomentumOp(TestFusedMomentumOp):
+    def init_attrs(self):
+        self.attrs = {
+            'mu': 0.0001,
+            'use_lars': True,
+            'lars_coeff': 0.001,
+            'lars_weight_decay': 0.0005
+        }
+
+    def update(self, p, g, v, lr):
+        mu = self.attrs['mu']
+        coeff = self.attrs['lars_coeff']
+        decay = self.attrs['lars_weight_decay']
+        p_norm = np.sqrt(np.square(p).sum())
+        g_norm = np.sqrt(np.square(g).sum())
+        local_lr = lr * coeff * p_norm / (g_norm + decay * p_norm)
+        v_out = mu * v + local_lr * (g + decay * p)
+        return p - v_out, v_out
+
+
+class TestFusedAdamOp(OpTest):
+    def setUp(self):
+        self.op_type = "fused_adam"
+        self.attrs = {'epsilon': 1e-4, 'beta1': 0.78, 'beta2': 0.836}
+        lr = np.array([0.004]).astype("float32")
+        names = ['Param', 'Grad', 'Moment1', 'Moment2', 'Beta1Pow', 'Beta2Pow']
+        inputs = dict((name, []) for name in names)
+        outputs = dict((name, []) for name in ['ParamOut', 'Moment1Out',
+                                               'Moment2Out'])
+        for i, s in enumerate(SHAPES):
+            step = {
+                'Param': np.random.uniform(-1, 1, s).astype("float32"),
+                'Grad': np.random.uniform(-1, 1, s).astype("float32"),
+                'Moment1': np.random.uniform(-1, 1, s).astype("float32"),
+                # The second moment is positive
+                'Moment2': np.random.random(s).astype("float32"),
+                'LearningRate': lr,
+                'Beta1Pow':
+                np.array([self.attrs['beta1']**(i + 1)]).astype("float32"),
+                'Beta2Pow':
+                np.array([self.attrs['beta2']**(i + 1)]).astype("float32")
+            }
+            for name in names:
+                inputs[name].append((name + str(i), step[name]))
+            param_out, moment1_out, moment2_out = adam_step(step, self.attrs)
+            outputs['ParamOut'].append(('ParamOut' + str(i), param_out))
+            outputs['Moment1Out'].append(('Moment1Out' + str(i), moment1_out))
+            outputs['Moment2Out'].append(('Moment2Out' + str(i), moment2_out))
+        inputs['LearningRate'] = [('lr', lr)]
+        self.inputs = inputs
+        self.outputs = outputs
+
+    def test_check_output(self):
+        self.check_output()
+
+
+if __name__ == "__main__":
+    unittest.main()
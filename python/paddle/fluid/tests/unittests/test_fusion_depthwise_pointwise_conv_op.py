@@ -0,0 +1,134 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+def depthwise_conv_naive(x, filter, stride, pad, dilation):
+    n, c, h, w = x.shape
+    m, _, f_h, f_w = filter.shape
+    multiplier = m // c
+    out_h = (h + 2 * pad[0] - (dilation[0] * (f_h - 1) + 1)) // stride[0] + 1
+    out_w = (w + 2 * pad[1] - (dilation[1] * (f_w - 1) + 1)) // stride[1] + 1
+    x_pad = np.pad(x, ((0, ), (0, ), (pad[0], ), (pad[1], )),
+                   mode='constant',
+                   constant_values=0)
+    x_pad = np.repeat(x_pad, multiplier, axis=1)
+    out = np.zeros((n, m, out_h, out_w))
+    for p in range(f_h):
+        for q in range(f_w):
+            h_begin = p * dilation[0]
+            w_begin = q * dilation[1]
+            h_end = h_begin + stride[0] * (out_h - 1) + 1
+            w_end = w_begin + stride[1] * (out_w - 1) + 1
+            x_slice = x_pad[:, :, h_begin:h_end:stride[0], w_begin:w_end:
+                            stride[1]]
+            out += x_slice * filter[:, 0, p, q].reshape([1, m, 1, 1])
+    return out
+
+
+class TestFusionDepthwisePointwiseConvOp(OpTest):
+    def set_conf(self):
+        pass
+
+    def setUp(self):
+        self.op_type = 'fusion_depthwise_pointwise_conv'
+        self.input_size = [2, 8, 9, 9]
+        self.multiplier = 1
+        self.filter_size = 3
+        self.out_channels = 16
+        self.stride = [1, 1]
+        self.pad = [1, 1]
+        self.dilations = [1, 1]
+        self.fuse_relu = True
+        self.with_bias = True
+        self.set_conf()
+
+        n, c, h, w = self.input_size
+        m = c * self.multiplier
+        x = np.random.uniform(-1, 1, self.input_size).astype('float32')
+        dw = np.random.uniform(
+            -1, 1, [m, 1, self.filter_size, self.filter_size]).astype('float32')
+        pw = np.random.uniform(-1, 1,
+                               [self.out_channels, m, 1, 1]).astype('float32')
+        dw_bias = np.random.uniform(-1, 1, [m]).astype('float32')
+        pw_bias = np.random.uniform(-1, 1,
+                                    [self.out_channels]).astype('float32')
+
+        out = depthwise_conv_naive(x, dw, self.stride, self.pad,
+                                   self.dilations)
+        if self.with_bias:
+            out += dw_bias.reshape([1, m, 1, 1])
+        if self.fuse_relu:
+            out = np.maximum(out, 0)
+        out = np.einsum('km,nmhw->nkhw', pw[:, :, 0, 0], out)
+        if self.with_bias:
+            out += pw_bias.reshape([1, self.out_channels, 1, 1])
+
+        self.inputs = {'Input': x, 'DepthwiseFilter': dw, 'PointwiseFilter': pw}
+        if self.with_bias:
+            self.inputs['DepthwiseBias'] = dw_bias
+            self.inputs['PointwiseBias'] = pw_bias
+        self.attrs = {
+            'strides': self.stride,
+            'paddings': self.pad,
+            'dilations': self.dilations,
+            'fuse_relu': self.fuse_relu
+        }
+        self.outputs = {'Output': out.astype('float32')}
+
+    def test_check_output(self):
+        self.check_output(atol=1e-3)
+
+
+class TestFusionDepthwisePointwiseConvStride2(
+        TestFusionDepthwisePointwiseConvOp):
+    def set_conf(self):
+        self.input_size = [1, 16, 15, 14]
+        self.stride = [2, 2]
+        self.out_channels = 8
+
+
+class TestFusionDepthwisePointwiseConvMultiplier(
+        TestFusionDepthwisePointwiseConvOp):
+    def set_conf(self):
+        self.multiplier = 2
+        self.dilations = [2, 2]
+        self.pad = [2, 2]
+        self.fuse_relu = False
+
+
+class TestFusionDepthwisePointwiseConvNoBias(
+        TestFusionDepthwisePointwiseConvOp):
+    def set_conf(self):
+        self.input_size = [3, 4, 20, 20]
+        self.filter_size = 5
+        self.pad = [2, 2]
+        self.with_bias = False
+
+
+# 256 channels of 34 columns make tiles of 3 rows.
+class TestFusionDepthwisePointwiseConvTiles(
+        TestFusionDepthwisePointwiseConvOp):
+    def set_conf(self):
+        self.input_size = [2, 256, 34, 34]
+        self.out_channels = 32
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,99 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+def sigmoid(x):
+    return 1. / (1. + np.exp(-x))
+
+
+class TestFusionElementwiseChainOp(OpTest):
+    def set_conf(self):
+        # x * 2 + 0.5 + bias(over axis 1), relu, * y, sigmoid
+        self.x_shape = [4, 5, 6]
+        self.functors = [
+            'scale', 'elementwise_add', 'relu', 'elementwise_mul', 'sigmoid'
+        ]
+        self.y_shapes = [[5], [4, 5, 6]]
+        self.axis = [1, -1]
+        self.scale = [2.]
+        self.bias = [0.5]
+
+    def compute(self, x, ys):
+        out = x * self.scale[0] + self.bias[0]
+        out = out + ys[0].reshape([1, 5, 1])
+        out = np.maximum(out, 0)
+        out = out * ys[1]
+        return sigmoid(out)
+
+    def setUp(self):
+        self.op_type = 'fusion_elementwise_chain'
+        self.set_conf()
+        x = np.random.uniform(-1, 1, self.x_shape).astype('float32')
+        ys = [
+            np.random.uniform(0.5, 1, shape).astype('float32')
+            for shape in self.y_shapes
+        ]
+        self.inputs = {'X': x}
+        if ys:
+            self.inputs['Y'] = [('y%d' % i, y) for i, y in enumerate(ys)]
+        self.attrs = {
+            'functor_list': self.functors,
+            'axis': self.axis,
+            'scale': self.scale,
+            'bias': self.bias
+        }
+        self.outputs = {'Out': self.compute(x, ys)}
+
+    def test_check_output(self):
+        self.check_output(atol=1e-5)
+
+
+class TestFusionElementwiseChainOpUnary(TestFusionElementwiseChainOp):
+    def set_conf(self):
+        self.x_shape = [3, 1000]
+        self.functors = ['abs', 'sqrt', 'exp', 'tanh', 'square']
+        self.y_shapes = []
+        self.axis = []
+        self.scale = []
+        self.bias = []
+
+    def compute(self, x, ys):
+        return np.square(np.tanh(np.exp(np.sqrt(np.abs(x)))))
+
+
+class TestFusionElementwiseChainOpBroadcast(TestFusionElementwiseChainOp):
+    def set_conf(self):
+        self.x_shape = [2, 3, 700]
+        self.functors = [
+            'elementwise_sub', 'elementwise_max', 'elementwise_div'
+        ]
+        self.y_shapes = [[700], [2, 3], [3, 1]]
+        self.axis = [-1, 0, 1]
+        self.scale = []
+        self.bias = []
+
+    def compute(self, x, ys):
+        out = x - ys[0].reshape([1, 1, 700])
+        out = np.maximum(out, ys[1].reshape([2, 3, 1]))
+        return out / ys[2].reshape([1, 3, 1])
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,78 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+def seqpool(x, lod, pooltype):
+    out = np.zeros((len(lod[0]), x.shape[1])).astype(x.dtype)
+    offset = 0
+    for i, length in enumerate(lod[0]):
+        sub_x = x[offset:offset + length, :]
+        offset += length
+        if length == 0:
+            continue
+        if pooltype == 'SUM':
+            out[i] = np.sum(sub_x, axis=0)
+        elif pooltype == 'AVERAGE':
+            out[i] = np.mean(sub_x, axis=0)
+        elif pooltype == 'SQRT':
+            out[i] = np.sum(sub_x, axis=0) / np.sqrt(length)
+    return out
+
+
+class TestFusionSeqPoolConcatOp(OpTest):
+    def set_conf(self):
+        pass
+
+    def setUp(self):
+        self.op_type = 'fusion_seqpool_concat'
+        self.lods = [[[1, 2, 3, 4]], [[2, 0, 1, 5]], [[3, 3, 1, 1]]]
+        self.widths = [8, 3, 16]
+        self.pooltype = 'SUM'
+        self.set_conf()
+
+        xs = []
+        outs = []
+        for i, (lod, w) in enumerate(zip(self.lods, self.widths)):
+            x = np.random.uniform(-1, 1, (sum(lod[0]), w)).astype('float32')
+            xs.append(('x%d' % i, (x, lod)))
+            outs.append(seqpool(x, lod, self.pooltype))
+        self.inputs = {'X': xs}
+        self.attrs = {'pooltype': self.pooltype, 'axis': 1}
+        self.outputs = {'Out': np.concatenate(outs, axis=1)}
+
+    def test_check_output(self):
+        self.check_output(atol=1e-5)
+
+
+class TestFusionSeqPoolConcatOpAverage(TestFusionSeqPoolConcatOp):
+    def set_conf(self):
+        self.pooltype = 'AVERAGE'
+        # one sequence of each slot is empty
+        self.lods = [[[1, 0, 3]], [[2, 0, 1]]]
+        self.widths = [5, 7]
+
+
+class TestFusionSeqPoolConcatOpSqrt(TestFusionSeqPoolConcatOp):
+    def set_conf(self):
+        self.pooltype = 'SQRT'
+
+
+if __name__ == '__main__':
+    unittest.main()
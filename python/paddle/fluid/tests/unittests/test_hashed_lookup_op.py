@@ -0,0 +1,116 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+MASK = (1 << 64) - 1
+PRIME1 = 11400714785074694791
+PRIME2 = 14029467366897019727
+PRIME3 = 1609587929392839161
+PRIME4 = 9650029242287828579
+PRIME5 = 2870177450012600261
+
+
+def rotl(x, r):
+    return ((x << r) | (x >> (64 - r))) & MASK
+
+
+def xxh64_int64(value, seed):
+    """XXH64 of the 8 bytes of an int64 in little endian."""
+    h = (seed + PRIME5 + 8) & MASK
+    k = rotl((value & MASK) * PRIME2 & MASK, 31) * PRIME1 & MASK
+    h ^= k
+    h = (rotl(h, 27) * PRIME1 + PRIME4) & MASK
+    h ^= h >> 33
+    h = h * PRIME2 & MASK
+    h ^= h >> 29
+    h = h * PRIME3 & MASK
+    h ^= h >> 32
+    return h
+
+
+def hashed_lookup(table, ids, lod, num_hash, pooltype):
+    rows = table.shape[0]
+    emb = np.zeros((len(ids), table.shape[1])).astype(table.dtype)
+    for i, id in enumerate(ids):
+        for k in range(num_hash):
+            emb[i] += table[xxh64_int64(int(id), k) % rows]
+    if pooltype == "NONE":
+        return emb
+    out = np.zeros((len(lod[0]), table.shape[1])).astype(table.dtype)
+    offset = 0
+    for s, length in enumerate(lod[0]):
+        if length > 0:
+            out[s] = emb[offset:offset + length].sum(axis=0)
+            if pooltype == "AVERAGE":
+                out[s] /= length
+            elif pooltype == "SQRT":
+                out[s] /= np.sqrt(length)
+        offset += length
+    return out
+
+
+class TestHashedLookupOp(OpTest):
+    def set_attrs(self):
+        self.num_hash = 2
+        self.pooltype = "SUM"
+
+    def setUp(self):
+        self.op_type = "hashed_lookup"
+        self.set_attrs()
+        table = np.random.random((13, 7)).astype("float64")
+        self.lod = [[3, 0, 5, 2]]
+        # The raw feature hashes, including the negative ones.
+        ids = np.random.randint(-2**62, 2**62, (10, 1)).astype("int64")
+        ids[4] = ids[2]
+        self.inputs = {'W': table, 'Ids': (ids, self.lod)}
+        self.attrs = {'num_hash': self.num_hash, 'pooltype': self.pooltype}
+        out = hashed_lookup(table, ids.flatten(), self.lod, self.num_hash,
+                            self.pooltype)
+        if self.pooltype == "NONE":
+            self.outputs = {'Out': (out, self.lod)}
+        else:
+            self.outputs = {'Out': out}
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad(self):
+        self.check_grad(['W'], 'Out', no_grad_set=set('Ids'))
+
+
+class TestHashedLookupOpAverage(TestHashedLookupOp):
+    def set_attrs(self):
+        self.num_hash = 3
+        self.pooltype = "AVERAGE"
+
+
+class TestHashedLookupOpSqrt(TestHashedLookupOp):
+    def set_attrs(self):
+        self.num_hash = 1
+        self.pooltype = "SQRT"
+
+
+class TestHashedLookupOpNoPool(TestHashedLookupOp):
+    def set_attrs(self):
+        self.num_hash = 2
+        self.pooltype = "NONE"
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -18,6 +18,8 @@ import unittest
 import numpy as np
 import math
 from op_test import OpTest
+import paddle.fluid as fluid
+import paddle.fluid.core as core
 
 np.random.seed(100)
 
@@ -99,5 +101,42 @@ class TestHSigmoidOp(OpTest):
         self.check_grad(['Bias', 'X', 'W'], ['Out'], no_grad_set=set('Label'))
 
 
+class TestHSigmoidSparse(unittest.TestCase):
+    def train(self, place, is_sparse, feed):
+        main = fluid.Program()
+        startup = fluid.Program()
+        startup.random_seed = 1
+        scope = fluid.Scope()
+        with fluid.program_guard(main, startup), fluid.scope_guard(scope):
+            x = fluid.layers.data(name='x', shape=[8], dtype='float32')
+            y = fluid.layers.data(name='y', shape=[1], dtype='int64')
+            cost = fluid.layers.hsigmoid(
+                input=x,
+                label=y,
+                num_classes=6,
+                param_attr='hsigmoid.w',
+                bias_attr='hsigmoid.b',
+                is_sparse=is_sparse)
+            fluid.optimizer.SGD(learning_rate=0.1).minimize(
+                fluid.layers.mean(cost))
+            exe = fluid.Executor(place)
+            exe.run(startup)
+            exe.run(main, feed=feed)
+            return np.array(scope.find_var('hsigmoid.w').get_tensor())
+
+    def test_sparse_grad(self):
+        feed = {
+            'x': np.random.random((4, 8)).astype('float32'),
+            'y': np.random.randint(0, 6, (4, 1)).astype('int64')
+        }
+        places = [fluid.CPUPlace()]
+        if core.is_compiled_with_cuda():
+            places.append(fluid.CUDAPlace(0))
+        for place in places:
+            dense = self.train(place, False, feed)
+            sparse = self.train(place, True, feed)
+            self.assertTrue(np.allclose(dense, sparse, atol=1e-6))
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,72 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+class TestKVCacheAppendOp(OpTest):
+    def set_conf(self):
+        self.rows = 1
+        self.step = 3
+
+    def setUp(self):
+        self.op_type = 'kv_cache_append'
+        self.set_conf()
+        batch = [6, 4]
+        cache = np.random.uniform(-1, 1, batch + [8, 16]).astype('float32')
+        x = np.random.uniform(-1, 1,
+                              batch + [self.rows, 16]).astype('float32')
+        out = np.copy(cache)
+        out[:, :, self.step:self.step + self.rows, :] = x
+        self.inputs = {
+            'Cache': cache,
+            'X': x,
+            'Step': np.array([self.step]).astype('int64')
+        }
+        self.outputs = {'CacheOut': out}
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestKVCacheAppendOpRows(TestKVCacheAppendOp):
+    def set_conf(self):
+        # append the positions of the source at the first step
+        self.rows = 5
+        self.step = 0
+
+
+class TestKVCacheReorderOp(OpTest):
+    def setUp(self):
+        self.op_type = 'kv_cache_reorder'
+        cache = np.random.uniform(-1, 1, [4, 2, 8, 16]).astype('float32')
+        # 2 sources with 2 prefixes each, the prefix 1 is pruned and the
+        # prefix 2 is extended twice.
+        ids = np.random.randint(0, 10, [4, 1]).astype('int64')
+        self.inputs = {
+            'Cache': cache,
+            'SelectedIds': (ids, [[2, 2], [1, 0, 2, 1]])
+        }
+        self.outputs = {'CacheOut': cache[[0, 2, 2, 3]]}
+
+    def test_check_output(self):
+        self.check_output()
+
+
+if __name__ == '__main__':
+    unittest.main()
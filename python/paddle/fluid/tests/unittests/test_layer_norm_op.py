@@ -170,6 +170,12 @@ class TestLayerNormdOp(unittest.TestCase):
         self.check_forward_backward(shape=[2, 3, 4, 5], begin_norm_axis=1)
         self.check_forward_backward(shape=[2, 3, 4, 5], begin_norm_axis=3)
 
+    def test_check_forward_backward_with_long_rows(self):
+        # A warp normalizes up to 4096 elements a row on CUDA, a block the
+        # longer rows.
+        self.check_forward_backward(shape=[3, 4096], begin_norm_axis=1)
+        self.check_forward_backward(shape=[2, 5, 1000], begin_norm_axis=1)
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -83,6 +83,43 @@ class TestLookupTableOpWithTensorIdsAndPadding(TestLookupTableOpWithTensorIds):
         pass
 
 
+class TestLookupTableQuantizedFloat16(OpTest):
+    def setUp(self):
+        self.op_type = "lookup_table"
+        table = np.random.random((17, 31)).astype("float16")
+        ids = np.random.randint(0, 17, 4).astype("int64")
+        # numpy float16 is binded to fluid float16 via uint16
+        self.inputs = {
+            'W': table.view(np.uint16),
+            'Ids': np.expand_dims(ids, axis=1)
+        }
+        self.attrs = {'table_format': 'float16', 'padding_idx': int(ids[0])}
+        out = table[ids].astype("float32")
+        out[ids == ids[0]] = 0
+        self.outputs = {'Out': out}
+
+    def test_check_output(self):
+        # The quantized tables are only looked up on CPU.
+        self.check_output_with_place(core.CPUPlace(), atol=1e-5)
+
+
+class TestLookupTableQuantizedInt8Rowwise(OpTest):
+    def setUp(self):
+        self.op_type = "lookup_table"
+        codes = np.random.randint(0, 256, (17, 31)).astype("uint8")
+        scale_bias = np.random.random((17, 2)).astype("float32")
+        table = np.concatenate(
+            [codes, scale_bias.view("uint8").reshape((17, 8))], axis=1)
+        ids = np.random.randint(0, 17, 4).astype("int64")
+        self.inputs = {'W': table, 'Ids': np.expand_dims(ids, axis=1)}
+        self.attrs = {'table_format': 'int8_rowwise'}
+        out = codes[ids] * scale_bias[ids, 0:1] + scale_bias[ids, 1:2]
+        self.outputs = {'Out': out.astype("float32")}
+
+    def test_check_output(self):
+        self.check_output_with_place(core.CPUPlace(), atol=1e-5)
+
+
 class TestLookupTableWIsSelectedRows(OpTest):
     def prepare_ids(self, scope, place):
         ids_tensor = scope.var('Ids').get_tensor()
@@ -138,6 +138,7 @@ class TestLstmOp(OpTest):
         self.has_initial_state = False
         self.is_reverse = False
         self.use_peepholes = True
+        self.use_persistent_kernel = False
 
     def setUp(self):
         self.set_argument()
@@ -182,7 +183,8 @@ class TestLstmOp(OpTest):
             'is_reverse': self.is_reverse,
             'gate_activation': self.act_gate,
             'cell_activation': self.act_cell,
-            'candidate_activation': self.act_cand
+            'candidate_activation': self.act_cand,
+            'use_persistent_kernel': self.use_persistent_kernel
         }
 
     def test_check_output(self):
@@ -198,6 +200,13 @@ class TestLstmOp(OpTest):
             ['Input', 'Weight', 'Bias'], ['Hidden'], max_relative_error=5e-4)
 
 
+class TestLstmOpPersistentKernel(TestLstmOp):
+    def set_argument(self):
+        TestLstmOp.set_argument(self)
+        self.lod = [[2, 30, 1, 3]]
+        self.use_persistent_kernel = True
+
+
 # class TestLstmOpHasInitial(TestLstmOp):
 #     def set_argument(self):
 #         self.lod = [[2, 3, 2]]
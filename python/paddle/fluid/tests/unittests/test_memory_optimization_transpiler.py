@@ -68,6 +68,30 @@ class TestMemoryTranspiler2(unittest.TestCase):
         print(str(result_program))
 
 
+class TestMemoryTranspilerView(unittest.TestCase):
+    def setUp(self):
+        program = Program()
+        with program_guard(program, startup_program=Program()):
+            x = layers.data(name='x', shape=[10], dtype='float32')
+            a = layers.scale(x, scale=2.0)
+            # view shares the memory of a, which is dead after reshape in the
+            # program but not in the memory.
+            view = layers.reshape(x=a, shape=[-1, 10])
+            b = layers.scale(x, scale=3.0)
+            layers.elementwise_add(view, b)
+        self.program = program
+        self.a = a.name
+        self.view = view.name
+
+    def test_view(self):
+        memory_optimize(self.program)
+        for op in self.program.global_block().ops:
+            if op.type == 'reshape2':
+                continue
+            for name in op.output_arg_names:
+                self.assertNotIn(name, [self.a, self.view])
+
+
 class TestMemoryTranspiler3(unittest.TestCase):
     def setUp(self):
         program = Program()
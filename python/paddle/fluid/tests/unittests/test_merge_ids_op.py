@@ -49,5 +49,13 @@ class TestMergeIdsOp(OpTest):
         self.check_output()
 
 
+class TestMergeIdsOpWithIndex(TestMergeIdsOp):
+    def setUp(self):
+        TestMergeIdsOp.setUp(self)
+        # the rows of the ids in the concatenated X
+        self.inputs['Index'] = np.array(
+            [[0], [1], [3], [4], [0], [1], [1], [2]]).astype('int64')
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -75,6 +75,39 @@ class TestMulOp2(OpTest):
             ['X'], 'Out', max_relative_error=0.5, no_grad_set=set('Y'))
 
 
+def fake_quant_dequant(x, bits):
+    scale = np.abs(x).max()
+    bin_cnt = (1 << (bits - 1)) - 1
+    return np.round(x * bin_cnt / scale) * scale / bin_cnt
+
+
+class TestFakeQuantMulOp(OpTest):
+    def setUp(self):
+        self.op_type = "mul"
+        x = np.random.random((4, 6)).astype("float32") - 0.5
+        y = np.random.random((6, 3)).astype("float32") - 0.5
+        self.inputs = {'X': x, 'Y': y}
+        self.attrs = {'x_quant_bits': 8, 'y_quant_bits': 4}
+        self.x_quant = fake_quant_dequant(x, 8)
+        self.y_quant = fake_quant_dequant(y, 4)
+        self.outputs = {'Out': np.dot(self.x_quant, self.y_quant)}
+
+    def test_check_output(self):
+        self.check_output_with_place(core.CPUPlace(), atol=1e-5)
+
+    def test_check_grad(self):
+        # The gradients are passed straight through the quantization, the
+        # loss is the mean of Out.
+        dout = np.ones((4, 3), dtype="float32") / 12
+        self.check_grad_with_place(
+            core.CPUPlace(), ['X', 'Y'],
+            'Out',
+            max_relative_error=1e-3,
+            user_defined_grads=[
+                np.dot(dout, self.y_quant.T), np.dot(self.x_quant.T, dout)
+            ])
+
+
 class TestFP16MulOp1(OpTest):
     def setUp(self):
         self.op_type = "mul"
@@ -158,6 +158,7 @@ class TestMulticlassNMSOp(OpTest):
         self.score_threshold = 0.01
 
     def setUp(self):
+        self.keep_top_k = 200
         self.set_argument()
         N = 7
         M = 1200
@@ -167,7 +168,7 @@ class TestMulticlassNMSOp(OpTest):
         background = 0
         nms_threshold = 0.3
         nms_top_k = 400
-        keep_top_k = 200
+        keep_top_k = self.keep_top_k
         score_threshold = self.score_threshold
 
         scores = np.random.random((N * M, C)).astype('float32')
@@ -214,6 +215,12 @@ class TestMulticlassNMSOpNoOutput(TestMulticlassNMSOp):
         self.score_threshold = 2.0
 
 
+class TestMulticlassNMSOpKeepAll(TestMulticlassNMSOp):
+    def set_argument(self):
+        self.score_threshold = 0.01
+        self.keep_top_k = -1
+
+
 class TestIOU(unittest.TestCase):
     def test_iou(self):
         box1 = np.array([4.0, 3.0, 7.0, 5.0]).astype('float32')
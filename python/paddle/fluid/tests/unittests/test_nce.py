@@ -17,6 +17,8 @@ from __future__ import print_function
 import unittest
 import numpy as np
 from op_test import OpTest
+import paddle.fluid as fluid
+import paddle.fluid.core as core
 
 
 def nce(input, weight, bias, sample_weight, labels, num_classes,
@@ -110,5 +112,46 @@ class TestNCECase1(TestNCE):
         self.generate_data(10, 20, 10, 2, 5)
 
 
+class TestNCESparse(unittest.TestCase):
+    def train(self, place, is_sparse, feed):
+        main = fluid.Program()
+        startup = fluid.Program()
+        startup.random_seed = 1
+        scope = fluid.Scope()
+        with fluid.program_guard(main, startup), fluid.scope_guard(scope):
+            x = fluid.layers.data(name='x', shape=[8], dtype='float32')
+            y = fluid.layers.data(name='y', shape=[1], dtype='int64')
+            cost = fluid.layers.nce(input=x,
+                                    label=y,
+                                    num_total_classes=20,
+                                    param_attr='nce.w',
+                                    bias_attr='nce.b',
+                                    num_neg_samples=3,
+                                    is_sparse=is_sparse)
+            # make the two runs draw the same negative classes
+            for op in main.global_block().ops:
+                if op.type == 'nce':
+                    op._set_attr('custom_neg_classes', [1, 5, 7])
+            fluid.optimizer.SGD(learning_rate=0.1).minimize(
+                fluid.layers.mean(cost))
+            exe = fluid.Executor(place)
+            exe.run(startup)
+            exe.run(main, feed=feed)
+            return np.array(scope.find_var('nce.w').get_tensor())
+
+    def test_sparse_grad(self):
+        feed = {
+            'x': np.random.randn(4, 8).astype('float32'),
+            'y': np.random.randint(0, 20, (4, 1)).astype('int64')
+        }
+        places = [fluid.CPUPlace()]
+        if core.is_compiled_with_cuda():
+            places.append(fluid.CUDAPlace(0))
+        for place in places:
+            dense = self.train(place, False, feed)
+            sparse = self.train(place, True, feed)
+            self.assertTrue(np.allclose(dense, sparse, atol=1e-6))
+
+
 if __name__ == '__main__':
     unittest.main()
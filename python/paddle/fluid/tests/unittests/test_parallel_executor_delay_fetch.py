@@ -0,0 +1,83 @@
+# Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+from __future__ import print_function
+
+import os
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+def simple_fc_net():
+    img = fluid.layers.data(name='image', shape=[784], dtype='float32')
+    label = fluid.layers.data(name='label', shape=[1], dtype='int64')
+    hidden = fluid.layers.fc(img, size=200, act='tanh')
+    prediction = fluid.layers.fc(hidden, size=10, act='softmax')
+    loss = fluid.layers.cross_entropy(input=prediction, label=label)
+    loss = fluid.layers.mean(loss)
+    return loss
+
+
+class TestDelayFetch(unittest.TestCase):
+    def run_program(self, use_cuda, delay_fetch, feed_dict):
+        os.environ['CPU_NUM'] = str(2)
+        main = fluid.Program()
+        startup = fluid.Program()
+        main.random_seed = 1
+        startup.random_seed = 1
+        scope = fluid.Scope()
+        with fluid.program_guard(main, startup), fluid.scope_guard(scope):
+            loss = simple_fc_net()
+            fluid.optimizer.SGD(learning_rate=0.01).minimize(loss)
+
+            place = fluid.CUDAPlace(0) if use_cuda else fluid.CPUPlace()
+            fluid.Executor(place).run(startup)
+
+            exec_strategy = fluid.ExecutionStrategy()
+            exec_strategy.delay_fetch = delay_fetch
+            train_exe = fluid.ParallelExecutor(
+                use_cuda=use_cuda,
+                loss_name=loss.name,
+                main_program=main,
+                exec_strategy=exec_strategy)
+
+            losses = []
+            for i in range(6):
+                loss_value, = train_exe.run([loss.name], feed=feed_dict)
+                losses.append(loss_value)
+            return losses
+
+    def check_delay_fetch(self, use_cuda):
+        batch_size = 32
+        feed_dict = {
+            'image': np.random.normal(size=(batch_size, 784)).astype('float32'),
+            'label': np.random.randint(
+                0, 10, (batch_size, 1), dtype="int64")
+        }
+        expected = self.run_program(use_cuda, False, feed_dict)
+        actual = self.run_program(use_cuda, True, feed_dict)
+        # Each run returns the loss of the last one.
+        self.assertIsNone(actual[0])
+        for i in range(1, len(actual)):
+            self.assertTrue(np.allclose(expected[i - 1], actual[i]))
+
+    def test_delay_fetch(self):
+        if core.is_compiled_with_cuda():
+            self.check_delay_fetch(use_cuda=True)
+        self.check_delay_fetch(use_cuda=False)
+
+
+if __name__ == '__main__':
+    unittest.main()
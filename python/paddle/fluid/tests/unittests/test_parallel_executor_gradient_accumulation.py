@@ -0,0 +1,95 @@
+# Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+from __future__ import print_function
+
+import os
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+def simple_fc_net():
+    img = fluid.layers.data(name='image', shape=[784], dtype='float32')
+    label = fluid.layers.data(name='label', shape=[1], dtype='int64')
+    hidden = fluid.layers.fc(
+        img,
+        size=200,
+        act='tanh',
+        param_attr=fluid.ParamAttr(name='fc_0.w'),
+        bias_attr=fluid.ParamAttr(name='fc_0.b'))
+    prediction = fluid.layers.fc(hidden, size=10, act='softmax')
+    loss = fluid.layers.cross_entropy(input=prediction, label=label)
+    loss = fluid.layers.mean(loss)
+    return loss
+
+
+class TestGradientAccumulation(unittest.TestCase):
+    def train(self, use_cuda, num_accumulation_steps, feeds):
+        os.environ['CPU_NUM'] = str(1)
+        main = fluid.Program()
+        startup = fluid.Program()
+        startup.random_seed = 1
+        scope = fluid.Scope()
+        with fluid.program_guard(main, startup), fluid.scope_guard(scope):
+            loss = simple_fc_net()
+            fluid.optimizer.SGD(learning_rate=0.1).minimize(loss)
+
+            place = fluid.CUDAPlace(0) if use_cuda else fluid.CPUPlace()
+            fluid.Executor(place).run(startup)
+
+            build_strategy = fluid.BuildStrategy()
+            build_strategy.num_accumulation_steps = num_accumulation_steps
+            train_exe = fluid.ParallelExecutor(
+                use_cuda=use_cuda,
+                loss_name=loss.name,
+                main_program=main,
+                build_strategy=build_strategy)
+            for feed in feeds:
+                train_exe.run([], feed=feed)
+            return np.array(scope.find_var('fc_0.w').get_tensor())
+
+    def check_accumulation(self, use_cuda):
+        num_steps = 4
+        batch_size = 8
+        image = np.random.normal(
+            size=(num_steps * batch_size, 784)).astype('float32')
+        label = np.random.randint(
+            0, 10, (num_steps * batch_size, 1), dtype="int64")
+        micro_batches = [{
+            'image': image[i * batch_size:(i + 1) * batch_size],
+            'label': label[i * batch_size:(i + 1) * batch_size]
+        } for i in range(num_steps)]
+
+        # the first num_steps - 1 runs do not update the parameters
+        expected = self.train(use_cuda, 1, [])
+        actual = self.train(use_cuda, num_steps, micro_batches[:-1])
+        self.assertTrue(np.allclose(expected, actual))
+
+        expected = self.train(use_cuda, 1,
+                              [{
+                                  'image': image,
+                                  'label': label
+                              }])
+        actual = self.train(use_cuda, num_steps, micro_batches)
+        self.assertTrue(np.allclose(expected, actual, atol=1e-5))
+
+    def test_gradient_accumulation(self):
+        if core.is_compiled_with_cuda():
+            self.check_accumulation(use_cuda=True)
+        self.check_accumulation(use_cuda=False)
+
+
+if __name__ == '__main__':
+    unittest.main()
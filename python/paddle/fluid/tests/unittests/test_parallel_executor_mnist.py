@@ -136,6 +136,20 @@ class TestMNIST(TestParallelExecutorBase):
         for loss in zip(all_reduce_last_loss, reduce_last_loss):
             self.assertAlmostEqual(loss[0], loss[1], delta=1e-4)
 
+        # the deferred broadcasts give the next iteration the same parameters
+        overlap_first_loss, overlap_last_loss = self.check_network_convergence(
+            model,
+            feed_dict={"image": img,
+                       "label": label},
+            use_cuda=use_cuda,
+            use_reduce=True,
+            overlap_broadcast=True)
+
+        for loss in zip(reduce_first_loss, overlap_first_loss):
+            self.assertAlmostEqual(loss[0], loss[1], delta=1e-6)
+        for loss in zip(reduce_last_loss, overlap_last_loss):
+            self.assertAlmostEqual(loss[0], loss[1], delta=1e-6)
+
     # simple_fc
     def check_simple_fc_convergence(self, use_cuda, use_reduce=False):
         if use_cuda and not core.is_compiled_with_cuda():
@@ -195,6 +209,35 @@ class TestMNIST(TestParallelExecutorBase):
         self.check_simple_fc_parallel_accuracy(True)
         self.check_simple_fc_parallel_accuracy(False)
 
+    def check_simple_fc_fuse_all_reduce(self, use_cuda):
+        if use_cuda and not core.is_compiled_with_cuda():
+            return
+
+        img, label = self._init_data()
+
+        first_loss, last_loss = self.check_network_convergence(
+            method=simple_fc_net,
+            seed=1,
+            feed_dict={"image": img,
+                       "label": label},
+            use_cuda=use_cuda)
+        fused_first_loss, fused_last_loss = self.check_network_convergence(
+            method=simple_fc_net,
+            seed=1,
+            feed_dict={"image": img,
+                       "label": label},
+            use_cuda=use_cuda,
+            fuse_all_reduce_ops=True)
+
+        for loss in zip(first_loss, fused_first_loss):
+            self.assertAlmostEquals(loss[0], loss[1], delta=1e-6)
+        for loss in zip(last_loss, fused_last_loss):
+            self.assertAlmostEquals(loss[0], loss[1], delta=1e-4)
+
+    def test_simple_fc_fuse_all_reduce(self):
+        self.check_simple_fc_fuse_all_reduce(True)
+        self.check_simple_fc_fuse_all_reduce(False)
+
     def check_batchnorm_fc_convergence(self, use_cuda, use_fast_executor):
         if use_cuda and not core.is_compiled_with_cuda():
             return
@@ -215,6 +258,31 @@ class TestMNIST(TestParallelExecutorBase):
             for use_fast_executor in (False, True):
                 self.check_batchnorm_fc_convergence(use_cuda, use_fast_executor)
 
+    def test_batchnorm_fc_with_priority_scheduling(self):
+        img, label = self._init_data()
+        for use_cuda in (False, True):
+            if use_cuda and not core.is_compiled_with_cuda():
+                continue
+            self.check_network_convergence(
+                fc_with_batchnorm,
+                feed_dict={"image": img,
+                           "label": label},
+                use_cuda=use_cuda,
+                use_fast_executor=True,
+                use_priority_scheduling=True)
+
+    def test_batchnorm_fc_with_work_stealing_executor(self):
+        img, label = self._init_data()
+        for use_cuda in (False, True):
+            if use_cuda and not core.is_compiled_with_cuda():
+                continue
+            self.check_network_convergence(
+                fc_with_batchnorm,
+                feed_dict={"image": img,
+                           "label": label},
+                use_cuda=use_cuda,
+                use_work_stealing_executor=True)
+
     def test_batchnorm_fc_with_new_strategy(self):
         # FIXME(zcd): close this test temporally.
         # self._compare_reduce_and_allreduce(fc_with_batchnorm, True)
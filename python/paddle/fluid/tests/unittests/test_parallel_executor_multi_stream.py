@@ -0,0 +1,86 @@
+# Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+from __future__ import print_function
+
+import os
+# Multiple streams need the stream-ordered allocator.
+os.environ['FLAGS_use_stream_ordered_allocator'] = 'true'
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+def branchy_fc_net():
+    img = fluid.layers.data(name='image', shape=[784], dtype='float32')
+    label = fluid.layers.data(name='label', shape=[1], dtype='int64')
+    # The independent towers may run on different streams.
+    towers = []
+    for i in range(4):
+        hidden = fluid.layers.fc(img, size=64, act='tanh')
+        towers.append(fluid.layers.fc(hidden, size=32, act='relu'))
+    hidden = fluid.layers.concat(towers, axis=1)
+    prediction = fluid.layers.fc(hidden, size=10, act='softmax')
+    loss = fluid.layers.cross_entropy(input=prediction, label=label)
+    loss = fluid.layers.mean(loss)
+    return loss
+
+
+class TestMultiStream(unittest.TestCase):
+    def run_program(self, num_compute_streams, feed_dict):
+        main = fluid.Program()
+        startup = fluid.Program()
+        main.random_seed = 1
+        startup.random_seed = 1
+        scope = fluid.Scope()
+        with fluid.program_guard(main, startup), fluid.scope_guard(scope):
+            loss = branchy_fc_net()
+            fluid.optimizer.SGD(learning_rate=0.01).minimize(loss)
+
+            place = fluid.CUDAPlace(0)
+            fluid.Executor(place).run(startup)
+
+            build_strategy = fluid.BuildStrategy()
+            build_strategy.num_compute_streams = num_compute_streams
+            train_exe = fluid.ParallelExecutor(
+                use_cuda=True,
+                loss_name=loss.name,
+                main_program=main,
+                build_strategy=build_strategy)
+
+            losses = []
+            for i in range(6):
+                fetch_list = [loss.name] if i % 2 == 1 else []
+                ret = train_exe.run(fetch_list, feed=feed_dict)
+                if fetch_list:
+                    losses.append(np.array(ret[0]).mean())
+            return losses
+
+    def test_multi_stream(self):
+        if not core.is_compiled_with_cuda():
+            return
+        batch_size = 32
+        feed_dict = {
+            'image': np.random.normal(size=(batch_size, 784)).astype('float32'),
+            'label': np.random.randint(
+                0, 10, (batch_size, 1), dtype="int64")
+        }
+        expected = self.run_program(1, feed_dict)
+        actual = self.run_program(4, feed_dict)
+        self.assertTrue(np.allclose(expected, actual))
+
+
+if __name__ == '__main__':
+    unittest.main()
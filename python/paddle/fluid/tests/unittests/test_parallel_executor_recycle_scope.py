@@ -0,0 +1,85 @@
+# Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+from __future__ import print_function
+
+import os
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+def simple_fc_net():
+    img = fluid.layers.data(name='image', shape=[784], dtype='float32')
+    label = fluid.layers.data(name='label', shape=[1], dtype='int64')
+    hidden = fluid.layers.fc(img, size=200, act='tanh')
+    prediction = fluid.layers.fc(hidden, size=10, act='softmax')
+    loss = fluid.layers.cross_entropy(input=prediction, label=label)
+    loss = fluid.layers.mean(loss)
+    return loss
+
+
+class TestRecycleLocalScopes(unittest.TestCase):
+    def run_program(self, use_cuda, recycle_local_scopes, feed_dict):
+        os.environ['CPU_NUM'] = str(2)
+        main = fluid.Program()
+        startup = fluid.Program()
+        main.random_seed = 1
+        startup.random_seed = 1
+        scope = fluid.Scope()
+        with fluid.program_guard(main, startup), fluid.scope_guard(scope):
+            loss = simple_fc_net()
+            fluid.optimizer.SGD(learning_rate=0.01).minimize(loss)
+
+            place = fluid.CUDAPlace(0) if use_cuda else fluid.CPUPlace()
+            fluid.Executor(place).run(startup)
+
+            exec_strategy = fluid.ExecutionStrategy()
+            exec_strategy.num_iteration_per_drop_scope = 2
+            exec_strategy.recycle_local_scopes = recycle_local_scopes
+            train_exe = fluid.ParallelExecutor(
+                use_cuda=use_cuda,
+                loss_name=loss.name,
+                main_program=main,
+                exec_strategy=exec_strategy)
+
+            losses = []
+            for i in range(9):
+                # The scopes are released every 2 iterations without fetching,
+                # and after each fetch.
+                fetch_list = [loss.name] if i % 3 == 2 else []
+                ret = train_exe.run(fetch_list, feed=feed_dict)
+                if fetch_list:
+                    losses.append(np.array(ret[0]).mean())
+            return losses
+
+    def check_recycle(self, use_cuda):
+        batch_size = 32
+        feed_dict = {
+            'image': np.random.normal(size=(batch_size, 784)).astype('float32'),
+            'label': np.random.randint(
+                0, 10, (batch_size, 1), dtype="int64")
+        }
+        expected = self.run_program(use_cuda, False, feed_dict)
+        actual = self.run_program(use_cuda, True, feed_dict)
+        self.assertTrue(np.allclose(expected, actual))
+
+    def test_recycle_local_scopes(self):
+        if core.is_compiled_with_cuda():
+            self.check_recycle(use_cuda=True)
+        self.check_recycle(use_cuda=False)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,88 @@
+# Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+def simple_fc_net():
+    img = fluid.layers.data(name='image', shape=[784], dtype='float32')
+    label = fluid.layers.data(name='label', shape=[1], dtype='int64')
+    with fluid.pipeline_stage(0):
+        hidden = fluid.layers.fc(img, size=200, act='tanh')
+    with fluid.pipeline_stage(1):
+        prediction = fluid.layers.fc(hidden, size=10, act='softmax')
+        loss = fluid.layers.cross_entropy(input=prediction, label=label)
+        loss = fluid.layers.mean(loss)
+    return loss
+
+
+class TestPipelineExecutor(unittest.TestCase):
+    def train(self, places, num_micro_batches, feeds):
+        main = fluid.Program()
+        startup = fluid.Program()
+        startup.random_seed = 1
+        scope = fluid.Scope()
+        with fluid.program_guard(main, startup), fluid.scope_guard(scope):
+            # The executor ignores the stages.
+            loss = simple_fc_net()
+            fluid.optimizer.Momentum(
+                learning_rate=0.1, momentum=0.9).minimize(loss)
+
+            place = places[0] if places else fluid.CPUPlace()
+            exe = fluid.Executor(place)
+            exe.run(startup)
+            if places is None:
+                return [
+                    exe.run(main, feed=feed, fetch_list=[loss.name])[0]
+                    for feed in feeds
+                ]
+            pipe_exe = fluid.PipelineExecutor(
+                places=places,
+                num_micro_batches=num_micro_batches,
+                main_program=main)
+            losses = []
+            for feed in feeds:
+                micro_batch_losses, = pipe_exe.run([loss.name], feed=feed)
+                self.assertEqual(micro_batch_losses.shape[0],
+                                 num_micro_batches)
+                losses.append(np.mean(micro_batch_losses))
+            return losses
+
+    def check_pipeline(self, places):
+        num_micro_batches = 4
+        batch_size = 32
+        feeds = [{
+            'image': np.random.normal(size=(batch_size, 784)).astype('float32'),
+            'label': np.random.randint(
+                0, 10, (batch_size, 1), dtype="int64")
+        } for _ in range(3)]
+        expected = self.train(None, 1, feeds)
+        actual = self.train(places, num_micro_batches, feeds)
+        for e, a in zip(expected, actual):
+            self.assertTrue(np.allclose(e, a, atol=1e-5))
+
+    def test_pipeline_cpu(self):
+        self.check_pipeline([fluid.CPUPlace(), fluid.CPUPlace()])
+
+    def test_pipeline_cuda(self):
+        if core.is_compiled_with_cuda() and core.get_cuda_device_count() > 1:
+            self.check_pipeline([fluid.CUDAPlace(0), fluid.CUDAPlace(1)])
+
+
+if __name__ == '__main__':
+    unittest.main()
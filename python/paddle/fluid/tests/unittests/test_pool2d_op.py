@@ -341,5 +341,29 @@ class TestCUDNNAvgInclude(TestCUDNNCase3):
         self.exclusive = False
 
 
+@unittest.skipIf(not core.is_compiled_with_cuda(),
+                 "core is not compiled with CUDA")
+class TestCUDNNNHWC(TestCUDNNCase2):
+    def setUp(self):
+        super(TestCUDNNNHWC, self).setUp()
+        self.attrs['data_format'] = "NHWC"
+        self.inputs['X'] = np.ascontiguousarray(
+            np.transpose(self.inputs['X'], (0, 2, 3, 1)))
+        self.outputs['Out'] = np.ascontiguousarray(
+            np.transpose(self.outputs['Out'], (0, 2, 3, 1)))
+
+
+@unittest.skipIf(not core.is_compiled_with_cuda(),
+                 "core is not compiled with CUDA")
+class TestCUDNNNHWCMax(TestCUDNNCase4):
+    def setUp(self):
+        super(TestCUDNNNHWCMax, self).setUp()
+        self.attrs['data_format'] = "NHWC"
+        self.inputs['X'] = np.ascontiguousarray(
+            np.transpose(self.inputs['X'], (0, 2, 3, 1)))
+        self.outputs['Out'] = np.ascontiguousarray(
+            np.transpose(self.outputs['Out'], (0, 2, 3, 1)))
+
+
 if __name__ == '__main__':
     unittest.main()
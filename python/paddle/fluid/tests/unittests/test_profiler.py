@@ -93,6 +93,68 @@ class TestProfiler(unittest.TestCase):
         with open('/tmp/profile_out', 'rb') as f:
             self.assertGreater(len(f.read()), 0)
 
+    def test_sampling_profiler(self):
+        startup_program = fluid.Program()
+        main_program = fluid.Program()
+        with fluid.program_guard(main_program, startup_program):
+            image = fluid.layers.data(name='x', shape=[784], dtype='float32')
+            hidden = fluid.layers.fc(input=image, size=64, act='relu')
+            avg = fluid.layers.mean(hidden)
+
+        exe = fluid.Executor(fluid.CPUPlace())
+        exe.run(startup_program)
+        profiler.stop_sampling_profiler(reset=True)
+        profiler.start_sampling_profiler(5)
+        for iter in range(10):
+            x = np.random.random((32, 784)).astype("float32")
+            exe.run(main_program, feed={'x': x}, fetch_list=[avg])
+        profiler.stop_sampling_profiler()
+        report = profiler.sampling_profiler_report()
+        self.assertIn('Sampled iterations: 2,', report)
+        self.assertIn('mul', report)
+        self.assertIn('relu', report)
+
+    def test_memory_profiler(self):
+        startup_program = fluid.Program()
+        main_program = fluid.Program()
+        with fluid.program_guard(main_program, startup_program):
+            image = fluid.layers.data(name='x', shape=[784], dtype='float32')
+            hidden = fluid.layers.fc(input=image, size=64, act='relu')
+            avg = fluid.layers.mean(hidden)
+
+        exe = fluid.Executor(fluid.CPUPlace())
+        exe.run(startup_program)
+        profiler.start_memory_profiler()
+        for iter in range(2):
+            x = np.random.random((32, 784)).astype("float32")
+            exe.run(main_program, feed={'x': x}, fetch_list=[avg])
+        profiler.stop_memory_profiler()
+        report = profiler.memory_profiler_report()
+        self.assertIn('Place: CPUPlace', report)
+        self.assertIn('Peak:', report)
+        self.assertIn('mul', report)
+        self.assertIn(hidden.name, report)
+
+    def test_op_phase_profiler(self):
+        startup_program = fluid.Program()
+        main_program = fluid.Program()
+        with fluid.program_guard(main_program, startup_program):
+            image = fluid.layers.data(name='x', shape=[784], dtype='float32')
+            hidden = fluid.layers.fc(input=image, size=64, act='relu')
+            avg = fluid.layers.mean(hidden)
+
+        exe = fluid.Executor(fluid.CPUPlace())
+        exe.run(startup_program)
+        profiler.start_op_phase_profiler()
+        for iter in range(2):
+            x = np.random.random((32, 784)).astype("float32")
+            exe.run(main_program, feed={'x': x}, fetch_list=[avg])
+        profiler.stop_op_phase_profiler()
+        report = profiler.op_phase_profiler_report()
+        self.assertIn('InferShape', report)
+        self.assertIn('mul', report)
+        self.assertIn('relu', report)
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,79 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import sys
+import unittest
+import paddle.fluid as fluid
+import numpy as np
+
+
+def batch_provider(worker_id, batch_num):
+    def __provider__():
+        for i in range(batch_num):
+            label = worker_id * batch_num + i
+            image = np.full((4, 3, 2), label, dtype='float32')
+            yield [image, np.array([[label]] * 4, dtype='int64')]
+
+    return __provider__
+
+
+@unittest.skipIf(not sys.platform.startswith('linux'),
+                 'The shared memory queue is only supported on Linux')
+class TestPyReaderMultiProcess(unittest.TestCase):
+    def setUp(self):
+        self.num_workers = 3
+        self.batch_num = 8
+        self.passes = 2
+
+    def test_main(self):
+        with fluid.program_guard(fluid.Program(), fluid.Program()):
+            place = fluid.CPUPlace()
+            executor = fluid.Executor(place)
+            reader = fluid.layers.py_reader(
+                capacity=4,
+                shapes=[(-1, 3, 2), (-1, 1)],
+                dtypes=['float32', 'int64'],
+                use_double_buffer=False)
+            reader.decorate_multiprocess_tensor_providers(
+                [
+                    batch_provider(i, self.batch_num)
+                    for i in range(self.num_workers)
+                ],
+                slot_size=4096)
+            image, label = fluid.layers.read_file(reader)
+            executor.run(fluid.default_startup_program())
+
+            for _ in range(self.passes):
+                labels = []
+                reader.start()
+                try:
+                    while True:
+                        image_np, label_np = executor.run(
+                            fetch_list=[image, label])
+                        self.assertEqual((4, 3, 2), image_np.shape)
+                        self.assertTrue((image_np == label_np[0, 0]).all())
+                        labels.append(int(label_np[0, 0]))
+                except fluid.core.EOFException:
+                    reader.reset()
+
+                # Every batch of every worker is read once.
+                self.assertEqual(
+                    list(range(self.num_workers * self.batch_num)),
+                    sorted(labels))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,84 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+class TestQuantizeOp(OpTest):
+    def set_args(self):
+        self.is_negative = True
+        self.scale = 127.0 / 2.0
+
+    def setUp(self):
+        self.set_args()
+        self.op_type = "quantize"
+        x = np.random.uniform(-3, 3, (2, 3, 5, 5)).astype("float32")
+        if not self.is_negative:
+            x = np.abs(x)
+        if self.is_negative:
+            y = np.clip(np.round(x * self.scale), -128, 127).astype("int8")
+        else:
+            y = np.clip(np.round(x * self.scale), 0, 255).astype("uint8")
+
+        self.inputs = {'Input': x}
+        self.attrs = {
+            'Scale': self.scale,
+            'is_negative_input': self.is_negative
+        }
+        self.outputs = {'Output': y}
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestQuantizeOpUnsigned(TestQuantizeOp):
+    def set_args(self):
+        self.is_negative = False
+        self.scale = 255.0 / 2.0
+
+
+class TestDequantizeOp(OpTest):
+    def set_args(self):
+        self.data_type = "int8"
+        self.low = -128
+        self.high = 128
+
+    def setUp(self):
+        self.set_args()
+        self.op_type = "dequantize"
+        self.scale = 127.0 / 2.0
+        x = np.random.randint(self.low, self.high,
+                              (2, 3, 5, 5)).astype(self.data_type)
+        y = (x.astype("float32") / self.scale).astype("float32")
+
+        self.inputs = {'Input': x}
+        self.attrs = {'Scale': self.scale}
+        self.outputs = {'Output': y}
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestDequantizeOpUnsigned(TestDequantizeOp):
+    def set_args(self):
+        self.data_type = "uint8"
+        self.low = 0
+        self.high = 256
+
+
+if __name__ == "__main__":
+    unittest.main()
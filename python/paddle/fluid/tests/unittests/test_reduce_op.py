@@ -325,5 +325,45 @@ class TestReduceAll(OpTest):
         self.check_grad(['X'], 'Out')
 
 
+class TestReduceMaxOpNonAdjacentAxises(OpTest):
+    def setUp(self):
+        self.op_type = "reduce_max"
+        self.inputs = {'X': np.random.random((4, 5, 6, 7)).astype("float64")}
+        self.attrs = {'dim': [0, 2]}
+        self.outputs = {
+            'Out': self.inputs['X'].max(axis=tuple(self.attrs['dim']))
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestReduceMinOpReduceAll(OpTest):
+    def setUp(self):
+        self.op_type = "reduce_min"
+        self.inputs = {'X': np.random.random((5, 6, 10)).astype("float64")}
+        self.attrs = {'reduce_all': True}
+        self.outputs = {'Out': self.inputs['X'].min()}
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestReduceProdOpNonAdjacentAxises(OpTest):
+    def setUp(self):
+        self.op_type = "reduce_prod"
+        self.inputs = {'X': np.random.random((3, 4, 5)).astype("float64")}
+        self.attrs = {'dim': [0, 2]}
+        self.outputs = {
+            'Out': self.inputs['X'].prod(axis=tuple(self.attrs['dim']))
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad(self):
+        self.check_grad(['X'], 'Out')
+
+
 if __name__ == '__main__':
     unittest.main()
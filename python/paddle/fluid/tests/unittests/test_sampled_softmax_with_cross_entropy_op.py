@@ -0,0 +1,139 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+def sampled_softmax_with_cross_entropy(x, weight, bias, label, num_classes,
+                                       neg_classes):
+    batch_size = x.shape[0]
+    num_samples = len(neg_classes)
+    log_range = np.log(num_classes + 1)
+    sampled_labels = np.array(
+        [[label[i][0]] + list(neg_classes) for i in range(batch_size)],
+        dtype='int64')
+    prob = np.log((sampled_labels + 2.0) / (sampled_labels + 1.0)) / log_range
+    logits = np.zeros(sampled_labels.shape)
+    for i in range(batch_size):
+        for j in range(num_samples + 1):
+            l = sampled_labels[i][j]
+            logits[i][j] = np.dot(x[i], weight[l]) + bias[l]
+    logits -= np.log(num_samples * prob)
+    logits -= logits.max(axis=1, keepdims=True)
+    softmax = np.exp(logits) / np.exp(logits).sum(axis=1, keepdims=True)
+    loss = -np.log(softmax[:, 0:1])
+    return loss, softmax, sampled_labels
+
+
+class TestSampledSoftmaxWithCrossEntropyOp(OpTest):
+    def set_data(self):
+        self.batch_size = 5
+        self.dim = 6
+        self.num_classes = 20
+        self.num_samples = 4
+
+    def setUp(self):
+        self.op_type = 'sampled_softmax_with_cross_entropy'
+        self.set_data()
+        x = np.random.randn(self.batch_size, self.dim).astype('float64')
+        weight = np.random.randn(self.num_classes, self.dim).astype('float64')
+        bias = np.random.randn(self.num_classes, 1).astype('float64')
+        label = np.random.randint(0, self.num_classes,
+                                  (self.batch_size, 1)).astype('int64')
+        neg_classes = list(
+            np.random.choice(
+                self.num_classes, self.num_samples, replace=False))
+        self.attrs = {
+            'num_total_classes': self.num_classes,
+            'num_samples': self.num_samples,
+            'custom_neg_classes': [int(c) for c in neg_classes]
+        }
+        self.inputs = {
+            'Input': x,
+            'Label': label,
+            'Weight': weight,
+            'Bias': bias
+        }
+        loss, softmax, sampled_labels = sampled_softmax_with_cross_entropy(
+            x, weight, bias[:, 0], label, self.num_classes, neg_classes)
+        self.outputs = {
+            'Loss': loss,
+            'Softmax': softmax,
+            'SampledLabels': sampled_labels
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad(self):
+        self.check_grad(
+            ['Input', 'Weight', 'Bias'], 'Loss', max_relative_error=0.02)
+
+
+class TestSampledSoftmaxWithCrossEntropyOpCase1(
+        TestSampledSoftmaxWithCrossEntropyOp):
+    def set_data(self):
+        self.batch_size = 16
+        self.dim = 10
+        self.num_classes = 100
+        self.num_samples = 10
+
+
+class TestSampledSoftmaxWithCrossEntropySparse(unittest.TestCase):
+    def train(self, place, is_sparse, feed):
+        main = fluid.Program()
+        startup = fluid.Program()
+        startup.random_seed = 1
+        scope = fluid.Scope()
+        with fluid.program_guard(main, startup), fluid.scope_guard(scope):
+            x = fluid.layers.data(name='x', shape=[8], dtype='float32')
+            y = fluid.layers.data(name='y', shape=[1], dtype='int64')
+            loss = fluid.layers.sampled_softmax_with_cross_entropy(
+                input=x,
+                label=y,
+                num_total_classes=50,
+                num_samples=5,
+                param_attr='sampled_softmax.w',
+                bias_attr='sampled_softmax.b',
+                seed=1,
+                is_sparse=is_sparse)
+            fluid.optimizer.SGD(learning_rate=0.1).minimize(
+                fluid.layers.mean(loss))
+            exe = fluid.Executor(place)
+            exe.run(startup)
+            exe.run(main, feed=feed)
+            return np.array(scope.find_var('sampled_softmax.w').get_tensor())
+
+    def test_sparse_grad(self):
+        feed = {
+            'x': np.random.randn(4, 8).astype('float32'),
+            'y': np.random.randint(0, 50, (4, 1)).astype('int64')
+        }
+        places = [fluid.CPUPlace()]
+        if core.is_compiled_with_cuda():
+            places.append(fluid.CUDAPlace(0))
+        for place in places:
+            dense = self.train(place, False, feed)
+            sparse = self.train(place, True, feed)
+            self.assertTrue(np.allclose(dense, sparse, atol=1e-6))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -224,5 +224,22 @@ class TestSeqProjectCase2(TestSeqProject):
         self.output_represention = 8  # output feature size
 
 
+class TestSeqProjectCase3(TestSeqProject):
+    def init_test_case(self):
+        self.input_row = 25
+        self.context_start = -2
+        self.context_length = 5
+        self.padding_trainable = False
+        self.context_stride = 1
+
+        self.input_size = [self.input_row, 23]
+        offset_lod = [[0, 1, 4, 10, 12, self.input_row]]
+        self.lod = [[]]
+        # convert from offset-based lod to length-based lod
+        for i in range(len(offset_lod[0]) - 1):
+            self.lod[0].append(offset_lod[0][i + 1] - offset_lod[0][i])
+        self.output_represention = 8  # output feature size
+
+
 if __name__ == '__main__':
     unittest.main()
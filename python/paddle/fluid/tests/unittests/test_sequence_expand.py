@@ -117,5 +117,14 @@ class TestSequenceExpandCase4(TestSequenceExpand):
         self.inputs = {'X': (x_data, x_lod), 'Y': (y_data, y_lod)}
 
 
+class TestSequenceExpandSkewed(TestSequenceExpand):
+    def set_data(self):
+        x_data = np.random.uniform(0.1, 1, [46, 3]).astype('float32')
+        x_lod = [[1, 40, 0, 2, 3]]
+        y_data = np.random.uniform(0.1, 1, [10, 1]).astype('float32')
+        y_lod = [[2, 1, 3, 0, 4]]
+        self.inputs = {'X': (x_data, x_lod), 'Y': (y_data, y_lod)}
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -132,5 +132,14 @@ class TestSequencePadOp7(TestSequencePadOp):
         self.dtype = 'float32'
 
 
+class TestSequencePadOpSkewed(TestSequencePadOp):
+    def set_attr(self):
+        self.x_shape = [46, 3]
+        self.x_len_lod = [[1, 40, 0, 2, 3]]
+        self.pad_value = [1.0, 2.0, 3.0]
+        self.padded_length = -1
+        self.dtype = 'float32'
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -26,11 +26,12 @@ class TestSequenceSoftmaxOp(OpTest):
         self.op_type = "sequence_softmax"
         self.use_cudnn = False
         self.init_op_type()
+        self.init_lod()
 
-        x = np.random.uniform(0.1, 1, (11, 1)).astype("float32")
-        lod = [[4, 1, 3, 3]]
+        lod = self.lod
+        x = np.random.uniform(0.1, 1, (sum(lod[0]), 1)).astype("float32")
 
-        out = np.zeros((11, 1)).astype("float32")
+        out = np.zeros((sum(lod[0]), 1)).astype("float32")
         offset = 0
         for i in range(len(lod[0])):
             sub_x = x[offset:offset + lod[0][i], :]
@@ -46,6 +47,9 @@ class TestSequenceSoftmaxOp(OpTest):
     def init_op_type(self):
         pass
 
+    def init_lod(self):
+        self.lod = [[4, 1, 3, 3]]
+
     def test_check_output(self):
         if self.use_cudnn:
             place = core.CUDAPlace(0)
@@ -62,6 +66,12 @@ class TestSequenceSoftmaxOp(OpTest):
             self.check_grad(["X"], "Out", max_relative_error=0.01)
 
 
+class TestSequenceSoftmaxOpLongSequence(TestSequenceSoftmaxOp):
+    def init_lod(self):
+        # the sequence longer than 256 is computed by a block on GPU
+        self.lod = [[3, 300, 1, 2]]
+
+
 # ----------------cudnn Sequencesoftmax----------------
 @unittest.skipIf(not core.is_compiled_with_cuda(),
                  "core is not compiled with CUDA")
@@ -71,5 +71,12 @@ class TestSequenceUnpadOp3(TestSequenceUnpadOp):
         self.dtype = "float64"
 
 
+class TestSequenceUnpadOpSkewed(TestSequenceUnpadOp):
+    def init(self):
+        self.length = [1, 40, 0, 2, 1]
+        self.x_shape = (5, 40, 3)
+        self.dtype = "float32"
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,76 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+
+import numpy as np
+import paddle.fluid as fluid
+
+
+class TestSlotFileReader(unittest.TestCase):
+    def setUp(self):
+        self.num_slots = 3
+        self.batch_size = 7
+        self.file_names = ['./slot_reader_test_%d.slot' % i for i in range(2)]
+        np.random.seed(1)
+        self.instances = []
+        for file_name in self.file_names:
+            instances = []
+            for _ in range(25):
+                instances.append([
+                    list(np.random.randint(0, 100, size=np.random.randint(0, 5)))
+                    for _ in range(self.num_slots)
+                ])
+
+            def reader():
+                for instance in instances:
+                    yield instance
+
+            fluid.slot_file_writer.convert_reader_to_slot_file(
+                file_name, reader, self.num_slots, max_chunk_instances=4)
+            self.instances.extend(instances)
+
+    def test_main(self):
+        with fluid.program_guard(fluid.Program(), fluid.Program()):
+            reader = fluid.layers.open_slot_files(
+                filenames=self.file_names,
+                num_slots=self.num_slots,
+                batch_size=self.batch_size)
+            slots = fluid.layers.read_file(reader)
+
+            exe = fluid.Executor(fluid.CPUPlace())
+            exe.run(fluid.default_startup_program())
+
+            begin = 0
+            while True:
+                try:
+                    results = exe.run(fetch_list=slots, return_numpy=False)
+                except fluid.core.EOFException:
+                    break
+                batch = self.instances[begin:begin + self.batch_size]
+                for slot, result in enumerate(results):
+                    lengths = result.recursive_sequence_lengths()[0]
+                    self.assertEqual(lengths,
+                                     [len(ins[slot]) for ins in batch])
+                    expected = [i for ins in batch for i in ins[slot]]
+                    self.assertEqual(
+                        list(np.array(result).flatten()), expected)
+                begin += len(batch)
+            self.assertEqual(begin, len(self.instances))
+
+
+if __name__ == '__main__':
+    unittest.main()
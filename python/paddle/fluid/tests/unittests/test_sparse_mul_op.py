@@ -0,0 +1,119 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+def sparse_mul(ids, values, lod, table):
+    out = np.zeros((len(lod[0]), table.shape[1])).astype(table.dtype)
+    offset = 0
+    for i, length in enumerate(lod[0]):
+        for k in range(offset, offset + length):
+            out[i] += values[k] * table[ids[k]]
+        offset += length
+    return out
+
+
+class TestSparseMulOp(OpTest):
+    def set_values(self):
+        self.with_values = True
+
+    def setUp(self):
+        self.op_type = "sparse_mul"
+        self.set_values()
+        table = np.random.random((17, 3)).astype("float64")
+        lod = [[3, 0, 4, 2]]
+        ids = np.random.randint(0, 17, (9, 1)).astype("int64")
+        ids[5] = ids[3]
+        values = np.random.random((9, 1)).astype("float64")
+        self.inputs = {'W': table, 'Ids': (ids, lod)}
+        if self.with_values:
+            self.inputs['Values'] = (values, lod)
+        else:
+            values = np.ones((9, 1)).astype("float64")
+        self.outputs = {
+            'Out': sparse_mul(ids.flatten(), values.flatten(), lod, table)
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad(self):
+        self.check_grad(['W'], 'Out', no_grad_set=set(['Ids', 'Values']))
+
+
+class TestSparseMulOpWithoutValues(TestSparseMulOp):
+    def set_values(self):
+        self.with_values = False
+
+
+class TestSparseFCSparseUpdate(unittest.TestCase):
+    def train(self, place, is_sparse):
+        main = fluid.Program()
+        startup = fluid.Program()
+        scope = fluid.Scope()
+        with fluid.program_guard(main, startup):
+            ids = fluid.layers.data(
+                name='ids', shape=[1], dtype='int64', lod_level=1)
+            values = fluid.layers.data(
+                name='values', shape=[1], dtype='float32', lod_level=1)
+            out = fluid.layers.sparse_fc(
+                input=ids,
+                size=[20, 4],
+                values=values,
+                is_sparse=is_sparse,
+                param_attr=fluid.ParamAttr(
+                    name='w',
+                    initializer=fluid.initializer.Constant(value=0.1)),
+                bias_attr=False)
+            loss = fluid.layers.reduce_sum(out * out)
+            fluid.optimizer.SGD(learning_rate=0.5).minimize(loss)
+
+        lod = [[2, 0, 3]]
+        ids_array = np.array([[4], [11], [4], [0], [11]]).astype("int64")
+        values_array = np.array([[1.], [2.], [-1.], [.5], [3.]]).astype(
+            "float32")
+        exe = fluid.Executor(place)
+        with fluid.scope_guard(scope):
+            exe.run(startup)
+            exe.run(main,
+                    feed={
+                        'ids': fluid.create_lod_tensor(ids_array, lod, place),
+                        'values':
+                        fluid.create_lod_tensor(values_array, lod, place)
+                    },
+                    fetch_list=[loss])
+            return np.array(scope.find_var('w').get_tensor())
+
+    def test_sparse_update(self):
+        places = [core.CPUPlace()]
+        if core.is_compiled_with_cuda():
+            places.append(core.CUDAPlace(0))
+        for place in places:
+            dense = self.train(place, is_sparse=False)
+            sparse = self.train(place, is_sparse=True)
+            self.assertTrue(np.allclose(dense, sparse, atol=1e-5))
+            # Only the rows of the ids are updated.
+            self.assertTrue(np.allclose(dense[1], 0.1))
+            self.assertFalse(np.allclose(dense[11], 0.1))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -39,6 +39,25 @@ class TestSplitIdsOp(OpTest):
         self.check_output()
 
 
+class TestSplitIdsOpWithIndex(OpTest):
+    def setUp(self):
+        self.op_type = "split_ids"
+        ids = np.random.randint(0, 10000, (20000, 1)).astype('int64')
+        uniq_ids = np.unique(ids)
+        outs = [uniq_ids[uniq_ids % 3 == i].reshape(-1, 1) for i in range(3)]
+        rows = np.concatenate(outs)
+        row_of = dict((id, row) for row, id in enumerate(rows.flatten()))
+        index = np.array([[row_of[id]] for id in ids.flatten()]).astype('int64')
+        self.inputs = {'Ids': [('ids0', ids[:7000]), ('ids1', ids[7000:])]}
+        self.outputs = {
+            'Out': [('out%d' % i, outs[i]) for i in range(3)],
+            'Index': index
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+
 class TestSplitSelectedRows(unittest.TestCase):
     def get_places(self):
         places = [core.CPUPlace()]
@@ -183,6 +183,23 @@ class TestTensor(unittest.TestCase):
             tensor_array = numpy.array(tensor)
             self.assertEqual((0, 1), tensor_array.shape)
 
+    def test_zero_copy_tensor(self):
+        place = core.CPUPlace()
+        tensor = core.LoDTensor()
+        array = numpy.random.random((100, 8)).astype('float32')
+        tensor.set(array, place, zero_copy=True)
+
+        # The tensor uses the memory of the array.
+        tensor_array = numpy.array(tensor, copy=False)
+        self.assertTrue(numpy.array_equal(array, tensor_array))
+        array[3, 4] = 2.0
+        self.assertAlmostEqual(2.0, tensor_array[3, 4])
+
+        # A non-contiguous array is copied.
+        tensor.set(array[:, 1], place, zero_copy=True)
+        self.assertTrue(
+            numpy.array_equal(array[:, 1], numpy.array(tensor, copy=False)))
+
 
 if __name__ == '__main__':
     unittest.main()
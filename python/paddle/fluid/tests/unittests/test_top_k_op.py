@@ -107,5 +107,27 @@ class TestTopkOp4(TestTopkOp):
         self.top_k = 1
 
 
+class TestTopkOpLargeK(OpTest):
+    def setUp(self):
+        self.op_type = "top_k"
+        k = 64
+        input = np.random.random((16, 200)).astype("float32")
+        output = np.ndarray((16, k))
+        indices = np.ndarray((16, k)).astype("int64")
+
+        self.inputs = {'X': input}
+        self.attrs = {'k': k}
+
+        for rowid in range(16):
+            row = input[rowid]
+            output[rowid] = np.sort(row)[::-1][:k]
+            indices[rowid] = row.argsort()[::-1][:k]
+
+        self.outputs = {'Out': output, 'Indices': indices}
+
+    def test_check_output(self):
+        self.check_output()
+
+
 if __name__ == "__main__":
     unittest.main()
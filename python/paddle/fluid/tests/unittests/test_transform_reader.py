@@ -0,0 +1,109 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+
+import numpy as np
+import paddle
+import paddle.fluid as fluid
+
+
+class TestTransformReader(unittest.TestCase):
+    def setUp(self):
+        self.batch_size = 4
+        self.num_batch = 8
+        self.file_name = './transform_reader_test.recordio'
+        np.random.seed(1)
+        self.images = np.random.uniform(
+            0, 255, size=[self.batch_size * self.num_batch, 3, 8,
+                          8]).astype('float32')
+
+        def reader():
+            for i, image in enumerate(self.images):
+                yield image, [i]
+
+        with fluid.program_guard(fluid.Program(), fluid.Program()):
+            feeder = fluid.DataFeeder(
+                feed_list=[
+                    fluid.layers.data(
+                        name='image', shape=[3, 8, 8]),
+                    fluid.layers.data(
+                        name='label', shape=[1], dtype='int64'),
+                ],
+                place=fluid.CPUPlace())
+            fluid.recordio_writer.convert_reader_to_recordio_file(
+                self.file_name,
+                paddle.batch(
+                    reader, batch_size=self.batch_size),
+                feeder)
+
+    def run_reader(self, image_shape, **kwargs):
+        with fluid.program_guard(fluid.Program(), fluid.Program()):
+            reader = fluid.layers.open_files(
+                filenames=[self.file_name],
+                shapes=[[-1, 3, 8, 8], [-1, 1]],
+                lod_levels=[0, 0],
+                dtypes=['float32', 'int64'])
+            reader = fluid.layers.transform(
+                reader,
+                shapes=[image_shape, [-1, 1]],
+                dtypes=['float32', 'int64'],
+                **kwargs)
+            img, label = fluid.layers.read_file(reader)
+
+            exe = fluid.Executor(fluid.CPUPlace())
+            exe.run(fluid.default_startup_program())
+            results = []
+            while True:
+                try:
+                    results.append(exe.run(fetch_list=[img, label]))
+                except fluid.core.EOFException:
+                    break
+            return results
+
+    def test_normalize(self):
+        results = self.run_reader(
+            [-1, 3, 8, 8],
+            transforms=['normalize'],
+            thread_num=4,
+            keep_order=True,
+            mean=[127.5],
+            std=[127.5])
+        self.assertEqual(len(results), self.num_batch)
+        expected = (self.images - 127.5) / 127.5
+        for i, (img_val, label_val) in enumerate(results):
+            begin = i * self.batch_size
+            self.assertTrue(
+                np.allclose(
+                    img_val,
+                    expected[begin:begin + self.batch_size],
+                    atol=1e-5))
+            self.assertEqual(label_val[0][0], begin)
+
+    def test_random_crop(self):
+        results = self.run_reader(
+            [-1, 3, 4, 4],
+            transforms=['random_crop'],
+            thread_num=2,
+            crop_shape=[4, 4],
+            seed=1)
+        self.assertEqual(len(results), self.num_batch)
+        for img_val, _ in results:
+            self.assertEqual(img_val.shape, (self.batch_size, 3, 4, 4))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -71,5 +71,17 @@ class TestCase4(TestTransposeOp):
         self.axis = (4, 2, 3, 1, 0, 5)
 
 
+class TestCase5(TestTransposeOp):
+    def initTestCase(self):
+        self.shape = (2, 16, 4, 8)
+        self.axis = (0, 2, 1, 3)
+
+
+class TestCase6(TestTransposeOp):
+    def initTestCase(self):
+        self.shape = (40, 70)
+        self.axis = (1, 0)
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -81,5 +81,33 @@ class TestUniformRandomOpSelectedRows(unittest.TestCase):
                 hist, prob, rtol=0, atol=0.01), "hist: " + str(hist))
 
 
+class TestUniformRandomOpGPUSeed(unittest.TestCase):
+    def run_op(self, seed, shape=[1000, 7]):
+        scope = core.Scope()
+        out = scope.var("X").get_tensor()
+        op = Operator(
+            "uniform_random",
+            Out="X",
+            shape=shape,
+            min=-5.0,
+            max=10.0,
+            seed=seed)
+        op.run(scope, core.CUDAPlace(0))
+        return np.array(out)
+
+    def test_seed(self):
+        if not core.is_compiled_with_cuda():
+            return
+        # a fixed seed always gives the same numbers
+        self.assertTrue(np.array_equal(self.run_op(10), self.run_op(10)))
+        # the numbers of a shape are the head of the ones of a larger shape
+        self.assertTrue(
+            np.array_equal(
+                self.run_op(10, [999, 7]).flatten(),
+                self.run_op(10).flatten()[:999 * 7]))
+        # the ops without a seed get different numbers
+        self.assertFalse(np.array_equal(self.run_op(0), self.run_op(0)))
+
+
 if __name__ == "__main__":
     unittest.main()
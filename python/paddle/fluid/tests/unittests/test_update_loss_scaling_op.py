@@ -0,0 +1,114 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+class TestUpdateLossScalingOp(OpTest):
+    def setUp(self):
+        self.op_type = "update_loss_scaling"
+        self.init_config()
+        x0 = np.random.random((3, 4)).astype('float32') * self.loss_scaling
+        x1 = np.random.random((5, )).astype('float32') * self.loss_scaling
+        if self.all_finite:
+            out0 = x0 / self.loss_scaling
+            out1 = x1 / self.loss_scaling
+        else:
+            out0 = np.zeros_like(x0)
+            out1 = np.zeros_like(x1)
+        self.inputs = {
+            'X': [('x0', x0), ('x1', x1)],
+            'AllFinite': np.array([self.all_finite]).astype('bool'),
+            'LossScaling': np.array([self.loss_scaling]).astype('float32'),
+            'GoodSteps': np.array([self.good_steps]).astype('int32'),
+            'BadSteps': np.array([self.bad_steps]).astype('int32')
+        }
+        self.attrs = {
+            'incr_every_n_steps': 4,
+            'decr_every_n_nan_or_inf': 2,
+            'incr_ratio': 2.0,
+            'decr_ratio': 0.5
+        }
+        self.outputs = {
+            'Out': [('out0', out0), ('out1', out1)],
+            'LossScalingOut':
+            np.array([self.expected_loss_scaling]).astype('float32'),
+            'GoodStepsOut':
+            np.array([self.expected_good_steps]).astype('int32'),
+            'BadStepsOut': np.array([self.expected_bad_steps]).astype('int32')
+        }
+
+    def init_config(self):
+        self.all_finite = True
+        self.loss_scaling = 1024.0
+        self.good_steps = 1
+        self.bad_steps = 1
+        self.expected_loss_scaling = 1024.0
+        self.expected_good_steps = 2
+        self.expected_bad_steps = 0
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestUpdateLossScalingOpIncrease(TestUpdateLossScalingOp):
+    def init_config(self):
+        self.all_finite = True
+        self.loss_scaling = 1024.0
+        self.good_steps = 3
+        self.bad_steps = 0
+        self.expected_loss_scaling = 2048.0
+        self.expected_good_steps = 0
+        self.expected_bad_steps = 0
+
+
+class TestUpdateLossScalingOpOverflow(TestUpdateLossScalingOp):
+    def init_config(self):
+        self.all_finite = False
+        self.loss_scaling = 1024.0
+        self.good_steps = 3
+        self.bad_steps = 0
+        self.expected_loss_scaling = 1024.0
+        self.expected_good_steps = 0
+        self.expected_bad_steps = 1
+
+
+class TestUpdateLossScalingOpDecrease(TestUpdateLossScalingOp):
+    def init_config(self):
+        self.all_finite = False
+        self.loss_scaling = 1024.0
+        self.good_steps = 0
+        self.bad_steps = 1
+        self.expected_loss_scaling = 512.0
+        self.expected_good_steps = 0
+        self.expected_bad_steps = 0
+
+
+class TestUpdateLossScalingOpMinimum(TestUpdateLossScalingOp):
+    def init_config(self):
+        self.all_finite = False
+        self.loss_scaling = 1.5
+        self.good_steps = 0
+        self.bad_steps = 1
+        self.expected_loss_scaling = 1.0
+        self.expected_good_steps = 0
+        self.expected_bad_steps = 0
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -133,6 +133,48 @@ class DistributeTranspilerConfig(object):
         According:https://github.com/PaddlePaddle/Paddle/issues/8638#issuecomment-369912156
         We can use bandwidth effiently when data size is larger than 2MB.If you
         want to change it, please be sure you see the slice_variable function.
+    use_hierarchical_allreduce (bool): In nccl2 mode, also generate the NCCL
+        ids of the inter-trainer communicators, so that ParallelExecutor can
+        all reduce hierarchically with
+        BuildStrategy.use_hierarchical_allreduce. Default False.
+    hierarchical_allreduce_num_devices (int): The number of devices each
+        trainer uses, 0 means all the visible CUDA devices. Default 0.
+    gradient_compression (dict): In pserver mode, the compression of the
+        gradients sent to the pservers, keyed by the parameter names. The
+        values can be "fp16" or "topk". Default None, no compression.
+    topk_ratio (float): The ratio of the elements sent by the "topk"
+        compression; the others are accumulated on the trainer and sent in
+        the later steps. Default 0.01.
+    prefetch_cache_size (int): The number of the rows of the distributed
+        lookup table cached on the trainer, the cached rows are not
+        prefetched again. Default 0, no cache.
+    prefetch_cache_staleness (int): The number of the following steps a
+        cached row can be reused in. Default 1.
+    prefetch_pipeline (bool): Refresh the cached rows used by a step in the
+        background while the step computes, so that the hot rows are
+        fetched without blocking the trainer. Default False.
+    staleness (int): In async mode, the number of steps a trainer can run
+        ahead of the slowest trainer before it waits to get the parameters,
+        i.e. stale synchronous parallel training. Default 0, the trainers
+        never wait.
+    pipeline_optimize (bool): In sync mode, the pservers optimize a
+        parameter as soon as its gradients from all the trainers arrive,
+        which overlaps the optimization with receiving the other
+        gradients. Default False.
+    async_checkpoint (bool): The pservers copy the distributed lookup table
+        on the checkpoint notify, and write the copy in the background, so
+        the training is not stalled by the write. Default False.
+    incremental_checkpoint (bool): The first checkpoint of the distributed
+        lookup table saves the whole table, and the following ones only the
+        rows updated since the previous checkpoint, which are applied by the
+        load op with merge=True. Default False.
+    overlap_recv (bool): In sync mode, receive the parameters at the
+        beginning of a step in the order the forward ops use them, and each
+        forward op only waits for its own parameters, so the download of the
+        parameters overlaps the forward compute. The startup program does not
+        fetch the parameters, and the parameters of the trainer miss the last
+        update after the training, until the trainer runs the program of
+        get_trainer_sync_program. Default False.
     """
 
     slice_var_up = True
@@ -142,6 +184,18 @@ class DistributeTranspilerConfig(object):
     # supported modes: pserver, nccl2
     mode = "pserver"
     print_log = False
+    use_hierarchical_allreduce = False
+    hierarchical_allreduce_num_devices = 0
+    gradient_compression = None
+    topk_ratio = 0.01
+    prefetch_cache_size = 0
+    prefetch_cache_staleness = 1
+    prefetch_pipeline = False
+    staleness = 0
+    pipeline_optimize = False
+    async_checkpoint = False
+    incremental_checkpoint = False
+    overlap_recv = False
 
 
 class DistributeTranspiler(object):
@@ -210,6 +264,18 @@ class DistributeTranspiler(object):
         assert (self.config.min_block_size >= 8192)
         assert (self.config.split_method.__bases__[0] == PSDispatcher)
 
+    def _get_compress_type(self, param_name):
+        # NOTE: the values must be the same as
+        # operators/distributed/grad_compression.h
+        compress_types = {"none": 0, "fp16": 1, "topk": 2}
+        if not self.config.gradient_compression:
+            return 0
+        compression = self.config.gradient_compression.get(param_name, "none")
+        if compression not in compress_types:
+            raise ValueError("Unknown gradient compression %s of %s" %
+                             (compression, param_name))
+        return compress_types[compression]
+
     def _transpile_nccl2(self,
                          trainer_id,
                          trainers,
@@ -224,10 +290,22 @@ class DistributeTranspiler(object):
 
             nccl_id_var = startup_program.global_block().create_var(
                 name="NCCLID", persistable=True, type=core.VarDesc.VarType.RAW)
+            outputs = {"NCCLID": nccl_id_var}
+            if self.config.use_hierarchical_allreduce:
+                num_devices = self.config.hierarchical_allreduce_num_devices
+                if num_devices <= 0:
+                    num_devices = core.get_cuda_device_count()
+                outputs["NCCLIDInter"] = [
+                    startup_program.global_block().create_var(
+                        name="NCCLID_INTER_%d" % i,
+                        persistable=True,
+                        type=core.VarDesc.VarType.RAW)
+                    for i in range(num_devices)
+                ]
             startup_program.global_block().append_op(
                 type="gen_nccl_id",
                 inputs={},
-                outputs={"NCCLID": nccl_id_var},
+                outputs=outputs,
                 attrs={
                     "endpoint": current_endpoint,
                     "endpoint_list": worker_endpoints,
@@ -354,24 +432,38 @@ class DistributeTranspiler(object):
             # if splited, grad should be the original grad var name (split_by_ref and send
             # will be on the same place). ParallelExecutor
             # will use op_role_var to get expected device place to run this op.
+            send_attrs = {
+                "epmap": eplist,
+                RPC_OP_ROLE_ATTR_NAME: RPC_OP_ROLE_ATTR_VALUE,
+                OP_ROLE_VAR_ATTR_NAME: [
+                    self.grad_name_to_param_name[grad_varname],
+                    splited_grad_varname
+                ],
+                "sync_mode": not self.sync_mode,
+            }
+            compress_type = self._get_compress_type(
+                self.grad_name_to_param_name[grad_varname])
+            if compress_type != 0:
+                send_attrs["compress_types"] = [compress_type] * len(
+                    splited_vars)
+                send_attrs["topk_ratio"] = float(self.config.topk_ratio)
             program.global_block()._insert_op(
                 index=index + 1,
                 type="send",
                 inputs={"X": splited_vars},
                 outputs={"Out": dummy_output},
-                attrs={
-                    "epmap": eplist,
-                    RPC_OP_ROLE_ATTR_NAME: RPC_OP_ROLE_ATTR_VALUE,
-                    OP_ROLE_VAR_ATTR_NAME: [
-                        self.grad_name_to_param_name[grad_varname],
-                        splited_grad_varname
-                    ],
-                    "sync_mode": not self.sync_mode,
-                })
+                attrs=send_attrs)
             for _, var in enumerate(splited_vars):
                 send_vars.append(var)
 
-        if self.sync_mode:
+        # in the bounded staleness mode, the send barrier advances the clock
+        # of the trainer on the pservers
+        need_send_barrier = self.sync_mode or self.config.staleness > 0
+        overlap_recv = self.sync_mode and self.config.overlap_recv
+        if overlap_recv:
+            fetch_barrier_out = program.global_block().create_var(
+                name=framework.generate_control_dev_var_name())
+        if need_send_barrier:
             send_barrier_out = program.global_block().create_var(
                 name=framework.generate_control_dev_var_name())
             if self.has_distributed_lookup_table:
@@ -379,6 +471,10 @@ class DistributeTranspiler(object):
                     self.table_name] = program.global_block().create_var(
                         name=framework.generate_control_dev_var_name())
             input_deps = list(self.grad_name_to_send_dummy_out.values())
+            if overlap_recv:
+                # the pservers switch to receiving the gradients after the
+                # fetch barriers of all the trainers
+                input_deps.append(fetch_barrier_out)
 
             program.global_block().append_op(
                 type="send_barrier",
@@ -404,12 +500,18 @@ class DistributeTranspiler(object):
 
         # step4: Concat the parameters splits together after recv.
         all_recv_outputs = []
-        for param_varname, splited_var in six.iteritems(self.param_var_mapping):
+        recv_params = list(self.param_var_mapping.keys())
+        if overlap_recv:
+            recv_params = self._params_by_first_use(program, recv_params)
+        # the index of the next op before the forward ops
+        head_index = 0
+        for param_varname in recv_params:
+            splited_var = self.param_var_mapping[param_varname]
             eps = []
             for var in splited_var:
                 index = [v.name for v in recv_vars].index(var.name)
                 eps.append(eplist[index])
-            if self.sync_mode:
+            if need_send_barrier:
                 recv_dep_in = send_barrier_out
             else:
                 # connect deps to send op in async mode
@@ -425,20 +527,46 @@ class DistributeTranspiler(object):
             if len(splited_trainer_grad) == 1:
                 recv_op_role_var_name = splited_trainer_grad[0].name
 
-            program.global_block().append_op(
-                type="recv",
-                inputs={"X": [recv_dep_in]},
-                outputs={"Out": splited_var},
+            recv_attrs = {
+                "epmap": eps,
+                "trainer_id": self.trainer_id,
+                RPC_OP_ROLE_ATTR_NAME: RPC_OP_ROLE_ATTR_VALUE,
+                OP_ROLE_VAR_ATTR_NAME: [param_varname, recv_op_role_var_name],
+                "sync_mode": not self.sync_mode
+            }
+            if overlap_recv:
+                # each recv waits for its own parameter, which the forward
+                # ops using it depend on
+                recv_attrs["sync_mode"] = True
+                program.global_block()._insert_op(
+                    index=head_index,
+                    type="recv",
+                    inputs={"X": []},
+                    outputs={"Out": splited_var},
+                    attrs=recv_attrs)
+                head_index += 1
+            else:
+                program.global_block().append_op(
+                    type="recv",
+                    inputs={"X": [recv_dep_in]},
+                    outputs={"Out": splited_var},
+                    attrs=recv_attrs)
+
+        if overlap_recv:
+            # the fetch barrier waits for the recvs, instead of the forward
+            # ops waiting for the fetch barrier
+            program.global_block()._insert_op(
+                index=head_index,
+                type="fetch_barrier",
+                inputs={"X": all_recv_outputs},
+                outputs={"Out": fetch_barrier_out},
                 attrs={
-                    "epmap": eps,
+                    "endpoints": pserver_endpoints,
                     "trainer_id": self.trainer_id,
-                    RPC_OP_ROLE_ATTR_NAME: RPC_OP_ROLE_ATTR_VALUE,
-                    OP_ROLE_VAR_ATTR_NAME:
-                    [param_varname, recv_op_role_var_name],
-                    "sync_mode": not self.sync_mode
+                    RPC_OP_ROLE_ATTR_NAME: RPC_OP_ROLE_ATTR_VALUE
                 })
-
-        if self.sync_mode:
+            head_index += 1
+        elif self.sync_mode:
             # form a WAW dependency
             program.global_block().append_op(
                 type="fetch_barrier",
@@ -450,18 +578,29 @@ class DistributeTranspiler(object):
                     RPC_OP_ROLE_ATTR_NAME: RPC_OP_ROLE_ATTR_VALUE
                 })
 
-        for param_varname, splited_var in six.iteritems(self.param_var_mapping):
+        for param_varname in recv_params:
+            splited_var = self.param_var_mapping[param_varname]
             if len(splited_var) <= 1:
                 continue
             orig_param = program.global_block().vars[param_varname]
-            program.global_block().append_op(
-                type="concat",
-                inputs={"X": splited_var},
-                outputs={"Out": [orig_param]},
-                attrs={
-                    "axis": 0,
-                    RPC_OP_ROLE_ATTR_NAME: DIST_OP_ROLE_ATTR_VALUE
-                })
+            concat_attrs = {
+                "axis": 0,
+                RPC_OP_ROLE_ATTR_NAME: DIST_OP_ROLE_ATTR_VALUE
+            }
+            if overlap_recv:
+                program.global_block()._insert_op(
+                    index=head_index,
+                    type="concat",
+                    inputs={"X": splited_var},
+                    outputs={"Out": [orig_param]},
+                    attrs=concat_attrs)
+                head_index += 1
+            else:
+                program.global_block().append_op(
+                    type="concat",
+                    inputs={"X": splited_var},
+                    outputs={"Out": [orig_param]},
+                    attrs=concat_attrs)
 
         self._get_trainer_startup_program(recv_vars=recv_vars, eplist=eplist)
 
@@ -510,6 +649,19 @@ class DistributeTranspiler(object):
 
         return self.origin_program
 
+    def _params_by_first_use(self, program, params):
+        """
+        Sort the parameters by the first op reading them, the parameters not
+        read by any op are the last.
+        """
+        ops = program.global_block().ops
+        first_use = {}
+        for index, op in enumerate(ops):
+            for name in op.input_arg_names:
+                if name not in first_use:
+                    first_use[name] = index
+        return sorted(params, key=lambda p: first_use.get(p, len(ops)))
+
     def _get_trainer_startup_program(self, recv_vars, eplist):
         """
         Get transpiled trainer side startup program.
@@ -522,10 +674,43 @@ class DistributeTranspiler(object):
             Program: trainer side startup program.
         """
         startup_program = self.startup_program
+        # the first step of the trainer program gets the parameters, the
+        # sync program gets the last update
+        if self.sync_mode and self.config.overlap_recv:
+            self.recv_vars = recv_vars
+            self.recv_eplist = eplist
+            return startup_program
 
         # FIXME(gongwb): delete not need ops.
         # note that: some parameter is not trainable and those ops can't be deleted.
+        self._append_fetch_params_ops(startup_program, recv_vars, eplist)
+        return startup_program
+
+    def get_trainer_sync_program(self):
+        """
+        Get the program receiving the latest parameters from the pservers.
+        With overlap_recv, the trainer program receives the parameters at the
+        beginning of each step, so the trainers should run this program once
+        after the last step, before saving the parameters, e.g. by
+        save_persistables or save_inference_model.
 
+        Returns:
+            Program: trainer side program to run after the training.
+        """
+        if not (self.sync_mode and self.config.overlap_recv):
+            raise ValueError(
+                "get_trainer_sync_program is only needed with overlap_recv "
+                "in sync mode")
+        sync_program = Program()
+        self._append_fetch_params_ops(sync_program, self.recv_vars,
+                                      self.recv_eplist)
+        return sync_program
+
+    def _append_fetch_params_ops(self, program, recv_vars, eplist):
+        """
+        Append the recv ops of the parameters, the fetch_barrier and the
+        concat ops merging the splited parameters to program.
+        """
         for varname, splited_var in six.iteritems(self.param_var_mapping):
             # Get the eplist of recv vars
             eps = []
@@ -534,18 +719,19 @@ class DistributeTranspiler(object):
                 eps.append(eplist[index])
 
             for var in splited_var:
-                if startup_program.global_block().has_var(var.name):
+                if program.global_block().has_var(var.name):
                     continue
 
-                startup_program.global_block().create_var(
+                # the unsplited parameter is the parameter itself
+                program.global_block().create_var(
                     name=var.name,
-                    persistable=False,
+                    persistable=var.name == varname,
                     type=var.type,
                     dtype=var.dtype,
                     shape=var.shape,
                     lod_level=var.lod_level)
 
-            op = startup_program.global_block().append_op(
+            op = program.global_block().append_op(
                 type="recv",
                 inputs={"X": []},
                 outputs={"Out": splited_var},
@@ -554,9 +740,9 @@ class DistributeTranspiler(object):
                     RPC_OP_ROLE_ATTR_NAME: RPC_OP_ROLE_ATTR_VALUE
                 })
 
-        fetch_barrier_out = startup_program.global_block().create_var(
+        fetch_barrier_out = program.global_block().create_var(
             name=framework.generate_control_dev_var_name())
-        startup_program.global_block().append_op(
+        program.global_block().append_op(
             type="fetch_barrier",
             inputs={},
             outputs={"Out": fetch_barrier_out},
@@ -570,25 +756,23 @@ class DistributeTranspiler(object):
             if len(splited_var) <= 1:
                 continue
             # NOTE: if enable memory optimization, origin vars maybe removed.
-            if varname in startup_program.global_block().vars:
-                orig_param = startup_program.global_block().vars[varname]
+            if varname in program.global_block().vars:
+                orig_param = program.global_block().vars[varname]
             else:
                 origin_param_var = self.origin_program.global_block().vars[
                     varname]
-                orig_param = startup_program.global_block().create_var(
+                orig_param = program.global_block().create_var(
                     name=varname,
                     persistable=origin_param_var.persistable,
                     type=origin_param_var.type,
                     dtype=origin_param_var.dtype,
                     shape=origin_param_var.shape)
-            startup_program.global_block().append_op(
+            program.global_block().append_op(
                 type="concat",
                 inputs={"X": splited_var},
                 outputs={"Out": [orig_param]},
                 attrs={"axis": 0})
 
-        return startup_program
-
     def get_pserver_program(self, endpoint):
         """
         Get parameter server side program.
@@ -814,6 +998,10 @@ in a single call.")
             attrs['checkpint_block_id'] = checkpoint_block_id
         if self.config.enable_dc_asgd:
             attrs['dc_asgd'] = True
+        if not self.sync_mode and self.config.staleness > 0:
+            attrs['staleness'] = self.config.staleness
+        if self.sync_mode and self.config.pipeline_optimize:
+            attrs['pipeline_optimize'] = True
 
         if len(prefetch_var_name_to_block_id) > 0:
             attrs[
@@ -1150,12 +1338,22 @@ to transpile() call.")
                 dtype=self.all_out_emb_vars[0].dtype)
             self.all_prefetch_output_vars.append(out_var)
 
+        # the rows of the ids in the prefetched rows, for merge_ids_op
+        prefetch_index_var = program.global_block().create_var(
+            name="prefetch_compress_index_tmp",
+            type=self.all_in_ids_vars[0].type,
+            shape=[-1, 1],
+            dtype=core.VarDesc.VarType.INT64)
+
         # insert split_ids_op
         program.global_block()._insert_op(
             index=lookup_table_op_index,
             type="split_ids",
             inputs={'Ids': self.all_in_ids_vars},
-            outputs={"Out": self.all_prefetch_input_vars})
+            outputs={
+                "Out": self.all_prefetch_input_vars,
+                "Index": prefetch_index_var
+            })
 
         # insert prefetch_op
         program.global_block()._insert_op(
@@ -1165,6 +1363,10 @@ to transpile() call.")
             outputs={"Out": self.all_prefetch_output_vars},
             attrs={
                 "epmap": pserver_endpoints,
+                "table_name": self.table_name,
+                "cache_size": self.config.prefetch_cache_size,
+                "cache_staleness": self.config.prefetch_cache_staleness,
+                "pipeline": self.config.prefetch_pipeline,
                 # FIXME(qiao) temporarily disable this config because prefetch
                 # is not act as other rpc op, it's more like a forward op
                 # RPC_OP_ROLE_ATTR_NAME: RPC_OP_ROLE_ATTR_VALUE
@@ -1177,7 +1379,8 @@ to transpile() call.")
             inputs={
                 'Ids': self.all_in_ids_vars,
                 'Rows': self.all_prefetch_input_vars,
-                'X': self.all_prefetch_output_vars
+                'X': self.all_prefetch_output_vars,
+                'Index': prefetch_index_var
             },
             outputs={"Out": self.all_out_emb_vars})
 
@@ -1354,7 +1557,11 @@ to transpile() call.")
             type='save',
             inputs={'X': [self.table_name]},
             outputs={},
-            attrs={'file_path': "none"})
+            attrs={
+                'file_path': "none",
+                'async_write': self.config.async_checkpoint,
+                'incremental': self.config.incremental_checkpoint
+            })
 
         return checkpoint_save_block.idx
 
@@ -41,6 +41,14 @@ SUB_BLOCK_OPS = [
 SUB_BLOCK_PAIR = [("while", "while_grad"), ("parallel_do", "parallel_do_grad"),
                   ("conditional_block", "conditional_block_grad")]
 
+# The outputs of these ops are views sharing the memory of their inputs, the
+# (input, output) slots of the views.
+VIEW_OPS = {}
+for _view_op in ["reshape", "squeeze", "unsqueeze", "flatten"]:
+    for _suffix in ["", "2"]:
+        VIEW_OPS[_view_op + _suffix] = ("X", "Out")
+        VIEW_OPS[_view_op + _suffix + "_grad"] = ("Out@GRAD", "X@GRAD")
+
 PRINT_LOG = False
 
 
@@ -140,8 +148,26 @@ class ControlFlowGraph(object):
         self.op_size = len(self._ops)
         op_node_connections = [(i, i + 1) for i in range(self.op_size - 1)]
         self._add_connections(op_node_connections)
+        # The memory of a view is the memory of its input, which is used as
+        # long as the view is. The views are never reused, writing them
+        # would write their inputs.
+        view_of = {}
+        for i in range(self.op_size):
+            op = self._ops[i]
+            if op.type() in VIEW_OPS:
+                in_slot, out_slot = VIEW_OPS[op.type()]
+                if in_slot in op.input_names() and \
+                        out_slot in op.output_names():
+                    for x, out in zip(op.input(in_slot), op.output(out_slot)):
+                        if x != out:
+                            view_of[out] = view_of.get(x, x)
+        self._skip_opt.update(view_of.keys())
         for i in range(self.op_size):
             self._uses[i].update(self._ops[i].input_arg_names())
+            self._uses[i].update([
+                view_of[x] for x in self._ops[i].input_arg_names()
+                if x in view_of
+            ])
             self._defs[i].update(self._ops[i].output_arg_names())
             self._live_in[i] = self._uses[i]
 
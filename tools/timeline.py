@@ -28,6 +28,13 @@ parser.add_argument(
     default='',
     help='Input profile file name. If there are multiple file, the format '
     'should be trainer1=file1,trainer2=file2,ps=file3')
+parser.add_argument(
+    '--chrome_trace_path',
+    type=str,
+    default='',
+    help='Input Chrome trace files written by the profiler to merge, '
+    'instead of --profile_path. The format should be '
+    'trainer1=file1,trainer2=file2,ps=file3')
 parser.add_argument(
     '--timeline_path', type=str, default='', help='Output timeline file name.')
 args = parser.parse_args()
@@ -163,13 +170,37 @@ class Timeline(object):
         return self._chrome_trace.format_to_string()
 
 
-profile_path = '/tmp/profile'
-if args.profile_path:
-    profile_path = args.profile_path
+def merge_chrome_traces(trace_paths):
+    """Merge the Chrome traces of the processes, whose pids are unique, so
+    the flows of the RPCs link the trainers and the pservers."""
+    events = []
+    for trace_path in trace_paths:
+        name, path = '', trace_path
+        if '=' in trace_path:
+            name, path = trace_path.split('=')
+        with open(path, 'r') as f:
+            trace = json.load(f)
+        for event in trace['traceEvents']:
+            if name and event.get('ph') == 'M' and \
+                    event.get('name') == 'process_name':
+                event['args']['name'] = '%s: %s' % (name, event['args']['name'])
+            events.append(event)
+    return json.dumps({'traceEvents': events, 'displayTimeUnit': 'ns'})
+
+
 timeline_path = '/tmp/timeline'
 if args.timeline_path:
     timeline_path = args.timeline_path
 
+if args.chrome_trace_path:
+    with open(timeline_path, 'w') as f:
+        f.write(merge_chrome_traces(args.chrome_trace_path.split(',')))
+    sys.exit(0)
+
+profile_path = '/tmp/profile'
+if args.profile_path:
+    profile_path = args.profile_path
+
 profile_paths = profile_path.split(',')
 profile_dict = dict()
 if len(profile_paths) == 1: